@@ -518,6 +518,83 @@ bool isRelationalOperator(CallExpr* call) {
 
 }
 
+static CallExpr* getSingleMoveDef(Symbol* sym) {
+  if (!isVarSymbol(sym)) return nullptr;
+
+  CallExpr* ret = nullptr;
+  for_SymbolDefs(def, sym) {
+    CallExpr* call = toCallExpr(def->parentExpr);
+    if (ret != nullptr || !call || !call->isPrimitive(PRIM_MOVE) ||
+        call->get(1) != def) {
+      return nullptr;
+    }
+    ret = call;
+  }
+  return ret;
+}
+
+//
+// Checks if a primitive computes its result from its actuals alone,
+// without side effects
+//
+bool isPureValuePrimitive(CallExpr* call) {
+  switch (call->primitive->tag) {
+    case PRIM_GET_MEMBER:
+    case PRIM_GET_MEMBER_VALUE:
+    case PRIM_GET_SVEC_MEMBER:
+    case PRIM_GET_SVEC_MEMBER_VALUE:
+    case PRIM_DEREF:
+    case PRIM_ADDR_OF:
+    case PRIM_CAST:
+    case PRIM_UNARY_MINUS:
+    case PRIM_ADD:
+    case PRIM_SUBTRACT:
+    case PRIM_MULT:
+    case PRIM_DIV:
+    case PRIM_MOD:
+      return true;
+    default:
+      return false;
+  }
+}
+
+//
+// Returns true if 'a' and 'b' are the same symbol, or temporaries that are
+// each set once by computing the same thing from the same values.
+//
+bool isSameValue(Symbol* a, Symbol* b, int depth) {
+  if (a == b) return true;
+  if (depth > 8) return false;
+
+  CallExpr* defA = getSingleMoveDef(a);
+  CallExpr* defB = getSingleMoveDef(b);
+  if (!defA || !defB) return false;
+
+  if (SymExpr* rhsA = toSymExpr(defA->get(2))) {
+    SymExpr* rhsB = toSymExpr(defB->get(2));
+    return rhsB && isSameValue(rhsA->symbol(), rhsB->symbol(), depth+1);
+  }
+
+  CallExpr* rhsA = toCallExpr(defA->get(2));
+  CallExpr* rhsB = toCallExpr(defB->get(2));
+  if (!rhsA || !rhsB || !rhsA->isPrimitive() || !rhsB->isPrimitive() ||
+      rhsA->primitive->tag != rhsB->primitive->tag ||
+      rhsA->numActuals() != rhsB->numActuals() ||
+      !isPureValuePrimitive(rhsA)) {
+    return false;
+  }
+
+  for (int i = 1; i <= rhsA->numActuals(); i++) {
+    SymExpr* actualA = toSymExpr(rhsA->get(i));
+    SymExpr* actualB = toSymExpr(rhsB->get(i));
+    if (!actualA || !actualB ||
+        !isSameValue(actualA->symbol(), actualB->symbol(), depth+1)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 
 //
 // TODO this should be fixed to include PRIM_SET_MEMBER
@@ -736,6 +813,7 @@ void insert_help(BaseAST* ast,
 
 void remove_help(BaseAST* ast, int trace_flag) {
   trace_remove(ast, trace_flag);
+  noteRemovedAst(ast);
   AST_CHILDREN_CALL(ast, remove_help, trace_flag);
   if (Expr* expr = toExpr(ast)) {
     if (SymExpr* se = toSymExpr(expr)) {
@@ -48,9 +48,13 @@
 #include "type.h"
 #include "WhileStmt.h"
 
+#include <algorithm>
+#include <atomic>
 #include <ostream>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <vector>
 
 //
 // declare global vectors gSymExprs, gCallExprs, gFnSymbols, ...
@@ -58,7 +62,9 @@
 #define decl_gvecs(type) Vec<type*> g##type##s
 foreach_ast(decl_gvecs);
 
-static int uid = 1;
+// Atomic so that node IDs stay unique if nodes are ever built off the
+// main thread.
+static std::atomic<int> uid(1);
 
 #define decl_counters(type)                                             \
   int n##type = g##type##s.n, k##type = n##type*sizeof(type)/1024
@@ -204,20 +210,110 @@ void trace_remove(BaseAST* ast, char flag) {
     INT_FATAL(ast, "Unexpected attempt to eviscerate a global type symbol.");
 }
 
-#define clean_gvec(type)                        \
-  int i##type = 0;                              \
-  forv_Vec(type, ast, g##type##s) {             \
-    if (isAlive(ast) || isRootModuleWithType(ast, type)) { \
-      g##type##s.v[i##type++] = ast;            \
-    } else {                                    \
-      if (E_##type == E_VarSymbol)              \
-        remove_weak_links(toVarSymbol(ast));    \
-      trace_remove(ast, 'x');                   \
-      delete ast; ast = 0;                      \
-    }                                           \
-  }                                             \
-  g##type##s.n = i##type
+//
+// A node that was alive after the last cleanAst() can only have died by
+// being removed from the tree, which remove_help() records here.  So
+// cleanAst() only checks those nodes and the ones built since then, and
+// does not touch the rest of the AST.
+//
+static std::vector<BaseAST*> sRemovedAsts;
+
+// ids below this were assigned before the last cleanAst()
+static int sFirstNewID = 0;
+
+// how many entries of each global vector the last cleanAst() left
+#define decl_cleaned(type) static int sCleaned##type##s = 0
+foreach_ast(decl_cleaned);
+#undef decl_cleaned
+
+void noteRemovedAst(BaseAST* ast) {
+  sRemovedAsts.push_back(ast);
+}
+
+// Returns where 'ast' is among the first 'n' entries of 'vec', or -1.
+// Nodes are added to their vector as they are built, so the entries are
+// in id order, except that a constructor that builds another node of its
+// own type before adding itself puts the two out of order.
+template <typename T>
+static int findCleanedAst(Vec<T*>& vec, int n, BaseAST* ast) {
+  int lo = 0;
+  int hi = n;
+  while (lo < hi) {
+    int mid = lo + (hi - lo) / 2;
+    if (vec.v[mid]->id < ast->id) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return (lo < n && vec.v[lo] == ast) ? lo : -1;
+}
+
+// Deletes the dead nodes in 'vec' and compacts it in place, keeping the
+// order of the live ones.
+template <typename T>
+static void cleanGVec(Vec<T*>& vec, int& cleaned, AstTag tag,
+                      const std::vector<BaseAST*>& removed, bool full) {
+  std::vector<int> dead;
+
+  // entries before 'checked' were alive at the last cleanAst(), so only
+  // the removed ones among them can be dead now
+  int checked = full ? 0 : std::min(cleaned, vec.n);
+  for (BaseAST* ast : removed) {
+    if (checked == 0) break;
+    if (ast->id >= sFirstNewID) continue;
+
+    int i = findCleanedAst(vec, checked, ast);
+    if (i < 0) {
+      // out of id order; check the whole vector
+      checked = 0;
+      dead.clear();
+    } else if (!isAlive(static_cast<T*>(ast))) {
+      dead.push_back(i);
+    }
+  }
+
+  for (int i = checked; i < vec.n; i++) {
+    T* ast = vec.v[i];
+    if (!isAlive(ast) && !(tag == E_ModuleSymbol && (BaseAST*)ast == rootModule)) {
+      dead.push_back(i);
+    }
+  }
 
+  if (!dead.empty()) {
+    std::sort(dead.begin(), dead.end());
+    dead.erase(std::unique(dead.begin(), dead.end()), dead.end());
+
+    int j = dead[0];
+    size_t d = 0;
+    for (int i = dead[0]; i < vec.n; i++) {
+      T* ast = vec.v[i];
+      if (d < dead.size() && dead[d] == i) {
+        d++;
+        if (tag == E_VarSymbol)
+          remove_weak_links(toVarSymbol(ast));
+        trace_remove(ast, 'x');
+        delete ast;
+      } else {
+        vec.v[j++] = ast;
+      }
+    }
+    vec.n = j;
+  }
+
+  cleaned = vec.n;
+}
+
+// Is every node left in the global vectors alive?
+static void verifyCleanedAst() {
+  #define verify_cleaned(type)                                        \
+    forv_Vec(type, ast, g##type##s) {                                 \
+      if (!isAlive(ast) && !isRootModuleWithType(ast, type))          \
+        INT_FATAL(ast, "cleanAst() missed a dead " #type);            \
+    }
+  foreach_ast(verify_cleaned);
+  #undef verify_cleaned
+}
 
 static void clean_modvec(Vec<ModuleSymbol*>& modvec) {
   int aliveMods = 0;
@@ -300,7 +396,55 @@ void cleanAst() {
   //
   // clean global vectors and delete dead ast instances
   //
+
+  // A new DefExpr or TypeSymbol repoints an existing symbol's defPoint or
+  // type's symbol, which can kill it without removing it from the tree.
+  for (int i = sCleanedDefExprs; i < gDefExprs.n; i++) {
+    Symbol* sym = gDefExprs.v[i]->sym;
+    if (sym && sym->id < sFirstNewID)
+      sRemovedAsts.push_back(sym);
+  }
+  for (int i = sCleanedTypeSymbols; i < gTypeSymbols.n; i++) {
+    Type* type = gTypeSymbols.v[i]->type;
+    if (type && type->id < sFirstNewID)
+      sRemovedAsts.push_back(type);
+  }
+
+  // With --minimal-modules, isAlive() treats dtString and dtBytes as dead
+  // although they are still in the tree.
+  bool full = fMinimalModules;
+
+  // Deleting a VarSymbol removes some SymExprs, so nodes removed while
+  // cleaning are sorted into the vectors not cleaned yet, and kept for
+  // the next cleanAst() if their vector is already done.
+  std::vector<std::vector<BaseAST*> > removed(E_DecoratedClassType + 1);
+  std::vector<bool> done(E_DecoratedClassType + 1, false);
+  std::vector<BaseAST*> later;
+  size_t sorted = 0;
+
+  #define clean_gvec(type)                                            \
+    for (; sorted < sRemovedAsts.size(); sorted++) {                  \
+      BaseAST* ast = sRemovedAsts[sorted];                            \
+      if (done[ast->astTag])                                          \
+        later.push_back(ast);                                         \
+      else                                                            \
+        removed[ast->astTag].push_back(ast);                          \
+    }                                                                 \
+    cleanGVec(g##type##s, sCleaned##type##s, E_##type,                \
+              removed[E_##type], full);                               \
+    done[E_##type] = true
+
   foreach_ast(clean_gvec);
+  #undef clean_gvec
+
+  for (; sorted < sRemovedAsts.size(); sorted++) {
+    later.push_back(sRemovedAsts[sorted]);
+  }
+  sRemovedAsts.swap(later);
+  sFirstNewID = uid;
+
+  if (fVerify)
+    verifyCleanedAst();
 }
 
 
@@ -314,18 +458,48 @@ void destroyAst() {
 }
 
 
+// The per-node checks only read the AST, so when there are many nodes
+// they are split across several threads.
+static void verifyNodes(const std::vector<BaseAST*>& asts) {
+  unsigned nThreads = std::thread::hardware_concurrency();
+  if (nThreads > 8) nThreads = 8;
+
+  if (nThreads < 2 || asts.size() < 20000) {
+    for (BaseAST* ast : asts) {
+      ast->verify();
+    }
+    return;
+  }
+
+  size_t chunk = (asts.size() + nThreads - 1) / nThreads;
+  std::vector<std::thread> threads;
+  for (size_t begin = 0; begin < asts.size(); begin += chunk) {
+    size_t end = std::min(asts.size(), begin + chunk);
+    threads.emplace_back([&asts, begin, end]() {
+      for (size_t i = begin; i < end; i++) {
+        asts[i]->verify();
+      }
+    });
+  }
+  for (std::thread& t : threads) {
+    t.join();
+  }
+}
+
 void
 verify() {
   verifyRemovedIterResumeGotos();
   verifyCopiedIterResumeGotos();
 
-  #define verify_gvec(type)                       \
+  std::vector<BaseAST*> asts;
+  #define collect_gvec(type)                      \
     forv_Vec(type, ast, g##type##s) {             \
      if (isAlive(ast)) {                          \
-      ast->verify();                              \
+      asts.push_back(ast);                        \
      }                                            \
     }
-  foreach_ast(verify_gvec);
+  foreach_ast(collect_gvec);
+  verifyNodes(asts);
 
   // rootModule does not pass isAlive(), yet is "alive" - needs to be  verified
   rootModule->verify();
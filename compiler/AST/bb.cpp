@@ -619,40 +619,106 @@ void BasicBlock::computeBackwardOrder(FnSymbol* fn,
   }
 }
 
+typedef BitVec::Word Word;
+
+static const size_t kChunkWords = BitVec::kChunkWords;
+
+// The solvers below work a chunk of each set at a time, and skip the work
+// for chunks that are empty in every set involved.
+
+// Computes (in - kill) | gen for one chunk into 'words' and returns it, or
+// returns NULL if the result is empty.  NULL chunks are empty.
+static const Word* transferChunk(Word*       words,
+                                 const Word* in,
+                                 const Word* kill,
+                                 const Word* gen) {
+  if (in == NULL && gen == NULL)
+    return NULL;
+
+  for (size_t w = 0; w < kChunkWords; w++)
+    words[w] = (in != NULL) ? in[w] : 0;
+
+  if (kill != NULL && in != NULL) {
+    for (size_t w = 0; w < kChunkWords; w++)
+      words[w] &= ~kill[w];
+  }
+
+  if (gen != NULL) {
+    for (size_t w = 0; w < kChunkWords; w++)
+      words[w] |= gen[w];
+  }
+
+  return words;
+}
+
+// Computes the union or intersection of chunk 'c' of 'sets' for the
+// blocks in 'bbs' into 'words' and returns it, or returns NULL if the
+// result is empty.
+static const Word* meetChunk(Word*                     words,
+                             std::vector<BitVec*>&     sets,
+                             std::vector<BasicBlock*>& bbs,
+                             size_t                    c,
+                             bool                      intersect) {
+  bool empty = true;
+
+  for_vector(BasicBlock, bb, bbs) {
+    const Word* other = sets[bb->id]->chunk(c);
+
+    if (other == NULL) {
+      if (intersect)
+        return NULL;
+
+    } else if (empty) {
+      for (size_t w = 0; w < kChunkWords; w++)
+        words[w] = other[w];
+
+      empty = false;
+
+    } else if (intersect) {
+      for (size_t w = 0; w < kChunkWords; w++)
+        words[w] &= other[w];
+
+    } else {
+      for (size_t w = 0; w < kChunkWords; w++)
+        words[w] |= other[w];
+    }
+  }
+
+  return empty ? NULL : words;
+}
+
 //#define DEBUG_FLOW
 void BasicBlock::backwardFlowAnalysis(FnSymbol*             fn,
                                       std::vector<BitVec*>& GEN,
                                       std::vector<BitVec*>& KILL,
                                       std::vector<BitVec*>& IN,
                                       std::vector<BitVec*>& OUT) {
-  bool iterate = true;
+  size_t nbbs    = fn->basicBlocks->size();
+  bool   iterate = true;
 
   while (iterate) {
-    int i = 0;
-
     iterate = false;
 
-    for_vector(BasicBlock, bb, *fn->basicBlocks) {
-      for (size_t j = 0; j < IN[i]->ndata; j++) {
-        unsigned int new_in  = (OUT[i]->data[j] & ~KILL[i]->data[j]) | GEN[i]->data[j];
-        unsigned int new_out = 0;
+    // Information flows from successors to predecessors, so visiting the
+    // blocks last to first lets most of it through in one sweep.
+    for (size_t i = nbbs; i-- > 0; ) {
+      BasicBlock* bb = (*fn->basicBlocks)[i];
 
-        if (new_in != IN[i]->data[j]) {
-          IN[i]->data[j] = new_in;
-          iterate = true;
-        }
+      for (size_t c = 0; c < IN[i]->numChunks(); c++) {
+        Word new_in[BitVec::kChunkWords];
+        Word new_out[BitVec::kChunkWords];
 
-        for_vector(BasicBlock, bbout, bb->outs) {
-          new_out = new_out | IN[bbout->id]->data[j];
+        if (IN[i]->setChunk(c, transferChunk(new_in,
+                                             OUT[i]->chunk(c),
+                                             KILL[i]->chunk(c),
+                                             GEN[i]->chunk(c)))) {
+          iterate = true;
         }
 
-        if (new_out != OUT[i]->data[j]) {
-          OUT[i]->data[j] = new_out;
+        if (OUT[i]->setChunk(c, meetChunk(new_out, IN, bb->outs, c, false))) {
           iterate = true;
         }
       }
-
-      i++;
     }
 #ifdef DEBUG_FLOW
     printf("IN\n");  printBitVectorSets(IN);
@@ -696,28 +762,20 @@ void BasicBlock::forwardFlowAnalysis(FnSymbol*             fn,
     BasicBlock* bb     = (*fn->basicBlocks)[i];
     bool        change = false;
 
-    for (size_t j = 0; j < IN[i]->ndata; j++) {
-      if (bb->ins.size() > 0) {
-        unsigned int new_in = (intersect) ? (unsigned int) (-1) : 0;
-
-        for_vector(BasicBlock, bbin, bb->ins) {
-          if (intersect)
-            new_in &= OUT[bbin->id]->data[j];
-          else
-            new_in |= OUT[bbin->id]->data[j];
-        }
+    for (size_t c = 0; c < IN[i]->numChunks(); c++) {
+      Word new_in[BitVec::kChunkWords];
+      Word new_out[BitVec::kChunkWords];
 
-        if (new_in != IN[i]->data[j]) {
-          IN[i]->data[j] = new_in;
-          change         = true;
-        }
+      if (bb->ins.size() > 0) {
+        if (IN[i]->setChunk(c, meetChunk(new_in, OUT, bb->ins, c, intersect)))
+          change = true;
       }
 
-      unsigned int new_out = (IN[i]->data[j] & ~KILL[i]->data[j]) | GEN[i]->data[j];
-
-      if (new_out != OUT[i]->data[j]) {
-        OUT[i]->data[j] = new_out;
-        change          = true;
+      if (OUT[i]->setChunk(c, transferChunk(new_out,
+                                            IN[i]->chunk(c),
+                                            KILL[i]->chunk(c),
+                                            GEN[i]->chunk(c)))) {
+        change = true;
       }
     }
 
@@ -249,6 +249,9 @@ void checkPrimitives()
      case PRIM_CHPL_COMM_ARRAY_GET:
      case PRIM_CHPL_COMM_ARRAY_PUT:
      case PRIM_CHPL_COMM_REMOTE_PREFETCH:
+     case PRIM_PREFETCH:
+     case PRIM_CACHE_STREAM_BEGIN:
+     case PRIM_CACHE_STREAM_END:
      case PRIM_CHPL_COMM_GET_STRD:      // Direct calls to the Chapel comm layer for strided comm
      case PRIM_CHPL_COMM_PUT_STRD:      //  may eventually add others (e.g.: non-blocking)
      case PRIM_ARRAY_GET:
@@ -968,6 +968,11 @@ initPrimitive() {
   prim_def(PRIM_CHPL_COMM_ARRAY_GET, "chpl_comm_array_get", returnInfoVoid, true, true);
   prim_def(PRIM_CHPL_COMM_ARRAY_PUT, "chpl_comm_array_put", returnInfoVoid, true, true);
   prim_def(PRIM_CHPL_COMM_REMOTE_PREFETCH, "chpl_comm_remote_prefetch", returnInfoVoid, true, true);
+  // prefetch the element at a (possibly wide) reference
+  prim_def(PRIM_PREFETCH, "prefetch", returnInfoVoid, true, true);
+  // start/end streaming reads through the remote cache (@streamingReads)
+  prim_def(PRIM_CACHE_STREAM_BEGIN, "cache stream begin", returnInfoVoid, true);
+  prim_def(PRIM_CACHE_STREAM_END, "cache stream end", returnInfoVoid, true);
   // Direct calls to the Chapel comm layer for strided comm
   prim_def(PRIM_CHPL_COMM_GET_STRD, "chpl_comm_get_strd", returnInfoVoid, true, true);
   prim_def(PRIM_CHPL_COMM_PUT_STRD, "chpl_comm_put_strd", returnInfoVoid, true, true);
@@ -1548,12 +1548,10 @@ void createInitStringLiterals() {
   DefExpr* bufferDef = new DefExpr(buffer);
   insertPt->insertBefore(bufferDef);
 
-  VarSymbol* offset = new VarSymbol("offset", SIZE_TYPE);
-  insertPt->insertBefore(new DefExpr(offset));
-  insertPt->insertBefore(new CallExpr(PRIM_MOVE, offset, new_IntSymbol(0)));
-
-  VarSymbol* one = new_IntSymbol(1);
-
+  // The offset of each literal in the buffer is known here, so pass it
+  // as a constant rather than keeping a running sum at execution time.
+  // This initialization runs serially on every locale at startup, and
+  // programs with large generated tables can have a great many literals.
   int64_t bufferSize = 0;
 
   INT_ASSERT(gChplCreateStringWithLiteral != NULL);
@@ -1578,6 +1576,7 @@ void createInitStringLiterals() {
     const char* cstr = s->immediate->string_value();
 
     VarSymbol* strLenVar = new_IntSymbol(strLength);
+    VarSymbol* offset = new_IntSymbol(bufferSize);
     VarSymbol* cstrTemp = newTemp("call_tmp", dtStringC);
     CallExpr *cstrMove = new CallExpr(PRIM_MOVE, cstrTemp,
                                       new_CStringSymbol(cstr));
@@ -1602,14 +1601,10 @@ void createInitStringLiterals() {
     }
 
     CallExpr* moveCall = new CallExpr(PRIM_MOVE, s, initCall);
-    CallExpr* addCall = new CallExpr(PRIM_ADD_ASSIGN, offset, strLenVar);//data
-    CallExpr* incCall = new CallExpr(PRIM_ADD_ASSIGN, offset, one); //null
 
     insertPt->insertBefore(new DefExpr(cstrTemp));
     insertPt->insertBefore(cstrMove);
     insertPt->insertBefore(moveCall);
-    insertPt->insertBefore(addCall);
-    insertPt->insertBefore(incCall);
 
     bufferSize += strLength+1; // string data and null
   }
@@ -21,30 +21,46 @@
 #include "bitVec.h"
 
 #include <cstdlib>
+#include <cstring>
 
-#define TYPE unsigned
+typedef BitVec::Word Word;
+
+static const size_t kWordBits   = BitVec::kWordBits;
+static const size_t kChunkWords = BitVec::kChunkWords;
+static const size_t kChunkBits  = BitVec::kChunkBits;
+
+static inline Word bitMask(size_t i) {
+  return (Word) 1 << (i % kWordBits);
+}
+
+static inline size_t wordInChunk(size_t i) {
+  return (i % kChunkBits) / kWordBits;
+}
+
+static bool isZero(const Word* words) {
+  Word any = 0;
+
+  for (size_t w = 0; w < kChunkWords; w++)
+    any |= words[w];
+
+  return any == 0;
+}
 
 BitVec::BitVec(size_t in_size) {
-  if (in_size == 0) {
-    ndata         = 0;
-    this->in_size = 0;
-    data          = NULL;
-  } else {
-    ndata         = 1 + (in_size - 1) / (sizeof(TYPE) << 3);
-    this->in_size = in_size;
-    data          = (TYPE*) calloc(ndata, sizeof(TYPE));
-  }
+  this->in_size = in_size;
+  nchunks       = (in_size + kChunkBits - 1) / kChunkBits;
+  chunks        = (nchunks > 0) ? (Word**) calloc(nchunks, sizeof(Word*)) : NULL;
 }
 
 
 BitVec::BitVec(const BitVec& rhs)
-: data(NULL),
-  in_size(rhs.in_size),
-  ndata(rhs.ndata)
+: chunks(NULL),
+  nchunks(rhs.nchunks),
+  in_size(rhs.in_size)
 {
-  if (ndata > 0)
+  if (nchunks > 0)
   {
-    data = (TYPE*) calloc(ndata, sizeof(TYPE));
+    chunks = (Word**) calloc(nchunks, sizeof(Word*));
 
     copy(rhs);
   }
@@ -52,13 +68,51 @@ BitVec::BitVec(const BitVec& rhs)
 
 
 BitVec::~BitVec() {
-  free(data);
+  for (size_t c = 0; c < nchunks; c++)
+    free(chunks[c]);
+
+  free(chunks);
+}
+
+
+Word* BitVec::ensureChunk(size_t c) {
+  if (chunks[c] == NULL)
+    chunks[c] = (Word*) calloc(kChunkWords, sizeof(Word));
+
+  return chunks[c];
+}
+
+
+void BitVec::freeChunk(size_t c) {
+  free(chunks[c]);
+  chunks[c] = NULL;
+}
+
+
+// Clears the bits of 'words' past the first 'used'.
+static void maskWords(Word* words, size_t used) {
+  for (size_t w = 0; w < kChunkWords; w++) {
+    size_t start = w * kWordBits;
+
+    if (start >= used)
+      words[w] = 0;
+    else if (used - start < kWordBits)
+      words[w] &= ((Word) 1 << (used - start)) - 1;
+  }
+}
+
+
+// Keep the bits past in_size clear, so that count() and equals() need not
+// mask them.
+void BitVec::maskLastChunk() {
+  if (nchunks > 0 && chunks[nchunks - 1] != NULL)
+    maskWords(chunks[nchunks - 1], in_size - (nchunks - 1) * kChunkBits);
 }
 
 
 void BitVec::clear() {
-  for (size_t i = 0; i < ndata; i++)
-    data[i] = 0;
+  for (size_t c = 0; c < nchunks; c++)
+    freeChunk(c);
 }
 
 
@@ -68,18 +122,15 @@ bool BitVec::get(size_t i) const {
     INT_FATAL("BitVec::get -- operand out of range.");
 #endif
 
-  size_t j = i / (sizeof(TYPE) << 3);
-  size_t k = i - j * (sizeof(TYPE) << 3);
+  const Word* words = chunks[i / kChunkBits];
 
-  return data[j] & (1 << k);
+  return words != NULL && (words[wordInChunk(i)] & bitMask(i)) != 0;
 }
 
 
 void BitVec::unset(size_t i) {
-  size_t j = i / (sizeof(TYPE) << 3);
-  size_t k = i - j * (sizeof(TYPE) << 3);
-
-  data[j] &= ((TYPE)-1) - (1 << k);
+  if (Word* words = chunks[i / kChunkBits])
+    words[wordInChunk(i)] &= ~bitMask(i);
 }
 
 
@@ -89,8 +140,14 @@ void BitVec::disjunction(const BitVec& other) {
     INT_FATAL("BitVec::disjunction -- operand lengths must be equal.");
 #endif
 
-  for (size_t i = 0; i < ndata; i++)
-    data[i] |= other.data[i];
+  for (size_t c = 0; c < nchunks; c++) {
+    if (const Word* theirs = other.chunks[c]) {
+      Word* mine = ensureChunk(c);
+
+      for (size_t w = 0; w < kChunkWords; w++)
+        mine[w] |= theirs[w];
+    }
+  }
 }
 
 
@@ -100,8 +157,34 @@ void BitVec::intersection(const BitVec& other) {
     INT_FATAL("BitVec::intersection -- operand lengths must be equal.");
 #endif
 
-  for (size_t i = 0; i < ndata; i++)
-    data[i] &= other.data[i];
+  for (size_t c = 0; c < nchunks; c++) {
+    if (Word* mine = chunks[c]) {
+      if (const Word* theirs = other.chunks[c]) {
+        for (size_t w = 0; w < kChunkWords; w++)
+          mine[w] &= theirs[w];
+      } else {
+        freeChunk(c);
+      }
+    }
+  }
+}
+
+
+void BitVec::difference(const BitVec& other) {
+#if DEBUG
+  if (other.in_size != in_size)
+    INT_FATAL("BitVec::difference -- operand lengths must be equal.");
+#endif
+
+  for (size_t c = 0; c < nchunks; c++) {
+    Word*       mine   = chunks[c];
+    const Word* theirs = other.chunks[c];
+
+    if (mine != NULL && theirs != NULL) {
+      for (size_t w = 0; w < kChunkWords; w++)
+        mine[w] &= ~theirs[w];
+    }
+  }
 }
 
 
@@ -119,96 +202,91 @@ bool BitVec::equals(const BitVec& other) const {
     INT_FATAL("BitVec::disjunction -- operand lengths must be equal.");
 #endif
 
-  bool retval = true;
+  for (size_t c = 0; c < nchunks; c++) {
+    const Word* mine   = chunks[c];
+    const Word* theirs = other.chunks[c];
+
+    if (mine == NULL && theirs == NULL)
+      continue;
 
-  for (size_t i = 0; i < ndata && retval == true; i++) {
-    if (data[i] != other.data[i]) {
-      retval = false;
+    if (mine == NULL || theirs == NULL) {
+      if (!isZero(mine != NULL ? mine : theirs))
+        return false;
+    } else if (memcmp(mine, theirs, kChunkWords * sizeof(Word)) != 0) {
+      return false;
     }
   }
 
-  return retval;
+  return true;
 }
 
 
 void BitVec::set() {
-  for (size_t i = 0; i < ndata; i++)
-    data[i] = ~0;
+  for (size_t c = 0; c < nchunks; c++) {
+    Word* words = ensureChunk(c);
+
+    for (size_t w = 0; w < kChunkWords; w++)
+      words[w] = ~(Word) 0;
+  }
+
+  maskLastChunk();
 }
 
 
 void BitVec::set(size_t i) {
-  size_t j = i / (sizeof(TYPE) << 3);
-  size_t k = i - j * (sizeof(TYPE) << 3);
-
-  data[j] |= 1 << k;
+  ensureChunk(i / kChunkBits)[wordInChunk(i)] |= bitMask(i);
 }
 
 
 void BitVec::reset() {
-  for (size_t i = 0; i < ndata; i++)
-    data[i] = 0;
+  clear();
 }
 
 
 void BitVec::reset(size_t i) {
-  size_t j = i / (sizeof(TYPE) << 3);
-  size_t k = i - j * (sizeof(TYPE) << 3);
-
-  data[j] &= ((size_t)-1) - (1 << k);
+  unset(i);
 }
 
 
 void BitVec::copy(const BitVec& other) {
-  for (size_t i = 0; i < ndata; ++i)
-    data[i] = other.data[i];
+  for (size_t c = 0; c < nchunks; ++c)
+    setChunk(c, other.chunks[c]);
 }
 
 
 void BitVec::copy(size_t i, bool value) {
-  size_t j = i / (sizeof(TYPE) << 3);
-  size_t k = i - j * (sizeof(TYPE) << 3);
-
-  data[j] &= ~(1 << k);
-
   if (value)
-    data[j] |= (1 << k);
+    set(i);
+  else
+    unset(i);
 }
 
 
 void BitVec::flip() {
-  for (size_t i = 0; i < ndata; i++)
-    data[i] = ~data[i];
+  for (size_t c = 0; c < nchunks; c++) {
+    Word* words = ensureChunk(c);
+
+    for (size_t w = 0; w < kChunkWords; w++)
+      words[w] = ~words[w];
+  }
+
+  maskLastChunk();
 }
 
 
 void BitVec::flip(size_t i) {
-  size_t j = i / (sizeof(TYPE)<<3);
-  size_t k = i - j*(sizeof(TYPE)<<3);
-
-  data[j] ^= 1 << k;
+  ensureChunk(i / kChunkBits)[wordInChunk(i)] ^= bitMask(i);
 }
 
 
-/*
- * The current use of this function expects there to be almost no 1's
- * in which case this algorithm is the most efficient instead of an
- * implementation that uses divide and conquer shifting and counting with
- * hex manipulation (I have no idea what the name of that bit counting
- * algorithm is)
- */
 size_t BitVec::count() const {
   size_t count = 0;
 
-  for (size_t i = 0; i < ndata; i++) {
-    size_t localCount = 0;
-    size_t x          = data[i];
-
-    for (localCount = 0; x; localCount++) {
-      x &= x - 1;
+  for (size_t c = 0; c < nchunks; c++) {
+    if (const Word* words = chunks[c]) {
+      for (size_t w = 0; w < kChunkWords; w++)
+        count += __builtin_popcountll(words[w]);
     }
-
-    count += localCount;
   }
 
   return count;
@@ -221,26 +299,52 @@ size_t BitVec::size() const {
 
 
 bool BitVec::test(size_t i) const {
-  size_t j = i / (sizeof(TYPE) << 3);
-  size_t k = i - j * (sizeof(TYPE) << 3);
-
-  return data[j] & (1 << k);
+  return get(i);
 }
 
 
 bool BitVec::any() const {
-  bool retval = false;
-
-  for (size_t i = 0; i < ndata && retval == false; i++) {
-    if (data[i] > 0) {
-      retval = true;
-    }
+  for (size_t c = 0; c < nchunks; c++) {
+    if (chunks[c] != NULL && !isZero(chunks[c]))
+      return true;
   }
 
-  return retval;
+  return false;
 }
 
 
 bool BitVec::none() const {
   return !any();
 }
+
+
+bool BitVec::setChunk(size_t c, const Word* words) {
+  Word masked[kChunkWords];
+
+  if (words != NULL && c == nchunks - 1) {
+    memcpy(masked, words, sizeof(masked));
+    maskWords(masked, in_size - c * kChunkBits);
+    words = masked;
+  }
+
+  Word* mine = chunks[c];
+
+  if (words == NULL || isZero(words)) {
+    bool changed = mine != NULL && !isZero(mine);
+
+    if (mine != NULL)
+      freeChunk(c);
+
+    return changed;
+  }
+
+  if (mine == NULL) {
+    mine = ensureChunk(c);
+  } else if (memcmp(mine, words, sizeof(masked)) == 0) {
+    return false;
+  }
+
+  memcpy(mine, words, sizeof(masked));
+
+  return true;
+}
@@ -3173,6 +3173,20 @@ void codegenCall(const char* fnName, GenRet a1)
   args.push_back(a1);
   codegenCallWithArgs(fnName, args);
 }
+void codegenFunctionProfileEnter(FnSymbol* fn) {
+  int idx = getFunctionProfileIndex(fn);
+  if (idx >= 0) {
+    codegenCall("chpl_fn_prof_enter", new_IntSymbol(idx, INT_SIZE_32));
+  }
+}
+
+void codegenFunctionProfileExit(FnSymbol* fn) {
+  if (getFunctionProfileIndex(fn) >= 0) {
+    std::vector<GenRet> args;
+    codegenCallWithArgs("chpl_fn_prof_exit", args);
+  }
+}
+
 static
 void codegenCall(const char* fnName, GenRet a1, GenRet a2)
 {
@@ -4428,6 +4442,8 @@ DEFINE_PRIM(RETURN) {
     ret = codegenValue(retExpr);
   }
 
+  codegenFunctionProfileExit(call->getFunction());
+
   if (gGenInfo->cfile) {
     if (returnVoid) {
       ret.c = "return";
@@ -5284,10 +5300,24 @@ static GenRet codegenGPUKernelLaunch(CallExpr* call, bool is3d) {
   //    offload that value and create a GPU pointer to the offloaded instance.
   // 4. If aggregate: pass by reference, and the size of its value. The behavior
   //    will be similar to 3.
+  //
+  // Class arguments that aren't refs are pointers the kernel may follow, so
+  // each one is also passed to `chpl_gpu_prefetch_kernel_arg` before the
+  // launch. With unified memory, that moves what it points to onto the
+  // device ahead of the kernel.
+  //
+  // With CPU-as-device, the first kernel argument is the entry point of a
+  // kernel that runs on the host (see FLAG_GPU_HOST_KERNEL), with size 0,
+  // or NULL for any other kernel.
 
   // number of arguments that are not kernel params
   int nNonKernelParamArgs = is3d ? 7:3;
   int nKernelParamArgs = call->numActuals() - nNonKernelParamArgs;
+  bool passHostEntry = !isFullGpuCodegen();
+  if (passHostEntry) {
+    nKernelParamArgs++;
+  }
+  FnSymbol* hostKernel = nullptr;
 
   const char* fn = is3d ? "chpl_gpu_launch_kernel":"chpl_gpu_launch_kernel_flat";
 
@@ -5302,6 +5332,9 @@ static GenRet codegenGPUKernelLaunch(CallExpr* call, bool is3d) {
     if (curArg == 1) {  // function name or symbol
       if (FnSymbol* fn = toFnSymbol(actualSym)) {
         args.push_back(new_CStringSymbol(fn->cname));
+        if (fn->hasFlag(FLAG_GPU_HOST_KERNEL)) {
+          hostKernel = fn;
+        }
       }
       else if (isCStringImmediate(actualSym)) {
         args.push_back(actual->codegen());
@@ -5318,6 +5351,21 @@ static GenRet codegenGPUKernelLaunch(CallExpr* call, bool is3d) {
       if (curArg == nNonKernelParamArgs) {
         GenRet numParams = new_IntSymbol(nKernelParamArgs);
         args.push_back(numParams);
+
+        if (passHostEntry) {
+          GenRet entry = codegenNullPointer();
+#ifdef HAVE_LLVM
+          if (hostKernel != nullptr && gGenInfo->cfile == nullptr) {
+            llvm::Function* entryFn =
+              getFunctionLLVM(gpuHostKernelEntryName(hostKernel));
+            INT_ASSERT(entryFn);
+            entry.val = gGenInfo->irBuilder->CreatePointerCast(
+              entryFn, gGenInfo->irBuilder->getInt8PtrTy());
+          }
+#endif
+          args.push_back(entry);
+          args.push_back(new_IntSymbol(0));
+        }
       }
     }
     else { // kernel args
@@ -5326,6 +5374,9 @@ static GenRet codegenGPUKernelLaunch(CallExpr* call, bool is3d) {
       // TODO can we use codegenArgForFormal instead of this logic?
       if (isClass(actualValType) || (!actualSym->isRef() &&
                                      !isAggregateType(actualValType))) {
+        if (isClass(actualValType) && !actualSym->isRef()) {
+          codegenCall("chpl_gpu_prefetch_kernel_arg", codegenValue(actual));
+        }
         args.push_back(codegenAddrOf(codegenValuePtr(actual)));
         args.push_back(new_IntSymbol(0));
       }
@@ -5619,6 +5670,37 @@ DEFINE_PRIM(CHPL_COMM_REMOTE_PREFETCH) {
                 call->get(5));
 }
 
+DEFINE_PRIM(PREFETCH) {
+    // args are:
+    //   ref to the element, line, file
+    SymExpr* sym = toSymExpr(call->get(1));
+
+    INT_ASSERT(sym);
+
+    if (sym->isWideRef()) {
+      // Remote elements go through the remote data cache, if it's enabled
+      GenRet elt = call->get(1);
+      codegenCall("chpl_gen_comm_prefetch",
+                  codegenRnode(elt),
+                  codegenRaddr(elt),
+                  codegenSizeof(sym->getValType()),
+                  genCommID(gGenInfo),
+                  call->get(2),
+                  call->get(3));
+    } else {
+      GenRet addr = sym->isRef() ? codegenValue(call->get(1))
+                                 : codegenAddrOf(call->get(1));
+      codegenCall("chpl_prefetch", codegenCastToVoidStar(addr));
+    }
+}
+
+DEFINE_PRIM(CACHE_STREAM_BEGIN) {
+    codegenCall("chpl_gen_cache_stream_begin");
+}
+DEFINE_PRIM(CACHE_STREAM_END) {
+    codegenCall("chpl_gen_cache_stream_end");
+}
+
 // Strided versions of get and put
 static void codegenPutGetStrd(CallExpr* call, GenRet &ret) {
     // args are: local addr, dststr addr,
@@ -1302,6 +1302,16 @@ static std::string pythonArgToByteBuffer(ArgSymbol* as) {
   return res;
 }
 
+//
+// Numeric elements have the same layout in a numpy array as in a Chapel
+// one, so arrays of them can be shared across the boundary rather than
+// copied element by element.
+//
+static bool isPythonZeroCopyEltType(Type* t) {
+  return is_int_type(t) || is_uint_type(t) || is_real_type(t) ||
+         is_complex_type(t);
+}
+
 static std::string pythonArgToExternalArray(ArgSymbol* as) {
   std::string strname = as->cname;
 
@@ -1312,20 +1322,49 @@ static std::string pythonArgToExternalArray(ArgSymbol* as) {
     // do a translation in the python wrapper.
     std::string typeStr = getPythonTypeName(eltType->type, PYTHON_PYX);
     std::string typeStrCDefs = getPythonTypeName(eltType->type, C_PYX);
-
-    // Create the memory needed to store the contents of what was passed to us
-    // E.g. cdef chpl_external_array chpl_foo =
-    //          chpl_make_external_array(sizeof(element type), len(foo))
-    std::string res = "\tcdef chpl_external_array chpl_" + strname;
+    std::string copyIndent = "\t";
+
+    std::string res = "\tcdef chpl_external_array chpl_" + strname + "\n";
+
+    if (isPythonZeroCopyEltType(eltType->type)) {
+      //
+      // Let Chapel use the buffer of a numpy array directly. This only
+      // copies if the array isn't already contiguous with the right dtype.
+      // The memoryview keeps the buffer alive until we return, and the
+      // external array has no freer, so freeing it afterwards is a no-op.
+      //
+      //   cdef element type[::1] chpl_view_foo
+      //   if isinstance(foo, numpy.ndarray):
+      //     chpl_view_foo = numpy.ascontiguousarray(foo, dtype = (dtype))
+      //     chpl_foo = chpl_make_external_array_ptr(
+      //         &chpl_view_foo[0] if chpl_view_foo.shape[0] > 0 else NULL,
+      //         chpl_view_foo.shape[0])
+      //   else:
+      //     (copy it, as below)
+      //
+      std::string view = "chpl_view_" + strname;
+      res += "\tcdef " + typeStrCDefs + "[::1] " + view + "\n";
+      res += "\tif isinstance(" + strname + ", numpy.ndarray):\n";
+      res += "\t\t" + view + " = numpy.ascontiguousarray(" + strname;
+      res += ", dtype = " + typeStr + ")\n";
+      res += "\t\tchpl_" + strname + " = chpl_make_external_array_ptr(";
+      res += "<void*> &" + view + "[0] if " + view + ".shape[0] > 0 ";
+      res += "else NULL, " + view + ".shape[0])\n";
+      res += "\telse:\n";
+      copyIndent = "\t\t";
+    }
+
+    // Otherwise, create the memory needed to store the contents of what was
+    // passed to us and copy them over.
+    // E.g. chpl_foo = chpl_make_external_array(sizeof(element type), len(foo))
+    //      for i in range(len(foo)):
+    //         (<element type*>chpl_foo.elts)[i] = foo[i]
+    res += copyIndent + "chpl_" + strname;
     res += " = chpl_make_external_array(sizeof(" + typeStrCDefs + "), len(";
     res += strname + "))\n";
-
-    // Copy the contents over.
-    // E.g. for i in range(len(foo)):
-    //         (<element type*>chpl_foo.elts)[i] = foo[i]
-    res += "\tfor i in range(len(" + strname + ")):\n";
-    res += "\t\t(<" + typeStrCDefs + "*>chpl_" + strname + ".elts)[i] = ";
-    res += strname + "[i]\n";
+    res += copyIndent + "for i in range(len(" + strname + ")):\n";
+    res += copyIndent + "\t(<" + typeStrCDefs + "*>chpl_" + strname;
+    res += ".elts)[i] = " + strname + "[i]\n";
 
     return res;
   }
@@ -2272,6 +2311,67 @@ GenRet FnSymbol::codegenCast(GenRet fnPtr) {
   return fngen;
 }
 
+const char* gpuHostKernelEntryName(FnSymbol* fn) {
+  return astr(fn->cname, "_host_entry");
+}
+
+#ifdef HAVE_LLVM
+// The entry point of a host kernel has the same type for every kernel,
+//
+//   void entry(void** params, int64_t first, int64_t last)
+//
+// where, as for cuLaunchKernel, params[i] points to the value of the
+// kernel argument after 'first' and 'last' that is numbered i.
+static llvm::FunctionType* getGpuHostKernelEntryType() {
+  llvm::LLVMContext& ctx = gGenInfo->llvmContext;
+  llvm::Type* i8PtrTy = llvm::Type::getInt8PtrTy(ctx);
+  llvm::Type* i64Ty = llvm::Type::getInt64Ty(ctx);
+  llvm::Type* argTys[] = { llvm::PointerType::getUnqual(i8PtrTy),
+                           i64Ty, i64Ty };
+  return llvm::FunctionType::get(llvm::Type::getVoidTy(ctx), argTys, false);
+}
+
+// Loads the arguments of host kernel 'fn' and calls it.
+static void codegenGpuHostKernelEntry(FnSymbol* fn, llvm::Function* kernel) {
+  GenInfo* info = gGenInfo;
+  llvm::IRBuilder<>* irBuilder = info->irBuilder;
+  llvm::Function* entry = getFunctionLLVM(gpuHostKernelEntryName(fn));
+  INT_ASSERT(entry && entry->empty());
+  INT_ASSERT(kernel->arg_size() >= 2);
+
+  llvm::IRBuilderBase::InsertPointGuard guard(*irBuilder);
+  irBuilder->SetCurrentDebugLocation(llvm::DebugLoc());
+  irBuilder->SetInsertPoint(
+    llvm::BasicBlock::Create(info->llvmContext, "entry", entry));
+
+  // The entry has no debug info, so keep the kernel's from being inlined
+  // into it.
+  if (debug_info) {
+    kernel->addFnAttr(llvm::Attribute::NoInline);
+  }
+
+  llvm::Function::arg_iterator ai = entry->arg_begin();
+  llvm::Value* params = &*ai++;
+  std::vector<llvm::Value*> args;
+  args.push_back(&*ai++);
+  args.push_back(&*ai++);
+
+  llvm::Type* i8PtrTy = irBuilder->getInt8PtrTy();
+  llvm::FunctionType* kernelTy = kernel->getFunctionType();
+  for (unsigned i = 2; i < kernel->arg_size(); i++) {
+    llvm::Type* argTy = kernelTy->getParamType(i);
+    llvm::Value* slot = irBuilder->CreateConstInBoundsGEP1_64(i8PtrTy, params,
+                                                              i - 2);
+    llvm::Value* ptr = irBuilder->CreateLoad(i8PtrTy, slot);
+    ptr = irBuilder->CreatePointerCast(ptr, llvm::PointerType::getUnqual(argTy));
+    args.push_back(irBuilder->CreateLoad(argTy, ptr));
+  }
+
+  irBuilder->CreateCall(kernelTy, kernel, args);
+  irBuilder->CreateRetVoid();
+}
+#endif
+
 void FnSymbol::codegenPrototype() {
   if (id == breakOnCodegenID) gdbShouldBreakHere();
   if (breakOnCodegenCname[0] && !strcmp(cname, breakOnCodegenCname)) {
@@ -2378,6 +2478,12 @@ void FnSymbol::codegenPrototype() {
       argID++;
     }
 
+    if (hasFlag(FLAG_GPU_HOST_KERNEL)) {
+      llvm::Function::Create(getGpuHostKernelEntryType(),
+                             llvm::Function::InternalLinkage,
+                             gpuHostKernelEntryName(this), info->module);
+    }
+
 #endif
   }
   return;
@@ -2829,6 +2935,8 @@ void FnSymbol::codegenDef() {
     }
   }
 
+  codegenFunctionProfileEnter(this);
+
   body->codegen();
   flushStatements();
 #ifdef HAVE_LLVM
@@ -2866,6 +2974,10 @@ void FnSymbol::codegenDef() {
     // (note, in particular, the default pass manager's
     //  populateFunctionPassManager does not include vectorization)
     simplifyFunction(func);
+
+    if (hasFlag(FLAG_GPU_HOST_KERNEL)) {
+      codegenGpuHostKernelEntry(this, func);
+    }
 #endif
   }
 
@@ -3039,7 +3151,9 @@ void FnSymbol::codegenPython(PythonFileType pxd) {
       fprintf(outfile, "%s", idCommentTemp(this));
 
     if (pxd == C_PXD) {
-      fprintf(outfile, "\t%s;\n", codegenPXDType().c.c_str());
+      // Exported routines don't touch Python objects, so the wrappers
+      // may call them without holding the GIL.
+      fprintf(outfile, "\t%s nogil;\n", codegenPXDType().c.c_str());
     } else if (pxd == PYTHON_PYX) {
       fprintf(outfile, "\n%s", codegenPYXType().c.c_str());
     } else {
@@ -3093,11 +3207,13 @@ GenRet FnSymbol::codegenPXDType() {
   return ret;
 }
 
-static void pythonRetByteBuffer(FnSymbol* fn, std::string& funcCall,
+static void pythonRetByteBuffer(FnSymbol* fn, std::string& retDecl,
+                                std::string& funcCall,
                                 std::string& returnStmt) {
 
   // The raw result of the routine call, a "chpl_byte_buffer".
-  funcCall += "cdef chpl_byte_buffer rv = ";
+  retDecl += "\tcdef chpl_byte_buffer rv\n";
+  funcCall += "rv = ";
 
   // Unpack a handle to the buffer and the buffer size.
   returnStmt += "\tcdef char* rdata = rv.data\n";
@@ -3127,7 +3243,8 @@ static void pythonRetByteBuffer(FnSymbol* fn, std::string& funcCall,
   }
 }
 
-static void pythonRetExternalArray(FnSymbol* fn, std::string& funcCall,
+static void pythonRetExternalArray(FnSymbol* fn, std::string& retDecl,
+                                   std::string& funcCall,
                                    std::string& returnStmt) {
   INT_ASSERT(fn->retType == dtExternalArray);
 
@@ -3136,11 +3253,46 @@ static void pythonRetExternalArray(FnSymbol* fn, std::string& funcCall,
 
   Type* eltType = eltTypeSym->type;
 
-  funcCall += "cdef chpl_external_array ret_arr = ";
+  retDecl += "\tcdef chpl_external_array ret_arr\n";
+  funcCall += "ret_arr = ";
 
   std::string typeStr = getPythonTypeName(eltType, PYTHON_PYX);
   std::string typeStrCDefs = getPythonTypeName(eltType, C_PYX);
 
+  if (isPythonZeroCopyEltType(eltType)) {
+    //
+    // Hand the Chapel buffer to numpy as a view rather than copying it.
+    // The cython array the view is built on calls the external array's
+    // freer (if any) when the last view of it goes away. Cython arrays
+    // can't be empty, so an empty result is just a new numpy array.
+    //
+    //   cdef view.array ret_view
+    //   if ret_arr.num_elts == 0:
+    //     chpl_free_external_array(ret_arr)
+    //     ret = numpy.zeros(shape = 0, dtype = (numpy dtype))
+    //   else:
+    //     ret_view = <C element type[:ret_arr.num_elts]>
+    //                  <C element type*> ret_arr.elts
+    //     if ret_arr.freer != NULL:
+    //       ret_view.callback_free_data = <void (*)(void*)> ret_arr.freer
+    //     ret = numpy.asarray(ret_view)
+    //
+    std::string res;
+    res += "\tcdef view.array ret_view\n";
+    res += "\tif ret_arr.num_elts == 0:\n";
+    res += "\t\tchpl_free_external_array(ret_arr)\n";
+    res += "\t\tret = numpy.zeros(shape = 0, dtype = " + typeStr + ")\n";
+    res += "\telse:\n";
+    res += "\t\tret_view = <" + typeStrCDefs + "[:ret_arr.num_elts]> <";
+    res += typeStrCDefs + "*> ret_arr.elts\n";
+    res += "\t\tif ret_arr.freer != NULL:\n";
+    res += "\t\t\tret_view.callback_free_data = <void (*)(void*)> ";
+    res += "ret_arr.freer\n";
+    res += "\t\tret = numpy.asarray(ret_view)\n";
+    returnStmt += res;
+    return;
+  }
+
   //
   // Create the numpy array to return. The form looks like:
   //
@@ -3191,7 +3343,8 @@ static void pythonRetExternalArray(FnSymbol* fn, std::string& funcCall,
   returnStmt += res;
 }
 
-static void pythonRetOpaqueArray(FnSymbol* fn, std::string& funcCall,
+static void pythonRetOpaqueArray(FnSymbol* fn, std::string& retDecl,
+                                 std::string& funcCall,
                                  std::string& returnStmt) {
   funcCall += "ret = ChplOpaqueArray()\n\t";
   funcCall += "ret.setVal(";
@@ -3211,19 +3364,33 @@ GenRet FnSymbol::codegenPYXType() {
 
   // Translation of any arguments with Python-specific types
   std::string argTranslate = "";
+  // Declaration of the C result of the wrapped function, if applicable
+  std::string retDecl = "";
   // Call to the wrapped function
   std::string funcCall = "\t";
   // Return statement, if applicable
   std::string returnStmt = "";
+  // Whether the call only involves C values, so that other Python threads
+  // can run while it does
+  bool releaseGil = true;
   if (retType != dtVoid) {
     if (retType == exportTypeChplByteBuffer) {
-      pythonRetByteBuffer(this, funcCall, returnStmt);
+      pythonRetByteBuffer(this, retDecl, funcCall, returnStmt);
     } else if (retType == dtExternalArray) {
-      pythonRetExternalArray(this, funcCall, returnStmt);
+      pythonRetExternalArray(this, retDecl, funcCall, returnStmt);
     } else if (retType == dtOpaqueArray) {
-      pythonRetOpaqueArray(this, funcCall, returnStmt);
+      pythonRetOpaqueArray(this, retDecl, funcCall, returnStmt);
+      releaseGil = false;
     } else {
-      funcCall += "ret = ";
+      std::string retTypeStr = getPythonTypeName(retType, C_PYX);
+      if (retTypeStr != "" && retTypeStr != "object") {
+        retDecl += "\tcdef " + retTypeStr + " chpl_ret\n";
+        funcCall += "chpl_ret = ";
+        returnStmt += "\tret = chpl_ret\n";
+      } else {
+        funcCall += "ret = ";
+        releaseGil = false;
+      }
     }
     returnStmt += "\treturn ret\n";
   }
@@ -3252,6 +3419,11 @@ GenRet FnSymbol::codegenPYXType() {
       header += formal->getPythonDefaultValue();
 
       std::string curArgTranslate = formal->getPythonArgTranslation();
+      // Python objects can't be passed along without the GIL
+      if (argType == "ChplOpaqueArray " ||
+          (curArgTranslate == "" && (argType == "" || argType == "object "))) {
+        releaseGil = false;
+      }
       if (curArgTranslate != "") {
         argTranslate += curArgTranslate;
         if (argType == "" && formal->type->getValType() == dtExternalArray) {
@@ -3272,7 +3444,10 @@ GenRet FnSymbol::codegenPYXType() {
   if (retType == dtOpaqueArray)
     funcCall += ")";
   funcCall += ")\n";
-  ret.c = header + argTranslate + funcCall + returnStmt;
+  if (releaseGil) {
+    funcCall = "\twith nogil:\n\t" + funcCall;
+  }
+  ret.c = header + argTranslate + retDecl + funcCall + returnStmt;
 
   return ret;
 }
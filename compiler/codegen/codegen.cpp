@@ -62,6 +62,7 @@
 #include "llvm/Remarks/RemarkSerializer.h"
 #include "llvm/Remarks/RemarkStreamer.h"
 #include "llvm/Remarks/YAMLRemarkSerializer.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/raw_ostream.h"
 
 
@@ -83,6 +84,7 @@
 
 #include <sys/types.h>
 #include <sys/wait.h>
+#include <unistd.h>
 
 // function prototypes
 static bool compareSymbol(const void* v1, const void* v2);
@@ -879,11 +881,13 @@ static void genFilenameTable() {
 // chpl_funSymTable     = cname, Chapel name
 // chpl_filenumSymTable = Chapel file name index, Chapel line number
 //
-static void genUnwindSymbolTable(){
+// The function profiler (--profile-functions) also uses these tables, and
+// identifies a function by its entry's position in them.
+static std::vector<FnSymbol*> gatherUnwindSymbols() {
   std::vector<FnSymbol*> symbols;
 
   //If CHPL_UNWIND is none we don't want any symbols in our tables
-  if(strcmp(CHPL_UNWIND, "none") != 0){
+  if(strcmp(CHPL_UNWIND, "none") != 0 || fProfileFunctions){
     // Gets only user symbols
     forv_Vec(FnSymbol, fn, gFnSymbols) {
       if(strncmp(fn->name, "chpl_", 5) || fn->hasFlag(FLAG_MODULE_INIT)) {
@@ -891,6 +895,37 @@ static void genUnwindSymbolTable(){
       }
     }
   }
+  return symbols;
+}
+
+int getFunctionProfileIndex(FnSymbol* fn) {
+  static std::map<FnSymbol*, int> indices;
+  static bool computed = false;
+
+  if (!fProfileFunctions || gCodegenGPU) return -1;
+
+  if (!computed) {
+    std::vector<FnSymbol*> symbols = gatherUnwindSymbols();
+    for (size_t i = 0; i < symbols.size(); i++) {
+      FnSymbol* sym = symbols[i];
+      // Only user code is instrumented, to keep the overhead where the
+      // user can act on it.
+      if (sym->getModule()->modTag == MOD_USER &&
+          !sym->hasFlag(FLAG_EXTERN) &&
+          !sym->hasFlag(FLAG_NO_CODEGEN) &&
+          !sym->hasFlag(FLAG_GPU_CODEGEN)) {
+        indices[sym] = (int) i;
+      }
+    }
+    computed = true;
+  }
+
+  std::map<FnSymbol*, int>::iterator it = indices.find(fn);
+  return it == indices.end() ? -1 : it->second;
+}
+
+static void genUnwindSymbolTable(){
+  std::vector<FnSymbol*> symbols = gatherUnwindSymbols();
 
   // Generate the cname, Chapel name table
   {
@@ -2977,6 +3012,17 @@ static void codegenPartTwo() {
 
     // compute the cnamesfunction names
     libWriter.writeAllSections();
+
+    if (!gDynoStdLibCachePath.empty()) {
+      // move the completed standard library into the cache
+      auto err = llvm::sys::fs::rename(gDynoGenLibOutput,
+                                       gDynoStdLibCachePath);
+      if (err) {
+        USR_WARN("could not save the standard library cache %s: %s",
+                 gDynoStdLibCachePath.c_str(), err.message().c_str());
+        llvm::sys::fs::remove(gDynoGenLibOutput);
+      }
+    }
 #endif
   }
 }
@@ -3040,6 +3086,12 @@ void codegen() {
   codegenPartTwo();
 }
 
+// Is there a jobserver from an enclosing make for our make to join?
+static bool inMakeJobserver() {
+  const char* makeflags = getenv("MAKEFLAGS");
+  return makeflags != NULL && strstr(makeflags, "--jobserver") != NULL;
+}
+
 void makeBinary(void) {
   if (no_codegen)
     return;
@@ -3062,6 +3114,13 @@ void makeBinary(void) {
     char parMakeFlags[32] = "";
     if (fParMake > 0) {
       snprintf(parMakeFlags, sizeof(parMakeFlags), "-j %d ", fParMake);
+    } else if (fIncrementalCompilation && !inMakeJobserver()) {
+      // Each module is its own C file, so compile them all at once. Under
+      // an enclosing 'make -j' the sub-make shares its jobserver instead.
+      long numCores = sysconf(_SC_NPROCESSORS_ONLN);
+      if (numCores > 1) {
+        snprintf(parMakeFlags, sizeof(parMakeFlags), "-j %ld ", numCores);
+      }
     }
     const char* command = astr(astr(CHPL_MAKE, " "),
                                parMakeFlags, makeflags,
@@ -708,6 +708,8 @@ static void makePYXFile(std::vector<FnSymbol*> functions) {
     // Necessary for using numpy types
     fprintf(pyx.fptr, "import numpy\n");
     fprintf(pyx.fptr, "cimport numpy\n");
+    // Necessary for returning Chapel arrays as numpy views
+    fprintf(pyx.fptr, "from cython cimport view\n");
     // Necessary for supporting pointers
     fprintf(pyx.fptr, "import ctypes\n");
     fprintf(pyx.fptr, "from libc.stdint cimport intptr_t\n\n");
@@ -346,7 +346,6 @@ std::string MLIContext::genMarshalBodyPrimitiveScalar(Type* t, bool push) {
 }
 
 std::string MLIContext::genMarshalBodyPrimArray(Type* t, bool push) {
-  const char* target = push ? "obj" : "buffer";
   std::string gen;
 
   // Declare temporaries for bytecount, buffer, and memory errors.
@@ -355,22 +354,21 @@ std::string MLIContext::genMarshalBodyPrimArray(Type* t, bool push) {
   gen += this->genNewDecl("int64_t", "mem_err");
 
   if (push) {
-    // Compute and push length of string.
+    // Compute length of string, then move it and the string as one
+    // message.
     gen += "bytes = strlen(obj);\n";
 
     if (this->debugPrint) {
       gen += this->genDebugPrintCall1Arg("Pushing length: ", "bytes");
     }
-  }
-
-  gen += this->genSocketCall("skt", "bytes", push);
 
-  if (!push) {
-    if (this->debugPrint) {
-      gen += this->genDebugPrintCall1Arg("Received intended length: ", "bytes");
-    }
-    // Attempt to allocate buffer.
-    gen += "buffer = mli_malloc(bytes + 1);\n";
+    gen += mliPushFunctionName;
+    gen += "_sized(skt, ((void*) obj), bytes);\n";
+  } else {
+    // Pull the string into a new null terminated buffer.
+    gen += "buffer = ";
+    gen += mliPullFunctionName;
+    gen += "_sized(skt, &bytes);\n";
 
     // Set ACK value (non-zero if memory allocation failed).
     gen += "mem_err = (buffer == NULL);\n";
@@ -380,18 +378,9 @@ std::string MLIContext::genMarshalBodyPrimArray(Type* t, bool push) {
   gen += this->genSocketCall("skt", "mem_err", !push);
 
   // If error, terminate client/server.
-  gen += "if (mem_err) chpl_mli_terminate(CHPL_MLI_CODE_EMEMORY);\n";
-
-  // Move the string over the wire, using length.
-  gen += this->genSocketCallBuffer("skt", target, "bytes", push);
-
-  // Generate a null frame in the opposite direction for the ACK.
-  gen += this->genSocketCall("skt", NULL, !push);
+  gen += "if (mem_err) chpl_mli_terminate();\n";
 
   if (!push) {
-    // Null terminate the string we just received.
-    gen += "((char*) buffer)[bytes] = '\\0';\n";
-
     if (t->symbol->hasFlag(FLAG_C_PTR_CLASS) &&
         getDataClassType(t->symbol)->typeInfo() == dtInt[INT_SIZE_8]) {
       // Cast buffer to int8*
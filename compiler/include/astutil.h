@@ -130,6 +130,17 @@ bool isDerefMove(CallExpr* call);
 //
 bool isRelationalOperator(CallExpr* call);
 
+//
+// Checks if a primitive computes its result from its actuals alone
+//
+bool isPureValuePrimitive(CallExpr* call);
+
+//
+// Checks if two symbols hold the same value: they are the same symbol, or
+// temporaries each set once to the same pure computation of the same values.
+//
+bool isSameValue(Symbol* a, Symbol* b, int depth = 0);
+
 //
 // Return value & 1 is true if se is a def
 // Return value & 2 is true if se is a use
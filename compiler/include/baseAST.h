@@ -295,6 +295,9 @@ int    lastNodeIDUsed();
 // trace various AST node removals
 void   trace_remove(BaseAST* ast, char flag);
 
+// record a node removed from the tree for the next cleanAst()
+void   noteRemovedAst(BaseAST* ast);
+
 void verifyInTree(BaseAST* ast, const char* msg);
 
 //
@@ -22,13 +22,23 @@
 #define _CHPL_BIT_VEC_H_
 
 #include <cstddef>
-
+#include <cstdint>
+
+//
+// A fixed size set of bits.  The bits are kept in chunks of kChunkBits
+// that are only allocated once one of their bits is set, so the per-block
+// sets of the dataflow analyses, which are sized by every symbol or copy
+// in the function but usually hold few of them, take space in proportion
+// to what they hold.  Within a chunk the operations are plain loops over
+// 64-bit words.
+//
 class BitVec {
 public:
-  unsigned* data;
-  size_t    in_size;
-  size_t    ndata;
+  typedef uint64_t Word;
 
+  static const size_t kWordBits   = 64;
+  static const size_t kChunkWords = 16;
+  static const size_t kChunkBits  = kWordBits * kChunkWords;
 
          BitVec(size_t in_size);
          BitVec(const BitVec& rhs);
@@ -43,6 +53,7 @@ public:
 
   void   disjunction(const BitVec& other);
   void   intersection(const BitVec& other);
+  void   difference(const BitVec& other);
 
   void   operator =  (const BitVec& other) { this->copy(other);         }
 
@@ -50,7 +61,7 @@ public:
   void   operator |= (const BitVec& other) { this->disjunction(other);  }
   void   operator += (const BitVec& other) { this->disjunction(other);  }
   void   operator &= (const BitVec& other) { this->intersection(other); }
-  void   operator -= (const BitVec& other);
+  void   operator -= (const BitVec& other) { this->difference(other);   }
 
   // Added functionality to make this compatible with std::bitset and thus
   // boosts dynamic bitset if that gets into the STL, or we start using boost
@@ -75,16 +86,24 @@ public:
 
   bool   any()                                                       const;
   bool   none()                                                      const;
-};
-
-inline void BitVec::operator-=(const BitVec& other)
-{
-  BitVec not_other(other);
 
-  not_other.flip();
-
-  this->intersection(not_other);
-}
+  // For the dataflow solvers, which combine sets a chunk at a time.
+  // chunk() is NULL when no bit in the chunk is set.  setChunk() copies
+  // kChunkWords words into the chunk, or clears it if 'words' is NULL,
+  // and returns whether that changed any bit.
+  size_t      numChunks()                       const { return nchunks;   }
+  const Word* chunk(size_t c)                   const { return chunks[c]; }
+  bool        setChunk(size_t c, const Word* words);
+
+private:
+  Word**  chunks;
+  size_t  nchunks;
+  size_t  in_size;
+
+  Word*  ensureChunk(size_t c);
+  void   freeChunk(size_t c);
+  void   maskLastChunk();
+};
 
 inline bool operator==(const BitVec& a, const BitVec& b)
 {
@@ -122,10 +141,9 @@ inline BitVec operator+(const BitVec& a, const BitVec& b)
 
 inline BitVec operator-(const BitVec& a, const BitVec& b)
 {
-  BitVec result(b);
+  BitVec result(a);
 
-  result.flip();
-  result.intersection(a);
+  result.difference(b);
 
   return result;
 }
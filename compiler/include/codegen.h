@@ -77,6 +77,8 @@ struct LoopData
 /* Holds names of files used by LLVM codegen. */
 struct LLVMGenFilenames {
   std::string moduleFilename;
+  // the objects for the other partitions when code generation is split
+  std::vector<std::string> extraModuleFilenames;
   std::string preOptFilename;
   std::string opt1Filename;
   std::string opt2Filename;
@@ -202,6 +204,16 @@ const char* idCommentTemp(BaseAST* ast);
 void genComment(const char* comment, bool push=false);
 void flushStatements(void);
 
+// Position of 'fn' in the Chapel symbol table when --profile-functions
+// instruments it, otherwise -1.
+int getFunctionProfileIndex(FnSymbol* fn);
+void codegenFunctionProfileEnter(FnSymbol* fn);
+void codegenFunctionProfileExit(FnSymbol* fn);
+
+// With CHPL_GPU=cpu, the runtime calls a kernel that runs on the host
+// (FLAG_GPU_HOST_KERNEL) through a function of this name.
+const char* gpuHostKernelEntryName(FnSymbol* fn);
+
 GenRet codegenCallExpr(const char* fnName);
 GenRet codegenCallExpr(const char* fnName, GenRet a1);
 GenRet codegenCallExpr(const char* fnName, GenRet a1, GenRet a2);
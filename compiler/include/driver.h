@@ -44,6 +44,7 @@ extern bool fNoGlobalConstOpt;
 extern bool fNoFastFollowers;
 extern bool fNoInlineIterators;
 extern bool fNoLoopInvariantCodeMotion;
+extern bool fNoLoopStrideSpecialization;
 extern bool fNoInterproceduralAliasAnalysis;
 extern bool fNoInline;
 extern bool fNoLiveAnalysis;
@@ -58,8 +59,10 @@ extern bool fNoConstArgChecks;
 extern bool fNoDivZeroChecks;
 extern bool fMungeUserIdents;
 extern bool fEnableTaskTracking;
+extern bool fProfileFunctions;
 extern bool fEnableMemInterleaving;
 extern bool fLLVMWideOpt;
+extern int fLlvmCodegenThreads;
 
 extern bool fAutoLocalAccess;
 extern bool fDynamicAutoLocalAccess;
@@ -68,11 +71,20 @@ extern bool fReportAutoLocalAccess;
 extern bool fAutoAggregation;
 extern bool fReportAutoAggregation;
 
+extern bool fAutoBulkTransfer;
+extern bool fReportAutoBulkTransfer;
+extern int fPrefetchDistance;
+
 extern bool fNoRemoteValueForwarding;
+extern bool fNoDevirtualize;
+extern bool fNoInferUnlockedChannels;
+extern bool fNoSmallRecordReturns;
 extern bool fNoInferConstRefs;
 extern bool fNoRemoteSerialization;
 extern bool fNoRemoveCopyCalls;
 extern bool fNoScalarReplacement;
+extern bool fNoStackAllocateClasses;
+extern bool fNoBoundsCheckElim;
 extern bool fNoTupleCopyOpt;
 extern bool fNoOptimizeRangeIteration;
 extern bool fNoOptimizeLoopIterators;
@@ -84,6 +96,7 @@ extern bool fNoRemoveEmptyRecords;
 extern bool fNoInferLocalFields;
 extern bool fRemoveUnreachableBlocks;
 extern bool fReplaceArrayAccessesWithRefTemps;
+extern bool fReorderRecordFields;
 extern int  optimize_on_clause_limit;
 extern int  scalar_replace_limit;
 extern int  inline_iter_yield_limit;
@@ -153,6 +166,8 @@ extern const char* CHPL_GPU_ARCH;
 
 extern bool  printPasses;
 extern FILE* printPassesFile;
+// --compile-profile output prefix, or empty
+extern std::string gCompileProfile;
 
 extern char fExplainCall[256];
 extern int  explainCallID;
@@ -169,6 +184,9 @@ extern bool fDriverCompilationPhase;
 extern bool fDriverMakeBinaryPhase;
 extern char driverTmpDir[FILENAME_MAX];
 // end compiler driver control flags
+extern char fProfileGenerateDir[FILENAME_MAX+1];
+extern char fProfileUsePath[FILENAME_MAX+1];
+extern bool fRuntimeLTO;
 extern bool fPrintAllCandidates;
 extern bool fPrintCallGraph;
 extern bool fPrintCallStackOnError;
@@ -178,6 +196,7 @@ extern bool fPrintModuleResolution;
 extern bool fPrintEmittedCodeSize;
 extern char fPrintStatistics[256];
 extern bool fPrintDispatch;
+extern bool fPrintRecordLayouts;
 extern bool fPrintUnusedFns;
 extern bool fPrintUnusedInternalFns;
 extern bool fRegionVectorizer;
@@ -248,6 +267,7 @@ extern bool fReportBlocking;
 extern bool fReportOptimizedLoopIterators;
 extern bool fReportInlinedIterators;
 extern bool fReportVectorizedLoops;
+extern bool fReportVectorization;
 extern bool fReportOptimizedOn;
 extern bool fReportPromotion;
 extern bool fReportScalarReplace;
@@ -265,6 +285,7 @@ extern bool specializeCCode;
 extern bool fNoMemoryFrees;
 extern int  numGlobalsOnHeap;
 extern bool preserveInlinedLineNumbers;
+extern bool fNoPropagateLineNumbers;
 
 extern int breakOnID;
 extern int breakOnRemoveID;
@@ -274,6 +295,7 @@ const int gpuArchNameLen = 256;
 extern char fGpuArch[gpuArchNameLen+1];
 extern bool fGpuPtxasEnforceOpt;
 extern bool fGpuSpecialization;
+extern bool fGpuFuseLoops;
 extern const char* gGpuSdkPath;
 extern std::set<std::string> gpuArches;
 
@@ -289,14 +311,17 @@ extern char compileVersion[64];
 extern bool fMinimalModules;
 
 // This flag sets the make -j value
-// <=0 == don't use -j
-//        (in the future, we may want to make < 0 mean "#cores")
+// <=0 == don't use -j, except with --incremental, which uses #cores
+//        unless an enclosing make's jobserver is available
 //  >0 == make -j <val>
 extern int fParMake;
 
 // Set to true if we want to enable incremental compilation.
 extern bool fIncrementalCompilation;
 
+// Directory caching the object files of incremental compilations
+extern char fIncrementalCacheDir[FILENAME_MAX+1];
+
 // LLVM flags (-mllvm)
 extern std::string llvmFlags;
 extern std::string llvmRemarksFilters;
@@ -329,6 +354,9 @@ extern std::vector<std::string> gDynoPrependInternalModulePaths;
 extern std::vector<std::string> gDynoPrependStandardModulePaths;
 
 extern std::string gDynoGenLibOutput;
+extern bool gDynoGenStdLib;
+extern std::string gDynoStdLibCacheDir;
+extern std::string gDynoStdLibCachePath;
 extern std::vector<UniqueString> gDynoGenLibSourcePaths;
 extern std::unordered_set<const char*> gDynoGenLibModuleNameAstrs;
 
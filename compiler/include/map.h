@@ -302,11 +302,9 @@ HashMap<K,AHashFns,C>::get_internal(K akey) {
           return c;
     return 0;
   }
-  unsigned int h = AHashFns::hash(akey);
-  h = h % n;
-  for (int k = h, j = 0;
-       k < n && j < SET_MAX_PROBE;
-       k = ((k + ++j) % n))
+  for (int k = _vec_hash_slot(AHashFns::hash(akey), n), j = 0;
+       j < SET_MAX_PROBE;
+       k = _vec_probe_next(k, n), j++)
   {
     if (!v[k].key)
       return 0;
@@ -340,11 +338,9 @@ HashMap<K,AHashFns,C>::put(K akey, C avalue) {
       return &v[n-1];
     }
     if (n > VEC_INTEGRAL_SIZE) {
-      unsigned int h = AHashFns::hash(akey);
-      h = h % n;
-      for (int k = h, j = 0;
-           k < n && j < SET_MAX_PROBE;
-           k = ((k + ++j) % n))
+      for (int k = _vec_hash_slot(AHashFns::hash(akey), n), j = 0;
+           j < SET_MAX_PROBE;
+           k = _vec_probe_next(k, n), j++)
       {
         if (!v[k].key) {
           v[k].key = akey;
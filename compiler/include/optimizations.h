@@ -62,6 +62,8 @@ void cleanupLoopBlocks(FnSymbol* fn);
 void deadVariableElimination(FnSymbol* fn);
 void deadExpressionElimination(FnSymbol* fn);
 
+void devirtualizeMethodCalls();
+
 bool outlivesBlock(LifetimeInformation* info, Symbol* sym, BlockStmt* block);
 
 void checkLifetimesForForallUnorderedOps(FnSymbol* fn,
@@ -78,6 +80,11 @@ void liveVariableAnalysis(FnSymbol* fn,
 
 void remoteValueForwarding();
 
+void reorderRecordFields();
+// Size and alignment of 't' as the backend would lay it out, with class
+// fields counted as local pointers; false if it can't be determined.
+bool estimateTypeLayout(Type* t, uint64_t& size, uint64_t& align);
+
 void inferConstRefs();
 
 void computeNoAliasSets();
@@ -92,6 +99,16 @@ void setDefinedConstForDefExprIfApplicable(DefExpr* defExpr,
 void setDefinedConstForPrimSetMemberIfApplicable(CallExpr *call);
 void setDefinedConstForFieldsInInitializer(FnSymbol *fn);
 
+void simplifyZipperedLoops();
+
+void splitSoaArrays();
+
+void specializeLoopStrides();
+
+void stackAllocateClasses();
+
+void inferUnlockedChannels();
+
 void earlyGpuTransforms();
 bool isLoopGpuBound(CForLoop* loop);
 void lateGpuTransforms();
@@ -201,6 +201,14 @@ class AddModuleInitBlocks : public PassT<ModuleSymbol*> {
  public:
   bool shouldProcess(ModuleSymbol* mod) override;
   void process(ModuleSymbol* mod) override;
+
+ private:
+  static std::vector<ModuleSymbol*> initDependencies(ModuleSymbol* mod);
+  const std::set<ModuleSymbol*>& initializedBy(ModuleSymbol* mod);
+
+  // caches the modules each module's initializer initializes, directly
+  // or through the initializers it calls
+  std::map<ModuleSymbol*, std::set<ModuleSymbol*>> initializedByCache;
 };
 
 /**
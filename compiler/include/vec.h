@@ -63,8 +63,8 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #define VEC_INITIAL_SIZE        (1 << VEC_INITIAL_SHIFT)
 
 #define SET_LINEAR_SIZE         4               /* must be <= than VEC_INTEGRAL_SIZE */
-#define SET_MAX_PROBE           5
-#define SET_INITIAL_INDEX       2
+#define SET_MAX_PROBE           8
+#define SET_INITIAL_INDEX       3               /* log2 of the first hashed size */
 
 // Do not define the generic variation of _vec_hasher, requiring us to write
 // a _vec_hasher for potential types.
@@ -80,11 +80,24 @@ uintptr_t _vec_hasher(unsigned int obj);
 template<>
 uintptr_t _vec_hasher(int obj);
 
+// Hashed sets (and the Maps built on them) have a power of 2 number of
+// slots and are probed linearly, so that a probe sequence stays within a
+// cache line or two.  The hashers return e.g. sequential AST ids, so
+// pick the slot from the high bits of a Fibonacci hash.
+static inline int _vec_hash_slot(uintptr_t h, int n) {
+  uint64_t x = (uint64_t)h * 0x9E3779B97F4A7C15ull;
+  return n > 1 ? (int)(x >> (64 - __builtin_ctz(n))) : 0;
+}
+
+static inline int _vec_probe_next(int k, int n) {
+  return (k + 1) & (n - 1);
+}
+
 template <class C, int S = VEC_INTEGRAL_SIZE>  // S must be a power of 2
 class Vec {
  public:
   int           n;
-  int           i;      // size index for sets
+  int           i;      // log2 of the size for hashed sets
   C             *v;
   C             e[S];
 
@@ -484,7 +497,7 @@ Vec<C,S>::set_expand() {
     i = SET_INITIAL_INDEX;
   else
     i = i + 1;
-  n = prime2[i];
+  n = 1 << i;
   v = (C*)malloc(n * sizeof(C));
   memset((void*)v, 0, n * sizeof(C));
 }
@@ -493,11 +506,9 @@ template <class C, int S> C *
 Vec<C,S>::set_add_internal(C c) {
   int j, k;
   if (n) {
-    uintptr_t h = _vec_hasher(c);
-    h = h % n;
-    for (k = h, j = 0;
-         k < n && j < SET_MAX_PROBE;
-         k = ((k + ++j) % n))
+    for (k = _vec_hash_slot(_vec_hasher(c), n), j = 0;
+         j < SET_MAX_PROBE;
+         k = _vec_probe_next(k, n), j++)
     {
       if (!v[k]) {
         v[k] = c;
@@ -518,11 +529,9 @@ template <class C, int S> C *
 Vec<C,S>::set_in_internal(C c) {
   int j, k;
   if (n) {
-    uintptr_t h = _vec_hasher(c);
-    h = h % n;
-    for (k = h, j = 0;
-         k < n && j < SET_MAX_PROBE;
-         k = ((k + ++j) % n))
+    for (k = _vec_hash_slot(_vec_hasher(c), n), j = 0;
+         j < SET_MAX_PROBE;
+         k = _vec_probe_next(k, n), j++)
     {
       if (!v[k])
         return 0;
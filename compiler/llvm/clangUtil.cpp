@@ -32,6 +32,8 @@
 #include <sstream>
 #include <fstream>
 #include <regex>
+#include <set>
+#include <tuple>
 
 #ifdef HAVE_LLVM
 #include "clang/AST/GlobalDecl.h"
@@ -52,10 +54,15 @@
 #include "clang/Lex/Preprocessor.h"
 
 #include "llvm/ADT/APFloat.h"
+#include "llvm/Analysis/ModuleSummaryAnalysis.h"
+#include "llvm/Analysis/ProfileSummaryInfo.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/Analysis/TargetTransformInfo.h"
 #include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/CodeGen/ParallelCG.h"
+#include "llvm/IR/DiagnosticHandler.h"
+#include "llvm/IR/DiagnosticInfo.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Verifier.h"
 #include "llvm/IRReader/IRReader.h"
@@ -2243,6 +2250,94 @@ static void llvmRunOptimizations(void);
 static void llvmEmitObjectFile(void);
 static void checkLoopsAssertVectorize(void);
 
+#ifdef HAVE_LLVM
+// Collects the remarks of the loop vectorizer, so that
+// --report-vectorization can show why each loop did or did not vectorize.
+// Other diagnostics get the default handling.
+class VectorizationRemarkHandler : public llvm::DiagnosticHandler {
+ public:
+  struct Remark {
+    const llvm::Function* fn;
+    std::string file;   // empty if there is no debug info
+    unsigned line;
+    std::string msg;
+
+    bool operator<(const Remark& other) const {
+      return std::tie(file, line, fn, msg) <
+             std::tie(other.file, other.line, other.fn, other.msg);
+    }
+  };
+
+  std::set<Remark> remarks;
+
+  static bool isVectorizerPass(llvm::StringRef passName) {
+    return passName == "loop-vectorize";
+  }
+
+  bool isAnalysisRemarkEnabled(llvm::StringRef passName) const override {
+    return isVectorizerPass(passName);
+  }
+  bool isMissedOptRemarkEnabled(llvm::StringRef passName) const override {
+    return isVectorizerPass(passName);
+  }
+  bool isPassedOptRemarkEnabled(llvm::StringRef passName) const override {
+    return isVectorizerPass(passName);
+  }
+  bool isAnyRemarkEnabled() const override {
+    return true;
+  }
+
+  bool handleDiagnostics(const llvm::DiagnosticInfo& DI) override {
+    auto remark = llvm::dyn_cast<llvm::DiagnosticInfoOptimizationBase>(&DI);
+    if (remark == nullptr || !isVectorizerPass(remark->getPassName())) {
+      return false;
+    }
+
+    Remark r;
+    r.fn = &remark->getFunction();
+    r.line = 0;
+    if (remark->isLocationAvailable()) {
+      llvm::StringRef path;
+      unsigned col = 0;
+      remark->getLocation(path, r.line, col);
+      r.file = path.str();
+    }
+    r.msg = remark->getMsg();
+    remarks.insert(r);
+    return true;
+  }
+};
+
+// Print the collected remarks for loops in user code. Remarks for the same
+// source line are printed once even if the loop was cloned or inlined.
+static void reportVectorizationRemarks(VectorizationRemarkHandler* handler) {
+  GenInfo* info = gGenInfo;
+  INT_ASSERT(info);
+
+  std::set<std::tuple<std::string, unsigned, std::string>> printed;
+  for (const auto& r : handler->remarks) {
+    const char* cname = astr(r.fn->getName().str());
+    auto funcIt = info->functionCNameAstrToSymbol.find(cname);
+    if (funcIt == info->functionCNameAstrToSymbol.end()) continue;
+
+    FnSymbol* fn = funcIt->second;
+    if (!developer && fn->getModule()->modTag != MOD_USER) continue;
+
+    const char* where = r.file.empty() ? fn->name : r.file.c_str();
+    if (!printed.insert(std::make_tuple(where, r.line, r.msg)).second) {
+      continue;
+    }
+
+    // use debug info if available to specify the loop
+    if (r.file.empty()) {
+      USR_PRINT(fn, "loop: %s", r.msg.c_str());
+    } else {
+      USR_PRINT(fn, "loop on line %u: %s", r.line, r.msg.c_str());
+    }
+  }
+}
+#endif
+
 void finishCodegenLLVM() {
   GenInfo* info = gGenInfo;
 
@@ -2286,10 +2381,29 @@ void finishCodegenLLVM() {
     }
   }
 
+#ifdef HAVE_LLVM
+  // Collect the loop vectorizer's remarks while optimizing, restoring the
+  // previous handler afterwards.
+  std::unique_ptr<llvm::DiagnosticHandler> savedDiagHandler;
+  VectorizationRemarkHandler* remarkHandler = nullptr;
+  if (fReportVectorization) {
+    savedDiagHandler = info->llvmContext.getDiagnosticHandler();
+    remarkHandler = new VectorizationRemarkHandler();
+    info->llvmContext.setDiagnosticHandler(
+      std::unique_ptr<llvm::DiagnosticHandler>(remarkHandler));
+  }
+#endif
+
   // Run all LLVM optimizations.
   llvmRunOptimizations();
 
 #ifdef HAVE_LLVM
+  if (remarkHandler) {
+    reportVectorizationRemarks(remarkHandler);
+    // this deletes remarkHandler
+    info->llvmContext.setDiagnosticHandler(std::move(savedDiagHandler));
+  }
+
   checkLoopsAssertVectorize();
 #endif
 }
@@ -2361,6 +2475,34 @@ llvm::PipelineTuningOptions createPipelineOptions(bool forFunctionPasses) {
 }
 #endif
 
+static std::string findSiblingClangToolPath(const std::string &toolName);
+
+// Each process of an instrumented program writes its own raw profile,
+// named by host and pid so that the locales of a multilocale run don't
+// overwrite each other.
+static std::string getProfileGenerateFile() {
+  return std::string(fProfileGenerateDir) + "/chpl-%h-%p.profraw";
+}
+
+// --profile-use takes an indexed profile, or a --profile-generate
+// directory whose raw profiles are merged into one first.
+static std::string getProfileUseFile() {
+  static std::string merged;
+
+  if (!isDirectory(fProfileUsePath))
+    return fProfileUsePath;
+
+  if (merged.empty()) {
+    merged = genIntermediateFilename("chpl.profdata");
+    std::string cmd = findSiblingClangToolPath("llvm-profdata") +
+                      " merge -o " + merged + " " +
+                      fProfileUsePath + "/*.profraw";
+    mysystem(cmd.c_str(), "merging execution profiles");
+  }
+
+  return merged;
+}
+
 // This has code based on clang's EmitAssemblyHelper::CreatePasses
 // in BackendUtil.cpp.
 static
@@ -2391,6 +2533,16 @@ void configurePMBuilder(PassManagerBuilder &PMBuilder, bool forFunctionPasses, i
 
   PMBuilder.OptLevel = optLevel;
   PMBuilder.SizeLevel = CodeGenOpts.OptimizeSize;
+
+  if (!forFunctionPasses && !gCodegenGPU) {
+    if (fProfileGenerateDir[0]) {
+      PMBuilder.EnablePGOInstrGen = true;
+      PMBuilder.PGOInstrGen = getProfileGenerateFile();
+    } else if (fProfileUsePath[0]) {
+      PMBuilder.PGOInstrUse = getProfileUseFile();
+    }
+    PMBuilder.PrepareForThinLTO = fRuntimeLTO;
+  }
   PMBuilder.SLPVectorize = CodeGenOpts.VectorizeSLP;
   PMBuilder.LoopVectorize = CodeGenOpts.VectorizeLoop;
   PMBuilder.CallGraphProfile = !CodeGenOpts.DisableIntegratedAS;
@@ -2448,7 +2600,16 @@ static void runModuleOptPipeline(bool addWideOpts) {
                               /* DebugLogging */ false);
   SI.registerCallbacks(PIC, &FAM);
 
+  // GPU kernels aren't instrumented; they'd need a device profile runtime.
   chpl::optional<PGOOptions> PGOOpt;
+  if (!gCodegenGPU) {
+    if (fProfileGenerateDir[0]) {
+      PGOOpt = PGOOptions(getProfileGenerateFile(), "", "",
+                          PGOOptions::IRInstr);
+    } else if (fProfileUsePath[0]) {
+      PGOOpt = PGOOptions(getProfileUseFile(), "", "", PGOOptions::IRUse);
+    }
+  }
   PassBuilder PB(info->targetMachine, createPipelineOptions(false),
                  PGOOpt, &PIC);
 
@@ -2483,6 +2644,10 @@ static void runModuleOptPipeline(bool addWideOpts) {
   ModulePassManager MPM;
   if (optLvl == LlvmOptimizationLevel::O0) {
     MPM = PB.buildO0DefaultPipeline(optLvl);
+  } else if (fRuntimeLTO && !gCodegenGPU) {
+    // leave the rest of the pipeline to the link, where the runtime
+    // bitcode is available for importing and inlining
+    MPM = PB.buildThinLTOPreLinkDefaultPipeline(optLvl);
   } else {
     MPM = PB.buildPerModuleDefaultPipeline(optLvl);
   }
@@ -4927,7 +5092,8 @@ void makeBinaryLLVM(void) {
     expandInstallationPaths(clangLDArgs);
 
 
-    std::vector<std::string> dotOFiles;
+    // the other partitions of the generated code, if it was split
+    std::vector<std::string> dotOFiles = filenames->extraModuleFilenames;
 
     // Gather C flags for compiling C files.
     std::string cargs;
@@ -4994,6 +5160,24 @@ void makeBinaryLLVM(void) {
     options += " ";
     options += ldflags;
 
+    // With --runtime-lto the backend runs at link time, so it needs the
+    // optimization and CPU flags the generated code was compiled with.
+    if (fRuntimeLTO) {
+      options += " -flto=thin";
+      for (const auto& arg : clangInfo->clangCCArgs) {
+        if (startsWith(arg.c_str(), "-O") ||
+            startsWith(arg.c_str(), "-march=") ||
+            startsWith(arg.c_str(), "-mcpu=")) {
+          options += " " + arg;
+        }
+      }
+      // the system linker often can't read bitcode, so prefer lld
+      std::string lld = findSiblingClangToolPath("ld.lld");
+      if (useLinkCXX == clangCXX && lld != "ld.lld") {
+        options += " -fuse-ld=lld";
+      }
+    }
+
     // We may need to add the -pthread flag here for the link step
     // if we start doing link-time optimization.  For now, leave it
     // out because its unnecessary inclusion causes a warning message
@@ -5064,6 +5248,95 @@ void makeBinaryLLVM(void) {
 }
 
 // Generate .o file from a completed LLVM Module
+static bool shouldSplitCodegen() {
+#if HAVE_LLVM_VER >= 110
+  // --llvm-print-ir-stage=asm prints from the one object file
+  // with --runtime-lto the link does the backend work, already in parallel
+  return fLlvmCodegenThreads > 1 && !fRuntimeLTO &&
+         llvmPrintIrStageNum != llvmStageNum::ASM &&
+         llvmPrintIrStageNum != llvmStageNum::EVERY;
+#else
+  return false;
+#endif
+}
+
+// Emit the optimized module as fLlvmCodegenThreads object files, in
+// parallel. The module is split after all optimizations (including the
+// global-to-wide ones) have run, so the partitions only need to agree on
+// symbol names, which splitCodeGen handles by externalizing locals that
+// are shared between partitions. The first partition goes to the usual
+// module object file and the others are linked in beside it.
+static void llvmEmitSplitObjectFiles(llvm::sys::fs::OpenFlags flags) {
+#if HAVE_LLVM_VER >= 110
+  GenInfo* info = gGenInfo;
+  LLVMGenFilenames* filenames = &info->llvmGenFilenames;
+  llvm::TargetMachine* tm = info->targetMachine;
+
+  std::vector<std::string> names;
+  names.push_back(filenames->moduleFilename);
+  for (int i = 1; i < fLlvmCodegenThreads; i++) {
+    std::string name = "chpl__module." + std::to_string(i) + ".o";
+    names.push_back(genIntermediateFilename(name.c_str()));
+  }
+
+  std::vector<std::unique_ptr<llvm::raw_fd_ostream>> files;
+  std::vector<llvm::raw_pwrite_stream*> outs;
+  for (const auto& name : names) {
+    std::error_code error;
+    files.emplace_back(new llvm::raw_fd_ostream(name, error, flags));
+    if (error || files.back()->has_error())
+      USR_FATAL("Could not open output file %s", name.c_str());
+    outs.push_back(files.back().get());
+  }
+
+  // each thread needs its own TargetMachine
+  auto makeTargetMachine = [tm]() {
+    return std::unique_ptr<llvm::TargetMachine>(
+      tm->getTarget().createTargetMachine(tm->getTargetTriple().str(),
+                                          tm->getTargetCPU(),
+                                          tm->getTargetFeatureString(),
+                                          tm->Options,
+                                          tm->getRelocationModel(),
+                                          tm->getCodeModel(),
+                                          tm->getOptLevel()));
+  };
+
+  llvm::splitCodeGen(*info->module, outs, {}, makeTargetMachine,
+                     llvm::CGFT_ObjectFile);
+
+  for (auto& file : files) {
+    file->close();
+  }
+
+  filenames->extraModuleFilenames.assign(names.begin() + 1, names.end());
+#endif
+}
+
+// With --runtime-lto the module is written as bitcode with a ThinLTO
+// summary, under the usual object file name, so that the link can import
+// the runtime's fast paths (e.g. chpl_task_getInfoChapel or the
+// chpl-cache and chpl_mem_* entry points) and inline them into user code.
+static void llvmEmitThinLTOBitcodeFile(llvm::sys::fs::OpenFlags flags) {
+  GenInfo* info = gGenInfo;
+  LLVMGenFilenames* filenames = &info->llvmGenFilenames;
+
+  std::error_code error;
+  llvm::raw_fd_ostream output(filenames->moduleFilename, error, flags);
+  if (error || output.has_error())
+    USR_FATAL("Could not open output file %s",
+              filenames->moduleFilename.c_str());
+
+  llvm::ProfileSummaryInfo PSI(*info->module);
+  llvm::ModuleSummaryIndex index =
+    llvm::buildModuleSummaryIndex(*info->module, nullptr, &PSI);
+
+  llvm::WriteBitcodeToFile(*info->module, output,
+                           /* ShouldPreserveUseListOrder */ false,
+                           &index,
+                           /* GenerateHash */ true);
+  output.close();
+}
+
 static void llvmEmitObjectFile(void) {
   GenInfo* info = gGenInfo;
   INT_ASSERT(info);
@@ -5091,7 +5364,13 @@ static void llvmEmitObjectFile(void) {
 
     bool disableVerify = !developer;
 
-    if (gCodegenGPU == false) {
+    if (gCodegenGPU == false && shouldSplitCodegen()) {
+      llvmEmitSplitObjectFiles(flags);
+
+    } else if (gCodegenGPU == false && fRuntimeLTO) {
+      llvmEmitThinLTOBitcodeFile(flags);
+
+    } else if (gCodegenGPU == false) {
       llvm::raw_fd_ostream outputOfile(filenames->moduleFilename, error, flags);
       if (error || outputOfile.has_error())
         USR_FATAL("Could not open output file %s", filenames->moduleFilename.c_str());
@@ -41,6 +41,10 @@
 // a few elements - MemCpyOptimizer might decide it's better
 // to load/store to inline the memcpy for example, or the
 // code generator might have started with loads and stores.
+//
+// Loads are merged across loads from other objects and across writes to
+// local temporaries that no wide pointer can refer to, so that reading
+// several fields of a remote record one at a time still turns into one get.
 
 // This code was based upon the LLVM optimization MemCpyOptimizer.cpp
 // TODO: MemCpyOptimizer has evolved quite a bit since then,
@@ -59,6 +63,7 @@
 
 #include "llvm/IR/BasicBlock.h"
 #include "llvm/IR/InstIterator.h"
+#include "llvm/IR/IntrinsicInst.h"
 
 #if HAVE_LLVM_VER < 90
 #include "llvm/IR/CallSite.h"
@@ -67,6 +72,7 @@
 #include "llvm/IR/Verifier.h"
 
 #include "llvm/Analysis/CallGraph.h"
+#include "llvm/Analysis/CaptureTracking.h"
 #include "llvm/Analysis/LazyCallGraph.h"
 #include "llvm/Analysis/ValueTracking.h"
 #include "llvm/Transforms/Utils/ValueMapper.h"
@@ -134,20 +140,60 @@ Value* getLoadStorePointer(Instruction* I)
   return NULL;
 }
 
+// Does I only write to a stack temporary whose address never escapes?
+// No wide pointer can refer to such memory, so the write can't change
+// what a later global load returns. This lets loads of several fields of
+// a remote record be merged even when the code copies each field into a
+// local as it goes.
+static bool onlyWritesUncapturedAlloca(Instruction* I, const DataLayout& DL)
+{
+  Value* ptr = NULL;
+  if (StoreInst* store = dyn_cast<StoreInst>(I)) {
+    if (!store->isSimple()) return false;
+    ptr = store->getPointerOperand();
+  } else if (MemIntrinsic* mi = dyn_cast<MemIntrinsic>(I)) {
+    if (mi->isVolatile()) return false;
+    ptr = mi->getRawDest();
+  } else if (IntrinsicInst* ii = dyn_cast<IntrinsicInst>(I)) {
+    if (ii->getIntrinsicID() != Intrinsic::lifetime_start &&
+        ii->getIntrinsicID() != Intrinsic::lifetime_end)
+      return false;
+    ptr = ii->getArgOperand(1);
+  } else {
+    return false;
+  }
+
+#if HAVE_LLVM_VER >= 120
+  const Value* obj = getUnderlyingObject(ptr);
+#else
+  const Value* obj = GetUnderlyingObject(ptr, DL);
+#endif
+  const AllocaInst* alloca = dyn_cast<AllocaInst>(obj);
+  if (alloca == NULL) return false;
+
+  return !PointerMayBeCaptured(alloca,
+                               /* ReturnCaptures */ true,
+                               /* StoreCaptures */ true);
+}
+
 // Given a start and end load/store instruction (in the same basic block),
 // reorder the instructions so that any uses of loaded values are
-// after Last.
+// after Last. Once a memory write has been moved, later local memory
+// operations are moved with it so that they stay in order; global loads
+// can't alias the temporaries those writes go to.
 // Returns the last instruction in the reordering.
 static
 Instruction* postponeDependentInstructions(
    Instruction *First,
    Instruction *Last,
    const SmallSet<Instruction*, 8>& toAggregate,
+   unsigned globalSpace,
    bool DebugThis)
 {
   // memopsUses stores uses of toAggregate
   SmallPtrSet<Instruction*, 8> memopsUses;
   Instruction *LastMemopUse = NULL;
+  bool postponedWrite = false;
 
   // Gather any instructions using the result of a load
   for (BasicBlock::iterator BI = First->getIterator();
@@ -170,7 +216,15 @@ Instruction* postponeDependentInstructions(
       }
     }
 
-    if( isUseOfMemop ) memopsUses.insert(insn);
+    if( postponedWrite && insn->mayReadOrWriteMemory() &&
+        !isMergeableGlobalLoadOrStore(insn, globalSpace, true, false) ) {
+      isUseOfMemop = true;
+    }
+
+    if( isUseOfMemop ) {
+      memopsUses.insert(insn);
+      if( insn->mayWriteToMemory() ) postponedWrite = true;
+    }
 
     if( insn == Last ) break;
   }
@@ -541,7 +595,9 @@ Instruction *AggregateGlobalOpsOpt::tryAggregating(Instruction *StartInst, Value
       // If the instruction is readnone, ignore it, otherwise bail out.  We
       // don't even allow readonly here because we don't want something like:
       // A[1] = 2; strlen(A); A[2] = 2; -> memcpy(A, ...); strlen(A).
-      if (BI->mayWriteToMemory())
+      // Loads can also continue past writes to local temporaries.
+      if (BI->mayWriteToMemory() &&
+          !(isLoad && onlyWritesUncapturedAlloca(insn, *DL)))
         break;
       if (isStore && BI->mayReadFromMemory())
         break;
@@ -573,16 +629,17 @@ Instruction *AggregateGlobalOpsOpt::tryAggregating(Instruction *StartInst, Value
       if (!NextLoad->isSimple()) break;
 
       // Check to see if this load is to a constant offset from the start ptr.
+      // A load from some other object can't interfere, so keep going.
 #if HAVE_LLVM_VER >= 100
       chpl::optional<int64_t> optOffset =
         isPointerOffset(StartPtr, NextLoad->getPointerOperand(), *DL);
       if (!optOffset)
-        break;
+        continue;
       int64_t Offset = *optOffset;
 #else
       int64_t Offset;
       if (!IsPointerOffset(StartPtr, NextLoad->getPointerOperand(), Offset, *DL))
-        break;
+        continue;
 #endif
 
       Ranges.addLoad(Offset, NextLoad);
@@ -671,7 +728,8 @@ Instruction *AggregateGlobalOpsOpt::tryAggregating(Instruction *StartInst, Value
 
     // Move any instructions between First and Last that depend on
     // the loaded values to just after Last.
-    postponeDependentInstructions(First, Last, toAggregate, DebugThis);
+    postponeDependentInstructions(First, Last, toAggregate, globalSpace,
+                                  DebugThis);
 
     // Compute the insert point for the new instructions
     // - just before the last load/store (which will be removed)
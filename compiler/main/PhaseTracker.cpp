@@ -22,6 +22,9 @@
 
 #include "baseAST.h"
 #include "driver.h"
+#include "stringutil.h"
+
+#include "chpl/framework/Context.h"
 
 #include <cstdlib>
 #include <cstring>
@@ -52,7 +55,8 @@ static void PassesReport(FILE*                    fp,
 
 PhaseTracker::PhaseTracker()
 {
-  mPhaseId = 0;
+  mPhaseId        = 0;
+  mInProfileFrame = false;
 
   mTimer.start();
   StartPhase("startup");
@@ -86,11 +90,35 @@ void PhaseTracker::StartPhase(const char* name,
   Phase* phase = new Phase(name, passId, subPhase, mTimer.elapsedUsecs());
 
   mPhases.push_back(phase);
+
+  // Also record the phase in the frontend's profile, so that the
+  // queries run during it are nested within it.
+  if (mInProfileFrame) {
+    gContext->profileEnd();
+    mInProfileFrame = false;
+  }
+
+  if (gContext != NULL && gContext->isProfiling()) {
+    const char* frameName = astr(name);
+
+    if (subPhase == kVerify)
+      frameName = astr(name, " (verify)");
+    else if (subPhase == kCleanAst)
+      frameName = astr(name, " (cleanAst)");
+
+    gContext->profileBegin(frameName);
+    mInProfileFrame = true;
+  }
 }
 
 void PhaseTracker::Stop()
 {
   mTimer.stop();
+
+  if (mInProfileFrame) {
+    gContext->profileEnd();
+    mInProfileFrame = false;
+  }
 }
 
 void PhaseTracker::Resume()
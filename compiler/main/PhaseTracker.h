@@ -109,6 +109,10 @@ private:
   Timer                mTimer;
   int                  mPhaseId;
   std::vector<Phase*>  mPhases;
+
+  // Whether a frame for the current phase is open in gContext's
+  // profile (see --compile-profile)
+  bool                 mInProfileFrame;
 };
 
 // Used to collect the times as the program runs
@@ -52,6 +52,7 @@
 
 #include "chpl/util/assertions.h"
 
+#include <fstream>
 #include <string>
 #include <map>
 #include <regex>
@@ -149,6 +150,9 @@ bool fDriverMakeBinaryPhase = false;
 bool driverDebugPhaseSpecified = false;
 // Tmp dir path managed by compiler driver
 char driverTmpDir[FILENAME_MAX] = "";
+char fProfileGenerateDir[FILENAME_MAX+1] = "";
+char fProfileUsePath[FILENAME_MAX+1] = "";
+bool fRuntimeLTO = false;
 bool fLibraryCompile = false;
 bool fLibraryFortran = false;
 bool fLibraryMakefile = false;
@@ -174,8 +178,12 @@ bool fFastFlag = false;
 bool fNoCopyPropagation = false;
 bool fNoDeadCodeElimination = false;
 bool fNoScalarReplacement = false;
+bool fNoStackAllocateClasses = false;
 bool fNoTupleCopyOpt = false;
 bool fNoRemoteValueForwarding = false;
+bool fNoDevirtualize = false;
+bool fNoInferUnlockedChannels = false;
+bool fNoSmallRecordReturns = false;
 bool fNoInferConstRefs = false;
 bool fNoRemoteSerialization = false;
 bool fNoRemoveCopyCalls = false;
@@ -189,6 +197,7 @@ bool fNoFastFollowers = false;
 bool fNoInlineIterators = false;
 bool fNoLiveAnalysis = false;
 bool fNoBoundsChecks = false;
+bool fNoBoundsCheckElim = false;
 bool fNoConstArgChecks = false;
 bool fNoDivZeroChecks = false;
 bool fNoFormalDomainChecks = false;
@@ -199,10 +208,12 @@ bool fOverloadSetsChecks = true;
 bool fNoStackChecks = false;
 bool fNoInferLocalFields = false;
 bool fReplaceArrayAccessesWithRefTemps = false;
+bool fReorderRecordFields = false;
 bool fUserSetStackChecks = false;
 bool fNoCastChecks = false;
 bool fMungeUserIdents = true;
 bool fEnableTaskTracking = false;
+bool fProfileFunctions = false;
 bool fEnableMemInterleaving = false;
 
 bool fAutoLocalAccess = true;
@@ -212,12 +223,20 @@ bool fReportAutoLocalAccess= false;
 bool fAutoAggregation = false;
 bool fReportAutoAggregation= false;
 
+bool fAutoBulkTransfer = false;
+bool fReportAutoBulkTransfer = false;
+int fPrefetchDistance = 0;
+
 bool  printPasses     = false;
 FILE* printPassesFile = NULL;
+std::string gCompileProfile;
 
 // flag for llvmWideOpt
 bool fLLVMWideOpt = false;
 
+// number of partitions/threads for LLVM object emission
+int fLlvmCodegenThreads = 1;
+
 bool fWarnArrayOfRange = true;
 bool fWarnConstLoops = true;
 bool fWarnIntUint = false;
@@ -231,6 +250,7 @@ static bool fNoWarnDomainLiteral = true;
 static bool fNoWarnTupleIteration = true;
 
 bool fNoLoopInvariantCodeMotion = false;
+bool fNoLoopStrideSpecialization = false;
 bool fNoInterproceduralAliasAnalysis = true;
 bool fNoChecks = false;
 bool fNoInline = false;
@@ -241,6 +261,7 @@ bool fRemoveUnreachableBlocks = true;
 bool fMinimalModules = false;
 int fParMake = 0;
 bool fIncrementalCompilation = false;
+char fIncrementalCacheDir[FILENAME_MAX+1] = "";
 bool fNoOptimizeForallUnordered = false;
 
 int optimize_on_clause_limit = 20;
@@ -281,6 +302,7 @@ bool fPrintModuleResolution = false;
 bool fPrintEmittedCodeSize = false;
 char fPrintStatistics[256] = "";
 bool fPrintDispatch = false;
+bool fPrintRecordLayouts = false;
 bool fPrintUnusedFns = false;
 bool fPrintUnusedInternalFns = false;
 bool fReportAliases = false;
@@ -288,6 +310,7 @@ bool fReportBlocking = false;
 bool fReportOptimizedLoopIterators = false;
 bool fReportInlinedIterators = false;
 bool fReportVectorizedLoops = false;
+bool fReportVectorization = false;
 bool fReportOptimizedOn = false;
 bool fReportOptimizeForallUnordered = false;
 bool fReportPromotion = false;
@@ -327,6 +350,7 @@ bool specializeCCode = false;
 bool fNoMemoryFrees = false;
 int numGlobalsOnHeap = 0;
 bool preserveInlinedLineNumbers = false;
+bool fNoPropagateLineNumbers = false;
 
 char stopAfterPass[128] = "";
 
@@ -378,6 +402,7 @@ int fGPUBlockSize = 0;
 char fGpuArch[gpuArchNameLen+1] = "";
 bool fGpuPtxasEnforceOpt;
 bool fGpuSpecialization = false;
+bool fGpuFuseLoops = false;
 const char* gGpuSdkPath = NULL;
 std::set<std::string> gpuArches;
 
@@ -393,6 +418,13 @@ static std::vector<std::string> cmdLineModPaths;
 // support for separate compilation
 // what is the name of the output library file e.g. MyModule.dyno
 std::string gDynoGenLibOutput;
+// is the library being generated the standard library (chpl_standard.dyno)?
+bool gDynoGenStdLib = false;
+// the directory to cache the standard library .dyno file in
+std::string gDynoStdLibCacheDir;
+// if the standard library is being saved into the cache, the final path
+// (gDynoGenLibOutput is a temporary file that is renamed to this)
+std::string gDynoStdLibCachePath;
 // what source code paths were requested to be compiled into the lib?
 std::vector<UniqueString> gDynoGenLibSourcePaths;
 // what top-level module names as astrs were requested to be stored in the lib?
@@ -1000,6 +1032,7 @@ static void setFastFlag(const ArgumentDescription* desc, const char* unused) {
   fNoDeadCodeElimination = false;
   fNoFastFollowers = false;
   fNoLoopInvariantCodeMotion= false;
+  fNoLoopStrideSpecialization = false;
   fNoInterproceduralAliasAnalysis = false;
   fNoInline = false;
   fNoInlineIterators = false;
@@ -1008,9 +1041,14 @@ static void setFastFlag(const ArgumentDescription* desc, const char* unused) {
   fNoLiveAnalysis = false;
   fNoInferConstRefs = false;
   fNoRemoteValueForwarding = false;
+  fNoDevirtualize = false;
+  fNoInferUnlockedChannels = false;
+  fNoSmallRecordReturns = false;
   fNoRemoteSerialization = false;
   fNoRemoveCopyCalls = false;
   fNoScalarReplacement = false;
+  fNoStackAllocateClasses = false;
+  fNoBoundsCheckElim = false;
   fNoTupleCopyOpt = false;
   fNoPrivatization = false;
   fNoChecks = true;
@@ -1049,6 +1087,8 @@ static void setBaselineFlag(const ArgumentDescription* desc, const char* unused)
   fNoDeadCodeElimination = true;      // --no-dead-code-elimination
   fNoFastFollowers = true;            // --no-fast-followers
   fNoLoopInvariantCodeMotion = true;  // --no-loop-invariant-code-motion
+                                      // --no-loop-stride-specialization
+  fNoLoopStrideSpecialization = true;
                                       // --no-interprocedural-alias-analysis
   fNoInterproceduralAliasAnalysis = true;
   fNoInline = true;                   // --no-inline
@@ -1059,9 +1099,14 @@ static void setBaselineFlag(const ArgumentDescription* desc, const char* unused)
   fNoVectorize = true;                // --no-vectorize
   fNoInferConstRefs = true;           // --no-infer-const-refs
   fNoRemoteValueForwarding = true;    // --no-remote-value-forwarding
+  fNoDevirtualize = true;             // --no-devirtualize
+  fNoInferUnlockedChannels = true;    // --no-infer-unlocked-channels
+  fNoSmallRecordReturns = true;       // --no-small-record-returns
   fNoRemoteSerialization = true;      // --no-remote-serialization
   fNoRemoveCopyCalls = true;          // --no-remove-copy-calls
   fNoScalarReplacement = true;        // --no-scalar-replacement
+  fNoStackAllocateClasses = true;     // --no-stack-allocate-classes
+  fNoBoundsCheckElim = true;          // --no-bounds-check-elim
   fNoTupleCopyOpt = true;             // --no-tuple-copy-opt
   fNoPrivatization = true;            // --no-privatization
   fNoOptimizeOnClauses = true;        // --no-optimize-on-clauses
@@ -1132,6 +1177,13 @@ static void setPrintPassesFile(const ArgumentDescription* desc, const char* file
   }
 }
 
+static void setCompileProfile(const ArgumentDescription* desc,
+                              const char* prefix) {
+  gCompileProfile = std::string(prefix);
+  // record the queries run while handling the remaining arguments, too
+  if (!gCompileProfile.empty()) gContext->beginProfile();
+}
+
 static void setLocal (const ArgumentDescription* desc, const char* unused) {
   // Used in postLocal() to set fLocal if user threw flag
   fUserSetLocal = true;
@@ -1189,6 +1241,19 @@ void addDynoGenLib(const ArgumentDescription* desc, const char* newpath) {
 
   // set the output path. other variables will be set later
   gDynoGenLibOutput = usePath;
+
+  auto slash = usePath.find_last_of("/");
+  std::string baseName = (slash == std::string::npos) ?
+                         usePath : usePath.substr(slash+1);
+  gDynoGenStdLib = (baseName == "chpl_standard.dyno");
+}
+
+static void setDynoStdLibCache(const ArgumentDescription* desc,
+                               const char* newpath) {
+  gDynoStdLibCacheDir = std::string(newpath);
+  while (gDynoStdLibCacheDir.size() > 1 && gDynoStdLibCacheDir.back() == '/') {
+    gDynoStdLibCacheDir.pop_back();
+  }
 }
 
 /*
@@ -1240,35 +1305,45 @@ static ArgumentDescription arg_desc[] = {
  {"cache-remote", ' ', NULL, "[Don't] enable cache for remote data", "N", &fCacheRemote, "CHPL_CACHE_REMOTE", NULL},
  {"copy-propagation", ' ', NULL, "Enable [disable] copy propagation", "n", &fNoCopyPropagation, "CHPL_DISABLE_COPY_PROPAGATION", NULL},
  {"dead-code-elimination", ' ', NULL, "Enable [disable] dead code elimination", "n", &fNoDeadCodeElimination, "CHPL_DISABLE_DEAD_CODE_ELIMINATION", NULL},
+ {"devirtualize", ' ', NULL, "Enable [disable] turning virtual method calls with one possible target into direct calls", "n", &fNoDevirtualize, "CHPL_DISABLE_DEVIRTUALIZE", NULL},
  {"fast", ' ', NULL, "Disable checks; optimize/specialize code", "F", &fFastFlag, "CHPL_FAST", setFastFlag},
  {"fast-followers", ' ', NULL, "Enable [disable] fast followers", "n", &fNoFastFollowers, "CHPL_DISABLE_FAST_FOLLOWERS", NULL},
  {"ieee-float", ' ', NULL, "Generate code that is strict [lax] with respect to IEEE compliance", "N", &fieeefloat, "CHPL_IEEE_FLOAT", setFloatOptFlag},
  {"ignore-local-classes", ' ', NULL, "Disable [enable] local classes", "N", &fIgnoreLocalClasses, NULL, NULL},
+ {"infer-unlocked-channels", ' ', NULL, "Enable [disable] creating unlocked fileReaders and fileWriters that only one task uses", "n", &fNoInferUnlockedChannels, "CHPL_DISABLE_INFER_UNLOCKED_CHANNELS", NULL},
  {"inline", ' ', NULL, "Enable [disable] function inlining", "n", &fNoInline, NULL, NULL},
  {"inline-iterators", ' ', NULL, "Enable [disable] iterator inlining", "n", &fNoInlineIterators, "CHPL_DISABLE_INLINE_ITERATORS", NULL},
  {"inline-iterators-yield-limit", ' ', "<limit>", "Limit number of yields permitted in inlined iterators", "I", &inline_iter_yield_limit, "CHPL_INLINE_ITER_YIELD_LIMIT", NULL},
  {"live-analysis", ' ', NULL, "Enable [disable] live variable analysis", "n", &fNoLiveAnalysis, "CHPL_DISABLE_LIVE_ANALYSIS", NULL},
  {"loop-invariant-code-motion", ' ', NULL, "Enable [disable] loop invariant code motion", "n", &fNoLoopInvariantCodeMotion, NULL, NULL},
+ {"loop-stride-specialization", ' ', NULL, "Enable [disable] cloning inner loops for unit runtime strides", "n", &fNoLoopStrideSpecialization, "CHPL_DISABLE_LOOP_STRIDE_SPECIALIZATION", NULL},
  {"optimize-forall-unordered-ops", ' ', NULL, "Enable [disable] optimization of foralls to unordered operations", "n", &fNoOptimizeForallUnordered, "CHPL_DISABLE_OPTIMIZE_FORALL_UNORDERED_OPS", NULL},
  {"optimize-range-iteration", ' ', NULL, "Enable [disable] optimization of iteration over anonymous ranges", "n", &fNoOptimizeRangeIteration, "CHPL_DISABLE_OPTIMIZE_RANGE_ITERATION", NULL},
  {"optimize-loop-iterators", ' ', NULL, "Enable [disable] optimization of iterators composed of a single loop", "n", &fNoOptimizeLoopIterators, "CHPL_DISABLE_OPTIMIZE_LOOP_ITERATORS", NULL},
  {"optimize-on-clauses", ' ', NULL, "Enable [disable] optimization of on clauses", "n", &fNoOptimizeOnClauses, "CHPL_DISABLE_OPTIMIZE_ON_CLAUSES", NULL},
  {"optimize-on-clause-limit", ' ', "<limit>", "Limit recursion depth of on clause optimization search", "I", &optimize_on_clause_limit, "CHPL_OPTIMIZE_ON_CLAUSE_LIMIT", NULL},
  {"privatization", ' ', NULL, "Enable [disable] privatization of distributed arrays and domains", "n", &fNoPrivatization, "CHPL_DISABLE_PRIVATIZATION", NULL},
+ {"propagate-line-numbers", ' ', NULL, "Enable [disable] passing user line numbers through library code to runtime calls", "n", &fNoPropagateLineNumbers, "CHPL_DISABLE_PROPAGATE_LINE_NUMBERS", NULL},
  {"remote-value-forwarding", ' ', NULL, "Enable [disable] remote value forwarding", "n", &fNoRemoteValueForwarding, "CHPL_DISABLE_REMOTE_VALUE_FORWARDING", NULL},
  {"remote-serialization", ' ', NULL, "Enable [disable] serialization for remote consts", "n", &fNoRemoteSerialization, "CHPL_DISABLE_REMOTE_SERIALIZATION", NULL},
  {"remove-copy-calls", ' ', NULL, "Enable [disable] remove copy calls", "n", &fNoRemoveCopyCalls, "CHPL_DISABLE_REMOVE_COPY_CALLS", NULL},
+ {"reorder-record-fields", ' ', NULL, "Enable [disable] reordering the fields of user records to reduce padding", "N", &fReorderRecordFields, "CHPL_REORDER_RECORD_FIELDS", NULL},
  {"scalar-replacement", ' ', NULL, "Enable [disable] scalar replacement", "n", &fNoScalarReplacement, "CHPL_DISABLE_SCALAR_REPLACEMENT", NULL},
- {"scalar-replace-limit", ' ', "<limit>", "Limit on the size of tuples being replaced during scalar replacement", "I", &scalar_replace_limit, "CHPL_SCALAR_REPLACE_TUPLE_LIMIT", NULL},
+ {"scalar-replace-limit", ' ', "<limit>", "Limit on the size of tuples and records being replaced during scalar replacement", "I", &scalar_replace_limit, "CHPL_SCALAR_REPLACE_TUPLE_LIMIT", NULL},
+ {"small-record-returns", ' ', NULL, "Enable [disable] returning small plain-data records by value", "n", &fNoSmallRecordReturns, "CHPL_DISABLE_SMALL_RECORD_RETURNS", NULL},
+ {"stack-allocate-classes", ' ', NULL, "Enable [disable] stack allocation of class instances that don't escape", "n", &fNoStackAllocateClasses, "CHPL_DISABLE_STACK_ALLOCATE_CLASSES", NULL},
  {"tuple-copy-opt", ' ', NULL, "Enable [disable] tuple (memcpy) optimization", "n", &fNoTupleCopyOpt, "CHPL_DISABLE_TUPLE_COPY_OPT", NULL},
  {"tuple-copy-limit", ' ', "<limit>", "Limit on the size of tuples considered for optimization", "I", &tuple_copy_limit, "CHPL_TUPLE_COPY_LIMIT", NULL},
  {"infer-local-fields", ' ', NULL, "Enable [disable] analysis to infer local fields in classes and records", "n", &fNoInferLocalFields, "CHPL_DISABLE_INFER_LOCAL_FIELDS", NULL},
  {"vectorize", ' ', NULL, "Enable [disable] generation of vectorization hints", "n", &fNoVectorize, "CHPL_DISABLE_VECTORIZATION", setVectorize},
 
  {"auto-local-access", ' ', NULL, "Enable [disable] using local access automatically", "N", &fAutoLocalAccess, "CHPL_DISABLE_AUTO_LOCAL_ACCESS", NULL},
+ {"bounds-check-elim", ' ', NULL, "Enable [disable] removing bounds checks from auto-local-access candidates proven to be in bounds", "n", &fNoBoundsCheckElim, "CHPL_DISABLE_BOUNDS_CHECK_ELIM", NULL},
  {"dynamic-auto-local-access", ' ', NULL, "Enable [disable] using local access automatically (dynamic only)", "N", &fDynamicAutoLocalAccess, "CHPL_DISABLE_DYNAMIC_AUTO_LOCAL_ACCESS", NULL},
 
  {"auto-aggregation", ' ', NULL, "Enable [disable] automatically aggregating remote accesses in foralls", "N", &fAutoAggregation, "CHPL_AUTO_AGGREGATION", NULL},
+ {"auto-bulk-transfer", ' ', NULL, "Enable [disable] turning element-wise array copy foralls into bulk transfers", "N", &fAutoBulkTransfer, "CHPL_AUTO_BULK_TRANSFER", NULL},
+ {"prefetch-distance", ' ', "<distance>", "Prefetch indirect array accesses in foralls this many iterations ahead (0 disables)", "I", &fPrefetchDistance, "CHPL_PREFETCH_DISTANCE", NULL},
 
  {"", ' ', NULL, "Run-time Semantic Check Options", NULL, NULL, NULL, NULL},
  {"checks", ' ', NULL, "Enable [disable] all following run-time checks", "n", &fNoChecks, "CHPL_CHECKS", setChecks},
@@ -1297,6 +1372,9 @@ static ArgumentDescription arg_desc[] = {
  {"lib-linkage", 'l', "<library>", "C library linkage", "P", libraryFilename, "CHPL_LIB_NAME", handleLibrary},
  {"lib-search-path", 'L', "<directory>", "C library search path", "P", libraryFilename, "CHPL_LIB_PATH", handleLibPath},
  {"optimize", 'O', NULL, "[Don't] Optimize generated C code", "N", &optimizeCCode, "CHPL_OPTIMIZE", NULL},
+ {"profile-generate", ' ', "<directory>", "Instrument the program to write execution profiles to directory", "P", fProfileGenerateDir, "CHPL_PROFILE_GENERATE", NULL},
+ {"profile-use", ' ', "<path>", "Optimize using a merged profile, or (with LLVM) the profiles in a --profile-generate directory", "P", fProfileUsePath, "CHPL_PROFILE_USE", NULL},
+ {"runtime-lto", ' ', NULL, "[Don't] link with a ThinLTO runtime so its fast paths can be inlined", "N", &fRuntimeLTO, "CHPL_RUNTIME_LTO", NULL},
  {"specialize", ' ', NULL, "[Don't] Specialize generated C code for CHPL_TARGET_CPU", "N", &specializeCCode, "CHPL_SPECIALIZE", NULL},
  {"output", 'o', "<filename>", "Name output executable", "P", executableFilename, "CHPL_EXE_NAME", NULL},
  {"static", ' ', NULL, "Generate a statically linked binary", "F", &fLinkStyle, NULL, NULL},
@@ -1304,12 +1382,14 @@ static ArgumentDescription arg_desc[] = {
  {"", ' ', NULL, "LLVM Code Generation Options", NULL, NULL, NULL, NULL},
  {"llvm", ' ', NULL, "[Don't] use the LLVM code generator", "N", &fYesLlvmCodegen, "CHPL_LLVM_CODEGEN", setLlvmCodegen},
  {"llvm-wide-opt", ' ', NULL, "Enable [disable] LLVM wide pointer optimizations", "N", &fLLVMWideOpt, "CHPL_LLVM_WIDE_OPTS", NULL},
+ {"llvm-codegen-threads", ' ', "<n>", "Split LLVM object emission into <n> partitions emitted in parallel", "I", &fLlvmCodegenThreads, "CHPL_LLVM_CODEGEN_THREADS", NULL},
  {"mllvm", ' ', "<flags>", "LLVM flags (can be specified multiple times)", "S", NULL, "CHPL_MLLVM", setLLVMFlags},
 
  {"", ' ', NULL, "Compilation Trace Options", NULL, NULL, NULL, NULL},
  {"print-commands", ' ', NULL, "[Don't] print system commands", "N", &printSystemCommands, "CHPL_PRINT_COMMANDS", NULL},
  {"print-passes", ' ', NULL, "[Don't] print compiler passes", "N", &printPasses, "CHPL_PRINT_PASSES", NULL},
  {"print-passes-file", ' ', "<filename>", "Print compiler passes to <filename>", "S", NULL, "CHPL_PRINT_PASSES_FILE", setPrintPassesFile},
+ {"compile-profile", ' ', "<prefix>", "Write a profile of compiler passes and frontend queries to <prefix>.trace.json and <prefix>.folded", "S", NULL, "CHPL_COMPILE_PROFILE", setCompileProfile},
 
  {"", ' ', NULL, "Miscellaneous Options", NULL, NULL, NULL, NULL},
  {"detailed-errors", ' ', NULL, "Enable [disable] detailed error messages", "N", &fDetailedErrors, "CHPL_DETAILED_ERRORS", NULL},
@@ -1322,6 +1402,7 @@ static ArgumentDescription arg_desc[] = {
  {"print-callgraph", ' ', NULL, "[Don't] print a representation of the callgraph for the program", "N", &fPrintCallGraph, "CHPL_PRINT_CALLGRAPH", NULL},
  {"print-callstack-on-error", ' ', NULL, "[Don't] print the Chapel call stack leading to each error or warning", "N", &fPrintCallStackOnError, "CHPL_PRINT_CALLSTACK_ON_ERROR", setPrintCallstackOnErrorFlag},
  {"print-unused-functions", ' ', NULL, "[Don't] print the name and location of unused functions", "N", &fPrintUnusedFns, NULL, NULL},
+ {"profile-functions", ' ', NULL, "[Don't] instrument user functions for the runtime function profiler", "N", &fProfileFunctions, "CHPL_PROFILE_FUNCTIONS", NULL},
  {"set", 's', "<name>[=<value>]", "Set config value", "S", NULL, NULL, readConfig},
  {"task-tracking", ' ', NULL, "Enable [disable] runtime task tracking", "N", &fEnableTaskTracking, "CHPL_TASK_TRACKING", NULL},
 
@@ -1385,19 +1466,22 @@ static ArgumentDescription arg_desc[] = {
  {"print-emitted-code-size", ' ', NULL, "Print emitted code size", "F", &fPrintEmittedCodeSize, NULL, NULL},
  {"print-module-resolution", ' ', NULL, "Print name of module being resolved", "F", &fPrintModuleResolution, "CHPL_PRINT_MODULE_RESOLUTION", NULL},
  {"print-dispatch", ' ', NULL, "Print dynamic dispatch table", "F", &fPrintDispatch, NULL, NULL},
+ {"print-record-layouts", ' ', NULL, "Print the field layout of user records", "F", &fPrintRecordLayouts, NULL, NULL},
  {"print-statistics", ' ', "[n|k|t]", "Print AST statistics", "S256", fPrintStatistics, NULL, NULL},
  {"report-aliases", ' ', NULL, "Report aliases in user code", "N", &fReportAliases, NULL, NULL},
  {"report-blocking", ' ', NULL, "Report blocking functions in user code", "N", &fReportBlocking, NULL, NULL},
  {"report-inlining", ' ', NULL, "Print inlined functions", "F", &report_inlining, NULL, NULL},
  {"report-dead-blocks", ' ', NULL, "Print dead block removal stats", "F", &fReportDeadBlocks, NULL, NULL},
- {"report-dead-modules", ' ', NULL, "Print dead module removal stats", "F", &fReportDeadModules, NULL, NULL},
+ {"report-dead-modules", ' ', NULL, "Print dead global and module removal stats", "F", &fReportDeadModules, NULL, NULL},
  {"report-gpu-transform-time", ' ', NULL, "Print amount of time spent in GPU transformations", "F", &fReportGpuTransformTime, NULL, NULL},
  {"report-optimized-loop-iterators", ' ', NULL, "Print stats on optimized single loop iterators", "F", &fReportOptimizedLoopIterators, NULL, NULL},
  {"report-inlined-iterators", ' ', NULL, "Print stats on inlined iterators", "F", &fReportInlinedIterators, NULL, NULL},
  {"report-vectorized-loops", ' ', NULL, "Show which loops have vectorization hints", "F", &fReportVectorizedLoops, NULL, NULL},
+ {"report-vectorization", ' ', NULL, "Show which loops the LLVM vectorizer vectorized, and why others were not", "F", &fReportVectorization, NULL, NULL},
  {"report-optimized-on", ' ', NULL, "Print information about on clauses that have been optimized for potential fast remote fork operation", "F", &fReportOptimizedOn, NULL, NULL},
  {"report-auto-local-access", ' ', NULL, "Enable compiler logs for auto local access optimization", "N", &fReportAutoLocalAccess, "CHPL_REPORT_AUTO_LOCAL_ACCESS", NULL},
  {"report-auto-aggregation", ' ', NULL, "Enable compiler logs for automatic aggregation", "N", &fReportAutoAggregation, "CHPL_REPORT_AUTO_AGGREGATION", NULL},
+ {"report-auto-bulk-transfer", ' ', NULL, "Enable compiler logs for automatic bulk transfer", "N", &fReportAutoBulkTransfer, "CHPL_REPORT_AUTO_BULK_TRANSFER", NULL},
  {"report-optimized-forall-unordered-ops", ' ', NULL, "Show which statements in foralls have been converted to unordered operations", "F", &fReportOptimizeForallUnordered, NULL, NULL},
  {"report-promotion", ' ', NULL, "Print information about scalar promotion", "F", &fReportPromotion, NULL, NULL},
  {"report-scalar-replace", ' ', NULL, "Print scalar replacement stats", "F", &fReportScalarReplace, NULL, NULL},
@@ -1438,6 +1522,7 @@ static ArgumentDescription arg_desc[] = {
  {"gpu-arch", ' ', "<cuda-architecture>", "CUDA architecture to use", "S16", &fGpuArch, "_CHPL_GPU_ARCH", setEnv},
  {"gpu-ptxas-enforce-optimization", ' ', NULL, "Modify generated .ptxas file to enable optimizations", "F", &fGpuPtxasEnforceOpt, NULL, NULL},
  {"gpu-specialization", ' ', NULL, "Enable [disable] an optimization that clones functions into copies assumed to run on a GPU locale.", "N", &fGpuSpecialization, "CHPL_GPU_SPECIALIZATION", NULL},
+ {"gpu-fuse-loops", ' ', NULL, "Enable [disable] fusing adjacent GPU-eligible loops with the same bounds into one kernel; only correct if each iteration of a loop depends on nothing but the same iteration of the loop before it", "N", &fGpuFuseLoops, "CHPL_GPU_FUSE_LOOPS", NULL},
  {"library", ' ', NULL, "Generate a Chapel library file", "F", &fLibraryCompile, NULL, NULL},
  {"library-dir", ' ', "<directory>", "Save generated library helper files in directory", "P", libDir, "CHPL_LIB_SAVE_DIR", verifySaveLibDir},
  {"library-header", ' ', "<filename>", "Name generated header file", "P", libmodeHeadername, NULL, setLibmode},
@@ -1466,6 +1551,7 @@ static ArgumentDescription arg_desc[] = {
  {"remove-unreachable-blocks", ' ', NULL, "[Don't] remove unreachable blocks after resolution", "N", &fRemoveUnreachableBlocks, "CHPL_REMOVE_UNREACHABLE_BLOCKS", NULL},
  {"replace-array-accesses-with-ref-temps", ' ', NULL, "Enable [disable] replacing array accesses with reference temps (experimental)", "N", &fReplaceArrayAccessesWithRefTemps, NULL, NULL },
  {"incremental", ' ', NULL, "Enable [disable] using incremental compilation", "N", &fIncrementalCompilation, "CHPL_INCREMENTAL_COMP", NULL},
+ {"incremental-cache", ' ', "<directory>", "Reuse object files of unchanged modules from directory", "P", fIncrementalCacheDir, "CHPL_INCREMENTAL_CACHE", &turnIncrementalOn},
  {"minimal-modules", ' ', NULL, "Enable [disable] using minimal modules",               "N", &fMinimalModules, "CHPL_MINIMAL_MODULES", NULL},
  {"parallel-make", 'j', NULL, "Specify degree of parallelism for C back-end", "I", &fParMake, "CHPL_PAR_MAKE", &turnIncrementalOn},
  {"print-chpl-settings", ' ', NULL, "Print current chapel settings and exit", "F", &fPrintChplSettings, NULL,NULL},
@@ -1487,6 +1573,7 @@ static ArgumentDescription arg_desc[] = {
  {"dyno-debug-trace", ' ', NULL, "Enable [disable] debug-trace output when using dyno compiler library", "N", &fDynoDebugTrace, "CHPL_DYNO_DEBUG_TRACE", NULL},
  {"dyno-break-on-hash", ' ' , NULL, "Break when query with given hash value is executed when using dyno compiler library", "X", &fDynoBreakOnHash, "CHPL_DYNO_BREAK_ON_HASH", NULL},
  {"dyno-gen-lib", ' ', "<path>", "Specify files named on the command line should be saved into a .dyno library", "P", NULL, NULL, addDynoGenLib},
+ {"dyno-std-lib-cache", ' ', "<directory>", "Load the standard library from a .dyno file cached in this directory, creating it if needed", "P", NULL, "CHPL_DYNO_STD_LIB_CACHE", setDynoStdLibCache},
  {"dyno-verify-serialization", ' ', NULL, "Enable [disable] verification of serialization", "N", &fDynoVerifySerialization, NULL, NULL},
  {"foreach-intents", ' ', NULL, "Enable [disable] (current, experimental, support for) foreach intents.", "N", &fForeachIntents, "CHPL_FOREACH_INTENTS", NULL},
 
@@ -1848,6 +1935,45 @@ static void postStaticLink() {
   }
 }
 
+// With the C backend the profile flags are passed on to the C compiler;
+// with LLVM the IR is instrumented or optimized in clangUtil.cpp and
+// clang only needs to link in the profile runtime.
+static void postProfileGuidedOptimization() {
+  if (fProfileGenerateDir[0] && fProfileUsePath[0]) {
+    USR_FATAL("--profile-generate and --profile-use can't be used together");
+  }
+
+  std::string gen;
+  std::string use;
+  if (fProfileGenerateDir[0]) {
+    gen = fLlvmCodegen ? std::string("-fprofile-generate")
+                       : std::string("-fprofile-generate=") +
+                         fProfileGenerateDir;
+  } else if (fProfileUsePath[0]) {
+    if (!pathExists(fProfileUsePath)) {
+      USR_FATAL("--profile-use path '%s' does not exist", fProfileUsePath);
+    }
+    if (!fLlvmCodegen) use = std::string("-fprofile-use=") + fProfileUsePath;
+  }
+
+  if (!gen.empty()) {
+    if (!fLlvmCodegen) setCCFlags(NULL, gen.c_str());
+    setLDFlags(NULL, gen.c_str());
+  }
+  if (!use.empty()) {
+    setCCFlags(NULL, use.c_str());
+  }
+}
+
+// The runtime has to have been built with CHPL_RUNTIME_LTO=1 so that
+// libchpl.a holds bitcode; clangUtil.cpp then emits the generated code as
+// bitcode too and links the two with -flto=thin.
+static void postRuntimeLTO() {
+  if (fRuntimeLTO && !fLlvmCodegen) {
+    USR_FATAL("--runtime-lto requires CHPL_TARGET_COMPILER=llvm");
+  }
+}
+
 static void postLocal() {
   if (!fUserSetLocal) fLocal = !strcmp(CHPL_COMM, "none");
 
@@ -2186,6 +2312,10 @@ static void postprocess_args() {
 
   postStaticLink();
 
+  postProfileGuidedOptimization();
+
+  postRuntimeLTO();
+
   checkMLDebugAndLibmode();
 
   checkLibraryPythonAndLibmode();
@@ -2375,6 +2505,37 @@ static void dynoConfigureContext(std::string chpl_module_path) {
 }
 
 
+// Write the profile requested with --compile-profile. Each driver
+// sub-invocation runs in its own process, so each writes its own files.
+static void writeCompileProfile() {
+  std::string prefix = gCompileProfile;
+  if (fDriverCompilationPhase) {
+    prefix += ".compilation";
+  } else if (fDriverMakeBinaryPhase) {
+    prefix += ".makeBinary";
+  }
+
+  gContext->endProfile();
+
+  std::string tracePath = prefix + ".trace.json";
+  std::ofstream trace(tracePath);
+  if (!trace) {
+    USR_WARN("Could not open '%s' to write the compile profile",
+             tracePath.c_str());
+  } else {
+    gContext->writeProfileChromeTrace(trace);
+  }
+
+  std::string foldedPath = prefix + ".folded";
+  std::ofstream folded(foldedPath);
+  if (!folded) {
+    USR_WARN("Could not open '%s' to write the compile profile",
+             foldedPath.c_str());
+  } else {
+    gContext->writeProfileFoldedStacks(folded);
+  }
+}
+
 int main(int argc, char* argv[]) {
   PhaseTracker tracker;
 
@@ -2488,6 +2649,10 @@ int main(int argc, char* argv[]) {
 
   tracker.Stop();
 
+  if (!gCompileProfile.empty()) {
+    writeCompileProfile();
+  }
+
   if (printPasses == true || printPassesFile != NULL) {
     // Report out timing totals information, with adjustments for driver mode.
     if (fDriverDoMonolithic) {
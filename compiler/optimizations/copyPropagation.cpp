@@ -427,6 +427,11 @@ static bool isUse(SymExpr* se)
       }
       return false;
 
+     case PRIM_PREFETCH:
+      // prefetch ref
+      // the argument is an address
+      return false;
+
      case PRIM_SET_MEMBER:
       // The first operand works like a reference, and the second is a field
       // name.  Only the third is a replaceable use.
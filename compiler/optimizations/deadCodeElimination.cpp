@@ -86,6 +86,33 @@ static bool isDeadVariable(Symbol* var) {
   }
 }
 
+// Removes 'var' and the moves into it, keeping any calls on their RHS.
+// Adds the symbols in those statements to 'potentiallyChanged'.
+static void removeDeadVariable(Symbol* var,
+                               std::set<Symbol*>& potentiallyChanged) {
+  for_SymbolDefs(se, var) {
+    CallExpr* call = toCallExpr(se->parentExpr);
+    collectSymbolSet(call->getStmtExpr(), potentiallyChanged);
+    INT_ASSERT(call);
+
+    Expr* dest = NULL;
+    Expr* rhs = NULL;
+    bool ok = getSettingPrimitiveDstSrc(call, &dest, &rhs);
+    INT_ASSERT(ok);
+
+    rhs->remove();
+    CallExpr* rhsCall = toCallExpr(rhs);
+    if (rhsCall && (rhsCall->isResolved() || rhsCall->isPrimitive(
+      PRIM_VIRTUAL_METHOD_CALL))) {
+      // RHS might have side-effects, leave it alone
+      call->replace(rhs);
+    } else {
+      call->remove();
+    }
+  }
+  var->defPoint->remove();
+}
+
 void deadVariableElimination(FnSymbol* fn) {
   std::set<Symbol*> symSet;
   collectSymbolSet(fn, symSet);
@@ -113,27 +140,7 @@ void deadVariableElimination(FnSymbol* fn) {
 
     if (isDeadVariable(sym)) {
       std::set<Symbol*> potentiallyChanged;
-      for_SymbolDefs(se, sym) {
-        CallExpr* call = toCallExpr(se->parentExpr);
-        collectSymbolSet(call->getStmtExpr(), potentiallyChanged);
-        INT_ASSERT(call);
-
-        Expr* dest = NULL;
-        Expr* rhs = NULL;
-        bool ok = getSettingPrimitiveDstSrc(call, &dest, &rhs);
-        INT_ASSERT(ok);
-
-        rhs->remove();
-        CallExpr* rhsCall = toCallExpr(rhs);
-        if (rhsCall && (rhsCall->isResolved() || rhsCall->isPrimitive(
-          PRIM_VIRTUAL_METHOD_CALL))) {
-          // RHS might have side-effects, leave it alone
-          call->replace(rhs);
-        } else {
-          call->remove();
-        }
-      }
-      sym->defPoint->remove();
+      removeDeadVariable(sym, potentiallyChanged);
 
       // If we just removed a symbol, let's (re)visit the other symbols in
       // this statement in case they are now dead.
@@ -339,6 +346,69 @@ static void removeDeadStringLiteral(DefExpr* defExpr) {
   defExpr->remove();
 }
 
+/************************************* | **************************************
+*                                                                             *
+* Module-level variables of user modules that are only ever set are removed   *
+* along with the moves that set them. As for local variables, a call on the   *
+* RHS is kept for its side effects; if its result was only stored in a temp,  *
+* deadVariableElimination then removes that in the module init function.      *
+* Variables that are read anywhere, including by their module's deinit or a   *
+* broadcast, are kept, as are config, exported and extern ones. Other         *
+* modules' globals may be named by the runtime, so they are left alone.       *
+*                                                                             *
+************************************** | *************************************/
+
+static unsigned int deadGlobalCount;
+
+static bool isDeadGlobal(VarSymbol* var) {
+  ModuleSymbol* mod = toModuleSymbol(var->defPoint->parentSymbol);
+
+  if (mod == NULL || mod->modTag != MOD_USER)
+    return false;
+
+  if (var->isRef() ||
+      var->hasFlag(FLAG_CONFIG) ||
+      var->hasFlag(FLAG_EXPORT) ||
+      var->hasFlag(FLAG_EXTERN) ||
+      var->hasFlag(FLAG_LOCALE_PRIVATE))
+    return false;
+
+  if (var->isUsed())
+    return false;
+
+  // Only moves and assignments can be removed
+  for_SymbolDefs(se, var) {
+    CallExpr* call = toCallExpr(se->parentExpr);
+    Expr* dest = NULL;
+    Expr* rhs = NULL;
+    if (call == NULL || !getSettingPrimitiveDstSrc(call, &dest, &rhs) ||
+        dest != se) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static void deadGlobalElimination() {
+  deadGlobalCount = 0;
+
+  // Removing 'x' in 'x = y' can make 'y' dead too, so iterate.
+  bool changed = true;
+  while (changed) {
+    changed = false;
+
+    forv_Vec(VarSymbol, var, gVarSymbols) {
+      if (var->inTree() && isDeadGlobal(var)) {
+        std::set<Symbol*> potentiallyChanged;
+        removeDeadVariable(var, potentiallyChanged);
+        deadGlobalCount++;
+        changed = true;
+      }
+    }
+  }
+}
+
 /************************************* | **************************************
 *                                                                             *
 * A module is dead if                                                         *
@@ -432,6 +502,7 @@ void deadCodeElimination() {
 
     deadStringLiteralElimination();
 
+    deadGlobalElimination();
 
     forv_Vec(FnSymbol, fn, gFnSymbols) {
 
@@ -453,8 +524,10 @@ void deadCodeElimination() {
 
     deadModuleElimination();
 
-    if (fReportDeadModules)
+    if (fReportDeadModules) {
+      printf("Removed %d dead globals.\n", deadGlobalCount);
       printf("Removed %d dead modules.\n", deadModuleCount);
+    }
 
     cleanupAfterTypeRemoval();
   }
@@ -0,0 +1,182 @@
+/*
+ * Copyright 2020-2023 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "AggregateType.h"
+#include "astutil.h"
+#include "DecoratedClassType.h"
+#include "driver.h"
+#include "expr.h"
+#include "optimizations.h"
+#include "stlUtil.h"
+#include "stmt.h"
+#include "symbol.h"
+#include "virtualDispatch.h"
+
+#include "global-ast-vecs.h"
+
+#include <set>
+#include <vector>
+
+/*
+   Turn virtual method calls into direct calls when the program can only
+   reach one implementation.
+
+   insertDynamicDispatchCalls() makes a call virtual whenever the method
+   has an override anywhere, but overrides in classes that are never
+   instantiated can't be reached. Every object gets its class id set by
+   a PRIM_SETCID when it is created, so after pruning those calls give
+   the set of classes that can exist at run time. A virtual call whose
+   receiver's subclasses in that set all have the same method in the
+   call's vtable slot becomes a direct call, which the backend can then
+   inline.
+
+   Guarded speculative calls for sites with a dominant target are left
+   to the backend: with --profile-use, its indirect call promotion does
+   that from the measured targets.
+*/
+
+static void collectInstantiatedClasses(std::set<AggregateType*>& classes) {
+  forv_Vec(CallExpr, call, gCallExprs) {
+    if (call->inTree() && call->isPrimitive(PRIM_SETCID)) {
+      Type* t = canonicalClassType(call->get(1)->getValType());
+      if (AggregateType* at = toAggregateType(t)) {
+        classes.insert(at);
+      }
+    }
+  }
+}
+
+static bool isSubclassOf(AggregateType* t, AggregateType* ancestor) {
+  if (t == ancestor) return true;
+
+  forv_Vec(AggregateType, parent, t->dispatchParents) {
+    if (parent && isSubclassOf(parent, ancestor)) return true;
+  }
+  return false;
+}
+
+static bool isOverrideOf(FnSymbol* target, FnSymbol* fn) {
+  if (target == fn) return true;
+
+  if (Vec<FnSymbol*>* children = virtualChildrenMap.get(fn)) {
+    forv_Vec(FnSymbol, child, *children) {
+      if (child == target) return true;
+    }
+  }
+  return false;
+}
+
+// Returns the only method a virtual call to 'fn' can reach, or nullptr.
+static FnSymbol* getOnlyTarget(FnSymbol* fn,
+                               const std::set<AggregateType*>& classes) {
+  Type* thisType = canonicalClassType(fn->_this->getValType());
+  AggregateType* recv = toAggregateType(thisType);
+  if (!recv) return nullptr;
+
+  int index = virtualMethodMap.get(fn);
+  FnSymbol* target = nullptr;
+  for (AggregateType* at : classes) {
+    if (!at->symbol->inTree() || !isSubclassOf(at, recv)) continue;
+
+    Vec<FnSymbol*>* vmt = virtualMethodTable.get(at);
+    if (!vmt || index >= vmt->n) return nullptr;
+
+    FnSymbol* impl = vmt->v[index];
+    if (!isOverrideOf(impl, fn)) return nullptr;
+    if (target && impl != target) return nullptr;
+    target = impl;
+  }
+  return target;
+}
+
+// Replaces the virtual call with a direct call to 'target'.
+static bool devirtualizeCall(CallExpr* call, FnSymbol* fn, FnSymbol* target) {
+  if (target->retType != fn->retType ||
+      target->numFormals() != fn->numFormals() ||
+      call->numActuals() != fn->numFormals() + 2) {
+    return false;
+  }
+
+  // Actuals start after the function and the class id.
+  SymExpr* thisActual = nullptr;
+  int i = 1;
+  for_formals(formal, fn) {
+    ArgSymbol* targetFormal = target->getFormal(i);
+    Expr* actual = call->get(i + 2);
+    if (formal == fn->_this) {
+      thisActual = toSymExpr(actual);
+      if (!thisActual || thisActual->isRef() || targetFormal->isRef()) {
+        return false;
+      }
+    } else if (formal->type != targetFormal->type ||
+               formal->qualType().getQual() !=
+               targetFormal->qualType().getQual()) {
+      return false;
+    }
+    i++;
+  }
+  if (!thisActual) return false;
+
+  SET_LINENO(call);
+
+  // An override takes its own class as 'this'.
+  if (target != fn) {
+    Type* targetThisType = target->_this->type;
+    VarSymbol* tmp = newTemp("devirt_this", targetThisType);
+    Expr* stmt = call->getStmtExpr();
+    stmt->insertBefore(new DefExpr(tmp));
+    stmt->insertBefore(new CallExpr(PRIM_MOVE, tmp,
+                         new CallExpr(PRIM_CAST, targetThisType->symbol,
+                                      thisActual->copy())));
+    thisActual->replace(new SymExpr(tmp));
+  }
+
+  CallExpr* direct = new CallExpr(target);
+  call->get(1)->remove(); // the function
+  call->get(1)->remove(); // the class id
+  while (call->numActuals() > 0) {
+    direct->insertAtTail(call->get(1)->remove());
+  }
+  call->replace(direct);
+  return true;
+}
+
+void devirtualizeMethodCalls() {
+  if (fNoDevirtualize) return;
+
+  std::set<AggregateType*> classes;
+  collectInstantiatedClasses(classes);
+
+  std::vector<CallExpr*> calls;
+  forv_Vec(CallExpr, call, gCallExprs) {
+    if (call->inTree() && call->isPrimitive(PRIM_VIRTUAL_METHOD_CALL)) {
+      calls.push_back(call);
+    }
+  }
+
+  for_vector(CallExpr, call, calls) {
+    FnSymbol* fn = toFnSymbol(toSymExpr(call->get(1))->symbol());
+    if (!fn || !fn->_this) continue;
+
+    if (FnSymbol* target = getOnlyTarget(fn, classes)) {
+      devirtualizeCall(call, fn, target);
+    }
+  }
+}
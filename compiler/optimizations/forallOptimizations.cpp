@@ -44,10 +44,19 @@
 //                                proven to be aligned with the leader. e.g.
 //                                `zip(A, A.domain)`
 // - automatic local access: Use `localAccess` instead of `this` for array
-//                           accesses that can be proven to be local
+//                           accesses that can be proven to be local. When
+//                           they can be proven to be in bounds too, the
+//                           accessor's bounds check is removed
 //
 // - automatic aggregation: Use aggregation instead of regular assignments for
 //                          applicable last statements within `forall` bodies
+//
+// - automatic bulk transfer: Turn `forall` loops that only copy elements
+//                            between two arrays into slice assignments, which
+//                            the modules implement with bulk transfers
+//
+// - automatic prefetching: Prefetch the targets of indirect accesses like
+//                          `A[B[i]]` a few iterations ahead
 
 static int curLogDepth = 0;
 static bool LOG_ALA(int depth, const char *msg, BaseAST *node);
@@ -56,6 +65,8 @@ static void LOGLN_ALA(BaseAST *node);
 static bool LOG_AA(int depth, const char *msg, BaseAST *node);
 static void LOGLN_AA(BaseAST *node);
 
+static bool LOG_ABT(int depth, const char *msg, BaseAST *node);
+
 // Support for reporting calls that are not optimized for different reasons
 enum CallRejectReason {
   CRR_ACCEPT,
@@ -77,6 +88,10 @@ enum CallRejectReason {
 std::set<astlocT> primMaybeLocalThisLocations;
 std::set<astlocT> primMaybeAggregateAssignLocations;
 
+// accesses that the analysis proved to be in bounds, see
+// removeProvenBoundsChecks()
+static std::set<CallExpr *> inBoundsAccesses;
+
 
 static bool callHasSymArguments(CallExpr *ce, const std::vector<Symbol *> &syms);
 static Symbol *getDotDomBaseSym(Expr *expr);
@@ -108,7 +123,8 @@ static Symbol *generateStaticCheckForAccess(CallExpr *access,
                                             Expr *&allChecks);
 static CallExpr *replaceCandidate(CallExpr *candidate,
                                   Symbol *staticCheckSym,
-                                  bool doStatic);
+                                  bool doStatic,
+                                  bool inBounds);
 static void optimizeLoop(ForallStmt *forall,
                          Expr *&staticCond, CallExpr *&dynamicCond,
                          bool doStatic);
@@ -132,6 +148,10 @@ static bool isLocalAccess(CallExpr *call);
 static const char *getForallCloneTypeStr(Symbol *aggMarker);
 static CallExpr *getAggGenCallForChild(Expr *child, bool srcAggregation);
 static bool assignmentSuitableForAggregation(CallExpr *call, ForallStmt *forall);
+static bool isRemoteElementAccess(Expr *expr, ForallStmt *forall);
+static bool isCompoundAssignment(CallExpr *call);
+static CallExpr *getAtomicUpdateElement(CallExpr *call);
+static void reportUnsupportedAggCandidate(CallExpr *call, ForallStmt *forall);
 static void insertAggCandidate(CallExpr *call, ForallStmt *forall);
 static bool handleYieldedArrayElementsInAssignment(CallExpr *call,
                                                    ForallStmt *forall);
@@ -141,13 +161,30 @@ static void removeAggregatorFromMaybeAggAssign(CallExpr *call, int argIndex);
 static void removeAggregatorFromFunction(Symbol *aggregator, FnSymbol *parent);
 static void removeAggregationFromRecursiveForallHelp(BlockStmt *block);
 static void autoAggregation(ForallStmt *forall);
+static Symbol *getElementCopyBase(Expr *expr, Symbol *idxSym);
+static void autoBulkTransfer(ForallStmt *forall);
+static void autoPrefetch(ForallStmt *forall);
 
 void doPreNormalizeArrayOptimizations() {
   const bool anyAnalysisNeeded = fAutoLocalAccess ||
                                  fAutoAggregation ||
+                                 fAutoBulkTransfer ||
+                                 fPrefetchDistance > 0 ||
                                  !fNoFastFollowers;
   if (anyAnalysisNeeded) {
     forv_expanding_Vec(ForallStmt, forall, gForallStmts) {
+      // do this first, the loop is kept as the fallback and the other
+      // optimizations still apply to it
+      if (fAutoBulkTransfer) {
+        autoBulkTransfer(forall);
+      }
+
+      // before automatic local access, so that its clones of the loop get
+      // the prefetches, too
+      if (fPrefetchDistance > 0) {
+        autoPrefetch(forall);
+      }
+
       if (!fNoFastFollowers) {
         symbolicFastFollowerAnalysis(forall);
       }
@@ -213,11 +250,12 @@ Expr *preFoldMaybeLocalThis(CallExpr *call) {
   // PRIM_MAYBE_LOCAL_THIS looks like
   //
   //  (call "may be local access" arrSymbol, idxSym0, ... ,idxSymN,
-  //                              paramControlFlag, paramStaticallyDetermined)
+  //                              paramControlFlag, paramStaticallyDetermined,
+  //                              paramInBounds)
   //
-  // we need to check the second argument from last to determine whether we
+  // we need to check the third argument from last to determine whether we
   // are confirming this to be a local access or not
-  if (SymExpr *controlSE = toSymExpr(call->get(call->argList.length-1))) {
+  if (SymExpr *controlSE = toSymExpr(call->get(call->argList.length-2))) {
     if (controlSE->symbol() == gTrue) {
       confirmed = true;
     }
@@ -228,6 +266,15 @@ Expr *preFoldMaybeLocalThis(CallExpr *call) {
 
   if (fAutoLocalAccess) {
     ret = confirmed ? confirmAccess(call) : revertAccess(call);
+
+    // static candidates index the array with an index of its own domain,
+    // whether or not the access also turned out to be local, unless the loop
+    // body might change that domain
+    SymExpr *inBoundsSE = toSymExpr(call->get(call->argList.length));
+    if (inBoundsSE->symbol() == gTrue && !fNoBoundsChecks &&
+        !fNoBoundsCheckElim) {
+      inBoundsAccesses.insert(toCallExpr(ret));
+    }
   }
   else {
     // maybe we have automatic aggregation but no automatic local access? In
@@ -451,7 +498,113 @@ void cleanupRemainingAggCondStmts() {
   }
 }
 
+//
+// Bounds check elimination for in-bounds accesses
+//
+// With bounds checks on, array accessors call `checkAccess` on their index.
+// For accesses in `inBoundsAccesses` that is redundant, so we point them at a
+// copy of the accessor without it. Accessors that forward to another overload
+// of themselves are copied too, so that the check goes away one level down.
+//
+static bool isBoundsCheckStmt(CallExpr *call) {
+  FnSymbol *fn = call->resolvedFunction();
+  return fn != NULL && fn->isMethod() && fn->name == astr("checkAccess") &&
+         isBlockStmt(call->parentExpr);
+}
+
+static FnSymbol *getUncheckedAccessor(FnSymbol *fn,
+                                      std::map<FnSymbol *, FnSymbol *> &cache,
+                                      int depth) {
+  std::map<FnSymbol *, FnSymbol *>::iterator it = cache.find(fn);
+  if (it != cache.end()) {
+    return it->second;
+  }
+  cache[fn] = NULL;  // in case of recursion
+
+  if (fn->hasFlag(FLAG_EXTERN) || depth > 2) {
+    return NULL;
+  }
+
+  std::vector<CallExpr *> calls;
+  collectFnCalls(fn->body, calls);
+
+  bool needsCopy = false;
+  for_vector(CallExpr, call, calls) {
+    if (isBoundsCheckStmt(call)) {
+      needsCopy = true;
+    }
+    else if (FnSymbol *callee = call->resolvedFunction()) {
+      if (callee->name == fn->name &&
+          getUncheckedAccessor(callee, cache, depth+1) != NULL) {
+        needsCopy = true;
+      }
+    }
+  }
+
+  if (!needsCopy) {
+    return NULL;
+  }
+
+  SET_LINENO(fn);
+  FnSymbol *unchecked = fn->copy();
+  unchecked->cname = astr(fn->cname, "_nobc");
+  fn->defPoint->insertBefore(new DefExpr(unchecked));
+  cache[fn] = unchecked;
+
+  calls.clear();
+  collectFnCalls(unchecked->body, calls);
+  for_vector(CallExpr, call, calls) {
+    if (isBoundsCheckStmt(call)) {
+      call->remove();
+    }
+    else if (FnSymbol *callee = call->resolvedFunction()) {
+      if (callee->name == fn->name) {
+        if (FnSymbol *uncheckedCallee = cache[callee]) {
+          call->baseExpr->replace(new SymExpr(uncheckedCallee));
+        }
+      }
+    }
+  }
+
+  return unchecked;
+}
+
+static void removeProvenBoundsChecks() {
+  std::map<FnSymbol *, FnSymbol *> cache;
+
+  for_set(CallExpr, access, inBoundsAccesses) {
+    if (!access->inTree()) {
+      continue;
+    }
+
+    // an access with several return intents to pick from keeps them all
+    // until cullOverReferences, so update each of them
+    std::vector<CallExpr *> options;
+    if (ContextCallExpr *cc = toContextCallExpr(access->parentExpr)) {
+      for_alist(option, cc->options) {
+        options.push_back(toCallExpr(option));
+      }
+    }
+    else {
+      options.push_back(access);
+    }
+
+    for_vector(CallExpr, option, options) {
+      if (FnSymbol *fn = option->resolvedFunction()) {
+        if (FnSymbol *unchecked = getUncheckedAccessor(fn, cache, 0)) {
+          SET_LINENO(option);
+          option->baseExpr->replace(new SymExpr(unchecked));
+          LOG_ALA(0, "Access is in bounds. Removed its bounds check", option);
+        }
+      }
+    }
+  }
+  inBoundsAccesses.clear();
+}
+
 void finalizeForallOptimizationsResolution() {
+  removeProvenBoundsChecks();
+
   if (fVerify) {
     for_alive_in_Vec (CallExpr, callExpr, gCallExprs) {
       if (callExpr->isPrimitive(PRIM_MAYBE_LOCAL_THIS) ||
@@ -573,6 +726,11 @@ static void LOGLN_AA(BaseAST *node) {
   LOGLN_help(node, fAutoAggregation && fReportAutoAggregation);
 }
 
+static bool LOG_ABT(int depth, const char *msg, BaseAST *node) {
+  return LOG_help(depth, msg, node, NOT_CLONE,
+                  fAutoBulkTransfer && fReportAutoBulkTransfer);
+}
+
 static bool LOG_ALA(int depth, const char *msg, BaseAST *node,
                     bool forallDetails) {
   ForallAutoLocalAccessCloneType cloneType = NOT_CLONE;
@@ -1208,10 +1366,37 @@ static Symbol *generateStaticCheckForAccess(CallExpr *access,
   }
 }
 
+// Does the body of 'forall' mention the domain of the static candidate
+// 'candidate', or the domain the loop iterates over? If so, it might change
+// the domain while iterating, and the access can't be assumed in bounds.
+static bool loopMayChangeAccessDomain(ForallStmt *forall, CallExpr *candidate,
+                                      int iterandIdx) {
+  std::set<Symbol *> domSyms;
+  if (Symbol *iterSym = forall->optInfo.iterSym[iterandIdx]) {
+    domSyms.insert(iterSym);
+  }
+  if (Symbol *dotDomIterSymDom = forall->optInfo.dotDomIterSymDom[iterandIdx]) {
+    domSyms.insert(dotDomIterSymDom);
+  }
+  if (Symbol *accDomSym = getDomSym(getCallBase(candidate))) {
+    domSyms.insert(accDomSym);
+  }
+
+  std::vector<SymExpr *> symExprs;
+  collectSymExprs(forall->loopBody(), symExprs);
+  for_vector(SymExpr, se, symExprs) {
+    if (domSyms.count(se->symbol()) > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
 // replace a candidate CallExpr with the corresponding PRIM_MAYBE_LOCAL_THIS
 static CallExpr* replaceCandidate(CallExpr *candidate,
                                   Symbol *staticCheckSym,
-                                  bool doStatic) {
+                                  bool doStatic,
+                                  bool inBounds) {
   SET_LINENO(candidate);
 
   Symbol *callBase = getCallBase(candidate);
@@ -1228,6 +1413,10 @@ static CallExpr* replaceCandidate(CallExpr *candidate,
   // accurate logging
   repl->insertAtTail(new SymExpr(doStatic?gTrue:gFalse));
 
+  // mark if this access is known to be in bounds, so that its bounds check
+  // can be removed
+  repl->insertAtTail(new SymExpr(inBounds?gTrue:gFalse));
+
   candidate->replace(repl);
 
   return repl;
@@ -1261,7 +1450,14 @@ static void optimizeLoop(ForallStmt *forall,
                                     dynamicCond);
     }
 
-    replaceCandidate(candidate, checkSym, doStatic);
+    bool inBounds = doStatic &&
+                    !loopMayChangeAccessDomain(forall, candidate, iterandIdx);
+    if (doStatic && !inBounds) {
+      LOG_ALA(3, "Loop may change the access's domain. Keeping bounds check",
+              candidate);
+    }
+
+    replaceCandidate(candidate, checkSym, doStatic, inBounds);
   }
 }
 
@@ -1575,9 +1771,10 @@ static CallExpr *revertAccess(CallExpr *call) {
   CallExpr *repl = new CallExpr(new UnresolvedSymExpr("this"),
                                 gMethodToken);
 
-  // Don't take the last two args; they are the static control symbol, and flag
-  // that tells whether this is a statically-determined access
-  for (int i = 1 ; i < call->argList.length-1 ; i++) {
+  // Don't take the last three args; they are the static control symbol, the
+  // flag that tells whether this is a statically-determined access and the
+  // flag that tells whether it is known to be in bounds
+  for (int i = 1 ; i < call->argList.length-2 ; i++) {
     Symbol *argSym = toSymExpr(call->get(i))->symbol();
     repl->insertAtTail(new SymExpr(argSym));
   }
@@ -1586,7 +1783,7 @@ static CallExpr *revertAccess(CallExpr *call) {
 }
 
 static CallExpr *confirmAccess(CallExpr *call) {
-  if (toSymExpr(call->get(call->argList.length))->symbol() == gTrue) {
+  if (toSymExpr(call->get(call->argList.length-1))->symbol() == gTrue) {
     LOG_ALA(0, "Static check successful. Using localAccess", call,
             /*forallDetails=*/true);
   }
@@ -1597,9 +1794,10 @@ static CallExpr *confirmAccess(CallExpr *call) {
   CallExpr *repl = new CallExpr(new UnresolvedSymExpr("localAccess"),
                                 gMethodToken);
 
-  // Don't take the last two args; they are the static control symbol, and flag
-  // that tells whether this is a statically-determined access
-  for (int i = 1 ; i < call->argList.length-1 ; i++) {
+  // Don't take the last three args; they are the static control symbol, the
+  // flag that tells whether this is a statically-determined access and the
+  // flag that tells whether it is known to be in bounds
+  for (int i = 1 ; i < call->argList.length-2 ; i++) {
     Symbol *argSym = toSymExpr(call->get(i))->symbol();
     repl->insertAtTail(new SymExpr(argSym));
   }
@@ -1702,6 +1900,12 @@ static void autoAggregation(ForallStmt *forall) {
 
             insertAggCandidate(lastCall, forall);
           }
+          else {
+            reportUnsupportedAggCandidate(lastCall, forall);
+          }
+        }
+        else {
+          reportUnsupportedAggCandidate(lastCall, forall);
         }
 
         if (reportedLoc) {
@@ -1915,6 +2119,82 @@ static bool assignmentSuitableForAggregation(CallExpr *call, ForallStmt *forall)
   return false;
 }
 
+// a remote element access is one we can't prove local, but whose base is a
+// symbol, the same thing we require of the nonlocal side of an aggregation
+// candidate
+static bool isRemoteElementAccess(Expr *expr, ForallStmt *forall) {
+  if (CallExpr *call = toCallExpr(expr)) {
+    if (!canBeLocalAccess(call) &&
+        !call->isPrimitive(PRIM_MAYBE_LOCAL_ARR_ELEM)) {
+      return getCallBaseSymIfSuitable(call, forall, /*checkArgs=*/false,
+                                      NULL) != NULL;
+    }
+  }
+  return false;
+}
+
+static bool isCompoundAssignment(CallExpr *call) {
+  static const char *ops[] = { "+=", "-=", "*=", "/=", "%=", "**=",
+                               "&=", "|=", "^=", "<<=", ">>=",
+                               "&&=", "||=" };
+  for (size_t i = 0; i < sizeof(ops) / sizeof(ops[0]); i++) {
+    if (call->isNamed(ops[i])) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// if `call` looks like `a[i].add(x)` or another non-fetching atomic
+// update, return `a[i]`
+static CallExpr *getAtomicUpdateElement(CallExpr *call) {
+  static const char *methods[] = { "add", "sub", "or", "and", "xor",
+                                   "write" };
+  if (CallExpr *baseCall = toCallExpr(call->baseExpr)) {
+    if (baseCall->isNamedAstr(astrSdot)) {
+      if (SymExpr *methodSE = toSymExpr(baseCall->get(2))) {
+        if (VarSymbol *methodSym = toVarSymbol(methodSE->symbol())) {
+          if (Immediate *imm = methodSym->immediate) {
+            for (size_t i = 0; i < sizeof(methods) / sizeof(methods[0]); i++) {
+              if (strcmp(imm->string_value(), methods[i]) == 0) {
+                return toCallExpr(baseCall->get(1));
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+  return NULL;
+}
+
+// The aggregators only copy, so unordered updates to remote elements and
+// reads into variables can't be aggregated.  Explain that, so that users
+// looking at the report can tell these apart from accesses we didn't
+// recognize at all.
+static void reportUnsupportedAggCandidate(CallExpr *call, ForallStmt *forall) {
+  if (call->isNamedAstr(astrSassign)) {
+    if (toSymExpr(call->get(1)) != NULL &&
+        isRemoteElementAccess(call->get(2), forall)) {
+      LOG_AA(1, "Will not aggregate a remote read into a variable: the value "
+                "would not be available until the aggregator is flushed",
+             call);
+    }
+  }
+  else if (isCompoundAssignment(call)) {
+    if (isRemoteElementAccess(call->get(1), forall)) {
+      LOG_AA(1, "Will not aggregate a compound assignment to a remote "
+                "element: aggregators only support `=`", call);
+    }
+  }
+  else if (CallExpr *elem = getAtomicUpdateElement(call)) {
+    if (isRemoteElementAccess(elem, forall)) {
+      LOG_AA(1, "Will not aggregate a non-fetching atomic update of a remote "
+                "element: it may be made unordered instead", call);
+    }
+  }
+}
+
 Expr *preFoldMaybeAggregateAssign(CallExpr *call) {
   INT_ASSERT(call->isPrimitive(PRIM_MAYBE_AGGREGATE_ASSIGN));
 
@@ -2452,3 +2732,312 @@ static bool isLocalAccess(CallExpr *call) {
 
   return false;
 }
+
+//
+// Support for automatic bulk transfer
+//
+
+// If `expr` is `X[idxSym]` for some variable or argument `X`, return `X`
+static Symbol *getElementCopyBase(Expr *expr, Symbol *idxSym) {
+  if (CallExpr *call = toCallExpr(expr)) {
+    if (call->numActuals() == 1) {
+      if (SymExpr *baseSE = toSymExpr(call->baseExpr)) {
+        Symbol *baseSym = baseSE->symbol();
+        if (SymExpr *argSE = toSymExpr(call->get(1))) {
+          if (argSE->symbol() == idxSym && baseSym != idxSym &&
+              (isVarSymbol(baseSym) || isArgSymbol(baseSym))) {
+            return baseSym;
+          }
+        }
+      }
+    }
+  }
+  return NULL;
+}
+
+// Turns
+//
+//   forall i in D do A[i] = B[i];
+//
+// into
+//
+//   param chpl__staticBulkTransferCheckSym = isArray(A) && isArray(B) &&
+//                                            (isDomain(D) || isRange(D));
+//   if chpl__staticBulkTransferCheckSym {
+//     A[D] = B[D];
+//   }
+//   else {
+//     forall i in D do A[i] = B[i];
+//   }
+//
+// The slice assignment lets the array implementations use bulk GETs and PUTs
+// (including strided ones) instead of one communication per element. The
+// check can't be made before resolution, so the original loop is kept and
+// the branch that isn't taken is removed when the param condition is folded.
+// `D` can only be a symbol or `X.domain`, so evaluating it more than once is
+// harmless.
+static void autoBulkTransfer(ForallStmt *forall) {
+  if (forall->getModule()->modTag != MOD_USER) return;
+
+  LOG_ABT(0, "Start analyzing forall for automatic bulk transfer", forall);
+
+  if (forall->zippered() ||
+      forall->numInductionVars() != 1 ||
+      forall->numIteratedExprs() != 1 ||
+      forall->numShadowVars() != 0) {
+    LOG_ABT(1, "Loop is zippered or has shadow variables", forall);
+    return;
+  }
+
+  Expr *iterExpr = forall->iteratedExpressions().head;
+  if (!isSymExpr(iterExpr) && getDotDomBaseSym(iterExpr) == NULL) {
+    LOG_ABT(1, "Iterand is not a symbol or a `.domain` expression", forall);
+    return;
+  }
+
+  DefExpr *idxDef = toDefExpr(forall->inductionVariables().head);
+  Symbol *idxSym = idxDef->sym;
+  if (idxSym->hasFlag(FLAG_INDEX_OF_INTEREST)) {
+    LOG_ABT(1, "Loop index is a tuple", forall);
+    return;
+  }
+
+  BlockStmt *body = forall->loopBody();
+  CallExpr *assign = NULL;
+  if (body->body.length == 1) {
+    assign = toCallExpr(body->body.head);
+  }
+  if (assign == NULL || !assign->isNamedAstr(astrSassign)) {
+    LOG_ABT(1, "Loop body is not a single assignment", forall);
+    return;
+  }
+
+  Symbol *lhsBase = getElementCopyBase(assign->get(1), idxSym);
+  Symbol *rhsBase = getElementCopyBase(assign->get(2), idxSym);
+  if (lhsBase == NULL || rhsBase == NULL) {
+    LOG_ABT(1, "Assignment is not an element-wise copy", assign);
+    return;
+  }
+  if (lhsBase == rhsBase) {
+    LOG_ABT(1, "Source and destination are the same symbol", assign);
+    return;
+  }
+
+  LOG_ABT(1, "Replacing with a slice assignment", assign);
+
+  SET_LINENO(forall);
+
+  VarSymbol *checkSym = new VarSymbol("chpl__staticBulkTransferCheckSym");
+  checkSym->addFlag(FLAG_PARAM);
+  // mark it with FLAG_TEMP to prevent the normalizer from adding
+  // PRIM_END_OF_STATEMENT in the wrong places for loops.
+  checkSym->addFlag(FLAG_TEMP);
+
+  CallExpr *iterCheck = new CallExpr("||",
+                                     new CallExpr("isDomain", iterExpr->copy()),
+                                     new CallExpr("isRange", iterExpr->copy()));
+  CallExpr *checkCall = new CallExpr("&&",
+                                     new CallExpr("isArray", lhsBase),
+                                     new CallExpr("isArray", rhsBase));
+  checkCall = new CallExpr("&&", checkCall, iterCheck);
+  forall->insertBefore(new DefExpr(checkSym, checkCall));
+
+  CallExpr *sliceAssign = new CallExpr(astrSassign,
+                                       new CallExpr(new SymExpr(lhsBase),
+                                                    iterExpr->copy()),
+                                       new CallExpr(new SymExpr(rhsBase),
+                                                    iterExpr->copy()));
+
+  BlockStmt *thenBlock = new BlockStmt(sliceAssign);
+  BlockStmt *elseBlock = new BlockStmt();
+  CondStmt *cond = new CondStmt(new SymExpr(checkSym), thenBlock, elseBlock);
+
+  forall->insertAfter(cond);
+  elseBlock->insertAtTail(forall->remove());
+}
+
+//
+// Support for automatic prefetching
+//
+
+static const char *prefetchIdxName = "chpl_prefetchIdx";
+
+static bool hasPrefetchBlock(ForallStmt *forall) {
+  std::vector<DefExpr *> defs;
+  collectDefExprs(forall->loopBody(), defs);
+  for_vector(DefExpr, def, defs) {
+    if (strcmp(def->sym->name, prefetchIdxName) == 0) return true;
+  }
+  return false;
+}
+
+// Builds
+//
+//   const chpl_prefetchIdx = i + distance;
+//   if B.domain.contains(chpl_prefetchIdx) {
+//     const chpl_prefetchElt = B[chpl_prefetchIdx];
+//     if A.domain.contains(chpl_prefetchElt) {
+//       ref chpl_prefetchRef = A[chpl_prefetchElt];
+//       __primitive("prefetch", chpl_prefetchRef);
+//     }
+//   }
+//
+// for the access `A[B[i]]`, where `outer` is `A[...]` and `inner` is `B[i]`.
+static BlockStmt *buildPrefetch(CallExpr *outer, CallExpr *inner,
+                                Symbol *idxSym) {
+  BlockStmt *ret = new BlockStmt();
+
+  VarSymbol *idx = new VarSymbol(prefetchIdxName);
+  idx->addFlag(FLAG_CONST);
+  ret->insertAtTail(new DefExpr(idx,
+                                new CallExpr("+", idxSym,
+                                             new_IntSymbol(fPrefetchDistance))));
+
+  VarSymbol *elt = new VarSymbol("chpl_prefetchElt");
+  elt->addFlag(FLAG_CONST);
+
+  VarSymbol *ref = new VarSymbol("chpl_prefetchRef");
+  ref->addFlag(FLAG_REF_VAR);
+
+  BlockStmt *eltBlock = new BlockStmt();
+  eltBlock->insertAtTail(new DefExpr(ref, new CallExpr(outer->baseExpr->copy(),
+                                                       elt)));
+  eltBlock->insertAtTail(new CallExpr(PRIM_PREFETCH, ref));
+
+  BlockStmt *idxBlock = new BlockStmt();
+  idxBlock->insertAtTail(new DefExpr(elt, new CallExpr(inner->baseExpr->copy(),
+                                                       idx)));
+  Expr *outerDom = buildDotExpr(outer->baseExpr->copy(), "domain");
+  idxBlock->insertAtTail(new CondStmt(new CallExpr(buildDotExpr(outerDom,
+                                                                "contains"),
+                                                   elt),
+                                      eltBlock));
+
+  Expr *innerDom = buildDotExpr(inner->baseExpr->copy(), "domain");
+  ret->insertAtTail(new CondStmt(new CallExpr(buildDotExpr(innerDom,
+                                                           "contains"),
+                                              idx),
+                                 idxBlock));
+  return ret;
+}
+
+// Turns
+//
+//   forall i in D do ... A[B[i]] ...;
+//
+// into
+//
+//   param chpl__prefetchCheckSym = isDomain(D) && isArray(B) && isArray(A);
+//   forall i in D {
+//     if chpl__prefetchCheckSym {
+//       if D.rank == 1 && B.rank == 1 && A.rank == 1 &&
+//          isIntegral(B.eltType) {
+//         // see buildPrefetch
+//       }
+//     }
+//     ... A[B[i]] ...;
+//   }
+//
+// The iterations of a forall are order independent, but each task runs its
+// indices in order, so the element `distance` indices from now is usually the
+// one the task needs next once this iteration's latency has passed. The
+// `contains` checks keep the prefetch from reaching outside either array.
+// Only the address is needed, so a remote element is prefetched into the
+// remote data cache and a local one into the processor's caches. Iterations
+// with non-unit strides prefetch indices that may not be visited.
+static void autoPrefetch(ForallStmt *forall) {
+  if (forall->getModule()->modTag != MOD_USER) return;
+
+  if (forall->zippered() ||
+      forall->numInductionVars() != 1 ||
+      forall->numIteratedExprs() != 1) {
+    return;
+  }
+
+  Expr *iterExpr = forall->iteratedExpressions().head;
+  if (!isSymExpr(iterExpr) && getDotDomBaseSym(iterExpr) == NULL) {
+    return;
+  }
+
+  DefExpr *idxDef = toDefExpr(forall->inductionVariables().head);
+  Symbol *idxSym = idxDef->sym;
+  if (idxSym->hasFlag(FLAG_INDEX_OF_INTEREST)) return;
+
+  // clones of loops that we have already handled
+  if (hasPrefetchBlock(forall)) return;
+
+  std::vector<CallExpr *> calls;
+  collectCallExprs(forall->loopBody(), calls);
+
+  std::set<std::pair<Symbol *, Symbol *> > seen;
+  std::vector<std::pair<CallExpr *, CallExpr *> > accesses;
+  for_vector(CallExpr, call, calls) {
+    if (call->numActuals() != 1) continue;
+
+    CallExpr *inner = toCallExpr(call->get(1));
+    if (inner == NULL ||
+        inner->numActuals() != 1 ||
+        !isSymExpr(inner->get(1)) ||
+        toSymExpr(inner->get(1))->symbol() != idxSym) {
+      continue;
+    }
+
+    Symbol *outerBase = getCallBaseSymIfSuitable(call, forall,
+                                                 /*checkArgs=*/false, NULL);
+    Symbol *innerBase = getCallBaseSymIfSuitable(inner, forall,
+                                                 /*checkArgs=*/false, NULL);
+    if (outerBase == NULL || innerBase == NULL || outerBase == innerBase) {
+      continue;
+    }
+
+    if (seen.insert(std::make_pair(outerBase, innerBase)).second) {
+      accesses.push_back(std::make_pair(call, inner));
+    }
+  }
+
+  if (accesses.empty()) return;
+
+  SET_LINENO(forall);
+
+  VarSymbol *checkSym = new VarSymbol("chpl__prefetchCheckSym");
+  checkSym->addFlag(FLAG_PARAM);
+  // mark it with FLAG_TEMP to prevent the normalizer from adding
+  // PRIM_END_OF_STATEMENT in the wrong places for loops.
+  checkSym->addFlag(FLAG_TEMP);
+
+  CallExpr *checkCall = new CallExpr("isDomain", iterExpr->copy());
+  CallExpr *rankCheck = new CallExpr("==",
+                                     buildDotExpr(iterExpr->copy(), "rank"),
+                                     new_IntSymbol(1));
+  BlockStmt *prefetches = new BlockStmt();
+
+  for (auto& access : accesses) {
+    CallExpr *outer = access.first;
+    CallExpr *inner = access.second;
+
+    checkCall = new CallExpr("&&", checkCall,
+                             new CallExpr("isArray", outer->baseExpr->copy()));
+    checkCall = new CallExpr("&&", checkCall,
+                             new CallExpr("isArray", inner->baseExpr->copy()));
+
+    Expr *outerRank = buildDotExpr(outer->baseExpr->copy(), "rank");
+    Expr *innerRank = buildDotExpr(inner->baseExpr->copy(), "rank");
+    Expr *innerEltType = buildDotExpr(inner->baseExpr->copy(), "eltType");
+    rankCheck = new CallExpr("&&", rankCheck,
+                             new CallExpr("==", outerRank, new_IntSymbol(1)));
+    rankCheck = new CallExpr("&&", rankCheck,
+                             new CallExpr("==", innerRank, new_IntSymbol(1)));
+    rankCheck = new CallExpr("&&", rankCheck,
+                             new CallExpr("isIntegral", innerEltType));
+
+    prefetches->insertAtTail(buildPrefetch(outer, inner, idxSym));
+  }
+
+  forall->insertBefore(new DefExpr(checkSym, checkCall));
+
+  // the rank checks can only be resolved once we know these are arrays
+  CondStmt *rankCond = new CondStmt(rankCheck, prefetches);
+  CondStmt *cond = new CondStmt(new SymExpr(checkSym),
+                                new BlockStmt(rankCond));
+  forall->loopBody()->insertAtHead(cond);
+}
@@ -416,6 +416,8 @@ public:
 
   CForLoop* cpuLoop() const { return loop_; }
   CForLoop* gpuLoop() const { return gpuLoop_; }
+  CondStmt* gpuCond() const { return gpuCond_; }
+  BlockStmt* gpuBlock() const { return gpuBlock_; }
 
   bool isEligible() const { return isEligible_; }
   Symbol* upperBound() const { return upperBound_; }
@@ -428,8 +430,8 @@ public:
 
   CForLoop* generateGpuAndNonGpuPaths();
   void makeCpuOnly() const;
-  void makeGpuOnly() const;
-  void fixupNonGpuPath() const;
+  void makeGpuOnly(bool kernelRunsOnHost) const;
+  void fixupNonGpuPath(bool kernelRunsOnHost) const;
 
 private:
   CallExpr* findCompileTimeGpuAssertions();
@@ -531,7 +533,8 @@ void GpuizableLoop::printNonGpuizableError(CallExpr* assertion, Expr* loc) {
 }
 
 bool GpuizableLoop::isAlreadyInGpuKernel() {
-  return this->parentFn_->hasFlag(FLAG_GPU_CODEGEN);
+  return this->parentFn_->hasFlag(FLAG_GPU_CODEGEN) ||
+         this->parentFn_->hasFlag(FLAG_GPU_HOST_KERNEL);
 }
 
 bool GpuizableLoop::evaluateLoop() {
@@ -754,14 +757,35 @@ void GpuizableLoop::reportNotGpuizable(const BaseAST* ast, const char *msg) {
 //    - Contains a copy of loop's body
 //    - Passes in any variables that are declared outside of the loop as
 //      parameters to this new function.
+//
+// When the body of the loop is nothing but another foreach loop whose bounds
+// are computed outside of the outer loop (after LICM this is what a nest
+// like `foreach i in 0..<n do foreach j in 0..<m` looks like), up to three
+// such loops are collapsed into one 2D or 3D kernel launch. The innermost
+// loop goes along X so that neighboring threads access neighboring
+// elements, and each thread gets its indices straight from its block and
+// thread IDs instead of dividing a flat index.
+
+// One dimension of the iteration space of a kernel
+struct GpuKernelDim {
+  CForLoop* loop = nullptr;
+  std::vector<Symbol*> loopIndices;
+  std::vector<Symbol*> lowerBounds;
+  Symbol* upperBound = nullptr;
+};
+
 class GpuKernel {
   const GpuizableLoop &gpuLoop;
   FnSymbol* fn_;
-  std::vector<Symbol*> kernelIndices_;
+  std::vector<GpuKernelDim> dims_; // outermost loop first
+  std::vector<Symbol*> kernelIndices_; // first index of each dimension
   std::vector<Symbol*> kernelActuals_;
   SymbolMap copyMap_;
   bool lateGpuizationFailure_;
-  SymExpr* blockSize_;
+  std::vector<SymExpr*> blockShape_;
+  bool dependsOnBlockSize_;
+  bool runsOnHost_;
+  BlockStmt* hostLoopBody_;
 
   public:
   GpuKernel(const GpuizableLoop &gpuLoop, DefExpr* insertionPoint);
@@ -769,9 +793,15 @@ class GpuKernel {
   FnSymbol* fn() const { return fn_; }
   const std::vector<Symbol*>& kernelActuals() { return kernelActuals_; }
   bool lateGpuizationFailure() const { return lateGpuizationFailure_; }
-  SymExpr* blockSize() const {return blockSize_; }
+  const std::vector<GpuKernelDim>& dims() const { return dims_; }
+  const std::vector<SymExpr*>& blockShape() const { return blockShape_; }
+  bool dependsOnBlockSize() const { return dependsOnBlockSize_; }
+  bool runsOnHost() const { return runsOnHost_; }
 
   private:
+  void findLoopNestToCollapse();
+  bool isCollapsedIndex(Symbol* sym) const;
+  bool canRunOnHost() const;
   void buildStubOutlinedFunction(DefExpr* insertionPoint);
   void determineBlockSize();
   static bool isCallToPrimitiveWeShouldNotCopyIntoKernel(CallExpr *call);
@@ -781,6 +811,9 @@ class GpuKernel {
 
   void generateIndexComputation();
   void generateEarlyReturn();
+  void generateHostLoop();
+  void insertIntoBody(Expr* expr);
+  void aggregateAtomicUpdates();
   void markGPUSubCalls(FnSymbol* fn);
   Symbol* addKernelArgument(Symbol* symInLoop);
   Symbol* addLocalVariable(Symbol* symInLoop);
@@ -789,17 +822,170 @@ class GpuKernel {
 GpuKernel::GpuKernel(const GpuizableLoop &gpuLoop, DefExpr* insertionPoint)
   : gpuLoop(gpuLoop)
   , lateGpuizationFailure_(false)
-  , blockSize_(nullptr)
+  , dependsOnBlockSize_(false)
+  , runsOnHost_(false)
+  , hostLoopBody_(nullptr)
 {
+  findLoopNestToCollapse();
+  runsOnHost_ = canRunOnHost();
   buildStubOutlinedFunction(insertionPoint);
   normalizeOutlinedFunction();
   determineBlockSize();
   populateBody(fn_);
   if(!lateGpuizationFailure_) {
+    aggregateAtomicUpdates();
     finalize();
   }
 }
 
+// Returns the only loop in the body of 'loop' if nothing else in the body
+// would have to run once per iteration of 'loop'.
+static CForLoop* findPerfectlyNestedLoop(CForLoop* loop) {
+  CForLoop* nested = nullptr;
+
+  for_alist(node, loop->body) {
+    if (isDefExpr(node)) {
+      continue;
+    } else if (CallExpr* call = toCallExpr(node)) {
+      if (call->isPrimitive(PRIM_GPU_ELIGIBLE) ||
+          call->isPrimitive(PRIM_ASSERT_ON_GPU) ||
+          call->isPrimitive(PRIM_GPU_SET_BLOCKSIZE)) {
+        continue;
+      }
+    } else if (CForLoop* cfl = toCForLoop(node)) {
+      if (nested == nullptr && cfl->isOrderIndependent()) {
+        nested = cfl;
+        continue;
+      }
+    }
+    return nullptr;
+  }
+
+  return nested;
+}
+
+// Pattern matches the same loop header as
+// GpuizableLoop::extractIndicesAndLowerBounds and extractUpperBound, and
+// also requires the indices to be incremented by one.
+static bool extractLoopDim(CForLoop* loop, GpuKernelDim& dim) {
+  dim.loop = loop;
+
+  BlockStmt* init = loop->initBlockGet();
+  BlockStmt* test = loop->testBlockGet();
+  BlockStmt* incr = loop->incrBlockGet();
+  if (!init || !test || !incr) return false;
+
+  for_alist (expr, init->body) {
+    CallExpr* call = toCallExpr(expr);
+    if (!call || !(call->isPrimitive(PRIM_ASSIGN) ||
+                   call->isPrimitive(PRIM_MOVE))) {
+      return false;
+    }
+    SymExpr* idxSymExpr = toSymExpr(call->get(1));
+    SymExpr* boundSymExpr = toSymExpr(call->get(2));
+    if (!idxSymExpr || !boundSymExpr) return false;
+
+    dim.loopIndices.push_back(idxSymExpr->symbol());
+    dim.lowerBounds.push_back(boundSymExpr->symbol());
+  }
+  if (dim.loopIndices.empty()) return false;
+
+  for_exprs_postorder (expr, test) {
+    if (CallExpr* call = toCallExpr(expr)) {
+      if (call->isPrimitive(PRIM_LESSOREQUAL)) {
+        SymExpr* lhsSymExpr = toSymExpr(call->get(1));
+        SymExpr* rhsSymExpr = toSymExpr(call->get(2));
+        if (lhsSymExpr && rhsSymExpr &&
+            lhsSymExpr->symbol() == dim.loopIndices[0]) {
+          dim.upperBound = rhsSymExpr->symbol();
+          break;
+        }
+      }
+    }
+  }
+  if (dim.upperBound == nullptr) return false;
+
+  size_t numIncrements = 0;
+  for_alist (expr, incr->body) {
+    CallExpr* call = toCallExpr(expr);
+    if (!call || !call->isPrimitive(PRIM_ADD_ASSIGN)) return false;
+
+    SymExpr* idxSymExpr = toSymExpr(call->get(1));
+    SymExpr* strideSymExpr = toSymExpr(call->get(2));
+    if (!idxSymExpr || !strideSymExpr) return false;
+
+    VarSymbol* stride = toVarSymbol(strideSymExpr->symbol());
+    if (!stride || !stride->immediate ||
+        (stride->immediate->const_kind != NUM_KIND_INT &&
+         stride->immediate->const_kind != NUM_KIND_UINT) ||
+        stride->immediate->to_int() != 1) {
+      return false;
+    }
+    if (std::find(dim.loopIndices.begin(), dim.loopIndices.end(),
+                  idxSymExpr->symbol()) == dim.loopIndices.end()) {
+      return false;
+    }
+    numIncrements++;
+  }
+
+  return numIncrements == dim.loopIndices.size();
+}
+
+void GpuKernel::findLoopNestToCollapse() {
+  CForLoop* outerLoop = gpuLoop.gpuLoop();
+
+  GpuKernelDim outerDim;
+  outerDim.loop = outerLoop;
+  outerDim.loopIndices = gpuLoop.loopIndices();
+  outerDim.lowerBounds = gpuLoop.lowerBounds();
+  outerDim.upperBound = gpuLoop.upperBound();
+  dims_.push_back(outerDim);
+
+  while (dims_.size() < 3) {
+    CForLoop* nested = findPerfectlyNestedLoop(dims_.back().loop);
+    if (nested == nullptr) break;
+
+    GpuKernelDim dim;
+    if (!extractLoopDim(nested, dim)) break;
+
+    // The shape of the grid is computed before the launch, so the bounds
+    // can't depend on the indices of the enclosing loops.
+    bool boundsAreInvariant = !isDefinedInTheLoops(dim.upperBound,
+                                                   {outerLoop});
+    for_vector(Symbol, lowerBound, dim.lowerBounds) {
+      if (isDefinedInTheLoops(lowerBound, {outerLoop})) {
+        boundsAreInvariant = false;
+      }
+    }
+    if (!boundsAreInvariant) break;
+
+    // Jumping out of the nested loop would skip the rest of its iterations,
+    // which run on other threads once it is collapsed.
+    bool hasJumpOut = false;
+    std::vector<GotoStmt*> gotos;
+    collectGotoStmts(nested, gotos);
+    for_vector(GotoStmt, gotoStmt, gotos) {
+      SymExpr* label = toSymExpr(gotoStmt->label);
+      if (!label || !isDefinedInTheLoops(label->symbol(), {nested})) {
+        hasJumpOut = true;
+      }
+    }
+    if (hasJumpOut) break;
+
+    dims_.push_back(dim);
+  }
+}
+
+bool GpuKernel::isCollapsedIndex(Symbol* sym) const {
+  for (size_t d = 1; d < dims_.size(); d++) {
+    const std::vector<Symbol*>& indices = dims_[d].loopIndices;
+    if (std::find(indices.begin(), indices.end(), sym) != indices.end()) {
+      return true;
+    }
+  }
+  return false;
+}
+
 static const char* getLoopName(CForLoop* loop) {
   auto filename = loop->astloc.filename();
   auto line = loop->astloc.stringLineno();
@@ -814,10 +1000,15 @@ void GpuKernel::buildStubOutlinedFunction(DefExpr* insertionPoint) {
 
   fn_->addFlag(FLAG_RESOLVED);
   fn_->addFlag(FLAG_ALWAYS_RESOLVE);
-  fn_->addFlag(FLAG_GPU_CODEGEN);
 
-  generateIndexComputation();
-  generateEarlyReturn();
+  if (runsOnHost_) {
+    fn_->addFlag(FLAG_GPU_HOST_KERNEL);
+    generateHostLoop();
+  } else {
+    fn_->addFlag(FLAG_GPU_CODEGEN);
+    generateIndexComputation();
+    generateEarlyReturn();
+  }
 
   insertionPoint->insertBefore(new DefExpr(fn_));
 }
@@ -846,61 +1037,79 @@ Symbol* GpuKernel::addLocalVariable(Symbol* symInLoop) {
 }
 
 /**
- *  For each loopIndex, generates and inserts the following AST into fn:
+ *  For each dimension, generates and inserts the following AST into fn,
+ *  where X is the axis of the dimension (the innermost loop uses X, the
+ *  one around it Y and the outermost of three loops Z):
  *
  *  blockIdxX  = __primitive('gpu blockIdx x')
  *  blockDimX  = __primitive('gpu blockDim x')
  *  threadIdxX = __primitive('gpu threadIdx x')
  *  t0 = varBlockIdxX * varBlockDimX
  *  t1 = t0 + threadIdxX
+ *
+ *  and for each loopIndex of the dimension:
+ *
  *  index = t1 + lowerBound
  *
  *  Also adds the loopIndex->index to the copyMap_
  **/
 void GpuKernel::generateIndexComputation() {
-  std::vector<Symbol*>::size_type numIndices = gpuLoop.loopIndices().size();
-  INT_ASSERT(gpuLoop.lowerBounds().size() == numIndices);
-
-  for (std::vector<Symbol*>::size_type i=0 ; i<numIndices ; i++) {
-    Symbol* loopIndex  = gpuLoop.loopIndices()[i];
-    Symbol* lowerBound = gpuLoop.lowerBounds()[i];
+  static const PrimitiveTag blockIdxPrims[] = {
+    PRIM_GPU_BLOCKIDX_X, PRIM_GPU_BLOCKIDX_Y, PRIM_GPU_BLOCKIDX_Z };
+  static const PrimitiveTag blockDimPrims[] = {
+    PRIM_GPU_BLOCKDIM_X, PRIM_GPU_BLOCKDIM_Y, PRIM_GPU_BLOCKDIM_Z };
+  static const PrimitiveTag threadIdxPrims[] = {
+    PRIM_GPU_THREADIDX_X, PRIM_GPU_THREADIDX_Y, PRIM_GPU_THREADIDX_Z };
+  static const char* axisNames[] = { "X", "Y", "Z" };
+
+  for (size_t d = 0; d < dims_.size(); d++) {
+    const GpuKernelDim& dim = dims_[d];
+    size_t axis = dims_.size() - 1 - d;
+    INT_ASSERT(dim.lowerBounds.size() == dim.loopIndices.size());
 
     // we want some of these variables to be 64-bits to be able to avoid
     // overflows in number of threads.
-    VarSymbol *varBlockIdxX = generateAssignmentToPrimitive(fn_, "blockIdxX",
-      PRIM_GPU_BLOCKIDX_X, dtInt[INT_SIZE_64]);
-    VarSymbol *varBlockDimX = generateAssignmentToPrimitive(fn_, "blockDimX",
-      PRIM_GPU_BLOCKDIM_X, dtInt[INT_SIZE_32]);
-    VarSymbol *varThreadIdxX = generateAssignmentToPrimitive(fn_, "threadIdxX",
-      PRIM_GPU_THREADIDX_X, dtInt[INT_SIZE_32]);
+    VarSymbol *varBlockIdx = generateAssignmentToPrimitive(fn_,
+      astr("blockIdx", axisNames[axis]), blockIdxPrims[axis],
+      dtInt[INT_SIZE_64]);
+    VarSymbol *varBlockDim = generateAssignmentToPrimitive(fn_,
+      astr("blockDim", axisNames[axis]), blockDimPrims[axis],
+      dtInt[INT_SIZE_32]);
+    VarSymbol *varThreadIdx = generateAssignmentToPrimitive(fn_,
+      astr("threadIdx", axisNames[axis]), threadIdxPrims[axis],
+      dtInt[INT_SIZE_32]);
 
     VarSymbol *tempVar = insertNewVarAndDef(fn_->body, "t0",
       dtInt[INT_SIZE_64]);
     CallExpr *c1 = new CallExpr(PRIM_MOVE, tempVar, new CallExpr(
-      PRIM_MULT, varBlockIdxX, varBlockDimX));
+      PRIM_MULT, varBlockIdx, varBlockDim));
     fn_->insertAtTail(c1);
 
     VarSymbol *tempVar1 = insertNewVarAndDef(fn_->body, "t1",
       dtInt[INT_SIZE_64]);
     CallExpr *c2 = new CallExpr(PRIM_MOVE, tempVar1, new CallExpr(
-      PRIM_ADD, tempVar, varThreadIdxX));
+      PRIM_ADD, tempVar, varThreadIdx));
     fn_->insertAtTail(c2);
 
-    Symbol* startOffset = addKernelArgument(lowerBound);
-    VarSymbol* index = insertNewVarAndDef(fn_->body, "chpl_simt_index",
-                                          dtInt[INT_SIZE_64]);
-    fn_->insertAtTail(new CallExpr(PRIM_MOVE, index, new CallExpr(
-      PRIM_ADD, tempVar1, startOffset)));
+    for (size_t i = 0; i < dim.loopIndices.size(); i++) {
+      Symbol* startOffset = addKernelArgument(dim.lowerBounds[i]);
+      VarSymbol* index = insertNewVarAndDef(fn_->body, "chpl_simt_index",
+                                            dtInt[INT_SIZE_64]);
+      fn_->insertAtTail(new CallExpr(PRIM_MOVE, index, new CallExpr(
+        PRIM_ADD, tempVar1, startOffset)));
 
-    kernelIndices_.push_back(index);
-    copyMap_.put(loopIndex, index);
+      if (i == 0) {
+        kernelIndices_.push_back(index);
+      }
+      copyMap_.put(dim.loopIndices[i], index);
+    }
   }
 
-  INT_ASSERT(kernelIndices_.size() == gpuLoop.loopIndices().size());
+  INT_ASSERT(kernelIndices_.size() == dims_.size());
 }
 
 /*
- * Adds the following AST to a GPU kernel
+ * Adds the following AST to a GPU kernel for each dimension
  *
  * def chpl_is_oob;
  * chpl_is_oob = `calculated thread idx` > upperBound
@@ -910,19 +1119,121 @@ void GpuKernel::generateIndexComputation() {
  *
  */
 void GpuKernel::generateEarlyReturn() {
-  Symbol* localUpperBound = addKernelArgument(gpuLoop.upperBound());
+  for (size_t d = 0; d < dims_.size(); d++) {
+    Symbol* localUpperBound = addKernelArgument(dims_[d].upperBound);
 
-  VarSymbol* isOOB = new VarSymbol("chpl_is_oob", dtBool);
-  fn_->insertAtTail(new DefExpr(isOOB));
+    VarSymbol* isOOB = new VarSymbol("chpl_is_oob", dtBool);
+    fn_->insertAtTail(new DefExpr(isOOB));
 
-  CallExpr* comparison = new CallExpr(PRIM_GREATER,
-                                      kernelIndices_[0],
-                                      localUpperBound);
-  fn_->insertAtTail(new CallExpr(PRIM_MOVE, isOOB, comparison));
+    CallExpr* comparison = new CallExpr(PRIM_GREATER,
+                                        kernelIndices_[d],
+                                        localUpperBound);
+    fn_->insertAtTail(new CallExpr(PRIM_MOVE, isOOB, comparison));
 
-  BlockStmt* thenBlock = new BlockStmt();
-  thenBlock->insertAtTail(new CallExpr(PRIM_RETURN, gVoid));
-  fn_->insertAtTail(new CondStmt(new SymExpr(isOOB), thenBlock));
+    BlockStmt* thenBlock = new BlockStmt();
+    thenBlock->insertAtTail(new CallExpr(PRIM_RETURN, gVoid));
+    fn_->insertAtTail(new CondStmt(new SymExpr(isOOB), thenBlock));
+  }
+}
+
+/*
+ * With CHPL_GPU=cpu, a host kernel runs the threads the runtime gives it
+ * in a loop instead, which is order independent like the loop the kernel
+ * came from:
+ *
+ * proc kernel(chpl_first_thread, chpl_last_thread, ...) {
+ *   for (t1 = chpl_first_thread; t1 <= chpl_last_thread; t1 += 1) {
+ *     index = t1 + lowerBound    // for each loopIndex
+ *     <loop body>
+ *   }
+ * }
+ *
+ * The runtime never passes threads past the upper bound, so there is no
+ * early return.
+ */
+void GpuKernel::generateHostLoop() {
+  INT_ASSERT(dims_.size() == 1);
+  const GpuKernelDim& dim = dims_[0];
+  CForLoop* origLoop = gpuLoop.gpuLoop();
+
+  ArgSymbol* firstThread = new ArgSymbol(INTENT_IN, "chpl_first_thread",
+                                         dtInt[INT_SIZE_64]);
+  ArgSymbol* lastThread = new ArgSymbol(INTENT_IN, "chpl_last_thread",
+                                        dtInt[INT_SIZE_64]);
+  fn_->insertFormalAtTail(firstThread);
+  fn_->insertFormalAtTail(lastThread);
+
+  VarSymbol* threadIdx = insertNewVarAndDef(fn_->body, "t1",
+                                            dtInt[INT_SIZE_64]);
+  hostLoopBody_ = new BlockStmt();
+
+  CallExpr* header = new CallExpr(PRIM_BLOCK_C_FOR_LOOP,
+    new CallExpr(PRIM_MOVE, threadIdx, firstThread),
+    new CallExpr(PRIM_LESSOREQUAL, threadIdx, lastThread),
+    new CallExpr(PRIM_ADD_ASSIGN, threadIdx, new_IntSymbol(1)));
+  BlockStmt* loopBlock = CForLoop::buildCForLoop(header, hostLoopBody_,
+                                     origLoop->getAdditionalLLVMMetadata());
+  fn_->insertAtTail(loopBlock);
+
+  CForLoop* hostLoop = toCForLoop(loopBlock->body.head);
+  INT_ASSERT(hostLoop);
+  hostLoop->orderIndependentSet(true);
+  hostLoop->setHasVectorizationHazard(origLoop->hasVectorizationHazard());
+  hostLoop->setHasParallelAccessVectorizationHazard(
+    origLoop->hasParallelAccessVectorizationHazard());
+
+  for (size_t i = 0; i < dim.loopIndices.size(); i++) {
+    Symbol* startOffset = addKernelArgument(dim.lowerBounds[i]);
+    VarSymbol* index = new VarSymbol("chpl_simt_index", dtInt[INT_SIZE_64]);
+    insertIntoBody(new DefExpr(index));
+    insertIntoBody(new CallExpr(PRIM_MOVE, index, new CallExpr(
+      PRIM_ADD, threadIdx, startOffset)));
+
+    if (i == 0) {
+      kernelIndices_.push_back(index);
+    }
+    copyMap_.put(dim.loopIndices[i], index);
+  }
+}
+
+// Returns true if code in 'ast' or in the functions it calls uses the GPU
+// thread hierarchy directly, and may therefore rely on a particular block
+// size.
+static bool usesThreadHierarchy(BaseAST* ast, std::set<FnSymbol*>& visited) {
+  static const std::unordered_set<PrimitiveTag> threadHierarchyPrims = {
+    PRIM_GPU_ALLOC_SHARED, PRIM_GPU_SYNC_THREADS,
+    PRIM_GPU_THREADIDX_X, PRIM_GPU_THREADIDX_Y, PRIM_GPU_THREADIDX_Z,
+    PRIM_GPU_BLOCKIDX_X, PRIM_GPU_BLOCKIDX_Y, PRIM_GPU_BLOCKIDX_Z,
+    PRIM_GPU_BLOCKDIM_X, PRIM_GPU_BLOCKDIM_Y, PRIM_GPU_BLOCKDIM_Z,
+    PRIM_GPU_GRIDDIM_X, PRIM_GPU_GRIDDIM_Y, PRIM_GPU_GRIDDIM_Z,
+  };
+
+  std::vector<CallExpr*> calls;
+  collectCallExprs(ast, calls);
+  for_vector(CallExpr, call, calls) {
+    if (call->isPrimitive()) {
+      if (threadHierarchyPrims.count(call->primitive->tag)) return true;
+    } else if (FnSymbol* fn = call->resolvedFunction()) {
+      if (visited.insert(fn).second && usesThreadHierarchy(fn->body, visited)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+// A kernel can run on the host as a loop over the threads it is given if
+// nothing in it cares which block or thread it is, which keeps the loop
+// vectorizable. The others keep running as the serial CPU loop after the
+// launch. This requires the LLVM backend, which generates the entry point
+// the runtime calls the kernel through.
+bool GpuKernel::canRunOnHost() const {
+  if (isFullGpuCodegen() || !fLlvmCodegen || dims_.size() != 1) {
+    return false;
+  }
+
+  std::set<FnSymbol*> visited;
+  return !usesThreadHierarchy(gpuLoop.gpuLoop(), visited);
 }
 
 void GpuKernel::determineBlockSize() {
@@ -931,12 +1242,20 @@ void GpuKernel::determineBlockSize() {
     collectCallExprs(node, callExprsInBody);
   }
 
+  std::set<FnSymbol*> visited;
+  dependsOnBlockSize_ = usesThreadHierarchy(gpuLoop.gpuLoop(), visited);
+
   for_vector(CallExpr, callExpr, callExprsInBody) {
     if (callExpr->isPrimitive(PRIM_GPU_SET_BLOCKSIZE)) {
-      if (blockSize_ != nullptr) {
+      if (!blockShape_.empty()) {
         USR_FATAL(callExpr, "Can only set GPU block size once per GPU-eligible loop.");
       }
-      blockSize_ = toSymExpr(callExpr->get(1));
+      if (callExpr->numActuals() < 1 || callExpr->numActuals() > 3) {
+        USR_FATAL(callExpr, "GPU block size must have 1 to 3 dimensions.");
+      }
+      for_actuals(actual, callExpr) {
+        blockShape_.push_back(toSymExpr(actual));
+      }
     }
   }
 }
@@ -948,6 +1267,15 @@ bool GpuKernel::isCallToPrimitiveWeShouldNotCopyIntoKernel(CallExpr *call) {
          call->isPrimitive(PRIM_GPU_SET_BLOCKSIZE);
 }
 
+// Host kernels get the loop body inside their loop over the threads.
+void GpuKernel::insertIntoBody(Expr* expr) {
+  if (hostLoopBody_ != nullptr) {
+    hostLoopBody_->insertAtTail(expr);
+  } else {
+    fn_->insertBeforeEpilogue(expr);
+  }
+}
+
 void GpuKernel::populateBody(FnSymbol *outlinedFunction) {
   std::set<Symbol*> handledSymbols;
 
@@ -958,7 +1286,25 @@ void GpuKernel::populateBody(FnSymbol *outlinedFunction) {
   CForLoop* loopForBody = gpuLoop.gpuLoop();
   CForLoop* cloneOfLoop = gpuLoop.cpuLoop();
 
-  for_alist(node, loopForBody->body) {
+  // The body of the kernel is the body of the innermost collapsed loop.
+  // The loops around it only contribute their declarations.
+  std::vector<Expr*> nodes;
+  for (size_t d = 0; d < dims_.size(); d++) {
+    bool isInnermost = d == dims_.size() - 1;
+    for_alist(node, dims_[d].loop->body) {
+      if (DefExpr* def = toDefExpr(node)) {
+        if (isCollapsedIndex(def->sym)) continue;
+      } else if (d > 0 && isCallExpr(node) &&
+                 toCallExpr(node)->isPrimitive(PRIM_GPU_ELIGIBLE)) {
+        continue;
+      } else if (!isInnermost) {
+        continue;
+      }
+      nodes.push_back(node);
+    }
+  }
+
+  for_vector(Expr, node, nodes) {
     bool copyNode = true;
     std::vector<SymExpr*> symExprsInBody;
     collectSymExprs(node, symExprsInBody);
@@ -976,7 +1322,7 @@ void GpuKernel::populateBody(FnSymbol *outlinedFunction) {
       DefExpr* newDef = def->copy();
       this->copyMap_.put(def->sym, newDef->sym);
 
-      outlinedFunction->insertBeforeEpilogue(newDef);
+      insertIntoBody(newDef);
     }
     else {
       // We also need to copy any defs that appear in blocks.
@@ -985,7 +1331,7 @@ void GpuKernel::populateBody(FnSymbol *outlinedFunction) {
       for_vector(DefExpr, def, defExprsInBody) {
         DefExpr* newDef = def->copy();
         this->copyMap_.put(def->sym, newDef->sym);
-        outlinedFunction->insertBeforeEpilogue(newDef);
+        insertIntoBody(newDef);
       }
 
       for_vector(SymExpr, symExpr, symExprsInBody) {
@@ -1012,7 +1358,7 @@ void GpuKernel::populateBody(FnSymbol *outlinedFunction) {
         else if (isTypeSymbol(sym)) {
           // nothing to do
         }
-        else if (gpuLoop.isIndexVariable(sym)) {
+        else if (gpuLoop.isIndexVariable(sym) || isCollapsedIndex(sym)) {
           // These are handled already, nothing to do
         }
         else {
@@ -1058,7 +1404,7 @@ void GpuKernel::populateBody(FnSymbol *outlinedFunction) {
     }
 
     if (copyNode) {
-      outlinedFunction->insertBeforeEpilogue(node->copy());
+      insertIntoBody(node->copy());
     }
   }
 
@@ -1097,6 +1443,97 @@ void GpuKernel::normalizeOutlinedFunction() {
   }
 }
 
+// Returns the warp-aggregated version (see chpl-gpu-gen-includes.h) of an
+// extern atomic update from the runtime, or nullptr if there isn't one.
+static FnSymbol* getWarpAggregatedAtomic(FnSymbol* fn) {
+  static std::map<FnSymbol*, FnSymbol*> aggregatedFns;
+  static const char* atomicPrefix = "chpl_gpu_atomic_";
+  static const char* aggregatedOps[] = { "add_", "min_", "max_" };
+
+  if (fn == nullptr || !fn->hasFlag(FLAG_EXTERN)) return nullptr;
+
+  const char* cname = fn->cname;
+  if (strncmp(cname, atomicPrefix, strlen(atomicPrefix)) != 0) return nullptr;
+  const char* op = cname + strlen(atomicPrefix);
+
+  bool isAggregatedOp = false;
+  for (const char* aggregatedOp : aggregatedOps) {
+    if (strncmp(op, aggregatedOp, strlen(aggregatedOp)) == 0) {
+      isAggregatedOp = true;
+    }
+  }
+  if (!isAggregatedOp) return nullptr;
+
+  auto it = aggregatedFns.find(fn);
+  if (it != aggregatedFns.end()) return it->second;
+
+  SET_LINENO(fn);
+  FnSymbol* aggregated = fn->copy();
+  aggregated->name = astr("chpl_gpu_warp_atomic_", op);
+  aggregated->cname = aggregated->name;
+  aggregated->retType = dtVoid;
+  fn->defPoint->insertAfter(new DefExpr(aggregated));
+
+  aggregatedFns[fn] = aggregated;
+  return aggregated;
+}
+
+// Collects the moves that only copy the value of 'sym' into other unused
+// temporaries of 'fn'. Returns false if the value is used for anything else.
+static bool collectUnusedResultMoves(FnSymbol* fn, Symbol* sym,
+                                     std::vector<CallExpr*>& moves) {
+  if (!isVarSymbol(sym) || sym->isRef() || sym->defPoint->getFunction() != fn) {
+    return false;
+  }
+
+  for_SymbolUses(use, sym) {
+    CallExpr* move = toCallExpr(use->parentExpr);
+    if (!move || !move->isPrimitive(PRIM_MOVE) || move->get(2) != use) {
+      return false;
+    }
+    SymExpr* lhs = toSymExpr(move->get(1));
+    if (!lhs || !collectUnusedResultMoves(fn, lhs->symbol(), moves)) {
+      return false;
+    }
+    moves.push_back(move);
+  }
+  return true;
+}
+
+// Atomic updates that ignore the old value -- the usual way of reducing
+// into a single location from a kernel -- don't need every thread to do
+// its own atomic. Use the versions that combine the values of a warp first.
+void GpuKernel::aggregateAtomicUpdates() {
+  if (!isFullGpuCodegen()) return;
+
+  std::vector<CallExpr*> calls;
+  collectCallExprs(fn_->body, calls);
+
+  for_vector(CallExpr, call, calls) {
+    FnSymbol* aggregated = getWarpAggregatedAtomic(call->resolvedFunction());
+    if (aggregated == nullptr) continue;
+
+    SET_LINENO(call);
+    if (CallExpr* move = toCallExpr(call->parentExpr)) {
+      if (!move->isPrimitive(PRIM_MOVE)) continue;
+
+      std::vector<CallExpr*> moves;
+      SymExpr* lhs = toSymExpr(move->get(1));
+      if (!lhs || !collectUnusedResultMoves(fn_, lhs->symbol(), moves)) {
+        continue;
+      }
+      for_vector(CallExpr, unusedMove, moves) {
+        unusedMove->remove();
+      }
+      move->replace(call->remove());
+    } else if (call->getStmtExpr() != call) {
+      continue;
+    }
+
+    call->baseExpr->replace(new SymExpr(aggregated));
+  }
+}
+
 void GpuKernel::finalize() {
   // just repeat the dead code elimination steps for the new function
   cleanupLoopBlocks(this->fn_);
@@ -1223,8 +1660,27 @@ const std::unordered_set<PrimitiveTag>
  *   chpl_block_delta = ub - lb
  *   chpl_gpu_num_threads = chpl_block_delta + 1
  */
+static void finishGpuAndNonGpuPaths(const GpuizableLoop &gpuLoop,
+                                    FnSymbol *fnContainingLoop,
+                                    bool kernelRunsOnHost) {
+  bool canAssumeFnWillRunOnGpu =
+    fGpuSpecialization && (assumeNonGpuSpecFnsAreOnCpu || isFnGpuSpecialized(fnContainingLoop));
+
+  if(canAssumeFnWillRunOnGpu) {
+    // If we are creating GPU specializations then we already know we're on a GPU
+    // sublocale and can just generate the kernel launch call (or, in the case
+    // of CPU-as-device, a kernel launch followed by the CPU loop unless the
+    // kernel runs on the host).
+    gpuLoop.makeGpuOnly(kernelRunsOnHost);
+  } else {
+    // we don't know if we're in a specialization, so we need to keep
+    // the conditional.
+    gpuLoop.fixupNonGpuPath(kernelRunsOnHost);
+  }
+}
+
 static VarSymbol* generateNumThreads(BlockStmt* gpuLaunchBlock,
-                                     const GpuizableLoop& gpuLoop) {
+                                     const GpuKernelDim& dim) {
 
   VarSymbol *varBoundDelta = insertNewVarAndDef(gpuLaunchBlock,
                                                 "chpl_block_delta",
@@ -1235,8 +1691,8 @@ static VarSymbol* generateNumThreads(BlockStmt* gpuLaunchBlock,
 
   CallExpr *c1 = new CallExpr(PRIM_ASSIGN, varBoundDelta,
                               new CallExpr(PRIM_SUBTRACT,
-                                           gpuLoop.upperBound(),
-                                           gpuLoop.lowerBounds()[0]));
+                                           dim.upperBound,
+                                           dim.lowerBounds[0]));
   gpuLaunchBlock->insertAtTail(c1);
 
   CallExpr *c2 = new CallExpr(PRIM_ASSIGN, numThreads,
@@ -1247,19 +1703,104 @@ static VarSymbol* generateNumThreads(BlockStmt* gpuLaunchBlock,
   return numThreads;
 }
 
-static CallExpr* generateGPUCall(GpuKernel& info, VarSymbol* numThreads) {
+static int defaultBlockSize() {
+  return fGPUBlockSize != 0 ? fGPUBlockSize : 512;
+}
+
+static CallExpr* generateGPUCall(GpuKernel& info, BlockStmt* gpuLaunchBlock,
+                                 VarSymbol* numThreads) {
   CallExpr *call = new CallExpr(PRIM_GPU_KERNEL_LAUNCH_FLAT);
 
   call->insertAtTail(info.fn());
 
   call->insertAtTail(numThreads);  // total number of GPU threads
 
-  if (info.blockSize()) {
+  const std::vector<SymExpr*>& blockShape = info.blockShape();
+  if (blockShape.size() == 1) {
     // sets blockSize if specified with by "gpu set BlockSize" primitive
-    call->insertAtTail(info.blockSize()->copy());
+    call->insertAtTail(blockShape[0]->copy());
+  } else if (blockShape.size() > 1) {
+    // a multidimensional block shape for a 1D kernel sets the number of
+    // threads in a block
+    VarSymbol* blockSize = insertNewVarAndDef(gpuLaunchBlock,
+                                              "chpl_gpu_block_size",
+                                              dtInt[INT_SIZE_64]);
+    gpuLaunchBlock->insertAtTail(new CallExpr(PRIM_ASSIGN, blockSize,
+                                              blockShape[0]->copy()));
+    for (size_t i = 1; i < blockShape.size(); i++) {
+      gpuLaunchBlock->insertAtTail(new CallExpr(PRIM_ASSIGN, blockSize,
+          new CallExpr(PRIM_MULT, blockSize, blockShape[i]->copy())));
+    }
+    call->insertAtTail(blockSize);
+  } else if (fGPUBlockSize != 0 || info.dependsOnBlockSize()) {
+    call->insertAtTail(new_IntSymbol(defaultBlockSize()));
   } else {
-    int blockSize = fGPUBlockSize != 0 ? fGPUBlockSize : 512;
-    call->insertAtTail(new_IntSymbol(blockSize));
+    // let the runtime pick a block size based on the kernel's occupancy
+    call->insertAtTail(new_IntSymbol(0));
+  }
+
+  for_vector (Symbol, actual, info.kernelActuals()) {
+    call->insertAtTail(new SymExpr(actual));
+  }
+
+  return call;
+}
+
+/*
+ * Generates a 2D or 3D launch for a kernel with several dimensions. The
+ * block shape is the one given to "gpu set blockSize" (missing axes are
+ * 1), or defaults to 32 threads along X, which is enough for accesses to
+ * X-neighbors to coalesce, with the rest of the default block size along
+ * Y. For each axis, this inserts the following AST into gpuLaunchBlock:
+ *
+ *   chpl_gpu_grid_dim = (chpl_gpu_num_threads + blockDim - 1) / blockDim
+ */
+static CallExpr* generateGPUCall3D(GpuKernel& info, BlockStmt* gpuLaunchBlock,
+                                   const std::vector<VarSymbol*>& numThreads) {
+  const std::vector<SymExpr*>& blockShape = info.blockShape();
+  size_t numAxes = numThreads.size();
+
+  std::vector<Symbol*> blockDims;
+  for (size_t axis = 0; axis < 3; axis++) {
+    if (!blockShape.empty()) {
+      blockDims.push_back(axis < blockShape.size() ?
+                          blockShape[axis]->symbol() : new_IntSymbol(1));
+    } else {
+      int xSize = std::min(32, defaultBlockSize());
+      int size = axis == 0 ? xSize :
+                 axis == 1 ? std::max(1, defaultBlockSize() / xSize) : 1;
+      blockDims.push_back(new_IntSymbol(size));
+    }
+  }
+
+  std::vector<Symbol*> gridDims;
+  for (size_t axis = 0; axis < 3; axis++) {
+    if (axis >= numAxes) {
+      gridDims.push_back(new_IntSymbol(1));
+      continue;
+    }
+
+    VarSymbol* gridDim = insertNewVarAndDef(gpuLaunchBlock,
+                                            "chpl_gpu_grid_dim",
+                                            dtInt[INT_SIZE_64]);
+    gpuLaunchBlock->insertAtTail(new CallExpr(PRIM_ASSIGN, gridDim,
+        new CallExpr(PRIM_ADD, numThreads[axis], blockDims[axis])));
+    gpuLaunchBlock->insertAtTail(new CallExpr(PRIM_ASSIGN, gridDim,
+        new CallExpr(PRIM_SUBTRACT, gridDim, new_IntSymbol(1))));
+    gpuLaunchBlock->insertAtTail(new CallExpr(PRIM_ASSIGN, gridDim,
+        new CallExpr(PRIM_DIV, gridDim, blockDims[axis])));
+    gridDims.push_back(gridDim);
+  }
+
+  CallExpr *call = new CallExpr(PRIM_GPU_KERNEL_LAUNCH);
+
+  call->insertAtTail(info.fn());
+
+  for_vector (Symbol, gridDim, gridDims) {
+    call->insertAtTail(gridDim);
+  }
+  for_vector (Symbol, blockDim, blockDims) {
+    call->insertAtTail(blockDim);
   }
 
   for_vector (Symbol, actual, info.kernelActuals()) {
@@ -1274,26 +1815,24 @@ static void generateGPUKernelCall(const GpuizableLoop &gpuLoop,
   BlockStmt* gpuBlock = new BlockStmt();
 
   // populate the gpu block
-  VarSymbol *numThreads = generateNumThreads(gpuBlock, gpuLoop);
-  CallExpr* gpuCall = generateGPUCall(kernel, numThreads);
-  gpuBlock->insertAtTail(gpuCall);
-  gpuLoop.gpuLoop()->replace(gpuBlock);
-
-  FnSymbol *fnContainingLoop = gpuBlock->getFunction();
-  bool canAssumeFnWillRunOnGpu =
-    fGpuSpecialization && (assumeNonGpuSpecFnsAreOnCpu || isFnGpuSpecialized(fnContainingLoop));
-
-  if(canAssumeFnWillRunOnGpu) {
-    // If we are creating GPU specializations then we already know we're on a GPU
-    // sublocale and can just generate the kernel launch call (or, in the case
-    // of CPU-as-device, a kernel launch followed by the CPU loop).
-    gpuLoop.makeGpuOnly();
+  const std::vector<GpuKernelDim>& dims = kernel.dims();
+  CallExpr* gpuCall = nullptr;
+  if (dims.size() == 1) {
+    VarSymbol *numThreads = generateNumThreads(gpuBlock, dims[0]);
+    gpuCall = generateGPUCall(kernel, gpuBlock, numThreads);
   } else {
-    // we don't know if we're in a specialization, so we need to keep
-    // the conditional.
-    gpuLoop.fixupNonGpuPath();
+    // the innermost loop goes along X
+    std::vector<VarSymbol*> numThreads;
+    for (auto it = dims.rbegin(); it != dims.rend(); ++it) {
+      numThreads.push_back(generateNumThreads(gpuBlock, *it));
+    }
+    gpuCall = generateGPUCall3D(kernel, gpuBlock, numThreads);
   }
+  gpuBlock->insertAtTail(gpuCall);
+  gpuLoop.gpuLoop()->replace(gpuBlock);
 
+  finishGpuAndNonGpuPaths(gpuLoop, gpuBlock->getFunction(),
+                          kernel.runsOnHost());
 }
 
 static CallExpr* getGpuEligibleMarker(CForLoop* loop) {
@@ -1307,6 +1846,148 @@ static CallExpr* getGpuEligibleMarker(CForLoop* loop) {
   return nullptr;
 }
 
+// ----------------------------------------------------------------------------
+// GPU loop fusion (--gpu-fuse-loops)
+// ----------------------------------------------------------------------------
+
+// An eligible loop that directly follows another one and has the same bounds
+// is moved into the first one's GPU path, so both bodies run in one kernel:
+//
+//   if onGpu { P1; loop1 } else { cpu loop1 }
+//   M
+//   if onGpu { P2; loop2 } else { cpu loop2 }
+//
+// becomes
+//
+//   M
+//   if onGpu { P1; P2; fused loop } else { cpu loop1 }
+//   if onGpu { } else { cpu loop2 }
+//
+// where P1 and P2 are what LICM hoisted out of each loop and M may only
+// compute temporaries. A thread of the fused kernel runs an iteration of the
+// second loop right after the same iteration of the first one, so this is
+// only correct if iteration i of the second loop depends on nothing but
+// iteration i of the first loop. The compiler can't check that, which is
+// why the fusion has to be asked for.
+
+// Statements between two fused loops can only define and compute
+// temporaries, since they'll run before the first loop.
+static bool canMoveBeforeFusedLoop(Expr* stmt) {
+  if (isDefExpr(stmt)) return true;
+
+  CallExpr* call = toCallExpr(stmt);
+  if (!call || !call->isPrimitive(PRIM_MOVE)) return false;
+
+  SymExpr* lhs = toSymExpr(call->get(1));
+  if (!lhs || !isVarSymbol(lhs->symbol()) ||
+      lhs->symbol()->defPoint->parentExpr != stmt->parentExpr) {
+    return false;
+  }
+
+  if (isSymExpr(call->get(2))) return true;
+
+  CallExpr* rhs = toCallExpr(call->get(2));
+  if (!rhs || !rhs->isPrimitive() || !isPureValuePrimitive(rhs)) {
+    return false;
+  }
+  for_actuals(actual, rhs) {
+    if (!isSymExpr(actual)) return false;
+  }
+  return true;
+}
+
+static bool setsBlockSize(CForLoop* loop) {
+  std::vector<CallExpr*> calls;
+  collectCallExprs(loop, calls);
+  for_vector(CallExpr, call, calls) {
+    if (call->isPrimitive(PRIM_GPU_SET_BLOCKSIZE)) return true;
+  }
+  return false;
+}
+
+// Fuses the eligible loop following 'first' into it, if there is one that
+// can be fused. Returns true if it did.
+static bool fuseNextEligibleLoop(FnSymbol* fn, GpuizableLoop& first) {
+  std::vector<Expr*> between;
+  Expr* next = first.gpuCond()->next;
+  while (next && !isCondStmt(next)) {
+    if (!canMoveBeforeFusedLoop(next)) return false;
+    between.push_back(next);
+    next = next->next;
+  }
+  CondStmt* cond = toCondStmt(next);
+  if (!cond) return false;
+
+  CForLoop* loop = nullptr;
+  for_alist(expr, cond->thenStmt->body) {
+    if (CForLoop* cfl = toCForLoop(expr)) loop = cfl;
+  }
+  if (!loop) return false;
+
+  // Copies made for GPU specializations aren't fused.
+  auto found = eligibleLoops.find(loop);
+  if (found == eligibleLoops.end()) return false;
+  GpuizableLoop& second = found->second;
+  if (!second.isEligible() || second.gpuCond() != cond) return false;
+
+  CForLoop* firstLoop = first.gpuLoop();
+  const std::vector<Symbol*>& firstIndices = first.loopIndices();
+  const std::vector<Symbol*>& secondIndices = second.loopIndices();
+  if (firstIndices.size() != secondIndices.size() ||
+      !isSameValue(first.upperBound(), second.upperBound())) {
+    return false;
+  }
+  for (size_t i = 0; i < firstIndices.size(); i++) {
+    if (!isSameValue(first.lowerBounds()[i], second.lowerBounds()[i])) {
+      return false;
+    }
+  }
+
+  std::set<FnSymbol*> visited;
+  if ((setsBlockSize(firstLoop) && setsBlockSize(loop)) ||
+      usesThreadHierarchy(firstLoop, visited) ||
+      usesThreadHierarchy(loop, visited)) {
+    return false;
+  }
+
+  SET_LINENO(firstLoop);
+
+  for_vector(Expr, stmt, between) {
+    first.gpuCond()->insertBefore(stmt->remove());
+  }
+
+  std::vector<Expr*> hoisted;
+  for_alist(expr, second.gpuBlock()->body) {
+    if (expr == loop) break;
+    hoisted.push_back(expr);
+  }
+  for_vector(Expr, expr, hoisted) {
+    firstLoop->insertBefore(expr->remove());
+  }
+
+  if (auto marker = getGpuEligibleMarker(loop)) {
+    marker->remove();
+  }
+
+  SymbolMap indexMap;
+  for (size_t i = 0; i < firstIndices.size(); i++) {
+    indexMap.put(secondIndices[i], firstIndices[i]);
+  }
+  std::vector<Expr*> body;
+  for_alist(expr, loop->body) {
+    body.push_back(expr);
+  }
+  for_vector(Expr, expr, body) {
+    firstLoop->insertAtTail(expr->remove());
+  }
+  update_symbols(firstLoop, &indexMap);
+
+  loop->remove();
+  finishGpuAndNonGpuPaths(second, fn, /* kernelRunsOnHost */ false);
+
+  return true;
+}
+
 static void outlineEligibleLoop(FnSymbol *fn, GpuizableLoop &gpuLoop) {
   SET_LINENO(gpuLoop.gpuLoop());
 
@@ -1315,6 +1996,12 @@ static void outlineEligibleLoop(FnSymbol *fn, GpuizableLoop &gpuLoop) {
     marker->remove();
   }
 
+  // The second loop of a fused pair would still run on the CPU after the
+  // launch, so don't fuse loops when kernels may run on the host.
+  if (fGpuFuseLoops && isFullGpuCodegen()) {
+    while (fuseNextEligibleLoop(fn, gpuLoop)) { }
+  }
+
   // Construction of the GpuKernel will create the outlined function
   GpuKernel kernel(gpuLoop, fn->defPoint);
   if(!kernel.lateGpuizationFailure()) {
@@ -1548,12 +2235,12 @@ void GpuizableLoop::makeCpuOnly() const {
   cpuBlock_->flattenAndRemove();
 }
 
-void GpuizableLoop::makeGpuOnly() const {
+void GpuizableLoop::makeGpuOnly(bool kernelRunsOnHost) const {
   cpuBlock_->remove();
   gpuBlock_->remove();
   gpuCond_->replace(gpuBlock_);
 
-  if (!isFullGpuCodegen()) {
+  if (!isFullGpuCodegen() && !kernelRunsOnHost) {
     // put the CPU loop right after where the kernel launch would
     // be to make CPU-as-device work.
     gpuBlock_->insertAfter(cpuBlock_);
@@ -1563,14 +2250,15 @@ void GpuizableLoop::makeGpuOnly() const {
   gpuBlock_->flattenAndRemove();
 }
 
-void GpuizableLoop::fixupNonGpuPath() const {
+void GpuizableLoop::fixupNonGpuPath(bool kernelRunsOnHost) const {
   // In the CPU-as-device mode, instead of the plain loop being in an "else",
   // it's always executed. This will make sure that we call the runtime support
   // as if there's a GPU, yet still executing the loop always.
   //
-  // So, take it from its else branch and put it after the conditional.
+  // So, take it from its else branch and put it after the conditional. A
+  // kernel that runs on the host already executes the loop.
 
-  if (!isFullGpuCodegen()) {
+  if (!isFullGpuCodegen() && !kernelRunsOnHost) {
     cpuBlock_->remove();
     gpuCond_->insertAfter(cpuBlock_);
   }
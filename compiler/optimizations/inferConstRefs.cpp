@@ -20,8 +20,10 @@
 
 #include "optimizations.h"
 
+#include "AggregateType.h"
 #include "astutil.h"
 #include "expr.h"
+#include "resolution.h"
 #include "stmt.h"
 #include "stlUtil.h"
 
@@ -730,6 +732,244 @@ static bool inferRefToConst(Symbol* sym) {
   return isRefToConst;
 }
 
+//
+// ----- BORROWING CONST-IN FORMALS -----
+//
+// Records passed to an 'in' or 'const in' formal are copy-initialized at
+// the call site and destroyed by the callee. When
+// the callee never modifies the formal or moves it anywhere, and every
+// caller copies from something that can't change or go away before the
+// call returns, the copy and the destroy can both be dropped: the callee
+// then borrows the caller's value, just as if the formal were 'const ref'.
+// For strings and bigints this saves an allocation per call.
+//
+// The formal keeps its by-value type so that nothing else in the AST has
+// to change; the call site passes a bitwise copy of the caller's record.
+//
+
+// Is copying a 't' unobservable apart from its cost?
+static bool hasInvisibleCopy(Type* t) {
+  AggregateType* at = toAggregateType(t);
+
+  if (at == NULL || !isRecord(at) ||
+      isRecordWrappedType(at) || isManagedPtrType(at) ||
+      isSyncType(at) || isSingleType(at) || isAtomicType(at) ||
+      at->symbol->hasFlag(FLAG_HAS_RUNTIME_TYPE) ||
+      at->symbol->hasFlag(FLAG_EXTERN)) {
+    return false;
+  }
+
+  // Library records such as string, bytes and bigint don't count copies.
+  if (at->symbol->getModule()->modTag != MOD_USER)
+    return true;
+
+  if (at->hasUserDefinedInitEquals())
+    return false;
+
+  forv_Vec(FnSymbol, method, at->methods) {
+    if (method && method->name == astrDeinit &&
+        !method->hasFlag(FLAG_COMPILER_GENERATED)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+//
+// Collects the autoDestroy calls for 'owner', the in-intent formal or the
+// local it is moved into at the start of the function. Returns false if
+// the value is modified or moved anywhere else.
+//
+static bool onlyReadAndDestroyed(Symbol* owner, ArgSymbol* formal,
+                                 std::vector<CallExpr*>& destroys) {
+  bool isConst = owner == formal ?
+                 formal->intent == INTENT_CONST_IN :
+                 owner->qualType().getQual() == QUAL_CONST_VAL;
+  if (!isConst) return false;
+
+  for_SymbolSymExprs(use, owner) {
+    CallExpr* call = toCallExpr(use->parentExpr);
+    if (call == NULL) continue;
+
+    if (FnSymbol* fn = call->resolvedFunction()) {
+      if (fn->hasFlag(FLAG_AUTO_DESTROY_FN)) {
+        destroys.push_back(call);
+      } else if (!actual_to_formal(use)->isRef()) {
+        return false; // a by-value pass moves the record
+      }
+    } else if (isMoveOrAssign(call)) {
+      if (use == call->get(1)) {
+        // The move from the formal that started this local
+        SymExpr* rhs = toSymExpr(call->get(2));
+        if (owner == formal || !call->isPrimitive(PRIM_MOVE) ||
+            rhs == NULL || rhs->symbol() != formal) {
+          return false;
+        }
+        continue;
+      }
+
+      // The formal is moved into a local to be destroyed (see
+      // handleInIntents), which is the only move we can follow.
+      Symbol* lhs = toSymExpr(call->get(1))->symbol();
+      if (owner != formal || !lhs->hasFlag(FLAG_NO_COPY) || lhs->isRef() ||
+          !onlyReadAndDestroyed(lhs, formal, destroys)) {
+        return false;
+      }
+    } else if (call->isPrimitive(PRIM_ADDR_OF) ||
+               call->isPrimitive(PRIM_SET_REFERENCE) ||
+               call->isPrimitive(PRIM_GET_MEMBER) ||
+               call->isPrimitive(PRIM_GET_MEMBER_VALUE)) {
+      // Already shown not to modify the record by inferConst
+    } else {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// Can the callee borrow 'src' in which the caller copy-initialized 'tmp'?
+static bool canBorrowFrom(Symbol* src, CallExpr* copyStmt, CallExpr* call) {
+  FnSymbol* caller = call->getFunction();
+
+  if (src->defPoint == NULL || src->defPoint->parentSymbol != caller)
+    return false;
+
+  if (src->isRef()) {
+    // A const ref formal whose callers pass only immutable values
+    if (!isArgSymbol(src) || !src->hasFlag(FLAG_REF_TO_IMMUTABLE))
+      return false;
+  } else {
+    Qualifier q = src->qualType().getQual();
+    if (q != QUAL_CONST_VAL && q != QUAL_CONST)
+      return false;
+  }
+
+  // 'src' must not be destroyed before the call
+  Expr* callStmt = call->getStmtExpr();
+  for (Expr* stmt = copyStmt->next; stmt != NULL; stmt = stmt->next) {
+    if (stmt == callStmt)
+      return true;
+
+    if (CallExpr* destroy = toCallExpr(stmt)) {
+      FnSymbol* fn = destroy->resolvedFunction();
+      if (fn && fn->hasFlag(FLAG_AUTO_DESTROY_FN)) {
+        SymExpr* se = toSymExpr(destroy->get(1));
+        if (se && se->symbol() == src)
+          return false;
+      }
+    }
+  }
+
+  return false;
+}
+
+//
+// Returns the 'move tmp, chpl__initCopy(src, ...)' that initializes the
+// actual 'tmp' for 'formal' if the callee may borrow 'src' instead.
+//
+static CallExpr* findBorrowableCopy(CallExpr* call, ArgSymbol* formal) {
+  SymExpr* actual = toSymExpr(formal_to_actual(call, formal));
+  Symbol*  tmp    = actual ? actual->symbol() : NULL;
+
+  if (tmp == NULL || !isVarSymbol(tmp) || tmp->isRef() ||
+      !tmp->hasFlag(FLAG_NO_AUTO_DESTROY)) {
+    return NULL;
+  }
+
+  CallExpr* copyStmt = NULL;
+  for_SymbolSymExprs(se, tmp) {
+    if (se == actual) continue;
+
+    CallExpr* move = toCallExpr(se->parentExpr);
+    if (copyStmt != NULL || move == NULL ||
+        !move->isPrimitive(PRIM_MOVE) || se != move->get(1)) {
+      return NULL;
+    }
+    copyStmt = move;
+  }
+  if (copyStmt == NULL) return NULL;
+
+  CallExpr* copy = toCallExpr(copyStmt->get(2));
+  FnSymbol* copyFn = copy ? copy->resolvedFunction() : NULL;
+  if (copyFn == NULL || !copyFn->hasFlag(FLAG_INIT_COPY_FN))
+    return NULL;
+
+  SymExpr* srcSe = toSymExpr(copy->get(1));
+  if (srcSe == NULL || srcSe->getValType() != tmp->type ||
+      !canBorrowFrom(srcSe->symbol(), copyStmt, call)) {
+    return NULL;
+  }
+
+  return copyStmt;
+}
+
+static void borrowConstInFormal(FnSymbol* fn, ArgSymbol* formal,
+                                const std::vector<CallExpr*>& calls) {
+  if (formal->isRef() || formal->intent != INTENT_CONST_IN ||
+      !shouldAddInFormalTempAtCallSite(formal, fn) ||
+      !hasInvisibleCopy(formal->type)) {
+    return;
+  }
+
+  std::vector<CallExpr*> destroys;
+  if (!onlyReadAndDestroyed(formal, formal, destroys))
+    return;
+
+  std::vector<CallExpr*> copies;
+  for_vector(CallExpr, call, calls) {
+    CallExpr* copyStmt = findBorrowableCopy(call, formal);
+    if (copyStmt == NULL) return;
+    copies.push_back(copyStmt);
+  }
+
+  for_vector(CallExpr, copyStmt, copies) {
+    SET_LINENO(copyStmt);
+    CallExpr* copy = toCallExpr(copyStmt->get(2));
+    SymExpr*  src  = toSymExpr(copy->get(1))->copy();
+
+    if (src->isRef())
+      copy->replace(new CallExpr(PRIM_DEREF, src));
+    else
+      copy->replace(src);
+  }
+
+  for_vector(CallExpr, destroy, destroys) {
+    destroy->remove();
+  }
+}
+
+static void borrowConstInFormals() {
+  forv_Vec(FnSymbol, fn, gFnSymbols) {
+    if (!fn->inTree() ||
+        fn->hasFlag(FLAG_VIRTUAL) ||
+        fn->hasFlag(FLAG_EXPORT)  ||
+        fn->hasFlag(FLAG_EXTERN)  ||
+        // The body of an asynchronous task can outlive its caller
+        isTaskFun(fn)) {
+      continue;
+    }
+
+    // Every use of 'fn' has to be a direct call we can see
+    std::vector<CallExpr*> calls;
+    bool allCallsKnown = true;
+    for_SymbolSymExprs(se, fn) {
+      CallExpr* call = toCallExpr(se->parentExpr);
+      if (call == NULL || call->baseExpr != se) {
+        allCallsKnown = false;
+        break;
+      }
+      calls.push_back(call);
+    }
+    if (!allCallsKnown || calls.empty()) continue;
+
+    for_formals(formal, fn) {
+      borrowConstInFormal(fn, formal, calls);
+    }
+  }
+}
+
 //
 // For each VarSymbol and ArgSymbol, determine whether or not any of these
 // properties can be applied:
@@ -737,6 +977,8 @@ static bool inferRefToConst(Symbol* sym) {
 // 2) QUAL_CONST_REF / INTENT_CONST_REF
 // 3) FLAG_REF_TO_IMMUTABLE
 //
+// and then let callees borrow const-in record formals where possible.
+//
 void inferConstRefs() {
   // Build a map from Symbols to ConstInfo. This is somewhat like
   // buildDefUseMaps, except we don't want to put defs and uses in different
@@ -775,6 +1017,8 @@ void inferConstRefs() {
     }
   }
 
+  borrowConstInFormals();
+
   // Free the ConstInfo maps and clear the infoMap in case this function is
   // called again.
   for (ConstInfoIter it = infoMap.begin(); it != infoMap.end(); ++it) {
@@ -48,6 +48,9 @@ static void inlineCleanup();
 ************************************** | *************************************/
 
 void inlineFunctions() {
+  // Direct calls from devirtualization can be inlined like any other.
+  devirtualizeMethodCalls();
+
   convertToQualifiedRefs();
 
   compute_call_sites();
@@ -817,6 +817,56 @@ static bool computeAliases(FnSymbol* fn, std::map<Symbol*, std::set<Symbol*> >&
   return false;
 }
 
+/*
+ * Returns true if the only things the loop writes are non-ref locals of the
+ * function it is in. Such a loop can't write to anything a const ref formal
+ * refers to, since that belongs to a caller.
+ */
+static bool loopOnlyWritesLocals(symToVecSymExprMap& localDefMap,
+                                 std::vector<CallExpr*>& callsInLoop) {
+  if (callsInLoop.size() != 0) {
+    return false;
+  }
+
+  for (symToVecSymExprMap::iterator it = localDefMap.begin();
+       it != localDefMap.end(); ++it) {
+    Symbol* sym = it->first;
+    if (it->second == NULL || it->second->size() == 0) {
+      continue;
+    }
+    if (!isVarSymbol(sym) || sym->isRef() ||
+        !isFnSymbol(sym->defPoint->parentSymbol)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*
+ * Returns true if the value a ref refers to might be changed without a def of
+ * the ref itself showing up in the loop. A ref to something immutable can't be
+ * changed, and a const ref formal can only be changed by this task writing to
+ * some other alias of its referent: another task changing it would be a race,
+ * and canPerformCodeMotion() already rejected loops that synchronize. Loads
+ * through these refs are what become remote GETs once insertWideReferences()
+ * widens them, e.g. for values used in `on` bodies, so being able to hoist
+ * them saves a round trip per iteration.
+ */
+static bool refMightBeDeffedElseWhere(Symbol* sym, bool onlyWritesLocals) {
+  if (!sym->isRef()) {
+    return false;
+  }
+  if (sym->hasFlag(FLAG_REF_TO_IMMUTABLE)) {
+    return false;
+  }
+  if (ArgSymbol* arg = toArgSymbol(sym)) {
+    if (arg->intent == INTENT_CONST_REF && onlyWritesLocals) {
+      return false;
+    }
+  }
+  return true;
+}
+
 /*
  * The basic algorithm will be to find all of the constants, and then find things that
  * have no definitions in the loop. We also need to consider a symbols aliases when we're
@@ -847,6 +897,8 @@ static void computeLoopInvariants(std::vector<SymExpr*>& loopInvariants,
   }
   stopTimer(collectSymExprAndDefTimer);
 
+  bool onlyWritesLocals = loopOnlyWritesLocals(localDefMap, callsInLoop);
+
   //calculate the actual defs of a symbol including the defs of
   //its aliases. If there are no defs or we have a constant,
   //add it to the list of invariants
@@ -940,13 +992,13 @@ static void computeLoopInvariants(std::vector<SymExpr*>& loopInvariants,
       if (isArgSymbol(symExpr->symbol()) &&
           symExpr->getValType()->symbol->hasFlag(FLAG_ITERATOR_CLASS) == false) {
         if(ArgSymbol* argSymbol = toArgSymbol(symExpr->symbol())) {
-          if(argSymbol->isRef()) {
+          if(refMightBeDeffedElseWhere(argSymbol, onlyWritesLocals)) {
             mightHaveBeenDeffedElseWhere = true;
           }
         }
         for_set(Symbol, aliasSym, aliases[symExpr->symbol()]) {
           if(ArgSymbol* argSymbol = toArgSymbol(aliasSym)) {
-            if(argSymbol->isRef()) {
+            if(refMightBeDeffedElseWhere(argSymbol, onlyWritesLocals)) {
               mightHaveBeenDeffedElseWhere = true;
             }
           }
@@ -969,11 +1021,11 @@ static void computeLoopInvariants(std::vector<SymExpr*>& loopInvariants,
           mightHaveBeenDeffedElseWhere = true;
         }
       }
-      if (symExpr->symbol()->isRef()) {
+      if (refMightBeDeffedElseWhere(symExpr->symbol(), onlyWritesLocals)) {
           mightHaveBeenDeffedElseWhere = true;
       }
       for_set(Symbol, aliasSym, aliases[symExpr->symbol()]) {
-        if (aliasSym->isRef()) {
+        if (refMightBeDeffedElseWhere(aliasSym, onlyWritesLocals)) {
           mightHaveBeenDeffedElseWhere = true;
         }
       }
@@ -1360,6 +1412,9 @@ void loopInvariantCodeMotion(void) {
   // optimize certain statements in foralls to unordered
   optimizeForallUnorderedOps();
 
+  // give zippered loops a single induction variable where possible
+  simplifyZipperedLoops();
+
   earlyGpuTransforms();
 
   loopInvariantCodeMotionImpl();
@@ -1372,6 +1427,10 @@ void loopInvariantCodeMotion(void) {
   // future).
   lateGpuTransforms();
 
+  // version inner loops on invariant strides being 1; after LICM so that
+  // the strides have been hoisted out of the loops
+  specializeLoopStrides();
+
   // Compute array element alias sets.
   //
   // Any manipulations on the AST that removes a symbol within a function may
@@ -270,6 +270,7 @@ classifyPrimitive(CallExpr *call) {
   case PRIM_CHPL_COMM_ARRAY_GET:
   case PRIM_CHPL_COMM_ARRAY_PUT:
   case PRIM_CHPL_COMM_REMOTE_PREFETCH:
+  case PRIM_PREFETCH:
   case PRIM_CHPL_COMM_GET_STRD:
   case PRIM_CHPL_COMM_PUT_STRD:
     // These involve communication
@@ -284,6 +285,12 @@ classifyPrimitive(CallExpr *call) {
   case PRIM_STRING_COPY:
     return LOCAL_NOT_FAST;
 
+    // These update the calling task's remote cache state, so they need
+    // to run in a task, and not on a GPU.
+  case PRIM_CACHE_STREAM_BEGIN:
+  case PRIM_CACHE_STREAM_END:
+    return LOCAL_NOT_FAST;
+
   case PRIM_GET_DYNAMIC_END_COUNT:
   case PRIM_SET_DYNAMIC_END_COUNT:
   case PRIM_GPU_THREADIDX_X:
@@ -517,6 +524,77 @@ markFastSafeFn(FnSymbol *fn, int recurse, std::set<FnSymbol*>& visited) {
   }
 }
 
+// Does the body of fn do any communication itself, not counting
+// what the functions it calls do?
+static bool
+isLocalFnBody(FnSymbol* fn)
+{
+  if (fn->hasFlag(FLAG_EXTERN))
+    return fn->hasEitherFlag(FLAG_FAST_ON_SAFE_EXTERN, FLAG_LOCAL_FN);
+
+  std::vector<CallExpr*> calls;
+
+  collectCallExprs(fn, calls);
+
+  for_vector(CallExpr, call, calls) {
+    bool inLocal = fn->hasFlag(FLAG_LOCAL_FN) || inLocalBlock(call);
+
+    if (call->primitive) {
+      if (!isLocal(classifyPrimitive(call, inLocal)))
+        return false;
+    } else if (!call->isResolved()) {
+      return false;
+    } else if (call->resolvedFunction()->hasFlag(FLAG_ON_BLOCK) && !inLocal) {
+      // Starting an 'on' statement communicates,
+      // even if its body does not.
+      return false;
+    }
+  }
+
+  return true;
+}
+
+//
+// Collect the functions that do no communication, counting everything
+// that they call. Unlike markFastSafeFn, this does not stop at a
+// recursion depth and assumes recursive calls are local until shown
+// otherwise, so it also finds local call trees that are too deep or
+// recursive for markFastSafeFn. It starts from the functions whose
+// own bodies are local and, until nothing changes, drops the ones that
+// call a function that is not (outside of a local block).
+// Expects compute_call_sites() to have been run.
+//
+static void
+computeLocalFnTrees(std::set<FnSymbol*>& localFns)
+{
+  std::vector<FnSymbol*> notLocal;
+
+  forv_Vec(FnSymbol, fn, gFnSymbols) {
+    if (isLocalFnBody(fn))
+      localFns.insert(fn);
+    else
+      notLocal.push_back(fn);
+  }
+
+  while (!notLocal.empty()) {
+    FnSymbol* fn = notLocal.back();
+    notLocal.pop_back();
+
+    if (fn->calledBy == NULL)
+      continue;
+
+    forv_Vec(CallExpr, call, *fn->calledBy) {
+      FnSymbol* caller = call->getFunction();
+
+      if (localFns.count(caller) != 0 &&
+          !caller->hasFlag(FLAG_LOCAL_FN) && !inLocalBlock(call)) {
+        localFns.erase(caller);
+        notLocal.push_back(caller);
+      }
+    }
+  }
+}
+
 // Removes PRIM_START_RMEM_FENCE and PRIM_FINISH_RMEM_FENCE
 // from the passed function.
 // For reporting purposes, returns true if the function actually
@@ -608,13 +686,18 @@ optimizeOnClauses(void) {
 
   compute_call_sites();
 
+  std::set<FnSymbol*> localFns;
+
+  if (fCacheRemote)
+    computeLocalFnTrees(localFns);
+
   forv_Vec(FnSymbol, fn, gFnSymbols) {
     std::set<FnSymbol*> visited;
 
     int is = markFastSafeFn(fn, optimize_on_clause_limit, visited);
 
     bool fastFork = isFast(is);
-    bool removeRmemFences = isLocal(is);
+    bool removeRmemFences = isLocal(is) || localFns.count(fn) != 0;
 
     if (!fn->hasFlag(FLAG_ON_BLOCK))
       fastFork = false;
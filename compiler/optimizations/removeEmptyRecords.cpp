@@ -23,6 +23,7 @@
 #include "astutil.h"
 #include "driver.h"
 #include "expr.h"
+#include "optimizations.h"
 #include "stlUtil.h"
 #include "stmt.h"
 #include "symbol.h"
@@ -30,11 +31,8 @@
 
 #include "global-ast-vecs.h"
 
-void
-removeEmptyRecords() {
-  if (fNoRemoveEmptyRecords)
-    return;
-
+static void
+removeEmptyRecordTypes() {
   std::set<Type*> emptyRecordTypeSet;
   int numEmptyRecordTypes = 0;
   std::vector<Symbol*> emptyRecordSymbols;
@@ -129,3 +127,12 @@ removeEmptyRecords() {
     }
   }
 }
+
+void
+removeEmptyRecords() {
+  if (!fNoRemoveEmptyRecords)
+    removeEmptyRecordTypes();
+
+  // Lay out what's left; nothing after this adds or removes fields.
+  reorderRecordFields();
+}
@@ -0,0 +1,258 @@
+/*
+ * Copyright 2020-2023 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "AggregateType.h"
+#include "driver.h"
+#include "expr.h"
+#include "ModuleSymbol.h"
+#include "optimizations.h"
+#include "stlUtil.h"
+#include "symbol.h"
+#include "type.h"
+
+#include "global-ast-vecs.h"
+
+#include <algorithm>
+#include <set>
+#include <vector>
+
+/*
+   Reorder the fields of user records to reduce padding.
+
+   The C and LLVM structs for a record have its fields in source order, so
+   a record like
+
+     record R { var a: int(8); var b: real; var c: int(8); }
+
+   takes 24 bytes where 16 would do. With --reorder-record-fields, fields
+   are sorted by decreasing alignment, except that fields marked
+   @hotField come first so they share the record's first cache line.
+
+   Field order has no meaning to Chapel code after resolution, since
+   fields are accessed by symbol (the only field-number operations are
+   param ones that are folded during resolution). It does matter to C,
+   so records that are extern, exported, or appear in the signature of
+   an extern or export function are left alone, as are tuples, wide
+   pointers and everything outside user modules.
+
+   The layout is computed here from the Chapel types rather than by the
+   backend. Class fields are counted as local pointers; in multilocale
+   programs they may be wide, which doesn't change their alignment.
+*/
+
+namespace {
+  struct FieldLayout {
+    Symbol*  field;
+    uint64_t size;
+    uint64_t align;
+    uint64_t offset;
+  };
+}
+
+static uint64_t roundUp(uint64_t n, uint64_t align) {
+  return (n + align - 1) / align * align;
+}
+
+static bool computeLayout(std::vector<FieldLayout>& fields, uint64_t& size,
+                          uint64_t& align);
+
+static bool getTypeLayout(Type* t, uint64_t& size, uint64_t& align,
+                          int depth) {
+  if (t == dtNothing || t == dtVoid) {
+    size = 0;
+    align = 1;
+  } else if (is_bool_type(t)) {
+    size = align = 1;
+  } else if (is_int_type(t) || is_uint_type(t) || is_real_type(t) ||
+             is_imag_type(t)) {
+    size = align = get_width(t) / 8;
+  } else if (is_complex_type(t)) {
+    size = get_width(t) / 8;
+    align = size / 2;
+  } else if (EnumType* et = toEnumType(t)) {
+    PrimitiveType* it = et->getIntegerType();
+    if (!it) return false;
+    size = align = get_width(it) / 8;
+  } else if (isClassLikeOrPtr(t) || isReferenceType(t) ||
+             isCPtrConstChar(t)) {
+    size = align = sizeof(void*);
+  } else if (AggregateType* at = toAggregateType(t)) {
+    if (!isRecord(at) || depth > 16 ||
+        at->symbol->hasFlag(FLAG_EXTERN) ||
+        at->symbol->hasFlag(FLAG_C_ARRAY)) {
+      return false;
+    }
+
+    std::vector<FieldLayout> fields;
+    for_fields(field, at) {
+      FieldLayout fl = { field, 0, 0, 0 };
+      if (!getTypeLayout(field->type, fl.size, fl.align, depth + 1)) {
+        return false;
+      }
+      fields.push_back(fl);
+    }
+    return computeLayout(fields, size, align);
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// Assigns offsets to 'fields' in order, as a C compiler would.
+static bool computeLayout(std::vector<FieldLayout>& fields, uint64_t& size,
+                          uint64_t& align) {
+  uint64_t offset = 0;
+  align = 1;
+  for (FieldLayout& fl : fields) {
+    if (fl.align == 0) return false;
+    offset = roundUp(offset, fl.align);
+    fl.offset = offset;
+    offset += fl.size;
+    align = std::max(align, fl.align);
+  }
+  size = roundUp(offset, align);
+  return true;
+}
+
+bool estimateTypeLayout(Type* t, uint64_t& size, uint64_t& align) {
+  return getTypeLayout(t, size, align, 0);
+}
+
+static void collectInteropTypes(std::set<Type*>& types) {
+  forv_Vec(FnSymbol, fn, gFnSymbols) {
+    if (!fn->inTree() ||
+        !(fn->hasFlag(FLAG_EXTERN) || fn->hasFlag(FLAG_EXPORT))) {
+      continue;
+    }
+    types.insert(fn->retType->getValType());
+    for_formals(formal, fn) {
+      types.insert(formal->type->getValType());
+    }
+  }
+}
+
+static bool canReorderFields(AggregateType* at,
+                             const std::set<Type*>& interopTypes) {
+  TypeSymbol* ts = at->symbol;
+  return isRecord(at) &&
+         ts->getModule()->modTag == MOD_USER &&
+         !ts->hasFlag(FLAG_EXTERN) &&
+         !ts->hasFlag(FLAG_EXPORT) &&
+         !ts->hasFlag(FLAG_TUPLE) &&
+         !ts->hasFlag(FLAG_REF) &&
+         !ts->hasFlag(FLAG_WIDE_REF) &&
+         !ts->hasFlag(FLAG_WIDE_CLASS) &&
+         !ts->hasFlag(FLAG_C_ARRAY) &&
+         interopTypes.count(at) == 0;
+}
+
+static bool fieldComesFirst(const FieldLayout& a, const FieldLayout& b) {
+  bool aHot = a.field->hasFlag(FLAG_HOT_FIELD);
+  bool bHot = b.field->hasFlag(FLAG_HOT_FIELD);
+  if (aHot != bHot) return aHot;
+  return a.align > b.align;
+}
+
+// Returns the layout of 'at's fields in their current order.
+static bool getFieldLayouts(AggregateType* at,
+                            std::vector<FieldLayout>& fields,
+                            uint64_t& size) {
+  for_fields(field, at) {
+    FieldLayout fl = { field, 0, 0, 0 };
+    if (!getTypeLayout(field->type, fl.size, fl.align, 0)) return false;
+    fields.push_back(fl);
+  }
+
+  uint64_t align = 0;
+  return computeLayout(fields, size, align);
+}
+
+static void printRecordLayout(AggregateType* at, uint64_t oldSize) {
+  std::vector<FieldLayout> fields;
+  uint64_t size = 0;
+  if (!getFieldLayouts(at, fields, size)) {
+    printf("record %s (%s:%d): layout unknown\n", at->symbol->name,
+           at->symbol->fname(), at->symbol->linenum());
+    return;
+  }
+
+  printf("record %s (%s:%d): %llu bytes", at->symbol->name,
+         at->symbol->fname(), at->symbol->linenum(),
+         (unsigned long long) size);
+  if (size != oldSize) {
+    printf(", was %llu", (unsigned long long) oldSize);
+  }
+  printf("\n");
+  for (const FieldLayout& fl : fields) {
+    printf("  %4llu  %-20s %s (%llu bytes)%s\n",
+           (unsigned long long) fl.offset, fl.field->name,
+           fl.field->type->symbol->name, (unsigned long long) fl.size,
+           fl.field->hasFlag(FLAG_HOT_FIELD) ? " hot" : "");
+  }
+}
+
+// Returns the size of 'at' before reordering, or 0 if it is unknown.
+static uint64_t reorderFields(AggregateType* at) {
+  std::vector<FieldLayout> fields;
+  uint64_t oldSize = 0;
+  if (!getFieldLayouts(at, fields, oldSize)) return 0;
+  if (!fReorderRecordFields) return oldSize;
+
+  std::vector<FieldLayout> sorted = fields;
+  std::stable_sort(sorted.begin(), sorted.end(), fieldComesFirst);
+
+  uint64_t newSize = 0, newAlign = 0;
+  computeLayout(sorted, newSize, newAlign);
+
+  bool anyHot = false;
+  for (const FieldLayout& fl : sorted) {
+    anyHot = anyHot || fl.field->hasFlag(FLAG_HOT_FIELD);
+  }
+
+  // Hot fields are placed first even if that costs some padding.
+  if (newSize < oldSize || anyHot) {
+    for (const FieldLayout& fl : sorted) {
+      at->fields.insertAtTail(fl.field->defPoint->remove());
+    }
+  }
+  return oldSize;
+}
+
+void reorderRecordFields() {
+  if (!fReorderRecordFields && !fPrintRecordLayouts) return;
+
+  std::set<Type*> interopTypes;
+  collectInteropTypes(interopTypes);
+
+  std::vector<std::pair<AggregateType*, uint64_t>> records;
+  forv_Vec(AggregateType, at, gAggregateTypes) {
+    if (at->inTree() && canReorderFields(at, interopTypes)) {
+      records.push_back(std::make_pair(at, reorderFields(at)));
+    }
+  }
+
+  // Print once everything is reordered, so that records nested in other
+  // records are shown with their final sizes.
+  if (fPrintRecordLayouts) {
+    for (auto& rec : records) {
+      printRecordLayout(rec.first, rec.second);
+    }
+  }
+}
@@ -104,6 +104,33 @@ compareTypesByOrder(const void* v1, const void* v2) {
     return 0;
 }
 
+//
+// records that only hold plain data can be scalar replaced like tuples,
+// since copying one is a bit copy and there is nothing to deinit; this
+// covers small records such as points and key/value pairs that would
+// otherwise stay in memory inside loops after inlining
+//
+static bool
+isScalarReplaceableRecord(AggregateType* ct) {
+  TypeSymbol* ts = ct->symbol;
+  if (!isRecord(ct) ||
+      !ts->hasFlag(FLAG_POD) ||
+      ts->hasFlag(FLAG_EXTERN) ||
+      ts->hasFlag(FLAG_REF) ||
+      ts->hasFlag(FLAG_C_ARRAY) ||
+      ts->hasFlag(FLAG_RUNTIME_TYPE_VALUE) ||
+      ct->fields.length == 0 ||
+      ct->fields.length > scalar_replace_limit)
+    return false;
+
+  for_fields(field, ct) {
+    if (field->isRef() || field->hasFlag(FLAG_TYPE_VARIABLE) ||
+        field->isParameter())
+      return false;
+  }
+  return true;
+}
+
 static bool
 removeIdentityDefs(Symbol* sym) {
   bool change = false;
@@ -588,7 +615,8 @@ scalarReplace() {
         if (ts->hasFlag(FLAG_ITERATOR_CLASS) ||
             ts->hasFlag(FLAG_ITERATOR_RECORD) ||
             (ts->hasFlag(FLAG_TUPLE) &&
-             (ct->fields.length<=scalar_replace_limit))) {
+             (ct->fields.length<=scalar_replace_limit)) ||
+            isScalarReplaceableRecord(ct)) {
           typeVec.add(ct);
           typeVarMap.put(ct, new Vec<Symbol*>());
           if (AggregateType* rct = toAggregateType(ct->refType))
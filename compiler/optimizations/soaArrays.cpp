@@ -0,0 +1,259 @@
+/*
+ * Copyright 2020-2023 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "astutil.h"
+#include "AggregateType.h"
+#include "driver.h"
+#include "expr.h"
+#include "optimizations.h"
+#include "stlUtil.h"
+#include "stmt.h"
+#include "stringutil.h"
+#include "symbol.h"
+
+#include "global-ast-vecs.h"
+
+#include <map>
+#include <vector>
+
+/*
+   Store arrays of records declared with @soa as one array per field.
+
+     @soa var A: [D] R;
+
+   becomes
+
+     var _soa_A_x: [D] R.x's type = R.x's init;
+     var _soa_A_y: [D] R.y's type = R.y's init;
+     ...
+
+   with every 'A[i].x' rewritten to '_soa_A_x[i]' and 'A.domain' to the
+   domain of the first field's array. A loop that only touches a few
+   fields then streams through just those fields' memory, and each
+   field's accesses are unit stride so they can be vectorized.
+
+   This runs before normalize, so the rewrite is purely syntactic. It is
+   only done when every use of the array is one of the two forms above
+   and the record is simple enough that its fields can be declared on
+   their own: a non-generic record without user initializers whose
+   fields all have declared types and defaults that don't refer to
+   other fields. Otherwise the array is left as an array of records and
+   we warn about why.
+*/
+
+static const char* soaFieldArrayName(Symbol* arr, Symbol* field) {
+  return astr("_soa_", arr->name, "_", field->name);
+}
+
+// Returns the record type of an '[D] R' type expression.
+static AggregateType* getSoaEltType(CallExpr* typeExpr) {
+  if (!typeExpr || !typeExpr->isNamed("chpl__buildArrayRuntimeType") ||
+      typeExpr->numActuals() != 2) {
+    return nullptr;
+  }
+
+  CallExpr* dom = toCallExpr(typeExpr->get(1));
+  if (!dom || !dom->isNamed("chpl__ensureDomainExpr")) return nullptr;
+
+  SymExpr* eltSe = toSymExpr(typeExpr->get(2));
+  TypeSymbol* ts = eltSe ? toTypeSymbol(eltSe->symbol()) : nullptr;
+  return ts ? toAggregateType(ts->type) : nullptr;
+}
+
+static bool refersToFieldOf(Expr* expr, AggregateType* at) {
+  std::vector<BaseAST*> asts;
+  collect_asts(expr, asts);
+  for_vector(BaseAST, ast, asts) {
+    const char* name = nullptr;
+    if (SymExpr* se = toSymExpr(ast)) {
+      Symbol* sym = se->symbol();
+      if (sym->defPoint && sym->defPoint->parentSymbol == at->symbol) {
+        return true;
+      }
+    } else if (UnresolvedSymExpr* use = toUnresolvedSymExpr(ast)) {
+      name = use->unresolved;
+    }
+    if (name == nullptr) continue;
+
+    if (name == astrThis) return true;
+    for_fields(field, at) {
+      if (field->name == name) return true;
+    }
+  }
+  return false;
+}
+
+// Returns nullptr if the record can be split, otherwise the reason it
+// can't be.
+static const char* checkSoaRecord(AggregateType* at) {
+  if (!at->isRecord()) return "its element type is not a record";
+  if (at->isGeneric()) return "its element type is generic";
+  if (at->hasUserDefinedInit) {
+    return "its element type has a user-defined initializer";
+  }
+  if (at->fields.length == 0) return "its element type has no fields";
+
+  for_fields(field, at) {
+    DefExpr* def = field->defPoint;
+    if (field->hasFlag(FLAG_TYPE_VARIABLE) || field->hasFlag(FLAG_PARAM)) {
+      return "its element type has type or param fields";
+    }
+    if (def->exprType == nullptr) {
+      return "a field of its element type has no declared type";
+    }
+    if (refersToFieldOf(def->exprType, at) ||
+        (def->init && refersToFieldOf(def->init, at))) {
+      return "a field of its element type depends on another field";
+    }
+  }
+  return nullptr;
+}
+
+// Is 'se' the 'A' in 'A[i].field'? Sets 'access' to the '.' call.
+static bool isSoaFieldAccess(SymExpr* se, AggregateType* at,
+                             CallExpr*& access) {
+  CallExpr* index = toCallExpr(se->parentExpr);
+  if (!index || index->baseExpr != se || index->numActuals() == 0) {
+    return false;
+  }
+
+  CallExpr* dot = toCallExpr(index->parentExpr);
+  const char* name = nullptr;
+  if (!dot || !dot->isNamedAstr(astrSdot) || dot->get(1) != index ||
+      !get_string(dot->get(2), &name)) {
+    return false;
+  }
+
+  for_fields(field, at) {
+    if (field->name == astr(name)) {
+      access = dot;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Is 'se' the 'A' in 'A.domain'?
+static bool isSoaDomainAccess(SymExpr* se) {
+  CallExpr* dot = toCallExpr(se->parentExpr);
+  const char* name = nullptr;
+  return dot && dot->isNamedAstr(astrSdot) && dot->get(1) == se &&
+         get_string(dot->get(2), &name) && astr(name) == astr("domain");
+}
+
+static void splitSoaArray(VarSymbol* arr) {
+  DefExpr* def = arr->defPoint;
+  CallExpr* typeExpr = toCallExpr(def->exprType);
+  AggregateType* at = getSoaEltType(typeExpr);
+
+  const char* reason = nullptr;
+  if (!at) {
+    reason = "its element type is not a named record type";
+  } else {
+    reason = checkSoaRecord(at);
+  }
+
+  std::vector<CallExpr*> fieldAccesses;
+  std::vector<CallExpr*> domainAccesses;
+  if (!reason) {
+    for_SymbolSymExprs(se, arr) {
+      CallExpr* access = nullptr;
+      if (isSoaFieldAccess(se, at, access)) {
+        fieldAccesses.push_back(access);
+      } else if (isSoaDomainAccess(se)) {
+        domainAccesses.push_back(toCallExpr(se->parentExpr));
+      } else {
+        reason = "it is used other than as 'A[i].field' or 'A.domain'";
+        break;
+      }
+    }
+  }
+
+  if (reason) {
+    USR_WARN(arr, "'%s' is stored as an array of records because %s",
+             arr->name, reason);
+    arr->removeFlag(FLAG_SOA_ARRAY);
+    return;
+  }
+
+  SET_LINENO(def);
+
+  // Evaluate the domain once so that every field array shares it.
+  CallExpr* domExpr = toCallExpr(typeExpr->get(1));
+  if (!isSymExpr(domExpr->get(1))) {
+    VarSymbol* dom = new VarSymbol(astr("_soa_", arr->name, "_domain"));
+    dom->addFlag(FLAG_CONST);
+    def->insertBefore(new DefExpr(dom, domExpr->remove(), nullptr));
+    domExpr = new CallExpr("chpl__ensureDomainExpr", dom);
+  }
+
+  std::map<const char*, VarSymbol*> fieldArrays;
+  VarSymbol* first = nullptr;
+  Expr* insertPoint = def;
+  for_fields(field, at) {
+    DefExpr* fieldDef = field->defPoint;
+    VarSymbol* fa = new VarSymbol(soaFieldArrayName(arr, field));
+    if (arr->hasFlag(FLAG_CONST)) fa->addFlag(FLAG_CONST);
+
+    CallExpr* faType = new CallExpr(typeExpr->baseExpr->copy(),
+                                    domExpr->copy(),
+                                    fieldDef->exprType->copy());
+    Expr* faInit = fieldDef->init ? fieldDef->init->copy() : nullptr;
+    DefExpr* faDef = new DefExpr(fa, faInit, faType);
+    insertPoint->insertAfter(faDef);
+    insertPoint = faDef;
+
+    fieldArrays[field->name] = fa;
+    if (!first) first = fa;
+  }
+
+  // 'A[i].x' becomes '_soa_A_x[i]'
+  for_vector(CallExpr, dot, fieldAccesses) {
+    SET_LINENO(dot);
+    CallExpr* index = toCallExpr(dot->get(1));
+    VarSymbol* fa = fieldArrays[astr(get_string(dot->get(2)))];
+
+    CallExpr* access = new CallExpr(new SymExpr(fa));
+    while (index->numActuals() > 0) {
+      access->insertAtTail(index->get(1)->remove());
+    }
+    dot->replace(access);
+  }
+
+  // 'A.domain' becomes '_soa_A_x.domain'
+  for_vector(CallExpr, dot, domainAccesses) {
+    toSymExpr(dot->get(1))->setSymbol(first);
+  }
+
+  def->remove();
+}
+
+void splitSoaArrays() {
+  std::vector<VarSymbol*> arrays;
+  forv_Vec(VarSymbol, var, gVarSymbols) {
+    if (var->hasFlag(FLAG_SOA_ARRAY) && var->inTree()) {
+      arrays.push_back(var);
+    }
+  }
+
+  for_vector(VarSymbol, arr, arrays) {
+    splitSoaArray(arr);
+  }
+}
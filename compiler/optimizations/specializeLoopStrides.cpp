@@ -0,0 +1,230 @@
+/*
+ * Copyright 2020-2023 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "astutil.h"
+#include "CForLoop.h"
+#include "driver.h"
+#include "expr.h"
+#include "optimizations.h"
+#include "stlUtil.h"
+#include "stmt.h"
+#include "symbol.h"
+#include "type.h"
+
+#include "global-ast-vecs.h"
+
+#include <algorithm>
+#include <set>
+#include <vector>
+
+/*
+   Version inner loops on their runtime strides being 1.
+
+   Accesses to arrays over strided domains, and to arrays whose stride
+   isn't known statically in general, scale the index by a stride that is
+   only available at runtime:
+
+     for (i = lo; i <= hi; i += 1) {
+       ...
+       off = i * blk;
+       ...
+     }
+
+   Once LICM has hoisted 'blk' out of the loop this turns that into
+
+     if (blk == 1) {
+       for (...) { ... off = i * 1; ... }
+     } else {
+       for (...) { ... off = i * blk; ... }
+     }
+
+   just as the fast-follower split runs a specialized copy of a forall
+   behind a dynamic check. In the first copy the backend sees contiguous
+   accesses, so it can use pointer increments and vectorize.
+
+   Only innermost C for loops are considered, and only for loop-invariant
+   integer locals that scale a value computed in the loop. At most
+   maxStrides strides are checked per loop, and loops larger than
+   maxLoopCalls calls aren't duplicated.
+*/
+
+static const size_t maxStrides = 2;
+static const size_t maxLoopCalls = 128;
+
+static bool isInside(Expr* expr, Expr* ancestor) {
+  for (Expr* e = expr; e; e = e->parentExpr) {
+    if (e == ancestor) return true;
+  }
+  return false;
+}
+
+// Is 'sym' set anywhere inside 'loop'?
+static bool isDefinedIn(Symbol* sym, CForLoop* loop) {
+  if (sym->isImmediate()) return false;
+  if (isInside(sym->defPoint, loop)) return true;
+
+  for_SymbolDefs(def, sym) {
+    if (isInside(def, loop)) return true;
+  }
+  return false;
+}
+
+// Could 'sym' be a stride that stays the same for the whole loop? It
+// has to be a local of 'fn' that the loop doesn't set and whose address
+// is never taken, so nothing can change it behind our back.
+static bool isInvariantStride(Symbol* sym, FnSymbol* fn, CForLoop* loop) {
+  if (!isVarSymbol(sym) && !isArgSymbol(sym)) return false;
+  if (sym->isImmediate() || sym->isRef() || sym->hasFlag(FLAG_EXTERN))
+    return false;
+  if (sym->defPoint->parentSymbol != fn) return false;
+  if (!is_int_type(sym->type) && !is_uint_type(sym->type)) return false;
+  if (ArgSymbol* arg = toArgSymbol(sym)) {
+    if (arg->intent & INTENT_FLAG_REF) return false;
+  }
+
+  for_SymbolSymExprs(se, sym) {
+    CallExpr* call = toCallExpr(se->parentExpr);
+    if (call && (call->isPrimitive(PRIM_ADDR_OF) ||
+                 call->isPrimitive(PRIM_SET_REFERENCE))) {
+      return false;
+    }
+  }
+
+  return !isDefinedIn(sym, loop);
+}
+
+// Finds 'x * stride' in the body where x changes from one iteration to
+// the next, and returns the distinct strides.
+static std::vector<Symbol*> findStrides(CForLoop* loop, FnSymbol* fn) {
+  std::vector<Symbol*> strides;
+
+  std::vector<CallExpr*> calls;
+  collectCallExprs(loop, calls);
+  if (calls.size() > maxLoopCalls) return strides;
+
+  for_vector(CallExpr, call, calls) {
+    if (!call->isPrimitive(PRIM_MULT)) continue;
+
+    SymExpr* a = toSymExpr(call->get(1));
+    SymExpr* b = toSymExpr(call->get(2));
+    if (!a || !b) continue;
+
+    Symbol* stride = nullptr;
+    if (isInvariantStride(b->symbol(), fn, loop) &&
+        isDefinedIn(a->symbol(), loop)) {
+      stride = b->symbol();
+    } else if (isInvariantStride(a->symbol(), fn, loop) &&
+               isDefinedIn(b->symbol(), loop)) {
+      stride = a->symbol();
+    }
+
+    if (stride && std::find(strides.begin(), strides.end(), stride) ==
+                  strides.end()) {
+      if (strides.size() == maxStrides) return std::vector<Symbol*>();
+      strides.push_back(stride);
+    }
+  }
+  return strides;
+}
+
+static VarSymbol* newOne(Type* type) {
+  for (int i = INT_SIZE_8; i < INT_SIZE_NUM; i++) {
+    if (dtInt[i] == type) return new_IntSymbol(1, (IF1_int_type) i);
+    if (dtUInt[i] == type) return new_UIntSymbol(1, (IF1_int_type) i);
+  }
+  return nullptr;
+}
+
+// Replaces the stride operands of the multiplications in 'loop' with 1.
+static void setStridesToOne(CForLoop* loop,
+                            const std::vector<Symbol*>& strides) {
+  std::vector<CallExpr*> calls;
+  collectCallExprs(loop, calls);
+  for_vector(CallExpr, call, calls) {
+    if (!call->isPrimitive(PRIM_MULT)) continue;
+
+    for_actuals(actual, call) {
+      SymExpr* se = toSymExpr(actual);
+      if (se && std::find(strides.begin(), strides.end(), se->symbol()) !=
+                strides.end()) {
+        SET_LINENO(se);
+        se->setSymbol(newOne(se->symbol()->type));
+      }
+    }
+  }
+}
+
+static void specializeLoopStrides(CForLoop* loop, FnSymbol* fn) {
+  std::vector<Symbol*> strides = findStrides(loop, fn);
+  if (strides.empty()) return;
+
+  for_vector(Symbol, stride, strides) {
+    if (newOne(stride->type) == nullptr) return;
+  }
+
+  SET_LINENO(loop);
+
+  Expr* condExpr = nullptr;
+  for_vector(Symbol, stride, strides) {
+    CallExpr* isOne = new CallExpr(PRIM_EQUAL, stride,
+                                   newOne(stride->type));
+    condExpr = condExpr ? new CallExpr(PRIM_AND, condExpr, isOne) : isOne;
+  }
+
+  CForLoop* unitLoop = loop->copy();
+  setStridesToOne(unitLoop, strides);
+
+  BlockStmt* thenBlock = new BlockStmt(unitLoop);
+  BlockStmt* elseBlock = new BlockStmt();
+  CondStmt* cond = new CondStmt(condExpr, thenBlock, elseBlock);
+
+  loop->insertBefore(cond);
+  elseBlock->insertAtTail(loop->remove());
+}
+
+void specializeLoopStrides() {
+  if (fNoLoopStrideSpecialization) return;
+
+  // collect first, since specializing adds loops
+  std::vector<CForLoop*> loops;
+  std::set<BlockStmt*> outerLoops;
+  forv_Vec(BlockStmt, block, gBlockStmts) {
+    if (!block->inTree() || !block->isLoopStmt()) continue;
+
+    if (CForLoop* loop = toCForLoop(block)) loops.push_back(loop);
+
+    for (Expr* e = block->parentExpr; e; e = e->parentExpr) {
+      if (BlockStmt* parent = toBlockStmt(e)) {
+        if (parent->isLoopStmt()) outerLoops.insert(parent);
+      }
+    }
+  }
+
+  for_vector(CForLoop, loop, loops) {
+    if (outerLoops.count(loop)) continue;
+
+    FnSymbol* fn = loop->getFunction();
+    if (fn == nullptr || fn->hasFlag(FLAG_GPU_CODEGEN) ||
+        isLoopGpuBound(loop)) {
+      continue;
+    }
+    specializeLoopStrides(loop, fn);
+  }
+}
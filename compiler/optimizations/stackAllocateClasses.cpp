@@ -0,0 +1,411 @@
+/*
+ * Copyright 2020-2023 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "optimizations.h"
+
+#include "astutil.h"
+#include "driver.h"
+#include "expr.h"
+#include "LoopStmt.h"
+#include "passes.h"
+#include "stlUtil.h"
+#include "stmt.h"
+#include "symbol.h"
+#include "type.h"
+#include "wellknown.h"
+
+#include "global-ast-vecs.h"
+
+#include <map>
+#include <set>
+#include <vector>
+
+/*
+   Stack allocate class instances that don't escape the function that
+   creates them.
+
+   A 'new C(...)' is a call to C's new wrapper, which heap allocates the
+   instance and runs the initializer.  If the instance is only ever used
+   by its creating function and the functions it is passed to, it can
+   live in the creator's stack frame instead:
+
+     move tmp, (call _new args)
+
+   becomes
+
+     move storage, (stack allocate class C)
+     move tmp, (call _new_in_place args storage)
+
+   where _new_in_place is a copy of the wrapper that initializes the
+   storage it is given instead of allocating.  A 'delete' of the instance
+   in the creating function becomes a direct call to its deinit.
+
+   The instance escapes, and is left alone, if it or a copy of it is
+   stored in a field or global, returned, yielded, passed by ref or to a
+   task function, iterator or virtual method, or deleted anywhere but in
+   the creating function.  The same goes for 'this' in the initializers
+   the new wrapper runs.  A formal of a function that is still being
+   analyzed, as with recursion, is assumed to escape.  Copies must be local variables that are set
+   once.  When the 'new' is in a loop, its copies must also be declared
+   in the loop, since each iteration reuses the same storage.
+
+   'owned' and 'shared' instances are transferred into the managing
+   record, which counts as escaping, so this currently applies to
+   'unmanaged' instances (and 'borrowed' ones that become unmanaged
+   temporaries).
+*/
+
+static const int maxCalleeDepth = 4;
+
+namespace {
+  struct EscapeInfo {
+    // in the creating function: the deletes to turn into deinit calls
+    std::vector<CallExpr*> deletes;
+    // statement of the 'new', or NULL when analyzing a callee's formal
+    Expr* allocStmt;
+  };
+}
+
+static std::map<std::pair<FnSymbol*, Symbol*>, bool> formalEscapes;
+static std::map<FnSymbol*, FnSymbol*> inPlaceNewMap;
+
+static bool escapes(Symbol* sym, FnSymbol* fn, EscapeInfo& info, int depth);
+
+static bool isInside(Expr* expr, Expr* ancestor) {
+  for (Expr* e = expr; e; e = e->parentExpr) {
+    if (e == ancestor) return true;
+  }
+  return false;
+}
+
+// A copy of the instance must be a local that is only set by its copy.
+static bool isTrackableCopy(Symbol* sym, FnSymbol* fn, EscapeInfo& info) {
+  VarSymbol* var = toVarSymbol(sym);
+  if (!var || var->isRef() || var->hasFlag(FLAG_RVV) ||
+      var->defPoint->parentSymbol != fn) {
+    return false;
+  }
+
+  int numDefs = 0;
+  for_SymbolDefs(def, var) {
+    numDefs++;
+  }
+  if (numDefs != 1) return false;
+
+  // With a loop, storage from one iteration is reused by the next.
+  if (info.allocStmt) {
+    if (Stmt* loop = LoopStmt::findEnclosingLoopOrForall(info.allocStmt)) {
+      if (!isInside(var->defPoint, loop)) return false;
+    }
+  }
+  return true;
+}
+
+// Can the ref temp 'ref' to a field of the instance outlive it?
+static bool fieldRefEscapes(Symbol* ref, FnSymbol* fn) {
+  VarSymbol* var = toVarSymbol(ref);
+  if (!var || var->hasFlag(FLAG_RVV) || var->defPoint->parentSymbol != fn) {
+    return true;
+  }
+
+  for_SymbolSymExprs(se, var) {
+    CallExpr* call = toCallExpr(se->parentExpr);
+    if (!call) return true;
+
+    if (isMoveOrAssign(call) && call->get(1) == se) {
+      continue;           // the def, or a write through the ref
+    } else if (call->isPrimitive(PRIM_DEREF) ||
+               isOpEqualPrim(call)) {
+      continue;
+    } else if (isMoveOrAssign(call) && call->get(2) == se &&
+               !call->get(1)->isRef()) {
+      continue;           // a read of the field's value
+    } else if (FnSymbol* callee = call->resolvedFunction()) {
+      // a ref argument is fine as long as it doesn't come back out
+      if (callee->retTag == RET_REF || isTaskFun(callee) ||
+          callee->isIterator()) {
+        return true;
+      }
+    } else {
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool isDeleteCall(CallExpr* call) {
+  FnSymbol* callee = call->resolvedFunction();
+  return callee && callee->name == astr("chpl__delete") &&
+         call->numActuals() == 1;
+}
+
+// Does passing the instance as 'actual' of 'call' let it escape?
+static bool actualEscapes(SymExpr* actual, CallExpr* call, EscapeInfo& info,
+                          int depth) {
+  FnSymbol* callee = call->resolvedFunction();
+  if (!callee) return true;
+
+  if (isDeleteCall(call)) {
+    // we can only drop the free where the instance was created
+    if (!info.allocStmt) return true;
+    info.deletes.push_back(call);
+    return false;
+  }
+
+  if (callee->hasFlag(FLAG_EXTERN) || isTaskFun(callee) ||
+      callee->isIterator() || callee->retTag == RET_REF ||
+      callee == gChplHereFree || depth >= maxCalleeDepth) {
+    return true;
+  }
+
+  ArgSymbol* formal = actual_to_formal(actual);
+  if (!formal || formal->isRef()) return true;
+
+  std::pair<FnSymbol*, Symbol*> key(callee, formal);
+  std::map<std::pair<FnSymbol*, Symbol*>, bool>::iterator it =
+    formalEscapes.find(key);
+  if (it != formalEscapes.end()) return it->second;
+
+  // Treat it as escaping while looking.  Assuming the opposite would let
+  // a recursive call cache a result that depends on the guess.
+  formalEscapes[key] = true;
+  EscapeInfo calleeInfo;
+  calleeInfo.allocStmt = NULL;
+  bool result = escapes(formal, callee, calleeInfo, depth + 1);
+  formalEscapes[key] = result;
+  return result;
+}
+
+// Does the value of 'sym', the instance or a copy of it, escape 'fn'?
+static bool escapes(Symbol* sym, FnSymbol* fn, EscapeInfo& info, int depth) {
+  std::vector<Symbol*> work;
+  std::set<Symbol*> seen;
+  work.push_back(sym);
+  seen.insert(sym);
+
+  while (!work.empty()) {
+    Symbol* cur = work.back();
+    work.pop_back();
+
+    for_SymbolSymExprs(se, cur) {
+      if (se->parentSymbol != fn) return true;
+
+      CallExpr* call = toCallExpr(se->parentExpr);
+      if (!call) return true;
+
+      if (isMoveOrAssign(call) && call->get(1) == se) {
+        // formals can't be reassigned; copies have their single def
+        if (isArgSymbol(cur)) return true;
+        continue;
+      }
+
+      // a copy, possibly to another class type
+      CallExpr* copy = NULL;
+      if (isMoveOrAssign(call) && call->get(2) == se) {
+        copy = call;
+      } else if (call->isPrimitive(PRIM_CAST) ||
+                 call->isPrimitive(PRIM_TO_NON_NILABLE_CLASS) ||
+                 call->isPrimitive(PRIM_TO_NILABLE_CLASS) ||
+                 call->isPrimitive(PRIM_TO_UNMANAGED_CLASS) ||
+                 call->isPrimitive(PRIM_TO_BORROWED_CLASS)) {
+        CallExpr* parent = toCallExpr(call->parentExpr);
+        if (parent && isMoveOrAssign(parent) && parent->get(2) == call &&
+            se == call->get(call->numActuals())) {
+          copy = parent;
+        } else {
+          return true;
+        }
+      }
+      if (copy) {
+        SymExpr* lhs = toSymExpr(copy->get(1));
+        if (!lhs || !isTrackableCopy(lhs->symbol(), fn, info)) return true;
+        if (seen.insert(lhs->symbol()).second) {
+          work.push_back(lhs->symbol());
+        }
+        continue;
+      }
+
+      if (call->isPrimitive(PRIM_GET_MEMBER) && se == call->get(1)) {
+        CallExpr* parent = toCallExpr(call->parentExpr);
+        if (!parent || !isMoveOrAssign(parent) || parent->get(2) != call) {
+          return true;
+        }
+        SymExpr* lhs = toSymExpr(parent->get(1));
+        if (!lhs || fieldRefEscapes(lhs->symbol(), fn)) return true;
+        continue;
+      }
+
+      if (((call->isPrimitive(PRIM_GET_MEMBER_VALUE) ||
+            call->isPrimitive(PRIM_SET_MEMBER) ||
+            call->isPrimitive(PRIM_SETCID) ||
+            call->isPrimitive(PRIM_GETCID) ||
+            call->isPrimitive(PRIM_TESTCID) ||
+            call->isPrimitive(PRIM_CHECK_NIL)) && se == call->get(1)) ||
+          call->isPrimitive(PRIM_PTR_EQUAL) ||
+          call->isPrimitive(PRIM_PTR_NOTEQUAL) ||
+          call->isPrimitive(PRIM_EQUAL) ||
+          call->isPrimitive(PRIM_NOTEQUAL)) {
+        continue;
+      }
+
+      if (call->isResolved() && !actualEscapes(se, call, info, depth)) {
+        continue;
+      }
+
+      // returns, yields, virtual calls, stores into fields, ...
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// Can the initializers run by the new wrapper 'newFn' let 'this' escape,
+// e.g. by storing it in a global or another object's field?
+static bool initializerEscapes(FnSymbol* newFn) {
+  std::vector<CallExpr*> calls;
+  collectCallExprs(newFn, calls);
+  for_vector(CallExpr, call, calls) {
+    FnSymbol* callee = call->resolvedFunction();
+    if (!callee || !(callee->isInitializer() || callee->isPostInitializer())) {
+      continue;
+    }
+    for_actuals(actual, call) {
+      SymExpr* se = toSymExpr(actual);
+      if (se && actual_to_formal(se) == callee->_this) {
+        EscapeInfo initInfo;
+        initInfo.allocStmt = NULL;
+        if (actualEscapes(se, call, initInfo, 0)) return true;
+      }
+    }
+  }
+  return false;
+}
+
+// Copy the new wrapper 'newFn' into one that initializes storage passed
+// in as its last argument instead of heap allocating it.
+static FnSymbol* getInPlaceNew(FnSymbol* newFn, AggregateType* ct) {
+  std::map<FnSymbol*, FnSymbol*>::iterator it = inPlaceNewMap.find(newFn);
+  if (it != inPlaceNewMap.end()) return it->second;
+
+  FnSymbol* ret = NULL;
+
+  std::vector<CallExpr*> calls;
+  collectCallExprs(newFn, calls);
+  int numAllocs = 0;
+  for_vector(CallExpr, call, calls) {
+    if (call->resolvedFunction() == gChplHereAlloc) numAllocs++;
+  }
+
+  if (numAllocs == 1 && !newFn->throwsError()) {
+    SET_LINENO(newFn);
+    ret = newFn->copy();
+    ret->name = astr("_new_in_place");
+    ret->cname = astr("_new_in_place_", ct->symbol->cname);
+    ret->removeFlag(FLAG_LLVM_RETURN_NOALIAS);
+
+    ArgSymbol* storage = new ArgSymbol(INTENT_CONST_IN, "storage", ct);
+    ret->insertFormalAtTail(storage);
+
+    calls.clear();
+    collectCallExprs(ret, calls);
+    for_vector(CallExpr, call, calls) {
+      if (call->resolvedFunction() == gChplHereAlloc) {
+        call->replace(new CallExpr(PRIM_CAST_TO_VOID_STAR, storage));
+      }
+    }
+    newFn->defPoint->insertAfter(new DefExpr(ret));
+  }
+
+  inPlaceNewMap[newFn] = ret;
+  return ret;
+}
+
+static void stackAllocate(CallExpr* newCall, AggregateType* ct,
+                          EscapeInfo& info) {
+  FnSymbol* inPlaceNew = getInPlaceNew(newCall->resolvedFunction(), ct);
+  if (!inPlaceNew) return;
+
+  SET_LINENO(newCall);
+  Expr* stmt = newCall->getStmtExpr();
+  VarSymbol* storage = newTemp("stack_instance", ct);
+  stmt->insertBefore(new DefExpr(storage));
+  stmt->insertBefore(new CallExpr(PRIM_MOVE, storage,
+                                  new CallExpr(PRIM_STACK_ALLOCATE_CLASS,
+                                               ct->symbol)));
+  newCall->baseExpr->replace(new SymExpr(inPlaceNew));
+  newCall->insertAtTail(storage);
+
+  // 'delete' runs the deinit; the storage goes away with the frame
+  for_vector(CallExpr, del, info.deletes) {
+    SET_LINENO(del);
+    Expr* arg = del->get(1)->remove();
+    if (FnSymbol* deinitFn = ct->getDestructor()) {
+      VarSymbol* tmp = newTemp("deinit_tmp", ct);
+      del->insertBefore(new DefExpr(tmp));
+      del->insertBefore(new CallExpr(PRIM_MOVE, tmp,
+                                     new CallExpr(PRIM_CAST, ct->symbol,
+                                                  arg)));
+      del->replace(new CallExpr(deinitFn, tmp));
+    } else {
+      del->remove();
+    }
+  }
+}
+
+void stackAllocateClasses() {
+  if (fNoStackAllocateClasses) return;
+
+  std::vector<CallExpr*> newCalls;
+  forv_Vec(CallExpr, call, gCallExprs) {
+    if (!call->inTree()) continue;
+
+    FnSymbol* callee = call->resolvedFunction();
+    if (!callee || !callee->hasFlag(FLAG_NEW_WRAPPER)) continue;
+
+    CallExpr* move = toCallExpr(call->parentExpr);
+    if (move && isMoveOrAssign(move) && move->get(2) == call) {
+      newCalls.push_back(call);
+    }
+  }
+
+  for_vector(CallExpr, call, newCalls) {
+    CallExpr* move = toCallExpr(call->parentExpr);
+    SymExpr* lhs = toSymExpr(move->get(1));
+    FnSymbol* fn = toFnSymbol(call->parentSymbol);
+    AggregateType* ct = lhs ? toAggregateType(lhs->typeInfo()) : NULL;
+
+    if (!fn || !ct || !isClass(ct) || ct->symbol->hasFlag(FLAG_EXTERN) ||
+        fn->isIterator() || isTaskFun(fn)) {
+      continue;
+    }
+
+    EscapeInfo info;
+    info.allocStmt = move;
+    if (isTrackableCopy(lhs->symbol(), fn, info) &&
+        !escapes(lhs->symbol(), fn, info, 0) &&
+        !initializerEscapes(call->resolvedFunction())) {
+      stackAllocate(call, ct, info);
+    }
+  }
+
+  formalEscapes.clear();
+  inPlaceNewMap.clear();
+}
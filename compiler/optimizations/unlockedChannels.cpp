@@ -0,0 +1,194 @@
+/*
+ * Copyright 2020-2023 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "astutil.h"
+#include "driver.h"
+#include "expr.h"
+#include "ForallStmt.h"
+#include "LoopExpr.h"
+#include "optimizations.h"
+#include "stlUtil.h"
+#include "stmt.h"
+#include "stringutil.h"
+#include "symbol.h"
+
+#include "global-ast-vecs.h"
+
+#include <vector>
+
+/*
+   Create fileReaders and fileWriters that only one task uses without a
+   lock.
+
+     var r = f.reader();
+     r.readln(x);
+
+   A channel created with 'locking=true' (the default) takes its lock for
+   every read and write. When the channel is a local variable whose only
+   uses are calls to its reading and writing methods in the task that
+   created it, nothing else can use it concurrently, so we add
+   'locking=false' to the call that creates it.
+
+   This runs before normalize, so it goes by names. It only applies to
+   'x.reader(...)', 'x.writer(...)', 'openReader(...)' and
+   'openWriter(...)' calls that don't pass 'locking' already, and only
+   when no user code defines functions with those names. Since 'locking'
+   is the first formal of the methods and the second of the functions,
+   calls passing more positional arguments than that are skipped too.
+   The variable
+   must be declared without a type, every use must be a call to one of
+   the methods listed below, and no use may be inside a nested function
+   or a construct that creates tasks ('begin', 'cobegin', 'coforall',
+   'forall'). 'lines' is left out because its parallel iterator reads
+   from several tasks.
+*/
+
+static const char* channelMethods[] = {
+  "read", "readln", "readf", "readLine", "readAll", "readString",
+  "readBytes", "readThrough", "readTo", "readBinary", "readBits",
+  "readByte", "readCodepoint", "readLiteral", "readNewline",
+  "write", "writeln", "writef", "writeBinary", "writeBits", "writeString",
+  "writeBytes", "writeCodepoint", "writeByte", "writeLiteral",
+  "writeNewline", "matchLiteral", "matchNewline", "advanceTo",
+  "advanceThrough", "advancePastByte", "close", "flush", "offset",
+};
+
+static bool isChannelMethod(const char* name) {
+  for (const char* method : channelMethods) {
+    if (strcmp(name, method) == 0) return true;
+  }
+  return false;
+}
+
+static bool userDefinesCreationFn() {
+  forv_Vec(FnSymbol, fn, gFnSymbols) {
+    if (fn->getModule()->modTag != MOD_USER) continue;
+    if (strcmp(fn->name, "reader") == 0 ||
+        strcmp(fn->name, "writer") == 0 ||
+        strcmp(fn->name, "openReader") == 0 ||
+        strcmp(fn->name, "openWriter") == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Returns the call creating a channel in 'init', or nullptr.
+static CallExpr* getChannelCreation(Expr* init) {
+  CallExpr* call = toCallExpr(init);
+  if (call && (call->isPrimitive(PRIM_TRY_EXPR) ||
+               call->isPrimitive(PRIM_TRYBANG_EXPR))) {
+    call = toCallExpr(call->get(1));
+  }
+  if (!call || call->primitive) return nullptr;
+
+  int maxPositional = 1;
+  if (!call->isNamed("openReader") && !call->isNamed("openWriter")) {
+    maxPositional = 0;
+    CallExpr* dot = toCallExpr(call->baseExpr);
+    const char* name = nullptr;
+    if (!dot || !dot->isNamedAstr(astrSdot) ||
+        !get_string(dot->get(2), &name) ||
+        (strcmp(name, "reader") != 0 && strcmp(name, "writer") != 0)) {
+      return nullptr;
+    }
+  }
+
+  int numPositional = 0;
+  for_actuals(actual, call) {
+    if (NamedExpr* named = toNamedExpr(actual)) {
+      if (strcmp(named->name, "locking") == 0) return nullptr;
+    } else {
+      numPositional++;
+    }
+  }
+  return numPositional <= maxPositional ? call : nullptr;
+}
+
+// Is 'expr' somewhere that could run in a different task than 'def'?
+static bool mayRunInOtherTask(Expr* expr, DefExpr* def) {
+  if (expr->parentSymbol != def->parentSymbol) return true;
+
+  for (Expr* cur = expr->parentExpr; cur && cur != def->parentExpr;
+       cur = cur->parentExpr) {
+    if (isForallStmt(cur)) return true;
+    if (LoopExpr* loop = toLoopExpr(cur)) {
+      if (loop->forall) return true;
+    }
+    if (BlockStmt* block = toBlockStmt(cur)) {
+      CallExpr* info = block->blockInfoGet();
+      if (info && !info->isPrimitive(PRIM_BLOCK_ON) &&
+          !info->isPrimitive(PRIM_BLOCK_ELIDED_ON) &&
+          !info->isPrimitive(PRIM_BLOCK_LOCAL) &&
+          !info->isPrimitive(PRIM_BLOCK_UNLOCAL)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+static bool isTaskPrivateChannel(VarSymbol* var) {
+  DefExpr* def = var->defPoint;
+  for_SymbolSymExprs(se, var) {
+    CallExpr* dot = toCallExpr(se->parentExpr);
+    const char* name = nullptr;
+    if (!dot || !dot->isNamedAstr(astrSdot) || dot->get(1) != se ||
+        !get_string(dot->get(2), &name) || !isChannelMethod(name)) {
+      return false;
+    }
+
+    // 'r.method' has to be called, not stored
+    CallExpr* call = toCallExpr(dot->parentExpr);
+    if (!call || call->baseExpr != dot) return false;
+
+    if (mayRunInOtherTask(se, def)) return false;
+  }
+  return true;
+}
+
+void inferUnlockedChannels() {
+  if (fNoInferUnlockedChannels || ioModule == nullptr) return;
+  if (userDefinesCreationFn()) return;
+
+  std::vector<std::pair<VarSymbol*, CallExpr*> > candidates;
+  forv_Vec(DefExpr, def, gDefExprs) {
+    VarSymbol* var = toVarSymbol(def->sym);
+    if (!var || !def->inTree() || def->exprType || !def->init ||
+        !isFnSymbol(def->parentSymbol) ||
+        def->getModule()->modTag != MOD_USER ||
+        var->hasFlag(FLAG_REF_VAR) || var->hasFlag(FLAG_CONFIG) ||
+        var->hasFlag(FLAG_EXPORT) || var->hasFlag(FLAG_EXTERN)) {
+      continue;
+    }
+
+    if (CallExpr* create = getChannelCreation(def->init)) {
+      if (isTaskPrivateChannel(var)) {
+        candidates.push_back(std::make_pair(var, create));
+      }
+    }
+  }
+
+  for (auto& candidate : candidates) {
+    CallExpr* create = candidate.second;
+    SET_LINENO(create);
+    create->insertAtTail(new NamedExpr("locking", new SymExpr(gFalse)));
+  }
+}
@@ -0,0 +1,279 @@
+/*
+ * Copyright 2020-2023 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "astutil.h"
+#include "CForLoop.h"
+#include "driver.h"
+#include "expr.h"
+#include "optimizations.h"
+#include "stlUtil.h"
+#include "stmt.h"
+#include "symbol.h"
+#include "type.h"
+
+#include "global-ast-vecs.h"
+
+#include <vector>
+
+/*
+   Simplify the C for loops that lowerIterators builds for zippered
+   iteration.
+
+   A zippered loop gets the init() and incr() of every iterator in its
+   header, so after the iterators' classes are scalar replaced a loop like
+
+     forall (a, b, c) in zip(A, B, C)
+
+   has one counter per follower:
+
+     for (i1 = lo1, i2 = lo2, i3 = lo3; i1 <= hi1; i1 += s1, i2 += s2, i3 += s3) {
+       hasMore2 = i2 <= hi2; if !hasMore2 then halt(...);
+       hasMore3 = i3 <= hi3; if !hasMore3 then halt(...);
+       ...
+     }
+
+   where the per-iteration checks only exist with bounds checks on. The
+   extra counters and especially the early exits keep the backend from
+   vectorizing the loop. When the followers iterate over the same indices,
+   which is the common case for arrays over the same domain, this
+   replaces the other counters with the first one and removes the checks
+   that compare it against the same bound as the loop test.
+
+   A counter qualifies if it is a local integer that is set once in the
+   init block, stepped once in the incr block and only read elsewhere in
+   the loop body. Counters are merged only when their start and step are
+   known to be the same value; nothing is assumed about values that come
+   from memory the loop writes.
+*/
+
+// Is 'stmt' executed every time 'block' is, without any conditional or
+// loop in between?
+static bool isUnconditionallyIn(Expr* stmt, BlockStmt* block) {
+  for (Expr* parent = stmt->parentExpr; parent; parent = parent->parentExpr) {
+    if (parent == block) return true;
+
+    BlockStmt* bs = toBlockStmt(parent);
+    if (!bs || bs->isLoopStmt() || !bs->isRealBlockStmt()) return false;
+  }
+  return false;
+}
+
+static bool isInside(Expr* expr, Expr* ancestor) {
+  for (Expr* e = expr; e; e = e->parentExpr) {
+    if (e == ancestor) return true;
+  }
+  return false;
+}
+
+// Is 'sym' set anywhere inside 'loop'?
+static bool isDefinedIn(Symbol* sym, CForLoop* loop) {
+  if (sym->isImmediate()) return false;
+  if (isInside(sym->defPoint, loop)) return true;
+
+  for_SymbolDefs(def, sym) {
+    if (isInside(def, loop)) return true;
+  }
+  return false;
+}
+
+namespace {
+  struct LoopCounter {
+    VarSymbol* var;
+    Symbol*    start;
+    Symbol*    step;
+    CallExpr*  init;
+    CallExpr*  incr;
+  };
+}
+
+// Recognizes 'var += step' and 'var = var + step'.
+static bool getIncrement(CallExpr* call, VarSymbol*& var, Symbol*& step) {
+  SymExpr* lhs = toSymExpr(call->get(1));
+  if (!lhs) return false;
+
+  SymExpr* stepSe = nullptr;
+  if (call->isPrimitive(PRIM_ADD_ASSIGN)) {
+    stepSe = toSymExpr(call->get(2));
+  } else if (call->isPrimitive(PRIM_MOVE) || call->isPrimitive(PRIM_ASSIGN)) {
+    CallExpr* rhs = toCallExpr(call->get(2));
+    if (rhs && rhs->isPrimitive(PRIM_ADD)) {
+      SymExpr* a = toSymExpr(rhs->get(1));
+      SymExpr* b = toSymExpr(rhs->get(2));
+      if (a && a->symbol() == lhs->symbol()) stepSe = b;
+      else if (b && b->symbol() == lhs->symbol()) stepSe = a;
+    }
+  }
+  if (!stepSe) return false;
+
+  var = toVarSymbol(lhs->symbol());
+  step = stepSe->symbol();
+  return var != nullptr;
+}
+
+static bool findLoopCounter(CForLoop* loop, CallExpr* incr,
+                            LoopCounter& counter) {
+  VarSymbol* var = nullptr;
+  Symbol* step = nullptr;
+  if (!getIncrement(incr, var, step)) return false;
+
+  if (var->isRef() || var->hasFlag(FLAG_EXTERN) ||
+      !isFnSymbol(var->defPoint->parentSymbol) ||
+      !(is_int_type(var->type) || is_uint_type(var->type)) ||
+      step->type != var->type || step == var ||
+      isDefinedIn(step, loop)) {
+    return false;
+  }
+  if (!isUnconditionallyIn(incr, loop->incrBlockGet())) return false;
+
+  CallExpr* init = nullptr;
+  for_SymbolSymExprs(se, var) {
+    if (isInside(se, incr)) continue;
+
+    CallExpr* call = toCallExpr(se->parentExpr);
+
+    int defUse = isDefAndOrUse(se);
+    if (defUse & 1) {
+      // the only other definition is the one in the init block
+      if (init != nullptr || !call || !isMoveOrAssign(call) ||
+          call->get(1) != se || !isSymExpr(call->get(2)) ||
+          !isUnconditionallyIn(call, loop->initBlockGet())) {
+        return false;
+      }
+      init = call;
+    } else if (!isInside(se, loop) ||
+               isInside(se, loop->initBlockGet()) ||
+               isInside(se, loop->incrBlockGet())) {
+      // uses outside the test and body would see a value we don't keep
+      return false;
+    }
+  }
+  if (init == nullptr) return false;
+
+  counter.var = var;
+  counter.start = toSymExpr(init->get(2))->symbol();
+  counter.step = step;
+  counter.init = init;
+  counter.incr = incr;
+  return counter.start->type == var->type;
+}
+
+// Returns the comparison in the loop's test, if there is a simple one.
+static CallExpr* findTestComparison(CForLoop* loop) {
+  std::vector<CallExpr*> calls;
+  collectCallExprs(loop->testBlockGet(), calls);
+  for_vector(CallExpr, call, calls) {
+    if (isRelationalOperator(call) && isSymExpr(call->get(1)) &&
+        isSymExpr(call->get(2))) {
+      return call;
+    }
+  }
+  return nullptr;
+}
+
+// Replaces 't = iv OP bound' at the top of the body with 't = true' when
+// the loop test just checked the same thing.
+static void removeRedundantChecks(CForLoop* loop, LoopCounter& primary) {
+  CallExpr* test = findTestComparison(loop);
+  if (!test || toSymExpr(test->get(1))->symbol() != primary.var) return;
+
+  Symbol* bound = toSymExpr(test->get(2))->symbol();
+  if (isDefinedIn(bound, loop)) return;
+
+  for_alist(stmt, loop->body) {
+    CallExpr* move = toCallExpr(stmt);
+    if (!move || !move->isPrimitive(PRIM_MOVE)) continue;
+
+    CallExpr* rhs = toCallExpr(move->get(2));
+    if (!rhs || !rhs->isPrimitive() ||
+        rhs->primitive->tag != test->primitive->tag ||
+        rhs->numActuals() != 2) {
+      continue;
+    }
+
+    SymExpr* lhs = toSymExpr(rhs->get(1));
+    SymExpr* otherBound = toSymExpr(rhs->get(2));
+    if (lhs && otherBound && lhs->symbol() == primary.var &&
+        !isDefinedIn(otherBound->symbol(), loop) &&
+        isSameValue(otherBound->symbol(), bound) &&
+        move->get(1)->typeInfo() == dtBool) {
+      SET_LINENO(rhs);
+      rhs->replace(new SymExpr(gTrue));
+    }
+  }
+}
+
+static void simplifyZipperedLoop(CForLoop* loop) {
+  std::vector<LoopCounter> counters;
+  for_alist(stmt, loop->incrBlockGet()->body) {
+    std::vector<CallExpr*> calls;
+    collectCallExprs(stmt, calls);
+    for_vector(CallExpr, call, calls) {
+      LoopCounter counter;
+      if (call->isPrimitive() && findLoopCounter(loop, call, counter)) {
+        counters.push_back(counter);
+      }
+    }
+  }
+  if (counters.size() < 2) return;
+
+  // Prefer the counter the loop test reads, so the test keeps its form.
+  size_t primaryIdx = 0;
+  if (CallExpr* test = findTestComparison(loop)) {
+    Symbol* tested = toSymExpr(test->get(1))->symbol();
+    for (size_t i = 0; i < counters.size(); i++) {
+      if (counters[i].var == tested) primaryIdx = i;
+    }
+  }
+  LoopCounter primary = counters[primaryIdx];
+
+  bool changed = false;
+  for (size_t i = 0; i < counters.size(); i++) {
+    LoopCounter& other = counters[i];
+    if (i == primaryIdx || other.var->type != primary.var->type ||
+        !isSameValue(other.start, primary.start) ||
+        !isSameValue(other.step, primary.step)) {
+      continue;
+    }
+
+    other.init->remove();
+    other.incr->remove();
+    for_SymbolSymExprs(se, other.var) {
+      se->setSymbol(primary.var);
+    }
+    other.var->defPoint->remove();
+    changed = true;
+  }
+
+  if (changed) {
+    removeRedundantChecks(loop, primary);
+  }
+}
+
+void simplifyZipperedLoops() {
+  if (fNoOptimizeLoopIterators) return;
+
+  forv_Vec(BlockStmt, block, gBlockStmts) {
+    if (CForLoop* loop = toCForLoop(block)) {
+      if (loop->inTree() && loop->getFunction() != nullptr) {
+        simplifyZipperedLoop(loop);
+      }
+    }
+  }
+}
@@ -32,10 +32,15 @@
 #include "symbol.h"
 #include "wellknown.h"
 #include "misc.h"
+#include "version.h"
 
 #include "chpl/libraries/LibraryFile.h"
 #include "chpl/libraries/LibraryFileWriter.h"
 #include "chpl/parsing/parsing-queries.h"
+#include "chpl/util/filesystem.h"
+
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
 
 // Turn this on to dump AST/uAST when using --dyno.
 #define DUMP_WHEN_CONVERTING_UAST_TO_AST 0
@@ -46,6 +51,8 @@
 
 #include <cstdlib>
 #include <fstream>
+#include <thread>
+#include <unistd.h>
 
 chpl::ID dynoIdForLastContainingDecl = chpl::ID();
 
@@ -73,8 +80,12 @@ static const char* stdGenModulesPath;
 
 static void          countTokensInCmdLineFiles();
 
+static void          useDynoStdLibCache();
+
 static void          addDynoLibFiles();
 
+static void          prefetchModuleFiles();
+
 static void          parseInternalModules();
 
 static void          parseCommandLineFiles();
@@ -313,6 +324,95 @@ static void countTokensInCmdLineFiles() {
   clean_exit(0);
 }
 
+// The cached standard library is only valid for the same compiler
+// version, installation, and configuration, so all of those are folded
+// into its file name.
+static std::string dynoStdLibCacheKey() {
+  char version[128];
+  get_version(version, sizeof(version));
+
+  std::string key = version;
+  key += '\n';
+  key += CHPL_HOME;
+  for (const auto& kv : envMap) {
+    key += '\n';
+    key += kv.first;
+    key += '=';
+    key += kv.second ? kv.second : "";
+  }
+  for (const auto& kv : gDynoParams) {
+    key += '\n';
+    key += kv.first;
+    key += '=';
+    key += kv.second;
+  }
+
+  // FNV-1a, which is stable from one run to the next
+  uint64_t h = 0xcbf29ce484222325ULL;
+  for (unsigned char c : key) {
+    h ^= c;
+    h *= 0x100000001b3ULL;
+  }
+
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%016llx", (unsigned long long) h);
+  return buf;
+}
+
+// Is any source file stored in the library newer than the library itself?
+static bool dynoLibIsStale(const chpl::libraries::LibraryFile* lib,
+                           const std::string& libPath) {
+  llvm::sys::fs::file_status libStatus;
+  if (llvm::sys::fs::status(libPath, libStatus)) return true;
+  auto libTime = libStatus.getLastModificationTime();
+
+  for (auto path : lib->containedFilePaths()) {
+    llvm::sys::fs::file_status srcStatus;
+    if (llvm::sys::fs::status(path.str(), srcStatus) ||
+        srcStatus.getLastModificationTime() > libTime) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// With --dyno-std-lib-cache, use the standard library saved by an earlier
+// compilation if it is still up to date. Otherwise, arrange for this
+// compilation to save it.
+static void useDynoStdLibCache() {
+  if (gDynoStdLibCacheDir.empty()) return;
+
+  // generating a library has to be done with LLVM, and a compilation
+  // that is already generating one can't also fill the cache
+  if (!fLlvmCodegen || !gDynoGenLibOutput.empty()) return;
+
+  std::string cachePath = gDynoStdLibCacheDir + "/chpl_standard-" +
+                          dynoStdLibCacheKey() + ".dyno";
+
+  if (chpl::fileExists(cachePath.c_str())) {
+    auto libPath = chpl::UniqueString::get(gContext, cachePath);
+    auto lib = chpl::libraries::LibraryFile::load(gContext, libPath);
+    if (lib != nullptr && !dynoLibIsStale(lib, cachePath)) {
+      lib->registerLibrary(gContext);
+      return;
+    }
+  }
+
+  if (chpl::ensureDirExists(gDynoStdLibCacheDir) ||
+      !chpl::isPathWriteable(gDynoStdLibCacheDir)) {
+    USR_WARN("could not write to the standard library cache directory %s",
+             gDynoStdLibCacheDir.c_str());
+    return;
+  }
+
+  // write to a temporary file which codegen renames once it is complete,
+  // so that concurrent compilations never see a partial file
+  gDynoStdLibCachePath = cachePath;
+  gDynoGenLibOutput = cachePath + ".tmp" + std::to_string(getpid());
+  gDynoGenStdLib = true;
+}
+
 static void addDynoLibFiles() {
   const char* inputFileName = NULL;
   int fileNum = 0;
@@ -481,7 +581,7 @@ static void parseCommandLineFiles() {
   if (!gDynoGenLibOutput.empty()) {
     std::vector<UniqueString> genLibPaths;
 
-    if (gDynoGenLibOutput == "chpl_standard.dyno") {
+    if (gDynoGenStdLib) {
       // gather the paths to the standard libraries
       for (auto& path : parsedPaths) {
         const auto& modulePrefix = chpl::parsing::bundledModulePath(gContext);
@@ -1242,6 +1342,55 @@ static const char* searchThePath(const char*      modName,
   return retval;
 }
 
+// Read the files that are about to be parsed using several threads, so
+// that the parser does not have to wait for each one in turn. These are
+// the files named on the command line and the .chpl files in the
+// internal module directories, nearly all of which are parsed by every
+// compilation. The standard modules are only read as they are used.
+static void prefetchModuleFiles() {
+  std::vector<std::string> paths;
+
+  auto addPath = [&paths](UniqueString path) {
+    UniqueString libPath;
+    if (!gContext->pathHasLibrary(path, libPath)) {
+      paths.push_back(path.str());
+    }
+  };
+
+  int fileNum = 0;
+  const char* inputFileName = NULL;
+  while ((inputFileName = nthFilename(fileNum++))) {
+    if (isChplSource(inputFileName)) {
+      addPath(cleanLocalPath(UniqueString::get(gContext, inputFileName)));
+    }
+  }
+
+  forv_Vec(const char*, dirName, sIntModPath) {
+    std::string dirStr = dirName;
+
+    // form the paths the same way as searchThePath
+    while (dirStr.size() > 1 && dirStr.back() == '/') {
+      dirStr.pop_back();
+    }
+
+    std::error_code err;
+    for (llvm::sys::fs::directory_iterator it(dirStr, err), end;
+         it != end && !err; it.increment(err)) {
+      std::string name = llvm::sys::path::filename(it->path()).str();
+      if (name.size() > 5 && name.compare(name.size() - 5, 5, ".chpl") == 0) {
+        addPath(UniqueString::get(gContext, dirStr + "/" + name));
+      }
+    }
+  }
+
+  unsigned nThreads = std::thread::hardware_concurrency();
+  if (nThreads > 8) nThreads = 8;
+
+  if (nThreads > 1) {
+    chpl::parsing::prefetchFileTexts(gContext, paths, nThreads);
+  }
+}
+
 void parseAndConvertUast() {
 
   // TODO: Runtime configuration of debug level for dyno parser.
@@ -1253,8 +1402,12 @@ void parseAndConvertUast() {
 
   if (countTokens || printTokens) countTokensInCmdLineFiles();
 
+  useDynoStdLibCache();
+
   addDynoLibFiles();
 
+  prefetchModuleFiles();
+
   parseInternalModules();
 
   parseCommandLineFiles();
@@ -229,6 +229,54 @@ bool AddModuleInitBlocks::shouldProcess(ModuleSymbol* mod) {
   return true;
 }
 
+// The modules whose initializers 'mod's initializer calls, in order.
+std::vector<ModuleSymbol*>
+AddModuleInitBlocks::initDependencies(ModuleSymbol* mod) {
+  std::vector<ModuleSymbol*> deps;
+
+  // If I have a parent, I need it initialized first,
+  // since all of its symbols are visible to me.
+  if (ModuleSymbol* parent = mod->defPoint->getModule())
+    // The initializer for theProgram is called specially in main.c,
+    // so we don't have to call it here.
+    if (parent != theProgram && parent != rootModule)
+      deps.push_back(parent);
+
+  // Call the initializer for each module I use.
+  for (ModuleSymbol* usedMod : mod->modUseList) {
+    if (usedMod != standardModule) {
+      deps.push_back(usedMod);
+    }
+  }
+
+  return deps;
+}
+
+// The modules that are known to be initialized once 'mod's initializer
+// returns, including 'mod' itself.
+const std::set<ModuleSymbol*>&
+AddModuleInitBlocks::initializedBy(ModuleSymbol* mod) {
+  auto it = initializedByCache.find(mod);
+  if (it != initializedByCache.end())
+    return it->second;
+
+  std::set<ModuleSymbol*>& result = initializedByCache[mod];
+  std::vector<ModuleSymbol*> work;
+  result.insert(mod);
+  work.push_back(mod);
+  while (!work.empty()) {
+    ModuleSymbol* cur = work.back();
+    work.pop_back();
+    if (!shouldProcess(cur))
+      continue;
+    for (ModuleSymbol* dep : initDependencies(cur)) {
+      if (result.insert(dep).second)
+        work.push_back(dep);
+    }
+  }
+  return result;
+}
+
 // TODO GLOBALS standardModule gAddModuleFn
 void AddModuleInitBlocks::process(ModuleSymbol* mod) {
   FnSymbol* fn = toFnSymbol(mod->initFn);
@@ -255,18 +303,24 @@ void AddModuleInitBlocks::process(ModuleSymbol* mod) {
 
   BlockStmt* initBlock = new BlockStmt();
 
-  // If I have a parent, I need it initialized first,
-  // since all of its symbols are visible to me.
-  if (ModuleSymbol* parent = mod->defPoint->getModule())
-    // The initializer for theProgram is called specially in main.c,
-    // so we don't have to call it here.
-    if (parent != theProgram && parent != rootModule)
-      initBlock->insertAtTail(new CallExpr(parent->initFn));
-
-  // Call the initializer for each module I use.
-  for (ModuleSymbol* usedMod : mod->modUseList) {
-    if (usedMod != standardModule) {
-      initBlock->insertAtTail(new CallExpr(usedMod->initFn));
+  // Skip the call for a module that an earlier call in this block has
+  // already initialized, since the guard would just return.  That is
+  // only certain if the earlier module's initializer can't get back to
+  // this one: if it can, this initializer may be running from inside it,
+  // before it got to the module in question.
+  std::vector<ModuleSymbol*> called;
+  for (ModuleSymbol* dep : initDependencies(mod)) {
+    bool covered = false;
+    for (ModuleSymbol* prev : called) {
+      const std::set<ModuleSymbol*>& done = initializedBy(prev);
+      if (done.count(dep) && !done.count(mod)) {
+        covered = true;
+        break;
+      }
+    }
+    if (!covered) {
+      initBlock->insertAtTail(new CallExpr(dep->initFn));
+      called.push_back(dep);
     }
   }
 
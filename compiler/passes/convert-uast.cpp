@@ -118,6 +118,10 @@ struct LoopAttributeInfo {
   LLVMMetadataList llvmMetadata;
   // The @assertOnGpu attribute, if one is provided by the user.
   const uast::Attribute* assertOnGpuAttr = nullptr;
+  // The @dynamicSchedule attribute, if one is provided by the user.
+  const uast::Attribute* dynamicScheduleAttr = nullptr;
+  // The @streamingReads attribute, if one is provided by the user.
+  const uast::Attribute* streamingReadsAttr = nullptr;
 
   void insertGpuEligibilityAssertion(BlockStmt* body) {
     if (assertOnGpuAttr) {
@@ -125,6 +129,17 @@ struct LoopAttributeInfo {
                                       new SymExpr(gTrue)));
     }
   }
+
+  // Each iteration of a @streamingReads loop puts the task into the
+  // remote cache's streaming mode, so that the remote data it reads
+  // doesn't displace what's in the cache. The defer ends it however
+  // the iteration ends.
+  void insertStreamingReads(BlockStmt* body) {
+    if (streamingReadsAttr) {
+      body->insertAtHead(new DeferStmt(new CallExpr(PRIM_CACHE_STREAM_END)));
+      body->insertAtHead(new CallExpr(PRIM_CACHE_STREAM_BEGIN));
+    }
+  }
 };
 
 // TODO: replace this global variable with a field in Converter
@@ -392,13 +407,35 @@ struct Converter {
     return LLVMMetadata::constructBool(attrName, true);
   }
 
+  // Build e.g. 'llvm.loop.vectorize.width' from '@llvm.vectorizeWidth(4)'.
+  LLVMMetadataPtr buildIntLoopHint(const uast::Attribute* node,
+                                   const char* llvmName) {
+    const uast::IntLiteral* value = nullptr;
+    if (node->numActuals() == 1) {
+      value = node->actual(0)->toIntLiteral();
+    }
+    if (value == nullptr || value->value() < 1) {
+      auto loc = chpl::parsing::locateId(context, node->id());
+      std::string msg = "'" + node->name().str() +
+                        "' requires a single positive integer literal";
+      auto err = GeneralError::get(ErrorBase::ERROR, loc, msg);
+      context->report(std::move(err));
+      return nullptr;
+    }
+    return LLVMMetadata::constructInt(astr(llvmName), value->value());
+  }
+
   LoopAttributeInfo buildLoopAttributes(const uast::Loop* node) {
     auto attrs = node->attributeGroup();
     if (attrs == nullptr) return {};
 
     auto llvmMetadata = UniqueString::get(context, "llvm.metadata");
     auto assertVectorized = UniqueString::get(context, "llvm.assertVectorized");
+    auto vectorizeWidth = UniqueString::get(context, "llvm.vectorizeWidth");
+    auto unrollCount = UniqueString::get(context, "llvm.unrollCount");
     auto assertOnGpu = UniqueString::get(context, "assertOnGpu");
+    auto dynamicSchedule = UniqueString::get(context, "dynamicSchedule");
+    auto streamingReads = UniqueString::get(context, "streamingReads");
 
     LoopAttributeInfo toReturn;
 
@@ -409,11 +446,37 @@ struct Converter {
     if (auto a = attrs->getAttributeNamed(assertVectorized)) {
       toReturn.llvmMetadata.push_back(buildAssertVectorize(a));
     }
+    if (auto a = attrs->getAttributeNamed(vectorizeWidth)) {
+      if (auto md = buildIntLoopHint(a, "llvm.loop.vectorize.width")) {
+        toReturn.llvmMetadata.push_back(md);
+      }
+    }
+    if (auto a = attrs->getAttributeNamed(unrollCount)) {
+      if (auto md = buildIntLoopHint(a, "llvm.loop.unroll.count")) {
+        toReturn.llvmMetadata.push_back(md);
+      }
+    }
     toReturn.assertOnGpuAttr = attrs->getAttributeNamed(assertOnGpu);
+    toReturn.dynamicScheduleAttr = attrs->getAttributeNamed(dynamicSchedule);
+    toReturn.streamingReadsAttr = attrs->getAttributeNamed(streamingReads);
 
     return toReturn;
   }
 
+  // '@dynamicSchedule forall i in r' is lowered to
+  // 'forall i in dynamic(r, chunkSize)', using the leader from the
+  // DynamicIters package. Its tasks claim chunks from a shared atomic
+  // counter instead of each getting a fixed share of the iterations.
+  Expr* buildDynamicScheduleIterator(const uast::Attribute* attr,
+                                     Expr* iterator) {
+    CallExpr* ret = new CallExpr("dynamic", iterator);
+    if (attr->numActuals() == 1) {
+      Expr* chunkSize = toExpr(convertAST(attr->actual(0)));
+      ret->insertAtTail(new NamedExpr("chunkSize", chunkSize));
+    }
+    return ret;
+  }
+
   Expr* visit(const uast::AttributeGroup* node) {
     INT_FATAL("Should not be called directly!");
     return nullptr;
@@ -493,6 +556,14 @@ struct Converter {
         sym->addFlag(flag);
       }
     }
+
+    if (attr->getAttributeNamed(USTR("soa"))) {
+      sym->addFlag(FLAG_SOA_ARRAY);
+    }
+
+    if (attr->getAttributeNamed(USTR("hotField"))) {
+      sym->addFlag(FLAG_HOT_FIELD);
+    }
   }
 
   void attachSymbolVisibility(const uast::Decl* node, Symbol* sym) {
@@ -1705,6 +1776,7 @@ struct Converter {
     auto loopAttributes = buildLoopAttributes(node);
     if (loopAttributes.assertOnGpuAttr)
       CHPL_REPORT(context, InvalidGpuAssertion, node, loopAttributes.assertOnGpuAttr);
+    loopAttributes.insertStreamingReads(body);
     return DoWhileStmt::build(condExpr, body, std::move(loopAttributes.llvmMetadata));
   }
 
@@ -1723,6 +1795,7 @@ struct Converter {
     auto loopAttributes = buildLoopAttributes(node);
     if (loopAttributes.assertOnGpuAttr)
       CHPL_REPORT(context, InvalidGpuAssertion, node, loopAttributes.assertOnGpuAttr);
+    loopAttributes.insertStreamingReads(body);
     return WhileDoStmt::build(condExpr, body, std::move(loopAttributes.llvmMetadata));
   }
 
@@ -1835,6 +1908,10 @@ struct Converter {
 
       auto loopAttributes = buildLoopAttributes(node);
       loopAttributes.insertGpuEligibilityAssertion(body);
+      loopAttributes.insertStreamingReads(body);
+      if (auto attr = loopAttributes.dynamicScheduleAttr) {
+        iterator = buildDynamicScheduleIterator(attr, iterator);
+      }
       return ForallStmt::build(indices, iterator, intents, body, zippered,
                                serialOK);
     }
@@ -1912,6 +1989,7 @@ struct Converter {
       auto loopAttributes = buildLoopAttributes(node);
       if (loopAttributes.assertOnGpuAttr)
         CHPL_REPORT(context, InvalidGpuAssertion, node, loopAttributes.assertOnGpuAttr);
+      loopAttributes.insertStreamingReads(block);
       ret = ForLoop::buildForLoop(index, iteratorExpr, block, zippered,
                                   isForExpr, std::move(loopAttributes.llvmMetadata));
     }
@@ -1971,6 +2049,7 @@ struct Converter {
 
       auto loopAttributes = buildLoopAttributes(node);
       loopAttributes.insertGpuEligibilityAssertion(body);
+      loopAttributes.insertStreamingReads(body);
       return ForallStmt::build(indices, iterator, intents, body, zippered,
                                serialOK);
     }
@@ -1999,6 +2078,7 @@ struct Converter {
 
     auto loopAttributes = buildLoopAttributes(node);
     loopAttributes.insertGpuEligibilityAssertion(body);
+    loopAttributes.insertStreamingReads(body);
     auto ret = ForLoop::buildForeachLoop(indices, iteratorExpr, intents, body,
                                          zippered,
                                          isForExpr, std::move(loopAttributes.llvmMetadata));
@@ -439,6 +439,7 @@ bool isDenormalizable(Symbol* sym,
                   // We want to pass symbols to kernel launches for now. This
                   // simplifies its codegen.
                   ce->isPrimitive(PRIM_GPU_KERNEL_LAUNCH_FLAT) ||
+                  ce->isPrimitive(PRIM_GPU_KERNEL_LAUNCH) ||
 
                   isBadMove(ce) ||
                   isValPassedByRef(ce, se) ||
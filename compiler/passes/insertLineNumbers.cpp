@@ -149,9 +149,12 @@ bool InsertLineNumbers::shouldPreferASTLine(/*const*/ FnSymbol* fn,
       !fn->hasFlag(FLAG_COMPILER_GENERATED) && !fn->hasFlag(FLAG_INLINE))
     return true;
 
-  // developer mode generally uses AST line numbers
+  // developer mode generally uses AST line numbers, as does
+  // --no-propagate-line-numbers, which trades the user's line in errors
+  // from library code for not threading _ln/_fn through every call.
   // FLAG_ALWAYS_PROPAGATE_LINE_FILE_INFO overrides
-  else if (developer && !fn->hasFlag(FLAG_ALWAYS_PROPAGATE_LINE_FILE_INFO))
+  else if ((developer || fNoPropagateLineNumbers) &&
+           !fn->hasFlag(FLAG_ALWAYS_PROPAGATE_LINE_FILE_INFO))
     return true;
 
   return false;
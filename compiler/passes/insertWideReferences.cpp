@@ -176,6 +176,18 @@
 //     - Under certain circumstances, 'expr' can be local within the body
 //       of the on-statement.
 //
+// - Whole-function locality inference:
+//   Non-distributed code compiled for multiple locales pays for wide
+//   pointers it can never need.  An interprocedural analysis could seed
+//   'local' facts (the target of "on x" inside the on_fn, values proven
+//   local by auto-local-access checks, fresh allocations) and push them
+//   down the call graph until they hit a formal that some caller widens.
+//   Wideness is per-symbol rather than per-call-path, so making use of
+//   those facts means cloning functions for narrow callers, which is the
+//   same code-size tradeoff as for function arguments above.  The on_fn
+//   case needs the bundle field holding 'x' to be traced from the
+//   wrapon_fn back to its PRIM_WIDE_GET_LOCALE at the call site.
+//
 // - Strings:
 //   Ongoing work on strings should remove the need for all the special
 //   treatment in this pass.
@@ -2230,7 +2242,8 @@ static void fixAST() {
         makeMatch(lhs, rhs);
         makeMatch(rhs, lhs);
       }
-      else if (call->isPrimitive(PRIM_GPU_KERNEL_LAUNCH_FLAT)) {
+      else if (call->isPrimitive(PRIM_GPU_KERNEL_LAUNCH_FLAT) ||
+               call->isPrimitive(PRIM_GPU_KERNEL_LAUNCH)) {
         // currently, we don't pass wide references to GPU kernels as we don't
         // know how to handle them. This'll change
         for_actuals (actual, call) {
@@ -2271,6 +2284,106 @@ static void moveAddressSourcesToTemp()
   }
 }
 
+//
+// A local check can't fail if an earlier check of the same variable always
+// runs before it and the variable hasn't changed since.  Local blocks get
+// one check per access of a wide variable, so a block or loop body that
+// uses 'x' several times checks it each time.  This walks each function
+// in order, remembering what has been proven local, and removes the
+// checks that are redundant.
+//
+// Only locals and formals whose address isn't taken are tracked, so any
+// change to them shows up as a def in the function.  A fact proven inside
+// a nested block isn't carried out of it; one proven before a loop is
+// carried in unless the loop changes the variable.  Labels can be jumped
+// to from elsewhere, so everything is forgotten at a label.
+//
+typedef std::set<Symbol*> ProvenLocalSet;
+
+static bool canTrackLocality(Symbol* sym, std::map<Symbol*, bool>& cache) {
+  std::map<Symbol*, bool>::iterator it = cache.find(sym);
+  if (it != cache.end())
+    return it->second;
+
+  bool ok = (isVarSymbol(sym) || isArgSymbol(sym)) &&
+            isFnSymbol(sym->defPoint->parentSymbol);
+  if (ok) {
+    for_SymbolSymExprs(se, sym) {
+      CallExpr* parent = toCallExpr(se->parentExpr);
+      if (parent && (parent->isPrimitive(PRIM_ADDR_OF) ||
+                     parent->isPrimitive(PRIM_SET_REFERENCE))) {
+        ok = false;
+        break;
+      }
+    }
+  }
+  cache[sym] = ok;
+  return ok;
+}
+
+static void forgetDefinedIn(BaseAST* ast, ProvenLocalSet& proven) {
+  if (proven.empty())
+    return;
+
+  std::vector<SymExpr*> ses;
+  collectSymExprs(ast, ses);
+  for_vector(SymExpr, se, ses) {
+    if (proven.count(se->symbol()) && (isDefAndOrUse(se) & 1))
+      proven.erase(se->symbol());
+  }
+}
+
+static void removeRedundantLocalChecks(BlockStmt* block,
+                                       ProvenLocalSet proven,
+                                       std::map<Symbol*, bool>& trackable) {
+  if (block->isLoopStmt())
+    forgetDefinedIn(block, proven);
+
+  for (Expr* stmt = block->body.head; stmt; ) {
+    Expr* next = stmt->next;
+
+    if (CallExpr* call = toCallExpr(stmt)) {
+      SymExpr* se = call->isPrimitive(PRIM_LOCAL_CHECK) ?
+                    toSymExpr(call->get(1)) : NULL;
+      if (se && proven.count(se->symbol())) {
+        call->remove();
+      } else if (se) {
+        if (canTrackLocality(se->symbol(), trackable))
+          proven.insert(se->symbol());
+      } else {
+        forgetDefinedIn(call, proven);
+      }
+    } else if (DefExpr* def = toDefExpr(stmt)) {
+      if (isLabelSymbol(def->sym))
+        proven.clear();
+    } else if (BlockStmt* inner = toBlockStmt(stmt)) {
+      removeRedundantLocalChecks(inner, proven, trackable);
+      forgetDefinedIn(inner, proven);
+    } else if (CondStmt* cond = toCondStmt(stmt)) {
+      forgetDefinedIn(cond->condExpr, proven);
+      removeRedundantLocalChecks(cond->thenStmt, proven, trackable);
+      if (cond->elseStmt)
+        removeRedundantLocalChecks(cond->elseStmt, proven, trackable);
+      forgetDefinedIn(cond, proven);
+    } else {
+      forgetDefinedIn(stmt, proven);
+    }
+
+    stmt = next;
+  }
+}
+
+static void removeRedundantLocalChecks() {
+  if (fNoLocalChecks)
+    return;
+
+  std::map<Symbol*, bool> trackable;
+  forv_Vec(FnSymbol, fn, gFnSymbols) {
+    if (fn->inTree())
+      removeRedundantLocalChecks(fn->body, ProvenLocalSet(), trackable);
+  }
+}
+
 //
 // Nearly the same as addUseOrDef, but 'exp' may not be a SymExpr representing
 // 'field'. It may instead be a literal or a runtime value as we sometimes see
@@ -2571,6 +2684,7 @@ insertWideReferences(void) {
   // NWR
   fixAST();
   moveAddressSourcesToTemp();
+  removeRedundantLocalChecks();
 
   handleIsWidePointer();
 
@@ -36,6 +36,7 @@
 #include "library.h"
 #include "LoopExpr.h"
 #include "forallOptimizations.h"
+#include "optimizations.h"
 #include "scopeResolve.h"
 #include "splitInit.h"
 #include "stlUtil.h"
@@ -133,6 +134,10 @@ void normalize() {
 
   insertModuleInit();
 
+  splitSoaArrays();
+
+  inferUnlockedChannels();
+
   doPreNormalizeArrayOptimizations();
 
   moveAndCheckInterfaceConstraints();
@@ -1506,7 +1511,7 @@ void addMentionToEndOfStatement(Expr* node, CallExpr* existingEndOfStatement) {
       if (!var->hasFlag(FLAG_TEMP) &&
           !var->isParameter() &&
           // exclude global variables, e.g. gMethodToken
-          var->defPoint->getFunction() == node->getFunction()) {
+          var->defPoint->getFunction() == fn) {
 
         // check that the variable is defined outside of the
         // node (to avoid adding mentions of removed variables
@@ -1597,13 +1602,22 @@ bool AddEndOfStatementMarkers::enterDefExpr(DefExpr* node) {
   VarSymbol* var = toVarSymbol(node->sym);
 
   if (var != NULL && !var->hasFlag(FLAG_TEMP)) {
-    // Scroll forward to find a PRIM_END_OF_STATEMENT
-    // (these are added in the parser along with DefExprs)
+    // Find the last PRIM_END_OF_STATEMENT after the DefExpr
+    // (these are added in the parser along with DefExprs).  Scanning back
+    // from the end of the block usually stops right away, where scanning
+    // forward through the rest of the block for every variable made
+    // very long functions quadratic.
     CallExpr* endOfStatement = NULL;
-    for (Expr* cur = node->next; cur != NULL; cur = cur->next)
-      if (CallExpr* call = toCallExpr(cur))
-        if (call->isPrimitive(PRIM_END_OF_STATEMENT))
-          endOfStatement = call;
+    if (node->list != NULL) {
+      for (Expr* cur = node->list->tail; cur != node; cur = cur->prev) {
+        if (CallExpr* call = toCallExpr(cur)) {
+          if (call->isPrimitive(PRIM_END_OF_STATEMENT)) {
+            endOfStatement = call;
+            break;
+          }
+        }
+      }
+    }
     addMentionToEndOfStatement(node, endOfStatement);
     return false;
   }
@@ -383,6 +383,68 @@ static void insertAutoDestroyForVar(Symbol *arg, FnSymbol* wrap_fn)
   wrap_fn->insertAtTail(autoDestroyCall);
 }
 
+// If 'arg' is a local whose last use is the task fn call 'fcall', apart
+// from its autoDestroy later in the same block, returns that autoDestroy.
+// The value can then be moved into the arg bundle instead of autoCopied,
+// since the wrapper's autoDestroy takes over from the caller's.
+static CallExpr* findMovableTaskArgDestroy(Expr* arg, CallExpr* fcall) {
+  if (fNoRemoveCopyCalls) return NULL;
+
+  SymExpr*   s   = toSymExpr(arg);
+  VarSymbol* var = toVarSymbol(s->symbol());
+  Expr*      block = fcall->parentExpr;
+
+  if (var == NULL || var->isRef() || var->hasFlag(FLAG_EXTERN) ||
+      var->defPoint->parentExpr != block) {
+    return NULL;
+  }
+
+  FnSymbol* autoDestroyFn = getAutoDestroy(var->getValType());
+  if (autoDestroyFn == NULL || getAutoCopyForType(var->getValType()) == NULL)
+    return NULL;
+
+  CallExpr* destroy = NULL;
+
+  for_SymbolSymExprs(se, var) {
+    if (se == s) continue;
+
+    CallExpr* call = toCallExpr(se->parentExpr);
+    if (call && (call->isPrimitive(PRIM_ADDR_OF) ||
+                 call->isPrimitive(PRIM_SET_REFERENCE))) {
+      return NULL;
+    }
+
+    Expr* stmt = se;
+    while (stmt->parentExpr != block) stmt = stmt->parentExpr;
+
+    bool afterCall = false;
+    for (Expr* e = fcall->next; e != NULL && !afterCall; e = e->next) {
+      afterCall = (e == stmt);
+    }
+
+    if (afterCall) {
+      if (destroy == NULL && stmt == call &&
+          call->resolvedFunction() == autoDestroyFn &&
+          call->numActuals() == 1) {
+        destroy = call;
+      } else {
+        return NULL;
+      }
+    }
+  }
+
+  if (destroy == NULL) return NULL;
+
+  // Something could jump to a label in between and skip the bundle.
+  for (Expr* e = fcall->next; e != destroy; e = e->next) {
+    if (DefExpr* def = toDefExpr(e)) {
+      if (isLabelSymbol(def->sym)) return NULL;
+    }
+  }
+
+  return destroy;
+}
+
 static void
 bundleArgs(CallExpr* fcall, BundleArgsFnData &baData) {
   SET_LINENO(fcall);
@@ -424,9 +486,15 @@ bundleArgs(CallExpr* fcall, BundleArgsFnData &baData) {
 
     // Insert autoCopy/autoDestroy as needed for "begin" or "nonblocking on"
     // calls (and some other cases).
+    // If this is the arg's last use, move it instead of copying it.
     Symbol  *var = NULL;
     bool autoCopy = needsAutoCopyAutoDestroyForArg(formal, arg, fn);
-    if (autoCopy)
+    CallExpr* lastDestroy = autoCopy ? findMovableTaskArgDestroy(arg, fcall)
+                                     : NULL;
+    if (lastDestroy)
+      lastDestroy->remove();
+
+    if (autoCopy && !lastDestroy)
       var = insertAutoCopyForTaskArg(arg, fcall, fn);
     else
       var = toSymExpr(arg)->symbol();
@@ -47,26 +47,28 @@ addCache(SymbolMapCache& cache,
          FnSymbol*       oldFn,
          FnSymbol*       fn,
          SymbolMap*      map) {
-  Vec<SymbolMapCacheEntry*>* entries = cache.get(oldFn);
-  SymbolMapCacheEntry*       entry   = new SymbolMapCacheEntry(fn, map);
+  SymbolMapCacheBuckets* buckets = cache.get(oldFn);
+  SymbolMapCacheEntry*   entry   = new SymbolMapCacheEntry(fn, map);
 
-  if (entries) {
-    entries->add(entry);
-
-  } else {
-    entries = new Vec<SymbolMapCacheEntry*>();
-    entries->add(entry);
-    cache.put(oldFn, entries);
+  if (buckets == NULL) {
+    buckets = new SymbolMapCacheBuckets();
+    cache.put(oldFn, buckets);
   }
+
+  (*buckets)[hashSymbolMap(map)].push_back(entry);
 }
 
 
 FnSymbol*
 checkCache(SymbolMapCache& cache, FnSymbol* oldFn, SymbolMap* map) {
-  if (Vec<SymbolMapCacheEntry*>* entries = cache.get(oldFn)) {
-    forv_Vec(SymbolMapCacheEntry, entry, *entries) {
-      if (isCacheEntryMatch(map, &entry->map))
-        return entry->fn;
+  if (SymbolMapCacheBuckets* buckets = cache.get(oldFn)) {
+    SymbolMapCacheBuckets::iterator it = buckets->find(hashSymbolMap(map));
+
+    if (it != buckets->end()) {
+      for (SymbolMapCacheEntry* entry : it->second) {
+        if (isCacheEntryMatch(map, &entry->map))
+          return entry->fn;
+      }
     }
   }
   return NULL;
@@ -76,14 +78,40 @@ checkCache(SymbolMapCache& cache, FnSymbol* oldFn, SymbolMap* map) {
 void
 freeCache(SymbolMapCache& cache) {
   form_Map(SymbolMapCacheElem, elem, cache) {
-    forv_Vec(SymbolMapCacheEntry, entry, *elem->value) {
-      delete entry;
+    for (auto& bucket : *elem->value) {
+      for (SymbolMapCacheEntry* entry : bucket.second) {
+        delete entry;
+      }
     }
     delete elem->value;
   }
   cache.clear();
 }
 
+// Combine the pairs with a commutative operation (+) so that the
+// order of the entries in the map does not matter. Pairs with a
+// NULL value are skipped since isCacheEntryMatch treats them the
+// same as missing keys.
+size_t hashSymbolMap(SymbolMap* map) {
+  size_t retval = 0;
+
+  form_Map(SymbolMapElem, e, *map) {
+    if (e->value != NULL) {
+      uint64_t h = (uint64_t)(uintptr_t) e->key;
+      h ^= (uint64_t)(uintptr_t) e->value * 0x9e3779b97f4a7c15ULL;
+      // finalizer from MurmurHash3, to spread the pointer bits
+      h ^= h >> 33;
+      h *= 0xff51afd7ed558ccdULL;
+      h ^= h >> 33;
+      h *= 0xc4ceb9fe1a85ec53ULL;
+      h ^= h >> 33;
+      retval += (size_t) h;
+    }
+  }
+
+  return retval;
+}
+
 static bool isCacheEntryMatch(SymbolMap* s1, SymbolMap* s2) {
   form_Map(SymbolMapElem, e, *s1) {
     if (s2->get(e->key) != e->value) {
@@ -243,17 +271,15 @@ addCache(SymbolMapScopeCache& cache,
          FnSymbol*       oldFn,
          FnSymbol*       fn,
          SymbolMap*      map) {
-  Vec<SymbolMapScopeCacheEntry*>* entries = cache.get(oldFn);
-  SymbolMapScopeCacheEntry*       entry = new SymbolMapScopeCacheEntry(fn, map);
-
-  if (entries) {
-    entries->add(entry);
+  SymbolMapScopeCacheBuckets* buckets = cache.get(oldFn);
+  SymbolMapScopeCacheEntry*   entry = new SymbolMapScopeCacheEntry(fn, map);
 
-  } else {
-    entries = new Vec<SymbolMapScopeCacheEntry*>();
-    entries->add(entry);
-    cache.put(oldFn, entries);
+  if (buckets == NULL) {
+    buckets = new SymbolMapScopeCacheBuckets();
+    cache.put(oldFn, buckets);
   }
+
+  (*buckets)[hashSymbolMap(map)].push_back(entry);
 }
 
 
@@ -264,11 +290,16 @@ FnSymbol*
 checkCache(SymbolMapScopeCache& cache, FnSymbol* oldFn,
            VisibilityInfo* visInfo, SymbolMap* map)
 {
-  if (Vec<SymbolMapScopeCacheEntry*>* entries = cache.get(oldFn)) {
-    forv_Vec(SymbolMapScopeCacheEntry, entry, *entries) {
-      if (isCacheEntryMatch(map, &entry->map) &&
-          (visInfo == NULL || isApplicableInstantiation(*visInfo, entry->fn)) )
-        return entry->fn;
+  if (SymbolMapScopeCacheBuckets* buckets = cache.get(oldFn)) {
+    SymbolMapScopeCacheBuckets::iterator it =
+      buckets->find(hashSymbolMap(map));
+
+    if (it != buckets->end()) {
+      for (SymbolMapScopeCacheEntry* entry : it->second) {
+        if (isCacheEntryMatch(map, &entry->map) &&
+            (visInfo == NULL || isApplicableInstantiation(*visInfo, entry->fn)) )
+          return entry->fn;
+      }
     }
   }
 
@@ -279,8 +310,10 @@ checkCache(SymbolMapScopeCache& cache, FnSymbol* oldFn,
 void
 freeCache(SymbolMapScopeCache& cache) {
   form_Map(SymbolMapScopeCacheElem, elem, cache) {
-    forv_Vec(SymbolMapScopeCacheEntry, entry, *elem->value) {
-      delete entry;
+    for (auto& bucket : *elem->value) {
+      for (SymbolMapScopeCacheEntry* entry : bucket.second) {
+        delete entry;
+      }
     }
     delete elem->value;
   }
@@ -23,6 +23,9 @@
 
 #include "baseAST.h"
 
+#include <unordered_map>
+#include <vector>
+
 class CalledFunInfo;
 class VisibilityInfo;
 class GenericsCacheInfo;
@@ -41,6 +44,10 @@ class ResolutionCandidate;
 //
 //   freeCache(cache): frees memory associated with cache
 //
+// The entries for each old_fn are bucketed by an order-independent
+// hash of the map (see hashSymbolMap), so a lookup only compares
+// the maps that hash the same.
+//
 class SymbolMapCacheEntry {
 public:
   SymbolMapCacheEntry(FnSymbol* ifn, SymbolMap* imap);
@@ -49,8 +56,17 @@ public:
   SymbolMap map;
 };
 
-typedef Map<FnSymbol*,     Vec<SymbolMapCacheEntry*>*> SymbolMapCache;
-typedef MapElem<FnSymbol*, Vec<SymbolMapCacheEntry*>*> SymbolMapCacheElem;
+// map hash -> entries with that hash, in the order they were added
+typedef std::unordered_map<size_t, std::vector<SymbolMapCacheEntry*>>
+        SymbolMapCacheBuckets;
+
+typedef Map<FnSymbol*,     SymbolMapCacheBuckets*> SymbolMapCache;
+typedef MapElem<FnSymbol*, SymbolMapCacheBuckets*> SymbolMapCacheElem;
+
+// Hash of the key-value pairs with non-NULL values in map,
+// independent of their order; maps that checkCache considers the
+// same have the same hash.
+size_t    hashSymbolMap(SymbolMap* map);
 
 
 void      addCache(SymbolMapCache& cache,
@@ -97,8 +113,12 @@ public:
   SymbolMap map;
 };
 
-typedef Map<FnSymbol*,     Vec<SymbolMapScopeCacheEntry*>*> SymbolMapScopeCache;
-typedef MapElem<FnSymbol*, Vec<SymbolMapScopeCacheEntry*>*> SymbolMapScopeCacheElem;
+// map hash -> entries with that hash, in the order they were added
+typedef std::unordered_map<size_t, std::vector<SymbolMapScopeCacheEntry*>>
+        SymbolMapScopeCacheBuckets;
+
+typedef Map<FnSymbol*,     SymbolMapScopeCacheBuckets*> SymbolMapScopeCache;
+typedef MapElem<FnSymbol*, SymbolMapScopeCacheBuckets*> SymbolMapScopeCacheElem;
 
 void      addCache(SymbolMapScopeCache& cache,
                    FnSymbol*       oldFn,
@@ -88,6 +88,7 @@ private:
 
   static void             returnByRefCollectCalls(RefMap& calls);
   static bool             isTransformableFunction(FnSymbol* fn);
+  static bool             returnsSmallPODRecord(FnSymbol* fn);
   static void             transformFunction(FnSymbol* fn);
   static ArgSymbol*       addFormal(FnSymbol* fn);
   static void             insertAssignmentToFormal(FnSymbol*  fn,
@@ -204,6 +205,10 @@ bool ReturnByRef::isTransformableFunction(FnSymbol* fn)
     else if (fn->hasFlag(FLAG_EXTERN)       == true)
       retval = false;
 
+    // Small plain-data records come back in registers
+    else if (returnsSmallPODRecord(fn)      == true)
+      retval = false;
+
     else if (typeNeedsCopyInitDeinit(type)  == true)
       retval = true;
 
@@ -223,6 +228,35 @@ bool ReturnByRef::isTransformableFunction(FnSymbol* fn)
   return retval;
 }
 
+//
+// A record that only holds plain data needs no copy initializer or
+// deinit, so the function can return it by value like an int.  That
+// lets the backend return records of up to two words in registers
+// instead of storing through the return argument and reloading.
+//
+// Star tuples are excluded because they are C arrays, which C can't
+// return by value, and exported functions keep their documented ABI.
+//
+bool ReturnByRef::returnsSmallPODRecord(FnSymbol* fn)
+{
+  static const uint64_t maxSize = 16;
+
+  AggregateType* type = toAggregateType(fn->retType);
+  uint64_t       size = 0;
+  uint64_t       align = 0;
+
+  return fNoSmallRecordReturns                  == false &&
+         type                                   != NULL  &&
+         isRecord(type)                         == true  &&
+         type->symbol->hasFlag(FLAG_POD)        == true  &&
+         type->symbol->hasFlag(FLAG_STAR_TUPLE) == false &&
+         type->symbol->hasFlag(FLAG_C_ARRAY)    == false &&
+         fn->hasFlag(FLAG_EXPORT)               == false &&
+         fn->hasFlag(FLAG_ITERATOR_FN)          == false &&
+         estimateTypeLayout(type, size, align)  == true  &&
+         size                                   <= maxSize;
+}
+
 void ReturnByRef::transformFunction(FnSymbol* fn)
 {
   ArgSymbol* formal = NULL;
@@ -2188,6 +2222,10 @@ void callDestructors() {
   // TODO: I think 'dyno' can handle all of this elegantly.
   convertClassTypesToCanonical();
 
+  // Needs canonical class types, and the calls to 'new' wrappers and
+  // chpl__delete() that inlining removes later.
+  stackAllocateClasses();
+
   pm.runPass(CallDestructorsCallCleanup(), gCallExprs);
   pm.runPass(RemoveElidedOnBlocks(), gBlockStmts);
 }
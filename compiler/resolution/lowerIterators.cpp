@@ -1035,10 +1035,16 @@ createArgBundleCopyFn(AggregateType* ct, FnSymbol* loopBodyFnWrapper) {
 // This creates the class type carrying the arguments to a (possibly recursive)
 // iterator function call and fills a temp with the passed-in values.
 //
+// The bundle is only used until the iterator function call returns, so it
+// lives on the caller's stack unless 'onHeap' is set because the iterator
+// hands it to tasks or on-statements.  Serial recursive iterators then
+// don't allocate at each level of the recursion.
+//
 static AggregateType*
 bundleLoopBodyFnArgsForIteratorFnCall(CallExpr* iteratorFnCall,
                                       CallExpr* loopBodyFnCall,
-                                      FnSymbol* loopBodyFnWrapper) {
+                                      FnSymbol* loopBodyFnWrapper,
+                                      bool onHeap) {
   FnSymbol* iteratorFn = iteratorFnCall->resolvedFunction();
   FnSymbol* loopBodyFn = loopBodyFnCall->resolvedFunction();
 
@@ -1059,13 +1065,19 @@ bundleLoopBodyFnArgsForIteratorFnCall(CallExpr* iteratorFnCall,
   ct->refType = rct;
 
   // Create the argument bundle.
-  // args = (ct*)malloc(sizeof(ct));
+  // args = (ct*)malloc(sizeof(ct));  or a stack temp
   VarSymbol* argBundle = newTemp("argBundle", ct);
   iteratorFnCall->insertBefore(new DefExpr(argBundle));
-  insertChplHereAlloc(iteratorFnCall, false /*insertAfter*/, argBundle,
-                      ct, newMemDesc("bundled args"));
+  if (onHeap) {
+    insertChplHereAlloc(iteratorFnCall, false /*insertAfter*/, argBundle,
+                        ct, newMemDesc("bundled args"));
+    iteratorFnCall->insertAfter(callChplHereFree(argBundle));
+  } else {
+    iteratorFnCall->insertBefore(new CallExpr(PRIM_MOVE, argBundle,
+                                   new CallExpr(PRIM_STACK_ALLOCATE_CLASS,
+                                                ct->symbol)));
+  }
   iteratorFnCall->insertAtTail(argBundle);
-  iteratorFnCall->insertAfter(callChplHereFree(argBundle));
 
   // loopBodyWrapper(int index, ct* fn_args) {
   //   loopBodyFn(index);
@@ -1305,6 +1317,22 @@ static void convertYieldsAndReturns(std::vector<CallExpr*>& calls, Symbol* index
 }
 
 
+// Returns true if the given function calls a task function.
+static bool fnContainsTaskFn(FnSymbol* fn)
+{
+  std::vector<CallExpr*> calls;
+
+  collectCallExprs(fn, calls);
+
+  for_vector(CallExpr, call, calls) {
+    if (resolvedToTaskFun(call))
+      return true;
+  }
+
+  return false;
+}
+
+
 // Returns true if the given function contains an on statement; false otherwise.
 // "Contains" includes "had a coforall/etc. block, now replaced with a call".
 static bool fnContainsOn(FnSymbol* fn)
@@ -1329,6 +1357,16 @@ static bool fnContainsOn(FnSymbol* fn)
 }
 
 
+// The arg bundle for a call to 'iteratorFn' (created from 'iterator') has
+// to be on the heap if tasks could outlive the call or read the bundle from
+// another locale.
+static bool argBundleNeedsHeap(FnSymbol* iteratorFn, FnSymbol* iterator)
+{
+  return iteratorFn->hasFlag(FLAG_ITERATOR_WITH_ON) ||
+         fnContainsTaskFn(iterator);
+}
+
+
 static FnSymbol*
 createIteratorFn(FnSymbol* iterator, CallExpr* iteratorFnCall, Symbol* index,
                  CallExpr* loopBodyFnCall, FnSymbol* loopBodyFnWrapper,
@@ -1344,7 +1382,10 @@ createIteratorFn(FnSymbol* iterator, CallExpr* iteratorFnCall, Symbol* index,
   // Now calls the newly-created iterator function.
   iteratorFnCall->baseExpr->replace(new SymExpr(iteratorFn));
   AggregateType* argsBundleType =
-    bundleLoopBodyFnArgsForIteratorFnCall(iteratorFnCall, loopBodyFnCall, loopBodyFnWrapper);
+    bundleLoopBodyFnArgsForIteratorFnCall(iteratorFnCall, loopBodyFnCall,
+                                          loopBodyFnWrapper,
+                                          argBundleNeedsHeap(iteratorFn,
+                                                             iterator));
 
   iteratorFn->body = iterator->body->copy();
   iterator->defPoint->insertBefore(new DefExpr(iteratorFn));
@@ -1450,7 +1491,10 @@ expandRecursiveIteratorInline(ForLoop* forLoop)
     iteratorFnMap.put(iterator, iteratorFn);
   } else {
     iteratorFnCall->baseExpr->replace(new SymExpr(iteratorFn));
-    bundleLoopBodyFnArgsForIteratorFnCall(iteratorFnCall, loopBodyFnCall, loopBodyFnWrapper);
+    bundleLoopBodyFnArgsForIteratorFnCall(iteratorFnCall, loopBodyFnCall,
+                                          loopBodyFnWrapper,
+                                          argBundleNeedsHeap(iteratorFn,
+                                                             iterator));
 
     Symbol* argBundleTmp = newTemp("argBundleTmp", iteratorFn->getFormal(3)->type);
 
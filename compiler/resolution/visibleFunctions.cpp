@@ -74,6 +74,35 @@ static Map<BlockStmt*, VisibleFunctionBlock*> visibleFunctionMap;
 
 static int                                    nVisibleFunctions       = 0;
 
+/*
+   Functions found by following a 'use' or 'import' into a module
+   (i.e. getVisibleFunctionsImpl with inUseChain=true), by module block
+   and name. Such a traversal does not depend on the call or on any
+   point of instantiation, so the blocks it visits and the functions it
+   finds can be replayed for later calls, as long as none of those
+   blocks has been visited yet for the current call. Traversals that
+   run into a private function or module, or that stop at a block that
+   another part of the search already visited, are not cached.
+
+   The entries are dropped when buildVisibleFunctionMap() adds a
+   visible function; instantiations are invisible, so they are kept
+   across those.
+ */
+class UseChainCandidates {
+public:
+  std::vector<BlockStmt*> blocks; // visited, in order
+  PtrSet<BlockStmt*>      blockSet;
+  std::vector<FnSymbol*>  fns;
+  bool                    cacheable = true;
+};
+
+typedef std::pair<BlockStmt*, const char*> UseChainKey;
+
+static std::map<UseChainKey, UseChainCandidates> useChainCache;
+
+// The traversal being recorded for useChainCache, if any.
+static UseChainCandidates*                    recordingUseChain       = NULL;
+
 /************************************* | **************************************
 *                                                                             *
 *                                                                             *
@@ -261,6 +290,7 @@ static void buildVisibleFunctionMap() {
         vfb->visibleFunctions.put(fn->name, fns);
       }
       fns->add(fn);
+      useChainCache.clear();
     }
   }
   nVisibleFunctions = gFnSymbols.n;
@@ -1083,6 +1113,10 @@ static void getVisibleFnsFirstVisit(const char*       name,
   visited.insert(block);
   if (visInfo != NULL)
     visInfo->visitedScopes.push_back(block);
+  if (recordingUseChain != NULL) {
+    recordingUseChain->blocks.push_back(block);
+    recordingUseChain->blockSet.insert(block);
+  }
 
   if (VisibleFunctionBlock* vfb = visibleFunctionMap.get(block)) {
     // the block defines functions
@@ -1096,6 +1130,10 @@ static void getVisibleFnsFirstVisit(const char*       name,
 
       forv_Vec(FnSymbol, fn, *fns) {
         if (fn->hasFlag(FLAG_PRIVATE)) {
+          // whether it is visible depends on the call
+          if (recordingUseChain != NULL)
+            recordingUseChain->cacheable = false;
+
           // Ensure that private functions are not used outside of their
           // proper scope
           if (!privacyChecked) {
@@ -1147,6 +1185,75 @@ static bool needToTraverseUse(bool firstVisit,
   }
 }
 
+// Same as getVisibleFunctionsImpl(name, call, mod->block, ..., true)
+// but uses or fills in useChainCache.
+static void getVisibleFnsInUsedModule(const char*      name,
+                                CallExpr*             call,
+                                ModuleSymbol*         mod,
+                                VisibilityInfo*       visInfo,
+                                PtrSet<BlockStmt*>& visited,
+                                Vec<FnSymbol*>&       visibleFns)
+{
+  BlockStmt* block = mod->block;
+
+  // whether mod is visible depended on the call
+  if (recordingUseChain != NULL && mod->hasFlag(FLAG_PRIVATE))
+    recordingUseChain->cacheable = false;
+
+  // Record only the outermost use chain, and not when printing
+  // the blocks visited for --break-on-resolve-id.
+  if (recordingUseChain != NULL || call->id == breakOnResolveID) {
+    getVisibleFunctionsImpl(name, call, block, visInfo,
+                            visited, visibleFns, true);
+    return;
+  }
+
+  UseChainKey key(block, name);
+  std::map<UseChainKey, UseChainCandidates>::iterator it =
+    useChainCache.find(key);
+
+  if (it != useChainCache.end()) {
+    UseChainCandidates& c = it->second;
+    bool canReplay = true;
+    for (BlockStmt* b : c.blocks) {
+      if (visited.find(b) != visited.end()) {
+        canReplay = false;
+        break;
+      }
+    }
+
+    if (canReplay) {
+      for (BlockStmt* b : c.blocks) {
+        visited.insert(b);
+        if (visInfo != NULL)
+          visInfo->visitedScopes.push_back(b);
+      }
+      for (FnSymbol* fn : c.fns)
+        visibleFns.add(fn);
+    } else {
+      // the search already went through some of these blocks
+      getVisibleFunctionsImpl(name, call, block, visInfo,
+                              visited, visibleFns, true);
+    }
+    return;
+  }
+
+  UseChainCandidates c;
+  int startFns = visibleFns.n;
+
+  recordingUseChain = &c;
+  getVisibleFunctionsImpl(name, call, block, visInfo,
+                          visited, visibleFns, true);
+  recordingUseChain = NULL;
+
+  if (c.cacheable) {
+    for (int i = startFns; i < visibleFns.n; i++)
+      c.fns.push_back(visibleFns.v[i]);
+    c.blockSet.clear(); // only needed while recording
+    useChainCache[key] = std::move(c);
+  }
+}
+
 static void getVisibleFnsFromUseList(const char*      name,
                                 CallExpr*             call,
                                 BlockStmt*            block,
@@ -1171,11 +1278,11 @@ static void getVisibleFnsFromUseList(const char*      name,
 
             if (mod->isVisible(call)) {
               if (use->isARenamedSym(name)) {
-                getVisibleFunctionsImpl(use->getRenamedSym(name),
-                  call, mod->block, visInfo, visited, visibleFns, true);
+                getVisibleFnsInUsedModule(use->getRenamedSym(name),
+                  call, mod, visInfo, visited, visibleFns);
               } else {
-                getVisibleFunctionsImpl(name, call, mod->block, visInfo,
-                                    visited, visibleFns, true);
+                getVisibleFnsInUsedModule(name, call, mod, visInfo,
+                                          visited, visibleFns);
               }
             }
           }
@@ -1194,11 +1301,11 @@ static void getVisibleFnsFromUseList(const char*      name,
           INT_ASSERT(mod);
           if (mod->isVisible(call)) {
             if (import->isARenamedSym(name)) {
-              getVisibleFunctionsImpl(import->getRenamedSym(name),
-                call, mod->block, visInfo, visited, visibleFns, true);
+              getVisibleFnsInUsedModule(import->getRenamedSym(name),
+                call, mod, visInfo, visited, visibleFns);
             } else {
-              getVisibleFunctionsImpl(name, call, mod->block, visInfo,
-                                  visited, visibleFns, true);
+              getVisibleFnsInUsedModule(name, call, mod, visInfo,
+                                        visited, visibleFns);
             }
           }
         }
@@ -1222,6 +1329,13 @@ static void getVisibleFunctionsImpl(const char*       name,
   const bool firstVisit = (visited.find(block) == visited.end());
 
   if (!firstVisit && inUseChain) {
+    // A use chain being recorded for useChainCache that stops here
+    // depends on what else was visited, unless it visited this block
+    // itself.
+    if (recordingUseChain != NULL &&
+        recordingUseChain->blockSet.count(block) == 0)
+      recordingUseChain->cacheable = false;
+
     // We've seen this block already, but we just found it again from going up
     // in scope from the call site.  That means that we may have skipped private
     // uses, so we should go through only the private uses - not in a use chain.
@@ -1424,6 +1538,7 @@ void visibleFunctionsClear() {
   }
 
   visibleFunctionMap.clear();
+  useChainCache.clear();
 }
 
 /************************************* | **************************************
@@ -817,6 +817,14 @@ void codegen_makefile(fileinfo* mainfile, const char** tmpbinname,
   fprintf(makefile.fptr, "COMP_GEN_SPECIALIZE = %i\n", specializeCCode);
   fprintf(makefile.fptr, "COMP_GEN_FLOAT_OPT = %i\n", ffloatOpt);
 
+  // Object files of unchanged modules are copied from here rather than
+  // recompiled (see Makefile.exe).
+  if (fIncrementalCacheDir[0] && !fLibraryCompile) {
+    ensureDirExists(fIncrementalCacheDir,
+                    "ensuring --incremental-cache directory exists");
+    fprintf(makefile.fptr, "COMP_GEN_OBJ_CACHE = %s\n", fIncrementalCacheDir);
+  }
+
   if (fMultiLocaleInterop) {
     const char* loc = "$(CHPL_MAKE_HOME)/runtime/etc/src";
     fprintf(makefile.fptr, "COMP_GEN_MLI_EXTRA_INCLUDES = -I%s\n", loc);
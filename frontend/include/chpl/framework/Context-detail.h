@@ -28,6 +28,7 @@
 #include <cstdint>
 #include <cstring>
 #include <tuple>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -51,18 +52,26 @@ namespace detail {
 struct StringAndLength {
   const char* str;
   size_t len;
+  // chpl::hash(str, len), computed once when the key is made so that
+  // the table never needs to rehash the string data (e.g. when it grows)
+  size_t hash;
+
+  static StringAndLength make(const char* str, size_t len) {
+    return {str, len, chpl::hash(str, len)};
+  }
 };
 
 struct UniqueStrEqual final {
-  bool operator()(StringAndLength lhs, StringAndLength rhs) const {
-    if (lhs.len != rhs.len) return false;
+  bool operator()(const StringAndLength& lhs,
+                  const StringAndLength& rhs) const {
+    if (lhs.hash != rhs.hash || lhs.len != rhs.len) return false;
     return 0 == memcmp(lhs.str, rhs.str, lhs.len);
   }
 };
 
 struct UniqueStrHash final {
-  size_t operator()(StringAndLength key) const {
-    return chpl::hash(key.str, key.len);
+  size_t operator()(const StringAndLength& key) const {
+    return key.hash;
   }
 };
 
@@ -85,6 +94,23 @@ struct QueryTimingStat {
   }
 };
 
+// A frame (a query, or a phase reported with Context::profileBegin)
+// in the call tree recorded by Context::beginProfile. Node 0 is the
+// root and has no name.
+struct ProfileNode {
+  const char* name = nullptr;
+  int parent = -1;
+  // including the time spent in children
+  QueryTimingDuration elapsed = QueryTimingDuration::zero();
+  size_t count = 0;
+  // the largest resident set size in KiB seen when leaving this frame,
+  // or 0 if memory is not sampled for it (it is not for queries)
+  long maxRssKb = 0;
+  // in the order they were first entered
+  std::vector<int> children;
+  std::unordered_map<const char*, int> childByName;
+};
+
 // forward declare some types
 class QueryMapResultBase;
 template<typename ResultType, typename... ArgTs> class QueryMapResult;
@@ -325,7 +351,11 @@ class QueryMapBase {
      : queryName(queryName), isInputQuery(isInputQuery) {
    }
    virtual ~QueryMapBase() = 0; // this is an abstract base class
-   virtual void clearOldResults(RevisionNumber currentRevisionNumber) = 0;
+   // removes results last checked before 'oldestRevisionToKeep'
+   virtual void clearOldResults(RevisionNumber oldestRevisionToKeep) = 0;
+   // appends each stored result to 'out'
+   virtual void
+   gatherResults(std::vector<const QueryMapResultBase*>& out) const = 0;
 };
 
 template<typename ResultType,
@@ -354,13 +384,13 @@ class QueryMap final : public QueryMapBase {
   }
   ~QueryMap() = default;
 
-  void clearOldResults(RevisionNumber currentRevisionNumber) override {
+  void clearOldResults(RevisionNumber oldestRevisionToKeep) override {
     // Performance: Would it be better to move everything to a new map
     // rather than modify it in place as is done here?
     auto iter = map.begin();
     while (iter != map.end()) {
       const TheResultType& result = *iter;
-      if (result.lastChecked == currentRevisionNumber) {
+      if (result.lastChecked >= oldestRevisionToKeep) {
         // Keep the result
         ++iter;
       } else {
@@ -371,6 +401,13 @@ class QueryMap final : public QueryMapBase {
 
     oldResults.clear();
   }
+
+  void
+  gatherResults(std::vector<const QueryMapResultBase*>& out) const override {
+    for (const auto& result : map) {
+      out.push_back(&result);
+    }
+  }
 };
 
 // Stopwatch that conditionally starts based on `enabled` passed to the
@@ -32,6 +32,7 @@
 #include "chpl/util/chplenv.h"
 
 #include <memory>
+#include <mutex>
 #include <tuple>
 #include <unordered_map>
 #include <unordered_set>
@@ -251,6 +252,9 @@ class Context {
   // map that supports uniqueCString / UniqueString
   using UniqueStringsTableType = std::unordered_set<chpl::detail::StringAndLength, chpl::detail::UniqueStrHash, chpl::detail::UniqueStrEqual>;
   UniqueStringsTableType uniqueStringsTable;
+  // Guards uniqueStringsTable so that UniqueStrings can be created from
+  // more than one thread. The rest of the Context is not yet thread-safe.
+  std::mutex uniqueStringsMutex;
 
   // Map from a query function pointer to appropriate QueryMap object.
   // Maps to an 'owned' heap-allocated thing to manage having subclasses
@@ -316,6 +320,16 @@ class Context {
 
   owned<std::ostream> queryTimingTraceOutput = nullptr;
 
+  // Used for beginProfile / profileBegin / profileEnd
+  struct ProfileFrame {
+    int node;
+    querydetail::QueryTimingClock::time_point start;
+    bool sampleMemory;
+  };
+  bool enableProfile = false;
+  std::vector<querydetail::ProfileNode> profileNodes;
+  std::vector<ProfileFrame> profileStack;
+
   std::string tmpDir_;
   bool tmpDirExists_ = false;
   bool tmpDirAnchorCreated_ = false;
@@ -324,6 +338,11 @@ class Context {
   querydetail::RevisionNumber lastPrepareToGCRevisionNumber = 0;
   querydetail::RevisionNumber gcCounter = 1;
 
+  // How many of the most recent revisions' query results survive
+  // collectGarbage, and how many results may be kept (0 for no limit).
+  int gcKeepRevisions = 1;
+  size_t gcMaxResults = 0;
+
   // --------- end all Context fields ---------
 
   void setupGlobalStrings();
@@ -437,7 +456,10 @@ class Context {
 
   void doNotCollectUniqueCString(const char *s);
 
-  // Future Work: make the context thread-safe
+  // Future Work: make the rest of the context thread-safe
+  //  * a query stack per thread
+  //  * locking or sharding in QueryMap
+  //  * recording dependencies between queries run on different threads
 
   // Future Work: allow moving some AST to a different context
   //              (or, at least, that can handle the unique strings)
@@ -754,6 +776,20 @@ class Context {
    */
   void collectGarbage();
 
+  /**
+    Configure which query results collectGarbage keeps. Results last used
+    in one of the most recent 'keepRevisions' revisions are kept, so the
+    default of 1 keeps only the results used in the current revision.
+    If 'maxResults' is nonzero, the least recently used results are also
+    dropped until no more than 'maxResults' remain, although results used
+    in the current revision are always kept.
+
+    Keeping more revisions lets long-running tools (such as a language
+    server) reuse results for code that was not looked at in every
+    revision, while 'maxResults' bounds how much memory that takes.
+   */
+  void setGarbageCollectionRetention(int keepRevisions, size_t maxResults=0);
+
   /**
     Note an error for the currently running query and report it
     with the error handler set by setErrorHandler.
@@ -847,6 +883,51 @@ class Context {
   /** End query timing trace, closes out stream */
   void endQueryTimingTrace();
 
+  /**
+    Start recording a hierarchical profile of the queries that run,
+    nested within any frames reported with profileBegin/profileEnd
+    (e.g. compiler passes). This also enables query timing, so that
+    the profile can include how often each query was reused.
+    Discards any profile recorded earlier.
+   */
+  void beginProfile();
+
+  /** Stop recording the profile. What was recorded can still be written. */
+  void endProfile();
+
+  bool isProfiling() const { return enableProfile; }
+
+  /**
+    When profiling, start a frame called 'name', which must remain valid
+    while the profile is in use. The resident set size high-water mark
+    is recorded when the frame ends. Frames must be nested properly with
+    respect to profileEnd.
+   */
+  void profileBegin(const char* name) {
+    if (enableProfile) profileFrameBegin(name, /* sampleMemory */ true);
+  }
+
+  /** When profiling, end the frame started by the last profileBegin */
+  void profileEnd() {
+    if (enableProfile) profileFrameEnd();
+  }
+
+  /**
+    Write the profile in the "folded stacks" format used by flame graph
+    tools: one line per call path, with the frames separated by ';',
+    followed by the time spent in the last frame itself in microseconds.
+   */
+  void writeProfileFoldedStacks(std::ostream& os) const;
+
+  /**
+    Write the profile as a Chrome trace (JSON) that can be loaded into
+    chrome://tracing, Perfetto or speedscope. Each path in the call tree
+    is one event, laid out as a flame chart, with the number of times the
+    frame was entered and any memory high-water mark as arguments. The
+    reuse counts for each query are in a separate "queryStats" list.
+   */
+  void writeProfileChromeTrace(std::ostream& os) const;
+
   typedef enum {
     NOT_CHECKED_NOT_CHANGED = 0,
     REUSED = 1,
@@ -952,6 +1033,10 @@ class Context {
    */
   void queryTimingReport(std::ostream& os);
 
+  // helpers for profileBegin / profileEnd and the query stopwatch
+  void profileFrameBegin(const char* name, bool sampleMemory);
+  void profileFrameEnd();
+
   // Used in the in QUERY_BEGIN_TIMING macro. Creates a stopwatch that starts
   // timing if we are enabled. And then on scope exit we conditionally stop the
   // timing and add it to the total or log it.
@@ -959,13 +1044,21 @@ class Context {
   auto makeQueryTimingStopwatch(querydetail::QueryMapBase* base) {
     size_t depth = queryStack.size();
     bool enabled = enableQueryTiming || enableQueryTimingTrace;
+    bool profiling = enableProfile;
+
+    if (profiling) {
+      profileFrameBegin(base->queryName, /* sampleMemory */ false);
+    }
 
     return querydetail::makeQueryTimingStopwatch(
         enabled,
         // This lambda gets called when the stopwatch object (which lives on the
         // stack of the query function) is destructed
-        [this, base, depth, enabled](auto& stopwatch) {
+        [this, base, depth, enabled, profiling](auto& stopwatch) {
           querydetail::QueryTimingDuration elapsed;
+          if (profiling) {
+            profileFrameEnd();
+          }
           if (enabled) {
             elapsed = stopwatch.elapsed();
           }
@@ -43,8 +43,10 @@ X(class_         , "class")
 X(deinit         , "deinit")
 X(dmapped        , "dmapped")
 X(domain         , "domain")
+X(dynamicSchedule, "dynamicSchedule")
 X(false_         , "false")
 X(generate       , "generate")
+X(hotField       , "hotField")
 X(imag_          , "imag")
 X(index          , "index")
 X(init           , "init")
@@ -72,8 +74,10 @@ X(RootClass      , "RootClass")
 X(scan           , "scan")
 X(shared         , "shared")
 X(single         , "single")
+X(soa            , "soa")
 X(sparse         , "sparse")
 X(stable         , "stable")
+X(streamingReads , "streamingReads")
 X(string         , "string")
 X(subdomain      , "subdomain")
 X(super_         , "super")
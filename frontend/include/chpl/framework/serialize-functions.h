@@ -46,6 +46,7 @@ namespace chpl {
 
 // forward declarations
 class Context;
+class UniqueString;
 template<typename T> struct serialize;
 template<typename T> struct deserialize;
 
@@ -241,6 +242,19 @@ class Deserializer {
   /** Get a string from the long strings table by index */
   std::pair<size_t, const char*> getString(int id);
 
+  /** Get a string from the long strings table by index as a UniqueString */
+  UniqueString getUniqueString(int id);
+
+  /** Skip over 'n' bytes */
+  void skipData(size_t n) {
+    if (cur_ + n <= end_) {
+      cur_ += n;
+    } else {
+      cur_ = end_;
+      ok_ = false;
+    }
+  }
+
   /** Return the current offset into the deserialization region */
   uint64_t position() {
     return cur_ - start_;
@@ -59,8 +59,8 @@ class LibraryFileDeserializationHelper {
   //      a symbol table symbol
   // value: symbol table index of that symbol
   // This will is computed from reading the symbol table.
-  // A copy is stored here as a performance optimization.
-  std::unordered_map<uint32_t, int> offsetToSymIdx;
+  // Points to the map in the ModuleSection, which outlives this helper.
+  const std::unordered_map<uint32_t, int>* offsetToSymIdx = nullptr;
 
   // To support deserializing UniqueStrings
   // This will be computed from reading the long strings section header.
@@ -70,6 +70,10 @@ class LibraryFileDeserializationHelper {
   size_t stringSectionLen = 0;
   const uint32_t* stringOffsetsTable = nullptr;
 
+  // the UniqueString for each long string that has been read so far,
+  // so that strings used many times are only looked up once
+  std::vector<UniqueString> uniqueStrings;
+
   // for AstNodes in the symbol table that were deserialized
   // maps to the symbol table index of that symbol.
   // This will be computed during the deserialization process.
@@ -85,6 +89,12 @@ class LibraryFileDeserializationHelper {
    */
   std::pair<size_t, const char*> getString(int id) const;
 
+  /**
+    Like getString, but returns the string as a UniqueString. The result
+    is remembered so that later uses of the same index are cheap.
+   */
+  UniqueString getUniqueString(Context* context, int id);
+
   /**
     When deserializing an AstNode, track some of the uast nodes to
     be able to map them back to symbol table id. */
@@ -75,6 +75,17 @@ void setFileText(Context* context, UniqueString path, std::string text);
  */
 bool hasFileText(Context* context, const std::string& path);
 
+/**
+ This function reads the files at 'paths' using up to 'nThreads' threads
+ and stores their contents for the fileText query, so that parsing them
+ later does not need to wait for the file system. Paths that already
+ have file text, or that can't be read, are skipped; an unreadable file
+ reports its error when fileText is next called for it.
+ */
+void prefetchFileTexts(Context* context,
+                       const std::vector<std::string>& paths,
+                       int nThreads);
+
 /**
   This query reads a file (with the fileText query) and then parses it.
 
@@ -134,6 +134,17 @@ class CanPassResult {
                                       const types::QualifiedType& actualType,
                                       const types::QualifiedType& formalType);
 
+  static CanPassResult canPassImpl(Context* context,
+                                   const types::QualifiedType& actualType,
+                                   const types::QualifiedType& formalType);
+
+  // memoizes canPassImpl, since the same actual/formal pairs come up
+  // over and over for the many candidates of overloaded operators
+  static const CanPassResult&
+  canPassQuery(Context* context,
+               types::QualifiedType actualType,
+               types::QualifiedType formalType);
+
  public:
   CanPassResult() { }
   ~CanPassResult() = default;
@@ -163,6 +174,28 @@ class CanPassResult {
     return conversionKind_ == PARAM_NARROWING;
   }
 
+  bool operator==(const CanPassResult& other) const {
+    return failReason_ == other.failReason_ &&
+           instantiates_ == other.instantiates_ &&
+           promotes_ == other.promotes_ &&
+           conversionKind_ == other.conversionKind_;
+  }
+  bool operator!=(const CanPassResult& other) const {
+    return !(*this == other);
+  }
+  void swap(CanPassResult& other) {
+    std::swap(failReason_, other.failReason_);
+    std::swap(instantiates_, other.instantiates_);
+    std::swap(promotes_, other.promotes_);
+    std::swap(conversionKind_, other.conversionKind_);
+  }
+  static bool update(CanPassResult& keep, CanPassResult& addin) {
+    return defaultUpdate(keep, addin);
+  }
+  void mark(Context* context) const {
+    // nothing to mark
+  }
+
   // implementation of canPass to allow use of private fields
   static CanPassResult canPass(Context* context,
                                const types::QualifiedType& actualType,
@@ -32,6 +32,8 @@
 #include "chpl/util/bitmap.h"
 #include "chpl/util/memory.h"
 
+#include "llvm/ADT/SmallVector.h"
+
 #include <unordered_map>
 #include <utility>
 
@@ -367,11 +369,12 @@ class CallInfo {
   bool hasQuestionArg_ = false;         // includes ? arg for type constructor
   bool isParenless_ = false;            // is a parenless call
 
-  // Performance TODO: use SmallVector here?
-  std::vector<CallInfoActual> actuals_; // types/params/names of actuals
+  // Most calls have only a few actuals, so keep them inline.
+  using CallInfoActualVec = llvm::SmallVector<CallInfoActual, 4>;
+  CallInfoActualVec actuals_;           // types/params/names of actuals
 
  public:
-  using CallInfoActualIterable = Iterable<std::vector<CallInfoActual>>;
+  using CallInfoActualIterable = Iterable<CallInfoActualVec>;
 
   /** Construct a CallInfo that contains QualifiedTypes for actuals */
   CallInfo(UniqueString name, types::QualifiedType calledType,
@@ -383,7 +386,8 @@ class CallInfo {
         isMethodCall_(isMethodCall),
         hasQuestionArg_(hasQuestionArg),
         isParenless_(isParenless),
-        actuals_(std::move(actuals)) {
+        actuals_(std::make_move_iterator(actuals.begin()),
+                 std::make_move_iterator(actuals.end())) {
     #ifndef NDEBUG
     if (isMethodCall) {
       CHPL_ASSERT(numActuals() >= 1);
@@ -504,9 +508,12 @@ class CallInfo {
     }
   }
   size_t hash() const {
-    return chpl::hash(name_, calledType_, isMethodCall_, isOpCall_,
-                      hasQuestionArg_, isParenless_,
-                      actuals_);
+    size_t ret = chpl::hash(name_, calledType_, isMethodCall_, isOpCall_,
+                            hasQuestionArg_, isParenless_);
+    for (const auto& actual : actuals_) {
+      ret = hash_combine(ret, actual.hash());
+    }
+    return ret;
   }
 
   void stringify(std::ostream& ss, chpl::StringifyKind stringKind) const;
@@ -1583,14 +1590,37 @@ class ResolvedExpression {
 class ResolutionResultByPostorderID {
  private:
   ID symbolId;
-  // This map is generally accessed with operator[] to default-construct a new
+  // The results for the postorder IDs the setup functions say we'll
+  // resolve -- a whole symbol, or one module-level statement -- are kept
+  // densely, indexed by postorder ID minus firstPostorder.  This is
+  // sized once by setup and never grows, so references to the
+  // ResolvedExpressions stay valid while more are added.  'present'
+  // records which have been accessed with the non-const byId(), as
+  // though they had been added to a map.
+  int firstPostorder = 0;
+  std::vector<ResolvedExpression> dense;
+  std::vector<bool> present;
+  // Anything outside that range (e.g. fabricated IDs) goes here.  This
+  // map is generally accessed with operator[] to default-construct a new
   // ResolvedExpression if none exists for an ID. at() is used instead only
   // when const-ness is required.
-  std::unordered_map<int, ResolvedExpression> map;
+  std::unordered_map<int, ResolvedExpression> overflow;
+
+  // make room for postorder IDs [first, first+count), dropping anything
+  // already here
+  void setupRange(int first, int count);
+
+  int denseIndex(int postorder) const {
+    int i = postorder - firstPostorder;
+    return (0 <= i && i < (int) dense.size()) ? i : -1;
+  }
 
  public:
   /** prepare to resolve the contents of the passed symbol */
   void setupForSymbol(const uast::AstNode* ast);
+  /** prepare to resolve the passed statement of the passed module */
+  void setupForModuleStmt(const uast::Module* mod,
+                          const uast::AstNode* modStmt);
   /** prepare to resolve the signature of the passed function */
   void setupForSignature(const uast::Function* func);
   /** prepare to resolve the body of the passed function */
@@ -1601,25 +1631,34 @@ class ResolutionResultByPostorderID {
   /* ID query functions */
   bool hasId(const ID& id) const {
     auto postorder = id.postOrderId();
-    if (id.symbolPath() == symbolId.symbolPath() &&
-        0 <= postorder && (map.count(postorder) > 0))
-      return true;
+    if (id.symbolPath() != symbolId.symbolPath() || postorder < 0)
+      return false;
 
-    return false;
+    int i = denseIndex(postorder);
+    if (i >= 0)
+      return present[i];
+    return overflow.count(postorder) > 0;
   }
   ResolvedExpression& byId(const ID& id) {
     auto postorder = id.postOrderId();
-    return map[postorder];
+    int i = denseIndex(postorder);
+    if (i >= 0) {
+      present[i] = true;
+      return dense[i];
+    }
+    return overflow[postorder];
   }
   const ResolvedExpression& byId(const ID& id) const {
     CHPL_ASSERT(hasId(id));
     auto postorder = id.postOrderId();
-    return map.at(postorder);
+    int i = denseIndex(postorder);
+    if (i >= 0)
+      return dense[i];
+    return overflow.at(postorder);
   }
   const ResolvedExpression* byIdOrNull(const ID& id) const {
     if (hasId(id)) {
-      auto postorder = id.postOrderId();
-      return &map.at(postorder);
+      return &byId(id);
     }
     return nullptr;
   }
@@ -1638,26 +1677,20 @@ class ResolutionResultByPostorderID {
     return byIdOrNull(ast->id());
   }
 
-  bool operator==(const ResolutionResultByPostorderID& other) const {
-    return symbolId == other.symbolId &&
-           map == other.map;
-  }
+  bool operator==(const ResolutionResultByPostorderID& other) const;
   bool operator!=(const ResolutionResultByPostorderID& other) const {
     return !(*this == other);
   }
   void swap(ResolutionResultByPostorderID& other) {
     symbolId.swap(other.symbolId);
-    map.swap(other.map);
+    std::swap(firstPostorder, other.firstPostorder);
+    dense.swap(other.dense);
+    present.swap(other.present);
+    overflow.swap(other.overflow);
   }
   static bool update(ResolutionResultByPostorderID& keep,
                      ResolutionResultByPostorderID& addin);
-  void mark(Context* context) const {
-    symbolId.mark(context);
-    for (auto const &elt : map) {
-      // mark ResolvedExpressions
-      elt.second.mark(context);
-    }
-  }
+  void mark(Context* context) const;
 };
 
 /**
@@ -526,6 +526,19 @@ class BorrowedIdsWithName {
     return !(*this == other);
   }
 
+  void swap(BorrowedIdsWithName& other) {
+    std::swap(filterFlags_, other.filterFlags_);
+    std::swap(excludeFlagSet_, other.excludeFlagSet_);
+    std::swap(numVisibleIds_, other.numVisibleIds_);
+    std::swap(idv_, other.idv_);
+    std::swap(moreIdvs_, other.moreIdvs_);
+  }
+
+  static bool update(BorrowedIdsWithName& keep,
+                     BorrowedIdsWithName& addin) {
+    return defaultUpdate(keep, addin);
+  }
+
   size_t hash() const {
     size_t ret = 0;
     ret = hash_combine(ret, chpl::hash(filterFlags_));
@@ -544,8 +557,10 @@ class BorrowedIdsWithName {
 
   void mark(Context* context) const {
     idv_.mark(context);
-    for (auto const& elt : *moreIdvs_) {
-      context->markPointer(&elt.id_);
+    if (moreIdvs_ != nullptr) {
+      for (auto const& elt : *moreIdvs_) {
+        context->markPointer(&elt.id_);
+      }
     }
     excludeFlagSet_.mark(context);
   }
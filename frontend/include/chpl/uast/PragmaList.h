@@ -284,6 +284,7 @@ PRAGMA(GLOBAL_TYPE_SYMBOL, ypr, "global type symbol", "is accessible through a g
 PRAGMA(GLOBAL_VAR_BUILTIN, ypr, "global var builtin", "is accessible through a global symbol variable")
 PRAGMA(GPU_CODEGEN, ypr, "codegen for GPU", "generate GPU code and set function calling convention to kernel launch")
 PRAGMA(GPU_AND_CPU_CODEGEN, ypr, "codegen for CPU and GPU", "generate both GPU and CPU code")
+PRAGMA(GPU_HOST_KERNEL, npr, "gpu host kernel", "kernel that runs on the host with CHPL_GPU=cpu")
 PRAGMA(ASSERT_ON_GPU, ypr, "assert on gpu", "triggers runtime assertion if not running on device")
 PRAGMA(GPU_SPECIALIZATION, npr, "gpu specialization", ncm)
 PRAGMA(REDUCTION_TEMP, npr, "reduction temp variable", ncm)
@@ -296,6 +297,7 @@ PRAGMA(IGNORE_IN_GLOBAL_ANALYSIS, ypr, "ignore in global analysis", "ignore this
 PRAGMA(RVV, npr, "RVV", "variable is the return value variable")
 PRAGMA(YVV, npr, "YVV", "variable is a yield value variable")
 PRAGMA(HEAP, npr, "heap", ncm)
+PRAGMA(HOT_FIELD, npr, "hot field", "field declared with @hotField, placed first when record fields are reordered")
 PRAGMA(IF_EXPR_RESULT, npr, "if-expr result", ncm)
 PRAGMA(IMPLICIT_ALIAS_FIELD, npr, "implicit alias field", ncm)
 PRAGMA(IMPLICIT_MODULE, npr, "implicit top-level module", ncm)
@@ -384,6 +386,7 @@ PRAGMA(MAYBE_COPY_ELIDED, npr, "maybe copy elided", "symbol might be dead early
 PRAGMA(MAYBE_PARAM, npr, "maybe param", "symbol can resolve to a param")
 PRAGMA(MAYBE_REF, npr, "maybe ref", "symbol can resolve to a ref")
 PRAGMA(SPLIT_INITED, npr, "split inited", "variable was initialized with split init")
+PRAGMA(SOA_ARRAY, npr, "soa array", "array of records declared with @soa, stored as one array per field")
 PRAGMA(USED_IN_TYPE, npr, "used in type", "call-expr temporary used in creating a type")
 PRAGMA(MAYBE_TYPE, npr, "maybe type", "symbol can resolve to a type")
 PRAGMA(MEMORY_ORDER_TYPE, ypr, "memory order type", "type implementing chpl memory order (normally called memoryOrder)")
@@ -193,6 +193,9 @@ PRIMITIVE_G(CHPL_COMM_PUT, "chpl_comm_put")
 PRIMITIVE_G(CHPL_COMM_ARRAY_GET, "chpl_comm_array_get")
 PRIMITIVE_G(CHPL_COMM_ARRAY_PUT, "chpl_comm_array_put")
 PRIMITIVE_G(CHPL_COMM_REMOTE_PREFETCH, "chpl_comm_remote_prefetch")
+PRIMITIVE_G(PREFETCH, "prefetch")
+PRIMITIVE_G(CACHE_STREAM_BEGIN, "cache stream begin")
+PRIMITIVE_G(CACHE_STREAM_END, "cache stream end")
 PRIMITIVE_G(CHPL_COMM_GET_STRD, "chpl_comm_get_strd")
 PRIMITIVE_G(CHPL_COMM_PUT_STRD, "chpl_comm_put_strd")
 
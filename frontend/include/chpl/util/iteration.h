@@ -36,7 +36,7 @@ template <typename C> class Iterable {
   typename C::const_iterator end_;
 
  public:
-  Iterable(const C &c) : begin_(c.cbegin()), end_(c.cend()) {}
+  Iterable(const C &c) : begin_(c.begin()), end_(c.end()) {}
 
   typename C::const_iterator begin() const { return begin_; }
   typename C::const_iterator end() const { return end_; }
@@ -32,9 +32,13 @@
 #include "llvm/Config/llvm-config.h"
 #include "llvm/Support/FileSystem.h"
 
+#include <sys/resource.h>
+
+#include <algorithm>
 #include <chrono>
 #include <fstream>
 #include <iomanip>
+#include <map>
 #include <utility>
 
 #include <cstdarg>
@@ -106,6 +110,9 @@ void Context::swap(Context& other) {
   std::swap(queryTraceIgnoreQueries, other.queryTraceIgnoreQueries);
   std::swap(queryDepthColor, other.queryDepthColor);
   std::swap(queryTimingTraceOutput, other.queryTimingTraceOutput);
+  std::swap(enableProfile, other.enableProfile);
+  std::swap(profileNodes, other.profileNodes);
+  std::swap(profileStack, other.profileStack);
   std::swap(lastPrepareToGCRevisionNumber, other.lastPrepareToGCRevisionNumber);
   std::swap(gcCounter, other.gcCounter);
 }
@@ -352,7 +359,10 @@ char* Context::setupStringMetadata(char* buf, size_t len) {
 
 // allocates new storage for the string if it was not found
 const char* Context::getOrCreateUniqueString(const char* str, size_t len) {
-  chpl::detail::StringAndLength key = {str, len};
+  auto key = chpl::detail::StringAndLength::make(str, len);
+
+  std::lock_guard<std::mutex> lock(uniqueStringsMutex);
+
   auto search = this->uniqueStringsTable.find(key);
   if (search != this->uniqueStringsTable.end()) {
     const char* ret = search->str;
@@ -369,8 +379,8 @@ const char* Context::getOrCreateUniqueString(const char* str, size_t len) {
   memcpy(s, str, len);
   // null terminate
   s[len] = 0x0;
-  // Add it to the table
-  chpl::detail::StringAndLength ret = {s, len};
+  // Add it to the table, reusing the hash computed for the key
+  chpl::detail::StringAndLength ret = {s, len, key.hash};
   this->uniqueStringsTable.insert(search, ret);
   return s;
 }
@@ -444,8 +454,11 @@ const char* Context::uniqueCStringConcatLen(const char* s1, size_t len1,
   // null terminate
   s[len] = '\0';
 
+  auto key = chpl::detail::StringAndLength::make(s, len);
+
+  std::lock_guard<std::mutex> lock(uniqueStringsMutex);
+
   // Check for it in the table
-  chpl::detail::StringAndLength key = {s, len};
   auto search = this->uniqueStringsTable.find(key);
   if (search != this->uniqueStringsTable.end()) {
     const char* ret = search->str;
@@ -456,8 +469,7 @@ const char* Context::uniqueCStringConcatLen(const char* s1, size_t len1,
   }
 
   // Add it to the table
-  chpl::detail::StringAndLength ret = {s, len};
-  this->uniqueStringsTable.insert(search, ret);
+  this->uniqueStringsTable.insert(search, key);
   return s;
 }
 
@@ -741,6 +753,12 @@ void Context::setBreakOnHash(size_t hashVal) {
   breakOnHash = hashVal;
 }
 
+void Context::setGarbageCollectionRetention(int keepRevisions,
+                                            size_t maxResults) {
+  gcKeepRevisions = keepRevisions < 1 ? 1 : keepRevisions;
+  gcMaxResults = maxResults;
+}
+
 void Context::collectGarbage() {
   // if there are no parent queries, collect some garbage
   CHPL_ASSERT(queryStack.size() == 0);
@@ -749,15 +767,86 @@ void Context::collectGarbage() {
     printf("%i COLLECTING GARBAGE\n", queryTraceDepth);
   }
 
+  bool collectStrings =
+    (this->lastPrepareToGCRevisionNumber == this->currentRevisionNumber);
+
+  // Decide which results to keep. Since a result is only ever checked
+  // after the results it depends upon, every dependency of a result has
+  // been checked in the same revision or a later one. So keeping all
+  // results checked at or after some revision never leaves a kept result
+  // pointing to a dependency that was removed.
+  RevisionNumber oldestToKeep = this->currentRevisionNumber;
+  std::vector<const QueryMapResultBase*> results;
+  if (gcKeepRevisions > 1) {
+    oldestToKeep = this->currentRevisionNumber - (gcKeepRevisions - 1);
+
+    for (auto& dbEntry: queryDB) {
+      dbEntry.second->gatherResults(results);
+    }
+
+    if (gcMaxResults > 0) {
+      // drop the least recently used revisions until under the limit
+      std::map<RevisionNumber, size_t> countPerRevision;
+      size_t nKept = 0;
+      for (auto r : results) {
+        if (r->lastChecked >= oldestToKeep) {
+          countPerRevision[r->lastChecked]++;
+          nKept++;
+        }
+      }
+      for (const auto& pair : countPerRevision) {
+        if (nKept <= gcMaxResults ||
+            pair.first >= this->currentRevisionNumber) {
+          break;
+        }
+        nKept -= pair.second;
+        oldestToKeep = pair.first + 1;
+      }
+    }
+
+    if (collectStrings) {
+      // Results used in this revision have already marked their
+      // UniqueStrings; the older ones that are being kept need to be
+      // marked too, dependencies first as when the queries ran.
+      std::unordered_set<const QueryMapResultBase*> visited;
+      std::vector<std::pair<const QueryMapResultBase*, size_t>> stack;
+      for (auto root : results) {
+        if (root->lastChecked < oldestToKeep ||
+            root->lastChecked == this->currentRevisionNumber ||
+            !visited.insert(root).second) {
+          continue;
+        }
+        stack.emplace_back(root, 0);
+        while (!stack.empty()) {
+          auto& top = stack.back();
+          const QueryMapResultBase* r = top.first;
+          if (top.second < r->dependencies.size()) {
+            const QueryMapResultBase* dep = r->dependencies[top.second].query;
+            top.second++;
+            if (dep != nullptr &&
+                dep->lastChecked != this->currentRevisionNumber &&
+                visited.insert(dep).second) {
+              stack.emplace_back(dep, 0);
+            }
+          } else {
+            r->markUniqueStringsInResult(this);
+            stack.pop_back();
+          }
+        }
+      }
+    }
+  }
+
   // clear out the saved old results
   // warning: this loop proceeds in a nondeterministic order
   for (auto& dbEntry: queryDB) {
     QueryMapBase* queryMapBase = dbEntry.second.get();
-    queryMapBase->clearOldResults(this->currentRevisionNumber);
+    queryMapBase->clearOldResults(oldestToKeep);
   }
 
-  if (this->lastPrepareToGCRevisionNumber == this->currentRevisionNumber) {
+  if (collectStrings) {
     // remove UniqueStrings that have not been marked
+    std::lock_guard<std::mutex> lock(uniqueStringsMutex);
 
     size_t nUniqueStringsBefore = uniqueStringsTable.size();
 
@@ -1178,6 +1267,182 @@ void Context::endQueryTimingTrace() {
   enableQueryTimingTrace = false;
 }
 
+static long maxResidentSetKb() {
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+  // reported in bytes rather than KiB
+  return usage.ru_maxrss / 1024;
+#else
+  return usage.ru_maxrss;
+#endif
+}
+
+void Context::beginProfile() {
+  profileNodes.clear();
+  profileStack.clear();
+  profileNodes.emplace_back(); // the root
+  enableProfile = true;
+  enableQueryTiming = true;
+}
+
+void Context::endProfile() {
+  // close any frames that are still open
+  while (!profileStack.empty()) {
+    profileFrameEnd();
+  }
+  enableProfile = false;
+}
+
+void Context::profileFrameBegin(const char* name, bool sampleMemory) {
+  int parent = profileStack.empty() ? 0 : profileStack.back().node;
+  int node;
+
+  auto search = profileNodes[parent].childByName.find(name);
+  if (search != profileNodes[parent].childByName.end()) {
+    node = search->second;
+  } else {
+    node = (int) profileNodes.size();
+    profileNodes.emplace_back();
+    profileNodes[node].name = name;
+    profileNodes[node].parent = parent;
+    profileNodes[parent].children.push_back(node);
+    profileNodes[parent].childByName.emplace(name, node);
+  }
+
+  profileStack.push_back({node, QueryTimingClock::now(), sampleMemory});
+}
+
+void Context::profileFrameEnd() {
+  // the profile may have been restarted while this frame was open
+  if (profileStack.empty()) return;
+
+  ProfileFrame frame = profileStack.back();
+  profileStack.pop_back();
+
+  ProfileNode& n = profileNodes[frame.node];
+  n.elapsed += QueryTimingClock::now() - frame.start;
+  n.count++;
+  if (frame.sampleMemory) {
+    n.maxRssKb = std::max(n.maxRssKb, maxResidentSetKb());
+  }
+}
+
+static long long profileMicros(QueryTimingDuration d) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+}
+
+static void writeJsonString(std::ostream& os, const char* s) {
+  os << '"';
+  for (const char* p = s; *p; p++) {
+    if (*p == '"' || *p == '\\') os << '\\';
+    if ((unsigned char) *p < 0x20) continue;
+    os << *p;
+  }
+  os << '"';
+}
+
+void Context::writeProfileFoldedStacks(std::ostream& os) const {
+  if (profileNodes.empty()) return;
+
+  // (node, path to it) pairs still to write
+  std::vector<std::pair<int, std::string>> work;
+  const auto& root = profileNodes[0];
+  for (auto it = root.children.rbegin(); it != root.children.rend(); ++it) {
+    work.emplace_back(*it, profileNodes[*it].name);
+  }
+
+  while (!work.empty()) {
+    auto cur = std::move(work.back());
+    work.pop_back();
+
+    const ProfileNode& n = profileNodes[cur.first];
+    QueryTimingDuration self = n.elapsed;
+    for (int child : n.children) {
+      self -= profileNodes[child].elapsed;
+    }
+    long long us = profileMicros(self);
+    if (us > 0) {
+      os << cur.second << ' ' << us << '\n';
+    }
+
+    for (auto it = n.children.rbegin(); it != n.children.rend(); ++it) {
+      work.emplace_back(*it, cur.second + ";" + profileNodes[*it].name);
+    }
+  }
+}
+
+void Context::writeProfileChromeTrace(std::ostream& os) const {
+  os << "{\"traceEvents\":[";
+  bool first = true;
+
+  if (!profileNodes.empty()) {
+    // Lay out the tree as a flame chart: each frame starts where its
+    // previous sibling ended, or where its parent started.
+    // (node, start time in microseconds) pairs still to write
+    std::vector<std::pair<int, long long>> work;
+    long long start = 0;
+    for (int child : profileNodes[0].children) {
+      work.emplace_back(child, start);
+      start += profileMicros(profileNodes[child].elapsed);
+    }
+    std::reverse(work.begin(), work.end());
+
+    while (!work.empty()) {
+      auto cur = work.back();
+      work.pop_back();
+
+      const ProfileNode& n = profileNodes[cur.first];
+      long long dur = profileMicros(n.elapsed);
+
+      if (!first) os << ',';
+      first = false;
+      os << "\n{\"name\":";
+      writeJsonString(os, n.name);
+      os << ",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+         << ",\"ts\":" << cur.second << ",\"dur\":" << dur
+         << ",\"args\":{\"count\":" << n.count;
+      if (n.maxRssKb > 0) {
+        os << ",\"maxRssKb\":" << n.maxRssKb;
+      }
+      os << "}}";
+
+      if (n.maxRssKb > 0) {
+        os << ",\n{\"name\":\"maxRssKb\",\"ph\":\"C\",\"pid\":1"
+           << ",\"ts\":" << cur.second + dur
+           << ",\"args\":{\"maxRssKb\":" << n.maxRssKb << "}}";
+      }
+
+      size_t firstChild = work.size();
+      long long childStart = cur.second;
+      for (int child : n.children) {
+        work.emplace_back(child, childStart);
+        childStart += profileMicros(profileNodes[child].elapsed);
+      }
+      std::reverse(work.begin() + firstChild, work.end());
+    }
+  }
+
+  os << "\n],\n\"queryStats\":[";
+  first = true;
+  for (const auto& it : queryDB) {
+    const QueryMapBase* base = it.second.get();
+    const auto& timings = base->timings;
+    size_t misses = timings.query.count;
+    size_t lookups = timings.systemGetResult.count;
+    size_t hits = lookups > misses ? lookups - misses : 0;
+    if (lookups == 0 && misses == 0) continue;
+
+    if (!first) os << ',';
+    first = false;
+    os << "\n{\"name\":";
+    writeJsonString(os, base->queryName);
+    os << ",\"hits\":" << hits << ",\"misses\":" << misses
+       << ",\"us\":" << profileMicros(timings.query.elapsed) << "}";
+  }
+  os << "\n]}\n";
+}
+
 namespace querydetail {
 
 
@@ -240,8 +240,7 @@ UniqueString UniqueString::deserialize(Deserializer& des) {
     memcpy(&num, &bytes[0], sizeof(num));
     // convert from big-endian order to host byte order
     uint32_t uid = ntohl(num);
-    const auto& pair = des.getString(uid);
-    return get(des.context(), pair.second, pair.first);
+    return des.getUniqueString(uid);
   }
 }
 
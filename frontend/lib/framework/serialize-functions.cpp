@@ -97,5 +97,14 @@ std::pair<size_t, const char*> Deserializer::getString(int id) {
   return std::make_pair((size_t) 0, (const char*) nullptr);
 }
 
+UniqueString Deserializer::getUniqueString(int id) {
+  if (libraryFileHelper_ != nullptr) {
+    return libraryFileHelper_->getUniqueString(context_, id);
+  }
+
+  auto pair = getString(id);
+  return UniqueString::get(context_, pair.second, pair.first);
+}
+
 
 } // end namespace chpl
@@ -23,6 +23,7 @@
 #include "chpl/framework/query-impl.h"
 #include "chpl/uast/AstNode.h"
 #include "chpl/uast/Builder.h"
+#include "chpl/util/version-info.h"
 
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/FileSystem.h"
@@ -38,17 +39,39 @@ LibraryFileDeserializationHelper::getString(int id) const {
   if (0 < id && id < nStrings) {
     uint64_t offset = stringOffsetsTable[id];
     uint64_t nextOffset = stringOffsetsTable[id+1];
-    return std::make_pair(nextOffset-offset,
-                          (const char*) (stringSectionData + offset));
+    if (offset <= nextOffset && nextOffset <= stringSectionLen &&
+        nextOffset - offset < Deserializer::MAX_STRING_SIZE) {
+      return std::make_pair(nextOffset-offset,
+                            (const char*) (stringSectionData + offset));
+    }
+  }
+
+  return std::make_pair(0, nullptr);
+}
+
+UniqueString
+LibraryFileDeserializationHelper::getUniqueString(Context* context, int id) {
+  if (0 < id && id < nStrings) {
+    if (uniqueStrings.empty()) {
+      uniqueStrings.resize(nStrings);
+    }
+    UniqueString& ret = uniqueStrings[id];
+    if (ret.isEmpty()) {
+      auto pair = getString(id);
+      ret = UniqueString::get(context, pair.second, pair.first);
+    }
+    return ret;
   } else {
-    return std::make_pair(0, nullptr);
+    return UniqueString();
   }
 }
 
 void LibraryFileDeserializationHelper::registerAst(const uast::AstNode* ast,
                                                    uint64_t startOffset) {
-  auto search = offsetToSymIdx.find(startOffset);
-  if (search != offsetToSymIdx.end()) {
+  if (offsetToSymIdx == nullptr) return;
+
+  auto search = offsetToSymIdx->find(startOffset);
+  if (search != offsetToSymIdx->end()) {
     astToSymIdx[ast] = search->second;
   }
 }
@@ -178,6 +201,7 @@ bool LibraryFile::readHeaders(Context* context) {
       fileData == nullptr || fileData == (unsigned char*) -1) {
     // note: mmap can return -1 as a pointer upon failure
     context->error(Location(), "Could not read file %s", libPath.c_str());
+    return false;
   }
 
   // inspect the file header
@@ -188,6 +212,24 @@ bool LibraryFile::readHeaders(Context* context) {
     return false;
   }
 
+  // the format changes incompatibly when the major version changes, and
+  // the uAST and generated code are only meaningful to the same release
+  if (header->fileFormatVersionMajor != FORMAT_VERSION_MAJOR ||
+      header->chplVersionMajor != (uint32_t) getMajorVersion() ||
+      header->chplVersionMinor != (uint32_t) getMinorVersion() ||
+      header->chplVersionUpdate != (uint32_t) getUpdateVersion()) {
+    context->error(Location(),
+                   "Library file %s was generated by chpl version %u.%u.%u "
+                   "(format %u.%u) and cannot be used by this version",
+                   libPath.c_str(),
+                   (unsigned) header->chplVersionMajor,
+                   (unsigned) header->chplVersionMinor,
+                   (unsigned) header->chplVersionUpdate,
+                   (unsigned) header->fileFormatVersionMajor,
+                   (unsigned) header->fileFormatVersionMinor);
+    return false;
+  }
+
   // save the file hash
   memcpy(&fileHash[0], &header->hash[0], HASH_SIZE);
 
@@ -368,8 +410,8 @@ bool LibraryFile::readModuleSection(Context* context,
                    fileData + r.start + symTable.end,
                    helper);
   uint32_t n = symTableHeader->nEntries;
-  std::string lastSymId;
-  std::string lastCname;
+  mod.symbols.reserve(n);
+  mod.offsetToSymIdx.reserve(n);
   for (uint32_t i = 0; i < n; i++) {
     uint64_t pos = des.position();
 
@@ -379,14 +421,11 @@ bool LibraryFile::readModuleSection(Context* context,
     // read the tag
     des.readByte();
 
+    // The symbol ID and the cnames are prefix-compressed strings that
+    // are not needed to locate the symbol's uAST, so skip over them here
+    // rather than reconstructing them.
     {
-      // read the variable-byte encoded common prefix length
       unsigned int nCommonPrefix = des.readVUint();
-      // shorten lastSymId to the first nCommonPrefix bytes
-      if (lastSymId.size() > nCommonPrefix) {
-        lastSymId.erase(nCommonPrefix, lastSymId.size()-nCommonPrefix);
-      }
-      // read the variable-byte encoded suffix length
       unsigned int nSuffix = des.readVUint();
 
       if (!des.checkStringLength(nCommonPrefix+nSuffix) ||
@@ -395,25 +434,15 @@ bool LibraryFile::readModuleSection(Context* context,
         return false;
       }
 
-      // expand lastSymId to have room to store the suffix
-      lastSymId.resize(nCommonPrefix+nSuffix);
-      // read the string data
-      des.readData(&lastSymId[nCommonPrefix], nSuffix);
+      des.skipData(nSuffix);
     }
 
     // consider the code-generated versions
     unsigned nGenerated = des.readVUint();
-    // read the data from each code-generated version
     for (unsigned int j = 0; j < nGenerated; j++) {
       des.readByte(); // isInstantiation
 
-      // read the variable-byte encoded common prefix length
       unsigned int nCommonPrefix = des.readVUint();
-      // shorten lastCname to the first nCommonPrefix bytes
-      if (lastCname.size() > nCommonPrefix) {
-        lastCname.erase(nCommonPrefix, lastCname.size()-nCommonPrefix);
-      }
-      // read the variable-byte encoded suffix length
       unsigned int nSuffix = des.readVUint();
 
       if (!des.checkStringLength(nCommonPrefix+nSuffix) ||
@@ -422,10 +451,7 @@ bool LibraryFile::readModuleSection(Context* context,
         return false;
       }
 
-      // expand lastCname to have room to store the suffix
-      lastCname.resize(nCommonPrefix+nSuffix);
-      // read the string data
-      des.readData(&lastCname[nCommonPrefix], nSuffix);
+      des.skipData(nSuffix);
     }
 
     // record the information
@@ -484,8 +510,8 @@ LibraryFile::setupHelper(Context* context, const ModuleSection* mod) const {
 
   LibraryFileDeserializationHelper ret;
 
-  // copy over offsetToSymIdx
-  ret.offsetToSymIdx = mod->offsetToSymIdx;
+  // refer to offsetToSymIdx rather than copying it
+  ret.offsetToSymIdx = &mod->offsetToSymIdx;
 
   // copy over the string info to help UniqueString deserialization
   ret.nStrings = mod->nStrings;
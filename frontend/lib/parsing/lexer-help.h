@@ -655,10 +655,40 @@ static SizedStr eatExternCode(yyscan_t scanner) {
 *                                                                           *
 ************************************* | ************************************/
 
+/*
+ * Consume the characters following the current token for as long as they
+ * are (if 'inSet') or are not (if '!inSet') in 'chars'. This scans the
+ * flex buffer directly with 'strspn' / 'strcspn' instead of calling
+ * 'yyinput' once per character. It stops at a NUL, which may mark the end
+ * of the buffer, so that 'getNextYYChar' can deal with that. The consumed
+ * characters are appended to 'out' if it is not null.
+ */
+static size_t consumeYYChars(yyscan_t scanner, const char* chars, bool inSet,
+                             std::string* out) {
+  struct yyguts_t* yyg = (struct yyguts_t*) scanner;
+  char first = yyg->yy_hold_char;
+  if (first == '\0' || (strchr(chars, first) != nullptr) != inSet) return 0;
+
+  char* p = yyg->yy_c_buf_p;
+  *p = first;
+  size_t n = inSet ? strspn(p, chars) : strcspn(p, chars);
+  if (out) out->append(p, n);
+
+  // Leave things as 'yyinput' would: 'yytext' stays terminated where it
+  // was, and the character after the consumed ones is held.
+  *p = '\0';
+  yyg->yy_c_buf_p = p + n;
+  yyg->yy_hold_char = p[n];
+  return n;
+}
+
 static void processWhitespace(yyscan_t scanner) {
   const char* pch = yyget_text(scanner);
   YYLTYPE* loc = yyget_lloc(scanner);
-  updateLocation(loc, 0, strlen(pch));
+
+  // The rule matches one character, so take the rest of the run here.
+  size_t n = strlen(pch) + consumeYYChars(scanner, " \t\r\f", true, nullptr);
+  updateLocation(loc, 0, n);
 }
 
 /************************************ | *************************************
@@ -679,7 +709,10 @@ static int processSingleLineComment(yyscan_t scanner) {
     context->parseStats->countCommentLine();
 
   // Read until the end of the line
-  while ((c = getNextYYChar(scanner)) != '\n' && c != 0) {
+  while (true) {
+    consumeYYChars(scanner, "\n", false, &s);
+    c = getNextYYChar(scanner);
+    if (c == '\n' || c == 0) break;
     s += c;
   }
 
@@ -736,6 +769,13 @@ static int processBlockComment(yyscan_t scanner) {
   if (context->parseStats)
     context->parseStats->countCommentLine();
   while (depth > 0) {
+    // Other characters cannot open or close a comment or end a line, so
+    // take a run of them at once. Only 'lastc' needs to reflect the run.
+    if (size_t n = consumeYYChars(scanner, "*/\n", false, &s)) {
+      nCols += n;
+      c = (unsigned char) s.back();
+    }
+
     int lastlastc = lastc;
 
     lastc = c;
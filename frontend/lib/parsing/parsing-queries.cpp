@@ -40,10 +40,12 @@
 
 #include "../util/filesystem_help.h"
 
+#include <atomic>
 #include <cstdio>
 #include <regex>
 #include <set>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <unordered_map>
 #include <utility>
@@ -95,6 +97,52 @@ bool hasFileText(Context* context, const std::string& path) {
   return context->hasCurrentResultForQuery(fileTextQuery, tupleOfArgs);
 }
 
+void prefetchFileTexts(Context* context,
+                       const std::vector<std::string>& paths,
+                       int nThreads) {
+  std::vector<std::string> toRead;
+  for (const auto& path : paths) {
+    if (!hasFileText(context, path)) {
+      toRead.push_back(path);
+    }
+  }
+
+  if (toRead.empty()) return;
+
+  size_t n = toRead.size();
+  std::vector<std::string> texts(n);
+  std::vector<char> ok(n, 0);
+
+  // The worker threads only touch the file system and their own elements
+  // of 'texts' and 'ok'; the Context is only used on this thread.
+  std::atomic<size_t> next(0);
+  auto worker = [&]() {
+    size_t i;
+    while ((i = next.fetch_add(1)) < n) {
+      std::string error;
+      ok[i] = readFile(toRead[i].c_str(), texts[i], error);
+    }
+  };
+
+  size_t nWorkers = nThreads < 1 ? 1 : nThreads;
+  if (nWorkers > n) nWorkers = n;
+
+  std::vector<std::thread> threads;
+  for (size_t t = 1; t < nWorkers; t++) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  for (size_t i = 0; i < n; i++) {
+    if (ok[i]) {
+      setFileText(context, toRead[i], std::move(texts[i]));
+    }
+  }
+}
+
 static Parser helpMakeParser(Context* context,
                              UniqueString parentSymbolPath) {
   if (parentSymbolPath.isEmpty()) {
@@ -116,7 +116,7 @@ Resolver::createForModuleStmt(Context* context, const Module* mod,
                               ResolutionResultByPostorderID& byId) {
   auto ret = Resolver(context, mod, byId, nullptr);
   ret.curStmt = modStmt;
-  ret.byPostorder.setupForSymbol(mod);
+  ret.byPostorder.setupForModuleStmt(mod, modStmt);
   return ret;
 }
 
@@ -127,7 +127,7 @@ Resolver::createForScopeResolvingModuleStmt(
                               ResolutionResultByPostorderID& byId) {
   auto ret = Resolver(context, mod, byId, nullptr);
   ret.curStmt = modStmt;
-  ret.byPostorder.setupForSymbol(mod);
+  ret.byPostorder.setupForModuleStmt(mod, modStmt);
   ret.scopeResolveOnly = true;
   return ret;
 }
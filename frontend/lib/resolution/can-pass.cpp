@@ -19,6 +19,7 @@
 
 #include "chpl/resolution/can-pass.h"
 
+#include "chpl/framework/query-impl.h"
 #include "chpl/resolution/resolution-queries.h"
 #include "chpl/types/all-types.h"
 
@@ -824,9 +825,9 @@ CanPassResult CanPassResult::canInstantiate(Context* context,
   return fail(FAIL_CANNOT_INSTANTIATE);
 }
 
-CanPassResult CanPassResult::canPass(Context* context,
-                                     const QualifiedType& actualQT,
-                                     const QualifiedType& formalQT) {
+CanPassResult CanPassResult::canPassImpl(Context* context,
+                                         const QualifiedType& actualQT,
+                                         const QualifiedType& formalQT) {
 
   const Type* actualT = actualQT.type();
   const Type* formalT = formalQT.type();
@@ -991,6 +992,23 @@ CanPassResult CanPassResult::canPass(Context* context,
   return fail(FAIL_FORMAL_OTHER);
 }
 
+const CanPassResult&
+CanPassResult::canPassQuery(Context* context,
+                            QualifiedType actualQT,
+                            QualifiedType formalQT) {
+  QUERY_BEGIN(canPassQuery, context, actualQT, formalQT);
+
+  CanPassResult result = canPassImpl(context, actualQT, formalQT);
+
+  return QUERY_END(result);
+}
+
+CanPassResult CanPassResult::canPass(Context* context,
+                                     const QualifiedType& actualQT,
+                                     const QualifiedType& formalQT) {
+  return canPassQuery(context, actualQT, formalQT);
+}
+
 // When trying to combine two kinds, you can't just pick one.
 // For instance, if any type in the list is a value, the result
 // should be a value, and if any type in the list is const, the
@@ -927,6 +927,9 @@ CallResolutionResult resolvePrimCall(Context* context,
     case PRIM_CHPL_COMM_ARRAY_GET:
     case PRIM_CHPL_COMM_ARRAY_PUT:
     case PRIM_CHPL_COMM_REMOTE_PREFETCH:
+    case PRIM_PREFETCH:
+    case PRIM_CACHE_STREAM_BEGIN:
+    case PRIM_CACHE_STREAM_END:
     case PRIM_CHPL_COMM_GET_STRD:
     case PRIM_CHPL_COMM_PUT_STRD:
     case PRIM_ARRAY_GET:
@@ -2322,6 +2322,14 @@ doIsCandidateApplicableInitial(Context* context,
 
   auto ufs = UntypedFnSignature::get(context, candidateId);
   auto faMap = FormalActualMap(ufs, ci);
+
+  // Rule out candidates with the wrong number or names of formals
+  // before computing their formal types, which is the expensive part
+  // when there are many overloads of an operator.
+  if (!isUntypedSignatureApplicable(context, ufs, faMap, ci)) {
+    return ApplicabilityResult::failure(candidateId, /* TODO */ FAIL_CANDIDATE_OTHER);
+  }
+
   auto ret = typedSignatureInitial(context, ufs);
 
   return isInitialTypedSignatureApplicable(context, ret, faMap, ci);
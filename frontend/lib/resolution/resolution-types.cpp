@@ -410,32 +410,87 @@ CallInfo CallInfo::createWithReceiver(const CallInfo& ci,
 }
 
 CallInfo CallInfo::copyAndRename(const CallInfo &ci, UniqueString rename) {
-  return CallInfo(rename, ci.calledType(), ci.isMethodCall(),
-                  ci.hasQuestionArg_, ci.isParenless_, ci.actuals_);
+  CallInfo ret = ci;
+  ret.name_ = rename;
+  ret.isOpCall_ = false;
+  return ret;
+}
+
+void ResolutionResultByPostorderID::setupRange(int first, int count) {
+  firstPostorder = first;
+  dense.clear();
+  dense.resize(count);
+  present.assign(count, false);
+  overflow.clear();
 }
 
+// The IDs within a symbol run from -1 (the symbol itself) up to
+// numContainedChildren()-1.
 void ResolutionResultByPostorderID::setupForSymbol(const AstNode* ast) {
   CHPL_ASSERT(Builder::astTagIndicatesNewIdScope(ast->tag()));
 
   symbolId = ast->id();
+  setupRange(-1, symbolId.numContainedChildren() + 1);
+}
+// Only keep room for the statement, and the IDs it contains, since
+// there is one of these per module-level statement.
+void ResolutionResultByPostorderID::setupForModuleStmt(const Module* mod,
+                                                       const AstNode* modStmt) {
+  symbolId = mod->id();
+  const ID& stmtId = modStmt->id();
+  setupRange(stmtId.postOrderId() - stmtId.numContainedChildren(),
+             stmtId.numContainedChildren() + 1);
 }
 void ResolutionResultByPostorderID::setupForSignature(const Function* func) {
   symbolId = func->id();
+  setupRange(-1, symbolId.numContainedChildren() + 1);
 }
 void ResolutionResultByPostorderID::setupForParamLoop(
     const For* loop, ResolutionResultByPostorderID& parent) {
   this->symbolId = parent.symbolId;
+  const ID& loopId = loop->id();
+  setupRange(loopId.postOrderId() - loopId.numContainedChildren(),
+             loopId.numContainedChildren() + 1);
 }
 void ResolutionResultByPostorderID::setupForFunction(const Function* func) {
   setupForSymbol(func);
 }
 
+bool ResolutionResultByPostorderID::operator==(
+    const ResolutionResultByPostorderID& other) const {
+  if (symbolId != other.symbolId ||
+      firstPostorder != other.firstPostorder ||
+      present != other.present ||
+      overflow != other.overflow) {
+    return false;
+  }
+  for (size_t i = 0; i < dense.size(); i++) {
+    if (present[i] && dense[i] != other.dense[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
 bool ResolutionResultByPostorderID::update(ResolutionResultByPostorderID& keep,
                                            ResolutionResultByPostorderID& addin)
 {
   return defaultUpdate(keep, addin);
 }
 
+void ResolutionResultByPostorderID::mark(Context* context) const {
+  symbolId.mark(context);
+  for (size_t i = 0; i < dense.size(); i++) {
+    if (present[i]) {
+      dense[i].mark(context);
+    }
+  }
+  for (auto const &elt : overflow) {
+    // mark ResolvedExpressions
+    elt.second.mark(context);
+  }
+}
+
 bool FormalActualMap::computeAlignment(const UntypedFnSignature* untyped,
                                        const TypedFnSignature* typed,
                                        const CallInfo& call) {
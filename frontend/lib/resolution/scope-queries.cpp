@@ -1543,22 +1543,50 @@ static bool lookupInScopeViz(Context* context,
   return got;
 }
 
+// Memoizes a lookup that starts with no scopes checked, so that
+// resolving many mentions of the same name in the same scope (e.g.
+// through deep chains of 'use' statements) walks the scopes only once
+// per revision. When 'checkShadowing' is set, the lookup also gathers
+// shadowed symbols and the bool in the result records whether any were
+// found (the warning itself depends on the mention, so it is issued by
+// the caller).
+static const std::pair<std::vector<BorrowedIdsWithName>, bool>&
+lookupNameInScopeQuery(Context* context,
+                       const Scope* scope,
+                       std::vector<const Scope*> receiverScopes,
+                       UniqueString name,
+                       LookupConfig config,
+                       bool checkShadowing) {
+  QUERY_BEGIN(lookupNameInScopeQuery, context,
+              scope, receiverScopes, name, config, checkShadowing);
+
+  CheckedScopes visited;
+  std::vector<BorrowedIdsWithName> vec;
+  std::vector<BorrowedIdsWithName> shadowed;
+
+  helpLookupInScope(context, scope, receiverScopes,
+                    /* resolving scope */ nullptr,
+                    name, config, visited, vec,
+                    /* traceCurPath */ nullptr,
+                    /* traceResult */ nullptr,
+                    checkShadowing ? &shadowed : nullptr,
+                    /* traceShadowed */ nullptr);
+
+  auto result = std::make_pair(std::move(vec), !shadowed.empty());
+  return QUERY_END(result);
+}
+
 std::vector<BorrowedIdsWithName>
 lookupNameInScope(Context* context,
                   const Scope* scope,
                   llvm::ArrayRef<const Scope*> receiverScopes,
                   UniqueString name,
                   LookupConfig config) {
-  CheckedScopes visited;
-  std::vector<BorrowedIdsWithName> vec;
+  if (!scope) return {};
 
-  if (scope) {
-    helpLookupInScope(context, scope, receiverScopes,
-                      /* resolving scope */ nullptr,
-                      name, config, visited, vec);
-  }
-
-  return vec;
+  return lookupNameInScopeQuery(context, scope, receiverScopes.vec(),
+                                name, config,
+                                /* checkShadowing */ false).first;
 }
 
 std::vector<BorrowedIdsWithName>
@@ -1568,17 +1596,25 @@ lookupNameInScopeWithWarnings(Context* context,
                               UniqueString name,
                               LookupConfig config,
                               ID idForWarnings) {
-  CheckedScopes visited;
-  std::vector<BorrowedIdsWithName> vec;
-
-  if (scope) {
+  if (!scope) return {};
+
+  const auto& got = lookupNameInScopeQuery(context, scope,
+                                           receiverScopes.vec(),
+                                           name, config,
+                                           /* checkShadowing */ true);
+  if (got.second) {
+    // Something was shadowed; redo the lookup with tracing in order
+    // to issue the warning for this mention.
+    CheckedScopes visited;
+    std::vector<BorrowedIdsWithName> vec;
     helpLookupInScopeWithShadowingWarning(context, scope, receiverScopes,
                                           /* resolving scope */ nullptr,
                                           name, config, visited, vec,
                                           idForWarnings);
+    return vec;
   }
 
-  return vec;
+  return got.first;
 }
 
 std::vector<BorrowedIdsWithName>
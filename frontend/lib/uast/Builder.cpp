@@ -278,6 +278,14 @@ void Builder::assignIDs() {
   int i = 0;
   int commentIndex = 0;
 
+  // Every AST node gets an idToAst_ entry, and when locations were
+  // noted, an idToLocation_ entry, so size those maps up front rather
+  // than letting them grow (and rehash) one doubling at a time.
+  if (useNotedLocations_) {
+    br.idToAst_.reserve(notedLocations_.size());
+    br.idToLocation_.reserve(notedLocations_.size());
+  }
+
   if (!startingSymbolPath_.isEmpty()) {
     // start from the starting symbol path if it exists
     pathVec = ID::expandSymbolPath(context_, startingSymbolPath_);
@@ -113,6 +113,10 @@ bool BuilderResult::update(BuilderResult& keep, BuilderResult& addin) {
   llvm::DenseMap<ID, const AstNode*> newIdToAst;
   llvm::DenseMap<ID, ID> newIdToParent;
 
+  // the ASTs are the same size as those in 'addin', so use its map size
+  newIdToAst.reserve(addin.idToAst_.size());
+  newIdToParent.reserve(addin.idToAst_.size());
+
   // recompute locationsVec by traversing the AST and using the maps
   for (const auto& ast : keep.topLevelExpressions_) {
     computeIdMaps(ast.get(), nullptr, newIdToAst, newIdToParent);
@@ -1335,6 +1335,10 @@ void Visitor::checkAttributeNameRecognizedOrToolSpaced(const Attribute* node) {
       node->name() == USTR("unstable") ||
       node->name() == USTR("stable") ||
       node->name() == USTR("assertOnGpu") ||
+      node->name() == USTR("dynamicSchedule") ||
+      node->name() == USTR("soa") ||
+      node->name() == USTR("hotField") ||
+      node->name() == USTR("streamingReads") ||
       node->name().startsWith(USTR("chpldoc.")) ||
       node->name().startsWith(USTR("llvm."))) {
       // TODO: should we match chpldoc.nodoc or anything toolspaced with chpldoc.?
@@ -1370,13 +1374,65 @@ void Visitor::checkAttributeAppliedToCorrectNode(const Attribute* attr) {
     if (node->isForall() || node->isForeach()) return;
 
     CHPL_REPORT(context_, InvalidGpuAssertion, node, attr);
+  } else if (attr->name() == USTR("dynamicSchedule")) {
+    auto forall = node->toForall();
+    if (!forall || forall->isExpressionLevel()) {
+      error(attr, "the @dynamicSchedule attribute can only be applied to "
+                  "forall statements");
+    } else if (forall->iterand()->isZip()) {
+      error(attr, "the @dynamicSchedule attribute is not supported on "
+                  "zippered forall loops");
+    } else if (attr->numActuals() > 1 ||
+               (attr->numActuals() == 1 && attr->isNamedActual(0) &&
+                attr->actualName(0) != "chunkSize")) {
+      error(attr, "the @dynamicSchedule attribute only accepts a chunk size");
+    }
+  } else if (attr->name() == USTR("soa")) {
+    auto var = node->toVariable();
+    if (!var || var->isField() ||
+        (var->kind() != Variable::VAR && var->kind() != Variable::CONST) ||
+        !var->typeExpression() || !var->typeExpression()->isBracketLoop()) {
+      error(attr, "the @soa attribute can only be applied to array variable "
+                  "declarations with an explicit array type");
+    } else if (var->initExpression() || var->isConfig() ||
+               var->linkage() != Decl::DEFAULT_LINKAGE) {
+      error(attr, "the @soa attribute cannot be applied to config, extern, "
+                  "export or initialized variables");
+    } else if (attr->numActuals() != 0) {
+      error(attr, "the @soa attribute does not accept arguments");
+    }
+  } else if (attr->name() == USTR("hotField")) {
+    auto var = node->toVariable();
+    if (!var || !var->isField() ||
+        (var->kind() != Variable::VAR && var->kind() != Variable::CONST)) {
+      error(attr, "the @hotField attribute can only be applied to var or "
+                  "const fields");
+    } else if (attr->numActuals() != 0) {
+      error(attr, "the @hotField attribute does not accept arguments");
+    }
+  } else if (attr->name() == USTR("streamingReads")) {
+    auto loop = node->toLoop();
+    auto forLoop = node->toFor();
+    auto indexableLoop = node->toIndexableLoop();
+    if (!loop || node->isCoforall() || (forLoop && forLoop->isParam()) ||
+        (indexableLoop && indexableLoop->isExpressionLevel())) {
+      error(attr, "the @streamingReads attribute can only be applied to "
+                  "for, forall, foreach, while and do-while statements");
+    } else if (attr->numActuals() != 0) {
+      error(attr, "the @streamingReads attribute does not accept arguments");
+    }
   }
 }
 
 void Visitor::checkAttributeUnstable(const Attribute* node) {
   if (shouldEmitUnstableWarning(node)) {
     if(node->name() == UniqueString::get(context_, "llvm.metadata") ||
-       node->name() == UniqueString::get(context_, "llvm.assertVectorized")) {
+       node->name() == UniqueString::get(context_, "llvm.assertVectorized") ||
+       node->name() == UniqueString::get(context_, "llvm.vectorizeWidth") ||
+       node->name() == UniqueString::get(context_, "llvm.unrollCount") ||
+       node->name() == USTR("soa") ||
+       node->name() == USTR("hotField") ||
+       node->name() == USTR("streamingReads")) {
       warn(node, "'%s' is an unstable attribute", node->name());
     }
   }
@@ -0,0 +1,108 @@
+/*
+ * Copyright 2023 Hewlett Packard Enterprise Development LP
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "test-common.h"
+
+#include "chpl/framework/Context.h"
+#include "chpl/framework/query-impl.h"
+
+#include <chrono>
+#include <sstream>
+#include <thread>
+
+using namespace chpl;
+
+static const int& innerQuery(Context* context, int arg) {
+  QUERY_BEGIN(innerQuery, context, arg);
+
+  // make sure some time is recorded for this query
+  std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  int result = arg + 1;
+
+  return QUERY_END(result);
+}
+
+static const int& outerQuery(Context* context, int arg) {
+  QUERY_BEGIN(outerQuery, context, arg);
+
+  // the second call reuses the result of the first
+  int result = innerQuery(context, arg) + innerQuery(context, arg);
+
+  return QUERY_END(result);
+}
+
+static bool contains(const std::string& s, const std::string& sub) {
+  return s.find(sub) != std::string::npos;
+}
+
+static void test1() {
+  printf("test1\n");
+  Context ctx;
+  Context* context = &ctx;
+
+  context->beginProfile();
+  context->profileBegin("phaseA");
+  int got = outerQuery(context, 1);
+  assert(got == 4);
+  context->profileEnd();
+  context->profileBegin("phaseB");
+  got = outerQuery(context, 1); // reused, so nothing nested in phaseB
+  assert(got == 4);
+  context->profileEnd();
+  context->endProfile();
+
+  std::ostringstream folded;
+  context->writeProfileFoldedStacks(folded);
+  printf("%s", folded.str().c_str());
+  assert(contains(folded.str(), "phaseA;outerQuery;innerQuery "));
+  assert(!contains(folded.str(), "phaseB;"));
+
+  std::ostringstream trace;
+  context->writeProfileChromeTrace(trace);
+  printf("%s", trace.str().c_str());
+  assert(contains(trace.str(), "\"traceEvents\":["));
+  assert(contains(trace.str(), "\"name\":\"phaseB\""));
+  assert(contains(trace.str(), "\"maxRssKb\":"));
+  assert(contains(trace.str(),
+                  "{\"name\":\"innerQuery\",\"hits\":1,\"misses\":1"));
+  assert(contains(trace.str(),
+                  "{\"name\":\"outerQuery\",\"hits\":1,\"misses\":1"));
+}
+
+// frames are ignored when not profiling
+static void test2() {
+  printf("test2\n");
+  Context ctx;
+  Context* context = &ctx;
+
+  context->profileBegin("phaseA");
+  outerQuery(context, 2);
+  context->profileEnd();
+
+  std::ostringstream folded;
+  context->writeProfileFoldedStacks(folded);
+  assert(folded.str().empty());
+}
+
+int main() {
+  test1();
+  test2();
+
+  return 0;
+}
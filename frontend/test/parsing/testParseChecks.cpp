@@ -586,6 +586,154 @@ static void test18(void) {
   assert(guard.realizeErrors());
 }
 
+// Limit where the @dynamicSchedule attribute can appear.
+static void test19(void) {
+  Context context;
+  Context* ctx = &context;
+  ErrorGuard guard(ctx);
+  std::string text =
+    R""""(
+      @dynamicSchedule
+      forall i in 1..10 { }
+      @dynamicSchedule(chunkSize=4)
+      forall i in 1..10 { }
+      @dynamicSchedule
+      for i in 1..10 { }
+      @dynamicSchedule
+      forall (i, j) in zip(1..10, 1..10) { }
+      @dynamicSchedule(size=4)
+      forall i in 1..10 { }
+    )"""";
+
+  auto path = UniqueString::get(ctx, "test19.chpl");
+  setFileText(ctx, path, text);
+
+  parseFileToBuilderResultAndCheck(ctx, path, UniqueString());
+
+  assert(guard.numErrors() == 3);
+  displayErrors(ctx, guard);
+  assertErrorMatches(ctx, guard, 0, "test19.chpl", 6,
+                     "the @dynamicSchedule attribute can only be applied "
+                     "to forall statements");
+  assertErrorMatches(ctx, guard, 1, "test19.chpl", 8,
+                     "the @dynamicSchedule attribute is not supported on "
+                     "zippered forall loops");
+  assertErrorMatches(ctx, guard, 2, "test19.chpl", 10,
+                     "the @dynamicSchedule attribute only accepts a chunk "
+                     "size");
+  assert(guard.realizeErrors());
+}
+
+// Limit where the @soa attribute can appear.
+static void test20(void) {
+  Context context;
+  Context* ctx = &context;
+  ErrorGuard guard(ctx);
+  std::string text =
+    R""""(
+      record R { var x, y: real; }
+      @soa var A: [1..10] R;
+      @soa var B = 1;
+      @soa var C: [1..10] R = new R();
+      @soa proc f() { }
+      @soa(8) var D: [1..10] R;
+    )"""";
+
+  auto path = UniqueString::get(ctx, "test20.chpl");
+  setFileText(ctx, path, text);
+
+  parseFileToBuilderResultAndCheck(ctx, path, UniqueString());
+
+  assert(guard.numErrors() == 4);
+  displayErrors(ctx, guard);
+  assertErrorMatches(ctx, guard, 0, "test20.chpl", 4,
+                     "the @soa attribute can only be applied to array "
+                     "variable declarations with an explicit array type");
+  assertErrorMatches(ctx, guard, 1, "test20.chpl", 5,
+                     "the @soa attribute cannot be applied to config, "
+                     "extern, export or initialized variables");
+  assertErrorMatches(ctx, guard, 2, "test20.chpl", 6,
+                     "the @soa attribute can only be applied to array "
+                     "variable declarations with an explicit array type");
+  assertErrorMatches(ctx, guard, 3, "test20.chpl", 7,
+                     "the @soa attribute does not accept arguments");
+  assert(guard.realizeErrors());
+}
+
+// Limit where the @hotField attribute can appear.
+static void test21(void) {
+  Context context;
+  Context* ctx = &context;
+  ErrorGuard guard(ctx);
+  std::string text =
+    R""""(
+      record R {
+        @hotField var x: int;
+        @hotField type t = int;
+        @hotField(1) var y: real;
+        @hotField proc f() { }
+      }
+      @hotField var z: int;
+    )"""";
+
+  auto path = UniqueString::get(ctx, "test21.chpl");
+  setFileText(ctx, path, text);
+
+  parseFileToBuilderResultAndCheck(ctx, path, UniqueString());
+
+  assert(guard.numErrors() == 4);
+  displayErrors(ctx, guard);
+  assertErrorMatches(ctx, guard, 0, "test21.chpl", 4,
+                     "the @hotField attribute can only be applied to var "
+                     "or const fields");
+  assertErrorMatches(ctx, guard, 1, "test21.chpl", 5,
+                     "the @hotField attribute does not accept arguments");
+  assertErrorMatches(ctx, guard, 2, "test21.chpl", 6,
+                     "the @hotField attribute can only be applied to var "
+                     "or const fields");
+  assertErrorMatches(ctx, guard, 3, "test21.chpl", 8,
+                     "the @hotField attribute can only be applied to var "
+                     "or const fields");
+  assert(guard.realizeErrors());
+}
+
+static void test22(void) {
+  Context context;
+  Context* ctx = &context;
+  ErrorGuard guard(ctx);
+  std::string text =
+    R""""(
+      @streamingReads for i in 1..10 { }
+      @streamingReads forall i in 1..10 { }
+      @streamingReads while false { }
+      @streamingReads(1) foreach i in 1..10 { }
+      @streamingReads coforall i in 1..10 { }
+      @streamingReads for param i in 1..10 { }
+      @streamingReads var x: int;
+    )"""";
+
+  auto path = UniqueString::get(ctx, "test22.chpl");
+  setFileText(ctx, path, text);
+
+  parseFileToBuilderResultAndCheck(ctx, path, UniqueString());
+
+  assert(guard.numErrors() == 4);
+  displayErrors(ctx, guard);
+  assertErrorMatches(ctx, guard, 0, "test22.chpl", 5,
+                     "the @streamingReads attribute does not accept "
+                     "arguments");
+  assertErrorMatches(ctx, guard, 1, "test22.chpl", 6,
+                     "the @streamingReads attribute can only be applied to "
+                     "for, forall, foreach, while and do-while statements");
+  assertErrorMatches(ctx, guard, 2, "test22.chpl", 7,
+                     "the @streamingReads attribute can only be applied to "
+                     "for, forall, foreach, while and do-while statements");
+  assertErrorMatches(ctx, guard, 3, "test22.chpl", 8,
+                     "the @streamingReads attribute can only be applied to "
+                     "for, forall, foreach, while and do-while statements");
+  assert(guard.realizeErrors());
+}
+
 int main() {
   test0();
   test1();
@@ -606,6 +754,10 @@ int main() {
   test16();
   test17();
   test18();
+  test19();
+  test20();
+  test21();
+  test22();
 
   return 0;
 }
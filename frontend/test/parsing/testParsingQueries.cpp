@@ -784,6 +784,38 @@ static void test12() {
   assert(cDeclAttr==nullptr);
 }
 
+// Check that results not used in a revision survive garbage collection
+// when the Context is configured to keep a few revisions.
+static void test13() {
+  printf("test13\n");
+  Context context;
+  Context* ctx = &context;
+  ctx->setGarbageCollectionRetention(/* keepRevisions */ 3);
+
+  ctx->advanceToNextRevision(true);
+  auto modOnePath = UniqueString::get(ctx, "modOne.chpl");
+  std::string modOneContents = "a;\n";
+  setFileText(ctx, modOnePath, modOneContents);
+  const Module* oldModuleOne = parseOneModule(ctx, modOnePath);
+  ctx->collectGarbage();
+
+  // only modTwo is used in this revision
+  ctx->advanceToNextRevision(true);
+  auto modTwoPath = UniqueString::get(ctx, "modTwo.chpl");
+  std::string modTwoContents = "b;\n";
+  setFileText(ctx, modTwoPath, modTwoContents);
+  parseOneModule(ctx, modTwoPath);
+  ctx->collectGarbage();
+
+  // modOne's parse should have been kept, so it is reused here
+  ctx->advanceToNextRevision(true);
+  setFileText(ctx, modOnePath, modOneContents);
+  const Module* moduleOne = parseOneModule(ctx, modOnePath);
+  assert(moduleOne == oldModuleOne);
+  assert(moduleOne->numStmts() == 1);
+  ctx->collectGarbage();
+}
+
 int main() {
   test0();
   test1();
@@ -798,6 +830,7 @@ int main() {
   test10();
   test11();
   test12();
+  test13();
 
   return 0;
 }
@@ -542,6 +542,40 @@ static void test8() {
   r = canPass(context, anEnum, anyEnumType); assert(passesInstantiates(r));
 }
 
+static void test9() {
+  printf("test9\n");
+  // canPass results are memoized; check that repeated and interleaved
+  // queries still tell apart kinds and param values, across revisions too.
+  Context ctx;
+  Context* context = &ctx;
+  Context* c = context;
+
+  auto int8Type = IntType::get(context, 8);
+  auto int64Type = IntType::get(context, 64);
+
+  QualifiedType refInt64(QualifiedType::REF, int64Type);
+  QualifiedType inInt64(QualifiedType::IN, int64Type);
+
+  QualifiedType small(QualifiedType::PARAM, int64Type,
+                      IntParam::get(context, 1));
+  QualifiedType big(QualifiedType::PARAM, int64Type,
+                    IntParam::get(context, 1000));
+  QualifiedType int8(QualifiedType::VAR, int8Type);
+
+  for (int i = 0; i < 2; i++) {
+    CanPassResult r;
+    r = canPass(c, int8, refInt64); assert(doesNotPass(r));
+    r = canPass(c, int8, inInt64); assert(passesNumeric(r));
+    r = canPass(c, int8, refInt64); assert(doesNotPass(r));
+
+    r = canPass(c, small, int8); assert(passesParamNarrowing(r));
+    r = canPass(c, big, int8); assert(doesNotPass(r));
+    r = canPass(c, small, int8); assert(passesParamNarrowing(r));
+
+    context->advanceToNextRevision(false);
+  }
+}
+
 int main() {
   test1();
   test2();
@@ -551,6 +585,7 @@ int main() {
   test6();
   test7();
   test8();
+  test9();
 
   return 0;
 }
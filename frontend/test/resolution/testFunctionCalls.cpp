@@ -132,11 +132,47 @@ static void test3b() {
   helpTest3(theFunction);
 }
 
+static void helpTest4(const std::string& call, bool found, TypeTag tag) {
+  // Candidates with the wrong number or names of formals are ruled
+  // out before their formal types are computed; make sure the right
+  // ones are still found.
+  Context ctx;
+  auto context = &ctx;
+  auto qt = resolveTypeOfXInit(context,
+                               R""""(
+                               proc f(a: int) do return true;
+                               proc f(a: int, b: int, c: int = 0) do return 1.0;
+                               proc g(a: int, b: int) do return 1;
+                               proc g(a: int, c: int) do return 1.0;
+                               proc h(xs: int...) do return true;
+                               )"""" + call, found);
+  if (found) {
+    assert(qt.type()->tag() == tag);
+  } else {
+    assert(qt.isUnknown() || qt.isErroneousType());
+  }
+}
+
+static void test4() {
+  // one candidate takes this many actuals, with or without defaults
+  helpTest4("var x = f(1);", true, typetags::BoolType);
+  helpTest4("var x = f(1, 2);", true, typetags::RealType);
+  helpTest4("var x = h(1, 2, 3, 4);", true, typetags::BoolType);
+
+  // named actuals pick between overloads of the same arity
+  helpTest4("var x = g(1, b=2);", true, typetags::IntType);
+  helpTest4("var x = g(1, c=2);", true, typetags::RealType);
+
+  // no candidate takes this many actuals or these names
+  helpTest4("var x = f(1, 2, 3, 4);", false, typetags::UnknownType);
+  helpTest4("var x = g(1, d=2);", false, typetags::UnknownType);
+}
 
 int main() {
   test1();
   test2();
   test3a();
   test3b();
+  test4();
   return 0;
 }
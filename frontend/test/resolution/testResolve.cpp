@@ -26,6 +26,8 @@
 #include "chpl/types/QualifiedType.h"
 #include "chpl/uast/Comment.h"
 #include "chpl/uast/FnCall.h"
+#include "chpl/uast/For.h"
+#include "chpl/uast/Function.h"
 #include "chpl/uast/Identifier.h"
 #include "chpl/uast/Module.h"
 #include "chpl/uast/Variable.h"
@@ -522,6 +524,132 @@ static void test10() {
   guard.realizeErrors();
 }
 
+// test that results are kept for the IDs set up, and only those
+static void test11() {
+  printf("test11\n");
+  Context ctx;
+  Context* context = &ctx;
+
+  auto path = UniqueString::get(context, "input.chpl");
+  std::string contents = R""""(
+                           proc f() {
+                             var a = 1;
+                             var b = a;
+                           }
+                         )"""";
+  setFileText(context, path, contents);
+
+  const ModuleVec& vec = parseToplevel(context, path);
+  assert(vec.size() == 1);
+  const Module* m = vec[0]->toModule();
+  assert(m && m->numStmts() == 1);
+  const Function* f = m->stmt(0)->toFunction();
+  assert(f);
+  const Variable* a = f->stmt(0)->toVariable();
+  const Variable* b = f->stmt(1)->toVariable();
+  assert(a && b);
+
+  QualifiedType intQt(QualifiedType::VAR, IntType::get(context, 0));
+
+  ResolutionResultByPostorderID rr;
+  rr.setupForFunction(f);
+  assert(!rr.hasAst(a));
+  assert(!rr.hasAst(b));
+
+  // adding more results must not move the ones already there
+  ResolvedExpression& aRe = rr.byAst(a);
+  aRe.setType(intQt);
+  rr.byAst(b);
+  assert(rr.hasAst(a) && rr.hasAst(b));
+  assert(&rr.byAst(a) == &aRe);
+  assert(rr.byAst(a).type() == intQt);
+  assert(rr.byAst(b).type() != intQt);
+
+  // an ID beyond the function's contents is still kept
+  ID farId(f->id().symbolPath(), f->id().numContainedChildren() + 100, 0);
+  assert(!rr.hasId(farId));
+  assert(rr.byIdOrNull(farId) == nullptr);
+  rr.byId(farId).setType(intQt);
+  assert(rr.hasId(farId));
+  assert(rr.byIdOrNull(farId)->type() == intQt);
+  assert(rr.byAst(a).type() == intQt);
+
+  // but an ID from another symbol is not
+  ID otherId(UniqueString::get(context, "input.g"), 0, 0);
+  assert(!rr.hasId(otherId));
+
+  // equality only considers the results that were added
+  ResolutionResultByPostorderID rr2;
+  rr2.setupForFunction(f);
+  rr2.byAst(a).setType(intQt);
+  rr2.byAst(b);
+  assert(rr != rr2);
+  rr2.byId(farId).setType(intQt);
+  assert(rr == rr2);
+  rr2.byAst(b).setType(intQt);
+  assert(rr != rr2);
+}
+
+// test that a module statement's results only cover that statement
+static void test12() {
+  printf("test12\n");
+  Context ctx;
+  Context* context = &ctx;
+
+  auto path = UniqueString::get(context, "input.chpl");
+  std::string contents = R""""(
+                           proc f() {
+                             var s = 0;
+                             for param i in 1..3 {
+                               var t: int = i;
+                             }
+                             return s;
+                           }
+                           var x = 1;
+                           var y = x;
+                           var z = f();
+                         )"""";
+  setFileText(context, path, contents);
+
+  const ModuleVec& vec = parseToplevel(context, path);
+  assert(vec.size() == 1);
+  const Module* m = vec[0]->toModule();
+  assert(m && m->numStmts() == 4);
+  const Variable* x = m->stmt(1)->toVariable();
+  const Variable* y = m->stmt(2)->toVariable();
+  const Variable* z = m->stmt(3)->toVariable();
+  assert(x && y && z);
+
+  const ResolutionResultByPostorderID& yRr = resolveModuleStmt(context, y->id());
+  assert(yRr.hasAst(y));
+  assert(yRr.hasAst(y->initExpression()));
+  assert(yRr.byAst(y).type().type()->isIntType());
+  assert(!yRr.hasAst(x));
+  assert(!yRr.hasAst(z));
+
+  const ResolutionResultByPostorderID& rr = resolveModule(context, m->id());
+  assert(rr.byAst(x).type().type()->isIntType());
+  assert(rr.byAst(y).type().type()->isIntType());
+  assert(rr.byAst(y->initExpression()).toId() == x->id());
+  assert(rr.byAst(z).type().type()->isIntType());
+
+  // each param loop body gets its own results for the loop's contents
+  const Function* f = m->stmt(0)->toFunction();
+  const For* loop = f->stmt(1)->toFor();
+  assert(f && loop);
+  const Variable* t = loop->stmt(0)->toVariable();
+  assert(t);
+  const ResolvedFunction* rf = resolveConcreteFunction(context, f->id());
+  assert(rf);
+  const ResolvedParamLoop* rpl = rf->byAst(loop).paramLoop();
+  assert(rpl);
+  assert(rpl->loopBodies().size() == 3);
+  for (const auto& body : rpl->loopBodies()) {
+    assert(body.hasAst(t));
+    assert(body.byAst(t).type().type()->isIntType());
+    assert(!body.hasAst(f->stmt(0)));
+  }
+}
 
 int main() {
   test1();
@@ -534,6 +662,8 @@ int main() {
   test8();
   test9();
   test10();
+  test11();
+  test12();
 
   return 0;
 }
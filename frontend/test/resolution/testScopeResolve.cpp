@@ -1267,6 +1267,57 @@ static void test32b() {
   auto moduleResolutionResults = scopeResolveModule(context, moduleO->id());
 }
 
+// check that memoized lookups are invalidated when a used module changes
+static void test33() {
+  printf("test33\n");
+  Context ctx;
+  Context* context = &ctx;
+
+  auto path = UniqueString::get(context, "input.chpl");
+  auto name = UniqueString::get(context, "x");
+  LookupConfig config = LOOKUP_DECLS |
+                        LOOKUP_IMPORT_AND_USE |
+                        LOOKUP_PARENTS |
+                        LOOKUP_INNERMOST;
+
+  std::string contents = R""""(
+      module M {
+        var x: int;
+      }
+      module N {
+        use M;
+      }
+   )"""";
+
+  for (int i = 0; i < 2; i++) {
+    context->advanceToNextRevision(false);
+    setFileText(context, path, contents);
+
+    const ModuleVec& vec = parseToplevel(context, path);
+    assert(vec.size() == 2);
+    const Scope* scopeN = scopeForId(context, vec[1]->id());
+
+    auto got = lookupNameInScope(context, scopeN, {}, name, config);
+    auto again = lookupNameInScope(context, scopeN, {}, name, config);
+    assert(got == again);
+
+    if (i == 0) {
+      assert(got.size() == 1);
+      assert(got[0].firstId() == vec[0]->stmt(0)->id());
+      contents = R""""(
+          module M {
+            var y: int;
+          }
+          module N {
+            use M;
+          }
+       )"""";
+    } else {
+      assert(got.empty());
+    }
+  }
+}
+
 
 int main() {
   test1();
@@ -1303,6 +1354,7 @@ int main() {
   test31();
   test32a();
   test32b();
+  test33();
 
   return 0;
 }
@@ -268,24 +268,86 @@ int chpl_mli_pull(void* socket, void* buffer, size_t bytes) {
   return chpl_mli_zmq_move(socket, buffer, bytes, 0);
 }
 
+//
+// Move a buffer along with its length as a single two-part message, so
+// that the sender waits on one reply instead of one per frame. The data
+// frame is handed to ZMQ without copying it. That is safe because every
+// sized push is followed by pulling the receiver's reply, which cannot
+// arrive before the data has been sent.
+//
 static
-int chpl_mli_push_ack(void* socket) {
-  return chpl_mli_push(socket, NULL, 0);
+int chpl_mli_push_sized(void* socket, void* buffer, uint64_t bytes) {
+  zmq_msg_t msg;
+  int result = 0;
+
+  chpl_mli_debugf("%" PRIu64 " bytes at %p to %p\n", bytes, buffer, socket);
+
+  result = zmq_send(socket, &bytes, sizeof(bytes), ZMQ_SNDMORE);
+
+  if (-1 != result) {
+    if (bytes == 0) {
+      result = zmq_send(socket, NULL, 0, 0);
+    } else {
+      zmq_msg_init_data(&msg, buffer, bytes, NULL, NULL);
+      result = zmq_msg_send(&msg, socket, 0);
+      if (-1 == result) { zmq_msg_close(&msg); }
+    }
+  }
+
+  if (-1 == result) {
+    chpl_mli_debugf("Failed to push to socket: %p\n", socket);
+    chpl_mli_debugf("%s\n", zmq_strerror(errno));
+    chpl_mli_terminate();
+  }
+
+  return result;
 }
 
+//
+// Pull a message sent with 'chpl_mli_push_sized' into a new buffer, which
+// is null terminated for convenience. Returns NULL if the buffer could not
+// be allocated, after draining the data from the socket.
+//
 static
-int chpl_mli_pull_ack(void* socket) {
-  return chpl_mli_pull(socket, NULL, 0);
+void* chpl_mli_pull_sized(void* socket, uint64_t* bytes) {
+  char* buffer = NULL;
+  zmq_msg_t msg;
+  int result = 0;
+
+  chpl_mli_pull(socket, bytes, sizeof(*bytes));
+  chpl_mli_debugf("Received intended length: %" PRIu64 "\n", *bytes);
+
+  buffer = chpl_mli_malloc(*bytes + 1);
+
+  if (buffer != NULL) {
+    result = zmq_recv(socket, buffer, *bytes, 0);
+    if (-1 != result) { buffer[*bytes] = 0; }
+  } else {
+    chpl_mli_debugf("%s\n", "Failed to allocate buffer!");
+    zmq_msg_init(&msg);
+    result = zmq_msg_recv(&msg, socket, 0);
+    zmq_msg_close(&msg);
+  }
+
+  if (-1 == result) {
+    chpl_mli_debugf("Failed to pull from socket: %p\n", socket);
+    chpl_mli_debugf("%s\n", zmq_strerror(errno));
+    chpl_mli_terminate();
+  }
+
+  return buffer;
 }
 
 static
 int chpl_mli_push_byte_buffer(void* socket, chpl_byte_buffer* obj) {
-  chpl_mli_push(socket, &obj->size, sizeof(obj->size));
-  chpl_mli_pull_ack(socket);
+  int64_t mem_err = 0;
+
   chpl_mli_debugf("Byte buffer length: %" PRIu64 "\n", obj->size);
+  chpl_mli_push_sized(socket, obj->data, obj->size);
 
-  chpl_mli_push(socket, obj->data, obj->size);
-  chpl_mli_pull_ack(socket);
+  // The reply says whether the receiver could allocate a buffer.
+  chpl_mli_pull(socket, &mem_err, sizeof(mem_err));
+  if (mem_err) { chpl_mli_terminate(); }
 
   // TODO: User data may not be trustable? E.g. not null terminated...
   // TODO: Truncate beyond a certain length.
@@ -296,23 +358,17 @@ int chpl_mli_push_byte_buffer(void* socket, chpl_byte_buffer* obj) {
 
 static
 int chpl_mli_pull_byte_buffer(void* socket, chpl_byte_buffer* obj) {
-  chpl_mli_pull(socket, &obj->size, sizeof(obj->size));
-  chpl_mli_push_ack(socket);
-  chpl_mli_debugf("Byte buffer length: %" PRIu64 "\n", obj->size);
+  int64_t mem_err = 0;
 
-  obj->data = chpl_mli_malloc(obj->size + 1);
+  obj->data = chpl_mli_pull_sized(socket, &obj->size);
   obj->isOwned = true;
+  chpl_mli_debugf("Byte buffer length: %" PRIu64 "\n", obj->size);
 
-  // TODO: Need to handle synchronous termination.
-  if (NULL == obj->data) {
-    chpl_mli_debugf("%s\n", "Failed to allocate buffer!");
-    chpl_mli_terminate();
-  }
-
-  chpl_mli_pull(socket, obj->data, obj->size);
-  chpl_mli_push_ack(socket);
+  mem_err = (obj->data == NULL);
+  chpl_mli_push(socket, &mem_err, sizeof(mem_err));
 
-  obj->data[obj->size] = 0;
+  // TODO: Need to handle synchronous termination.
+  if (mem_err) { chpl_mli_terminate(); }
 
   chpl_mli_debugf("Byte buffer data: %s\n", obj->data);
 
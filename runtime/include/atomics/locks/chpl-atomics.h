@@ -24,6 +24,8 @@
 #include "chpltypes.h"
 #include "chpl-tasks.h"
 #include <pthread.h>
+#include <stdint.h>
+#include <string.h>
 
 // Locks based atomic implementation. Note that we use pthread mutexes instead
 // of chpl sync variables because we need to use atomics during runtime init
@@ -32,6 +34,17 @@
 // Since there are no yields, there's no possibility of recursive locking on
 // the same thread from different tasks or unlocking from a different thread,
 // both of which violate pthread semantics.
+//
+// Rather than each atomic carrying its own mutex, an atomic's address
+// is hashed to pick one of a fixed table of locks, each on its own
+// cache line, so that unrelated atomics rarely contend and an atomic
+// is no bigger than its value.  Where glibc offers them, the locks are
+// adaptive mutexes, which spin briefly before sleeping; our critical
+// sections are only a few instructions long.
+//
+// On x86_64 with a compiler that takes GNU inline assembly we don't
+// need locks at all: every operation is a lock-prefixed instruction
+// (or a cmpxchg loop around one), so that path is used instead.
 
 #ifdef __cplusplus
 extern "C" {
@@ -49,57 +62,48 @@ extern "C" {
  #define MAYBE_INLINE
 #endif
 
-typedef struct atomic_int_least8_s {
-  pthread_mutex_t lock;
-  int_least8_t v;
-} atomic_int_least8_t;
-typedef struct atomic_int_least16_s {
-  pthread_mutex_t lock;
-  int_least16_t v;
-} atomic_int_least16_t;
-typedef struct atomic_int_least32_s {
-  pthread_mutex_t lock;
-  int_least32_t v;
-} atomic_int_least32_t;
-typedef struct atomic_int_least64_s {
-  pthread_mutex_t lock;
-  int_least64_t v;
-} atomic_int_least64_t;
-typedef struct atomic_uint_least8_s {
-  pthread_mutex_t lock;
-  uint_least8_t v;
-} atomic_uint_least8_t;
-typedef struct atomic_uint_least16_s {
-  pthread_mutex_t lock;
-  uint_least16_t v;
-} atomic_uint_least16_t;
-typedef struct atomic_uint_least32_s {
-  pthread_mutex_t lock;
-  uint_least32_t v;
-} atomic_uint_least32_t;
-typedef struct atomic_uint_least64_s {
-  pthread_mutex_t lock;
-  uint_least64_t v;
-} atomic_uint_least64_t;
-typedef struct atomic_uintptr_s {
-  pthread_mutex_t lock;
-  uintptr_t v;
-} atomic_uintptr_t;
+#if defined(__x86_64__) && defined(__GNUC__)
+ #define CHPL_ATOMICS_LOCKS_NATIVE 1
+#else
+ #define CHPL_ATOMICS_LOCK_STRIPES 256    // must be a power of 2
 
-typedef struct atomic_bool_s {
+typedef union chpl_atomic_lock_stripe_u {
   pthread_mutex_t lock;
-  chpl_bool v;
-} atomic_bool;
+  char pad[((sizeof(pthread_mutex_t) + 63) / 64) * 64];
+} chpl_atomic_lock_stripe_t;
 
-typedef struct atomic__real32_s {
-  pthread_mutex_t lock;
-  _real32 v;
-} atomic__real32;
+// Defined in chpl-atomics.c.
+extern chpl_atomic_lock_stripe_t
+  chpl_atomic_lock_stripes[CHPL_ATOMICS_LOCK_STRIPES];
 
-typedef struct atomic__real64_s {
-  pthread_mutex_t lock;
-  _real64 v;
-} atomic__real64;
+static inline pthread_mutex_t* chpl_atomic_lock_for(const void* obj) {
+  uintptr_t a = (uintptr_t) obj;
+  // Atomics are at least a few bytes apart, and neighbours in an array
+  // should land on different locks.
+  return &chpl_atomic_lock_stripes[((a >> 3) ^ (a >> 11))
+                                   & (CHPL_ATOMICS_LOCK_STRIPES - 1)].lock;
+}
+#endif
+
+#define DECLARE_ATOMIC_TYPE(type, basetype) \
+typedef struct atomic_ ## type ## _s { \
+  basetype v; \
+} atomic_ ## type;
+
+DECLARE_ATOMIC_TYPE(int_least8_t, int_least8_t)
+DECLARE_ATOMIC_TYPE(int_least16_t, int_least16_t)
+DECLARE_ATOMIC_TYPE(int_least32_t, int_least32_t)
+DECLARE_ATOMIC_TYPE(int_least64_t, int_least64_t)
+DECLARE_ATOMIC_TYPE(uint_least8_t, uint_least8_t)
+DECLARE_ATOMIC_TYPE(uint_least16_t, uint_least16_t)
+DECLARE_ATOMIC_TYPE(uint_least32_t, uint_least32_t)
+DECLARE_ATOMIC_TYPE(uint_least64_t, uint_least64_t)
+DECLARE_ATOMIC_TYPE(uintptr_t, uintptr_t)
+DECLARE_ATOMIC_TYPE(bool, chpl_bool)
+DECLARE_ATOMIC_TYPE(_real32, _real32)
+DECLARE_ATOMIC_TYPE(_real64, _real64)
+
+#undef DECLARE_ATOMIC_TYPE
 
 typedef pthread_spinlock_t atomic_spinlock_t;
 
@@ -116,73 +120,123 @@ static inline memory_order _defaultOfMemoryOrder(void) {
   return memory_order_seq_cst;
 }
 
+#ifdef CHPL_ATOMICS_LOCKS_NATIVE
+
 static inline
 void chpl_atomic_thread_fence(memory_order order)
 {
-  // No idea!
+  // x86 only reorders stores after later loads.
+  if (order == memory_order_seq_cst) {
+    __asm__ __volatile__("mfence" ::: "memory");
+  } else {
+    __asm__ __volatile__("" ::: "memory");
+  }
 }
 static inline
 void chpl_atomic_signal_fence(memory_order order)
 {
-  // No idea!
+  __asm__ __volatile__("" ::: "memory");
 }
 
-#define DECLARE_ATOMICS_BASE(type, basetype) \
-static inline chpl_bool atomic_is_lock_free_ ## type(atomic_ ## type * obj) { \
+//
+// The primitives, on an atomic's bits.  Every lock-prefixed instruction
+// (and xchg with memory, which is locked implicitly) is a full barrier,
+// so these are all seq_cst.
+//
+#define DECLARE_NATIVE_PRIMS(bits) \
+static inline bits chpl_atomic_xchg_ ## bits(void* p, bits v) { \
+  __asm__ __volatile__("xchg %0, %1" \
+                       : "+r"(v), "+m"(*(volatile bits*) p) \
+                       : : "memory"); \
+  return v; \
+} \
+static inline bits chpl_atomic_xadd_ ## bits(void* p, bits v) { \
+  __asm__ __volatile__("lock; xadd %0, %1" \
+                       : "+r"(v), "+m"(*(volatile bits*) p) \
+                       : : "memory", "cc"); \
+  return v; \
+} \
+static inline chpl_bool chpl_atomic_cas_ ## bits(void* p, bits* expected, \
+                                                 bits desired) { \
+  bits prev = *expected; \
+  bits old; \
+  __asm__ __volatile__("lock; cmpxchg %2, %1" \
+                       : "=a"(old), "+m"(*(volatile bits*) p) \
+                       : "q"(desired), "0"(prev) \
+                       : "memory", "cc"); \
+  if (old == prev) { \
+    return true; \
+  } \
+  *expected = old; \
   return false; \
+}
+
+DECLARE_NATIVE_PRIMS(uint8_t)
+DECLARE_NATIVE_PRIMS(uint16_t)
+DECLARE_NATIVE_PRIMS(uint32_t)
+DECLARE_NATIVE_PRIMS(uint64_t)
+
+#undef DECLARE_NATIVE_PRIMS
+
+// 'bits' is the unsigned type of the same size as 'basetype'.
+#define DECLARE_ATOMICS_BASE(type, basetype, bits) \
+static inline chpl_bool atomic_is_lock_free_ ## type(atomic_ ## type * obj) { \
+  return true; \
 } \
 static inline void atomic_init_ ## type(atomic_ ## type * obj, basetype value) { \
   obj->v = value; \
-  (void) pthread_mutex_init(&obj->lock, NULL); \
 } \
 static inline void atomic_destroy_ ## type(atomic_ ## type * obj) { \
-  (void) pthread_mutex_destroy(&obj->lock); \
 } \
-static MAYBE_INLINE void \
+static inline void \
 atomic_store_explicit_ ## type(atomic_ ## type * obj, basetype value, memory_order order) { \
-  (void) pthread_mutex_lock(&obj->lock); \
-  obj->v = value; \
-  (void) pthread_mutex_unlock(&obj->lock); \
+  if (order == memory_order_seq_cst) { \
+    bits b; \
+    memcpy(&b, &value, sizeof(b)); \
+    (void) chpl_atomic_xchg_ ## bits(&obj->v, b); \
+  } else { \
+    __asm__ __volatile__("" ::: "memory"); \
+    *(volatile basetype*) &obj->v = value; \
+    __asm__ __volatile__("" ::: "memory"); \
+  } \
 } \
 static inline void atomic_store_ ## type(atomic_ ## type * obj, basetype value) { \
   atomic_store_explicit_ ## type(obj, value, memory_order_seq_cst); \
 } \
-static MAYBE_INLINE basetype \
+static inline basetype \
 atomic_load_explicit_ ## type(atomic_ ## type * obj, memory_order order) { \
   basetype ret; \
-  (void) pthread_mutex_lock(&obj->lock); \
-  ret = obj->v; \
-  (void) pthread_mutex_unlock(&obj->lock); \
+  __asm__ __volatile__("" ::: "memory"); \
+  ret = *(volatile basetype*) &obj->v; \
+  __asm__ __volatile__("" ::: "memory"); \
   return ret; \
 } \
 static inline basetype atomic_load_ ## type(atomic_ ## type * obj) { \
   return atomic_load_explicit_ ## type(obj, memory_order_seq_cst); \
 } \
-static MAYBE_INLINE basetype \
+static inline basetype \
 atomic_exchange_explicit_ ## type(atomic_ ## type * obj, basetype value, memory_order order) { \
+  bits b; \
   basetype ret; \
-  (void) pthread_mutex_lock(&obj->lock); \
-  ret = obj->v; \
-  obj->v = value; \
-  (void) pthread_mutex_unlock(&obj->lock); \
+  memcpy(&b, &value, sizeof(b)); \
+  b = chpl_atomic_xchg_ ## bits(&obj->v, b); \
+  memcpy(&ret, &b, sizeof(ret)); \
   return ret; \
 } \
 static inline basetype atomic_exchange_ ## type(atomic_ ## type * obj, basetype value) { \
   return atomic_exchange_explicit_ ## type(obj, value, memory_order_seq_cst); \
 } \
-static MAYBE_INLINE chpl_bool \
+static inline chpl_bool \
 atomic_compare_exchange_strong_explicit_ ## type(atomic_ ## type * obj, basetype * expected, basetype desired, memory_order succ, memory_order fail) { \
-  basetype ret; \
-  (void) pthread_mutex_lock(&obj->lock); \
-  if( obj->v == *expected ) { \
-    obj->v = desired; \
-    ret = true; \
-  } else { \
-    *expected = obj->v; \
-    ret = false; \
+  bits e; \
+  bits d; \
+  memcpy(&e, expected, sizeof(e)); \
+  memcpy(&d, &desired, sizeof(d)); \
+  if (chpl_atomic_cas_ ## bits(&obj->v, &e, d)) { \
+    return true; \
   } \
-  (void) pthread_mutex_unlock(&obj->lock); \
-  return ret; \
+  memcpy(expected, &e, sizeof(e)); \
+  return false; \
 } \
 static inline chpl_bool atomic_compare_exchange_strong_ ## type(atomic_ ## type * obj, basetype * expected, basetype desired) { \
   return atomic_compare_exchange_strong_explicit_ ## type(obj, expected, desired, memory_order_seq_cst, memory_order_seq_cst); \
@@ -194,94 +248,176 @@ static inline chpl_bool atomic_compare_exchange_weak_ ## type(atomic_ ## type *
   return atomic_compare_exchange_weak_explicit_ ## type(obj, expected, desired, memory_order_seq_cst, memory_order_seq_cst); \
 }
 
-#define DECLARE_ATOMICS_FETCH_OPS(type) \
-static MAYBE_INLINE type \
+// An operation the hardware doesn't have, as a compare-exchange loop.
+#define DECLARE_CAS_LOOP_OP(type, name, op) \
+static inline type \
+atomic_fetch_ ## name ## _explicit_ ## type(atomic_ ## type * obj, type operand, memory_order order) { \
+  type old = atomic_load_explicit_ ## type(obj, memory_order_relaxed); \
+  while (!atomic_compare_exchange_strong_explicit_ ## type(obj, &old, old op operand, order, memory_order_relaxed)) { \
+  } \
+  return old; \
+} \
+static inline type atomic_fetch_ ## name ## _ ## type(atomic_ ## type * obj, type operand) { \
+  return atomic_fetch_ ## name ## _explicit_ ## type(obj, operand, memory_order_seq_cst); \
+}
+
+#define DECLARE_ATOMICS_FETCH_OPS(type, bits) \
+static inline type \
 atomic_fetch_add_explicit_ ## type(atomic_ ## type * obj, type operand, memory_order order) { \
-  type ret; \
-  (void) pthread_mutex_lock(&obj->lock); \
-  ret = obj->v; \
-  obj->v += operand; \
-  (void) pthread_mutex_unlock(&obj->lock); \
-  return ret; \
+  return (type) chpl_atomic_xadd_ ## bits(&obj->v, (bits) operand); \
 } \
 static inline type atomic_fetch_add_ ## type(atomic_ ## type * obj, type operand) { \
   return atomic_fetch_add_explicit_ ## type(obj, operand, memory_order_seq_cst); \
 } \
-static MAYBE_INLINE type \
+static inline type \
 atomic_fetch_sub_explicit_ ## type(atomic_ ## type * obj, type operand, memory_order order) { \
-  type ret; \
-  (void) pthread_mutex_lock(&obj->lock); \
-  ret = obj->v; \
-  obj->v -= operand; \
-  (void) pthread_mutex_unlock(&obj->lock); \
-  return ret; \
+  return (type) chpl_atomic_xadd_ ## bits(&obj->v, (bits) 0 - (bits) operand); \
 } \
 static inline type atomic_fetch_sub_ ## type(atomic_ ## type * obj, type operand) { \
   return atomic_fetch_sub_explicit_ ## type(obj, operand, memory_order_seq_cst); \
 } \
-static MAYBE_INLINE type \
-atomic_fetch_or_explicit_ ## type(atomic_ ## type * obj, type operand, memory_order order) { \
-  type ret; \
-  (void) pthread_mutex_lock(&obj->lock); \
-  ret = obj->v; \
-  obj->v |= operand; \
-  (void) pthread_mutex_unlock(&obj->lock); \
-  return ret; \
+DECLARE_CAS_LOOP_OP(type, or, |) \
+DECLARE_CAS_LOOP_OP(type, and, &) \
+DECLARE_CAS_LOOP_OP(type, xor, ^)
+
+#define DECLARE_REAL_ATOMICS_FETCH_OPS(type) \
+DECLARE_CAS_LOOP_OP(type, add, +) \
+DECLARE_CAS_LOOP_OP(type, sub, -)
+
+DECLARE_ATOMICS_BASE(bool, chpl_bool, uint8_t);
+
+#define DECLARE_ATOMICS(type, bits) \
+  DECLARE_ATOMICS_BASE(type, type, bits) \
+  DECLARE_ATOMICS_FETCH_OPS(type, bits)
+
+#define DECLARE_REAL_ATOMICS(type, bits) \
+  DECLARE_ATOMICS_BASE(type, type, bits) \
+  DECLARE_REAL_ATOMICS_FETCH_OPS(type)
+
+DECLARE_ATOMICS(int_least8_t, uint8_t);
+DECLARE_ATOMICS(int_least16_t, uint16_t);
+DECLARE_ATOMICS(int_least32_t, uint32_t);
+DECLARE_ATOMICS(int_least64_t, uint64_t);
+DECLARE_ATOMICS(uint_least8_t, uint8_t);
+DECLARE_ATOMICS(uint_least16_t, uint16_t);
+DECLARE_ATOMICS(uint_least32_t, uint32_t);
+DECLARE_ATOMICS(uint_least64_t, uint64_t);
+DECLARE_ATOMICS(uintptr_t, uint64_t);
+
+DECLARE_REAL_ATOMICS(_real32, uint32_t);
+DECLARE_REAL_ATOMICS(_real64, uint64_t);
+
+#undef DECLARE_CAS_LOOP_OP
+#undef DECLARE_REAL_ATOMICS
+
+#else // !CHPL_ATOMICS_LOCKS_NATIVE
+
+static inline
+void chpl_atomic_thread_fence(memory_order order)
+{
+  // No idea!
+}
+static inline
+void chpl_atomic_signal_fence(memory_order order)
+{
+  // No idea!
+}
+
+#define DECLARE_ATOMICS_BASE(type, basetype) \
+static inline chpl_bool atomic_is_lock_free_ ## type(atomic_ ## type * obj) { \
+  return false; \
+} \
+static inline void atomic_init_ ## type(atomic_ ## type * obj, basetype value) { \
+  obj->v = value; \
 } \
-static inline type atomic_fetch_or_ ## type(atomic_ ## type * obj, type operand) { \
-  return atomic_fetch_or_explicit_ ## type(obj, operand, memory_order_seq_cst); \
+static inline void atomic_destroy_ ## type(atomic_ ## type * obj) { \
 } \
-static MAYBE_INLINE type \
-atomic_fetch_and_explicit_ ## type(atomic_ ## type * obj, type operand, memory_order order) { \
-  type ret; \
-  (void) pthread_mutex_lock(&obj->lock); \
+static MAYBE_INLINE void \
+atomic_store_explicit_ ## type(atomic_ ## type * obj, basetype value, memory_order order) { \
+  pthread_mutex_t* lock = chpl_atomic_lock_for(obj); \
+  (void) pthread_mutex_lock(lock); \
+  obj->v = value; \
+  (void) pthread_mutex_unlock(lock); \
+} \
+static inline void atomic_store_ ## type(atomic_ ## type * obj, basetype value) { \
+  atomic_store_explicit_ ## type(obj, value, memory_order_seq_cst); \
+} \
+static MAYBE_INLINE basetype \
+atomic_load_explicit_ ## type(atomic_ ## type * obj, memory_order order) { \
+  pthread_mutex_t* lock = chpl_atomic_lock_for(obj); \
+  basetype ret; \
+  (void) pthread_mutex_lock(lock); \
   ret = obj->v; \
-  obj->v &= operand; \
-  (void) pthread_mutex_unlock(&obj->lock); \
+  (void) pthread_mutex_unlock(lock); \
   return ret; \
 } \
-static inline type atomic_fetch_and_ ## type(atomic_ ## type * obj, type operand) { \
-  return atomic_fetch_and_explicit_ ## type(obj, operand, memory_order_seq_cst); \
+static inline basetype atomic_load_ ## type(atomic_ ## type * obj) { \
+  return atomic_load_explicit_ ## type(obj, memory_order_seq_cst); \
 } \
-static MAYBE_INLINE type \
-atomic_fetch_xor_explicit_ ## type(atomic_ ## type * obj, type operand, memory_order order) { \
-  type ret; \
-  (void) pthread_mutex_lock(&obj->lock); \
+static MAYBE_INLINE basetype \
+atomic_exchange_explicit_ ## type(atomic_ ## type * obj, basetype value, memory_order order) { \
+  pthread_mutex_t* lock = chpl_atomic_lock_for(obj); \
+  basetype ret; \
+  (void) pthread_mutex_lock(lock); \
   ret = obj->v; \
-  obj->v ^= operand; \
-  (void) pthread_mutex_unlock(&obj->lock); \
+  obj->v = value; \
+  (void) pthread_mutex_unlock(lock); \
   return ret; \
 } \
-static inline type atomic_fetch_xor_ ## type(atomic_ ## type * obj, type operand) { \
-  return atomic_fetch_xor_explicit_ ## type(obj, operand, memory_order_seq_cst); \
-}
-
-#define DECLARE_REAL_ATOMICS_FETCH_OPS(type) \
-static MAYBE_INLINE type \
-atomic_fetch_add_explicit_ ## type(atomic_ ## type * obj, type operand, memory_order order) { \
-  type ret; \
-  (void) pthread_mutex_lock(&obj->lock); \
-  ret = obj->v; \
-  obj->v += operand; \
-  (void) pthread_mutex_unlock(&obj->lock); \
+static inline basetype atomic_exchange_ ## type(atomic_ ## type * obj, basetype value) { \
+  return atomic_exchange_explicit_ ## type(obj, value, memory_order_seq_cst); \
+} \
+static MAYBE_INLINE chpl_bool \
+atomic_compare_exchange_strong_explicit_ ## type(atomic_ ## type * obj, basetype * expected, basetype desired, memory_order succ, memory_order fail) { \
+  pthread_mutex_t* lock = chpl_atomic_lock_for(obj); \
+  basetype ret; \
+  (void) pthread_mutex_lock(lock); \
+  if( obj->v == *expected ) { \
+    obj->v = desired; \
+    ret = true; \
+  } else { \
+    *expected = obj->v; \
+    ret = false; \
+  } \
+  (void) pthread_mutex_unlock(lock); \
   return ret; \
 } \
-static inline type atomic_fetch_add_ ## type(atomic_ ## type * obj, type operand) { \
-  return atomic_fetch_add_explicit_ ## type(obj, operand, memory_order_seq_cst); \
+static inline chpl_bool atomic_compare_exchange_strong_ ## type(atomic_ ## type * obj, basetype * expected, basetype desired) { \
+  return atomic_compare_exchange_strong_explicit_ ## type(obj, expected, desired, memory_order_seq_cst, memory_order_seq_cst); \
+} \
+static inline chpl_bool atomic_compare_exchange_weak_explicit_ ## type(atomic_ ## type * obj, basetype * expected, basetype desired, memory_order succ, memory_order fail) { \
+  return atomic_compare_exchange_strong_explicit_ ## type(obj, expected, desired, succ, fail); \
 } \
+static inline chpl_bool atomic_compare_exchange_weak_ ## type(atomic_ ## type * obj, basetype * expected, basetype desired) { \
+  return atomic_compare_exchange_weak_explicit_ ## type(obj, expected, desired, memory_order_seq_cst, memory_order_seq_cst); \
+}
+
+#define DECLARE_LOCKED_OP(type, name, op) \
 static MAYBE_INLINE type \
-atomic_fetch_sub_explicit_ ## type(atomic_ ## type * obj, type operand, memory_order order) { \
+atomic_fetch_ ## name ## _explicit_ ## type(atomic_ ## type * obj, type operand, memory_order order) { \
+  pthread_mutex_t* lock = chpl_atomic_lock_for(obj); \
   type ret; \
-  (void) pthread_mutex_lock(&obj->lock); \
+  (void) pthread_mutex_lock(lock); \
   ret = obj->v; \
-  obj->v -= operand; \
-  (void) pthread_mutex_unlock(&obj->lock); \
+  obj->v op ## = operand; \
+  (void) pthread_mutex_unlock(lock); \
   return ret; \
 } \
-static inline type atomic_fetch_sub_ ## type(atomic_ ## type * obj, type operand) { \
-  return atomic_fetch_sub_explicit_ ## type(obj, operand, memory_order_seq_cst); \
+static inline type atomic_fetch_ ## name ## _ ## type(atomic_ ## type * obj, type operand) { \
+  return atomic_fetch_ ## name ## _explicit_ ## type(obj, operand, memory_order_seq_cst); \
 }
 
+#define DECLARE_ATOMICS_FETCH_OPS(type) \
+DECLARE_LOCKED_OP(type, add, +) \
+DECLARE_LOCKED_OP(type, sub, -) \
+DECLARE_LOCKED_OP(type, or, |) \
+DECLARE_LOCKED_OP(type, and, &) \
+DECLARE_LOCKED_OP(type, xor, ^)
+
+#define DECLARE_REAL_ATOMICS_FETCH_OPS(type) \
+DECLARE_LOCKED_OP(type, add, +) \
+DECLARE_LOCKED_OP(type, sub, -)
+
 DECLARE_ATOMICS_BASE(bool, chpl_bool);
 
 #define DECLARE_ATOMICS(type) \
@@ -308,8 +444,14 @@ DECLARE_ATOMICS_FETCH_OPS(uintptr_t);
 DECLARE_REAL_ATOMICS(_real32);
 DECLARE_REAL_ATOMICS(_real64);
 
+#undef DECLARE_LOCKED_OP
+#undef DECLARE_REAL_ATOMICS
+
+#endif // CHPL_ATOMICS_LOCKS_NATIVE
+
 #undef DECLARE_ATOMICS_BASE
 #undef DECLARE_ATOMICS_FETCH_OPS
+#undef DECLARE_REAL_ATOMICS_FETCH_OPS
 #undef DECLARE_ATOMICS
 #undef MAYBE_INLINE
 
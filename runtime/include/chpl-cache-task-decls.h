@@ -28,6 +28,10 @@ extern "C" {
 // This is the type of the task private data used by the cache
 typedef struct {
   int64_t last_acquire; // cache acquire barrier sets this
+  // For the node-wide shared cache (CHPL_RT_CACHE_SHARED):
+  uint64_t shared_last_acquire; // epoch of the last acquire barrier
+  int shared_wrote; // set by a PUT, cleared by the next release barrier
+  int streaming; // nesting depth of chpl_cache_stream_begin()
 } chpl_cache_taskPrvData_t;
 
 #ifdef __cplusplus
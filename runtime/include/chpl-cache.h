@@ -126,6 +126,13 @@ void chpl_cache_comm_getput_unordered(c_nodeid_t dstnode, void* dstaddr,
                                       int ln, int32_t fn);
 void chpl_cache_comm_getput_unordered_task_fence(void);
 
+// Between these, the calling task's GETs of data that isn't already in
+// the cache go through a few read-ahead buffers that don't displace
+// anything in the cache, for one-pass scans of remote data that won't
+// be read again. They nest.
+void chpl_cache_stream_begin(void);
+void chpl_cache_stream_end(void);
+
 int chpl_cache_pagesize(void);
 
 // For debugging.
@@ -36,20 +36,49 @@ extern "C" {
 // determine if the code needs to call any callbacks:
 // Typical code:
 //
-//    if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_put)) {
+//    if (chpl_comm_want_callbacks(chpl_comm_cb_event_kind_put, node, size)) {
 //       chpl_comm_cb_info_t cb_data = {.... actual data ....};
 //       chpl_comm_do_callbacks (&cb_data);
 //    }
 //
+// chpl_comm_want_callbacks() also checks the loosest of the installed
+// callbacks' filters, so that the event information isn't built for
+// events none of them want.
+//
 
 extern int chpl_comm_callback_counts[chpl_comm_cb_num_event_kinds];
 
+// the loosest of the filters installed for each event kind
+extern chpl_comm_cb_filter_t
+       chpl_comm_callback_filters[chpl_comm_cb_num_event_kinds];
+
 static inline
 int chpl_comm_have_callbacks(chpl_comm_cb_event_kind_t event_kind) {
   assert(event_kind < chpl_comm_cb_num_event_kinds);
   return (chpl_comm_callback_counts[event_kind] > 0);
 }
 
+static inline
+int chpl_comm_want_callbacks(chpl_comm_cb_event_kind_t event_kind,
+                             c_nodeid_t node, size_t size) {
+  const chpl_comm_cb_filter_t* f;
+  if (!chpl_comm_have_callbacks(event_kind))
+    return 0;
+  f = &chpl_comm_callback_filters[event_kind];
+  return size >= f->min_size && node >= f->node_lo && node <= f->node_hi;
+}
+
+// the number of bytes a strided transfer moves, for the size filter
+static inline
+size_t chpl_comm_cb_strd_size(size_t* count, int32_t stridelevels,
+                              size_t elemSize) {
+  size_t size = elemSize;
+  int32_t i;
+  for (i = 0; i <= stridelevels; i++)
+    size *= count[i];
+  return size;
+}
+
 void chpl_comm_do_callbacks (const chpl_comm_cb_info_t *cb_data);
 
 #ifdef __cplusplus
@@ -34,6 +34,10 @@ extern "C" {
 //
 //   chpl_comm_install_callback   - install communication callback function
 //   chpl_comm_uninstall_callback - remove communication callback function
+//   chpl_comm_install_filtered_callback - install callback for some events
+//   chpl_comm_install_batch_callback    - install callback for event batches
+//   chpl_comm_uninstall_batch_callback  - remove batched callback function
+//   chpl_comm_flush_callbacks    - deliver batched events now
 //
 //
 // SYNOPSIS
@@ -44,6 +48,19 @@ extern "C" {
 //                                    chpl_comm_cb_fn_t cb_fn);
 //     int chpl_comm_uninstall_callback(chpl_comm_cb_event_kind_t event_kind,
 //                                      chpl_comm_cb_fn_t cb_fn);
+//     int chpl_comm_install_filtered_callback(
+//                               chpl_comm_cb_event_kind_t event_kind,
+//                               chpl_comm_cb_fn_t cb_fn,
+//                               const chpl_comm_cb_filter_t* filter);
+//     int chpl_comm_install_batch_callback(
+//                               chpl_comm_cb_event_kind_t event_kind,
+//                               chpl_comm_cb_batch_fn_t cb_fn,
+//                               const chpl_comm_cb_filter_t* filter,
+//                               int batch_len);
+//     int chpl_comm_uninstall_batch_callback(
+//                               chpl_comm_cb_event_kind_t event_kind,
+//                               chpl_comm_cb_batch_fn_t cb_fn);
+//     void chpl_comm_flush_callbacks(void);
 //
 //
 // DESCRIPTION
@@ -70,6 +87,29 @@ extern "C" {
 //   information sets depending only on the chpl_comm_cb_event_kind_t
 //   value.
 //
+//   A filtered callback is only called for events that pass its filter,
+//   of type chpl_comm_cb_filter_t below: those moving at least
+//   'min_size' bytes (the size of a put or get, the whole of a strided
+//   one, or the argument of an executeOn), whose remote node is in
+//   [node_lo, node_hi], and then only one of every 'sample_every' such
+//   events on each thread.  The runtime checks the filters before it
+//   even builds the event information, so events no callback wants cost
+//   very little.  CHPL_COMM_CB_FILTER_INIT is a filter that passes
+//   everything.  A NULL filter does too.
+//
+//   A batched callback receives arrays of events, of type:
+//
+//     typedef void (*chpl_comm_cb_batch_fn_t)(const chpl_comm_cb_info_t* infos,
+//                                             int num_infos);
+//
+//   Each thread collects up to 'batch_len' events before delivering
+//   them.  Batched events are copies, so the pointers that only live as
+//   long as the event itself (the strides and counts of strided events)
+//   are NULL in them.  Events still being collected are delivered by
+//   chpl_comm_flush_callbacks() and when the callback is uninstalled.
+//   Batched callbacks are installed and uninstalled separately from
+//   unbatched ones, and are removed with chpl_comm_uninstall_batch_callback.
+//
 //
 // RETURN VALUE
 //
@@ -83,10 +123,13 @@ extern "C" {
 //
 //     ENOMEM:  No room to install another callback function for this
 //              event.  At present there is a static limit of 10 installed
-//              callback functions for each event.
+//              callback functions for each event, and of 8 batched
+//              callback functions in all.
 //     ERANGE:  The specified 'kind' is too large.
+//     EINVAL:  The batch length is less than 1.
 //
-//   The following errors can occur with chpl_comm_uninstall_callback():
+//   The following errors can occur with chpl_comm_uninstall_callback()
+//   and chpl_comm_uninstall_batch_callback():
 //
 //     ENOENT:  The given pointer was not found in the list of installed
 //              callback functions for the given event.
@@ -169,11 +212,31 @@ typedef struct {
 } chpl_comm_cb_info_t;
 
 typedef void (*chpl_comm_cb_fn_t)(const chpl_comm_cb_info_t*);
+typedef void (*chpl_comm_cb_batch_fn_t)(const chpl_comm_cb_info_t*, int);
+
+typedef struct {
+  size_t min_size;          // skip events moving fewer bytes than this
+  c_nodeid_t node_lo;       // skip events whose remote node is
+  c_nodeid_t node_hi;       //   outside [node_lo, node_hi]
+  uint32_t sample_every;    // deliver 1 of every N events that pass (0: all)
+} chpl_comm_cb_filter_t;
+
+#define CHPL_COMM_CB_FILTER_INIT { 0, 0, INT32_MAX, 1 }
 
 int chpl_comm_install_callback(chpl_comm_cb_event_kind_t,
                                chpl_comm_cb_fn_t);
 int chpl_comm_uninstall_callback(chpl_comm_cb_event_kind_t,
                                  chpl_comm_cb_fn_t);
+int chpl_comm_install_filtered_callback(chpl_comm_cb_event_kind_t,
+                                        chpl_comm_cb_fn_t,
+                                        const chpl_comm_cb_filter_t*);
+int chpl_comm_install_batch_callback(chpl_comm_cb_event_kind_t,
+                                     chpl_comm_cb_batch_fn_t,
+                                     const chpl_comm_cb_filter_t*,
+                                     int);
+int chpl_comm_uninstall_batch_callback(chpl_comm_cb_event_kind_t,
+                                       chpl_comm_cb_batch_fn_t);
+void chpl_comm_flush_callbacks(void);
 
 #ifdef __cplusplus
 } // end extern "C"
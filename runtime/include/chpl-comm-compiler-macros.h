@@ -24,6 +24,7 @@
 #ifndef LAUNCHER
 
 #include "chpl-comm.h"
+#include "chpl-comm-diags.h" // for call-site latencies
 #include "chpl-mem.h"
 #include "error.h"
 #include "chpl-wide-ptr-fns.h"
@@ -59,7 +60,9 @@ void chpl_gen_comm_get(void *addr, c_nodeid_t node, void* raddr,
     chpl_cache_comm_get(addr, node, raddr, size, commID, ln, fn);
 #endif
   } else {
+    uint64_t start = chpl_comm_diags_callsite_start();
     chpl_comm_get(addr, node, raddr, size, commID, ln, fn);
+    chpl_comm_diags_callsite_end("get", start, ln, fn);
   }
 }
 #ifdef HAS_GPU_LOCALE
@@ -111,6 +114,27 @@ void chpl_gen_comm_prefetch(c_nodeid_t node, void* raddr,
   }
 }
 
+// For loops with the @streamingReads attribute
+static inline
+void chpl_gen_cache_stream_begin(void)
+{
+#ifdef HAS_CHPL_CACHE_FNS
+  if( chpl_cache_enabled() ) {
+    chpl_cache_stream_begin();
+  }
+#endif
+}
+
+static inline
+void chpl_gen_cache_stream_end(void)
+{
+#ifdef HAS_CHPL_CACHE_FNS
+  if( chpl_cache_enabled() ) {
+    chpl_cache_stream_end();
+  }
+#endif
+}
+
 
 static inline
 void chpl_gen_comm_put(void* addr, c_nodeid_t node, void* raddr,
@@ -123,7 +147,9 @@ void chpl_gen_comm_put(void* addr, c_nodeid_t node, void* raddr,
     chpl_cache_comm_put(addr, node, raddr, size, commID, ln, fn);
 #endif
   } else {
+    uint64_t start = chpl_comm_diags_callsite_start();
     chpl_comm_put(addr, node, raddr, size, commID, ln, fn);
+    chpl_comm_diags_callsite_end("put", start, ln, fn);
   }
 }
 #ifdef HAS_GPU_LOCALE
@@ -23,9 +23,12 @@
 
 #include <stdarg.h>
 #include <stdio.h>
+#include <string.h>
+#include <time.h>
 
 #include "chpl-atomics.h"
 #include "chpl-comm.h"
+#include "chpltimers.h"
 #include "error.h"
 
 #ifdef __cplusplus
@@ -48,6 +51,8 @@ extern int chpl_comm_diags_print_unstable;
   MACRO(get_nb) \
   MACRO(put) \
   MACRO(put_nb) \
+  MACRO(get_tiny) \
+  MACRO(put_tiny) \
   MACRO(test_nb) \
   MACRO(wait_nb) \
   MACRO(try_nb) \
@@ -64,7 +69,22 @@ extern int chpl_comm_diags_print_unstable;
   MACRO(cache_prefetch_unused) \
   MACRO(cache_prefetch_waited) \
   MACRO(cache_readahead_unused) \
-  MACRO(cache_readahead_waited)
+  MACRO(cache_readahead_waited) \
+  MACRO(cache_stride_streams) \
+  MACRO(cache_num_stride_prefetches) \
+  MACRO(cache_stride_prefetch_unused) \
+  MACRO(cache_stride_prefetch_waited) \
+  MACRO(cache_shared_hits) \
+  MACRO(cache_shared_misses) \
+  MACRO(cache_put_coalesced) \
+  MACRO(aggr_put) \
+  MACRO(aggr_get) \
+  MACRO(aggr_execute_on) \
+  MACRO(aggr_send) \
+  MACRO(am_handoffs) \
+  MACRO(am_handoff_depth) \
+  MACRO(throttle_waits) \
+  MACRO(throttle_cuts)
 
 typedef struct _chpl_commDiagnostics {
 #define _COMM_DIAGS_DECL(cdv) uint64_t cdv;
@@ -97,12 +117,73 @@ typedef struct _chpl_atomic_commDiagnostics {
 
 extern chpl_atomic_commDiagnostics chpl_comm_diags_counters;
 
+//
+// Per-call-site profiling.  With CHPL_RT_COMM_DIAGS_CALLSITES=true,
+// while comm diagnostics are on each locale also records, for every
+// (file, line, operation), how many remote operations there were and
+// how many bytes they moved.  Blocking GETs and PUTs generated by the
+// compiler also get a log2 latency histogram.  Each thread has its own
+// table; they are merged and printed, busiest call sites first, when
+// diagnostics are stopped on that locale, and at exit on locales that
+// still have anything recorded.
+//
+extern int chpl_comm_diags_callsites;
+
+// Latency bucket b holds times below 2^(b+6) ns; the last is unbounded.
+#define CHPL_COMM_DIAGS_LAT_BUCKETS 24
+
+void chpl_comm_diags_callsite_init(void);
+void chpl_comm_diags_callsite_record(const char*, size_t, int, int32_t);
+void chpl_comm_diags_callsite_latency(const char*, uint64_t, int, int32_t);
+void chpl_comm_diags_callsite_report(void);
+void chpl_comm_diags_callsite_reset(void);
+void chpl_comm_diags_callsite_exit(void);
+
+extern chpl_bool chpl_task_getCommDiagsTemporarilyDisabled(void);
+
+#define chpl_comm_diags_callsite_enabled()                                   \
+  (chpl_comm_diags_callsites && chpl_comm_diagnostics                        \
+   && !chpl_task_getCommDiagsTemporarilyDisabled())
+
+#define chpl_comm_diags_callsite(op, size, ln, fn)                           \
+  do {                                                                       \
+    if (chpl_comm_diags_callsite_enabled()) {                                \
+      chpl_comm_diags_callsite_record(op, size, ln, fn);                     \
+    }                                                                        \
+  } while(0)
+
+//
+// Bracket a blocking operation to time it.  The start returns 0 when
+// call-site profiling is off, and the end then does nothing.
+//
+static inline
+uint64_t chpl_comm_diags_callsite_start(void) {
+  if (!chpl_comm_diags_callsite_enabled()) {
+    return 0;
+  }
+  // Raw ticks are never 0, so they can't be mistaken for "off".
+  return chpl_fast_timer_ticks();
+}
+
+static inline
+void chpl_comm_diags_callsite_end(const char* op, uint64_t start,
+                                  int ln, int32_t fn) {
+  if (start == 0) {
+    return;
+  }
+  chpl_comm_diags_callsite_latency(op,
+                                   chpl_fast_timer_ticks_to_ns(
+                                     chpl_fast_timer_ticks() - start),
+                                   ln, fn);
+}
+
 static inline
 void chpl_comm_diags_init(void) {
 #define _COMM_DIAGS_INIT(cdv) \
         atomic_init_uint_least64_t(&chpl_comm_diags_counters.cdv, 0);
   CHPL_COMM_DIAGS_VARS_ALL(_COMM_DIAGS_INIT);
 #undef _COMM_DIAGS_INIT
+  chpl_comm_diags_callsite_init();
 }
 
 static inline
@@ -111,6 +192,7 @@ void chpl_comm_diags_reset(void) {
         atomic_store_uint_least64_t(&chpl_comm_diags_counters.cdv, 0);
  CHPL_COMM_DIAGS_VARS_ALL(_COMM_DIAGS_RESET);
 #undef _COMM_DIAGS_RESET
+  chpl_comm_diags_callsite_reset();
 }
 
 static inline
@@ -122,7 +204,6 @@ void chpl_comm_diags_copy(chpl_commDiagnostics* cd) {
 }
 
 extern chpl_bool chpl_task_setCommDiagsTemporarilyDisabled(chpl_bool);
-extern chpl_bool chpl_task_getCommDiagsTemporarilyDisabled(void);
 
 #define chpl_comm_diags_verbose_printf(is_unstable, format, ...)   \
   do {                                                             \
@@ -143,32 +224,46 @@ extern chpl_bool chpl_task_getCommDiagsTemporarilyDisabled(void);
   } while(0)
 
 #define chpl_comm_diags_verbose_rdma(op, node, size, ln, fn, commid)     \
-  chpl_comm_diags_verbose_printf(false,                                  \
-                                 "%s:%d: remote %s, node %d, %zu bytes, " \
-                                 "commid %d",                            \
-                                 chpl_lookupFilename(fn), ln, op,        \
-                                 (int) node, size, (int) commid)
+  do {                                                                   \
+    chpl_comm_diags_verbose_printf(false,                                \
+                                   "%s:%d: remote %s, node %d, %zu bytes, " \
+                                   "commid %d",                          \
+                                   chpl_lookupFilename(fn), ln, op,      \
+                                   (int) node, size, (int) commid);      \
+    chpl_comm_diags_callsite(op, size, ln, fn);                          \
+  } while(0)
 
 #define chpl_comm_diags_verbose_rdmaStrd(op, node, ln, fn, commid)      \
-  chpl_comm_diags_verbose_printf(false,                                 \
-                                 "%s:%d: remote strided %s, node %d, "  \
-                                 "commid %d",                           \
-                                 chpl_lookupFilename(fn), ln, op,       \
-                                 (int) node, (int) commid)
+  do {                                                                  \
+    chpl_comm_diags_verbose_printf(false,                               \
+                                   "%s:%d: remote strided %s, node %d, " \
+                                   "commid %d",                         \
+                                   chpl_lookupFilename(fn), ln, op,     \
+                                   (int) node, (int) commid);           \
+    chpl_comm_diags_callsite("strided " op, 0, ln, fn);                 \
+  } while(0)
 
 #define chpl_comm_diags_verbose_amo(op, node, ln, fn)                   \
-  chpl_comm_diags_verbose_printf(true,                                  \
-                                 "%s:%d: remote %s, node %d",           \
-                                 chpl_lookupFilename(fn), ln, op,       \
-                                 (int) node)
+  do {                                                                  \
+    chpl_comm_diags_verbose_printf(true,                                \
+                                   "%s:%d: remote %s, node %d",         \
+                                   chpl_lookupFilename(fn), ln, op,     \
+                                   (int) node);                         \
+    chpl_comm_diags_callsite(op, 0, ln, fn);                            \
+  } while(0)
 
 #define chpl_comm_diags_verbose_executeOn(kind, node, ln, fn)           \
-  chpl_comm_diags_verbose_printf(false,                                 \
-                                 "%s:%d: remote %-*sexecuteOn, node %d", \
-                                 chpl_lookupFilename(fn), ln,           \
-                                 ((int) strlen(kind)                    \
-                                  + ((strlen(kind) == 0) ? 0 : 1)),     \
-                                 kind, (int) node)
+  do {                                                                  \
+    chpl_comm_diags_verbose_printf(false,                               \
+                                   "%s:%d: remote %-*sexecuteOn, node %d", \
+                                   chpl_lookupFilename(fn), ln,         \
+                                   ((int) strlen(kind)                  \
+                                    + ((strlen(kind) == 0) ? 0 : 1)),   \
+                                   kind, (int) node);                   \
+    chpl_comm_diags_callsite((kind)[0] == '\0'                          \
+                             ? "executeOn" : kind " executeOn",         \
+                             0, ln, fn);                                \
+  } while(0)
 
 #define chpl_comm_diags_incr(_ctr)                                           \
   do {                                                                       \
@@ -180,6 +275,20 @@ extern chpl_bool chpl_task_getCommDiagsTemporarilyDisabled(void);
     }                                                                        \
   } while(0)
 
+//
+// Like chpl_comm_diags_incr(), but for comm layer helper threads such
+// as AM handlers, which are not tasks and so have no per-task setting
+// for temporarily disabling diagnostics.
+//
+#define chpl_comm_diags_add_nontask(_ctr, _n)                                \
+  do {                                                                       \
+    if (chpl_comm_diagnostics) {                                             \
+      atomic_uint_least64_t* ctrAddr = &chpl_comm_diags_counters._ctr;       \
+      (void) atomic_fetch_add_explicit_uint_least64_t(ctrAddr, (_n),         \
+                                                      memory_order_relaxed); \
+    }                                                                        \
+  } while(0)
+
 #ifdef __cplusplus
 }
 #endif
@@ -29,16 +29,6 @@
 extern "C" {
 #endif
 
-//
-// Support for broadcasting globals.  Comm layer implementations must
-// supply this.  It is called collectively.  On node 0 it must arrange
-// that all the global variable wide pointers are in a buffer that can
-// be the source of a GET from the other nodes and return either that
-// buffer's address (if it wants it freed later) or NULL.  On all other
-// nodes it should return the node-0 local address of that buffer.
-//
-wide_ptr_t* chpl_comm_broadcast_global_vars_helper(void);
-
 //
 // These are runtime-private copies of chpl_private_broadcast_table[]
 // and chpl_private_broadcast_table_len, extended with a few more
@@ -58,7 +48,8 @@ extern size_t chpl_rt_priv_bcast_lens[];
   MACRO(chpl_gpu_diagnostics)               \
   MACRO(chpl_gpu_diags_print_unstable)      \
   MACRO(chpl_verbose_gpu_stacktrace)        \
-  MACRO(chpl_verbose_mem)
+  MACRO(chpl_verbose_mem)                    \
+  MACRO(chpl_comm_coll_mboxMap_0)
 
 #define _RT_PRV_BCAST_M(sym)  chpl_rt_prv_tab_ ## sym ## _idx,
 typedef enum {
@@ -68,10 +59,23 @@ typedef enum {
 #undef _RT_PRV_BCAST_M
 
 //
-// This is in chpl-comm.c.
+// These are in chpl-comm.c.
 //
 void chpl_comm_init_prv_bcast_tab(void);
 
+// Where node 0 collects the collectives' mailbox addresses.
+extern void* chpl_comm_coll_mboxMap_0;
+
+//
+// Comm layers with an out-of-band allgather can call this during
+// startup, on the initializing thread, to set up the generic
+// collectives' mailboxes.  Otherwise their addresses are gathered on
+// node 0 at the first collective.  The allgather's arguments are this
+// node's data, the buffer for all of it, and the per-node size.
+//
+typedef void (*chpl_comm_oob_allgather_t)(const void*, void*, size_t);
+void chpl_comm_coll_init_oob(chpl_comm_oob_allgather_t allgather);
+
 //
 // Broadcast one of our runtime-specific variables.
 //
@@ -19,6 +19,7 @@
  */
 #include "chpltypes.h"
 #include "chpl-atomics.h"
+#include "chpl-comm-task-decls.h"
 
 #ifndef _chpl_comm_native_atomics_h_
 #define _chpl_comm_native_atomics_h_
@@ -121,6 +122,11 @@ DECL_CHPL_COMM_ATOMIC_CMPXCHG(real64)
 // value the target had prior to the operation is returned in *result on
 // the local node.
 //
+// The fetching style also has a non-blocking form, which returns a
+// handle for chpl_comm_{test_nb_complete,wait_nb_some,try_nb_some}().
+// Its *result is not valid, and must not be touched, until the handle
+// has been seen to complete.  The operand is consumed by the call.
+//
 // We support AND, OR, and XOR for various int types, and ADD and SUB
 // for both int and real types.
 //
@@ -136,10 +142,15 @@ DECL_CHPL_COMM_ATOMIC_CMPXCHG(real64)
   void chpl_comm_atomic_fetch_ ## op ## _ ## type                       \
          (void* operand, c_nodeid_t node, void* object, void* result,   \
           memory_order order, int ln, int32_t fn);
+#define DECL_CHPL_COMM_ATOMIC_FETCH_NB_BINARY(op, type)                 \
+  chpl_comm_nb_handle_t chpl_comm_atomic_fetch_ ## op ## _nb_ ## type   \
+         (void* operand, c_nodeid_t node, void* object, void* result,   \
+          memory_order order, int ln, int32_t fn);
 #define DECL_CHPL_COMM_ATOMIC_BINARY(op, type)                          \
   DECL_CHPL_COMM_ATOMIC_NONFETCH_BINARY(op, type)                       \
   DECL_CHPL_COMM_ATOMIC_NONFETCH_UNORDERED_BINARY(op, type)             \
-  DECL_CHPL_COMM_ATOMIC_FETCH_BINARY(op, type)
+  DECL_CHPL_COMM_ATOMIC_FETCH_BINARY(op, type)                          \
+  DECL_CHPL_COMM_ATOMIC_FETCH_NB_BINARY(op, type)
 
 DECL_CHPL_COMM_ATOMIC_BINARY(and, int32)
 DECL_CHPL_COMM_ATOMIC_BINARY(and, int64)
@@ -134,7 +134,9 @@ void put_strd_common(void* dstaddr_arg, size_t* dststrides, int32_t dstlocale,
   size_t currHandles = 0;
 
   // Communications callback support
-  if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_put_strd)) {
+  if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_put_strd)
+      && chpl_comm_want_callbacks(chpl_comm_cb_event_kind_put_strd, dstlocale,
+          chpl_comm_cb_strd_size(count, stridelevels, elemSize))) {
       chpl_comm_cb_info_t cb_data =
         {chpl_comm_cb_event_kind_put_strd, chpl_nodeID, dstlocale,
          .iu.comm_strd={srcaddr_arg, srcstrides, dstaddr_arg, dststrides, count,
@@ -280,7 +282,9 @@ void get_strd_common(void* dstaddr_arg, size_t* dststrides, int32_t srclocale,
 
 
   // Communications callback support
-  if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_get_strd)) {
+  if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_get_strd)
+      && chpl_comm_want_callbacks(chpl_comm_cb_event_kind_get_strd, srclocale,
+          chpl_comm_cb_strd_size(count, stridelevels, elemSize))) {
     chpl_comm_cb_info_t cb_data =
       {chpl_comm_cb_event_kind_get_strd, chpl_nodeID, srclocale,
        .iu.comm_strd={srcaddr_arg, srcstrides, dstaddr_arg, dststrides, count,
@@ -254,8 +254,11 @@ void chpl_comm_rollcall(void);
 //
 // chpl_comm_regMemHeapTouch():
 //   For configurations that use a static/fixed heap, this attempts to
-//   touch the heap in an interleaved and parallel manner to improve
-//   NUMA affinity and speed up faulting in the memory.
+//   touch the heap in parallel, from threads on every NUMA domain, to
+//   improve NUMA affinity and speed up faulting in the memory.  The
+//   heap is interleaved across the domains, or with
+//   CHPL_RT_COMM_HEAP_PLACEMENT=sublocale split into a block per
+//   domain; "none" skips this.
 //
 // chpl_comm_regMemAllocThreshold():
 //   Allocations smaller than this should be done normally, by the
@@ -353,6 +356,39 @@ chpl_bool chpl_comm_regMemFree(void* p, size_t size) {
   return CHPL_COMM_IMPL_REG_MEM_FREE(p, size);
 }
 
+//
+// GPU memory the network can access directly.
+//
+// chpl_comm_regMemDevice()
+//   Ask the comm layer to be able to use [p, p+size), a whole device
+//   allocation on GPU sublocale subloc, as the local side of
+//   chpl_comm_put(), chpl_comm_get() and their strided forms to other
+//   nodes, with the network reading or writing the GPU memory itself.
+//   Returns true if it can, in which case the memory stays registered
+//   until chpl_comm_regMemDeviceFree().  The remote side of such
+//   transfers still has to be host memory.  Idempotent.
+//
+// chpl_comm_regMemDeviceFree()
+//   Drop any registrations within [p, p+size).  Must be called before
+//   device memory that may have been passed to chpl_comm_regMemDevice()
+//   is freed.
+//
+#ifndef CHPL_COMM_IMPL_REG_MEM_DEVICE
+#define CHPL_COMM_IMPL_REG_MEM_DEVICE(p, size, subloc) false
+#endif
+static inline
+chpl_bool chpl_comm_regMemDevice(void* p, size_t size, c_sublocid_t subloc) {
+  return CHPL_COMM_IMPL_REG_MEM_DEVICE(p, size, subloc);
+}
+
+#ifndef CHPL_COMM_IMPL_REG_MEM_DEVICE_FREE
+#define CHPL_COMM_IMPL_REG_MEM_DEVICE_FREE(p, size) return
+#endif
+static inline
+void chpl_comm_regMemDeviceFree(void* p, size_t size) {
+  CHPL_COMM_IMPL_REG_MEM_DEVICE_FREE(p, size);
+}
+
 //
 // These routines are used by the Chapel runtime to broadcast the
 // locations of module-level ("global") variables to all locales
@@ -427,6 +463,164 @@ static inline void chpl_comm_barrier(const char *msg) {
   chpl_comm_impl_barrier(msg);
 }
 
+//
+// Split-phase barrier.  chpl_comm_barrier_begin() says this locale has
+// reached the barrier and returns without waiting for the others.
+// chpl_comm_barrier_test() returns true once all the locales have
+// reached it, and chpl_comm_barrier_wait() waits for that, yielding as
+// chpl_comm_barrier() does.  In between, the caller can do local work.
+// A locale can only have one barrier in progress: after begin() it
+// must see test() return true, or call wait(), before starting another
+// barrier of either kind.  These may not be used before
+// chpl_comm_post_task_init().
+//
+void chpl_comm_impl_barrier_begin(const char *msg);
+chpl_bool chpl_comm_impl_barrier_test(void);
+void chpl_comm_impl_barrier_wait(void);
+
+static inline void chpl_comm_barrier_begin(const char *msg) {
+
+#ifdef CHPL_COMM_DEBUG
+  chpl_msg(2, "%d: begin barrier for '%s'\n", chpl_nodeID, msg);
+#endif
+
+  if (chpl_numNodes == 1) {
+    return;
+  }
+
+  chpl_rmem_consist_fence(memory_order_seq_cst, 0, 0);
+  chpl_comm_impl_barrier_begin(msg);
+}
+
+static inline chpl_bool chpl_comm_barrier_test(void) {
+  return chpl_numNodes == 1 || chpl_comm_impl_barrier_test();
+}
+
+static inline void chpl_comm_barrier_wait(void) {
+  if (chpl_numNodes == 1) {
+    return;
+  }
+
+  chpl_comm_impl_barrier_wait();
+}
+
+//
+// Collectives over all top-level locales.  Every locale must call the
+// same collectives in the same order, with the same root, size, count,
+// type and op arguments, and only one task per locale may be in a
+// collective at a time.  Like chpl_comm_barrier(), these may be called
+// from a Chapel task and yield while they wait.  They may not be
+// called before chpl_comm_post_task_init().
+//
+//   chpl_comm_bcast():     copy size bytes at buf on root to buf on the
+//                          other locales.
+//   chpl_comm_reduce():    combine count elements at src on every
+//                          locale, element-wise, into dst on root.  dst
+//                          is not used on the other locales.
+//   chpl_comm_allreduce(): same, but into dst on every locale.
+//   chpl_comm_allgather(): concatenate the size bytes at src on every
+//                          locale, in locale order, into the
+//                          chpl_numNodes*size bytes at dst everywhere.
+//
+// For the reductions src and dst may be the same.  The bitwise ops only
+// apply to the integral types.  Every locale gets bitwise-identical
+// allreduce results, including for the real types.
+//
+typedef enum {
+  CHPL_COMM_COLL_INT32,
+  CHPL_COMM_COLL_INT64,
+  CHPL_COMM_COLL_UINT32,
+  CHPL_COMM_COLL_UINT64,
+  CHPL_COMM_COLL_REAL32,
+  CHPL_COMM_COLL_REAL64,
+} chpl_comm_coll_type_t;
+
+typedef enum {
+  CHPL_COMM_COLL_SUM,
+  CHPL_COMM_COLL_MIN,
+  CHPL_COMM_COLL_MAX,
+  CHPL_COMM_COLL_BAND,
+  CHPL_COMM_COLL_BOR,
+  CHPL_COMM_COLL_BXOR,
+} chpl_comm_coll_op_t;
+
+//
+// Comm layers with native collectives can supply them by defining
+// CHPL_COMM_IMPL_BCAST() etc.  Otherwise we use the versions in
+// chpl-comm.c, which are built on chpl_comm_put() and use
+// dissemination and recursive-doubling algorithms, taking
+// ceil(log2(chpl_numNodes)) steps.
+//
+void chpl_comm_coll_bcast_generic(c_nodeid_t root, void* buf, size_t size);
+void chpl_comm_coll_reduce_generic(c_nodeid_t root, const void* src,
+                                   void* dst, size_t count,
+                                   chpl_comm_coll_type_t type,
+                                   chpl_comm_coll_op_t op);
+void chpl_comm_coll_allreduce_generic(const void* src, void* dst,
+                                      size_t count,
+                                      chpl_comm_coll_type_t type,
+                                      chpl_comm_coll_op_t op);
+void chpl_comm_coll_allgather_generic(const void* src, void* dst,
+                                      size_t size);
+
+#ifndef CHPL_COMM_IMPL_BCAST
+#define CHPL_COMM_IMPL_BCAST(root, buf, size) \
+        chpl_comm_coll_bcast_generic(root, buf, size)
+#endif
+static inline
+void chpl_comm_bcast(c_nodeid_t root, void* buf, size_t size) {
+  chpl_rmem_consist_fence(memory_order_seq_cst, 0, 0);
+  CHPL_COMM_IMPL_BCAST(root, buf, size);
+}
+
+#ifndef CHPL_COMM_IMPL_REDUCE
+#define CHPL_COMM_IMPL_REDUCE(root, src, dst, count, type, op) \
+        chpl_comm_coll_reduce_generic(root, src, dst, count, type, op)
+#endif
+static inline
+void chpl_comm_reduce(c_nodeid_t root, const void* src, void* dst,
+                      size_t count, chpl_comm_coll_type_t type,
+                      chpl_comm_coll_op_t op) {
+  chpl_rmem_consist_fence(memory_order_seq_cst, 0, 0);
+  CHPL_COMM_IMPL_REDUCE(root, src, dst, count, type, op);
+}
+
+#ifndef CHPL_COMM_IMPL_ALLREDUCE
+#define CHPL_COMM_IMPL_ALLREDUCE(src, dst, count, type, op) \
+        chpl_comm_coll_allreduce_generic(src, dst, count, type, op)
+#endif
+static inline
+void chpl_comm_allreduce(const void* src, void* dst, size_t count,
+                         chpl_comm_coll_type_t type, chpl_comm_coll_op_t op) {
+  chpl_rmem_consist_fence(memory_order_seq_cst, 0, 0);
+  CHPL_COMM_IMPL_ALLREDUCE(src, dst, count, type, op);
+}
+
+#ifndef CHPL_COMM_IMPL_ALLGATHER
+#define CHPL_COMM_IMPL_ALLGATHER(src, dst, size) \
+        chpl_comm_coll_allgather_generic(src, dst, size)
+#endif
+static inline
+void chpl_comm_allgather(const void* src, void* dst, size_t size) {
+  chpl_rmem_consist_fence(memory_order_seq_cst, 0, 0);
+  CHPL_COMM_IMPL_ALLGATHER(src, dst, size);
+}
+
+//
+// The generic collectives PUT data and then a flag saying it has
+// arrived.  Comm layers whose PUTs to a node can become visible out of
+// order must make the effects of this task's earlier PUTs visible
+// here, before the flag is sent.
+//
+#ifndef CHPL_COMM_IMPL_PUT_FENCE
+#define CHPL_COMM_IMPL_PUT_FENCE() \
+        return
+#endif
+static inline
+void chpl_comm_put_fence(void) {
+  CHPL_COMM_IMPL_PUT_FENCE();
+}
+
 //
 // Do exit processing that has to occur before the tasking layer is
 // shut down.  "The "all" parameter is true for normal, collective
@@ -497,6 +691,28 @@ void chpl_comm_get_strd(void* dstaddr, size_t* dststrides, c_nodeid_t srcnode,
                         int32_t stridelevels, size_t elemSize, int32_t commID,
                         int ln, int32_t fn);
 
+//
+// Non-blocking versions of chpl_comm_put_strd() and chpl_comm_get_strd().
+// These return a handle usable with chpl_comm_{test,wait,try}_nb_*(), so
+// several strided transfers can be in flight at once.  As for
+// chpl_comm_put_nb() and chpl_comm_get_nb(), neither the source nor the
+// destination may be touched until the handle is complete.  The stride and
+// count arrays need not outlive the call.
+//
+chpl_comm_nb_handle_t chpl_comm_put_strd_nb(void* dstaddr, size_t* dststrides,
+                                            c_nodeid_t dstnode,
+                                            void* srcaddr, size_t* srcstrides,
+                                            size_t* count, int32_t stridelevels,
+                                            size_t elemSize, int32_t commID,
+                                            int ln, int32_t fn);
+
+chpl_comm_nb_handle_t chpl_comm_get_strd_nb(void* dstaddr, size_t* dststrides,
+                                            c_nodeid_t srcnode,
+                                            void* srcaddr, size_t* srcstrides,
+                                            size_t* count, int32_t stridelevels,
+                                            size_t elemSize, int32_t commID,
+                                            int ln, int32_t fn);
+
 
 //
 // Unordered ops
@@ -547,6 +763,132 @@ void chpl_comm_execute_on_fast(c_nodeid_t node, c_sublocid_t subloc,
                                chpl_comm_on_bundle_t *arg, size_t arg_size,
                                int ln, int32_t fn);
 
+//
+// Aggregated communication (implemented in chpl-comm.c)
+//
+// These buffer small PUTs, GETs, and executeOns per task and per
+// destination node and send them in bulk, on top of the nonblocking
+// interface above, so they work the same with any comm layer.  They are
+// unordered with respect to each other and to other communication.
+//
+// The source of an aggregated PUT and the record passed to an
+// aggregated executeOn can be reused as soon as the call returns.  The
+// target of an aggregated GET is not valid, and an aggregated PUT is
+// not guaranteed to be visible, until the task calls
+// chpl_comm_aggr_flush().  An aggregated executeOn is started no later
+// than the flush; as with chpl_comm_execute_on_nb(), knowing when it
+// has finished is up to the caller.
+//
+// A buffer is sent when it fills up (CHPL_RT_COMM_AGGR_BUFF_SIZE bytes)
+// and the task's buffers are all sent if the oldest thing in them has
+// waited longer than CHPL_RT_COMM_AGGR_FLUSH_USECS.  Each destination
+// has two buffers of each kind, so one can be filled while the other
+// is in flight.
+//
+// For chpl_comm_aggr_execute_on(), consecutive records for the same
+// node, sublocale, and fid are packed into the payload of a single
+// executeOn bundle.  The function 'fid' is passed that bundle and
+// should walk the records in it with chpl_comm_aggr_bundle_next().
+//
+void chpl_comm_aggr_put(void* addr, c_nodeid_t node, void* raddr,
+                        size_t size, int32_t commID, int ln, int32_t fn);
+
+void chpl_comm_aggr_get(void* addr, c_nodeid_t node, void* raddr,
+                        size_t size, int32_t commID, int ln, int32_t fn);
+
+void chpl_comm_aggr_execute_on(c_nodeid_t node, c_sublocid_t subloc,
+                               chpl_fn_int_t fid,
+                               void* rec, size_t rec_size,
+                               int ln, int32_t fn);
+
+// Send everything this task has buffered and wait for the PUTs and GETs
+// to complete.  This also releases the task's aggregation buffers.
+void chpl_comm_aggr_flush(void);
+
+//
+// Return the next record in an aggregated executeOn bundle, or NULL if
+// there are no more.  '*pos' should be 0 on the first call.
+//
+static inline
+void* chpl_comm_aggr_bundle_next(chpl_comm_on_bundle_t* arg,
+                                 size_t* pos, size_t* rec_size) {
+  char* payload = (char*) arg->payload;
+  uint64_t len = *(uint64_t*) payload;  // total payload bytes
+  if (*pos == 0) {
+    *pos = sizeof(uint64_t);
+  }
+  if (*pos >= len) {
+    return NULL;
+  }
+  *rec_size = *(uint64_t*) (payload + *pos);
+  void* rec = payload + *pos + sizeof(uint64_t);
+  *pos += sizeof(uint64_t) + ((*rec_size + 7) & ~(size_t) 7);
+  return rec;
+}
+
+//
+// Asynchronous executeOn (implemented in chpl-comm.c)
+//
+// chpl_comm_execute_on_async() runs a function on a remote locale like
+// chpl_comm_execute_on() does, but returns as soon as the call has been
+// started, with a handle the caller later tests or waits on.  A task
+// can thus have many of them in flight at once.  arg can be reused as
+// soon as the call returns.  As with chpl_comm_execute_on(), 'node'
+// must not be the calling node.
+//
+// The payload of the bundle must start with a chpl_comm_on_reply_t,
+// which the runtime fills in.  The remote function can use it to send
+// back up to CHPL_COMM_ON_ASYNC_MAX_RESULT bytes with
+// chpl_comm_on_reply(), which must happen before it returns.
+//
+// chpl_comm_test_on_complete() returns nonzero iff the call has
+// finished.  chpl_comm_wait_on_some() waits until at least one of the
+// non-NULL handles it is given has finished and returns the index of
+// one that has.  chpl_comm_finish_on() waits for the call if need be,
+// copies its result (if any, and at most 'size' bytes) to 'result',
+// releases the handle, and returns the size of the result.
+//
+#define CHPL_COMM_ON_ASYNC_MAX_RESULT 64
+
+typedef struct chpl_comm_on_handle_s* chpl_comm_on_handle_t;
+
+typedef struct {
+  c_nodeid_t node;              // where the result goes
+  void* result;
+} chpl_comm_on_reply_t;
+
+chpl_comm_on_handle_t chpl_comm_execute_on_async(c_nodeid_t node,
+                                                 c_sublocid_t subloc,
+                                                 chpl_fn_int_t fid,
+                                                 chpl_comm_on_bundle_t *arg,
+                                                 size_t arg_size,
+                                                 int ln, int32_t fn);
+
+int chpl_comm_test_on_complete(chpl_comm_on_handle_t h);
+
+size_t chpl_comm_wait_on_some(chpl_comm_on_handle_t* h, size_t nhandles);
+
+size_t chpl_comm_finish_on(chpl_comm_on_handle_t h,
+                           void* result, size_t size);
+
+void chpl_comm_on_reply(chpl_comm_on_bundle_t* arg,
+                        const void* val, size_t size,
+                        int ln, int32_t fn);
+
+//
+// Does chpl_comm_put_unordered() buffer PUTs so that they are sent
+// together (as one vectored operation) at the next
+// chpl_comm_getput_unordered_task_fence()? The remote cache uses this to
+// decide whether or not to write back many small dirty regions that way.
+//
+#ifndef CHPL_COMM_IMPL_BUFFERED_UNORDERED_PUT
+#define CHPL_COMM_IMPL_BUFFERED_UNORDERED_PUT() false
+#endif
+static inline
+chpl_bool chpl_comm_buffered_unordered_put(void) {
+  return CHPL_COMM_IMPL_BUFFERED_UNORDERED_PUT();
+}
+
 //
 // Hook to ensure remote memory consistency after unordered operations.
 //
@@ -577,8 +919,10 @@ void chpl_comm_task_create(void) {
 #define CHPL_COMM_IMPL_TASK_END() \
         return
 #endif
+void chpl_comm_aggr_task_end(void);
 static inline
 void chpl_comm_task_end(void) {
+  chpl_comm_aggr_task_end();
   CHPL_COMM_IMPL_TASK_END();
 }
 
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2020-2023 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _CHPL_FILE_WALK_H_
+#define _CHPL_FILE_WALK_H_
+
+#include "qio_error.h"
+#include "sys_basic.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// What chpl_fs_walk reports and how it descends.
+#define CHPL_FS_WALK_DIRS          0x01 // report directories (starting with root)
+#define CHPL_FS_WALK_FILES         0x02 // report everything that isn't a directory
+#define CHPL_FS_WALK_HIDDEN        0x04 // don't skip names starting with '.'
+#define CHPL_FS_WALK_FOLLOW_LINKS  0x08 // descend into symbolic links to
+                                        // directories (cycles aren't detected)
+#define CHPL_FS_WALK_SORT          0x10 // sort the result by path
+
+// The paths found by chpl_fs_walk, in no particular order unless
+// CHPL_FS_WALK_SORT was given.
+typedef struct chpl_fs_walk_s {
+  char** paths;
+  uint8_t* is_dir;
+  size_t num;
+} chpl_fs_walk_t;
+
+// Walks the directory tree under 'root' with 'nworkers' threads
+// (or one per online CPU for nworkers <= 0), which share directories
+// by work stealing. If 'pattern' is not NULL, only entries whose names
+// match it (as with fnmatch) are reported, but every directory is still
+// searched. On success, 'ret' must be freed with chpl_fs_walk_free.
+qioerr chpl_fs_walk(const char* root, const char* pattern, int flags,
+                    int nworkers, chpl_fs_walk_t* ret);
+
+void chpl_fs_walk_free(chpl_fs_walk_t* w);
+
+static inline
+size_t chpl_fs_walk_num(const chpl_fs_walk_t w) {
+  return w.num;
+}
+
+static inline
+const char* chpl_fs_walk_index(const chpl_fs_walk_t w, size_t i) {
+  return w.paths[i];
+}
+
+static inline
+int chpl_fs_walk_is_dir(const chpl_fs_walk_t w, size_t i) {
+  return w.is_dir[i];
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
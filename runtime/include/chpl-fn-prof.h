@@ -0,0 +1,91 @@
+/*
+ * Copyright 2020-2023 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Sampling profiler for Chapel functions.
+//
+// A program compiled with --profile-functions calls chpl_fn_prof_enter()
+// and chpl_fn_prof_exit() around the body of each user function, which
+// keeps a shadow stack of Chapel functions per thread.  Setting
+// CHPL_RT_FUNCTION_PROFILE=<dir> at execution time starts a SIGPROF timer
+// (CHPL_RT_FUNCTION_PROFILE_HZ samples per CPU second, default 1000) whose
+// handler charges one sample to the function on top of the interrupted
+// thread's shadow stack and to each distinct function below it.  At exit
+// each locale writes <dir>/fnprof-<nodeID>; tools/chpl-fn-prof merges
+// them.
+//
+// Functions are identified by their position in chpl_funSymTable, the
+// table the stack unwinder uses.  The shadow stack belongs to the thread,
+// so a task that is suspended and resumed elsewhere can leave another
+// task's samples charged to its functions for a while.
+//
+
+#ifndef _chpl_fn_prof_h_
+#define _chpl_fn_prof_h_
+
+#include <stdint.h>
+#include "chpltypes.h"
+#include "chpl-thread-local-storage.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void chpl_fn_prof_init(void);
+void chpl_fn_prof_finalize(void);
+
+#define CHPL_FN_PROF_MAX_DEPTH 128
+
+// The fields are volatile so that the signal handler, which runs on the
+// same thread, sees the frames in the order they were pushed.
+typedef struct {
+  volatile int32_t depth;
+  volatile int32_t fns[CHPL_FN_PROF_MAX_DEPTH];
+} chpl_fn_prof_stack_t;
+
+#ifdef CHPL_TLS
+extern CHPL_TLS chpl_fn_prof_stack_t chpl_fn_prof_stack;
+
+static inline void chpl_fn_prof_enter(int32_t fn) {
+  int32_t depth = chpl_fn_prof_stack.depth;
+  if (depth < CHPL_FN_PROF_MAX_DEPTH) {
+    chpl_fn_prof_stack.fns[depth] = fn;
+  }
+  chpl_fn_prof_stack.depth = depth + 1;
+}
+
+static inline void chpl_fn_prof_exit(void) {
+  int32_t depth = chpl_fn_prof_stack.depth;
+  if (depth > 0) {
+    chpl_fn_prof_stack.depth = depth - 1;
+  }
+}
+#else
+// Without compiler-supported thread-local storage there is no cheap way
+// to keep the shadow stack, so profiling is not supported.
+static inline void chpl_fn_prof_enter(int32_t fn) { }
+static inline void chpl_fn_prof_exit(void) { }
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _chpl_fn_prof_h_
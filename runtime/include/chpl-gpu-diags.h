@@ -46,7 +46,14 @@ extern int chpl_gpu_diags_print_unstable;
   MACRO(kernel_launch) \
   MACRO(host_to_device) \
   MACRO(device_to_host) \
-  MACRO(device_to_device)
+  MACRO(device_to_device) \
+  MACRO(mem_pool_hit) \
+  MACRO(mem_pool_miss) \
+  MACRO(mem_pool_release) \
+  MACRO(mem_prefetch) \
+  MACRO(mem_advise) \
+  MACRO(mem_alloc_coarse) \
+  MACRO(mem_alloc_fine)
 
 
 typedef struct _chpl_gpuDiagnostics {
@@ -39,8 +39,14 @@ void chpl_gpu_impl_launch_kernel_flat(int ln, int32_t fn,
                                  void* stream,
                                  int nargs, va_list args);
 
+// The block size at which the kernel reaches its highest occupancy on the
+// current device, or 0 if that can't be determined.
+int chpl_gpu_impl_max_potential_block_size(const char* name);
+
 void* chpl_gpu_impl_mem_alloc(size_t size);
-void* chpl_gpu_impl_mem_array_alloc(size_t size);
+// CHPL_GPU_MEM_POLICY_DEFAULT asks for what the vendor allocator gives.
+void* chpl_gpu_impl_mem_array_alloc(size_t size,
+                                    chpl_gpu_mem_policy_t policy);
 void chpl_gpu_impl_mem_free(void* memAlloc);
 void* chpl_gpu_impl_memset(void* addr, const uint8_t val, size_t n,
                            void* stream);
@@ -53,9 +59,6 @@ void chpl_gpu_impl_copy_host_to_device(void* dst, const void* src, size_t n,
 void chpl_gpu_impl_copy_device_to_device(void* dst, const void* src, size_t n,
                                          void* stream);
 
-void* chpl_gpu_impl_comm_async(void *dst, void *src, size_t n);
-void chpl_gpu_impl_comm_wait(void *stream);
-
 // module code uses this to pick the right deallocator for a pointer
 bool chpl_gpu_impl_is_device_ptr(const void* ptr);
 
@@ -63,6 +66,19 @@ bool chpl_gpu_impl_is_host_ptr(const void* ptr);
 
 // TODO do we really need to expose this?
 size_t chpl_gpu_impl_get_alloc_size(void* ptr);
+// start of the allocation ptr points into
+void* chpl_gpu_impl_get_alloc_base(void* ptr);
+// device the allocation ptr points into is on
+c_sublocid_t chpl_gpu_impl_get_ptr_device(const void* ptr);
+
+// Hints for unified memory. They do nothing for memory that isn't managed
+// or on devices that can't migrate it, and return whether they did
+// anything. Prefetches and advice apply to the whole allocation ptr
+// points into.
+bool chpl_gpu_impl_mem_prefetch(void* ptr, c_sublocid_t dev_id, void* stream);
+bool chpl_gpu_impl_mem_advise_preferred_location(void* ptr,
+                                                 c_sublocid_t dev_id);
+bool chpl_gpu_impl_mem_advise_read_mostly(void* ptr, bool enable);
 
 bool chpl_gpu_impl_can_access_peer(int dev1, int dev2);
 void chpl_gpu_impl_set_peer_access(int dev1, int dev2, bool enable);
@@ -76,6 +92,21 @@ void chpl_gpu_impl_stream_destroy(void* stream);
 bool chpl_gpu_impl_stream_ready(void* stream);
 void chpl_gpu_impl_stream_synchronize(void* stream);
 
+// Events mark a point in a stream.  Where streams aren't supported,
+// event_create may return NULL and the rest must accept that.
+void* chpl_gpu_impl_event_create(void);
+void chpl_gpu_impl_event_destroy(void* event);
+void chpl_gpu_impl_event_record(void* event, void* stream);
+// Work queued on stream after this won't start until event completes.
+void chpl_gpu_impl_stream_wait_event(void* stream, void* event);
+bool chpl_gpu_impl_event_ready(void* event);
+void chpl_gpu_impl_event_synchronize(void* event);
+// Events that can be timed. Where that isn't supported, timing_event_create
+// may return NULL, and event_elapsed_ms then returns a negative value.
+void* chpl_gpu_impl_timing_event_create(void);
+// Milliseconds between two completed timing events on the same device.
+float chpl_gpu_impl_event_elapsed_ms(void* start, void* end);
+
 bool chpl_gpu_impl_can_reduce(void);
 
 #define DECL_ONE_REDUCE_IMPL(chpl_kind, data_type) \
@@ -90,6 +121,44 @@ GPU_REDUCE(DECL_ONE_REDUCE_IMPL, maxloc)
 
 #undef DECL_ONE_REDUCE_IMPL
 
+#define DECL_ONE_SCAN_IMPL(chpl_kind, data_type) \
+void chpl_gpu_impl_##chpl_kind##_scan_##data_type(data_type* data,\
+                                                  data_type* out, int n,\
+                                                  void* stream);
+GPU_REDUCE(DECL_ONE_SCAN_IMPL, inclusive_sum)
+GPU_REDUCE(DECL_ONE_SCAN_IMPL, exclusive_sum)
+GPU_REDUCE(DECL_ONE_SCAN_IMPL, inclusive_min)
+GPU_REDUCE(DECL_ONE_SCAN_IMPL, inclusive_max)
+
+#undef DECL_ONE_SCAN_IMPL
+
+#define DECL_ONE_SEGMENTED_REDUCE_IMPL(chpl_kind, data_type) \
+void chpl_gpu_impl_##chpl_kind##_segmented_reduce_##data_type(\
+    data_type* data, int nsegs, int* offsets, data_type* out, void* stream);
+GPU_REDUCE(DECL_ONE_SEGMENTED_REDUCE_IMPL, sum)
+GPU_REDUCE(DECL_ONE_SEGMENTED_REDUCE_IMPL, min)
+GPU_REDUCE(DECL_ONE_SEGMENTED_REDUCE_IMPL, max)
+
+#undef DECL_ONE_SEGMENTED_REDUCE_IMPL
+
+#define DECL_ONE_SORT_IMPL(chpl_kind, data_type) \
+void chpl_gpu_impl_sort_##chpl_kind##_##data_type(data_type* data,\
+                                                  data_type* out, int n,\
+                                                  void* stream);
+GPU_REDUCE(DECL_ONE_SORT_IMPL, keys)
+
+#undef DECL_ONE_SORT_IMPL
+
+#define DECL_ONE_HISTOGRAM_IMPL(chpl_kind, data_type) \
+void chpl_gpu_impl_histogram_##chpl_kind##_##data_type(data_type* data, int n,\
+                                                       int* counts, int nbins,\
+                                                       data_type lower,\
+                                                       data_type upper,\
+                                                       void* stream);
+GPU_REDUCE(DECL_ONE_HISTOGRAM_IMPL, even)
+
+#undef DECL_ONE_HISTOGRAM_IMPL
+
 #ifdef __cplusplus
 }
 #endif
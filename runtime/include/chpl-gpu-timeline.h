@@ -0,0 +1,105 @@
+/*
+ * Copyright 2020-2023 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// GPU kernel and copy timeline.
+//
+// Setting CHPL_RT_GPU_TIMELINE=true makes each locale time its kernel
+// launches and copies to and from GPUs with device events, and print a
+// summary at exit: per kernel, how often it ran, how long it took on the
+// device and how long launching it took on the host, and per copy
+// direction, the bytes moved and the bandwidth reached. Comparing those
+// shows whether a GPU phase is bound by launches, transfers or compute.
+//
+// If CHPL_RT_GPU_TIMELINE_TRACE=<dir> is also set, each locale writes
+// <dir>/gputrace-<nodeID>.json in the Chrome trace event format, which
+// Perfetto (ui.perfetto.dev) and chrome://tracing can open. At most
+// CHPL_RT_GPU_TIMELINE_MAX_RECORDS (default 65536) operations are
+// recorded per locale.
+//
+
+#ifndef _chpl_gpu_timeline_h_
+#define _chpl_gpu_timeline_h_
+
+#ifdef HAS_GPU_LOCALE
+
+#include <stddef.h>
+#include <stdint.h>
+#include "chpltypes.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+  chpl_gpu_timeline_kernel,
+  chpl_gpu_timeline_host_to_device,
+  chpl_gpu_timeline_device_to_host,
+  chpl_gpu_timeline_device_to_device,
+  chpl_gpu_timeline_num_kinds
+} chpl_gpu_timeline_kind_t;
+
+typedef struct chpl_gpu_timeline_rec_s chpl_gpu_timeline_rec_t;
+
+extern chpl_bool chpl_gpu_timeline_enabled;
+
+void chpl_gpu_timeline_init(void);
+void chpl_gpu_timeline_exit(void);
+
+chpl_gpu_timeline_rec_t* chpl_gpu_timeline_start(chpl_gpu_timeline_kind_t kind,
+                                                 int dev, const char* name,
+                                                 int64_t threads, size_t bytes,
+                                                 void* stream,
+                                                 int ln, int32_t fn);
+void chpl_gpu_timeline_stop(chpl_gpu_timeline_rec_t* rec, void* stream);
+
+//
+// Bracket the host call that queues an operation on stream. begin returns
+// NULL when the timeline is off (or full), and end then does nothing.
+// name is a kernel name and must outlive the program; it is NULL for
+// copies.
+//
+static inline
+chpl_gpu_timeline_rec_t* chpl_gpu_timeline_begin(chpl_gpu_timeline_kind_t kind,
+                                                 int dev, const char* name,
+                                                 int64_t threads, size_t bytes,
+                                                 void* stream,
+                                                 int ln, int32_t fn) {
+  if (!chpl_gpu_timeline_enabled) {
+    return NULL;
+  }
+  return chpl_gpu_timeline_start(kind, dev, name, threads, bytes, stream,
+                                 ln, fn);
+}
+
+static inline
+void chpl_gpu_timeline_end(chpl_gpu_timeline_rec_t* rec, void* stream) {
+  if (rec != NULL) {
+    chpl_gpu_timeline_stop(rec, stream);
+  }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HAS_GPU_LOCALE
+
+#endif // _chpl_gpu_timeline_h_
@@ -39,6 +39,20 @@ extern bool chpl_gpu_no_cpu_mode_warning;
 extern bool chpl_gpu_sync_with_host;
 extern bool chpl_gpu_use_stream_per_task;
 
+// How array memory on a GPU sublocale is kept coherent with the host.
+// Coarse-grained memory is only made coherent at kernel and
+// synchronization boundaries, and gets the device's full bandwidth.
+// Fine-grained memory stays coherent while kernels run, which atomics
+// shared by the CPU and GPU need. The default is whatever the vendor
+// allocator for the memory strategy gives. Locale models and the
+// CHPL_RT_GPU_ARRAY_MEM_POLICY environment variable can change what
+// unqualified array allocations get.
+typedef enum {
+  CHPL_GPU_MEM_POLICY_DEFAULT,
+  CHPL_GPU_MEM_POLICY_COARSE,
+  CHPL_GPU_MEM_POLICY_FINE,
+} chpl_gpu_mem_policy_t;
+
 
 #ifdef HAS_GPU_LOCALE
 
@@ -98,9 +112,18 @@ void chpl_gpu_launch_kernel_flat(int ln, int32_t fn,
                                  const char* name,
                                  int64_t num_threads, int blk_dim,
                                  int nargs, ...);
+// Move the unified memory ptr points into to the current device ahead of
+// a kernel launch. Does nothing for other memory.
+void chpl_gpu_prefetch_kernel_arg(const void* ptr);
 
 void* chpl_gpu_mem_array_alloc(size_t size, chpl_mem_descInt_t description,
                                    int32_t lineno, int32_t filename);
+// As above, for arrays whose use calls for a particular coherence, like
+// GPU-only scratch data (coarse) or atomics the host also updates (fine).
+void* chpl_gpu_mem_array_alloc_policy(size_t size,
+                                      chpl_gpu_mem_policy_t policy,
+                                      chpl_mem_descInt_t description,
+                                      int32_t lineno, int32_t filename);
 void* chpl_gpu_mem_alloc(size_t size, chpl_mem_descInt_t description,
                          int32_t lineno, int32_t filename);
 void* chpl_gpu_mem_calloc(size_t number, size_t size,
@@ -152,9 +175,60 @@ void chpl_gpu_copy_device_to_device(c_sublocid_t dst_dev, void* dst,
                                     c_sublocid_t src_dev, const void* src,
                                     size_t n, int32_t commID, int ln,
                                     int32_t fn);
+
+// Asynchronous copies.  chpl_gpu_copy_async starts a copy between host
+// and device memory, or within a device, on one of the current task's
+// copy streams for dev and returns an event that completes with it.  If
+// `after` is not NULL the copy waits for that event first.  Copies use
+// different streams than kernels do, so they only overlap with kernels
+// when ordered with events, e.g. for a double-buffered loop:
+//
+//   copied[b] = chpl_gpu_copy_async(dev, buf[b], chunk, n, used[b], ...);
+//   chpl_gpu_stream_wait_event(dev, copied[b]);
+//   <launch the kernel that reads buf[b]>
+//   used[b] = chpl_gpu_event_record(dev);
+//
+// Host memory should be page-locked (chpl_gpu_hostmem_register) for
+// copies to be truly asynchronous.  Every event has to be released with
+// chpl_gpu_event_wait or chpl_gpu_event_free, and may be released while
+// other streams are still waiting for it.
+void* chpl_gpu_copy_async(c_sublocid_t dev, void* dst, const void* src,
+                          size_t n, void* after, int32_t commID,
+                          int ln, int32_t fn);
+// An event that completes when the task's kernels and copies on dev
+// issued so far do.
+void* chpl_gpu_event_record(c_sublocid_t dev);
+// Make the task's later kernels and copies on dev wait for event,
+// without blocking the host.
+void chpl_gpu_stream_wait_event(c_sublocid_t dev, void* event);
+bool chpl_gpu_event_ready(void* event);
+// Block until event completes, then release it.
+void chpl_gpu_event_wait(void* event);
+void chpl_gpu_event_free(void* event);
+
+// Older interface to the above; the handle is an event.
 void* chpl_gpu_comm_async(void *dst, void *src, size_t n);
 void chpl_gpu_comm_wait(void *stream);
 
+// For the comm layer, which does AMOs from other nodes on memory here.
+// Returns the device obj is on if the CPU can't do atomics on it, else
+// -1. In the former case also tries to register the allocation for
+// network atomics (see chpl_comm_regMemDevice()) and says whether that
+// worked in *registered.
+c_sublocid_t chpl_gpu_comm_amo_device(void* obj, bool* registered);
+// Blocking copies between device memory and the host, for AMOs the
+// network can't do on it. These may be called from comm layer threads
+// that aren't tasks, so they use their own streams; callers must not
+// make them concurrently.
+void chpl_gpu_comm_amo_get(void* dst, c_sublocid_t dev, const void* obj,
+                           size_t n);
+void chpl_gpu_comm_amo_put(c_sublocid_t dev, void* obj, const void* src,
+                           size_t n);
+
+// Tell the driver that the unified memory allocation ptr points into is
+// (or is no longer) mostly read, so devices can keep copies of it.
+void chpl_gpu_mem_advise_read_mostly(void* ptr, bool enable);
+
 bool chpl_gpu_is_device_ptr(const void* ptr);
 bool chpl_gpu_is_host_ptr(const void* ptr);
 
@@ -180,6 +254,60 @@ GPU_REDUCE(DECL_ONE_REDUCE, maxloc);
 
 #undef DECL_ONE_REDUCE
 
+// Device-wide scans, segmented reductions, sorts and histograms.  Like
+// the reductions above, these are only available when
+// chpl_gpu_can_reduce() is true.  All arrays are in device memory on the
+// task's current sublocale, and the work is queued on the task's stream.
+//
+// Scans write n elements to out, which may be the same as data.  The
+// exclusive scan starts from 0.
+#define DECL_ONE_SCAN(chpl_kind, data_type) \
+void chpl_gpu_##chpl_kind##_scan_##data_type(data_type* data, data_type* out,\
+                                             int n);
+
+GPU_REDUCE(DECL_ONE_SCAN, inclusive_sum);
+GPU_REDUCE(DECL_ONE_SCAN, exclusive_sum);
+GPU_REDUCE(DECL_ONE_SCAN, inclusive_min);
+GPU_REDUCE(DECL_ONE_SCAN, inclusive_max);
+
+#undef DECL_ONE_SCAN
+
+// Reduce each of nsegs segments into out[i].  Segment i is
+// data[offsets[i]..offsets[i+1]-1], so offsets has nsegs+1 elements.
+#define DECL_ONE_SEGMENTED_REDUCE(chpl_kind, data_type) \
+void chpl_gpu_##chpl_kind##_segmented_reduce_##data_type(data_type* data,\
+                                                         int nsegs,\
+                                                         int* offsets,\
+                                                         data_type* out);
+
+GPU_REDUCE(DECL_ONE_SEGMENTED_REDUCE, sum);
+GPU_REDUCE(DECL_ONE_SEGMENTED_REDUCE, min);
+GPU_REDUCE(DECL_ONE_SEGMENTED_REDUCE, max);
+
+#undef DECL_ONE_SEGMENTED_REDUCE
+
+// Radix sort n keys in ascending order into out, which must not be the
+// same as data.
+#define DECL_ONE_SORT(chpl_kind, data_type) \
+void chpl_gpu_sort_##chpl_kind##_##data_type(data_type* data, data_type* out,\
+                                             int n);
+
+GPU_REDUCE(DECL_ONE_SORT, keys);
+
+#undef DECL_ONE_SORT
+
+// Count the n samples into nbins equal-width bins covering
+// [lower, upper).  Samples outside that range aren't counted.
+#define DECL_ONE_HISTOGRAM(chpl_kind, data_type) \
+void chpl_gpu_histogram_##chpl_kind##_##data_type(data_type* data, int n,\
+                                                  int* counts, int nbins,\
+                                                  data_type lower,\
+                                                  data_type upper);
+
+GPU_REDUCE(DECL_ONE_HISTOGRAM, even);
+
+#undef DECL_ONE_HISTOGRAM
+
 
 #endif // HAS_GPU_LOCALE
 
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2020-2023 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _chpl_mem_arena_H_
+#define _chpl_mem_arena_H_
+
+#ifndef LAUNCHER
+
+#include <stddef.h>
+#include <stdint.h>
+#include "chpl-mem-desc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Per-thread arenas for the small, short-lived objects the runtime
+// itself allocates on hot paths (AM handoffs, task descriptors, qio
+// bytes headers, and so on).  Objects are grouped into power-of-two
+// size classes, and each thread keeps a bounded free list per class,
+// so most allocations and frees never reach the underlying allocator.
+// An object may be freed on a different thread than the one that
+// allocated it.
+//
+// Requests too large for any size class fall through to the regular
+// allocator.  Either way the memory hooks see every object, so memory
+// tracking (--memTrack and friends) reports them as usual, under the
+// given descriptor.  Objects must be freed with chpl_mem_arena_free(),
+// never with chpl_mem_free().
+//
+void chpl_mem_arena_init(void);
+
+void* chpl_mem_arena_alloc(size_t size, chpl_mem_descInt_t description,
+                           int32_t lineno, int32_t filename);
+void* chpl_mem_arena_allocZero(size_t size, chpl_mem_descInt_t description,
+                               int32_t lineno, int32_t filename);
+void chpl_mem_arena_free(void* memAlloc, int32_t lineno, int32_t filename);
+
+//
+// Bytes currently held in arena free lists across all threads.  This
+// isn't synchronized with ongoing allocation, so it's approximate.
+//
+size_t chpl_mem_arena_cachedBytes(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LAUNCHER
+
+#endif // _chpl_mem_arena_H_
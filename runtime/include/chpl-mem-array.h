@@ -39,6 +39,23 @@
 extern "C" {
 #endif
 
+//
+// Array element data is aligned to at least this many bytes, so that
+// vectorized loops over it can use aligned loads and stores without
+// peeling (64 covers AVX-512).  Comm layer and mapped allocations are
+// page aligned already; this matters for the ones that come from the
+// memory layer.
+//
+#define CHPL_MEM_ARRAY_ALIGNMENT 64
+
+#if defined(__GNUC__) || defined(__clang__)
+#define CHPL_MEM_ARRAY_ASSUME_ALIGNED \
+  __attribute__((assume_aligned(CHPL_MEM_ARRAY_ALIGNMENT)))
+#else
+#define CHPL_MEM_ARRAY_ASSUME_ALIGNED
+#endif
+
+
 static inline
 chpl_bool chpl_mem_size_justifies_comm_alloc(size_t size) {
   //
@@ -52,6 +69,17 @@ chpl_bool chpl_mem_size_justifies_comm_alloc(size_t size) {
 
 
 static inline
+chpl_bool chpl_mem_size_justifies_map_alloc(size_t size) {
+  //
+  // Large arrays the comm layer won't allocate get mappings of their
+  // own, so that they can be resized by remapping rather than copying.
+  // This is never on when the comm layer does allocations.
+  //
+  return size >= chpl_mem_array_mapThreshold;
+}
+
+
+static inline CHPL_MEM_ARRAY_ASSUME_ALIGNED
 void* chpl_mem_array_alloc(size_t nmemb, size_t eltSize,
                            c_sublocid_t subloc, chpl_bool* callPostAlloc,
                            chpl_bool haltOnOom,
@@ -91,7 +119,13 @@ void* chpl_mem_array_alloc(size_t nmemb, size_t eltSize,
   }
 
   if (p == NULL) {
-    p = chpl_malloc(size);
+    p = chpl_mem_size_justifies_map_alloc(size)
+        ? chpl_mem_array_map(size)
+        : chpl_memalign(CHPL_MEM_ARRAY_ALIGNMENT, size);
+  }
+
+  if (p != NULL && chpl_mem_localizeArrays) {
+    chpl_mem_array_localize(p, nmemb, eltSize);
   }
 
   if (haltOnOom) {
@@ -107,6 +141,32 @@ void* chpl_mem_array_alloc(size_t nmemb, size_t eltSize,
   return p;
 }
 
+static inline
+void chpl_mem_array_initElts(void* p, size_t nmemb, size_t eltSize,
+                             const void* val) {
+  //
+  // Initialize all the elements of a newly allocated array to *val, or
+  // to zero if val is NULL.  Large arrays are done in parallel.  If the
+  // allocation said to call chpl_mem_array_postAlloc(), this must come
+  // first, since it is the first touch.  On GPU sublocales only zeroing
+  // is supported.
+  //
+  const size_t size = nmemb * eltSize;
+#if defined(HAS_GPU_LOCALE) && !defined(GPU_RUNTIME_CPU)
+  if (chpl_gpu_running_on_gpu_locale()) {
+    assert(val == NULL);
+    chpl_gpu_memset(p, 0, size);
+    return;
+  }
+#endif
+  if (val == NULL && chpl_mem_size_justifies_map_alloc(size)) {
+    // Fresh mappings are zeroed already; we just need the pages.
+    chpl_mem_parallel_touch(p, size);
+  } else {
+    chpl_mem_parallel_fill(p, nmemb, eltSize, val);
+  }
+}
+
 static inline
 void chpl_mem_array_postAlloc(void* p, size_t nmemb, size_t eltSize,
                               int32_t lineno, int32_t filename) {
@@ -124,10 +184,30 @@ chpl_bool chpl_mem_array_supports_realloc(void* p, size_t oldNmemb, size_t newNm
                                           int32_t filename) {
   const size_t oldSize = oldNmemb * eltSize;
   const size_t newSize = newNmemb * eltSize;
-  return chpl_mem_size_justifies_comm_alloc(oldSize) == chpl_mem_size_justifies_comm_alloc(newSize);
+  return (chpl_mem_size_justifies_comm_alloc(oldSize) == chpl_mem_size_justifies_comm_alloc(newSize)
+          && chpl_mem_size_justifies_map_alloc(oldSize) == chpl_mem_size_justifies_map_alloc(newSize));
 }
 
 static inline
+void* chpl_mem_array_realloc_aligned(void* p, size_t oldSize, size_t newSize) {
+  //
+  // The memory layer's realloc doesn't keep our alignment.  If it
+  // returns a misaligned block, move the data to an aligned one.
+  //
+  void* newp = chpl_realloc(p, newSize);
+  if (newp != NULL
+      && ((uintptr_t) newp & (CHPL_MEM_ARRAY_ALIGNMENT - 1)) != 0) {
+    void* alignedp = chpl_memalign(CHPL_MEM_ARRAY_ALIGNMENT, newSize);
+    if (alignedp != NULL) {
+      memcpy(alignedp, newp, (oldSize < newSize) ? oldSize : newSize);
+    }
+    chpl_free(newp);
+    newp = alignedp;
+  }
+  return newp;
+}
+
+static inline CHPL_MEM_ARRAY_ASSUME_ALIGNED
 void* chpl_mem_array_realloc(void* p, size_t oldNmemb, size_t newNmemb,
                              size_t eltSize,
                              c_sublocid_t subloc, chpl_bool* callPostAlloc,
@@ -163,7 +243,13 @@ void* chpl_mem_array_realloc(void* p, size_t oldNmemb, size_t newNmemb,
   }
 
   if (newp == NULL) {
-    newp = chpl_realloc(p, newSize);
+    newp = chpl_mem_size_justifies_map_alloc(oldSize)
+           ? chpl_mem_array_remap(p, oldSize, newSize)
+           : chpl_mem_array_realloc_aligned(p, oldSize, newSize);
+  }
+
+  if (newp != NULL && chpl_mem_localizeArrays) {
+    chpl_mem_array_localize(newp, newNmemb, eltSize);
   }
 
   chpl_memhook_realloc_post(newp, p, newSize, CHPL_RT_MD_ARRAY_ELEMENTS,
@@ -213,6 +299,11 @@ void chpl_mem_array_free(void* p,
     return;
   }
 
+  if (chpl_mem_size_justifies_map_alloc(size)) {
+    chpl_mem_array_unmap(p, size);
+    return;
+  }
+
   chpl_free(p);
 #ifdef HAS_GPU_LOCALE
   }
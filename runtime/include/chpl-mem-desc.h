@@ -65,7 +65,6 @@ extern "C" {
   m(COMM_FRK_RCV_ARG,     "comm layer received remote fork arg",      false), \
   m(COMM_FRK_DONE_FLAG,   "comm layer remote fork done flag(s)",      false), \
   m(COMM_PER_LOC_INFO,    "comm layer per-locale information",        false), \
-  m(COMM_PRV_OBJ_ARRAY,   "comm layer private objects array",         false), \
   m(COMM_PRV_BCAST_DATA,  "comm layer private broadcast data",        false), \
   m(MEM_HEAP_SPACE,       "mem layer heap expansion space",           false), \
   m(GLOM_STRINGS_DATA,    "glom strings data",                        true ), \
@@ -87,6 +86,8 @@ extern "C" {
   m(TASK_POOL_DESC,       "task pool descriptor",                     false), \
   m(TASK_ARG_AND_POOL_DESC, "task body argument and pool descriptor", false), \
   m(TASK_LAYER_UNSPEC,    "tasking layer unspecified data",           false), \
+  m(TASK_PROF_DATA,       "task profiling data",                      false), \
+  m(FN_PROF_DATA,         "function profiling data",                  false), \
   m(THREAD_PRV_DATA,      "thread private data",                      false), \
   m(THREAD_LIST_DESC,     "thread list descriptor",                   false), \
   m(THREAD_STACK_DESC,    "thread stack descriptor",                  false), \
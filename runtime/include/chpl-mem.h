@@ -74,6 +74,28 @@ void chpl_mem_exit(void);
 
 int chpl_mem_inited(void);
 
+// Flat locale model: if set, large arrays are spread across the NUMA
+// domains to match default forall partitioning; see chpl-mem-array.h.
+extern chpl_bool chpl_mem_localizeArrays;
+void chpl_mem_array_localize(void* p, size_t nmemb, size_t eltSize);
+
+// Arrays at least this big get mappings of their own, which can grow
+// without copying; SIZE_MAX if none do.  See chpl-mem-array.h.
+extern size_t chpl_mem_array_mapThreshold;
+void* chpl_mem_array_map(size_t size);
+void* chpl_mem_array_remap(void* p, size_t oldSize, size_t newSize);
+void chpl_mem_array_unmap(void* p, size_t size);
+
+// Regions at least this big are initialized by several threads at
+// once, so that page faults proceed in parallel and first touch spreads
+// the pages across NUMA domains; SIZE_MAX to never do this.
+extern size_t chpl_mem_parallelInitThreshold;
+// Set nmemb elements of eltSize bytes to *val, or to 0 if val is NULL.
+void chpl_mem_parallel_fill(void* p, size_t nmemb, size_t eltSize,
+                            const void* val);
+// Fault in memory known to be zeroed already (fresh mappings).
+void chpl_mem_parallel_touch(void* p, size_t size);
+
 extern void* chpl_gpu_memmove(void* dest, const void* src, size_t num);
 
 static inline
@@ -100,7 +122,15 @@ void* chpl_mem_allocManyZero(size_t number, size_t size,
                              int32_t lineno, int32_t filename) {
   void* memAlloc;
   chpl_memhook_malloc_pre(number, size, description, lineno, filename);
-  memAlloc = chpl_calloc(number, size);
+  if (size != 0 && number <= SIZE_MAX / size
+      && number * size >= chpl_mem_parallelInitThreshold) {
+    // calloc() would zero (or first touch) it all from this one thread.
+    if ((memAlloc = chpl_malloc(number * size)) != NULL) {
+      chpl_mem_parallel_fill(memAlloc, number, size, NULL);
+    }
+  } else {
+    memAlloc = chpl_calloc(number, size);
+  }
   chpl_memhook_malloc_post(memAlloc, number, size, description,
                            lineno, filename);
   return memAlloc;
@@ -204,6 +234,10 @@ void* chpl_mem_layerAlloc(size_t, int32_t lineno, int32_t filename);
 void* chpl_mem_layerRealloc(void*, size_t, int32_t lineno, int32_t filename);
 void chpl_mem_layerFree(void*, int32_t lineno, int32_t filename);
 
+// Page size of the memory layer's own heap mapping, if it imposes one
+// (as with explicit huge pages); 0 otherwise.
+size_t chpl_mem_layerHeapPageSize(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -36,7 +36,8 @@ typedef struct chpl_privateObject_s {
   void* obj;
 } chpl_privateObject_t;
 
-// This is a dynamically-allocated array of chpl_privateObject_t.
+// This is an array of chpl_privateObject_t that grows in place; its
+// address doesn't change after chpl_privatization_init().
 extern chpl_privateObject_t* chpl_privateObjects;
 
 // Compiler generates accesses like chpl_privateObjects[i];
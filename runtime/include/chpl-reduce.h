@@ -0,0 +1,161 @@
+/*
+ * Copyright 2020-2023 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Host reduction kernels over contiguous arrays of primitive types.
+//
+// These are the per-task building blocks for whole-array reductions: the
+// caller splits the array among its tasks, runs one kernel per chunk and
+// combines the partial results.  Each kernel keeps several independent
+// accumulators so that the C compiler can vectorize it without having to
+// reassociate floating point operations itself.
+//
+// Integer sums and dot products wrap on overflow.  For floating point
+// types, min and max skip NaNs.  minloc/maxloc return the index of the
+// first element equal to the result, or 0 if there is none.  Over an empty
+// array, sum returns 0 and min/max return the identity of their operation.
+
+#ifndef _chpl_reduce_h_
+#define _chpl_reduce_h_
+
+#include <math.h>
+#include <stdint.h>
+
+#include "sys_basic.h"
+#include "chpl-atomics.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// MACRO(data_type, sum_type, dot_type, min_value, max_value), where
+// sum_type and dot_type are the types integer sums and dot products are
+// accumulated in so that wrapping is well defined.
+#define CHPL_REDUCE_TYPES(MACRO) \
+  MACRO(int8_t, uint8_t, uint64_t, INT8_MIN, INT8_MAX) \
+  MACRO(int16_t, uint16_t, uint64_t, INT16_MIN, INT16_MAX) \
+  MACRO(int32_t, uint32_t, uint64_t, INT32_MIN, INT32_MAX) \
+  MACRO(int64_t, uint64_t, uint64_t, INT64_MIN, INT64_MAX) \
+  MACRO(uint8_t, uint8_t, uint64_t, 0, UINT8_MAX) \
+  MACRO(uint16_t, uint16_t, uint64_t, 0, UINT16_MAX) \
+  MACRO(uint32_t, uint32_t, uint64_t, 0, UINT32_MAX) \
+  MACRO(uint64_t, uint64_t, uint64_t, 0, UINT64_MAX) \
+  MACRO(float, float, float, -INFINITY, INFINITY) \
+  MACRO(double, double, double, -INFINITY, INFINITY)
+
+#define DECL_CHPL_REDUCE(data_type, sum_type, dot_type, min_value, \
+                         max_value) \
+data_type chpl_reduce_sum_##data_type(const data_type* data, int64_t n); \
+data_type chpl_reduce_min_##data_type(const data_type* data, int64_t n); \
+data_type chpl_reduce_max_##data_type(const data_type* data, int64_t n); \
+data_type chpl_reduce_minloc_##data_type(const data_type* data, int64_t n, \
+                                         int64_t* idx); \
+data_type chpl_reduce_maxloc_##data_type(const data_type* data, int64_t n, \
+                                         int64_t* idx); \
+data_type chpl_reduce_dot_##data_type(const data_type* a, \
+                                      const data_type* b, int64_t n);
+
+CHPL_REDUCE_TYPES(DECL_CHPL_REDUCE)
+
+#undef DECL_CHPL_REDUCE
+
+//
+// Combining support for reduce intents.
+//
+// When the tasks of a forall finish, each one combines its reduce op
+// into the parent op under the parent's lock, so with many tasks and a
+// large op state the combines run one at a time.  Instead, a finishing
+// task can offer its op to a slot in the parent.  If no other op is
+// waiting there, its op is left waiting and the task is done.  If one
+// is, the task takes it, combines it into its own op without any lock,
+// and offers the result again.  Tasks that finish together thus pair up
+// and combine in parallel, in a tree roughly log(tasks) deep rather
+// than a chain.  Once all the tasks are done, the parent takes the one
+// op that may be left waiting and combines it into itself.
+//
+//    // at task teardown, 'op' being the task's own reduce op
+//    while ((other = chpl_reduce_tree_offer(&parent->tree, op)) != NULL) {
+//      op->combine(other);
+//      delete other;
+//    }
+//
+//    // once the tasks are done
+//    if ((other = chpl_reduce_tree_take(&parent->tree)) != NULL) {
+//      parent->combine(other);
+//      delete other;
+//    }
+//
+// The ops that meet in a slot must all be on the slot's locale.
+// Tasks on other locales should combine into a per-locale op first,
+// which then combines into the parent from there.
+//
+
+typedef struct {
+  atomic_uintptr_t waiting;              // an op left for a sibling, or 0
+} chpl_reduce_tree_t;
+
+static inline
+void chpl_reduce_tree_init(chpl_reduce_tree_t* t) {
+  atomic_init_uintptr_t(&t->waiting, (uintptr_t) NULL);
+}
+
+static inline
+void chpl_reduce_tree_destroy(chpl_reduce_tree_t* t) {
+  atomic_destroy_uintptr_t(&t->waiting);
+}
+
+//
+// Offers 'op' to the slot.  Returns NULL if 'op' was left waiting
+// there, after which it belongs to whoever takes it.  Otherwise returns
+// an op that was waiting, which now belongs to the caller, who should
+// combine it into 'op' and offer 'op' again.
+//
+static inline
+void* chpl_reduce_tree_offer(chpl_reduce_tree_t* t, void* op) {
+  uintptr_t cur = atomic_load_explicit_uintptr_t(&t->waiting,
+                                                 memory_order_acquire);
+  while (1) {
+    uintptr_t want = (cur == (uintptr_t) NULL) ? (uintptr_t) op
+                                               : (uintptr_t) NULL;
+    // Release our op's state to whoever takes it, and acquire the
+    // state of the one we take.
+    if (atomic_compare_exchange_weak_explicit_uintptr_t(&t->waiting,
+                                                        &cur, want,
+                                                        memory_order_acq_rel,
+                                                        memory_order_acquire))
+      return (void*) cur;
+  }
+}
+
+//
+// Takes the op left waiting in the slot, if any.  Use this once all the
+// ops that might be offered have been.
+//
+static inline
+void* chpl_reduce_tree_take(chpl_reduce_tree_t* t) {
+  return (void*) atomic_exchange_explicit_uintptr_t(&t->waiting,
+                                                    (uintptr_t) NULL,
+                                                    memory_order_acquire);
+}
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
+
+#endif
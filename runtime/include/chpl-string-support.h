@@ -87,6 +87,15 @@ c_string string_concat(c_string x, c_string y, int32_t lineno, int32_t filename)
 int string_index_of(c_string x, c_string y);
 c_string string_index(c_string x, int i, int32_t lineno, int32_t filename);
 c_string string_select(c_string x, int low, int high, int stride, int32_t lineno, int32_t filename);
+void string_select_into(char* dst, c_string x, int low, int high, int stride);
+
+// The number of bytes string_select() selects, for low >= 1, high >= low.
+static inline
+int string_select_size(int low, int high, int stride) {
+  const int n = high - low + 1;
+  const int s = (stride > 0) ? stride : -stride;
+  return (s == 1) ? n : (n - 1) / s + 1;
+}
 
 #ifdef __cplusplus
 }
@@ -38,7 +38,10 @@ struct chpl_chpl____wide_chpl_string_s;
 
 chpl_string chpl_wide_string_copy(struct chpl_chpl____wide_chpl_string_s* x, int32_t lineno, int32_t filename);
 
-#define CHPL_SHORT_STRING_SIZE 8
+// Strings of up to CHPL_SHORT_STRING_SIZE-1 bytes, plus the terminating
+// NUL, can be kept in place in a chpl__inPlaceBuffer instead of on the
+// heap.
+#define CHPL_SHORT_STRING_SIZE 24
 
 typedef struct chpl__inPlaceBuffer_t {
   uint8_t data[CHPL_SHORT_STRING_SIZE];
@@ -47,6 +50,29 @@ typedef struct chpl__inPlaceBuffer_t {
 uint8_t* chpl__getInPlaceBufferData(chpl__inPlaceBuffer* buf);
 uint8_t* chpl__getInPlaceBufferDataForWrite(chpl__inPlaceBuffer* buf);
 
+static inline
+chpl_bool chpl__isInPlace(chpl__inPlaceBuffer* buf, c_string s) {
+  return s == (c_string) buf->data;
+}
+
+//
+// These are string_copy(), string_concat(), string_select() and
+// chpl_wide_string_copy(), except that a result that fits in buf is
+// put there rather than in newly allocated memory.  Only results for
+// which chpl__isInPlace() is false need to be freed.
+//
+c_string chpl__inPlaceCopy(chpl__inPlaceBuffer* buf, c_string x,
+                           int32_t lineno, int32_t filename);
+c_string chpl__inPlaceConcat(chpl__inPlaceBuffer* buf,
+                             c_string x, c_string y,
+                             int32_t lineno, int32_t filename);
+c_string chpl__inPlaceSelect(chpl__inPlaceBuffer* buf, c_string x,
+                             int low, int high, int stride,
+                             int32_t lineno, int32_t filename);
+chpl_string chpl__inPlaceWideCopy(chpl__inPlaceBuffer* buf,
+                                  struct chpl_chpl____wide_chpl_string_s* x,
+                                  int32_t lineno, int32_t filename);
+
 #ifdef __cplusplus
 }
 #endif
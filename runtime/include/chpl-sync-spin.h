@@ -0,0 +1,83 @@
+/*
+ * Copyright 2020-2023 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Adaptive waiting for sync variables, shared by the tasking layers.
+//
+// Each sync variable keeps an estimate of how many spin iterations its
+// waits have recently taken.  A waiter spins (with a CPU pause hint)
+// for up to about twice that, and if the variable still isn't in the
+// state it wants, falls back to the tasking layer's normal, parking
+// wait.  Waits that end while spinning pull the estimate toward what
+// they took; waits that park shrink it, so a variable whose waits are
+// long converges to parking right away.  The estimate is only updated
+// with the sync variable's lock held.
+//
+
+#ifndef _chpl_sync_spin_h_
+#define _chpl_sync_spin_h_
+
+#include <stdint.h>
+#include "chpltypes.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CHPL_SYNC_SPIN_MIN 16
+#define CHPL_SYNC_SPIN_MAX 8192
+
+static inline void chpl_sync_spinPause(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  __asm__ __volatile__ ("yield");
+#elif defined(__powerpc64__)
+  __asm__ __volatile__ ("or 27,27,27");
+#endif
+}
+
+//
+// How many times to spin before parking, given the current estimate.
+//
+static inline uint32_t chpl_sync_spinLimit(uint32_t est) {
+  uint32_t limit = 2 * est + CHPL_SYNC_SPIN_MIN;
+  return (limit > CHPL_SYNC_SPIN_MAX) ? CHPL_SYNC_SPIN_MAX : limit;
+}
+
+//
+// Update the estimate after a wait that spun "spins" times and then
+// either succeeded or parked.
+//
+static inline void chpl_sync_spinLearn(uint32_t* est, uint32_t spins,
+                                       chpl_bool parked) {
+  if (parked) {
+    *est -= *est / 4;
+  } else {
+    *est = (uint32_t) ((int64_t) *est
+                       + ((int64_t) spins - (int64_t) *est) / 8);
+  }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _chpl_sync_spin_h_
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2020-2023 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Per-task profiling built on the tasking callbacks.
+//
+// Setting CHPL_RT_TASK_PROFILE=<dir> makes each locale record, for a
+// sample of its tasks (every CHPL_RT_TASK_PROFILE_SAMPLE'th task ID,
+// default 1 = all), when the task was created, began, and ended, where
+// it was created, and how long it spent waiting on sync variables.  At
+// exit each locale writes its records to <dir>/taskprof-<nodeID> in
+// the binary format described in chpl-task-prof.c.  The summarizer in
+// tools/chpl-task-prof reads them.
+//
+
+#ifndef _chpl_task_prof_h_
+#define _chpl_task_prof_h_
+
+#include <stdint.h>
+#include <time.h>
+#include "chpltimers.h"
+#include "chpltypes.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern chpl_bool chpl_task_prof_enabled;
+
+void chpl_task_prof_init(void);
+void chpl_task_prof_exit(void);
+
+void chpl_task_prof_addSyncWait(uint64_t ns);
+
+static inline uint64_t chpl_task_prof_now(void) {
+  return chpl_fast_timer_ns();
+}
+
+//
+// Bracket a sync variable wait.  These are cheap when profiling is
+// off: the start returns 0 and the end then does nothing.
+//
+static inline uint64_t chpl_task_prof_syncWaitStart(void) {
+  return chpl_task_prof_enabled ? chpl_task_prof_now() : 0;
+}
+
+static inline void chpl_task_prof_syncWaitEnd(uint64_t start) {
+  if (start != 0) {
+    chpl_task_prof_addSyncWait(chpl_task_prof_now() - start);
+  }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _chpl_task_prof_h_
@@ -39,6 +39,9 @@ extern "C" {
 // chpl_task_getRequestedSubloc from here (well, actually chpl-tasks-impl-fns)
 typedef struct {
   void** streams;
+  void** copy_streams;  // CHPL_GPU_NUM_COPY_STREAMS per device
+  int copy_next;        // copy stream the next async copy goes on
+  struct chpl_gpu_pool_block_s* pool_pending; // freed, maybe still in use
 } chpl_gpu_taskPrvData_t;
 #endif
 
@@ -76,6 +79,7 @@ typedef struct chpl_task_bundle {
   int lineno;
   int filename;
   c_sublocid_t requestedSubloc;
+  c_sublocid_t preferredSubloc; // placement hint for tasks this one creates
   chpl_fn_int_t requested_fid;
   chpl_fn_p requested_fn;
   chpl_taskID_t id;
@@ -219,6 +223,22 @@ void chpl_task_addTask(
          int,                // line at which function begins
          int32_t);           // name of file containing function
 
+//
+// Bulk task creation: the equivalent of calling chpl_task_addTask for
+// each of 'n' bundles of the same size, stored contiguously.  Tasking
+// layers can spread the creation work out or amortize their own
+// overheads across the batch.  The bundles' memory is again only
+// borrowed for the duration of the call.
+//
+void chpl_task_addTasks(
+         chpl_fn_int_t,      // function to call for each task
+         chpl_task_bundle_t*,// first of n contiguous argument bundles
+         size_t,             // length of each argument bundle
+         int64_t,            // number of tasks (bundles)
+         c_sublocid_t,       // desired sublocale
+         int,                // line at which function begins
+         int32_t);           // name of file containing function
+
 //
 // Call a chpl_ftable[] function in a task.
 //
@@ -279,6 +299,19 @@ void chpl_task_setSubloc(c_sublocid_t);
 c_sublocid_t chpl_task_getRequestedSubloc(void);
 #endif
 
+//
+// Get and set the current task's preferred sublocale (NUMA domain).
+// Unlike a requested sublocale this is only a hint: tasks the current
+// task goes on to create with no particular sublocale requested will,
+// if the tasking layer supports it, be placed near that domain, and
+// they inherit the preference themselves.  c_sublocid_any means no
+// preference.  The ByAddr form prefers the domain holding the memory
+// at the given address, for tasks about to work on that memory.
+//
+c_sublocid_t chpl_task_getPreferredSubloc(void);
+void chpl_task_setPreferredSubloc(c_sublocid_t);
+void chpl_task_setPreferredSublocByAddr(const void*);
+
 // For tasking layers that support task affinity/placement, this
 // resets any automatic placement order
 #ifndef CHPL_TASK_IMPL_RESET_SPAWN_ORDER
@@ -353,6 +386,18 @@ chpl_task_infoChapel_t* chpl_task_getInfoChapelInBundle(chpl_task_bundle_t* b)
 //
 uint32_t chpl_task_getMaxPar(void);
 
+//
+// Changes the width of parallelism the tasking layer provides on the
+// calling locale, for programs that share their nodes with other work.
+// Shrinking it parks worker threads so their cores are returned to the
+// OS; growing it back unparks them.  The request is clamped to the
+// range [1, the value chpl_task_getMaxPar() returned at startup], and
+// the resulting setting, as chpl_task_getMaxPar() now reports it, is
+// returned.  Tasking layers that can't adjust their parallelism ignore
+// the request and return the original value.
+//
+uint32_t chpl_task_setMaxPar(uint32_t maxPar);
+
 //
 // returns the value of the call stack size limit being used in
 // practice; the value returned may potentially differ from one locale
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2020-2023 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// A timer wheel for parking sleeping tasks.
+//
+// A tasking layer that can suspend a task (e.g. on a qthreads FEB)
+// adds a timer whose callback makes the task runnable again, then
+// suspends it.  One thread, started on first use, runs the callbacks
+// once their deadlines pass, so sleeping tasks cost nothing until then.
+//
+
+#ifndef _chpl_timer_wheel_h_
+#define _chpl_timer_wheel_h_
+
+#include <stdint.h>
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The wheel's resolution.  Sleeps shorter than this aren't worth
+// parking for.
+#define CHPL_TIMER_WHEEL_TICK_NS 1000000
+
+typedef struct chpl_timer_s {
+  struct chpl_timer_s* next;
+  uint64_t deadline;             // CLOCK_MONOTONIC ns
+  void (*fn)(void*);
+  void* arg;
+} chpl_timer_t;
+
+static inline uint64_t chpl_timer_wheel_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000 + (uint64_t) ts.tv_nsec;
+}
+
+static inline uint64_t chpl_timer_wheel_deadline(double secs) {
+  return chpl_timer_wheel_now() + (secs > 0 ? (uint64_t) (secs * 1.0e9) : 0);
+}
+
+//
+// Calls fn(arg) on the wheel's thread once 'deadline' has passed.
+// The caller owns 't', which must stay valid until fn is called; the
+// wheel is done with 't' by the time it calls fn.
+//
+void chpl_timer_wheel_add(chpl_timer_t* t, uint64_t deadline,
+                          void (*fn)(void*), void* arg);
+
+//
+// Blocks the calling thread until 'deadline', for callers that aren't
+// tasks that can be parked.
+//
+void chpl_timer_wheel_sleepThread(uint64_t deadline);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _chpl_timer_wheel_h_
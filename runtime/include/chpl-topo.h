@@ -88,6 +88,12 @@ int chpl_topo_bindCPU(int id);
 //
 int chpl_topo_getNumNumaDomains(void);
 
+//
+// get the sublocale (NUMA domain) containing the PU specified by the
+// hwloc OS index, as returned by chpl_topo_getCPUs
+//
+c_sublocid_t chpl_topo_getCPULocality(int cpu);
+
 //
 // set the sublocale where the current thread is running
 //
@@ -130,6 +136,21 @@ void chpl_topo_setMemLocality(void*, size_t, chpl_bool, c_sublocid_t);
 //
 void chpl_topo_setMemSubchunkLocality(void*, size_t, chpl_bool, size_t*);
 
+//
+// set the locality of an array's elements to match the way a forall
+// divides them among worker threads: the elements are split as evenly
+// as possible into consecutive chunks and each chunk is put on the NUMA
+// domain of the accessible core with the same index (wrapping around),
+// where the tasking layer places the corresponding worker
+//
+// args:
+//   base address
+//   number of elements
+//   element size (bytes)
+//   number of chunks
+//
+void chpl_topo_setMemChunkLocality(void*, size_t, size_t, int);
+
 //
 // touch a block of memory, while running on a given NUMA domain
 //
@@ -159,6 +180,27 @@ typedef struct chpl_topo_pci_addr {
 
 chpl_topo_pci_addr_t *chpl_topo_selectNicByType(chpl_topo_pci_addr_t *inAddr,
                                                 chpl_topo_pci_addr_t *outAddr);
+
+//
+// For locales that use more than one NIC. Fills "outAddrs" with up to
+// "count" NICs of the same type (vendor and device) as the one at
+// "inAddr" that this locale should use, with that one first, and
+// "outSockets" (if not NULL) with the logical index of each one's
+// socket, or -1 if that isn't known. If the locale is running in a
+// socket these are the NICs in that socket, otherwise they are all the
+// NICs of that type on the node. Returns the number of NICs, which is
+// 0 if the NIC at "inAddr" can't be found.
+//
+int chpl_topo_selectNicsByType(chpl_topo_pci_addr_t *inAddr,
+                               chpl_topo_pci_addr_t *outAddrs,
+                               int *outSockets, int count);
+
+//
+// Returns the logical index of the socket the current thread last ran
+// on, or -1 if that isn't known.
+//
+int chpl_topo_getThreadSocket(void);
+
 //
 // Returns True if the node is oversubscribed (locales are sharing
 // cores).
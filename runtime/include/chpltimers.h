@@ -24,6 +24,8 @@
 #include "chpltypes.h"  // For _real64.
 
 #include <sys/time.h>   // For struct timeval.
+#include <stdint.h>
+#include <time.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -41,6 +43,62 @@ void chpl_timevalue_parts(_timevalue t, int32_t* seconds, int32_t* minutes, int3
 
 _real64 chpl_now_time(void);
 
+//
+// A fast monotonic timer for instrumentation.
+//
+// chpl_fast_timer_ticks() reads the CPU's counter when it runs at a
+// constant rate and is trusted across cores -- the invariant TSC on
+// x86, when the kernel uses it as its clock source, or the generic
+// timer's virtual count on aarch64 -- and otherwise CLOCK_MONOTONIC in
+// ns.  Setting CHPL_RT_USE_CYCLE_COUNTER=false forces the latter.
+// Ticks are only meaningful as differences on one locale; convert
+// them with chpl_fast_timer_ticks_to_ns().
+//
+extern chpl_bool chpl_fast_timer_use_counter;
+extern double chpl_fast_timer_ns_per_tick;   // 0 until calibrated
+extern uint64_t chpl_fast_timer_base;
+
+void chpl_fast_timer_init(void);
+void chpl_fast_timer_calibrate(void);
+
+static inline uint64_t chpl_fast_timer_monotonic_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000 + (uint64_t) ts.tv_nsec;
+}
+
+static inline uint64_t chpl_fast_timer_ticks(void) {
+  if (chpl_fast_timer_use_counter) {
+#if defined(__x86_64__)
+    uint32_t lo, hi;
+    __asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((uint64_t) hi << 32) | lo;
+#elif defined(__aarch64__)
+    uint64_t t;
+    __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(t));
+    return t;
+#endif
+  }
+  return chpl_fast_timer_monotonic_ns();
+}
+
+static inline uint64_t chpl_fast_timer_ticks_to_ns(uint64_t ticks) {
+  if (chpl_fast_timer_ns_per_tick == 0) {
+    chpl_fast_timer_calibrate();
+  }
+  return (uint64_t) ((double) ticks * chpl_fast_timer_ns_per_tick);
+}
+
+// ns since the runtime started
+static inline uint64_t chpl_fast_timer_ns(void) {
+  return chpl_fast_timer_ticks_to_ns(chpl_fast_timer_ticks()
+                                     - chpl_fast_timer_base);
+}
+
+static inline _real64 chpl_fast_timer_secs(void) {
+  return (_real64) chpl_fast_timer_ns() * 1.0e-9;
+}
+
 #endif // LAUNCHER
 
 #ifdef __cplusplus
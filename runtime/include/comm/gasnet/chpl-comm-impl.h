@@ -33,6 +33,36 @@ extern "C" {
     chpl_comm_impl_regMemHeapInfo(start_p, size_p)
 void chpl_comm_impl_regMemHeapInfo(void** start_p, size_t* size_p);
 
+//
+// Collectives.  GASNet-EX has these natively, except for allgather.
+// The type and op arguments are a chpl_comm_coll_type_t and a
+// chpl_comm_coll_op_t, which chpl-comm.h declares after including us.
+//
+#define CHPL_COMM_IMPL_BCAST(root, buf, size) \
+        chpl_comm_impl_bcast(root, buf, size)
+void chpl_comm_impl_bcast(c_nodeid_t root, void* buf, size_t size);
+
+#define CHPL_COMM_IMPL_REDUCE(root, src, dst, count, type, op) \
+        chpl_comm_impl_reduce(root, src, dst, count, type, op)
+void chpl_comm_impl_reduce(c_nodeid_t root, const void* src, void* dst,
+                           size_t count, int type, int op);
+
+#define CHPL_COMM_IMPL_ALLREDUCE(src, dst, count, type, op) \
+        chpl_comm_impl_allreduce(src, dst, count, type, op)
+void chpl_comm_impl_allreduce(const void* src, void* dst, size_t count,
+                              int type, int op);
+
+//
+// Task end and unordered fences send the remote frees we've batched.
+//
+#define CHPL_COMM_IMPL_UNORDERED_TASK_FENCE() \
+        chpl_comm_impl_unordered_task_fence()
+void chpl_comm_impl_unordered_task_fence(void);
+
+#define CHPL_COMM_IMPL_TASK_END() \
+        chpl_comm_impl_task_end()
+void chpl_comm_impl_task_end(void);
+
 #ifdef __cplusplus
 }
 #endif
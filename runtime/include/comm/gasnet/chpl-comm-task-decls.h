@@ -25,12 +25,16 @@
 #include "chpl-cache-task-decls.h"
 #define HAS_CHPL_CACHE_FNS
 
+// The task private data has room for message aggregation buffers.
+#define HAS_CHPL_COMM_AGGR_BUFF
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 typedef struct {
     chpl_cache_taskPrvData_t cache_data;
+    void* aggr_buff;
 } chpl_comm_taskPrvData_t;
 
 //
@@ -37,6 +37,15 @@ void chpl_comm_impl_regMemHeapInfo(void** start_p, size_t* size_p);
         chpl_comm_impl_regMemHeapPageSize()
 size_t chpl_comm_impl_regMemHeapPageSize(void);
 
+#define CHPL_COMM_IMPL_REG_MEM_DEVICE(p, size, subloc) \
+        chpl_comm_impl_regMemDevice(p, size, subloc)
+chpl_bool chpl_comm_impl_regMemDevice(void* p, size_t size,
+                                      c_sublocid_t subloc);
+
+#define CHPL_COMM_IMPL_REG_MEM_DEVICE_FREE(p, size) \
+        chpl_comm_impl_regMemDeviceFree(p, size)
+void chpl_comm_impl_regMemDeviceFree(void* p, size_t size);
+
 #ifdef __cplusplus
 }
 #endif
@@ -57,6 +66,15 @@ extern "C" {
         chpl_comm_impl_unordered_task_fence()
 void chpl_comm_impl_unordered_task_fence(void);
 
+#define CHPL_COMM_IMPL_PUT_FENCE() \
+        chpl_comm_impl_put_fence()
+void chpl_comm_impl_put_fence(void);
+
+//
+// Unordered PUTs are buffered and sent by ofi_put_V().
+//
+#define CHPL_COMM_IMPL_BUFFERED_UNORDERED_PUT() true
+
 #define CHPL_COMM_IMPL_TASK_CREATE() \
         chpl_comm_impl_task_create()
 void chpl_comm_impl_task_create(void);
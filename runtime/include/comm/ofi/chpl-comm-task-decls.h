@@ -33,6 +33,9 @@
 #include "chpl-cache-task-decls.h"
 #define HAS_CHPL_CACHE_FNS
 
+// The task private data has room for message aggregation buffers.
+#define HAS_CHPL_COMM_AGGR_BUFF
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -43,8 +46,10 @@ typedef struct {
   uint8_t amDone;               // delayed 'done' indicator
   chpl_cache_taskPrvData_t cache_data;
   void* amo_nf_buff;
+  void* amo_am_buff;
   void* get_buff;
   void* put_buff;
+  void* aggr_buff;
 } chpl_comm_taskPrvData_t;
 
 //
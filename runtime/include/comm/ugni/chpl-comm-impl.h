@@ -89,6 +89,11 @@ extern "C" {
         chpl_comm_impl_unordered_task_fence()
 void chpl_comm_impl_unordered_task_fence(void);
 
+//
+// Unordered PUTs are buffered and sent by do_remote_put_V().
+//
+#define CHPL_COMM_IMPL_BUFFERED_UNORDERED_PUT() true
+
 #define CHPL_COMM_IMPL_TASK_END() \
         chpl_comm_impl_task_end()
 void chpl_comm_impl_task_end(void);
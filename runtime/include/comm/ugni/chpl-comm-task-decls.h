@@ -30,6 +30,9 @@
 #include "chpl-cache-task-decls.h"
 #define HAS_CHPL_CACHE_FNS
 
+// The task private data has room for message aggregation buffers.
+#define HAS_CHPL_COMM_AGGR_BUFF
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -40,6 +43,7 @@ typedef struct {
   void* amo_nf_buff;
   void* get_buff;
   void* put_buff;
+  void* aggr_buff;
 } chpl_comm_taskPrvData_t;
 
 //
@@ -31,6 +31,12 @@
 
 #include "utf8-decoder.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -67,6 +73,42 @@ uint32_t chpl_enc_check_escape(const char* start, const char* end) {
   return 0;
 }
 
+/*
+ * Returns the number of leading bytes in `buf` that are ASCII, i.e. that
+ * have the high bit clear. Each of those bytes is a codepoint on its own,
+ * so callers can skip them without running the UTF-8 decoder.
+ *
+ * :arg buflen: Upper limit for number of bytes to read
+ */
+static inline
+ssize_t chpl_enc_ascii_prefix_len(const char* buf, ssize_t buflen)
+{
+  const unsigned char* p = (const unsigned char*)buf;
+  ssize_t i = 0;
+
+#if defined(__SSE2__)
+  for ( ; i + 16 <= buflen; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i*)(p + i));
+    if (_mm_movemask_epi8(v) != 0) break;
+  }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  for ( ; i + 16 <= buflen; i += 16) {
+    uint8x16_t v = vld1q_u8(p + i);
+    if (vmaxvq_u8(v) >= 0x80) break;
+  }
+#endif
+
+  // a word at a time, then a byte at a time to find the exact position
+  for ( ; i + 8 <= buflen; i += 8) {
+    uint64_t w;
+    memcpy(&w, p + i, sizeof(w));
+    if (w & UINT64_C(0x8080808080808080)) break;
+  }
+  while (i < buflen && p[i] < 0x80) i++;
+
+  return i;
+}
+
 /*
  * Decodes the char buffer `buf` using UTF8 encoding and writes the codepoint in
  * `chr`
@@ -87,8 +129,15 @@ int chpl_enc_decode_char_buf_utf8(int32_t* CHPL_ENC_RESTRICT chr,
   const char* end = start + buflen;
   uint32_t codepoint=0, state;
   int bytes_read = 0;
+
+  if (buflen > 0 && (unsigned char)*buf < 0x80) {
+    *chr = (unsigned char)*buf;
+    *nbytes = 1;
+    return 0;
+  }
+
   state = 0;
-  while( buf != end ) {
+  while( bytes_read < buflen ) {
     chpl_enc_utf8_decode(&state, &codepoint,
                          *((const unsigned char*)buf+bytes_read));
     bytes_read++;
@@ -212,10 +261,17 @@ static inline
 int chpl_enc_validate_buf(const char *buf, ssize_t buflen, int64_t *num_cp) {
   int32_t cp;
   int nbytes;
+  ssize_t ascii;
 
-  int offset = 0;
+  ssize_t offset = 0;
   *num_cp = 0;
   while (offset<buflen) {
+    // runs of ASCII are valid and one codepoint per byte
+    ascii = chpl_enc_ascii_prefix_len(buf+offset, buflen-offset);
+    offset += ascii;
+    *num_cp += ascii;
+    if (offset >= buflen) break;
+
     // you can create a chapel string with a codepoint that represents an
     // escaped byte, so the last argument is true
     if (chpl_enc_decode_char_buf_utf8(&cp, &nbytes, buf+offset,
@@ -244,8 +300,11 @@ char* chpl_enc_codepoint_at_idx(const char* buf,
   int nbytes = 0;
 
   ssize_t buflen = strlen(buf);
-  int offset = 0;
-  int at_char = -1;
+
+  // in an ASCII prefix, codepoint indices are byte offsets
+  ssize_t offset = chpl_enc_ascii_prefix_len(buf, buflen);
+  if (idx < offset) offset = idx;
+  ssize_t at_char = offset - 1;
 
   while (offset<buflen) {
     // you can create a chapel string with a codepoint that represents an
@@ -147,6 +147,36 @@ GPU_3OP_ATOMIC(unsigned int,           chpl_gpu_atomic_CAS_uint,      atomicCAS)
 GPU_3OP_ATOMIC(unsigned long long int, chpl_gpu_atomic_CAS_ulonglong, atomicCAS);
 // [*] GPU_3OP_ATOMIC(unsigned short int,     chpl_gpu_atomic_CAS_ushort, atomicCAS);
 
+// ============================
+// Warp-Aggregated Atomic Updates
+// ============================
+
+// The compiler calls these instead of the atomics above when a kernel
+// doesn't use the value an atomic returns. The CUDA versions combine the
+// values of a warp before doing the atomic; here they don't aggregate yet.
+
+#define GPU_WARP_AGGREGATED_ATOMIC(T, runtime_name, rocm_name)   \
+  __device__ static inline void runtime_name(T *x, T val) {      \
+    rocm_name(x, val);                                           \
+  }                                                              \
+  __host__ static inline void runtime_name(T *x, T val) {}
+
+GPU_WARP_AGGREGATED_ATOMIC(int,                chpl_gpu_warp_atomic_add_int,       atomicAdd);
+GPU_WARP_AGGREGATED_ATOMIC(unsigned int,       chpl_gpu_warp_atomic_add_uint,      atomicAdd);
+GPU_WARP_AGGREGATED_ATOMIC(unsigned long long, chpl_gpu_warp_atomic_add_ulonglong, atomicAdd);
+GPU_WARP_AGGREGATED_ATOMIC(float,              chpl_gpu_warp_atomic_add_float,     atomicAdd);
+GPU_WARP_AGGREGATED_ATOMIC(double,             chpl_gpu_warp_atomic_add_double,    atomicAdd);
+
+GPU_WARP_AGGREGATED_ATOMIC(int,                    chpl_gpu_warp_atomic_min_int,       atomicMin);
+GPU_WARP_AGGREGATED_ATOMIC(unsigned int,           chpl_gpu_warp_atomic_min_uint,      atomicMin);
+GPU_WARP_AGGREGATED_ATOMIC(unsigned long long int, chpl_gpu_warp_atomic_min_ulonglong, atomicMin);
+// [*] GPU_WARP_AGGREGATED_ATOMIC(long long int,          chpl_gpu_warp_atomic_min_longlong,  atomicMin);
+
+GPU_WARP_AGGREGATED_ATOMIC(int,                    chpl_gpu_warp_atomic_max_int,       atomicMax);
+GPU_WARP_AGGREGATED_ATOMIC(unsigned int,           chpl_gpu_warp_atomic_max_uint,      atomicMax);
+GPU_WARP_AGGREGATED_ATOMIC(unsigned long long int, chpl_gpu_warp_atomic_max_ulonglong, atomicMax);
+// [*] GPU_WARP_AGGREGATED_ATOMIC(long long int,          chpl_gpu_warp_atomic_max_longlong,  atomicMax);
+
 #endif // HAS_GPU_LOCALE
 
 #endif // _CHPL_GPU_GEN_INCLUDES_H
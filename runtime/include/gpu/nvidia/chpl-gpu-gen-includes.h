@@ -140,6 +140,55 @@ GPU_3OP_ATOMIC(unsigned long long int, chpl_gpu_atomic_CAS_ulonglong, atomicCAS)
 GPU_3OP_ATOMIC(unsigned short int,     chpl_gpu_atomic_CAS_ushort, atomicCAS);
 #endif
 
+// ============================
+// Warp-Aggregated Atomic Updates
+// ============================
+
+// The compiler calls these instead of the atomics above when a kernel
+// doesn't use the value an atomic returns (e.g. `gpuAtomicAdd(sum, x)` as a
+// reduction). When the whole warp updates the same location, its values
+// are combined with shuffles and a single thread does the atomic;
+// otherwise every thread does its own.
+
+#define GPU_COMBINE_ADD(a, b) ((a) + (b))
+#define GPU_COMBINE_MIN(a, b) ((b) < (a) ? (b) : (a))
+#define GPU_COMBINE_MAX(a, b) ((a) < (b) ? (b) : (a))
+
+#define GPU_WARP_AGGREGATED_ATOMIC(T, runtime_name, cuda_name, combine)    \
+  __device__ static inline void runtime_name(T *x, T val) {                \
+    const unsigned fullMask = 0xffffffffu;                                 \
+    if (__activemask() == fullMask) {                                      \
+      T* first = (T*)__shfl_sync(fullMask, (unsigned long long)x, 0);      \
+      if (__all_sync(fullMask, x == first)) {                              \
+        for (int offset = 16; offset > 0; offset /= 2) {                   \
+          val = combine(val, __shfl_down_sync(fullMask, val, offset));     \
+        }                                                                  \
+        if (__nvvm_read_ptx_sreg_laneid() == 0) {                          \
+          cuda_name(x, val);                                               \
+        }                                                                  \
+        return;                                                            \
+      }                                                                    \
+    }                                                                      \
+    cuda_name(x, val);                                                     \
+  }                                                                        \
+  __host__ static inline void runtime_name(T *x, T val) {}
+
+GPU_WARP_AGGREGATED_ATOMIC(int,                chpl_gpu_warp_atomic_add_int,       atomicAdd, GPU_COMBINE_ADD);
+GPU_WARP_AGGREGATED_ATOMIC(unsigned int,       chpl_gpu_warp_atomic_add_uint,      atomicAdd, GPU_COMBINE_ADD);
+GPU_WARP_AGGREGATED_ATOMIC(unsigned long long, chpl_gpu_warp_atomic_add_ulonglong, atomicAdd, GPU_COMBINE_ADD);
+GPU_WARP_AGGREGATED_ATOMIC(float,              chpl_gpu_warp_atomic_add_float,     atomicAdd, GPU_COMBINE_ADD);
+GPU_WARP_AGGREGATED_ATOMIC(double,             chpl_gpu_warp_atomic_add_double,    atomicAdd, GPU_COMBINE_ADD);
+
+GPU_WARP_AGGREGATED_ATOMIC(int,                    chpl_gpu_warp_atomic_min_int,       atomicMin, GPU_COMBINE_MIN);
+GPU_WARP_AGGREGATED_ATOMIC(unsigned int,           chpl_gpu_warp_atomic_min_uint,      atomicMin, GPU_COMBINE_MIN);
+GPU_WARP_AGGREGATED_ATOMIC(unsigned long long int, chpl_gpu_warp_atomic_min_ulonglong, atomicMin, GPU_COMBINE_MIN);
+GPU_WARP_AGGREGATED_ATOMIC(long long int,          chpl_gpu_warp_atomic_min_longlong,  atomicMin, GPU_COMBINE_MIN);
+
+GPU_WARP_AGGREGATED_ATOMIC(int,                    chpl_gpu_warp_atomic_max_int,       atomicMax, GPU_COMBINE_MAX);
+GPU_WARP_AGGREGATED_ATOMIC(unsigned int,           chpl_gpu_warp_atomic_max_uint,      atomicMax, GPU_COMBINE_MAX);
+GPU_WARP_AGGREGATED_ATOMIC(unsigned long long int, chpl_gpu_warp_atomic_max_ulonglong, atomicMax, GPU_COMBINE_MAX);
+GPU_WARP_AGGREGATED_ATOMIC(long long int,          chpl_gpu_warp_atomic_max_longlong,  atomicMax, GPU_COMBINE_MAX);
+
 #endif // HAS_GPU_LOCALE
 
 #endif // _CHPL_GPU_GEN_INCLUDES_H
@@ -70,6 +70,15 @@ c_sublocid_t chpl_rt_sublocFromLocaleID(chpl_localeID_t loc) {
   return loc.subloc;
 }
 
+//
+// The host and GPU share one memory on an APU, so array data doesn't
+// need to be fine-grained just to be visible to both; it only needs to
+// be for atomics or flags the two update while kernels run. Coarse-
+// grained memory gets the full GPU bandwidth, so that is what arrays get
+// unless they ask otherwise (see chpl_gpu_mem_array_alloc_policy()).
+//
+#define CHPL_LOCALE_MODEL_GPU_ARRAY_MEM_POLICY CHPL_GPU_MEM_POLICY_COARSE
+
 //
 // These functions are exported from the locale model for use by
 // the tasking layer to convert between a full sublocale and an
@@ -25,6 +25,7 @@
 
 #include <inttypes.h>
 #include "qbuffer.h"
+#include "qio.h"
 #include "qio_style.h"
 
 #ifdef __cplusplus
@@ -37,9 +38,24 @@ extern "C" {
 // under normal program flow.
 qbytes_t* bulk_get_bytes(int64_t src_locale, qbytes_t* src_addr);
 
+// Like bulk_get_bytes, but copies len bytes starting at src_offset
+// straight into dst rather than into a new qbytes_t.
+qioerr bulk_get_bytes_into(int64_t src_locale, qbytes_t* src_addr,
+                           int64_t src_offset, void* dst, int64_t len);
+
+// Copy the part of buf from start to end to dst_addr on dst_locale,
+// with the copies for the buffer's parts overlapping each other.
 qioerr bulk_put_buffer(int64_t dst_locale, void* dst_addr, int64_t dst_len,
                       qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end);
 
+// Read up to len bytes from ch into dst_addr on dst_locale, PUTting them
+// from the channel's buffer rather than copying them anywhere first.
+// *amt_read is set to the number of bytes read; reaching the end of the
+// file before len bytes returns EEOF.
+qioerr qio_channel_read_to_remote(const int threadsafe, qio_channel_t* ch,
+                                  int64_t dst_locale, void* dst_addr,
+                                  int64_t len, int64_t* amt_read);
+
 
 #ifdef __cplusplus
 }
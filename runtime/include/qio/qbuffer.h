@@ -163,6 +163,9 @@ void _qbytes_init_generic(qbytes_t* ret, void* give_data, int64_t len, qbytes_fr
 qioerr qbytes_create_generic(qbytes_t** out, void* give_data, int64_t len, qbytes_free_t free_function);
 qioerr _qbytes_init_iobuf(qbytes_t* ret);
 qioerr qbytes_create_iobuf(qbytes_t** out);
+// Like qbytes_create_iobuf, but a reused iobuf may hold stale data;
+// for callers that overwrite the bytes before reading them.
+qioerr qbytes_create_iobuf_uninit(qbytes_t** out);
 qioerr _qbytes_init_calloc(qbytes_t* ret, int64_t len);
 
 // The caller is responsible for calling qbytes_release on the return value.
@@ -472,11 +475,15 @@ qioerr qbuffer_memset(qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end,
 #ifdef _chplrt_H_
 
 #include "chpl-mem.h"
+#include "chpl-mem-arena.h"
 #define qio_malloc(size) chpl_mem_alloc(size, CHPL_RT_MD_IO_BUFFER, __LINE__, 0)
 #define qio_calloc(nmemb, size) chpl_mem_allocManyZero(nmemb, size, CHPL_RT_MD_IO_BUFFER, __LINE__, 0)
 #define qio_realloc(ptr, size) chpl_mem_realloc(ptr, size, CHPL_RT_MD_IO_BUFFER, __LINE__, 0)
 #define qio_memalign(boundary, size)  chpl_mem_memalign(boundary, size, CHPL_RT_MD_IO_BUFFER, __LINE__, 0)
 #define qio_free(ptr) chpl_mem_free(ptr, __LINE__, 0)
+// small, frequently made objects such as qbytes_t headers
+#define qio_small_calloc(size) chpl_mem_arena_allocZero(size, CHPL_RT_MD_IO_BUFFER, __LINE__, 0)
+#define qio_small_free(ptr) chpl_mem_arena_free(ptr, __LINE__, 0)
 #define qio_memcpy(dest, src, num) chpl_memcpy(dest, src, num)
 
 typedef chpl_bool qio_bool;
@@ -490,6 +497,8 @@ typedef chpl_bool qio_bool;
 #define qio_realloc(ptr, size) sys_realloc(ptr, size)
 #define qio_memalign(boundary, size) sys_memalign(boundary, size)
 #define qio_free(ptr) sys_free(ptr)
+#define qio_small_calloc(size) sys_calloc(1, size)
+#define qio_small_free(ptr) sys_free(ptr)
 #define qio_memcpy(dest, src, num) memcpy(dest, src, num)
 
 typedef bool qio_bool;
@@ -25,9 +25,11 @@
 #include "qbuffer.h"
 #include "qio.h"
 #include "qio_formatted.h"
+#include "qio_compress.h"
 #include "qio_regex.h"
 #include "qio_style.h"
 #include "bulkget.h"
 #include "sys.h"
 #include "qio_popen.h"
+#include "qio_collective.h"
 #include "qio_plugin_api.h"
@@ -53,6 +53,9 @@ typedef enum {
   QIO_FDFLAG_READABLE = 2,
   QIO_FDFLAG_WRITEABLE = 4,
   QIO_FDFLAG_SEEKABLE = 8,
+  // the descriptor has O_NONBLOCK set; reads and writes that would block
+  // let other tasks run and then try again.
+  QIO_FDFLAG_NONBLOCKING = 16,
 } qio_fdflag_t;
 
 typedef uint32_t qio_hint_t;
@@ -203,6 +206,18 @@ qioerr qio_send(fd_t sockfd, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_
               socklen_t ancillary_len,
               ssize_t* num_sent_out);
 
+// Send or receive a batch of messages, message i being starts[i] to
+// ends[i] in buf, with as few system calls as the system allows (see
+// sys_sendmmsg). num_msgs_out is the number of messages handled, which
+// can be fewer than nmsgs; num_sent_out/num_recvd_out (which can be
+// NULL) get the size of each. Receiving waits only for the first
+// message. If yield is set, the socket isn't waited on: the calling
+// task yields until at least one message can be handled, so a worker
+// isn't tied up by a quiet socket. MSG_ZEROCOPY can be passed in flags
+// for large sends; see sys_enable_zerocopy.
+qioerr qio_send_batch(fd_t sockfd, qbuffer_t* buf, const qbuffer_iter_t* starts, const qbuffer_iter_t* ends, int nmsgs, int flags, int yield, int* num_msgs_out, ssize_t* num_sent_out);
+qioerr qio_recv_batch(fd_t sockfd, qbuffer_t* buf, const qbuffer_iter_t* starts, const qbuffer_iter_t* ends, int nmsgs, int flags, int yield, int* num_msgs_out, ssize_t* num_recvd_out);
+
 typedef enum {
   QIO_CH_ALWAYS_UNBUFFERED = 1,
   QIO_CH_ALWAYS_BUFFERED,
@@ -228,6 +243,14 @@ char* qio_chtype_to_string(qio_chtype_t type);
      -- noreuse -- pread/pwrite
      -- cached -- mmap for reads and writes
      -- force_readwrite
+     -- iouring -- like pread/pwrite, but through io_uring; only used when
+                   asked for (or with CHPL_RT_QIO_IO_URING set), and falls
+                   back to pread/pwrite if io_uring isn't available
+     -- direct -- like pread/pwrite, but bypasses the page cache with O_DIRECT
+                  wherever the offset and length are block aligned; only
+                  used when asked for. Unaligned heads and tails still go
+                  through the page cache, and it acts like pread/pwrite where
+                  O_DIRECT isn't supported.
  */
 
 #define QIO_HINT_AFTERCHTYPE 0x0010
@@ -238,13 +261,15 @@ typedef enum {
   QIO_METHOD_FREADFWRITE = 3*QIO_HINT_AFTERCHTYPE,
   QIO_METHOD_MMAP = 4*QIO_HINT_AFTERCHTYPE,
   QIO_METHOD_MEMORY = 5*QIO_HINT_AFTERCHTYPE,
+  QIO_METHOD_IOURING = 6*QIO_HINT_AFTERCHTYPE,
+  QIO_METHOD_DIRECT = 7*QIO_HINT_AFTERCHTYPE,
   //QIO_METHOD_LIBEVENT,
 } qio_method_t;
 #define QIO_METHODMASK 0x00f0
 #define QIO_HINT_AFTERMETHOD 0x0100
 #define QIO_METHOD_DEFAULT 0
 #define QIO_MIN_METHOD QIO_METHOD_READWRITE
-#define QIO_MAX_METHOD QIO_METHOD_MEMORY
+#define QIO_MAX_METHOD QIO_METHOD_DIRECT
 
 enum {
   QIO_HINT_RANDOM       = QIO_HINT_AFTERMETHOD,
@@ -279,6 +304,11 @@ enum {
   // is opened within the qio implementation.  Otherwise, the user (or system)
   // has to close it.
   QIO_HINT_OWNED        = QIO_HINT_NOFAST<<1,
+
+  // Write filled buffers from a background thread instead of on the
+  // writing task (pread/pwrite and io_uring methods only).  Flushing
+  // waits for those writes to finish.
+  QIO_HINT_WRITEBEHIND  = QIO_HINT_OWNED<<1,
 };
 
 
@@ -339,6 +369,12 @@ char* qio_hints_to_string(qio_hint_t hint)
       case QIO_METHOD_MEMORY:
         strcat(buf, " memory"); ok = 1;
         break;
+      case QIO_METHOD_IOURING:
+        strcat(buf, " iouring"); ok = 1;
+        break;
+      case QIO_METHOD_DIRECT:
+        strcat(buf, " direct_io"); ok = 1;
+        break;
       // no default to get warned if any are added.
     }
   }
@@ -355,6 +391,7 @@ char* qio_hints_to_string(qio_hint_t hint)
   if( hint & QIO_HINT_NOREUSE ) strcat(buf, " noreuse");
   if( hint & QIO_HINT_NOFAST ) strcat(buf, " nofast");
   if( hint & QIO_HINT_OWNED ) strcat(buf, " owned");
+  if( hint & QIO_HINT_WRITEBEHIND ) strcat(buf, " writebehind");
 
   return qio_strdup(buf);
 }
@@ -372,6 +409,8 @@ typedef struct qio_file_s {
   // An (arguably) better solution is to put
   FILE* fp; // set if this file wraps a FILE*
   fd_t fd; // -1 if not set
+  fd_t direct_fd; // a second descriptor opened with O_DIRECT for
+                  // QIO_METHOD_DIRECT; negative if not (yet) opened
   int use_fp; // we only default to FREADFWRITE if this and fp are set.
   qbuffer_t* buf; // NULL if not set.
                   // if set, fp==NULL, fd==-1, is memory-only file.
@@ -426,6 +465,12 @@ typedef struct qio_file_s {
   qio_lock_t lock;
   int64_t max_initial_position;
 
+  // Jobs queued for the write-behind thread and the first error from
+  // them; both protected by the write-behind queue's lock, not by
+  // the file's lock.
+  int64_t wb_pending;
+  qioerr wb_err;
+
   qio_style_t style;
 } qio_file_t;
 
@@ -435,6 +480,10 @@ qioerr qio_readv(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer
 qioerr qio_writev(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, ssize_t* num_written);
 qioerr qio_preadv(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_read);
 qioerr qio_pwritev(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_written);
+qioerr qio_uring_preadv(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_read);
+qioerr qio_uring_pwritev(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_written);
+qioerr qio_direct_preadv(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_read);
+qioerr qio_direct_pwritev(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_written);
 
 // if fp is not null, fd is ignored; if fp is null, we use fd.
 // the QIO file takes ownership of fp or fd, closing it when the QIO file is closed.
@@ -531,6 +580,27 @@ void* qio_file_get_plugin(qio_file_t* f) {
 // Calls fflush on a FILE* first.
 qioerr qio_file_length(qio_file_t* f, int64_t *len_out);
 
+// A view maps part of a file directly into memory so its contents can
+// be used in place, for example as the elements of an external array
+// (see chpl_make_external_array_ptr), instead of being read through a
+// channel.  The view is read-only unless copy_on_write is set, in which
+// case it can be modified but the changes are private and never reach
+// the file.  hints are applied with qio_madvise_for_hints; 0 means use
+// the file's hints.  len < 0 views through the end of the file, and a
+// view that would pass the end of the file is truncated there.
+//
+// Only files backed by a file descriptor can be viewed.  view->data is
+// valid until qio_file_view_release, which may be called after the file
+// itself has been closed.
+typedef struct qio_file_view_s {
+  void* data;      // the first byte at start
+  int64_t len;     // the number of bytes at data
+  qbytes_t* map;   // owns the mapping; NULL for an empty view
+} qio_file_view_t;
+
+qioerr qio_file_view(qio_file_t* f, int64_t start, int64_t len, int copy_on_write, qio_hint_t hints, qio_file_view_t* view_out);
+void qio_file_view_release(qio_file_view_t* view);
+
 /* CHANNELS ..... */
 
 /* A Read and Write Buffered channels support:
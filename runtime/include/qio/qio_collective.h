@@ -0,0 +1,112 @@
+/*
+ * Copyright 2020-2023 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _QIO_COLLECTIVE_H_
+#define _QIO_COLLECTIVE_H_
+
+#include "sys_basic.h"
+#include "qio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Support for collective (two-phase) writes to a shared file.
+//
+// Instead of every locale writing its own pieces of a file region, the
+// region is split into stripe-aligned spans, one per aggregator. Writers
+// hand their pieces to the aggregator whose span contains them
+// (qio_collective_buffer_add, run on the aggregator's locale), and each
+// aggregator then writes the pieces it holds with a few large pwritev
+// calls (qio_collective_buffer_flush). No two aggregators write to the same
+// stripe, so file systems that lock by stripe (Lustre, GPFS) don't have to
+// move locks between writers.
+//
+// Moving the pieces between locales is left to the caller.
+
+typedef struct qio_collective_layout_s {
+  int64_t start;           // first byte of the region being written
+  int64_t end;             // one past the last byte of the region
+  int64_t stripe;          // the file system's stripe size
+  int64_t aligned_start;   // start, rounded down to a stripe boundary
+  int64_t span;            // bytes per aggregator, a multiple of stripe
+  int64_t num_aggregators;
+} qio_collective_layout_t;
+
+// Computes the layout for writing [start, end) of fl with at most
+// max_aggregators aggregators. The stripe size comes from qio_get_chunk
+// when stripe is 0.
+qioerr qio_collective_layout_init(qio_collective_layout_t* layout,
+                                  qio_file_t* fl,
+                                  int64_t start, int64_t end,
+                                  int64_t stripe,
+                                  int64_t max_aggregators);
+
+// Returns the aggregator that writes the byte at offset.
+int64_t qio_collective_aggregator_for(const qio_collective_layout_t* layout,
+                                      int64_t offset);
+
+// Returns the part of the region aggregator agg writes as [*start, *end).
+// The part is empty when *start == *end.
+void qio_collective_aggregator_region(const qio_collective_layout_t* layout,
+                                      int64_t agg,
+                                      int64_t* start_out, int64_t* end_out);
+
+typedef struct qio_collective_piece_s {
+  int64_t offset;
+  int64_t len;
+  void* data;
+} qio_collective_piece_t;
+
+typedef struct qio_collective_buffer_s {
+  qio_file_t* file;
+  qio_lock_t lock;
+  qio_collective_piece_t* pieces;
+  size_t num_pieces;
+  size_t max_pieces;
+  int64_t buffered;        // total bytes in pieces
+  int64_t max_buffered;    // flush once more than this is buffered
+} qio_collective_buffer_t;
+
+// Creates an aggregator's buffer for writes to the file. A max_buffered of 0
+// only writes the pieces when qio_collective_buffer_flush is called.
+qioerr qio_collective_buffer_create(qio_collective_buffer_t** buf_out,
+                                    qio_file_t* file,
+                                    int64_t max_buffered);
+
+// Copies [data, data+len) into the buffer, to be written at offset.
+// Pieces may be added concurrently and in any order. Pieces that overlap
+// are written in an unspecified order.
+qioerr qio_collective_buffer_add(qio_collective_buffer_t* buf,
+                                 int64_t offset, const void* data,
+                                 int64_t len);
+
+// Writes out and releases all the pieces in the buffer, coalescing pieces
+// that are adjacent in the file into single writes.
+qioerr qio_collective_buffer_flush(qio_collective_buffer_t* buf);
+
+// Frees the buffer, discarding any pieces that were not flushed.
+void qio_collective_buffer_destroy(qio_collective_buffer_t* buf);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
+
+#endif
@@ -0,0 +1,127 @@
+/*
+ * Copyright 2020-2023 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _QIO_COMPRESS_H_
+#define _QIO_COMPRESS_H_
+
+#include "sys_basic.h"
+#include "qio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Seekable compressed files.
+ *
+ * The data is cut into frames of a fixed uncompressed size (the last
+ * one may be shorter) and each frame is compressed on its own, so any
+ * frame can be decompressed without reading the ones before it. The
+ * frames are followed by an index giving each frame's compressed and
+ * uncompressed size, and then a fixed-size footer:
+ *
+ *   frame 0 | frame 1 | ... | index | footer
+ *
+ *   index:  for each frame, compressed size and uncompressed size
+ *           (uint64_t each)
+ *   footer: magic (8 bytes), codec (uint32_t), version (uint32_t),
+ *           number of frames (uint64_t), frame size (uint64_t)
+ *
+ * All integers are little-endian.
+ *
+ * Writers compress frames as they fill, or compress them elsewhere
+ * (e.g. in parallel tasks, with qio_codec_compress) and add them in
+ * order with qio_frame_writer_add_compressed. Readers load the index
+ * once and can then decompress any frames, from any number of tasks.
+ *
+ * zstd and lz4 are supported when the runtime is built with HAS_ZSTD or
+ * HAS_LZ4 and linked with the library; QIO_CODEC_NONE stores frames
+ * as they are.
+ */
+
+typedef enum {
+  QIO_CODEC_NONE = 0,
+  QIO_CODEC_ZSTD = 1,
+  QIO_CODEC_LZ4 = 2,
+} qio_codec_t;
+
+#define QIO_FRAME_DEFAULT_SIZE (4*1024*1024)
+
+int qio_codec_available(qio_codec_t codec);
+
+// The most space compressing len bytes can take.
+size_t qio_codec_bound(qio_codec_t codec, size_t len);
+
+// Compress len bytes into dst, which has room for cap bytes.
+// These are thread-safe.
+qioerr qio_codec_compress(qio_codec_t codec, int level,
+                          const void* src, size_t len,
+                          void* dst, size_t cap, size_t* len_out);
+// Decompress a frame known to hold exactly dst_len bytes.
+qioerr qio_codec_decompress(qio_codec_t codec,
+                            const void* src, size_t len,
+                            void* dst, size_t dst_len);
+
+typedef struct qio_frame_writer_s qio_frame_writer_t;
+
+// Frames are written to ch starting at its current position. ch must
+// stay open until qio_frame_writer_close, which also frees the writer.
+qioerr qio_frame_writer_create(qio_frame_writer_t** w_out, qio_channel_t* ch,
+                               qio_codec_t codec, int level,
+                               int64_t frame_size);
+qioerr qio_frame_writer_write(qio_frame_writer_t* w,
+                              const void* ptr, int64_t len);
+// Add a frame that was already compressed with w's codec. Any data
+// buffered by qio_frame_writer_write must have filled a whole frame.
+qioerr qio_frame_writer_add_compressed(qio_frame_writer_t* w,
+                                       const void* cdata, int64_t clen,
+                                       int64_t ulen);
+qioerr qio_frame_writer_close(qio_frame_writer_t* w);
+
+typedef struct qio_frame_index_s {
+  qio_codec_t codec;
+  int64_t nframes;
+  int64_t frame_size;
+  // nframes+1 entries each; frame i is coffset[i] to coffset[i+1] in
+  // the file and uoffset[i] to uoffset[i+1] in the uncompressed data.
+  int64_t* coffset;
+  int64_t* uoffset;
+} qio_frame_index_t;
+
+// Read the index of compressed data that ends at end (-1 for the
+// end of the file). The data need not start at the beginning of the
+// file.
+qioerr qio_frame_index_read(qio_file_t* f, int64_t end,
+                            qio_frame_index_t* idx_out);
+void qio_frame_index_destroy(qio_frame_index_t* idx);
+
+// Return the frame holding uncompressed offset uoff, or nframes if
+// there isn't one.
+int64_t qio_frame_index_find(const qio_frame_index_t* idx, int64_t uoff);
+
+// Decompress frame i into dst, which must have room for its
+// uncompressed size. This is thread-safe.
+qioerr qio_frame_read(qio_file_t* f, const qio_frame_index_t* idx,
+                      int64_t i, void* dst);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
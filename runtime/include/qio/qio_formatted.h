@@ -191,6 +191,15 @@ qioerr qio_channel_read_svarint(const int threadsafe, qio_channel_t* restrict ch
 qioerr qio_channel_write_uvarint(const int threadsafe, qio_channel_t* restrict ch, uint64_t num);
 qioerr qio_channel_write_svarint(const int threadsafe, qio_channel_t* restrict ch, int64_t num);
 
+// Reading/writing a contiguous array of nelts elements of elt_size bytes,
+// taking the channel lock once for the whole transfer.  When byteorder
+// differs from the host's, elt_size must be 1, 2, 4 or 8 and the
+// elements are swapped a block at a time (in place, for reads).  Large
+// transfers that don't need swapping go straight between the caller's
+// buffer and the file, without being copied through the channel buffer.
+qioerr qio_channel_read_array(const int threadsafe, const int byteorder, qio_channel_t* restrict ch, void* restrict ptr, size_t elt_size, int64_t nelts);
+qioerr qio_channel_write_array(const int threadsafe, const int byteorder, qio_channel_t* restrict ch, const void* restrict ptr, size_t elt_size, int64_t nelts);
+
 
 static inline
 qioerr qio_channel_read_int(const int threadsafe, const int byteorder, qio_channel_t* restrict ch, void* restrict ptr, size_t len, int issigned) {
@@ -398,6 +407,18 @@ qioerr qio_channel_write_complex(const int threadsafe, const int byteorder, qio_
 //  + -- nonzero positive -- read exactly this length.
 qioerr qio_channel_read_string(const int threadsafe, const int byteorder, const int64_t str_style, qio_channel_t* restrict ch, const char* restrict * restrict out, int64_t* restrict len_out, ssize_t maxlen_bytes);
 
+// Divide [start, end) of a file into 'nchunks' ranges that can be read
+// in parallel, each one ending just after a 'term' byte (e.g. '\n'), so
+// no record is split between two ranges.  'end' may be INT64_MAX, meaning
+// the end of the file.  On return, chunk i is [bounds_out[i],
+// bounds_out[i+1]), where bounds_out must have room for nchunks+1 offsets.
+// A chunk can be empty if a single record spans a whole split.  Open a
+// reading channel per chunk with qio_channel_create to consume them.
+// Finding each boundary reads only the bytes between the nominal split
+// point and the next terminator, straight from the mapping if the file
+// uses QIO_METHOD_MMAP and is mapped.
+qioerr qio_file_split_records(qio_file_t* f, qio_hint_t hints, int64_t start, int64_t end, uint8_t term, int64_t nchunks, int64_t* bounds_out);
+
 // string binary style:
 // QIO_BINARY_STRING_STYLE_LEN1B_DATA -1 -- 1 byte of length before
 // QIO_BINARY_STRING_STYLE_LEN2B_DATA -2 -- 2 bytes of length before
@@ -671,6 +692,70 @@ int32_t qio_skip_json_field_unlocked(qio_channel_t* restrict ch);
 
 qioerr qio_channel_skip_json_field(const int threadsafe, qio_channel_t* ch);
 
+// JSON tapes.
+//
+// A tape describes one JSON value as a flat list of entries in document
+// order: an object is followed by its keys and values (alternating), an
+// array by its elements. The entries hold byte offsets into the text
+// rather than copies, and each one knows where the entry after it and
+// everything it contains is, so a value can be skipped without looking
+// inside it.
+//
+// Structural characters are found 64 bytes at a time, and the skip
+// routines above use the same scan on whatever is already in the
+// channel's buffer before falling back to reading a byte at a time.
+typedef enum {
+  QIO_JSON_OBJECT = 1,
+  QIO_JSON_ARRAY,
+  QIO_JSON_STRING, // start and end include the quotes
+  QIO_JSON_NUMBER,
+  QIO_JSON_TRUE,
+  QIO_JSON_FALSE,
+  QIO_JSON_NULL,
+} qio_json_type_t;
+
+typedef struct qio_json_tape_entry_s {
+  int64_t start; // offset of the value's first byte in the text
+  int64_t end;   // offset just past its last byte
+  int64_t next;  // index of the entry following this value
+  int32_t type;  // a qio_json_type_t
+} qio_json_tape_entry_t;
+
+typedef struct qio_json_tape_s {
+  const char* text;
+  qio_json_tape_entry_t* entries;
+  int64_t n;
+  int64_t cap;
+  char* buf; // holds the text for qio_channel_read_json_tape
+  int64_t buf_cap;
+} qio_json_tape_t;
+
+#define QIO_JSON_MAX_DEPTH 512
+
+void qio_json_tape_init(qio_json_tape_t* t);
+void qio_json_tape_destroy(qio_json_tape_t* t);
+
+// Build a tape for the JSON value at the start of text, which may be
+// preceded by whitespace. The tape refers to text, so it has to stay
+// around. *used_out, if not NULL, is set to the number of bytes up to
+// the end of the value. Returns EEOF if there is only whitespace and
+// EFORMAT if the value is invalid or nested more than
+// QIO_JSON_MAX_DEPTH deep.
+qioerr qio_json_tape_parse(qio_json_tape_t* t, const char* text, int64_t len,
+                           int64_t* used_out);
+
+// Read the next JSON value from ch into t, keeping a copy of its text
+// in t. Line-delimited JSON can be read by calling this repeatedly
+// until it returns EEOF.
+qioerr qio_channel_read_json_tape(const int threadsafe, qio_channel_t* ch,
+                                  qio_json_tape_t* t);
+
+// Return the index of the value for the field named name in the object
+// at entry i, or -1 if there is no such field. Names are compared with
+// the keys as they appear in the text, escapes and all.
+int64_t qio_json_tape_find_field(const qio_json_tape_t* t, int64_t i,
+                                 const char* name, int64_t namelen);
+
 enum {
   QIO_CONV_UNK = 0,
   QIO_CONV_ARG_TYPE_NUMERIC,
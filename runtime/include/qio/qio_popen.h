@@ -35,6 +35,9 @@ extern "C" {
 #define QIO_FD_PIPE (-3)
 #define QIO_FD_TO_STDOUT (-4)
 #define QIO_FD_BUFFERED_PIPE (-5)
+// Like QIO_FD_PIPE, but the parent's end is non-blocking, so that
+// reading or writing it lets other tasks run while the pipe isn't ready.
+#define QIO_FD_NONBLOCKING_PIPE (-6)
 
 // Helper functions to allocate/free memory available
 // to a forked child process
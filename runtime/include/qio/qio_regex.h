@@ -142,6 +142,50 @@ int64_t qio_regex_replace(qio_regex_t* regex, const char* repl, int64_t repl_len
 //
 qioerr qio_regex_channel_match(const qio_regex_t* regex, const int threadsafe, struct qio_channel_s* ch, int64_t maxlen, int anchor, qio_bool can_discard, qio_bool keep_unmatched, qio_bool keep_whole_pattern, qio_regex_string_piece_t* submatch, int64_t nsubmatch);
 
+// A set of patterns that are all matched in one pass over the text,
+// for when the question is which of many patterns occur rather than
+// where one of them does.
+typedef struct qio_regex_set_s {
+  void* set;
+} qio_regex_set_t;
+
+static inline
+qio_regex_set_t qio_regex_set_null(void)
+{
+  qio_regex_set_t ret;
+  ret.set = NULL;
+  return ret;
+}
+
+// Create an empty set. Every pattern added uses 'options', and 'anchor'
+// is one of the QIO_REGEX_ANCHOR_ values. The set must be released.
+void qio_regex_set_create(const qio_regex_options_t* options, int anchor, qio_regex_set_t* set);
+void qio_regex_set_release(qio_regex_set_t* set);
+
+// Add a pattern before the set is compiled. Returns its index, which is
+// what the match functions report, or -1 if the pattern is invalid or
+// the set is already compiled. On error, if err_str is not NULL, it is
+// set to a message that must be freed by the caller (made with qio_malloc).
+int64_t qio_regex_set_add(qio_regex_set_t* set, const char* str, int64_t str_len, const char** err_str);
+
+// Compile the set once all patterns are added. Returns false if RE2
+// ran out of memory.
+qio_bool qio_regex_set_compile(qio_regex_set_t* set);
+
+// Match every pattern in the set against str[startpos, endpos).
+// Stores up to nmatches indices of matching patterns in increasing
+// order in matches, and returns how many patterns matched, which can
+// be more than nmatches. Returns -1 if the set is not compiled or the
+// match ran out of memory.
+int64_t qio_regex_set_match(const qio_regex_set_t* set, const char* str, int64_t str_len, int64_t startpos, int64_t endpos, int64_t* matches, int64_t nmatches);
+
+// Read up to maxlen bytes from the channel and match the set against
+// them as one piece of text, as qio_regex_set_match does. The channel is
+// left after the bytes read, and *nread_out is how many there were. The
+// number of matching patterns is returned in *nfound_out.
+// Returns EEOF if there was nothing left to read.
+qioerr qio_regex_set_channel_match(const qio_regex_set_t* set, const int threadsafe, struct qio_channel_s* ch, int64_t maxlen, int64_t* matches, int64_t nmatches, int64_t* nfound_out, int64_t* nread_out);
+
 #ifdef __cplusplus
 } // end extern "C"
 #endif
@@ -204,6 +204,15 @@ qio_err_t sys_writev(fd_t fd, const struct iovec* iov, int iovcnt, ssize_t* num_
 qio_err_t sys_preadv(fd_t fd, const struct iovec* iov, int iovcnt, off_t seek_to_offset, ssize_t* num_read_out);
 qio_err_t sys_pwritev(fd_t fd, const struct iovec* iov, int iovcnt, off_t seek_to_offset, ssize_t* num_written_out);
 
+// These behave like sys_preadv/sys_pwritev but go through a shared
+// io_uring, yielding the calling task while the kernel does the I/O.
+// An iovec too long for one request is split into several that are
+// all submitted together.  Without io_uring support (see
+// sys_uring_available) they just call sys_preadv/sys_pwritev.
+int sys_uring_available(void);
+qio_err_t sys_uring_preadv(fd_t fd, const struct iovec* iov, int iovcnt, off_t seek_to_offset, ssize_t* num_read_out);
+qio_err_t sys_uring_pwritev(fd_t fd, const struct iovec* iov, int iovcnt, off_t seek_to_offset, ssize_t* num_written_out);
+
 qio_err_t sys_fsync(fd_t fd);
 
 qio_err_t sys_fcntl(fd_t fd, int cmd, int* ret);
@@ -279,6 +288,32 @@ qio_err_t sys_sendto(fd_t sockfd, const void* buf, int64_t len, int flags, const
 
 qio_err_t sys_sendmsg(fd_t sockfd, const struct msghdr *msg, int flags, ssize_t* num_sent_out);
 
+// One message for sys_sendmmsg/sys_recvmmsg. This has the same layout
+// as Linux's struct mmsghdr, which is only declared with _GNU_SOURCE.
+typedef struct sys_mmsghdr_s {
+  struct msghdr msg_hdr;
+  unsigned int msg_len; // set to the bytes sent or received
+} sys_mmsghdr_t;
+
+// Send or receive up to vlen messages, with one system call where the
+// system has sendmmsg/recvmmsg and with one sendmsg/recvmsg per message
+// elsewhere. Receiving waits (on a blocking socket) only for the first
+// message. num_msgs_out is the number of messages handled; an error is
+// returned only if that's 0.
+qio_err_t sys_sendmmsg(fd_t sockfd, sys_mmsghdr_t* msgvec, unsigned int vlen, int flags, int* num_msgs_out);
+qio_err_t sys_recvmmsg(fd_t sockfd, sys_mmsghdr_t* msgvec, unsigned int vlen, int flags, int* num_msgs_out);
+
+// Zero-copy sends (Linux MSG_ZEROCOPY): after sys_enable_zerocopy, a
+// send with MSG_ZEROCOPY in its flags leaves its data in place until the
+// kernel is done with it, so it must not be changed or freed until
+// sys_zerocopy_completed reports it. Zero-copy sends on a socket are
+// numbered from 0, and each completion covers sends lo_out to hi_out,
+// inclusive. sys_zerocopy_completed returns EAGAIN when there are no
+// completions to report, and both return ENOTSUP where this isn't
+// supported.
+qio_err_t sys_enable_zerocopy(fd_t sockfd);
+qio_err_t sys_zerocopy_completed(fd_t sockfd, uint32_t* lo_out, uint32_t* hi_out);
+
 
 qio_err_t sys_setsockopt(fd_t sockfd, int level, int optname, void* optval, socklen_t optlen);
 
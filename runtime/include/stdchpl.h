@@ -50,6 +50,7 @@
 #include "chpl-export-wrappers.h"
 #include "chpl-external-array.h"
 #include "chpl-file-utils.h"
+#include "chpl-fn-prof.h"
 #include "chpl-gpu.h"
 #include "chpl-gpu-diags.h"
 #include "chplglob.h"
@@ -62,6 +63,7 @@
 #include "chplmemtrack.h"
 #include "chpl-prefetch.h"
 #include "chpl-privatization.h"
+#include "chpl-reduce.h"
 #include "chpl-string.h"
 #include "chplsys.h"
 #include "chpl-tasks.h"
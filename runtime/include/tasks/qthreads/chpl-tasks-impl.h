@@ -64,6 +64,7 @@ typedef struct {
     int       is_full;
     aligned_t signal_full;
     aligned_t signal_empty;
+    uint32_t  spin_est;     // see chpl-sync-spin.h
 } chpl_sync_aux_t;
 
 #ifdef __cplusplus
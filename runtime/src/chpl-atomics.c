@@ -0,0 +1,57 @@
+/*
+ * Copyright 2020-2023 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Out-of-line state for the atomics implementations that need it: the
+// lock table for the locks-based one on platforms it can't do natively.
+//
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE   // for PTHREAD_ADAPTIVE_MUTEX_INITIALIZER_NP
+#endif
+
+#include "chplrt.h"
+
+#include "chpl-atomics.h"
+
+#ifdef CHPL_ATOMICS_LOCK_STRIPES
+
+#if defined(PTHREAD_ADAPTIVE_MUTEX_INITIALIZER_NP)
+ #define STRIPE_INIT { PTHREAD_ADAPTIVE_MUTEX_INITIALIZER_NP }
+#else
+ #define STRIPE_INIT { PTHREAD_MUTEX_INITIALIZER }
+#endif
+
+#define STRIPE_INIT_4   STRIPE_INIT, STRIPE_INIT, STRIPE_INIT, STRIPE_INIT
+#define STRIPE_INIT_16  STRIPE_INIT_4, STRIPE_INIT_4, STRIPE_INIT_4, \
+                        STRIPE_INIT_4
+#define STRIPE_INIT_64  STRIPE_INIT_16, STRIPE_INIT_16, STRIPE_INIT_16, \
+                        STRIPE_INIT_16
+#define STRIPE_INIT_256 STRIPE_INIT_64, STRIPE_INIT_64, STRIPE_INIT_64, \
+                        STRIPE_INIT_64
+
+#if CHPL_ATOMICS_LOCK_STRIPES != 256
+ #error Update STRIPE_INIT_* to match CHPL_ATOMICS_LOCK_STRIPES.
+#endif
+
+chpl_atomic_lock_stripe_t
+  chpl_atomic_lock_stripes[CHPL_ATOMICS_LOCK_STRIPES] = { STRIPE_INIT_256 };
+
+#endif
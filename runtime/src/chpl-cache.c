@@ -196,7 +196,10 @@ then by copying the newly gotten data out of the cache and into the request
 buffer.
 
 When processing GETs on adjacent memory locations, the cache triggers
-both synchronous and asynchronous read-ahead.
+both synchronous and asynchronous read-ahead. For GETs that miss at a
+regular distance from each other (strided or reverse walks), a stride
+prefetcher that tracks recent misses per task and remote node starts
+nonblocking GETs for the next few elements of the stream.
 
 When processing a PUT, we similarly check for the requested cache page in the
 pointer tree and use an unused page if not. We find a unused 'dirty entry' to
@@ -245,6 +248,12 @@ the sequence number of the last acquire barrier. If a task performs a GET but
 finds a cache entry with a minimum sequence number before its last acquire
 barrier, it must invalidate that cache line and do a new GET.
 
+Optionally (with CHPL_RT_CACHE_SHARED=true), GETs that miss in the
+per-pthread cache can be served from a node-wide read-only cache shared by all
+of the threads on a locale, so that many threads reading the same remote pages
+do not each need to GET and store them. See the comments with
+shared_cache_get() for how it stays consistent with the fences above.
+
 Lastly, since the implementation uses thread-local storage for the cache, it
 requires that tasks not move between threads. Tasks could move between threads
 if we had a way to notify the cache that they were about to do so (in which
@@ -310,28 +319,59 @@ use.
 // Controls the cache page size - the cache manages items of this many bytes
 // but also includes facilities for partial pages (valid and dirty bits).
 //
-// Reasonable values for CACHEPAGE_BITS are between 6 and 12
-// (64 bytes and 4k bytes. CACHEPAGE_BITS should not be larger than the
-// page size) and it must currently be even.
-// Here we set it to 1k bytes (ie 2^10).
-#define CACHEPAGE_BITS 10
+// This is chosen at startup (see cache_configure()) from
+// CHPL_RT_CACHE_PAGE_SIZE, and can be between CACHEPAGE_MIN_BITS and
+// CACHEPAGE_MAX_BITS (64 bytes and 16k bytes). It should not be
+// larger than the system page size, and it must currently be even
+// (so the page size is a power of 4).
+// By default we set it to 1k bytes (ie 2^10).
+#define CACHEPAGE_MIN_BITS 6
+#define CACHEPAGE_MAX_BITS 14
+#define CACHEPAGE_DEFAULT_BITS 10
+static int cache_page_bits = CACHEPAGE_DEFAULT_BITS;
+#define CACHEPAGE_BITS cache_page_bits
 #define CACHEPAGE_SIZE (1 << CACHEPAGE_BITS)
 #define CACHEPAGE_MASK (CACHEPAGE_SIZE-1)
+#define CACHEPAGE_MAX_SIZE (1 << CACHEPAGE_MAX_BITS)
 
 // CACHELINE_BITS
 // Controls the cache line size - that is, the minimum number of bytes
 // that are fetched for any 'get' operation.
 //
-// Reasonable values for CACHELINE_BITS are between 6 and CACHEPAGE_BITS.
-// Here we set it to 64 bytes (ie 2^6)
-#define CACHELINE_BITS 6
+// This is chosen at startup from CHPL_RT_CACHE_LINE_SIZE and can be
+// between CACHELINE_MIN_BITS and CACHEPAGE_BITS.
+// By default we set it to 64 bytes (ie 2^6)
+#define CACHELINE_MIN_BITS 6
+#define CACHELINE_DEFAULT_BITS 6
+static int cache_line_bits = CACHELINE_DEFAULT_BITS;
+#define CACHELINE_BITS cache_line_bits
 #define CACHELINE_SIZE (1 << CACHELINE_BITS)
 #define CACHELINE_MASK (CACHELINE_SIZE-1)
 
+// How many pages are in each pthread's cache? Set by cache_configure().
+// The default is a 1 MiB cache.
+#define CACHE_DEFAULT_SIZE (1024*1024)
+static int cache_num_pages = CACHE_DEFAULT_SIZE >> CACHEPAGE_DEFAULT_BITS;
+
+// What percentage of the cache pages are used for the 2Q Ain queue?
+// And for how many pages (as a percentage of the cache pages) does
+// the Aout queue keep identifiers? Set by cache_configure().
+#define CACHE_DEFAULT_AIN_PCT 25
+#define CACHE_DEFAULT_AOUT_PCT 50
+static int cache_ain_pct = CACHE_DEFAULT_AIN_PCT;
+static int cache_aout_pct = CACHE_DEFAULT_AOUT_PCT;
+
+// When a release fence finds at least this many dirty pages, write them
+// back with unordered PUTs that the comm layer sends as vectored PUTs
+// instead of one nonblocking PUT per dirty region. 0 disables this.
+// Set by cache_configure() from CHPL_RT_CACHE_PUT_COALESCE.
+#define CACHE_DEFAULT_PUT_COALESCE 8
+static int cache_put_coalesce_min = CACHE_DEFAULT_PUT_COALESCE;
+
 // What type can store the number of cache lines in a cache page?
-typedef int8_t line_per_page_t;
+typedef int16_t line_per_page_t;
 // What type for a number of lines to read ahead?
-typedef int16_t readahead_distance_t;
+typedef int32_t readahead_distance_t;
 
 // used to compress top_index_list / bottom_index arrays
 // the entry pointer is entry_base + idx*sizeof(entry type)
@@ -351,6 +391,37 @@ typedef int16_t entry_id_t;
 
 #define MAX_SEQUENTIAL_READAHEAD_BYTES (MAX_PAGES_PER_PREFETCH*CACHEPAGE_SIZE)
 
+// Should we enable strided prefetching?
+// The stride prefetcher watches the cache misses of each task to each
+// remote node and, once the same stride has been seen
+// STRIDE_PREFETCH_CONFIRM times in a row, prefetches the next
+// STRIDE_PREFETCH_DEGREE elements of the stream. Negative strides
+// (reverse walks) are handled the same way as positive ones.
+#define ENABLE_STRIDE_PREFETCH 1
+
+// How many access streams do we track per cache?
+#define STRIDE_STREAMS 8
+// How many times must a stride repeat before we prefetch?
+#define STRIDE_PREFETCH_CONFIRM 2
+// How many strides ahead of the current access do we prefetch?
+#define STRIDE_PREFETCH_DEGREE 4
+// Strides smaller than this are left to sequential readahead.
+#define STRIDE_MIN_BYTES (2*CACHELINE_SIZE)
+// Accesses further apart than this are considered a different stream.
+#define STRIDE_MAX_BYTES (64*CACHEPAGE_SIZE)
+
+// Streaming reads (see chpl_cache_stream_begin()) of data that isn't
+// already in the cache go through a few read-ahead buffers instead of
+// the cache pages, so that one-pass scans don't evict data that will be
+// used again.
+#define STREAM_BUFFERS 4
+// How big is each stream buffer? It's at least two pages, so that any
+// GET small enough to go through the cache fits in one from the start
+// of its first line.
+#define STREAM_BUFFER_MIN_SIZE (16*1024)
+#define STREAM_BUFFER_SIZE (2*CACHEPAGE_SIZE > STREAM_BUFFER_MIN_SIZE ? \
+                            2*CACHEPAGE_SIZE : STREAM_BUFFER_MIN_SIZE)
+
 // These defines can enable different kinds of debugging output.
 
 //#define TIME
@@ -469,6 +540,8 @@ struct rdcache_s;
 // How many uint64_t words do we need to create a bitmask for CACHEPAGE_SIZE?
 // Divide # bytes in cache by 64, rounding up.
 #define CACHEPAGE_BITMASK_WORDS ((CACHEPAGE_SIZE+63)/64)
+// The same, but for the largest CACHEPAGE_SIZE (for sizing arrays).
+#define CACHEPAGE_MAX_BITMASK_WORDS ((CACHEPAGE_MAX_SIZE+63)/64)
 
 // How many cache lines per cache page?
 #define CACHE_LINES_PER_PAGE (CACHEPAGE_SIZE/CACHELINE_SIZE)
@@ -476,6 +549,9 @@ struct rdcache_s;
 // How many uint64_t words do we need to create a bitmask for CACHE_LINES_PER_PAGE
 // ie, a mask recording a bit per cache line?
 #define CACHE_LINES_PER_PAGE_BITMASK_WORDS (((CACHEPAGE_SIZE/CACHELINE_SIZE)+63)/64)
+// The same, but for the largest number of lines per page (for sizing arrays).
+#define CACHE_LINES_PER_PAGE_MAX_BITMASK_WORDS \
+  ((((1 << CACHEPAGE_MAX_BITS)/(1 << CACHELINE_MIN_BITS))+63)/64)
 
 // Storing a remote address (node number is separate).
 typedef uintptr_t raddr_t;
@@ -523,7 +599,8 @@ struct dirty_entry_s {
   // which cache entry are we talking about here?
   struct cache_entry_s* entry;
   // Which of the page's bytes are dirty?
-  uint64_t dirty[CACHEPAGE_BITMASK_WORDS]; // ie we need to create a put for these bytes
+  // Only the first CACHEPAGE_BITMASK_WORDS are used.
+  uint64_t dirty[CACHEPAGE_MAX_BITMASK_WORDS]; // ie we need to create a put for these bytes
 };
 
 #define QUEUE_FREE 0
@@ -546,7 +623,8 @@ raddr_t raddr_min(raddr_t a, raddr_t b)
 // prefetched or read ahead.
 enum {
   ENTRY_FLAGS_PREFETCHED = 1,
-  ENTRY_FLAGS_READAHEADED = 2
+  ENTRY_FLAGS_READAHEADED = 2,
+  ENTRY_FLAGS_STRIDE_PREFETCHED = 4
 };
 
 // This entry stores the main information for the cache.
@@ -577,7 +655,8 @@ struct cache_entry_s {
   // This refers to CACHEPAGE_SIZE bytes of memory.
   unsigned char* page;
   // Which of the cache lines have we done 'get's for?
-  uint64_t valid_lines[CACHE_LINES_PER_PAGE_BITMASK_WORDS];
+  // Only the first CACHE_LINES_PER_PAGE_BITMASK_WORDS are used.
+  uint64_t valid_lines[CACHE_LINES_PER_PAGE_MAX_BITMASK_WORDS];
   // dirty info if this cache page is dirty, NULL otherwise.
   struct dirty_entry_s* dirty;
   // What is the minimum sequence number stored in this cache entry?
@@ -614,10 +693,50 @@ static int set_valid_lines(uint64_t* valid, uintptr_t skip, uintptr_t len)
 // Note skip/len are in line numbers, NOT byte offsets!
 static void unset_valid_lines(uint64_t* valid, uintptr_t skip, uintptr_t len)
 {
-  uint64_t myvalid[CACHE_LINES_PER_PAGE_BITMASK_WORDS];
+  uint64_t myvalid[CACHE_LINES_PER_PAGE_MAX_BITMASK_WORDS];
   unset_valids_for_skip_len(valid, myvalid, skip, len, CACHE_LINES_PER_PAGE_BITMASK_WORDS);
 }
 
+// This type records the recent access history of one task to one
+// remote node, for use by the stride prefetcher.
+struct stride_stream_s {
+  // Which task and node is this stream for? task == NULL means unused.
+  chpl_cache_taskPrvData_t* task;
+  c_nodeid_t node;
+  // Line address of the most recent access in the stream.
+  raddr_t last_addr;
+  // The most recently observed distance between accesses (in bytes).
+  intptr_t stride;
+  // How many times in a row has stride repeated?
+  int confirmed;
+  // Start address of the furthest element (in the direction of stride)
+  // we have started prefetching, or 0 if none.  Elements up to and
+  // including it are not prefetched again.
+  raddr_t prefetched_to;
+  // Per-stream statistics (printed by rdcache_print).
+  uint64_t num_prefetches;
+  uint64_t num_prefetch_hits;
+};
+
+// A buffer for streaming reads.
+struct stream_buffer_s {
+  c_nodeid_t node;
+  raddr_t raddr; // start of the buffered data
+  size_t len; // 0 if the buffer holds nothing usable
+  // The request number when the data was requested; like an entry's
+  // min_sequence_number, the data is only good for a task whose last
+  // acquire fence was no later than this.
+  cache_seqn_t sequence_number;
+  // The handle for a read-ahead into this buffer still in flight.
+  chpl_comm_nb_handle_t handle;
+  // Set while a task fills or waits on this buffer (which can yield);
+  // other tasks leave a busy buffer alone.
+  int busy;
+  // Set if the data was invalidated while busy.
+  int stale;
+  unsigned char* data;
+};
+
 struct rdcache_s {
   // A 2Q cache.
   // See "2Q: A Low Overhead High Performance Buffer Management
@@ -635,6 +754,16 @@ struct rdcache_s {
   c_nodeid_t last_cache_miss_read_node;
   raddr_t last_cache_miss_read_addr;
 
+  // Access streams tracked by the stride prefetcher.
+  // Replacement is round-robin through next_stream_victim.
+  int next_stream_victim;
+  struct stride_stream_s streams[STRIDE_STREAMS];
+
+  // Buffers for streaming reads.
+  // Replacement is round-robin through next_stream_buffer_victim.
+  int next_stream_buffer_victim;
+  struct stream_buffer_s stream_buffers[STREAM_BUFFERS];
+
   // Used with the lookup table. This is the number of bits
   // for the number of table slots.
   int table_bits;
@@ -791,15 +920,20 @@ struct rdcache_s* cache_create(void) {
 
   // This used to grow based on the number of locales, but that
   // would mean increasing memory usage per node, which isn't acceptable.
-  cache_pages = 1024;
-
-  ain_pages = cache_pages / 4; // 2Q: "Kin should be 25% of page slots"
-                               // but here we set it smaller so that
-                               // we can have #top_entries == ain
-                               // and still have limited overhead.
-  aout_pages = cache_pages / 2; // 2Q: "Kout should hold identifiers for as
-                                // many pages as would fit in 50% of the
-                                // buffer"
+  // Instead, it can be set by CHPL_RT_CACHE_SIZE (see cache_configure()).
+  cache_pages = cache_num_pages;
+
+  // 2Q: "Kin should be 25% of page slots"
+  // but here we set it smaller so that
+  // we can have #top_entries == ain
+  // and still have limited overhead.
+  ain_pages = (int) ((int64_t) cache_pages * cache_ain_pct / 100);
+  if( ain_pages < 1 ) ain_pages = 1;
+  // 2Q: "Kout should hold identifiers for as
+  // many pages as would fit in 50% of the
+  // buffer"
+  aout_pages = (int) ((int64_t) cache_pages * cache_aout_pct / 100);
+  if( aout_pages < 1 ) aout_pages = 1;
   // How many pages can be dirty at once?
   dirty_pages = 16 + cache_pages / 64;
 
@@ -830,6 +964,7 @@ struct rdcache_s* cache_create(void) {
   total_size += sizeof(cache_seqn_t) * pending_len;
   // We allocate an extra page for alignment
   total_size += CACHEPAGE_SIZE + CACHEPAGE_SIZE * cache_pages;
+  total_size += STREAM_BUFFERS * STREAM_BUFFER_SIZE;
 
   // Now, allocate it all in one go.
   buffer = chpl_memalign(64, total_size);
@@ -867,6 +1002,12 @@ struct rdcache_s* cache_create(void) {
   // and finally allocate the pages
   pages = buffer + total_size;
   total_size += CACHEPAGE_SIZE * cache_pages;
+  // and the stream buffers
+  memset(c->stream_buffers, 0, sizeof(c->stream_buffers));
+  for( i = 0; i < STREAM_BUFFERS; i++ ) {
+    c->stream_buffers[i].data = buffer + total_size;
+    total_size += STREAM_BUFFER_SIZE;
+  }
 
   if (total_size > allocated_size) {
     chpl_internal_error("cache_create() failed");
@@ -879,6 +1020,11 @@ struct rdcache_s* cache_create(void) {
   c->last_cache_miss_read_node = -1;
   c->last_cache_miss_read_addr = 0;
 
+  c->next_stream_victim = 0;
+  memset(c->streams, 0, sizeof(c->streams));
+
+  c->next_stream_buffer_victim = 0;
+
   c->max_pages = cache_pages;
   c->max_entries = n_entries;
 
@@ -976,6 +1122,9 @@ void count_unused_prefetches(struct cache_entry_s* z)
   if((z->prefetch_diags_flags & ENTRY_FLAGS_READAHEADED) != 0) {
     chpl_comm_diags_incr(cache_readahead_unused);
   }
+  if((z->prefetch_diags_flags & ENTRY_FLAGS_STRIDE_PREFETCHED) != 0) {
+    chpl_comm_diags_incr(cache_stride_prefetch_unused);
+  }
   z->prefetch_diags_flags = 0;
 }
 
@@ -1066,6 +1215,17 @@ void rdcache_print(struct rdcache_s* cache) {
   for( entry = cache->am_lru_head; entry; entry = entry->next ) {
     cache_entry_print(cache, entry, "     am ", 1);
   }
+  printf("  Streams:\n");
+  for( int i = 0; i < STRIDE_STREAMS; i++ ) {
+    struct stride_stream_s* st = &cache->streams[i];
+    if( st->task == NULL ) continue;
+    printf("    stream %i node %i last %p stride %li confirmed %i "
+           "prefetches %llu hits %llu\n",
+           i, (int) st->node, (void*) st->last_addr, (long) st->stride,
+           st->confirmed,
+           (unsigned long long) st->num_prefetches,
+           (unsigned long long) st->num_prefetch_hits);
+  }
 
   fflush(stdout);
 }
@@ -2040,10 +2200,28 @@ void count_waited_prefetch(struct cache_entry_s* entry,
     if (entry->prefetch_diags_flags & ENTRY_FLAGS_READAHEADED) {
       chpl_comm_diags_incr(cache_readahead_waited);
     }
+    if (entry->prefetch_diags_flags & ENTRY_FLAGS_STRIDE_PREFETCHED) {
+      chpl_comm_diags_incr(cache_stride_prefetch_waited);
+    }
     entry->prefetch_diags_flags = 0;
   }
 }
 
+// Remove the dirty structure from entry and put it back on its free list.
+// This has the effect of clearing the dirty bits.
+static
+void release_dirty(struct rdcache_s* cache, struct cache_entry_s* entry)
+{
+  struct dirty_entry_s* dirty = entry->dirty;
+
+  DOUBLE_REMOVE(cache, dirty, dirty_lru);
+  dirty->entry = NULL;
+  entry->dirty = NULL;
+  DOUBLE_PUSH_TAIL(cache, dirty, dirty_lru);
+  // ... and decrement the number of dirty pages.
+  cache->num_dirty_pages--;
+}
+
 // For the region of this page in raddr,len, we complete any pending/not
 // started operations that possibly overlap with that region.
 // If FLUSH_EVICT or FLUSH_INVALIDATE_PAGE is set, we will ignore the region.
@@ -2132,14 +2310,7 @@ void flush_entry(struct rdcache_s* cache,
           // Move past this region of 1s in dirty bits.
           start = got_skip + got_len;
         }
-        // Now remove the dirty structure and put it back on its free list.
-        // This has the effect of clearing the dirty bits.
-        DOUBLE_REMOVE(cache, dirty, dirty_lru);
-        dirty->entry = NULL;
-        entry->dirty = NULL;
-        DOUBLE_PUSH_TAIL(cache, dirty, dirty_lru);
-        // ... and decrement the number of dirty pages.
-        cache->num_dirty_pages--;
+        release_dirty(cache, entry);
       }
     }
   }
@@ -2572,6 +2743,203 @@ int cache_put_in_page(struct rdcache_s* cache,
 }
 
 
+// Forget streamed data overlapping a PUT or invalidation.
+static
+void stream_invalidate(struct rdcache_s* cache,
+                       c_nodeid_t node, raddr_t raddr, size_t size)
+{
+  int i;
+
+  for( i = 0; i < STREAM_BUFFERS; i++ ) {
+    struct stream_buffer_s* b = &cache->stream_buffers[i];
+    if( b->busy ) {
+      // We don't know what it will hold yet.
+      b->stale = 1;
+    } else if( b->len != 0 && b->node == node &&
+               raddr < b->raddr + b->len && b->raddr < raddr + size ) {
+      b->len = 0;
+    }
+  }
+}
+
+// Wait for a read-ahead into a stream buffer, if there is one.
+// This can yield.
+static
+void stream_wait(struct rdcache_s* cache, struct stream_buffer_s* b)
+{
+  if( b->handle != NULL ) {
+    b->busy = 1;
+    chpl_comm_wait_nb_some(&b->handle, 1);
+    b->handle = NULL;
+    b->busy = 0;
+    if( b->stale ) {
+      b->stale = 0;
+      b->len = 0;
+    }
+  }
+}
+
+// Fill a stream buffer from node:raddr. If nonblocking is set, this
+// only starts the GET; stream_wait() finishes it. This can yield.
+static
+void stream_fill(struct rdcache_s* cache, struct stream_buffer_s* b,
+                 c_nodeid_t node, raddr_t raddr, int nonblocking,
+                 int32_t commID, int ln, int32_t fn)
+{
+  chpl_comm_nb_handle_t handle = NULL;
+  cache_seqn_t sn;
+
+  assert(!b->busy && b->handle == NULL);
+
+  b->busy = 1;
+  b->stale = 0;
+  b->len = 0;
+
+  sn = cache->next_request_number;
+  cache->next_request_number++;
+
+  if( nonblocking ) {
+    handle = chpl_comm_get_nb(b->data, node, (void*) raddr,
+                              STREAM_BUFFER_SIZE, commID, ln, fn);
+  } else {
+    chpl_comm_get(b->data, node, (void*) raddr, STREAM_BUFFER_SIZE,
+                  commID, ln, fn);
+  }
+
+  b->node = node;
+  b->raddr = raddr;
+  b->len = STREAM_BUFFER_SIZE;
+  b->sequence_number = sn;
+  b->handle = handle;
+  b->busy = 0;
+  if( b->stale && handle == NULL ) {
+    b->stale = 0;
+    b->len = 0;
+  }
+}
+
+static inline
+int stream_holds(struct stream_buffer_s* b,
+                 c_nodeid_t node, raddr_t raddr, size_t size)
+{
+  return b->len != 0 && b->node == node &&
+         b->raddr <= raddr && raddr + size <= b->raddr + b->len;
+}
+
+// Find a stream buffer holding node:[raddr, raddr+size) that the
+// task can use, or NULL if there isn't one.
+static
+struct stream_buffer_s* stream_find(struct rdcache_s* cache,
+                                    chpl_cache_taskPrvData_t* task_local,
+                                    c_nodeid_t node, raddr_t raddr,
+                                    size_t size)
+{
+  int i;
+
+  for( i = 0; i < STREAM_BUFFERS; i++ ) {
+    struct stream_buffer_s* b = &cache->stream_buffers[i];
+    if( !b->busy && stream_holds(b, node, raddr, size) &&
+        b->sequence_number >= task_local->last_acquire )
+      return b;
+  }
+  return NULL;
+}
+
+// Choose a stream buffer to replace, other than 'keep', or return
+// NULL if they are all busy.
+static
+struct stream_buffer_s* stream_victim(struct rdcache_s* cache,
+                                      struct stream_buffer_s* keep)
+{
+  int i;
+
+  for( i = 0; i < STREAM_BUFFERS; i++ ) {
+    struct stream_buffer_s* b;
+    b = &cache->stream_buffers[cache->next_stream_buffer_victim];
+    cache->next_stream_buffer_victim =
+      (cache->next_stream_buffer_victim + 1) % STREAM_BUFFERS;
+    if( b != keep && !b->busy )
+      return b;
+  }
+  return NULL;
+}
+
+static inline
+int stream_can_get(c_nodeid_t node, raddr_t raddr)
+{
+  return !chpl_task_guardPagesInUse() &&
+         chpl_comm_addr_gettable(node, (void*) raddr, STREAM_BUFFER_SIZE);
+}
+
+// A GET for a task in streaming mode. Data already in the cache comes
+// from there as usual; otherwise it comes through a stream buffer, and
+// once the GETs reach the second half of a buffer the next one is read
+// ahead. Returns 1 if the data came from a buffer that already had it.
+static
+int stream_get(struct rdcache_s* cache,
+               chpl_cache_taskPrvData_t* task_local,
+               unsigned char* addr,
+               c_nodeid_t node, raddr_t raddr, size_t size,
+               int32_t commID, int ln, int32_t fn)
+{
+  struct stream_buffer_s* b;
+  raddr_t ra_page;
+  raddr_t ra_next;
+  int hit = 1;
+
+  assert(size < CACHEPAGE_SIZE);
+
+  // The cache may hold this task's own PUTs, so use it for any page
+  // that it has.
+  for( ra_page = round_down_to_mask(raddr, CACHEPAGE_MASK);
+       ra_page < raddr + size;
+       ra_page += CACHEPAGE_SIZE ) {
+    struct cache_entry_s* entry = lookup_entry(cache, node, ra_page);
+    if( entry && entry->page )
+      return cache_get(cache, task_local, addr, node, raddr, size,
+                       0, /* isstrideprefetch */ false, commID, ln, fn);
+  }
+
+  b = stream_find(cache, task_local, node, raddr, size);
+  if( b ) {
+    stream_wait(cache, b);
+    // The data may have been invalidated while we waited.
+    if( !stream_holds(b, node, raddr, size) )
+      b = NULL;
+  }
+
+  if( !b ) {
+    raddr_t ra_line = round_down_to_mask(raddr, CACHELINE_MASK);
+
+    hit = 0;
+    b = stream_can_get(node, ra_line) ? stream_victim(cache, NULL) : NULL;
+    if( b ) {
+      stream_wait(cache, b);
+      stream_fill(cache, b, node, ra_line, 0, commID, ln, fn);
+    }
+    if( !b || !stream_holds(b, node, raddr, size) ) {
+      chpl_comm_get(addr, node, (void*) raddr, size, commID, ln, fn);
+      return 0;
+    }
+  }
+
+  chpl_memcpy(addr, b->data + (raddr - b->raddr), size);
+
+  // Read ahead the data after this buffer once we're halfway through it.
+  ra_next = b->raddr + b->len;
+  if( raddr + size > b->raddr + b->len / 2 &&
+      !stream_find(cache, task_local, node, ra_next, 1) &&
+      stream_can_get(node, ra_next) ) {
+    struct stream_buffer_s* v = stream_victim(cache, b);
+    if( v ) {
+      stream_wait(cache, v);
+      stream_fill(cache, v, node, ra_next, 1, commID, ln, fn);
+    }
+  }
+
+  return hit;
+}
+
 // returns 1 if all of the page operations were "hit"s
 static
 int cache_put(struct rdcache_s* cache,
@@ -2599,6 +2967,8 @@ int cache_put(struct rdcache_s* cache,
     return 1;
   }
 
+  stream_invalidate(cache, node, raddr, size);
+
   // first_page = raddr of start of first needed page
   ra_first_page = round_down_to_mask(raddr, CACHEPAGE_MASK);
   // last_page = raddr of start of last needed page
@@ -2651,6 +3021,7 @@ int cache_get(struct rdcache_s* cache,
               unsigned char * addr,
               c_nodeid_t node, raddr_t raddr, size_t size,
               int sequential_readahead_length,
+              chpl_bool isstrideprefetch,
               int32_t commID, int ln, int32_t fn);
 
 static
@@ -2752,7 +3123,7 @@ void cache_get_trigger_readahead(struct rdcache_s* cache,
       cache_get(cache, task_local,
                 /* addr */ NULL /* means prefetch */,
                 node, prefetch_start, prefetch_end - prefetch_start,
-                next_ra_length,
+                next_ra_length, /* isstrideprefetch */ false,
                 commID, ln, fn);
     } else {
       // We could not prefetch, so record a cache miss so
@@ -2781,6 +3152,146 @@ void cache_get_trigger_readahead(struct rdcache_s* cache,
   }
 }
 
+// Find the stream that an access by task_local to node:ra_line belongs to.
+// Prefers a stream whose stride predicts this access; otherwise picks
+// the nearest stream from the same task to the same node. Returns NULL
+// if no stream is close enough.
+static
+struct stride_stream_s* find_stride_stream(struct rdcache_s* cache,
+                                           chpl_cache_taskPrvData_t* task_local,
+                                           c_nodeid_t node, raddr_t ra_line)
+{
+  struct stride_stream_s* best = NULL;
+  uintptr_t best_dist = STRIDE_MAX_BYTES + 1;
+  int i;
+
+  for( i = 0; i < STRIDE_STREAMS; i++ ) {
+    struct stride_stream_s* st = &cache->streams[i];
+    uintptr_t dist;
+    if( st->task != task_local || st->node != node ) continue;
+    if( st->stride != 0 && st->last_addr + st->stride == ra_line )
+      return st;
+    dist = (ra_line > st->last_addr) ? ra_line - st->last_addr
+                                     : st->last_addr - ra_line;
+    if( dist < best_dist ) {
+      best = st;
+      best_dist = dist;
+    }
+  }
+
+  return best;
+}
+
+// Record a demand access by task_local to node:raddr..raddr+size-1
+// and prefetch ahead if the task's accesses to node have a stable stride.
+// This is called on cache misses and on hits to pages that were brought in
+// by the stride prefetcher (so that a stream continues once it is being
+// prefetched successfully). This can yield since it can start prefetches,
+// so the caller must not have an entry reserved.
+static
+void stride_prefetch_observe(struct rdcache_s* cache,
+                             chpl_cache_taskPrvData_t* task_local,
+                             c_nodeid_t node, raddr_t raddr, size_t size,
+                             chpl_bool was_stride_prefetched,
+                             int32_t commID, int ln, int32_t fn)
+{
+  struct stride_stream_s* st;
+  raddr_t ra_line;
+  raddr_t start, end;
+  intptr_t delta;
+  uintptr_t abs_stride;
+  int k;
+
+  if( !ENABLE_STRIDE_PREFETCH || task_local == NULL ) return;
+
+  ra_line = round_down_to_mask(raddr, CACHELINE_MASK);
+
+  st = find_stride_stream(cache, task_local, node, ra_line);
+
+  if( st == NULL ) {
+    // Start tracking a new stream, replacing an old one.
+    st = &cache->streams[cache->next_stream_victim];
+    cache->next_stream_victim = (cache->next_stream_victim + 1) % STRIDE_STREAMS;
+    if( st->task != NULL ) {
+      TRACE_READAHEAD_PRINT(("%d: task %d dropping stream node %d stride %li "
+                             "prefetches %llu hits %llu\n",
+                             chpl_nodeID, (int)chpl_task_getId(),
+                             (int) st->node, (long) st->stride,
+                             (unsigned long long) st->num_prefetches,
+                             (unsigned long long) st->num_prefetch_hits));
+    }
+    memset(st, 0, sizeof(*st));
+    st->task = task_local;
+    st->node = node;
+    st->last_addr = ra_line;
+    return;
+  }
+
+  if( was_stride_prefetched ) {
+    st->num_prefetch_hits++;
+  }
+
+  delta = (intptr_t) (ra_line - st->last_addr);
+  if( delta == 0 ) return; // same line again; nothing learned
+
+  if( delta == st->stride ) {
+    if( st->confirmed < STRIDE_PREFETCH_CONFIRM ) {
+      st->confirmed++;
+      if( st->confirmed == STRIDE_PREFETCH_CONFIRM )
+        chpl_comm_diags_incr(cache_stride_streams);
+    }
+  } else {
+    st->stride = delta;
+    st->confirmed = 0;
+    st->prefetched_to = 0;
+  }
+  st->last_addr = ra_line;
+
+  abs_stride = (delta < 0) ? -(uintptr_t)delta : (uintptr_t)delta;
+  if( st->confirmed < STRIDE_PREFETCH_CONFIRM ||
+      abs_stride < STRIDE_MIN_BYTES ||
+      abs_stride > STRIDE_MAX_BYTES ||
+      is_congested(cache) ||
+      chpl_task_guardPagesInUse() ) {
+    return;
+  }
+
+  for( k = 1; k <= STRIDE_PREFETCH_DEGREE; k++ ) {
+    // Stop rather than wrap around the address space.
+    if( delta < 0 && raddr < k * abs_stride ) break;
+
+    start = raddr + k * delta;
+    end = start + size;
+
+    // Skip elements of the stream we already started prefetching.
+    if( st->prefetched_to != 0 &&
+        ((delta > 0 && start <= st->prefetched_to) ||
+         (delta < 0 && start >= st->prefetched_to)) )
+      continue;
+
+    if( !chpl_comm_addr_gettable(node, (void*) start, size) ) break;
+
+    TRACE_READAHEAD_PRINT(("%d: task %d stride %li prefetch from %p to %p\n",
+                           chpl_nodeID, (int)chpl_task_getId(), (long) delta,
+                           (void*) start, (void*) end));
+
+    st->prefetched_to = start;
+    st->num_prefetches++;
+
+    // note - this can yield, and another task could reuse st
+    // at that point, so don't use st after this call.
+    cache_get(cache, task_local,
+              /* addr */ NULL /* means prefetch */,
+              node, start, end - start,
+              /* sequential_readahead_length */ 0,
+              /* isstrideprefetch */ true,
+              commID, ln, fn);
+
+    if( st->task != task_local || st->node != node || st->stride != delta )
+      break;
+  }
+}
+
 static
 int should_readahead_extend(uint64_t* valid,
                             uintptr_t skip, uintptr_t len )
@@ -2872,6 +3383,7 @@ int cache_get_in_page(struct rdcache_s* cache,
                       c_nodeid_t node, raddr_t raddr, size_t size,
                       raddr_t ra_first_page, raddr_t ra_last_page,
                       int sequential_readahead_length,
+                      chpl_bool isstrideprefetch,
                       int32_t commID, int ln, int32_t fn)
 {
   struct cache_entry_s* entry;
@@ -2883,6 +3395,7 @@ int cache_get_in_page(struct rdcache_s* cache,
   int isprefetch;
   int isreadahead;
   int entry_after_acquire;
+  chpl_bool was_stride_prefetched = false;
   chpl_comm_nb_handle_t handle;
   uintptr_t readahead_len, readahead_skip;
 
@@ -2967,6 +3480,9 @@ int cache_get_in_page(struct rdcache_s* cache,
     // Data is already in cache...  but to do a 'get' for previously
     // prefetched data, we might have to wait for it.
     if (!isprefetch) {
+      was_stride_prefetched =
+        (entry->prefetch_diags_flags & ENTRY_FLAGS_STRIDE_PREFETCHED) != 0;
+
       if (entry->max_prefetch_sequence_number >
           cache->completed_request_number) {
         chpl_bool waited = wait_for(cache, entry->max_prefetch_sequence_number);
@@ -3020,6 +3536,10 @@ int cache_get_in_page(struct rdcache_s* cache,
                                     raddr, size,
                                     readahead_skip, readahead_len,
                                     commID, ln, fn);
+        if (was_stride_prefetched) {
+          stride_prefetch_observe(cache, task_local, node, raddr, size,
+                                  true, commID, ln, fn);
+        }
         return 1;
       }
     }
@@ -3027,6 +3547,13 @@ int cache_get_in_page(struct rdcache_s* cache,
     // "unlock" the entry
     unreserve_entry(cache, task_local, entry);
     entry = NULL;
+
+    // Keep a successfully prefetched stream going.
+    // note - this can yield
+    if (was_stride_prefetched) {
+      stride_prefetch_observe(cache, task_local, node, raddr, size,
+                              true, commID, ln, fn);
+    }
     return 1;
   }
 
@@ -3107,7 +3634,13 @@ int cache_get_in_page(struct rdcache_s* cache,
     entry->prefetch_diags_flags |= ENTRY_FLAGS_READAHEADED;
     chpl_comm_diags_incr(cache_num_page_readaheads);
   }
-  if (isprefetch && !isreadahead && !(entry->prefetch_diags_flags & ENTRY_FLAGS_PREFETCHED)) {
+  if (isstrideprefetch &&
+      !(entry->prefetch_diags_flags & ENTRY_FLAGS_STRIDE_PREFETCHED)) {
+    entry->prefetch_diags_flags |= ENTRY_FLAGS_STRIDE_PREFETCHED;
+    chpl_comm_diags_incr(cache_num_stride_prefetches);
+  }
+  if (isprefetch && !isreadahead && !isstrideprefetch &&
+      !(entry->prefetch_diags_flags & ENTRY_FLAGS_PREFETCHED)) {
     entry->prefetch_diags_flags |= ENTRY_FLAGS_PREFETCHED;
     chpl_comm_diags_incr(cache_num_prefetches);
   }
@@ -3210,6 +3743,13 @@ int cache_get_in_page(struct rdcache_s* cache,
   // TODO: is this call necessary?
   ensure_free_page(cache, task_local, /* give_up_if_locked */ 0);
 
+  // Look for a strided access pattern and prefetch along it.
+  // note - this can yield
+  if (!isprefetch && entry_after_acquire) {
+    stride_prefetch_observe(cache, task_local, node, raddr, size,
+                            false, commID, ln, fn);
+  }
+
   return 0;
 }
 
@@ -3224,6 +3764,7 @@ int cache_get(struct rdcache_s* cache,
               unsigned char * addr,
               c_nodeid_t node, raddr_t raddr, size_t size,
               int sequential_readahead_length,
+              chpl_bool isstrideprefetch,
               int32_t commID, int ln, int32_t fn)
 {
   raddr_t ra_first_page;
@@ -3282,6 +3823,7 @@ int cache_get(struct rdcache_s* cache,
                             node, requested_start, requested_size,
                             ra_first_page, ra_last_page,
                             sequential_readahead_length,
+                            isstrideprefetch,
                             commID, ln, fn);
 
     all_hits = all_hits && hit;
@@ -3564,6 +4106,8 @@ void cache_invalidate(struct rdcache_s* cache,
     return;
   }
 
+  stream_invalidate(cache, node, raddr, size);
+
   // first_page = raddr of start of first needed page
   ra_first_page = round_down_to_mask(raddr, CACHEPAGE_MASK);
   // last_page = raddr of start of last needed page
@@ -3589,11 +4133,70 @@ void cache_invalidate(struct rdcache_s* cache,
   }
 }
 
+// Write back all of the dirty pages using unordered PUTs. The comm
+// layer buffers these and sends them in vectored PUTs (ofi_put_V() or
+// do_remote_put_V()), which is much better for the NIC than many small
+// PUTs when the dirty regions are scattered (e.g. histogram updates).
+// All of the PUTs are complete when this returns.
+static
+void cache_clean_dirty_coalesced(struct rdcache_s* cache,
+                                 chpl_cache_taskPrvData_t* task_local)
+{
+  uintptr_t start, got_skip, got_len;
+
+  while (1) {
+    struct dirty_entry_s* cur;
+    struct cache_entry_s* victim;
+
+    cur = cache->dirty_lru_head;
+    // Dirty records with page entries are before free ones without
+    if( ! cur || ! cur->entry ) break;
+
+    victim = cur->entry;
+
+    if (!try_reserve_entry(cache, task_local, victim)) {
+      // couldn't reserve entry - yield and try the lookup again
+      chpl_task_yield();
+      continue;
+    }
+
+    // Unordered PUTs could pass an earlier PUT of this page,
+    // so make sure any of those are done first.
+    // note: wait_for can yield, but victim is locked
+    wait_for(cache, victim->max_put_sequence_number);
+
+    start = 0;
+    while( get_skip_len_for_valids(cur->dirty, start, &got_skip, &got_len,
+                                   CACHEPAGE_BITMASK_WORDS) ) {
+      // Note: chpl_comm_put_unordered can yield
+      // (but it copies the data, so the page can change afterwards)
+      chpl_comm_put_unordered(victim->page + got_skip,
+                              victim->base.node,
+                              (void*)(victim->base.raddr + got_skip),
+                              got_len, CHPL_COMM_UNKNOWN_ID, -1, 0);
+      chpl_comm_diags_incr(cache_put_coalesced);
+      start = got_skip + got_len;
+    }
+
+    release_dirty(cache, victim);
+    unreserve_entry(cache, task_local, victim);
+  }
+
+  // Send anything still buffered and wait for it to complete.
+  chpl_comm_getput_unordered_task_fence();
+}
+
 static
 void cache_clean_dirty(struct rdcache_s* cache,
                        chpl_cache_taskPrvData_t* task_local)
 {
 
+  if (cache_put_coalesce_min > 0 &&
+      cache->num_dirty_pages >= cache_put_coalesce_min) {
+    cache_clean_dirty_coalesced(cache, task_local);
+    return;
+  }
+
   while (1) {
     struct dirty_entry_s* cur;
     struct cache_entry_s* victim;
@@ -3707,6 +4310,83 @@ void destroy_pthread_local_cache(void* arg)
   if (s) cache_destroy(s);
 }
 
+// Read the CHPL_RT_CACHE_* settings for the cache size and geometry.
+// This needs to be called before any cache is created.
+static
+int cache_size_to_bits(const char* ev, size_t size, int min_bits, int max_bits,
+                       int dflt_bits, chpl_bool even_bits)
+{
+  int bits = 0;
+  char msg[200];
+
+  while( ((size_t) 1 << bits) < size ) bits++;
+
+  if( ((size_t) 1 << bits) != size || bits < min_bits || bits > max_bits ||
+      (even_bits && (bits & 1) != 0) ) {
+    snprintf(msg, sizeof(msg),
+             "CHPL_RT_%s must be a power of %d between %d and %d; using %d",
+             ev, even_bits ? 4 : 2, 1 << min_bits, 1 << max_bits,
+             1 << dflt_bits);
+    chpl_warning(msg, 0, 0);
+    return dflt_bits;
+  }
+  return bits;
+}
+
+static
+void cache_configure(void)
+{
+  size_t page_size;
+  size_t line_size;
+  size_t cache_size;
+  int max_page_bits;
+  int pages;
+
+  // Don't allow cache pages larger than system pages, since readahead
+  // assumes a system page is gettable if any part of it is.
+  max_page_bits = CACHEPAGE_MAX_BITS;
+  while( max_page_bits > CACHEPAGE_MIN_BITS &&
+         ((size_t) 1 << max_page_bits) > sys_page_size() ) {
+    max_page_bits -= 2;
+  }
+
+  page_size = chpl_env_rt_get_size("CACHE_PAGE_SIZE",
+                                   1 << CACHEPAGE_DEFAULT_BITS);
+  cache_page_bits = cache_size_to_bits("CACHE_PAGE_SIZE", page_size,
+                                       CACHEPAGE_MIN_BITS, max_page_bits,
+                                       CACHEPAGE_DEFAULT_BITS, true);
+
+  line_size = chpl_env_rt_get_size("CACHE_LINE_SIZE",
+                                   1 << CACHELINE_DEFAULT_BITS);
+  cache_line_bits = cache_size_to_bits("CACHE_LINE_SIZE", line_size,
+                                       CACHELINE_MIN_BITS, cache_page_bits,
+                                       CACHELINE_DEFAULT_BITS, false);
+
+  // The number of pages must be a power of 2 for the lookup table.
+  cache_size = chpl_env_rt_get_size("CACHE_SIZE", CACHE_DEFAULT_SIZE);
+  pages = 16;
+  while( pages < (1 << 22) &&
+         ((size_t) pages << (cache_page_bits + 1)) <= cache_size ) {
+    pages *= 2;
+  }
+  cache_num_pages = pages;
+
+  cache_ain_pct = chpl_env_rt_get_int_pct("CACHE_AIN", CACHE_DEFAULT_AIN_PCT,
+                                          true);
+  cache_aout_pct = chpl_env_rt_get_int_pct("CACHE_AOUT",
+                                           CACHE_DEFAULT_AOUT_PCT, true);
+  if( cache_ain_pct > 90 ) cache_ain_pct = 90;
+  if( cache_aout_pct > 400 ) cache_aout_pct = 400;
+
+  // Coalescing only helps if the comm layer combines unordered PUTs.
+  cache_put_coalesce_min = 0;
+  if( chpl_comm_buffered_unordered_put() ) {
+    cache_put_coalesce_min =
+      (int) chpl_env_rt_get_int("CACHE_PUT_COALESCE",
+                                CACHE_DEFAULT_PUT_COALESCE);
+  }
+}
+
 static
 void chpl_cache_do_init(void)
 {
@@ -3726,6 +4406,210 @@ void chpl_cache_do_init(void)
   pthread_mutex_unlock(&is_inited_mutex);
 }
 
+//////////////// NODE-WIDE SHARED READ-ONLY CACHE ////////////////////
+//
+// When CHPL_RT_CACHE_SHARED is set, single-page GETs that are not
+// present in the per-pthread cache are served from a read-only cache
+// shared by all of the pthreads on this node.
+//
+// The shared cache is a set-associative table of CACHEPAGE_SIZE pages
+// split into shards by hash_raddr(). Readers do not lock anything:
+// each slot has a version number that is odd while the slot is being
+// refilled, and a reader checks that the version did not change while it
+// copied the data out (treating a change as a miss). All of the slots are
+// allocated at startup and never freed, so a reader racing with a refill
+// can see at worst torn data that it then discards; no deferred
+// reclamation is needed.
+//
+// Consistency with fences is handled with a node-wide epoch:
+//  * filling a slot increments the epoch and records the old value
+//    in the slot (before the GET is started)
+//  * an acquire fence records the current epoch in the task, and the
+//    task only uses slots filled at or after that epoch
+//  * a PUT marks the task so that it bypasses the shared cache until
+//    its next release fence (which waits for the PUTs to complete and
+//    then records the current epoch), so that a task always sees its
+//    own writes.
+// So the shared cache only helps data that is read-mostly between fences.
+
+// How many pages are in each shard?
+#define SHARED_CACHE_WAYS 4
+// Default size of the shared cache, in pages.
+#define SHARED_CACHE_DEFAULT_PAGES (16*1024)
+
+struct shared_cache_slot_s {
+  atomic_uint_least64_t version; // odd while the slot is being filled
+  atomic_uint_least64_t fill_epoch;
+  atomic_uintptr_t raddr; // aligned to CACHEPAGE_SIZE; 0 means empty
+  atomic_int_least32_t node;
+  unsigned char* page;
+};
+
+struct shared_cache_shard_s {
+  atomic_uint_least32_t next_victim;
+  struct shared_cache_slot_s ways[SHARED_CACHE_WAYS];
+} __attribute__ ((aligned (64)));
+
+static chpl_bool shared_cache_enabled = false;
+static unsigned int shared_cache_shard_bits = 0;
+static struct shared_cache_shard_s* shared_cache_shards = NULL;
+static atomic_uint_least64_t shared_cache_epoch;
+
+static
+void shared_cache_init(void)
+{
+  size_t n_pages;
+  size_t n_shards;
+  size_t i;
+  int j;
+  unsigned char* pages;
+
+  if (!chpl_env_rt_get_bool("CACHE_SHARED", false))
+    return;
+
+  n_pages = chpl_env_rt_get_size("CACHE_SHARED_PAGES",
+                                 SHARED_CACHE_DEFAULT_PAGES);
+  // round down to a power of 2 number of shards
+  shared_cache_shard_bits = 0;
+  while (((size_t) SHARED_CACHE_WAYS << (shared_cache_shard_bits + 1))
+         <= n_pages) {
+    shared_cache_shard_bits++;
+  }
+  n_shards = (size_t) 1 << shared_cache_shard_bits;
+
+  shared_cache_shards =
+    chpl_memalign(64, n_shards * sizeof(struct shared_cache_shard_s));
+  pages = chpl_memalign(CACHEPAGE_SIZE,
+                        n_shards * SHARED_CACHE_WAYS * CACHEPAGE_SIZE);
+
+  for (i = 0; i < n_shards; i++) {
+    struct shared_cache_shard_s* shard = &shared_cache_shards[i];
+    atomic_init_uint_least32_t(&shard->next_victim, 0);
+    for (j = 0; j < SHARED_CACHE_WAYS; j++) {
+      struct shared_cache_slot_s* slot = &shard->ways[j];
+      atomic_init_uint_least64_t(&slot->version, 0);
+      atomic_init_uint_least64_t(&slot->fill_epoch, 0);
+      atomic_init_uintptr_t(&slot->raddr, 0);
+      atomic_init_int_least32_t(&slot->node, -1);
+      slot->page = pages + (i * SHARED_CACHE_WAYS + j) * CACHEPAGE_SIZE;
+    }
+  }
+
+  // Start at 1 so that a freshly started task (with
+  // shared_last_acquire == 0) can't be confused with one that fenced.
+  atomic_init_uint_least64_t(&shared_cache_epoch, 1);
+
+  shared_cache_enabled = true;
+}
+
+// Try to satisfy a GET of node:raddr..raddr+size-1 into addr from
+// the shared cache, filling a shared cache slot on a miss.
+// Returns true if the GET was done, or false if the caller needs to do it
+// (e.g. because the request crosses a page or the slot to fill is busy).
+// This can yield (when filling a slot).
+static
+chpl_bool shared_cache_get(chpl_cache_taskPrvData_t* task_local,
+                           unsigned char* addr,
+                           c_nodeid_t node, raddr_t raddr, size_t size,
+                           int32_t commID, int ln, int32_t fn)
+{
+  raddr_t ra_page = round_down_to_mask(raddr, CACHEPAGE_MASK);
+  uint64_t hash;
+  struct shared_cache_shard_s* shard;
+  struct shared_cache_slot_s* slot;
+  uint64_t version;
+  uint64_t epoch;
+  int j;
+
+  if (round_down_to_mask(raddr + size - 1, CACHEPAGE_MASK) != ra_page)
+    return false;
+
+  hash = hash_raddr(ra_page, node);
+  shard = &shared_cache_shards[hash & ((1 << shared_cache_shard_bits) - 1)];
+
+  for (j = 0; j < SHARED_CACHE_WAYS; j++) {
+    slot = &shard->ways[j];
+    version = atomic_load_explicit_uint_least64_t(&slot->version,
+                                                  memory_order_acquire);
+    if ((version & 1) != 0 ||
+        atomic_load_uintptr_t(&slot->raddr) != ra_page ||
+        atomic_load_int_least32_t(&slot->node) != node ||
+        atomic_load_uint_least64_t(&slot->fill_epoch) <
+          task_local->shared_last_acquire)
+      continue;
+
+    chpl_memcpy(addr, slot->page + (raddr - ra_page), size);
+
+    chpl_atomic_thread_fence(memory_order_acquire);
+    if (atomic_load_explicit_uint_least64_t(&slot->version,
+                                            memory_order_relaxed) == version) {
+      chpl_comm_diags_incr(cache_shared_hits);
+      return true;
+    }
+  }
+
+  // It's a miss, so fill a slot with the whole page, if we can.
+  if (chpl_task_guardPagesInUse() ||
+      !chpl_comm_addr_gettable(node, (void*) ra_page, CACHEPAGE_SIZE))
+    return false;
+
+  j = atomic_fetch_add_uint_least32_t(&shard->next_victim, 1) %
+      SHARED_CACHE_WAYS;
+  slot = &shard->ways[j];
+  version = atomic_load_uint_least64_t(&slot->version);
+  if ((version & 1) != 0 ||
+      !atomic_compare_exchange_strong_uint_least64_t(&slot->version,
+                                                     &version, version + 1)) {
+    // another thread is filling this slot
+    return false;
+  }
+
+  // Now the slot is ours. Record the epoch before starting the GET.
+  epoch = atomic_fetch_add_uint_least64_t(&shared_cache_epoch, 1);
+
+  // note: this can yield, but other tasks will skip the slot
+  chpl_comm_get(slot->page, node, (void*) ra_page, CACHEPAGE_SIZE,
+                commID, ln, fn);
+
+  atomic_store_uintptr_t(&slot->raddr, ra_page);
+  atomic_store_int_least32_t(&slot->node, node);
+  atomic_store_uint_least64_t(&slot->fill_epoch, epoch);
+
+  chpl_memcpy(addr, slot->page + (raddr - ra_page), size);
+
+  atomic_store_explicit_uint_least64_t(&slot->version, version + 2,
+                                       memory_order_release);
+
+  chpl_comm_diags_incr(cache_shared_misses);
+  return true;
+}
+
+// Should this task's GET of node:raddr try the shared cache?
+static inline
+chpl_bool use_shared_cache(struct rdcache_s* cache,
+                           chpl_cache_taskPrvData_t* task_local,
+                           c_nodeid_t node, raddr_t raddr)
+{
+  struct cache_entry_s* entry;
+
+  if (!shared_cache_enabled || task_local == NULL || task_local->shared_wrote)
+    return false;
+
+  // If the per-pthread cache has the page, it could have data
+  // (e.g. from another task's PUT) that is newer than the shared copy.
+  entry = lookup_entry(cache, node, round_down_to_mask(raddr, CACHEPAGE_MASK));
+  return entry == NULL || entry->page == NULL;
+}
+
+// Note that this task did a PUT, so it shouldn't use the shared cache
+// until the PUT is known to be complete.
+static inline
+void shared_cache_note_put(chpl_cache_taskPrvData_t* task_local)
+{
+  if (shared_cache_enabled && task_local != NULL)
+    task_local->shared_wrote = 1;
+}
+
 // The implementation of functions in chpl-cache.h
 
 void chpl_cache_init(void) {
@@ -3739,7 +4623,9 @@ void chpl_cache_init(void) {
   }
 
   //printf("CACHE IS ENABLED\n");
+  cache_configure();
   chpl_cache_do_init();
+  shared_cache_init();
 }
 
 void chpl_cache_exit(void)
@@ -3779,6 +4665,15 @@ void chpl_cache_fence(int acquire, int release, int ln, int32_t fn)
     cache_clean_dirty(cache, task_local);
     wait_all(cache);
   }
+
+  // Shared cache slots filled before now are no longer usable by this
+  // task after an acquire, or after a release that completed its PUTs.
+  if( shared_cache_enabled && (acquire || task_local->shared_wrote) ) {
+    task_local->shared_last_acquire =
+      atomic_load_uint_least64_t(&shared_cache_epoch);
+    if( release )
+      task_local->shared_wrote = 0;
+  }
 #ifdef DUMP
   DEBUG_PRINT(("%d: task %d after fence\n", chpl_nodeID, (int) chpl_task_getId()));
   chpl_cache_print();
@@ -3819,6 +4714,9 @@ void chpl_cache_comm_put(void* addr, c_nodeid_t node, void* raddr,
   chpl_cache_taskPrvData_t* task_local = task_private_cache_data();
   int all_hits;
 
+  if (cache)
+    shared_cache_note_put(task_local);
+
   if (!cache || size_merits_direct_comm(cache, size)) {
     if (cache)
       cache_invalidate(cache, task_local, node, (raddr_t)raddr, size);
@@ -3894,9 +4792,19 @@ void chpl_cache_comm_get(void *addr, c_nodeid_t node, void* raddr,
   chpl_cache_print();
 #endif
 
-  all_hits = cache_get(cache, task_local,
-                       addr, node, (raddr_t)raddr, size,
-                       0, commID, ln, fn);
+  if (task_local && task_local->streaming) {
+    all_hits = stream_get(cache, task_local,
+                          addr, node, (raddr_t)raddr, size,
+                          commID, ln, fn);
+  } else if (use_shared_cache(cache, task_local, node, (raddr_t)raddr) &&
+             shared_cache_get(task_local, addr, node, (raddr_t)raddr, size,
+                              commID, ln, fn)) {
+    return;
+  } else {
+    all_hits = cache_get(cache, task_local,
+                         addr, node, (raddr_t)raddr, size,
+                         0, /* isstrideprefetch */ false, commID, ln, fn);
+  }
 
   if (size != 0) {
     if (all_hits)
@@ -3908,6 +4816,22 @@ void chpl_cache_comm_get(void *addr, c_nodeid_t node, void* raddr,
   return;
 }
 
+void chpl_cache_stream_begin(void)
+{
+  chpl_cache_taskPrvData_t* task_local = task_private_cache_data();
+
+  if (task_local)
+    task_local->streaming++;
+}
+
+void chpl_cache_stream_end(void)
+{
+  chpl_cache_taskPrvData_t* task_local = task_private_cache_data();
+
+  if (task_local && task_local->streaming > 0)
+    task_local->streaming--;
+}
+
 void chpl_cache_comm_prefetch(c_nodeid_t node, void* raddr,
                               size_t size, int32_t commID, int ln, int32_t fn)
 {
@@ -3925,6 +4849,7 @@ void chpl_cache_comm_prefetch(c_nodeid_t node, void* raddr,
   cache_get(cache, task_local,
             /* addr */ NULL, node, (raddr_t)raddr, size,
             /* sequential_readahead_length */ 0,
+            /* isstrideprefetch */ false,
             CHPL_COMM_UNKNOWN_ID, ln, fn);
 
 }
@@ -4033,6 +4958,7 @@ void chpl_cache_comm_put_strd(void *addr, void *dststr, c_nodeid_t node,
                     strlevels, elemSize,
                     commID, ln, fn);
   }
+  shared_cache_note_put(task_private_cache_data());
   // do the strided put.
   chpl_comm_put_strd(addr, dststr, node, raddr, srcstr, count, strlevels,
                      elemSize, commID, ln, fn);
@@ -4060,8 +4986,10 @@ void chpl_cache_comm_put_unordered(void* addr, c_nodeid_t node, void* raddr,
   struct rdcache_s* cache = tls_cache_remote_data();
   chpl_cache_taskPrvData_t* task_local = task_private_cache_data();
 
-  if (cache)
+  if (cache) {
     cache_invalidate(cache, task_local, node, (raddr_t)raddr, size);
+    shared_cache_note_put(task_local);
+  }
 
   chpl_comm_put_unordered(addr, node, raddr, size, commID, ln, fn);
 
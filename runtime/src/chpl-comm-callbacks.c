@@ -19,10 +19,14 @@
  */
 
 #include <assert.h>
+#include <pthread.h>
+#include <string.h>
 
 #include "chplrt.h"
 
 #include "chpl-comm.h"
+#include "chpl-mem.h"
+#include "chpl-thread-local-storage.h"
 #include "error.h"
 #include "chpl-comm-callbacks.h"
 #include "chpl-comm-callbacks-internal.h"
@@ -31,29 +35,87 @@
 // Communication callback support
 //
 #define MAX_CBS_PER_EVENT 10
+#define MAX_BATCH_CBS 8
 
 
 //
 // Storage for call back information
 //
+struct cb_entry {
+  chpl_comm_cb_fn_t fn;                 // unbatched callback, or NULL
+  int batch_id;                         // batched callback's slot, or -1
+  chpl_comm_cb_filter_t filter;
+  uint32_t sample_every;                // filter.sample_every, or 1
+  int filtered;                         // does the filter reject anything?
+};
+
 static struct cb_info {
-  chpl_comm_cb_fn_t fns[MAX_CBS_PER_EVENT];
+  struct cb_entry cbs[MAX_CBS_PER_EVENT];
 } cb_info[chpl_comm_cb_num_event_kinds];
 
 int chpl_comm_callback_counts[chpl_comm_cb_num_event_kinds] = {0};
 
+chpl_comm_cb_filter_t chpl_comm_callback_filters[chpl_comm_cb_num_event_kinds];
+
+// Per-thread event counts, for sampling.  These are indexed by the
+// position of the callback in its event's list, so they get out of step
+// when callbacks are uninstalled; that just perturbs the sampling.
+static CHPL_TLS uint32_t sample_counts[chpl_comm_cb_num_event_kinds]
+                                      [MAX_CBS_PER_EVENT];
+
 
 //
-// Communication callback support.
+// Batched callbacks.  Each thread collects events in its own buffer for
+// each batched callback, so threads don't contend.  The buffers are
+// kept on a list per callback so that they can all be flushed, and are
+// reused (and resized) when the callback's slot is, as told by its
+// generation number.
 //
-int chpl_comm_install_callback(chpl_comm_cb_event_kind_t event_kind,
-                               chpl_comm_cb_fn_t cb_fn) {
+struct batch_buf {
+  pthread_mutex_t lock;                 // held while adding or flushing
+  uint64_t gen;
+  int n;
+  int len;
+  chpl_comm_cb_info_t* infos;
+  struct batch_buf* next;
+};
+
+static struct batch_slot {
+  chpl_comm_cb_batch_fn_t fn;           // NULL if not in use
+  int batch_len;
+  uint64_t gen;
+  struct batch_buf* bufs;
+} batch_slots[MAX_BATCH_CBS];
+
+static pthread_mutex_t batch_slots_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static CHPL_TLS struct batch_buf* my_batch_bufs[MAX_BATCH_CBS];
+
+
+// Recompute the loosest filter for an event kind, which is what
+// chpl_comm_want_callbacks() checks.
+static void update_kind_filter(chpl_comm_cb_event_kind_t event_kind) {
+  chpl_comm_cb_filter_t* kf = &chpl_comm_callback_filters[event_kind];
   int i;
 
-  if (event_kind >= chpl_comm_cb_num_event_kinds) {
-    errno = ERANGE;
-    return -1;
+  for (i = 0; i < chpl_comm_callback_counts[event_kind]; i++) {
+    const chpl_comm_cb_filter_t* f = &cb_info[event_kind].cbs[i].filter;
+    if (i == 0 || f->min_size < kf->min_size)
+      kf->min_size = f->min_size;
+    if (i == 0 || f->node_lo < kf->node_lo)
+      kf->node_lo = f->node_lo;
+    if (i == 0 || f->node_hi > kf->node_hi)
+      kf->node_hi = f->node_hi;
   }
+}
+
+
+static int install_entry(chpl_comm_cb_event_kind_t event_kind,
+                         chpl_comm_cb_fn_t cb_fn, int batch_id,
+                         const chpl_comm_cb_filter_t* filter) {
+  static const chpl_comm_cb_filter_t pass_all = CHPL_COMM_CB_FILTER_INIT;
+  struct cb_entry* cb;
+  int i;
 
   i = chpl_comm_callback_counts[event_kind];
 
@@ -62,13 +124,58 @@ int chpl_comm_install_callback(chpl_comm_cb_event_kind_t event_kind,
     return -1;
   }
 
+  cb = &cb_info[event_kind].cbs[i];
+  cb->fn = cb_fn;
+  cb->batch_id = batch_id;
+  cb->filter = (filter == NULL) ? pass_all : *filter;
+  cb->sample_every = (cb->filter.sample_every > 1)
+                     ? cb->filter.sample_every : 1;
+  cb->filtered = (cb->filter.min_size > 0 ||
+                  cb->filter.node_lo > 0 ||
+                  cb->filter.node_hi < INT32_MAX ||
+                  cb->sample_every > 1);
+  sample_counts[event_kind][i] = 0;
+
   chpl_comm_callback_counts[event_kind]++;
-  cb_info[event_kind].fns[i]= cb_fn;
+  update_kind_filter(event_kind);
 
   return 0;
 }
 
 
+static void remove_entry(chpl_comm_cb_event_kind_t event_kind, int found_i) {
+  int i;
+
+  for (i = found_i + 1; i < chpl_comm_callback_counts[event_kind]; i++) {
+    cb_info[event_kind].cbs[i - 1] = cb_info[event_kind].cbs[i];
+  }
+
+  chpl_comm_callback_counts[event_kind]--;
+  update_kind_filter(event_kind);
+}
+
+
+//
+// Communication callback support.
+//
+int chpl_comm_install_callback(chpl_comm_cb_event_kind_t event_kind,
+                               chpl_comm_cb_fn_t cb_fn) {
+  return chpl_comm_install_filtered_callback(event_kind, cb_fn, NULL);
+}
+
+
+int chpl_comm_install_filtered_callback(chpl_comm_cb_event_kind_t event_kind,
+                                        chpl_comm_cb_fn_t cb_fn,
+                                        const chpl_comm_cb_filter_t* filter) {
+  if (event_kind >= chpl_comm_cb_num_event_kinds) {
+    errno = ERANGE;
+    return -1;
+  }
+
+  return install_entry(event_kind, cb_fn, -1, filter);
+}
+
+
 int chpl_comm_uninstall_callback(chpl_comm_cb_event_kind_t event_kind,
                                  chpl_comm_cb_fn_t cb_fn) {
   int i;
@@ -80,7 +187,8 @@ int chpl_comm_uninstall_callback(chpl_comm_cb_event_kind_t event_kind,
   }
 
   for (i = 0, found_i = -1; i < chpl_comm_callback_counts[event_kind]; i++) {
-    if (cb_info[event_kind].fns[i] == cb_fn) {
+    if (cb_info[event_kind].cbs[i].batch_id < 0 &&
+        cb_info[event_kind].cbs[i].fn == cb_fn) {
       found_i = i;
       break;
     }
@@ -91,19 +199,219 @@ int chpl_comm_uninstall_callback(chpl_comm_cb_event_kind_t event_kind,
     return -1;
   }
 
-  for (i = found_i + 1; i < chpl_comm_callback_counts[event_kind]; i++) {
-    cb_info[event_kind].fns[i - 1] = cb_info[event_kind].fns[i];
+  remove_entry(event_kind, found_i);
+
+  return 0;
+}
+
+
+// Deliver the events collected for a batched callback by all threads.
+static void flush_batch_slot(struct batch_slot* slot) {
+  struct batch_buf* b;
+
+  for (b = slot->bufs; b != NULL; b = b->next) {
+    pthread_mutex_lock(&b->lock);
+    if (b->gen == slot->gen && b->n > 0) {
+      (slot->fn)(b->infos, b->n);
+      b->n = 0;
+    }
+    pthread_mutex_unlock(&b->lock);
   }
+}
 
-  chpl_comm_callback_counts[event_kind]--;
+
+int chpl_comm_install_batch_callback(chpl_comm_cb_event_kind_t event_kind,
+                                     chpl_comm_cb_batch_fn_t cb_fn,
+                                     const chpl_comm_cb_filter_t* filter,
+                                     int batch_len) {
+  int id;
+
+  if (event_kind >= chpl_comm_cb_num_event_kinds) {
+    errno = ERANGE;
+    return -1;
+  }
+
+  if (batch_len < 1) {
+    errno = EINVAL;
+    return -1;
+  }
+
+  pthread_mutex_lock(&batch_slots_lock);
+  for (id = 0; id < MAX_BATCH_CBS && batch_slots[id].fn != NULL; id++)
+    ;
+  if (id >= MAX_BATCH_CBS) {
+    pthread_mutex_unlock(&batch_slots_lock);
+    errno = ENOMEM;
+    return -1;
+  }
+  batch_slots[id].fn = cb_fn;
+  batch_slots[id].batch_len = batch_len;
+  batch_slots[id].gen++;
+  pthread_mutex_unlock(&batch_slots_lock);
+
+  if (install_entry(event_kind, NULL, id, filter) != 0) {
+    pthread_mutex_lock(&batch_slots_lock);
+    batch_slots[id].fn = NULL;
+    pthread_mutex_unlock(&batch_slots_lock);
+    return -1;
+  }
 
   return 0;
 }
 
+
+int chpl_comm_uninstall_batch_callback(chpl_comm_cb_event_kind_t event_kind,
+                                       chpl_comm_cb_batch_fn_t cb_fn) {
+  int i;
+  int found_i;
+  int id;
+
+  if (event_kind >= chpl_comm_cb_num_event_kinds) {
+    errno = ERANGE;
+    return -1;
+  }
+
+  for (i = 0, found_i = -1; i < chpl_comm_callback_counts[event_kind]; i++) {
+    id = cb_info[event_kind].cbs[i].batch_id;
+    if (id >= 0 && batch_slots[id].fn == cb_fn) {
+      found_i = i;
+      break;
+    }
+  }
+
+  if (found_i < 0) {
+    errno = ENOENT;
+    return -1;
+  }
+
+  id = cb_info[event_kind].cbs[found_i].batch_id;
+  remove_entry(event_kind, found_i);
+
+  pthread_mutex_lock(&batch_slots_lock);
+  flush_batch_slot(&batch_slots[id]);
+  batch_slots[id].fn = NULL;
+  pthread_mutex_unlock(&batch_slots_lock);
+
+  return 0;
+}
+
+
+void chpl_comm_flush_callbacks(void) {
+  int id;
+
+  pthread_mutex_lock(&batch_slots_lock);
+  for (id = 0; id < MAX_BATCH_CBS; id++) {
+    if (batch_slots[id].fn != NULL) {
+      flush_batch_slot(&batch_slots[id]);
+    }
+  }
+  pthread_mutex_unlock(&batch_slots_lock);
+}
+
+
+static struct batch_buf* get_batch_buf(int id) {
+  struct batch_buf* b = my_batch_bufs[id];
+
+  if (b == NULL) {
+    b = chpl_mem_alloc(sizeof(*b), CHPL_RT_MD_COMM_UTIL, 0, 0);
+    pthread_mutex_init(&b->lock, NULL);
+    b->gen = 0;
+    b->n = 0;
+    b->len = 0;
+    b->infos = NULL;
+
+    pthread_mutex_lock(&batch_slots_lock);
+    b->next = batch_slots[id].bufs;
+    batch_slots[id].bufs = b;
+    pthread_mutex_unlock(&batch_slots_lock);
+
+    my_batch_bufs[id] = b;
+  }
+
+  return b;
+}
+
+
+static void add_to_batch(int id, const chpl_comm_cb_info_t *info) {
+  struct batch_slot* slot = &batch_slots[id];
+  struct batch_buf* b = get_batch_buf(id);
+  chpl_comm_cb_info_t* copy;
+
+  pthread_mutex_lock(&b->lock);
+
+  // Start over if the slot has been reused since we last added to it.
+  if (b->gen != slot->gen) {
+    if (b->len != slot->batch_len) {
+      if (b->infos != NULL)
+        chpl_mem_free(b->infos, 0, 0);
+      b->infos = chpl_mem_allocMany(slot->batch_len, sizeof(b->infos[0]),
+                                    CHPL_RT_MD_COMM_UTIL, 0, 0);
+      b->len = slot->batch_len;
+    }
+    b->n = 0;
+    b->gen = slot->gen;
+  }
+
+  copy = &b->infos[b->n++];
+  *copy = *info;
+  if (info->event_kind == chpl_comm_cb_event_kind_put_strd ||
+      info->event_kind == chpl_comm_cb_event_kind_get_strd) {
+    // these only live as long as the event
+    copy->iu.comm_strd.srcstrides = NULL;
+    copy->iu.comm_strd.dststrides = NULL;
+    copy->iu.comm_strd.count = NULL;
+  }
+
+  if (b->n == b->len) {
+    (slot->fn)(b->infos, b->n);
+    b->n = 0;
+  }
+
+  pthread_mutex_unlock(&b->lock);
+}
+
+
+// the size the min_size filter compares against
+static size_t event_size(const chpl_comm_cb_info_t *info) {
+  switch (info->event_kind) {
+  case chpl_comm_cb_event_kind_put:
+  case chpl_comm_cb_event_kind_put_nb:
+  case chpl_comm_cb_event_kind_get:
+  case chpl_comm_cb_event_kind_get_nb:
+    return info->iu.comm.size;
+  case chpl_comm_cb_event_kind_put_strd:
+  case chpl_comm_cb_event_kind_get_strd:
+    return chpl_comm_cb_strd_size(info->iu.comm_strd.count,
+                                  info->iu.comm_strd.stridelevels,
+                                  info->iu.comm_strd.elemSize);
+  default:
+    return info->iu.executeOn.arg_size;
+  }
+}
+
+
+static int passes_filter(struct cb_entry* cb, uint32_t* sample_count,
+                         const chpl_comm_cb_info_t *info, size_t size) {
+  if (!cb->filtered)
+    return 1;
+  if (size < cb->filter.min_size ||
+      info->remoteNodeID < cb->filter.node_lo ||
+      info->remoteNodeID > cb->filter.node_hi)
+    return 0;
+  if (cb->sample_every > 1) {
+    if (++*sample_count < cb->sample_every)
+      return 0;
+    *sample_count = 0;
+  }
+  return 1;
+}
+
+
 void chpl_comm_do_callbacks(const chpl_comm_cb_info_t *info)
 {
   int i;
   struct cb_info *cb;
+  size_t size;
 
   // Don't do anything if the event kind is bad
   if (info->event_kind >= chpl_comm_cb_num_event_kinds)
@@ -111,7 +419,15 @@ void chpl_comm_do_callbacks(const chpl_comm_cb_info_t *info)
 
   // Call the callbacks
   cb = &cb_info[info->event_kind];
+  size = event_size(info);
   for (i = 0; i < chpl_comm_callback_counts[info->event_kind]; i++) {
-    (cb->fns[i])(info);
+    struct cb_entry* e = &cb->cbs[i];
+    if (!passes_filter(e, &sample_counts[info->event_kind][i], info, size))
+      continue;
+    if (e->batch_id < 0) {
+      (e->fn)(info);
+    } else {
+      add_to_batch(e->batch_id, info);
+    }
   }
 }
@@ -23,28 +23,378 @@
 //
 
 #include "chplrt.h"
+#include "chpl-env.h"
 #include "chpl-env-gen.h"
 
 #include "chpl-comm.h"
 #include "chpl-comm-diags.h"
 #include "chpl-comm-internal.h"
+#include "chpl-linefile-support.h"
+#include "chpl-mem.h"
 #include "chpl-mem-consistency.h"
+#include "chpl-thread-local-storage.h"
 #include "error.h"
 
+#include <inttypes.h>
+#include <pthread.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 int chpl_verbose_comm = 0;
 int chpl_verbose_comm_stacktrace = 0;
 int chpl_comm_diagnostics = 0;
 int chpl_comm_diags_print_unstable = 0;
+int chpl_comm_diags_callsites = 0;
 
 chpl_atomic_commDiagnostics chpl_comm_diags_counters;
 
 static pthread_once_t bcastPrintUnstable_once = PTHREAD_ONCE_INIT;
 
 
+////////////////////
+//
+// Per-call-site profiling
+//
+// Each thread records into its own open-addressed hash table, keyed
+// by (operation, file, line).  The operation names are string
+// literals, so within a table they are compared by address; the same
+// name can have different addresses in different translation units,
+// so the report merges by string.  The per-table lock is only ever
+// contended by a report or reset running on another thread.  Tables
+// outlive their threads, since what they hold is still wanted.
+//
+
+typedef struct {
+  const char* op;
+  int32_t fn;
+  int ln;
+  uint64_t count;
+  uint64_t bytes;
+  uint64_t lat_n;
+  uint64_t lat_ns;
+  uint64_t lat[CHPL_COMM_DIAGS_LAT_BUCKETS];
+} callsite_t;
+
+typedef struct callsite_table_s {
+  struct callsite_table_s* next;          // in callsite_tables
+  atomic_spinlock_t lock;
+  size_t cap;                             // always a power of 2
+  size_t n;
+  callsite_t* sites;
+  callsite_t* last;                       // most recently recorded
+} callsite_table_t;
+
+CHPL_TLS_DECL(callsite_table_t*, thread_callsites);
+
+static pthread_mutex_t callsite_tables_lock = PTHREAD_MUTEX_INITIALIZER;
+static callsite_table_t* callsite_tables = NULL;
+
+
+void chpl_comm_diags_callsite_init(void) {
+  chpl_comm_diags_callsites = chpl_env_rt_get_bool("COMM_DIAGS_CALLSITES",
+                                                   false);
+  if (chpl_comm_diags_callsites) {
+    CHPL_TLS_INIT(thread_callsites);
+  }
+}
+
+
+static
+callsite_table_t* get_thread_callsites(void) {
+  callsite_table_t* t;
+
+  if ((t = (callsite_table_t*) CHPL_TLS_GET(thread_callsites)) == NULL) {
+    if ((t = (callsite_table_t*) chpl_calloc(1, sizeof(*t))) == NULL) {
+      return NULL;
+    }
+    atomic_init_spinlock_t(&t->lock);
+    CHPL_TLS_SET(thread_callsites, t);
+
+    pthread_mutex_lock(&callsite_tables_lock);
+    t->next = callsite_tables;
+    callsite_tables = t;
+    pthread_mutex_unlock(&callsite_tables_lock);
+  }
+
+  return t;
+}
+
+
+static inline
+size_t callsite_hash(const char* op, int ln, int32_t fn) {
+  uint64_t h = (uint64_t) (uintptr_t) op;
+  h ^= ((uint64_t) (uint32_t) fn << 32) | (uint32_t) ln;
+  h *= UINT64_C(0x9e3779b97f4a7c15);
+  return (size_t) (h >> 32);
+}
+
+
+// Find the entry for a call site, adding it if need be.  The caller
+// holds the table lock.
+static
+callsite_t* callsite_find(callsite_table_t* t,
+                          const char* op, int ln, int32_t fn) {
+  size_t i;
+
+  if (t->n + 1 > t->cap / 4 * 3) {
+    size_t newCap = (t->cap == 0) ? 256 : 2 * t->cap;
+    callsite_t* sites = (callsite_t*) chpl_calloc(newCap, sizeof(*sites));
+    if (sites == NULL) {
+      return NULL;
+    }
+    for (size_t j = 0; j < t->cap; j++) {
+      callsite_t* e = &t->sites[j];
+      if (e->op != NULL) {
+        i = callsite_hash(e->op, e->ln, e->fn) & (newCap - 1);
+        while (sites[i].op != NULL) {
+          i = (i + 1) & (newCap - 1);
+        }
+        sites[i] = *e;
+      }
+    }
+    chpl_free(t->sites);
+    t->sites = sites;
+    t->cap = newCap;
+    t->last = NULL;
+  }
+
+  i = callsite_hash(op, ln, fn) & (t->cap - 1);
+  while (t->sites[i].op != NULL) {
+    callsite_t* e = &t->sites[i];
+    if (e->op == op && e->ln == ln && e->fn == fn) {
+      return e;
+    }
+    i = (i + 1) & (t->cap - 1);
+  }
+
+  t->sites[i].op = op;
+  t->sites[i].ln = ln;
+  t->sites[i].fn = fn;
+  t->n++;
+  return &t->sites[i];
+}
+
+
+void chpl_comm_diags_callsite_record(const char* op, size_t size,
+                                     int ln, int32_t fn) {
+  callsite_table_t* t;
+  callsite_t* e;
+
+  if ((t = get_thread_callsites()) == NULL) {
+    return;
+  }
+
+  atomic_lock_spinlock_t(&t->lock);
+  if ((e = callsite_find(t, op, ln, fn)) != NULL) {
+    e->count++;
+    e->bytes += size;
+  }
+  t->last = e;
+  atomic_unlock_spinlock_t(&t->lock);
+}
+
+
+//
+// The latency of an operation is reported just after the comm layer
+// recorded the operation itself, from a different translation unit,
+// so look at the most recent entry first and match it by name.
+//
+void chpl_comm_diags_callsite_latency(const char* op, uint64_t ns,
+                                      int ln, int32_t fn) {
+  callsite_table_t* t;
+  callsite_t* e;
+  int b;
+
+  if ((t = get_thread_callsites()) == NULL) {
+    return;
+  }
+
+  for (b = 0;
+       b < CHPL_COMM_DIAGS_LAT_BUCKETS - 1 && (ns >> (b + 6)) != 0;
+       b++)
+    ;
+
+  atomic_lock_spinlock_t(&t->lock);
+  e = t->last;
+  if (e == NULL || e->ln != ln || e->fn != fn || strcmp(e->op, op) != 0) {
+    e = callsite_find(t, op, ln, fn);
+  }
+  if (e != NULL) {
+    e->lat_n++;
+    e->lat_ns += ns;
+    e->lat[b]++;
+  }
+  atomic_unlock_spinlock_t(&t->lock);
+}
+
+
+static
+int callsite_cmp_key(const void* va, const void* vb) {
+  const callsite_t* a = (const callsite_t*) va;
+  const callsite_t* b = (const callsite_t*) vb;
+  int c;
+
+  if (a->fn != b->fn) {
+    return (a->fn < b->fn) ? -1 : 1;
+  }
+  if (a->ln != b->ln) {
+    return (a->ln < b->ln) ? -1 : 1;
+  }
+  if ((c = strcmp(a->op, b->op)) != 0) {
+    return c;
+  }
+  return 0;
+}
+
+
+static
+int callsite_cmp_count(const void* va, const void* vb) {
+  const callsite_t* a = (const callsite_t*) va;
+  const callsite_t* b = (const callsite_t*) vb;
+
+  if (a->count != b->count) {
+    return (a->count > b->count) ? -1 : 1;
+  }
+  if (a->bytes != b->bytes) {
+    return (a->bytes > b->bytes) ? -1 : 1;
+  }
+  return callsite_cmp_key(a, b);
+}
+
+
+//
+// Gather every thread's entries, clearing the tables as we go.
+// Returns the number gathered, or -1 if there wasn't memory.
+//
+static
+ssize_t callsite_gather(callsite_t** sites_p) {
+  callsite_t* sites = NULL;
+  size_t n = 0;
+  size_t cap = 0;
+
+  pthread_mutex_lock(&callsite_tables_lock);
+  for (callsite_table_t* t = callsite_tables; t != NULL; t = t->next) {
+    atomic_lock_spinlock_t(&t->lock);
+    if (sites_p != NULL && n + t->n > cap) {
+      size_t newCap = (cap == 0) ? 256 : cap;
+      callsite_t* newSites;
+      while (newCap < n + t->n) {
+        newCap *= 2;
+      }
+      newSites = (callsite_t*) chpl_realloc(sites, newCap * sizeof(*sites));
+      if (newSites == NULL) {
+        atomic_unlock_spinlock_t(&t->lock);
+        pthread_mutex_unlock(&callsite_tables_lock);
+        chpl_free(sites);
+        return -1;
+      }
+      sites = newSites;
+      cap = newCap;
+    }
+    for (size_t i = 0; i < t->cap; i++) {
+      if (t->sites[i].op != NULL) {
+        if (sites_p != NULL) {
+          sites[n++] = t->sites[i];
+        }
+        memset(&t->sites[i], 0, sizeof(t->sites[i]));
+      }
+    }
+    t->n = 0;
+    t->last = NULL;
+    atomic_unlock_spinlock_t(&t->lock);
+  }
+  pthread_mutex_unlock(&callsite_tables_lock);
+
+  if (sites_p != NULL) {
+    *sites_p = sites;
+  }
+  return (ssize_t) n;
+}
+
+
+void chpl_comm_diags_callsite_report(void) {
+  callsite_t* sites;
+  ssize_t got;
+  size_t n;
+
+  if (!chpl_comm_diags_callsites) {
+    return;
+  }
+
+  if ((got = callsite_gather(&sites)) <= 0) {
+    if (got < 0) {
+      chpl_warning("out of memory for comm diagnostics call sites", 0, 0);
+    }
+    return;
+  }
+
+  // Merge entries for the same call site from different threads.
+  qsort(sites, got, sizeof(*sites), callsite_cmp_key);
+  n = 0;
+  for (size_t i = 0; i < (size_t) got; i++) {
+    if (n > 0 && callsite_cmp_key(&sites[n - 1], &sites[i]) == 0) {
+      callsite_t* m = &sites[n - 1];
+      m->count += sites[i].count;
+      m->bytes += sites[i].bytes;
+      m->lat_n += sites[i].lat_n;
+      m->lat_ns += sites[i].lat_ns;
+      for (int b = 0; b < CHPL_COMM_DIAGS_LAT_BUCKETS; b++) {
+        m->lat[b] += sites[i].lat[b];
+      }
+    } else {
+      sites[n++] = sites[i];
+    }
+  }
+  qsort(sites, n, sizeof(*sites), callsite_cmp_count);
+
+  printf("%d: comm diagnostics by call site:\n", chpl_nodeID);
+  for (size_t i = 0; i < n; i++) {
+    callsite_t* e = &sites[i];
+    printf("%d: %s:%d: %s: %" PRIu64 " ops, %" PRIu64 " bytes",
+           chpl_nodeID, chpl_lookupFilename(e->fn), e->ln, e->op,
+           e->count, e->bytes);
+    if (e->lat_n > 0) {
+      printf(", mean %" PRIu64 " ns, histogram",
+             e->lat_ns / e->lat_n);
+      for (int b = 0; b < CHPL_COMM_DIAGS_LAT_BUCKETS; b++) {
+        if (e->lat[b] == 0) {
+          continue;
+        }
+        if (b < CHPL_COMM_DIAGS_LAT_BUCKETS - 1) {
+          printf(" <%" PRIu64 ":%" PRIu64,
+                 UINT64_C(1) << (b + 6), e->lat[b]);
+        } else {
+          printf(" >=%" PRIu64 ":%" PRIu64,
+                 UINT64_C(1) << (b + 5), e->lat[b]);
+        }
+      }
+    }
+    printf("\n");
+  }
+  fflush(stdout);
+
+  chpl_free(sites);
+}
+
+
+void chpl_comm_diags_callsite_reset(void) {
+  if (chpl_comm_diags_callsites) {
+    (void) callsite_gather(NULL);
+  }
+}
+
+
+//
+// Report whatever is left at exit. Locales other than the one that
+// stopped diagnostics get here with everything they recorded.
+//
+void chpl_comm_diags_callsite_exit(void) {
+  chpl_comm_diags_callsite_report();
+}
+
+
 static
 void broadcast_print_unstable(void) {
   chpl_bool prevDisabled = chpl_task_setCommDiagsTemporarilyDisabled(true);
@@ -147,6 +497,8 @@ void chpl_comm_stopDiagnostics(int32_t lineno, int32_t filename) {
   chpl_bool prevDisabled = chpl_task_setCommDiagsTemporarilyDisabled(true);
   chpl_comm_bcast_rt_private(chpl_comm_diagnostics);
   (void)chpl_task_setCommDiagsTemporarilyDisabled(prevDisabled);
+
+  chpl_comm_diags_callsite_report();
 }
 
 
@@ -173,6 +525,7 @@ void chpl_comm_stopDiagnosticsHere(int32_t lineno, int32_t filename) {
     chpl_warning("comm diagnostics was never started", lineno, filename);
   }
   chpl_comm_diagnostics = 0;
+  chpl_comm_diags_callsite_report();
 }
 
 
@@ -25,20 +25,25 @@
 #include "chplrt.h"
 
 #include "chpl-align.h"
+#include "chpl-atomics.h"
 #include "chpl-comm.h"
 #include "chpl-comm-compiler-macros.h"
 #include "chpl-comm-diags.h"
 #include "chpl-comm-internal.h"
 #include "chpl-gpu-diags.h"
 #include "chpl-env.h"
+#include "chpl-format.h"
 #include "chpl-mem.h"
 #include "chpl-topo.h"
+#include "chpltimers.h"
+#include "error.h"
 
 // Don't get warning macros for chpl_comm_get etc.
 #include "chpl-comm-no-warning-macros.h"
 
 #include <pthread.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <string.h>
 #include <unistd.h>
 
@@ -58,42 +63,29 @@ void chpl_comm_register_global_var(int i, wide_ptr_t *ptr_to_wide_ptr) {
 
 void chpl_comm_broadcast_global_vars(int numGlobals) {
   //
-  // On node 0: gather up the global variables' wide pointers into a
-  //            buffer; return that buffer if it needs deallocating
-  //            after the communication, otherwise NULL.
-  // On other nodes: retrieve the node 0 local address of that buffer.
-  //
-  wide_ptr_t* buf_on_0;
-  buf_on_0 = chpl_comm_broadcast_global_vars_helper();
-
-  //
-  // On node 0: barrier to ensure the other nodes have the global vars;
-  //            free the buffer if needed.
-  // On other nodes: GET the buffer of wide pointers; scatter it into
-  //                 our copies of the global vars; barrier to indicate
-  //                 we're done.  Node 0 could actually free the buffer
-  //                 as soon as we GET it, but we also have to prevent
-  //                 node 0 from running any Chapel code until all the
-  //                 other nodes have recorded the wide pointers.  So,
-  //                 we delay our barrier to achieve both goals.
+  // Node 0 gathers the global variables' wide pointers into a buffer,
+  // we broadcast that, and the other nodes scatter it into their copies
+  // of the global vars.  The broadcast takes log2(numNodes) steps, so
+  // nobody waits on node 0 alone.  The barrier keeps node 0 from
+  // running any Chapel code until all the other nodes have recorded
+  // the wide pointers.
   //
+  size_t size = chpl_numGlobalsOnHeap * sizeof(wide_ptr_t);
+  wide_ptr_t* buf = (wide_ptr_t*)
+                    chpl_mem_alloc(size, CHPL_RT_MD_COMM_PER_LOC_INFO, 0, 0);
   if (chpl_nodeID == 0) {
-    chpl_comm_barrier("broadcast global vars");
-    if (buf_on_0 != NULL) {
-      chpl_mem_free(buf_on_0, 0, 0);
+    for (int i = 0; i < chpl_numGlobalsOnHeap; i++) {
+      buf[i] = *chpl_globals_registry[i];
     }
-  } else {
-    wide_ptr_t* buf;
-    size_t size = chpl_numGlobalsOnHeap * sizeof(*buf);
-    buf = (wide_ptr_t*)
-          chpl_mem_alloc(size, CHPL_RT_MD_COMM_PER_LOC_INFO, 0, 0);
-    chpl_comm_get(buf, 0, buf_on_0, size, CHPL_COMM_UNKNOWN_ID, 0, -1);
+  }
+  chpl_comm_bcast(0, buf, size);
+  if (chpl_nodeID != 0) {
     for (int i = 0; i < chpl_numGlobalsOnHeap; i++) {
       *chpl_globals_registry[i] = buf[i];
     }
-    chpl_comm_barrier("broadcast global vars");
-    chpl_mem_free(buf, 0, 0);
   }
+  chpl_comm_barrier("broadcast global vars");
+  chpl_mem_free(buf, 0, 0);
 }
 
 
@@ -167,12 +159,13 @@ ssize_t chpl_comm_getenvMaxHeapSize(void)
 typedef struct {
   unsigned char *start;
   uintptr_t size;
-  int tid;
-  int nthreads;
+  int tid;                      // index among the threads touching this
+  int nthreads;                 // number of threads touching this
+  c_sublocid_t subloc;          // NUMA domain to run on
 } memory_region;
 
-// Pin a thread a specific NUMA domain and cyclically touch pages to get
-// interleaved memory. We don't have an accurate estimate of the page size when
+// Pin a thread to a specific NUMA domain and cyclically touch pages of its
+// region. We don't have an accurate estimate of the page size when
 // Transparent Huge Pages (THP) are used, so we fault in regions in at least 2
 // MiB chunks to cover the most common THP size. We then touch the first
 // element of every system page or non-transparent huge page to fault in.
@@ -183,9 +176,12 @@ static void *touch_thread(void *mem_region) {
   uintptr_t touch_size = page_size > 2<<20 ? page_size: 2<<20;
   unsigned char* aligned_start = round_up_to_mask_ptr(mr->start, touch_size-1);
   uintptr_t aligned_offset = (uintptr_t)aligned_start - (uintptr_t)mr->start;
-  uintptr_t aligned_size = round_down_to_mask(mr->size - aligned_offset, touch_size-1);
+  uintptr_t aligned_size = (mr->size > aligned_offset)
+                           ? round_down_to_mask(mr->size - aligned_offset,
+                                                touch_size-1)
+                           : 0;
 
-  chpl_topo_setThreadLocality(mr->tid % chpl_topo_getNumNumaDomains());
+  chpl_topo_setThreadLocality(mr->subloc);
   // Iterate through all the touch regions cyclically
   for (uintptr_t tr=mr->tid*touch_size; tr<aligned_size; tr+=mr->nthreads*touch_size) {
     // Iterate through all the page regions in the current region we're touching
@@ -196,29 +192,120 @@ static void *touch_thread(void *mem_region) {
   return NULL;
 }
 
+//
+// How chpl_comm_regMemHeapTouch() places the heap.  With "interleave"
+// (the default) pages go round-robin across the NUMA domains.  With
+// "sublocale" the heap is split into one consecutive block per domain,
+// in order, matching chpl_topo_setMemSubchunkLocality().  With "none"
+// we don't prefault and the heap is faulted in at registration time.
+//
+typedef enum {
+  heap_interleave,
+  heap_sublocale,
+  heap_none,
+} heap_placement_t;
+
+static heap_placement_t get_heap_placement(void) {
+  const char* env = chpl_env_rt_get("COMM_HEAP_PLACEMENT", NULL);
+  if (env == NULL || strcmp(env, "interleave") == 0) {
+    return heap_interleave;
+  } else if (strcmp(env, "sublocale") == 0) {
+    return heap_sublocale;
+  } else if (strcmp(env, "none") == 0) {
+    return heap_none;
+  } else {
+    char msg[200];
+    snprintf(msg, sizeof(msg),
+             "CHPL_RT_COMM_HEAP_PLACEMENT must be \"interleave\", "
+             "\"sublocale\" or \"none\", not \"%s\". Using \"interleave\".",
+             env);
+    chpl_warning(msg, 0, 0);
+    return heap_interleave;
+  }
+}
+
 // Touch or fault-in a region of memory. Meant to be used on the registered
-// heap/segment for configurations that register a static heap.  We try to
-// touch the memory in an interleaved/cyclic fashion in parallel to improve
-// NUMA affinity and the speed of faulting memory in. Without this memory will
+// heap/segment for configurations that register a static heap.  We
+// set the memory's NUMA policy and then touch it in parallel, with
+// threads spread across all the NUMA domains, to improve NUMA affinity
+// and the speed of faulting memory in. Without this memory will
 // be faulted in serially at NIC registration time, which is slow and leads to
 // poor NUMA affinity with memory split evenly in massive chunks across NUMA
-// domains.
+// domains.  With --verbose, report how long it took.
 void chpl_comm_regMemHeapTouch(void* start, uintptr_t size) {
+  heap_placement_t placement = get_heap_placement();
+  if (placement == heap_none) {
+    return;
+  }
+
+  int nsublocs = chpl_topo_getNumNumaDomains();
+  if (nsublocs < 1) {
+    nsublocs = 1;
+  }
   int nthreads = chpl_topo_getNumCPUsPhysical(true);
+  if (nthreads < nsublocs) {
+    nthreads = nsublocs;
+  }
   pthread_t thread_id[nthreads];
   memory_region mem_regions[nthreads];
+  uint64_t t0 = chpl_fast_timer_ns();
+
+  if (placement == heap_interleave) {
+    chpl_topo_interleaveMemLocality(start, size);
+    for (int tid=0; tid<nthreads; tid++) {
+      mem_regions[tid].start = start;
+      mem_regions[tid].size = size;
+      mem_regions[tid].tid = tid;
+      mem_regions[tid].nthreads = nthreads;
+      mem_regions[tid].subloc = tid % nsublocs;
+    }
+  } else {
+    //
+    // Thread tid touches its share of the block for domain
+    // tid % nsublocs.  If there's no topology to tell us the block
+    // sizes we still split the heap evenly, just without a policy.
+    //
+    size_t block_size[nsublocs];
+    unsigned char* block_start[nsublocs];
+    size_t page_size = chpl_comm_regMemHeapPageSize();
+    size_t npages = size / page_size;
+    for (int i=0; i<nsublocs; i++) {
+      size_t pg_lo = npages * i / nsublocs;
+      size_t pg_hi = (i == nsublocs - 1) ? npages : npages * (i + 1) / nsublocs;
+      block_size[i] = (pg_hi - pg_lo) * page_size;
+    }
+    chpl_topo_setMemSubchunkLocality(start, size, true, block_size);
+    block_start[0] = start;
+    for (int i=1; i<nsublocs; i++) {
+      block_start[i] = block_start[i-1] + block_size[i-1];
+    }
+    for (int tid=0; tid<nthreads; tid++) {
+      int subloc = tid % nsublocs;
+      mem_regions[tid].start = block_start[subloc];
+      mem_regions[tid].size = block_size[subloc];
+      mem_regions[tid].tid = tid / nsublocs;
+      mem_regions[tid].nthreads = nthreads / nsublocs
+                                  + (subloc < nthreads % nsublocs);
+      mem_regions[tid].subloc = subloc;
+    }
+  }
 
   for (int tid=0; tid<nthreads; tid++) {
-    mem_regions[tid].start = start;
-    mem_regions[tid].size = size;
-    mem_regions[tid].tid = tid;
-    mem_regions[tid].nthreads = nthreads;
     pthread_create(&thread_id[tid], NULL, touch_thread, (void *)&mem_regions[tid]);
   }
 
   for (int tid=0; tid<nthreads; tid++) {
     pthread_join(thread_id[tid], NULL);
   }
+
+  {
+    char buf[10];
+    chpl_msg(2, "%d: prefaulted %s fixed heap (%s) on %d threads in "
+             "%.3f seconds\n",
+             (int) chpl_nodeID, chpl_snprintf_KMG_z(buf, sizeof(buf), size),
+             (placement == heap_interleave) ? "interleaved" : "by sublocale",
+             nthreads, (chpl_fast_timer_ns() - t0) * 1e-9);
+  }
 }
 
 void* chpl_get_global_serialize_table(int64_t idx) {
@@ -269,3 +356,943 @@ int32_t chpl_get_local_rank(void) {
   return localRank;
 }
 
+
+
+//
+// Aggregated communication support.
+//
+// Each task has, for each node it has aggregated anything to, up to
+// three channels: PUT, GET, and executeOn.  A channel has two buffers.
+// One is filled while the operations for the other are in flight, and
+// when the one being filled is full we start it and then wait for the
+// other before filling that.
+//
+
+#define AGGR_MAX_OPS 128   // max PUTs or GETs per buffer
+
+enum aggr_kind {
+  aggr_kind_put,
+  aggr_kind_get,
+  aggr_kind_xo,
+  aggr_num_kinds
+};
+
+struct aggr_op_s {
+  void* addr;                   // GET target (PUT data is in the buffer)
+  void* raddr;                  // remote address
+  size_t off;                   // PUT: offset of the data in the buffer
+  size_t size;
+};
+
+struct aggr_buf_s {
+  char* data;                   // PUT data, or executeOn bundle
+  size_t used;                  // bytes of data used
+  int numOps;
+  struct aggr_op_s* ops;        // [AGGR_MAX_OPS] PUT and GET only
+  chpl_comm_nb_handle_t* handles;  // [AGGR_MAX_OPS] from the last send
+  int numHandles;
+};
+
+struct aggr_chan_s {
+  struct aggr_buf_s bufs[2];
+  int cur;                      // index of buffer being filled
+  chpl_fn_int_t fid;            // executeOn only: fid and sublocale of
+  c_sublocid_t subloc;          //   what's in the buffer being filled
+  int ln;
+  int32_t fn;
+};
+
+struct aggr_dest_s {
+  struct aggr_chan_s* chans[aggr_num_kinds];
+  chpl_bool active;             // on the task's active list?
+};
+
+typedef struct {
+  struct aggr_dest_s* dests;    // [chpl_numNodes]
+  c_nodeid_t* active;           // nodes that have something buffered
+  int numActive;
+  uint32_t opsSinceTimeCheck;
+  _real64 firstOpTime;          // when the oldest buffered op was added
+} aggr_taskData_t;
+
+// How often (in ops) to check the time, since that isn't free.
+#define AGGR_TIME_CHECK_INTERVAL 64
+
+static pthread_once_t aggr_once = PTHREAD_ONCE_INIT;
+static size_t aggrBuffSize;
+static _real64 aggrFlushSecs;
+
+static
+void aggr_init(void) {
+  aggrBuffSize = chpl_env_rt_get_size("COMM_AGGR_BUFF_SIZE", 8192);
+  if (aggrBuffSize < 64) {
+    aggrBuffSize = 64;
+  }
+  aggrFlushSecs = chpl_env_rt_get_int("COMM_AGGR_FLUSH_USECS", 1000) * 1.0e-6;
+}
+
+static inline
+aggr_taskData_t* aggr_task_data(chpl_bool create) {
+#ifdef HAS_CHPL_COMM_AGGR_BUFF
+  chpl_task_infoRuntime_t* infoRuntime = chpl_task_getInfoRuntime();
+  if (infoRuntime == NULL) {
+    return NULL;
+  }
+
+  aggr_taskData_t* td = infoRuntime->comm_data.aggr_buff;
+  if (td == NULL && create) {
+    pthread_once(&aggr_once, aggr_init);
+    td = chpl_mem_calloc(1, sizeof(*td), CHPL_RT_MD_COMM_UTIL, 0, 0);
+    td->dests = chpl_mem_calloc(chpl_numNodes, sizeof(td->dests[0]),
+                                CHPL_RT_MD_COMM_PER_LOC_INFO, 0, 0);
+    td->active = chpl_mem_allocMany(chpl_numNodes, sizeof(td->active[0]),
+                                    CHPL_RT_MD_COMM_PER_LOC_INFO, 0, 0);
+    infoRuntime->comm_data.aggr_buff = td;
+  }
+  return td;
+#else
+  return NULL;
+#endif
+}
+
+static
+struct aggr_chan_s* aggr_chan_alloc(enum aggr_kind kind) {
+  struct aggr_chan_s* chan;
+  chan = chpl_mem_calloc(1, sizeof(*chan), CHPL_RT_MD_COMM_UTIL, 0, 0);
+  for (int i = 0; i < 2; i++) {
+    struct aggr_buf_s* buf = &chan->bufs[i];
+    if (kind == aggr_kind_put) {
+      buf->data = chpl_mem_alloc(aggrBuffSize,
+                                 CHPL_RT_MD_COMM_XMIT_RCV_BUF, 0, 0);
+    } else if (kind == aggr_kind_xo) {
+      // bundle header, then payload length, then the records
+      buf->data = chpl_mem_alloc(sizeof(chpl_comm_on_bundle_t)
+                                 + sizeof(uint64_t) + aggrBuffSize,
+                                 CHPL_RT_MD_COMM_XMIT_RCV_BUF, 0, 0);
+    }
+    if (kind != aggr_kind_xo) {
+      buf->ops = chpl_mem_allocMany(AGGR_MAX_OPS, sizeof(buf->ops[0]),
+                                    CHPL_RT_MD_COMM_UTIL, 0, 0);
+      buf->handles = chpl_mem_allocMany(AGGR_MAX_OPS, sizeof(buf->handles[0]),
+                                        CHPL_RT_MD_COMM_UTIL, 0, 0);
+    }
+  }
+  return chan;
+}
+
+static
+void aggr_chan_free(struct aggr_chan_s* chan) {
+  for (int i = 0; i < 2; i++) {
+    chpl_mem_free(chan->bufs[i].data, 0, 0);
+    chpl_mem_free(chan->bufs[i].ops, 0, 0);
+    chpl_mem_free(chan->bufs[i].handles, 0, 0);
+  }
+  chpl_mem_free(chan, 0, 0);
+}
+
+//
+// Wait for all of a buffer's operations.  chpl_comm_wait_nb_some() may
+// return once only some of the handles are done, so repeat it until the
+// remaining ones are cleared.
+//
+static inline
+void aggr_buf_wait(struct aggr_buf_s* buf) {
+  int i = 0;
+  while (i < buf->numHandles) {
+    if (chpl_comm_test_nb_complete(buf->handles[i])) {
+      i++;
+    } else {
+      chpl_comm_wait_nb_some(&buf->handles[i], buf->numHandles - i);
+    }
+  }
+  buf->numHandles = 0;
+}
+
+//
+// Start the operations in the channel's current buffer, then switch to
+// the other buffer, waiting for its earlier operations if necessary.
+//
+static
+void aggr_chan_send(struct aggr_chan_s* chan, enum aggr_kind kind,
+                    c_nodeid_t node) {
+  struct aggr_buf_s* buf = &chan->bufs[chan->cur];
+  if (buf->numOps == 0) {
+    return;
+  }
+
+  chpl_comm_diags_incr(aggr_send);
+
+  switch (kind) {
+  case aggr_kind_put:
+    for (int i = 0; i < buf->numOps; i++) {
+      buf->handles[i] = chpl_comm_put_nb(buf->data + buf->ops[i].off, node,
+                                         buf->ops[i].raddr, buf->ops[i].size,
+                                         CHPL_COMM_UNKNOWN_ID,
+                                         chan->ln, chan->fn);
+    }
+    buf->numHandles = buf->numOps;
+    break;
+  case aggr_kind_get:
+    for (int i = 0; i < buf->numOps; i++) {
+      buf->handles[i] = chpl_comm_get_nb(buf->ops[i].addr, node,
+                                         buf->ops[i].raddr, buf->ops[i].size,
+                                         CHPL_COMM_UNKNOWN_ID,
+                                         chan->ln, chan->fn);
+    }
+    buf->numHandles = buf->numOps;
+    break;
+  case aggr_kind_xo:
+    {
+      chpl_comm_on_bundle_t* bundle = (chpl_comm_on_bundle_t*) buf->data;
+      uint64_t len = sizeof(uint64_t) + buf->used;
+      *(uint64_t*) bundle->payload = len;
+      // execute_on_nb copies the bundle, so nothing to wait for here
+      chpl_comm_execute_on_nb(node, chan->subloc, chan->fid, bundle,
+                              sizeof(*bundle) + len, chan->ln, chan->fn);
+    }
+    break;
+  default:
+    break;
+  }
+
+  buf->numOps = 0;
+  buf->used = 0;
+  chan->cur = 1 - chan->cur;
+  aggr_buf_wait(&chan->bufs[chan->cur]);
+}
+
+//
+// Send everything the task has buffered.  If 'fini', also wait for it
+// all to complete and release the buffers.
+//
+static
+void aggr_send_all(aggr_taskData_t* td, chpl_bool fini) {
+  for (int i = 0; i < td->numActive; i++) {
+    c_nodeid_t node = td->active[i];
+    struct aggr_dest_s* dest = &td->dests[node];
+    for (int k = 0; k < aggr_num_kinds; k++) {
+      struct aggr_chan_s* chan = dest->chans[k];
+      if (chan == NULL) {
+        continue;
+      }
+      aggr_chan_send(chan, (enum aggr_kind) k, node);
+      if (fini) {
+        aggr_buf_wait(&chan->bufs[0]);
+        aggr_buf_wait(&chan->bufs[1]);
+        aggr_chan_free(chan);
+        dest->chans[k] = NULL;
+      }
+    }
+    if (fini) {
+      dest->active = false;
+    }
+  }
+  if (fini) {
+    td->numActive = 0;
+  }
+  td->firstOpTime = 0.0;
+}
+
+//
+// Find or create the channel for an op of the given kind to the given
+// node, and check whether it's time to do a timed flush.
+//
+static
+struct aggr_chan_s* aggr_get_chan(aggr_taskData_t* td, c_nodeid_t node,
+                                  enum aggr_kind kind, int ln, int32_t fn) {
+  if (aggrFlushSecs > 0.0
+      && ++td->opsSinceTimeCheck >= AGGR_TIME_CHECK_INTERVAL) {
+    td->opsSinceTimeCheck = 0;
+    _real64 now = chpl_now_time();
+    if (td->firstOpTime == 0.0) {
+      td->firstOpTime = now;
+    } else if (now - td->firstOpTime > aggrFlushSecs) {
+      aggr_send_all(td, false);
+    }
+  }
+
+  struct aggr_dest_s* dest = &td->dests[node];
+  if (!dest->active) {
+    dest->active = true;
+    td->active[td->numActive++] = node;
+  }
+  if (dest->chans[kind] == NULL) {
+    dest->chans[kind] = aggr_chan_alloc(kind);
+  }
+
+  struct aggr_chan_s* chan = dest->chans[kind];
+  chan->ln = ln;
+  chan->fn = fn;
+  return chan;
+}
+
+
+void chpl_comm_aggr_put(void* addr, c_nodeid_t node, void* raddr,
+                        size_t size, int32_t commID, int ln, int32_t fn) {
+  if (node == chpl_nodeID) {
+    memmove(raddr, addr, size);
+    return;
+  }
+
+  aggr_taskData_t* td = aggr_task_data(true);
+  if (td == NULL || size > aggrBuffSize) {
+    chpl_comm_put(addr, node, raddr, size, commID, ln, fn);
+    return;
+  }
+
+  chpl_comm_diags_incr(aggr_put);
+
+  struct aggr_chan_s* chan = aggr_get_chan(td, node, aggr_kind_put, ln, fn);
+  struct aggr_buf_s* buf = &chan->bufs[chan->cur];
+  if (buf->numOps == AGGR_MAX_OPS || buf->used + size > aggrBuffSize) {
+    aggr_chan_send(chan, aggr_kind_put, node);
+    buf = &chan->bufs[chan->cur];
+  }
+
+  memcpy(buf->data + buf->used, addr, size);
+
+  // Extend the previous PUT if this one follows it in remote memory.
+  struct aggr_op_s* prev = (buf->numOps > 0) ? &buf->ops[buf->numOps - 1]
+                                             : NULL;
+  if (prev != NULL && (char*) prev->raddr + prev->size == (char*) raddr) {
+    prev->size += size;
+  } else {
+    buf->ops[buf->numOps++] = (struct aggr_op_s) { .raddr = raddr,
+                                                   .off = buf->used,
+                                                   .size = size, };
+  }
+  buf->used += size;
+}
+
+
+void chpl_comm_aggr_get(void* addr, c_nodeid_t node, void* raddr,
+                        size_t size, int32_t commID, int ln, int32_t fn) {
+  if (node == chpl_nodeID) {
+    memmove(addr, raddr, size);
+    return;
+  }
+
+  aggr_taskData_t* td = aggr_task_data(true);
+  if (td == NULL) {
+    chpl_comm_get(addr, node, raddr, size, commID, ln, fn);
+    return;
+  }
+
+  chpl_comm_diags_incr(aggr_get);
+
+  struct aggr_chan_s* chan = aggr_get_chan(td, node, aggr_kind_get, ln, fn);
+  struct aggr_buf_s* buf = &chan->bufs[chan->cur];
+
+  // Extend the previous GET if this one follows it at both ends.
+  struct aggr_op_s* prev = (buf->numOps > 0) ? &buf->ops[buf->numOps - 1]
+                                             : NULL;
+  if (prev != NULL
+      && (char*) prev->raddr + prev->size == (char*) raddr
+      && (char*) prev->addr + prev->size == (char*) addr) {
+    prev->size += size;
+    return;
+  }
+
+  if (buf->numOps == AGGR_MAX_OPS) {
+    aggr_chan_send(chan, aggr_kind_get, node);
+    buf = &chan->bufs[chan->cur];
+  }
+  buf->ops[buf->numOps++] = (struct aggr_op_s) { .addr = addr,
+                                                 .raddr = raddr,
+                                                 .size = size, };
+}
+
+
+void chpl_comm_aggr_execute_on(c_nodeid_t node, c_sublocid_t subloc,
+                               chpl_fn_int_t fid,
+                               void* rec, size_t rec_size,
+                               int ln, int32_t fn) {
+  size_t recSpace = sizeof(uint64_t) + ((rec_size + 7) & ~(size_t) 7);
+
+  aggr_taskData_t* td = aggr_task_data(true);
+  if (td == NULL || recSpace > aggrBuffSize) {
+    //
+    // Send it by itself, in the same format as an aggregated bundle.
+    //
+    size_t argSize = sizeof(chpl_comm_on_bundle_t) + sizeof(uint64_t)
+                     + recSpace;
+    chpl_comm_on_bundle_t* arg = chpl_mem_alloc(argSize,
+                                                CHPL_RT_MD_COMM_FRK_SND_ARG,
+                                                ln, fn);
+    char* payload = (char*) arg->payload;
+    *(uint64_t*) payload = sizeof(uint64_t) + recSpace;
+    *(uint64_t*) (payload + sizeof(uint64_t)) = rec_size;
+    memcpy(payload + 2 * sizeof(uint64_t), rec, rec_size);
+    chpl_comm_execute_on_nb(node, subloc, fid, arg, argSize, ln, fn);
+    chpl_mem_free(arg, ln, fn);
+    return;
+  }
+
+  chpl_comm_diags_incr(aggr_execute_on);
+
+  struct aggr_chan_s* chan = aggr_get_chan(td, node, aggr_kind_xo, ln, fn);
+  struct aggr_buf_s* buf = &chan->bufs[chan->cur];
+  if (buf->numOps > 0
+      && (chan->fid != fid || chan->subloc != subloc
+          || buf->used + recSpace > aggrBuffSize)) {
+    aggr_chan_send(chan, aggr_kind_xo, node);
+    buf = &chan->bufs[chan->cur];
+  }
+  chan->fid = fid;
+  chan->subloc = subloc;
+
+  char* recs = buf->data + sizeof(chpl_comm_on_bundle_t) + sizeof(uint64_t);
+  *(uint64_t*) (recs + buf->used) = rec_size;
+  memcpy(recs + buf->used + sizeof(uint64_t), rec, rec_size);
+  buf->used += recSpace;
+  buf->numOps++;
+}
+
+
+void chpl_comm_aggr_flush(void) {
+  aggr_taskData_t* td = aggr_task_data(false);
+  if (td != NULL) {
+    aggr_send_all(td, true);
+  }
+}
+
+
+void chpl_comm_aggr_task_end(void) {
+#ifdef HAS_CHPL_COMM_AGGR_BUFF
+  chpl_task_infoRuntime_t* infoRuntime = chpl_task_getInfoRuntime();
+  if (infoRuntime == NULL || infoRuntime->comm_data.aggr_buff == NULL) {
+    return;
+  }
+
+  aggr_taskData_t* td = infoRuntime->comm_data.aggr_buff;
+  aggr_send_all(td, true);
+  chpl_mem_free(td->dests, 0, 0);
+  chpl_mem_free(td->active, 0, 0);
+  chpl_mem_free(td, 0, 0);
+  infoRuntime->comm_data.aggr_buff = NULL;
+#endif
+}
+
+
+//
+// Asynchronous executeOn support.
+//
+// Each call gets a task here that does a blocking executeOn and then
+// marks the handle done, so this works the same with any comm layer.
+// The remote function PUTs its result, preceded by its size, straight
+// into the handle; that PUT is complete before the executeOn is.
+//
+struct chpl_comm_on_handle_s {
+  atomic_bool done;
+  c_nodeid_t node;
+  c_sublocid_t subloc;
+  chpl_fn_int_t fid;
+  chpl_comm_on_bundle_t* arg;   // our copy of the caller's bundle
+  size_t argSize;
+  int ln;
+  int32_t fn;
+  struct {
+    uint64_t size;
+    uint64_t data[CHPL_COMM_ON_ASYNC_MAX_RESULT / sizeof(uint64_t)];
+  } result;
+};
+
+typedef struct {
+  chpl_task_bundle_t hdr;
+  chpl_comm_on_handle_t h;
+} on_async_task_t;
+
+
+static
+void on_async_wrapper(on_async_task_t* bundle) {
+  chpl_comm_on_handle_t h = bundle->h;
+  chpl_comm_execute_on(h->node, h->subloc, h->fid, h->arg, h->argSize,
+                       h->ln, h->fn);
+  chpl_mem_free(h->arg, h->ln, h->fn);
+  h->arg = NULL;
+  atomic_store_bool(&h->done, true);
+}
+
+
+chpl_comm_on_handle_t chpl_comm_execute_on_async(c_nodeid_t node,
+                                                 c_sublocid_t subloc,
+                                                 chpl_fn_int_t fid,
+                                                 chpl_comm_on_bundle_t *arg,
+                                                 size_t arg_size,
+                                                 int ln, int32_t fn) {
+  if (arg_size < sizeof(chpl_comm_on_bundle_t)
+                 + sizeof(chpl_comm_on_reply_t)) {
+    chpl_internal_error("chpl_comm_execute_on_async() bundle has no reply");
+  }
+
+  chpl_comm_on_handle_t h = chpl_mem_alloc(sizeof(*h),
+                                           CHPL_RT_MD_COMM_FRK_DONE_FLAG,
+                                           ln, fn);
+  atomic_init_bool(&h->done, false);
+  h->node = node;
+  h->subloc = subloc;
+  h->fid = fid;
+  h->argSize = arg_size;
+  h->ln = ln;
+  h->fn = fn;
+  h->result.size = 0;
+
+  h->arg = chpl_mem_alloc(arg_size, CHPL_RT_MD_COMM_FRK_SND_ARG, ln, fn);
+  memcpy(h->arg, arg, arg_size);
+  chpl_comm_on_reply_t* reply = (chpl_comm_on_reply_t*) h->arg->payload;
+  reply->node = chpl_nodeID;
+  reply->result = &h->result;
+
+  on_async_task_t bundle = { .hdr.kind = CHPL_ARG_BUNDLE_KIND_TASK,
+                             .h = h };
+  chpl_task_startMovedTask(FID_NONE, (chpl_fn_p) on_async_wrapper,
+                           &bundle, sizeof(bundle),
+                           c_sublocid_any, chpl_nullTaskID);
+  return h;
+}
+
+
+int chpl_comm_test_on_complete(chpl_comm_on_handle_t h) {
+  return atomic_load_bool(&h->done);
+}
+
+
+size_t chpl_comm_wait_on_some(chpl_comm_on_handle_t* h, size_t nhandles) {
+  while (true) {
+    chpl_bool any = false;
+    for (size_t i = 0; i < nhandles; i++) {
+      if (h[i] != NULL) {
+        if (chpl_comm_test_on_complete(h[i])) {
+          return i;
+        }
+        any = true;
+      }
+    }
+    if (!any) {
+      return nhandles;
+    }
+    chpl_task_yield();
+  }
+}
+
+
+size_t chpl_comm_finish_on(chpl_comm_on_handle_t h,
+                           void* result, size_t size) {
+  while (!chpl_comm_test_on_complete(h)) {
+    chpl_task_yield();
+  }
+
+  size_t resultSize = h->result.size;
+  if (result != NULL && size > 0) {
+    memcpy(result, h->result.data, size < resultSize ? size : resultSize);
+  }
+
+  atomic_destroy_bool(&h->done);
+  chpl_mem_free(h, h->ln, h->fn);
+  return resultSize;
+}
+
+
+void chpl_comm_on_reply(chpl_comm_on_bundle_t* arg,
+                        const void* val, size_t size,
+                        int ln, int32_t fn) {
+  if (size > CHPL_COMM_ON_ASYNC_MAX_RESULT) {
+    chpl_internal_error("chpl_comm_on_reply() result is too big");
+  }
+
+  chpl_comm_on_reply_t* reply = (chpl_comm_on_reply_t*) arg->payload;
+  struct {
+    uint64_t size;
+    uint64_t data[CHPL_COMM_ON_ASYNC_MAX_RESULT / sizeof(uint64_t)];
+  } result;
+  result.size = size;
+  memcpy(result.data, val, size);
+  chpl_comm_put(&result, reply->node, reply->result,
+                sizeof(result.size) + size, CHPL_COMM_UNKNOWN_ID, ln, fn);
+}
+
+
+//
+// Collectives, for comm layers that don't have their own.
+//
+// Each locale has a mailbox of slots the others PUT data into, followed
+// by a sequence number saying which collective the data belongs to.
+// All the algorithms are dissemination-style: on each step every locale
+// sends to one locale and receives from another, so no locale finishes
+// a collective until all the others have started it.  A sender thus
+// can't get more than one collective ahead of a receiver, and two sets
+// of slots, used by alternate collectives, keep it from overwriting
+// data that hasn't been read yet.  Within a collective each slot is
+// written by only one locale.  Data bigger than a slot is done in
+// pieces, each a separate collective.
+//
+#define COLL_SLOT_SIZE 8192
+
+typedef struct {
+  volatile int64_t seq;
+  char data[COLL_SLOT_SIZE];
+} coll_slot_t;
+
+void* chpl_comm_coll_mboxMap_0;         // node 0's coll_mboxMap
+
+static int coll_numRounds;               // ceil(log2(chpl_numNodes))
+static int coll_numSlots;                // per set: one per step, + 2
+static coll_slot_t* coll_mbox;
+static coll_slot_t** coll_mboxMap;
+static int64_t coll_seq;
+
+
+static
+void coll_alloc(void) {
+  coll_numRounds = 0;
+  while ((1 << coll_numRounds) < chpl_numNodes) {
+    coll_numRounds++;
+  }
+  // The extra two are for allreduce's fold-in and fold-out steps.
+  coll_numSlots = coll_numRounds + 2;
+  coll_mbox = chpl_mem_allocManyZero(2 * coll_numSlots, sizeof(coll_mbox[0]),
+                                     CHPL_RT_MD_COMM_UTIL, 0, 0);
+  coll_mboxMap = chpl_mem_allocManyZero(chpl_numNodes,
+                                        sizeof(coll_mboxMap[0]),
+                                        CHPL_RT_MD_COMM_PER_LOC_INFO, 0, 0);
+  coll_mboxMap[chpl_nodeID] = coll_mbox;
+}
+
+
+void chpl_comm_coll_init_oob(chpl_comm_oob_allgather_t allgather) {
+  coll_alloc();
+
+  //
+  // Not every out-of-band allgather returns the results in node order,
+  // so each node says which one it is.
+  //
+  typedef struct {
+    c_nodeid_t node;
+    coll_slot_t* mbox;
+  } mbox_info_t;
+
+  mbox_info_t my_info = { chpl_nodeID, coll_mbox };
+  mbox_info_t* infos = chpl_mem_allocMany(chpl_numNodes, sizeof(infos[0]),
+                                          CHPL_RT_MD_COMM_PER_LOC_INFO, 0, 0);
+  (*allgather)(&my_info, infos, sizeof(infos[0]));
+  for (int i = 0; i < chpl_numNodes; i++) {
+    coll_mboxMap[infos[i].node] = infos[i].mbox;
+  }
+  chpl_mem_free(infos, 0, 0);
+}
+
+
+//
+// For comm layers that didn't exchange the mailbox addresses at startup,
+// do it on first use by gathering them on node 0.
+//
+static
+void coll_init(void) {
+  coll_alloc();
+
+  //
+  // Node 0's map is the one everyone fills in and then copies.
+  //
+  if (chpl_nodeID == 0) {
+    chpl_comm_coll_mboxMap_0 = coll_mboxMap;
+    chpl_comm_bcast_rt_private(chpl_comm_coll_mboxMap_0);
+  }
+  chpl_comm_barrier("collective mailbox map");
+  if (chpl_nodeID != 0) {
+    coll_slot_t** map0 = (coll_slot_t**) chpl_comm_coll_mboxMap_0;
+    chpl_comm_put(&coll_mbox, 0, &map0[chpl_nodeID], sizeof(coll_mbox),
+                  CHPL_COMM_UNKNOWN_ID, 0, -1);
+  }
+  chpl_comm_barrier("collective mailboxes");
+  if (chpl_nodeID != 0) {
+    chpl_comm_get(coll_mboxMap, 0, chpl_comm_coll_mboxMap_0,
+                  chpl_numNodes * sizeof(coll_mboxMap[0]),
+                  CHPL_COMM_UNKNOWN_ID, 0, -1);
+  }
+}
+
+
+static inline
+void coll_begin(void) {
+  if (coll_mbox == NULL) {
+    coll_init();
+  }
+  coll_seq++;
+}
+
+
+static
+void coll_send(c_nodeid_t node, int slot, const void* data, size_t size) {
+  coll_slot_t* rs = &coll_mboxMap[node][(coll_seq & 1) * coll_numSlots + slot];
+  if (size > 0) {
+    chpl_comm_put((void*) data, node, rs->data, size,
+                  CHPL_COMM_UNKNOWN_ID, 0, -1);
+    chpl_comm_put_fence();
+  }
+  chpl_comm_put(&coll_seq, node, (void*) &rs->seq, sizeof(coll_seq),
+                CHPL_COMM_UNKNOWN_ID, 0, -1);
+}
+
+
+static
+const void* coll_recv(int slot) {
+  coll_slot_t* s = &coll_mbox[(coll_seq & 1) * coll_numSlots + slot];
+  while (s->seq != coll_seq) {
+    chpl_task_yield();
+  }
+  chpl_atomic_thread_fence(memory_order_acquire);
+  return s->data;
+}
+
+
+static
+size_t coll_type_size(chpl_comm_coll_type_t type) {
+  switch (type) {
+  case CHPL_COMM_COLL_INT32:  return sizeof(int32_t);
+  case CHPL_COMM_COLL_INT64:  return sizeof(int64_t);
+  case CHPL_COMM_COLL_UINT32: return sizeof(uint32_t);
+  case CHPL_COMM_COLL_UINT64: return sizeof(uint64_t);
+  case CHPL_COMM_COLL_REAL32: return sizeof(float);
+  case CHPL_COMM_COLL_REAL64: return sizeof(double);
+  }
+  chpl_internal_error("unknown collective data type");
+  return 0;
+}
+
+
+#define COLL_COMBINE_ARITH(T)                                           \
+  do {                                                                  \
+    T* a = (T*) acc;                                                    \
+    const T* b = (const T*) in;                                         \
+    switch (op) {                                                       \
+    case CHPL_COMM_COLL_SUM:                                            \
+      for (size_t i = 0; i < count; i++) a[i] += b[i];                  \
+      return;                                                           \
+    case CHPL_COMM_COLL_MIN:                                            \
+      for (size_t i = 0; i < count; i++) if (b[i] < a[i]) a[i] = b[i];  \
+      return;                                                           \
+    case CHPL_COMM_COLL_MAX:                                            \
+      for (size_t i = 0; i < count; i++) if (b[i] > a[i]) a[i] = b[i];  \
+      return;                                                           \
+    default:                                                            \
+      break;                                                            \
+    }                                                                   \
+  } while (0)
+
+#define COLL_COMBINE_BITWISE(T)                                         \
+  do {                                                                  \
+    T* a = (T*) acc;                                                    \
+    const T* b = (const T*) in;                                         \
+    switch (op) {                                                       \
+    case CHPL_COMM_COLL_BAND:                                           \
+      for (size_t i = 0; i < count; i++) a[i] &= b[i];                  \
+      return;                                                           \
+    case CHPL_COMM_COLL_BOR:                                            \
+      for (size_t i = 0; i < count; i++) a[i] |= b[i];                  \
+      return;                                                           \
+    case CHPL_COMM_COLL_BXOR:                                           \
+      for (size_t i = 0; i < count; i++) a[i] ^= b[i];                  \
+      return;                                                           \
+    default:                                                            \
+      break;                                                            \
+    }                                                                   \
+  } while (0)
+
+static
+void coll_combine(void* acc, const void* in, size_t count,
+                  chpl_comm_coll_type_t type, chpl_comm_coll_op_t op) {
+  switch (type) {
+  case CHPL_COMM_COLL_INT32:
+    COLL_COMBINE_ARITH(int32_t);
+    COLL_COMBINE_BITWISE(int32_t);
+    break;
+  case CHPL_COMM_COLL_INT64:
+    COLL_COMBINE_ARITH(int64_t);
+    COLL_COMBINE_BITWISE(int64_t);
+    break;
+  case CHPL_COMM_COLL_UINT32:
+    COLL_COMBINE_ARITH(uint32_t);
+    COLL_COMBINE_BITWISE(uint32_t);
+    break;
+  case CHPL_COMM_COLL_UINT64:
+    COLL_COMBINE_ARITH(uint64_t);
+    COLL_COMBINE_BITWISE(uint64_t);
+    break;
+  case CHPL_COMM_COLL_REAL32:
+    COLL_COMBINE_ARITH(float);
+    break;
+  case CHPL_COMM_COLL_REAL64:
+    COLL_COMBINE_ARITH(double);
+    break;
+  }
+  chpl_internal_error("unsupported collective reduction op for data type");
+}
+
+#undef COLL_COMBINE_ARITH
+#undef COLL_COMBINE_BITWISE
+
+
+void chpl_comm_coll_bcast_generic(c_nodeid_t root, void* buf, size_t size) {
+  if (chpl_numNodes == 1) {
+    return;
+  }
+
+  //
+  // On step k, locales whose rank relative to the root is below 2^k
+  // already have the data and send it to rank+2^k.  Everyone else just
+  // sends the sequence number, which makes this a dissemination
+  // barrier as well.
+  //
+  const c_nodeid_t N = chpl_numNodes;
+  const c_nodeid_t rank = (chpl_nodeID - root + N) % N;
+  char* p = (char*) buf;
+
+  for (size_t off = 0; off < size; off += COLL_SLOT_SIZE) {
+    size_t n = (size - off < COLL_SLOT_SIZE) ? size - off : COLL_SLOT_SIZE;
+    coll_begin();
+    for (int k = 0; k < coll_numRounds; k++) {
+      c_nodeid_t d = (c_nodeid_t) 1 << k;
+      chpl_bool have = (rank < d && rank + d < N);
+      coll_send((chpl_nodeID + d) % N, k, p + off, have ? n : 0);
+      const void* in = coll_recv(k);
+      if (rank >= d && rank < 2 * d) {
+        memcpy(p + off, in, n);
+      }
+    }
+  }
+}
+
+
+void chpl_comm_coll_allreduce_generic(const void* src, void* dst,
+                                      size_t count,
+                                      chpl_comm_coll_type_t type,
+                                      chpl_comm_coll_op_t op) {
+  const size_t eltSize = coll_type_size(type);
+  if (src != dst) {
+    memmove(dst, src, count * eltSize);
+  }
+  if (chpl_numNodes == 1) {
+    return;
+  }
+
+  //
+  // Recursive doubling over the largest power of two number of locales.
+  // First, each of the first 2*rem locales with an even ID folds its
+  // data into the next one, and gets the result back from it at the
+  // end.  Partners always combine the same two values, so everyone ends
+  // up with the same bits even when the op isn't associative.
+  //
+  const c_nodeid_t N = chpl_numNodes;
+  c_nodeid_t P = 1;
+  int numSteps = 0;
+  while (2 * P <= N) {
+    P *= 2;
+    numSteps++;
+  }
+  const c_nodeid_t rem = N - P;
+  const int foldIn = coll_numRounds;
+  const int foldOut = coll_numRounds + 1;
+  const chpl_bool foldSender = (chpl_nodeID < 2 * rem
+                                && chpl_nodeID % 2 == 0);
+  const chpl_bool foldReceiver = (chpl_nodeID < 2 * rem
+                                  && chpl_nodeID % 2 == 1);
+  const c_nodeid_t newRank = (chpl_nodeID < 2 * rem)
+                             ? chpl_nodeID / 2
+                             : chpl_nodeID - rem;
+
+  const size_t perPiece = COLL_SLOT_SIZE / eltSize;
+  for (size_t off = 0; off < count; off += perPiece) {
+    size_t n = (count - off < perPiece) ? count - off : perPiece;
+    char* acc = (char*) dst + off * eltSize;
+    coll_begin();
+
+    if (foldSender) {
+      coll_send(chpl_nodeID + 1, foldIn, acc, n * eltSize);
+      memcpy(acc, coll_recv(foldOut), n * eltSize);
+      continue;
+    }
+
+    if (foldReceiver) {
+      coll_combine(acc, coll_recv(foldIn), n, type, op);
+    }
+
+    for (int k = 0; k < numSteps; k++) {
+      c_nodeid_t partnerRank = newRank ^ ((c_nodeid_t) 1 << k);
+      c_nodeid_t partner = (partnerRank < rem)
+                           ? partnerRank * 2 + 1
+                           : partnerRank + rem;
+      coll_send(partner, k, acc, n * eltSize);
+      coll_combine(acc, coll_recv(k), n, type, op);
+    }
+
+    if (foldReceiver) {
+      coll_send(chpl_nodeID - 1, foldOut, acc, n * eltSize);
+    }
+  }
+}
+
+
+void chpl_comm_coll_reduce_generic(c_nodeid_t root, const void* src,
+                                   void* dst, size_t count,
+                                   chpl_comm_coll_type_t type,
+                                   chpl_comm_coll_op_t op) {
+  //
+  // An allreduce takes the same number of steps as a tree reduction
+  // would, and keeps the every-locale-hears-from-every-other property
+  // the mailbox slots depend on.
+  //
+  if (chpl_nodeID == root) {
+    chpl_comm_coll_allreduce_generic(src, dst, count, type, op);
+  } else {
+    size_t size = count * coll_type_size(type);
+    void* tmp = chpl_mem_alloc(size, CHPL_RT_MD_COMM_UTIL, 0, 0);
+    chpl_comm_coll_allreduce_generic(src, tmp, count, type, op);
+    chpl_mem_free(tmp, 0, 0);
+  }
+}
+
+
+void chpl_comm_coll_allgather_generic(const void* src, void* dst,
+                                      size_t size) {
+  if (chpl_numNodes == 1) {
+    memmove(dst, src, size);
+    return;
+  }
+  if (size == 0) {
+    return;
+  }
+
+  //
+  // Bruck's algorithm.  We keep blocks in order starting with our own,
+  // and on step k send the first min(2^k, N-2^k) of them to the locale
+  // 2^k below us, appending the ones we get from the locale 2^k above.
+  // Messages are at most N/2 blocks, so big blocks are done in pieces.
+  //
+  const c_nodeid_t N = chpl_numNodes;
+  const size_t maxBlocks = N / 2;
+  size_t piece = COLL_SLOT_SIZE / maxBlocks;
+  if (piece == 0) {
+    chpl_internal_error("too many locales for chpl_comm_allgather()");
+  }
+  if (piece > size) {
+    piece = size;
+  }
+
+  char* tmp = chpl_mem_allocMany(N, piece, CHPL_RT_MD_COMM_UTIL, 0, 0);
+  for (size_t off = 0; off < size; off += piece) {
+    size_t n = (size - off < piece) ? size - off : piece;
+    coll_begin();
+    memcpy(tmp, (const char*) src + off, n);
+    for (int k = 0; k < coll_numRounds; k++) {
+      c_nodeid_t d = (c_nodeid_t) 1 << k;
+      c_nodeid_t cnt = (d < N - d) ? d : N - d;
+      coll_send((chpl_nodeID - d + N) % N, k, tmp, cnt * n);
+      memcpy(tmp + d * n, coll_recv(k), cnt * n);
+    }
+    for (c_nodeid_t j = 0; j < N; j++) {
+      memcpy((char*) dst + ((chpl_nodeID + j) % N) * size + off,
+             tmp + j * n, n);
+    }
+  }
+  chpl_mem_free(tmp, 0, 0);
+}
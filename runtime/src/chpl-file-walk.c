@@ -0,0 +1,588 @@
+/*
+ * Copyright 2020-2023 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _GNU_SOURCE
+// get statx
+#define _GNU_SOURCE
+#endif
+
+#ifndef CHPL_RT_UNIT_TEST
+#include "chplrt.h"
+#endif
+
+#include "chpl-file-walk.h"
+#include "qbuffer.h"
+#include "deque.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <fnmatch.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+/*
+   A parallel directory walk.
+
+   Listing a big tree on a parallel file system is bound by the latency
+   of each directory read and stat, not by the CPU, so we keep many
+   requests in flight by reading several directories at once. Each
+   worker has a deque of directories still to be read. A worker pushes
+   the subdirectories it finds onto the back of its own deque and takes
+   its next directory from there too, so it walks depth first through
+   what it has recently seen. A worker with nothing to do steals from
+   the front of another worker's deque, which holds the directories
+   found earliest and so usually the biggest subtrees.
+
+   The workers are pthreads rather than tasks because they spend their
+   time blocked in the kernel, which would tie up the tasking layer's
+   worker threads.
+
+   On Linux, directories are read with getdents64 into a large buffer,
+   so each system call returns many entries, and entries whose d_type
+   is unknown (or that are links we may follow) are looked up with
+   statx asking only for the file type, which lets a network file
+   system skip fetching the rest of the inode.
+*/
+
+#define WALK_DIRENT_BUF_SIZE (256*1024)
+#define WALK_MAX_WORKERS 256
+
+typedef struct walk_state_s walk_state_t;
+
+typedef struct walk_worker_s {
+  walk_state_t* state;
+  int id;
+  pthread_mutex_t lock; // protects dirs
+  deque_t dirs; // of char*, owned by the deque
+  // what this worker found
+  char** paths;
+  uint8_t* is_dir;
+  size_t num;
+  size_t cap;
+  char* buf;
+} walk_worker_t;
+
+struct walk_state_s {
+  const char* pattern;
+  int flags;
+  int nworkers;
+  walk_worker_t* workers;
+
+  pthread_mutex_t lock; // protects the rest
+  pthread_cond_t cond;
+  int64_t queued; // directories in some worker's deque
+  int64_t pending; // directories queued or being read
+  int idle; // workers waiting on cond
+  qioerr err;
+};
+
+static
+int walk_done(walk_state_t* s)
+{
+  return s->pending == 0 || s->err != 0;
+}
+
+static
+void walk_set_error(walk_state_t* s, qioerr err)
+{
+  pthread_mutex_lock(&s->lock);
+  if( !s->err ) s->err = err;
+  pthread_cond_broadcast(&s->cond);
+  pthread_mutex_unlock(&s->lock);
+}
+
+static
+char* walk_join(const char* dir, const char* name)
+{
+  size_t dirlen = strlen(dir);
+  size_t namelen = strlen(name);
+  int slash = dirlen > 0 && dir[dirlen-1] != '/';
+  char* ret = (char*) qio_malloc(dirlen + slash + namelen + 1);
+
+  if( !ret ) return NULL;
+  memcpy(ret, dir, dirlen);
+  if( slash ) ret[dirlen] = '/';
+  memcpy(ret + dirlen + slash, name, namelen + 1);
+  return ret;
+}
+
+// Adds a path to what this worker found, taking ownership of 'path'.
+static
+qioerr walk_report(walk_worker_t* w, char* path, int is_dir)
+{
+  if( w->num == w->cap ) {
+    size_t cap = w->cap ? 2*w->cap : 64;
+    char** paths = (char**) qio_realloc(w->paths, cap*sizeof(char*));
+    uint8_t* dirs;
+    if( !paths ) {
+      qio_free(path);
+      return QIO_ENOMEM;
+    }
+    w->paths = paths;
+    dirs = (uint8_t*) qio_realloc(w->is_dir, cap);
+    if( !dirs ) {
+      qio_free(path);
+      return QIO_ENOMEM;
+    }
+    w->is_dir = dirs;
+    w->cap = cap;
+  }
+  w->paths[w->num] = path;
+  w->is_dir[w->num] = is_dir;
+  w->num++;
+  return 0;
+}
+
+// Queues a directory to be read, taking ownership of 'path'.
+static
+qioerr walk_push(walk_worker_t* w, char* path)
+{
+  walk_state_t* s = w->state;
+  qioerr err;
+
+  pthread_mutex_lock(&w->lock);
+  err = deque_push_back(sizeof(char*), &w->dirs, &path);
+  pthread_mutex_unlock(&w->lock);
+  if( err ) {
+    qio_free(path);
+    return err;
+  }
+
+  pthread_mutex_lock(&s->lock);
+  s->queued++;
+  s->pending++;
+  if( s->idle > 0 ) pthread_cond_signal(&s->cond);
+  pthread_mutex_unlock(&s->lock);
+  return 0;
+}
+
+// Takes a directory from the back of our deque or the front of another's.
+static
+char* walk_pop(walk_worker_t* w)
+{
+  walk_state_t* s = w->state;
+  char* path = NULL;
+  int i;
+
+  for( i = 0; i < s->nworkers && path == NULL; i++ ) {
+    walk_worker_t* victim = &s->workers[(w->id + i) % s->nworkers];
+
+    pthread_mutex_lock(&victim->lock);
+    if( deque_size(sizeof(char*), &victim->dirs) > 0 ) {
+      if( victim == w ) {
+        deque_it_get_cur(sizeof(char*),
+                         deque_last(sizeof(char*), &victim->dirs), &path);
+        deque_pop_back(sizeof(char*), &victim->dirs);
+      } else {
+        deque_it_get_cur(sizeof(char*), deque_begin(&victim->dirs), &path);
+        deque_pop_front(sizeof(char*), &victim->dirs);
+      }
+    }
+    pthread_mutex_unlock(&victim->lock);
+  }
+
+  if( path ) {
+    pthread_mutex_lock(&s->lock);
+    s->queued--;
+    pthread_mutex_unlock(&s->lock);
+  }
+  return path;
+}
+
+// Sets *is_dir for an entry whose d_type didn't say. Returns an errno.
+static
+int walk_stat_is_dir(int dfd, const char* name, int follow, int* is_dir)
+{
+  int atflags = follow ? 0 : AT_SYMLINK_NOFOLLOW;
+#if defined(__linux__) && defined(STATX_TYPE)
+  struct statx stx;
+  if( statx(dfd, name, atflags | AT_STATX_DONT_SYNC, STATX_TYPE, &stx) == 0 ) {
+    *is_dir = S_ISDIR(stx.stx_mode);
+    return 0;
+  }
+  if( errno != ENOSYS ) return errno;
+#endif
+  {
+    struct stat st;
+    if( fstatat(dfd, name, &st, atflags) != 0 ) return errno;
+    *is_dir = S_ISDIR(st.st_mode);
+  }
+  return 0;
+}
+
+static
+qioerr walk_entry(walk_worker_t* w, const char* dir, int dfd,
+                  const char* name, unsigned char d_type)
+{
+  walk_state_t* s = w->state;
+  int follow = (s->flags & CHPL_FS_WALK_FOLLOW_LINKS) != 0;
+  int is_dir = 0;
+  int report;
+  char* path;
+  int rc;
+
+  if( name[0] == '.' ) {
+    if( name[1] == '\0' || (name[1] == '.' && name[2] == '\0') ) return 0;
+    if( !(s->flags & CHPL_FS_WALK_HIDDEN) ) return 0;
+  }
+
+  if( d_type == DT_DIR ) {
+    is_dir = 1;
+  } else if( d_type == DT_UNKNOWN || (d_type == DT_LNK && follow) ) {
+    rc = walk_stat_is_dir(dfd, name, follow, &is_dir);
+    if( rc == ENOENT ) {
+      // a dangling link is reported as a file
+      if( d_type == DT_LNK ) is_dir = 0;
+      // otherwise, the entry was removed since we read it
+      else return 0;
+    } else if( rc ) {
+      return qio_int_to_err(rc);
+    }
+  }
+
+  report = (s->flags & (is_dir ? CHPL_FS_WALK_DIRS : CHPL_FS_WALK_FILES)) &&
+           (s->pattern == NULL || fnmatch(s->pattern, name, 0) == 0);
+  if( !report && !is_dir ) return 0;
+
+  path = walk_join(dir, name);
+  if( !path ) return QIO_ENOMEM;
+
+  if( report ) {
+    if( is_dir ) {
+      char* copy = qio_strdup(path);
+      qioerr err;
+      if( !copy ) {
+        qio_free(path);
+        return QIO_ENOMEM;
+      }
+      err = walk_report(w, copy, 1);
+      if( err ) {
+        qio_free(path);
+        return err;
+      }
+    } else {
+      return walk_report(w, path, 0);
+    }
+  }
+
+  return walk_push(w, path);
+}
+
+#ifdef __linux__
+struct walk_dirent64 {
+  uint64_t d_ino;
+  int64_t d_off;
+  unsigned short d_reclen;
+  unsigned char d_type;
+  char d_name[];
+};
+#endif
+
+static
+qioerr walk_read_dir(walk_worker_t* w, const char* dir)
+{
+  qioerr err = 0;
+  int dfd;
+
+  dfd = open(dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if( dfd == -1 ) {
+    // removed since we found it
+    if( errno == ENOENT ) return 0;
+    return qio_mkerror_errno();
+  }
+
+#ifdef __linux__
+  while( !err ) {
+    long pos;
+    long n = syscall(SYS_getdents64, dfd, w->buf, WALK_DIRENT_BUF_SIZE);
+    if( n == 0 ) break;
+    if( n < 0 ) {
+      if( errno == EINTR ) continue;
+      err = qio_mkerror_errno();
+      break;
+    }
+    for( pos = 0; pos < n && !err; ) {
+      struct walk_dirent64* d = (struct walk_dirent64*) (w->buf + pos);
+      err = walk_entry(w, dir, dfd, d->d_name, d->d_type);
+      pos += d->d_reclen;
+    }
+  }
+  close(dfd);
+#else
+  {
+    DIR* d = fdopendir(dfd);
+    struct dirent* ent;
+    if( !d ) {
+      err = qio_mkerror_errno();
+      close(dfd);
+      return err;
+    }
+    errno = 0;
+    while( !err && (ent = readdir(d)) != NULL ) {
+      err = walk_entry(w, dir, dfd, ent->d_name, ent->d_type);
+      errno = 0;
+    }
+    if( !err && errno ) err = qio_mkerror_errno();
+    closedir(d);
+  }
+#endif
+
+  return err;
+}
+
+static
+void* walk_worker(void* arg)
+{
+  walk_worker_t* w = (walk_worker_t*) arg;
+  walk_state_t* s = w->state;
+
+  while( 1 ) {
+    char* dir = walk_pop(w);
+    qioerr err;
+    int done;
+
+    if( !dir ) {
+      // Wait for someone to queue more work, or for the walk to finish.
+      pthread_mutex_lock(&s->lock);
+      while( s->queued == 0 && !walk_done(s) ) {
+        s->idle++;
+        pthread_cond_wait(&s->cond, &s->lock);
+        s->idle--;
+      }
+      done = walk_done(s);
+      pthread_mutex_unlock(&s->lock);
+      if( done ) break;
+      continue;
+    }
+
+    pthread_mutex_lock(&s->lock);
+    done = s->err != 0;
+    pthread_mutex_unlock(&s->lock);
+
+    err = done ? 0 : walk_read_dir(w, dir);
+    qio_free(dir);
+    if( err ) walk_set_error(s, err);
+
+    pthread_mutex_lock(&s->lock);
+    s->pending--;
+    if( walk_done(s) ) pthread_cond_broadcast(&s->cond);
+    pthread_mutex_unlock(&s->lock);
+  }
+
+  return NULL;
+}
+
+typedef struct walk_result_s {
+  char* path;
+  uint8_t is_dir;
+} walk_result_t;
+
+static
+int walk_result_cmp(const void* a, const void* b)
+{
+  return strcmp(((const walk_result_t*) a)->path,
+                ((const walk_result_t*) b)->path);
+}
+
+// Moves what the workers found into 'ret'.
+static
+qioerr walk_collect(walk_state_t* s, chpl_fs_walk_t* ret)
+{
+  walk_result_t* results;
+  size_t num = 0;
+  size_t k = 0;
+  size_t i;
+  int j;
+
+  for( j = 0; j < s->nworkers; j++ ) num += s->workers[j].num;
+
+  results = (walk_result_t*) qio_malloc((num ? num : 1)*sizeof(walk_result_t));
+  ret->paths = (char**) qio_malloc((num ? num : 1)*sizeof(char*));
+  ret->is_dir = (uint8_t*) qio_malloc(num ? num : 1);
+  if( !results || !ret->paths || !ret->is_dir ) {
+    qio_free(results);
+    qio_free(ret->paths);
+    qio_free(ret->is_dir);
+    ret->paths = NULL;
+    ret->is_dir = NULL;
+    return QIO_ENOMEM;
+  }
+
+  for( j = 0; j < s->nworkers; j++ ) {
+    walk_worker_t* w = &s->workers[j];
+    for( i = 0; i < w->num; i++ ) {
+      results[k].path = w->paths[i];
+      results[k].is_dir = w->is_dir[i];
+      k++;
+    }
+    w->num = 0;
+  }
+
+  if( s->flags & CHPL_FS_WALK_SORT ) {
+    qsort(results, num, sizeof(walk_result_t), walk_result_cmp);
+  }
+
+  for( i = 0; i < num; i++ ) {
+    ret->paths[i] = results[i].path;
+    ret->is_dir[i] = results[i].is_dir;
+  }
+  ret->num = num;
+
+  qio_free(results);
+  return 0;
+}
+
+static
+void walk_worker_destroy(walk_worker_t* w)
+{
+  size_t i;
+
+  // anything left if we stopped early
+  while( deque_size(sizeof(char*), &w->dirs) > 0 ) {
+    char* path;
+    deque_it_get_cur(sizeof(char*), deque_begin(&w->dirs), &path);
+    deque_pop_front(sizeof(char*), &w->dirs);
+    qio_free(path);
+  }
+  deque_destroy(&w->dirs);
+  pthread_mutex_destroy(&w->lock);
+
+  for( i = 0; i < w->num; i++ ) qio_free(w->paths[i]);
+  qio_free(w->paths);
+  qio_free(w->is_dir);
+  qio_free(w->buf);
+}
+
+qioerr chpl_fs_walk(const char* root, const char* pattern, int flags,
+                    int nworkers, chpl_fs_walk_t* ret)
+{
+  walk_state_t s;
+  pthread_t* threads = NULL;
+  int nthreads = 0;
+  int ninited = 0;
+  qioerr err = 0;
+  struct stat st;
+  char* path;
+  int i;
+
+  ret->paths = NULL;
+  ret->is_dir = NULL;
+  ret->num = 0;
+
+  if( stat(root, &st) != 0 ) return qio_mkerror_errno();
+  if( !S_ISDIR(st.st_mode) ) {
+    QIO_RETURN_CONSTANT_ERROR(ENOTDIR, "walk root is not a directory");
+  }
+
+  if( nworkers <= 0 ) nworkers = (int) sysconf(_SC_NPROCESSORS_ONLN);
+  if( nworkers <= 0 ) nworkers = 1;
+  if( nworkers > WALK_MAX_WORKERS ) nworkers = WALK_MAX_WORKERS;
+
+  memset(&s, 0, sizeof(s));
+  s.pattern = pattern;
+  s.flags = flags;
+  s.nworkers = nworkers;
+  pthread_mutex_init(&s.lock, NULL);
+  pthread_cond_init(&s.cond, NULL);
+
+  s.workers = (walk_worker_t*) qio_calloc(nworkers, sizeof(walk_worker_t));
+  threads = (pthread_t*) qio_calloc(nworkers, sizeof(pthread_t));
+  if( !s.workers || !threads ) {
+    err = QIO_ENOMEM;
+    goto done;
+  }
+
+  for( i = 0; i < nworkers; i++ ) {
+    walk_worker_t* w = &s.workers[i];
+    w->state = &s;
+    w->id = i;
+    err = deque_init(sizeof(char*), &w->dirs, 0);
+    if( err ) goto done;
+    pthread_mutex_init(&w->lock, NULL);
+    ninited++;
+    w->buf = (char*) qio_malloc(WALK_DIRENT_BUF_SIZE);
+    if( !w->buf ) {
+      err = QIO_ENOMEM;
+      goto done;
+    }
+  }
+
+  if( flags & CHPL_FS_WALK_DIRS ) {
+    const char* slash = strrchr(root, '/');
+    const char* name = slash && slash[1] ? slash + 1 : root;
+    if( pattern == NULL || fnmatch(pattern, name, 0) == 0 ) {
+      path = qio_strdup(root);
+      if( !path ) {
+        err = QIO_ENOMEM;
+        goto done;
+      }
+      err = walk_report(&s.workers[0], path, 1);
+      if( err ) goto done;
+    }
+  }
+
+  path = qio_strdup(root);
+  if( !path ) {
+    err = QIO_ENOMEM;
+    goto done;
+  }
+  err = walk_push(&s.workers[0], path);
+  if( err ) goto done;
+
+  // This thread is worker 0.
+  for( i = 1; i < nworkers; i++ ) {
+    if( pthread_create(&threads[i], NULL, walk_worker, &s.workers[i]) != 0 ) {
+      break;
+    }
+    nthreads++;
+  }
+  walk_worker(&s.workers[0]);
+  for( i = 1; i <= nthreads; i++ ) pthread_join(threads[i], NULL);
+
+  err = s.err;
+  if( !err ) err = walk_collect(&s, ret);
+
+done:
+  for( i = 0; i < ninited; i++ ) walk_worker_destroy(&s.workers[i]);
+  qio_free(s.workers);
+  qio_free(threads);
+  pthread_cond_destroy(&s.cond);
+  pthread_mutex_destroy(&s.lock);
+  return err;
+}
+
+void chpl_fs_walk_free(chpl_fs_walk_t* w)
+{
+  size_t i;
+  for( i = 0; i < w->num; i++ ) qio_free(w->paths[i]);
+  qio_free(w->paths);
+  qio_free(w->is_dir);
+  w->paths = NULL;
+  w->is_dir = NULL;
+  w->num = 0;
+}
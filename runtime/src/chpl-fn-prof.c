@@ -0,0 +1,292 @@
+/*
+ * Copyright 2020-2023 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Sampling profiler for Chapel functions.  See chpl-fn-prof.h for how to
+// turn it on.
+//
+// Each locale's profile is a text file:
+//
+//   # chpl function profile v1
+//   # locale <nodeID> hz <hz> samples <n> untracked <n> truncated <n>
+//   <self>\t<total>\t<function>\t<file>:<line>
+//   ...
+//
+// with one line per function that was sampled at least once, most self
+// samples first.  "untracked" samples hit a thread that was not in any
+// instrumented function (runtime threads, library code called from the
+// top level); "truncated" ones saw a shadow stack deeper than
+// CHPL_FN_PROF_MAX_DEPTH, and only its outermost frames were charged.
+//
+
+#include "chplrt.h"
+
+#include "chpl-atomics.h"
+#include "chpl-comm.h"
+#include "chpl-env.h"
+#include "chpl-fn-prof.h"
+#include "chpl-linefile-support.h"
+#include "chpl-mem.h"
+#include "chplcgfns.h"
+#include "error.h"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/param.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+
+
+#ifdef CHPL_TLS
+CHPL_TLS chpl_fn_prof_stack_t chpl_fn_prof_stack;
+#endif
+
+static chpl_bool prof_enabled = false;
+static const char* prof_dir;
+static uint64_t prof_hz;
+static int32_t numFns;
+static atomic_uint_least64_t* selfSamples;
+static atomic_uint_least64_t* totalSamples;
+static atomic_uint_least64_t* lastSample;  // dedups recursive frames
+static atomic_uint_least64_t numSamples;
+static atomic_uint_least64_t numUntracked;
+static atomic_uint_least64_t numTruncated;
+static struct sigaction oldAct;
+
+static void on_sigprof(int);
+static void write_profile(void);
+
+
+void chpl_fn_prof_init(void) {
+  struct sigaction act;
+  struct itimerval timer;
+  uint64_t usecs;
+
+  prof_dir = chpl_env_rt_get("FUNCTION_PROFILE", NULL);
+  if (prof_dir == NULL || prof_dir[0] == '\0') {
+    return;
+  }
+
+#ifndef CHPL_TLS
+  chpl_warning("function profiling is not supported on this platform", 0, 0);
+  return;
+#else
+  numFns = chpl_sizeSymTable / 2;
+  if (numFns == 0) {
+    chpl_warning("CHPL_RT_FUNCTION_PROFILE is set, but the program was not "
+                 "compiled with --profile-functions", 0, 0);
+    return;
+  }
+
+  prof_hz = chpl_env_rt_get_uint("FUNCTION_PROFILE_HZ", 1000);
+  if (prof_hz == 0) {
+    prof_hz = 1000;
+  }
+  usecs = 1000000 / prof_hz;
+  if (usecs == 0) {
+    usecs = 1;
+  }
+
+  selfSamples = chpl_mem_allocMany(numFns, sizeof(selfSamples[0]),
+                                   CHPL_RT_MD_FN_PROF_DATA, 0, 0);
+  totalSamples = chpl_mem_allocMany(numFns, sizeof(totalSamples[0]),
+                                    CHPL_RT_MD_FN_PROF_DATA, 0, 0);
+  lastSample = chpl_mem_allocMany(numFns, sizeof(lastSample[0]),
+                                  CHPL_RT_MD_FN_PROF_DATA, 0, 0);
+  for (int32_t i = 0; i < numFns; i++) {
+    atomic_init_uint_least64_t(&selfSamples[i], 0);
+    atomic_init_uint_least64_t(&totalSamples[i], 0);
+    atomic_init_uint_least64_t(&lastSample[i], 0);
+  }
+  atomic_init_uint_least64_t(&numSamples, 0);
+  atomic_init_uint_least64_t(&numUntracked, 0);
+  atomic_init_uint_least64_t(&numTruncated, 0);
+
+  memset(&act, 0, sizeof(act));
+  act.sa_handler = on_sigprof;
+  act.sa_flags = SA_RESTART;
+  sigemptyset(&act.sa_mask);
+  if (sigaction(SIGPROF, &act, &oldAct) != 0) {
+    chpl_warning("cannot install the function profiling signal handler",
+                 0, 0);
+    return;
+  }
+
+  // ITIMER_PROF counts the CPU time of the whole process, and the kernel
+  // delivers the signal to a thread that was running when it expired, so
+  // busy worker threads are sampled in proportion to their CPU use.
+  timer.it_interval.tv_sec = usecs / 1000000;
+  timer.it_interval.tv_usec = usecs % 1000000;
+  timer.it_value = timer.it_interval;
+  prof_enabled = true;
+  if (setitimer(ITIMER_PROF, &timer, NULL) != 0) {
+    prof_enabled = false;
+    (void) sigaction(SIGPROF, &oldAct, NULL);
+    chpl_warning("cannot start the function profiling timer", 0, 0);
+  }
+#endif
+}
+
+
+void chpl_fn_prof_finalize(void) {
+  struct itimerval timer;
+
+  if (!prof_enabled) {
+    return;
+  }
+
+  memset(&timer, 0, sizeof(timer));
+  (void) setitimer(ITIMER_PROF, &timer, NULL);
+  (void) sigaction(SIGPROF, &oldAct, NULL);
+  prof_enabled = false;
+
+  write_profile();
+
+  chpl_mem_free(selfSamples, 0, 0);
+  chpl_mem_free(totalSamples, 0, 0);
+  chpl_mem_free(lastSample, 0, 0);
+}
+
+
+#ifdef CHPL_TLS
+static void on_sigprof(int sig) {
+  int savedErrno = errno;
+  int32_t depth = chpl_fn_prof_stack.depth;
+  uint64_t sample;
+
+  sample = atomic_fetch_add_uint_least64_t(&numSamples, 1) + 1;
+  if (depth <= 0) {
+    (void) atomic_fetch_add_uint_least64_t(&numUntracked, 1);
+    errno = savedErrno;
+    return;
+  }
+  if (depth > CHPL_FN_PROF_MAX_DEPTH) {
+    (void) atomic_fetch_add_uint_least64_t(&numTruncated, 1);
+    depth = CHPL_FN_PROF_MAX_DEPTH;
+  }
+
+  {
+    int32_t top = chpl_fn_prof_stack.fns[depth - 1];
+    if (top >= 0 && top < numFns) {
+      (void) atomic_fetch_add_uint_least64_t(&selfSamples[top], 1);
+    }
+  }
+
+  // A function that is on the stack more than once still gets only one
+  // sample: the first frame to claim it for this sample wins.
+  for (int32_t i = 0; i < depth; i++) {
+    int32_t fn = chpl_fn_prof_stack.fns[i];
+    if (fn >= 0 && fn < numFns &&
+        atomic_exchange_uint_least64_t(&lastSample[fn], sample) != sample) {
+      (void) atomic_fetch_add_uint_least64_t(&totalSamples[fn], 1);
+    }
+  }
+
+  errno = savedErrno;
+}
+#else
+static void on_sigprof(int sig) { }
+#endif
+
+
+typedef struct {
+  uint64_t self;
+  uint64_t total;
+  int32_t  fn;
+} prof_row_t;
+
+static int cmp_rows(const void* a, const void* b) {
+  const prof_row_t* x = (const prof_row_t*) a;
+  const prof_row_t* y = (const prof_row_t*) b;
+  if (x->self != y->self) {
+    return (x->self < y->self) ? 1 : -1;
+  }
+  if (x->total != y->total) {
+    return (x->total < y->total) ? 1 : -1;
+  }
+  return (x->fn > y->fn) - (x->fn < y->fn);
+}
+
+
+static void write_profile(void) {
+  char fname[MAXPATHLEN];
+  FILE* f;
+  prof_row_t* rows;
+  int32_t numRows = 0;
+
+  if (mkdir(prof_dir, 0777) != 0 && errno != EEXIST) {
+    char msg[MAXPATHLEN + 100];
+    snprintf(msg, sizeof(msg),
+             "cannot create function profile directory %s: %s",
+             prof_dir, strerror(errno));
+    chpl_warning(msg, 0, 0);
+    return;
+  }
+
+  snprintf(fname, sizeof(fname), "%s/fnprof-%d", prof_dir, (int) chpl_nodeID);
+  if ((f = fopen(fname, "w")) == NULL) {
+    char msg[MAXPATHLEN + 100];
+    snprintf(msg, sizeof(msg), "cannot open function profile file %s: %s",
+             fname, strerror(errno));
+    chpl_warning(msg, 0, 0);
+    return;
+  }
+
+  rows = chpl_mem_allocMany(numFns, sizeof(rows[0]),
+                            CHPL_RT_MD_FN_PROF_DATA, 0, 0);
+  for (int32_t i = 0; i < numFns; i++) {
+    uint64_t total = atomic_load_uint_least64_t(&totalSamples[i]);
+    if (total > 0) {
+      rows[numRows++] = (prof_row_t)
+                        { .self  = atomic_load_uint_least64_t(&selfSamples[i]),
+                          .total = total,
+                          .fn    = i,
+                        };
+    }
+  }
+  qsort(rows, numRows, sizeof(rows[0]), cmp_rows);
+
+  fprintf(f, "# chpl function profile v1\n");
+  fprintf(f, "# locale %d hz %" PRIu64 " samples %" PRIu64
+             " untracked %" PRIu64 " truncated %" PRIu64 "\n",
+          (int) chpl_nodeID, prof_hz,
+          atomic_load_uint_least64_t(&numSamples),
+          atomic_load_uint_least64_t(&numUntracked),
+          atomic_load_uint_least64_t(&numTruncated));
+  for (int32_t i = 0; i < numRows; i++) {
+    int32_t t = 2 * rows[i].fn;
+    fprintf(f, "%" PRIu64 "\t%" PRIu64 "\t%s\t%s:%d\n",
+            rows[i].self, rows[i].total, chpl_funSymTable[t + 1],
+            chpl_lookupFilename(chpl_filenumSymTable[t]),
+            chpl_filenumSymTable[t + 1]);
+  }
+  chpl_mem_free(rows, 0, 0);
+
+  if (fclose(f) != 0) {
+    char msg[MAXPATHLEN + 100];
+    snprintf(msg, sizeof(msg), "error writing function profile file %s",
+             fname);
+    chpl_warning(msg, 0, 0);
+  }
+}
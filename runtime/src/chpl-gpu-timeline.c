@@ -0,0 +1,434 @@
+/*
+ * Copyright 2020-2023 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// GPU kernel and copy timeline.  See chpl-gpu-timeline.h for how to turn
+// it on.
+//
+// Each recorded operation gets a pair of timing events around it on the
+// stream it is queued on, and the host time around the call that queues
+// it.  Nothing is read back until exit, so recording doesn't add any
+// synchronization.  Device times are put on the host clock through an
+// event recorded on each device at startup.
+//
+
+#ifdef HAS_GPU_LOCALE
+
+#include "chplrt.h"
+
+#include "chpl-atomics.h"
+#include "chpl-comm.h"
+#include "chpl-env.h"
+#include "chpl-gpu.h"
+#include "chpl-gpu-impl.h"
+#include "chpl-gpu-timeline.h"
+#include "chpl-linefile-support.h"
+#include "chpl-mem.h"
+#include "error.h"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/param.h>
+#include <sys/stat.h>
+#include <time.h>
+
+
+chpl_bool chpl_gpu_timeline_enabled = false;
+
+struct chpl_gpu_timeline_rec_s {
+  void*    ev_start;
+  void*    ev_end;
+  const char* name;
+  uint64_t host_start;           // ns
+  uint64_t host_end;
+  uint64_t dev_start;            // ns on the host clock, filled in at exit
+  uint64_t dev_dur;
+  int64_t  threads;
+  size_t   bytes;
+  chpl_gpu_timeline_kind_t kind;
+  int      dev;
+  int32_t  lineno;
+  int32_t  filename;
+};
+
+static const char* trace_dir;
+static chpl_gpu_timeline_rec_t* recs;
+static uint64_t maxRecs;
+static atomic_uint_least64_t numRecs;
+static atomic_uint_least64_t numDropped;
+
+static void** ref_events;        // per device
+static uint64_t* ref_host;
+
+static const char* kind_names[chpl_gpu_timeline_num_kinds] = {
+  "kernel",
+  "host to device",
+  "device to host",
+  "device to device",
+};
+
+static void resolve_device_times(uint64_t n);
+static void print_summary(uint64_t n);
+static void write_trace(uint64_t n);
+
+
+static inline uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000 + (uint64_t) ts.tv_nsec;
+}
+
+
+void chpl_gpu_timeline_init(void) {
+  if (!chpl_env_rt_get_bool("GPU_TIMELINE", false) ||
+      chpl_gpu_num_devices <= 0) {
+    return;
+  }
+
+  trace_dir = chpl_env_rt_get("GPU_TIMELINE_TRACE", NULL);
+  if (trace_dir != NULL && trace_dir[0] == '\0') {
+    trace_dir = NULL;
+  }
+  maxRecs = chpl_env_rt_get_uint("GPU_TIMELINE_MAX_RECORDS", 1 << 16);
+  if (maxRecs == 0) {
+    return;
+  }
+
+  recs = chpl_calloc(maxRecs, sizeof(recs[0]));
+  ref_events = chpl_calloc(chpl_gpu_num_devices, sizeof(ref_events[0]));
+  ref_host = chpl_calloc(chpl_gpu_num_devices, sizeof(ref_host[0]));
+  if (recs == NULL || ref_events == NULL || ref_host == NULL) {
+    chpl_warning("cannot allocate the GPU timeline", 0, 0);
+    chpl_free(recs);
+    chpl_free(ref_events);
+    chpl_free(ref_host);
+    return;
+  }
+  atomic_init_uint_least64_t(&numRecs, 0);
+  atomic_init_uint_least64_t(&numDropped, 0);
+
+  for (int dev = 0; dev < chpl_gpu_num_devices; dev++) {
+    chpl_gpu_impl_use_device(dev);
+    ref_events[dev] = chpl_gpu_impl_timing_event_create();
+    chpl_gpu_impl_event_record(ref_events[dev], NULL);
+    ref_host[dev] = now_ns();
+  }
+
+  chpl_gpu_timeline_enabled = true;
+}
+
+
+void chpl_gpu_timeline_exit(void) {
+  if (!chpl_gpu_timeline_enabled) {
+    return;
+  }
+  chpl_gpu_timeline_enabled = false;
+
+  uint64_t n = atomic_load_uint_least64_t(&numRecs);
+  if (n > maxRecs) {
+    n = maxRecs;
+  }
+
+  resolve_device_times(n);
+  print_summary(n);
+  if (trace_dir != NULL) {
+    write_trace(n);
+  }
+
+  for (int dev = 0; dev < chpl_gpu_num_devices; dev++) {
+    chpl_gpu_impl_use_device(dev);
+    chpl_gpu_impl_event_destroy(ref_events[dev]);
+  }
+  chpl_free(ref_host);
+  chpl_free(ref_events);
+  chpl_free(recs);
+}
+
+
+// The caller has made dev the current device.
+chpl_gpu_timeline_rec_t* chpl_gpu_timeline_start(chpl_gpu_timeline_kind_t kind,
+                                                 int dev, const char* name,
+                                                 int64_t threads, size_t bytes,
+                                                 void* stream,
+                                                 int ln, int32_t fn) {
+  if (dev < 0 || dev >= chpl_gpu_num_devices) {
+    return NULL;
+  }
+
+  uint64_t i = atomic_fetch_add_uint_least64_t(&numRecs, 1);
+  if (i >= maxRecs) {
+    (void) atomic_fetch_add_uint_least64_t(&numDropped, 1);
+    return NULL;
+  }
+
+  chpl_gpu_timeline_rec_t* rec = &recs[i];
+  rec->kind = kind;
+  rec->dev = dev;
+  rec->name = name;
+  rec->threads = threads;
+  rec->bytes = bytes;
+  rec->lineno = ln;
+  rec->filename = fn;
+  rec->ev_start = chpl_gpu_impl_timing_event_create();
+  chpl_gpu_impl_event_record(rec->ev_start, stream);
+  rec->host_start = now_ns();
+  return rec;
+}
+
+
+void chpl_gpu_timeline_stop(chpl_gpu_timeline_rec_t* rec, void* stream) {
+  rec->ev_end = chpl_gpu_impl_timing_event_create();
+  chpl_gpu_impl_event_record(rec->ev_end, stream);
+  rec->host_end = now_ns();
+}
+
+
+static void resolve_device_times(uint64_t n) {
+  for (int dev = 0; dev < chpl_gpu_num_devices; dev++) {
+    chpl_gpu_impl_use_device(dev);
+    chpl_gpu_impl_event_synchronize(ref_events[dev]);
+  }
+
+  for (uint64_t i = 0; i < n; i++) {
+    chpl_gpu_timeline_rec_t* r = &recs[i];
+    if (r->host_end < r->host_start) {
+      // never stopped
+      r->host_end = r->host_start;
+    }
+
+    float dur = -1.0f;
+    float off = -1.0f;
+    chpl_gpu_impl_use_device(r->dev);
+    if (r->ev_end != NULL) {
+      chpl_gpu_impl_event_synchronize(r->ev_end);
+      dur = chpl_gpu_impl_event_elapsed_ms(r->ev_start, r->ev_end);
+      off = chpl_gpu_impl_event_elapsed_ms(ref_events[r->dev], r->ev_start);
+    }
+    chpl_gpu_impl_event_destroy(r->ev_start);
+    chpl_gpu_impl_event_destroy(r->ev_end);
+    r->ev_start = r->ev_end = NULL;
+
+    if (dur >= 0.0f && off >= 0.0f) {
+      // the offset is a float in ms, so far from startup this is only
+      // good to a few tens of us; the duration is exact enough
+      r->dev_start = ref_host[r->dev] + (uint64_t) ((double) off * 1e6);
+      r->dev_dur = (uint64_t) ((double) dur * 1e6);
+    } else {
+      // no device timing (e.g. CPU-as-device): use the host call
+      r->dev_start = r->host_start;
+      r->dev_dur = r->host_end - r->host_start;
+    }
+  }
+}
+
+
+static int cmp_rec(const void* a, const void* b) {
+  const chpl_gpu_timeline_rec_t* x = *(chpl_gpu_timeline_rec_t* const*) a;
+  const chpl_gpu_timeline_rec_t* y = *(chpl_gpu_timeline_rec_t* const*) b;
+  if (x->kind != y->kind) {
+    return (x->kind > y->kind) - (x->kind < y->kind);
+  }
+  if (x->name == y->name) {
+    return 0;
+  }
+  if (x->name == NULL || y->name == NULL) {
+    return (x->name == NULL) ? -1 : 1;
+  }
+  return strcmp(x->name, y->name);
+}
+
+
+static double gb_per_s(uint64_t bytes, uint64_t ns) {
+  return (ns == 0) ? 0.0 : (double) bytes / (double) ns;
+}
+
+
+static void print_summary(uint64_t n) {
+  uint64_t dropped = atomic_load_uint_least64_t(&numDropped);
+  uint64_t kernelDevNs = 0, kernelHostNs = 0, copyDevNs = 0, copyBytes = 0;
+  uint64_t first = UINT64_MAX, last = 0;
+
+  chpl_gpu_timeline_rec_t** sorted = chpl_calloc(n + 1, sizeof(*sorted));
+  if (sorted == NULL) {
+    chpl_warning("cannot allocate the GPU timeline summary", 0, 0);
+    return;
+  }
+  for (uint64_t i = 0; i < n; i++) {
+    sorted[i] = &recs[i];
+  }
+  qsort(sorted, n, sizeof(*sorted), cmp_rec);
+
+  printf("GPU timeline for locale %d: %" PRIu64 " operations",
+         (int) chpl_nodeID, n);
+  if (dropped > 0) {
+    printf(" (%" PRIu64 " more not recorded)", dropped);
+  }
+  printf("\n");
+
+  chpl_gpu_timeline_kind_t prevKind = chpl_gpu_timeline_num_kinds;
+  for (uint64_t i = 0; i < n; ) {
+    chpl_gpu_timeline_rec_t* g = sorted[i];
+    uint64_t count = 0, devNs = 0, hostNs = 0, bytes = 0;
+    int64_t threads = 0;
+    for (; i < n && cmp_rec(&sorted[i], &g) == 0; i++) {
+      chpl_gpu_timeline_rec_t* r = sorted[i];
+      count++;
+      devNs += r->dev_dur;
+      hostNs += r->host_end - r->host_start;
+      bytes += r->bytes;
+      threads += r->threads;
+      if (r->host_start < first) first = r->host_start;
+      if (r->dev_start + r->dev_dur > last) last = r->dev_start + r->dev_dur;
+    }
+
+    if (g->kind == chpl_gpu_timeline_kernel) {
+      if (prevKind != g->kind) {
+        printf("  %-40s %8s %12s %10s %12s %12s\n", "kernel", "count",
+               "device ms", "avg us", "launch ms", "avg threads");
+      }
+      printf("  %-40s %8" PRIu64 " %12.3f %10.1f %12.3f %12" PRId64 "\n",
+             g->name, count, devNs / 1e6, devNs / 1e3 / count,
+             hostNs / 1e6, threads / (int64_t) count);
+      kernelDevNs += devNs;
+      kernelHostNs += hostNs;
+    } else {
+      if (prevKind == chpl_gpu_timeline_kernel ||
+          prevKind == chpl_gpu_timeline_num_kinds) {
+        printf("  %-40s %8s %12s %10s %12s %12s\n", "copy", "count",
+               "device ms", "avg us", "MB", "GB/s");
+      }
+      printf("  %-40s %8" PRIu64 " %12.3f %10.1f %12.3f %12.2f\n",
+             kind_names[g->kind], count, devNs / 1e6, devNs / 1e3 / count,
+             bytes / 1e6, gb_per_s(bytes, devNs));
+      copyDevNs += devNs;
+      copyBytes += bytes;
+    }
+    prevKind = g->kind;
+  }
+
+  if (n > 0) {
+    printf("  kernels: %.3f ms on devices, %.3f ms launching; "
+           "copies: %.3f ms on devices, %.2f GB/s; span: %.3f ms\n",
+           kernelDevNs / 1e6, kernelHostNs / 1e6, copyDevNs / 1e6,
+           gb_per_s(copyBytes, copyDevNs), (last - first) / 1e6);
+  }
+  fflush(stdout);
+
+  chpl_free(sorted);
+}
+
+
+static void write_json_string(FILE* f, const char* s) {
+  fputc('"', f);
+  for (; s != NULL && *s != '\0'; s++) {
+    unsigned char c = (unsigned char) *s;
+    if (c == '"' || c == '\\') {
+      fprintf(f, "\\%c", c);
+    } else if (c < 0x20) {
+      fprintf(f, "\\u%04x", c);
+    } else {
+      fputc(c, f);
+    }
+  }
+  fputc('"', f);
+}
+
+
+static void write_trace(uint64_t n) {
+  char fname[MAXPATHLEN];
+  FILE* f;
+  const int node = (int) chpl_nodeID;
+
+  if (mkdir(trace_dir, 0777) != 0 && errno != EEXIST) {
+    char msg[MAXPATHLEN + 100];
+    snprintf(msg, sizeof(msg), "cannot create GPU trace directory %s: %s",
+             trace_dir, strerror(errno));
+    chpl_warning(msg, 0, 0);
+    return;
+  }
+
+  snprintf(fname, sizeof(fname), "%s/gputrace-%d.json", trace_dir, node);
+  if ((f = fopen(fname, "w")) == NULL) {
+    char msg[MAXPATHLEN + 100];
+    snprintf(msg, sizeof(msg), "cannot open GPU trace file %s: %s",
+             fname, strerror(errno));
+    chpl_warning(msg, 0, 0);
+    return;
+  }
+
+  uint64_t epoch = UINT64_MAX;
+  for (int dev = 0; dev < chpl_gpu_num_devices; dev++) {
+    if (ref_host[dev] < epoch) epoch = ref_host[dev];
+  }
+
+  // Device work goes on one track per device, the host calls that queue
+  // it on another per device.
+  fprintf(f, "{\"traceEvents\":[\n");
+  fprintf(f, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,"
+             "\"args\":{\"name\":\"locale %d\"}}", node, node);
+  for (int dev = 0; dev < chpl_gpu_num_devices; dev++) {
+    fprintf(f, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,"
+               "\"tid\":%d,\"args\":{\"name\":\"gpu %d\"}}",
+            node, dev, dev);
+    fprintf(f, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,"
+               "\"tid\":%d,\"args\":{\"name\":\"host calls (gpu %d)\"}}",
+            node, 1000 + dev, dev);
+  }
+
+  for (uint64_t i = 0; i < n; i++) {
+    chpl_gpu_timeline_rec_t* r = &recs[i];
+    const bool isKernel = r->kind == chpl_gpu_timeline_kernel;
+    const char* name = isKernel ? r->name : kind_names[r->kind];
+    const char* file = chpl_lookupFilename(r->filename);
+
+    for (int onHost = 0; onHost < 2; onHost++) {
+      uint64_t start = onHost ? r->host_start : r->dev_start;
+      uint64_t dur = onHost ? r->host_end - r->host_start : r->dev_dur;
+      fprintf(f, ",\n{\"name\":");
+      write_json_string(f, name);
+      fprintf(f, ",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,"
+                 "\"ts\":%.3f,\"dur\":%.3f,\"args\":{",
+              isKernel ? (onHost ? "launch" : "kernel") : "copy",
+              node, onHost ? 1000 + r->dev : r->dev,
+              (start >= epoch ? start - epoch : 0) / 1e3, dur / 1e3);
+      if (isKernel) {
+        fprintf(f, "\"threads\":%" PRId64, r->threads);
+      } else {
+        fprintf(f, "\"bytes\":%zu,\"GB/s\":%.3f",
+                r->bytes, gb_per_s(r->bytes, r->dev_dur));
+      }
+      fprintf(f, ",\"file\":");
+      write_json_string(f, file);
+      fprintf(f, ",\"line\":%d}}", (int) r->lineno);
+    }
+  }
+  fprintf(f, "\n]}\n");
+
+  if (fclose(f) != 0) {
+    char msg[MAXPATHLEN + 100];
+    snprintf(msg, sizeof(msg), "error writing GPU trace file %s", fname);
+    chpl_warning(msg, 0, 0);
+  }
+}
+
+#endif // HAS_GPU_LOCALE
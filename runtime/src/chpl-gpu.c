@@ -27,6 +27,10 @@ int chpl_gpu_num_devices = -1;
 bool chpl_gpu_sync_with_host = true;
 bool chpl_gpu_use_stream_per_task = true;
 
+// Whether to prefetch and advise the driver about unified memory. This
+// does nothing when array data is on the device.
+static bool unified_memory_hints = true;
+
 #ifdef HAS_GPU_LOCALE
 
 // #define CHPL_GPU_ENABLE_PROFILE
@@ -35,6 +39,7 @@ bool chpl_gpu_use_stream_per_task = true;
 #include "chpl-gpu.h"
 #include "chpl-gpu-impl.h"
 #include "chpl-gpu-diags.h"
+#include "chpl-gpu-timeline.h"
 #include "chpl-tasks.h"
 #include "error.h"
 #include "chplcgfns.h"
@@ -42,10 +47,52 @@ bool chpl_gpu_use_stream_per_task = true;
 #include "chpl-env-gen.h"
 #include "chpl-env.h"
 #include "chpl-comm-compiler-macros.h"
+#include "chpl-comm-no-warning-macros.h" // No warnings for chpl_comm_get etc.
 
 #include "gpu/chpl-gpu-reduce-util.h"
 
 #include <inttypes.h>
+#include <string.h>
+
+// What array allocations that don't ask for a coherence policy get.
+#ifdef CHPL_LOCALE_MODEL_GPU_ARRAY_MEM_POLICY
+static chpl_gpu_mem_policy_t array_mem_policy =
+  CHPL_LOCALE_MODEL_GPU_ARRAY_MEM_POLICY;
+#else
+static chpl_gpu_mem_policy_t array_mem_policy = CHPL_GPU_MEM_POLICY_DEFAULT;
+#endif
+
+static void gpu_pool_init(void);
+static void block_size_cache_init(void);
+
+static const char* mem_policy_name(chpl_gpu_mem_policy_t policy) {
+  switch (policy) {
+  case CHPL_GPU_MEM_POLICY_COARSE: return "coarse";
+  case CHPL_GPU_MEM_POLICY_FINE:   return "fine";
+  default:                         return "default";
+  }
+}
+
+static void array_mem_policy_init(void) {
+  const char* env = chpl_env_rt_get("GPU_ARRAY_MEM_POLICY", NULL);
+  if (env == NULL) {
+    return;
+  }
+
+  if (strcmp(env, "default") == 0) {
+    array_mem_policy = CHPL_GPU_MEM_POLICY_DEFAULT;
+  } else if (strcmp(env, "coarse") == 0) {
+    array_mem_policy = CHPL_GPU_MEM_POLICY_COARSE;
+  } else if (strcmp(env, "fine") == 0) {
+    array_mem_policy = CHPL_GPU_MEM_POLICY_FINE;
+  } else {
+    char msg[200];
+    snprintf(msg, sizeof(msg),
+             "CHPL_RT_GPU_ARRAY_MEM_POLICY must be \"default\", "
+             "\"coarse\" or \"fine\", not \"%s\". Ignoring it.", env);
+    chpl_warning(msg, 0, 0);
+  }
+}
 
 void chpl_gpu_init(void) {
   chpl_gpu_impl_init(&chpl_gpu_num_devices);
@@ -84,6 +131,16 @@ void chpl_gpu_init(void) {
     }
 #endif
   }
+
+  unified_memory_hints = chpl_env_rt_get_bool("GPU_UNIFIED_MEMORY_HINTS",
+                                              true);
+  array_mem_policy_init();
+  CHPL_GPU_DEBUG("GPU array memory policy: %s\n",
+                 mem_policy_name(array_mem_policy));
+
+  gpu_pool_init();
+  block_size_cache_init();
+  chpl_gpu_timeline_init();
 }
 
 // With very limited and artificial benchmarking, we observed that yielding
@@ -115,12 +172,390 @@ static chpl_gpu_taskPrvData_t* get_gpu_task_private_data(void) {
   return NULL;
 }
 
+// Copies started with chpl_gpu_copy_async go on their own streams, this
+// many per device per task, so that they can overlap with the kernels on
+// the task's main stream.
+#define CHPL_GPU_NUM_COPY_STREAMS 2
+
+// Make work queued on stream after this wait for everything already on
+// the task's copy streams for dev.
+static void join_copy_streams(chpl_gpu_taskPrvData_t* prvData, int dev,
+                              void* stream) {
+  if (prvData == NULL || prvData->copy_streams == NULL) return;
+
+  for (int i = 0; i < CHPL_GPU_NUM_COPY_STREAMS; i++) {
+    void* cstream = prvData->copy_streams[dev*CHPL_GPU_NUM_COPY_STREAMS + i];
+    if (cstream != NULL) {
+      void* event = chpl_gpu_impl_event_create();
+      chpl_gpu_impl_event_record(event, cstream);
+      chpl_gpu_impl_stream_wait_event(stream, event);
+      chpl_gpu_impl_event_destroy(event);
+    }
+  }
+}
+
+// Wait for the task's copy streams and, if destroy is set, destroy them.
+static void wait_copy_streams(chpl_gpu_taskPrvData_t* prvData, bool destroy) {
+  if (prvData->copy_streams == NULL) return;
+
+  const int n = chpl_gpu_num_devices * CHPL_GPU_NUM_COPY_STREAMS;
+  for (int i = 0; i < n; i++) {
+    if (prvData->copy_streams[i] != NULL) {
+      wait_stream(prvData->copy_streams[i]);
+    }
+  }
+  if (destroy) {
+    for (int i = 0; i < n; i++) {
+      if (prvData->copy_streams[i] != NULL) {
+        CHPL_GPU_DEBUG("Destroying copy stream %p (subloc %d)\n",
+                       prvData->copy_streams[i],
+                       i / CHPL_GPU_NUM_COPY_STREAMS);
+        chpl_gpu_impl_stream_destroy(prvData->copy_streams[i]);
+        prvData->copy_streams[i] = NULL;
+      }
+    }
+  }
+}
+
+//
+// Device memory pool
+//
+// Freed allocations of up to CHPL_RT_GPU_MEM_POOL_SIZE bytes per device
+// are kept in size-classed free lists (four classes per power of 2) and
+// handed out again, instead of going back through the vendor allocator,
+// which is slow and whose free synchronizes the device.  Each device's
+// pool has its own lock and a table from device pointer to block.
+//
+// A block freed by a task that has its own stream may still be in use
+// by work queued on that stream.  It goes on the task's pending list,
+// and only moves to the shared pool once the stream is seen to be idle:
+// at the task's next allocation if the stream is ready by then, or at
+// the next fence or the end of the task.
+//
+
+typedef enum {
+  POOL_KIND_MEM,                // chpl_gpu_impl_mem_alloc
+  POOL_KIND_ARRAY,              // chpl_gpu_impl_mem_array_alloc, by
+  POOL_KIND_ARRAY_COARSE,       //   chpl_gpu_mem_policy_t, so blocks are
+  POOL_KIND_ARRAY_FINE,         //   only reused with the same coherence
+  POOL_NUM_KINDS
+} pool_kind_t;
+
+#define POOL_MIN_LOG2 8
+#define POOL_NUM_CLASSES (1 + (64 - POOL_MIN_LOG2) * 4)
+
+struct chpl_gpu_pool_block_s {
+  struct chpl_gpu_pool_block_s* next;   // free list or pending list
+  struct chpl_gpu_pool_block_s* hnext;  // pointer table chain
+  void* ptr;
+  void* stream;                         // while pending
+  size_t size;                          // class size
+  int dev;
+  pool_kind_t kind;
+  int cls;
+};
+typedef struct chpl_gpu_pool_block_s pool_block_t;
+
+typedef struct {
+  atomic_spinlock_t lock;
+  pool_block_t* free[POOL_NUM_KINDS][POOL_NUM_CLASSES];
+  pool_block_t** table;                 // every block, by ptr
+  size_t table_size;                    // always a power of 2
+  size_t num_blocks;
+  size_t cached_bytes;
+} gpu_pool_t;
+
+static gpu_pool_t* gpu_pools = NULL;
+static size_t gpu_pool_max_bytes = 0;   // 0 => no pooling
+
+// Give memory back to the vendor layer.  The comm layer may have it
+// registered for RMA, see comm_can_use_directly().
+static void device_free(void* ptr, size_t size) {
+  chpl_comm_regMemDeviceFree(ptr, size);
+  chpl_gpu_impl_mem_free(ptr);
+}
+
+
+static void gpu_pool_init(void) {
+#ifdef GPU_RUNTIME_CPU
+  // chpl_gpu_mem_realloc() reallocates these directly
+  gpu_pool_max_bytes = 0;
+#else
+  gpu_pool_max_bytes = chpl_env_rt_get_size("GPU_MEM_POOL_SIZE",
+                                            (size_t) 512 << 20);
+#endif
+  if (gpu_pool_max_bytes == 0 || chpl_gpu_num_devices <= 0) {
+    gpu_pool_max_bytes = 0;
+    return;
+  }
+
+  gpu_pools = chpl_calloc(chpl_gpu_num_devices, sizeof(gpu_pools[0]));
+  if (gpu_pools == NULL) {
+    gpu_pool_max_bytes = 0;
+    return;
+  }
+  for (int i = 0; i < chpl_gpu_num_devices; i++) {
+    atomic_init_spinlock_t(&gpu_pools[i].lock);
+  }
+}
+
+static inline int pool_class(size_t size, size_t* cls_size) {
+  if (size <= ((size_t) 1 << POOL_MIN_LOG2)) {
+    *cls_size = (size_t) 1 << POOL_MIN_LOG2;
+    return 0;
+  }
+  int e = 63 - __builtin_clzll((unsigned long long) (size - 1));
+  size_t base = (size_t) 1 << e;
+  size_t quarter = base / 4;
+  size_t k = (size - 1 - base) / quarter;
+  *cls_size = base + (k + 1) * quarter;
+  return 1 + (e - POOL_MIN_LOG2) * 4 + (int) k;
+}
+
+static inline size_t pool_hash(gpu_pool_t* p, void* ptr) {
+  uint64_t h = (uint64_t) (uintptr_t) ptr * UINT64_C(0x9e3779b97f4a7c15);
+  return (size_t) (h >> 32) & (p->table_size - 1);
+}
+
+// The pool lock is held for these.
+static bool pool_table_add(gpu_pool_t* p, pool_block_t* b) {
+  if (p->num_blocks + 1 > p->table_size) {
+    size_t newSize = (p->table_size == 0) ? 256 : 2 * p->table_size;
+    pool_block_t** newTable = chpl_calloc(newSize, sizeof(newTable[0]));
+    if (newTable == NULL) {
+      return false;
+    }
+    pool_block_t** oldTable = p->table;
+    size_t oldSize = p->table_size;
+    p->table = newTable;
+    p->table_size = newSize;
+    for (size_t i = 0; i < oldSize; i++) {
+      pool_block_t* e = oldTable[i];
+      while (e != NULL) {
+        pool_block_t* next = e->hnext;
+        size_t h = pool_hash(p, e->ptr);
+        e->hnext = newTable[h];
+        newTable[h] = e;
+        e = next;
+      }
+    }
+    chpl_free(oldTable);
+  }
+
+  size_t h = pool_hash(p, b->ptr);
+  b->hnext = p->table[h];
+  p->table[h] = b;
+  p->num_blocks++;
+  return true;
+}
+
+static pool_block_t* pool_table_find(gpu_pool_t* p, void* ptr,
+                                     bool remove) {
+  if (p->table_size == 0) {
+    return NULL;
+  }
+  pool_block_t** link = &p->table[pool_hash(p, ptr)];
+  while (*link != NULL && (*link)->ptr != ptr) {
+    link = &(*link)->hnext;
+  }
+  pool_block_t* b = *link;
+  if (b != NULL && remove) {
+    *link = b->hnext;
+    p->num_blocks--;
+  }
+  return b;
+}
+
+// Put a block whose last user is done back on its pool's free list,
+// or back to the device if the pool is full.
+static void pool_release(pool_block_t* b) {
+  gpu_pool_t* p = &gpu_pools[b->dev];
+  bool keep;
+
+  atomic_lock_spinlock_t(&p->lock);
+  keep = (p->cached_bytes + b->size <= gpu_pool_max_bytes);
+  if (keep) {
+    b->stream = NULL;
+    b->next = p->free[b->kind][b->cls];
+    p->free[b->kind][b->cls] = b;
+    p->cached_bytes += b->size;
+  } else {
+    (void) pool_table_find(p, b->ptr, true);
+  }
+  atomic_unlock_spinlock_t(&p->lock);
+
+  if (!keep) {
+    chpl_gpu_impl_use_device(b->dev);
+    device_free(b->ptr, b->size);
+    chpl_free(b);
+    chpl_gpu_diags_incr(mem_pool_release);
+  }
+}
+
+// Release the task's pending blocks whose streams are idle.  If wait is
+// true, the caller has just synchronized all of the task's streams.
+static void pool_release_pending(chpl_gpu_taskPrvData_t* prvData,
+                                 bool wait) {
+  pool_block_t** link = &prvData->pool_pending;
+  void* readyStream = NULL;
+  void* busyStream = NULL;
+
+  while (*link != NULL) {
+    pool_block_t* b = *link;
+    bool ready = wait || b->stream == readyStream;
+    if (!ready && b->stream != busyStream) {
+      if (chpl_gpu_impl_stream_ready(b->stream)) {
+        readyStream = b->stream;
+        ready = true;
+      } else {
+        busyStream = b->stream;
+      }
+    }
+    if (ready) {
+      *link = b->next;
+      pool_release(b);
+    } else {
+      link = &b->next;
+    }
+  }
+}
+
+static inline pool_kind_t array_pool_kind(chpl_gpu_mem_policy_t policy) {
+  switch (policy) {
+  case CHPL_GPU_MEM_POLICY_COARSE: return POOL_KIND_ARRAY_COARSE;
+  case CHPL_GPU_MEM_POLICY_FINE:   return POOL_KIND_ARRAY_FINE;
+  default:                         return POOL_KIND_ARRAY;
+  }
+}
+
+static void* vendor_alloc(int dev, pool_kind_t kind, size_t size) {
+  chpl_gpu_mem_policy_t policy;
+  switch (kind) {
+  case POOL_KIND_ARRAY:        policy = CHPL_GPU_MEM_POLICY_DEFAULT; break;
+  case POOL_KIND_ARRAY_COARSE: policy = CHPL_GPU_MEM_POLICY_COARSE;  break;
+  case POOL_KIND_ARRAY_FINE:   policy = CHPL_GPU_MEM_POLICY_FINE;    break;
+  default:
+    return chpl_gpu_impl_mem_alloc(size);
+  }
+
+  void* ptr = chpl_gpu_impl_mem_array_alloc(size, policy);
+  if (ptr != NULL && policy == CHPL_GPU_MEM_POLICY_COARSE) {
+    chpl_gpu_diags_incr(mem_alloc_coarse);
+  } else if (ptr != NULL && policy == CHPL_GPU_MEM_POLICY_FINE) {
+    chpl_gpu_diags_incr(mem_alloc_fine);
+  }
+#ifndef CHPL_GPU_MEM_STRATEGY_ARRAY_ON_DEVICE
+  // Array data allocated on a GPU sublocale is mostly used by kernels on
+  // that GPU, so its pages should stay there rather than follow faults
+  // back and forth. Pooled blocks keep this when they are reused. Data
+  // asked to be fine-grained is shared with the host, so it isn't pinned.
+  if (unified_memory_hints && ptr != NULL && dev >= 0 &&
+      policy != CHPL_GPU_MEM_POLICY_FINE &&
+      chpl_gpu_impl_mem_advise_preferred_location(ptr, dev)) {
+    chpl_gpu_diags_incr(mem_advise);
+  }
+#endif
+  return ptr;
+}
+
+static void* pool_alloc(int dev, pool_kind_t kind, size_t size) {
+  if (gpu_pool_max_bytes == 0 || dev < 0 || size > gpu_pool_max_bytes) {
+    return vendor_alloc(dev, kind, size);
+  }
+
+  chpl_gpu_taskPrvData_t* prvData = get_gpu_task_private_data();
+  if (prvData != NULL && prvData->pool_pending != NULL) {
+    pool_release_pending(prvData, false);
+  }
+
+  gpu_pool_t* p = &gpu_pools[dev];
+  size_t clsSize;
+  int cls = pool_class(size, &clsSize);
+  pool_block_t* b;
+
+  atomic_lock_spinlock_t(&p->lock);
+  if ((b = p->free[kind][cls]) != NULL) {
+    p->free[kind][cls] = b->next;
+    p->cached_bytes -= b->size;
+  }
+  atomic_unlock_spinlock_t(&p->lock);
+
+  if (b != NULL) {
+    chpl_gpu_diags_incr(mem_pool_hit);
+    return b->ptr;
+  }
+
+  chpl_gpu_diags_incr(mem_pool_miss);
+  void* ptr = vendor_alloc(dev, kind, clsSize);
+  if (ptr == NULL) {
+    return NULL;
+  }
+
+  if ((b = chpl_calloc(1, sizeof(*b))) != NULL) {
+    b->ptr = ptr;
+    b->size = clsSize;
+    b->dev = dev;
+    b->kind = kind;
+    b->cls = cls;
+    atomic_lock_spinlock_t(&p->lock);
+    if (!pool_table_add(p, b)) {
+      chpl_free(b);
+    }
+    atomic_unlock_spinlock_t(&p->lock);
+  }
+  // Without a block to track it, this is freed like an unpooled one.
+  return ptr;
+}
+
+static void pool_free(void* ptr) {
+  pool_block_t* b = NULL;
+
+  if (gpu_pool_max_bytes > 0) {
+    // Try the device we're on first; the pointer is usually from there.
+    int dev = chpl_task_getRequestedSubloc();
+    for (int i = -1; b == NULL && i < chpl_gpu_num_devices; i++) {
+      int d = (i < 0) ? dev : i;
+      if (d < 0 || d >= chpl_gpu_num_devices || (i >= 0 && d == dev)) {
+        continue;
+      }
+      atomic_lock_spinlock_t(&gpu_pools[d].lock);
+      b = pool_table_find(&gpu_pools[d], ptr, false);
+      atomic_unlock_spinlock_t(&gpu_pools[d].lock);
+    }
+  }
+
+  if (b == NULL) {
+    device_free(ptr, chpl_gpu_impl_get_alloc_size(ptr));
+    return;
+  }
+
+  chpl_gpu_taskPrvData_t* prvData = get_gpu_task_private_data();
+  void* stream = (prvData != NULL && prvData->streams != NULL)
+                 ? prvData->streams[b->dev] : NULL;
+  if (stream != NULL) {
+    // async copies to or from the block are on other streams
+    join_copy_streams(prvData, b->dev, stream);
+    b->stream = stream;
+    b->next = prvData->pool_pending;
+    prvData->pool_pending = b;
+  } else {
+    // Without streams per task everything is on the default stream.
+    // Unless we sync on every operation, work using the block may
+    // still be queued there.
+    if (prvData == NULL && !chpl_gpu_sync_with_host) {
+      chpl_gpu_impl_stream_synchronize(NULL);
+    }
+    pool_release(b);
+  }
+}
+
 void chpl_gpu_task_end(void) {
   if (!has_stream_per_task()) return;
 
   chpl_gpu_taskPrvData_t* prvData = get_gpu_task_private_data();
   assert(prvData);
 
+  wait_copy_streams(prvData, /*destroy=*/true);
   if (prvData->streams != NULL) {
     int i;
     for (i=0 ; i<chpl_gpu_num_devices ; i++) {
@@ -128,6 +563,14 @@ void chpl_gpu_task_end(void) {
         CHPL_GPU_DEBUG("Destroying stream %p (subloc %d)\n",
                        prvData->streams[i], i);
         wait_stream(prvData->streams[i]);
+      }
+    }
+    // The streams are idle, so blocks freed on them can be reused.
+    if (prvData->pool_pending != NULL) {
+      pool_release_pending(prvData, true);
+    }
+    for (i=0 ; i<chpl_gpu_num_devices ; i++) {
+      if (prvData->streams[i] != NULL) {
         chpl_gpu_impl_stream_destroy(prvData->streams[i]);
         prvData->streams[i] = NULL;
       }
@@ -147,6 +590,7 @@ void chpl_gpu_task_fence(void) {
   chpl_gpu_taskPrvData_t* prvData = get_gpu_task_private_data();
   assert(prvData);
 
+  wait_copy_streams(prvData, /*destroy=*/false);
   if (prvData->streams != NULL) {
     int i;
     for (i=0 ; i<chpl_gpu_num_devices ; i++) {
@@ -155,6 +599,9 @@ void chpl_gpu_task_fence(void) {
         wait_stream(prvData->streams[i]);
       }
     }
+    if (prvData->pool_pending != NULL) {
+      pool_release_pending(prvData, true);
+    }
   }
 }
 
@@ -189,6 +636,31 @@ static void* get_stream(int dev) {
   return *stream;
 }
 
+// The copy streams are used round robin, so that a copy into one buffer
+// of a double-buffered loop doesn't queue up behind the previous one.
+static void* get_copy_stream(int dev) {
+  if (!has_stream_per_task()) return NULL;
+
+  chpl_gpu_taskPrvData_t* prvData = get_gpu_task_private_data();
+  assert(prvData);
+
+  if (prvData->copy_streams == NULL) {
+    prvData->copy_streams = chpl_mem_calloc(chpl_gpu_num_devices *
+                                            CHPL_GPU_NUM_COPY_STREAMS,
+                                            sizeof(void*),
+                                            CHPL_RT_MD_GPU_UTIL, 0, 0);
+  }
+  const int i = prvData->copy_next;
+  prvData->copy_next = (i + 1) % CHPL_GPU_NUM_COPY_STREAMS;
+
+  void** stream = &(prvData->copy_streams[dev*CHPL_GPU_NUM_COPY_STREAMS + i]);
+  if (*stream == NULL) {
+    *stream = chpl_gpu_impl_stream_create();
+    CHPL_GPU_DEBUG("Copy stream created: %p (subloc %d)\n", *stream, dev);
+  }
+  return *stream;
+}
+
 void chpl_gpu_support_module_finished_initializing(void) {
   // we can't use `CHPL_GPU_DEBUG` before the support module is finished
   // initializing. This call back is used to signal the runtime that that module
@@ -210,6 +682,130 @@ void chpl_gpu_support_module_finished_initializing(void) {
                  chpl_gpu_sync_with_host ? "enabled" : "disabled");
 }
 
+//
+// Block sizes for kernels that are launched without one (the compiler passes
+// 0 when neither the loop nor --gpu-block-size sets it). The first launch of
+// a kernel on a device asks the vendor layer for the block size that gives
+// the kernel its highest occupancy, which takes the registers and shared
+// memory the kernel uses into account. Later launches reuse it.
+//
+
+#define CHPL_GPU_DEFAULT_BLOCK_SIZE 512
+#define BLOCK_SIZE_TABLE_SIZE 256   // a power of 2
+
+typedef struct chpl_gpu_block_size_entry_s {
+  struct chpl_gpu_block_size_entry_s* next;
+  const char* name;
+  int blk_dim;
+} block_size_entry_t;
+
+typedef struct {
+  atomic_spinlock_t lock;
+  block_size_entry_t* table[BLOCK_SIZE_TABLE_SIZE];
+} block_size_cache_t;
+
+static block_size_cache_t* block_size_caches = NULL;
+
+static void block_size_cache_init(void) {
+  if (chpl_gpu_num_devices <= 0) {
+    return;
+  }
+
+  block_size_caches = chpl_calloc(chpl_gpu_num_devices,
+                                  sizeof(block_size_caches[0]));
+  if (block_size_caches == NULL) {
+    return;
+  }
+  for (int i = 0; i < chpl_gpu_num_devices; i++) {
+    atomic_init_spinlock_t(&block_size_caches[i].lock);
+  }
+}
+
+static inline size_t block_size_hash(const char* name) {
+  uint64_t h = UINT64_C(0xcbf29ce484222325);
+  for (const char* c = name; *c != '\0'; c++) {
+    h = (h ^ (unsigned char) *c) * UINT64_C(0x100000001b3);
+  }
+  return (size_t) h & (BLOCK_SIZE_TABLE_SIZE - 1);
+}
+
+// The cache lock is held for this.
+static block_size_entry_t* block_size_find(block_size_cache_t* c,
+                                           const char* name, size_t h) {
+  for (block_size_entry_t* e = c->table[h]; e != NULL; e = e->next) {
+    if (e->name == name || strcmp(e->name, name) == 0) {
+      return e;
+    }
+  }
+  return NULL;
+}
+
+static int get_auto_block_size(int dev, const char* name) {
+  if (block_size_caches == NULL || dev < 0 || dev >= chpl_gpu_num_devices) {
+    return CHPL_GPU_DEFAULT_BLOCK_SIZE;
+  }
+
+  block_size_cache_t* c = &block_size_caches[dev];
+  size_t h = block_size_hash(name);
+
+  atomic_lock_spinlock_t(&c->lock);
+  block_size_entry_t* e = block_size_find(c, name, h);
+  atomic_unlock_spinlock_t(&c->lock);
+  if (e != NULL) {
+    return e->blk_dim;
+  }
+
+  // Don't hold the lock across the query; a racing task computes the same
+  // value, and only the first one is kept.
+  int blk_dim = chpl_gpu_impl_max_potential_block_size(name);
+  if (blk_dim <= 0) {
+    blk_dim = CHPL_GPU_DEFAULT_BLOCK_SIZE;
+  }
+  CHPL_GPU_DEBUG("Picked block size %d for kernel %s (subloc %d)\n",
+                 blk_dim, name, dev);
+
+  block_size_entry_t* newEntry = chpl_malloc(sizeof(*newEntry));
+  if (newEntry == NULL) {
+    return blk_dim;
+  }
+  newEntry->name = name;
+  newEntry->blk_dim = blk_dim;
+
+  atomic_lock_spinlock_t(&c->lock);
+  e = block_size_find(c, name, h);
+  if (e == NULL) {
+    newEntry->next = c->table[h];
+    c->table[h] = newEntry;
+  }
+  atomic_unlock_spinlock_t(&c->lock);
+
+  if (e != NULL) {
+    chpl_free(newEntry);
+    return e->blk_dim;
+  }
+  return blk_dim;
+}
+
+// The compiler calls this before a kernel launch for each pointer it passes
+// to the kernel. With unified memory, moving the data to the device ahead
+// of the kernel, on the stream it will run on, is much faster than
+// migrating it one page fault at a time once the kernel touches it.
+void chpl_gpu_prefetch_kernel_arg(const void* ptr) {
+#ifndef CHPL_GPU_MEM_STRATEGY_ARRAY_ON_DEVICE
+  int dev = chpl_task_getRequestedSubloc();
+  if (!unified_memory_hints || ptr == NULL || dev < 0) {
+    return;
+  }
+
+  chpl_gpu_impl_use_device(dev);
+  if (chpl_gpu_impl_mem_prefetch((void*)ptr, dev, get_stream(dev))) {
+    CHPL_GPU_DEBUG("Prefetched the allocation holding %p (subloc %d)\n",
+                   ptr, dev);
+    chpl_gpu_diags_incr(mem_prefetch);
+  }
+#endif
+}
+
 inline void chpl_gpu_launch_kernel(int ln, int32_t fn,
                                    const char* name,
                                    int grd_dim_x, int grd_dim_y, int grd_dim_z,
@@ -235,25 +831,35 @@ inline void chpl_gpu_launch_kernel(int ln, int32_t fn,
 
   chpl_gpu_impl_use_device(chpl_task_getRequestedSubloc());
 
-  chpl_gpu_diags_verbose_launch(ln, fn, chpl_task_getRequestedSubloc(),
-                                blk_dim_x, blk_dim_y, blk_dim_z);
-  chpl_gpu_diags_incr(kernel_launch);
+  if (grd_dim_x > 0 && grd_dim_y > 0 && grd_dim_z > 0) {
+    chpl_gpu_diags_verbose_launch(ln, fn, chpl_task_getRequestedSubloc(),
+                                  blk_dim_x, blk_dim_y, blk_dim_z);
+    chpl_gpu_diags_incr(kernel_launch);
 
-  chpl_gpu_impl_launch_kernel(ln, fn,
-                              name,
-                              grd_dim_x, grd_dim_y, grd_dim_z,
-                              blk_dim_x, blk_dim_y, blk_dim_z,
-                              stream,
-                              nargs, args);
+    chpl_gpu_timeline_rec_t* rec =
+      chpl_gpu_timeline_begin(chpl_gpu_timeline_kernel, dev, name,
+                              (int64_t) grd_dim_x * grd_dim_y * grd_dim_z *
+                              blk_dim_x * blk_dim_y * blk_dim_z,
+                              0, stream, ln, fn);
+    chpl_gpu_impl_launch_kernel(ln, fn,
+                                name,
+                                grd_dim_x, grd_dim_y, grd_dim_z,
+                                blk_dim_x, blk_dim_y, blk_dim_z,
+                                stream,
+                                nargs, args);
+    chpl_gpu_timeline_end(rec, stream);
 
 #ifdef CHPL_GPU_MEM_STRATEGY_ARRAY_ON_DEVICE
-  if (chpl_gpu_sync_with_host) {
-    CHPL_GPU_DEBUG("Eagerly synchronizing stream %p\n", stream);
-    wait_stream(stream);
-  }
+    if (chpl_gpu_sync_with_host) {
+      CHPL_GPU_DEBUG("Eagerly synchronizing stream %p\n", stream);
+      wait_stream(stream);
+    }
 #else
-  chpl_gpu_impl_synchronize();
+    chpl_gpu_impl_synchronize();
 #endif
+  } else {
+    CHPL_GPU_DEBUG("No kernel launched since the grid is empty\n");
+  }
 
   va_end(args);
 
@@ -289,16 +895,24 @@ inline void chpl_gpu_launch_kernel_flat(int ln, int32_t fn,
   va_list args;
   va_start(args, nargs);
 
+  if (num_threads > 0 && blk_dim <= 0) {
+    blk_dim = get_auto_block_size(dev, name);
+  }
+
   if (num_threads > 0){
     chpl_gpu_diags_verbose_launch(ln, fn, chpl_task_getRequestedSubloc(),
         blk_dim, 1, 1);
     chpl_gpu_diags_incr(kernel_launch);
 
+    chpl_gpu_timeline_rec_t* rec =
+      chpl_gpu_timeline_begin(chpl_gpu_timeline_kernel, dev, name,
+                              num_threads, 0, stream, ln, fn);
     chpl_gpu_impl_launch_kernel_flat(ln, fn,
                                      name,
                                      num_threads, blk_dim,
                                      stream,
                                      nargs, args);
+    chpl_gpu_timeline_end(rec, stream);
 
 #ifdef CHPL_GPU_MEM_STRATEGY_ARRAY_ON_DEVICE
     if (chpl_gpu_sync_with_host) {
@@ -328,10 +942,37 @@ extern void chpl_gpu_comm_on_get(c_sublocid_t src_subloc, void* addr,
                                  void* raddr, size_t size);
 
 
+// Whether the comm layer can read or write the device memory at ptr
+// itself, so that a transfer between it and host memory on another node
+// doesn't have to be staged through host memory here.  The first time,
+// this registers the whole allocation with the network.
+static bool comm_can_use_directly(c_nodeid_t node, void* ptr,
+                                  c_sublocid_t subloc) {
+#ifdef CHPL_GPU_MEM_STRATEGY_ARRAY_ON_DEVICE
+  if (node == chpl_nodeID) {
+    return false;
+  }
+  chpl_gpu_impl_use_device(subloc);
+  return chpl_comm_regMemDevice(chpl_gpu_impl_get_alloc_base(ptr),
+                                chpl_gpu_impl_get_alloc_size(ptr), subloc);
+#else
+  return false;
+#endif
+}
+
 void chpl_gpu_comm_put(c_nodeid_t dst_node, c_sublocid_t dst_subloc, void *dst,
                        c_sublocid_t src_subloc, void *src,
                        size_t size, int32_t commID, int ln, int32_t fn)
 {
+  if (src_subloc >= 0 && dst_subloc < 0
+      && comm_can_use_directly(dst_node, src, src_subloc)) {
+    // the network reads the source from the device; make sure our
+    // kernels and copies that write it are done first
+    chpl_gpu_task_fence();
+    chpl_gen_comm_put(src, dst_node, dst, size, commID, ln, fn);
+    return;
+  }
+
   void* src_data = src;
   c_sublocid_t src_data_subloc = src_subloc;
   if (src_subloc >= 0) {
@@ -364,6 +1005,15 @@ void chpl_gpu_comm_get(c_sublocid_t dst_subloc, void *dst,
                        c_nodeid_t src_node, c_sublocid_t src_subloc, void *src,
                        size_t size, int32_t commID, int ln, int32_t fn)
 {
+  if (dst_subloc >= 0 && src_subloc < 0
+      && comm_can_use_directly(src_node, dst, dst_subloc)) {
+    // the network writes the destination on the device; don't let it
+    // race with our own kernels and copies that use it
+    chpl_gpu_task_fence();
+    chpl_gen_comm_get(dst, src_node, src, size, commID, ln, fn);
+    return;
+  }
+
   void* dst_buff = dst;
   c_sublocid_t dst_buff_subloc = dst_subloc;
   if (dst_subloc >= 0) {
@@ -397,6 +1047,15 @@ void chpl_gpu_comm_get_strd(c_sublocid_t dst_subloc,
                           void* srcaddr_arg, size_t* srcstrides,
                           size_t* count, int32_t stridelevels, size_t elemSize,
                           int32_t commID, int ln, int32_t fn) {
+  if (dst_subloc >= 0 && src_subloc < 0
+      && comm_can_use_directly(srclocale, dstaddr_arg, dst_subloc)) {
+    chpl_gpu_task_fence();
+    chpl_comm_get_strd(dstaddr_arg, dststrides, srclocale,
+                       srcaddr_arg, srcstrides, count, stridelevels, elemSize,
+                       commID, ln, fn);
+    return;
+  }
+
   // TODO: Re-use code from chpl-comm-strd-xfer.h instead of copying it here.
   //
   // Note: This function differs from the original in chpl-comm-strd-xfer.h by
@@ -532,6 +1191,15 @@ void chpl_gpu_comm_put_strd(c_sublocid_t src_subloc,
                           void* srcaddr_arg, size_t* srcstrides,
                           size_t* count, int32_t stridelevels, size_t elemSize,
                           int32_t commID, int ln, int32_t fn) {
+  if (src_subloc >= 0 && dst_subloc < 0
+      && comm_can_use_directly(dstlocale, srcaddr_arg, src_subloc)) {
+    chpl_gpu_task_fence();
+    chpl_comm_put_strd(dstaddr_arg, dststrides, dstlocale,
+                       srcaddr_arg, srcstrides, count, stridelevels, elemSize,
+                       commID, ln, fn);
+    return;
+  }
+
   // TODO: Re-use code from chpl-comm-strd-xfer.h instead of copying it here.
   //
   // Note: This function differs from the original in chpl-comm-strd-xfer.h by
@@ -734,7 +1402,11 @@ void chpl_gpu_copy_device_to_device(c_sublocid_t dst_dev, void* dst,
   chpl_gpu_diags_incr(device_to_device);
 
   void* stream = get_stream(dst_dev);
+  chpl_gpu_timeline_rec_t* rec =
+    chpl_gpu_timeline_begin(chpl_gpu_timeline_device_to_device, dst_dev,
+                            NULL, 0, n, stream, ln, fn);
   chpl_gpu_impl_copy_device_to_device(dst, src, n, stream);
+  chpl_gpu_timeline_end(rec, stream);
   if (dst_dev != src_dev) {
     // going to a device that maybe used by a different task, synchronize
     wait_stream(stream);
@@ -761,7 +1433,11 @@ void chpl_gpu_copy_device_to_host(void* dst, c_sublocid_t src_dev,
   chpl_gpu_diags_verbose_device_to_host_copy(ln, fn, src_dev, n, commID);
   chpl_gpu_diags_incr(device_to_host);
 
+  chpl_gpu_timeline_rec_t* rec =
+    chpl_gpu_timeline_begin(chpl_gpu_timeline_device_to_host, src_dev,
+                            NULL, 0, n, stream, ln, fn);
   chpl_gpu_impl_copy_device_to_host(dst, src, n, stream);
+  chpl_gpu_timeline_end(rec, stream);
 
   // data is going to host, synchronize
   wait_stream(stream);
@@ -782,7 +1458,11 @@ void chpl_gpu_copy_host_to_device(c_sublocid_t dst_dev, void* dst,
   chpl_gpu_diags_verbose_host_to_device_copy(ln, fn, dst_dev, n, commID);
   chpl_gpu_diags_incr(host_to_device);
 
+  chpl_gpu_timeline_rec_t* rec =
+    chpl_gpu_timeline_begin(chpl_gpu_timeline_host_to_device, dst_dev,
+                            NULL, 0, n, stream, ln, fn);
   chpl_gpu_impl_copy_host_to_device(dst, src, n, stream);
+  chpl_gpu_timeline_end(rec, stream);
   if (chpl_gpu_sync_with_host) {
     CHPL_GPU_DEBUG("Eagerly synchronizing stream %p\n", stream);
     wait_stream(stream);
@@ -791,16 +1471,137 @@ void chpl_gpu_copy_host_to_device(c_sublocid_t dst_dev, void* dst,
   CHPL_GPU_DEBUG("Copy successful\n");
 }
 
-void* chpl_gpu_comm_async(void *dst, void *src, size_t n) {
-  assert(chpl_gpu_is_device_ptr(dst) || chpl_gpu_is_device_ptr(src));
+void* chpl_gpu_copy_async(c_sublocid_t dev, void* dst, const void* src,
+                          size_t n, void* after, int32_t commID,
+                          int ln, int32_t fn) {
+  const bool dst_on_dev = chpl_gpu_is_device_ptr(dst);
+  const bool src_on_dev = chpl_gpu_is_device_ptr(src);
+  assert(dst_on_dev || src_on_dev);
+
+  void* stream = NULL;
+  if (dev >= 0) {
+    chpl_gpu_impl_use_device(dev);
+    stream = get_copy_stream(dev);
+  }
+
+  CHPL_GPU_DEBUG("Copying %zu bytes asynchronously on stream %p\n", n, stream);
 
-  CHPL_GPU_DEBUG("Copying %zu bytes asynchronously between host and device\n", n);
+  if (after != NULL) {
+    chpl_gpu_impl_stream_wait_event(stream, after);
+  }
 
-  return chpl_gpu_impl_comm_async(dst, src, n);
+  chpl_gpu_timeline_rec_t* rec =
+    chpl_gpu_timeline_begin(dst_on_dev && src_on_dev ?
+                              chpl_gpu_timeline_device_to_device :
+                            dst_on_dev ? chpl_gpu_timeline_host_to_device :
+                                         chpl_gpu_timeline_device_to_host,
+                            dev, NULL, 0, n, stream, ln, fn);
+  if (dst_on_dev && src_on_dev) {
+    chpl_gpu_diags_verbose_device_to_device_copy(ln, fn, dev, dev, n, commID);
+    chpl_gpu_diags_incr(device_to_device);
+    chpl_gpu_impl_copy_device_to_device(dst, src, n, stream);
+  }
+  else if (dst_on_dev) {
+    chpl_gpu_diags_verbose_host_to_device_copy(ln, fn, dev, n, commID);
+    chpl_gpu_diags_incr(host_to_device);
+    chpl_gpu_impl_copy_host_to_device(dst, src, n, stream);
+  }
+  else {
+    chpl_gpu_diags_verbose_device_to_host_copy(ln, fn, dev, n, commID);
+    chpl_gpu_diags_incr(device_to_host);
+    chpl_gpu_impl_copy_device_to_host(dst, src, n, stream);
+  }
+  chpl_gpu_timeline_end(rec, stream);
+
+  void* event = chpl_gpu_impl_event_create();
+  chpl_gpu_impl_event_record(event, stream);
+  return event;
+}
+
+void* chpl_gpu_event_record(c_sublocid_t dev) {
+  chpl_gpu_impl_use_device(dev);
+  void* event = chpl_gpu_impl_event_create();
+  chpl_gpu_impl_event_record(event, get_stream(dev));
+  return event;
+}
+
+void chpl_gpu_stream_wait_event(c_sublocid_t dev, void* event) {
+  if (event == NULL) return;
+
+  chpl_gpu_impl_use_device(dev);
+  chpl_gpu_impl_stream_wait_event(get_stream(dev), event);
+}
+
+bool chpl_gpu_event_ready(void* event) {
+  return chpl_gpu_impl_event_ready(event);
+}
+
+void chpl_gpu_event_wait(void* event) {
+  if (yield_in_stream_sync) {
+    while (!chpl_gpu_impl_event_ready(event)) {
+      chpl_task_yield();
+    }
+  }
+  chpl_gpu_impl_event_synchronize(event);
+  chpl_gpu_impl_event_destroy(event);
+}
+
+void chpl_gpu_event_free(void* event) {
+  chpl_gpu_impl_event_destroy(event);
+}
+
+void* chpl_gpu_comm_async(void *dst, void *src, size_t n) {
+  return chpl_gpu_copy_async(chpl_task_getRequestedSubloc(), dst, src, n,
+                             /*after=*/NULL, CHPL_COMM_UNKNOWN_ID, 0, 0);
 }
 
 void chpl_gpu_comm_wait(void *stream) {
-  chpl_gpu_impl_comm_wait(stream);
+  chpl_gpu_event_wait(stream);
+}
+
+c_sublocid_t chpl_gpu_comm_amo_device(void* obj, bool* registered) {
+  *registered = false;
+#ifdef CHPL_GPU_MEM_STRATEGY_ARRAY_ON_DEVICE
+  if (chpl_gpu_impl_is_host_ptr(obj)) {
+    return -1;
+  }
+  c_sublocid_t dev = chpl_gpu_impl_get_ptr_device(obj);
+  chpl_gpu_impl_use_device(dev);
+  *registered = chpl_comm_regMemDevice(chpl_gpu_impl_get_alloc_base(obj),
+                                       chpl_gpu_impl_get_alloc_size(obj), dev);
+  return dev;
+#else
+  // unified memory, which the CPU can do atomics on
+  return -1;
+#endif
+}
+
+static void** amo_streams = NULL;
+
+static void* get_amo_stream(c_sublocid_t dev) {
+  if (amo_streams == NULL) {
+    amo_streams = chpl_mem_calloc(chpl_gpu_num_devices, sizeof(void*),
+                                  CHPL_RT_MD_GPU_UTIL, 0, 0);
+  }
+  chpl_gpu_impl_use_device(dev);
+  if (amo_streams[dev] == NULL) {
+    amo_streams[dev] = chpl_gpu_impl_stream_create();
+  }
+  return amo_streams[dev];
+}
+
+void chpl_gpu_comm_amo_get(void* dst, c_sublocid_t dev, const void* obj,
+                           size_t n) {
+  void* stream = get_amo_stream(dev);
+  chpl_gpu_impl_copy_device_to_host(dst, obj, n, stream);
+  chpl_gpu_impl_stream_synchronize(stream);
+}
+
+void chpl_gpu_comm_amo_put(c_sublocid_t dev, void* obj, const void* src,
+                           size_t n) {
+  void* stream = get_amo_stream(dev);
+  chpl_gpu_impl_copy_host_to_device(obj, src, n, stream);
+  chpl_gpu_impl_stream_synchronize(stream);
 }
 
 size_t chpl_gpu_get_alloc_size(void* ptr) {
@@ -818,7 +1619,7 @@ void* chpl_gpu_mem_alloc(size_t size, chpl_mem_descInt_t description,
     chpl_gpu_impl_use_device(chpl_task_getRequestedSubloc());
 
     chpl_memhook_malloc_pre(1, size, description, lineno, filename);
-    ptr = chpl_gpu_impl_mem_alloc(size);
+    ptr = pool_alloc(chpl_task_getRequestedSubloc(), POOL_KIND_MEM, size);
     chpl_memhook_malloc_post((void*)ptr, 1, size, description, lineno, filename);
 
     CHPL_GPU_DEBUG("chpl_gpu_mem_alloc returning %p\n", (void*)ptr);
@@ -832,8 +1633,17 @@ void* chpl_gpu_mem_alloc(size_t size, chpl_mem_descInt_t description,
 
 void* chpl_gpu_mem_array_alloc(size_t size, chpl_mem_descInt_t description,
                                int32_t lineno, int32_t filename) {
-  CHPL_GPU_DEBUG("chpl_gpu_mem_array_alloc called. Size:%zu file:%s line:%d\n",
-                 size, chpl_lookupFilename(filename), lineno);
+  return chpl_gpu_mem_array_alloc_policy(size, array_mem_policy, description,
+                                         lineno, filename);
+}
+
+void* chpl_gpu_mem_array_alloc_policy(size_t size,
+                                      chpl_gpu_mem_policy_t policy,
+                                      chpl_mem_descInt_t description,
+                                      int32_t lineno, int32_t filename) {
+  CHPL_GPU_DEBUG("chpl_gpu_mem_array_alloc called. Size:%zu policy:%s "
+                 "file:%s line:%d\n", size, mem_policy_name(policy),
+                 chpl_lookupFilename(filename), lineno);
 
   int dev = chpl_task_getRequestedSubloc();
   chpl_gpu_impl_use_device(dev);
@@ -841,7 +1651,7 @@ void* chpl_gpu_mem_array_alloc(size_t size, chpl_mem_descInt_t description,
   void* ptr = 0;
   if (size > 0) {
     chpl_memhook_malloc_pre(1, size, description, lineno, filename);
-    ptr = chpl_gpu_impl_mem_array_alloc(size);
+    ptr = pool_alloc(dev, array_pool_kind(policy), size);
     chpl_memhook_malloc_post((void*)ptr, 1, size, description, lineno, filename);
 
     CHPL_GPU_DEBUG("chpl_gpu_mem_array_alloc returning %p\n", (void*)ptr);
@@ -860,7 +1670,9 @@ void chpl_gpu_mem_free(void* memAlloc, int32_t lineno, int32_t filename) {
   chpl_gpu_impl_use_device(dev);
 
   chpl_memhook_free_pre(memAlloc, 0, lineno, filename);
-  chpl_gpu_impl_mem_free(memAlloc);
+  if (memAlloc != NULL) {
+    pool_free(memAlloc);
+  }
 
   CHPL_GPU_DEBUG("chpl_gpu_mem_free is returning\n");
 }
@@ -888,7 +1700,7 @@ void* chpl_gpu_mem_calloc(size_t number, size_t size,
     chpl_gpu_impl_use_device(dev_id);
 
     chpl_memhook_malloc_pre(1, total_size, description, lineno, filename);
-    ptr = chpl_gpu_impl_mem_alloc(total_size);
+    ptr = pool_alloc(dev_id, POOL_KIND_MEM, total_size);
     chpl_memhook_malloc_post((void*)ptr, 1, total_size, description, lineno, filename);
 
     chpl_gpu_impl_copy_host_to_device(ptr, host_mem, total_size, NULL);
@@ -957,6 +1769,18 @@ void chpl_gpu_hostmem_register(void *memAlloc, size_t size) {
   chpl_gpu_impl_hostmem_register(memAlloc, size);
 }
 
+void chpl_gpu_mem_advise_read_mostly(void* ptr, bool enable) {
+#ifndef CHPL_GPU_MEM_STRATEGY_ARRAY_ON_DEVICE
+  if (!unified_memory_hints || ptr == NULL) {
+    return;
+  }
+
+  if (chpl_gpu_impl_mem_advise_read_mostly(ptr, enable)) {
+    chpl_gpu_diags_incr(mem_advise);
+  }
+#endif
+}
+
 bool chpl_gpu_is_device_ptr(const void* ptr) {
   return chpl_gpu_impl_is_device_ptr(ptr);
 }
@@ -1004,4 +1828,78 @@ GPU_REDUCE(DEF_ONE_REDUCE, maxloc)
 
 #undef DEF_ONE_REDUCE
 
+// The scans, sorts etc. all take the same steps around the impl call.
+#define GPU_RUN_ON_TASK_STREAM(name, impl_call) \
+  CHPL_GPU_DEBUG(name " called\n"); \
+  \
+  int dev = chpl_task_getRequestedSubloc(); \
+  chpl_gpu_impl_use_device(dev); \
+  void* stream = get_stream(dev); \
+  \
+  impl_call; \
+  \
+  if (chpl_gpu_sync_with_host) { \
+    CHPL_GPU_DEBUG("Eagerly synchronizing stream %p\n", stream); \
+    wait_stream(stream); \
+  } \
+  \
+  CHPL_GPU_DEBUG(name " returned\n");
+
+#define DEF_ONE_SCAN(kind, data_type)\
+void chpl_gpu_##kind##_scan_##data_type(data_type* data, data_type* out, \
+                                        int n) { \
+  GPU_RUN_ON_TASK_STREAM("chpl_gpu_" #kind "_scan_" #data_type, \
+    chpl_gpu_impl_##kind##_scan_##data_type(data, out, n, stream)) \
+}
+
+GPU_REDUCE(DEF_ONE_SCAN, inclusive_sum)
+GPU_REDUCE(DEF_ONE_SCAN, exclusive_sum)
+GPU_REDUCE(DEF_ONE_SCAN, inclusive_min)
+GPU_REDUCE(DEF_ONE_SCAN, inclusive_max)
+
+#undef DEF_ONE_SCAN
+
+#define DEF_ONE_SEGMENTED_REDUCE(kind, data_type)\
+void chpl_gpu_##kind##_segmented_reduce_##data_type(data_type* data, \
+                                                    int nsegs, int* offsets, \
+                                                    data_type* out) { \
+  GPU_RUN_ON_TASK_STREAM("chpl_gpu_" #kind "_segmented_reduce_" #data_type, \
+    chpl_gpu_impl_##kind##_segmented_reduce_##data_type(data, nsegs, \
+                                                        offsets, out, \
+                                                        stream)) \
+}
+
+GPU_REDUCE(DEF_ONE_SEGMENTED_REDUCE, sum)
+GPU_REDUCE(DEF_ONE_SEGMENTED_REDUCE, min)
+GPU_REDUCE(DEF_ONE_SEGMENTED_REDUCE, max)
+
+#undef DEF_ONE_SEGMENTED_REDUCE
+
+#define DEF_ONE_SORT(kind, data_type)\
+void chpl_gpu_sort_##kind##_##data_type(data_type* data, data_type* out, \
+                                        int n) { \
+  GPU_RUN_ON_TASK_STREAM("chpl_gpu_sort_" #kind "_" #data_type, \
+    chpl_gpu_impl_sort_##kind##_##data_type(data, out, n, stream)) \
+}
+
+GPU_REDUCE(DEF_ONE_SORT, keys)
+
+#undef DEF_ONE_SORT
+
+#define DEF_ONE_HISTOGRAM(kind, data_type)\
+void chpl_gpu_histogram_##kind##_##data_type(data_type* data, int n, \
+                                             int* counts, int nbins, \
+                                             data_type lower, \
+                                             data_type upper) { \
+  GPU_RUN_ON_TASK_STREAM("chpl_gpu_histogram_" #kind "_" #data_type, \
+    chpl_gpu_impl_histogram_##kind##_##data_type(data, n, counts, nbins, \
+                                                 lower, upper, stream)) \
+}
+
+GPU_REDUCE(DEF_ONE_HISTOGRAM, even)
+
+#undef DEF_ONE_HISTOGRAM
+
+#undef GPU_RUN_ON_TASK_STREAM
+
 #endif
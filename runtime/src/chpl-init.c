@@ -28,15 +28,18 @@
 #include "chpl-comm.h"
 #include "chplexit.h"
 #include "chplio.h"
+#include "chpl-fn-prof.h"
 #include "chpl-gpu.h"
 #include "chpl-init.h"
 #include "chpl-mem.h"
 #include "chplmemtrack.h"
 #include "chpl-privatization.h"
+#include "chpl-task-prof.h"
 #include "chpl-tasks.h"
 #include "chpl-topo.h"
 #include "chpl-linefile-support.h"
 #include "chplsys.h"
+#include "chpltimers.h"
 #include "config.h"
 #include "error.h"
 
@@ -259,6 +262,7 @@ void chpl_rt_init(int argc, char* argv[]) {
   //
 
   chpl_error_init();  // This does local-only initialization
+  chpl_fast_timer_init();
   chpl_topo_pre_comm_init(NULL);
   chpl_comm_init(&argc, &argv);
   chpl_topo_post_comm_init();
@@ -307,6 +311,8 @@ void chpl_rt_init(int argc, char* argv[]) {
   // Initialize the task management layer.
   //
   chpl_task_init();
+  chpl_task_prof_init();
+  chpl_fn_prof_init();
 
   // Initialize privatization, needs to happen before hitting module init
   chpl_privatization_init();
@@ -0,0 +1,256 @@
+/*
+ * Copyright 2020-2023 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Per-thread small-object arenas.  See chpl-mem-arena.h.
+//
+// Every object is preceded by a small header recording its size class
+// (or that it has none), so chpl_mem_arena_free() doesn't need to be
+// told the size.  The blocks themselves come from the memory layer
+// directly, below the memory hooks: the hooks are called for each
+// object handed out or returned, so memory tracking sees exactly the
+// live objects, and blocks sitting in free lists are not counted as
+// allocated.
+//
+#include "chplrt.h"
+
+#include <pthread.h>
+#include <string.h>
+
+#include "chpl-env.h"
+#include "chpl-mem.h"
+#include "chpl-mem-arena.h"
+#include "chpl-thread-local-storage.h"
+#include "chpltypes.h"
+#include "error.h"
+
+// Size classes hold objects of 32, 64, ..., 1024 bytes.
+#define ARENA_MIN_SHIFT   5
+#define ARENA_NUM_CLASSES 6
+#define ARENA_NO_CLASS    ARENA_NUM_CLASSES
+
+#define ARENA_CLASS_SIZE(c) ((size_t) 1 << (ARENA_MIN_SHIFT + (c)))
+
+// The header is padded to keep objects as aligned as malloc would.
+typedef union {
+  uint32_t cls;
+  max_align_t align;
+} arena_hdr_t;
+
+typedef struct arena_free_s {
+  struct arena_free_s* next;
+} arena_free_t;
+
+typedef struct arena_s {
+  struct arena_s* next;                   // in arena_list
+  struct arena_s* prev;
+  arena_free_t* free[ARENA_NUM_CLASSES];
+  uint32_t count[ARENA_NUM_CLASSES];
+} arena_t;
+
+static chpl_bool arena_enabled = false;
+static uint32_t arena_cache_max;
+
+CHPL_TLS_DECL(arena_t*, thread_arena);
+static pthread_key_t arena_destructor_key;  // set but never read
+
+static pthread_mutex_t arena_list_lock = PTHREAD_MUTEX_INITIALIZER;
+static arena_t* arena_list = NULL;
+
+
+static
+void arena_destroy(void* arg) {
+  arena_t* a = (arena_t*) arg;
+
+  pthread_mutex_lock(&arena_list_lock);
+  if (a->prev == NULL) {
+    arena_list = a->next;
+  } else {
+    a->prev->next = a->next;
+  }
+  if (a->next != NULL) {
+    a->next->prev = a->prev;
+  }
+  pthread_mutex_unlock(&arena_list_lock);
+
+  for (int c = 0; c < ARENA_NUM_CLASSES; c++) {
+    arena_free_t* f = a->free[c];
+    while (f != NULL) {
+      arena_free_t* next = f->next;
+      chpl_free((arena_hdr_t*) f - 1);
+      f = next;
+    }
+  }
+
+  chpl_free(a);
+}
+
+
+void chpl_mem_arena_init(void) {
+  const uint32_t dflt = 64;
+  int64_t n = chpl_env_rt_get_int("MEM_ARENA_CACHE_SIZE", dflt);
+
+  if (n < 0 || n > UINT32_MAX) {
+    chpl_warning("CHPL_RT_MEM_ARENA_CACHE_SIZE is out of range; "
+                 "using the default", 0, 0);
+    n = dflt;
+  }
+  arena_cache_max = (uint32_t) n;
+
+  if (arena_cache_max > 0) {
+    CHPL_TLS_INIT(thread_arena);
+    if (pthread_key_create(&arena_destructor_key, arena_destroy) != 0) {
+      chpl_internal_error("cannot create memory arena thread key");
+    }
+    arena_enabled = true;
+  }
+}
+
+
+// returns NULL if the arenas are not in use
+static inline
+arena_t* get_thread_arena(void) {
+  arena_t* a;
+
+  if (!arena_enabled) {
+    return NULL;
+  }
+
+  if ((a = (arena_t*) CHPL_TLS_GET(thread_arena)) == NULL) {
+    if ((a = (arena_t*) chpl_calloc(1, sizeof(*a))) == NULL) {
+      return NULL;
+    }
+    CHPL_TLS_SET(thread_arena, a);
+    (void) pthread_setspecific(arena_destructor_key, a);
+
+    pthread_mutex_lock(&arena_list_lock);
+    if ((a->next = arena_list) != NULL) {
+      arena_list->prev = a;
+    }
+    arena_list = a;
+    pthread_mutex_unlock(&arena_list_lock);
+  }
+
+  return a;
+}
+
+
+static inline
+uint32_t size_class(size_t size) {
+  uint32_t c = 0;
+  while (c < ARENA_NUM_CLASSES && size > ARENA_CLASS_SIZE(c)) {
+    c++;
+  }
+  return c;
+}
+
+
+static inline
+void* arena_alloc(size_t size, chpl_mem_descInt_t description,
+                  int32_t lineno, int32_t filename, chpl_bool zero) {
+  uint32_t cls = size_class(size);
+  arena_hdr_t* hdr = NULL;
+  void* memAlloc;
+  arena_t* a;
+
+  chpl_memhook_malloc_pre(1, size, description, lineno, filename);
+
+  if (cls != ARENA_NO_CLASS && (a = get_thread_arena()) != NULL
+      && a->free[cls] != NULL) {
+    arena_free_t* f = a->free[cls];
+    a->free[cls] = f->next;
+    a->count[cls]--;
+    hdr = (arena_hdr_t*) f - 1;
+    if (zero) {
+      memset(f, 0, size);
+    }
+  } else {
+    size_t blockSize = sizeof(arena_hdr_t)
+                       + ((cls == ARENA_NO_CLASS)
+                          ? size : ARENA_CLASS_SIZE(cls));
+    hdr = zero ? chpl_calloc(1, blockSize) : chpl_malloc(blockSize);
+    if (hdr != NULL) {
+      hdr->cls = cls;
+    }
+  }
+
+  memAlloc = (hdr == NULL) ? NULL : (void*) (hdr + 1);
+  chpl_memhook_malloc_post(memAlloc, 1, size, description,
+                           lineno, filename);
+  return memAlloc;
+}
+
+
+void* chpl_mem_arena_alloc(size_t size, chpl_mem_descInt_t description,
+                           int32_t lineno, int32_t filename) {
+  return arena_alloc(size, description, lineno, filename, false);
+}
+
+
+void* chpl_mem_arena_allocZero(size_t size, chpl_mem_descInt_t description,
+                               int32_t lineno, int32_t filename) {
+  return arena_alloc(size, description, lineno, filename, true);
+}
+
+
+void chpl_mem_arena_free(void* memAlloc, int32_t lineno, int32_t filename) {
+  arena_hdr_t* hdr;
+  uint32_t cls;
+  arena_t* a;
+
+  if (memAlloc == NULL) {
+    return;
+  }
+
+  hdr = (arena_hdr_t*) memAlloc - 1;
+  cls = hdr->cls;
+
+  // The class size bounds the original request, which is all the
+  // hooks need to know.
+  chpl_memhook_free_pre(memAlloc,
+                        (cls == ARENA_NO_CLASS) ? 0 : ARENA_CLASS_SIZE(cls),
+                        lineno, filename);
+
+  if (cls != ARENA_NO_CLASS && (a = get_thread_arena()) != NULL
+      && a->count[cls] < arena_cache_max) {
+    arena_free_t* f = (arena_free_t*) memAlloc;
+    f->next = a->free[cls];
+    a->free[cls] = f;
+    a->count[cls]++;
+    return;
+  }
+
+  chpl_free(hdr);
+}
+
+
+size_t chpl_mem_arena_cachedBytes(void) {
+  size_t bytes = 0;
+
+  pthread_mutex_lock(&arena_list_lock);
+  for (arena_t* a = arena_list; a != NULL; a = a->next) {
+    for (int c = 0; c < ARENA_NUM_CLASSES; c++) {
+      bytes += a->count[c] * (sizeof(arena_hdr_t) + ARENA_CLASS_SIZE(c));
+    }
+  }
+  pthread_mutex_unlock(&arena_list_lock);
+
+  return bytes;
+}
@@ -35,42 +35,104 @@ void chpl_mem_replace_malloc_if_needed(void);
 #ifndef CHPL_USING_CSTDLIB_MALLOC
 // Don't declare anything unless we're not using C allocator.
 
-struct system_allocated_ptr {
-  struct system_allocated_ptr* next;
-  void* ptr;
+// What the system allocator handed out before the Chapel heap was
+// up, sorted by address.  The ranges don't overlap: a new one that
+// overlaps older ones means those were freed (or realloc'd away), so
+// they are dropped.  Nothing is added once the Chapel heap is up, but
+// every free() has to check this, so it's searched by bisection.
+struct system_allocated_range {
+  unsigned char* start;
   size_t len;
 };
 
-static struct system_allocated_ptr* system_allocated_head;
+static struct system_allocated_range* system_allocated;
+static size_t system_allocated_num;
+static size_t system_allocated_cap;
+
+// Returns the index of the first range that ends after ptr.
+static size_t find_system_allocated(unsigned char* ptr)
+{
+  size_t lo = 0;
+  size_t hi = system_allocated_num;
+  while( lo < hi ) {
+    size_t mid = lo + (hi - lo) / 2;
+    if( system_allocated[mid].start + system_allocated[mid].len <= ptr )
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
 
 // This version is for linker malloc replacements
 static void track_system_allocated(
   void* ptr,
   size_t len,
-  void * (*real_malloc) (size_t) )
+  void * (*real_realloc) (void*, size_t) )
+{
+  unsigned char* start = (unsigned char*) ptr;
+  size_t i, j;
+
+  if( !ptr ) return;
+  if( len == 0 ) len = 1;
+
+  i = find_system_allocated(start);
+  for( j = i;
+       j < system_allocated_num && system_allocated[j].start < start + len;
+       j++ ) {
+  }
+
+  if( i == j && system_allocated_num == system_allocated_cap ) {
+    size_t cap = system_allocated_cap ? 2 * system_allocated_cap : 64;
+    struct system_allocated_range* grown;
+    grown = (struct system_allocated_range*)
+              real_realloc(system_allocated, cap * sizeof(*grown));
+    if( !grown ) return;
+    system_allocated = grown;
+    system_allocated_cap = cap;
+  }
+
+  // replace ranges [i, j) with this one
+  if( i == j ) {
+    memmove(&system_allocated[i + 1], &system_allocated[i],
+            (system_allocated_num - i) * sizeof(*system_allocated));
+    system_allocated_num++;
+  } else if( j > i + 1 ) {
+    memmove(&system_allocated[i + 1], &system_allocated[j],
+            (system_allocated_num - j) * sizeof(*system_allocated));
+    system_allocated_num -= j - i - 1;
+  }
+  system_allocated[i].start = start;
+  system_allocated[i].len = len;
+}
+
+// Drops the range starting at ptr, when the system allocator frees it
+// before the Chapel heap is up.  (After that, readers don't lock, so
+// freed ranges stay.)
+static void untrack_system_allocated(void* ptr)
 {
-  struct system_allocated_ptr* cur;
-  cur = (struct system_allocated_ptr*)
-            real_malloc(sizeof(struct system_allocated_ptr));
-  cur->next = system_allocated_head;
-  cur->ptr = ptr;
-  cur->len = len;
-  system_allocated_head = cur;
+  unsigned char* start = (unsigned char*) ptr;
+  size_t i = find_system_allocated(start);
+  if( i < system_allocated_num && system_allocated[i].start == start ) {
+    memmove(&system_allocated[i], &system_allocated[i + 1],
+            (system_allocated_num - i - 1) * sizeof(*system_allocated));
+    system_allocated_num--;
+  }
 }
 
 static int is_system_allocated(void* ptr_in, size_t *len_out)
 {
   unsigned char* ptr = (unsigned char*) ptr_in;
-  struct system_allocated_ptr* cur;
-  for( cur = system_allocated_head;
-       cur;
-       cur = cur->next ) {
-    unsigned char* start = cur->ptr;
-    unsigned char* end = start + cur->len;
-    if( start <= ptr && ptr < end ) {
-      if( len_out ) *len_out = cur->len;
-      return 1;
-    }
+  size_t i;
+
+  if( system_allocated_num == 0 ||
+      ptr < system_allocated[0].start )
+    return 0;
+
+  i = find_system_allocated(ptr);
+  if( i < system_allocated_num && system_allocated[i].start <= ptr ) {
+    if( len_out ) *len_out = system_allocated[i].len;
+    return 1;
   }
   return 0;
 }
@@ -109,7 +171,7 @@ void* calloc(size_t n, size_t size)
     ret = __libc_calloc(n, size);
     if( DEBUG_REPLACE_MALLOC )
       printf("in early calloc %p = system calloc(%#x)\n", ret, (int) (n*size));
-    track_system_allocated(ret, n*size, __libc_malloc);
+    track_system_allocated(ret, n*size, __libc_realloc);
     return ret;
   }
   if( DEBUG_REPLACE_MALLOC )
@@ -130,7 +192,7 @@ void* malloc(size_t size)
     ret = __libc_malloc(size);
     if( DEBUG_REPLACE_MALLOC )
       printf("in early malloc %p = system malloc(%#x)\n", ret, (int) size);
-    track_system_allocated(ret, size, __libc_malloc);
+    track_system_allocated(ret, size, __libc_realloc);
     return ret;
   }
   if( DEBUG_REPLACE_MALLOC )
@@ -150,7 +212,7 @@ void* memalign(size_t alignment, size_t size)
     void* ret = __libc_memalign(alignment, size);
     if( DEBUG_REPLACE_MALLOC )
       printf("in early memalign %p = system memalign(%#x)\n", ret, (int) size);
-    track_system_allocated(ret, size, __libc_malloc);
+    track_system_allocated(ret, size, __libc_realloc);
     return ret;
   }
   if( DEBUG_REPLACE_MALLOC )
@@ -166,7 +228,8 @@ void* realloc(void* ptr, size_t size)
     if( DEBUG_REPLACE_MALLOC )
       printf("in early realloc %p = system realloc(%p,%#x)\n",
              ret, ptr, (int) size);
-    track_system_allocated(ret, size, __libc_malloc);
+    if( ret && ptr ) untrack_system_allocated(ptr);
+    track_system_allocated(ret, size, __libc_realloc);
     return ret;
   } else {
     void* ret = NULL;
@@ -210,7 +273,14 @@ void free(void* ptr)
     printf("in free(%p)\n", ptr);
   // check to see if we're freeing a pointer that was allocated
   // before the our allocator came up.
-  if( !chpl_mem_inited() || is_system_allocated(ptr, NULL) ) {
+  if( !chpl_mem_inited() ) {
+    if( DEBUG_REPLACE_MALLOC )
+      printf("calling early system free\n");
+    untrack_system_allocated(ptr);
+    __libc_free(ptr);
+    return;
+  }
+  if( is_system_allocated(ptr, NULL) ) {
     if( DEBUG_REPLACE_MALLOC )
       printf("calling system free\n");
     __libc_free(ptr);
@@ -234,7 +304,7 @@ int posix_memalign(void **memptr, size_t alignment, size_t size)
     if( DEBUG_REPLACE_MALLOC )
       printf("in early posix_memalign %p = system posix_memalign(%#x)\n",
              *memptr, (int) size);
-    track_system_allocated(*memptr, size, __libc_malloc);
+    track_system_allocated(*memptr, size, __libc_realloc);
     return 0;
   }
 
@@ -257,7 +327,7 @@ void* valloc(size_t size)
     ret = __libc_valloc(size);
     if( DEBUG_REPLACE_MALLOC )
       printf("in early valloc %p = system valloc(%#x)\n", ret, (int) size);
-    track_system_allocated(ret, size, __libc_malloc);
+    track_system_allocated(ret, size, __libc_realloc);
     return ret;
   }
   if( DEBUG_REPLACE_MALLOC )
@@ -278,7 +348,7 @@ void* pvalloc(size_t size)
     if( DEBUG_REPLACE_MALLOC )
       printf("in early pvalloc %p = system pvalloc(%#x)\n",
              ret, (int) size);
-    track_system_allocated(ret, size, __libc_malloc);
+    track_system_allocated(ret, size, __libc_realloc);
     return ret;
   }
   if( DEBUG_REPLACE_MALLOC )
@@ -21,19 +21,281 @@
 //
 // Shared code for different mem implementations in mem-*/chpl_*_mem.c
 //
+
+// This #define needs to be before the other #includes
+// since it affects included files (mremap() is Linux-only)
+#ifdef __linux__
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#endif
+
 #include "chplrt.h"
 
+#include "chpl-comm.h"
+#include "chpl-env.h"
 #include "chpl-mem.h"
+#include "chpl-mem-arena.h"
+#include "chpl-tasks.h"
+#include "chpl-topo.h"
+#include "chplcgfns.h"
 #include "chpltypes.h"
 #include "error.h"
 #include "chplsys.h"
 
+#include <pthread.h>
+#include <string.h>
+#include <sys/mman.h>
+
 static int heapInitialized = 0;
 
+chpl_bool chpl_mem_localizeArrays = false;
+
+size_t chpl_mem_array_mapThreshold = SIZE_MAX;
+
+size_t chpl_mem_parallelInitThreshold = SIZE_MAX;
+
 
 void chpl_mem_init(void) {
   chpl_mem_layerInit();
+  chpl_mem_arena_init();
   heapInitialized = 1;
+
+  //
+  // The numa locale model places arrays itself, by sublocale.  With the
+  // flat model, CHPL_RT_LOCALIZE_ARRAYS asks us to do it here instead.
+  //
+  chpl_mem_localizeArrays = (strcmp(CHPL_LOCALE_MODEL, "flat") == 0
+                             && chpl_topo_getNumNumaDomains() > 1
+                             && chpl_env_rt_get_bool("LOCALIZE_ARRAYS",
+                                                     false));
+
+  //
+  // Give large arrays mappings of their own, so they can be resized with
+  // mremap() instead of being copied.  Not if the comm layer needs all
+  // memory to be in its registered heap, or allocates large arrays
+  // itself, or if the heap uses explicit huge pages, which we would
+  // otherwise bypass.
+  //
+  void* heapStart;
+  size_t heapSize;
+  chpl_comm_regMemHeapInfo(&heapStart, &heapSize);
+  if (heapStart == NULL && heapSize == 0
+      && chpl_comm_regMemAllocThreshold() == SIZE_MAX
+      && chpl_mem_layerHeapPageSize() == 0) {
+    chpl_mem_array_mapThreshold =
+      chpl_env_rt_get_size("ARRAY_MAP_THRESHOLD", (size_t) 64 << 20);
+    if (chpl_mem_array_mapThreshold == 0) {
+      chpl_mem_array_mapThreshold = SIZE_MAX;
+    } else if (chpl_mem_array_mapThreshold < chpl_getSysPageSize()) {
+      chpl_mem_array_mapThreshold = chpl_getSysPageSize();
+    }
+  }
+
+  chpl_mem_parallelInitThreshold =
+    chpl_env_rt_get_size("PARALLEL_INIT_THRESHOLD", (size_t) 64 << 20);
+  if (chpl_mem_parallelInitThreshold == 0) {
+    chpl_mem_parallelInitThreshold = SIZE_MAX;
+  }
+}
+
+
+void* chpl_mem_array_map(size_t size) {
+  void* p = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  return (p == MAP_FAILED) ? NULL : p;
+}
+
+
+void* chpl_mem_array_remap(void* p, size_t oldSize, size_t newSize) {
+  void* newp;
+#ifdef MREMAP_MAYMOVE
+  //
+  // The kernel grows the mapping in place if it can and otherwise moves
+  // the existing pages to a new range, but never copies them.
+  //
+  newp = mremap(p, oldSize, newSize, MREMAP_MAYMOVE);
+  if (newp == MAP_FAILED) {
+    newp = NULL;
+  }
+#else
+  if ((newp = chpl_mem_array_map(newSize)) != NULL) {
+    memcpy(newp, p, (oldSize < newSize) ? oldSize : newSize);
+    chpl_mem_array_unmap(p, oldSize);
+  }
+#endif
+  return newp;
+}
+
+
+void chpl_mem_array_unmap(void* p, size_t size) {
+  if (p != NULL) {
+    (void) munmap(p, size);
+  }
+}
+
+
+//
+// Default foralls give each of here.maxTaskPar tasks (the default for
+// dataParTasksPerLocale) an equal share of the elements.  Bind the
+// pages of each share to the NUMA domain its worker thread runs on, so
+// that first touch in a forall and later foralls over the same index
+// set find their memory local.  Arrays too small for every share to
+// have a page of its own aren't worth it.
+//
+void chpl_mem_array_localize(void* p, size_t nmemb, size_t eltSize) {
+  const int numChunks = chpl_task_getMaxPar();
+  if (numChunks < 2
+      || nmemb * eltSize < numChunks * chpl_getHeapPageSize()) {
+    return;
+  }
+  chpl_topo_setMemChunkLocality(p, nmemb, eltSize, numChunks);
+}
+
+
+//
+// Parallel initialization.  The region is cut into one contiguous share
+// per thread, the way a default forall would divide it, and each share
+// is filled (or just faulted in) by its own thread.  Unless the pages
+// have already been bound by chpl_mem_array_localize(), each thread is
+// also confined to the NUMA domain its share would most likely be used
+// from, so that first touch places the pages there.
+//
+typedef struct {
+  unsigned char* start;
+  size_t nmemb;
+  size_t eltSize;
+  const void* val;    // NULL: zero
+  chpl_bool touchOnly;
+  c_sublocid_t subloc;
+} parInitShare_t;
+
+static void touchPages(unsigned char* start, size_t size) {
+#ifdef MADV_POPULATE_WRITE
+  // Let the kernel fault in the whole range, without a trap per page.
+  if (madvise(start, size, MADV_POPULATE_WRITE) == 0) {
+    return;
+  }
+#endif
+  const size_t pgSize = chpl_getSysPageSize();
+  for (size_t off = 0; off < size; off += pgSize) {
+    start[off] = 0;
+  }
+}
+
+static void fillElts(unsigned char* start, size_t nmemb, size_t eltSize,
+                     const void* val) {
+  const size_t size = nmemb * eltSize;
+  if (val == NULL) {
+    memset(start, 0, size);
+    return;
+  }
+
+  //
+  // Copy in the first element and then keep doubling what's been done.
+  //
+  size_t done = eltSize;
+  memcpy(start, val, eltSize);
+  while (done < size) {
+    const size_t n = (done < size - done) ? done : size - done;
+    memcpy(start + done, start, n);
+    done += n;
+  }
+}
+
+static void* parInitThread(void* arg) {
+  parInitShare_t* sh = (parInitShare_t*) arg;
+  if (sh->subloc != c_sublocid_none) {
+    chpl_topo_setThreadLocality(sh->subloc);
+  }
+  if (sh->touchOnly) {
+    touchPages(sh->start, sh->nmemb * sh->eltSize);
+  } else {
+    fillElts(sh->start, sh->nmemb, sh->eltSize, sh->val);
+  }
+  return NULL;
+}
+
+static void parallelInit(void* p, size_t nmemb, size_t eltSize,
+                         const void* val, chpl_bool touchOnly) {
+  //
+  // Give each thread at least a few MiB, so that creating it pays off.
+  //
+  const size_t minShareSize = (size_t) 4 << 20;
+  const size_t size = nmemb * eltSize;
+  size_t nthreads = chpl_topo_getNumCPUsPhysical(true);
+  if (nthreads > size / minShareSize) {
+    nthreads = size / minShareSize;
+  }
+  if (nthreads > nmemb) {
+    nthreads = nmemb;
+  }
+
+  if (size < chpl_mem_parallelInitThreshold || nthreads <= 1) {
+    if (touchOnly) {
+      touchPages(p, size);
+    } else {
+      fillElts(p, nmemb, eltSize, val);
+    }
+    return;
+  }
+
+  const int numNumas = chpl_topo_getNumNumaDomains();
+  const chpl_bool bindThreads = (numNumas > 1 && !chpl_mem_localizeArrays);
+  pthread_t threads[nthreads];
+  parInitShare_t shares[nthreads];
+  unsigned char* start = (unsigned char*) p;
+  size_t numStarted = 0;
+
+  for (size_t i = 0; i < nthreads; i++) {
+    parInitShare_t* sh = &shares[i];
+    sh->nmemb = nmemb / nthreads + ((i < nmemb % nthreads) ? 1 : 0);
+    sh->start = start;
+    sh->eltSize = eltSize;
+    sh->val = val;
+    sh->touchOnly = touchOnly;
+    sh->subloc = bindThreads
+                 ? (c_sublocid_t) (i * numNumas / nthreads)
+                 : c_sublocid_none;
+    start += sh->nmemb * eltSize;
+
+    //
+    // The last share is ours.  If we can't create a thread for some
+    // other share, we do that one ourselves too.
+    //
+    if (i < nthreads - 1
+        && pthread_create(&threads[numStarted], NULL,
+                          parInitThread, sh) == 0) {
+      numStarted++;
+    } else {
+      if (touchOnly) {
+        touchPages(sh->start, sh->nmemb * eltSize);
+      } else {
+        fillElts(sh->start, sh->nmemb, eltSize, val);
+      }
+    }
+  }
+
+  for (size_t i = 0; i < numStarted; i++) {
+    (void) pthread_join(threads[i], NULL);
+  }
+}
+
+
+void chpl_mem_parallel_fill(void* p, size_t nmemb, size_t eltSize,
+                            const void* val) {
+  if (p == NULL || nmemb == 0 || eltSize == 0) {
+    return;
+  }
+  parallelInit(p, nmemb, eltSize, val, false);
+}
+
+
+void chpl_mem_parallel_touch(void* p, size_t size) {
+  if (p == NULL || size == 0) {
+    return;
+  }
+  parallelInit(p, size, 1, NULL, true);
 }
 
 
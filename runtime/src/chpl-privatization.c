@@ -22,72 +22,121 @@
 #include "chpl-privatization.h"
 #include "chpl-mem.h"
 #include "chpl-atomics.h"
+#include "error.h"
 
-static int64_t chpl_capPrivateObjects = 0;
-static atomic_spinlock_t lock;
+#include <sys/mman.h>
+
+#ifndef MAP_NORESERVE
+#define MAP_NORESERVE 0
+#endif
+
+//
+// The table is a single array whose address never changes, so the
+// compiler-generated chpl_privateObjects[pid] lookups need no locking
+// and old copies never have to be kept around.  We reserve address
+// space for the largest table we could need at startup and make it
+// usable a chunk at a time as higher pids come along.  Fresh pages are
+// zero, so new entries start out NULL.
+//
+#define PRV_CHUNK_BYTES ((int64_t) 64 * 1024)
+#define PRV_CHUNK_OBJS (PRV_CHUNK_BYTES / (int64_t) sizeof(chpl_privateObject_t))
+
+static int64_t chpl_maxPrivateObjects = 0;              // entries reserved
+static atomic_int_least64_t chpl_capPrivateObjects;     // entries usable
+static atomic_int_least64_t chpl_livePrivateObjects;    // non-NULL entries
+static atomic_spinlock_t lock;                          // held to grow
 
 chpl_privateObject_t* chpl_privateObjects = NULL;
 
 void chpl_privatization_init(void) {
+  int64_t n;
+
   atomic_init_spinlock_t(&lock);
+  atomic_init_int_least64_t(&chpl_capPrivateObjects, 0);
+  atomic_init_int_least64_t(&chpl_livePrivateObjects, 0);
+
+  // Ask for room for 2^28 objects, settling for less if address space
+  // is tight.
+  for (n = (int64_t) 1 << 28; n >= PRV_CHUNK_OBJS; n >>= 2) {
+    void* p = mmap(NULL, n * sizeof(chpl_privateObject_t), PROT_NONE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (p != MAP_FAILED) {
+      chpl_privateObjects = (chpl_privateObject_t*) p;
+      chpl_maxPrivateObjects = n;
+      break;
+    }
+  }
+
+  if (chpl_privateObjects == NULL) {
+    chpl_internal_error("cannot reserve space for privatized objects");
+  }
 }
 
 static inline int64_t max(int64_t a, int64_t b) {
   return a > b ? a : b;
 }
 
+static inline int64_t min(int64_t a, int64_t b) {
+  return a < b ? a : b;
+}
+
+// Make room for pid, at least doubling the usable part of the table.
+static void growPrivateObjects(int64_t pid) {
+  int64_t cap, newCap;
+
+  atomic_lock_spinlock_t(&lock);
+
+  cap = atomic_load_int_least64_t(&chpl_capPrivateObjects);
+  if (pid >= cap) {
+    if (pid >= chpl_maxPrivateObjects) {
+      chpl_internal_error("too many privatized objects");
+    }
+
+    newCap = (pid / PRV_CHUNK_OBJS + 1) * PRV_CHUNK_OBJS;
+    newCap = min(max(newCap, 2*cap), chpl_maxPrivateObjects);
+
+    if (mprotect(chpl_privateObjects + cap,
+                 (newCap - cap) * sizeof(chpl_privateObject_t),
+                 PROT_READ | PROT_WRITE) != 0) {
+      chpl_internal_error("cannot grow the privatized object table");
+    }
+
+    atomic_store_int_least64_t(&chpl_capPrivateObjects, newCap);
+  }
+
+  atomic_unlock_spinlock_t(&lock);
+}
+
 // Note that this function can be called in parallel and more notably it can be
 // called with non-monotonic pid's. e.g. this may be called with pid 27, and
 // then pid 2, so it has to ensure that the privatized array has at least pid+1
 // elements. Be __very__ careful if you have to update it.
+//
+// Only growing the table takes the lock.  Calls for different pids can
+// otherwise proceed in parallel; calls for the same pid are not expected
+// to race with each other or with chpl_clearPrivatizedClass.
 void chpl_newPrivatizedClass(void* v, int64_t pid) {
-  atomic_lock_spinlock_t(&lock);
+  if (pid >= atomic_load_int_least64_t(&chpl_capPrivateObjects)) {
+    growPrivateObjects(pid);
+  }
 
-  // initialize array to a default size
-  if (chpl_privateObjects == NULL) {
-    chpl_capPrivateObjects = 2*max(pid, 4);
-    chpl_privateObjects =
-        chpl_mem_allocManyZero(chpl_capPrivateObjects,
-                               sizeof(chpl_privateObject_t),
-                               CHPL_RT_MD_COMM_PRV_OBJ_ARRAY, 0, 0);
-  } else {
-    // if we're out of space, double (or more) the array size
-    if (pid >= chpl_capPrivateObjects) {
-      chpl_privateObject_t* tmp;
-      int64_t oldCap;
-
-      oldCap = chpl_capPrivateObjects;
-      chpl_capPrivateObjects = 2*max(pid, oldCap);
-
-      tmp = chpl_mem_allocManyZero(chpl_capPrivateObjects,
-                                   sizeof(chpl_privateObject_t),
-                                   CHPL_RT_MD_COMM_PRV_OBJ_ARRAY, 0, 0);
-      chpl_memcpy((void*)tmp, (void*)chpl_privateObjects,
-                  (oldCap)*sizeof(chpl_privateObject_t));
-      chpl_privateObjects = tmp;
-      // purposely leak old copies of chpl_privateObject to avoid the need to
-      // lock chpl_getPrivatizedClass; TODO: fix with lock free data structure
-    }
+  if (chpl_privateObjects[pid].obj == NULL && v != NULL) {
+    atomic_fetch_add_int_least64_t(&chpl_livePrivateObjects, 1);
+  } else if (chpl_privateObjects[pid].obj != NULL && v == NULL) {
+    atomic_fetch_sub_int_least64_t(&chpl_livePrivateObjects, 1);
   }
   chpl_privateObjects[pid].obj = v;
-
-  atomic_unlock_spinlock_t(&lock);
 }
 
 void chpl_clearPrivatizedClass(int64_t i) {
-  atomic_lock_spinlock_t(&lock);
-  chpl_privateObjects[i].obj = NULL;
-  atomic_unlock_spinlock_t(&lock);
+  if (i < atomic_load_int_least64_t(&chpl_capPrivateObjects)
+      && chpl_privateObjects[i].obj != NULL) {
+    chpl_privateObjects[i].obj = NULL;
+    atomic_fetch_sub_int_least64_t(&chpl_livePrivateObjects, 1);
+  }
 }
 
 // Used to check for leaks of privatized classes
 int64_t chpl_numPrivatizedClasses(void) {
-  int64_t ret = 0;
-  atomic_lock_spinlock_t(&lock);
-  for (int64_t i = 0; i < chpl_capPrivateObjects; i++) {
-    if (chpl_privateObjects[i].obj)
-      ret++;
-  }
-  atomic_unlock_spinlock_t(&lock);
-  return ret;
+  return atomic_load_int_least64_t(&chpl_livePrivateObjects);
 }
@@ -0,0 +1,105 @@
+/*
+ * Copyright 2020-2023 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "chplrt.h"
+#include "chpl-reduce.h"
+
+// Enough independent accumulators to fill two AVX-512 registers of
+// doubles, which also keeps the add latency hidden on narrower machines.
+#define LANES 16
+
+#define SUM_OP(acc, x) ((acc) + (x))
+#define MIN_OP(acc, x) ((x) < (acc) ? (x) : (acc))
+#define MAX_OP(acc, x) ((x) > (acc) ? (x) : (acc))
+
+// Reduces data[0..n) with OP into an 'acc_type' result, starting every
+// lane at 'init'.  The lanes are combined in a fixed order, so the result
+// does not depend on how the compiler vectorized the main loop.
+#define REDUCE_LANES(acc_type, data, n, init, OP, result) \
+  do { \
+    acc_type acc[LANES]; \
+    for (int l = 0; l < LANES; l++) acc[l] = (init); \
+    int64_t i = 0; \
+    for (; i + LANES <= (n); i += LANES) { \
+      for (int l = 0; l < LANES; l++) \
+        acc[l] = OP(acc[l], (acc_type)(data)[i + l]); \
+    } \
+    for (; i < (n); i++) acc[0] = OP(acc[0], (acc_type)(data)[i]); \
+    for (int l = 1; l < LANES; l++) acc[0] = OP(acc[0], acc[l]); \
+    result = acc[0]; \
+  } while (0)
+
+#define DEF_CHPL_REDUCE(data_type, sum_type, dot_type, min_value, \
+                        max_value) \
+data_type chpl_reduce_sum_##data_type(const data_type* data, int64_t n) { \
+  sum_type result; \
+  REDUCE_LANES(sum_type, data, n, (sum_type)0, SUM_OP, result); \
+  return (data_type)result; \
+} \
+\
+data_type chpl_reduce_min_##data_type(const data_type* data, int64_t n) { \
+  data_type result; \
+  REDUCE_LANES(data_type, data, n, (data_type)(max_value), MIN_OP, result); \
+  return result; \
+} \
+\
+data_type chpl_reduce_max_##data_type(const data_type* data, int64_t n) { \
+  data_type result; \
+  REDUCE_LANES(data_type, data, n, (data_type)(min_value), MAX_OP, result); \
+  return result; \
+} \
+\
+data_type chpl_reduce_minloc_##data_type(const data_type* data, int64_t n, \
+                                         int64_t* idx) { \
+  data_type result = chpl_reduce_min_##data_type(data, n); \
+  *idx = 0; \
+  for (int64_t i = 0; i < n; i++) { \
+    if (data[i] == result) { *idx = i; break; } \
+  } \
+  return result; \
+} \
+\
+data_type chpl_reduce_maxloc_##data_type(const data_type* data, int64_t n, \
+                                         int64_t* idx) { \
+  data_type result = chpl_reduce_max_##data_type(data, n); \
+  *idx = 0; \
+  for (int64_t i = 0; i < n; i++) { \
+    if (data[i] == result) { *idx = i; break; } \
+  } \
+  return result; \
+} \
+\
+data_type chpl_reduce_dot_##data_type(const data_type* a, \
+                                      const data_type* b, int64_t n) { \
+  dot_type acc[LANES]; \
+  for (int l = 0; l < LANES; l++) acc[l] = 0; \
+  int64_t i = 0; \
+  for (; i + LANES <= n; i += LANES) { \
+    for (int l = 0; l < LANES; l++) \
+      acc[l] += (dot_type)a[i + l] * (dot_type)b[i + l]; \
+  } \
+  for (; i < n; i++) acc[0] += (dot_type)a[i] * (dot_type)b[i]; \
+  for (int l = 1; l < LANES; l++) acc[0] += acc[l]; \
+  return (data_type)acc[0]; \
+}
+
+CHPL_REDUCE_TYPES(DEF_CHPL_REDUCE)
+
+#undef DEF_CHPL_REDUCE
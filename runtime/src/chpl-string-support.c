@@ -136,21 +136,27 @@ int string_index_of(c_string haystack, c_string needle) {
 c_string
 string_select(c_string x, int low, int high, int stride, int32_t lineno, int32_t filename) {
   char* result = NULL;
-  char* dst = NULL;
-  int size;
-  c_string src;
 
   if (low  < 1) low = 1;
   if (high < low) return NULL;
 
-  size = high - low + 1;
-  result = chpl_mem_allocMany(1, size + 1, CHPL_RT_MD_STR_SELECT_DATA,
-                              lineno, filename);
-  src = stride > 0 ? x + low - 1 : x + high - 1;
-  dst = result;
+  result = chpl_mem_allocMany(1, string_select_size(low, high, stride) + 1,
+                              CHPL_RT_MD_STR_SELECT_DATA, lineno, filename);
+  string_select_into(result, x, low, high, stride);
+  return result;
+}
+
+// Copies the bytes string_select() would select into dst, which must
+// have room for string_select_size() of them and a terminating NUL.
+// Here low must be at least 1 and high at least low.
+void
+string_select_into(char* dst, c_string x, int low, int high, int stride) {
+  const int size = high - low + 1;
+  c_string src = stride > 0 ? x + low - 1 : x + high - 1;
+
   if (stride == 1) {
-    memcpy(result, src, size);
-    dst = result + size;
+    memcpy(dst, src, size);
+    dst += size;
   } else if (stride > 0) {
     while (src - x <= high - 1) {
       *dst++ = *src;
@@ -164,7 +170,6 @@ string_select(c_string x, int low, int high, int stride, int32_t lineno, int32_t
   }
 
   *dst = '\0';
-  return result;
 }
 
 // Returns a string containing the character at the given index of the input
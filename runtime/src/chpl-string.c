@@ -47,3 +47,71 @@ uint8_t* chpl__getInPlaceBufferData(chpl__inPlaceBuffer* buf) {
 uint8_t* chpl__getInPlaceBufferDataForWrite(chpl__inPlaceBuffer* buf) {
   return chpl__getInPlaceBufferData(buf);
 }
+
+c_string
+chpl__inPlaceCopy(chpl__inPlaceBuffer* buf, c_string x,
+                  int32_t lineno, int32_t filename) {
+  size_t len;
+
+  if (x == NULL) return NULL;
+
+  if ((len = strlen(x)) >= CHPL_SHORT_STRING_SIZE)
+    return string_copy(x, lineno, filename);
+
+  memcpy(buf->data, x, len + 1);
+  return (c_string) buf->data;
+}
+
+c_string
+chpl__inPlaceConcat(chpl__inPlaceBuffer* buf, c_string x, c_string y,
+                    int32_t lineno, int32_t filename) {
+  size_t xlen;
+  size_t ylen;
+
+  if (x == NULL)
+    return chpl__inPlaceCopy(buf, y, lineno, filename);
+  if (y == NULL)
+    return chpl__inPlaceCopy(buf, x, lineno, filename);
+
+  xlen = strlen(x);
+  ylen = strlen(y);
+  if (xlen + ylen >= CHPL_SHORT_STRING_SIZE)
+    return string_concat(x, y, lineno, filename);
+
+  // buf may be where x or y are, so use memmove.
+  memmove(buf->data + xlen, y, ylen + 1);
+  memmove(buf->data, x, xlen);
+  return (c_string) buf->data;
+}
+
+c_string
+chpl__inPlaceSelect(chpl__inPlaceBuffer* buf, c_string x,
+                    int low, int high, int stride,
+                    int32_t lineno, int32_t filename) {
+  chpl__inPlaceBuffer tmp;
+
+  if (low  < 1) low = 1;
+  if (high < low) return NULL;
+
+  if (string_select_size(low, high, stride) >= CHPL_SHORT_STRING_SIZE)
+    return string_select(x, low, high, stride, lineno, filename);
+
+  // Go through tmp in case x is in buf.
+  string_select_into((char*) tmp.data, x, low, high, stride);
+  *buf = tmp;
+  return (c_string) buf->data;
+}
+
+chpl_string
+chpl__inPlaceWideCopy(chpl__inPlaceBuffer* buf, chpl____wide_chpl_string* x,
+                      int32_t lineno, int32_t filename) {
+  if (x->addr == NULL) return NULL;
+
+  if (x->size > CHPL_SHORT_STRING_SIZE)
+    return chpl_wide_string_copy(x, lineno, filename);
+
+  chpl_gen_comm_get((void *)buf->data, chpl_rt_nodeFromLocaleID(x->locale),
+                    (void *)(x->addr), x->size, CHPL_COMM_UNKNOWN_ID,
+                    lineno, filename);
+  return (chpl_string) buf->data;
+}
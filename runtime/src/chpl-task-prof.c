@@ -0,0 +1,329 @@
+/*
+ * Copyright 2020-2023 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Per-task profiling built on the tasking callbacks.  See
+// chpl-task-prof.h for how to turn it on.
+//
+// Each locale's trace file is, in native byte order:
+//
+//   header     char     magic[8]     "CHPLTPRF"
+//              uint32_t version      1
+//              int32_t  nodeID
+//              uint32_t sample       every sample'th task ID is recorded
+//              uint32_t (unused)
+//              uint64_t numRecords
+//              uint64_t numDropped   sampled tasks we couldn't record
+//   records    prof_rec_t[numRecords], times in ns since an arbitrary
+//              (per-locale) epoch
+//   filenames  uint32_t count, then for each filename index used by
+//              the records: int32_t index, uint32_t length, and that
+//              many bytes of name (no NUL)
+//
+
+#include "chplrt.h"
+
+#include "chpl-atomics.h"
+#include "chpl-comm.h"
+#include "chpl-env.h"
+#include "chpl-linefile-support.h"
+#include "chpl-mem.h"
+#include "chpl-tasks.h"
+#include "chpl-tasks-callbacks.h"
+#include "chpl-task-prof.h"
+#include "error.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/param.h>
+#include <sys/stat.h>
+
+
+chpl_bool chpl_task_prof_enabled = false;
+
+typedef struct {
+  uint64_t id;
+  uint64_t t_create;
+  uint64_t t_begin;
+  uint64_t t_end;
+  uint64_t sync_ns;              // time waiting on sync variables
+  int32_t  filename;             // creating call site
+  int32_t  lineno;
+  int32_t  fid;
+  int32_t  is_executeOn;
+} prof_rec_t;
+
+//
+// Tasks between create and end are tracked in a small table indexed by
+// task ID.  A sampled task whose slot is taken by another is dropped.
+//
+#define INFLIGHT_LEN 65536               // must be a power of 2
+
+typedef struct {
+  atomic_uint_least64_t id;              // 0: free
+  atomic_uint_least64_t sync_ns;
+  uint64_t t_create;
+  uint64_t t_begin;
+  int32_t  filename;
+  int32_t  lineno;
+  int32_t  fid;
+  int32_t  is_executeOn;
+} inflight_t;
+
+static const char* prof_dir;
+static uint64_t prof_sample;
+static inflight_t* inflight;
+static prof_rec_t* recs;
+static uint64_t maxRecs;
+static atomic_uint_least64_t numRecs;
+static atomic_uint_least64_t numDropped;
+
+static void cb_task_create(const chpl_task_cb_info_t*);
+static void cb_task_begin(const chpl_task_cb_info_t*);
+static void cb_task_end(const chpl_task_cb_info_t*);
+static void write_trace(void);
+
+
+void chpl_task_prof_init(void) {
+  prof_dir = chpl_env_rt_get("TASK_PROFILE", NULL);
+  if (prof_dir == NULL || prof_dir[0] == '\0') {
+    return;
+  }
+
+  prof_sample = chpl_env_rt_get_uint("TASK_PROFILE_SAMPLE", 1);
+  if (prof_sample == 0) {
+    prof_sample = 1;
+  }
+  maxRecs = chpl_env_rt_get_uint("TASK_PROFILE_MAX_RECORDS", 1 << 20);
+
+  inflight = chpl_mem_allocMany(INFLIGHT_LEN, sizeof(inflight[0]),
+                                CHPL_RT_MD_TASK_PROF_DATA, 0, 0);
+  for (int i = 0; i < INFLIGHT_LEN; i++) {
+    atomic_init_uint_least64_t(&inflight[i].id, 0);
+    atomic_init_uint_least64_t(&inflight[i].sync_ns, 0);
+  }
+  recs = chpl_mem_allocMany(maxRecs, sizeof(recs[0]),
+                            CHPL_RT_MD_TASK_PROF_DATA, 0, 0);
+  atomic_init_uint_least64_t(&numRecs, 0);
+  atomic_init_uint_least64_t(&numDropped, 0);
+
+  if (chpl_task_install_callback(chpl_task_cb_event_kind_create,
+                                 chpl_task_cb_info_kind_full,
+                                 cb_task_create) != 0
+      || chpl_task_install_callback(chpl_task_cb_event_kind_begin,
+                                    chpl_task_cb_info_kind_id_only,
+                                    cb_task_begin) != 0
+      || chpl_task_install_callback(chpl_task_cb_event_kind_end,
+                                    chpl_task_cb_info_kind_id_only,
+                                    cb_task_end) != 0) {
+    chpl_warning("cannot install task profiling callbacks", 0, 0);
+    return;
+  }
+
+  chpl_task_prof_enabled = true;
+}
+
+
+void chpl_task_prof_exit(void) {
+  if (!chpl_task_prof_enabled) {
+    return;
+  }
+
+  chpl_task_prof_enabled = false;
+  (void) chpl_task_uninstall_callback(chpl_task_cb_event_kind_create,
+                                      cb_task_create);
+  (void) chpl_task_uninstall_callback(chpl_task_cb_event_kind_begin,
+                                      cb_task_begin);
+  (void) chpl_task_uninstall_callback(chpl_task_cb_event_kind_end,
+                                      cb_task_end);
+
+  write_trace();
+
+  chpl_mem_free(recs, 0, 0);
+  chpl_mem_free(inflight, 0, 0);
+}
+
+
+static inline
+inflight_t* find_inflight(uint64_t id) {
+  inflight_t* slot;
+
+  if (id == 0 || id % prof_sample != 0) {
+    return NULL;
+  }
+  slot = &inflight[id & (INFLIGHT_LEN - 1)];
+  return (atomic_load_uint_least64_t(&slot->id) == id) ? slot : NULL;
+}
+
+
+static void cb_task_create(const chpl_task_cb_info_t* info) {
+  uint64_t id = info->iu.full.id;
+  uint64_t free_id = 0;
+  inflight_t* slot;
+
+  if (id == 0 || id % prof_sample != 0) {
+    return;
+  }
+
+  slot = &inflight[id & (INFLIGHT_LEN - 1)];
+  if (!atomic_compare_exchange_strong_uint_least64_t(&slot->id, &free_id,
+                                                     id)) {
+    (void) atomic_fetch_add_uint_least64_t(&numDropped, 1);
+    return;
+  }
+
+  atomic_store_uint_least64_t(&slot->sync_ns, 0);
+  slot->t_create = chpl_task_prof_now();
+  slot->t_begin = 0;
+  slot->filename = info->iu.full.filename;
+  slot->lineno = info->iu.full.lineno;
+  slot->fid = info->iu.full.fid;
+  slot->is_executeOn = info->iu.full.is_executeOn;
+}
+
+
+static void cb_task_begin(const chpl_task_cb_info_t* info) {
+  inflight_t* slot = find_inflight(info->iu.id_only.id);
+  if (slot != NULL) {
+    slot->t_begin = chpl_task_prof_now();
+  }
+}
+
+
+static void cb_task_end(const chpl_task_cb_info_t* info) {
+  inflight_t* slot = find_inflight(info->iu.id_only.id);
+  uint64_t i;
+
+  if (slot == NULL) {
+    return;
+  }
+
+  i = atomic_fetch_add_uint_least64_t(&numRecs, 1);
+  if (i < maxRecs) {
+    recs[i] = (prof_rec_t)
+              { .id           = info->iu.id_only.id,
+                .t_create     = slot->t_create,
+                .t_begin      = slot->t_begin,
+                .t_end        = chpl_task_prof_now(),
+                .sync_ns      = atomic_load_uint_least64_t(&slot->sync_ns),
+                .filename     = slot->filename,
+                .lineno       = slot->lineno,
+                .fid          = slot->fid,
+                .is_executeOn = slot->is_executeOn,
+              };
+  } else {
+    (void) atomic_fetch_add_uint_least64_t(&numDropped, 1);
+  }
+
+  atomic_store_uint_least64_t(&slot->id, 0);
+}
+
+
+void chpl_task_prof_addSyncWait(uint64_t ns) {
+  inflight_t* slot;
+
+  if (!chpl_task_prof_enabled) {
+    return;
+  }
+  if ((slot = find_inflight((uint64_t) chpl_task_getId())) != NULL) {
+    (void) atomic_fetch_add_uint_least64_t(&slot->sync_ns, ns);
+  }
+}
+
+
+static int cmp_int32(const void* a, const void* b) {
+  int32_t x = *(const int32_t*) a;
+  int32_t y = *(const int32_t*) b;
+  return (x > y) - (x < y);
+}
+
+
+static void write_trace(void) {
+  char fname[MAXPATHLEN];
+  FILE* f;
+  uint64_t n = atomic_load_uint_least64_t(&numRecs);
+  uint64_t dropped = atomic_load_uint_least64_t(&numDropped);
+  const uint32_t version = 1;
+  const uint32_t unused = 0;
+  uint32_t sample = (uint32_t) prof_sample;
+  int32_t nodeID = (int32_t) chpl_nodeID;
+  int32_t* fnames;
+  uint32_t numFnames = 0;
+
+  if (n > maxRecs) {
+    n = maxRecs;
+  }
+
+  if (mkdir(prof_dir, 0777) != 0 && errno != EEXIST) {
+    char msg[MAXPATHLEN + 100];
+    snprintf(msg, sizeof(msg), "cannot create task profile directory %s: %s",
+             prof_dir, strerror(errno));
+    chpl_warning(msg, 0, 0);
+    return;
+  }
+
+  snprintf(fname, sizeof(fname), "%s/taskprof-%d", prof_dir, (int) nodeID);
+  if ((f = fopen(fname, "wb")) == NULL) {
+    char msg[MAXPATHLEN + 100];
+    snprintf(msg, sizeof(msg), "cannot open task profile file %s: %s",
+             fname, strerror(errno));
+    chpl_warning(msg, 0, 0);
+    return;
+  }
+
+  fwrite("CHPLTPRF", 1, 8, f);
+  fwrite(&version, sizeof(version), 1, f);
+  fwrite(&nodeID, sizeof(nodeID), 1, f);
+  fwrite(&sample, sizeof(sample), 1, f);
+  fwrite(&unused, sizeof(unused), 1, f);
+  fwrite(&n, sizeof(n), 1, f);
+  fwrite(&dropped, sizeof(dropped), 1, f);
+  fwrite(recs, sizeof(recs[0]), n, f);
+
+  // filename table, for the distinct filename indices we saw
+  fnames = chpl_mem_allocMany(n + 1, sizeof(*fnames),
+                              CHPL_RT_MD_TASK_PROF_DATA, 0, 0);
+  for (uint64_t i = 0; i < n; i++) {
+    fnames[i] = recs[i].filename;
+  }
+  qsort(fnames, n, sizeof(*fnames), cmp_int32);
+  for (uint64_t i = 0; i < n; i++) {
+    if (numFnames == 0 || fnames[numFnames - 1] != fnames[i]) {
+      fnames[numFnames++] = fnames[i];
+    }
+  }
+  fwrite(&numFnames, sizeof(numFnames), 1, f);
+  for (uint32_t i = 0; i < numFnames; i++) {
+    const char* name = chpl_lookupFilename(fnames[i]);
+    uint32_t len = (name == NULL) ? 0 : (uint32_t) strlen(name);
+    fwrite(&fnames[i], sizeof(fnames[i]), 1, f);
+    fwrite(&len, sizeof(len), 1, f);
+    fwrite(name, 1, len, f);
+  }
+  chpl_mem_free(fnames, 0, 0);
+
+  if (fclose(f) != 0) {
+    char msg[MAXPATHLEN + 100];
+    snprintf(msg, sizeof(msg), "error writing task profile file %s", fname);
+    chpl_warning(msg, 0, 0);
+  }
+}
@@ -235,3 +235,11 @@ chpl_bool chpl_task_doTaskReport(void) {
 static void init_taskReport(void) {
   taskReport = chpl_env_rt_get_bool("ENABLE_TASK_REPORTING", false);
 }
+
+
+//
+// Prefer the NUMA domain holding the given memory for new tasks.
+//
+void chpl_task_setPreferredSublocByAddr(const void* addr) {
+  chpl_task_setPreferredSubloc(chpl_topo_getMemLocality((void*) addr));
+}
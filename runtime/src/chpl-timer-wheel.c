@@ -0,0 +1,210 @@
+/*
+ * Copyright 2020-2023 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// A hashed timer wheel.  See chpl-timer-wheel.h.
+//
+// Timers go in the slot for their deadline's tick, modulo the number
+// of slots, so a timer more than one turn of the wheel away shares a
+// slot with nearer ones and is skipped until its turn comes around.
+// While there are timers, the wheel's thread sleeps until the tick of
+// the next slot that has any, which costs a scan of at most one turn's
+// worth of slots.
+//
+
+#include "chplrt.h"
+
+#include "chpl-timer-wheel.h"
+#include "error.h"
+
+#include <errno.h>
+#include <pthread.h>
+
+#define WHEEL_SLOTS 1024                 // must be a power of 2
+
+static pthread_once_t wheel_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t wheel_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t wheel_cond;
+static chpl_timer_t* wheel[WHEEL_SLOTS];
+static uint64_t wheel_numTimers;
+static uint64_t wheel_tick;              // ticks before this are done
+static uint64_t wheel_wakeTick;          // when the thread will next look
+
+static inline uint64_t tick_of(uint64_t ns) {
+  return ns / CHPL_TIMER_WHEEL_TICK_NS;
+}
+
+// The first tick that starts at or after the deadline, so that a timer
+// never fires early.
+static inline uint64_t deadline_tick(uint64_t deadline) {
+  return tick_of(deadline + CHPL_TIMER_WHEEL_TICK_NS - 1);
+}
+
+static void fire(chpl_timer_t* t) {
+  while (t != NULL) {
+    // The timer's owner may free it once its callback runs.
+    chpl_timer_t* next = t->next;
+    void (*fn)(void*) = t->fn;
+    void* arg = t->arg;
+    fn(arg);
+    t = next;
+  }
+}
+
+static void* wheel_thread(void* arg) {
+  (void) arg;
+
+  pthread_mutex_lock(&wheel_lock);
+  while (1) {
+    chpl_timer_t* ready = NULL;
+    uint64_t now_tick;
+    struct timespec until;
+    uint64_t next_ns;
+
+    while (wheel_numTimers == 0) {
+      wheel_wakeTick = UINT64_MAX;
+      pthread_cond_wait(&wheel_cond, &wheel_lock);
+    }
+
+    // Collect the timers due in each tick that has passed.  If we fell
+    // a whole turn behind, one pass over the slots sees them all.
+    now_tick = tick_of(chpl_timer_wheel_now());
+    if (now_tick >= wheel_tick + WHEEL_SLOTS) {
+      wheel_tick = now_tick - (WHEEL_SLOTS - 1);
+    }
+    for ( ; wheel_tick <= now_tick; wheel_tick++) {
+      chpl_timer_t** p = &wheel[wheel_tick & (WHEEL_SLOTS - 1)];
+      while (*p != NULL) {
+        chpl_timer_t* t = *p;
+        if (deadline_tick(t->deadline) <= now_tick) {
+          *p = t->next;
+          t->next = ready;
+          ready = t;
+          wheel_numTimers--;
+        } else {
+          p = &t->next;
+        }
+      }
+    }
+
+    if (ready != NULL) {
+      pthread_mutex_unlock(&wheel_lock);
+      fire(ready);
+      pthread_mutex_lock(&wheel_lock);
+      continue;
+    }
+
+    // Sleep until the tick of the next slot with timers starts.
+    wheel_wakeTick = wheel_tick;
+    while (wheel[wheel_wakeTick & (WHEEL_SLOTS - 1)] == NULL &&
+           wheel_wakeTick < wheel_tick + WHEEL_SLOTS - 1) {
+      wheel_wakeTick++;
+    }
+    next_ns = wheel_wakeTick * CHPL_TIMER_WHEEL_TICK_NS;
+#if defined(__APPLE__)
+    {
+      // Apple has no monotonic condition variables, but can wait for
+      // a relative time.
+      uint64_t now = chpl_timer_wheel_now();
+      uint64_t ns = next_ns > now ? next_ns - now : 0;
+      until.tv_sec = ns / 1000000000;
+      until.tv_nsec = ns % 1000000000;
+      (void) pthread_cond_timedwait_relative_np(&wheel_cond, &wheel_lock,
+                                                &until);
+    }
+#else
+    until.tv_sec = next_ns / 1000000000;
+    until.tv_nsec = next_ns % 1000000000;
+    (void) pthread_cond_timedwait(&wheel_cond, &wheel_lock, &until);
+#endif
+  }
+
+  return NULL;
+}
+
+static void wheel_init(void) {
+  pthread_condattr_t attr;
+  pthread_attr_t thread_attr;
+  pthread_t thread;
+
+  pthread_condattr_init(&attr);
+#if !defined(__APPLE__)
+  // Deadlines are CLOCK_MONOTONIC, so the timed waits must be too.
+  pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+#endif
+  pthread_cond_init(&wheel_cond, &attr);
+  pthread_condattr_destroy(&attr);
+
+  wheel_tick = tick_of(chpl_timer_wheel_now());
+  wheel_wakeTick = UINT64_MAX;
+
+  pthread_attr_init(&thread_attr);
+  pthread_attr_setdetachstate(&thread_attr, PTHREAD_CREATE_DETACHED);
+  if (pthread_create(&thread, &thread_attr, wheel_thread, NULL) != 0) {
+    chpl_internal_error("cannot create the timer wheel thread");
+  }
+  pthread_attr_destroy(&thread_attr);
+}
+
+void chpl_timer_wheel_add(chpl_timer_t* t, uint64_t deadline,
+                          void (*fn)(void*), void* arg) {
+  uint64_t tick;
+
+  pthread_once(&wheel_once, wheel_init);
+
+  t->deadline = deadline;
+  t->fn = fn;
+  t->arg = arg;
+
+  pthread_mutex_lock(&wheel_lock);
+  // A deadline in a tick the wheel has already done goes in the next.
+  tick = deadline_tick(deadline);
+  if (tick < wheel_tick) {
+    tick = wheel_tick;
+  }
+  t->next = wheel[tick & (WHEEL_SLOTS - 1)];
+  wheel[tick & (WHEEL_SLOTS - 1)] = t;
+  wheel_numTimers++;
+  // Wake the wheel's thread if it would otherwise look too late.
+  if (tick < wheel_wakeTick) {
+    wheel_wakeTick = tick;
+    pthread_cond_signal(&wheel_cond);
+  }
+  pthread_mutex_unlock(&wheel_lock);
+}
+
+void chpl_timer_wheel_sleepThread(uint64_t deadline) {
+#if defined(__APPLE__)
+  uint64_t now;
+  while ((now = chpl_timer_wheel_now()) < deadline) {
+    struct timespec ts;
+    ts.tv_sec = (deadline - now) / 1000000000;
+    ts.tv_nsec = (deadline - now) % 1000000000;
+    (void) nanosleep(&ts, NULL);
+  }
+#else
+  struct timespec until;
+  until.tv_sec = deadline / 1000000000;
+  until.tv_nsec = deadline % 1000000000;
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &until, NULL)
+         == EINTR) {
+  }
+#endif
+}
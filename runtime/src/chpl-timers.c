@@ -24,7 +24,17 @@
 
 #include "chpltimers.h"
 
+#ifndef LAUNCHER
+#include "chpl-env.h"
+#endif
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
 #include <time.h>   // For struct tm.
+#if defined(__x86_64__)
+#include <cpuid.h>
+#endif
 
 _timevalue chpl_null_timevalue(void) {
   _timevalue ret;
@@ -56,3 +66,110 @@ void chpl_timevalue_parts(_timevalue t, int32_t* seconds, int32_t* minutes, int3
   if( yday ) *yday = localt.tm_yday;
   if( isdst ) *isdst = localt.tm_isdst;
 }
+
+
+#ifndef LAUNCHER
+
+chpl_bool chpl_fast_timer_use_counter = false;
+double chpl_fast_timer_ns_per_tick = 0;
+uint64_t chpl_fast_timer_base = 0;
+
+// Where chpl_fast_timer_init() started, for measuring the counter's rate.
+static uint64_t calibrate_ticks;
+static uint64_t calibrate_ns;
+static pthread_once_t calibrate_once = PTHREAD_ONCE_INIT;
+
+#if defined(__x86_64__)
+//
+// The TSC only counts time if it is invariant (doesn't change rate with
+// P-states or stop in C-states).  Whether it is also in step across
+// sockets is something the kernel checks at boot; it stops using the
+// TSC as its clock source if not, so on Linux we follow its lead.
+//
+static chpl_bool tsc_usable(void) {
+  unsigned int eax, ebx, ecx, edx;
+  if (__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) == 0
+      || eax < 0x80000007) {
+    return false;
+  }
+  __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+  if ((edx & (1 << 8)) == 0) {
+    return false;
+  }
+
+#if defined(__linux__)
+  {
+    FILE* f = fopen("/sys/devices/system/clocksource/clocksource0/"
+                    "current_clocksource", "r");
+    char buf[32] = "";
+    if (f != NULL) {
+      chpl_bool is_tsc = (fgets(buf, sizeof(buf), f) != NULL
+                          && strncmp(buf, "tsc", 3) == 0);
+      fclose(f);
+      return is_tsc;
+    }
+  }
+#endif
+  return true;
+}
+#endif
+
+void chpl_fast_timer_init(void) {
+  chpl_fast_timer_use_counter = false;
+  if (chpl_env_rt_get_bool("USE_CYCLE_COUNTER", true)) {
+#if defined(__x86_64__)
+    chpl_fast_timer_use_counter = tsc_usable();
+#elif defined(__aarch64__)
+    {
+      // The generic timer tells us its rate, so there is no need to
+      // measure it.
+      uint64_t freq;
+      __asm__ __volatile__("mrs %0, cntfrq_el0" : "=r"(freq));
+      if (freq != 0) {
+        chpl_fast_timer_use_counter = true;
+        chpl_fast_timer_ns_per_tick = 1.0e9 / (double) freq;
+      }
+    }
+#endif
+  }
+
+  if (!chpl_fast_timer_use_counter) {
+    chpl_fast_timer_ns_per_tick = 1.0;
+  }
+
+  calibrate_ns = chpl_fast_timer_monotonic_ns();
+  calibrate_ticks = chpl_fast_timer_ticks();
+  chpl_fast_timer_base = calibrate_ticks;
+}
+
+//
+// Measure the counter's rate against CLOCK_MONOTONIC over the time
+// since chpl_fast_timer_init().  This waits until first needed so that
+// run time usually makes the interval long enough to be precise for
+// free; if not, wait out the rest of CALIBRATE_MIN_NS.
+//
+#define CALIBRATE_MIN_NS 20000000
+
+static void calibrate(void) {
+  uint64_t ns;
+  uint64_t ticks;
+  double rate;
+
+  if (chpl_fast_timer_ns_per_tick != 0) {
+    return;
+  }
+
+  do {
+    ns = chpl_fast_timer_monotonic_ns();
+    ticks = chpl_fast_timer_ticks();
+  } while (ns - calibrate_ns < CALIBRATE_MIN_NS);
+
+  rate = (double) (ns - calibrate_ns) / (double) (ticks - calibrate_ticks);
+  chpl_fast_timer_ns_per_tick = rate;
+}
+
+void chpl_fast_timer_calibrate(void) {
+  (void) pthread_once(&calibrate_once, calibrate);
+}
+
+#endif // LAUNCHER
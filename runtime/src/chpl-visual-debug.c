@@ -24,11 +24,17 @@
 
 #include "chpl-visual-debug.h"
 #include "chplrt.h"
+#include "chpl-atomics.h"
 #include "chpl-comm.h"
+#include "chpl-env.h"
+#include "chpl-mem.h"
 #include "chpl-tasks.h"
 #include "chpl-tasks-callbacks.h"
 #include "chpl-comm-callbacks.h"
 #include "chpl-linefile-support.h"
+#include "chpl-thread-local-storage.h"
+#include <inttypes.h>
+#include <pthread.h>
 #include <stdint.h>
 #include <string.h>
 #include <unistd.h>
@@ -41,6 +47,7 @@
 #include <sys/stat.h>
 #include <sys/resource.h>
 #include <sys/param.h>
+#include <time.h>
 
 #include "chplcgfns.h"
 
@@ -87,8 +94,460 @@ int chpl_dprintf (int fd, const char * format, ...) {
   return -1;
 }
 
+//
+// Trace backend
+//
+// With CHPL_RT_VDEBUG_FORMAT=trace, the task, comm and on records are
+// not formatted as they happen.  Instead the callbacks append fixed-
+// size binary records to per-thread buffers, and a helper thread turns
+// the full buffers into Chrome/Perfetto trace event JSON, in the file
+// <name>.json next to each locale's text file.  The text file still
+// gets the start, tag, pause and end records, so chplvis can load the
+// pair.  If the helper can't keep up and all the buffers are in use,
+// events are dropped rather than stalling the program, and the number
+// dropped is reported in the JSON.
+//
+
+typedef enum {
+  VDB_TASK,
+  VDB_BTASK,
+  VDB_ETASK,
+  VDB_NB_PUT,
+  VDB_NB_GET,
+  VDB_PUT,
+  VDB_GET,
+  VDB_ST_PUT,
+  VDB_ST_GET,
+  VDB_FORK,
+  VDB_FORK_NB,
+  VDB_F_FORK,
+} vdb_kind_t;
+
+static const char* vdb_kind_name[] = {
+  "task", "Btask", "Etask",
+  "nb_put", "nb_get", "put", "get", "st_put", "st_get",
+  "fork", "fork_nb", "f_fork",
+};
+
+typedef struct {
+  uint64_t ns;              // CLOCK_REALTIME, as gettimeofday()
+  chpl_taskID_t task;       // task generating the event
+  chpl_taskID_t other;      // new task, for VDB_TASK
+  uint64_t addr;            // local address, or arg for forks
+  uint64_t raddr;
+  uint64_t len;             // length, or arg size for forks
+  int32_t kind;
+  int32_t node;
+  int32_t rnode;
+  int32_t a;                // elemSize, subloc, or is_executeOn
+  int32_t b;                // commID or fid
+  int32_t lineno;
+  int32_t fileno;
+} vdb_rec_t;
+
+#define VDB_BUF_RECS 4096
+
+typedef struct vdb_buf_s {
+  struct vdb_buf_s* next;   // in the free list or the full queue
+  size_t n;
+  vdb_rec_t recs[VDB_BUF_RECS];
+} vdb_buf_t;
+
+typedef struct vdb_thread_s {
+  struct vdb_thread_s* next;
+  atomic_spinlock_t lock;   // only contended at start and stop
+  vdb_buf_t* buf;
+} vdb_thread_t;
+
+static int vdb_trace = 0;
+static int vdb_trace_fd = -1;
+
+static pthread_once_t vdb_trace_once = PTHREAD_ONCE_INIT;
+CHPL_TLS_DECL(vdb_thread_t*, vdb_thread);
+
+static pthread_mutex_t vdb_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t vdb_cond = PTHREAD_COND_INITIALIZER;
+static vdb_thread_t* vdb_threads = NULL;     // all of these, under vdb_lock
+static vdb_buf_t* vdb_free = NULL;
+static vdb_buf_t* vdb_full_head = NULL;
+static vdb_buf_t* vdb_full_tail = NULL;
+static int vdb_num_bufs = 0;
+static int vdb_max_bufs;
+static int vdb_flusher_done = 0;
+static pthread_t vdb_flusher;
+static atomic_uint_least64_t vdb_dropped;
+
+
+static void vdb_trace_init_once(void) {
+  CHPL_TLS_INIT(vdb_thread);
+  atomic_init_uint_least64_t(&vdb_dropped, 0);
+}
+
+
+static vdb_thread_t* vdb_get_thread(void) {
+  vdb_thread_t* t = (vdb_thread_t*) CHPL_TLS_GET(vdb_thread);
+  if (t == NULL) {
+    if ((t = (vdb_thread_t*) chpl_calloc(1, sizeof(*t))) == NULL)
+      return NULL;
+    atomic_init_spinlock_t(&t->lock);
+    CHPL_TLS_SET(vdb_thread, t);
+    pthread_mutex_lock(&vdb_lock);
+    t->next = vdb_threads;
+    vdb_threads = t;
+    pthread_mutex_unlock(&vdb_lock);
+  }
+  return t;
+}
+
+
+// Hand a buffer to the flusher.  Called with vdb_lock held.
+static void vdb_enqueue(vdb_buf_t* b) {
+  b->next = NULL;
+  if (vdb_full_tail == NULL)
+    vdb_full_head = b;
+  else
+    vdb_full_tail->next = b;
+  vdb_full_tail = b;
+  pthread_cond_signal(&vdb_cond);
+}
+
+
+// Trade in a full buffer (or none) for an empty one, or NULL if there
+// are none left.
+static vdb_buf_t* vdb_swap_buf(vdb_buf_t* full) {
+  vdb_buf_t* b;
+
+  pthread_mutex_lock(&vdb_lock);
+  if (full != NULL)
+    vdb_enqueue(full);
+  if ((b = vdb_free) != NULL) {
+    vdb_free = b->next;
+  } else if (vdb_num_bufs < vdb_max_bufs
+             && (b = (vdb_buf_t*) chpl_malloc(sizeof(*b))) != NULL) {
+    vdb_num_bufs++;
+  }
+  pthread_mutex_unlock(&vdb_lock);
+
+  if (b != NULL)
+    b->n = 0;
+  return b;
+}
+
+
+static void vdb_trace_add(vdb_rec_t* r) {
+  struct timespec ts;
+  vdb_thread_t* t;
+  vdb_buf_t* b;
+
+  if ((t = vdb_get_thread()) == NULL) {
+    (void) atomic_fetch_add_uint_least64_t(&vdb_dropped, 1);
+    return;
+  }
+
+  (void) clock_gettime(CLOCK_REALTIME, &ts);
+  r->ns = (uint64_t) ts.tv_sec * 1000000000 + (uint64_t) ts.tv_nsec;
+  r->task = chpl_task_getId();
+
+  atomic_lock_spinlock_t(&t->lock);
+  if ((b = t->buf) == NULL || b->n == VDB_BUF_RECS)
+    b = t->buf = vdb_swap_buf(b);
+  if (b != NULL)
+    b->recs[b->n++] = *r;
+  else
+    (void) atomic_fetch_add_uint_least64_t(&vdb_dropped, 1);
+  atomic_unlock_spinlock_t(&t->lock);
+}
+
+
+// Write JSON text, flushing the staging buffer when it gets close to
+// full.  Each record is far shorter than the slack left for it.
+typedef struct {
+  char buf[1 << 16];
+  size_t n;
+} vdb_out_t;
+
+static void vdb_out_flush(vdb_out_t* o) {
+  size_t off = 0;
+  while (off < o->n) {
+    ssize_t w = write(vdb_trace_fd, o->buf + off, o->n - off);
+    if (w < 0) {
+      if (errno == EINTR)
+        continue;
+      break;
+    }
+    off += w;
+  }
+  o->n = 0;
+}
+
+static void vdb_out_printf(vdb_out_t* o, const char* format, ...)
+#ifdef __GNUC__
+      __attribute__ ((format (printf, 2, 3)))
+#endif
+  ;
+
+static void vdb_out_printf(vdb_out_t* o, const char* format, ...) {
+  va_list ap;
+  int len;
+
+  if (o->n > sizeof(o->buf) - 2048)
+    vdb_out_flush(o);
+  va_start(ap, format);
+  len = vsnprintf(o->buf + o->n, sizeof(o->buf) - o->n, format, ap);
+  va_end(ap);
+  if (len > 0)
+    o->n += MIN((size_t) len, sizeof(o->buf) - o->n - 1);
+}
+
+// Source location for the trace viewer, with JSON string escaping.
+static void vdb_out_src(vdb_out_t* o, int32_t fileno, int32_t lineno) {
+  const char* fn = (fileno >= 0 && fileno < chpl_filenameTableSize)
+                   ? chpl_lookupFilename(fileno) : "";
+  vdb_out_printf(o, ",\"src\":\"");
+  for (int i = 0; fn[i] != '\0' && i < 512; i++) {
+    if (fn[i] == '"' || fn[i] == '\\')
+      o->buf[o->n++] = '\\';
+    if ((unsigned char) fn[i] >= ' ')
+      o->buf[o->n++] = fn[i];
+  }
+  vdb_out_printf(o, ":%d\"", lineno);
+}
+
+static void vdb_out_rec(vdb_out_t* o, const vdb_rec_t* r) {
+  char tbuf[CHPL_TASK_ID_STRING_MAX_LEN];
+  char obuf[CHPL_TASK_ID_STRING_MAX_LEN];
+  const char* name = vdb_kind_name[r->kind];
+  uint64_t us = r->ns / 1000;
+  unsigned frac = (unsigned) (r->ns % 1000);
+
+  switch ((vdb_kind_t) r->kind) {
+  case VDB_TASK:
+    vdb_out_printf(o,
+                   "{\"name\":\"create\",\"cat\":\"task\",\"ph\":\"i\","
+                   "\"s\":\"t\",\"ts\":%" PRIu64 ".%03u,\"pid\":%d,"
+                   "\"tid\":%s,\"args\":{\"task\":%s,\"on\":%d,"
+                   "\"line\":%d,\"file\":%d,\"fid\":%d",
+                   us, frac, r->node, TID_STRING(tbuf, r->task),
+                   TID_STRING(obuf, r->other), r->a, r->lineno, r->fileno,
+                   r->b);
+    vdb_out_src(o, r->fileno, r->lineno);
+    vdb_out_printf(o, "}},\n");
+    break;
+
+  case VDB_BTASK:
+  case VDB_ETASK:
+    vdb_out_printf(o,
+                   "{\"name\":\"task\",\"cat\":\"task\",\"ph\":\"%s\","
+                   "\"ts\":%" PRIu64 ".%03u,\"pid\":%d,\"tid\":%s},\n",
+                   (r->kind == VDB_BTASK) ? "B" : "E", us, frac, r->node,
+                   TID_STRING(obuf, r->other));
+    break;
+
+  case VDB_NB_PUT:
+  case VDB_NB_GET:
+  case VDB_PUT:
+  case VDB_GET:
+  case VDB_ST_PUT:
+  case VDB_ST_GET:
+    vdb_out_printf(o,
+                   "{\"name\":\"%s\",\"cat\":\"comm\",\"ph\":\"i\","
+                   "\"s\":\"t\",\"ts\":%" PRIu64 ".%03u,\"pid\":%d,"
+                   "\"tid\":%s,\"args\":{\"remote\":%d,"
+                   "\"addr\":\"%#" PRIx64 "\",\"raddr\":\"%#" PRIx64 "\","
+                   "\"elemSize\":%d,\"len\":%" PRIu64 ",\"commID\":%d,"
+                   "\"line\":%d,\"file\":%d",
+                   name, us, frac, r->node, TID_STRING(tbuf, r->task),
+                   r->rnode, r->addr, r->raddr, r->a, r->len, r->b,
+                   r->lineno, r->fileno);
+    vdb_out_src(o, r->fileno, r->lineno);
+    vdb_out_printf(o, "}},\n");
+    break;
+
+  case VDB_FORK:
+  case VDB_FORK_NB:
+  case VDB_F_FORK:
+    vdb_out_printf(o,
+                   "{\"name\":\"%s\",\"cat\":\"on\",\"ph\":\"i\","
+                   "\"s\":\"t\",\"ts\":%" PRIu64 ".%03u,\"pid\":%d,"
+                   "\"tid\":%s,\"args\":{\"remote\":%d,\"subloc\":%d,"
+                   "\"fid\":%d,\"arg\":\"%#" PRIx64 "\","
+                   "\"argSize\":%" PRIu64 ",\"line\":%d,\"file\":%d",
+                   name, us, frac, r->node, TID_STRING(tbuf, r->task),
+                   r->rnode, r->a, r->b, r->addr, r->len, r->lineno,
+                   r->fileno);
+    vdb_out_src(o, r->fileno, r->lineno);
+    vdb_out_printf(o, "}},\n");
+    break;
+  }
+}
+
+
+static void* vdb_flusher_main(void* arg) {
+  vdb_out_t* o = (vdb_out_t*) arg;
+
+  pthread_mutex_lock(&vdb_lock);
+  for (;;) {
+    vdb_buf_t* b;
+
+    while (vdb_full_head == NULL && !vdb_flusher_done)
+      pthread_cond_wait(&vdb_cond, &vdb_lock);
+    if ((b = vdb_full_head) == NULL)
+      break;
+    if ((vdb_full_head = b->next) == NULL)
+      vdb_full_tail = NULL;
+    pthread_mutex_unlock(&vdb_lock);
+
+    for (size_t i = 0; i < b->n; i++)
+      vdb_out_rec(o, &b->recs[i]);
+    vdb_out_flush(o);
+
+    pthread_mutex_lock(&vdb_lock);
+    b->next = vdb_free;
+    vdb_free = b;
+  }
+  pthread_mutex_unlock(&vdb_lock);
+
+  return NULL;
+}
+
+
+static int vdb_trace_start(const char* fname) {
+  static vdb_out_t out;
+  char jname[MAXPATHLEN];
+  vdb_thread_t* t;
+
+  (void) pthread_once(&vdb_trace_once, vdb_trace_init_once);
+
+  snprintf(jname, sizeof(jname), "%s.json", fname);
+  vdb_trace_fd = open(jname, O_WRONLY|O_CREAT|O_TRUNC, 0666);
+  if (vdb_trace_fd < 0) {
+    fprintf(stderr, "Visual Debug failed to open %s: %s\n",
+            jname, strerror(errno));
+    return -1;
+  }
+
+  out.n = 0;
+  vdb_out_printf(&out, "[\n{\"name\":\"process_name\",\"ph\":\"M\","
+                 "\"pid\":%d,\"args\":{\"name\":\"locale %d\"}},\n",
+                 chpl_nodeID, chpl_nodeID);
+  vdb_out_flush(&out);
+
+  // Drop anything recorded by callbacks that raced the last stop.
+  pthread_mutex_lock(&vdb_lock);
+  for (t = vdb_threads; t != NULL; t = t->next) {
+    atomic_lock_spinlock_t(&t->lock);
+    if (t->buf != NULL)
+      t->buf->n = 0;
+    atomic_unlock_spinlock_t(&t->lock);
+  }
+  vdb_flusher_done = 0;
+  pthread_mutex_unlock(&vdb_lock);
+  atomic_store_uint_least64_t(&vdb_dropped, 0);
+
+  vdb_max_bufs = (int) chpl_env_rt_get_int("VDEBUG_TRACE_BUFFERS", 64);
+  if (vdb_max_bufs < 1)
+    vdb_max_bufs = 1;
+
+  if (pthread_create(&vdb_flusher, NULL, vdb_flusher_main, &out) != 0) {
+    fprintf(stderr, "Visual Debug failed to start its trace thread\n");
+    close(vdb_trace_fd);
+    vdb_trace_fd = -1;
+    return -1;
+  }
+
+  vdb_trace = 1;
+  return 0;
+}
+
+
+static void vdb_trace_stop(void) {
+  char buf[200];
+  vdb_thread_t* t;
+  uint64_t dropped;
+  int len;
+
+  if (vdb_trace_fd < 0)
+    return;
+  vdb_trace = 0;
+
+  // Collect the partly filled buffers, then let the flusher finish.
+  pthread_mutex_lock(&vdb_lock);
+  for (t = vdb_threads; t != NULL; t = t->next) {
+    atomic_lock_spinlock_t(&t->lock);
+    if (t->buf != NULL && t->buf->n > 0) {
+      vdb_enqueue(t->buf);
+      t->buf = NULL;
+    }
+    atomic_unlock_spinlock_t(&t->lock);
+  }
+  vdb_flusher_done = 1;
+  pthread_cond_signal(&vdb_cond);
+  pthread_mutex_unlock(&vdb_lock);
+  (void) pthread_join(vdb_flusher, NULL);
+
+  dropped = atomic_load_uint_least64_t(&vdb_dropped);
+  len = snprintf(buf, sizeof(buf),
+                 "{\"name\":\"dropped\",\"ph\":\"M\",\"pid\":%d,"
+                 "\"args\":{\"events\":%" PRIu64 "}}\n]\n",
+                 chpl_nodeID, dropped);
+  if (write(vdb_trace_fd, buf, len) != len) { /* nothing to do */ }
+  close(vdb_trace_fd);
+  vdb_trace_fd = -1;
+
+  if (dropped > 0)
+    fprintf(stderr, "Visual Debug dropped %" PRIu64 " trace events on "
+            "locale %d; set CHPL_RT_VDEBUG_TRACE_BUFFERS higher than %d\n",
+            dropped, chpl_nodeID, vdb_max_bufs);
+}
+
+
+static void vdb_trace_comm(vdb_kind_t kind, const chpl_comm_cb_info_t* info) {
+  const struct chpl_comm_info_comm *cm = &info->iu.comm;
+  vdb_rec_t r = { .kind = kind,
+                  .node = info->localNodeID, .rnode = info->remoteNodeID,
+                  .addr = (uint64_t) (uintptr_t) cm->addr,
+                  .raddr = (uint64_t) (uintptr_t) cm->raddr,
+                  .a = 1, .len = cm->size, .b = cm->commID,
+                  .lineno = cm->lineno, .fileno = cm->filename };
+  vdb_trace_add(&r);
+}
+
+static void vdb_trace_comm_strd(vdb_kind_t kind,
+                                const chpl_comm_cb_info_t* info) {
+  const struct chpl_comm_info_comm_strd *cm = &info->iu.comm_strd;
+  vdb_rec_t r = { .kind = kind,
+                  .node = info->localNodeID, .rnode = info->remoteNodeID,
+                  .a = cm->elemSize, .len = 1, .b = cm->commID,
+                  .lineno = cm->lineno, .fileno = cm->filename };
+  for (int32_t i = 0; i < cm->stridelevels; i++) {
+    r.len *= cm->count[i];
+  }
+  // Same address order as the text records.
+  if (kind == VDB_ST_PUT) {
+    r.addr = (uint64_t) (uintptr_t) cm->srcaddr;
+    r.raddr = (uint64_t) (uintptr_t) cm->dstaddr;
+  } else {
+    r.addr = (uint64_t) (uintptr_t) cm->dstaddr;
+    r.raddr = (uint64_t) (uintptr_t) cm->srcaddr;
+  }
+  vdb_trace_add(&r);
+}
+
+static void vdb_trace_fork(vdb_kind_t kind, const chpl_comm_cb_info_t* info) {
+  const struct chpl_comm_info_comm_executeOn *cm = &info->iu.executeOn;
+  vdb_rec_t r = { .kind = kind,
+                  .node = info->localNodeID, .rnode = info->remoteNodeID,
+                  .a = cm->subloc, .b = cm->fid,
+                  .addr = (uint64_t) (uintptr_t) cm->arg,
+                  .len = cm->arg_size,
+                  .lineno = cm->lineno, .fileno = cm->filename };
+  vdb_trace_add(&r);
+}
+
+
 static int chpl_make_vdebug_file (const char *rootname) {
     char fname[MAXPATHLEN];
+    const char *format;
     struct stat sb;
 
     chpl_vdebug = 0;
@@ -115,6 +574,14 @@ static int chpl_make_vdebug_file (const char *rootname) {
       return -1;
     }
 
+    // The trace backend is optional; on failure we just use text.
+    format = chpl_env_rt_get("VDEBUG_FORMAT", "text");
+    if (strcmp(format, "trace") == 0) {
+      (void) vdb_trace_start(fname);
+    } else if (strcmp(format, "text") != 0) {
+      fprintf (stderr, "CHPL_RT_VDEBUG_FORMAT must be 'text' or 'trace'.\n");
+    }
+
     return 0;
 }
 
@@ -210,6 +677,9 @@ void chpl_vdebug_stop (void) {
   chpl_vdebug = 0;
   uninstall_callbacks();
 
+  // Finish any trace before the End record, which chplvis reads last
+  vdb_trace_stop();
+
   // Now log the stop
   if (chpl_vdebug_fd >= 0) {
     (void) gettimeofday (&tv, NULL);
@@ -310,6 +780,10 @@ void chpl_vdebug_pause (int tagno) {
 //
 
 void cb_comm_put_nb (const chpl_comm_cb_info_t *info) {
+  if (chpl_vdebug && vdb_trace) {
+    vdb_trace_comm(VDB_NB_PUT, info);
+    return;
+  }
   if (chpl_vdebug) {
     struct timeval tv;
     const struct chpl_comm_info_comm *cm = &info->iu.comm;
@@ -331,6 +805,10 @@ void cb_comm_put_nb (const chpl_comm_cb_info_t *info) {
 // Note: dstNodeId is node requesting Get
 
 void cb_comm_get_nb (const chpl_comm_cb_info_t *info) {
+  if (chpl_vdebug && vdb_trace) {
+    vdb_trace_comm(VDB_NB_GET, info);
+    return;
+  }
   if (chpl_vdebug) {
     struct timeval tv;
     const struct chpl_comm_info_comm *cm = &info->iu.comm;
@@ -351,6 +829,10 @@ void cb_comm_get_nb (const chpl_comm_cb_info_t *info) {
 
 
 void cb_comm_put (const chpl_comm_cb_info_t *info) {
+  if (chpl_vdebug && vdb_trace) {
+    vdb_trace_comm(VDB_PUT, info);
+    return;
+  }
   if (chpl_vdebug) {
     struct timeval tv;
     const struct chpl_comm_info_comm *cm = &info->iu.comm;
@@ -372,6 +854,10 @@ void cb_comm_put (const chpl_comm_cb_info_t *info) {
 // Note:  dstNodeId is for the node making the request
 
 void cb_comm_get (const chpl_comm_cb_info_t *info) {
+  if (chpl_vdebug && vdb_trace) {
+    vdb_trace_comm(VDB_GET, info);
+    return;
+  }
   if (chpl_vdebug) {
     struct timeval tv;
     const struct chpl_comm_info_comm *cm = &info->iu.comm;
@@ -391,6 +877,10 @@ void cb_comm_get (const chpl_comm_cb_info_t *info) {
 //                  length lineNumber fileName
 
 void cb_comm_put_strd (const chpl_comm_cb_info_t *info) {
+  if (chpl_vdebug && vdb_trace) {
+    vdb_trace_comm_strd(VDB_ST_PUT, info);
+    return;
+  }
     if (chpl_vdebug) {
     struct timeval tv;
     size_t length;
@@ -421,6 +911,10 @@ void cb_comm_put_strd (const chpl_comm_cb_info_t *info) {
 // Note:  dstNode is node making request for get
 
 void cb_comm_get_strd (const chpl_comm_cb_info_t *info) {
+  if (chpl_vdebug && vdb_trace) {
+    vdb_trace_comm_strd(VDB_ST_GET, info);
+    return;
+  }
   if (chpl_vdebug) {
     struct timeval tv;
     size_t length;
@@ -447,6 +941,10 @@ void cb_comm_get_strd (const chpl_comm_cb_info_t *info) {
 // Record>  fork: time.sec nodeId forkNodeId subLoc funcId arg argSize forkTaskId lineNumber fileName
 
 void cb_comm_executeOn (const chpl_comm_cb_info_t *info) {
+  if (chpl_vdebug && vdb_trace) {
+    vdb_trace_fork(VDB_FORK, info);
+    return;
+  }
 
   // Visual Debug Support
   if (chpl_vdebug) {
@@ -468,6 +966,10 @@ void cb_comm_executeOn (const chpl_comm_cb_info_t *info) {
 
 
 void  cb_comm_executeOn_nb (const chpl_comm_cb_info_t *info) {
+  if (chpl_vdebug && vdb_trace) {
+    vdb_trace_fork(VDB_FORK_NB, info);
+    return;
+  }
   if (chpl_vdebug) {
     const struct chpl_comm_info_comm_executeOn *cm = &info->iu.executeOn;
     chpl_taskID_t executeOnTask = chpl_task_getId();
@@ -485,6 +987,10 @@ void  cb_comm_executeOn_nb (const chpl_comm_cb_info_t *info) {
 // Record>  f_fork: time.sec nodeId forkNodeId subLoc funcId arg argSize forkTaskId lineNumber fileName
 
 void cb_comm_executeOn_fast (const chpl_comm_cb_info_t *info) {
+  if (chpl_vdebug && vdb_trace) {
+    vdb_trace_fork(VDB_F_FORK, info);
+    return;
+  }
   if (chpl_vdebug) {
     const struct chpl_comm_info_comm_executeOn *cm = &info->iu.executeOn;
     chpl_taskID_t executeOnTask = chpl_task_getId();
@@ -601,6 +1107,15 @@ int uninstall_callbacks (void) {
 void cb_task_create (const chpl_task_cb_info_t *info) {
   struct timeval tv;
   if (!chpl_vdebug) return;
+  if (vdb_trace) {
+    vdb_rec_t r = { .kind = VDB_TASK, .node = info->nodeID,
+                    .other = info->iu.full.id,
+                    .a = info->iu.full.is_executeOn, .b = info->iu.full.fid,
+                    .lineno = info->iu.full.lineno,
+                    .fileno = info->iu.full.filename };
+    vdb_trace_add(&r);
+    return;
+  }
   if (chpl_vdebug_fd >= 0) {
     chpl_taskID_t taskId = chpl_task_getId();
     char buff[CHPL_TASK_ID_STRING_MAX_LEN];
@@ -624,6 +1139,12 @@ void cb_task_create (const chpl_task_cb_info_t *info) {
 void cb_task_begin (const chpl_task_cb_info_t *info) {
   struct timeval tv;
   if (!chpl_vdebug) return;
+  if (vdb_trace) {
+    vdb_rec_t r = { .kind = VDB_BTASK, .node = info->nodeID,
+                    .other = info->iu.full.id };
+    vdb_trace_add(&r);
+    return;
+  }
   if (chpl_vdebug_fd >= 0) {
     (void)gettimeofday(&tv, NULL);
     chpl_dprintf (chpl_vdebug_fd, "Btask: %lld.%06ld %lld %lu\n",
@@ -638,6 +1159,12 @@ void cb_task_begin (const chpl_task_cb_info_t *info) {
 void cb_task_end (const chpl_task_cb_info_t *info) {
   struct timeval tv;
   if (!chpl_vdebug) return;
+  if (vdb_trace) {
+    vdb_rec_t r = { .kind = VDB_ETASK, .node = info->nodeID,
+                    .other = info->iu.id_only.id };
+    vdb_trace_add(&r);
+    return;
+  }
   if (chpl_vdebug_fd >= 0) {
     (void)gettimeofday(&tv, NULL);
     chpl_dprintf (chpl_vdebug_fd, "Etask: %lld.%06ld %lld %lu\n",
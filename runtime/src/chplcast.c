@@ -50,6 +50,32 @@ static int scanningNCounts(void) {
   return answer;
 }
 
+/* strtoull, with a quick loop for the common case of a decimal number
+   short enough that it can't overflow (19 digits always fit in 64 bits) */
+static unsigned long long parseUnsigned(const char* str, char** endPtr,
+                                        int numberBase) {
+  if (numberBase == 10 && isdigit(str[0])) {
+    const char* p = str;
+    unsigned long long val = 0;
+    while (p - str < 19 && isdigit(*p)) {
+      val = val*10 + (*p - '0');
+      p++;
+    }
+    if (!isdigit(*p)) {
+      *endPtr = (char*)p;
+      return val;
+    }
+  }
+  return strtoull(str, endPtr, numberBase);
+}
+
+/* Returns true if 'str' is all whitespace. */
+static int onlySpaceLeft(const char* str) {
+  while (*str && isspace(*str))
+    str++;
+  return *str == '\0';
+}
+
 static int illegalFirstUnsChar(char c) {
   return (c == '-');
 }
@@ -77,7 +103,7 @@ static int illegalFirstUnsChar(char c) {
     } else if (str[0] == '+') {                                         \
       str++;                                                            \
     }                                                                   \
-    if (strlen(str) >= 2 && str[0] == '0') {                            \
+    if (str[0] == '0' && str[1] != '\0') {                               \
       if (str[1] == 'b' || str[1] == 'B') {                             \
         numberBase = 2;                                                 \
         str += 2;                                                       \
@@ -101,7 +127,7 @@ static int illegalFirstUnsChar(char c) {
       *invalidCh = *str;                                                \
       return -1;                                                        \
     }                                                                   \
-    val = (_type(base, width))strtoull(str, &endPtr, numberBase);  \
+    val = (_type(base, width))parseUnsigned(str, &endPtr, numberBase);  \
     if (negative) {                                                     \
       val = -1*val;                                                     \
     }                                                                   \
@@ -141,15 +167,26 @@ chpl_bool c_string_to_chpl_bool(c_string str, chpl_bool* err, int lineno, int32_
 
 #define _real_type(base, width) _##base##width
 
-#define _define_string_to_float_precise(base, width, format)            \
+/* Well-formed numbers are converted with strtod/strtof, which accept
+   the same text as scanf but don't interpret a format string on every
+   call. Anything else goes through sscanf as before, so that malformed
+   input is reported the same way. */
+#define _define_string_to_float_precise(base, width, format, strtoX)    \
   _real_type(base, width) c_string_to_##base##width##_precise(c_string str, \
                                                               int* invalid,   \
                                                               char* invalidCh) { \
     _real_type(base, width) val;                                        \
+    char* endPtr;                                                       \
     int numbytes;                                                       \
     int numitems;                                                       \
     while (*str && isspace(*str))                                       \
       str++;                                                            \
+    val = strtoX(str, &endPtr);                                         \
+    if (endPtr != str && onlySpaceLeft(endPtr)) {                       \
+      *invalid = 0;                                                     \
+      *invalidCh = '\0';                                                \
+      return val;                                                       \
+    }                                                                   \
     numitems = sscanf(str, format"%n", &val, &numbytes);                \
     if (scanningNCounts() && numitems == 2) {                           \
       numitems = 1;                                                     \
@@ -171,19 +208,26 @@ chpl_bool c_string_to_chpl_bool(c_string str, chpl_bool* err, int lineno, int32_
     return val;                                                         \
   }
 
-_define_string_to_float_precise(real, 32, "%f")
-_define_string_to_float_precise(real, 64, "%lf")
+_define_string_to_float_precise(real, 32, "%f", strtof)
+_define_string_to_float_precise(real, 64, "%lf", strtod)
 
-#define _define_string_to_imag_precise(base, width, format)             \
+#define _define_string_to_imag_precise(base, width, format, strtoX)     \
   _real_type(base, width) c_string_to_##base##width##_precise(c_string str, \
                                                               int* invalid,   \
                                                               char* invalidCh) { \
     _real_type(base, width) val;                                        \
+    char* endPtr;                                                       \
     int numbytes;                                                       \
     char i = '\0';                                                      \
     int numitems;                                                       \
     while (*str && isspace(*str))                                       \
       str++;                                                            \
+    val = strtoX(str, &endPtr);                                         \
+    if (endPtr != str && *endPtr == 'i' && onlySpaceLeft(endPtr+1)) {   \
+      *invalid = 0;                                                     \
+      *invalidCh = '\0';                                                \
+      return val;                                                       \
+    }                                                                   \
     numitems = sscanf(str, format"%c%n", &val, &i, &numbytes);          \
     if (scanningNCounts() && numitems == 3) {                           \
       numitems = 2;                                                     \
@@ -213,8 +257,8 @@ _define_string_to_float_precise(real, 64, "%lf")
   }
 
 
-_define_string_to_imag_precise(imag, 32, "%f")
-_define_string_to_imag_precise(imag, 64, "%lf")
+_define_string_to_imag_precise(imag, 32, "%f", strtof)
+_define_string_to_imag_precise(imag, 64, "%lf", strtod)
 
 
 
@@ -359,29 +403,50 @@ _define_string_to_real_type(complex, 64)
 _define_string_to_real_type(complex, 128)
 
 
+/* Writes the decimal digits of 'u', preceded by a '-' if 'negative',
+   so that they end just before 'end'. Returns where they start. */
+static char* formatDecimal(char* end, uint64_t u, int negative) {
+  char* p = end;
+  do {
+    *--p = '0' + (u % 10);
+    u /= 10;
+  } while (u != 0);
+  if (negative)
+    *--p = '-';
+  return p;
+}
+
 c_string
 integral_to_c_string(int64_t x, uint32_t size, chpl_bool isSigned, chpl_bool* err)
 {
-  char buffer[256];
-  const char* format = "";
+  char buffer[32];
+  char* end = buffer + sizeof(buffer) - 1;
+  int64_t sval = 0;
+  uint64_t uval = 0;
   enum {UNSIGNED = 0<<16, SIGNED = 1<<16 };
+  *end = '\0';
+  /* Widths below 64 bits print the low 32 bits, as the %d and %u formats
+     these used to go through did. */
   switch (SIGNED * isSigned + size)
   {
    default:
     *err = true;
-    break;
-
-   case UNSIGNED + 1: format = "%" PRIu8;  break;
-   case UNSIGNED + 2: format = "%" PRIu16; break;
-   case UNSIGNED + 4: format = "%" PRIu32; break;
-   case UNSIGNED + 8: format = "%" PRIu64; break;
-   case   SIGNED + 1: format = "%" PRId8;  break;
-   case   SIGNED + 2: format = "%" PRId16; break;
-   case   SIGNED + 4: format = "%" PRId32; break;
-   case   SIGNED + 8: format = "%" PRId64; break;
+    return string_copy(end, 0, 0);
+
+   case UNSIGNED + 1:
+   case UNSIGNED + 2:
+   case UNSIGNED + 4: uval = (uint32_t)x; break;
+   case UNSIGNED + 8: uval = (uint64_t)x; break;
+   case   SIGNED + 1:
+   case   SIGNED + 2:
+   case   SIGNED + 4: sval = (int32_t)x;  break;
+   case   SIGNED + 8: sval = x;           break;
+  }
+  if (isSigned) {
+    /* negate as unsigned so that INT64_MIN works */
+    uval = sval < 0 ? -(uint64_t)sval : (uint64_t)sval;
   }
-  snprintf(buffer, sizeof(buffer), format, x);
-  return string_copy(buffer, 0, 0);
+  return string_copy(formatDecimal(end, uval, isSigned && sval < 0), 0, 0);
 }
 
 /*
@@ -413,6 +478,15 @@ real_to_c_string(_real64 x, chpl_bool isImag)
     } else {
       return string_copy(POSINFSTRING, 0, 0);
     }
+  } else if (fabs(x) < 1e6 && x == (int64_t)x && !(x == 0 && signbit(x))) {
+    /* %lg prints these as just their integer digits, which ensureDecimal
+       would follow with ".0"; skip the formatted print for them. */
+    char buffer[32];
+    char* end = buffer + sizeof(buffer) - 4;
+    int64_t ival = (int64_t)x;
+    char* start = formatDecimal(end, ival < 0 ? -ival : ival, ival < 0);
+    strcpy(end, isImag ? ".0i" : ".0");
+    return string_copy(start, 0, 0);
   } else {
     char buffer[256];
     char* last;
@@ -22,8 +22,12 @@
 
 #include "chpl_rt_utils_static.h"
 #include "chpl-comm.h"
+#include "chpl-comm-diags.h"
+#include "chpl-fn-prof.h"
+#include "chpl-gpu-timeline.h"
 #include "chplexit.h"
 #include "chpl-mem.h"
+#include "chpl-task-prof.h"
 #include "chplmemtrack.h"
 #include "chpl-topo.h"
 #include "gdb.h"
@@ -45,6 +49,12 @@ static void chpl_exit_common(int status, int all) {
 void chpl_finalize(int status, int all) {
   chpl_comm_pre_task_exit(all);
   if (all) {
+    chpl_comm_diags_callsite_exit();
+    chpl_task_prof_exit();
+    chpl_fn_prof_finalize();
+#ifdef HAS_GPU_LOCALE
+    chpl_gpu_timeline_exit();
+#endif
     chpl_task_exit();
     chpl_reportMemInfo();
   }
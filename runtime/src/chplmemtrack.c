@@ -21,7 +21,10 @@
 #include "chplrt.h"
 
 #include "chplmemtrack.h"
+#include "chpl-atomics.h"
+#include "chpl-env.h"
 #include "chpl-mem.h"
+#include "chpl-mem-arena.h"
 #include "chpl-mem-desc.h"
 #include "chpl-mem-sys.h"  // mem layer not initialized yet, need system alloc
 #include "chpl-tasks.h"
@@ -30,6 +33,7 @@
 #include "chpl-comm-internal.h"
 #include "chplcgfns.h"
 #include "chpl-linefile-support.h"
+#include "chpl-thread-local-storage.h"
 #include "config.h"
 #include "error.h"
 
@@ -73,6 +77,7 @@ typedef struct memTableEntry_struct { /* table entry */
   void* memAlloc;
   int32_t lineno;
   int32_t filename;
+  size_t weight;   // bytes this entry stands for; more if sampling
   struct memTableEntry_struct* nextInBucket;
 } memTableEntry;
 
@@ -129,6 +134,175 @@ void memTrack_unlock(void) {
 }
 
 
+//
+// Sampling.  With CHPL_RT_MEM_TRACK_SAMPLE_BYTES=B (on average, one
+// sample per B bytes allocated, as tcmalloc does) or
+// CHPL_RT_MEM_TRACK_SAMPLE_EVERY=N (every Nth allocation), only the
+// sampled allocations go into the table, each standing for the bytes
+// it statistically represents.  So the current and high water totals
+// and the leak reports are estimates.  The number and bytes of the
+// allocations of each type stay exact; each thread counts those in
+// its own buffer, and reports merge the buffers.  The per-buffer lock
+// is only ever contended by a report.  Buffers outlive their threads.
+//
+// Frees have to find out whether what they free was sampled without
+// taking the table lock.  A counting filter over addresses, bumped for
+// each sampled entry in the table, tells them whether it might be.
+//
+typedef struct memTrackThread_s {
+  struct memTrackThread_s* next;        // in memTrackThreads
+  atomic_spinlock_t lock;
+  size_t* descCounts;                   // number, bytes for each type
+  size_t allocated;
+  int64_t untilSample;                  // bytes or allocations
+  uint64_t rng;
+} memTrackThread_t;
+
+static size_t sampleBytes = 0;
+static size_t sampleEvery = 0;
+static chpl_bool memSampling = false;
+
+CHPL_TLS_DECL(memTrackThread_t*, memTrackThread);
+
+static pthread_mutex_t memTrackThreads_lock = PTHREAD_MUTEX_INITIALIZER;
+static memTrackThread_t* memTrackThreads = NULL;
+
+#define SAMPLED_FILTER_BITS 16
+static atomic_uint_least32_t sampledFilter[1 << SAMPLED_FILTER_BITS];
+
+static inline
+size_t sampledFilterIdx(void* memAlloc) {
+  uint64_t h = (uint64_t) (uintptr_t) memAlloc;
+  h *= UINT64_C(0x9e3779b97f4a7c15);
+  return (size_t) (h >> (64 - SAMPLED_FILTER_BITS));
+}
+
+static inline
+chpl_bool mightBeSampled(void* memAlloc) {
+  return atomic_load_uint_least32_t(&sampledFilter[sampledFilterIdx(memAlloc)])
+         != 0;
+}
+
+
+// Uniform in (0, 1].
+static inline
+double nextRandom(memTrackThread_t* t) {
+  t->rng ^= t->rng << 13;
+  t->rng ^= t->rng >> 7;
+  t->rng ^= t->rng << 17;
+  return ((double) (t->rng >> 11) + 1.0) / 9007199254740992.0;
+}
+
+
+static
+int64_t nextSampleInterval(memTrackThread_t* t) {
+  if (sampleBytes > 0) {
+    // Exponentially distributed, so sampling is a Poisson process over
+    // allocated bytes.
+    return (int64_t) (-log(nextRandom(t)) * (double) sampleBytes) + 1;
+  }
+  return (int64_t) sampleEvery;
+}
+
+
+static
+memTrackThread_t* getMemTrackThread(void) {
+  memTrackThread_t* t;
+
+  if ((t = (memTrackThread_t*) CHPL_TLS_GET(memTrackThread)) == NULL) {
+    //
+    // Use the system allocator, so as not to track ourselves.
+    //
+    const int numEntries = CHPL_RT_MD_NUM+chpl_mem_numDescs;
+    if ((t = (memTrackThread_t*) sys_calloc(1, sizeof(*t))) == NULL) {
+      return NULL;
+    }
+    if ((t->descCounts = (size_t*) sys_calloc(numEntries,
+                                              2 * sizeof(size_t)))
+        == NULL) {
+      sys_free(t);
+      return NULL;
+    }
+    atomic_init_spinlock_t(&t->lock);
+    t->rng = ((uint64_t) (uintptr_t) t * UINT64_C(0x9e3779b97f4a7c15)) | 1;
+    t->untilSample = nextSampleInterval(t);
+    CHPL_TLS_SET(memTrackThread, t);
+
+    pthread_mutex_lock(&memTrackThreads_lock);
+    t->next = memTrackThreads;
+    memTrackThreads = t;
+    pthread_mutex_unlock(&memTrackThreads_lock);
+  }
+
+  return t;
+}
+
+
+//
+// Count an allocation in this thread's buffer.  Returns the number of
+// bytes it should stand for if it is to be sampled, or 0 if not.
+//
+static
+size_t countAndSample(size_t bytes, chpl_mem_descInt_t description) {
+  memTrackThread_t* t;
+  size_t weight = 0;
+
+  if ((t = getMemTrackThread()) == NULL) {
+    return 0;
+  }
+
+  atomic_lock_spinlock_t(&t->lock);
+  t->descCounts[2 * description] += 1;
+  t->descCounts[2 * description + 1] += bytes;
+  t->allocated += bytes;
+  t->untilSample -= (sampleBytes > 0) ? (int64_t) bytes : 1;
+  if (t->untilSample <= 0) {
+    if (sampleBytes > 0) {
+      //
+      // An allocation of s bytes is sampled with probability
+      // 1 - exp(-s/B), so it stands for s divided by that.
+      //
+      const double p = -expm1(-(double) bytes / (double) sampleBytes);
+      weight = (size_t) ((double) bytes / p);
+    } else {
+      weight = bytes * sampleEvery;
+    }
+    t->untilSample = nextSampleInterval(t);
+  }
+  atomic_unlock_spinlock_t(&t->lock);
+
+  return weight;
+}
+
+
+//
+// Merge the per-thread buffers into table (numbers and bytes for each
+// type, in the layout printMemAllocsByType() uses) if it isn't NULL,
+// and return the total bytes allocated.
+//
+static
+size_t mergeMemTrackThreads(size_t* table) {
+  const int numEntries = CHPL_RT_MD_NUM+chpl_mem_numDescs;
+  size_t allocated = 0;
+
+  pthread_mutex_lock(&memTrackThreads_lock);
+  for (memTrackThread_t* t = memTrackThreads; t != NULL; t = t->next) {
+    atomic_lock_spinlock_t(&t->lock);
+    allocated += t->allocated;
+    if (table != NULL) {
+      for (int i = 0; i < numEntries; i++) {
+        table[3*i] += t->descCounts[2*i+1];
+        table[3*i+1] += t->descCounts[2*i];
+      }
+    }
+    atomic_unlock_spinlock_t(&t->lock);
+  }
+  pthread_mutex_unlock(&memTrackThreads_lock);
+
+  return allocated;
+}
+
+
 
 void chpl_setMemFlags(void) {
   chpl_bool local_memTrack = false;
@@ -182,6 +356,20 @@ void chpl_setMemFlags(void) {
   }
 
   if (local_memTrack) {
+    sampleBytes = chpl_env_rt_get_size("MEM_TRACK_SAMPLE_BYTES", 0);
+    sampleEvery = chpl_env_rt_get_size("MEM_TRACK_SAMPLE_EVERY", 0);
+    memSampling = (sampleBytes > 0 || sampleEvery > 1);
+    if (memSampling) {
+      CHPL_TLS_INIT(memTrackThread);
+      for (int i = 0; i < (1 << SAMPLED_FILTER_BITS); i++) {
+        atomic_init_uint_least32_t(&sampledFilter[i], 0);
+      }
+      if (memMax > 0 && chpl_nodeID == 0) {
+        chpl_warning("with memory tracking sampling, --memMax is checked "
+                     "against an estimate", 0, 0);
+      }
+    }
+
     hashSizeIndex = 0;
     hashSize = hashSizes[hashSizeIndex];
     memTable = sys_calloc(hashSize, sizeof(memTableEntry*));
@@ -249,7 +437,7 @@ resizeTable(int direction) {
 }
 
 static void addMemTableEntry(void *memAlloc, size_t number, size_t size,
-                             c_sublocid_t subloc,
+                             size_t weight, c_sublocid_t subloc,
                              chpl_mem_descInt_t description, int32_t lineno,
                              int32_t filename) {
   unsigned hashValue;
@@ -274,8 +462,13 @@ static void addMemTableEntry(void *memAlloc, size_t number, size_t size,
   memEntry->filename = filename;
   memEntry->number = number;
   memEntry->size = size;
-  increaseMemStat(number*size, lineno, filename);
+  memEntry->weight = weight;
+  increaseMemStat(weight, lineno, filename);
   totalEntries += 1;
+  if (memSampling) {
+    (void) atomic_fetch_add_uint_least32_t(
+             &sampledFilter[sampledFilterIdx(memAlloc)], 1);
+  }
 }
 
 
@@ -304,8 +497,12 @@ static memTableEntry* removeMemTableEntry(void* address) {
     }
   }
   if (deletedBucket) {
-    decreaseMemStat(deletedBucket->number * deletedBucket->size);
+    decreaseMemStat(deletedBucket->weight);
     totalEntries -= 1;
+    if (memSampling) {
+      (void) atomic_fetch_sub_uint_least32_t(
+               &sampledFilter[sampledFilterIdx(address)], 1);
+    }
     if (totalEntries*8 < hashSize && hashSizeIndex > 0)
       resizeTable(-1);
   }
@@ -355,14 +552,28 @@ void chpl_printMemAllocStats(int32_t lineno, int32_t filename) {
   // Take a pre-run through the descriptions and values to figure
   // out how long each line will need to be.
   //
-  static const struct {
+  // Memory held in the runtime's small-object arenas isn't allocated in
+  // the tracking sense, but it is still in use by the program.
+  static size_t arenaCached;
+  arenaCached = chpl_mem_arena_cachedBytes();
+
+  //
+  // When sampling, only the sum of allocations is exact.
+  //
+  static size_t sumAllocated;
+  sumAllocated = memSampling ? mergeMemTrackThreads(NULL) : totalAllocated;
+
+  const struct {
     const char* desc;
     size_t* val;
   } descsVals[] = {
-    { "Allocated Now:", &totalMem },
-    { "Allocation High Water Mark:", &maxMem },
-    { "Sum of Allocations:", &totalAllocated },
-    { "Sum of Frees:", &totalFreed },
+    { memSampling ? "Allocated Now (est.):" : "Allocated Now:", &totalMem },
+    { memSampling
+      ? "Allocation High Water Mark (est.):"
+      : "Allocation High Water Mark:", &maxMem },
+    { "Sum of Allocations:", &sumAllocated },
+    { memSampling ? "Sum of Frees (est.):" : "Sum of Frees:", &totalFreed },
+    { "Cached in Arenas:", &arenaCached },
   };
   const int nDescsVals = sizeof(descsVals) / sizeof(descsVals[0]);
 
@@ -385,7 +596,8 @@ void chpl_printMemAllocStats(int32_t lineno, int32_t filename) {
   // Now finally, size the buffer, print the information, and send it
   // to the memory log file.
   //
-  char buf[4 * (strlen(prefixBuf) + 1 + descWidth + 1 + memWidth + 1) + 1];
+  char buf[nDescsVals * (strlen(prefixBuf) + 1 + descWidth + 1 + memWidth + 1)
+           + 1];
   size_t len;
 
   memTrack_lock();
@@ -428,19 +640,28 @@ static void printMemAllocsByType(_Bool forLeaks,
 
   table = (size_t*)sys_calloc(numEntries, 3*sizeof(size_t));
 
-  for (i = 0; i < hashSize; i++) {
-    for (me = memTable[i]; me != NULL; me = me->nextInBucket) {
-      table[3*me->description] += me->number*me->size;
-      table[3*me->description+1] += 1;
-      table[3*me->description+2] = me->description;
+  if (memSampling && !forLeaks) {
+    // The per-type totals of all allocations are exact.
+    mergeMemTrackThreads(table);
+  } else {
+    for (i = 0; i < hashSize; i++) {
+      for (me = memTable[i]; me != NULL; me = me->nextInBucket) {
+        const size_t chunk = me->number*me->size;
+        table[3*me->description] += me->weight;
+        table[3*me->description+1] += (chunk == 0) ? 1 : me->weight / chunk;
+      }
     }
   }
+  for (i = 0; i < numEntries; i++) {
+    table[3*i+2] = i;
+  }
 
   qsort(table, numEntries, 3*sizeof(size_t), memTableEntryCmp);
 
   if (forLeaks) {
     fprintf(memLogFile, "====================\n");
-    fprintf(memLogFile, "Leaked Memory Report\n");
+    fprintf(memLogFile, "Leaked Memory Report%s\n",
+            memSampling ? " (estimated from samples)" : "");
     fprintf(memLogFile, "==============================================================\n");
     fprintf(memLogFile, "Number of leaked allocations\n");
     fprintf(memLogFile, "           Total leaked memory (bytes)\n");
@@ -675,10 +896,15 @@ void chpl_track_malloc(void* memAlloc, size_t number, size_t size,
   if (number * size > memThreshold) {
     c_sublocid_t subloc = chpl_task_getRequestedSubloc();
     if (chpl_memTrack && chpl_mem_descTrack(description)) {
-      memTrack_lock();
-      addMemTableEntry(memAlloc, number, size, subloc, description,
-                       lineno, filename);
-      memTrack_unlock();
+      const size_t weight = memSampling
+                            ? countAndSample(number * size, description)
+                            : number * size;
+      if (!memSampling || weight > 0) {
+        memTrack_lock();
+        addMemTableEntry(memAlloc, number, size, weight, subloc, description,
+                         lineno, filename);
+        memTrack_unlock();
+      }
     }
     if (chpl_verbose_mem) {
       char subloc_info[16] = "";
@@ -707,7 +933,7 @@ void chpl_track_free(void* memAlloc, size_t approximateSize, int32_t lineno,
   if (approximateSize == 0 || approximateSize > memThreshold) {
     c_sublocid_t subloc = chpl_task_getRequestedSubloc();
     memTableEntry* memEntry = NULL;
-    if (chpl_memTrack) {
+    if (chpl_memTrack && (!memSampling || mightBeSampled(memAlloc))) {
       memTrack_lock();
       memEntry = removeMemTableEntry(memAlloc);
       if (memEntry) {
@@ -724,7 +950,7 @@ void chpl_track_free(void* memAlloc, size_t approximateSize, int32_t lineno,
         sys_free(memEntry);
       }
       memTrack_unlock();
-    } else if (chpl_verbose_mem && !memEntry) {
+    } else if (chpl_verbose_mem) {
       char subloc_info[16] = "";
       chpl_track_gen_subloc_info(subloc_info, subloc);
       fprintf(memLogFile, "%" PRI_c_nodeid_t "%s: %s:%" PRId32 ": free at %p\n",
@@ -741,7 +967,8 @@ void chpl_track_realloc_pre(void* memAlloc, size_t size,
                          int32_t lineno, int32_t filename) {
   memTableEntry* memEntry = NULL;
 
-  if (chpl_memTrack && size > memThreshold) {
+  if (chpl_memTrack && size > memThreshold
+      && (!memSampling || (memAlloc && mightBeSampled(memAlloc)))) {
     memTrack_lock();
     if (memAlloc) {
       memEntry = removeMemTableEntry(memAlloc);
@@ -760,9 +987,15 @@ void chpl_track_realloc_post(void* moreMemAlloc,
   c_sublocid_t subloc = chpl_task_getRequestedSubloc();
   if (size > memThreshold) {
     if (chpl_memTrack && chpl_mem_descTrack(description)) {
-      memTrack_lock();
-      addMemTableEntry(moreMemAlloc, 1, size, subloc, description, lineno, filename);
-      memTrack_unlock();
+      const size_t weight = memSampling
+                            ? countAndSample(size, description)
+                            : size;
+      if (!memSampling || weight > 0) {
+        memTrack_lock();
+        addMemTableEntry(moreMemAlloc, 1, size, weight, subloc, description,
+                         lineno, filename);
+        memTrack_unlock();
+      }
     }
     if (chpl_verbose_mem) {
       fprintf(memLogFile, "%" PRI_c_nodeid_t ": %s:%" PRId32
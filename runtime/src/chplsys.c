@@ -341,6 +341,14 @@ static void computeHeapPageSize(void) {
   }
 #endif
 
+  //
+  // If the memory layer maps the heap itself with a fixed page size,
+  // go with that.
+  //
+  if ((heapPageSize = chpl_mem_layerHeapPageSize()) != 0) {
+    return;
+  }
+
   // note: sets heapPageSize
   computeHeapPageSizeByGuessing(chpl_getSysPageSize());
 }
@@ -45,6 +45,7 @@
 // Don't get warning macros for chpl_comm_get etc
 #include "chpl-comm-no-warning-macros.h"
 
+#include <pthread.h>
 #include <signal.h>
 #include <sched.h>
 #include <stdint.h>
@@ -160,6 +161,18 @@ void init_done_obj(done_t* done, int target) {
 
 static inline void am_poll_try(void);
 
+//
+// Every AM handler bumps this, so that a polling task that backs off
+// when idle can tell whether its polls are finding anything to do.
+//
+static atomic_uint_least32_t amHandled;
+
+static inline
+void note_am_handled(void) {
+  (void) atomic_fetch_add_explicit_uint_least32_t(&amHandled, 1,
+                                                  memory_order_relaxed);
+}
+
 static inline
 void wait_done_obj(done_t* done, chpl_bool do_yield)
 {
@@ -215,6 +228,19 @@ typedef struct {
   large_fork_t          large;
 } large_fork_task_t;
 
+//
+// The target side of a large fork GETs the caller's bundle into a
+// buffer of its own.  Bundles up to this size go in a buffer on the
+// wrapper's stack instead of being allocated; that's well below any
+// task stack size we'd run with.
+//
+#define MAX_STACK_FORK_RCV_SIZE 4096
+
+typedef union {
+  chpl_comm_on_bundle_t bundle;
+  unsigned char         space[MAX_STACK_FORK_RCV_SIZE];
+} stack_fork_rcv_t;
+
 typedef struct {
   void*   ack;
   int     id;       // private broadcast table entry to update
@@ -256,12 +282,14 @@ typedef enum {
   PRIV_BCAST,           // put data at addr (used for private broadcast)
   PRIV_BCAST_LARGE,     // put data at addr (used for private broadcast)
   FREE,                 // free data at addr
+  FREE_BATCH,           // free data at several addrs
   SHUTDOWN,             // tell nodes to get ready for shutdown
   DO_REPLY_PUT,         // do a PUT here from another locale
   DO_COPY_PAYLOAD       // copy AM payload to another address
 } AM_handler_function_idx_t;
 
 static void AM_fork_fast(gasnet_token_t token, void* buf, size_t nbytes) {
+  note_am_handled();
   chpl_comm_on_bundle_t *f = buf;
 
   // Run the function
@@ -315,6 +343,7 @@ size_t setup_large_fork_task(large_fork_task_t* dst, large_fork_t* f, size_t nby
 
 
 static void AM_fork_fast_small(gasnet_token_t token, void* buf, size_t nbytes) {
+  note_am_handled();
   small_fork_hdr_t *f = buf;
   small_fork_task_t task;
   chpl_comm_on_bundle_t *bptr = &task.bundle;
@@ -340,6 +369,7 @@ static void fork_wrapper(chpl_comm_on_bundle_t *f) {
 }
 
 static void AM_fork(gasnet_token_t token, void* buf, size_t nbytes) {
+  note_am_handled();
   chpl_comm_on_bundle_t *f = (chpl_comm_on_bundle_t*) buf;
   chpl_task_startMovedTask(f->task_bundle.requested_fid,
                            (chpl_fn_p)fork_wrapper,
@@ -348,6 +378,7 @@ static void AM_fork(gasnet_token_t token, void* buf, size_t nbytes) {
 }
 
 static void AM_fork_small(gasnet_token_t token, void* buf, size_t nbytes) {
+  note_am_handled();
   small_fork_hdr_t *f = buf;
   small_fork_task_t task;
   chpl_comm_on_bundle_t *bptr = &task.bundle;
@@ -365,6 +396,7 @@ static void AM_fork_small(gasnet_token_t token, void* buf, size_t nbytes) {
 
 static void fork_large_wrapper(large_fork_task_t* f) {
   large_fork_t *lg = &f->large;
+  stack_fork_rcv_t stackArg;
   chpl_comm_on_bundle_t* arg;
   int caller;
   size_t bundle_size_on_caller;
@@ -378,9 +410,11 @@ static void fork_large_wrapper(large_fork_task_t* f) {
   ack = lg->hdr.ack;
   fid = lg->hdr.fid;
 
-  // Allocate the bundle
-  arg = chpl_mem_allocMany(1, bundle_size_on_caller,
-                           CHPL_RT_MD_COMM_FRK_RCV_ARG, 0, 0);
+  // Allocate the bundle, unless it fits on the stack
+  arg = (bundle_size_on_caller <= sizeof(stackArg))
+        ? &stackArg.bundle
+        : chpl_mem_allocMany(1, bundle_size_on_caller,
+                             CHPL_RT_MD_COMM_FRK_RCV_ARG, 0, 0);
 
   // GET the bundle data
   // TODO: This could get only the payload
@@ -394,13 +428,15 @@ static void fork_large_wrapper(large_fork_task_t* f) {
   GASNET_Safe(gasnet_AMRequestShort2(caller, SIGNAL, Arg0(ack), Arg1(ack)));
 
   // Free the bundle we just allocated.
-  chpl_mem_free(arg, 0, 0);
+  if (arg != &stackArg.bundle)
+    chpl_mem_free(arg, 0, 0);
 }
 
 ////GASNET - can we send as much of user data as possible initially
 ////           hide data copy by making get non-blocking
 ////GASNET - can we allocate f big enough so as not to need malloc in wrapper
 static void AM_fork_large(gasnet_token_t token, void* buf, size_t nbytes) {
+  note_am_handled();
   large_fork_t *f = buf;
   large_fork_task_t task;
   chpl_comm_on_bundle_t *bptr = &task.bundle;
@@ -421,6 +457,7 @@ static void fork_nb_wrapper(chpl_comm_on_bundle_t *f) {
 static void AM_fork_nb(gasnet_token_t  token,
                         void           *buf,
                         size_t          nbytes) {
+  note_am_handled();
   chpl_comm_on_bundle_t *f = (chpl_comm_on_bundle_t*) buf;
 
   chpl_task_startMovedTask(f->task_bundle.requested_fid,
@@ -432,6 +469,7 @@ static void AM_fork_nb(gasnet_token_t  token,
 static void AM_fork_nb_small(gasnet_token_t  token,
                              void           *buf,
                              size_t          nbytes) {
+  note_am_handled();
   small_fork_hdr_t *f = buf;
   small_fork_task_t task;
   chpl_comm_on_bundle_t *bptr = &task.bundle;
@@ -446,8 +484,120 @@ static void AM_fork_nb_small(gasnet_token_t  token,
 }
 
 
+//
+// Batching of remote frees.
+//
+// Nothing waits for a remote free, so rather than sending an AM for
+// each one we collect them per target node and send each node's as one
+// medium AM, when its batch fills up or when a task ends or does an
+// unordered fence.  The batches are shared by all tasks, because each
+// nonblocking large fork frees just one thing on its initiator and
+// what we want is to combine the frees of the many doing that at once.
+// The nodes with frees pending are kept in a list, so flushing doesn't
+// have to look at every node.
+//
+#define MAX_FREE_BATCH_LEN 64   // 512 bytes, the least gasnet_AMMaxMedium()
+
+typedef struct {
+  int count;
+  void* p[MAX_FREE_BATCH_LEN];
+} free_batch_t;
+
+static pthread_mutex_t free_batch_lock = PTHREAD_MUTEX_INITIALIZER;
+static free_batch_t** free_batches;     // [chpl_numNodes], or NULL
+static c_nodeid_t* free_batch_nodes;    // nodes with frees pending
+static int num_free_batch_nodes;
+static atomic_bool free_batches_pending;
+
+static void init_free_batches(void) {
+  atomic_init_bool(&free_batches_pending, false);
+  if (chpl_numNodes <= 1
+      || !chpl_env_rt_get_bool("COMM_GASNET_BATCH_FREE", true)) {
+    return;
+  }
+  free_batches = chpl_mem_allocManyZero(chpl_numNodes, sizeof(*free_batches),
+                                        CHPL_RT_MD_COMM_UTIL, 0, 0);
+  free_batch_nodes = chpl_mem_allocMany(chpl_numNodes,
+                                        sizeof(*free_batch_nodes),
+                                        CHPL_RT_MD_COMM_UTIL, 0, 0);
+}
+
+static void send_free_batch(c_nodeid_t node, free_batch_t* fb) {
+  GASNET_Safe(gasnet_AMRequestMedium0(node, FREE_BATCH, fb->p,
+                                      fb->count * sizeof(fb->p[0])));
+}
+
+static void request_free(c_nodeid_t node, void* p) {
+  free_batch_t full;
+  free_batch_t* fb;
+
+  if (free_batches == NULL) {
+    GASNET_Safe(gasnet_AMRequestShort2(node, FREE, Arg0(p), Arg1(p)));
+    return;
+  }
+
+  full.count = 0;
+  pthread_mutex_lock(&free_batch_lock);
+  if ((fb = free_batches[node]) == NULL) {
+    fb = chpl_mem_allocManyZero(1, sizeof(*fb), CHPL_RT_MD_COMM_UTIL, 0, 0);
+    free_batches[node] = fb;
+  }
+  if (fb->count == 0) {
+    free_batch_nodes[num_free_batch_nodes++] = node;
+    atomic_store_bool(&free_batches_pending, true);
+  }
+  fb->p[fb->count++] = p;
+  if (fb->count == MAX_FREE_BATCH_LEN) {
+    // Send it once we've let go of the lock.  The node stays on the
+    // pending list and flushing skips it if it's still empty then.
+    full = *fb;
+    fb->count = 0;
+  }
+  pthread_mutex_unlock(&free_batch_lock);
+
+  if (full.count > 0) {
+    send_free_batch(node, &full);
+  }
+}
+
+static void flush_free_batches(void) {
+  if (!atomic_load_explicit_bool(&free_batches_pending,
+                                 memory_order_relaxed)) {
+    return;
+  }
+
+  while (1) {
+    free_batch_t fb;
+    c_nodeid_t node;
+
+    pthread_mutex_lock(&free_batch_lock);
+    if (num_free_batch_nodes == 0) {
+      atomic_store_bool(&free_batches_pending, false);
+      pthread_mutex_unlock(&free_batch_lock);
+      break;
+    }
+    node = free_batch_nodes[--num_free_batch_nodes];
+    fb = *free_batches[node];
+    free_batches[node]->count = 0;
+    pthread_mutex_unlock(&free_batch_lock);
+
+    if (fb.count > 0) {
+      send_free_batch(node, &fb);
+    }
+  }
+}
+
+void chpl_comm_impl_unordered_task_fence(void) {
+  flush_free_batches();
+}
+
+void chpl_comm_impl_task_end(void) {
+  flush_free_batches();
+}
+
 static void fork_nb_large_wrapper(large_fork_task_t* f) {
   large_fork_t *lg = &f->large;
+  stack_fork_rcv_t stackArg;
   chpl_comm_on_bundle_t* arg;
   int caller;
   size_t bundle_size_on_caller;
@@ -459,27 +609,29 @@ static void fork_nb_large_wrapper(large_fork_task_t* f) {
   arg_on_caller = lg->arg;
   fid = lg->hdr.fid;
 
-  // Allocate the bundle
-  arg = chpl_mem_allocMany(1, bundle_size_on_caller,
-                           CHPL_RT_MD_COMM_FRK_RCV_ARG, 0, 0);
+  // Allocate the bundle, unless it fits on the stack
+  arg = (bundle_size_on_caller <= sizeof(stackArg))
+        ? &stackArg.bundle
+        : chpl_mem_allocMany(1, bundle_size_on_caller,
+                             CHPL_RT_MD_COMM_FRK_RCV_ARG, 0, 0);
 
   // GET the bundle data
   chpl_comm_get(arg, caller, arg_on_caller, bundle_size_on_caller,
                 CHPL_COMM_UNKNOWN_ID, 0, CHPL_FILE_IDX_FORK_LARGE);
 
   // Signal that the allocated region can be freed
-  GASNET_Safe(gasnet_AMRequestShort2(caller, FREE,
-                                     Arg0(arg_on_caller),
-                                     Arg1(arg_on_caller)));
+  request_free(caller, arg_on_caller);
 
   // Call the user function
   chpl_ftable_call(fid, arg);
 
   // Free the bundle we just allocated
-  chpl_mem_free(arg, 0, 0);
+  if (arg != &stackArg.bundle)
+    chpl_mem_free(arg, 0, 0);
 }
 
 static void AM_fork_nb_large(gasnet_token_t token, void* buf, size_t nbytes) {
+  note_am_handled();
   large_fork_t *f = buf;
   large_fork_task_t task;
   chpl_comm_on_bundle_t *bptr = &task.bundle;
@@ -494,6 +646,7 @@ static void AM_fork_nb_large(gasnet_token_t token, void* buf, size_t nbytes) {
 }
 
 static void AM_signal(gasnet_token_t token, gasnet_handlerarg_t a0, gasnet_handlerarg_t a1) {
+  note_am_handled();
   done_t* done = (done_t*) get_ptr_from_args(a0, a1);
   uint_least32_t prev;
   prev = atomic_fetch_add_explicit_uint_least32_t(&done->count, 1,
@@ -504,6 +657,7 @@ static void AM_signal(gasnet_token_t token, gasnet_handlerarg_t a0, gasnet_handl
 
 static void AM_signal_long(gasnet_token_t token, void *buf, size_t nbytes,
                            gasnet_handlerarg_t a0, gasnet_handlerarg_t a1) {
+  note_am_handled();
   done_t* done = (done_t*) get_ptr_from_args(a0, a1);
   uint_least32_t prev;
   prev = atomic_fetch_add_explicit_uint_least32_t(&done->count, 1,
@@ -513,6 +667,7 @@ static void AM_signal_long(gasnet_token_t token, void *buf, size_t nbytes,
 }
 
 static void AM_priv_bcast(gasnet_token_t token, void* buf, size_t nbytes) {
+  note_am_handled();
   priv_bcast_t* pbp = buf;
   chpl_memcpy(chpl_rt_priv_bcast_tab[pbp->id], pbp->data, pbp->size);
 
@@ -522,6 +677,7 @@ static void AM_priv_bcast(gasnet_token_t token, void* buf, size_t nbytes) {
 }
 
 static void AM_priv_bcast_large(gasnet_token_t token, void* buf, size_t nbytes) {
+  note_am_handled();
   priv_bcast_large_t* pblp = buf;
   chpl_memcpy((char*)chpl_rt_priv_bcast_tab[pblp->id]+pblp->offset, pblp->data, pblp->size);
 
@@ -531,12 +687,23 @@ static void AM_priv_bcast_large(gasnet_token_t token, void* buf, size_t nbytes)
 }
 
 static void AM_free(gasnet_token_t token, gasnet_handlerarg_t a0, gasnet_handlerarg_t a1) {
+  note_am_handled();
   void* to_free = get_ptr_from_args(a0, a1);
 
   chpl_mem_free(to_free, 0, 0);
 }
 
+static void AM_free_batch(gasnet_token_t token, void* buf, size_t nbytes) {
+  note_am_handled();
+  void** to_free = buf;
+
+  for (size_t i = 0; i < nbytes / sizeof(void*); i++) {
+    chpl_mem_free(to_free[i], 0, 0);
+  }
+}
+
 static void AM_shutdown(gasnet_token_t token) {
+  note_am_handled();
   chpl_signal_shutdown();
 }
 
@@ -544,6 +711,7 @@ static void AM_shutdown(gasnet_token_t token) {
 // arg->dst (which is local to the caller of this AM).
 // nbytes is < gasnet_AMMaxLongReply here (see chpl_comm_get).
 static void AM_reply_put(gasnet_token_t token, void* buf, size_t nbytes) {
+  note_am_handled();
   xfer_info_t* x = buf;
 
   assert(nbytes == sizeof(xfer_info_t));
@@ -559,6 +727,7 @@ void AM_copy_payload(gasnet_token_t token, void* buf, size_t nbytes,
                      gasnet_handlerarg_t ack0, gasnet_handlerarg_t ack1,
                      gasnet_handlerarg_t dst0, gasnet_handlerarg_t dst1)
 {
+  note_am_handled();
   void* dst = get_ptr_from_args(dst0, dst1);
 
   memcpy(dst, buf, nbytes);
@@ -580,6 +749,7 @@ static gex_AM_Entry_t ftable[] = {
   {PRIV_BCAST,       AM_priv_bcast,       GEX_FLAG_AM_REQUEST | GEX_FLAG_AM_MEDIUM, 0, NULL, "AM_priv_bcast"       },
   {PRIV_BCAST_LARGE, AM_priv_bcast_large, GEX_FLAG_AM_REQUEST | GEX_FLAG_AM_MEDIUM, 0, NULL, "AM_priv_bcast_large" },
   {FREE,             AM_free,             GEX_FLAG_AM_REQUEST | GEX_FLAG_AM_SHORT,  2, NULL, "AM_free"             },
+  {FREE_BATCH,       AM_free_batch,       GEX_FLAG_AM_REQUEST | GEX_FLAG_AM_MEDIUM, 0, NULL, "AM_free_batch"       },
   {SHUTDOWN,         AM_shutdown,         GEX_FLAG_AM_REQUEST | GEX_FLAG_AM_SHORT,  0, NULL, "AM_shutdown"         },
   {DO_REPLY_PUT,     AM_reply_put,        GEX_FLAG_AM_REQUEST | GEX_FLAG_AM_MEDIUM, 0, NULL, "AM_reply_put"        },
   {DO_COPY_PAYLOAD,  AM_copy_payload,     GEX_FLAG_AM_REQUEST | GEX_FLAG_AM_MEDIUM, 4, NULL, "AM_copy_payload"     }
@@ -596,7 +766,7 @@ chpl_comm_nb_handle_t chpl_comm_put_nb(void *addr, c_nodeid_t node, void* raddr,
   int remote_in_segment;
 
   // Communication callbacks
-  if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_put_nb)) {
+  if (chpl_comm_want_callbacks(chpl_comm_cb_event_kind_put_nb, node, size)) {
     chpl_comm_cb_info_t cb_data =
       {chpl_comm_cb_event_kind_put_nb, chpl_nodeID, node,
        .iu.comm={addr, raddr, size, commID, ln, fn}};
@@ -634,7 +804,7 @@ chpl_comm_nb_handle_t chpl_comm_get_nb(void* addr, c_nodeid_t node, void* raddr,
   int remote_in_segment;
 
   // Communications callback support
-  if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_get_nb)) {
+  if (chpl_comm_want_callbacks(chpl_comm_cb_event_kind_get_nb, node, size)) {
     chpl_comm_cb_info_t cb_data =
       {chpl_comm_cb_event_kind_get_nb, chpl_nodeID, node,
        .iu.comm={addr, raddr, size, commID, ln, fn}};
@@ -726,6 +896,19 @@ static volatile int pollingQuit;
 static chpl_bool pollingRequired;
 static atomic_spinlock_t pollingLock;
 
+//
+// With CHPL_RT_COMM_GASNET_PROGRESS=backoff the polling task sleeps,
+// for exponentially longer times up to the given maximum, once its
+// polls stop finding AMs to handle.  This frees its core on CPU
+// constrained nodes, at the cost of up to that much latency for
+// requests arriving at an idle locale.  Tasks waiting for their own
+// replies in wait_done_obj() drive progress themselves, so they don't
+// see the delay.
+//
+static chpl_bool pollingBackoff;
+static long pollingMaxSleepNs;
+#define POLLING_IDLE_POLLS 1000
+
 static inline void am_poll_try(void) {
   // Serialize polling for IBV, UCX, Aries, and OFI. Concurrent polling causes
   // contention in these configurations. For other configurations that are
@@ -741,10 +924,30 @@ static inline void am_poll_try(void) {
 }
 
 static void polling(void* x) {
+  uint_least32_t lastHandled = atomic_load_uint_least32_t(&amHandled);
+  int idlePolls = 0;
+  long sleepNs = 0;
+
   pollingRunning = 1;
 
   while (!pollingQuit) {
     am_poll_try();
+    if (pollingBackoff) {
+      const uint_least32_t handled = atomic_load_uint_least32_t(&amHandled);
+      if (handled != lastHandled) {
+        lastHandled = handled;
+        idlePolls = 0;
+        sleepNs = 0;
+      } else if (++idlePolls >= POLLING_IDLE_POLLS) {
+        sleepNs = (sleepNs == 0) ? 1000 : 2 * sleepNs;
+        if (sleepNs > pollingMaxSleepNs) {
+          sleepNs = pollingMaxSleepNs;
+        }
+        struct timespec ts = { .tv_sec = sleepNs / 1000000000,
+                               .tv_nsec = sleepNs % 1000000000 };
+        (void) nanosleep(&ts, NULL);
+      }
+    }
     chpl_task_yield();
   }
 
@@ -753,6 +956,23 @@ static void polling(void* x) {
 
 static void setup_polling(void) {
   atomic_init_spinlock_t(&pollingLock);
+  atomic_init_uint_least32_t(&amHandled, 0);
+
+  {
+    const char* ev = chpl_env_rt_get("COMM_GASNET_PROGRESS", "spin");
+    if (strcmp(ev, "backoff") == 0) {
+      pollingBackoff = true;
+    } else if (strcmp(ev, "spin") != 0) {
+      chpl_warning("CHPL_RT_COMM_GASNET_PROGRESS must be 'spin' or "
+                   "'backoff'; using 'spin'", 0, 0);
+    }
+    pollingMaxSleepNs =
+      1000 * (long) chpl_env_rt_get_int("COMM_GASNET_PROGRESS_MAX_SLEEP_US",
+                                        100);
+    if (pollingMaxSleepNs < 1000) {
+      pollingMaxSleepNs = 1000;
+    }
+  }
 #if defined(GASNET_CONDUIT_IBV)
   pollingRequired = false;
   chpl_env_set("GASNET_RCV_THREAD", "1", 1);
@@ -947,6 +1167,7 @@ int chpl_comm_run_in_lldb(int argc, char* argv[], int lldbArgnum, int* status) {
 }
 
 void chpl_comm_post_task_init(void) {
+  init_free_batches();
   start_polling();
 }
 
@@ -970,26 +1191,6 @@ void chpl_comm_impl_regMemHeapInfo(void** start_p, size_t* size_p) {
 #endif
 }
 
-wide_ptr_t* chpl_comm_broadcast_global_vars_helper(void) {
-  //
-  // Gather the global variables' wide pointers on node 0 into the
-  // buffer at the front of our communicable segment.  We don't have
-  // to communicate that because everyone already knows where it is.
-  // We do need to delay returning on the non-0 nodes until after
-  // node 0 has filled in that buffer, however.
-  //
-  if (chpl_nodeID == 0) {
-    for (int i = 0; i < chpl_numGlobalsOnHeap; i++) {
-      ((wide_ptr_t*) seginfo_table[0].addr)[i] = *chpl_globals_registry[i];
-    }
-    chpl_comm_barrier("fill node 0 globals buf");
-    return NULL; // so common code won't try to free it!
-  } else {
-    chpl_comm_barrier("fill node 0 globals buf");
-    return (wide_ptr_t*) seginfo_table[0].addr;
-  }
-}
-
 void chpl_comm_broadcast_private(int id, size_t size) {
   int  node, offset;
   int  payloadSize = size + sizeof(priv_bcast_t);
@@ -1047,24 +1248,103 @@ void chpl_comm_broadcast_private(int id, size_t size) {
   chpl_mem_free(done, 0, 0);
 }
 
-void chpl_comm_impl_barrier(const char *msg) {
-  int id = (int) msg[0];
-  int retval;
+static chpl_bool bar_in_progress;
+static gex_Event_t bar_event;
+
+void chpl_comm_impl_barrier_begin(const char *msg) {
+  if (bar_in_progress) {
+    chpl_internal_error("barrier begun while another is in progress");
+  }
+  bar_in_progress = true;
+  bar_event = gex_Coll_BarrierNB(myteam, GEX_NO_FLAGS);
+}
+
+chpl_bool chpl_comm_impl_barrier_test(void) {
+  if (!bar_in_progress) {
+    return true;
+  }
+  if (gex_Event_Test(bar_event) == GASNET_ERR_NOT_READY) {
+    return false;
+  }
+  bar_in_progress = false;
+  return true;
+}
 
+void chpl_comm_impl_barrier_wait(void) {
   //
-  // We don't want to just do a gasnet_barrier_wait() here, because
-  // GASNet will put us to work polling, and we already have a polling
-  // task that the tasking layer has presumably placed to best effect.
-  // We don't want to compete with that.  Also, the implementation is
+  // We don't want to just do a gex_Event_Wait() here, because GASNet
+  // will put us to work polling, and we already have a polling task
+  // that the tasking layer has presumably placed to best effect.  We
+  // don't want to compete with that.  Also, the implementation is
   // required to do chpl_task_yield() while waiting for the barrier to
   // satisfy; see chpl_comm.h.  This prevents us from monopolizing the
   // processor while waiting.
   //
-  gasnet_barrier_notify(id, 0);
-  while ((retval = gasnet_barrier_try(id, 0)) == GASNET_ERR_NOT_READY) {
+  while (!chpl_comm_impl_barrier_test()) {
+    chpl_task_yield();
+  }
+}
+
+void chpl_comm_impl_barrier(const char *msg) {
+  chpl_comm_impl_barrier_begin(msg);
+  chpl_comm_impl_barrier_wait();
+}
+
+static void coll_gex_wait(gex_Event_t ev) {
+  while (gex_Event_Test(ev) == GASNET_ERR_NOT_READY) {
     chpl_task_yield();
   }
-  GASNET_Safe_Retval(gasnet_barrier_try(id, 0), retval);
+}
+
+static gex_DT_t coll_gex_dt(int type, size_t* size) {
+  switch ((chpl_comm_coll_type_t) type) {
+  case CHPL_COMM_COLL_INT32:  *size = sizeof(int32_t);  return GEX_DT_I32;
+  case CHPL_COMM_COLL_INT64:  *size = sizeof(int64_t);  return GEX_DT_I64;
+  case CHPL_COMM_COLL_UINT32: *size = sizeof(uint32_t); return GEX_DT_U32;
+  case CHPL_COMM_COLL_UINT64: *size = sizeof(uint64_t); return GEX_DT_U64;
+  case CHPL_COMM_COLL_REAL32: *size = sizeof(float);    return GEX_DT_FLT;
+  case CHPL_COMM_COLL_REAL64: *size = sizeof(double);   return GEX_DT_DBL;
+  }
+  chpl_internal_error("unknown collective data type");
+  return GEX_DT_I32;
+}
+
+static gex_OP_t coll_gex_op(int op, int type) {
+  chpl_bool isReal = (type == CHPL_COMM_COLL_REAL32
+                      || type == CHPL_COMM_COLL_REAL64);
+  switch ((chpl_comm_coll_op_t) op) {
+  case CHPL_COMM_COLL_SUM:  return GEX_OP_ADD;
+  case CHPL_COMM_COLL_MIN:  return GEX_OP_MIN;
+  case CHPL_COMM_COLL_MAX:  return GEX_OP_MAX;
+  case CHPL_COMM_COLL_BAND: if (!isReal) return GEX_OP_AND; break;
+  case CHPL_COMM_COLL_BOR:  if (!isReal) return GEX_OP_OR;  break;
+  case CHPL_COMM_COLL_BXOR: if (!isReal) return GEX_OP_XOR; break;
+  }
+  chpl_internal_error("unsupported collective reduction op for data type");
+  return GEX_OP_ADD;
+}
+
+void chpl_comm_impl_bcast(c_nodeid_t root, void* buf, size_t size) {
+  coll_gex_wait(gex_Coll_BroadcastNB(myteam, root, buf, buf, size,
+                                     GEX_NO_FLAGS));
+}
+
+void chpl_comm_impl_reduce(c_nodeid_t root, const void* src, void* dst,
+                           size_t count, int type, int op) {
+  size_t eltSize;
+  gex_DT_t dt = coll_gex_dt(type, &eltSize);
+  coll_gex_wait(gex_Coll_ReduceToOneNB(myteam, root, dst, src, dt, eltSize,
+                                       count, coll_gex_op(op, type),
+                                       NULL, NULL, GEX_NO_FLAGS));
+}
+
+void chpl_comm_impl_allreduce(const void* src, void* dst, size_t count,
+                              int type, int op) {
+  size_t eltSize;
+  gex_DT_t dt = coll_gex_dt(type, &eltSize);
+  coll_gex_wait(gex_Coll_ReduceToAllNB(myteam, dst, src, dt, eltSize, count,
+                                       coll_gex_op(op, type),
+                                       NULL, NULL, GEX_NO_FLAGS));
 }
 
 void chpl_comm_pre_task_exit(int all) {
@@ -1107,7 +1387,7 @@ void  chpl_comm_put(void* addr, c_nodeid_t node, void* raddr,
     memmove(raddr, addr, size);
   } else {
     // Communications callback support
-    if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_put)) {
+    if (chpl_comm_want_callbacks(chpl_comm_cb_event_kind_put, node, size)) {
       chpl_comm_cb_info_t cb_data =
         {chpl_comm_cb_event_kind_put, chpl_nodeID, node,
          .iu.comm={addr, raddr, size, commID, ln, fn}};
@@ -1183,7 +1463,7 @@ void  chpl_comm_get(void* addr, c_nodeid_t node, void* raddr,
     memmove(addr, raddr, size);
   } else {
     // Communications callback support
-    if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_get)) {
+    if (chpl_comm_want_callbacks(chpl_comm_cb_event_kind_get, node, size)) {
       chpl_comm_cb_info_t cb_data =
         {chpl_comm_cb_event_kind_get, chpl_nodeID, node,
          .iu.comm={addr, raddr, size, commID, ln, fn}};
@@ -1295,17 +1575,23 @@ void  chpl_comm_get(void* addr, c_nodeid_t node, void* raddr,
 // This is an adapter from Chapel code to GASNet's VIS interface. It does:
 // * convert count[0] and all of 'srcstr' and 'dststr' from counts of element
 //   to counts of bytes,
+// * start the transfer and return its event, or wait for it if 'blocking'.
 //
-void  chpl_comm_get_strd(void* dstaddr, size_t* dststrides, c_nodeid_t srcnode_id,
+static inline
+gex_Event_t do_strd_xfer(chpl_bool isGet, chpl_bool blocking,
+                         void* dstaddr, size_t* dststrides,
+                         c_nodeid_t remnode_id,
                          void* srcaddr, size_t* srcstrides, size_t* count,
-                         int32_t stridelevels, size_t elemSize, int32_t commID,
-                         int ln, int32_t fn) {
+                         int32_t stridelevels, size_t elemSize,
+                         int32_t commID, int ln, int32_t fn) {
   int i;
   const size_t strlvls = (size_t)stridelevels;
   // Avoid 0-lengh VLA when stridelevels is 0 (contiguous transfer), gasnet
   // will ignore arrays in this case
   const size_t strlvls_nz = strlvls == 0 ? 1 : strlvls;
-  const gasnet_node_t srcnode = (gasnet_node_t)srcnode_id;
+  const gasnet_node_t remnode = (gasnet_node_t)remnode_id;
+  const chpl_comm_cb_event_kind_t cb_kind =
+    isGet ? chpl_comm_cb_event_kind_get_strd : chpl_comm_cb_event_kind_put_strd;
 
   ptrdiff_t dststr[strlvls_nz];
   ptrdiff_t srcstr[strlvls_nz];
@@ -1319,66 +1605,91 @@ void  chpl_comm_get_strd(void* dstaddr, size_t* dststrides, c_nodeid_t srcnode_i
   }
 
   // Communications callback support
-  if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_get_strd)) {
+  if (chpl_comm_have_callbacks(cb_kind)
+      && chpl_comm_want_callbacks(cb_kind, remnode_id,
+          chpl_comm_cb_strd_size(count, stridelevels, elemSize))) {
     chpl_comm_cb_info_t cb_data =
-      {chpl_comm_cb_event_kind_get_strd, chpl_nodeID, srcnode_id,
+      {cb_kind, chpl_nodeID, remnode_id,
        .iu.comm_strd={srcaddr, srcstrides, dstaddr, dststrides, count,
                       stridelevels, elemSize, commID, ln, fn}};
     chpl_comm_do_callbacks (&cb_data);
   }
 
-  // the case (chpl_nodeID == srcnode) is internally managed inside gasnet
-  chpl_comm_diags_verbose_rdmaStrd("get", srcnode, ln, fn, commID);
-  if (chpl_nodeID != srcnode) {
-    chpl_comm_diags_incr(get);
+  // the case (chpl_nodeID == remnode) is internally managed inside gasnet
+  chpl_comm_diags_verbose_rdmaStrd(isGet ? "get" : "put", remnode,
+                                   ln, fn, commID);
+  if (chpl_nodeID != remnode) {
+    if (isGet) {
+      chpl_comm_diags_incr(get);
+    } else {
+      chpl_comm_diags_incr(put);
+    }
   }
 
-  // TODO -- handle strided get for non-registered memory
-  // TODO GEX convert to NB with task-yield
-  gex_VIS_StridedGetBlocking(myteam, dstaddr, dststr, srcnode, srcaddr, srcstr, elemsz, cnt, strlvls, GEX_NO_FLAGS);
+  // TODO -- handle strided get/put for non-registered memory
+  if (blocking) {
+    // TODO GEX convert to NB with task-yield
+    if (isGet) {
+      gex_VIS_StridedGetBlocking(myteam, dstaddr, dststr, remnode, srcaddr,
+                                 srcstr, elemsz, cnt, strlvls, GEX_NO_FLAGS);
+    } else {
+      gex_VIS_StridedPutBlocking(myteam, remnode, dstaddr, dststr, srcaddr,
+                                 srcstr, elemsz, cnt, strlvls, GEX_NO_FLAGS);
+    }
+    return GEX_EVENT_INVALID;
+  }
+
+  // As for chpl_comm_put_nb(), GEX_EVENT_DEFER means the source will not
+  // change until the PUT is complete.
+  if (isGet) {
+    return gex_VIS_StridedGetNB(myteam, dstaddr, dststr, remnode, srcaddr,
+                                srcstr, elemsz, cnt, strlvls, GEX_NO_FLAGS);
+  }
+  return gex_VIS_StridedPutNB(myteam, remnode, dstaddr, dststr, srcaddr,
+                              srcstr, elemsz, cnt, strlvls, GEX_EVENT_DEFER,
+                              GEX_NO_FLAGS);
 }
 
-// See the comment for chpl_comm_get_strd().
-void  chpl_comm_put_strd(void* dstaddr, size_t* dststrides, c_nodeid_t dstnode_id,
+void  chpl_comm_get_strd(void* dstaddr, size_t* dststrides, c_nodeid_t srcnode_id,
                          void* srcaddr, size_t* srcstrides, size_t* count,
                          int32_t stridelevels, size_t elemSize, int32_t commID,
                          int ln, int32_t fn) {
-  int i;
-  const size_t strlvls = (size_t)stridelevels;
-  // Avoid 0-lengh VLA when stridelevels is 0 (contiguous transfer), gasnet
-  // will ignore arrays in this case
-  const size_t strlvls_nz = strlvls == 0 ? 1 : strlvls;
-  const gasnet_node_t dstnode = (gasnet_node_t)dstnode_id;
-
-  ptrdiff_t dststr[strlvls_nz];
-  ptrdiff_t srcstr[strlvls_nz];
-  size_t cnt[strlvls_nz];
-  size_t elemsz = count[0] * elemSize;
-
-  for (i=0; i<strlvls; i++) {
-    srcstr[i] = srcstrides[i] * elemSize;
-    dststr[i] = dststrides[i] * elemSize;
-    cnt[i] = count[i+1];
-  }
-
-  // Communications callback support
-  if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_put_strd)) {
-      chpl_comm_cb_info_t cb_data =
-        {chpl_comm_cb_event_kind_put_strd, chpl_nodeID, dstnode_id,
-         .iu.comm_strd={srcaddr, srcstrides, dstaddr, dststrides, count,
-                        stridelevels, elemSize, commID, ln, fn}};
-      chpl_comm_do_callbacks (&cb_data);
-  }
-
-  // the case (chpl_nodeID == dstnode) is internally managed inside gasnet
-  chpl_comm_diags_verbose_rdmaStrd("put", dstnode, ln, fn, commID);
-  if (chpl_nodeID != dstnode) {
-    chpl_comm_diags_incr(put);
-  }
+  (void) do_strd_xfer(true, true, dstaddr, dststrides, srcnode_id,
+                      srcaddr, srcstrides, count, stridelevels, elemSize,
+                      commID, ln, fn);
+}
 
-  // TODO -- handle strided put for non-registered memory
-  // TODO GEX convert to NB with task-yield
-  gex_VIS_StridedPutBlocking(myteam, dstnode, dstaddr, dststr, srcaddr, srcstr, elemsz, cnt, strlvls, GEX_NO_FLAGS);
+void  chpl_comm_put_strd(void* dstaddr, size_t* dststrides, c_nodeid_t dstnode_id,
+                         void* srcaddr, size_t* srcstrides, size_t* count,
+                         int32_t stridelevels, size_t elemSize, int32_t commID,
+                         int ln, int32_t fn) {
+  (void) do_strd_xfer(false, true, dstaddr, dststrides, dstnode_id,
+                      srcaddr, srcstrides, count, stridelevels, elemSize,
+                      commID, ln, fn);
+}
+
+chpl_comm_nb_handle_t chpl_comm_get_strd_nb(void* dstaddr, size_t* dststrides,
+                                            c_nodeid_t srcnode_id,
+                                            void* srcaddr, size_t* srcstrides,
+                                            size_t* count, int32_t stridelevels,
+                                            size_t elemSize, int32_t commID,
+                                            int ln, int32_t fn) {
+  return (chpl_comm_nb_handle_t)
+         do_strd_xfer(true, false, dstaddr, dststrides, srcnode_id,
+                      srcaddr, srcstrides, count, stridelevels, elemSize,
+                      commID, ln, fn);
+}
+
+chpl_comm_nb_handle_t chpl_comm_put_strd_nb(void* dstaddr, size_t* dststrides,
+                                            c_nodeid_t dstnode_id,
+                                            void* srcaddr, size_t* srcstrides,
+                                            size_t* count, int32_t stridelevels,
+                                            size_t elemSize, int32_t commID,
+                                            int ln, int32_t fn) {
+  return (chpl_comm_nb_handle_t)
+         do_strd_xfer(false, false, dstaddr, dststrides, dstnode_id,
+                      srcaddr, srcstrides, count, stridelevels, elemSize,
+                      commID, ln, fn);
 }
 
 #define MAX_UNORDERED_TRANS_SZ 1024
@@ -1429,6 +1740,31 @@ void chpl_comm_put_unordered(void* addr, c_nodeid_t node, void* raddr,
 
 void chpl_comm_getput_unordered_task_fence(void) { }
 
+//
+// Get GASNet network buffer space for an nbytes fork request to node,
+// using a negotiated-payload AM so the message can be built there
+// directly.  It asks for the space with GEX_FLAG_IMMEDIATE, so that
+// under backpressure we get control back instead of blocking inside
+// GASNet.  Then we poll (our own polling may be what relieves the
+// backpressure), let other tasks run if do_yield, and try again.
+//
+static inline
+gex_AM_SrcDesc_t prepare_fork_am(c_nodeid_t node, size_t nbytes,
+                                 chpl_bool do_yield) {
+  gex_AM_SrcDesc_t sd;
+
+  while ((sd = gex_AM_PrepareRequestMedium(myteam, node, NULL,
+                                           nbytes, nbytes, NULL,
+                                           GEX_FLAG_IMMEDIATE, 0))
+         == GEX_AM_SRCDESC_NO_OP) {
+    am_poll_try();
+    if (do_yield)
+      chpl_task_yield();
+  }
+
+  return sd;
+}
+
 static inline
 void  execute_on_common(c_nodeid_t node, c_sublocid_t subloc,
                         chpl_fn_int_t fid,
@@ -1474,7 +1810,7 @@ void  execute_on_common(c_nodeid_t node, c_sublocid_t subloc,
   arg->kind = CHPL_ARG_BUNDLE_KIND_COMM;
 
   if (small || large) {
-    special_fork_t tmp;
+    gex_AM_SrcDesc_t sd;
 
     small_fork_hdr_t hdr = { .caller = chpl_nodeID,
                              .subloc = subloc,
@@ -1484,11 +1820,13 @@ void  execute_on_common(c_nodeid_t node, c_sublocid_t subloc,
                              .payload_size = payload_size };
 
     if (small) {
-      // Copy the argument bundle payload to a smaller message.
-      // We'll reconstruct the argument bundle payload on the other end.
-      // This copying should have minor performance impact because
-      // arg_size is small.
-      small_fork_hdr_t *f = &tmp.small;
+      // Build a smaller message holding just the header and the
+      // argument bundle payload, right in the network buffer.  We'll
+      // reconstruct the argument bundle on the other end.
+      small_fork_hdr_t *f;
+
+      sd = prepare_fork_am(node, small_msg_size, !fast);
+      f = (small_fork_hdr_t*) gex_AM_SrcDescAddr(sd);
 
       // Copy in the header
       *f = hdr;
@@ -1497,11 +1835,11 @@ void  execute_on_common(c_nodeid_t node, c_sublocid_t subloc,
       memcpy(f + 1, arg + 1, payload_size);
 
       // Send the AM
-      GASNET_Safe(gasnet_AMRequestMedium0(node, op, f, small_msg_size));
+      gex_AM_CommitRequestMedium0(sd, op, small_msg_size);
     } else {
       // Setup a small message pointing to arg
       // so the other side can GET from it
-      large_fork_t *f = &tmp.large;
+      large_fork_t *f;
       chpl_comm_on_bundle_t* use_arg;
 
       if (blocking)
@@ -1517,6 +1855,9 @@ void  execute_on_common(c_nodeid_t node, c_sublocid_t subloc,
         chpl_memcpy(use_arg, arg, arg_size);
       }
 
+      sd = prepare_fork_am(node, sizeof(large_fork_t), !fast);
+      f = (large_fork_t*) gex_AM_SrcDescAddr(sd);
+
       // Copy in the header
       f->hdr = hdr;
 
@@ -1525,7 +1866,7 @@ void  execute_on_common(c_nodeid_t node, c_sublocid_t subloc,
       f->arg_size = arg_size;
 
       // Send the AM
-      GASNET_Safe(gasnet_AMRequestMedium0(node, op, f, sizeof(large_fork_t)));
+      gex_AM_CommitRequestMedium0(sd, op, sizeof(large_fork_t));
     }
   } else {
     // Neither small nor large
@@ -1554,7 +1895,8 @@ void  chpl_comm_execute_on(c_nodeid_t node, c_sublocid_t subloc,
     chpl_ftable_call(fid, arg);
   } else {
     // Communications callback support
-    if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_executeOn)) {
+    if (chpl_comm_want_callbacks(chpl_comm_cb_event_kind_executeOn,
+                                 node, arg_size)) {
       chpl_comm_cb_info_t cb_data =
         {chpl_comm_cb_event_kind_executeOn, chpl_nodeID, node,
          .iu.executeOn={subloc, fid, arg, arg_size, ln, fn}};
@@ -1578,7 +1920,8 @@ void  chpl_comm_execute_on_nb(c_nodeid_t node, c_sublocid_t subloc,
     assert(0); // locale model code should prevent this...
   } else {
     // Communications callback support
-    if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_executeOn_nb)) {
+    if (chpl_comm_want_callbacks(chpl_comm_cb_event_kind_executeOn_nb,
+                                 node, arg_size)) {
       chpl_comm_cb_info_t cb_data =
         {chpl_comm_cb_event_kind_executeOn_nb, chpl_nodeID, node,
          .iu.executeOn={subloc, fid, arg, arg_size, ln, fn}};
@@ -1603,7 +1946,8 @@ void  chpl_comm_execute_on_fast(c_nodeid_t node, c_sublocid_t subloc,
     chpl_ftable_call(fid, arg);
   } else {
     // Communications callback support
-    if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_executeOn_fast)) {
+    if (chpl_comm_want_callbacks(chpl_comm_cb_event_kind_executeOn_fast,
+                                 node, arg_size)) {
       chpl_comm_cb_info_t cb_data =
         {chpl_comm_cb_event_kind_executeOn_fast, chpl_nodeID, node,
          .iu.executeOn={subloc, fid, arg, arg_size, ln, fn}};
@@ -607,7 +607,7 @@ chpl_comm_nb_handle_t chpl_comm_put_nb(void *addr, c_nodeid_t node, void* raddr,
   int remote_in_segment;
 
   // Communication callbacks
-  if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_put_nb)) {
+  if (chpl_comm_want_callbacks(chpl_comm_cb_event_kind_put_nb, node, size)) {
     chpl_comm_cb_info_t cb_data =
       {chpl_comm_cb_event_kind_put_nb, chpl_nodeID, node,
        .iu.comm={addr, raddr, size, commID, ln, fn}};
@@ -642,7 +642,7 @@ chpl_comm_nb_handle_t chpl_comm_get_nb(void* addr, c_nodeid_t node, void* raddr,
   int remote_in_segment;
 
   // Communications callback support
-  if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_get_nb)) {
+  if (chpl_comm_want_callbacks(chpl_comm_cb_event_kind_get_nb, node, size)) {
     chpl_comm_cb_info_t cb_data =
       {chpl_comm_cb_event_kind_get_nb, chpl_nodeID, node,
        .iu.comm={addr, raddr, size, commID, ln, fn}};
@@ -999,26 +999,6 @@ void chpl_comm_impl_regMemHeapInfo(void** start_p, size_t* size_p) {
 #endif
 }
 
-wide_ptr_t* chpl_comm_broadcast_global_vars_helper(void) {
-  //
-  // Gather the global variables' wide pointers on node 0 into the
-  // buffer at the front of our communicable segment.  We don't have
-  // to communicate that because everyone already knows where it is.
-  // We do need to delay returning on the non-0 nodes until after
-  // node 0 has filled in that buffer, however.
-  //
-  if (chpl_nodeID == 0) {
-    for (int i = 0; i < chpl_numGlobalsOnHeap; i++) {
-      ((wide_ptr_t*) seginfo_table[0].addr)[i] = *chpl_globals_registry[i];
-    }
-    chpl_comm_barrier("fill node 0 globals buf");
-    return NULL; // so common code won't try to free it!
-  } else {
-    chpl_comm_barrier("fill node 0 globals buf");
-    return (wide_ptr_t*) seginfo_table[0].addr;
-  }
-}
-
 void chpl_comm_broadcast_private(int id, size_t size) {
   int  node, offset;
   int  payloadSize = size + sizeof(priv_bcast_t);
@@ -1076,10 +1056,33 @@ void chpl_comm_broadcast_private(int id, size_t size) {
   chpl_mem_free(done, 0, 0);
 }
 
-void chpl_comm_impl_barrier(const char *msg) {
-  int id = (int) msg[0];
+static chpl_bool bar_in_progress;
+static int bar_id;
+
+void chpl_comm_impl_barrier_begin(const char *msg) {
+  if (bar_in_progress) {
+    chpl_internal_error("barrier begun while another is in progress");
+  }
+  bar_id = (int) msg[0];
+  bar_in_progress = true;
+  gasnet_barrier_notify(bar_id, 0);
+}
+
+chpl_bool chpl_comm_impl_barrier_test(void) {
   int retval;
 
+  if (!bar_in_progress) {
+    return true;
+  }
+  if ((retval = gasnet_barrier_try(bar_id, 0)) == GASNET_ERR_NOT_READY) {
+    return false;
+  }
+  GASNET_Safe_Retval(gasnet_barrier_try(bar_id, 0), retval);
+  bar_in_progress = false;
+  return true;
+}
+
+void chpl_comm_impl_barrier_wait(void) {
   //
   // We don't want to just do a gasnet_barrier_wait() here, because
   // GASNet will put us to work polling, and we already have a polling
@@ -1089,11 +1092,36 @@ void chpl_comm_impl_barrier(const char *msg) {
   // satisfy; see chpl_comm.h.  This prevents us from monopolizing the
   // processor while waiting.
   //
-  gasnet_barrier_notify(id, 0);
-  while ((retval = gasnet_barrier_try(id, 0)) == GASNET_ERR_NOT_READY) {
+  while (!chpl_comm_impl_barrier_test()) {
     chpl_task_yield();
   }
-  GASNET_Safe_Retval(gasnet_barrier_try(id, 0), retval);
+}
+
+void chpl_comm_impl_barrier(const char *msg) {
+  chpl_comm_impl_barrier_begin(msg);
+  chpl_comm_impl_barrier_wait();
+}
+
+//
+// GASNet-1 collectives need their own setup and thread restrictions,
+// so we use the runtime's generic ones.
+//
+void chpl_comm_impl_bcast(c_nodeid_t root, void* buf, size_t size) {
+  chpl_comm_coll_bcast_generic(root, buf, size);
+}
+
+void chpl_comm_impl_reduce(c_nodeid_t root, const void* src, void* dst,
+                           size_t count, int type, int op) {
+  chpl_comm_coll_reduce_generic(root, src, dst, count,
+                                (chpl_comm_coll_type_t) type,
+                                (chpl_comm_coll_op_t) op);
+}
+
+void chpl_comm_impl_allreduce(const void* src, void* dst, size_t count,
+                              int type, int op) {
+  chpl_comm_coll_allreduce_generic(src, dst, count,
+                                   (chpl_comm_coll_type_t) type,
+                                   (chpl_comm_coll_op_t) op);
 }
 
 void chpl_comm_pre_task_exit(int all) {
@@ -1136,7 +1164,7 @@ void  chpl_comm_put(void* addr, c_nodeid_t node, void* raddr,
     memmove(raddr, addr, size);
   } else {
     // Communications callback support
-    if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_put)) {
+    if (chpl_comm_want_callbacks(chpl_comm_cb_event_kind_put, node, size)) {
       chpl_comm_cb_info_t cb_data =
         {chpl_comm_cb_event_kind_put, chpl_nodeID, node,
          .iu.comm={addr, raddr, size, commID, ln, fn}};
@@ -1211,7 +1239,7 @@ void  chpl_comm_get(void* addr, c_nodeid_t node, void* raddr,
     memmove(addr, raddr, size);
   } else {
     // Communications callback support
-    if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_get)) {
+    if (chpl_comm_want_callbacks(chpl_comm_cb_event_kind_get, node, size)) {
       chpl_comm_cb_info_t cb_data =
         {chpl_comm_cb_event_kind_get, chpl_nodeID, node,
          .iu.comm={addr, raddr, size, commID, ln, fn}};
@@ -1351,7 +1379,9 @@ void  chpl_comm_get_strd(void* dstaddr, size_t* dststrides, c_nodeid_t srcnode_i
   }
 
   // Communications callback support
-  if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_get_strd)) {
+  if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_get_strd)
+      && chpl_comm_want_callbacks(chpl_comm_cb_event_kind_get_strd, srcnode_id,
+          chpl_comm_cb_strd_size(count, stridelevels, elemSize))) {
     chpl_comm_cb_info_t cb_data =
       {chpl_comm_cb_event_kind_get_strd, chpl_nodeID, srcnode_id,
        .iu.comm_strd={srcaddr, srcstrides, dstaddr, dststrides, count,
@@ -1396,7 +1426,9 @@ void  chpl_comm_put_strd(void* dstaddr, size_t* dststrides, c_nodeid_t dstnode_i
   }
 
   // Communications callback support
-  if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_put_strd)) {
+  if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_put_strd)
+      && chpl_comm_want_callbacks(chpl_comm_cb_event_kind_put_strd, dstnode_id,
+          chpl_comm_cb_strd_size(count, stridelevels, elemSize))) {
       chpl_comm_cb_info_t cb_data =
         {chpl_comm_cb_event_kind_put_strd, chpl_nodeID, dstnode_id,
          .iu.comm_strd={srcaddr, srcstrides, dstaddr, dststrides, count,
@@ -1414,6 +1446,31 @@ void  chpl_comm_put_strd(void* dstaddr, size_t* dststrides, c_nodeid_t dstnode_i
   gasnet_puts_bulk(dstnode, dstaddr, dststr, srcaddr, srcstr, cnt, strlvls);
 }
 
+//
+// The strided transfers above block, so these are complete on return.
+//
+chpl_comm_nb_handle_t chpl_comm_put_strd_nb(void* dstaddr, size_t* dststrides,
+                                            c_nodeid_t dstnode,
+                                            void* srcaddr, size_t* srcstrides,
+                                            size_t* count, int32_t stridelevels,
+                                            size_t elemSize, int32_t commID,
+                                            int ln, int32_t fn) {
+  chpl_comm_put_strd(dstaddr, dststrides, dstnode, srcaddr, srcstrides,
+                     count, stridelevels, elemSize, commID, ln, fn);
+  return NULL;
+}
+
+chpl_comm_nb_handle_t chpl_comm_get_strd_nb(void* dstaddr, size_t* dststrides,
+                                            c_nodeid_t srcnode,
+                                            void* srcaddr, size_t* srcstrides,
+                                            size_t* count, int32_t stridelevels,
+                                            size_t elemSize, int32_t commID,
+                                            int ln, int32_t fn) {
+  chpl_comm_get_strd(dstaddr, dststrides, srcnode, srcaddr, srcstrides,
+                     count, stridelevels, elemSize, commID, ln, fn);
+  return NULL;
+}
+
 #define MAX_UNORDERED_TRANS_SZ 1024
 void chpl_comm_getput_unordered(c_nodeid_t dstnode, void* dstaddr,
                                 c_nodeid_t srcnode, void* srcaddr,
@@ -1462,6 +1519,10 @@ void chpl_comm_put_unordered(void* addr, c_nodeid_t node, void* raddr,
 
 void chpl_comm_getput_unordered_task_fence(void) { }
 
+void chpl_comm_impl_unordered_task_fence(void) { }
+
+void chpl_comm_impl_task_end(void) { }
+
 static inline
 void  execute_on_common(c_nodeid_t node, c_sublocid_t subloc,
                         chpl_fn_int_t fid,
@@ -1587,7 +1648,8 @@ void  chpl_comm_execute_on(c_nodeid_t node, c_sublocid_t subloc,
     chpl_ftable_call(fid, arg);
   } else {
     // Communications callback support
-    if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_executeOn)) {
+    if (chpl_comm_want_callbacks(chpl_comm_cb_event_kind_executeOn,
+                                 node, arg_size)) {
       chpl_comm_cb_info_t cb_data =
         {chpl_comm_cb_event_kind_executeOn, chpl_nodeID, node,
          .iu.executeOn={subloc, fid, arg, arg_size, ln, fn}};
@@ -1611,7 +1673,8 @@ void  chpl_comm_execute_on_nb(c_nodeid_t node, c_sublocid_t subloc,
     assert(0); // locale model code should prevent this...
   } else {
     // Communications callback support
-    if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_executeOn_nb)) {
+    if (chpl_comm_want_callbacks(chpl_comm_cb_event_kind_executeOn_nb,
+                                 node, arg_size)) {
       chpl_comm_cb_info_t cb_data =
         {chpl_comm_cb_event_kind_executeOn_nb, chpl_nodeID, node,
          .iu.executeOn={subloc, fid, arg, arg_size, ln, fn}};
@@ -1636,7 +1699,8 @@ void  chpl_comm_execute_on_fast(c_nodeid_t node, c_sublocid_t subloc,
     chpl_ftable_call(fid, arg);
   } else {
     // Communications callback support
-    if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_executeOn_fast)) {
+    if (chpl_comm_want_callbacks(chpl_comm_cb_event_kind_executeOn_fast,
+                                 node, arg_size)) {
       chpl_comm_cb_info_t cb_data =
         {chpl_comm_cb_event_kind_executeOn_fast, chpl_nodeID, node,
          .iu.executeOn={subloc, fid, arg, arg_size, ln, fn}};
@@ -151,12 +151,16 @@ void chpl_comm_rollcall(void) {
   chpl_msg(2, "executing on a single node\n");
 }
 
-wide_ptr_t* chpl_comm_broadcast_global_vars_helper(void) { return NULL; }
-
 void chpl_comm_broadcast_private(int id, size_t size) { }
 
 void chpl_comm_impl_barrier(const char *msg) { }
 
+void chpl_comm_impl_barrier_begin(const char *msg) { }
+
+chpl_bool chpl_comm_impl_barrier_test(void) { return true; }
+
+void chpl_comm_impl_barrier_wait(void) { }
+
 void chpl_comm_pre_task_exit(int all) { }
 
 void chpl_comm_exit(int all, int status) { }
@@ -201,6 +205,31 @@ void  chpl_comm_get_strd(void* dstaddr_arg, size_t* dststrides, c_nodeid_t srcno
                   commID, ln, fn);
 }
 
+//
+// The strided transfers above are done by the time they return.
+//
+chpl_comm_nb_handle_t chpl_comm_put_strd_nb(void* dstaddr, size_t* dststrides,
+                                            c_nodeid_t dstnode,
+                                            void* srcaddr, size_t* srcstrides,
+                                            size_t* count, int32_t stridelevels,
+                                            size_t elemSize, int32_t commID,
+                                            int ln, int32_t fn) {
+  chpl_comm_put_strd(dstaddr, dststrides, dstnode, srcaddr, srcstrides,
+                     count, stridelevels, elemSize, commID, ln, fn);
+  return NULL;
+}
+
+chpl_comm_nb_handle_t chpl_comm_get_strd_nb(void* dstaddr, size_t* dststrides,
+                                            c_nodeid_t srcnode,
+                                            void* srcaddr, size_t* srcstrides,
+                                            size_t* count, int32_t stridelevels,
+                                            size_t elemSize, int32_t commID,
+                                            int ln, int32_t fn) {
+  chpl_comm_get_strd(dstaddr, dststrides, srcnode, srcaddr, srcstrides,
+                     count, stridelevels, elemSize, commID, ln, fn);
+  return NULL;
+}
+
 void chpl_comm_getput_unordered(c_nodeid_t dstnode, void* dstaddr,
                                 c_nodeid_t srcnode, void* srcaddr,
                                 size_t size, int32_t commID,
@@ -0,0 +1,224 @@
+/*
+ * Copyright 2020-2023 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Cross-memory attach (CMA) to co-located locales for the OFI-based
+// Chapel comm layer.
+//
+// When several locales run on the same node, RMA between them would
+// otherwise go out through the provider and back in again.  On Linux
+// we can instead copy directly between the two processes' memory with
+// process_vm_readv() and process_vm_writev().  Those need nothing from
+// the peer, so they work on whatever memory it has, fixed heap or not.
+// They do need the kernel to allow us to access the peer, which ptrace
+// restrictions (such as Yama) can prevent, so we test every peer during
+// setup and only use CMA for the ones where that worked.
+//
+
+// This #define needs to be before the other #includes
+// since it affects included files (for process_vm_readv/writev)
+#ifdef __linux__
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#endif
+
+#include "chplrt.h"
+
+#include "chpl-comm.h"
+#include "chpl-env.h"
+#include "chpl-mem-sys.h"
+#include "error.h"
+
+#include "comm-ofi-internal.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/types.h>
+#include <sys/uio.h>
+#endif
+
+
+//
+// Indexed by node, the process ID to use for CMA to that node, or 0 if
+// we can't use CMA to reach it.  NULL if we can't use CMA to reach any
+// node.
+//
+pid_t* chpl_comm_ofi_cma_pids = NULL;
+
+
+#ifdef __linux__
+
+//
+// What each locale tells the others about itself.  A peer is only used
+// if reading this record from its memory with CMA gives back what it
+// sent, which shows both that we can access it and that the process ID
+// refers to the process we think it does.
+//
+typedef struct {
+  uint64_t hostHash;
+  uint64_t nonce;
+  pid_t pid;
+  void* self;
+} cmaInfo_t;
+
+static cmaInfo_t myCmaInfo;
+
+
+static
+uint64_t hostHash(void) {
+  char hostname[HOST_NAME_MAX + 1];
+  uint64_t hash = UINT64_C(14695981039346656037);
+
+  memset(hostname, 0, sizeof(hostname));
+  CHK_TRUE(gethostname(hostname, sizeof(hostname)) == 0);
+  for (const char* p = hostname; *p != '\0'; p++) {
+    hash = (hash ^ (unsigned char) *p) * UINT64_C(1099511628211);
+  }
+  return hash;
+}
+
+
+static
+chpl_bool cmaProbe(const cmaInfo_t* peer) {
+  cmaInfo_t got;
+  struct iovec liov = { &got, sizeof(got) };
+  struct iovec riov = { peer->self, sizeof(got) };
+
+  if (process_vm_readv(peer->pid, &liov, 1, &riov, 1, 0) != sizeof(got)) {
+    return false;
+  }
+  return memcmp(&got, peer, sizeof(got)) == 0;
+}
+
+
+void chpl_comm_ofi_cma_init(void) {
+  //
+  // This is collective: everyone has to participate in the allgather,
+  // even the locales that won't end up using CMA.
+  //
+  chpl_bool useCma = chpl_env_rt_get_bool("COMM_OFI_CMA", true)
+                     && chpl_get_num_locales_on_node() > 1;
+
+  struct timespec ts;
+  (void) clock_gettime(CLOCK_REALTIME, &ts);
+
+  memset(&myCmaInfo, 0, sizeof(myCmaInfo));
+  myCmaInfo.hostHash = useCma ? hostHash() : 0;
+  myCmaInfo.nonce = (((uint64_t) ts.tv_sec << 32) ^ (uint64_t) ts.tv_nsec
+                     ^ ((uint64_t) getpid() << 16) ^ (uint64_t) chpl_nodeID);
+  myCmaInfo.pid = getpid();
+  myCmaInfo.self = &myCmaInfo;
+
+  cmaInfo_t* infos;
+  CHK_SYS_CALLOC(infos, chpl_numNodes);
+  chpl_comm_ofi_oob_allgather(&myCmaInfo, infos, sizeof(infos[0]));
+
+  if (useCma) {
+    int numPeers = 0;
+    pid_t* pids;
+    CHK_SYS_CALLOC(pids, chpl_numNodes);
+    for (int i = 0; i < chpl_numNodes; i++) {
+      if (i != chpl_nodeID
+          && infos[i].hostHash == myCmaInfo.hostHash
+          && cmaProbe(&infos[i])) {
+        pids[i] = infos[i].pid;
+        numPeers++;
+      }
+    }
+
+    DBG_PRINTF(DBG_CMA, "CMA reaches %d co-located locale%s", numPeers,
+               (numPeers == 1) ? "" : "s");
+    if (numPeers > 0) {
+      chpl_comm_ofi_cma_pids = pids;
+    } else {
+      sys_free(pids);
+    }
+  }
+
+  sys_free(infos);
+}
+
+
+//
+// Copy between here and a co-located node.  Returns how many bytes were
+// actually moved, which may be fewer than requested if the kernel gave
+// up partway or the remote memory isn't accessible this way (device
+// memory, for example); the caller is expected to move the rest some
+// other way.
+//
+static
+size_t cmaXfer(chpl_bool isPut, void* addr, c_nodeid_t node, void* raddr,
+               size_t size) {
+  size_t done = 0;
+  while (done < size) {
+    struct iovec liov = { (char*) addr + done, size - done };
+    struct iovec riov = { (char*) raddr + done, size - done };
+    ssize_t ret = isPut
+                  ? process_vm_writev(chpl_comm_ofi_cma_pids[node],
+                                      &liov, 1, &riov, 1, 0)
+                  : process_vm_readv(chpl_comm_ofi_cma_pids[node],
+                                     &liov, 1, &riov, 1, 0);
+    if (ret <= 0) {
+      DBG_PRINTF(DBG_CMA, "CMA %s %d:%p failed after %zd of %zd bytes",
+                 isPut ? "PUT" : "GET", (int) node, raddr, done, size);
+      break;
+    }
+    done += ret;
+  }
+  return done;
+}
+
+
+size_t chpl_comm_ofi_cma_put(const void* addr, c_nodeid_t node, void* raddr,
+                             size_t size) {
+  return cmaXfer(true, (void*) addr, node, raddr, size);
+}
+
+
+size_t chpl_comm_ofi_cma_get(void* addr, c_nodeid_t node, void* raddr,
+                             size_t size) {
+  return cmaXfer(false, addr, node, raddr, size);
+}
+
+#else // __linux__
+
+void chpl_comm_ofi_cma_init(void) {
+  // Not available here.  Locales all run the same executable, so none of
+  // them will be expecting us to exchange CMA information.
+}
+
+
+size_t chpl_comm_ofi_cma_put(const void* addr, c_nodeid_t node, void* raddr,
+                             size_t size) {
+  return 0;
+}
+
+
+size_t chpl_comm_ofi_cma_get(void* addr, c_nodeid_t node, void* raddr,
+                             size_t size) {
+  return 0;
+}
+
+#endif // __linux__
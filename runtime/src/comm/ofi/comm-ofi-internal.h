@@ -31,6 +31,7 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include <sys/types.h>
 
 #include <rdma/fabric.h>
 #include <rdma/fi_domain.h>
@@ -76,6 +77,7 @@ extern "C" {
   m(MR_KEY,                 "mem reg: remote region keys")              \
   m(MR_BB,                  "mem reg: bounce buffers")                  \
   m(HUGEPAGES,              "hugepages")                                \
+  m(CMA,                    "cross-memory attach to co-located locales")\
   m(TCIPS,                  "tx context alloc/free")                    \
   m(OOB,                    "out-of-band calls")                        \
   m(BARRIER,                "barriers")                                 \
@@ -293,6 +295,24 @@ size_t chpl_comm_ofi_hp_gethugepagesize(void);
 chpl_bool chpl_comm_ofi_hp_supported(void);
 
 
+//
+// Cross-memory attach interface
+//
+
+// Indexed by node: process ID to use for CMA to it, or 0 if it can't be
+// reached that way.  NULL if no node can.
+extern pid_t* chpl_comm_ofi_cma_pids;
+
+void chpl_comm_ofi_cma_init(void);
+size_t chpl_comm_ofi_cma_put(const void*, c_nodeid_t, void*, size_t);
+size_t chpl_comm_ofi_cma_get(void*, c_nodeid_t, void*, size_t);
+
+static inline
+chpl_bool chpl_comm_ofi_cma_reaches(c_nodeid_t node) {
+  return chpl_comm_ofi_cma_pids != NULL && chpl_comm_ofi_cma_pids[node] != 0;
+}
+
+
 //
 // Other/utility
 //
@@ -131,8 +131,7 @@ void chpl_comm_ofi_oob_barrier(void) {
 }
 
 
-static void allgather_kvs(const void* mine, void* all, size_t size,
-                          size_t chunk_off, size_t chunk_size);
+static void allgather_kvs(const void* mine, void* all, size_t size);
 
 void chpl_comm_ofi_oob_allgather(const void* mine, void* all, size_t size) {
   if (PMI_Allgather != NULL) {
@@ -173,18 +172,7 @@ void chpl_comm_ofi_oob_allgather(const void* mine, void* all, size_t size) {
     // Fall back to KVS-based allgather.
     DBG_PRINTF(DBG_OOB, "OOB allgather via KVS: %zd", size);
 
-    //
-    // There is a limit on the maximum size of a KVS value, so we may
-    // need to do this in multiple chunks.
-    //
-    size_t size_remaining = size;
-    size_t chunk_size_max = (PMI2_MAX_VALLEN - 1) / 2; // unencoded max chunk
-    while (size_remaining > chunk_size_max) {
-      allgather_kvs(mine, all, size, size - size_remaining, chunk_size_max);
-      size_remaining -= chunk_size_max;
-    }
-
-    allgather_kvs(mine, all, size, size - size_remaining, size_remaining);
+    allgather_kvs(mine, all, size);
   }
 }
 
@@ -193,38 +181,60 @@ static inline void encode_kvs(char* enc, const char* raw, size_t size);
 static inline void decode_kvs(char* raw, const char* enc, size_t size);
 
 static
-void allgather_kvs(const void* mine, void* all, size_t size,
-                   size_t chunk_off, size_t chunk_size) {
+void allgather_kvs(const void* mine, void* all, size_t size) {
+  //
+  // There is a limit on the maximum size of a KVS value, so we may
+  // need to do this in multiple chunks.  We put all of our chunks
+  // before fencing, so that the whole exchange costs just one fence
+  // no matter how large it is.
+  //
+  const size_t chunk_size_max = (PMI2_MAX_VALLEN - 1) / 2; // unencoded max
+  const int num_chunks = (size == 0)
+                         ? 1
+                         : (int) ((size + chunk_size_max - 1) / chunk_size_max);
+
   //
   // Key values need to be NUL-terminated printable strings.
   //
-  size_t chunk_size_enc = 2 * chunk_size + 1;
+  size_t chunk_size_enc = 2 * chunk_size_max + 1;
 
   char* enc;
   CHK_SYS_MALLOC_SZ(enc, 1, chunk_size_enc);
-  encode_kvs(enc, (const char*) mine + chunk_off, chunk_size);
 
   char key[64];
-  const char* key_fmt = "ChplAllgthr%d_N%d";
+  const char* key_fmt = "ChplAllgthr%d_N%d_C%d";
   static int key_cntr;
 
   key_cntr++;
-  CHK_TRUE(snprintf(key, sizeof(key), key_fmt, key_cntr, chpl_nodeID)
-           < sizeof(key));
 
-  DBG_PRINTF(DBG_OOB, "PMI2_KVS_Put(\"%s\", \"%s\")", key, enc);
-  PMI2_CHK(PMI2_KVS_Put(key, enc));
+  for (int c = 0; c < num_chunks; c++) {
+    const size_t chunk_off = c * chunk_size_max;
+    const size_t chunk_size = (size - chunk_off < chunk_size_max)
+                              ? size - chunk_off
+                              : chunk_size_max;
+    encode_kvs(enc, (const char*) mine + chunk_off, chunk_size);
+    CHK_TRUE(snprintf(key, sizeof(key), key_fmt, key_cntr, chpl_nodeID, c)
+             < sizeof(key));
+    DBG_PRINTF(DBG_OOB, "PMI2_KVS_Put(\"%s\", \"%s\")", key, enc);
+    PMI2_CHK(PMI2_KVS_Put(key, enc));
+  }
 
   PMI2_CHK(PMI2_KVS_Fence());
 
   for (int node = 0; node < chpl_numNodes; node++) {
-    CHK_TRUE(snprintf(key, sizeof(key), key_fmt, key_cntr, node)
-             < sizeof(key));
-    int chunk_size_ret;
-    PMI2_CHK(PMI2_KVS_Get(NULL, PMI2_ID_NULL, key, enc,
-                          chunk_size_enc, &chunk_size_ret));
-    CHK_TRUE(((size_t) chunk_size_ret) == chunk_size_enc - 1);
-    decode_kvs((char*) all + node * size + chunk_off, enc, chunk_size);
+    for (int c = 0; c < num_chunks; c++) {
+      const size_t chunk_off = c * chunk_size_max;
+      const size_t chunk_size = (size - chunk_off < chunk_size_max)
+                                ? size - chunk_off
+                                : chunk_size_max;
+      CHK_TRUE(snprintf(key, sizeof(key), key_fmt, key_cntr, node, c)
+               < sizeof(key));
+      int chunk_size_ret;
+      PMI2_CHK(PMI2_KVS_Get(NULL, PMI2_ID_NULL, key, enc,
+                            chunk_size_enc, &chunk_size_ret));
+      CHK_TRUE(((size_t) chunk_size_ret) == 2 * chunk_size);
+      decode_kvs((char*) all + node * size + chunk_off, enc, chunk_size);
+    }
   }
 
   sys_free(enc);
@@ -38,6 +38,7 @@
 #include "chpl-gen-includes.h"
 #include "chpl-linefile-support.h"
 #include "chpl-mem.h"
+#include "chpl-mem-arena.h"
 #include "chpl-mem-sys.h"
 #include "chplsys.h"
 #include "chpl-tasks.h"
@@ -45,6 +46,10 @@
 #include "chpltypes.h"
 #include "error.h"
 
+#ifdef HAS_GPU_LOCALE
+#include "chpl-gpu.h"
+#endif
+
 #include "comm-ofi-internal.h"
 
 // Don't get warning macros for chpl_comm_get etc
@@ -162,7 +167,38 @@ static struct fid_av*   ofi_rxAv;           // address vector
 static fi_addr_t*       ofi_rxAddrs = NULL; // table of remote endpoint
                                             // addresses
 
-#define rxAddr(tcip, n) (tcip->addrs[n])
+//
+// With CHPL_RT_COMM_OFI_LAZY_AV set, remote addresses are not inserted
+// into the address vectors at startup.  Instead each AV keeps a
+// directory of everyone's endpoint names, and a node's address goes
+// into the AV the first time we send to that node.  Until then its
+// slot in the address table holds FI_ADDR_NOTAVAIL, so the fast path
+// is still just an index into the table.  This keeps per-node startup
+// work and provider AV state in proportion to the number of nodes we
+// actually talk to, rather than the job size.
+//
+struct avDir_t {
+  struct fid_av* av;                    // address vector
+  fi_addr_t* addrs;                     // table we fill in lazily
+  char* names;                          // everyone's endpoint names
+  size_t nameLen;                       // length of one name
+  pthread_mutex_t lock;                 // serializes inserts
+  struct avDir_t* next;
+};
+
+static chpl_bool envLazyAv;
+static struct avDir_t* avDirList;
+
+static fi_addr_t avAddrInsert(fi_addr_t*, c_nodeid_t);
+
+static inline
+fi_addr_t avAddr(fi_addr_t* addrs, c_nodeid_t node) {
+  fi_addr_t addr = addrs[node];
+  return (addr != FI_ADDR_NOTAVAIL) ? addr : avAddrInsert(addrs, node);
+}
+
+#define rxAddr(tcip, n) avAddr((tcip)->addrs, n)
+#define rmaAddr(tcip, n) avAddr((tcip)->rmaAddrs, n)
 
 //
 // Transmit support.
@@ -177,7 +213,13 @@ static chpl_bool envUseAmRxCntr;        // env: AMH uses receive counters
 static chpl_bool envInjectRMA;          // env: inject RMA messages
 static chpl_bool envInjectAMO;          // env: inject AMO messages
 static chpl_bool envInjectAM;           // env: inject AM messages
+static chpl_bool envAggregateAmAMO;     // env: aggregate unordered AM AMOs
+static chpl_bool envBatchExecOn;        // env: batch concurrent nb on-stmts
+static chpl_bool envBatchFree;          // env: batch remote frees
+static chpl_bool envStrdIov;            // env: vectored strided PUT/GET
 static chpl_bool envUseDedicatedAmhCores;  // env: use dedicated AM cores
+static chpl_bool envThrottle;           // env: per-node RMA throttling
+static size_t tinyRmaSize;              // PUT/GET size for tiny fast paths
 
 static int numTxCtxs;
 static int numRxCtxs;
@@ -185,8 +227,10 @@ static int numRxCtxs;
 struct perTxCtxInfo_t {
   atomic_bool allocated;        // true: in use; false: available
   chpl_bool bound;              // true: bound to an owner (usually a thread)
+  int nic;                      // index in nicTab
   struct fid_av* av;            // address vector
   fi_addr_t* addrs;             // addresses in address vector
+  fi_addr_t* rmaAddrs;          // addresses of remote RMA targets
   struct fid_ep* txCtx;         // transmit context (endpoint, if not scalable)
   struct fid_cq* txCQ;          // completion CQ
   struct fid_cntr* txCntr;      // completion counter
@@ -206,6 +250,38 @@ static int tciTabLen;
 static struct perTxCtxInfo_t* tciTab;
 static chpl_bool tciTabBindTxCtxs;
 
+/*
+Nodes may have several NICs of the same type. If CHPL_RT_COMM_OFI_NUM_NICS
+is > 1 (or 0, meaning all of them) we use up to that many of the NICs the
+topology layer says are near us, each with its own domain, and spread the
+worker transmit contexts across them. Threads prefer transmit contexts on
+NICs in their own socket; see findFreeTciTabEntry(). nicTab[0] is the NIC
+described by ofi_info and ofi_domain. It alone receives AMs and is the
+target of AMOs, because AMOs done by different NICs are not atomic with
+respect to each other. Each of the other NICs has an endpoint that is only
+the target of RMA, so RMA initiated on a NIC here lands on the
+corresponding NIC on the remote node. Without message ordering across
+NICs we can only do this in delivery-complete MCM mode.
+*/
+
+#define MAX_NICS 8
+
+struct nicInfo_t {
+  struct fi_info* info;         // fabric interface info
+  struct fid_fabric* fabric;    // fabric domain
+  struct fid_domain* domain;    // fabric access domain
+  int socket;                   // socket we're in, -1 if unknown
+  struct fid_av* av;            // AV shared by this NIC's endpoints
+  fi_addr_t* rxAddrs;           // remote AM receive endpoint addresses
+  fi_addr_t* rmaAddrs;          // remote RMA target endpoint addresses
+  struct fid_ep* rmaEp;         // RMA target endpoint
+  struct fid_cq* rmaCQ;         // RMA target endpoint CQ
+  struct fid_mr* mr;            // registration of memTab[0]
+};
+
+static int numNics = 1;
+static struct nicInfo_t nicTab[MAX_NICS];
+
 static size_t txCQLen;
 
 //
@@ -232,6 +308,56 @@ static memTab_t* memTabMap;
 
 static struct fid_mr* ofiMrTab[MAX_MEM_REGIONS];
 
+//
+// Local registration cache, for memory outside the regions above.
+// See mrCacheAcquire().
+//
+struct mrCacheEntry {
+  char* lo;
+  char* hi;
+  struct fid_mr* mr;
+  void* desc;
+  uint64_t lastUse;
+  int refs;
+};
+
+static struct mrCacheEntry* mrCache;    // sorted by lo, non-overlapping
+static int mrCacheCount;
+static int mrCacheMaxCount;             // 0: cache disabled
+static size_t mrCacheMinSize;
+static uint64_t mrCacheUseCounter;
+static pthread_mutex_t mrCacheLock = PTHREAD_MUTEX_INITIALIZER;
+
+//
+// Requested keys for registrations made after startup have to be
+// unique, so they start above the ones used for the startup regions.
+//
+static uint64_t mrNextKey = MAX_MEM_REGIONS;
+
+//
+// Registrations of GPU memory, for RMA directly to and from it and for
+// network AMOs on it.  See chpl_comm_impl_regMemDevice().
+//
+#if defined(CHPL_GPU_NVIDIA)
+  #define OFI_HMEM_IFACE FI_HMEM_CUDA
+#elif defined(CHPL_GPU_AMD)
+  #define OFI_HMEM_IFACE FI_HMEM_ROCR
+#endif
+
+struct mrDevEntry {
+  char* lo;
+  char* hi;
+  struct fid_mr* mr;
+  void* desc;
+  uint64_t key;
+};
+
+static chpl_bool envUseHmem;
+static struct mrDevEntry* mrDev;        // sorted by lo, non-overlapping
+static int mrDevCount;
+static int mrDevMaxCount;
+static pthread_mutex_t mrDevLock = PTHREAD_MUTEX_INITIALIZER;
+
 static chpl_bool  envUseCxiHybridMR;
 //
 // Messaging (AM) support.
@@ -249,9 +375,19 @@ struct amRequest_execOnLrg_t {
   void* pPayload;                 // addr of arg payload on initiator node
 };
 
-#define NUM_AM_HANDLERS 1
-static int numAmHandlers = NUM_AM_HANDLERS;
-static int reservedCPUs[NUM_AM_HANDLERS];
+//
+// Large executeOn bundles up to this size may be retrieved into a buffer
+// on the body task's stack rather than a dynamically allocated one.
+//
+#define AM_MAX_STACK_EXEC_ON_LRG_SIZE 4096
+
+//
+// AM handler threads.  The first one (index 0) owns the receive
+// endpoint; any others just run requests the first one hands them.
+//
+#define MAX_AM_HANDLERS 16
+static int numAmHandlers = 1;
+static int reservedCPUs[MAX_AM_HANDLERS];
 
 //
 // AM request landing zones.
@@ -329,6 +465,11 @@ static void ofi_get_lowLevel(void*, void*, c_nodeid_t,
                              uint64_t, uint64_t, size_t, void*,
                              uint64_t, struct perTxCtxInfo_t*);
 static void do_remote_get_buff(void*, c_nodeid_t, void*, size_t);
+static chpl_bool ofi_strd_iov(chpl_bool, void*, size_t*, c_nodeid_t,
+                              void*, size_t*, size_t*, int32_t, size_t);
+static void ofi_strd_iov_msg(chpl_bool, c_nodeid_t, struct iovec*, void**,
+                             struct fi_rma_iov*, size_t, size_t, uint64_t,
+                             struct perTxCtxInfo_t*);
 static void do_remote_amo_nf_buff(void*, c_nodeid_t, void*, size_t,
                                   enum fi_op, enum fi_datatype);
 static void amEnsureProgress(struct perTxCtxInfo_t*);
@@ -343,6 +484,13 @@ static void forceMemFxVisOneNode(c_nodeid_t, chpl_bool, chpl_bool,
 static void forceMemFxVisAllNodes(chpl_bool, chpl_bool, c_nodeid_t,
                                   struct perTxCtxInfo_t*);
 static void forceMemFxVisAllNodes_noTcip(chpl_bool, chpl_bool);
+static void init_mrCache(void);
+static void fini_mrCache(void);
+static chpl_bool mrCacheAcquire(void**, void*, size_t);
+static void mrCacheRelease(const void*, size_t);
+static chpl_bool mrDevGetDesc(void**, const void*, size_t);
+static void fini_mrDev(void);
+static void fini_throttle(void);
 static void* allocBounceBuf(size_t);
 static void freeBounceBuf(void*);
 static void local_yield(void);
@@ -430,6 +578,11 @@ static void ofiErrReport(const char*, int, const char*);
 //
 static __thread chpl_bool isAmHandler = false;
 
+//
+// Which AM handler is this?  Index 0 is the one that receives requests.
+//
+static __thread int amHandlerIdx = 0;
+
 
 //
 // Flag used to tell AM handler(s) to exit.
@@ -831,10 +984,17 @@ chpl_comm_taskPrvData_t* get_comm_taskPrvdata(void) {
 #define MAX_CHAINED_PUT_LEN MAX_TXNS_IN_FLIGHT
 #define MAX_CHAINED_GET_LEN MAX_TXNS_IN_FLIGHT
 
+//
+// Maximum number of non-fetching AMOs buffered for doing by AM, across
+// all target nodes.  These are sent in per-node batches when flushed.
+//
+#define MAX_BUFFERED_AMO_AM_LEN 256
+
 enum BuffType {
   amo_nf_buff = 1 << 0,
   get_buff    = 1 << 1,
-  put_buff    = 1 << 2
+  put_buff    = 1 << 2,
+  amo_am_buff = 1 << 3
 };
 
 // Per task information about non-fetching AMO buffers
@@ -851,6 +1011,21 @@ typedef struct {
   void*              local_mr;
 } amo_nf_buff_task_info_t;
 
+// Per task information about non-fetching AMOs that have to be done by
+// AM on the target node, because the network can't do them
+typedef struct {
+  chpl_bool          new;
+  int                vi;
+  c_nodeid_t         locale_v[MAX_BUFFERED_AMO_AM_LEN];
+  void*              object_v[MAX_BUFFERED_AMO_AM_LEN];
+  uint64_t           opnd_v[MAX_BUFFERED_AMO_AM_LEN];
+  uint8_t            size_v[MAX_BUFFERED_AMO_AM_LEN];
+  uint8_t            cmd_v[MAX_BUFFERED_AMO_AM_LEN];
+  uint8_t            type_v[MAX_BUFFERED_AMO_AM_LEN];
+  chpl_bool          sent_v[MAX_BUFFERED_AMO_AM_LEN];  // used in flush
+  uint8_t            done_v[MAX_BUFFERED_AMO_AM_LEN];  // AM 'done' flags
+} amo_am_buff_task_info_t;
+
 // Per task information about GET buffers
 typedef struct {
   chpl_bool     new;
@@ -897,6 +1072,7 @@ void* task_local_buff_acquire(enum BuffType t) {
   DEFINE_INIT(amo_nf_buff_task_info_t, amo_nf_buff);
   DEFINE_INIT(get_buff_task_info_t, get_buff);
   DEFINE_INIT(put_buff_task_info_t, put_buff);
+  DEFINE_INIT(amo_am_buff_task_info_t, amo_am_buff);
 
 #undef DEFINE_INIT
   return NULL;
@@ -905,6 +1081,7 @@ void* task_local_buff_acquire(enum BuffType t) {
 static void amo_nf_buff_task_info_flush(amo_nf_buff_task_info_t* info);
 static void get_buff_task_info_flush(get_buff_task_info_t* info);
 static void put_buff_task_info_flush(put_buff_task_info_t* info);
+static void amo_am_buff_task_info_flush(amo_am_buff_task_info_t* info);
 
 // Flush one or more task local buffers
 static inline
@@ -924,6 +1101,8 @@ void task_local_buff_flush(enum BuffType t) {
                amo_nf_buff_task_info_flush);
   DEFINE_FLUSH(get_buff_task_info_t, get_buff, get_buff_task_info_flush);
   DEFINE_FLUSH(put_buff_task_info_t, put_buff, put_buff_task_info_flush);
+  DEFINE_FLUSH(amo_am_buff_task_info_t, amo_am_buff,
+               amo_am_buff_task_info_flush);
 
 #undef DEFINE_FLUSH
 }
@@ -948,6 +1127,8 @@ void task_local_buff_end(enum BuffType t) {
              amo_nf_buff_task_info_flush);
   DEFINE_END(get_buff_task_info_t, get_buff, get_buff_task_info_flush);
   DEFINE_END(put_buff_task_info_t, put_buff, put_buff_task_info_flush);
+  DEFINE_END(amo_am_buff_task_info_t, amo_am_buff,
+             amo_am_buff_task_info_flush);
 
 #undef END
 }
@@ -962,6 +1143,7 @@ pthread_t pthread_that_inited;
 
 static void init_ofi(void);
 static void init_ofiFabricDomain(void);
+static void init_ofiMoreNics(void);
 static void init_ofiReserveCores(void);
 static void init_ofiDoProviderChecks(void);
 static void init_ofiEp(void);
@@ -971,6 +1153,7 @@ static void init_ofiExchangeAvInfo(void);
 static void init_ofiForMem(void);
 static void init_ofiForRma(void);
 static void init_ofiForAms(void);
+static void init_throttle(void);
 static void init_ofiConnections(void);
 
 static void init_bar(void);
@@ -1014,11 +1197,34 @@ void chpl_comm_init(int *argc_p, char ***argv_p) {
 
   envUseCxiHybridMR = chpl_env_rt_get_bool("COMM_OFI_CXI_HYBRID_MR", true);
 
+#ifdef OFI_HMEM_IFACE
+  envUseHmem = chpl_env_rt_get_bool("COMM_OFI_HMEM", false);
+#endif
+
   envInjectRMA = chpl_env_rt_get_bool("COMM_OFI_INJECT_RMA", true);
   envInjectAMO = chpl_env_rt_get_bool("COMM_OFI_INJECT_AMO", true);
   envInjectAM = chpl_env_rt_get_bool("COMM_OFI_INJECT_AM", true);
+  envAggregateAmAMO = chpl_env_rt_get_bool("COMM_OFI_AGGREGATE_AM_AMO", true);
+  envBatchExecOn = chpl_env_rt_get_bool("COMM_OFI_BATCH_EXEC_ON", true);
+  envBatchFree = chpl_env_rt_get_bool("COMM_OFI_BATCH_FREE", true);
+  envStrdIov = chpl_env_rt_get_bool("COMM_OFI_STRD_IOV", true);
   envUseDedicatedAmhCores = chpl_env_rt_get_bool(
                                   "COMM_OFI_DEDICATED_AMH_CORES", false);
+  envLazyAv = chpl_env_rt_get_bool("COMM_OFI_LAZY_AV", false);
+  envThrottle = chpl_env_rt_get_bool("COMM_OFI_THROTTLE", false);
+
+  numAmHandlers = chpl_env_rt_get_int("COMM_OFI_AM_HANDLERS", 1);
+  if (numAmHandlers < 1) {
+    chpl_warning("CHPL_RT_COMM_OFI_AM_HANDLERS < 1, using 1", 0, 0);
+    numAmHandlers = 1;
+  } else if (numAmHandlers > MAX_AM_HANDLERS) {
+    char msg[100];
+    (void) snprintf(msg, sizeof(msg),
+                    "CHPL_RT_COMM_OFI_AM_HANDLERS > %d, using %d",
+                    MAX_AM_HANDLERS, MAX_AM_HANDLERS);
+    chpl_warning(msg, 0, 0);
+    numAmHandlers = MAX_AM_HANDLERS;
+  }
   //
   // The user can specify the provider by setting either the Chapel
   // CHPL_RT_COMM_OFI_PROVIDER environment variable or the libfabric
@@ -1101,6 +1307,8 @@ void chpl_comm_post_task_init(void) {
   } else {
     init_ofi();
     init_bar();
+    chpl_comm_ofi_cma_init();
+    chpl_comm_coll_init_oob(chpl_comm_ofi_oob_allgather);
   }
 }
 
@@ -1130,6 +1338,7 @@ void init_ofi(void) {
   init_ofiForMem();
   init_ofiForRma();
   init_ofiForAms();
+  init_throttle();
 
   CHPL_CALLOC(orderDummy, 1);
   CHK_TRUE(mrGetDesc(&orderDummyMRDesc, orderDummy, sizeof(*orderDummy)));
@@ -2064,6 +2273,192 @@ void init_ofiFabricDomain(void) {
   }
 
   OFI_CHK(fi_domain(ofi_fabric, ofi_info, &ofi_domain, NULL));
+
+  init_ofiMoreNics();
+}
+
+
+//
+// Open the given NICs after the first, if we can find our provider on
+// them.
+//
+static
+void openMoreNics(chpl_topo_pci_addr_t* addrs, int* sockets, int n) {
+  //
+  // Find the same provider on the other NICs.  Copy the hints from the
+  // provider we already have, minus whatever ties it to its NIC.
+  //
+  struct fi_info* hints;
+  CHK_TRUE((hints = fi_dupinfo(ofi_info)) != NULL);
+  sys_free(hints->src_addr);
+  hints->src_addr = NULL;
+  hints->src_addrlen = 0;
+  sys_free(hints->dest_addr);
+  hints->dest_addr = NULL;
+  hints->dest_addrlen = 0;
+  sys_free(hints->domain_attr->name);
+  hints->domain_attr->name = NULL;
+  sys_free(hints->fabric_attr->name);
+  hints->fabric_attr->name = NULL;
+  if (hints->nic != NULL) {
+    OFI_CHK(fi_close(&hints->nic->fid));
+    hints->nic = NULL;
+  }
+
+  struct fi_info* infoList;
+  int ret;
+  OFI_CHK_2(fi_getinfo(COMM_OFI_FI_VERSION, NULL, NULL, 0, hints, &infoList),
+            ret, -FI_ENODATA);
+  fi_freeinfo(hints);
+  if (ret != FI_SUCCESS) {
+    return;
+  }
+
+  for (int i = 1; i < n; i++) {
+    struct fi_info* info;
+    for (info = infoList; info != NULL; info = info->next) {
+      if (info->nic == NULL
+          || info->nic->bus_attr == NULL
+          || info->nic->bus_attr->bus_type != FI_BUS_PCI
+          || strcmp(info->fabric_attr->prov_name,
+                    ofi_info->fabric_attr->prov_name) != 0) {
+        continue;
+      }
+      struct fi_pci_attr* pci = &info->nic->bus_attr->attr.pci;
+      if (pci->domain_id == addrs[i].domain
+          && pci->bus_id == addrs[i].bus
+          && pci->device_id == addrs[i].device
+          && pci->function_id == addrs[i].function) {
+        break;
+      }
+    }
+    if (info == NULL) {
+      DBG_PRINTF(DBG_CFG, "no provider for NIC %04x:%02x:%02x.%x",
+                 addrs[i].domain, addrs[i].bus, addrs[i].device,
+                 addrs[i].function);
+      continue;
+    }
+
+    struct nicInfo_t* nip = &nicTab[numNics++];
+    CHK_TRUE((nip->info = fi_dupinfo(info)) != NULL);
+    nip->socket = sockets[i];
+    OFI_CHK(fi_fabric(nip->info->fabric_attr, &nip->fabric, NULL));
+    OFI_CHK(fi_domain(nip->fabric, nip->info, &nip->domain, NULL));
+    DBG_PRINTF(DBG_CFG, "NIC %d: \"%s\" device, socket %d",
+               numNics - 1, nip->info->domain_attr->name, nip->socket);
+  }
+
+  fi_freeinfo(infoList);
+}
+
+
+//
+// Open the other NICs we'll use, if any.  See nicTab.
+//
+static
+void init_ofiMoreNics(void) {
+  nicTab[0] = (struct nicInfo_t) { .info = ofi_info,
+                                   .fabric = ofi_fabric,
+                                   .domain = ofi_domain,
+                                   .socket = -1, };
+
+  int maxNics = chpl_env_rt_get_int("COMM_OFI_NUM_NICS", 1);
+  if (maxNics == 1) {
+    return;
+  }
+  if (maxNics < 0) {
+    chpl_warning("CHPL_RT_COMM_OFI_NUM_NICS < 0, ignored", 0, 0);
+    return;
+  }
+  if (maxNics == 0 || maxNics > MAX_NICS) {
+    maxNics = MAX_NICS;
+  }
+
+  //
+  // The other NICs' tx contexts are given the memory descriptors and
+  // keys from the registrations on the first one, so we can only use
+  // them if we don't need local descriptors and we can request the
+  // same keys everywhere.  Also, nothing services the RMA target
+  // endpoints, so their provider has to progress inbound RMA itself.
+  // The cxi provider does that in hardware even though it says it
+  // needs manual progress.
+  //
+  const uint64_t nonScalableMemRegBits = (FI_MR_BASIC
+                                          | FI_MR_LOCAL
+                                          | FI_MR_VIRT_ADDR
+                                          | FI_MR_ALLOCATED
+                                          | FI_MR_PROV_KEY
+                                          | FI_MR_ENDPOINT
+                                          | FI_MR_HMEM);
+  size_t heapSize;
+  chpl_comm_impl_regMemHeapInfo(NULL, &heapSize);
+
+  const char* whyNot = NULL;
+  if (ofi_info->nic == NULL
+      || ofi_info->nic->bus_attr == NULL
+      || ofi_info->nic->bus_attr->bus_type != FI_BUS_PCI) {
+    whyNot = "NIC has no PCI address";
+  } else if (mcmMode != mcmm_dlvrCmplt) {
+    whyNot = "MCM mode is not delivery-complete";
+  } else if ((ofi_info->domain_attr->mr_mode & nonScalableMemRegBits) != 0
+             || heapSize != 0) {
+    whyNot = "memory registration is not scalable";
+  } else if (providerInUse(provType_efa)) {
+    whyNot = "provider cannot share address vectors";
+  } else if (ofi_info->domain_attr->data_progress == FI_PROGRESS_MANUAL
+             && !providerInUse(provType_cxi)) {
+    whyNot = "provider needs manual progress";
+  }
+
+  if (whyNot != NULL) {
+    if (chpl_nodeID == 0) {
+      char msg[200];
+      (void) snprintf(msg, sizeof(msg),
+                      "CHPL_RT_COMM_OFI_NUM_NICS ignored: %s", whyNot);
+      chpl_warning(msg, 0, 0);
+    }
+    return;
+  }
+
+  struct fi_pci_attr* pci = &ofi_info->nic->bus_attr->attr.pci;
+  chpl_topo_pci_addr_t inAddr = { .domain = pci->domain_id,
+                                  .bus = pci->bus_id,
+                                  .device = pci->device_id,
+                                  .function = pci->function_id, };
+  chpl_topo_pci_addr_t addrs[MAX_NICS];
+  int sockets[MAX_NICS];
+  int n = chpl_topo_selectNicsByType(&inAddr, addrs, sockets, maxNics);
+  if (n > 0) {
+    nicTab[0].socket = sockets[0];
+  }
+  if (n > 1) {
+    openMoreNics(addrs, sockets, n);
+  }
+
+  //
+  // Everyone has to agree on the number of NICs, because RMA sent on
+  // one of ours targets the same one on the remote node.
+  //
+  int* allNumNics;
+  CHPL_CALLOC(allNumNics, chpl_numNodes);
+  chpl_comm_ofi_oob_allgather(&numNics, allNumNics, sizeof(numNics));
+  int minNumNics = numNics;
+  for (int i = 0; i < chpl_numNodes; i++) {
+    if (allNumNics[i] < minNumNics) {
+      minNumNics = allNumNics[i];
+    }
+  }
+  CHPL_FREE(allNumNics);
+
+  while (numNics > minNumNics) {
+    struct nicInfo_t* nip = &nicTab[--numNics];
+    OFI_CHK(fi_close(&nip->domain->fid));
+    OFI_CHK(fi_close(&nip->fabric->fid));
+    fi_freeinfo(nip->info);
+    *nip = (struct nicInfo_t) { .socket = -1, };
+  }
+
+  DBG_PRINTF(DBG_CFG, "using %d NIC%s", numNics, (numNics == 1) ? "" : "s");
 }
 
 
@@ -2110,6 +2505,9 @@ struct fi_info* getBaseProviderHints(chpl_bool* pTxAttrsForced) {
       || chpl_env_rt_get_bool("COMM_OFI_HINTS_CAPS_ATOMIC", false)) {
     hints->caps |= FI_ATOMIC;
   }
+  if (envUseHmem) {
+    hints->caps |= FI_HMEM;
+  }
 
   hints->tx_attr->op_flags = FI_COMPLETION;
   hints->tx_attr->msg_order = FI_ORDER_SAS;
@@ -2125,6 +2523,9 @@ struct fi_info* getBaseProviderHints(chpl_bool* pTxAttrsForced) {
                                  | FI_MR_VIRT_ADDR
                                  | FI_MR_PROV_KEY // TODO: avoid pkey bcast?
                                  | FI_MR_ENDPOINT);
+  if (envUseHmem) {
+    hints->domain_attr->mr_mode |= FI_MR_HMEM;
+  }
 
   // Set FI_MR_ALLOCATED if there is more than one node and the maximum
   // heap size was specified and the CHPL_RT_OVERSUBSCRIBED environment
@@ -2381,22 +2782,29 @@ void init_ofiEp(void) {
   DBG_PRINTF(DBG_CFG,"tciTabBindTxCtxs %s numTxCtxs %d numAmHandlers %d",
              tciTabBindTxCtxs ? "true" : "false", numTxCtxs, numAmHandlers);
   const chpl_bool useScalEp = envPreferScalableTxEp
-                              && ofi_info->domain_attr->max_ep_tx_ctx > 1;
+                              && ofi_info->domain_attr->max_ep_tx_ctx > 1
+                              && numNics == 1;
   if (useScalEp) {
     ofi_info->ep_attr->tx_ctx_cnt = numTxCtxs;
   }
 
-  CHK_TRUE(ofi_info->domain_attr->max_ep_rx_ctx >= numAmHandlers);
-  numRxCtxs = numAmHandlers;
+  //
+  // There is only one AM request endpoint, owned by the first AM
+  // handler, regardless of how many handlers there are.
+  //
+  CHK_TRUE(ofi_info->domain_attr->max_ep_rx_ctx >= 1);
+  numRxCtxs = 1;
 
   tciTabLen = numTxCtxs;
   CHK_TRUE(tciTabLen > 0);
   CHPL_CALLOC(tciTab, tciTabLen);
 
-  // Use "hybrid" MR mode for the cxi provider if it's available
+  // Use "hybrid" MR mode for the cxi provider if it's available. Not with
+  // multiple NICs, though, because then memory descriptors from the first
+  // one would go to the others.
 
   if (providerInUse(provType_cxi)) {
-    if (envUseCxiHybridMR) {
+    if (envUseCxiHybridMR && numNics == 1) {
 #ifdef FI_CXI_DOM_OPS_3
       struct fi_cxi_dom_ops *dom_ops;
       int rc;
@@ -2480,6 +2888,10 @@ void init_ofiEp(void) {
     OFI_CHK(fi_av_open(ofi_domain, &avAttr, &ofi_rxAv, NULL));
   }
 
+  for (int i = 1; i < numNics; i++) {
+    OFI_CHK(fi_av_open(nicTab[i].domain, &avAttr, &nicTab[i].av, NULL));
+  }
+
   if (useScalEp) {
     OFI_CHK(fi_scalable_ep(ofi_domain, ofi_info, &ofi_txEpScal, NULL));
     OFI_CHK(fi_scalable_ep_bind(ofi_txEpScal, &ofi_av->fid, 0));
@@ -2493,9 +2905,15 @@ void init_ofiEp(void) {
   struct fi_cq_attr cqAttr;
   struct fi_cntr_attr cntrAttr;
 
+  //
+  // All we ever need from a transmit completion is its context, since
+  // that's where the transaction tracking is encoded, so the tx CQs use
+  // the smallest entry format.  This keeps the per-completion cost of
+  // harvesting them in checkTxCmplsCQ() down in PUT- and AMO-heavy code.
+  //
   {
     cqAttr = (struct fi_cq_attr)
-             { .format = FI_CQ_FORMAT_MSG,
+             { .format = FI_CQ_FORMAT_CONTEXT,
                .size = 100 + MAX_TXNS_IN_FLIGHT,
                .wait_obj = FI_WAIT_NONE, };
     txCQLen = cqAttr.size;
@@ -2518,7 +2936,7 @@ void init_ofiEp(void) {
                                    : FI_WAIT_SET;
 
   cqAttr = (struct fi_cq_attr)
-           { .format = FI_CQ_FORMAT_MSG,
+           { .format = FI_CQ_FORMAT_CONTEXT,
              .size = 100,
              .wait_obj = waitObj,
              .wait_cond = FI_CQ_COND_NONE,
@@ -2567,6 +2985,23 @@ void init_ofiEp(void) {
 
   OFI_CHK(fi_enable(ofi_rxEp));
 
+  //
+  // The other NICs get endpoints that are only RMA targets.  Nothing
+  // completes there, but the endpoints need CQs to be enabled.
+  //
+  cqAttr = (struct fi_cq_attr)
+           { .format = FI_CQ_FORMAT_MSG,
+             .size = 1,
+             .wait_obj = FI_WAIT_NONE, };
+  for (int i = 1; i < numNics; i++) {
+    struct nicInfo_t* nip = &nicTab[i];
+    OFI_CHK(fi_endpoint(nip->domain, nip->info, &nip->rmaEp, NULL));
+    OFI_CHK(fi_ep_bind(nip->rmaEp, &nip->av->fid, 0));
+    OFI_CHK(fi_cq_open(nip->domain, &cqAttr, &nip->rmaCQ, NULL));
+    OFI_CHK(fi_ep_bind(nip->rmaEp, &nip->rmaCQ->fid, FI_TRANSMIT | FI_RECV));
+    OFI_CHK(fi_enable(nip->rmaEp));
+  }
+
   //
   // If we're using poll and wait sets, put all the progress-related
   // CQs and/or counters in the poll set.
@@ -2591,7 +3026,21 @@ void init_ofiEpTxCtx(int i, chpl_bool isAMHandler,
   atomic_init_bool(&tcip->allocated, false);
   tcip->bound = false;
 
-  if (ofi_txEpScal == NULL) {
+  //
+  // Spread the workers' tx contexts across the NICs.  The AM handlers
+  // use the first one.
+  //
+  tcip->nic = isAMHandler ? 0 : i % numNics;
+  struct fid_domain* domain = nicTab[tcip->nic].domain;
+
+  if (tcip->nic != 0) {
+    //
+    // use the NIC's shared AV
+    //
+    tcip->av = nicTab[tcip->nic].av;
+    OFI_CHK(fi_endpoint(domain, nicTab[tcip->nic].info, &tcip->txCtx, NULL));
+    OFI_CHK(fi_ep_bind(tcip->txCtx, &tcip->av->fid, 0));
+  } else if (ofi_txEpScal == NULL) {
     //
     // not using a scalable endpoint
     //
@@ -2619,7 +3068,7 @@ void init_ofiEpTxCtx(int i, chpl_bool isAMHandler,
   uint64_t cqFlags = FI_TRANSMIT | FI_RECV;
   if (cntrAttr != NULL) {
     DBG_PRINTF(DBG_TCIPS, "using transmit completion counters");
-    OFI_CHK(fi_cntr_open(ofi_domain, cntrAttr, &tcip->txCntr,
+    OFI_CHK(fi_cntr_open(domain, cntrAttr, &tcip->txCntr,
                          &tcip->checkTxCmplsFn));
     tcip->txCmplFid = &tcip->txCntr->fid;
     OFI_CHK(fi_ep_bind(tcip->txCtx, tcip->txCmplFid,
@@ -2631,7 +3080,7 @@ void init_ofiEpTxCtx(int i, chpl_bool isAMHandler,
   }
 
   if (cqAttr != NULL) {
-    OFI_CHK(fi_cq_open(ofi_domain, cqAttr, &tcip->txCQ,
+    OFI_CHK(fi_cq_open(domain, cqAttr, &tcip->txCQ,
                        &tcip->checkTxCmplsFn));
     tcip->txCmplFid = &tcip->txCQ->fid;
     OFI_CHK(fi_ep_bind(tcip->txCtx, tcip->txCmplFid, cqFlags));
@@ -2649,16 +3098,65 @@ void init_ofiEpTxCtx(int i, chpl_bool isAMHandler,
 }
 
 static
-void insertAddrs(struct fid_av* av, char *addrs, size_t numAddrs,
-                 fi_addr_t **fi_addrs_p) {
+void insertAddrs(struct fid_av* av, char *addrs, size_t addrLen,
+                 size_t numAddrs, fi_addr_t **fi_addrs_p) {
   fi_addr_t *fi_addrs;
   CHPL_CALLOC(fi_addrs, numAddrs);
-  CHK_TRUE(fi_av_insert(av, addrs, numAddrs, fi_addrs, 0, NULL) ==
-           numAddrs);
+  if (envLazyAv) {
+    for (size_t i = 0; i < numAddrs; i++) {
+      fi_addrs[i] = FI_ADDR_NOTAVAIL;
+    }
+
+    struct avDir_t* dir;
+    CHPL_CALLOC(dir, 1);
+    dir->av = av;
+    dir->addrs = fi_addrs;
+    dir->nameLen = addrLen;
+    CHPL_CALLOC_SZ(dir->names, numAddrs, addrLen);
+    memcpy(dir->names, addrs, numAddrs * addrLen);
+    PTHREAD_CHK(pthread_mutex_init(&dir->lock, NULL));
+    dir->next = avDirList;
+    avDirList = dir;
+  } else {
+    CHK_TRUE(fi_av_insert(av, addrs, numAddrs, fi_addrs, 0, NULL) ==
+             numAddrs);
+  }
   *fi_addrs_p = fi_addrs;
 }
 
 
+static
+fi_addr_t avAddrInsert(fi_addr_t* addrs, c_nodeid_t node) {
+  //
+  // First contact with this node through this address table.  Several
+  // tx contexts can share an address table, so find its directory and
+  // insert the address under the directory's lock.  The list is only
+  // built during startup, so walking it here needs no lock.
+  //
+  struct avDir_t* dir;
+  for (dir = avDirList; dir != NULL && dir->addrs != addrs; dir = dir->next)
+    ;
+  CHK_TRUE(dir != NULL);
+
+  PTHREAD_CHK(pthread_mutex_lock(&dir->lock));
+  fi_addr_t addr = addrs[node];
+  if (addr == FI_ADDR_NOTAVAIL) {
+    CHK_TRUE(fi_av_insert(dir->av, dir->names + node * dir->nameLen, 1,
+                          &addr, 0, NULL) == 1);
+    DBG_PRINTF(DBG_CFG_AV, "lazy AV insert: node %d, fi_addr %#" PRIx64,
+               (int) node, (uint64_t) addr);
+    //
+    // Make the AV's state for the new address visible before the table
+    // entry that lets other threads skip this path.
+    //
+    chpl_atomic_thread_fence(memory_order_release);
+    addrs[node] = addr;
+  }
+  PTHREAD_CHK(pthread_mutex_unlock(&dir->lock));
+  return addr;
+}
+
+
 static
 void init_ofiExchangeAvInfo(void) {
   //
@@ -2686,15 +3184,31 @@ void init_ofiExchangeAvInfo(void) {
     }
   }
 
-  char* my_addr;
-  char* addrs;
+  //
+  // We exchange our AM receive endpoint address together with the RMA
+  // target endpoint addresses on any other NICs, all in one allgather,
+  // so that startup costs a single out-of-band round no matter how
+  // many NICs there are.  Each node contributes a record made up of
+  // these addresses back to back.
+  //
   size_t my_addr_len = 0;
-
   OFI_CHK_1(fi_getname(&ofi_rxEp->fid, NULL, &my_addr_len), -FI_ETOOSMALL);
 
-  CHPL_CALLOC_SZ(my_addr, my_addr_len, 1);
+  size_t* my_rma_addr_lens = NULL;
+  size_t rec_len = my_addr_len;
+  if (numNics > 1) {
+    CHPL_CALLOC(my_rma_addr_lens, numNics);
+    for (int i = 1; i < numNics; i++) {
+      OFI_CHK_1(fi_getname(&nicTab[i].rmaEp->fid, NULL, &my_rma_addr_lens[i]),
+                -FI_ETOOSMALL);
+      rec_len += my_rma_addr_lens[i];
+    }
+  }
+
+  char* my_rec;
+  CHPL_CALLOC_SZ(my_rec, rec_len, 1);
+  char* my_addr = my_rec;
   OFI_CHK(fi_getname(&ofi_rxEp->fid, my_addr, &my_addr_len));
-  CHPL_CALLOC_SZ(addrs, chpl_numNodes, my_addr_len);
   if (DBG_TEST_MASK(DBG_CFG_AV)) {
     char nameBuf[128];
     size_t nameLen;
@@ -2704,7 +3218,61 @@ void init_ofiExchangeAvInfo(void) {
                (int) nameLen, nameBuf,
                (nameLen <= sizeof(nameBuf)) ? "" : "[...]");
   }
-  chpl_comm_ofi_oob_allgather(my_addr, addrs, my_addr_len);
+  {
+    size_t off = my_addr_len;
+    for (int i = 1; i < numNics; i++) {
+      OFI_CHK(fi_getname(&nicTab[i].rmaEp->fid, my_rec + off,
+                         &my_rma_addr_lens[i]));
+      off += my_rma_addr_lens[i];
+    }
+  }
+
+  char* recs;
+  CHPL_CALLOC_SZ(recs, chpl_numNodes, rec_len);
+  chpl_comm_ofi_oob_allgather(my_rec, recs, rec_len);
+
+  //
+  // Pull the addresses for each endpoint out of the records into the
+  // dense arrays fi_av_insert() wants.
+  //
+  char* addrs;
+  CHPL_CALLOC_SZ(addrs, chpl_numNodes, my_addr_len);
+  for (int n = 0; n < chpl_numNodes; n++) {
+    memcpy(addrs + n * my_addr_len, recs + n * rec_len, my_addr_len);
+  }
+
+  //
+  // The other NICs' AVs get everybody's AM receive endpoint followed by
+  // their RMA target endpoint on the same NIC.
+  //
+  size_t numAddrs = chpl_numNodes;
+  if (numNics > 1) {
+    char* rma_addrs;
+    size_t rma_addrs_len_max = 0;
+    for (int i = 1; i < numNics; i++) {
+      if (my_rma_addr_lens[i] > rma_addrs_len_max) {
+        rma_addrs_len_max = my_rma_addr_lens[i];
+      }
+    }
+    CHPL_CALLOC_SZ(rma_addrs, chpl_numNodes, rma_addrs_len_max);
+
+    size_t off = my_addr_len;
+    for (int i = 1; i < numNics; i++) {
+      struct nicInfo_t* nip = &nicTab[i];
+      const size_t len = my_rma_addr_lens[i];
+      for (int n = 0; n < chpl_numNodes; n++) {
+        memcpy(rma_addrs + n * len, recs + n * rec_len + off, len);
+      }
+      insertAddrs(nip->av, addrs, my_addr_len, numAddrs, &nip->rxAddrs);
+      insertAddrs(nip->av, rma_addrs, len, numAddrs, &nip->rmaAddrs);
+      off += len;
+    }
+
+    CHPL_FREE(rma_addrs);
+    CHPL_FREE(my_rma_addr_lens);
+  }
+
+  CHPL_FREE(recs);
 
   //
   // Insert the addresses into the address vector and build up a vector
@@ -2716,24 +3284,30 @@ void init_ofiExchangeAvInfo(void) {
   // Only when the provider cannot support scalable EPs and we have
   // multiple actual endpoints are the AVs individualized to those.
   //
-  size_t numAddrs = chpl_numNodes;
   if (ofi_av != NULL) {
-    insertAddrs(ofi_av, addrs, numAddrs, &ofi_addrs);
+    insertAddrs(ofi_av, addrs, my_addr_len, numAddrs, &ofi_addrs);
   }
   if (ofi_rxAv != ofi_av) {
-    insertAddrs(ofi_rxAv, addrs, numAddrs, &ofi_rxAddrs);
+    insertAddrs(ofi_rxAv, addrs, my_addr_len, numAddrs, &ofi_rxAddrs);
   }
   for (int i = 0; i < tciTabLen; i++) {
-    if (ofi_av != NULL) {
-      tciTab[i].av = ofi_av;
-      tciTab[i].addrs = ofi_addrs;
+    if (tciTab[i].nic != 0) {
+      tciTab[i].addrs = nicTab[tciTab[i].nic].rxAddrs;
+      tciTab[i].rmaAddrs = nicTab[tciTab[i].nic].rmaAddrs;
     } else {
-      insertAddrs(tciTab[i].av, addrs, numAddrs, &tciTab[i].addrs);
+      if (ofi_av != NULL) {
+        tciTab[i].av = ofi_av;
+        tciTab[i].addrs = ofi_addrs;
+      } else {
+        insertAddrs(tciTab[i].av, addrs, my_addr_len, numAddrs,
+                    &tciTab[i].addrs);
+      }
+      tciTab[i].rmaAddrs = tciTab[i].addrs;
     }
     assert(tciTab[i].av != NULL);
     assert(tciTab[i].addrs != NULL);
   }
-  CHPL_FREE(my_addr);
+  CHPL_FREE(my_rec);
   CHPL_FREE(addrs);
 }
 
@@ -2799,6 +3373,7 @@ void init_ofiForMem(void) {
     ((ofi_info->domain_attr->mr_mode & FI_MR_PROV_KEY) != 0);
 
   uint64_t bufAcc = FI_RECV | FI_REMOTE_READ | FI_REMOTE_WRITE;
+  uint64_t regStart = chpl_fast_timer_ns();
 
   if (((ofi_info->domain_attr->mr_mode & FI_MR_LOCAL) != 0) ||
        cxiHybridMRMode) {
@@ -2822,6 +3397,23 @@ void init_ofiForMem(void) {
     CHK_TRUE(prov_key || memTab[i].key == i);
   }
 
+  //
+  // Register the same memory, with the same key, on the other NICs.
+  //
+  for (int i = 1; i < numNics; i++) {
+    CHK_TRUE(scalableMemReg && memTabCount == 1);
+    OFI_CHK(fi_mr_reg(nicTab[i].domain,
+                      memTab[0].addr, memTab[0].size,
+                      bufAcc, 0, 0, 0, &nicTab[i].mr, NULL));
+    CHK_TRUE(fi_mr_key(nicTab[i].mr) == memTab[0].key);
+  }
+
+  if (!scalableMemReg) {
+    chpl_msg(2, "%d: registered %d memory region%s in %.3f seconds\n",
+             (int) chpl_nodeID, memTabCount, (memTabCount == 1) ? "" : "s",
+             (chpl_fast_timer_ns() - regStart) * 1e-9);
+  }
+
   //
   // Unless we're doing scalable registration of the entire address
   // space, share the memory regions around the job.
@@ -2830,6 +3422,8 @@ void init_ofiForMem(void) {
     CHPL_CALLOC(memTabMap, chpl_numNodes);
     chpl_comm_ofi_oob_allgather(&memTab, memTabMap, sizeof(memTabMap[0]));
   }
+
+  init_mrCache();
 }
 
 
@@ -2976,10 +3570,24 @@ void init_ofiForRma(void) {
   // initialize its internals.  The datatype here doesn't matter.
   //
   (void) isAtomicValid(FI_INT32);
+
+  //
+  // PUTs and GETs up to this size take the fast paths in ofi_put() and
+  // ofi_get(), which skip localizing the local buffer.  We can't inject
+  // anything bigger than inject_size, so that's the limit.
+  //
+  const size_t injSize = ofi_info->tx_attr->inject_size;
+  tinyRmaSize = chpl_env_rt_get_size("COMM_OFI_TINY_RMA_SIZE", injSize);
+  if (tinyRmaSize > injSize) {
+    tinyRmaSize = injSize;
+  }
 }
 
 
 static void init_amHandling(void);
+static void init_execOnBatches(void);
+static void init_freeBatches(void);
+static void flushFreeBatches(void);
 
 static
 void init_ofiForAms(void) {
@@ -3070,6 +3678,8 @@ void init_ofiForAms(void) {
   }
 
   init_amHandling();
+  init_execOnBatches();
+  init_freeBatches();
 }
 
 
@@ -3147,26 +3757,6 @@ void chpl_comm_rollcall(void) {
 // Chapel global and private variable support
 //
 
-wide_ptr_t* chpl_comm_broadcast_global_vars_helper(void) {
-  DBG_PRINTF(DBG_IFACE_SETUP, "%s()", __func__);
-
-  //
-  // Gather the global variables' wide pointers on node 0 into a
-  // buffer, and broadcast the address of that buffer to the other
-  // nodes.
-  //
-  wide_ptr_t* buf;
-  if (chpl_nodeID == 0) {
-    CHPL_CALLOC(buf, chpl_numGlobalsOnHeap);
-    for (int i = 0; i < chpl_numGlobalsOnHeap; i++) {
-      buf[i] = *chpl_globals_registry[i];
-    }
-  }
-  chpl_comm_ofi_oob_bcast(&buf, sizeof(buf));
-  return buf;
-}
-
-
 static void*** chplPrivBcastTabMap;
 
 static
@@ -3274,6 +3864,10 @@ void fini_ofi(void) {
   if (chpl_numNodes <= 1)
     return;
 
+  fini_mrCache();
+  fini_mrDev();
+  fini_throttle();
+
   for (int i = 0; i < memTabCount; i++) {
     OFI_CHK(fi_close(&ofiMrTab[i]->fid));
   }
@@ -3311,12 +3905,25 @@ void fini_ofi(void) {
   }
 
   for (int i = 0; i < tciTabLen; i++) {
-    if (tciTab[i].av != ofi_av) {
+    if (tciTab[i].nic == 0 && tciTab[i].av != ofi_av) {
       OFI_CHK(fi_close(&tciTab[i].av->fid));
       CHPL_FREE(tciTab[i].addrs);
     }
   }
 
+  for (int i = 1; i < numNics; i++) {
+    struct nicInfo_t* nip = &nicTab[i];
+    OFI_CHK(fi_close(&nip->mr->fid));
+    OFI_CHK(fi_close(&nip->rmaEp->fid));
+    OFI_CHK(fi_close(&nip->rmaCQ->fid));
+    OFI_CHK(fi_close(&nip->av->fid));
+    CHPL_FREE(nip->rxAddrs);
+    CHPL_FREE(nip->rmaAddrs);
+    OFI_CHK(fi_close(&nip->domain->fid));
+    OFI_CHK(fi_close(&nip->fabric->fid));
+    fi_freeinfo(nip->info);
+  }
+
   if (ofi_rxAv != ofi_av) {
     OFI_CHK(fi_close(&ofi_rxAv->fid));
   }
@@ -3331,6 +3938,15 @@ void fini_ofi(void) {
   if (ofi_addrs != NULL) {
     CHPL_FREE(ofi_addrs);
   }
+
+  while (avDirList != NULL) {
+    struct avDir_t* dir = avDirList;
+    avDirList = dir->next;
+    PTHREAD_CHK(pthread_mutex_destroy(&dir->lock));
+    CHPL_FREE(dir->names);
+    CHPL_FREE(dir);
+  }
+
   if (ofi_amhPollSet != NULL) {
     OFI_CHK(fi_close(&ofi_amhWaitSet->fid));
     OFI_CHK(fi_close(&ofi_amhPollSet->fid));
@@ -3631,6 +4247,51 @@ struct memEntry* getMemEntry(memTab_t* tab, void* addr, size_t size) {
 }
 
 
+//
+// A small per-thread direct-mapped cache in front of getMemEntry() for
+// remote tables, keyed by node and address page.  The tables don't
+// change after startup, so entries never go stale.  With only a few
+// regions the search is as quick as the cache, so we only use it when
+// there are more.
+//
+#define MEM_XLATE_CACHE_LEN 64  // must be a power of 2
+#define MEM_XLATE_PAGE_BITS 21
+#define MEM_XLATE_MIN_REGIONS 4
+
+struct memXlateEntry {
+  int node;
+  uintptr_t page;
+  struct memEntry* mr;
+};
+
+static __thread struct memXlateEntry memXlateCache[MEM_XLATE_CACHE_LEN];
+
+static inline
+struct memEntry* getRemoteMemEntry(int iNode, void* addr, size_t size) {
+  if (memTabCount < MEM_XLATE_MIN_REGIONS) {
+    return getMemEntry(&memTabMap[iNode], addr, size);
+  }
+
+  const uintptr_t page = (uintptr_t) addr >> MEM_XLATE_PAGE_BITS;
+  struct memXlateEntry* xe =
+    &memXlateCache[(page ^ ((uintptr_t) iNode * 0x9E3779B1U))
+                   & (MEM_XLATE_CACHE_LEN - 1)];
+  struct memEntry* mr = xe->mr;
+  if (mr != NULL && xe->node == iNode && xe->page == page
+      && (char*) addr >= (char*) mr->addr
+      && (char*) addr + size <= (char*) mr->addr + mr->size) {
+    return mr;
+  }
+
+  if ((mr = getMemEntry(&memTabMap[iNode], addr, size)) != NULL) {
+    xe->node = iNode;
+    xe->page = page;
+    xe->mr = mr;
+  }
+  return mr;
+}
+
+
 static inline
 chpl_bool mrGetDesc(void** pDesc, void* addr, size_t size) {
   chpl_bool ret;
@@ -3658,51 +4319,437 @@ chpl_bool mrGetDesc(void** pDesc, void* addr, size_t size) {
 }
 
 
-static inline
-void* mrLocalize(void** pDesc, const void* addr, size_t size,
-                 chpl_bool isSource, const char* what) {
-  void* mrAddr = (void*) addr;
-  if (mrAddr == NULL) {
-    *pDesc = NULL;
-  } else if (!mrGetDesc(pDesc, mrAddr, size)) {
-    mrAddr = allocBounceBuf(size);
-    DBG_PRINTF(DBG_MR_BB, "%s BB: %p", what, mrAddr);
-    CHK_TRUE(mrGetDesc(pDesc, mrAddr, size));
-    if (isSource) {
-      memcpy(mrAddr, addr, size);
-    }
+//
+// The local registration cache.  With basic memory registration, local
+// buffers outside the regions registered at startup (the fixed heap,
+// static data, the process stack) normally go through bounce buffers.
+// For large ones it's cheaper to register the buffer itself for local
+// access, and cheaper still to reuse that registration the next time.
+//
+// Entries are kept in an array sorted by address with no overlaps, so
+// lookup is a binary search.  When the cache is full we evict the least
+// recently used entry that isn't in use by an in-flight transfer.
+//
+// Memory that Chapel allocates is always in a registered region, so the
+// cache only ever holds memory from elsewhere (foreign libraries, other
+// threads' stacks, and so on), and we can't see it being freed.  A
+// stale entry would be wrong, not just slow, which is why the cache is
+// opt-in: CHPL_RT_COMM_OFI_MR_CACHE_ENTRIES sets the number of entries
+// and should only be used when such buffers outlive the program's use
+// of them for communication.
+//
+
+static
+void init_mrCache(void) {
+  mrCacheMaxCount = chpl_env_rt_get_int("COMM_OFI_MR_CACHE_ENTRIES", 0);
+  if (mrCacheMaxCount < 0 || scalableMemReg) {
+    mrCacheMaxCount = 0;
+  }
+  mrCacheMinSize = chpl_env_rt_get_size("COMM_OFI_MR_CACHE_MIN_SIZE",
+                                        64 * 1024);
+  if (mrCacheMaxCount > 0) {
+    CHPL_CALLOC(mrCache, mrCacheMaxCount);
   }
-  return mrAddr;
 }
 
 
-static inline
-void* mrLocalizeSource(void** pDesc, const void* addr, size_t size,
-                       const char* what) {
-  return mrLocalize(pDesc, addr, size, true /*isSource*/, what);
+static
+void fini_mrCache(void) {
+  for (int i = 0; i < mrCacheCount; i++) {
+    OFI_CHK(fi_close(&mrCache[i].mr->fid));
+  }
+  mrCacheCount = 0;
+  if (mrCache != NULL) {
+    CHPL_FREE(mrCache);
+  }
 }
 
 
+//
+// Return the index of the first entry whose end is above addr, which
+// is the only one that can contain it.  Call with the lock held.
+//
 static inline
-void* mrLocalizeTarget(void** pDesc, const void* addr, size_t size,
-                       const char* what) {
-  return mrLocalize(pDesc, addr, size, false /*isSource*/, what);
+int mrCacheSearch(const char* addr) {
+  int lo = 0;
+  int hi = mrCacheCount;
+  while (lo < hi) {
+    int mid = lo + (hi - lo) / 2;
+    if (mrCache[mid].hi <= addr) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
 }
 
 
 static inline
-void mrUnLocalizeSource(void* mrAddr, const void* addr) {
-  if (mrAddr != NULL && mrAddr != addr) {
-    freeBounceBuf(mrAddr);
-  }
+void mrCacheRemove(int i) {
+  DBG_PRINTF(DBG_MR, "MR cache evict [%p, %p)", mrCache[i].lo, mrCache[i].hi);
+  OFI_CHK(fi_close(&mrCache[i].mr->fid));
+  memmove(&mrCache[i], &mrCache[i + 1],
+          (mrCacheCount - i - 1) * sizeof(mrCache[0]));
+  mrCacheCount--;
 }
 
 
-static inline
-void mrUnLocalizeTarget(void* mrAddr, void* addr, size_t size) {
-  if (mrAddr != NULL && mrAddr != addr) {
-    memcpy(addr, mrAddr, size);
+//
+// Find or create a local registration covering [addr, addr+size), and
+// count it as in use until mrCacheRelease().  Returns false if the
+// cache is disabled, the buffer is too small to be worth registering,
+// or there's no room.
+//
+static
+chpl_bool mrCacheAcquire(void** pDesc, void* addr, size_t size) {
+  if (mrCacheMaxCount == 0 || size < mrCacheMinSize) {
+    return false;
+  }
+
+  const size_t pgSize = chpl_getSysPageSize();
+  char* lo = (char*) ALIGN_DN((uintptr_t) addr, pgSize);
+  char* hi = (char*) ALIGN_UP((uintptr_t) addr + size, pgSize);
+  chpl_bool ret = false;
+
+  PTHREAD_CHK(pthread_mutex_lock(&mrCacheLock));
+
+  int i = mrCacheSearch(addr);
+  if (i < mrCacheCount
+      && mrCache[i].lo <= (char*) addr
+      && mrCache[i].hi >= (char*) addr + size) {
+    mrCache[i].refs++;
+    mrCache[i].lastUse = ++mrCacheUseCounter;
+    *pDesc = mrCache[i].desc;
+    ret = true;
+  } else {
+    //
+    // Miss.  Anything we overlap gets replaced, which we can only do
+    // if none of it is in use.
+    //
+    int iEnd = i;
+    chpl_bool busy = false;
+    while (iEnd < mrCacheCount && mrCache[iEnd].lo < hi) {
+      busy = busy || mrCache[iEnd].refs > 0;
+      iEnd++;
+    }
+    if (!busy) {
+      while (iEnd > i) {
+        mrCacheRemove(--iEnd);
+      }
+
+      if (mrCacheCount == mrCacheMaxCount) {
+        int iLRU = -1;
+        for (int j = 0; j < mrCacheCount; j++) {
+          if (mrCache[j].refs == 0
+              && (iLRU < 0 || mrCache[j].lastUse < mrCache[iLRU].lastUse)) {
+            iLRU = j;
+          }
+        }
+        if (iLRU >= 0) {
+          mrCacheRemove(iLRU);
+          if (iLRU < i) {
+            i--;
+          }
+        }
+      }
+
+      struct fid_mr* mr;
+      if (mrCacheCount < mrCacheMaxCount
+          && fi_mr_reg(ofi_domain, lo, hi - lo,
+                       FI_SEND | FI_RECV | FI_READ | FI_WRITE,
+                       0, mrNextKey++, 0, &mr, NULL) == FI_SUCCESS) {
+        if ((ofi_info->domain_attr->mr_mode & FI_MR_ENDPOINT) != 0) {
+          OFI_CHK(fi_mr_bind(mr, &ofi_rxEp->fid, 0));
+          OFI_CHK(fi_mr_enable(mr));
+        }
+        DBG_PRINTF(DBG_MR, "MR cache add [%p, %p)", lo, hi);
+        memmove(&mrCache[i + 1], &mrCache[i],
+                (mrCacheCount - i) * sizeof(mrCache[0]));
+        mrCache[i] = (struct mrCacheEntry)
+                     { .lo = lo, .hi = hi, .mr = mr, .desc = fi_mr_desc(mr),
+                       .lastUse = ++mrCacheUseCounter, .refs = 1, };
+        mrCacheCount++;
+        *pDesc = mrCache[i].desc;
+        ret = true;
+      }
+    }
+  }
+
+  PTHREAD_CHK(pthread_mutex_unlock(&mrCacheLock));
+  return ret;
+}
+
+
+//
+// Done with a buffer that mrLocalize() didn't have to bounce.  If it
+// got its descriptor from the cache, release that.  This repeats the
+// checks mrLocalize() made, in the same order, so that it only drops
+// a reference that mrCacheAcquire() took for this buffer.
+//
+static
+void mrCacheRelease(const void* addr, size_t size) {
+  void* desc;
+  if (mrCacheMaxCount == 0 || size < mrCacheMinSize
+      || mrDevGetDesc(&desc, addr, size)
+      || mrGetDesc(&desc, (void*) addr, size)) {
+    return;
+  }
+
+  PTHREAD_CHK(pthread_mutex_lock(&mrCacheLock));
+  int i = mrCacheSearch(addr);
+  CHK_TRUE(i < mrCacheCount
+           && mrCache[i].lo <= (const char*) addr
+           && mrCache[i].hi >= (const char*) addr + size
+           && mrCache[i].refs > 0);
+  mrCache[i].refs--;
+  PTHREAD_CHK(pthread_mutex_unlock(&mrCacheLock));
+}
+
+
+//
+// GPU memory registrations.  The GPU layer asks for these, one per
+// device allocation, before using the memory as the local side of an
+// RMA, and drops them before freeing the memory, so unlike the entries
+// in the local registration cache they can't go stale.  Lookup is a
+// binary search of a sorted array, as for the cache.
+//
+static inline
+int mrDevSearch(const char* addr) {
+  int lo = 0;
+  int hi = mrDevCount;
+  while (lo < hi) {
+    int mid = lo + (hi - lo) / 2;
+    if (mrDev[mid].hi <= addr) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+
+//
+// If [addr, addr+size) is registered GPU memory, return true and its
+// descriptor.
+//
+static inline
+chpl_bool mrDevGetDesc(void** pDesc, const void* addr, size_t size) {
+  //
+  // Checking the count without the lock is fine: a task only uses GPU
+  // memory for RMA after its own registration request returned.
+  //
+  if (mrDevCount == 0) {
+    return false;
+  }
+
+  chpl_bool ret = false;
+  PTHREAD_CHK(pthread_mutex_lock(&mrDevLock));
+  int i = mrDevSearch(addr);
+  if (i < mrDevCount
+      && mrDev[i].lo <= (const char*) addr
+      && mrDev[i].hi >= (const char*) addr + size) {
+    if (pDesc != NULL) {
+      *pDesc = mrDev[i].desc;
+    }
+    ret = true;
+  }
+  PTHREAD_CHK(pthread_mutex_unlock(&mrDevLock));
+  return ret;
+}
+
+
+//
+// If [addr, addr+size) is registered GPU memory, return true and the
+// key and target address with which to reach it, as for mrGetKey().
+//
+static inline
+chpl_bool mrDevGetKey(uint64_t* pKey, uint64_t* pOff,
+                      const void* addr, size_t size) {
+  if (mrDevCount == 0) {
+    return false;
+  }
+
+  chpl_bool ret = false;
+  PTHREAD_CHK(pthread_mutex_lock(&mrDevLock));
+  int i = mrDevSearch(addr);
+  if (i < mrDevCount
+      && mrDev[i].lo <= (const char*) addr
+      && mrDev[i].hi >= (const char*) addr + size) {
+    *pKey = mrDev[i].key;
+    *pOff = ((ofi_info->domain_attr->mr_mode & FI_MR_VIRT_ADDR) == 0)
+            ? (uint64_t) ((const char*) addr - mrDev[i].lo)
+            : (uint64_t) addr;
+    ret = true;
+  }
+  PTHREAD_CHK(pthread_mutex_unlock(&mrDevLock));
+  return ret;
+}
+
+
+chpl_bool chpl_comm_impl_regMemDevice(void* addr, size_t size,
+                                      c_sublocid_t subloc) {
+#ifdef OFI_HMEM_IFACE
+  if (!envUseHmem || ofi_info == NULL || (ofi_info->caps & FI_HMEM) == 0
+      || size == 0) {
+    return false;
+  }
+  if (mrDevGetDesc(NULL, addr, size)) {
+    return true;
+  }
+
+  char* lo = (char*) addr;
+  char* hi = lo + size;
+  chpl_bool ret = false;
+
+  PTHREAD_CHK(pthread_mutex_lock(&mrDevLock));
+
+  int i = mrDevSearch(lo);
+  if (i < mrDevCount && mrDev[i].lo <= lo && mrDev[i].hi >= hi) {
+    ret = true;                         // another task beat us to it
+  } else if (i == mrDevCount || mrDev[i].lo >= hi) {
+    if (mrDevCount == mrDevMaxCount) {
+      int newMax = (mrDevMaxCount == 0) ? 16 : 2 * mrDevMaxCount;
+      struct mrDevEntry* newDev;
+      CHPL_CALLOC(newDev, newMax);
+      if (mrDevCount > 0) {
+        memcpy(newDev, mrDev, mrDevCount * sizeof(mrDev[0]));
+        CHPL_FREE(mrDev);
+      }
+      mrDev = newDev;
+      mrDevMaxCount = newMax;
+    }
+
+    struct iovec iov = { .iov_base = addr, .iov_len = size, };
+    struct fi_mr_attr attr = { .mr_iov = &iov,
+                               .iov_count = 1,
+                               .access = (FI_SEND | FI_RECV
+                                          | FI_READ | FI_WRITE
+                                          | FI_REMOTE_READ
+                                          | FI_REMOTE_WRITE),
+                               .requested_key = mrNextKey++,
+                               .iface = OFI_HMEM_IFACE, };
+#if defined(CHPL_GPU_NVIDIA)
+    attr.device.cuda = subloc;
+#endif
+    struct fid_mr* mr;
+    int rc = fi_mr_regattr(ofi_domain, &attr, 0, &mr);
+    if (rc == FI_SUCCESS) {
+      if ((ofi_info->domain_attr->mr_mode & FI_MR_ENDPOINT) != 0) {
+        OFI_CHK(fi_mr_bind(mr, &ofi_rxEp->fid, 0));
+        OFI_CHK(fi_mr_enable(mr));
+      }
+      DBG_PRINTF(DBG_MR, "MR device add [%p, %p) (subloc %d)",
+                 lo, hi, (int) subloc);
+      memmove(&mrDev[i + 1], &mrDev[i],
+              (mrDevCount - i) * sizeof(mrDev[0]));
+      mrDev[i] = (struct mrDevEntry)
+                 { .lo = lo, .hi = hi, .mr = mr, .desc = fi_mr_desc(mr),
+                   .key = fi_mr_key(mr), };
+      mrDevCount++;
+      ret = true;
+    } else {
+      DBG_PRINTF(DBG_MR, "MR device add [%p, %p) failed: %s",
+                 lo, hi, fi_strerror(-rc));
+    }
+  }
+  // else it overlaps a registration of some other allocation; refuse
+
+  PTHREAD_CHK(pthread_mutex_unlock(&mrDevLock));
+  return ret;
+#else
+  return false;
+#endif
+}
+
+
+void chpl_comm_impl_regMemDeviceFree(void* addr, size_t size) {
+  if (mrDevCount == 0) {
+    return;
+  }
+
+  char* lo = (char*) addr;
+  char* hi = lo + size;
+
+  PTHREAD_CHK(pthread_mutex_lock(&mrDevLock));
+  int i = mrDevSearch(lo);
+  int iEnd = i;
+  while (iEnd < mrDevCount && mrDev[iEnd].lo < hi) {
+    DBG_PRINTF(DBG_MR, "MR device remove [%p, %p)",
+               mrDev[iEnd].lo, mrDev[iEnd].hi);
+    OFI_CHK(fi_close(&mrDev[iEnd].mr->fid));
+    iEnd++;
+  }
+  memmove(&mrDev[i], &mrDev[iEnd], (mrDevCount - iEnd) * sizeof(mrDev[0]));
+  mrDevCount -= iEnd - i;
+  PTHREAD_CHK(pthread_mutex_unlock(&mrDevLock));
+}
+
+
+static
+void fini_mrDev(void) {
+  for (int i = 0; i < mrDevCount; i++) {
+    OFI_CHK(fi_close(&mrDev[i].mr->fid));
+  }
+  mrDevCount = 0;
+  if (mrDev != NULL) {
+    CHPL_FREE(mrDev);
+  }
+}
+
+
+static inline
+void* mrLocalize(void** pDesc, const void* addr, size_t size,
+                 chpl_bool isSource, const char* what) {
+  void* mrAddr = (void*) addr;
+  if (mrAddr == NULL) {
+    *pDesc = NULL;
+  } else if (!mrDevGetDesc(pDesc, mrAddr, size)
+             && !mrGetDesc(pDesc, mrAddr, size)
+             && !mrCacheAcquire(pDesc, mrAddr, size)) {
+    mrAddr = allocBounceBuf(size);
+    DBG_PRINTF(DBG_MR_BB, "%s BB: %p", what, mrAddr);
+    CHK_TRUE(mrGetDesc(pDesc, mrAddr, size));
+    if (isSource) {
+      memcpy(mrAddr, addr, size);
+    }
+  }
+  return mrAddr;
+}
+
+
+static inline
+void* mrLocalizeSource(void** pDesc, const void* addr, size_t size,
+                       const char* what) {
+  return mrLocalize(pDesc, addr, size, true /*isSource*/, what);
+}
+
+
+static inline
+void* mrLocalizeTarget(void** pDesc, const void* addr, size_t size,
+                       const char* what) {
+  return mrLocalize(pDesc, addr, size, false /*isSource*/, what);
+}
+
+
+static inline
+void mrUnLocalizeSource(void* mrAddr, const void* addr, size_t size) {
+  if (mrAddr != NULL && mrAddr != addr) {
     freeBounceBuf(mrAddr);
+  } else if (mrAddr != NULL) {
+    mrCacheRelease(addr, size);
+  }
+}
+
+
+static inline
+void mrUnLocalizeTarget(void* mrAddr, void* addr, size_t size) {
+  if (mrAddr != NULL && mrAddr != addr) {
+    memcpy(addr, mrAddr, size);
+    freeBounceBuf(mrAddr);
+  } else if (mrAddr != NULL) {
+    mrCacheRelease(addr, size);
   }
 }
 
@@ -3718,7 +4765,7 @@ chpl_bool mrGetKey(uint64_t* pKey, uint64_t* pOff,
     off = (uint64_t) addr;
   } else {
     struct memEntry* mr;
-    if ((mr = getMemEntry(&memTabMap[iNode], addr, size)) == NULL) {
+    if ((mr = getRemoteMemEntry(iNode, addr, size)) == NULL) {
       DBG_PRINTF(DBG_MR_KEY, "mrGetKey(%d:%p, %zd): no entry",
                  iNode, addr, size);
       return false;
@@ -3775,6 +4822,27 @@ void* mrLocalizeTargetRemote(const void* addr, size_t size,
 }
 
 
+//
+// Undo mrLocalize*Remote().  Those never use the registration cache,
+// so there is nothing to release unless they bounced.
+//
+static inline
+void mrUnLocalizeSourceRemote(void* mrAddr, const void* addr) {
+  if (mrAddr != NULL && mrAddr != addr) {
+    freeBounceBuf(mrAddr);
+  }
+}
+
+
+static inline
+void mrUnLocalizeTargetRemote(void* mrAddr, void* addr, size_t size) {
+  if (mrAddr != NULL && mrAddr != addr) {
+    memcpy(addr, mrAddr, size);
+    freeBounceBuf(mrAddr);
+  }
+}
+
+
 ////////////////////////////////////////
 //
 // Interface: memory consistency
@@ -3881,7 +4949,15 @@ void mcmReleaseAllNodes(struct bitmap_t* b1, struct bitmap_t* b2,
 void chpl_comm_impl_unordered_task_fence(void) {
   DBG_PRINTF(DBG_IFACE_MCM, "%s()", __func__);
 
-  task_local_buff_end(get_buff | put_buff | amo_nf_buff);
+  task_local_buff_end(get_buff | put_buff | amo_nf_buff | amo_am_buff);
+  flushFreeBatches();
+}
+
+
+void chpl_comm_impl_put_fence(void) {
+  DBG_PRINTF(DBG_IFACE_MCM, "%s()", __func__);
+
+  forceMemFxVisAllNodes_noTcip(true /*checkPuts*/, false /*checkAmos*/);
 }
 
 
@@ -3897,7 +4973,8 @@ void chpl_comm_impl_task_create(void) {
 void chpl_comm_impl_task_end(void) {
   DBG_PRINTF(DBG_IFACE_MCM, "%s()", __func__);
 
-  task_local_buff_end(get_buff | put_buff | amo_nf_buff);
+  task_local_buff_end(get_buff | put_buff | amo_nf_buff | amo_am_buff);
+  flushFreeBatches();
   retireDelayedAmDone(true /*taskIsEnding*/);
   forceMemFxVisAllNodes_noTcip(true /*checkPuts*/, true /*checkAmos*/);
 }
@@ -3911,11 +4988,14 @@ void chpl_comm_impl_task_end(void) {
 typedef enum {
   am_opExecOn = CHPL_ARG_BUNDLE_KIND_COMM, // impl-nonspecific on-stmt
   am_opExecOnLrg,                          // on-stmt, large arg
+  am_opExecOnBatch,                        // several nonblocking on-stmts
   am_opGet,                                // do an RMA GET
   am_opPut,                                // do an RMA PUT
   am_opAMO,                                // do an AMO
+  am_opAMOBatch,                           // do a batch of non-fetching AMOs
   am_opFAMOResult,                         // return result of fetching AMO
   am_opFree,                               // free some memory
+  am_opFreeBatch,                          // free several things
   am_opNop,                                // do nothing; for MCM & liveness
   am_opShutdown,                           // signal main process for shutdown
 } amOp_t;
@@ -3971,6 +5051,32 @@ struct amRequest_AMO_t {
   void* result;                 // result address on initiator's node
 };
 
+//
+// A batch of non-fetching AMOs, all to the same target node.  Only the
+// first 'count' entries of ops[] are sent.  The maximum length keeps
+// this smaller than an executeOn request, so it doesn't increase the
+// size of the AM landing zones.
+//
+#define AM_MAX_AMO_BATCH_LEN 32
+
+struct amRequest_AMO_batch_t {
+  struct amRequest_base_t b;
+  int16_t count;                // number of AMOs in ops[]
+  struct {
+    void* obj;                  // object address on target node
+    chpl_amo_datum_t opnd;      // operand
+    uint8_t ofiOp;              // ofi AMO op (enum fi_op)
+    uint8_t ofiType;            // ofi object type (enum fi_datatype)
+    int8_t size;                // object size (bytes)
+  } ops[AM_MAX_AMO_BATCH_LEN];
+};
+
+static inline
+size_t amo_batch_reqSize(int count) {
+  return offsetof(struct amRequest_AMO_batch_t, ops)
+         + count * sizeof(((struct amRequest_AMO_batch_t*) NULL)->ops[0]);
+}
+
 struct amRequest_FAMO_result_t {
   struct amRequest_base_t b;
   int8_t size;                  // result size (bytes)
@@ -3985,14 +5091,53 @@ struct amRequest_free_t {
   void* p;                      // address to free, on AM target node
 };
 
+//
+// A batch of frees, all on the same target node.  Only the first
+// 'count' entries of p[] are sent.
+//
+#define AM_MAX_FREE_BATCH_LEN 64
+
+struct amRequest_free_batch_t {
+  struct amRequest_base_t b;
+  int16_t count;                // number of addresses in p[]
+  void* p[AM_MAX_FREE_BATCH_LEN]; // addresses to free, on AM target node
+};
+
+static inline
+size_t free_batch_reqSize(int count) {
+  return offsetof(struct amRequest_free_batch_t, p)
+         + count * sizeof(((struct amRequest_free_batch_t*) NULL)->p[0]);
+}
+
+//
+// A batch of small nonblocking executeOns to the same node.  The
+// bundles are packed one after another, each 8-byte aligned, in space[].
+//
+#define AM_MAX_BATCHED_EXEC_ON_SIZE 256  // largest bundle we'll batch
+
+struct amRequest_execOnBatch_t {
+  struct amRequest_base_t b;
+  uint32_t count;               // number of bundles
+  uint32_t used;                // bytes of space[] used
+  char space[AM_MAX_EXEC_ON_PAYLOAD_SIZE];
+};
+
+static inline
+size_t exec_on_batch_reqSize(size_t used) {
+  return offsetof(struct amRequest_execOnBatch_t, space) + used;
+}
+
 typedef union {
   struct amRequest_base_t b;
   struct amRequest_execOn_t xo;      // present only to set the max req size
   struct amRequest_execOnLrg_t xol;
+  struct amRequest_execOnBatch_t xoBatch;
   struct amRequest_RMA_t rma;
   struct amRequest_AMO_t amo;
+  struct amRequest_AMO_batch_t amoBatch;
   struct amRequest_FAMO_result_t famo_result;
   struct amRequest_free_t free;
+  struct amRequest_free_batch_t freeBatch;
 } amRequest_t;
 
 struct taskArg_RMA_t {
@@ -4038,7 +5183,8 @@ void chpl_comm_execute_on(c_nodeid_t node, c_sublocid_t subloc,
 
   CHK_TRUE(node != chpl_nodeID); // handled by the locale model
 
-  if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_executeOn)) {
+  if (chpl_comm_want_callbacks(chpl_comm_cb_event_kind_executeOn,
+                               node, argSize)) {
     chpl_comm_cb_info_t cb_data =
       {chpl_comm_cb_event_kind_executeOn, chpl_nodeID, node,
        .iu.executeOn={subloc, fid, arg, argSize, ln, fn}};
@@ -4062,7 +5208,8 @@ void chpl_comm_execute_on_nb(c_nodeid_t node, c_sublocid_t subloc,
 
   CHK_TRUE(node != chpl_nodeID); // handled by the locale model
 
-  if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_executeOn_nb)) {
+  if (chpl_comm_want_callbacks(chpl_comm_cb_event_kind_executeOn_nb,
+                               node, argSize)) {
     chpl_comm_cb_info_t cb_data =
       {chpl_comm_cb_event_kind_executeOn_nb, chpl_nodeID, node,
        .iu.executeOn={subloc, fid, arg, argSize, ln, fn}};
@@ -4086,7 +5233,8 @@ void chpl_comm_execute_on_fast(c_nodeid_t node, c_sublocid_t subloc,
 
   CHK_TRUE(node != chpl_nodeID); // handled by the locale model
 
-  if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_executeOn_fast)) {
+  if (chpl_comm_want_callbacks(chpl_comm_cb_event_kind_executeOn_fast,
+                               node, argSize)) {
     chpl_comm_cb_info_t cb_data =
       {chpl_comm_cb_event_kind_executeOn_fast, chpl_nodeID, node,
        .iu.executeOn={subloc, fid, arg, argSize, ln, fn}};
@@ -4100,6 +5248,108 @@ void chpl_comm_execute_on_fast(c_nodeid_t node, c_sublocid_t subloc,
 }
 
 
+//
+// Batching of nonblocking executeOns.
+//
+// We can't hold back a task's nonblocking executeOn in the hope that
+// more will follow, because the task might then block waiting for the
+// one it started, without doing anything else we'd see.  Instead we
+// combine.  While a task is sending an AM to some node, other tasks
+// starting nonblocking executeOns to that same node add them to a
+// pending batch rather than sending them.  When the first task is
+// done sending, it sends that batch in one AM, and repeats until no
+// batch is pending.  So nothing waits on anything but a send already
+// under way, and under load the AM rate to a node is much lower than
+// its fork rate.
+//
+struct execOnBatch_t {
+  pthread_mutex_t lock;
+  atomic_bool sending;          // a task is sending to this node now
+  struct amRequest_execOnBatch_t pending;
+};
+
+static struct execOnBatch_t* execOnBatches;  // [chpl_numNodes], or NULL
+
+static
+void init_execOnBatches(void) {
+  if (!envBatchExecOn) {
+    return;
+  }
+
+  CHPL_CALLOC(execOnBatches, chpl_numNodes);
+  for (int i = 0; i < chpl_numNodes; i++) {
+    PTHREAD_CHK(pthread_mutex_init(&execOnBatches[i].lock, NULL));
+    atomic_init_bool(&execOnBatches[i].sending, false);
+  }
+}
+
+
+static
+void amRequestExecOnBatchable(c_nodeid_t node,
+                              chpl_comm_on_bundle_t* arg, size_t argSize) {
+  struct execOnBatch_t* eob = &execOnBatches[node];
+  size_t space = ALIGN_UP(argSize, sizeof(uint64_t));
+
+  //
+  // If it looks like we'll add to a batch, first make sure the memory
+  // effects of our earlier PUTs and AMOs are visible.  The task that
+  // sends the batch can only do that for its own.
+  //
+  chpl_bool mayAdd = atomic_load_explicit_bool(&eob->sending,
+                                               memory_order_relaxed);
+  if (mayAdd) {
+    forceMemFxVisAllNodes_noTcip(true /*checkPuts*/, true /*checkAmos*/);
+  }
+
+  PTHREAD_CHK(pthread_mutex_lock(&eob->lock));
+  chpl_bool sending = atomic_load_bool(&eob->sending);
+  if (mayAdd && sending
+      && eob->pending.used + space <= sizeof(eob->pending.space)) {
+    memcpy(&eob->pending.space[eob->pending.used], arg, argSize);
+    eob->pending.used += space;
+    eob->pending.count++;
+    PTHREAD_CHK(pthread_mutex_unlock(&eob->lock));
+    return;
+  }
+  if (!sending) {
+    atomic_store_bool(&eob->sending, true);
+  }
+  PTHREAD_CHK(pthread_mutex_unlock(&eob->lock));
+
+  amRequestCommon(node, (amRequest_t*) arg, argSize, false, NULL);
+
+  if (sending) {
+    // some other task is responsible for the pending batch
+    return;
+  }
+
+  //
+  // Send whatever other tasks added while we were sending.
+  //
+  while (true) {
+    amRequest_t req;
+    PTHREAD_CHK(pthread_mutex_lock(&eob->lock));
+    if (eob->pending.count == 0) {
+      atomic_store_bool(&eob->sending, false);
+      PTHREAD_CHK(pthread_mutex_unlock(&eob->lock));
+      break;
+    }
+    size_t reqSize = exec_on_batch_reqSize(eob->pending.used);
+    memcpy(&req.xoBatch, &eob->pending, reqSize);
+    eob->pending.count = 0;
+    eob->pending.used = 0;
+    PTHREAD_CHK(pthread_mutex_unlock(&eob->lock));
+
+    req.xoBatch.b = (struct amRequest_base_t) { .op = am_opExecOnBatch,
+                                                .node = chpl_nodeID, };
+    DBG_PRINTF(DBG_AM | DBG_AM_SEND,
+               "sending batch of %d executeOns to %d",
+               (int) req.xoBatch.count, (int) node);
+    amRequestCommon(node, &req, reqSize, false, NULL);
+  }
+}
+
+
 static inline
 void amRequestExecOn(c_nodeid_t node, c_sublocid_t subloc,
                      chpl_fn_int_t fid,
@@ -4119,9 +5369,15 @@ void amRequestExecOn(c_nodeid_t node, c_sublocid_t subloc,
   if (argSize <= sizeof(amRequest_t)) {
     //
     // The arg bundle will fit in max-sized AM request; just send it.
+    // If it's a small nonblocking one, it may go in a batch.
     //
     arg->kind = am_opExecOn;
-    amRequestCommon(node, (amRequest_t*) arg, argSize, blocking, NULL);
+    if (!blocking && argSize <= AM_MAX_BATCHED_EXEC_ON_SIZE
+        && execOnBatches != NULL) {
+      amRequestExecOnBatchable(node, arg, argSize);
+    } else {
+      amRequestCommon(node, (amRequest_t*) arg, argSize, blocking, NULL);
+    }
   } else {
     //
     // The arg bundle is too large for an AM request.  Send a copy of
@@ -4181,7 +5437,7 @@ void amRequestRmaPut(c_nodeid_t node, void* addr, void* raddr, size_t size) {
                                .size = size, }, };
   amRequestCommon(node, &req, sizeof(req.rma), true, NULL);
 
-  mrUnLocalizeSource(myAddr, addr);
+  mrUnLocalizeSourceRemote(myAddr, addr);
 }
 
 
@@ -4206,7 +5462,7 @@ void amRequestRmaGet(c_nodeid_t node, void* addr, void* raddr, size_t size) {
                                .size = size, }, };
   amRequestCommon(node, &req, sizeof(req.rma), true, NULL);
 
-  mrUnLocalizeTarget(myAddr, addr, size);
+  mrUnLocalizeTargetRemote(myAddr, addr, size);
 }
 
 
@@ -4283,7 +5539,7 @@ void amRequestAMO(c_nodeid_t node, void* object,
   // neither of those require anything from the common code.
   //
   amRequestCommon(node, &req, sizeof(req.amo), blocking, tcip);
-  mrUnLocalizeTarget(myResult, result, size);
+  mrUnLocalizeTargetRemote(myResult, result, size);
   tciFree(tcip);
 }
 
@@ -4325,12 +5581,121 @@ void amRequestFAMOResult(c_nodeid_t node,
 }
 
 
+//
+// Batching of remote frees.
+//
+// Nothing waits for a remote free, so rather than sending an AM for
+// each one we collect them per target node and send each node's in one
+// AM, when its batch fills up or when a task ends or does an unordered
+// fence.  The batches are shared by all tasks, because a task often
+// frees just one thing (the initiator's copy of a large executeOn
+// payload, say) and what we want is to combine the frees of the many
+// tasks doing that at once.  The nodes with frees pending are kept in
+// a list, so flushing doesn't have to look at every node.
+//
+struct freeBatch_t {
+  int count;
+  void* p[AM_MAX_FREE_BATCH_LEN];
+};
+
+static pthread_mutex_t freeBatchLock = PTHREAD_MUTEX_INITIALIZER;
+static struct freeBatch_t** freeBatches;  // [chpl_numNodes], or NULL
+static c_nodeid_t* freeBatchNodes;        // nodes with frees pending
+static int numFreeBatchNodes;
+static atomic_bool freeBatchesPending;    // numFreeBatchNodes > 0
+
+static
+void init_freeBatches(void) {
+  if (!envBatchFree || chpl_numNodes <= 1) {
+    return;
+  }
+
+  CHPL_CALLOC(freeBatches, chpl_numNodes);
+  CHPL_CALLOC(freeBatchNodes, chpl_numNodes);
+  atomic_init_bool(&freeBatchesPending, false);
+}
+
+
+static
+void sendFreeBatch(c_nodeid_t node, struct freeBatch_t* fb) {
+  amRequest_t req = { .freeBatch = { .b = { .op = am_opFreeBatch,
+                                            .node = chpl_nodeID, },
+                                     .count = fb->count, }, };
+  memcpy(req.freeBatch.p, fb->p, fb->count * sizeof(fb->p[0]));
+  DBG_PRINTF(DBG_AM | DBG_AM_SEND,
+             "sending batch of %d frees to %d", fb->count, (int) node);
+  amRequestCommon(node, &req, free_batch_reqSize(fb->count), false, NULL);
+}
+
+
 static inline
 void amRequestFree(c_nodeid_t node, void* p) {
-  amRequest_t req = { .free = { .b = { .op = am_opFree,
-                                       .node = chpl_nodeID, },
-                                .p = p, }, };
-  amRequestCommon(node, &req, sizeof(req.free), false, NULL);
+  if (freeBatches == NULL) {
+    amRequest_t req = { .free = { .b = { .op = am_opFree,
+                                         .node = chpl_nodeID, },
+                                  .p = p, }, };
+    amRequestCommon(node, &req, sizeof(req.free), false, NULL);
+    return;
+  }
+
+  struct freeBatch_t full;
+  full.count = 0;
+
+  PTHREAD_CHK(pthread_mutex_lock(&freeBatchLock));
+  struct freeBatch_t* fb = freeBatches[node];
+  if (fb == NULL) {
+    CHPL_CALLOC(freeBatches[node], 1);
+    fb = freeBatches[node];
+  }
+  if (fb->count == 0) {
+    freeBatchNodes[numFreeBatchNodes++] = node;
+    atomic_store_bool(&freeBatchesPending, true);
+  }
+  fb->p[fb->count++] = p;
+  if (fb->count == AM_MAX_FREE_BATCH_LEN) {
+    //
+    // Take the full batch and send it once we've let go of the lock.
+    // The node stays in the pending list; flushing skips it if it
+    // is still empty by then.
+    //
+    full = *fb;
+    fb->count = 0;
+  }
+  PTHREAD_CHK(pthread_mutex_unlock(&freeBatchLock));
+
+  if (full.count > 0) {
+    sendFreeBatch(node, &full);
+  }
+}
+
+
+static
+void flushFreeBatches(void) {
+  if (freeBatches == NULL
+      || !atomic_load_explicit_bool(&freeBatchesPending,
+                                    memory_order_relaxed)) {
+    return;
+  }
+
+  while (true) {
+    struct freeBatch_t fb;
+    c_nodeid_t node;
+
+    PTHREAD_CHK(pthread_mutex_lock(&freeBatchLock));
+    if (numFreeBatchNodes == 0) {
+      atomic_store_bool(&freeBatchesPending, false);
+      PTHREAD_CHK(pthread_mutex_unlock(&freeBatchLock));
+      break;
+    }
+    node = freeBatchNodes[--numFreeBatchNodes];
+    fb = *freeBatches[node];
+    freeBatches[node]->count = 0;
+    PTHREAD_CHK(pthread_mutex_unlock(&freeBatchLock));
+
+    if (fb.count > 0) {
+      sendFreeBatch(node, &fb);
+    }
+  }
 }
 
 
@@ -4402,11 +5767,11 @@ void amRequestCommon(c_nodeid_t node,
     tciFree(myTcip);
   }
 
-  mrUnLocalizeSource(myReq, req);
+  mrUnLocalizeSource(myReq, req, reqSize);
 
   if (blocking) {
     amWaitForDone(pAmDone);
-    mrUnLocalizeSource(pAmDone, &amDone); // don't need or want target copyout
+    mrUnLocalizeSourceRemote(pAmDone, &amDone); // don't want target copyout
   }
 }
 
@@ -4471,6 +5836,8 @@ void amReqFn_msgOrdFence(c_nodeid_t node,
   switch (req->b.op) {
   case am_opExecOn:
   case am_opExecOnLrg:
+  case am_opExecOnBatch:
+  case am_opAMOBatch:
     forceMemFxVisAllNodes(true /*checkPuts*/, true /*checkAmos*/,
                           node /*skipNode*/, tcip);
     havePutsOut = (tcip->putVisBitmap != NULL
@@ -4560,6 +5927,8 @@ void amReqFn_msgOrd(c_nodeid_t node,
   switch (req->b.op) {
   case am_opExecOn:
   case am_opExecOnLrg:
+  case am_opExecOnBatch:
+  case am_opAMOBatch:
     forceMemFxVisAllNodes(true /*checkPuts*/, true /*checkAmos*/,
                           -1 /*skipNode*/, tcip);
     break;
@@ -4741,24 +6110,59 @@ static pthread_cond_t amStartStopCond = PTHREAD_COND_INITIALIZER;
 static pthread_mutex_t amStartStopMutex = PTHREAD_MUTEX_INITIALIZER;
 
 static void amHandler(void*);
+static void amHandlerReceiver(struct perTxCtxInfo_t*);
+static void amHandlerHelper(void);
+static void handleAmReq(amRequest_t*);
+static size_t amReqSize(amRequest_t*);
+static void dispatchAmReq(amRequest_t*, size_t);
 static void processRxAmReq(void);
 static void processRxAmReqCQ(void);
 static void processRxAmReqCntr(void);
 static void amHandleExecOn(chpl_comm_on_bundle_t*);
 static void amWrapExecOnBody(void*);
 static void amHandleExecOnLrg(chpl_comm_on_bundle_t*);
+static void amHandleExecOnBatch(struct amRequest_execOnBatch_t*);
 static void amWrapExecOnLrgBody(struct amRequest_execOnLrg_t*);
 static void amWrapGet(struct taskArg_RMA_t*);
 static void amWrapPut(struct taskArg_RMA_t*);
 static void amHandleAMO(struct amRequest_AMO_t*);
+static void amHandleAMOBatch(struct amRequest_AMO_batch_t*);
 static void amHandleFAMOResult(struct amRequest_FAMO_result_t*);
 static void amPutDone(c_nodeid_t, amDone_t*);
 static void amCheckLiveness(void);
 
+static void doTargetAMO(void*, const void*, const void*, void*,
+                        enum fi_op, enum fi_datatype, size_t size);
 static void doCpuAMO(void*, const void*, const void*, void*,
                      enum fi_op, enum fi_datatype, size_t size);
 
 
+//
+// With more than one AM handler, the receiving handler (index 0) hands
+// requests off to the helpers through these queues.  Requests are
+// steered by sender node, so that all the requests from any given
+// node are still handled in the order they arrived.
+//
+struct amHandoff_t {
+  struct amHandoff_t* next;
+  amRequest_t req;                // truncated to the actual req size
+};
+
+struct amHandoffQ_t {
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  struct amHandoff_t* head;
+  struct amHandoff_t* tail;
+  int depth;
+  int maxDepth;                   // for debug reporting
+  uint64_t numHandled;            // for debug reporting
+};
+
+static struct amHandoffQ_t amHandoffQs[MAX_AM_HANDLERS];
+static int amHandlerIdxs[MAX_AM_HANDLERS] = { 0, 1, 2, 3, 4, 5, 6, 7,
+                                              8, 9, 10, 11, 12, 13, 14, 15, };
+
+
 static
 void init_amHandling(void) {
   //
@@ -4769,16 +6173,26 @@ void init_amHandling(void) {
     CHK_TRUE(sizeof(pd.amDone) >= sizeof(amDone_t));
   }
 
+  for (int i = 0; i < numAmHandlers; i++) {
+    PTHREAD_CHK(pthread_mutex_init(&amHandoffQs[i].lock, NULL));
+    PTHREAD_CHK(pthread_cond_init(&amHandoffQs[i].cond, NULL));
+  }
+
   //
-  // Start AM handler thread(s).  Don't proceed from here until at
-  // least one is running.
+  // Start AM handler thread(s).  Don't proceed from here until all of
+  // them are running, because each one takes its own tx context and
+  // the receiving one must not start handing off requests to helpers
+  // that don't exist yet.
   //
   atomic_init_bool(&amHandlersExit, false);
   PTHREAD_CHK(pthread_mutex_lock(&amStartStopMutex));
   for (int i = 0; i < numAmHandlers; i++) {
-    CHK_TRUE(chpl_task_createCommTask(amHandler, NULL, reservedCPUs[i]) == 0);
+    CHK_TRUE(chpl_task_createCommTask(amHandler, &amHandlerIdxs[i],
+                                      reservedCPUs[i]) == 0);
+  }
+  while (numAmHandlersActive < numAmHandlers) {
+    PTHREAD_CHK(pthread_cond_wait(&amStartStopCond, &amStartStopMutex));
   }
-  PTHREAD_CHK(pthread_cond_wait(&amStartStopCond, &amStartStopMutex));
   PTHREAD_CHK(pthread_mutex_unlock(&amStartStopMutex));
 }
 
@@ -4799,7 +6213,16 @@ void fini_amHandling(void) {
     OFI_CHK(fi_cntr_add(ofi_rxCntr, 1));
   }
 
-  PTHREAD_CHK(pthread_cond_wait(&amStartStopCond, &amStartStopMutex));
+  // Helper AM handlers may be waiting for work.  Wake them.
+  for (int i = 1; i < numAmHandlers; i++) {
+    PTHREAD_CHK(pthread_mutex_lock(&amHandoffQs[i].lock));
+    PTHREAD_CHK(pthread_cond_signal(&amHandoffQs[i].cond));
+    PTHREAD_CHK(pthread_mutex_unlock(&amHandoffQs[i].lock));
+  }
+
+  while (numAmHandlersActive > 0) {
+    PTHREAD_CHK(pthread_cond_wait(&amStartStopCond, &amStartStopMutex));
+  }
   PTHREAD_CHK(pthread_mutex_unlock(&amStartStopMutex));
 
   atomic_destroy_bool(&amHandlersExit);
@@ -4812,25 +6235,54 @@ void fini_amHandling(void) {
 static __thread struct perTxCtxInfo_t* amTcip;
 
 static
-void amHandler(void* argNil) {
+void amHandler(void* arg) {
+  isAmHandler = true;
+  amHandlerIdx = *(int*) arg;
+
   struct perTxCtxInfo_t* tcip;
   CHK_TRUE((tcip = tciAllocForAmHandler()) != NULL);
   amTcip = tcip;
 
-  isAmHandler = true;
-
-  DBG_PRINTF(DBG_AM, "AM handler running");
+  DBG_PRINTF(DBG_AM, "AM handler %d running", amHandlerIdx);
 
   //
   // Count this AM handler thread as running.  The creator thread
-  // wants to be released as soon as at least one AM handler thread
-  // is running, so if we're the first, do that.
+  // wants to be released once all the AM handler threads are running,
+  // so if we're the last, do that.
+  //
+  PTHREAD_CHK(pthread_mutex_lock(&amStartStopMutex));
+  if (++numAmHandlersActive == numAmHandlers)
+    PTHREAD_CHK(pthread_cond_signal(&amStartStopCond));
+  PTHREAD_CHK(pthread_mutex_unlock(&amStartStopMutex));
+
+  if (amHandlerIdx == 0) {
+    amHandlerReceiver(tcip);
+  } else {
+    amHandlerHelper();
+  }
+
+  DBG_PRINTF(DBG_AM, "AM handler %d done, handled %" PRIu64
+             " handed-off reqs, max queue depth %d",
+             amHandlerIdx, amHandoffQs[amHandlerIdx].numHandled,
+             amHandoffQs[amHandlerIdx].maxDepth);
+
+  //
+  // Un-count this AM handler thread.  Whoever told us to exit wants to
+  // be released once all the AM handler threads are done, so if we're
+  // the last, do that.
   //
   PTHREAD_CHK(pthread_mutex_lock(&amStartStopMutex));
-  if (++numAmHandlersActive == 1)
+  if (--numAmHandlersActive == 0)
     PTHREAD_CHK(pthread_cond_signal(&amStartStopCond));
   PTHREAD_CHK(pthread_mutex_unlock(&amStartStopMutex));
+}
+
 
+//
+// The receiving AM handler runs this.
+//
+static
+void amHandlerReceiver(struct perTxCtxInfo_t* tcip) {
   //
   // Process AM requests and watch transmit responses arrive.
   //
@@ -4852,23 +6304,127 @@ void amHandler(void* argNil) {
       amCheckLiveness();
     }
   }
+}
+
+
+//
+// Helper AM handlers run this.  They handle requests the receiving
+// handler has handed off to them, and consume their own transmit
+// completions.
+//
+static
+void amHandlerHelper(void) {
+  struct amHandoffQ_t* q = &amHandoffQs[amHandlerIdx];
+
+  while (true) {
+    PTHREAD_CHK(pthread_mutex_lock(&q->lock));
+    while (q->head == NULL && !atomic_load_bool(&amHandlersExit)) {
+      PTHREAD_CHK(pthread_cond_wait(&q->cond, &q->lock));
+    }
+    struct amHandoff_t* ho = q->head;
+    if (ho != NULL) {
+      if ((q->head = ho->next) == NULL) {
+        q->tail = NULL;
+      }
+      q->depth--;
+    }
+    PTHREAD_CHK(pthread_mutex_unlock(&q->lock));
+
+    if (ho == NULL) {
+      break;                    // told to exit, and nothing left to do
+    }
+
+    handleAmReq(&ho->req);
+    chpl_mem_arena_free(ho, 0, 0);
+    q->numHandled++;
+    (*amTcip->checkTxCmplsFn)(amTcip);
+  }
+}
+
+
+//
+// Hand a received AM request off to the appropriate AM handler, or
+// handle it here if that's us.  The request is in the receive buffer,
+// so when handing it off we have to copy it.
+//
+static
+void dispatchAmReq(amRequest_t* req, size_t size) {
+  c_nodeid_t sender = op_uses_on_bundle(req->b.op)
+                      ? req->xo.hdr.comm.node
+                      : req->b.node;
+  int idx = (numAmHandlers == 1) ? 0 : (int) (sender % numAmHandlers);
+  if (idx == 0) {
+    handleAmReq(req);
+    return;
+  }
+
+  struct amHandoff_t* ho;
+  ho = chpl_mem_arena_alloc(offsetof(struct amHandoff_t, req) + size,
+                            CHPL_RT_MD_COMM_UTIL, 0, 0);
+  if (ho == NULL) {
+    chpl_error("out of memory handing off AM request", 0, 0);
+  }
+  ho->next = NULL;
+  memcpy(&ho->req, req, size);
+
+  struct amHandoffQ_t* q = &amHandoffQs[idx];
+  PTHREAD_CHK(pthread_mutex_lock(&q->lock));
+  if (q->tail == NULL) {
+    q->head = ho;
+  } else {
+    q->tail->next = ho;
+  }
+  q->tail = ho;
+  int depth = ++q->depth;
+  if (depth > q->maxDepth) {
+    q->maxDepth = depth;
+  }
+  PTHREAD_CHK(pthread_cond_signal(&q->cond));
+  PTHREAD_CHK(pthread_mutex_unlock(&q->lock));
+
+  chpl_comm_diags_add_nontask(am_handoffs, 1);
+  chpl_comm_diags_add_nontask(am_handoff_depth, depth);
+}
 
-  //
-  // Un-count this AM handler thread.  Whoever told us to exit wants to
-  // be released once all the AM handler threads are done, so if we're
-  // the last, do that.
-  //
-  PTHREAD_CHK(pthread_mutex_lock(&amStartStopMutex));
-  if (--numAmHandlersActive == 0)
-    PTHREAD_CHK(pthread_cond_signal(&amStartStopCond));
-  PTHREAD_CHK(pthread_mutex_unlock(&amStartStopMutex));
 
-  DBG_PRINTF(DBG_AM, "AM handler done");
+//
+// Return the size of an AM request as sent.  This has to be computed
+// before the request is handled, because handling may modify it.
+//
+static
+size_t amReqSize(amRequest_t* req) {
+  switch (req->b.op) {
+    case am_opExecOn:
+      return req->xo.hdr.comm.argSize;
+    case am_opExecOnLrg:
+      return sizeof(req->xol);
+    case am_opExecOnBatch:
+      return exec_on_batch_reqSize(req->xoBatch.used);
+    case am_opGet:
+    case am_opPut:
+      return sizeof(req->rma);
+    case am_opAMO:
+      return sizeof(req->amo);
+    case am_opAMOBatch:
+      return amo_batch_reqSize(req->amoBatch.count);
+    case am_opFAMOResult:
+      return sizeof(req->famo_result);
+    case am_opFree:
+      return sizeof(req->free);
+    case am_opFreeBatch:
+      return free_batch_reqSize(req->freeBatch.count);
+    case am_opNop:
+    case am_opShutdown:
+      return sizeof(req->b);
+    default:
+      INTERNAL_ERROR_V("unexpected AM op %d", (int) req->b.op);
+      return 0;
+  }
 }
 
+
 static
-size_t handleAmReq(amRequest_t *req) {
-  size_t size = 0;
+void handleAmReq(amRequest_t *req) {
   switch (req->b.op) {
     case am_opExecOn:
       DBG_PRINTF(DBG_AM | DBG_AM_RECV, "rx AM sizeof %lu argSize %lu", sizeof(req->xo.hdr), req->xo.hdr.comm.argSize);
@@ -4877,13 +6433,15 @@ size_t handleAmReq(amRequest_t *req) {
       } else {
         amHandleExecOn(&req->xo.hdr);
       }
-      size = req->xo.hdr.comm.argSize;
       break;
 
     case am_opExecOnLrg:
       DBG_PRINTF(DBG_AM | DBG_AM_RECV, "rx AM sizeof %lu argSize %lu", sizeof(req->xol.hdr), req->xol.hdr.comm.argSize);
       amHandleExecOnLrg(&req->xol.hdr);
-      size = sizeof(req->xol);
+      break;
+
+    case am_opExecOnBatch:
+      amHandleExecOnBatch(&req->xoBatch);
       break;
 
     case am_opGet:
@@ -4894,7 +6452,6 @@ size_t handleAmReq(amRequest_t *req) {
                                  &arg, sizeof(arg), c_sublocid_any,
                                  chpl_nullTaskID);
       }
-      size = sizeof(req->rma);
       break;
 
     case am_opPut:
@@ -4905,22 +6462,30 @@ size_t handleAmReq(amRequest_t *req) {
                                  &arg, sizeof(arg), c_sublocid_any,
                                  chpl_nullTaskID);
       }
-      size = sizeof(req->rma);
       break;
 
     case am_opAMO:
       amHandleAMO(&req->amo);
-      size = sizeof(req->amo);
+      break;
+
+    case am_opAMOBatch:
+      amHandleAMOBatch(&req->amoBatch);
       break;
 
     case am_opFAMOResult:
       amHandleFAMOResult(&req->famo_result);
-      size = sizeof(req->famo_result);
       break;
 
     case am_opFree:
-      CHPL_FREE(req->free.p);
-      size = sizeof(req->free);
+      freeBounceBuf(req->free.p);
+      break;
+
+    case am_opFreeBatch:
+      DBG_PRINTF(DBG_AM | DBG_AM_RECV, "rx AM batch of %d frees",
+                 (int) req->freeBatch.count);
+      for (int i = 0; i < req->freeBatch.count; i++) {
+        freeBounceBuf(req->freeBatch.p[i]);
+      }
       break;
 
     case am_opNop:
@@ -4928,19 +6493,16 @@ size_t handleAmReq(amRequest_t *req) {
       if (req->b.pAmDone != NULL) {
         amPutDone(req->b.node, req->b.pAmDone);
       }
-      size = sizeof(req->b);
       break;
 
     case am_opShutdown:
       chpl_signal_shutdown();
-      size = sizeof(req->b);
       break;
 
     default:
       INTERNAL_ERROR_V("unexpected AM op %d", (int) req->b.op);
       break;
   }
-  return size;
 }
 
 static
@@ -5008,7 +6570,8 @@ void processRxAmReqCntr(void) {
     DBG_PRINTF(DBG_AM | DBG_AM_RECV,
                "rx AM req: %s",
                am_reqStr(chpl_nodeID, req, 0));
-    size = handleAmReq(req);
+    size = amReqSize(req);
+    dispatchAmReq(req, size);
     ofi_rxBuffer = (void *) ((char *) ofi_rxBuffer +  size);
   }
   ofi_rxCount += todo;
@@ -5044,7 +6607,7 @@ void processRxAmReqCQ(void) {
       DBG_PRINTF(DBG_AM | DBG_AM_RECV,
                  "rx AM req: %s",
                  am_reqStr(chpl_nodeID, req, cqes[i].len));
-      (void) handleAmReq(req);
+      dispatchAmReq(req, amReqSize(req));
     }
     if ((cqes[i].flags & FI_MULTI_RECV) != 0) {
       //
@@ -5105,25 +6668,47 @@ void amHandleExecOnLrg(chpl_comm_on_bundle_t* req) {
 
 
 static
-void amWrapExecOnLrgBody(struct amRequest_execOnLrg_t* xol) {
-  DBG_PRINTF(DBG_AM | DBG_AM_RECV, "%s", am_reqStartStr((amRequest_t*) xol));
+void amHandleExecOnBatch(struct amRequest_execOnBatch_t* xob) {
+  DBG_PRINTF(DBG_AM | DBG_AM_RECV, "rx AM batch of %d executeOns",
+             (int) xob->count);
 
   //
-  // TODO: We could stack-allocate "bundle" here, if it was small enough
-  //       (TBD) not to create the potential for stack overflow.  Some
-  //       systems have fast enough networks that saving the dynamic
-  //       alloc should be performance-visible.
+  // Start a task for each bundle, just as for a single one.  Tasks are
+  // started from a copy of the bundle, so we can leave these in place.
   //
+  size_t off = 0;
+  for (uint32_t i = 0; i < xob->count; i++) {
+    chpl_comm_on_bundle_t* bundle =
+      (chpl_comm_on_bundle_t*) &xob->space[off];
+    amHandleExecOn(bundle);
+    off += ALIGN_UP(bundle->comm.argSize, sizeof(uint64_t));
+  }
+}
+
+
+static
+void amWrapExecOnLrgBody(struct amRequest_execOnLrg_t* xol) {
+  DBG_PRINTF(DBG_AM | DBG_AM_RECV, "%s", am_reqStartStr((amRequest_t*) xol));
 
   //
   // The bundle header is in our argument, but we have to retrieve the
-  // payload from the initiating side.
+  // payload from the initiating side.  Small enough bundles go on the
+  // stack; on fast networks saving the dynamic alloc is visible.  But
+  // only with scalable memory registration, so that the GET doesn't
+  // need a bounce buffer for the unregistered stack memory.
   //
   chpl_comm_bundleData_t* comm = &xol->hdr.comm;
   c_nodeid_t node = comm->node;
 
+  union {
+    chpl_comm_on_bundle_t b;
+    char space[AM_MAX_STACK_EXEC_ON_LRG_SIZE];
+  } stackBundle;
+
   chpl_comm_on_bundle_t* bundle;
-  CHPL_CALLOC_SZ(bundle, 1, comm->argSize);
+  bundle = (scalableMemReg && comm->argSize <= sizeof(stackBundle))
+           ? &stackBundle.b
+           : chpl_mem_arena_alloc(comm->argSize, CHPL_RT_MD_COMM_UTIL, 0, 0);
   *bundle = xol->hdr;
 
   size_t payloadSize = comm->argSize
@@ -5154,7 +6739,9 @@ void amWrapExecOnLrgBody(struct amRequest_execOnLrg_t* xol) {
     amPutDone(node, comm->pAmDone);
   }
 
-  CHPL_FREE(bundle);
+  if (bundle != &stackBundle.b) {
+    chpl_mem_arena_free(bundle, 0, 0);
+  }
 }
 
 
@@ -5196,8 +6783,8 @@ void amHandleAMO(struct amRequest_AMO_t* amo) {
 
   chpl_amo_datum_t result;
   size_t resSize = amo->size;
-  doCpuAMO(amo->obj, &amo->opnd, &amo->cmpr, &result,
-           amo->ofiOp, amo->ofiType, amo->size);
+  doTargetAMO(amo->obj, &amo->opnd, &amo->cmpr, &result,
+              amo->ofiOp, amo->ofiType, amo->size);
 
   if (amo->result != NULL) {
       // Use a non-blocking AMO to return the result and set pAmDone.
@@ -5215,6 +6802,27 @@ void amHandleAMO(struct amRequest_AMO_t* amo) {
 }
 
 
+static
+void amHandleAMOBatch(struct amRequest_AMO_batch_t* amoBatch) {
+  DBG_PRINTF(DBG_AM | DBG_AM_RECV, "%s",
+             am_reqStartStr((amRequest_t*) amoBatch));
+  assert(amoBatch->b.node != chpl_nodeID); // should be handled on initiator
+
+  for (int i = 0; i < amoBatch->count; i++) {
+    doTargetAMO(amoBatch->ops[i].obj, &amoBatch->ops[i].opnd, NULL, NULL,
+                (enum fi_op) amoBatch->ops[i].ofiOp,
+                (enum fi_datatype) amoBatch->ops[i].ofiType,
+                amoBatch->ops[i].size);
+  }
+
+  if (amoBatch->b.pAmDone != NULL) {
+    amPutDone(amoBatch->b.node, amoBatch->b.pAmDone);
+  }
+  DBG_PRINTF(DBG_AM | DBG_AM_RECV, "%s",
+             am_reqDoneStr((amRequest_t*) amoBatch));
+}
+
+
 static inline
 void amPutDone(c_nodeid_t node, amDone_t* pAmDone) {
   static __thread amDone_t* amDone = NULL;
@@ -5339,6 +6947,172 @@ void amCheckLiveness(void) {
 }
 
 
+////////////////////////////////////////
+//
+// Congestion throttling
+//
+
+//
+// With CHPL_RT_COMM_OFI_THROTTLE set, tasks on a node limit how many
+// RMAs they have in flight to each other node at once.  The limit is a
+// window that grows by one per window's worth of RMAs that complete
+// about as fast as the fastest ever seen to that node, and halves,
+// no more than once per round trip, when one takes much longer.  This
+// additive-increase, multiplicative-decrease scheme backs everyone off
+// when many nodes pile onto one, before the target's NIC and the links
+// in front of it saturate.  The state is per target node and shared by
+// all our tx contexts, since their traffic meets the same congestion.
+// Only small transfers are timed, because how long large ones take
+// depends mostly on their size.  AM handlers are never throttled.
+//
+#define THROTTLE_WINDOW_INIT 32
+#define THROTTLE_WINDOW_MAX 1024
+#define THROTTLE_SLOW_FACTOR 4
+#define THROTTLE_TIMED_SIZE_MAX 4096
+
+struct throttleNode_t {
+  atomic_uint_least32_t inFlight;
+  atomic_uint_least32_t window;
+  atomic_uint_least32_t acks;         // fast completions since last grow
+  atomic_uint_least64_t minLatNs;     // fastest timed completion seen
+  atomic_uint_least64_t lastCutNs;    // when the window last shrank
+};
+
+static struct throttleNode_t* throttleTab;
+
+static
+void init_throttle(void) {
+  if (!envThrottle || chpl_numNodes <= 1) {
+    return;
+  }
+
+  CHPL_CALLOC(throttleTab, chpl_numNodes);
+  for (int i = 0; i < chpl_numNodes; i++) {
+    struct throttleNode_t* tn = &throttleTab[i];
+    atomic_init_uint_least32_t(&tn->inFlight, 0);
+    atomic_init_uint_least32_t(&tn->window, THROTTLE_WINDOW_INIT);
+    atomic_init_uint_least32_t(&tn->acks, 0);
+    atomic_init_uint_least64_t(&tn->minLatNs, UINT64_MAX);
+    atomic_init_uint_least64_t(&tn->lastCutNs, 0);
+  }
+}
+
+
+static
+void fini_throttle(void) {
+  if (throttleTab != NULL) {
+    for (int i = 0; i < chpl_numNodes; i++) {
+      struct throttleNode_t* tn = &throttleTab[i];
+      atomic_destroy_uint_least32_t(&tn->inFlight);
+      atomic_destroy_uint_least32_t(&tn->window);
+      atomic_destroy_uint_least32_t(&tn->acks);
+      atomic_destroy_uint_least64_t(&tn->minLatNs);
+      atomic_destroy_uint_least64_t(&tn->lastCutNs);
+    }
+    CHPL_FREE(throttleTab);
+  }
+}
+
+
+static inline
+chpl_bool throttleApplies(void) {
+  return throttleTab != NULL && amTcip == NULL;
+}
+
+
+static inline
+uint64_t throttleNowNs(void) {
+  return (uint64_t) (chpl_comm_ofi_time_get() * 1e9);
+}
+
+
+//
+// Wait for room in the window for the given node, then take a slot in
+// it.  Returns the start time to pass to throttleEnd().  Don't call
+// this while holding a tciTab[] entry, because it may yield.
+//
+static inline
+uint64_t throttleBegin(c_nodeid_t node) {
+  if (!throttleApplies()) {
+    return 0;
+  }
+
+  struct throttleNode_t* tn = &throttleTab[node];
+  chpl_bool waited = false;
+  uint_least32_t n = atomic_load_uint_least32_t(&tn->inFlight);
+  while (true) {
+    if (n < atomic_load_uint_least32_t(&tn->window)) {
+      if (atomic_compare_exchange_weak_uint_least32_t(&tn->inFlight,
+                                                      &n, n + 1)) {
+        break;
+      }
+    } else {
+      if (!waited) {
+        chpl_comm_diags_incr(throttle_waits);
+        waited = true;
+      }
+      local_yield();
+      n = atomic_load_uint_least32_t(&tn->inFlight);
+    }
+  }
+
+  return throttleNowNs();
+}
+
+
+//
+// Release the slot taken by throttleBegin() and adjust the window
+// based on how long the transfer took.
+//
+static inline
+void throttleEnd(c_nodeid_t node, size_t size, uint64_t startNs) {
+  if (!throttleApplies()) {
+    return;
+  }
+
+  struct throttleNode_t* tn = &throttleTab[node];
+  (void) atomic_fetch_sub_uint_least32_t(&tn->inFlight, 1);
+  if (size > THROTTLE_TIMED_SIZE_MAX) {
+    return;
+  }
+
+  const uint64_t nowNs = throttleNowNs();
+  const uint64_t latNs = nowNs - startNs;
+  uint64_t minLatNs = atomic_load_uint_least64_t(&tn->minLatNs);
+  while (latNs < minLatNs
+         && !atomic_compare_exchange_weak_uint_least64_t(&tn->minLatNs,
+                                                         &minLatNs, latNs)) {
+    // minLatNs was reloaded; retry
+  }
+  if (latNs < minLatNs) {
+    minLatNs = latNs;
+  }
+
+  uint_least32_t window = atomic_load_uint_least32_t(&tn->window);
+  if (latNs > THROTTLE_SLOW_FACTOR * minLatNs) {
+    uint64_t lastCutNs = atomic_load_uint_least64_t(&tn->lastCutNs);
+    if (nowNs - lastCutNs > latNs
+        && atomic_compare_exchange_strong_uint_least64_t(&tn->lastCutNs,
+                                                         &lastCutNs, nowNs)) {
+      uint_least32_t newWindow = (window > 1) ? window / 2 : 1;
+      atomic_store_uint_least32_t(&tn->window, newWindow);
+      atomic_store_uint_least32_t(&tn->acks, 0);
+      chpl_comm_diags_incr(throttle_cuts);
+      DBG_PRINTF(DBG_RMA,
+                 "throttle node %d: window %u -> %u, latency %" PRIu64
+                 " ns, min %" PRIu64 " ns",
+                 (int) node, (unsigned) window, (unsigned) newWindow,
+                 latNs, minLatNs);
+    }
+  } else if (window < THROTTLE_WINDOW_MAX
+             && atomic_fetch_add_uint_least32_t(&tn->acks, 1) + 1 >= window) {
+    atomic_store_uint_least32_t(&tn->acks, 0);
+    (void) atomic_compare_exchange_strong_uint_least32_t(&tn->window,
+                                                         &window, window + 1);
+  }
+}
+
+
 ////////////////////////////////////////
 //
 // Interface: RMA
@@ -5391,6 +7165,37 @@ int chpl_comm_try_nb_some(chpl_comm_nb_handle_t* h, size_t nhandles) {
 }
 
 
+//
+// A blocking PUT or GET to a co-located node can be done directly with
+// cross-memory attach, leaving the network out of it.  CMA completes
+// before it returns, but this task's earlier network operations to the
+// node may not have yet, so make those visible first.  Returns how many
+// bytes were moved; the caller does the rest over the network.
+//
+static inline
+size_t cmaRma(chpl_bool isPut, void* addr, c_nodeid_t node, void* raddr,
+              size_t size) {
+  if (!chpl_comm_ofi_cma_reaches(node)) {
+    return 0;
+  }
+
+  DBG_PRINTF(DBG_RMA | DBG_CMA, "CMA %s %d:%p %s %p, size %zd",
+             isPut ? "PUT" : "GET", (int) node, raddr,
+             isPut ? "<=" : "=>", addr, size);
+
+  if (mcmMode != mcmm_dlvrCmplt) {
+    struct perTxCtxInfo_t* tcip;
+    CHK_TRUE((tcip = tciAlloc()) != NULL);
+    forceMemFxVisOneNode(node, true /*checkPuts*/, true /*checkAmos*/, tcip);
+    tciFree(tcip);
+  }
+
+  return isPut
+         ? chpl_comm_ofi_cma_put(addr, node, raddr, size)
+         : chpl_comm_ofi_cma_get(addr, node, raddr, size);
+}
+
+
 void chpl_comm_put(void* addr, c_nodeid_t node, void* raddr,
                    size_t size, int32_t commID, int ln, int32_t fn) {
   DBG_PRINTF(DBG_IFACE,
@@ -5415,7 +7220,7 @@ void chpl_comm_put(void* addr, c_nodeid_t node, void* raddr,
   }
 
   // Communications callback support
-  if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_put)) {
+  if (chpl_comm_want_callbacks(chpl_comm_cb_event_kind_put, node, size)) {
       chpl_comm_cb_info_t cb_data =
         {chpl_comm_cb_event_kind_put, chpl_nodeID, node,
          .iu.comm={addr, raddr, size, commID, ln, fn}};
@@ -5425,7 +7230,11 @@ void chpl_comm_put(void* addr, c_nodeid_t node, void* raddr,
   chpl_comm_diags_verbose_rdma("put", node, size, ln, fn, commID);
   chpl_comm_diags_incr(put);
 
-  (void) ofi_put(addr, node, raddr, size);
+  size_t cmaDone = cmaRma(true /*isPut*/, addr, node, raddr, size);
+  if (cmaDone < size) {
+    (void) ofi_put((char*) addr + cmaDone, node, (char*) raddr + cmaDone,
+                   size - cmaDone);
+  }
 }
 
 
@@ -5453,7 +7262,7 @@ void chpl_comm_get(void* addr, int32_t node, void* raddr,
   }
 
   // Communications callback support
-  if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_get)) {
+  if (chpl_comm_want_callbacks(chpl_comm_cb_event_kind_get, node, size)) {
       chpl_comm_cb_info_t cb_data =
         {chpl_comm_cb_event_kind_get, chpl_nodeID, node,
          .iu.comm={addr, raddr, size, commID, ln, fn}};
@@ -5463,7 +7272,54 @@ void chpl_comm_get(void* addr, int32_t node, void* raddr,
   chpl_comm_diags_verbose_rdma("get", node, size, ln, fn, commID);
   chpl_comm_diags_incr(get);
 
-  (void) ofi_get(addr, node, raddr, size);
+  size_t cmaDone = cmaRma(false /*isPut*/, addr, node, raddr, size);
+  if (cmaDone < size) {
+    (void) ofi_get((char*) addr + cmaDone, node, (char*) raddr + cmaDone,
+                   size - cmaDone);
+  }
+}
+
+
+//
+// Try to do a strided transfer natively, with vectored RMA.  If that
+// works, do the callbacks and diagnostics here, charging the whole
+// thing as a single PUT or GET.  Otherwise leave those to the generic
+// strided code.
+//
+static inline
+chpl_bool strd_iov_common(chpl_bool isPut,
+                          void* dstaddr, size_t* dststrides, c_nodeid_t node,
+                          void* srcaddr, size_t* srcstrides,
+                          size_t* count, int32_t stridelevels,
+                          size_t elemSize,
+                          int32_t commID, int ln, int32_t fn) {
+  if (!ofi_strd_iov(isPut, dstaddr, dststrides, node, srcaddr, srcstrides,
+                    count, stridelevels, elemSize)) {
+    return false;
+  }
+
+  chpl_comm_cb_event_kind_t kind = isPut
+                                   ? chpl_comm_cb_event_kind_put_strd
+                                   : chpl_comm_cb_event_kind_get_strd;
+  if (chpl_comm_have_callbacks(kind)
+      && chpl_comm_want_callbacks(kind, node,
+          chpl_comm_cb_strd_size(count, stridelevels, elemSize))) {
+    chpl_comm_cb_info_t cb_data =
+      {kind, chpl_nodeID, node,
+       .iu.comm_strd={srcaddr, srcstrides, dstaddr, dststrides, count,
+                      stridelevels, elemSize, commID, ln, fn}};
+    chpl_comm_do_callbacks (&cb_data);
+  }
+
+  if (isPut) {
+    chpl_comm_diags_verbose_rdmaStrd("put", node, ln, fn, commID);
+    chpl_comm_diags_incr(put);
+  } else {
+    chpl_comm_diags_verbose_rdmaStrd("get", node, ln, fn, commID);
+    chpl_comm_diags_incr(get);
+  }
+
+  return true;
 }
 
 
@@ -5477,6 +7333,12 @@ void chpl_comm_put_strd(void* dstaddr_arg, size_t* dststrides,
              dstaddr_arg, dststrides, (int) dstnode, srcaddr_arg, srcstrides,
              count, (int) stridelevels, elemSize, (int) commID);
 
+  if (strd_iov_common(true /*isPut*/, dstaddr_arg, dststrides, dstnode,
+                      srcaddr_arg, srcstrides, count, stridelevels, elemSize,
+                      commID, ln, fn)) {
+    return;
+  }
+
   put_strd_common(dstaddr_arg, dststrides,
                   dstnode,
                   srcaddr_arg, srcstrides,
@@ -5496,6 +7358,12 @@ void chpl_comm_get_strd(void* dstaddr_arg, size_t* dststrides,
              dstaddr_arg, dststrides, (int) srcnode, srcaddr_arg, srcstrides,
              count, (int) stridelevels, elemSize, (int) commID);
 
+  if (strd_iov_common(false /*isPut*/, dstaddr_arg, dststrides, srcnode,
+                      srcaddr_arg, srcstrides, count, stridelevels, elemSize,
+                      commID, ln, fn)) {
+    return;
+  }
+
   get_strd_common(dstaddr_arg, dststrides,
                   srcnode,
                   srcaddr_arg, srcstrides,
@@ -5505,6 +7373,35 @@ void chpl_comm_get_strd(void* dstaddr_arg, size_t* dststrides,
 }
 
 
+//
+// We don't have non-blocking handles yet (see chpl_comm_put_nb()), so
+// these are complete on return.  The vectored strided transfers still
+// keep all of their messages in flight together.
+//
+chpl_comm_nb_handle_t chpl_comm_put_strd_nb(void* dstaddr, size_t* dststrides,
+                                            c_nodeid_t dstnode,
+                                            void* srcaddr, size_t* srcstrides,
+                                            size_t* count, int32_t stridelevels,
+                                            size_t elemSize, int32_t commID,
+                                            int ln, int32_t fn) {
+  chpl_comm_put_strd(dstaddr, dststrides, dstnode, srcaddr, srcstrides,
+                     count, stridelevels, elemSize, commID, ln, fn);
+  return NULL;
+}
+
+
+chpl_comm_nb_handle_t chpl_comm_get_strd_nb(void* dstaddr, size_t* dststrides,
+                                            c_nodeid_t srcnode,
+                                            void* srcaddr, size_t* srcstrides,
+                                            size_t* count, int32_t stridelevels,
+                                            size_t elemSize, int32_t commID,
+                                            int ln, int32_t fn) {
+  chpl_comm_get_strd(dstaddr, dststrides, srcnode, srcaddr, srcstrides,
+                     count, stridelevels, elemSize, commID, ln, fn);
+  return NULL;
+}
+
+
 void chpl_comm_getput_unordered(c_nodeid_t dstnode, void* dstaddr,
                                 c_nodeid_t srcnode, void* srcaddr,
                                 size_t size, int32_t commID,
@@ -5571,7 +7468,7 @@ void chpl_comm_get_unordered(void* addr, c_nodeid_t node, void* raddr,
   }
 
   // Communications callback support
-  if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_get)) {
+  if (chpl_comm_want_callbacks(chpl_comm_cb_event_kind_get, node, size)) {
       chpl_comm_cb_info_t cb_data =
         {chpl_comm_cb_event_kind_get, chpl_nodeID, node,
          .iu.comm={addr, raddr, size, commID, ln, fn}};
@@ -5609,7 +7506,7 @@ void chpl_comm_put_unordered(void* addr, c_nodeid_t node, void* raddr,
   }
 
   // Communications callback support
-  if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_put)) {
+  if (chpl_comm_want_callbacks(chpl_comm_cb_event_kind_put, node, size)) {
       chpl_comm_cb_info_t cb_data =
         {chpl_comm_cb_event_kind_put, chpl_nodeID, node,
          .iu.comm={addr, raddr, size, commID, ln, fn}};
@@ -5705,24 +7602,46 @@ struct perTxCtxInfo_t* findFreeTciTabEntry(chpl_bool bindToAmHandler) {
 
   if (bindToAmHandler) {
     //
-    // AM handlers use tciTab[numWorkerTxCtxs .. tciTabLen - 1].  For
-    // now we only support a single AM handler, so this is simple.  If
-    // we ever have more, the CHK_FALSE will force us to revisit this.
+    // AM handlers use tciTab[numWorkerTxCtxs .. tciTabLen - 1], from
+    // the top down by handler index.  The receiving handler (index 0)
+    // thus gets the last one, which is the one in the AM poll set.
     //
-    tcip = &tciTab[numWorkerTxCtxs];
+    tcip = &tciTab[tciTabLen - 1 - amHandlerIdx];
+    CHK_TRUE(tcip >= &tciTab[numWorkerTxCtxs]);
     CHK_TRUE(tciAllocTabEntry(tcip));
     return tcip;
   }
 
   //
-  // Workers use tciTab[0 .. numWorkerTxCtxs - 1].  Search forever for
-  // an entry we can use.  Give up (and kill the program) only if we
-  // discover they're all bound, because if that's true we can predict
-  // we'll never find a free one.
+  // Workers use tciTab[0 .. numWorkerTxCtxs - 1].  With more than one
+  // NIC, first look once for an entry on a NIC in our socket.
   //
   static __thread int last_iw = 0;
   tcip = NULL;
 
+  if (numNics > 1) {
+    static __thread int mySocket = -2;
+    if (mySocket == -2) {
+      mySocket = chpl_topo_getThreadSocket();
+    }
+    if (mySocket >= 0) {
+      int iw = last_iw;
+      do {
+        if (++iw >= numWorkerTxCtxs)
+          iw = 0;
+        if (nicTab[tciTab[iw].nic].socket == mySocket
+            && tciAllocTabEntry(&tciTab[iw])) {
+          return &tciTab[iw];
+        }
+      } while (iw != last_iw);
+    }
+  }
+
+  //
+  // Search forever for an entry we can use.  Give up (and kill the
+  // program) only if we discover they're all bound, because if that's
+  // true we can predict we'll never find a free one.
+  //
   do {
     int iw = last_iw;
     chpl_bool allBound = true;
@@ -5790,6 +7709,8 @@ typedef chpl_comm_nb_handle_t (rmaPutFn_t)(void* myAddr, void* mrDesc,
                                            struct perTxCtxInfo_t* tcip);
 
 static rmaPutFn_t rmaPutFn_selector;
+static chpl_bool rmaPutTiny(const void*, c_nodeid_t, uint64_t, uint64_t,
+                            size_t, struct perTxCtxInfo_t*);
 
 static inline
 chpl_comm_nb_handle_t ofi_put(const void* addr, c_nodeid_t node,
@@ -5826,20 +7747,26 @@ chpl_comm_nb_handle_t ofi_put(const void* addr, c_nodeid_t node,
   uint64_t mrKey;
   uint64_t mrRaddr;
   if (mrGetKey(&mrKey, &mrRaddr, node, raddr, size)) {
+    const uint64_t startNs = throttleBegin(node);
     struct perTxCtxInfo_t* tcip;
     CHK_TRUE((tcip = tciAlloc()) != NULL);
     if (tcip->txCntr == NULL) {
       waitForCQSpace(tcip, 1);
     }
 
-    void* mrDesc;
-    void* myAddr = mrLocalizeSource(&mrDesc, addr, size, "PUT src");
+    if (rmaPutTiny(addr, node, mrRaddr, mrKey, size, tcip)) {
+      ret = NULL;
+    } else {
+      void* mrDesc;
+      void* myAddr = mrLocalizeSource(&mrDesc, addr, size, "PUT src");
 
-    ret = rmaPutFn_selector(myAddr, mrDesc, node, mrRaddr, mrKey, size,
-                            tcip);
+      ret = rmaPutFn_selector(myAddr, mrDesc, node, mrRaddr, mrKey, size,
+                              tcip);
 
-    mrUnLocalizeSource(myAddr, addr);
+      mrUnLocalizeSource(myAddr, addr, size);
+    }
     tciFree(tcip);
+    throttleEnd(node, size, startNs);
   } else {
     amRequestRmaPut(node, (void*) addr, raddr, size);
     ret = NULL;
@@ -5901,6 +7828,47 @@ static ssize_t wrap_fi_writemsg(const void* addr, void* mrDesc,
 
 
 
+//
+// Whether a PUT from addr may be injected.  Injection copies the source
+// with the CPU, which can't read GPU memory.
+//
+static inline
+chpl_bool putInjectable(const void* addr, size_t size) {
+  return size <= ofi_info->tx_attr->inject_size
+         && envInjectRMA
+         && !mrDevGetDesc(NULL, addr, size);
+}
+
+
+//
+// Fast path for tiny PUTs.  Injection copies the source before it
+// returns and needs no memory descriptor, so if we're going to inject
+// anyway there's no point in localizing the source first, which for
+// a source outside registered memory means allocating and filling a
+// bounce buffer.  The conditions here are the ones under which the
+// message ordering rmaPutFn_*() would inject.
+//
+static inline
+chpl_bool rmaPutTiny(const void* addr, c_nodeid_t node,
+                     uint64_t mrRaddr, uint64_t mrKey, size_t size,
+                     struct perTxCtxInfo_t* tcip) {
+  if (size > tinyRmaSize
+      || !tcip->bound
+      || mcmMode == mcmm_dlvrCmplt
+      || (mcmMode == mcmm_msgOrdFence
+          && tcip->amoVisBitmap != NULL
+          && bitmapTest(tcip->amoVisBitmap, node))
+      || !putInjectable(addr, size)) {
+    return false;
+  }
+
+  chpl_comm_diags_incr(put_tiny);
+  (void) wrap_fi_inject_write(addr, node, mrRaddr, mrKey, size, tcip);
+  bitmapSet(tcip->putVisBitmap, node);
+  return true;
+}
+
+
 //
 // Implements ofi_put() when MCM mode is message ordering with fences.
 //
@@ -5911,10 +7879,9 @@ chpl_comm_nb_handle_t rmaPutFn_msgOrdFence(void* myAddr, void* mrDesc,
                                            size_t size,
                                            struct perTxCtxInfo_t* tcip) {
   if (tcip->bound
-      && size <= ofi_info->tx_attr->inject_size
+      && putInjectable(myAddr, size)
       && (tcip->amoVisBitmap == NULL
-          || !bitmapTest(tcip->amoVisBitmap, node))
-      && envInjectRMA) {
+          || !bitmapTest(tcip->amoVisBitmap, node))) {
     //
     // Special case: write injection has the least latency.  We can use
     // that if this PUT doesn't need a fence, its size doesn't exceed
@@ -5935,8 +7902,7 @@ chpl_comm_nb_handle_t rmaPutFn_msgOrdFence(void* myAddr, void* mrDesc,
       // be able to inject the PUT, though.
       //
       uint64_t flags = FI_FENCE;
-      if (size <= ofi_info->tx_attr->inject_size
-          && envInjectRMA) {
+      if (putInjectable(myAddr, size)) {
         flags |= FI_INJECT;
       }
       (void) wrap_fi_writemsg(myAddr, mrDesc, node, mrRaddr, mrKey, size,
@@ -5988,8 +7954,7 @@ chpl_comm_nb_handle_t rmaPutFn_msgOrd(void* myAddr, void* mrDesc,
   //
 
   if (tcip->bound
-      && size <= ofi_info->tx_attr->inject_size
-      && envInjectRMA) {
+      && putInjectable(myAddr, size)) {
     //
     // Special case: write injection has the least latency.  We can use
     // that if this PUT's size doesn't exceed the injection size limit
@@ -6049,7 +8014,7 @@ ssize_t wrap_fi_write(const void* addr, void* mrDesc,
              (int) node, mrRaddr, addr, size, ctx);
   OFI_RIDE_OUT_EAGAIN(tcip,
                       fi_write(tcip->txCtx, addr, size,
-                               mrDesc, rxAddr(tcip, node),
+                               mrDesc, rmaAddr(tcip, node),
                                mrRaddr, mrKey, ctx));
   tcip->numTxnsOut++;
   tcip->numTxnsSent++;
@@ -6069,7 +8034,7 @@ ssize_t wrap_fi_inject_write(const void* addr,
   // TODO: How quickly/often does local resource throttling happen?
   OFI_RIDE_OUT_EAGAIN(tcip,
                       fi_inject_write(tcip->txCtx, addr, size,
-                                      rxAddr(tcip, node),
+                                      rmaAddr(tcip, node),
                                       mrRaddr, mrKey));
   tcip->numTxnsSent++;
   return FI_SUCCESS;
@@ -6093,7 +8058,7 @@ ssize_t wrap_fi_writemsg(const void* addr, void* mrDesc,
                           { .msg_iov = &msg_iov,
                             .desc = &mrDesc,
                             .iov_count = 1,
-                            .addr = rxAddr(tcip, node),
+                            .addr = rmaAddr(tcip, node),
                             .rma_iov = &rma_iov,
                             .rma_iov_count = 1,
                             .context = ctx };
@@ -6282,12 +8247,37 @@ chpl_comm_nb_handle_t ofi_get(void* addr, c_nodeid_t node,
   uint64_t mrKey;
   uint64_t mrRaddr;
   if (mrGetKey(&mrKey, &mrRaddr, node, raddr, size)) {
+    const uint64_t startNs = throttleBegin(node);
     struct perTxCtxInfo_t* tcip;
     CHK_TRUE((tcip = tciAlloc()) != NULL);
     waitForCQSpace(tcip, 1);
 
+    //
+    // Tiny GETs into memory we can't use directly land in a per-thread
+    // scratch buffer instead of a freshly allocated bounce buffer, and
+    // skip the registration cache.  The buffer is marked busy while in
+    // use in case progressing completions leads to a nested GET.
+    //
+    static __thread void* tinyBuf;
+    static __thread chpl_bool tinyBufBusy;
+    chpl_bool useTinyBuf = false;
     void* mrDesc;
-    void* myAddr = mrLocalizeTarget(&mrDesc, addr, size, "GET tgt");
+    void* myAddr;
+
+    if (size <= tinyRmaSize
+        && !tinyBufBusy
+        && !mrDevGetDesc(NULL, addr, size)
+        && !mrGetDesc(&mrDesc, addr, size)) {
+      if (tinyBuf == NULL) {
+        tinyBuf = allocBounceBuf(tinyRmaSize);
+      }
+      CHK_TRUE(mrGetDesc(&mrDesc, tinyBuf, size));
+      myAddr = tinyBuf;
+      tinyBufBusy = useTinyBuf = true;
+      chpl_comm_diags_incr(get_tiny);
+    } else {
+      myAddr = mrLocalizeTarget(&mrDesc, addr, size, "GET tgt");
+    }
 
     atomic_bool txnDone;
     void *ctx = txCtxInit(tcip, __LINE__, &txnDone);
@@ -6296,8 +8286,14 @@ chpl_comm_nb_handle_t ofi_get(void* addr, c_nodeid_t node,
 
     waitForTxnComplete(tcip, ctx);
     txCtxCleanup(ctx);
-    mrUnLocalizeTarget(myAddr, addr, size);
+    if (useTinyBuf) {
+      memcpy(addr, myAddr, size);
+      tinyBufBusy = false;
+    } else {
+      mrUnLocalizeTarget(myAddr, addr, size);
+    }
     tciFree(tcip);
+    throttleEnd(node, size, startNs);
   } else {
     amRequestRmaGet(node, addr, raddr, size);
     ret = NULL;
@@ -6445,7 +8441,7 @@ ssize_t wrap_fi_read(void* addr, void* mrDesc,
              addr, (int) node, mrRaddr, size, ctx);
   OFI_RIDE_OUT_EAGAIN(tcip,
                       fi_read(tcip->txCtx, addr, size,
-                              mrDesc, rxAddr(tcip, node),
+                              mrDesc, rmaAddr(tcip, node),
                               mrRaddr, mrKey, ctx));
   tcip->numTxnsOut++;
   tcip->numTxnsSent++;
@@ -6470,7 +8466,7 @@ ssize_t wrap_fi_readmsg(void* addr, void* mrDesc,
                           { .msg_iov = &msg_iov,
                             .desc = &mrDesc,
                             .iov_count = 1,
-                            .addr = rxAddr(tcip, node),
+                            .addr = rmaAddr(tcip, node),
                             .rma_iov = &rma_iov,
                             .rma_iov_count = 1,
                             .context = ctx };
@@ -6531,7 +8527,7 @@ void ofi_get_V(int v_len, void** addr_v, void** local_mr_v,
                             { .msg_iov = &msg_iov,
                               .desc = &local_mr_v[vi],
                               .iov_count = 1,
-                              .addr = rxAddr(tcip, locale_v[vi]),
+                              .addr = rmaAddr(tcip, locale_v[vi]),
                               .rma_iov = &rma_iov,
                               .rma_iov_count = 1,
                               .context = txnTrkEncodeId(__LINE__),
@@ -6621,6 +8617,248 @@ void do_remote_get_buff(void* addr, c_nodeid_t node, void* raddr,
 /*** END OF BUFFERED GET OPERATIONS ***/
 
 
+/*
+ *** START OF VECTORED STRIDED OPERATIONS ***
+ *
+ * Support for doing strided PUTs and GETs directly, with each network
+ * transaction moving as many of the contiguous chunks as the provider
+ * allows in its local and remote iovecs.
+ */
+
+#define MAX_STRD_IOV_LEN 32
+
+//
+// Do a strided PUT or GET using vectored RMA.  Returns false, having
+// done nothing, if the transfer can't be done this way because either
+// the local or the remote extent isn't registered.  In that case the
+// caller should use the generic strided code, which will bounce the
+// local side through registered memory as needed.
+//
+static
+chpl_bool ofi_strd_iov(chpl_bool isPut, void* dstaddr, size_t* dststrides,
+                       c_nodeid_t node, void* srcaddr, size_t* srcstrides,
+                       size_t* count, int32_t stridelevels, size_t elemSize) {
+  const int strlvls = (int) stridelevels;
+  const size_t chunkSize = count[0] * elemSize;
+
+  if (!envStrdIov
+      || strlvls < 1
+      || node == chpl_nodeID
+      || chunkSize == 0
+      || chunkSize > ofi_info->ep_attr->max_msg_size) {
+    return false;
+  }
+
+  //
+  // Find the overall extent on each side.  Everything is linear within
+  // a memory region, so if the whole local extent has a descriptor and
+  // the whole remote extent has a key, so do all the chunks.
+  //
+  size_t dstStr[strlvls];
+  size_t srcStr[strlvls];
+  size_t dstExtent = chunkSize;
+  size_t srcExtent = chunkSize;
+  size_t numChunks = 1;
+  for (int i = 0; i < strlvls; i++) {
+    if (count[i + 1] == 0) {
+      return true;
+    }
+    dstStr[i] = dststrides[i] * elemSize;
+    srcStr[i] = srcstrides[i] * elemSize;
+    dstExtent += (count[i + 1] - 1) * dstStr[i];
+    srcExtent += (count[i + 1] - 1) * srcStr[i];
+    numChunks *= count[i + 1];
+  }
+
+  void* locAddr = isPut ? srcaddr : dstaddr;
+  size_t locExtent = isPut ? srcExtent : dstExtent;
+  void* remAddr = isPut ? dstaddr : srcaddr;
+  size_t remExtent = isPut ? dstExtent : srcExtent;
+
+  void* mrDesc;
+  uint64_t mrKey;
+  uint64_t mrRaddr;
+  if (!(mrDevGetDesc(&mrDesc, locAddr, locExtent)
+        || mrGetDesc(&mrDesc, locAddr, locExtent))
+      || !mrGetKey(&mrKey, &mrRaddr, node, remAddr, remExtent)) {
+    return false;
+  }
+
+  DBG_PRINTF(DBG_RMA | (isPut ? DBG_RMA_WRITE : DBG_RMA_READ),
+             "strided %s %s %d:%p, %zd chunks of %zd",
+             isPut ? "PUT" : "GET", isPut ? "to" : "from",
+             (int) node, remAddr, numChunks, chunkSize);
+
+  struct perTxCtxInfo_t* tcip;
+  CHK_TRUE((tcip = tciAlloc()) != NULL);
+
+  //
+  // In the message ordering MCM modes, pending PUTs and AMOs to this
+  // node must be ordered before what we do here.
+  //
+  //
+  // In delivery-complete mode, a PUT isn't done until its effects are
+  // visible.  The *msg() calls don't use the default op_flags, so we
+  // have to ask for that explicitly.
+  //
+  const uint64_t allFlags = (isPut && mcmMode == mcmm_dlvrCmplt)
+                            ? FI_DELIVERY_COMPLETE
+                            : 0;
+  uint64_t firstFlags = 0;
+  if (mcmMode != mcmm_dlvrCmplt && tcip->bound) {
+    chpl_bool havePutsOut = tcip->putVisBitmap != NULL
+                            && bitmapTest(tcip->putVisBitmap, node);
+    chpl_bool haveAmosOut = tcip->amoVisBitmap != NULL
+                            && bitmapTest(tcip->amoVisBitmap, node);
+    if (mcmMode == mcmm_msgOrdFence
+        && (haveAmosOut || (havePutsOut && !isPut))) {
+      firstFlags = FI_FENCE;
+    }
+    if (!isPut) {
+      if (havePutsOut) {
+        bitmapClear(tcip->putVisBitmap, node);
+      }
+      if (haveAmosOut) {
+        bitmapClear(tcip->amoVisBitmap, node);
+      }
+    }
+  }
+
+  size_t maxIov = ofi_info->tx_attr->iov_limit;
+  if (maxIov > ofi_info->tx_attr->rma_iov_limit) {
+    maxIov = ofi_info->tx_attr->rma_iov_limit;
+  }
+  if (maxIov > MAX_STRD_IOV_LEN) {
+    maxIov = MAX_STRD_IOV_LEN;
+  } else if (maxIov < 1) {
+    maxIov = 1;
+  }
+
+  struct iovec msg_iov[MAX_STRD_IOV_LEN];
+  struct fi_rma_iov rma_iov[MAX_STRD_IOV_LEN];
+  void* descs[MAX_STRD_IOV_LEN];
+  size_t iovCnt = 0;
+  size_t msgSize = 0;
+
+  //
+  // Walk the chunks in odometer order, merging any that happen to be
+  // contiguous on both sides, and send off a message whenever an iovec
+  // fills up.
+  //
+  size_t idx[strlvls];
+  memset(idx, 0, sizeof(idx));
+  size_t dstOff = 0;
+  size_t srcOff = 0;
+
+  for (size_t ci = 0; ci < numChunks; ci++) {
+    char* locChunk = (char*) locAddr + (isPut ? srcOff : dstOff);
+    uint64_t remChunk = mrRaddr + (isPut ? dstOff : srcOff);
+
+    if (iovCnt > 0
+        && (char*) msg_iov[iovCnt - 1].iov_base
+           + msg_iov[iovCnt - 1].iov_len == locChunk
+        && rma_iov[iovCnt - 1].addr + rma_iov[iovCnt - 1].len == remChunk
+        && msgSize + chunkSize <= ofi_info->ep_attr->max_msg_size) {
+      msg_iov[iovCnt - 1].iov_len += chunkSize;
+      rma_iov[iovCnt - 1].len += chunkSize;
+    } else {
+      if (iovCnt == maxIov
+          || msgSize + chunkSize > ofi_info->ep_attr->max_msg_size) {
+        ofi_strd_iov_msg(isPut, node, msg_iov, descs, rma_iov, iovCnt,
+                         msgSize, allFlags | firstFlags, tcip);
+        firstFlags = 0;
+        iovCnt = 0;
+        msgSize = 0;
+      }
+      msg_iov[iovCnt] = (struct iovec) { .iov_base = locChunk,
+                                         .iov_len = chunkSize, };
+      rma_iov[iovCnt] = (struct fi_rma_iov) { .addr = remChunk,
+                                              .len = chunkSize,
+                                              .key = mrKey, };
+      descs[iovCnt] = mrDesc;
+      iovCnt++;
+    }
+    msgSize += chunkSize;
+
+    for (int l = 0; l < strlvls; l++) {
+      if (++idx[l] < count[l + 1]) {
+        dstOff += dstStr[l];
+        srcOff += srcStr[l];
+        break;
+      }
+      dstOff -= (count[l + 1] - 1) * dstStr[l];
+      srcOff -= (count[l + 1] - 1) * srcStr[l];
+      idx[l] = 0;
+    }
+  }
+
+  ofi_strd_iov_msg(isPut, node, msg_iov, descs, rma_iov, iovCnt, msgSize,
+                   allFlags | firstFlags, tcip);
+
+  //
+  // Wait for everything to complete, so that the source is reusable
+  // (PUT) or the target is filled (GET).  Then for a PUT, arrange to
+  // force its memory effects to be visible, as for ofi_put().
+  //
+  while (tcip->numTxnsOut > 0) {
+    (*tcip->ensureProgressFn)(tcip);
+  }
+
+  if (isPut && mcmMode != mcmm_dlvrCmplt) {
+    if (tcip->bound) {
+      bitmapSet(tcip->putVisBitmap, node);
+    } else {
+      mcmReleaseOneNode(node, tcip, "strided PUT");
+    }
+  }
+
+  tciFree(tcip);
+  return true;
+}
+
+
+//
+// Initiate one message of a vectored strided PUT or GET.
+//
+static
+void ofi_strd_iov_msg(chpl_bool isPut, c_nodeid_t node,
+                      struct iovec* msg_iov, void** descs,
+                      struct fi_rma_iov* rma_iov, size_t iovCnt,
+                      size_t size, uint64_t flags,
+                      struct perTxCtxInfo_t* tcip) {
+  if (tcip->txCntr == NULL) {
+    waitForCQSpace(tcip, 1);
+  }
+
+  struct fi_msg_rma msg = (struct fi_msg_rma)
+                          { .msg_iov = msg_iov,
+                            .desc = descs,
+                            .iov_count = iovCnt,
+                            .addr = rmaAddr(tcip, node),
+                            .rma_iov = rma_iov,
+                            .rma_iov_count = iovCnt,
+                            .context = txnTrkEncodeId(__LINE__), };
+  if (isPut) {
+    DBG_PRINTF(DBG_RMA | DBG_RMA_WRITE,
+               "tx write msg: %d:%#" PRIx64 " <= %p, %zd iovs, size %zd, "
+               "flags %#" PRIx64,
+               (int) node, rma_iov[0].addr, msg_iov[0].iov_base, iovCnt,
+               size, flags);
+    OFI_RIDE_OUT_EAGAIN(tcip, fi_writemsg(tcip->txCtx, &msg, flags));
+  } else {
+    DBG_PRINTF(DBG_RMA | DBG_RMA_READ,
+               "tx read msg: %p <= %d:%#" PRIx64 ", %zd iovs, size %zd, "
+               "flags %#" PRIx64,
+               msg_iov[0].iov_base, (int) node, rma_iov[0].addr, iovCnt,
+               size, flags);
+    OFI_RIDE_OUT_EAGAIN(tcip, fi_readmsg(tcip->txCtx, &msg, flags));
+  }
+  tcip->numTxnsOut++;
+  tcip->numTxnsSent++;
+}
+/*** END OF VECTORED STRIDED OPERATIONS ***/
+
+
 struct amoBundle_t {
   struct fi_msg_atomic m;
   struct fi_ioc iovOpnd;
@@ -6699,8 +8937,8 @@ chpl_comm_nb_handle_t ofi_amo(c_nodeid_t node, uint64_t object, uint64_t mrKey,
   tciFree(tcip);
 
   mrUnLocalizeTarget(myRes, result, size);
-  mrUnLocalizeSource(myCmpr, cmpr);
-  mrUnLocalizeSource(myOpnd, opnd);
+  mrUnLocalizeSource(myCmpr, cmpr, size);
+  mrUnLocalizeSource(myOpnd, opnd, size);
 
   return ret;
 }
@@ -7132,16 +9370,14 @@ void amCheckRxTxCmpls(chpl_bool* pHadRxEvent, chpl_bool* pHadTxEvent,
 
 static
 void checkTxCmplsCQ(struct perTxCtxInfo_t* tcip) {
-  struct fi_cq_msg_entry cqes[txCQLen];
+  struct fi_cq_entry cqes[txCQLen];
   const size_t cqesSize = sizeof(cqes) / sizeof(cqes[0]);
   const size_t numEvents = readCQ(tcip->txCQ, cqes, cqesSize);
 
   tcip->numTxnsOut -= numEvents;
   for (int i = 0; i < numEvents; i++) {
-    struct fi_cq_msg_entry* cqe = &cqes[i];
-    const txnTrkCtx_t trk = txnTrkDecode(cqe->op_context);
-    DBG_PRINTF(DBG_ACK, "CQ ack tx, flags %#" PRIx64 ", ctx %d:%p",
-               cqe->flags, trk.typ, trk.ptr);
+    const txnTrkCtx_t trk = txnTrkDecode(cqes[i].op_context);
+    DBG_PRINTF(DBG_ACK, "CQ ack tx, ctx %d:%p", trk.typ, trk.ptr);
     if (trk.typ == txnTrkDone) {
       atomic_store_explicit_bool((atomic_bool*) trk.ptr, true,
                                  memory_order_release);
@@ -7307,15 +9543,18 @@ void forceMemFxVisAllNodes_noTcip(chpl_bool checkPuts, chpl_bool checkAmos) {
 
 static
 void* allocBounceBuf(size_t size) {
-  void* p;
-  CHPL_CALLOC_SZ(p, 1, size);
-  return p;
+  //
+  // Bounce buffers are small and short-lived, so they come from the
+  // per-thread arenas.  They're freed by freeBounceBuf(), possibly on
+  // another thread, and (for executeOn payloads) by am_opFree AMs.
+  //
+  return chpl_mem_arena_allocZero(size, CHPL_RT_MD_COMM_UTIL, 0, 0);
 }
 
 
 static
 void freeBounceBuf(void* p) {
-  CHPL_FREE(p);
+  chpl_mem_arena_free(p, 0, 0);
 }
 
 
@@ -7499,6 +9738,14 @@ DEFN_CHPL_COMM_ATOMIC_CMPXCHG(real64, FI_DOUBLE, _real64)
     chpl_comm_diags_incr(amo);                                          \
     doAMO(node, object, opnd, NULL, result,                             \
           ofiOp, ofiType, sizeof(Type));                                \
+  }                                                                     \
+                                                                        \
+  chpl_comm_nb_handle_t chpl_comm_atomic_fetch_##fnOp##_nb_##fnType     \
+         (void* opnd, c_nodeid_t node, void* object, void* result,      \
+          memory_order order, int ln, int32_t fn) {                     \
+    chpl_comm_atomic_fetch_##fnOp##_##fnType(opnd, node, object,        \
+                                             result, order, ln, fn);    \
+    return NULL;                                                        \
   }
 
 DEFN_IFACE_AMO_SIMPLE_OP(and, FI_BAND, int32, FI_INT32, int32_t)
@@ -7565,6 +9812,14 @@ DEFN_IFACE_AMO_SIMPLE_OP(add, FI_SUM, real64, FI_DOUBLE, _real64)
     chpl_comm_diags_incr(amo);                                          \
     doAMO(node, object, &myOpnd, NULL, result,                          \
           FI_SUM, ofiType, sizeof(Type));                               \
+  }                                                                     \
+                                                                        \
+  chpl_comm_nb_handle_t chpl_comm_atomic_fetch_sub_nb_##fnType          \
+         (void* opnd, c_nodeid_t node, void* object, void* result,      \
+          memory_order order, int ln, int32_t fn) {                     \
+    chpl_comm_atomic_fetch_sub_##fnType(opnd, node, object,             \
+                                        result, order, ln, fn);         \
+    return NULL;                                                        \
   }
 
 #define NEGATE_I32(x) ((x) == INT32_MIN ? (x) : -(x))
@@ -7581,7 +9836,7 @@ DEFN_IFACE_AMO_SUB(real64, FI_DOUBLE, _real64, NEGATE_U_OR_R)
 void chpl_comm_atomic_unordered_task_fence(void) {
   DBG_PRINTF(DBG_IFACE_MCM, "%s()", __func__);
 
-  task_local_buff_flush(amo_nf_buff);
+  task_local_buff_flush(amo_nf_buff | amo_am_buff);
 }
 
 
@@ -7686,7 +9941,7 @@ void doAMO(c_nodeid_t node, void* object,
       if (ofiOp != FI_ATOMIC_READ) {
         forceMemFxVisAllNodes_noTcip(true /*checkPuts*/, true /*checkAmos*/);
       }
-      doCpuAMO(object, opnd, cmpr, result, ofiOp, ofiType, size);
+      doTargetAMO(object, opnd, cmpr, result, ofiOp, ofiType, size);
     } else {
       amRequestAMO(node, object, opnd, cmpr, result,
                    ofiOp, ofiType, size);
@@ -7702,6 +9957,56 @@ void doAMO(c_nodeid_t node, void* object,
 }
 
 
+//
+// Do an AMO on an object on this node that the initiator couldn't reach
+// over the network.  Usually that's a CPU AMO, but with GPU memory the
+// CPU can't access the object may be on a device.  Remote nodes don't
+// know the keys for device registrations, so they send us those AMOs
+// and if the provider can do atomics on the device memory we do it as
+// a network AMO to ourselves.  Otherwise we copy the object to the
+// host, do it there and copy it back.  All such copy-based AMOs are
+// serialized, so they are atomic with respect to each other, but not
+// with respect to kernels running at the same time.
+//
+#ifdef HAS_GPU_LOCALE
+static pthread_mutex_t devAmoLock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+static
+void doTargetAMO(void* obj,
+                 const void* opnd, const void* cmpr, void* result,
+                 enum fi_op ofiOp, enum fi_datatype ofiType, size_t size) {
+#ifdef HAS_GPU_LOCALE
+  chpl_bool registered;
+  c_sublocid_t dev = chpl_gpu_comm_amo_device(obj, &registered);
+  if (dev >= 0) {
+    uint64_t mrKey;
+    uint64_t mrRaddr;
+    if (registered && isAtomicValid(ofiType)
+        && mrDevGetKey(&mrKey, &mrRaddr, obj, size)) {
+      DBG_PRINTF(DBG_AMO, "AMO on device %d memory %p via network",
+                 (int) dev, obj);
+      ofi_amo(chpl_nodeID, mrRaddr, mrKey, opnd, cmpr, result,
+              ofiOp, ofiType, size);
+    } else {
+      DBG_PRINTF(DBG_AMO, "AMO on device %d memory %p via host copy",
+                 (int) dev, obj);
+      chpl_amo_datum_t tmp;
+      PTHREAD_CHK(pthread_mutex_lock(&devAmoLock));
+      chpl_gpu_comm_amo_get(&tmp, dev, obj, size);
+      doCpuAMO(&tmp, opnd, cmpr, result, ofiOp, ofiType, size);
+      if (ofiOp != FI_ATOMIC_READ) {
+        chpl_gpu_comm_amo_put(dev, obj, &tmp, size);
+      }
+      PTHREAD_CHK(pthread_mutex_unlock(&devAmoLock));
+    }
+    return;
+  }
+#endif
+  doCpuAMO(obj, opnd, cmpr, result, ofiOp, ofiType, size);
+}
+
+
 static inline
 void doCpuAMO(void* obj,
               const void* opnd, const void* cmpr, void* result,
@@ -7874,7 +10179,8 @@ void doCpuAMO(void* obj,
  *
  * Support for non-fetching buffered atomic operations. We internally buffer
  * atomic operations and then initiate them all at once for increased
- * transaction rate.
+ * transaction rate.  AMOs the network can't do are buffered too, and sent
+ * to each target node in one AM that does the whole batch there.
  */
 
 // Flush buffered AMOs for the specified task info and reset the counter.
@@ -7892,12 +10198,126 @@ void amo_nf_buff_task_info_flush(amo_nf_buff_task_info_t* info) {
 }
 
 
+// Send the buffered AM-based AMOs for the specified task info, one AM
+// per batch of AMOs to the same node, and wait for all of them to be
+// done on their targets.
+static inline
+void amo_am_buff_task_info_flush(amo_am_buff_task_info_t* info) {
+  if (info->vi <= 0) {
+    return;
+  }
+
+  DBG_PRINTF(DBG_AMO_UNORD,
+             "amo_am_buff_task_info_flush(): info has %d entries",
+             info->vi);
+
+  //
+  // We need a 'done' flag per AM we send.  There can't be more AMs than
+  // buffered AMOs, and localizing all the flags at once is cheaper than
+  // doing it per AM.
+  //
+  amDone_t* pAmDone_v = mrLocalizeTargetRemote(info->done_v,
+                                               info->vi * sizeof(amDone_t),
+                                               "AMO batch done indicators");
+  for (int i = 0; i < info->vi; i++) {
+    info->sent_v[i] = false;
+  }
+
+  int numReqs = 0;
+  for (int i = 0; i < info->vi; i++) {
+    if (info->sent_v[i]) {
+      continue;
+    }
+
+    //
+    // Gather this and later AMOs to the same node into a batch.  If
+    // there are more than fit, the rest go in a later batch.
+    //
+    c_nodeid_t node = info->locale_v[i];
+    amRequest_t req = { .amoBatch = { .b = { .op = am_opAMOBatch,
+                                             .node = chpl_nodeID,
+                                             .pAmDone =
+                                               &pAmDone_v[numReqs], }, }, };
+    int count = 0;
+    for (int j = i; j < info->vi && count < AM_MAX_AMO_BATCH_LEN; j++) {
+      if (!info->sent_v[j] && info->locale_v[j] == node) {
+        req.amoBatch.ops[count].obj = info->object_v[j];
+        memcpy(&req.amoBatch.ops[count].opnd, &info->opnd_v[j],
+               info->size_v[j]);
+        req.amoBatch.ops[count].ofiOp = info->cmd_v[j];
+        req.amoBatch.ops[count].ofiType = info->type_v[j];
+        req.amoBatch.ops[count].size = info->size_v[j];
+        info->sent_v[j] = true;
+        count++;
+      }
+    }
+    req.amoBatch.count = count;
+
+    pAmDone_v[numReqs] = 0;
+    chpl_atomic_thread_fence(memory_order_release);
+    amRequestCommon(node, &req, amo_batch_reqSize(count),
+                    false /*blocking*/, NULL);
+    numReqs++;
+  }
+
+  for (int i = 0; i < numReqs; i++) {
+    amWaitForDone(&pAmDone_v[i]);
+  }
+  // don't want target copyout
+  mrUnLocalizeSourceRemote(pAmDone_v, info->done_v);
+
+  info->vi = 0;
+}
+
+
+//
+// Buffer a non-fetching AMO that has to be done on the target node's
+// CPU by AM.  Rather than sending one AM per AMO we send one message
+// for a whole batch of them to the same node when the buffer is
+// flushed.
+//
+static inline
+void do_remote_amo_am_buff(void* opnd, c_nodeid_t node,
+                           void* object, size_t size,
+                           enum fi_op ofiOp, enum fi_datatype ofiType) {
+  amo_am_buff_task_info_t* info = NULL;
+  if (envAggregateAmAMO) {
+    info = task_local_buff_acquire(amo_am_buff);
+  }
+  if (info == NULL) {
+    amRequestAMO(node, object, opnd, NULL, NULL, ofiOp, ofiType, size);
+    return;
+  }
+
+  int vi = info->vi;
+  info->opnd_v[vi]   = 0;
+  memcpy(&info->opnd_v[vi], opnd, size);
+  info->locale_v[vi] = node;
+  info->object_v[vi] = object;
+  info->size_v[vi]   = size;
+  info->cmd_v[vi]    = ofiOp;
+  info->type_v[vi]   = ofiType;
+  info->vi++;
+
+  DBG_PRINTF(DBG_AMO_UNORD,
+             "do_remote_amo_am_buff(): info[%d] = {%d, %p, %zd, %d, %d}",
+             vi, (int) node, object, size, (int) ofiOp, (int) ofiType);
+
+  // flush if buffers are full
+  if (info->vi == MAX_BUFFERED_AMO_AM_LEN) {
+    amo_am_buff_task_info_flush(info);
+  }
+}
+
+
 static inline
 void do_remote_amo_nf_buff(void* opnd, c_nodeid_t node,
                            void* object, size_t size,
                            enum fi_op ofiOp, enum fi_datatype ofiType) {
   //
-  // "Unordered" is possible only for actual network atomic ops.
+  // "Unordered" network atomic ops are chained at flush time.  Those we
+  // have to do by AM are buffered separately and sent in per-node
+  // batches.
   //
   if (chpl_numNodes <= 1) {
     doCpuAMO(object, opnd, NULL, NULL, ofiOp, ofiType, size);
@@ -7913,8 +10333,7 @@ void do_remote_amo_nf_buff(void* opnd, c_nodeid_t node,
     if (node == chpl_nodeID) {
       doCpuAMO(object, opnd, NULL, NULL, ofiOp, ofiType, size);
     } else {
-      amRequestAMO(node, object, opnd, NULL, NULL,
-                   ofiOp, ofiType, size);
+      do_remote_amo_am_buff(opnd, node, object, size, ofiOp, ofiType);
     }
     return;
   }
@@ -8041,61 +10460,51 @@ void init_bar(void) {
 }
 
 
-void chpl_comm_impl_barrier(const char *msg) {
-  DBG_PRINTF(DBG_IFACE_SETUP, "%s('%s')", __func__, msg);
-
-  DBG_PRINTF(DBG_BARRIER, "barrier '%s'", (msg == NULL) ? "" : msg);
-
-  if (pthread_equal(pthread_self(), pthread_that_inited)
-      || numAmHandlersActive == 0) {
-    //
-    // Either this is the main (chpl_comm_init()ing) thread or
-    // comm layer setup is not complete yet.  Use OOB barrier.
-    //
-    chpl_comm_ofi_oob_barrier();
-    DBG_PRINTF(DBG_BARRIER, "barrier '%s' done via out-of-band",
-               (msg == NULL) ? "" : msg);
-    return;
-  }
+//
+// The barrier also comes in split-phase form: begin, then test until
+// done.  bar_progress() does as much as it can without waiting and says
+// whether the barrier is done.
+//
+static chpl_bool bar_inProgress;
+static const char* bar_msg;
+static c_nodeid_t bar_numChildrenSeen;
+static chpl_bool bar_notifiedParent;
 
-  //
-  // Ensure our outstanding nonfetching AMOs and PUTs are visible.
-  // (Visibility of operations done by other tasks on this node is
-  // the caller's responsibility.)
-  //
-  retireDelayedAmDone(false /*taskIsEnding*/);
-  forceMemFxVisAllNodes_noTcip(true /*checkPuts*/, true /*checkAmos*/);
 
+static
+chpl_bool bar_progress(void) {
   //
   // Wait for our child locales to notify us that they have reached the
   // barrier.
   //
-  DBG_PRINTF(DBG_BARRIER, "BAR wait for %d children", (int) bar_numChildren);
-  for (uint32_t i = 0; i < bar_numChildren; i++) {
-    while (bar_info.child_notify[i] == 0) {
-      local_yield();
+  while (bar_numChildrenSeen < bar_numChildren) {
+    if (bar_info.child_notify[bar_numChildrenSeen] == 0) {
+      return false;
     }
+    bar_numChildrenSeen++;
   }
 
   const int one = 1;
 
   if (chpl_nodeID != 0) {
-    //
-    // Notify our parent locale that we have reached the barrier.
-    //
-    c_nodeid_t parChild = (chpl_nodeID - 1) % BAR_TREE_NUM_CHILDREN;
+    if (!bar_notifiedParent) {
+      //
+      // Notify our parent locale that we have reached the barrier.
+      //
+      c_nodeid_t parChild = (chpl_nodeID - 1) % BAR_TREE_NUM_CHILDREN;
 
-    DBG_PRINTF(DBG_BARRIER, "BAR notify parent %d", (int) bar_parent);
-    ofi_put(&one, bar_parent,
-            (void*) &bar_infoMap[bar_parent]->child_notify[parChild],
-            sizeof(one));
+      DBG_PRINTF(DBG_BARRIER, "BAR notify parent %d", (int) bar_parent);
+      ofi_put(&one, bar_parent,
+              (void*) &bar_infoMap[bar_parent]->child_notify[parChild],
+              sizeof(one));
+      bar_notifiedParent = true;
+    }
 
     //
     // Wait for our parent locale to release us from the barrier.
     //
-    DBG_PRINTF(DBG_BARRIER, "BAR wait for parental release");
-    while (bar_info.parent_release == 0) {
-      local_yield();
+    if (bar_info.parent_release == 0) {
+      return false;
     }
   }
 
@@ -8120,7 +10529,72 @@ void chpl_comm_impl_barrier(const char *msg) {
   }
 
   DBG_PRINTF(DBG_BARRIER, "barrier '%s' done via PUTs",
-             (msg == NULL) ? "" : msg);
+             (bar_msg == NULL) ? "" : bar_msg);
+  bar_inProgress = false;
+  return true;
+}
+
+
+void chpl_comm_impl_barrier_begin(const char *msg) {
+  DBG_PRINTF(DBG_IFACE_SETUP, "%s('%s')", __func__, msg);
+
+  DBG_PRINTF(DBG_BARRIER, "barrier '%s'", (msg == NULL) ? "" : msg);
+
+  if (bar_inProgress) {
+    INTERNAL_ERROR_V("barrier '%s' begun while barrier '%s' in progress",
+                     (msg == NULL) ? "" : msg,
+                     (bar_msg == NULL) ? "" : bar_msg);
+  }
+
+  //
+  // Ensure our outstanding nonfetching AMOs and PUTs are visible.
+  // (Visibility of operations done by other tasks on this node is
+  // the caller's responsibility.)
+  //
+  retireDelayedAmDone(false /*taskIsEnding*/);
+  forceMemFxVisAllNodes_noTcip(true /*checkPuts*/, true /*checkAmos*/);
+
+  bar_msg = msg;
+  bar_numChildrenSeen = 0;
+  bar_notifiedParent = false;
+  bar_inProgress = true;
+  DBG_PRINTF(DBG_BARRIER, "BAR wait for %d children", (int) bar_numChildren);
+  (void) bar_progress();
+}
+
+
+chpl_bool chpl_comm_impl_barrier_test(void) {
+  return !bar_inProgress || bar_progress();
+}
+
+
+void chpl_comm_impl_barrier_wait(void) {
+  DBG_PRINTF(DBG_IFACE_SETUP, "%s()", __func__);
+
+  while (!chpl_comm_impl_barrier_test()) {
+    local_yield();
+  }
+}
+
+
+void chpl_comm_impl_barrier(const char *msg) {
+  DBG_PRINTF(DBG_IFACE_SETUP, "%s('%s')", __func__, msg);
+
+  if (pthread_equal(pthread_self(), pthread_that_inited)
+      || numAmHandlersActive == 0) {
+    //
+    // Either this is the main (chpl_comm_init()ing) thread or
+    // comm layer setup is not complete yet.  Use OOB barrier.
+    //
+    DBG_PRINTF(DBG_BARRIER, "barrier '%s'", (msg == NULL) ? "" : msg);
+    chpl_comm_ofi_oob_barrier();
+    DBG_PRINTF(DBG_BARRIER, "barrier '%s' done via out-of-band",
+               (msg == NULL) ? "" : msg);
+    return;
+  }
+
+  chpl_comm_impl_barrier_begin(msg);
+  chpl_comm_impl_barrier_wait();
 }
 
 
@@ -8139,9 +10613,7 @@ void time_init(void) {
 
 
 double chpl_comm_ofi_time_get(void) {
-  struct timespec _ts;
-  (void) clock_gettime(CLOCK_MONOTONIC, &_ts);
-  return ((double) _ts.tv_sec + (double) _ts.tv_nsec * 1e-9) - timeBase;
+  return chpl_fast_timer_secs() - timeBase;
 }
 
 
@@ -8385,11 +10857,14 @@ const char* am_opName(amOp_t op) {
   switch (op) {
   case am_opExecOn: return "opExecOn";
   case am_opExecOnLrg: return "opExecOnLrg";
+  case am_opExecOnBatch: return "opExecOnBatch";
   case am_opGet: return "opGet";
   case am_opPut: return "opPut";
   case am_opAMO: return "opAMO";
+  case am_opAMOBatch: return "opAMOBatch";
   case am_opFAMOResult: return "opFAMOResult";
   case am_opFree: return "opFree";
+  case am_opFreeBatch: return "opFreeBatch";
   case am_opNop: return "opNop";
   case am_opShutdown: return "opShutdown";
   default: return "op???";
@@ -8520,6 +10995,15 @@ const char* am_reqStr(c_nodeid_t tgtNode, amRequest_t* req, size_t reqSize) {
     }
     break;
 
+  case am_opAMOBatch:
+    len += snprintf(buf + len, sizeof(buf) - len,
+                    ", count %d, obj[0] %p, ofiOp[0] %s, ofiType[0] %s",
+                    (int) req->amoBatch.count, req->amoBatch.ops[0].obj,
+                    amo_opName((enum fi_op) req->amoBatch.ops[0].ofiOp),
+                    amo_typeName((enum fi_datatype)
+                                 req->amoBatch.ops[0].ofiType));
+    break;
+
   case am_opFAMOResult:
     len += snprintf(buf + len, sizeof(buf) - len,
                     ", res %p, result %s"
@@ -8535,6 +11019,11 @@ const char* am_reqStr(c_nodeid_t tgtNode, amRequest_t* req, size_t reqSize) {
                     req->free.p);
     break;
 
+  case am_opFreeBatch:
+    len += snprintf(buf + len, sizeof(buf) - len, ", count %d, p[0] %p",
+                    (int) req->freeBatch.count, req->freeBatch.p[0]);
+    break;
+
   default:
     break;
   }
@@ -148,12 +148,12 @@ static atomic_uint_least32_t next_thread_idx;
 #define DBG_P_LP(flg, f, ...)                                           \
         _DBG_P(_DBG_DO(flg),                                            \
                " (%d/%s/%d): " f,                                       \
-               chpl_nodeID, task_id(cd != NULL && cd->firmly_bound),    \
+               chpl_nodeID, task_id(IS_POLLING_CD(cd)),                 \
                (int) thread_idx, ## __VA_ARGS__)
 #define DBG_P_LPS(flg, f, li, cdi, rbi, seq, ...)                       \
         _DBG_P(_DBG_DO(flg),                                            \
                " (%d/%s/%d) %d/%d/%d <%" PRIu64 ">: " f,                \
-               chpl_nodeID, task_id(cd != NULL && cd->firmly_bound),    \
+               chpl_nodeID, task_id(IS_POLLING_CD(cd)),                 \
                (int) thread_idx,                                        \
                (int) li, cdi, rbi, seq, ## __VA_ARGS__)
 
@@ -529,6 +529,9 @@ static size_t hugepage_size;
 // Yield during comm
 static chpl_bool yield_during_comm;
 
+// Give each worker thread its own comm domain for its lifetime
+static chpl_bool per_thread_cds;
+
 //
 // Memory region support.
 //
@@ -698,6 +701,9 @@ mpool_idx_base_t mpool_idx_finc(mpool_idx_t* pvar) {
 // firmly_bound:  Set to "true" if the communication domain is
 //                permanently owned by a particular task/thread, as
 //                for example the polling thread.
+// per_thread:    Set to "true" if the communication domain is firmly
+//                bound to a worker thread (see per_thread_cds), and
+//                so is shared by all the tasks that thread runs.
 // nih:           NIC handle.
 // remote_eps:    Remote endpoints.
 // cqh:           Completion queue handle.
@@ -740,6 +746,7 @@ typedef struct {
   atomic_spinlock_t  busy CACHE_LINE_ALIGN;
   cq_cnt_atomic_t    cq_cnt_curr CACHE_LINE_ALIGN;
   chpl_bool          firmly_bound;
+  chpl_bool          per_thread;
   gni_nic_handle_t   nih;
   gni_ep_handle_t*   remote_eps;
   gni_cq_handle_t    cqh;
@@ -767,6 +774,18 @@ static __thread int comm_dom_free_idx = -1;
 static __thread comm_dom_t* cd = NULL;
 static __thread int cd_idx = -1;
 
+//
+// With per_thread_cds, the number of comm domains bound to threads so
+// far, and the most we'll bind.  The rest stay in the shared pool for
+// threads that come along after we run out.
+//
+static atomic_uint_least32_t per_thread_cd_cnt;
+static uint32_t per_thread_cd_max;
+static __thread chpl_bool cd_bind_tried = false;
+
+#define IS_POLLING_CD(cd)     ((cd) != NULL && (cd)->firmly_bound \
+                               && !(cd)->per_thread)
+
 #define INIT_CD_BUSY(cd)      atomic_init_spinlock_t(&(cd)->busy)
 #define ACQUIRE_CD_MAYBE(cd)  atomic_try_lock_spinlock_t(&(cd)->busy)
 #define RELEASE_CD(cd)        atomic_unlock_spinlock_t(&(cd)->busy)
@@ -1434,6 +1453,10 @@ static void      do_nic_get(void*, c_nodeid_t, mem_region_t*,
 static int       amo_cmd_2_nic_op(fork_amo_cmd_t, int);
 static void      do_nic_amo(void*, void*, c_nodeid_t, void*, size_t,
                             gni_fma_cmd_type_t, void*, mem_region_t*);
+static chpl_comm_nb_handle_t do_nic_amo_nb(void*, c_nodeid_t, void*, size_t,
+                                           gni_fma_cmd_type_t, void*,
+                                           mem_region_t*);
+static chpl_bool nb_amo_retire(chpl_comm_nb_handle_t);
 static void      do_nic_amo_nf(void*, c_nodeid_t, void*, size_t,
                                gni_fma_cmd_type_t, mem_region_t*);
 static void      do_nic_amo_nf_buff(void*, c_nodeid_t, void*, size_t,
@@ -1452,6 +1475,7 @@ static void      fork_shutdown(c_nodeid_t, chpl_bool);
 static void      do_fork_post(c_nodeid_t, chpl_bool,
                               uint64_t, fork_base_info_t*, int*, int*);
 static void      acquire_comm_dom(void);
+static void      acquire_comm_dom_for_post(void);
 static void      acquire_comm_dom_and_req_buf(c_nodeid_t, int*);
 static void      release_comm_dom(void);
 static chpl_bool reacquire_comm_dom(int);
@@ -1895,6 +1919,13 @@ void chpl_comm_init(int *argc_p, char ***argv_p) {
   yield_during_comm = chpl_env_rt_get_bool("COMM_UGNI_YIELD_DURING_COMM",
                                            true);
 
+  //
+  // Optionally bind a comm domain to each thread that communicates, for
+  // as long as the thread lives, instead of having tasks acquire one from
+  // the shared pool for each transaction.
+  //
+  per_thread_cds = chpl_env_rt_get_bool("COMM_UGNI_PER_THREAD_CDS", false);
+
   //
   // We can reach 16k memory regions on Aries.
   max_mem_regions = chpl_env_rt_get_int("COMM_UGNI_MAX_MEM_REGIONS", 16384);
@@ -1960,6 +1991,14 @@ void chpl_comm_impl_task_end(void) {
   task_local_buff_end(get_buff | put_buff | amo_nf_buff);
 }
 
+static
+void pmi_allgather(const void* in, void* out, size_t size)
+{
+  if (PMI_Allgather((void*) in, out, size) != PMI_SUCCESS)
+    CHPL_INTERNAL_ERROR("PMI_Allgather(collective mailboxes) failed");
+}
+
+
 void chpl_comm_post_task_init(void)
 {
   if (chpl_numNodes == 1)
@@ -2099,6 +2138,7 @@ void chpl_comm_post_task_init(void)
     gni_setup_per_comm_dom(i);
 
   atomic_init_int_least32_t(&global_init_cdi, 0);
+  atomic_init_uint_least32_t(&per_thread_cd_cnt, 0);
 
 
   //
@@ -2106,6 +2146,11 @@ void chpl_comm_post_task_init(void)
   //
   register_memory();
 
+  //
+  // Set up the generic collectives.
+  //
+  chpl_comm_coll_init_oob(pmi_allgather);
+
   //
   // Start the polling task.
   //
@@ -2233,6 +2278,13 @@ static void compute_comm_dom_cnt(void)
 
   comm_dom_cnt++;  // count the polling task's dedicated comm domain
 
+  //
+  // With per-thread comm domains, add one to the shared pool for threads
+  // that don't get their own.
+  //
+  if (per_thread_cds)
+    comm_dom_cnt++;
+
   //
   // Limit us to 120 on Aries (architectural limit = 128).
   //
@@ -2244,6 +2296,13 @@ static void compute_comm_dom_cnt(void)
 
   if (comm_dom_cnt >= (1 << _IID_CDI_BITS))
     CHPL_INTERNAL_ERROR("too many comm domains for internal encoding");
+
+  //
+  // Leave one for the polling task and at least one shared.
+  //
+  per_thread_cd_max = (per_thread_cds && comm_dom_cnt > 2)
+                      ? comm_dom_cnt - 2
+                      : 0;
 }
 
 
@@ -2255,6 +2314,7 @@ void gni_setup_per_comm_dom(int cdi)
 
   INIT_CD_BUSY(cd);
   cd->firmly_bound = false;
+  cd->per_thread = false;
 
   //
   // Create communication domain.
@@ -2791,25 +2851,49 @@ mem_region_t* mreg_for_local_addr(void* addr, size_t size)
 }
 
 
+//
+// Remote lookups go through a small per-thread direct-mapped cache of
+// memory region table entries, keyed by locale and address page, so
+// that alternating among a few regions or locales doesn't mean a table
+// search each time.  Other nodes change their entries in our copies of
+// their tables without telling us, so rather than trying to invalidate
+// the cache we re-check a cached entry against the table itself, as
+// the search would, each time we use it.
+//
+#define MREG_XLATE_CACHE_LEN 64  // must be a power of 2
+#define MREG_XLATE_PAGE_BITS 21
+
+typedef struct {
+  c_nodeid_t    locale;
+  uint64_t      page;
+  mem_region_t* mr;
+} mreg_xlate_t;
+
+static __thread mreg_xlate_t mreg_xlate_cache[MREG_XLATE_CACHE_LEN];
+
 static
 inline
 mem_region_t* mreg_for_remote_addr(void* addr, size_t size, c_nodeid_t locale)
 {
-  static __thread mem_region_t** mrs;
+  const uint64_t page = (uint64_t) addr >> MREG_XLATE_PAGE_BITS;
+  mreg_xlate_t* xe =
+    &mreg_xlate_cache[(page ^ ((uint64_t) locale * 0x9E3779B97F4A7C15UL))
+                      & (MREG_XLATE_CACHE_LEN - 1)];
   mem_region_t* mr;
-  if (mrs == NULL) {
-    mrs = (mem_region_t**) chpl_mem_allocManyZero(chpl_numNodes,
-                                                  sizeof(mrs[0]),
-                                                  CHPL_RT_MD_COMM_PER_LOC_INFO,
-                                                  0, 0);
-  }
   PERFSTATS_INC(remote_mreg_cnt);
   PERFSTATS_TSTAMP(pstStart);
-  if ((mr = mrs[locale]) == NULL
+  if ((mr = xe->mr) == NULL
+      || xe->locale != locale
+      || xe->page != page
       || (uint64_t) addr < mr->addr
       || (uint64_t) addr >= mr->addr + mrtl_len(mr->len)
       || !mrtl_isReg(mr->len)) {
-    mr = mrs[locale] = mreg_for_addr(addr, mem_regions_all_entries[locale]);
+    mr = mreg_for_addr(addr, mem_regions_all_entries[locale]);
+    if (mr != NULL) {
+      xe->locale = locale;
+      xe->page = page;
+      xe->mr = mr;
+    }
     PERFSTATS_ADD(remote_mreg_cmps,
                   ((mr == NULL)
                    ? mem_regions_all_entries[locale]->mreg_cnt
@@ -2875,6 +2959,7 @@ void set_up_for_polling(void)
   //
   // Grab a communication domain permanently.
   //
+  cd_bind_tried = true;  // we bind our own, below
   acquire_comm_dom();
   cd->firmly_bound = true;
 
@@ -3899,25 +3984,6 @@ void regMemBroadcast(int mr_i, int mr_cnt, chpl_bool send_mreg_cnt)
 }
 
 
-wide_ptr_t* chpl_comm_broadcast_global_vars_helper() {
-  //
-  // Gather the global variables' wide pointers on node 0 into a
-  // buffer, and broadcast the address of that buffer to the other
-  // nodes.
-  //
-  wide_ptr_t* buf;
-  if (chpl_nodeID == 0) {
-    buf = (wide_ptr_t*) chpl_mem_allocMany(chpl_numGlobalsOnHeap, sizeof(*buf),
-                                           CHPL_RT_MD_COMM_PER_LOC_INFO, 0, 0);
-    for (int i = 0; i < chpl_numGlobalsOnHeap; i++) {
-      buf[i] = *chpl_globals_registry[i];
-    }
-  }
-  PMI_Bcast(&buf, sizeof(buf));
-  return buf;
-}
-
-
 void chpl_comm_broadcast_private(int id, size_t size)
 {
   int i;
@@ -3940,50 +4006,53 @@ void chpl_comm_broadcast_private(int id, size_t size)
 }
 
 
-void chpl_comm_impl_barrier(const char *msg)
-{
-  DBG_P_L(DBGF_IFACE, "IFACE chpl_comm_barrier(\"%s\")", msg);
+//
+// The barrier also comes in split-phase form: begin, then test until
+// done.  bar_progress() does as much as it can without waiting and says
+// whether the barrier is done.
+//
+static chpl_bool bar_in_progress;
+static const char* bar_msg;
+static uint32_t bar_num_children_seen;
+static chpl_bool bar_notified_parent;
 
-  //
-  // If we can't communicate yet, just do a PMI barrier.
-  //
-  if (!polling_task_running) {
-    if (PMI_Barrier() != PMI_SUCCESS)
-      CHPL_INTERNAL_ERROR("PMI_Barrier() failed");
-    return;
-  }
 
+static
+chpl_bool bar_progress(void)
+{
   //
   // Wait for our child locales to notify us that they have reached the
   // barrier.
   //
-  DBG_P_LP(DBGF_BARRIER, "BAR wait for %d children", (int) bar_num_children);
-  for (uint32_t i = 0; i < bar_num_children; i++) {
-    while (bar_info.child_notify[i] == 0) {
+  while (bar_num_children_seen < bar_num_children) {
+    if (bar_info.child_notify[bar_num_children_seen] == 0) {
       PERFSTATS_INC(lyield_in_bar_1_cnt);
-      local_yield();
+      return false;
     }
+    bar_num_children_seen++;
   }
 
   if (chpl_nodeID != 0) {
-    //
-    // Notify our parent locale that we have reached the barrier.
-    //
-    static uint32_t bar_flag = 1;
-    uint32_t child_in_parent = (chpl_nodeID - 1) % BAR_TREE_NUM_CHILDREN;
-
-    DBG_P_LP(DBGF_BARRIER, "BAR notify parent %d", (int) bar_parent);
-    do_remote_put(&bar_flag, bar_parent,
-                  (void*) &parent_bar_info->child_notify[child_in_parent],
-                  sizeof(bar_flag), NULL, may_proxy_true);
+    if (!bar_notified_parent) {
+      //
+      // Notify our parent locale that we have reached the barrier.
+      //
+      static uint32_t bar_flag = 1;
+      uint32_t child_in_parent = (chpl_nodeID - 1) % BAR_TREE_NUM_CHILDREN;
+
+      DBG_P_LP(DBGF_BARRIER, "BAR notify parent %d", (int) bar_parent);
+      do_remote_put(&bar_flag, bar_parent,
+                    (void*) &parent_bar_info->child_notify[child_in_parent],
+                    sizeof(bar_flag), NULL, may_proxy_true);
+      bar_notified_parent = true;
+    }
 
     //
     // Wait for our parent locale to release us from the barrier.
     //
-    DBG_P_LP(DBGF_BARRIER, "BAR wait for parental release");
-    while (bar_info.parent_release == 0) {
+    if (bar_info.parent_release == 0) {
       PERFSTATS_INC(lyield_in_bar_2_cnt);
-      local_yield();
+      return false;
     }
   }
 
@@ -4017,6 +4086,60 @@ void chpl_comm_impl_barrier(const char *msg)
     do_remote_put_V(bar_num_children, src_v, node_v, tgt_v, size_v, NULL,
                     may_proxy_true);
   }
+
+  bar_in_progress = false;
+  return true;
+}
+
+
+void chpl_comm_impl_barrier_begin(const char *msg)
+{
+  DBG_P_L(DBGF_IFACE, "IFACE chpl_comm_barrier_begin(\"%s\")", msg);
+
+  if (bar_in_progress)
+    CHPL_INTERNAL_ERROR("barrier begun while another is in progress");
+
+  bar_msg = msg;
+  bar_num_children_seen = 0;
+  bar_notified_parent = false;
+  bar_in_progress = true;
+  DBG_P_LP(DBGF_BARRIER, "BAR wait for %d children", (int) bar_num_children);
+  (void) bar_progress();
+}
+
+
+chpl_bool chpl_comm_impl_barrier_test(void)
+{
+  return !bar_in_progress || bar_progress();
+}
+
+
+void chpl_comm_impl_barrier_wait(void)
+{
+  DBG_P_L(DBGF_IFACE, "IFACE chpl_comm_barrier_wait(\"%s\")",
+          (bar_msg == NULL) ? "" : bar_msg);
+
+  while (!chpl_comm_impl_barrier_test()) {
+    local_yield();
+  }
+}
+
+
+void chpl_comm_impl_barrier(const char *msg)
+{
+  DBG_P_L(DBGF_IFACE, "IFACE chpl_comm_barrier(\"%s\")", msg);
+
+  //
+  // If we can't communicate yet, just do a PMI barrier.
+  //
+  if (!polling_task_running) {
+    if (PMI_Barrier() != PMI_SUCCESS)
+      CHPL_INTERNAL_ERROR("PMI_Barrier() failed");
+    return;
+  }
+
+  chpl_comm_impl_barrier_begin(msg);
+  chpl_comm_impl_barrier_wait();
 }
 
 
@@ -4593,7 +4716,7 @@ void send_polling_response(void* src_addr, c_nodeid_t locale, void* tgt_addr,
   // This gets nearly all the benefit of not waiting for completions,
   // while avoiding concurrency control entirely.
   //
-  if (cd == NULL || !cd->firmly_bound) {
+  if (!IS_POLLING_CD(cd)) {
     do_remote_put(src_addr, locale, tgt_addr, size, mr, may_proxy_false);
     return;
   }
@@ -5103,7 +5226,7 @@ void chpl_comm_put(void* addr, c_nodeid_t locale, void* raddr,
   }
 
   // Communications callback support
-  if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_put)) {
+  if (chpl_comm_want_callbacks(chpl_comm_cb_event_kind_put, locale, size)) {
       chpl_comm_cb_info_t cb_data =
         {chpl_comm_cb_event_kind_put, chpl_nodeID, locale,
          .iu.comm={addr, raddr, size, commID, ln, fn}};
@@ -5629,7 +5752,7 @@ void chpl_comm_get_unordered(void* addr, c_nodeid_t locale, void* raddr,
   }
 
   // Communications callback support
-  if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_get)) {
+  if (chpl_comm_want_callbacks(chpl_comm_cb_event_kind_get, locale, size)) {
       chpl_comm_cb_info_t cb_data =
         {chpl_comm_cb_event_kind_get, chpl_nodeID, locale,
          .iu.comm={addr, raddr, size, commID, ln, fn}};
@@ -5660,7 +5783,7 @@ void chpl_comm_put_unordered(void* addr, c_nodeid_t locale, void* raddr,
   }
 
   // Communications callback support
-  if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_put)) {
+  if (chpl_comm_want_callbacks(chpl_comm_cb_event_kind_put, locale, size)) {
       chpl_comm_cb_info_t cb_data =
         {chpl_comm_cb_event_kind_put, chpl_nodeID, locale,
          .iu.comm={addr, raddr, size, commID, ln, fn}};
@@ -5695,7 +5818,7 @@ void chpl_comm_get(void* addr, c_nodeid_t locale, void* raddr,
   }
 
   // Communications callback support
-  if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_get)) {
+  if (chpl_comm_want_callbacks(chpl_comm_cb_event_kind_get, locale, size)) {
       chpl_comm_cb_info_t cb_data =
         {chpl_comm_cb_event_kind_get, chpl_nodeID, locale,
          .iu.comm={addr, raddr, size, commID, ln, fn}};
@@ -6127,6 +6250,34 @@ void chpl_comm_get_strd(void* dstaddr_arg, size_t* dststrides,
 }
 
 
+//
+// The strided transfers above retire all of their transactions before
+// returning, so these are complete on return.
+//
+chpl_comm_nb_handle_t chpl_comm_put_strd_nb(void* dstaddr, size_t* dststrides,
+                                            c_nodeid_t dstnode,
+                                            void* srcaddr, size_t* srcstrides,
+                                            size_t* count, int32_t stridelevels,
+                                            size_t elemSize, int32_t commID,
+                                            int ln, int32_t fn) {
+  chpl_comm_put_strd(dstaddr, dststrides, dstnode, srcaddr, srcstrides,
+                     count, stridelevels, elemSize, commID, ln, fn);
+  return NULL;
+}
+
+
+chpl_comm_nb_handle_t chpl_comm_get_strd_nb(void* dstaddr, size_t* dststrides,
+                                            c_nodeid_t srcnode,
+                                            void* srcaddr, size_t* srcstrides,
+                                            size_t* count, int32_t stridelevels,
+                                            size_t elemSize, int32_t commID,
+                                            int ln, int32_t fn) {
+  chpl_comm_get_strd(dstaddr, dststrides, srcnode, srcaddr, srcstrides,
+                     count, stridelevels, elemSize, commID, ln, fn);
+  return NULL;
+}
+
+
 //
 // Non-blocking get interface
 //
@@ -6165,21 +6316,42 @@ int chpl_comm_test_nb_complete(chpl_comm_nb_handle_t h)
 }
 
 
+//
+// The only incomplete handles we give out are for non-blocking fetching
+// AMOs; see do_nic_amo_nb().
+//
 void chpl_comm_wait_nb_some(chpl_comm_nb_handle_t* h, size_t nhandles)
 {
   chpl_comm_diags_incr(wait_nb);
 
   PERFSTATS_INC(wait_nb_cnt);
+
+  for (size_t i = 0; i < nhandles; i++) {
+    if (h[i] != NULL) {
+      while (!nb_amo_retire(h[i]))
+        local_yield();
+      h[i] = NULL;
+    }
+  }
 }
 
 
 int chpl_comm_try_nb_some(chpl_comm_nb_handle_t* h, size_t nhandles)
 {
+  int any_done = 0;
+
   chpl_comm_diags_incr(try_nb);
 
   PERFSTATS_INC(try_nb_cnt);
 
-  return 0;
+  for (size_t i = 0; i < nhandles; i++) {
+    if (h[i] != NULL && nb_amo_retire(h[i])) {
+      h[i] = NULL;
+      any_done = 1;
+    }
+  }
+
+  return any_done;
 }
 
 
@@ -6530,6 +6702,36 @@ DEFINE_CHPL_COMM_ATOMIC_CMPXCHG(real64, cswap_64, int_least64_t)
             do_nic_amo(opnd, NULL, loc, obj, sz,                        \
                        amo_cmd_2_nic_op(_c, 1), res, remote_mr);        \
           }                                                             \
+        }                                                               \
+                                                                        \
+        /*==============================*/                              \
+        chpl_comm_nb_handle_t                                           \
+        chpl_comm_atomic_fetch_##_o##_nb_##_f(void* opnd,               \
+                                              int32_t loc,              \
+                                              void* obj,                \
+                                              void* res,                \
+                                              memory_order order,       \
+                                              int ln, int32_t fn)       \
+        {                                                               \
+          mem_region_t* remote_mr;                                      \
+          DBG_P_LP(DBGF_IFACE|DBGF_AMO,                                 \
+                   "IFACE chpl_comm_atomic_fetch_"#_o"_nb_"#_f          \
+                   "(%p, %d, %p, %p)",                                  \
+                   opnd, (int) loc, obj, res);                          \
+                                                                        \
+          chpl_comm_diags_verbose_amo("amo fetch_" #_o "_nb",           \
+                                      loc, ln, fn);                     \
+          chpl_comm_diags_incr(amo);                                    \
+          const size_t sz = sizeof(_t);                                 \
+          if (chpl_numNodes == 1                                        \
+              || ((remote_mr = mreg_for_remote_addr(obj, sz, loc))      \
+                  == NULL)) {                                           \
+            do_non_nic_amo_##_c##_##_f(obj, res, opnd, NULL, loc);      \
+            return NULL;                                                \
+          }                                                             \
+          return do_nic_amo_nb(opnd, loc, obj, sz,                      \
+                               amo_cmd_2_nic_op(_c, 1), res,            \
+                               remote_mr);                              \
         }
 
 DEFINE_CHPL_COMM_ATOMIC_INT_OP(int32, and, and_i32, int_least32_t)
@@ -6646,6 +6848,35 @@ DEFINE_CHPL_COMM_ATOMIC_INT_OP(uint64, add, add_i64, uint_least64_t)
           else {                                                        \
             do_non_nic_amo_##_c##_##_f(obj, res, opnd, NULL, loc);      \
           }                                                             \
+        }                                                               \
+                                                                        \
+        /*==============================*/                              \
+        chpl_comm_nb_handle_t                                           \
+        chpl_comm_atomic_fetch_add_nb_##_f(void* opnd,                  \
+                                           int32_t loc,                 \
+                                           void* obj,                   \
+                                           void* res,                   \
+                                           memory_order order,          \
+                                           int ln, int32_t fn)          \
+        {                                                               \
+          mem_region_t* remote_mr;                                      \
+          DBG_P_LP(DBGF_IFACE|DBGF_AMO,                                 \
+                   "IFACE chpl_comm_atomic_fetch_add_nb_"#_f            \
+                   "(%p, %d, %p, %p)",                                  \
+                   opnd, (int) loc, obj, res);                          \
+                                                                        \
+          chpl_comm_diags_verbose_amo("amo fetch_add_nb", loc, ln, fn); \
+          chpl_comm_diags_incr(amo);                                    \
+          const size_t sz = sizeof(_t);                                 \
+          if (chpl_numNodes > 1 && sz == sizeof(int_least32_t)          \
+              && ((remote_mr = mreg_for_remote_addr(obj, sz, loc))      \
+                  != NULL)) {                                           \
+            return do_nic_amo_nb(opnd, loc, obj, sz,                    \
+                                 amo_cmd_2_nic_op(_c, 1), res,          \
+                                 remote_mr);                            \
+          }                                                             \
+          do_non_nic_amo_##_c##_##_f(obj, res, opnd, NULL, loc);        \
+          return NULL;                                                  \
         }
 
 DEFINE_CHPL_COMM_ATOMIC_REAL_OP(real32, add_r32, _real32)
@@ -6711,6 +6942,27 @@ DEFINE_CHPL_COMM_ATOMIC_REAL_OP(real64, add_r64, _real64)
                                                                         \
           chpl_comm_atomic_fetch_add_##_f(&nopnd, loc, obj, res, order, \
                                           ln, fn);                      \
+        }                                                               \
+                                                                        \
+        /*==============================*/                              \
+        chpl_comm_nb_handle_t                                           \
+        chpl_comm_atomic_fetch_sub_nb_##_f(void* opnd,                  \
+                                           int32_t loc,                 \
+                                           void* obj,                   \
+                                           void* res,                   \
+                                           memory_order order,          \
+                                           int ln, int32_t fn)          \
+        {                                                               \
+          _t nopnd = _negate(*(_t*) opnd);                              \
+                                                                        \
+          DBG_P_LP(DBGF_IFACE|DBGF_AMO,                                 \
+                   "IFACE chpl_comm_atomic_fetch_sub_nb_"#_f            \
+                   "(%p, %d, %p, %p)",                                  \
+                   opnd, (int) loc, obj, res);                          \
+                                                                        \
+          return chpl_comm_atomic_fetch_add_nb_##_f(&nopnd, loc, obj,   \
+                                                    res, order,         \
+                                                    ln, fn);            \
         }
 
 #define NEGATE_I32(x) ((x) == INT_LEAST32_MIN ? (x) : -(x))
@@ -6929,6 +7181,209 @@ void do_nic_amo(void* opnd1, void* opnd2, c_nodeid_t locale,
 }
 
 
+/*
+ *** START OF NON-BLOCKING FETCHING ATOMIC OPERATIONS ***
+ *
+ * The handle for a non-blocking fetching AMO points to its descriptor.
+ * These are the only non-NULL handles we give out; everything else we
+ * do "non-blocking" is already done when it returns.
+ *
+ * A task may keep many of these in flight, so we don't go to the
+ * shared pools for each one.  Descriptors come from a per-thread free
+ * list that we extend a batch at a time, and the result trampolines
+ * needed when the caller's result isn't NIC-registered come from a
+ * per-thread cache that we refill from the amo_res pools several at a
+ * time, under one pool lock.
+ */
+
+typedef struct nb_amo_desc_s {
+  nb_desc_t nb_desc;              // POST, completion flag, comm domain
+  void* result;                   // where the caller wants the result
+  fork_amo_data_t* reg_result;    // trampoline, if result isn't registered
+  size_t size;
+  struct nb_amo_desc_s* next_free;
+} nb_amo_desc_t;
+
+#define NB_AMO_DESC_BATCH 64
+
+static __thread nb_amo_desc_t* nb_amo_desc_free = NULL;
+
+#define AMO_RES_CACHE_LEN 32
+
+static __thread fork_amo_data_t* amo_res_cache[AMO_RES_CACHE_LEN];
+static __thread int amo_res_cache_cnt = 0;
+
+
+static
+nb_amo_desc_t* nb_amo_desc_alloc(void)
+{
+  nb_amo_desc_t* d;
+
+  if (nb_amo_desc_free == NULL) {
+    //
+    // These stay on this thread's list for good once we have them.
+    //
+    nb_amo_desc_t* batch =
+      (nb_amo_desc_t*) chpl_mem_allocMany(NB_AMO_DESC_BATCH, sizeof(*batch),
+                                          CHPL_RT_MD_COMM_UTIL, 0, 0);
+    for (int i = 0; i < NB_AMO_DESC_BATCH - 1; i++)
+      batch[i].next_free = &batch[i + 1];
+    batch[NB_AMO_DESC_BATCH - 1].next_free = NULL;
+    nb_amo_desc_free = batch;
+  }
+
+  d = nb_amo_desc_free;
+  nb_amo_desc_free = d->next_free;
+  return d;
+}
+
+
+static inline
+void nb_amo_desc_release(nb_amo_desc_t* d)
+{
+  d->next_free = nb_amo_desc_free;
+  nb_amo_desc_free = d;
+}
+
+
+//
+// Move up to n result buffers from one of the amo_res pools to v,
+// returning how many we got (at least 1).
+//
+static
+int amo_res_alloc_batch(fork_amo_data_t** v, int n)
+{
+  int i, j;
+  int cnt = 0;
+
+  for (i = amo_res_next_pool_i();
+       cnt == 0;
+       i = (i + 1) & (AMO_RES_NUM_POOLS - 1)) {
+    if (mpool_idx_load(&amo_res_pool_head[i]) >= 0 &&
+        !atomic_exchange_bool(&amo_res_pool_lock[i], true)) {
+      while (cnt < n && (j = mpool_idx_load(&amo_res_pool_head[i])) >= 0) {
+        v[cnt++] = &amo_res_pool[i][j];
+        mpool_idx_store(&amo_res_pool_head[i], amo_res_pool[i][j].i);
+      }
+      atomic_store_bool(&amo_res_pool_lock[i], false);
+    }
+  }
+
+  return cnt;
+}
+
+
+static inline
+fork_amo_data_t* nb_amo_res_alloc(void)
+{
+  if (amo_res_cache_cnt == 0)
+    amo_res_cache_cnt = amo_res_alloc_batch(amo_res_cache,
+                                            AMO_RES_CACHE_LEN / 2);
+  return amo_res_cache[--amo_res_cache_cnt];
+}
+
+
+static inline
+void nb_amo_res_free(fork_amo_data_t* amo_res_p)
+{
+  if (amo_res_cache_cnt < AMO_RES_CACHE_LEN)
+    amo_res_cache[amo_res_cache_cnt++] = amo_res_p;
+  else
+    amo_res_free(amo_res_p);
+}
+
+
+static
+chpl_comm_nb_handle_t do_nic_amo_nb(void* opnd1, c_nodeid_t locale,
+                                    void* object, size_t size,
+                                    gni_fma_cmd_type_t cmd, void* result,
+                                    mem_region_t* remote_mr)
+{
+  nb_amo_desc_t*         d;
+  mem_region_t*          local_mr;
+  void*                  reg_result = result;
+  gni_post_descriptor_t* post_desc;
+
+  check_nic_amo(size, object, remote_mr);
+  PERFSTATS_INC(amo_cnt);
+
+  d = nb_amo_desc_alloc();
+  d->result = result;
+  d->reg_result = NULL;
+  d->size = size;
+
+  //
+  // The result has to be in memory known to the NIC.  Unlike the
+  // blocking case we can't use the stack, so if the caller's result
+  // isn't registered we give the NIC a trampoline instead.
+  //
+  if ((local_mr = mreg_for_local_addr(reg_result, size)) == NULL) {
+    reg_result = d->reg_result = nb_amo_res_alloc();
+    local_mr = gnr_mreg;
+    if (local_mr == NULL)
+      CHPL_INTERNAL_ERROR("do_nic_amo_nb(): "
+                          "result address is not NIC-registered");
+  }
+
+  //
+  // Fill in the POST descriptor.
+  //
+  post_desc                    = &d->nb_desc.post_desc;
+  *post_desc                   = (gni_post_descriptor_t) { 0 };
+  post_desc->type              = GNI_POST_AMO;
+  post_desc->cq_mode           = GNI_CQMODE_GLOBAL_EVENT;
+  post_desc->dlvr_mode         = GNI_DLVMODE_PERFORMANCE;
+  post_desc->rdma_mode         = 0;
+  post_desc->src_cq_hndl       = 0;
+  post_desc->local_addr        = (uint64_t) (intptr_t) reg_result;
+  post_desc->local_mem_hndl    = local_mr->mdh;
+  post_desc->remote_addr       = (uint64_t) (intptr_t) object;
+  post_desc->remote_mem_hndl   = remote_mr->mdh;
+  post_desc->length            = size;
+  post_desc->amo_cmd           = cmd;
+  post_desc->first_operand     = size == 4 ? *(uint32_t*) opnd1:
+                                             *(uint64_t*) opnd1;
+
+  atomic_init_bool(&d->nb_desc.done, false);
+  post_desc->post_id = (uint64_t) (intptr_t) &d->nb_desc.done;
+
+  //
+  // Initiate the transaction, but don't wait for it.
+  //
+  d->nb_desc.cdi = post_fma(locale, post_desc);
+
+  return (chpl_comm_nb_handle_t) d;
+}
+
+
+//
+// If the non-blocking AMO with the given handle is done, deliver its
+// result, recycle its resources, and return true.  Otherwise return
+// false.
+//
+static
+chpl_bool nb_amo_retire(chpl_comm_nb_handle_t h)
+{
+  nb_amo_desc_t* d = (nb_amo_desc_t*) h;
+
+  if (!atomic_load_explicit_bool(&d->nb_desc.done, memory_order_acquire)) {
+    consume_all_outstanding_cq_events(d->nb_desc.cdi);
+    if (!atomic_load_explicit_bool(&d->nb_desc.done, memory_order_acquire))
+      return false;
+  }
+
+  if (d->reg_result != NULL) {
+    memcpy(d->result, d->reg_result, d->size);
+    nb_amo_res_free(d->reg_result);
+  }
+
+  nb_amo_desc_release(d);
+  return true;
+}
+
+/*** END OF NON-BLOCKING FETCHING ATOMIC OPERATIONS ***/
+
+
 void chpl_comm_execute_on(c_nodeid_t locale, c_sublocid_t subloc,
                           chpl_fn_int_t fid,
                           chpl_comm_on_bundle_t* arg, size_t arg_size,
@@ -6941,7 +7396,8 @@ void chpl_comm_execute_on(c_nodeid_t locale, c_sublocid_t subloc,
   assert(locale != chpl_nodeID); // locale model code should prevent this ...
 
   // Communications callback support
-  if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_executeOn)) {
+  if (chpl_comm_want_callbacks(chpl_comm_cb_event_kind_executeOn,
+                               locale, arg_size)) {
       chpl_comm_cb_info_t cb_data =
         {chpl_comm_cb_event_kind_executeOn, chpl_nodeID, locale,
          .iu.executeOn={subloc, fid, arg, arg_size, ln, fn}};
@@ -6968,7 +7424,8 @@ void chpl_comm_execute_on_nb(c_nodeid_t locale, c_sublocid_t subloc,
   assert(locale != chpl_nodeID); // locale model code should prevent this ...
 
   // Communications callback support
-  if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_executeOn_nb)) {
+  if (chpl_comm_want_callbacks(chpl_comm_cb_event_kind_executeOn_nb,
+                               locale, arg_size)) {
       chpl_comm_cb_info_t cb_data =
         {chpl_comm_cb_event_kind_executeOn_nb, chpl_nodeID, locale,
          .iu.executeOn={subloc, fid, arg, arg_size, ln, fn}};
@@ -6995,7 +7452,8 @@ void chpl_comm_execute_on_fast(c_nodeid_t locale, c_sublocid_t subloc,
   assert(locale != chpl_nodeID); // locale model code should prevent this ...
 
   // Communications callback support
-  if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_executeOn_fast)) {
+  if (chpl_comm_want_callbacks(chpl_comm_cb_event_kind_executeOn_fast,
+                               locale, arg_size)) {
       chpl_comm_cb_info_t cb_data =
         {chpl_comm_cb_event_kind_executeOn_fast, chpl_nodeID, locale,
          .iu.executeOn={subloc, fid, arg, arg_size, ln, fn}};
@@ -7492,6 +7950,21 @@ void acquire_comm_dom(void)
   cd = want_cd;
   cd_idx = want_cdi;
 
+  //
+  // With per-thread comm domains, the first one a thread gets is its
+  // own from then on, as long as there are enough to go around.
+  //
+  if (per_thread_cds && !cd_bind_tried) {
+    cd_bind_tried = true;
+    if (atomic_fetch_add_uint_least32_t(&per_thread_cd_cnt, 1)
+        < per_thread_cd_max) {
+      cd->firmly_bound = true;
+      cd->per_thread = true;
+    } else {
+      (void) atomic_fetch_sub_uint_least32_t(&per_thread_cd_cnt, 1);
+    }
+  }
+
 #ifdef DEBUG_STATS
   cd->acqs++;
   cd->acqs_looks += acq_looks;
@@ -7499,6 +7972,26 @@ void acquire_comm_dom(void)
 }
 
 
+//
+// Get a comm domain to post a transaction on.  If we already have one,
+// we went through acquire_comm_dom*() to get it, which made sure it had
+// room in its CQ -- unless it's our per-thread comm domain, which the
+// other tasks on this thread may have filled up since.
+//
+static inline
+void acquire_comm_dom_for_post(void)
+{
+  if (cd == NULL) {
+    acquire_comm_dom();
+  } else if (cd->per_thread) {
+    while (CQ_CNT_LOAD(cd) >= cd->cq_cnt_max) {
+      PERFSTATS_INC(acq_cd_cq_cnt);
+      consume_all_outstanding_cq_events(cd_idx);
+    }
+  }
+}
+
+
 static
 void acquire_comm_dom_and_req_buf(c_nodeid_t remote_locale, int* p_rbi)
 {
@@ -7511,6 +8004,41 @@ void acquire_comm_dom_and_req_buf(c_nodeid_t remote_locale, int* p_rbi)
   uint64_t acq_looks = 0;
 #endif
 
+  //
+  // If we have our own comm domain, we can only wait for one of its
+  // request buffers to free up.
+  //
+  if (cd != NULL && cd->per_thread) {
+    PERFSTATS_INC(acq_cd_rb_cnt);
+
+    do {
+#ifdef DEBUG_STATS
+      acq_looks++;
+#endif
+      for (rbi = 0; rbi < FORK_REQ_BUFS_PER_CD; rbi++) {
+        if (*SEND_SIDE_FORK_REQ_FREE_ADDR(remote_locale, cd_idx, rbi)) {
+          goto found_own_rb;
+        }
+        PERFSTATS_INC(acq_cd_rb_frf_cnt);
+      }
+      PERFSTATS_INC(lyield_in_acq_cd_rb_cnt);
+      local_yield();
+    } while (1);
+
+  found_own_rb:
+
+    *SEND_SIDE_FORK_REQ_FREE_ADDR(remote_locale, cd_idx, rbi) = false;
+    acquire_comm_dom_for_post();
+
+    *p_rbi = rbi;
+
+#ifdef DEBUG_STATS
+    cd->acqs_with_rb++;
+    cd->acqs_with_rb_looks += acq_looks;
+#endif
+    return;
+  }
+
   if (comm_dom_free_idx == -1) {
     comm_dom_free_idx = atomic_fetch_add_int_least32_t(&global_init_cdi, 1) % comm_dom_cnt;
   }
@@ -7659,8 +8187,7 @@ int post_fma(c_nodeid_t locale, gni_post_descriptor_t* post_desc)
 
   PERFSTATS_ADD_POST(post_desc);
 
-  if (cd == NULL)
-    acquire_comm_dom();
+  acquire_comm_dom_for_post();
   cdi = cd_idx;
 
   CQ_CNT_INC(cd);
@@ -7709,8 +8236,7 @@ int post_fma_ct(c_nodeid_t* locale_v, gni_post_descriptor_t* post_desc)
 {
   int cdi;
 
-  if (cd == NULL)
-    acquire_comm_dom();
+  acquire_comm_dom_for_post();
   cdi = cd_idx;
   PERFSTATS_ADD_POST(post_desc);
 
@@ -7789,8 +8315,7 @@ int post_rdma(c_nodeid_t locale, gni_post_descriptor_t* post_desc)
 
   PERFSTATS_ADD_POST(post_desc);
 
-  if (cd == NULL)
-    acquire_comm_dom();
+  acquire_comm_dom_for_post();
   cdi = cd_idx;
 
   post_desc->src_cq_hndl = cd->cqh;
@@ -7855,6 +8380,17 @@ void local_yield(void)
     else
       sched_yield();
   }
+  else if (cd->per_thread) {
+    //
+    // Our comm domain belongs to our pthread, not our task, so whatever
+    // task runs next here can use it too.
+    //
+    PERFSTATS_INC(tskyield_in_lyield_with_cd_cnt);
+    if (can_task_yield())
+      chpl_task_yield();
+    else
+      sched_yield();
+  }
   else {
     //
     // If we have a comm domain then we have to hold on to our pthread
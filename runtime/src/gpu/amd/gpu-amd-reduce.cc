@@ -103,5 +103,94 @@ GPU_IMPL_REDUCE(DEF_ONE_REDUCE_RET_VAL_IDX, ArgMax, maxloc)
 
 #undef DEF_ONE_REDUCE_RET_VAL_IDX
 
+#if ROCM_VERSION_MAJOR >= 5
+// hipCUB algorithms are called twice: once to ask how much temporary
+// storage they need and once to do the work.  `call` uses `temp` and
+// `temp_bytes`.
+#define HIPCUB_CALL_WITH_TEMP(call) \
+  void* temp = NULL; \
+  size_t temp_bytes = 0; \
+  ROCM_CALL(call); \
+  ROCM_CALL(hipMalloc(&temp, temp_bytes)); \
+  ROCM_CALL(call); \
+  ROCM_CALL(hipFree(temp));
+#else
+#define HIPCUB_CALL_WITH_TEMP(call) \
+  chpl_internal_error("Scans and sorts via runtime calls are not supported with AMD GPUs using ROCm version <5\n");
+#endif
+
+#define DEF_ONE_SUM_SCAN(impl_kind, chpl_kind, data_type) \
+void chpl_gpu_impl_##chpl_kind##_scan_##data_type(data_type* data,\
+                                                  data_type* out, int n,\
+                                                  void* stream) {\
+  HIPCUB_CALL_WITH_TEMP(hipcub::DeviceScan::impl_kind(temp, temp_bytes, data,\
+                                                      out, n,\
+                                                      (hipStream_t)stream))\
+}
+
+GPU_IMPL_REDUCE(DEF_ONE_SUM_SCAN, InclusiveSum, inclusive_sum)
+GPU_IMPL_REDUCE(DEF_ONE_SUM_SCAN, ExclusiveSum, exclusive_sum)
+
+#undef DEF_ONE_SUM_SCAN
+
+#define DEF_ONE_OP_SCAN(impl_op, chpl_kind, data_type) \
+void chpl_gpu_impl_##chpl_kind##_scan_##data_type(data_type* data,\
+                                                  data_type* out, int n,\
+                                                  void* stream) {\
+  HIPCUB_CALL_WITH_TEMP(hipcub::DeviceScan::InclusiveScan(temp, temp_bytes,\
+                                                          data, out,\
+                                                          impl_op(), n,\
+                                                          (hipStream_t)stream))\
+}
+
+GPU_IMPL_REDUCE(DEF_ONE_OP_SCAN, hipcub::Min, inclusive_min)
+GPU_IMPL_REDUCE(DEF_ONE_OP_SCAN, hipcub::Max, inclusive_max)
+
+#undef DEF_ONE_OP_SCAN
+
+#define DEF_ONE_SEGMENTED_REDUCE(impl_kind, chpl_kind, data_type) \
+void chpl_gpu_impl_##chpl_kind##_segmented_reduce_##data_type(\
+    data_type* data, int nsegs, int* offsets, data_type* out, void* stream) {\
+  HIPCUB_CALL_WITH_TEMP(hipcub::DeviceSegmentedReduce::impl_kind(\
+                            temp, temp_bytes, data, out, nsegs, offsets,\
+                            offsets+1, (hipStream_t)stream))\
+}
+
+GPU_IMPL_REDUCE(DEF_ONE_SEGMENTED_REDUCE, Sum, sum)
+GPU_IMPL_REDUCE(DEF_ONE_SEGMENTED_REDUCE, Min, min)
+GPU_IMPL_REDUCE(DEF_ONE_SEGMENTED_REDUCE, Max, max)
+
+#undef DEF_ONE_SEGMENTED_REDUCE
+
+#define DEF_ONE_SORT(impl_kind, chpl_kind, data_type) \
+void chpl_gpu_impl_sort_##chpl_kind##_##data_type(data_type* data,\
+                                                  data_type* out, int n,\
+                                                  void* stream) {\
+  HIPCUB_CALL_WITH_TEMP(hipcub::DeviceRadixSort::impl_kind(\
+                            temp, temp_bytes, data, out, n, 0,\
+                            sizeof(data_type)*8, (hipStream_t)stream))\
+}
+
+GPU_IMPL_REDUCE(DEF_ONE_SORT, SortKeys, keys)
+
+#undef DEF_ONE_SORT
+
+#define DEF_ONE_HISTOGRAM(impl_kind, chpl_kind, data_type) \
+void chpl_gpu_impl_histogram_##chpl_kind##_##data_type(data_type* data, int n,\
+                                                       int* counts, int nbins,\
+                                                       data_type lower,\
+                                                       data_type upper,\
+                                                       void* stream) {\
+  HIPCUB_CALL_WITH_TEMP(hipcub::DeviceHistogram::impl_kind(\
+                            temp, temp_bytes, data, counts, nbins+1, lower,\
+                            upper, n, (hipStream_t)stream))\
+}
+
+GPU_IMPL_REDUCE(DEF_ONE_HISTOGRAM, HistogramEven, even)
+
+#undef DEF_ONE_HISTOGRAM
+
+#undef HIPCUB_CALL_WITH_TEMP
+
 #endif // HAS_GPU_LOCALE
 
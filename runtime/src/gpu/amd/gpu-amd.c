@@ -71,6 +71,10 @@ static hipModule_t *chpl_gpu_rocm_modules;
 
 static int *deviceClockRates;
 
+// whether the device can migrate managed memory on its own (prefetching
+// and advice need this)
+static bool *deviceConcurrentManagedAccess;
+
 
 static void switch_context(int dev_id) {
   ROCM_CALL(hipSetDevice(dev_id));
@@ -114,6 +118,7 @@ void chpl_gpu_impl_init(int* num_devices) {
   const int loc_num_devices = *num_devices;
   chpl_gpu_rocm_modules = chpl_malloc(sizeof(hipModule_t)*loc_num_devices);
   deviceClockRates = chpl_malloc(sizeof(int)*loc_num_devices);
+  deviceConcurrentManagedAccess = chpl_malloc(sizeof(bool)*loc_num_devices);
 
   int i;
   for (i=0 ; i<loc_num_devices ; i++) {
@@ -130,6 +135,11 @@ void chpl_gpu_impl_init(int* num_devices) {
 
     hipDeviceGetAttribute(&deviceClockRates[i], hipDeviceAttributeClockRate, device);
 
+    int concurrentManaged = 0;
+    hipDeviceGetAttribute(&concurrentManaged,
+                          hipDeviceAttributeConcurrentManagedAccess, device);
+    deviceConcurrentManagedAccess[i] = concurrentManaged != 0;
+
     chpl_gpu_impl_set_globals(i, module);
   }
 }
@@ -319,6 +329,21 @@ inline void chpl_gpu_impl_launch_kernel_flat(int ln, int32_t fn,
                               nargs, args);
 }
 
+int chpl_gpu_impl_max_potential_block_size(const char* name) {
+  c_sublocid_t dev_id = chpl_task_getRequestedSubloc();
+  hipModule_t rocm_module = chpl_gpu_rocm_modules[dev_id];
+  void* function = chpl_gpu_load_function(rocm_module, name);
+
+  int min_grid_size;
+  int block_size;
+  ROCM_CALL(hipModuleOccupancyMaxPotentialBlockSize(&min_grid_size,
+                                                    &block_size,
+                                                    (hipFunction_t)function,
+                                                    0, // no dynamic shared memory
+                                                    0));
+  return block_size;
+}
+
 void* chpl_gpu_impl_memset(void* addr, const uint8_t val, size_t n,
                            void* stream) {
   assert(chpl_gpu_is_device_ptr(addr));
@@ -355,28 +380,31 @@ void chpl_gpu_impl_copy_device_to_device(void* dst, const void* src, size_t n,
 }
 
 
-void* chpl_gpu_impl_comm_async(void *dst, void *src, size_t n) {
-  hipStream_t stream;
-  hipStreamCreateWithFlags(&stream, hipStreamNonBlocking);
-  hipMemcpyAsync((hipDeviceptr_t)dst, (hipDeviceptr_t)src, n, hipMemcpyDefault, stream);
-  return stream;
-}
-
-void chpl_gpu_impl_comm_wait(void *stream) {
-  hipStreamSynchronize((hipStream_t)stream);
-  hipStreamDestroy((hipStream_t)stream);
-}
-
-void* chpl_gpu_impl_mem_array_alloc(size_t size) {
+void* chpl_gpu_impl_mem_array_alloc(size_t size,
+                                    chpl_gpu_mem_policy_t policy) {
   assert(size>0);
 
   hipDeviceptr_t ptr = 0;
 
+  // hipMalloc memory is coarse-grained and managed memory is fine-grained.
+  // On an APU like the MI300A both are in the same HBM, so the policy only
+  // decides whether the host sees the GPU's writes while kernels run.
 #ifdef CHPL_GPU_MEM_STRATEGY_ARRAY_ON_DEVICE
     // hip doesn't have stream-ordered memory allocator (no hipMallocAsync)
-    ROCM_CALL(hipMalloc(&ptr, size));
+    if (policy == CHPL_GPU_MEM_POLICY_FINE) {
+      ROCM_CALL(hipExtMallocWithFlags((void**)&ptr, size,
+                                      hipDeviceMallocFinegrained));
+    } else {
+      ROCM_CALL(hipMalloc(&ptr, size));
+    }
 #else
     ROCM_CALL(hipMallocManaged(&ptr, size, hipMemAttachGlobal));
+    if (policy == CHPL_GPU_MEM_POLICY_COARSE) {
+      int dev;
+      ROCM_CALL(hipGetDevice(&dev));
+      ROCM_CALL(hipMemAdvise((void*)ptr, size, hipMemAdviseSetCoarseGrain,
+                             dev));
+    }
 #endif
 
   return (void*)ptr;
@@ -431,6 +459,73 @@ size_t chpl_gpu_impl_get_alloc_size(void* ptr) {
   return size;
 }
 
+void* chpl_gpu_impl_get_alloc_base(void* ptr) {
+  hipDeviceptr_t base;
+  size_t size;
+  ROCM_CALL(hipMemGetAddressRange(&base, &size, (hipDeviceptr_t)ptr));
+
+  return (void*)base;
+}
+
+c_sublocid_t chpl_gpu_impl_get_ptr_device(const void* ptr) {
+  hipPointerAttribute_t res;
+  ROCM_CALL(hipPointerGetAttributes(&res, (hipDeviceptr_t)ptr));
+  return res.device;
+}
+
+// If ptr points into managed memory, returns the allocation it is in.
+static bool get_managed_range(void* ptr, hipDeviceptr_t* base, size_t* size) {
+  hipPointerAttribute_t res;
+  hipError_t ret_val = hipPointerGetAttributes(&res, (hipDeviceptr_t)ptr);
+  if (ret_val != hipSuccess || !res.isManaged) {
+    return false;
+  }
+
+  ROCM_CALL(hipMemGetAddressRange(base, size, (hipDeviceptr_t)ptr));
+  return true;
+}
+
+bool chpl_gpu_impl_mem_prefetch(void* ptr, c_sublocid_t dev_id, void* stream) {
+  hipDeviceptr_t base;
+  size_t size;
+  if (!deviceConcurrentManagedAccess[dev_id] ||
+      !get_managed_range(ptr, &base, &size)) {
+    return false;
+  }
+
+  ROCM_CALL(hipMemPrefetchAsync((void*)base, size, dev_id,
+                                (hipStream_t)stream));
+  return true;
+}
+
+bool chpl_gpu_impl_mem_advise_preferred_location(void* ptr,
+                                                 c_sublocid_t dev_id) {
+  hipDeviceptr_t base;
+  size_t size;
+  if (!deviceConcurrentManagedAccess[dev_id] ||
+      !get_managed_range(ptr, &base, &size)) {
+    return false;
+  }
+
+  ROCM_CALL(hipMemAdvise((void*)base, size, hipMemAdviseSetPreferredLocation,
+                         dev_id));
+  return true;
+}
+
+bool chpl_gpu_impl_mem_advise_read_mostly(void* ptr, bool enable) {
+  hipDeviceptr_t base;
+  size_t size;
+  if (!get_managed_range(ptr, &base, &size)) {
+    return false;
+  }
+
+  ROCM_CALL(hipMemAdvise((void*)base, size,
+                         enable ? hipMemAdviseSetReadMostly :
+                                  hipMemAdviseUnsetReadMostly,
+                         0));
+  return true;
+}
+
 unsigned int chpl_gpu_device_clock_rate(int32_t devNum) {
   return (unsigned int)deviceClockRates[devNum];
 }
@@ -487,6 +582,62 @@ void chpl_gpu_impl_stream_synchronize(void* stream) {
   }
 }
 
+void* chpl_gpu_impl_event_create(void) {
+  hipEvent_t event;
+  ROCM_CALL(hipEventCreateWithFlags(&event, hipEventDisableTiming));
+  return (void*) event;
+}
+
+void chpl_gpu_impl_event_destroy(void* event) {
+  if (event) {
+    ROCM_CALL(hipEventDestroy((hipEvent_t)event));
+  }
+}
+
+void chpl_gpu_impl_event_record(void* event, void* stream) {
+  if (event) {
+    ROCM_CALL(hipEventRecord((hipEvent_t)event, (hipStream_t)stream));
+  }
+}
+
+void chpl_gpu_impl_stream_wait_event(void* stream, void* event) {
+  if (event) {
+    ROCM_CALL(hipStreamWaitEvent((hipStream_t)stream, (hipEvent_t)event, 0));
+  }
+}
+
+bool chpl_gpu_impl_event_ready(void* event) {
+  if (event) {
+    hipError_t res = hipEventQuery((hipEvent_t)event);
+    if (res == hipErrorNotReady) {
+      return false;
+    }
+    ROCM_CALL(res);
+  }
+  return true;
+}
+
+void chpl_gpu_impl_event_synchronize(void* event) {
+  if (event) {
+    ROCM_CALL(hipEventSynchronize((hipEvent_t)event));
+  }
+}
+
+void* chpl_gpu_impl_timing_event_create(void) {
+  hipEvent_t event;
+  ROCM_CALL(hipEventCreate(&event));
+  return (void*) event;
+}
+
+float chpl_gpu_impl_event_elapsed_ms(void* start, void* end) {
+  if (start == NULL || end == NULL) {
+    return -1.0f;
+  }
+  float ms;
+  ROCM_CALL(hipEventElapsedTime(&ms, (hipEvent_t)start, (hipEvent_t)end));
+  return ms;
+}
+
 bool chpl_gpu_impl_can_reduce(void) {
   return ROCM_VERSION_MAJOR>=5;
 }
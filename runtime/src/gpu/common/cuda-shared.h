@@ -94,6 +94,15 @@ size_t chpl_gpu_common_get_alloc_size(void* ptr) {
   return size;
 }
 
+static inline
+void* chpl_gpu_common_get_alloc_base(void* ptr) {
+  CUdeviceptr base;
+  size_t size;
+  CUDA_CALL(cuMemGetAddressRange(&base, &size, (CUdeviceptr)ptr));
+
+  return (void*)base;
+}
+
 #endif // ifndef cuda_shared_h
 
 #endif // HAS_GPU_LOCALE
@@ -26,6 +26,7 @@
 #include "chpl-gpu.h"
 #include "chpl-gpu-impl.h"
 #include "chpl-linefile-support.h"
+#include "chpl-reduce.h"
 #include "chpl-tasks.h"
 #include "error.h"
 #include "chplcgfns.h"
@@ -47,6 +48,131 @@ bool chpl_gpu_impl_is_host_ptr(const void* ptr) {
   return true;
 }
 
+// With CHPL_GPU=cpu, the compiler passes the entry point of a kernel that
+// can run on the host as the first kernel argument, with size 0, or NULL for
+// a kernel that can't. The loop of the latter runs serially right after the
+// launch, so there is nothing to do for it here.
+typedef void (*chpl_gpu_host_kernel_t)(void** params, int64_t first,
+                                       int64_t last);
+
+// A kernel running on the host. The launching task and the tasks it starts
+// repeatedly take the next 'grab' threads, always whole blocks, and run them
+// as one call to the kernel, which loops over them. The last task done with
+// the launch frees it.
+typedef struct {
+  chpl_gpu_host_kernel_t entry;
+  void** params;
+  int64_t num_threads;
+  int64_t grab;
+  atomic_int_least64_t next;
+  atomic_int_least64_t done;
+  atomic_int_least64_t refs;
+} host_launch_t;
+
+typedef struct {
+  chpl_task_bundle_t hdr;
+  host_launch_t* launch;
+} host_launch_task_t;
+
+static void run_host_launch(host_launch_t* launch) {
+  while (true) {
+    int64_t first = atomic_fetch_add_int_least64_t(&launch->next,
+                                                   launch->grab);
+    if (first >= launch->num_threads) {
+      break;
+    }
+    int64_t last = first + launch->grab - 1;
+    if (last >= launch->num_threads) {
+      last = launch->num_threads - 1;
+    }
+
+    launch->entry(launch->params, first, last);
+    atomic_fetch_add_int_least64_t(&launch->done, last - first + 1);
+  }
+}
+
+static void release_host_launch(host_launch_t* launch) {
+  if (atomic_fetch_sub_int_least64_t(&launch->refs, 1) == 1) {
+    atomic_destroy_int_least64_t(&launch->next);
+    atomic_destroy_int_least64_t(&launch->done);
+    atomic_destroy_int_least64_t(&launch->refs);
+    chpl_mem_free(launch, 0, 0);
+  }
+}
+
+static void host_launch_task_wrapper(host_launch_task_t* bundle) {
+  run_host_launch(bundle->launch);
+  release_host_launch(bundle->launch);
+}
+
+static void launch_host_kernel(int ln, int32_t fn, const char* name,
+                               chpl_gpu_host_kernel_t entry,
+                               int64_t num_threads, int blk_dim,
+                               int nargs, va_list args) {
+  // Like cuLaunchKernel, the kernel gets a pointer to the value of each of
+  // its arguments, with ln and fn at the end. Arguments that would be
+  // copied to the device are already in memory the kernel can read, so it
+  // gets a pointer to a pointer to the original instead.
+  void** params = chpl_mem_alloc((nargs+2) * sizeof(void*),
+                                 CHPL_RT_MD_GPU_KERNEL_PARAM_BUFF, ln, fn);
+  void** copied = chpl_mem_alloc((nargs > 0 ? nargs : 1) * sizeof(void*),
+                                 CHPL_RT_MD_GPU_KERNEL_PARAM_META, ln, fn);
+  for (int i = 0; i < nargs; i++) {
+    void* cur_arg = va_arg(args, void*);
+    size_t cur_arg_size = va_arg(args, size_t);
+    if (cur_arg_size > 0) {
+      copied[i] = cur_arg;
+      params[i] = &copied[i];
+    } else {
+      params[i] = cur_arg;
+    }
+  }
+  params[nargs] = &ln;
+  params[nargs+1] = &fn;
+
+  // Hand out a few chunks per task so uneven iterations balance out, but
+  // never split a block.
+  int64_t max_par = chpl_task_getMaxPar();
+  int64_t num_blocks = (num_threads + blk_dim - 1) / blk_dim;
+  int64_t blocks_per_grab = (num_blocks + 4 * max_par - 1) / (4 * max_par);
+  int64_t grab = blocks_per_grab * blk_dim;
+  int64_t num_grabs = (num_threads + grab - 1) / grab;
+  int64_t num_tasks = num_grabs < max_par ? num_grabs : max_par;
+
+  CHPL_GPU_DEBUG("Running kernel %s on the host: %" PRId64 " threads, "
+                 "%" PRId64 " at a time, %" PRId64 " tasks\n",
+                 name, num_threads, grab, num_tasks);
+
+  host_launch_t* launch = chpl_mem_alloc(sizeof(*launch),
+                                         CHPL_RT_MD_GPU_KERNEL_PARAM_META,
+                                         ln, fn);
+  launch->entry = entry;
+  launch->params = params;
+  launch->num_threads = num_threads;
+  launch->grab = grab;
+  atomic_init_int_least64_t(&launch->next, 0);
+  atomic_init_int_least64_t(&launch->done, 0);
+  atomic_init_int_least64_t(&launch->refs, num_tasks);
+
+  host_launch_task_t bundle = { .hdr.kind = CHPL_ARG_BUNDLE_KIND_TASK,
+                                .launch = launch };
+  c_sublocid_t subloc = chpl_task_getRequestedSubloc();
+  for (int64_t i = 1; i < num_tasks; i++) {
+    chpl_task_startMovedTask(FID_NONE, (chpl_fn_p) host_launch_task_wrapper,
+                             &bundle, sizeof(bundle), subloc,
+                             chpl_nullTaskID);
+  }
+
+  run_host_launch(launch);
+  while (atomic_load_int_least64_t(&launch->done) < num_threads) {
+    chpl_task_yield();
+  }
+  release_host_launch(launch);
+
+  chpl_mem_free(copied, ln, fn);
+  chpl_mem_free(params, ln, fn);
+}
+
 inline void chpl_gpu_impl_launch_kernel(int ln, int32_t fn,
                                         const char* name,
                                         int grd_dim_x,
@@ -57,6 +183,8 @@ inline void chpl_gpu_impl_launch_kernel(int ln, int32_t fn,
                                         int blk_dim_z,
                                         void* stream,
                                         int nargs, va_list args) {
+  // Kernels with several dimensions always run as a serial loop after
+  // the launch.
 }
 
 inline void chpl_gpu_impl_launch_kernel_flat(int ln, int32_t fn,
@@ -66,6 +194,22 @@ inline void chpl_gpu_impl_launch_kernel_flat(int ln, int32_t fn,
                                              void* stream,
                                              int nargs,
                                              va_list args) {
+  if (nargs == 0) {
+    return;
+  }
+
+  chpl_gpu_host_kernel_t entry = (chpl_gpu_host_kernel_t) va_arg(args, void*);
+  (void) va_arg(args, size_t);
+  if (entry == NULL) {
+    return;
+  }
+
+  launch_host_kernel(ln, fn, name, entry, num_threads, blk_dim,
+                     nargs - 1, args);
+}
+
+int chpl_gpu_impl_max_potential_block_size(const char* name) {
+  return 0;
 }
 
 void* chpl_gpu_impl_memset(void* addr, const uint8_t val, size_t n,
@@ -88,16 +232,8 @@ void chpl_gpu_impl_copy_device_to_device(void* dst, const void* src, size_t n,
   chpl_memcpy(dst, src, n);
 }
 
-void* chpl_gpu_impl_comm_async(void *dst, void *src, size_t n) {
-  chpl_memcpy(dst, src, n);
-  return NULL;
-}
-
-void chpl_gpu_impl_comm_wait(void *stream) {
-  assert(stream==NULL);
-}
-
-void* chpl_gpu_impl_mem_array_alloc(size_t size) {
+void* chpl_gpu_impl_mem_array_alloc(size_t size,
+                                    chpl_gpu_mem_policy_t policy) {
   // this function's upstream is blocked by GPU_RUNTIME_CPU check, This should
   // be unreachable
   chpl_internal_error("chpl_gpu_mem_array_alloc was called unexpectedly.");
@@ -122,6 +258,27 @@ size_t chpl_gpu_impl_get_alloc_size(void* ptr) {
   return -1;
 }
 
+void* chpl_gpu_impl_get_alloc_base(void* ptr) {
+  return NULL;
+}
+
+c_sublocid_t chpl_gpu_impl_get_ptr_device(const void* ptr) {
+  return 0;
+}
+
+bool chpl_gpu_impl_mem_prefetch(void* ptr, c_sublocid_t dev_id, void* stream) {
+  return false;
+}
+
+bool chpl_gpu_impl_mem_advise_preferred_location(void* ptr,
+                                                 c_sublocid_t dev_id) {
+  return false;
+}
+
+bool chpl_gpu_impl_mem_advise_read_mostly(void* ptr, bool enable) {
+  return false;
+}
+
 unsigned int chpl_gpu_device_clock_rate(int32_t devNum) {
   return -1;
 }
@@ -157,17 +314,45 @@ bool chpl_gpu_impl_stream_ready(void* stream) {
 void chpl_gpu_impl_stream_synchronize(void* stream) {
 }
 
+void* chpl_gpu_impl_event_create(void) {
+  return NULL;
+}
+
+void chpl_gpu_impl_event_destroy(void* event) {
+}
+
+void chpl_gpu_impl_event_record(void* event, void* stream) {
+}
+
+void chpl_gpu_impl_stream_wait_event(void* stream, void* event) {
+}
+
+bool chpl_gpu_impl_event_ready(void* event) {
+  return true;
+}
+
+void chpl_gpu_impl_event_synchronize(void* event) {
+}
+
+void* chpl_gpu_impl_timing_event_create(void) {
+  return NULL;
+}
+
+float chpl_gpu_impl_event_elapsed_ms(void* start, void* end) {
+  return -1.0f;
+}
+
 bool chpl_gpu_impl_can_reduce(void) {
   return false;
 }
 
+// In cpu-as-device mode "device" memory is host memory, so the
+// reductions can use the host kernels directly.
 #define DEF_ONE_REDUCE_RET_VAL(impl_kind, chpl_kind, data_type) \
 void chpl_gpu_impl_##chpl_kind##_reduce_##data_type(data_type* data, int n,\
                                                     data_type* val, int* idx,\
                                                     void* stream) {\
-  chpl_internal_error("This function shouldn't have been called. "\
-                      "cpu-as-device mode should handle reductions in "\
-                      "the module code\n");\
+  *val = chpl_reduce_##chpl_kind##_##data_type(data, n);\
 }
 
 GPU_IMPL_REDUCE(DEF_ONE_REDUCE_RET_VAL, Sum, sum)
@@ -180,9 +365,9 @@ GPU_IMPL_REDUCE(DEF_ONE_REDUCE_RET_VAL, Max, max)
 void chpl_gpu_impl_##chpl_kind##_reduce_##data_type(data_type* data, int n,\
                                                     data_type* val, int* idx,\
                                                     void* stream) {\
-  chpl_internal_error("This function shouldn't have been called. "\
-                      "cpu-as-device mode should handle reductions in "\
-                      "the module code\n");\
+  int64_t loc;\
+  *val = chpl_reduce_##chpl_kind##_##data_type(data, n, &loc);\
+  *idx = (int)loc;\
 }
 
 GPU_IMPL_REDUCE(DEF_ONE_REDUCE_RET_VAL_IDX, ArgMin, minloc)
@@ -190,4 +375,61 @@ GPU_IMPL_REDUCE(DEF_ONE_REDUCE_RET_VAL_IDX, ArgMax, maxloc)
 
 #undef DEF_ONE_REDUCE_RET_VAL_IDX
 
+#define NOT_IN_CPU_AS_DEVICE(what) \
+  chpl_internal_error("This function shouldn't have been called. "\
+                      "cpu-as-device mode should handle " what " in "\
+                      "the module code\n");
+
+#define DEF_ONE_SCAN(chpl_kind, data_type) \
+void chpl_gpu_impl_##chpl_kind##_scan_##data_type(data_type* data,\
+                                                  data_type* out, int n,\
+                                                  void* stream) {\
+  NOT_IN_CPU_AS_DEVICE("scans")\
+}
+
+GPU_REDUCE(DEF_ONE_SCAN, inclusive_sum)
+GPU_REDUCE(DEF_ONE_SCAN, exclusive_sum)
+GPU_REDUCE(DEF_ONE_SCAN, inclusive_min)
+GPU_REDUCE(DEF_ONE_SCAN, inclusive_max)
+
+#undef DEF_ONE_SCAN
+
+#define DEF_ONE_SEGMENTED_REDUCE(chpl_kind, data_type) \
+void chpl_gpu_impl_##chpl_kind##_segmented_reduce_##data_type(\
+    data_type* data, int nsegs, int* offsets, data_type* out, void* stream) {\
+  NOT_IN_CPU_AS_DEVICE("reductions")\
+}
+
+GPU_REDUCE(DEF_ONE_SEGMENTED_REDUCE, sum)
+GPU_REDUCE(DEF_ONE_SEGMENTED_REDUCE, min)
+GPU_REDUCE(DEF_ONE_SEGMENTED_REDUCE, max)
+
+#undef DEF_ONE_SEGMENTED_REDUCE
+
+#define DEF_ONE_SORT(chpl_kind, data_type) \
+void chpl_gpu_impl_sort_##chpl_kind##_##data_type(data_type* data,\
+                                                  data_type* out, int n,\
+                                                  void* stream) {\
+  NOT_IN_CPU_AS_DEVICE("sorts")\
+}
+
+GPU_REDUCE(DEF_ONE_SORT, keys)
+
+#undef DEF_ONE_SORT
+
+#define DEF_ONE_HISTOGRAM(chpl_kind, data_type) \
+void chpl_gpu_impl_histogram_##chpl_kind##_##data_type(data_type* data, int n,\
+                                                       int* counts, int nbins,\
+                                                       data_type lower,\
+                                                       data_type upper,\
+                                                       void* stream) {\
+  NOT_IN_CPU_AS_DEVICE("histograms")\
+}
+
+GPU_REDUCE(DEF_ONE_HISTOGRAM, even)
+
+#undef DEF_ONE_HISTOGRAM
+
+#undef NOT_IN_CPU_AS_DEVICE
+
 #endif // HAS_GPU_LOCALE
@@ -81,6 +81,88 @@ GPU_IMPL_REDUCE(DEF_ONE_REDUCE_RET_VAL_IDX, ArgMax, maxloc)
 
 #undef DEF_ONE_REDUCE_RET_VAL_IDX
 
+// CUB algorithms are called twice: once to ask how much temporary
+// storage they need and once to do the work.  `call` uses `temp` and
+// `temp_bytes`.
+#define CUB_CALL_WITH_TEMP(call) \
+  void* temp = NULL; \
+  size_t temp_bytes = 0; \
+  CUDA_CALL(call); \
+  CUDA_CALL(cuMemAlloc(((CUdeviceptr*)&temp), temp_bytes)); \
+  CUDA_CALL(call); \
+  CUDA_CALL(cuMemFree((CUdeviceptr)temp));
+
+#define DEF_ONE_SUM_SCAN(cub_kind, chpl_kind, data_type) \
+void chpl_gpu_impl_##chpl_kind##_scan_##data_type(data_type* data,\
+                                                  data_type* out, int n,\
+                                                  void* stream) {\
+  CUB_CALL_WITH_TEMP(cub::DeviceScan::cub_kind(temp, temp_bytes, data, out, n,\
+                                               (CUstream)stream))\
+}
+
+GPU_IMPL_REDUCE(DEF_ONE_SUM_SCAN, InclusiveSum, inclusive_sum)
+GPU_IMPL_REDUCE(DEF_ONE_SUM_SCAN, ExclusiveSum, exclusive_sum)
+
+#undef DEF_ONE_SUM_SCAN
+
+#define DEF_ONE_OP_SCAN(cub_op, chpl_kind, data_type) \
+void chpl_gpu_impl_##chpl_kind##_scan_##data_type(data_type* data,\
+                                                  data_type* out, int n,\
+                                                  void* stream) {\
+  CUB_CALL_WITH_TEMP(cub::DeviceScan::InclusiveScan(temp, temp_bytes, data,\
+                                                    out, cub_op(), n,\
+                                                    (CUstream)stream))\
+}
+
+GPU_IMPL_REDUCE(DEF_ONE_OP_SCAN, cub::Min, inclusive_min)
+GPU_IMPL_REDUCE(DEF_ONE_OP_SCAN, cub::Max, inclusive_max)
+
+#undef DEF_ONE_OP_SCAN
+
+#define DEF_ONE_SEGMENTED_REDUCE(cub_kind, chpl_kind, data_type) \
+void chpl_gpu_impl_##chpl_kind##_segmented_reduce_##data_type(\
+    data_type* data, int nsegs, int* offsets, data_type* out, void* stream) {\
+  CUB_CALL_WITH_TEMP(cub::DeviceSegmentedReduce::cub_kind(\
+                         temp, temp_bytes, data, out, nsegs, offsets,\
+                         offsets+1, (CUstream)stream))\
+}
+
+GPU_IMPL_REDUCE(DEF_ONE_SEGMENTED_REDUCE, Sum, sum)
+GPU_IMPL_REDUCE(DEF_ONE_SEGMENTED_REDUCE, Min, min)
+GPU_IMPL_REDUCE(DEF_ONE_SEGMENTED_REDUCE, Max, max)
+
+#undef DEF_ONE_SEGMENTED_REDUCE
+
+#define DEF_ONE_SORT(cub_kind, chpl_kind, data_type) \
+void chpl_gpu_impl_sort_##chpl_kind##_##data_type(data_type* data,\
+                                                  data_type* out, int n,\
+                                                  void* stream) {\
+  CUB_CALL_WITH_TEMP(cub::DeviceRadixSort::cub_kind(\
+                         temp, temp_bytes, data, out, n, 0,\
+                         sizeof(data_type)*8, (CUstream)stream))\
+}
+
+GPU_IMPL_REDUCE(DEF_ONE_SORT, SortKeys, keys)
+
+#undef DEF_ONE_SORT
+
+#define DEF_ONE_HISTOGRAM(cub_kind, chpl_kind, data_type) \
+void chpl_gpu_impl_histogram_##chpl_kind##_##data_type(data_type* data, int n,\
+                                                       int* counts, int nbins,\
+                                                       data_type lower,\
+                                                       data_type upper,\
+                                                       void* stream) {\
+  CUB_CALL_WITH_TEMP(cub::DeviceHistogram::cub_kind(\
+                         temp, temp_bytes, data, counts, nbins+1, lower,\
+                         upper, n, (CUstream)stream))\
+}
+
+GPU_IMPL_REDUCE(DEF_ONE_HISTOGRAM, HistogramEven, even)
+
+#undef DEF_ONE_HISTOGRAM
+
+#undef CUB_CALL_WITH_TEMP
+
 #undef DEF_REDUCE
 
 #endif // HAS_GPU_LOCALE
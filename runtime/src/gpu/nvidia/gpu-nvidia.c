@@ -50,6 +50,10 @@ static CUmodule *chpl_gpu_cuda_modules;
 
 static int *deviceClockRates;
 
+// whether the device can migrate managed memory on its own (prefetching
+// and advice need this)
+static bool *deviceConcurrentManagedAccess;
+
 
 static bool chpl_gpu_has_context(void) {
   CUcontext cuda_context = NULL;
@@ -111,6 +115,7 @@ void chpl_gpu_impl_init(int* num_devices) {
   chpl_gpu_devices = chpl_malloc(sizeof(CUdevice)*loc_num_devices);
   chpl_gpu_cuda_modules = chpl_malloc(sizeof(CUmodule)*loc_num_devices);
   deviceClockRates = chpl_malloc(sizeof(int)*loc_num_devices);
+  deviceConcurrentManagedAccess = chpl_malloc(sizeof(bool)*loc_num_devices);
 
   int i;
   for (i=0 ; i<loc_num_devices ; i++) {
@@ -128,6 +133,11 @@ void chpl_gpu_impl_init(int* num_devices) {
 
     cuDeviceGetAttribute(&deviceClockRates[i], CU_DEVICE_ATTRIBUTE_CLOCK_RATE, device);
 
+    int concurrentManaged = 0;
+    cuDeviceGetAttribute(&concurrentManaged,
+                         CU_DEVICE_ATTRIBUTE_CONCURRENT_MANAGED_ACCESS, device);
+    deviceConcurrentManagedAccess[i] = concurrentManaged != 0;
+
     chpl_gpu_devices[i] = device;
     chpl_gpu_primary_ctx[i] = context;
 
@@ -320,6 +330,20 @@ inline void chpl_gpu_impl_launch_kernel_flat(int ln, int32_t fn,
                               nargs, args);
 }
 
+int chpl_gpu_impl_max_potential_block_size(const char* name) {
+  c_sublocid_t dev_id = chpl_task_getRequestedSubloc();
+  CUmodule cuda_module = chpl_gpu_cuda_modules[dev_id];
+  void* function = chpl_gpu_load_function(cuda_module, name);
+
+  int min_grid_size;
+  int block_size;
+  CUDA_CALL(cuOccupancyMaxPotentialBlockSize(&min_grid_size, &block_size,
+                                             (CUfunction)function,
+                                             NULL, // no dynamic shared memory
+                                             0, 0));
+  return block_size;
+}
+
 void* chpl_gpu_impl_memset(void* addr, const uint8_t val, size_t n,
                            void* stream) {
   assert(chpl_gpu_is_device_ptr(addr));
@@ -353,21 +377,14 @@ void chpl_gpu_impl_copy_device_to_device(void* dst, const void* src, size_t n,
 }
 
 
-void* chpl_gpu_impl_comm_async(void *dst, void *src, size_t n) {
-  CUstream stream;
-  cuStreamCreate(&stream, CU_STREAM_NON_BLOCKING);
-  cuMemcpyAsync((CUdeviceptr)dst, (CUdeviceptr)src, n, stream);
-  return stream;
-}
-
-void chpl_gpu_impl_comm_wait(void *stream) {
-  cuStreamSynchronize((CUstream)stream);
-  cuStreamDestroy((CUstream)stream);
-}
-
-void* chpl_gpu_impl_mem_array_alloc(size_t size) {
+void* chpl_gpu_impl_mem_array_alloc(size_t size,
+                                    chpl_gpu_mem_policy_t policy) {
   assert(size>0);
 
+  // CUDA memory has no coherence granularity to choose; device and managed
+  // memory are used the same way whatever the policy.
+  (void)policy;
+
   CUdeviceptr ptr = 0;
 
 #ifdef CHPL_GPU_MEM_STRATEGY_ARRAY_ON_DEVICE
@@ -427,6 +444,72 @@ size_t chpl_gpu_impl_get_alloc_size(void* ptr) {
   return chpl_gpu_common_get_alloc_size(ptr);
 }
 
+void* chpl_gpu_impl_get_alloc_base(void* ptr) {
+  return chpl_gpu_common_get_alloc_base(ptr);
+}
+
+c_sublocid_t chpl_gpu_impl_get_ptr_device(const void* ptr) {
+  int dev;
+  CUDA_CALL(cuPointerGetAttribute(&dev, CU_POINTER_ATTRIBUTE_DEVICE_ORDINAL,
+                                  (CUdeviceptr)ptr));
+  return dev;
+}
+
+// If ptr points into managed memory, returns the allocation it is in.
+static bool get_managed_range(void* ptr, CUdeviceptr* base, size_t* size) {
+  unsigned int managed = 0;
+  CUresult ret_val = cuPointerGetAttribute(&managed,
+                                           CU_POINTER_ATTRIBUTE_IS_MANAGED,
+                                           (CUdeviceptr)ptr);
+  if (ret_val != CUDA_SUCCESS || !managed) {
+    return false;
+  }
+
+  CUDA_CALL(cuMemGetAddressRange(base, size, (CUdeviceptr)ptr));
+  return true;
+}
+
+bool chpl_gpu_impl_mem_prefetch(void* ptr, c_sublocid_t dev_id, void* stream) {
+  CUdeviceptr base;
+  size_t size;
+  if (!deviceConcurrentManagedAccess[dev_id] ||
+      !get_managed_range(ptr, &base, &size)) {
+    return false;
+  }
+
+  CUDA_CALL(cuMemPrefetchAsync(base, size, chpl_gpu_devices[dev_id],
+                               (CUstream)stream));
+  return true;
+}
+
+bool chpl_gpu_impl_mem_advise_preferred_location(void* ptr,
+                                                 c_sublocid_t dev_id) {
+  CUdeviceptr base;
+  size_t size;
+  if (!deviceConcurrentManagedAccess[dev_id] ||
+      !get_managed_range(ptr, &base, &size)) {
+    return false;
+  }
+
+  CUDA_CALL(cuMemAdvise(base, size, CU_MEM_ADVISE_SET_PREFERRED_LOCATION,
+                        chpl_gpu_devices[dev_id]));
+  return true;
+}
+
+bool chpl_gpu_impl_mem_advise_read_mostly(void* ptr, bool enable) {
+  CUdeviceptr base;
+  size_t size;
+  if (!get_managed_range(ptr, &base, &size)) {
+    return false;
+  }
+
+  CUDA_CALL(cuMemAdvise(base, size,
+                        enable ? CU_MEM_ADVISE_SET_READ_MOSTLY :
+                                 CU_MEM_ADVISE_UNSET_READ_MOSTLY,
+                        0));
+  return true;
+}
+
 unsigned int chpl_gpu_device_clock_rate(int32_t devNum) {
   return (unsigned int)deviceClockRates[devNum];
 }
@@ -480,6 +563,62 @@ void chpl_gpu_impl_stream_synchronize(void* stream) {
   }
 }
 
+void* chpl_gpu_impl_event_create(void) {
+  CUevent event;
+  CUDA_CALL(cuEventCreate(&event, CU_EVENT_DISABLE_TIMING));
+  return (void*) event;
+}
+
+void chpl_gpu_impl_event_destroy(void* event) {
+  if (event) {
+    CUDA_CALL(cuEventDestroy((CUevent)event));
+  }
+}
+
+void chpl_gpu_impl_event_record(void* event, void* stream) {
+  if (event) {
+    CUDA_CALL(cuEventRecord((CUevent)event, (CUstream)stream));
+  }
+}
+
+void chpl_gpu_impl_stream_wait_event(void* stream, void* event) {
+  if (event) {
+    CUDA_CALL(cuStreamWaitEvent((CUstream)stream, (CUevent)event, 0));
+  }
+}
+
+bool chpl_gpu_impl_event_ready(void* event) {
+  if (event) {
+    CUresult res = cuEventQuery((CUevent)event);
+    if (res == CUDA_ERROR_NOT_READY) {
+      return false;
+    }
+    CUDA_CALL(res);
+  }
+  return true;
+}
+
+void chpl_gpu_impl_event_synchronize(void* event) {
+  if (event) {
+    CUDA_CALL(cuEventSynchronize((CUevent)event));
+  }
+}
+
+void* chpl_gpu_impl_timing_event_create(void) {
+  CUevent event;
+  CUDA_CALL(cuEventCreate(&event, CU_EVENT_DEFAULT));
+  return (void*) event;
+}
+
+float chpl_gpu_impl_event_elapsed_ms(void* start, void* end) {
+  if (start == NULL || end == NULL) {
+    return -1.0f;
+  }
+  float ms;
+  CUDA_CALL(cuEventElapsedTime(&ms, (CUevent)start, (CUevent)end));
+  return ms;
+}
+
 bool chpl_gpu_impl_can_reduce(void) {
   return true;
 }
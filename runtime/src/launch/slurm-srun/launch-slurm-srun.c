@@ -38,6 +38,7 @@
 #define CHPL_NODELIST_FLAG "--nodelist"
 #define CHPL_PARTITION_FLAG "--partition"
 #define CHPL_EXCLUDE_FLAG "--exclude"
+#define CHPL_BCAST_FLAG "--bcast"
 
 static char* debug = NULL;
 static char* walltime = NULL;
@@ -46,6 +47,7 @@ static char* nodelist = NULL;
 static char* partition = NULL;
 static char* reservation = NULL;
 static char* exclude = NULL;
+static char* bcastDir = NULL;
 
 char slurmFilename[FILENAME_MAX];
 
@@ -282,6 +284,14 @@ static char* chpl_launch_create_command(int argc, char* argv[],
     exclude = getenv("CHPL_LAUNCHER_EXCLUDE");
   }
 
+  // command line bcast directory takes precedence over env var
+  if (!bcastDir) {
+    bcastDir = getenv("CHPL_LAUNCHER_BCAST");
+  }
+  if (bcastDir && strlen(bcastDir) == 0) {
+    bcastDir = NULL;
+  }
+
   reservation = getenv("SLURM_RESERVATION");
 
   // request exclusive node access by default, but allow user to override
@@ -422,6 +432,22 @@ static char* chpl_launch_create_command(int argc, char* argv[],
                tmpDir, argv[0], "$SLURM_JOB_ID");
     }
 
+    // With a large binary and many nodes, every node loading it from the
+    // shared file system at once can swamp the metadata servers. When
+    // asked to, copy it to node-local storage first (sbcast does this
+    // with a tree broadcast) and run it from there.
+    const char* realBinary = chpl_get_real_binary_name();
+    char bcastBinary[MAX_COM_LEN];
+    if (bcastDir != NULL) {
+      const char* realBasename = strrchr(realBinary, '/');
+      realBasename = (realBasename == NULL) ? realBinary : realBasename + 1;
+      snprintf(bcastBinary, sizeof(bcastBinary), "%s/%s.$SLURM_JOB_ID",
+               bcastDir, realBasename);
+      fprintf(slurmFile, "sbcast --force --compress %s %s || exit 1\n",
+              realBinary, bcastBinary);
+      realBinary = bcastBinary;
+    }
+
     // add the srun command
     fprintf(slurmFile, "srun --kill-on-bad-exit  ");
 
@@ -432,7 +458,7 @@ static char* chpl_launch_create_command(int argc, char* argv[],
     }
     // add the (possibly wrapped) binary name.
     fprintf(slurmFile, "%s %s ",
-        chpl_get_real_binary_wrapper(), chpl_get_real_binary_name());
+        chpl_get_real_binary_wrapper(), realBinary);
 
 
     // add any arguments passed to the launcher to the binary
@@ -446,6 +472,12 @@ static char* chpl_launch_create_command(int argc, char* argv[],
     }
     fprintf(slurmFile, "\n");
 
+    // remove the node-local copies of the binary
+    if (bcastDir != NULL) {
+      fprintf(slurmFile, "srun --nodes=%d --ntasks-per-node=1 rm -f %s\n",
+              numNodes, bcastBinary);
+    }
+
     // After the job is run, if we buffered stdout to <tmpDir>, we need
     // to copy the output to the actual output file. The <tmpDir> output
     // will only exist on one node, ignore failures on the other nodes
@@ -539,6 +571,20 @@ static char* chpl_launch_create_command(int argc, char* argv[],
       len += snprintf(iCom+len, sizeof(iCom)-len, "--account=%s ", account);
     }
 
+    // Copy the binary to node-local storage and run it from there (see
+    // the batch case). srun can only do this for the executable it runs,
+    // so a wrapper would be copied instead of the real binary.
+    if (bcastDir != NULL) {
+      if (strcmp(chpl_get_real_binary_wrapper(), "") == 0) {
+        len += snprintf(iCom+len, sizeof(iCom)-len, "--bcast=%s/ --compress ",
+                        bcastDir);
+      } else {
+        chpl_warning("CHPL_LAUNCHER_BCAST is ignored for interactive jobs "
+                     "with CHPL_LAUNCHER_REAL_WRAPPER set, consider also "
+                     "setting CHPL_LAUNCHER_USE_SBATCH", 0, 0);
+      }
+    }
+
     // add the (possibly wrapped) binary name
     len += snprintf(iCom+len, sizeof(iCom)-len, "%s %s",
         chpl_get_real_binary_wrapper(), chpl_get_real_binary_name());
@@ -654,6 +700,15 @@ int chpl_launch_handle_arg(int argc, char* argv[], int argNum,
     return 1;
   }
 
+  // handle --bcast <dir> or --bcast=<dir>
+  if (!strcmp(argv[argNum], CHPL_BCAST_FLAG)) {
+    bcastDir = argv[argNum+1];
+    return 2;
+  } else if (!strncmp(argv[argNum], CHPL_BCAST_FLAG"=", strlen(CHPL_BCAST_FLAG))) {
+    bcastDir = &(argv[argNum][strlen(CHPL_BCAST_FLAG)+1]);
+    return 1;
+  }
+
   // handle --generate-sbatch-script
   if (!strcmp(argv[argNum], CHPL_GENERATE_SBATCH_SCRIPT)) {
     generate_sbatch_script = 1;
@@ -698,6 +753,12 @@ const argDescTuple_t* chpl_launch_get_help(void) {
       { "",
         "(or use $CHPL_LAUNCHER_EXCLUDE)"
       },
+      { CHPL_BCAST_FLAG " <dir>",
+        "copy the binary to node-local <dir> and run it from there"
+      },
+      { "",
+        "(or use $CHPL_LAUNCHER_BCAST)"
+      },
       { NULL, NULL },
     };
   return args;
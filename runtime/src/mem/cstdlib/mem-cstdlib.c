@@ -45,3 +45,8 @@ void chpl_mem_layerInit(void) {
 
 
 void chpl_mem_layerExit(void) { }
+
+
+size_t chpl_mem_layerHeapPageSize(void) {
+  return 0;
+}
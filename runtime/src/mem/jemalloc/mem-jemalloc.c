@@ -25,7 +25,10 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
+#include <strings.h>
+#include <sys/mman.h>
 
+#include "chpl-align.h"
 #include "chpl-comm.h"
 #include "chpl-env.h"
 #include "chpl-linefile-support.h"
@@ -55,7 +58,24 @@ unsigned CHPL_JE_LG_ARENA;
 #define USE_JE_CHUNK_HOOKS
 #endif
 
-enum heap_type {FIXED, DYNAMIC, NONE};
+// FIXED and DYNAMIC heaps come from the comm layer.  A MAPPED heap is one
+// we mmap ourselves, so that we can choose its page size and NUMA policy
+// when the comm layer has no registered heap to offer.
+enum heap_type {FIXED, DYNAMIC, MAPPED, NONE};
+
+// Page size for a MAPPED heap (CHPL_RT_HEAP_PAGES): transparent huge
+// pages, or explicit (hugetlbfs) 2MB or 1GB pages.
+enum heap_pages {PAGES_DEFAULT, PAGES_THP, PAGES_2M, PAGES_1G};
+static enum heap_pages heap_pages = PAGES_DEFAULT;
+
+// NUMA placement for a MAPPED heap (CHPL_RT_HEAP_NUMA_POLICY): leave it to
+// first touch, bind each chunk to the allocating thread's NUMA domain, or
+// interleave every chunk across all NUMA domains.
+enum heap_numa {NUMA_FIRST_TOUCH, NUMA_LOCAL, NUMA_INTERLEAVE};
+static enum heap_numa heap_numa = NUMA_FIRST_TOUCH;
+
+// minimum size of each mapping we add to a MAPPED heap
+static size_t mapped_region_size;
 
 static struct shared_heap {
   enum heap_type type;
@@ -85,6 +105,55 @@ static inline void* alignHelper(void* base_ptr, size_t offset, size_t alignment)
 #ifdef USE_JE_CHUNK_HOOKS
 
 
+// Page size backing a MAPPED heap.
+static size_t mapped_page_size(void) {
+  switch (heap_pages) {
+  case PAGES_2M: return (size_t) 1 << 21;
+  case PAGES_1G: return (size_t) 1 << 30;
+  default:       return chpl_getSysPageSize();
+  }
+}
+
+
+// Map a new region for a MAPPED heap.  The size is rounded up to the heap
+// page size and passed back.  If explicit huge pages can't be had (none
+// reserved, or no kernel support) we say so once and fall back to
+// transparent huge pages for the rest of the run.
+static void* map_heap_region(size_t* size) {
+  void* p;
+  int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+
+  *size = round_up_to_mask(*size, mapped_page_size() - 1);
+
+#if defined(MAP_HUGETLB) && defined(MAP_HUGE_SHIFT)
+  if (heap_pages == PAGES_2M) {
+    flags |= MAP_HUGETLB | (21 << MAP_HUGE_SHIFT);
+  } else if (heap_pages == PAGES_1G) {
+    flags |= MAP_HUGETLB | (30 << MAP_HUGE_SHIFT);
+  }
+#endif
+
+  p = mmap(NULL, *size, PROT_READ | PROT_WRITE, flags, -1, 0);
+  if (p == MAP_FAILED) {
+    if (heap_pages != PAGES_2M && heap_pages != PAGES_1G) {
+      return NULL;
+    }
+    chpl_warning("could not map explicit huge pages for the heap, "
+                 "using transparent huge pages instead", 0, 0);
+    heap_pages = PAGES_THP;
+    return map_heap_region(size);
+  }
+
+#ifdef MADV_HUGEPAGE
+  if (heap_pages == PAGES_THP) {
+    (void) madvise(p, *size, MADV_HUGEPAGE);
+  }
+#endif
+
+  return p;
+}
+
+
 // Our chunk replacement hook for allocations (Essentially a replacement for
 // mmap/sbrk.) Grab memory out of the fixed shared heap or get an extension
 // chunk, and give it to jemalloc.
@@ -171,12 +240,65 @@ static void* chunk_alloc(void *chunk, size_t size, size_t alignment, bool *zero,
     heap.base = cur_chunk_base;
     heap.size = size;
     heap.cur_offset = 0;
+  } else if (heap.type == MAPPED) {
+    //
+    // Carve chunks out of our current mapping, adding a new one when it
+    // runs out.  We never give memory back, so every chunk comes out of
+    // fresh anonymous memory and is already zeroed.
+    //
+    size_t cur_heap_size;
+
+    if (chunk != NULL) {
+      return NULL;
+    }
+
+    pthread_mutex_lock(&heap.alloc_lock);
+
+    cur_chunk_base = alignHelper(heap.base, heap.cur_offset, alignment);
+    cur_heap_size = (uintptr_t)cur_chunk_base - (uintptr_t)heap.base;
+
+    if (heap.base == NULL || cur_heap_size > heap.size
+        || size > heap.size - cur_heap_size) {
+      // The tail of the old mapping is abandoned; it is always smaller
+      // than the chunk we couldn't fit into it.
+      size_t region_size = size + alignment;
+      void* region;
+
+      if (region_size < mapped_region_size) {
+        region_size = mapped_region_size;
+      }
+      if ((region = map_heap_region(&region_size)) == NULL) {
+        pthread_mutex_unlock(&heap.alloc_lock);
+        return NULL;
+      }
+
+      heap.base = region;
+      heap.size = region_size;
+      cur_chunk_base = alignHelper(heap.base, 0, alignment);
+      cur_heap_size = (uintptr_t)cur_chunk_base - (uintptr_t)heap.base;
+    }
+
+    heap.cur_offset = cur_heap_size + size;
+
+    pthread_mutex_unlock(&heap.alloc_lock);
+
+    if (heap_numa == NUMA_INTERLEAVE
+        || (interleave_mem && arena_ind == CHPL_JE_LG_ARENA)) {
+      chpl_topo_interleaveMemLocality(cur_chunk_base, size);
+    } else if (heap_numa == NUMA_LOCAL) {
+      c_sublocid_t subloc = chpl_topo_getThreadLocality();
+      if (isActualSublocID(subloc)) {
+        chpl_topo_setMemLocality(cur_chunk_base, size, true, subloc);
+      }
+    }
+
+    *zero = true;
   } else {
     chpl_internal_error("Invalid heap.type in chunk_alloc");
   }
 
   // jemalloc 4.5.0 man: "Zeroing is mandatory if *zero is true upon entry."
-  if (*zero) {
+  if (*zero && heap.type != MAPPED) {
     memset(cur_chunk_base, 0, size);
   }
 
@@ -397,11 +519,55 @@ static void initializeSharedHeap(void) {
   useUpMemNotInHeap();
 }
 
+// No special heap: just do a first allocation to let jemalloc set up.
+static void initializeNoHeap(void) {
+  void* p;
+  heap.type = NONE;
+  if ((p = CHPL_JE_MALLOCX(1, MALLOCX_NO_FLAGS)) == NULL) {
+    chpl_internal_error("cannot init heap: chpl_je_malloc() failed");
+  }
+  CHPL_JE_DALLOCX(p, MALLOCX_NO_FLAGS);
+}
+
+static void getMappedHeapSettings(void) {
+  const char* s;
+
+  if ((s = chpl_env_rt_get("HEAP_PAGES", NULL)) != NULL) {
+    if (strcasecmp(s, "thp") == 0) {
+      heap_pages = PAGES_THP;
+    } else if (strcasecmp(s, "2m") == 0) {
+      heap_pages = PAGES_2M;
+    } else if (strcasecmp(s, "1g") == 0) {
+      heap_pages = PAGES_1G;
+    } else if (strcasecmp(s, "default") != 0) {
+      char msg[128];
+      snprintf(msg, sizeof(msg),
+               "CHPL_RT_HEAP_PAGES=\"%s\" is not valid; ignoring it", s);
+      chpl_warning(msg, 0, 0);
+    }
+  }
+
+  if ((s = chpl_env_rt_get("HEAP_NUMA_POLICY", NULL)) != NULL) {
+    if (strcasecmp(s, "local") == 0) {
+      heap_numa = NUMA_LOCAL;
+    } else if (strcasecmp(s, "interleave") == 0) {
+      heap_numa = NUMA_INTERLEAVE;
+    } else if (strcasecmp(s, "first-touch") != 0) {
+      char msg[128];
+      snprintf(msg, sizeof(msg),
+               "CHPL_RT_HEAP_NUMA_POLICY=\"%s\" is not valid; ignoring it",
+               s);
+      chpl_warning(msg, 0, 0);
+    }
+  }
+}
+
 void chpl_mem_layerInit(void) {
   void* heap_base;
   size_t heap_size;
 
   interleave_mem = chpl_env_rt_get_bool("INTERLEAVE_MEMORY", CHPL_INTERLEAVE_MEM);
+  getMappedHeapSettings();
   CHPL_JE_LG_ARENA = get_num_arenas()-1;
 
   chpl_comm_regMemHeapInfo(&heap_base, &heap_size);
@@ -435,19 +601,50 @@ void chpl_mem_layerInit(void) {
     // regions, which our comm layers may not support.
     merge_split_chunks = chpl_env_rt_get_bool("MERGE_SPLIT_CHUNKS", false);
     initializeSharedHeap();
-  } else {
-    void* p;
-    heap.type = NONE;
-    if ((p = CHPL_JE_MALLOCX(1, MALLOCX_NO_FLAGS)) == NULL) {
-      chpl_internal_error("cannot init heap: chpl_je_malloc() failed");
+  } else if (heap_pages != PAGES_DEFAULT || heap_numa != NUMA_FIRST_TOUCH) {
+#ifdef USE_JE_CHUNK_HOOKS
+    heap.type = MAPPED;
+    // We never unmap anything, so merging/splitting across our separate
+    // mappings is safe
+    merge_split_chunks = chpl_env_rt_get_bool("MERGE_SPLIT_CHUNKS", true);
+    heap.base = NULL;
+    heap.size = 0;
+    heap.cur_offset = 0;
+    mapped_region_size = chpl_env_rt_get_size("HEAP_REGION_SIZE",
+                                              (size_t) 64 << 20);
+    if (mapped_region_size < mapped_page_size()) {
+      mapped_region_size = mapped_page_size();
     }
-    CHPL_JE_DALLOCX(p, MALLOCX_NO_FLAGS);
+    if (pthread_mutex_init(&heap.alloc_lock, NULL) != 0) {
+      chpl_internal_error("cannot init chunk_alloc lock");
+    }
+    initializeSharedHeap();
+#else
+    chpl_warning("CHPL_RT_HEAP_PAGES and CHPL_RT_HEAP_NUMA_POLICY need "
+                 "jemalloc >= 4.1; ignoring them", 0, 0);
+    heap_pages = PAGES_DEFAULT;
+    heap_numa = NUMA_FIRST_TOUCH;
+    initializeNoHeap();
+#endif
+  } else {
+    initializeNoHeap();
   }
 }
 
 
+size_t chpl_mem_layerHeapPageSize(void) {
+  // Only explicit huge pages change what mprotect() and friends can work
+  // with; transparent huge pages can still be split.
+  if (heap.type == MAPPED
+      && (heap_pages == PAGES_2M || heap_pages == PAGES_1G)) {
+    return mapped_page_size();
+  }
+  return 0;
+}
+
+
 void chpl_mem_layerExit(void) {
-  if (heap.type == FIXED) {
+  if (heap.type == FIXED || heap.type == MAPPED) {
     // ignore errors, we're exiting anyways
     (void) pthread_mutex_destroy(&heap.alloc_lock);
   }
@@ -25,6 +25,84 @@
 
 #include "bulkget.h"
 
+// Transfers larger than this are split up, so that several pieces can
+// be in flight at once.
+#define BULK_XFER_CHUNK (1024*1024)
+#define BULK_XFER_MAX_NB 8
+
+// How much qio_channel_read_to_remote asks the channel to buffer at once.
+#define BULK_READ_CHUNK (8*1024*1024)
+
+typedef struct bulk_xfer_s {
+  int64_t node;
+  int put;
+  chpl_comm_nb_handle_t handles[BULK_XFER_MAX_NB];
+  size_t nhandles;
+} bulk_xfer_t;
+
+static
+void bulk_xfer_init(bulk_xfer_t* x, int64_t node, int put)
+{
+  x->node = node;
+  x->put = put;
+  x->nhandles = 0;
+}
+
+static
+void bulk_xfer_wait(bulk_xfer_t* x)
+{
+  if( x->nhandles > 0 ) {
+    chpl_comm_wait_nb_some(x->handles, x->nhandles);
+    x->nhandles = 0;
+  }
+}
+
+// Start copying len bytes between local and remote (on x->node), in
+// the direction given by x->put. Neither buffer may be touched until
+// bulk_xfer_wait returns.
+static
+void bulk_xfer_start(bulk_xfer_t* x, void* local, void* remote, size_t len)
+{
+  int use_nb = (x->node != chpl_nodeID);
+
+#ifdef HAS_CHPL_CACHE_FNS
+  // Go through the remote cache when it's on, so that we see (and
+  // don't overtake) anything it is holding for these addresses.
+  if( chpl_cache_enabled() ) use_nb = 0;
+#endif
+
+  if( ! use_nb ) {
+    if( x->put ) {
+      chpl_gen_comm_put(local, x->node, remote, len,
+                        CHPL_COMM_UNKNOWN_ID, -1, CHPL_FILE_IDX_INTERNAL);
+    } else {
+      chpl_gen_comm_get(local, x->node, remote, len,
+                        CHPL_COMM_UNKNOWN_ID, -1, CHPL_FILE_IDX_INTERNAL);
+    }
+    return;
+  }
+
+  while( len > 0 ) {
+    size_t amt = (len > BULK_XFER_CHUNK) ? BULK_XFER_CHUNK : len;
+
+    if( x->nhandles == BULK_XFER_MAX_NB ) bulk_xfer_wait(x);
+
+    if( x->put ) {
+      x->handles[x->nhandles++] =
+          chpl_comm_put_nb(local, x->node, remote, amt,
+                           CHPL_COMM_UNKNOWN_ID, -1, CHPL_FILE_IDX_INTERNAL);
+    } else {
+      x->handles[x->nhandles++] =
+          chpl_comm_get_nb(local, x->node, remote, amt,
+                           CHPL_COMM_UNKNOWN_ID, -1, CHPL_FILE_IDX_INTERNAL);
+    }
+
+    local = PTR_ADDBYTES(local, amt);
+    remote = PTR_ADDBYTES(remote, amt);
+    len -= amt;
+  }
+}
+
 // The initial ref count in the return qbytes buffer is 1.
 // The caller is responsible for calling qbytes_release on it when done.
 qbytes_t* bulk_get_bytes(int64_t src_locale, qbytes_t* src_addr)
@@ -53,15 +131,38 @@ qbytes_t* bulk_get_bytes(int64_t src_locale, qbytes_t* src_addr)
 
   // Next, get the data itself.
   if( src_data ) {
-    chpl_gen_comm_get(ret->data, src_locale, src_data,
-                      sizeof(uint8_t) * src_len,
-                      CHPL_COMM_UNKNOWN_ID, -1, CHPL_FILE_IDX_INTERNAL);
+    bulk_xfer_t x;
+    bulk_xfer_init(&x, src_locale, 0);
+    bulk_xfer_start(&x, ret->data, src_data, sizeof(uint8_t) * src_len);
+    bulk_xfer_wait(&x);
   }
 
   // Great! All done.
   return ret;
 }
 
+qioerr bulk_get_bytes_into(int64_t src_locale, qbytes_t* src_addr,
+                           int64_t src_offset, void* dst, int64_t len)
+{
+  qbytes_t tmp;
+  bulk_xfer_t x;
+
+  memset(&tmp, 0, sizeof(qbytes_t));
+
+  chpl_gen_comm_get(&tmp, src_locale, src_addr, sizeof(qbytes_t),
+                    CHPL_COMM_UNKNOWN_ID, -1, CHPL_FILE_IDX_INTERNAL);
+
+  if( src_offset < 0 || len < 0 || src_offset + len > tmp.len ) {
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "range outside of bytes");
+  }
+  if( len == 0 ) return 0;
+
+  bulk_xfer_init(&x, src_locale, 0);
+  bulk_xfer_start(&x, dst, PTR_ADDBYTES(tmp.data, src_offset), len);
+  bulk_xfer_wait(&x);
+  return 0;
+}
+
 qioerr bulk_put_buffer(int64_t dst_locale, void* dst_addr, int64_t dst_len,
                       qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end)
 {
@@ -71,6 +172,7 @@ qioerr bulk_put_buffer(int64_t dst_locale, void* dst_addr, int64_t dst_len,
   size_t iovcnt;
   size_t i,j;
   MAYBE_STACK_SPACE(struct iovec, iov_onstack);
+  bulk_xfer_t x;
   qioerr err;
 
   if( num_bytes < 0 || num_parts < 0 || start.offset < buf->offset_start || end.offset > buf->offset_end )  QIO_RETURN_CONSTANT_ERROR(EINVAL, "range outside of buffer");
@@ -81,29 +183,78 @@ qioerr bulk_put_buffer(int64_t dst_locale, void* dst_addr, int64_t dst_len,
   err = qbuffer_to_iov(buf, start, end, num_parts, iov, NULL, &iovcnt);
   if( err ) goto error;
 
+  // Start all of the PUTs, then wait for them; iov points into buf,
+  // which the caller is holding on to.
+  bulk_xfer_init(&x, dst_locale, 1);
   j = 0;
   for( i = 0; i < iovcnt; i++ ) {
-    if( j + iov[i].iov_len > dst_len ) goto error_nospace;
-    //chpl_memcpy(PTR_ADDBYTES(ptr, j), iov[i].iov_base, iov[i].iov_len);
+    if( j + iov[i].iov_len > dst_len ) {
+      bulk_xfer_wait(&x);
+      QIO_GET_CONSTANT_ERROR(err, EMSGSIZE, "no space in buffer");
+      goto error;
+    }
 
-    // TODO -- note -- technically, this should be gasnet_put_bulk,
-    // since we don't want to require src/dst to have a particular alignment.
-    chpl_gen_comm_put( iov[i].iov_base,
-                       dst_locale,
-                       PTR_ADDBYTES(dst_addr, j),
-                       sizeof(uint8_t)*iov[i].iov_len,
-                       CHPL_COMM_UNKNOWN_ID, -1, CHPL_FILE_IDX_INTERNAL);
+    bulk_xfer_start(&x, iov[i].iov_base, PTR_ADDBYTES(dst_addr, j),
+                    sizeof(uint8_t)*iov[i].iov_len);
 
     j += iov[i].iov_len;
   }
+  bulk_xfer_wait(&x);
 
   MAYBE_STACK_FREE(iov, iov_onstack);
   return 0;
 
-error_nospace:
-  QIO_RETURN_CONSTANT_ERROR(EMSGSIZE, "no space in buffer");
 error:
   MAYBE_STACK_FREE(iov, iov_onstack);
   return err;
 }
 
+qioerr qio_channel_read_to_remote(const int threadsafe, qio_channel_t* ch,
+                                  int64_t dst_locale, void* dst_addr,
+                                  int64_t len, int64_t* amt_read)
+{
+  qioerr err = 0;
+  int64_t done = 0;
+
+  while( done < len ) {
+    int64_t want = len - done;
+    int64_t n;
+    qbuffer_t* buf;
+    qbuffer_iter_t start, end;
+
+    if( want > BULK_READ_CHUNK ) want = BULK_READ_CHUNK;
+
+    err = qio_channel_begin_peek_buffer(threadsafe, ch, want, 0,
+                                        &buf, &start, &end);
+    if( qio_err_to_int(err) == EEOF ) {
+      // Near the end of the file; take whatever is left.
+      err = qio_channel_begin_peek_buffer(threadsafe, ch, 0, 0,
+                                          &buf, &start, &end);
+    }
+    if( err ) break;
+
+    n = qbuffer_iter_num_bytes(start, end);
+    if( n > len - done ) n = len - done;
+    if( n <= 0 ) {
+      qio_channel_end_peek_buffer(threadsafe, ch, 0);
+      err = QIO_EEOF;
+      break;
+    }
+
+    end = start;
+    qbuffer_iter_advance(buf, &end, n);
+    err = bulk_put_buffer(dst_locale, PTR_ADDBYTES(dst_addr, done), n,
+                          buf, start, end);
+    if( err ) {
+      qio_channel_end_peek_buffer(threadsafe, ch, 0);
+      break;
+    }
+
+    err = qio_channel_end_peek_buffer(threadsafe, ch, n);
+    done += n;
+    if( err ) break;
+  }
+
+  *amt_read = done;
+  return err;
+}
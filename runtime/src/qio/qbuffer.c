@@ -29,8 +29,14 @@
 #include "error.h"
 
 #include "sys.h"
+#include "chpl-thread-local-storage.h"
+
+#ifndef CHPL_RT_UNIT_TEST
+#include "chpl-env.h"
+#endif
 
 #include <limits.h>
+#include <pthread.h>
 #include <sys/mman.h>
 
 #include <ctype.h>
@@ -56,7 +62,7 @@ void _qbytes_free_qbytes(qbytes_t* b)
   b->len = 0;
   b->free_function = NULL;
   DO_DESTROY_REFCNT(b);
-  qio_free(b);
+  qio_small_free(b);
 }
 
 void qbytes_free_null(qbytes_t* b) {
@@ -91,6 +97,98 @@ void qbytes_free_iobuf(qbytes_t* b) {
   qbytes_free_qio_free(b);
 }
 
+// Per-thread pools of iobufs made by qbytes_create_iobuf, so that
+// channels that come and go quickly don't allocate a new one each time.
+// A pooled iobuf keeps its qbytes_t, and the free list is threaded
+// through the first bytes of the data. An iobuf can be released on a
+// different thread than the one that created it; it just goes into that
+// thread's pool. CHPL_RT_QIO_IOBUF_POOL_SIZE sets how many each thread
+// keeps (0 turns pooling off).
+
+typedef struct qbytes_pool_s {
+  qbytes_t* head;
+  int64_t count;
+} qbytes_pool_t;
+
+static pthread_once_t qbytes_pool_once = PTHREAD_ONCE_INIT;
+static int64_t qbytes_pool_max = 0;
+CHPL_TLS_DECL(qbytes_pool_t*, qbytes_thread_pool);
+static pthread_key_t qbytes_pool_destructor_key;  // set but never read
+
+static
+void qbytes_pool_destroy(void* arg)
+{
+  qbytes_pool_t* pool = (qbytes_pool_t*) arg;
+  qbytes_t* b = pool->head;
+
+  while( b ) {
+    qbytes_t* next = *(qbytes_t**) b->data;
+    qbytes_free_iobuf(b);
+    b = next;
+  }
+
+  qio_free(pool);
+}
+
+static
+void qbytes_pool_init(void)
+{
+  const int64_t dflt = 16;
+
+#ifdef CHPL_RT_UNIT_TEST
+  qbytes_pool_max = dflt;
+#else
+  qbytes_pool_max = chpl_env_rt_get_int("QIO_IOBUF_POOL_SIZE", dflt);
+#endif
+
+  if( qbytes_pool_max > 0 ) {
+    CHPL_TLS_INIT(qbytes_thread_pool);
+    if( pthread_key_create(&qbytes_pool_destructor_key, qbytes_pool_destroy) != 0 ) {
+      qbytes_pool_max = 0;
+    }
+  }
+}
+
+// returns NULL if pooling is off
+static
+qbytes_pool_t* qbytes_get_thread_pool(void)
+{
+  qbytes_pool_t* pool;
+
+  pthread_once(&qbytes_pool_once, qbytes_pool_init);
+  if( qbytes_pool_max <= 0 ) return NULL;
+
+  pool = (qbytes_pool_t*) CHPL_TLS_GET(qbytes_thread_pool);
+  if( pool == NULL ) {
+    pool = (qbytes_pool_t*) qio_calloc(1, sizeof(qbytes_pool_t));
+    if( pool == NULL ) return NULL;
+    CHPL_TLS_SET(qbytes_thread_pool, pool);
+    (void) pthread_setspecific(qbytes_pool_destructor_key, pool);
+  }
+
+  return pool;
+}
+
+static
+void qbytes_free_pooled_iobuf(qbytes_t* b)
+{
+  qbytes_pool_t* pool;
+
+  // qbytes_iobuf_size can change (in testing), and then old iobufs
+  // aren't worth keeping.
+  if( (size_t) b->len == qbytes_iobuf_size &&
+      b->len >= (int64_t) sizeof(qbytes_t*) &&
+      (pool = qbytes_get_thread_pool()) != NULL &&
+      pool->count < qbytes_pool_max ) {
+    *(qbytes_t**) b->data = pool->head;
+    pool->head = b;
+    pool->count++;
+    return;
+  }
+
+  qbytes_free_iobuf(b);
+}
+
 void debug_print_bytes(qbytes_t* b)
 {
   fprintf(stderr, "bytes %p: data=%p len=%lli ref_cnt=%" PRIu64 " free_function=%p flags=%i\n",
@@ -131,7 +229,7 @@ qioerr qbytes_create_generic(qbytes_t** out, void* give_data, int64_t len, qbyte
 {
   qbytes_t* ret = NULL;
 
-  ret = (qbytes_t*) qio_calloc(1, sizeof(qbytes_t));
+  ret = (qbytes_t*) qio_small_calloc(sizeof(qbytes_t));
   if( ! ret ) return QIO_ENOMEM;
 
   // On return the ref count is 1.
@@ -167,12 +265,33 @@ qioerr _qbytes_init_iobuf(qbytes_t* ret)
 }
 
 
-qioerr qbytes_create_iobuf(qbytes_t** out)
+static
+qioerr qbytes_create_iobuf_common(qbytes_t** out, int zero)
 {
   qbytes_t* ret = NULL;
+  qbytes_pool_t* pool;
   qioerr err;
 
-  ret = (qbytes_t*) qio_calloc(1, sizeof(qbytes_t));
+  // Reuse a pooled iobuf if there is one of the right size.
+  pool = qbytes_get_thread_pool();
+  while( pool && pool->head ) {
+    ret = pool->head;
+    pool->head = *(qbytes_t**) ret->data;
+    pool->count--;
+    if( (size_t) ret->len == qbytes_iobuf_size ) {
+      // Only clear a reused iobuf when the caller needs zeroed
+      // memory; otherwise just drop the free list link.
+      if( zero ) memset(ret->data, 0, ret->len);
+      else *(qbytes_t**) ret->data = NULL;
+      DO_DESTROY_REFCNT(ret);
+      _qbytes_init_generic(ret, ret->data, ret->len, qbytes_free_pooled_iobuf);
+      *out = ret;
+      return 0;
+    }
+    qbytes_free_iobuf(ret);
+  }
+
+  ret = (qbytes_t*) qio_small_calloc(sizeof(qbytes_t));
   if( ! ret ) {
     *out = NULL;
     return QIO_ENOMEM;
@@ -180,15 +299,26 @@ qioerr qbytes_create_iobuf(qbytes_t** out)
 
   err = _qbytes_init_iobuf(ret);
   if( err ) {
-    qio_free(ret);
+    qio_small_free(ret);
     *out = NULL;
     return err;
   }
+  ret->free_function = qbytes_free_pooled_iobuf;
 
   *out = ret;
   return 0;
 }
 
+qioerr qbytes_create_iobuf(qbytes_t** out)
+{
+  return qbytes_create_iobuf_common(out, 1);
+}
+
+qioerr qbytes_create_iobuf_uninit(qbytes_t** out)
+{
+  return qbytes_create_iobuf_common(out, 0);
+}
+
 /*
 qioerr _qbytes_init_calloc(qbytes_t* ret, int64_t len)
 {
@@ -211,7 +341,7 @@ qioerr qbytes_create_calloc(qbytes_t** out, int64_t len)
   qbytes_t* ret = NULL;
   void* data;
 
-  ret = (qbytes_t*) qio_calloc(1, sizeof(qbytes_t) + len);
+  ret = (qbytes_t*) qio_small_calloc(sizeof(qbytes_t) + len);
   if( ! ret ) {
     *out = NULL;
     return QIO_ENOMEM;
@@ -720,10 +850,46 @@ void qbuffer_iter_ceil_part(qbuffer_t* buf, qbuffer_iter_t* iter)
 
 /* Advances an iterator using linear search.
  */
+// Advancing an iterator looks at this many parts one at a time before
+// switching to a binary search, so short moves stay cheap but long
+// ones don't walk every part in between.
+#define QBUFFER_ADVANCE_LINEAR_PARTS 8
+
+// Returns the first part in [first, last) with end_offset > offset,
+// or last if there isn't one. The parts' end offsets increase, so this
+// is a binary search.
+static
+deque_iterator_t _qbuffer_find_part(deque_iterator_t first, deque_iterator_t last, int64_t offset)
+{
+  deque_iterator_t middle;
+  qbuffer_part_t* qbp;
+  ssize_t num_parts = deque_it_difference(sizeof(qbuffer_part_t), last, first);
+  ssize_t half;
+
+  while( num_parts > 0 ) {
+    half = num_parts >> 1;
+    middle = first;
+
+    deque_it_forward_n(sizeof(qbuffer_part_t), &middle, half);
+
+    qbp = (qbuffer_part_t*) deque_it_get_cur_ptr(sizeof(qbuffer_part_t), middle);
+    if( offset < qbp->end_offset ) {
+      num_parts = half;
+    } else {
+      first = middle;
+      deque_it_forward_one(sizeof(qbuffer_part_t), &first);
+      num_parts = num_parts - half - 1;
+    }
+  }
+
+  return first;
+}
+
 void qbuffer_iter_advance(qbuffer_t* buf, qbuffer_iter_t* iter, int64_t amt)
 {
   deque_iterator_t d_begin = deque_begin( & buf->deque );
   deque_iterator_t d_end = deque_end( & buf->deque );
+  int steps = 0;
 
   if( amt >= 0 ) {
     // forward search.
@@ -734,6 +900,12 @@ void qbuffer_iter_advance(qbuffer_t* buf, qbuffer_iter_t* iter, int64_t amt)
         // it's in this one.
         return;
       }
+      if( ++steps == QBUFFER_ADVANCE_LINEAR_PARTS ) {
+        // it's farther away; search the rest.
+        iter->iter = _qbuffer_find_part(iter->iter, d_end, iter->offset);
+        if( ! deque_it_equals(iter->iter, d_end) ) return;
+        break;
+      }
       deque_it_forward_one(sizeof(qbuffer_part_t), & iter->iter);
     }
     // If we get here, we didn't find it. Return the buffer end.
@@ -751,10 +923,22 @@ void qbuffer_iter_advance(qbuffer_t* buf, qbuffer_iter_t* iter, int64_t amt)
       }
     }
 
-    // now we have a valid deque element.
-    do {
+    while( ! deque_it_equals(iter->iter, d_begin) ) {
       qbuffer_part_t* qbp;
 
+      if( ++steps == QBUFFER_ADVANCE_LINEAR_PARTS ) {
+        // it's farther away; search everything before here.
+        deque_iterator_t found = _qbuffer_find_part(d_begin, iter->iter, iter->offset);
+        if( ! deque_it_equals(found, iter->iter) ) {
+          qbp = (qbuffer_part_t*) deque_it_get_cur_ptr(sizeof(qbuffer_part_t), found);
+          if( iter->offset >= qbp->end_offset - qbp->len_bytes ) {
+            iter->iter = found;
+            return;
+          }
+        }
+        break;
+      }
+
       deque_it_back_one(sizeof(qbuffer_part_t), & iter->iter);
 
       qbp = (qbuffer_part_t*) deque_it_get_cur_ptr(sizeof(qbuffer_part_t), iter->iter);
@@ -762,43 +946,20 @@ void qbuffer_iter_advance(qbuffer_t* buf, qbuffer_iter_t* iter, int64_t amt)
         // it's in this one.
         return;
       }
-    } while( ! deque_it_equals(iter->iter, d_begin) );
+    }
     // If we get here, we didn't find it. Return the buffer start.
     *iter = qbuffer_begin(buf);
   }
 }
 
-
-
-
-// find buffer iterator part in logarithmic time
-// finds an offset in the window [offset_start,offset_end]
-// (in other words, offset might not start at 0)
 qbuffer_iter_t qbuffer_iter_at(qbuffer_t* buf, int64_t offset)
 {
   qbuffer_iter_t ret;
-  deque_iterator_t first = deque_begin(& buf->deque);
+  deque_iterator_t first;
   deque_iterator_t last = deque_end(& buf->deque);
-  deque_iterator_t middle;
   qbuffer_part_t* qbp;
-  ssize_t num_parts = deque_it_difference(sizeof(qbuffer_part_t), last, first);
-  ssize_t half;
-
-  while( num_parts > 0 ) {
-    half = num_parts >> 1;
-    middle = first;
 
-    deque_it_forward_n(sizeof(qbuffer_part_t), &middle, half);
-
-    qbp = (qbuffer_part_t*) deque_it_get_cur_ptr(sizeof(qbuffer_part_t), middle);
-    if( offset < qbp->end_offset ) {
-      num_parts = half;
-    } else {
-      first = middle;
-      deque_it_forward_one(sizeof(qbuffer_part_t), &first);
-      num_parts = num_parts - half - 1;
-    }
-  }
+  first = _qbuffer_find_part(deque_begin(& buf->deque), last, offset);
 
   if( deque_it_equals(first, last) ) {
     ret = qbuffer_end(buf);
@@ -34,6 +34,7 @@
 
 #ifndef CHPL_RT_UNIT_TEST
 #include "chplrt.h"
+#include "chpl-env.h"
 #endif
 
 #include "qio.h"
@@ -58,6 +59,7 @@
 #include <sys/stat.h>
 
 #include <assert.h>
+#include <pthread.h>
 
 // Default to using close-on-exec for systems that support it.
 #ifdef O_CLOEXEC
@@ -104,6 +106,16 @@ ssize_t qio_write_unbuffered_threshold = 32*1024;
 // can avoid buffering by calling pread/fread/read directly
 ssize_t qio_read_unbuffered_threshold = 32*1024;
 
+// Use io_uring instead of pread/pwrite when choosing a method for a
+// seekable file.  When it's -1 we haven't read CHPL_RT_QIO_IO_URING yet.
+static int qio_iouring_by_default = -1;
+
+// Write-behind settings; see qio_wb_init().  When qio_write_behind_by_default
+// is -1 we haven't read CHPL_RT_QIO_WRITE_BEHIND yet.
+static int qio_write_behind_by_default = -1;
+static int64_t qio_write_behind_max_bytes = 64*1024*1024;
+static int qio_write_behind_fsync = 0;
+
 #ifdef _chplrt_H_
 qioerr qio_lock(qio_lock_t* x) {
   // recursive mutex based on glibc pthreads implementation
@@ -149,6 +161,47 @@ void qio_unlock(qio_lock_t* x) {
 #include "qio_plugin_api_dummy.c"
 #endif
 
+// Lets other tasks run while we wait for the write-behind thread or a
+// non-blocking socket.
+#ifdef CHPL_RT_UNIT_TEST
+#include <sched.h>
+#define qio_yield() sched_yield()
+#else
+#define qio_yield() chpl_task_yield()
+#endif
+
+// Returns true if 'rc' is from an operation that would have blocked on a
+// file with a non-blocking descriptor, such as a pipe to a subprocess.
+static inline
+bool qio_file_would_block(qio_file_t* file, qio_err_t rc)
+{
+  return (file->fdflags & QIO_FDFLAG_NONBLOCKING) &&
+         (rc == EAGAIN || rc == EWOULDBLOCK);
+}
+
+// These wrap the sys_ calls for QIO_METHOD_READWRITE. On a non-blocking
+// descriptor, they yield to other tasks until the call can make progress
+// instead of tying up the worker thread in the kernel.
+static
+qioerr qio_file_read(qio_file_t* file, void* ptr, size_t len, ssize_t* num_read)
+{
+  qio_err_t rc;
+  while( qio_file_would_block(file, rc = sys_read(file->fd, ptr, len, num_read)) ) {
+    qio_yield();
+  }
+  return qio_int_to_err(rc);
+}
+
+static
+qioerr qio_file_write(qio_file_t* file, const void* ptr, size_t len, ssize_t* num_written)
+{
+  qio_err_t rc;
+  while( qio_file_would_block(file, rc = sys_write(file->fd, ptr, len, num_written)) ) {
+    qio_yield();
+  }
+  return qio_int_to_err(rc);
+}
+
 qioerr qio_readv(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, ssize_t* num_read)
 {
   ssize_t nread = 0;
@@ -175,9 +228,13 @@ qioerr qio_readv(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer
   if( err ) goto error;
 
   // read into our buffer.
-  if (file->fd != -1)
-    err = qio_int_to_err(sys_readv(file->fd, iov, iovcnt, &nread));
-  else
+  if (file->fd != -1) {
+    qio_err_t rc;
+    while( qio_file_would_block(file, rc = sys_readv(file->fd, iov, iovcnt, &nread)) ) {
+      qio_yield();
+    }
+    err = qio_int_to_err(rc);
+  } else
     QIO_RETURN_CONSTANT_ERROR(EINVAL, "invalid file descriptor");
 
 error:
@@ -216,9 +273,13 @@ qioerr qio_writev(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffe
   if( err ) goto error;
 
   // write from our buffer
-  if (file->fd != -1)
-    err = qio_int_to_err(sys_writev(file->fd, iov, iovcnt, &nwritten));
-  else
+  if (file->fd != -1) {
+    qio_err_t rc;
+    while( qio_file_would_block(file, rc = sys_writev(file->fd, iov, iovcnt, &nwritten)) ) {
+      qio_yield();
+    }
+    err = qio_int_to_err(rc);
+  } else
     QIO_RETURN_CONSTANT_ERROR(EINVAL, "invalid file descriptor");
 
 error:
@@ -231,7 +292,200 @@ error:
   return err;
 }
 
-qioerr qio_preadv(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_read)
+// Support for QIO_METHOD_DIRECT.
+//
+// Data is moved with O_DIRECT through a second descriptor for the file,
+// so that the file's own descriptor is left as it was for other channels.
+// The parts of a request that O_DIRECT can't do -- an unaligned head or
+// tail, or a piece smaller than a block -- go through the file's own
+// descriptor and the page cache. Aligned parts in memory that isn't
+// aligned are copied through a pooled iobuf.
+#define QIO_DIRECT_ALIGN 4096
+
+#define QIO_DIRECT_FD_UNOPENED (-1)
+#define QIO_DIRECT_FD_UNAVAILABLE (-2)
+
+static pthread_mutex_t qio_direct_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static qio_err_t sys_open(const char* pathname, int flags, mode_t mode, fd_t* fd_out);
+
+// Returns the O_DIRECT descriptor for the file, or -1 if there isn't one.
+static
+fd_t qio_direct_fd(qio_file_t* file)
+{
+  fd_t fd;
+
+  pthread_mutex_lock(&qio_direct_lock);
+  if( file->direct_fd == QIO_DIRECT_FD_UNOPENED ) {
+    file->direct_fd = QIO_DIRECT_FD_UNAVAILABLE;
+#if defined(O_DIRECT) && defined(__linux__)
+    {
+      char path[64];
+      int flags = O_DIRECT | QIO_OCLOEXEC;
+      fd_t newfd = -1;
+
+      if( (file->fdflags & QIO_FDFLAG_READABLE) &&
+          (file->fdflags & QIO_FDFLAG_WRITEABLE) ) flags |= O_RDWR;
+      else if( file->fdflags & QIO_FDFLAG_WRITEABLE ) flags |= O_WRONLY;
+      else flags |= O_RDONLY;
+
+      // Opening the file again gives a descriptor with its own flags.
+      snprintf(path, sizeof(path), "/proc/self/fd/%i", (int) file->fd);
+      if( sys_open(path, flags, 0, &newfd) == 0 ) file->direct_fd = newfd;
+    }
+#endif
+  }
+  fd = file->direct_fd;
+  pthread_mutex_unlock(&qio_direct_lock);
+
+  return fd < 0 ? -1 : fd;
+}
+
+static
+int qio_direct_aligned(const void* ptr, int64_t n)
+{
+  return ((intptr_t) ptr) % QIO_DIRECT_ALIGN == 0 && n % QIO_DIRECT_ALIGN == 0;
+}
+
+// Reads or writes one piece of a request. Returns in *num_out how much
+// was transferred, which might be less than len.
+static
+qio_err_t qio_direct_transfer_piece(qio_file_t* file, fd_t dfd, int writing,
+                                    void* ptr, int64_t len, int64_t offset,
+                                    ssize_t* num_out)
+{
+  int64_t head = offset % QIO_DIRECT_ALIGN;
+  int64_t n;
+  qbytes_t* bounce = NULL;
+  ssize_t got = 0;
+  qio_err_t err;
+
+  if( dfd < 0 || head != 0 || len < QIO_DIRECT_ALIGN ) {
+    // Up to the next block boundary through the page cache.
+    n = head != 0 ? QIO_DIRECT_ALIGN - head : len;
+    if( n > len ) n = len;
+    return writing ?
+           sys_pwrite(file->fd, ptr, n, offset, num_out) :
+           sys_pread(file->fd, ptr, n, offset, num_out);
+  }
+
+  n = len - len % QIO_DIRECT_ALIGN;
+  if( qio_direct_aligned(ptr, 0) ) {
+    err = writing ?
+          sys_pwrite(dfd, ptr, n, offset, num_out) :
+          sys_pread(dfd, ptr, n, offset, num_out);
+  } else {
+    if( qbytes_create_iobuf_uninit(&bounce) != 0 ||
+        !qio_direct_aligned(bounce->data, bounce->len) ) {
+      if( bounce ) qbytes_release(bounce);
+      return writing ?
+             sys_pwrite(file->fd, ptr, n, offset, num_out) :
+             sys_pread(file->fd, ptr, n, offset, num_out);
+    }
+    if( n > bounce->len ) n = bounce->len;
+    if( writing ) {
+      qio_memcpy(bounce->data, ptr, n);
+      err = sys_pwrite(dfd, bounce->data, n, offset, &got);
+    } else {
+      err = sys_pread(dfd, bounce->data, n, offset, &got);
+      if( got > 0 ) qio_memcpy(ptr, bounce->data, got);
+    }
+    qbytes_release(bounce);
+    *num_out = got;
+  }
+
+  // The file system might want a larger alignment, or not support
+  // O_DIRECT at all; fall back to the page cache for this piece.
+  if( err == EINVAL ) {
+    err = writing ?
+          sys_pwrite(file->fd, ptr, n, offset, num_out) :
+          sys_pread(file->fd, ptr, n, offset, num_out);
+  }
+
+  return err;
+}
+
+// Like sys_preadv and sys_pwritev, but reads or writes with O_DIRECT
+// where the alignment allows it.
+static
+qio_err_t qio_direct_transfer(qio_file_t* file, int writing,
+                              const struct iovec* iov, int iovcnt,
+                              int64_t offset, ssize_t* num_out)
+{
+  fd_t dfd = qio_direct_fd(file);
+  ssize_t total = 0;
+  ssize_t got;
+  int64_t skip = 0;
+  int64_t len;
+  int i = 0;
+  int j;
+  qio_err_t err = 0;
+
+  while( i < iovcnt ) {
+    // Runs of whole aligned parts go to a single preadv/pwritev.
+    if( dfd >= 0 && skip == 0 && (offset + total) % QIO_DIRECT_ALIGN == 0 ) {
+      for( j = i;
+           j < iovcnt && qio_direct_aligned(iov[j].iov_base, iov[j].iov_len);
+           j++ ) ;
+      if( j > i ) {
+        got = 0;
+        err = writing ?
+              sys_pwritev(dfd, &iov[i], j - i, offset + total, &got) :
+              sys_preadv(dfd, &iov[i], j - i, offset + total, &got);
+        if( err == EINVAL ) {
+          // fall back for the whole request
+          dfd = -1;
+          err = 0;
+          continue;
+        }
+        total += got;
+        if( err || got < (ssize_t) sys_iov_total_bytes(&iov[i], j - i) ) break;
+        i = j;
+        continue;
+      }
+    }
+
+    len = iov[i].iov_len - skip;
+    got = 0;
+    err = qio_direct_transfer_piece(file, dfd, writing,
+                                    (char*) iov[i].iov_base + skip, len,
+                                    offset + total, &got);
+    total += got;
+    if( err || got == 0 ) break;
+    skip += got;
+    if( skip == (int64_t) iov[i].iov_len ) {
+      skip = 0;
+      i++;
+    }
+  }
+
+  // Like preadv, report reading nothing as EOF.
+  if( !writing && err == 0 && total == 0 &&
+      sys_iov_total_bytes(iov, iovcnt) != 0 ) {
+    err = EEOF;
+  }
+
+  *num_out = total;
+  return err;
+}
+
+static
+qio_err_t qio_direct_preadv_iov(qio_file_t* file, const struct iovec* iov,
+                                int iovcnt, int64_t offset, ssize_t* num_read)
+{
+  return qio_direct_transfer(file, 0, iov, iovcnt, offset, num_read);
+}
+
+static
+qio_err_t qio_direct_pwritev_iov(qio_file_t* file, const struct iovec* iov,
+                                 int iovcnt, int64_t offset,
+                                 ssize_t* num_written)
+{
+  return qio_direct_transfer(file, 1, iov, iovcnt, offset, num_written);
+}
+
+static
+qioerr _qio_preadv(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_read, qio_method_t method)
 {
   ssize_t nread = 0;
   int64_t num_bytes = qbuffer_iter_num_bytes(start, end);
@@ -258,7 +512,11 @@ qioerr qio_preadv(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffe
 
   // read into our buffer.
   if (file->fd != -1)
-    err = qio_int_to_err(sys_preadv(file->fd, iov, iovcnt, seek_to_offset, &nread));
+    err = qio_int_to_err(method == QIO_METHOD_DIRECT ?
+                         qio_direct_preadv_iov(file, iov, iovcnt, seek_to_offset, &nread) :
+                         method == QIO_METHOD_IOURING ?
+                         sys_uring_preadv(file->fd, iov, iovcnt, seek_to_offset, &nread) :
+                         sys_preadv(file->fd, iov, iovcnt, seek_to_offset, &nread));
   else
     QIO_RETURN_CONSTANT_ERROR(EINVAL, "invalid file descriptor");
 
@@ -272,6 +530,21 @@ error:
 
 }
 
+qioerr qio_preadv(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_read)
+{
+  return _qio_preadv(file, buf, start, end, seek_to_offset, num_read, QIO_METHOD_PREADPWRITE);
+}
+
+qioerr qio_uring_preadv(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_read)
+{
+  return _qio_preadv(file, buf, start, end, seek_to_offset, num_read, QIO_METHOD_IOURING);
+}
+
+qioerr qio_direct_preadv(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_read)
+{
+  return _qio_preadv(file, buf, start, end, seek_to_offset, num_read, QIO_METHOD_DIRECT);
+}
+
 qioerr qio_freadv(FILE* fp, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, ssize_t* num_read)
 {
   int64_t total_read = 0;
@@ -369,7 +642,8 @@ error:
 
 
 
-qioerr qio_pwritev(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_written)
+static
+qioerr _qio_pwritev(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_written, qio_method_t method)
 {
   ssize_t nwritten = 0;
   int64_t num_bytes = qbuffer_iter_num_bytes(start, end);
@@ -396,7 +670,11 @@ qioerr qio_pwritev(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuff
 
   // write from our buffer
   if (file->fd != -1)
-    err = qio_int_to_err(sys_pwritev(file->fd, iov, iovcnt, seek_to_offset, &nwritten));
+    err = qio_int_to_err(method == QIO_METHOD_DIRECT ?
+                         qio_direct_pwritev_iov(file, iov, iovcnt, seek_to_offset, &nwritten) :
+                         method == QIO_METHOD_IOURING ?
+                         sys_uring_pwritev(file->fd, iov, iovcnt, seek_to_offset, &nwritten) :
+                         sys_pwritev(file->fd, iov, iovcnt, seek_to_offset, &nwritten));
   else
     QIO_RETURN_CONSTANT_ERROR(EINVAL, "invalid file descriptor");
 
@@ -410,6 +688,21 @@ error:
   return err;
 }
 
+qioerr qio_pwritev(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_written)
+{
+  return _qio_pwritev(file, buf, start, end, seek_to_offset, num_written, QIO_METHOD_PREADPWRITE);
+}
+
+qioerr qio_uring_pwritev(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_written)
+{
+  return _qio_pwritev(file, buf, start, end, seek_to_offset, num_written, QIO_METHOD_IOURING);
+}
+
+qioerr qio_direct_pwritev(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_written)
+{
+  return _qio_pwritev(file, buf, start, end, seek_to_offset, num_written, QIO_METHOD_DIRECT);
+}
+
 qioerr qio_recv(fd_t sockfd, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int flags,
               sys_sockaddr_t* src_addr_out, /* can be NULL */
               void* ancillary_out, socklen_t* ancillary_len_inout, /* can be NULL */
@@ -521,6 +814,335 @@ error:
   return err;
 }
 
+// Sets up msgvec[i] to cover starts[i] to ends[i], with the iovecs in iov.
+static
+qioerr _qio_setup_mmsg(qbuffer_t* buf, const qbuffer_iter_t* starts, const qbuffer_iter_t* ends, int nmsgs, sys_mmsghdr_t* msgvec, struct iovec* iov)
+{
+  qioerr err;
+  int i;
+
+  for( i = 0; i < nmsgs; i++ ) {
+    size_t iovcnt = 0;
+    ssize_t num_parts = qbuffer_iter_num_parts(starts[i], ends[i]);
+
+    err = qbuffer_to_iov(buf, starts[i], ends[i], num_parts, iov, NULL, &iovcnt);
+    if( err ) return err;
+
+    memset(&msgvec[i], 0, sizeof(sys_mmsghdr_t));
+    msgvec[i].msg_hdr.msg_iov = iov;
+    msgvec[i].msg_hdr.msg_iovlen = iovcnt;
+    iov += iovcnt;
+  }
+
+  return 0;
+}
+
+// Counts the iovecs needed for a batch of messages.
+static
+qioerr _qio_count_mmsg_parts(const qbuffer_iter_t* starts, const qbuffer_iter_t* ends, int nmsgs, int64_t* nparts_out)
+{
+  int64_t total = 0;
+  int i;
+
+  for( i = 0; i < nmsgs; i++ ) {
+    int64_t num_bytes = qbuffer_iter_num_bytes(starts[i], ends[i]);
+    ssize_t num_parts = qbuffer_iter_num_parts(starts[i], ends[i]);
+    if( num_bytes < 0 || num_parts < 0 || num_parts > INT_MAX ) {
+      QIO_RETURN_CONSTANT_ERROR(EINVAL, "range outside of buffer");
+    }
+    total += num_parts;
+  }
+
+  *nparts_out = total;
+  return 0;
+}
+
+static
+qioerr _qio_mmsg(int sending, fd_t sockfd, qbuffer_t* buf, const qbuffer_iter_t* starts, const qbuffer_iter_t* ends, int nmsgs, int flags, int yield, int* num_msgs_out, ssize_t* num_bytes_out)
+{
+  sys_mmsghdr_t* msgvec = NULL;
+  struct iovec* iov = NULL;
+  int64_t nparts = 0;
+  int got = 0;
+  int i;
+  MAYBE_STACK_SPACE(struct iovec, iov_onstack);
+  MAYBE_STACK_SPACE(sys_mmsghdr_t, msgvec_onstack);
+  qioerr err;
+
+  *num_msgs_out = 0;
+
+  if( nmsgs <= 0 ) return 0;
+
+  err = _qio_count_mmsg_parts(starts, ends, nmsgs, &nparts);
+  if( err ) return err;
+
+  MAYBE_STACK_ALLOC(struct iovec, nparts, iov, iov_onstack);
+  MAYBE_STACK_ALLOC(sys_mmsghdr_t, nmsgs, msgvec, msgvec_onstack);
+  if( ! iov || ! msgvec ) {
+    err = QIO_ENOMEM;
+    goto error;
+  }
+
+  err = _qio_setup_mmsg(buf, starts, ends, nmsgs, msgvec, iov);
+  if( err ) goto error;
+
+  if( yield ) flags |= MSG_DONTWAIT;
+
+  while( 1 ) {
+    qio_err_t rc = sending ?
+                   sys_sendmmsg(sockfd, msgvec, nmsgs, flags, &got) :
+                   sys_recvmmsg(sockfd, msgvec, nmsgs, flags, &got);
+    if( rc == EINTR ) continue;
+    if( yield && (rc == EAGAIN || rc == EWOULDBLOCK) ) {
+      // Let another task have this worker until the socket is ready.
+      qio_yield();
+      continue;
+    }
+    err = qio_int_to_err(rc);
+    break;
+  }
+
+  if( ! err ) {
+    *num_msgs_out = got;
+    if( num_bytes_out ) {
+      for( i = 0; i < got; i++ ) num_bytes_out[i] = msgvec[i].msg_len;
+    }
+  }
+
+error:
+  MAYBE_STACK_FREE(msgvec, msgvec_onstack);
+  MAYBE_STACK_FREE(iov, iov_onstack);
+
+  return err;
+}
+
+qioerr qio_send_batch(fd_t sockfd, qbuffer_t* buf, const qbuffer_iter_t* starts, const qbuffer_iter_t* ends, int nmsgs, int flags, int yield, int* num_msgs_out, ssize_t* num_sent_out)
+{
+  return _qio_mmsg(1, sockfd, buf, starts, ends, nmsgs, flags, yield, num_msgs_out, num_sent_out);
+}
+
+qioerr qio_recv_batch(fd_t sockfd, qbuffer_t* buf, const qbuffer_iter_t* starts, const qbuffer_iter_t* ends, int nmsgs, int flags, int yield, int* num_msgs_out, ssize_t* num_recvd_out)
+{
+  return _qio_mmsg(0, sockfd, buf, starts, ends, nmsgs, flags, yield, num_msgs_out, num_recvd_out);
+}
+
+static
+int qio_use_iouring_by_default(void)
+{
+  if( qio_iouring_by_default == -1 ) {
+#ifdef CHPL_RT_UNIT_TEST
+    qio_iouring_by_default = 0;
+#else
+    qio_iouring_by_default = chpl_env_rt_get_bool("QIO_IO_URING", false);
+#endif
+  }
+  return qio_iouring_by_default && sys_uring_available();
+}
+
+/* WRITE-BEHIND ------------------------- */
+
+// A buffered channel normally writes out each filled chunk on the task
+// that filled it. With write-behind, complete chunks are instead handed
+// to a single background thread that pwrites them, so the writer can
+// keep going while the previous data is on its way to the disk. The
+// chunks stay referenced by the queued job until they're written.
+//
+// Only positional methods (pread/pwrite and io_uring) use it, since
+// the data carries its own file offset. Flushing a channel, or closing
+// or syncing its file, waits for everything queued for the file (so the
+// file outlives its queued jobs), and an
+// error from the background writes is reported then (and repeatedly
+// after that; the data is lost).
+//
+// CHPL_RT_QIO_WRITE_BEHIND turns it on for every file, otherwise it
+// follows QIO_HINT_WRITEBEHIND. CHPL_RT_QIO_WRITE_BEHIND_MAX_BYTES
+// bounds how much data can be queued before writers wait for it to
+// drain, and CHPL_RT_QIO_WRITE_BEHIND_FSYNC makes the background thread
+// fsync after each job.
+
+typedef struct qio_wb_job_s {
+  struct qio_wb_job_s* next;
+  qio_file_t* file;
+  int64_t offset;
+  int64_t len;
+  qbuffer_t buf;
+} qio_wb_job_t;
+
+static pthread_once_t qio_wb_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t qio_wb_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t qio_wb_cond = PTHREAD_COND_INITIALIZER;
+static int qio_wb_running = 0;
+static qio_wb_job_t* qio_wb_head = NULL;
+static qio_wb_job_t* qio_wb_tail = NULL;
+static int64_t qio_wb_queued_bytes = 0;
+
+static
+void qio_wb_thread(void* arg)
+{
+  while( 1 ) {
+    qio_wb_job_t* job;
+    qbuffer_iter_t start;
+    qbuffer_iter_t end;
+    ssize_t num_written;
+    qioerr err = 0;
+
+    pthread_mutex_lock(&qio_wb_lock);
+    while( qio_wb_head == NULL ) pthread_cond_wait(&qio_wb_cond, &qio_wb_lock);
+    job = qio_wb_head;
+    qio_wb_head = job->next;
+    if( qio_wb_head == NULL ) qio_wb_tail = NULL;
+    pthread_mutex_unlock(&qio_wb_lock);
+
+    start = qbuffer_begin(&job->buf);
+    end = qbuffer_end(&job->buf);
+    while( !err && qbuffer_iter_num_bytes(start, end) > 0 ) {
+      num_written = 0;
+      // job->buf starts at offset 0
+      err = qio_pwritev(job->file, &job->buf, start, end, job->offset + start.offset, &num_written);
+      qbuffer_iter_advance(&job->buf, &start, num_written);
+      if( err && qio_err_to_int(err) == EINTR ) err = 0;
+    }
+
+    if( !err && qio_write_behind_fsync ) err = qio_int_to_err(sys_fsync(job->file->fd));
+
+    qbuffer_destroy(&job->buf);
+
+    pthread_mutex_lock(&qio_wb_lock);
+    qio_wb_queued_bytes -= job->len;
+    if( err && !job->file->wb_err ) job->file->wb_err = err;
+    job->file->wb_pending--;
+    pthread_mutex_unlock(&qio_wb_lock);
+
+    qio_free(job);
+  }
+}
+
+#ifdef CHPL_RT_UNIT_TEST
+static
+void* qio_wb_pthread(void* arg)
+{
+  qio_wb_thread(arg);
+  return NULL;
+}
+#endif
+
+static
+void qio_wb_init(void)
+{
+#ifdef CHPL_RT_UNIT_TEST
+  pthread_t thread;
+  qio_wb_running = (pthread_create(&thread, NULL, qio_wb_pthread, NULL) == 0);
+  if( qio_wb_running ) pthread_detach(thread);
+#else
+  int64_t max = chpl_env_rt_get_int("QIO_WRITE_BEHIND_MAX_BYTES",
+                                    qio_write_behind_max_bytes);
+  if( max > 0 ) qio_write_behind_max_bytes = max;
+  qio_write_behind_fsync = chpl_env_rt_get_bool("QIO_WRITE_BEHIND_FSYNC", false);
+  qio_wb_running = (chpl_task_createCommTask(qio_wb_thread, NULL, -1) == 0);
+  if( !qio_wb_running ) {
+    chpl_warning("cannot start the qio write-behind thread; "
+                 "writing on the calling task instead", 0, 0);
+  }
+#endif
+}
+
+static
+int qio_write_behind_ok(qio_channel_t* ch)
+{
+  qio_method_t method = (qio_method_t) (ch->hints & QIO_METHODMASK);
+
+  if( method != QIO_METHOD_PREADPWRITE && method != QIO_METHOD_IOURING ) return 0;
+  if( ch->hints & QIO_HINT_DIRECT ) return 0;
+  if( ch->chan_info || ch->file->fd == -1 ) return 0;
+
+  if( qio_write_behind_by_default == -1 ) {
+#ifdef CHPL_RT_UNIT_TEST
+    qio_write_behind_by_default = 0;
+#else
+    qio_write_behind_by_default = chpl_env_rt_get_bool("QIO_WRITE_BEHIND", false);
+#endif
+  }
+  if( !(ch->hints & QIO_HINT_WRITEBEHIND) && !qio_write_behind_by_default ) return 0;
+
+  pthread_once(&qio_wb_once, qio_wb_init);
+  return qio_wb_running;
+}
+
+// Waits until nothing is queued for the file, then returns
+// any error from its background writes.
+static
+qioerr qio_wb_wait(qio_file_t* f)
+{
+  qioerr err;
+
+  pthread_mutex_lock(&qio_wb_lock);
+  while( f->wb_pending > 0 ) {
+    pthread_mutex_unlock(&qio_wb_lock);
+    qio_yield();
+    pthread_mutex_lock(&qio_wb_lock);
+  }
+  err = f->wb_err;
+  pthread_mutex_unlock(&qio_wb_lock);
+
+  return err;
+}
+
+// Queues the data between start and end to be written at start.offset.
+static
+qioerr qio_wb_submit(qio_channel_t* ch, qbuffer_iter_t start, qbuffer_iter_t end)
+{
+  qio_file_t* f = ch->file;
+  int64_t len = qbuffer_iter_num_bytes(start, end);
+  qio_wb_job_t* job;
+  qioerr err;
+
+  pthread_mutex_lock(&qio_wb_lock);
+  err = f->wb_err;
+  // Apply backpressure, but always let one job through.
+  while( !err && qio_wb_queued_bytes > 0 &&
+         qio_wb_queued_bytes + len > qio_write_behind_max_bytes ) {
+    pthread_mutex_unlock(&qio_wb_lock);
+    qio_yield();
+    pthread_mutex_lock(&qio_wb_lock);
+    err = f->wb_err;
+  }
+  pthread_mutex_unlock(&qio_wb_lock);
+  if( err ) return err;
+
+  job = (qio_wb_job_t*) qio_calloc(1, sizeof(qio_wb_job_t));
+  if( !job ) return QIO_ENOMEM;
+
+  job->file = f;
+  job->offset = start.offset;
+  job->len = len;
+  err = qbuffer_init(&job->buf);
+  while( !err && qbuffer_iter_num_bytes(start, end) > 0 ) {
+    qbytes_t* bytes;
+    int64_t skip;
+    int64_t part_len;
+
+    qbuffer_iter_get(start, end, &bytes, &skip, &part_len);
+    err = qbuffer_append(&job->buf, bytes, skip, part_len);
+    qbuffer_iter_next_part(&ch->buf, &start);
+  }
+  if( err ) {
+    qbuffer_destroy(&job->buf);
+    qio_free(job);
+    return err;
+  }
+
+  pthread_mutex_lock(&qio_wb_lock);
+  f->wb_pending++;
+  qio_wb_queued_bytes += len;
+  if( qio_wb_tail ) qio_wb_tail->next = job;
+  else qio_wb_head = job;
+  qio_wb_tail = job;
+  pthread_cond_signal(&qio_wb_cond);
+  pthread_mutex_unlock(&qio_wb_lock);
+
+  return 0;
+}
+
 static
 qio_hint_t choose_io_method(qio_file_t* file, qio_hint_t hints, qio_hint_t default_hints, int64_t file_size, int reading, int writing, int isfilestar)
 {
@@ -561,6 +1183,8 @@ qio_hint_t choose_io_method(qio_file_t* file, qio_hint_t hints, qio_hint_t defau
 
           if (mmap_ok)
             method = QIO_METHOD_MMAP;
+          else if (qio_use_iouring_by_default())
+            method = QIO_METHOD_IOURING;
           else
             method = QIO_METHOD_PREADPWRITE;
         } else {
@@ -570,6 +1194,16 @@ qio_hint_t choose_io_method(qio_file_t* file, qio_hint_t hints, qio_hint_t defau
     } else {
       // method already chosen in hints.
     }
+
+    // io_uring might be unsupported by this kernel, or not permitted.
+    if( method == QIO_METHOD_IOURING && !sys_uring_available() )
+      method = QIO_METHOD_PREADPWRITE;
+
+    // O_DIRECT needs a descriptor that can seek.
+    if( method == QIO_METHOD_DIRECT ) {
+      if( isfilestar ) method = QIO_METHOD_FREADFWRITE;
+      else if( !(fdflags & QIO_FDFLAG_SEEKABLE) ) method = QIO_METHOD_READWRITE;
+    }
   }
 
   // Always use fread/fwrite with FILE*
@@ -804,6 +1438,10 @@ qioerr qio_file_init(qio_file_t** file_out, FILE* fp, fd_t fd, qio_hint_t iohint
       initial_pos = initial_length;
     }
 
+    if( rc & O_NONBLOCK ) {
+      fdflags = (qio_fdflag_t) (fdflags | QIO_FDFLAG_NONBLOCKING);
+    }
+
     rc &= O_ACCMODE;
     // When setting the file mode, we pretend no matter what
     // that stdin is read-only and stdout/stderr are write-only.
@@ -830,6 +1468,7 @@ qioerr qio_file_init(qio_file_t** file_out, FILE* fp, fd_t fd, qio_hint_t iohint
   DO_INIT_REFCNT(file);
   file->fp = fp;
   file->fd = fd;
+  file->direct_fd = QIO_DIRECT_FD_UNOPENED;
   file->use_fp = usefilestar;
   file->buf = NULL;
   file->fdflags = fdflags;
@@ -913,6 +1552,7 @@ qioerr qio_file_init_plugin(qio_file_t** file_out, void* file_info, int fdflags,
   DO_INIT_REFCNT(file);
   file->fp = NULL;
   file->fd = -1;
+  file->direct_fd = QIO_DIRECT_FD_UNOPENED;
   file->use_fp = 0;
   file->buf = NULL;
   file->fdflags = (qio_fdflag_t) fdflags;
@@ -959,6 +1599,9 @@ qioerr _qio_file_do_close(qio_file_t* f)
 
   //printf("closing %p fd %i fp %p\n", f, f->fd, f->fp);
 
+  // Background writes still need the descriptor.  Any error from them
+  // was reported when their channel was flushed.
+  (void) qio_wb_wait(f);
 
   err = qio_lock(& f->lock);
   if( err ) return err;
@@ -990,6 +1633,12 @@ qioerr _qio_file_do_close(qio_file_t* f)
     f->hints &= ~QIO_HINT_OWNED;
   }
 
+  if( f->direct_fd >= 0 ) {
+    // ours even if the file's descriptor isn't
+    err = qio_int_to_err(sys_close(f->direct_fd));
+    f->direct_fd = QIO_DIRECT_FD_UNAVAILABLE;
+  }
+
   if( f->fd >= 0 ) {
     if (f->hints & QIO_HINT_OWNED)
       err = qio_int_to_err(sys_close(f->fd));
@@ -1025,15 +1674,19 @@ qioerr qio_file_sync(qio_file_t* f)
   qioerr err = 0;
   qioerr newerr;
 
+  err = qio_wb_wait(f);
+
   if( f->fp ) {
     newerr = qio_int_to_err(fflush(f->fp));
     if( ! err ) err = newerr;
     newerr = qio_int_to_err(sys_fsync(fileno(f->fp)));
     if( ! err ) err = newerr;
   } else if( f->fd >= 0 ) {
-    err = qio_int_to_err(sys_fsync(f->fd));
+    newerr = qio_int_to_err(sys_fsync(f->fd));
+    if( ! err ) err = newerr;
   } else if( f->file_info ) {
-    err = chpl_qio_fsync(f->file_info);
+    newerr = chpl_qio_fsync(f->file_info);
+    if( ! err ) err = newerr;
   }
 
   return err;
@@ -1193,6 +1846,7 @@ qioerr qio_file_open_mem_ext(qio_file_t** file_out, qbuffer_t* buf, qio_fdflag_t
   DO_INIT_REFCNT(file); // initialized to 1.
   file->fp = NULL;
   file->fd = -1;
+  file->direct_fd = QIO_DIRECT_FD_UNOPENED;
   file->fdflags = fdflags;
   file->closed = false;
   file->hints = choose_io_method(file, iohints, 0, qbuffer_len(file->buf),
@@ -1342,6 +1996,77 @@ qioerr qio_file_length(qio_file_t* f, int64_t *len_out)
   return err;
 }
 
+qioerr qio_file_view(qio_file_t* f, int64_t start, int64_t len, int copy_on_write, qio_hint_t hints, qio_file_view_t* view_out)
+{
+  struct stat stats;
+  long pagesize;
+  int64_t map_start;
+  int64_t skip;
+  int64_t map_len;
+  int prot;
+  void* data = NULL;
+  qbytes_t* bytes = NULL;
+  qioerr err;
+
+  view_out->data = NULL;
+  view_out->len = 0;
+  view_out->map = NULL;
+
+  if( start < 0 ) QIO_RETURN_CONSTANT_ERROR(EINVAL, "negative view offset");
+  if( f->fd == -1 ) QIO_RETURN_CONSTANT_ERROR(ENOSYS, "file view requires a file descriptor");
+  if( ! (f->fdflags & QIO_FDFLAG_READABLE) ) QIO_RETURN_CONSTANT_ERROR(EBADF, "file view requires a readable file");
+
+  err = qio_int_to_err(sys_fstat(f->fd, &stats));
+  if( err ) return err;
+
+  if( start >= stats.st_size ) return 0;
+  if( len < 0 || len > stats.st_size - start ) len = stats.st_size - start;
+  if( len == 0 ) return 0;
+
+  // mmap offsets must be page-aligned
+  pagesize = sys_page_size();
+  map_start = (start / pagesize) * pagesize;
+  skip = start - map_start;
+  map_len = skip + len;
+
+  // This check is (only) important for 32-bit systems.
+  if( map_len > SSIZE_MAX ) QIO_RETURN_CONSTANT_ERROR(EOVERFLOW, "overflow in mmap");
+
+  prot = PROT_READ;
+  if( copy_on_write ) prot |= PROT_WRITE;
+
+  err = qio_int_to_err(sys_mmap(NULL, map_len, prot,
+                                copy_on_write ? MAP_PRIVATE : MAP_SHARED,
+                                f->fd, map_start, &data));
+  if( err ) return err;
+
+  err = qio_madvise_for_hints(data, map_len, hints ? hints : f->hints);
+  if( err ) {
+    sys_munmap(data, map_len);
+    return err;
+  }
+
+  err = qbytes_create_generic(&bytes, data, map_len, qbytes_free_munmap);
+  if( err ) {
+    sys_munmap(data, map_len);
+    return err;
+  }
+
+  view_out->data = (char*) data + skip;
+  view_out->len = len;
+  view_out->map = bytes;
+
+  return 0;
+}
+
+void qio_file_view_release(qio_file_view_t* view)
+{
+  if( view->map ) qbytes_release(view->map);
+  view->data = NULL;
+  view->len = 0;
+  view->map = NULL;
+}
+
 /* CHANNELS ----------------------------- */
 static
 qioerr _qio_channel_init(qio_channel_t* ch, qio_chtype_t type)
@@ -1953,7 +2678,7 @@ qioerr _buffered_allocate_bufferspace(qio_channel_t* ch, int64_t amt, int64_t ma
 
   // allocate some space!
   while( left > 0 ) {
-    err = qbytes_create_iobuf(&tmp);
+    err = qbytes_create_iobuf_uninit(&tmp);
     if( err ) goto error;
     uselen = tmp->len;
     if( uselen > max_left ) uselen = max_left;
@@ -2291,6 +3016,12 @@ qioerr _buffered_read_atleast(qio_channel_t* ch, int64_t amt)
       case QIO_METHOD_PREADPWRITE:
         err = qio_preadv(ch->file, &ch->buf, read_start, read_end, read_start.offset, &num_read);
         break;
+      case QIO_METHOD_IOURING:
+        err = qio_uring_preadv(ch->file, &ch->buf, read_start, read_end, read_start.offset, &num_read);
+        break;
+      case QIO_METHOD_DIRECT:
+        err = qio_direct_preadv(ch->file, &ch->buf, read_start, read_end, read_start.offset, &num_read);
+        break;
       case QIO_METHOD_FREADFWRITE:
         err = qio_freadv(ch->file->fp, &ch->buf, read_start, read_end, &num_read);
         break;
@@ -2700,6 +3431,18 @@ qioerr _qio_buffered_behind(qio_channel_t* ch, int flushall)
     qbuffer_iter_ceil_part(&ch->buf, &write_end);
   }
 
+  if( (ch->flags & QIO_FDFLAG_WRITEABLE) && qio_write_behind_ok(ch) ) {
+    if( flushall ) {
+      // Everything queued earlier has to be on disk before the flush
+      // is done; then write the rest here.
+      err = qio_wb_wait(ch->file);
+    } else {
+      err = qio_wb_submit(ch, write_start, write_end);
+      if( !err ) write_start = write_end;
+    }
+    if( err ) goto error;
+  }
+
   if(ch->flags & QIO_FDFLAG_WRITEABLE) {
     while( qbuffer_iter_num_bytes(write_start, write_end) > 0 ) {
       QIO_GET_CONSTANT_ERROR(err, EINVAL, "write method not implemented");
@@ -2711,6 +3454,14 @@ qioerr _qio_buffered_behind(qio_channel_t* ch, int flushall)
         case QIO_METHOD_PREADPWRITE:
           err = qio_pwritev(ch->file, &ch->buf, write_start, write_end, write_start.offset, &num_written);
           break;
+        case QIO_METHOD_DIRECT:
+          err = qio_direct_pwritev(ch->file, &ch->buf, write_start, write_end, write_start.offset, &num_written);
+          break;
+        case QIO_METHOD_IOURING:
+          // This submits the whole write-behind region at once, as
+          // several requests if it has more than IOV_MAX parts.
+          err = qio_uring_pwritev(ch->file, &ch->buf, write_start, write_end, write_start.offset, &num_written);
+          break;
         case QIO_METHOD_FREADFWRITE:
           err = qio_fwritev(ch->file->fp, &ch->buf, write_start, write_end, &num_written);
           break;
@@ -2827,6 +3578,11 @@ qioerr _qio_buffered_read(qio_channel_t* ch, void* ptr, ssize_t len, ssize_t* am
     ch->mark_cur == 0 &&                     // not waiting for a commit/revert
     ch->chan_info == NULL                    // there is no IO plugin
   ) {
+    // If nothing has been buffered yet, the qbuffer doesn't know the
+    // channel's position, and the iterators below would start at 0.
+    err = _qio_channel_needbuffer_unlocked(ch);
+    if( err ) return err;
+
     // copy out what remains in the buffer before making a system call
     gotlen = qio_ptr_diff(ch->cached_end, ch->cached_cur);
 
@@ -2862,13 +3618,26 @@ qioerr _qio_buffered_read(qio_channel_t* ch, void* ptr, ssize_t len, ssize_t* am
       num_read = 0;
       switch (method) {
         case QIO_METHOD_READWRITE:
-          err = qio_int_to_err(sys_read(ch->file->fd, ptr, remaining,
-                               &num_read));
+          err = qio_file_read(ch->file, ptr, remaining, &num_read);
           break;
         case QIO_METHOD_PREADPWRITE:
           err = qio_int_to_err(sys_pread(ch->file->fd, ptr, remaining,
                                _right_mark_start(ch), &num_read));
           break;
+        case QIO_METHOD_DIRECT:
+          {
+            struct iovec iov = { ptr, remaining };
+            err = qio_int_to_err(qio_direct_preadv_iov(ch->file, &iov, 1,
+                                 _right_mark_start(ch), &num_read));
+          }
+          break;
+        case QIO_METHOD_IOURING:
+          {
+            struct iovec iov = { ptr, remaining };
+            err = qio_int_to_err(sys_uring_preadv(ch->file->fd, &iov, 1,
+                                 _right_mark_start(ch), &num_read));
+          }
+          break;
         case QIO_METHOD_FREADFWRITE:
           if( ch->file->fp ) {
             num_read_u = fread(ptr, 1, remaining, ch->file->fp);
@@ -3015,11 +3784,23 @@ qioerr _qio_buffered_write(qio_channel_t* ch, const void* ptr, ssize_t len, ssiz
       num_written = 0;
       switch (method) {
         case QIO_METHOD_READWRITE:
-          err = qio_int_to_err(sys_write(ch->file->fd, ptr, remaining, &num_written));
+          err = qio_file_write(ch->file, ptr, remaining, &num_written);
           break;
         case QIO_METHOD_PREADPWRITE:
           err = qio_int_to_err(sys_pwrite(ch->file->fd, ptr, remaining, _right_mark_start(ch), &num_written));
           break;
+        case QIO_METHOD_DIRECT:
+          {
+            struct iovec iov = { (void*) ptr, remaining };
+            err = qio_int_to_err(qio_direct_pwritev_iov(ch->file, &iov, 1, _right_mark_start(ch), &num_written));
+          }
+          break;
+        case QIO_METHOD_IOURING:
+          {
+            struct iovec iov = { (void*) ptr, remaining };
+            err = qio_int_to_err(sys_uring_pwritev(ch->file->fd, &iov, 1, _right_mark_start(ch), &num_written));
+          }
+          break;
         case QIO_METHOD_FREADFWRITE:
           if( ch->file->fp ) {
             num_written_u = fwrite(ptr, 1, remaining, ch->file->fp);
@@ -3137,13 +3918,25 @@ qioerr _qio_unbuffered_write(qio_channel_t* ch, const void* ptr, ssize_t len_in,
       num_written = 0;
       switch (method) {
         case QIO_METHOD_READWRITE:
-          err = qio_int_to_err(sys_write(ch->file->fd, ptr, len, &num_written));
+          err = qio_file_write(ch->file, ptr, len, &num_written);
           break;
         case QIO_METHOD_MMAP: // mmap uses pread/pwrite when we're
                               // outside the mmap'd region.
         case QIO_METHOD_PREADPWRITE:
           err = qio_int_to_err(sys_pwrite(ch->file->fd, ptr, len, _right_mark_start(ch), &num_written));
           break;
+        case QIO_METHOD_DIRECT:
+          {
+            struct iovec iov = { (void*) ptr, len };
+            err = qio_int_to_err(qio_direct_pwritev_iov(ch->file, &iov, 1, _right_mark_start(ch), &num_written));
+          }
+          break;
+        case QIO_METHOD_IOURING:
+          {
+            struct iovec iov = { (void*) ptr, len };
+            err = qio_int_to_err(sys_uring_pwritev(ch->file->fd, &iov, 1, _right_mark_start(ch), &num_written));
+          }
+          break;
         case QIO_METHOD_FREADFWRITE:
           if( ch->file->fp ) {
             num_written_u = fwrite(ptr, 1, len, ch->file->fp);
@@ -3220,7 +4013,8 @@ qioerr _qio_unbuffered_read(qio_channel_t* ch, void* ptr, ssize_t len_in, ssize_
   len = len_in;
 
   if( ch->file->mmap &&
-      (method == QIO_METHOD_PREADPWRITE || method == QIO_METHOD_MMAP) &&
+      (method == QIO_METHOD_PREADPWRITE || method == QIO_METHOD_IOURING ||
+       method == QIO_METHOD_MMAP) &&
       _right_mark_start(ch) + len <= ch->file->mmap->len) {
     // As long as we're using an I/O method that seeks on every read,
     // copy the data out of the mmap.
@@ -3232,12 +4026,24 @@ qioerr _qio_unbuffered_read(qio_channel_t* ch, void* ptr, ssize_t len_in, ssize_
       num_read = 0;
       switch (method) {
         case QIO_METHOD_READWRITE:
-          err = qio_int_to_err(sys_read(ch->file->fd, ptr, len, &num_read));
+          err = qio_file_read(ch->file, ptr, len, &num_read);
           break;
         case QIO_METHOD_MMAP:
         case QIO_METHOD_PREADPWRITE:
           err = qio_int_to_err(sys_pread(ch->file->fd, ptr, len, _right_mark_start(ch), &num_read));
           break;
+        case QIO_METHOD_DIRECT:
+          {
+            struct iovec iov = { ptr, len };
+            err = qio_int_to_err(qio_direct_preadv_iov(ch->file, &iov, 1, _right_mark_start(ch), &num_read));
+          }
+          break;
+        case QIO_METHOD_IOURING:
+          {
+            struct iovec iov = { ptr, len };
+            err = qio_int_to_err(sys_uring_preadv(ch->file->fd, &iov, 1, _right_mark_start(ch), &num_read));
+          }
+          break;
         case QIO_METHOD_FREADFWRITE:
           if( ch->file->fp ) {
             num_read_u = fread(ptr, 1, len, ch->file->fp);
@@ -3751,7 +4557,7 @@ qioerr qio_channel_begin_peek_buffer(const int threadsafe, qio_channel_t* ch, in
   err = _qio_channel_require_unlocked(ch, require, writing);
   if( err ) {
     _qio_channel_set_error_unlocked(ch, err);
-    qio_unlock(&ch->lock);
+    if( threadsafe ) qio_unlock(&ch->lock);
     return err;
   }
 
@@ -0,0 +1,296 @@
+/*
+ * Copyright 2020-2023 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CHPL_RT_UNIT_TEST
+#include "chplrt.h"
+#endif
+
+#include "sys.h"
+#include "qio_collective.h"
+
+#include <limits.h>
+#include <stdlib.h>
+
+qioerr qio_collective_layout_init(qio_collective_layout_t* layout,
+                                  qio_file_t* fl,
+                                  int64_t start, int64_t end,
+                                  int64_t stripe,
+                                  int64_t max_aggregators)
+{
+  int64_t num_stripes;
+  int64_t stripes_per_agg;
+  qioerr err;
+
+  if( start < 0 || end < start || max_aggregators < 1 ) {
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "invalid collective write region");
+  }
+
+  if( stripe == 0 ) {
+    err = qio_get_chunk(fl, &stripe);
+    if( err ) return err;
+  }
+  if( stripe <= 0 ) stripe = 1;
+
+  layout->start = start;
+  layout->end = end;
+  layout->stripe = stripe;
+  layout->aligned_start = start - start % stripe;
+
+  num_stripes = (end - layout->aligned_start + stripe - 1) / stripe;
+  if( num_stripes < 1 ) num_stripes = 1;
+  if( max_aggregators > num_stripes ) max_aggregators = num_stripes;
+
+  // Give every aggregator the same number of whole stripes. Rounding up
+  // can leave the last few aggregators with nothing, so don't count them.
+  stripes_per_agg = (num_stripes + max_aggregators - 1) / max_aggregators;
+  layout->span = stripes_per_agg * stripe;
+  layout->num_aggregators =
+    (num_stripes + stripes_per_agg - 1) / stripes_per_agg;
+
+  return 0;
+}
+
+int64_t qio_collective_aggregator_for(const qio_collective_layout_t* layout,
+                                      int64_t offset)
+{
+  int64_t agg;
+
+  if( offset < layout->aligned_start ) return 0;
+
+  agg = (offset - layout->aligned_start) / layout->span;
+  if( agg >= layout->num_aggregators ) agg = layout->num_aggregators - 1;
+  return agg;
+}
+
+void qio_collective_aggregator_region(const qio_collective_layout_t* layout,
+                                      int64_t agg,
+                                      int64_t* start_out, int64_t* end_out)
+{
+  int64_t start = layout->aligned_start + agg * layout->span;
+  int64_t end = start + layout->span;
+
+  if( start < layout->start ) start = layout->start;
+  if( end > layout->end ) end = layout->end;
+  if( agg < 0 || agg >= layout->num_aggregators || end < start ) {
+    start = end = layout->start;
+  }
+
+  *start_out = start;
+  *end_out = end;
+}
+
+qioerr qio_collective_buffer_create(qio_collective_buffer_t** buf_out,
+                                    qio_file_t* file,
+                                    int64_t max_buffered)
+{
+  qio_collective_buffer_t* buf;
+  qioerr err;
+
+  if( file->fd == -1 ) {
+    QIO_RETURN_CONSTANT_ERROR(EINVAL,
+                              "collective writes need a file descriptor");
+  }
+
+  buf = (qio_collective_buffer_t*) qio_calloc(1, sizeof(*buf));
+  if( ! buf ) return QIO_ENOMEM;
+
+  err = qio_lock_init(&buf->lock);
+  if( err ) {
+    qio_free(buf);
+    return err;
+  }
+
+  qio_file_retain(file);
+  buf->file = file;
+  buf->max_buffered = max_buffered;
+
+  *buf_out = buf;
+  return 0;
+}
+
+static
+int _qio_collective_piece_cmp(const void* a, const void* b)
+{
+  const qio_collective_piece_t* x = (const qio_collective_piece_t*) a;
+  const qio_collective_piece_t* y = (const qio_collective_piece_t*) b;
+
+  if( x->offset < y->offset ) return -1;
+  if( x->offset > y->offset ) return 1;
+  return 0;
+}
+
+// Writes all of iov at offset, retrying after short writes.
+static
+qioerr _qio_collective_pwritev(fd_t fd, struct iovec* iov, int iovcnt,
+                               int64_t offset)
+{
+  ssize_t num_written;
+  qioerr err;
+
+  while( iovcnt > 0 ) {
+    num_written = 0;
+    err = qio_int_to_err(sys_pwritev(fd, iov, iovcnt, offset, &num_written));
+    if( err && qio_err_to_int(err) == EINTR ) err = 0;
+    if( err ) return err;
+    if( num_written == 0 ) {
+      QIO_RETURN_CONSTANT_ERROR(EIO, "collective write made no progress");
+    }
+
+    offset += num_written;
+    while( iovcnt > 0 && (size_t) num_written >= iov[0].iov_len ) {
+      num_written -= iov[0].iov_len;
+      iov++;
+      iovcnt--;
+    }
+    if( iovcnt > 0 ) {
+      iov[0].iov_base = (char*) iov[0].iov_base + num_written;
+      iov[0].iov_len -= num_written;
+    }
+  }
+
+  return 0;
+}
+
+// Assumes buf->lock is held.
+static
+qioerr _qio_collective_buffer_flush(qio_collective_buffer_t* buf)
+{
+  struct iovec* iov = NULL;
+  size_t i, j, k;
+  int64_t run_end;
+  qioerr err = 0;
+
+  if( buf->num_pieces == 0 ) return 0;
+
+  qsort(buf->pieces, buf->num_pieces, sizeof(qio_collective_piece_t),
+        _qio_collective_piece_cmp);
+
+  iov = (struct iovec*) qio_malloc(buf->num_pieces * sizeof(struct iovec));
+  if( ! iov ) return QIO_ENOMEM;
+
+  // Each run of pieces that are adjacent in the file is one write
+  // (sys_pwritev splits it into groups of IOV_MAX).
+  for( i = 0; i < buf->num_pieces && !err; i = j ) {
+    run_end = buf->pieces[i].offset + buf->pieces[i].len;
+    for( j = i + 1; j < buf->num_pieces; j++ ) {
+      if( buf->pieces[j].offset != run_end ) break;
+      run_end += buf->pieces[j].len;
+    }
+
+    for( k = i; k < j; k++ ) {
+      iov[k - i].iov_base = buf->pieces[k].data;
+      iov[k - i].iov_len = buf->pieces[k].len;
+    }
+    err = _qio_collective_pwritev(buf->file->fd, iov, j - i,
+                                  buf->pieces[i].offset);
+  }
+
+  qio_free(iov);
+
+  for( i = 0; i < buf->num_pieces; i++ ) {
+    qio_free(buf->pieces[i].data);
+  }
+  buf->num_pieces = 0;
+  buf->buffered = 0;
+
+  return err;
+}
+
+qioerr qio_collective_buffer_add(qio_collective_buffer_t* buf,
+                                 int64_t offset, const void* data,
+                                 int64_t len)
+{
+  qio_collective_piece_t* pieces;
+  void* copy;
+  size_t max_pieces;
+  qioerr err;
+
+  if( offset < 0 || len < 0 ) {
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "invalid collective write piece");
+  }
+  if( len == 0 ) return 0;
+
+  // copy outside of the lock
+  copy = qio_malloc(len);
+  if( ! copy ) return QIO_ENOMEM;
+  qio_memcpy(copy, data, len);
+
+  err = qio_lock(&buf->lock);
+  if( err ) {
+    qio_free(copy);
+    return err;
+  }
+
+  if( buf->num_pieces == buf->max_pieces ) {
+    max_pieces = buf->max_pieces ? 2 * buf->max_pieces : 16;
+    pieces = (qio_collective_piece_t*)
+      qio_realloc(buf->pieces, max_pieces * sizeof(qio_collective_piece_t));
+    if( ! pieces ) {
+      qio_unlock(&buf->lock);
+      qio_free(copy);
+      return QIO_ENOMEM;
+    }
+    buf->pieces = pieces;
+    buf->max_pieces = max_pieces;
+  }
+
+  buf->pieces[buf->num_pieces].offset = offset;
+  buf->pieces[buf->num_pieces].len = len;
+  buf->pieces[buf->num_pieces].data = copy;
+  buf->num_pieces++;
+  buf->buffered += len;
+
+  if( buf->max_buffered > 0 && buf->buffered > buf->max_buffered ) {
+    err = _qio_collective_buffer_flush(buf);
+  }
+
+  qio_unlock(&buf->lock);
+
+  return err;
+}
+
+qioerr qio_collective_buffer_flush(qio_collective_buffer_t* buf)
+{
+  qioerr err;
+
+  err = qio_lock(&buf->lock);
+  if( err ) return err;
+
+  err = _qio_collective_buffer_flush(buf);
+
+  qio_unlock(&buf->lock);
+
+  return err;
+}
+
+void qio_collective_buffer_destroy(qio_collective_buffer_t* buf)
+{
+  size_t i;
+
+  if( ! buf ) return;
+
+  for( i = 0; i < buf->num_pieces; i++ ) {
+    qio_free(buf->pieces[i].data);
+  }
+  qio_free(buf->pieces);
+  qio_lock_destroy(&buf->lock);
+  qio_file_release(buf->file);
+  qio_free(buf);
+}
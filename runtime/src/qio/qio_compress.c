@@ -0,0 +1,478 @@
+/*
+ * Copyright 2020-2023 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sys_basic.h"
+
+#ifndef CHPL_RT_UNIT_TEST
+#include "chplrt.h"
+#endif
+
+#include "qio.h"
+#include "qio_formatted.h"
+#include "qio_compress.h"
+
+#include <limits.h>
+#include <string.h>
+
+#ifdef HAS_ZSTD
+#include <zstd.h>
+#endif
+
+#ifdef HAS_LZ4
+#include <lz4.h>
+#endif
+
+static const char qio_frame_magic[8] = {'C','H','P','L','Q','Z','F','\n'};
+#define QIO_FRAME_VERSION 1
+#define QIO_FRAME_FOOTER_BYTES 32
+#define QIO_FRAME_INDEX_ENTRY_BYTES 16
+
+/* CODECS ------------------------------- */
+
+int qio_codec_available(qio_codec_t codec)
+{
+  switch( codec ) {
+    case QIO_CODEC_NONE:
+      return 1;
+    case QIO_CODEC_ZSTD:
+#ifdef HAS_ZSTD
+      return 1;
+#else
+      return 0;
+#endif
+    case QIO_CODEC_LZ4:
+#ifdef HAS_LZ4
+      return 1;
+#else
+      return 0;
+#endif
+  }
+  return 0;
+}
+
+size_t qio_codec_bound(qio_codec_t codec, size_t len)
+{
+  switch( codec ) {
+    case QIO_CODEC_NONE:
+      return len;
+    case QIO_CODEC_ZSTD:
+#ifdef HAS_ZSTD
+      return ZSTD_compressBound(len);
+#else
+      return 0;
+#endif
+    case QIO_CODEC_LZ4:
+#ifdef HAS_LZ4
+      if( len > LZ4_MAX_INPUT_SIZE ) return 0;
+      return LZ4_compressBound((int) len);
+#else
+      return 0;
+#endif
+  }
+  return 0;
+}
+
+qioerr qio_codec_compress(qio_codec_t codec, int level,
+                          const void* src, size_t len,
+                          void* dst, size_t cap, size_t* len_out)
+{
+  *len_out = 0;
+
+  switch( codec ) {
+    case QIO_CODEC_NONE:
+      if( len > cap ) QIO_RETURN_CONSTANT_ERROR(EOVERFLOW, "compression buffer too small");
+      memcpy(dst, src, len);
+      *len_out = len;
+      return 0;
+    case QIO_CODEC_ZSTD:
+#ifdef HAS_ZSTD
+      {
+        size_t rc = ZSTD_compress(dst, cap, src, len, level);
+        if( ZSTD_isError(rc) ) QIO_RETURN_CONSTANT_ERROR(EINVAL, "zstd compression failed");
+        *len_out = rc;
+        return 0;
+      }
+#else
+      break;
+#endif
+    case QIO_CODEC_LZ4:
+#ifdef HAS_LZ4
+      {
+        int rc;
+        if( len > LZ4_MAX_INPUT_SIZE ) QIO_RETURN_CONSTANT_ERROR(EOVERFLOW, "frame too large for lz4");
+        if( cap > INT_MAX ) cap = INT_MAX;
+        // lz4 trades ratio for speed with an acceleration factor;
+        // treat a negative level as one.
+        rc = LZ4_compress_fast((const char*) src, (char*) dst, (int) len,
+                               (int) cap, level < 0 ? -level : 1);
+        if( rc <= 0 ) QIO_RETURN_CONSTANT_ERROR(EINVAL, "lz4 compression failed");
+        *len_out = rc;
+        return 0;
+      }
+#else
+      break;
+#endif
+  }
+
+  QIO_RETURN_CONSTANT_ERROR(ENOSYS, "compression codec not available");
+}
+
+qioerr qio_codec_decompress(qio_codec_t codec,
+                            const void* src, size_t len,
+                            void* dst, size_t dst_len)
+{
+  switch( codec ) {
+    case QIO_CODEC_NONE:
+      if( len != dst_len ) QIO_RETURN_CONSTANT_ERROR(EINVAL, "corrupt compressed frame");
+      memcpy(dst, src, len);
+      return 0;
+    case QIO_CODEC_ZSTD:
+#ifdef HAS_ZSTD
+      {
+        size_t rc = ZSTD_decompress(dst, dst_len, src, len);
+        if( ZSTD_isError(rc) || rc != dst_len ) QIO_RETURN_CONSTANT_ERROR(EINVAL, "corrupt compressed frame");
+        return 0;
+      }
+#else
+      break;
+#endif
+    case QIO_CODEC_LZ4:
+#ifdef HAS_LZ4
+      {
+        int rc;
+        if( len > INT_MAX || dst_len > INT_MAX ) QIO_RETURN_CONSTANT_ERROR(EINVAL, "corrupt compressed frame");
+        rc = LZ4_decompress_safe((const char*) src, (char*) dst,
+                                 (int) len, (int) dst_len);
+        if( rc < 0 || (size_t) rc != dst_len ) QIO_RETURN_CONSTANT_ERROR(EINVAL, "corrupt compressed frame");
+        return 0;
+      }
+#else
+      break;
+#endif
+  }
+
+  QIO_RETURN_CONSTANT_ERROR(ENOSYS, "compression codec not available");
+}
+
+/* WRITING ------------------------------ */
+
+struct qio_frame_writer_s {
+  qio_channel_t* ch;
+  qio_codec_t codec;
+  int level;
+  int64_t frame_size;
+
+  // uncompressed data for the frame being filled
+  uint8_t* buf;
+  int64_t buf_len;
+
+  // compressed output, reused for each frame
+  uint8_t* cbuf;
+  size_t cbuf_cap;
+
+  // index entries so far: csize, usize, csize, usize, ...
+  uint64_t* entries;
+  int64_t nframes;
+  int64_t entries_cap;
+};
+
+static
+qioerr _frame_writer_add(qio_frame_writer_t* w, const void* cdata,
+                         int64_t clen, int64_t ulen)
+{
+  qioerr err;
+
+  if( w->nframes == w->entries_cap ) {
+    int64_t cap = w->entries_cap ? 2*w->entries_cap : 64;
+    uint64_t* entries = qio_realloc(w->entries, 2*cap*sizeof(uint64_t));
+    if( !entries ) return QIO_ENOMEM;
+    w->entries = entries;
+    w->entries_cap = cap;
+  }
+
+  err = qio_channel_write_amt(true, w->ch, cdata, clen);
+  if( err ) return err;
+
+  w->entries[2*w->nframes] = clen;
+  w->entries[2*w->nframes+1] = ulen;
+  w->nframes++;
+
+  return 0;
+}
+
+static
+qioerr _frame_writer_compress_buffered(qio_frame_writer_t* w)
+{
+  size_t clen = 0;
+  qioerr err;
+
+  if( w->buf_len == 0 ) return 0;
+
+  err = qio_codec_compress(w->codec, w->level, w->buf, w->buf_len,
+                           w->cbuf, w->cbuf_cap, &clen);
+  if( err ) return err;
+
+  err = _frame_writer_add(w, w->cbuf, clen, w->buf_len);
+  if( err ) return err;
+
+  w->buf_len = 0;
+  return 0;
+}
+
+qioerr qio_frame_writer_create(qio_frame_writer_t** w_out, qio_channel_t* ch,
+                               qio_codec_t codec, int level,
+                               int64_t frame_size)
+{
+  qio_frame_writer_t* w;
+
+  *w_out = NULL;
+
+  if( !qio_codec_available(codec) ) QIO_RETURN_CONSTANT_ERROR(ENOSYS, "compression codec not available");
+  if( frame_size <= 0 ) frame_size = QIO_FRAME_DEFAULT_SIZE;
+  if( (uint64_t) frame_size > SIZE_MAX / 2 ||
+      qio_codec_bound(codec, frame_size) == 0 ) {
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "frame size too large for codec");
+  }
+
+  w = (qio_frame_writer_t*) qio_calloc(1, sizeof(qio_frame_writer_t));
+  if( !w ) return QIO_ENOMEM;
+
+  w->ch = ch;
+  w->codec = codec;
+  w->level = level;
+  w->frame_size = frame_size;
+  w->cbuf_cap = qio_codec_bound(codec, frame_size);
+  w->buf = qio_malloc(frame_size);
+  w->cbuf = qio_malloc(w->cbuf_cap);
+  if( !w->buf || !w->cbuf ) {
+    qio_free(w->buf);
+    qio_free(w->cbuf);
+    qio_free(w);
+    return QIO_ENOMEM;
+  }
+
+  *w_out = w;
+  return 0;
+}
+
+qioerr qio_frame_writer_write(qio_frame_writer_t* w,
+                              const void* ptr, int64_t len)
+{
+  const uint8_t* p = (const uint8_t*) ptr;
+  qioerr err;
+
+  while( len > 0 ) {
+    int64_t amt = w->frame_size - w->buf_len;
+    if( amt > len ) amt = len;
+
+    memcpy(w->buf + w->buf_len, p, amt);
+    w->buf_len += amt;
+    p += amt;
+    len -= amt;
+
+    if( w->buf_len == w->frame_size ) {
+      err = _frame_writer_compress_buffered(w);
+      if( err ) return err;
+    }
+  }
+
+  return 0;
+}
+
+qioerr qio_frame_writer_add_compressed(qio_frame_writer_t* w,
+                                       const void* cdata, int64_t clen,
+                                       int64_t ulen)
+{
+  if( w->buf_len != 0 ) QIO_RETURN_CONSTANT_ERROR(EINVAL, "partial frame buffered");
+  if( clen < 0 || ulen < 0 ) QIO_RETURN_CONSTANT_ERROR(EINVAL, "negative frame size");
+
+  return _frame_writer_add(w, cdata, clen, ulen);
+}
+
+qioerr qio_frame_writer_close(qio_frame_writer_t* w)
+{
+  qioerr err;
+  int64_t i;
+
+  err = _frame_writer_compress_buffered(w);
+
+  for( i = 0; !err && i < 2*w->nframes; i++ ) {
+    err = qio_channel_write_uint64(true, QIO_LITTLE, w->ch, w->entries[i]);
+  }
+
+  if( !err ) err = qio_channel_write_amt(true, w->ch, qio_frame_magic, sizeof(qio_frame_magic));
+  if( !err ) err = qio_channel_write_uint32(true, QIO_LITTLE, w->ch, w->codec);
+  if( !err ) err = qio_channel_write_uint32(true, QIO_LITTLE, w->ch, QIO_FRAME_VERSION);
+  if( !err ) err = qio_channel_write_uint64(true, QIO_LITTLE, w->ch, w->nframes);
+  if( !err ) err = qio_channel_write_uint64(true, QIO_LITTLE, w->ch, w->frame_size);
+
+  qio_free(w->buf);
+  qio_free(w->cbuf);
+  qio_free(w->entries);
+  qio_free(w);
+
+  return err;
+}
+
+/* READING ------------------------------ */
+
+qioerr qio_frame_index_read(qio_file_t* f, int64_t end,
+                            qio_frame_index_t* idx_out)
+{
+  qio_channel_t* ch = NULL;
+  char magic[sizeof(qio_frame_magic)];
+  uint32_t codec = 0;
+  uint32_t version = 0;
+  uint64_t nframes = 0;
+  uint64_t frame_size = 0;
+  int64_t index_start;
+  int64_t i;
+  qioerr err;
+
+  memset(idx_out, 0, sizeof(qio_frame_index_t));
+
+  if( end < 0 ) {
+    err = qio_file_length(f, &end);
+    if( err ) return err;
+  }
+
+  if( end < QIO_FRAME_FOOTER_BYTES ) QIO_RETURN_CONSTANT_ERROR(EINVAL, "not a compressed file");
+
+  err = qio_channel_create(&ch, f, 0, 1, 0, end - QIO_FRAME_FOOTER_BYTES, end, NULL, 0);
+  if( err ) return err;
+
+  err = qio_channel_read_amt(false, ch, magic, sizeof(magic));
+  if( !err ) err = qio_channel_read_uint32(false, QIO_LITTLE, ch, &codec);
+  if( !err ) err = qio_channel_read_uint32(false, QIO_LITTLE, ch, &version);
+  if( !err ) err = qio_channel_read_uint64(false, QIO_LITTLE, ch, &nframes);
+  if( !err ) err = qio_channel_read_uint64(false, QIO_LITTLE, ch, &frame_size);
+  qio_channel_release(ch);
+  ch = NULL;
+  if( err ) return err;
+
+  if( memcmp(magic, qio_frame_magic, sizeof(magic)) != 0 ||
+      version != QIO_FRAME_VERSION ||
+      nframes > (uint64_t) (end - QIO_FRAME_FOOTER_BYTES) / QIO_FRAME_INDEX_ENTRY_BYTES ) {
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "not a compressed file");
+  }
+
+  index_start = end - QIO_FRAME_FOOTER_BYTES - nframes * QIO_FRAME_INDEX_ENTRY_BYTES;
+
+  idx_out->codec = (qio_codec_t) codec;
+  idx_out->nframes = nframes;
+  idx_out->frame_size = frame_size;
+  idx_out->coffset = (int64_t*) qio_malloc((nframes + 1) * sizeof(int64_t));
+  idx_out->uoffset = (int64_t*) qio_malloc((nframes + 1) * sizeof(int64_t));
+  if( !idx_out->coffset || !idx_out->uoffset ) {
+    err = QIO_ENOMEM;
+    goto error;
+  }
+
+  err = qio_channel_create(&ch, f, 0, 1, 0, index_start, end - QIO_FRAME_FOOTER_BYTES, NULL, 0);
+  if( err ) goto error;
+
+  idx_out->coffset[0] = 0;
+  idx_out->uoffset[0] = 0;
+  for( i = 0; !err && i < (int64_t) nframes; i++ ) {
+    uint64_t csize = 0;
+    uint64_t usize = 0;
+    err = qio_channel_read_uint64(false, QIO_LITTLE, ch, &csize);
+    if( !err ) err = qio_channel_read_uint64(false, QIO_LITTLE, ch, &usize);
+    if( !err && (csize > (uint64_t) index_start || usize > INT64_MAX - (uint64_t) idx_out->uoffset[i]) ) {
+      QIO_GET_CONSTANT_ERROR(err, EINVAL, "corrupt compressed file index");
+    }
+    if( !err ) {
+      idx_out->coffset[i+1] = idx_out->coffset[i] + csize;
+      idx_out->uoffset[i+1] = idx_out->uoffset[i] + usize;
+    }
+  }
+  qio_channel_release(ch);
+  if( err ) goto error;
+
+  // The frames end where the index starts; shift the offsets to match,
+  // since the compressed data doesn't have to begin at offset 0.
+  if( idx_out->coffset[nframes] > index_start ) {
+    QIO_GET_CONSTANT_ERROR(err, EINVAL, "corrupt compressed file index");
+    goto error;
+  }
+  {
+    int64_t base = index_start - idx_out->coffset[nframes];
+    for( i = 0; i <= (int64_t) nframes; i++ ) idx_out->coffset[i] += base;
+  }
+
+  return 0;
+
+error:
+  qio_frame_index_destroy(idx_out);
+  return err;
+}
+
+void qio_frame_index_destroy(qio_frame_index_t* idx)
+{
+  qio_free(idx->coffset);
+  qio_free(idx->uoffset);
+  memset(idx, 0, sizeof(qio_frame_index_t));
+}
+
+int64_t qio_frame_index_find(const qio_frame_index_t* idx, int64_t uoff)
+{
+  int64_t lo = 0;
+  int64_t hi = idx->nframes;
+
+  if( uoff < 0 || uoff >= idx->uoffset[idx->nframes] ) return idx->nframes;
+
+  // find the last frame starting at or before uoff
+  while( hi - lo > 1 ) {
+    int64_t mid = lo + (hi - lo) / 2;
+    if( idx->uoffset[mid] <= uoff ) lo = mid;
+    else hi = mid;
+  }
+
+  return lo;
+}
+
+qioerr qio_frame_read(qio_file_t* f, const qio_frame_index_t* idx,
+                      int64_t i, void* dst)
+{
+  qio_channel_t* ch = NULL;
+  int64_t clen;
+  void* cdata;
+  qioerr err;
+
+  if( i < 0 || i >= idx->nframes ) QIO_RETURN_CONSTANT_ERROR(EINVAL, "no such frame");
+
+  clen = idx->coffset[i+1] - idx->coffset[i];
+  cdata = qio_malloc(clen > 0 ? clen : 1);
+  if( !cdata ) return QIO_ENOMEM;
+
+  err = qio_channel_create(&ch, f, 0, 1, 0, idx->coffset[i], idx->coffset[i+1], NULL, 0);
+  if( !err ) {
+    err = qio_channel_read_amt(false, ch, cdata, clen);
+    qio_channel_release(ch);
+  }
+
+  if( !err ) {
+    err = qio_codec_decompress(idx->codec, cdata, clen, dst,
+                               idx->uoffset[i+1] - idx->uoffset[i]);
+  }
+
+  qio_free(cdata);
+  return err;
+}
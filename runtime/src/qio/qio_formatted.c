@@ -24,10 +24,20 @@
 #endif
 
 #include "qio_formatted.h"
+#include "qio_fastfloat.h"
 
 #include <limits.h>
 #include <ctype.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#if defined(__PCLMUL__)
+#include <wmmintrin.h>
+#endif
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 #ifdef HAS_WCTYPE_H
 #include <wctype.h>
 #include <langinfo.h>
@@ -43,6 +53,113 @@ static int wcwidth(int wc) {
 }
 #endif
 
+// Scanning helpers that work directly on the bytes already in the
+// channel's fast-path buffer (cached_cur..cached_end), 16 at a time
+// where SSE2 or NEON is available.  Each returns a pointer to the
+// first byte not in the run; callers fall back to the character-at-
+// a-time loops for whatever lies past cached_end.
+
+// Skip ' ', '\t', '\n', '\v', '\f' and '\r'.  These are whitespace in
+// every locale; anything else is left for iswspace to decide.
+static inline
+const uint8_t* _skip_ascii_space(const uint8_t* p, const uint8_t* end)
+{
+#if defined(__SSE2__)
+  const __m128i sp = _mm_set1_epi8(' ');
+  const __m128i tab = _mm_set1_epi8('\t');
+  const __m128i four = _mm_set1_epi8('\r' - '\t');
+  while( end - p >= 16 ) {
+    __m128i v = _mm_loadu_si128((const __m128i*) p);
+    __m128i d = _mm_sub_epi8(v, tab);
+    __m128i ctl = _mm_cmpeq_epi8(_mm_min_epu8(d, four), d);
+    __m128i ws = _mm_or_si128(ctl, _mm_cmpeq_epi8(v, sp));
+    int mask = _mm_movemask_epi8(ws);
+    if( mask != 0xFFFF ) return p + __builtin_ctz(~mask);
+    p += 16;
+  }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  const uint8x16_t sp = vdupq_n_u8(' ');
+  const uint8x16_t tab = vdupq_n_u8('\t');
+  const uint8x16_t four = vdupq_n_u8('\r' - '\t');
+  while( end - p >= 16 ) {
+    uint8x16_t v = vld1q_u8(p);
+    uint8x16_t ws = vorrq_u8(vcleq_u8(vsubq_u8(v, tab), four),
+                             vceqq_u8(v, sp));
+    if( vminvq_u8(ws) != 0xFF ) break;
+    p += 16;
+  }
+#endif
+  while( p < end && (*p == ' ' || (uint8_t) (*p - '\t') <= '\r' - '\t') ) {
+    p++;
+  }
+  return p;
+}
+
+// Skip decimal digits.
+static inline
+const uint8_t* _skip_decimal_digits(const uint8_t* p, const uint8_t* end)
+{
+#if defined(__SSE2__)
+  const __m128i zero = _mm_set1_epi8('0');
+  const __m128i nine = _mm_set1_epi8(9);
+  while( end - p >= 16 ) {
+    __m128i d = _mm_sub_epi8(_mm_loadu_si128((const __m128i*) p), zero);
+    int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(d, nine), d));
+    if( mask != 0xFFFF ) return p + __builtin_ctz(~mask);
+    p += 16;
+  }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  const uint8x16_t zero = vdupq_n_u8('0');
+  const uint8x16_t nine = vdupq_n_u8(9);
+  while( end - p >= 16 ) {
+    uint8x16_t d = vsubq_u8(vld1q_u8(p), zero);
+    if( vmaxvq_u8(d) > 9 ) break;
+    p += 16;
+  }
+#endif
+  while( p < end && (uint8_t) (*p - '0') <= 9 ) p++;
+  return p;
+}
+
+// Advance the channel past whitespace sitting in its buffer.
+static inline
+void _skip_cached_ascii_space(qio_channel_t* restrict ch)
+{
+  if( ch->cached_cur != NULL && ch->cached_cur < ch->cached_end ) {
+    ch->cached_cur = (void*) _skip_ascii_space((const uint8_t*) ch->cached_cur,
+                                               (const uint8_t*) ch->cached_end);
+  }
+}
+
+// Parse n <= 19 decimal digits, 8 at a time.
+static inline
+uint64_t _parse_decimal_digits(const char* p, size_t n)
+{
+  uint64_t num = 0;
+
+  while( n >= 8 ) {
+    uint64_t v;
+    memcpy(&v, p, 8);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    // combine pairs of digits, then pairs of pairs, and so on
+    v -= 0x3030303030303030ULL;
+    v = (v * 10) + (v >> 8);
+    v = (((v & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+         (((v >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+    num = num * 100000000ULL + (uint32_t) v;
+    p += 8;
+    n -= 8;
+  }
+  while( n > 0 ) {
+    num = num * 10 + (uint64_t) (*p - '0');
+    p++;
+    n--;
+  }
+  return num;
+}
+
 qioerr qio_channel_read_uvarint(const int threadsafe, qio_channel_t* restrict ch, uint64_t* restrict ptr) {
   qioerr err = 0;
   uint8_t byte;
@@ -131,6 +248,136 @@ qioerr qio_channel_write_svarint(const int threadsafe, qio_channel_t* restrict c
   return qio_channel_write_uvarint(threadsafe, ch, u_num);
 }
 
+// Swapping writes go through a bounce buffer of this size.  It's well
+// over qio_write_unbuffered_threshold, so each block is still written
+// directly rather than through the channel buffer.
+#define QIO_ARRAY_SWAP_BLOCK (256*1024)
+
+static inline
+int _array_needs_swap(int byteorder, size_t elt_size)
+{
+  if( elt_size == 1 ) return 0;
+  if( byteorder == QIO_BIG ) return htobe16(1) != 1;
+  if( byteorder == QIO_LITTLE ) return htole16(1) != 1;
+  return 0;
+}
+
+// Convert n elements between host and 'byteorder' order (the same
+// operation in both directions).  dst may equal src.  The loops are
+// simple enough for the compiler to vectorize.
+static
+void _array_swap(void* dst, const void* src, size_t elt_size, size_t n, int byteorder)
+{
+  size_t i;
+
+  switch( elt_size ) {
+    case 2:
+      for( i = 0; i < n; i++ ) {
+        uint16_t x;
+        memcpy(&x, (const char*) src + 2*i, 2);
+        x = (byteorder == QIO_BIG) ? htobe16(x) : htole16(x);
+        memcpy((char*) dst + 2*i, &x, 2);
+      }
+      break;
+    case 4:
+      for( i = 0; i < n; i++ ) {
+        uint32_t x;
+        memcpy(&x, (const char*) src + 4*i, 4);
+        x = (byteorder == QIO_BIG) ? htobe32(x) : htole32(x);
+        memcpy((char*) dst + 4*i, &x, 4);
+      }
+      break;
+    case 8:
+      for( i = 0; i < n; i++ ) {
+        uint64_t x;
+        memcpy(&x, (const char*) src + 8*i, 8);
+        x = (byteorder == QIO_BIG) ? htobe64(x) : htole64(x);
+        memcpy((char*) dst + 8*i, &x, 8);
+      }
+      break;
+  }
+}
+
+static
+qioerr _array_check(const int byteorder, size_t elt_size, int64_t nelts, ssize_t* len_out)
+{
+  if( nelts < 0 || elt_size == 0 || (uint64_t) nelts > SSIZE_MAX / elt_size ) {
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "bad array size");
+  }
+  if( _array_needs_swap(byteorder, elt_size) &&
+      elt_size != 2 && elt_size != 4 && elt_size != 8 ) {
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "cannot change byte order for element size");
+  }
+  *len_out = (ssize_t) (nelts * elt_size);
+  return 0;
+}
+
+qioerr qio_channel_read_array(const int threadsafe, const int byteorder, qio_channel_t* restrict ch, void* restrict ptr, size_t elt_size, int64_t nelts)
+{
+  ssize_t len = 0;
+  qioerr err;
+
+  err = _array_check(byteorder, elt_size, nelts, &len);
+  if( err ) return err;
+
+  if( threadsafe ) {
+    err = qio_lock(&ch->lock);
+    if( err ) return err;
+  }
+
+  err = qio_channel_read_amt(false, ch, ptr, len);
+  if( ! err && _array_needs_swap(byteorder, elt_size) ) {
+    _array_swap(ptr, ptr, elt_size, nelts, byteorder);
+  }
+
+  if( threadsafe ) {
+    qio_unlock(&ch->lock);
+  }
+
+  return err;
+}
+
+qioerr qio_channel_write_array(const int threadsafe, const int byteorder, qio_channel_t* restrict ch, const void* restrict ptr, size_t elt_size, int64_t nelts)
+{
+  ssize_t len = 0;
+  qioerr err;
+
+  err = _array_check(byteorder, elt_size, nelts, &len);
+  if( err ) return err;
+
+  if( threadsafe ) {
+    err = qio_lock(&ch->lock);
+    if( err ) return err;
+  }
+
+  if( ! _array_needs_swap(byteorder, elt_size) ) {
+    err = qio_channel_write_amt(false, ch, ptr, len);
+  } else if( len > 0 ) {
+    size_t block_elts = QIO_ARRAY_SWAP_BLOCK / elt_size;
+    size_t block_len = block_elts * elt_size;
+    void* tmp = qio_malloc(len < (ssize_t) block_len ? len : block_len);
+    int64_t done = 0;
+
+    if( ! tmp ) {
+      err = QIO_ENOMEM;
+    }
+    while( ! err && done < nelts ) {
+      size_t n = block_elts;
+      if( (int64_t) n > nelts - done ) n = nelts - done;
+      _array_swap(tmp, (const char*) ptr + done * elt_size, elt_size, n, byteorder);
+      err = qio_channel_write_amt(false, ch, tmp, n * elt_size);
+      done += n;
+    }
+    qio_free(tmp);
+  }
+
+  if( threadsafe ) {
+    qio_unlock(&ch->lock);
+  }
+
+  return err;
+}
+
 
 
 static
@@ -143,6 +390,17 @@ qioerr _peek_until_byte(qio_channel_t* restrict ch, uint8_t term_byte, int64_t*
   uint8_t byte = 0;
   int found_term;
 
+  // Fast path: the terminator is already in the buffer.
+  if( ch->cached_cur != NULL && ch->cached_cur < ch->cached_end ) {
+    const void* p = memchr(ch->cached_cur, term_byte,
+                           qio_ptr_diff(ch->cached_end, ch->cached_cur));
+    if( p != NULL ) {
+      *amt_read_out = qio_ptr_diff((void*) p, ch->cached_cur);
+      *found_term_out = 1;
+      return 0;
+    }
+  }
+
   mark_offset = qio_channel_offset_unlocked(ch);
 
   err = qio_channel_mark(false, ch);
@@ -205,12 +463,94 @@ qioerr _peek_until_len(qio_channel_t* restrict ch, ssize_t len, int64_t* restric
 }
 
 
+// Find where the record containing offset 'from' ends, that is, the
+// offset just past the first 'term' byte at or after 'from', or 'end'
+// if there isn't one.
+static
+qioerr _split_find_record_end(qio_file_t* f, qio_hint_t hints, uint8_t term, int64_t from, int64_t end, int64_t* offset_out)
+{
+  qio_channel_t* ch = NULL;
+  int64_t amt = 0;
+  int found_term = 0;
+  qioerr err;
+
+  if( f->mmap && end <= f->mmap->len &&
+      (f->hints & QIO_METHODMASK) == QIO_METHOD_MMAP ) {
+    // The whole range is mapped; just search it directly.
+    const uint8_t* base = (const uint8_t*) f->mmap->data;
+    const uint8_t* p = memchr(base + from, term, end - from);
+    *offset_out = (p == NULL) ? end : qio_ptr_diff((void*) p, (void*) base) + 1;
+    return 0;
+  }
+
+  err = qio_channel_create(&ch, f, hints, 1, 0, from, end, NULL, 0);
+  if( err ) return err;
+
+  err = _peek_until_byte(ch, term, &amt, &found_term);
+  if( qio_err_to_int(err) == EEOF ) err = 0;
+
+  qio_channel_release(ch);
+
+  if( err ) return err;
+
+  *offset_out = found_term ? from + amt + 1 : end;
+  return 0;
+}
+
+qioerr qio_file_split_records(qio_file_t* f, qio_hint_t hints, int64_t start, int64_t end, uint8_t term, int64_t nchunks, int64_t* bounds_out)
+{
+  int64_t len;
+  int64_t i;
+  qioerr err;
+
+  if( nchunks < 1 || start < 0 || end < start ) {
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "invalid range or chunk count");
+  }
+
+  if( end == INT64_MAX ) {
+    err = qio_file_length(f, &len);
+    if( err ) return err;
+    if( len < start ) len = start;
+    end = len;
+  }
+  len = end - start;
+
+  bounds_out[0] = start;
+  bounds_out[nchunks] = end;
+
+  for( i = 1; i < nchunks; i++ ) {
+    // Split points are evenly spaced; each one moves forward to the
+    // next record boundary.  Starting the search one byte early keeps
+    // a split that already falls on a boundary where it is.
+    int64_t split = start + (int64_t) ((double) len * i / nchunks);
+    int64_t from = split - 1;
+
+    if( from < start ) from = start;
+
+    if( split <= start ) {
+      bounds_out[i] = start;
+    } else if( from < bounds_out[i-1] ) {
+      // The previous chunk's last record already runs past this
+      // split point, so this chunk ends up empty.
+      bounds_out[i] = bounds_out[i-1];
+    } else {
+      err = _split_find_record_end(f, hints, term, from, end, &bounds_out[i]);
+      if( err ) return err;
+    }
+  }
+
+  return 0;
+}
+
+
 static
 qioerr _getc_after_whitespace(qio_channel_t* restrict ch, int32_t* restrict got_chr)
 {
   qioerr err = 0;
   int32_t chr = 0;
 
+  _skip_cached_ascii_space(ch);
+
   while( 1 ) {
     err = qio_channel_read_char(false, ch, &chr);
     if( ! iswspace(chr) ) break;
@@ -2151,12 +2491,490 @@ static inline bool is_json_whitespace(int32_t c)
            c == '\f' || c == '\n' || c == '\r' || c == '\t' );
 }
 
+// The rest of the JSON support looks for structural characters 64
+// bytes at a time, in the manner of simdjson. Each block gives bitmasks
+// of where the backslashes, quotes, brackets/braces/colons/commas and
+// whitespace are; from those we work out which quotes are escaped,
+// which bytes are inside strings, and so where the structural
+// characters and the starts of numbers and literals are. A small state
+// machine then checks those against the JSON grammar, optionally
+// recording a tape as it goes.
+//
+// This is stricter than the character-at-a-time skipping code above
+// (which, for example, allows trailing commas), so when skipping, a
+// value this doesn't accept, or one that runs past what is buffered,
+// is handed to that code instead.
+
+typedef struct json_block_state_s {
+  uint64_t escaped;   // bit 0 set if the next block starts escaped
+  uint64_t in_string; // all ones if the last block ended in a string
+  uint64_t scalar;    // bit 0 set if the last block ended in a scalar
+} json_block_state_t;
+
+#if defined(__ARM_NEON) && defined(__aarch64__) && !defined(__SSE2__)
+// Gather the top bits of four comparison results into a 64-bit mask.
+static inline
+uint64_t _neon_movemask64(uint8x16_t a, uint8x16_t b,
+                          uint8x16_t c, uint8x16_t d)
+{
+  const uint8x16_t bits = { 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80,
+                            0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80 };
+  uint8x16_t s0 = vpaddq_u8(vandq_u8(a, bits), vandq_u8(b, bits));
+  uint8x16_t s1 = vpaddq_u8(vandq_u8(c, bits), vandq_u8(d, bits));
+  s0 = vpaddq_u8(s0, s1);
+  s0 = vpaddq_u8(s0, s0);
+  return vgetq_lane_u64(vreinterpretq_u64_u8(s0), 0);
+}
+#endif
+
+static inline
+void _json_block_masks(const uint8_t* p, uint64_t* bs_out,
+                       uint64_t* quote_out, uint64_t* op_out,
+                       uint64_t* ws_out)
+{
+#if defined(__SSE2__)
+  const __m128i backslash = _mm_set1_epi8('\\');
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i lower = _mm_set1_epi8(0x20);
+  const __m128i lbrace = _mm_set1_epi8('{');
+  const __m128i rbrace = _mm_set1_epi8('}');
+  const __m128i colon = _mm_set1_epi8(':');
+  const __m128i comma = _mm_set1_epi8(',');
+  const __m128i sp = _mm_set1_epi8(' ');
+  const __m128i bsp = _mm_set1_epi8('\b');
+  const __m128i five = _mm_set1_epi8('\r' - '\b');
+  const __m128i vt = _mm_set1_epi8('\v');
+  uint64_t bs = 0, qu = 0, op = 0, ws = 0;
+  int i;
+
+  for( i = 0; i < 4; i++ ) {
+    __m128i v = _mm_loadu_si128((const __m128i*) (p + 16*i));
+    // '[' and ']' are '{' and '}' without the 0x20 bit
+    __m128i l = _mm_or_si128(v, lower);
+    __m128i o = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(l, lbrace),
+                                          _mm_cmpeq_epi8(l, rbrace)),
+                             _mm_or_si128(_mm_cmpeq_epi8(v, colon),
+                                          _mm_cmpeq_epi8(v, comma)));
+    // '\b' through '\r' other than '\v', and ' '
+    __m128i d = _mm_sub_epi8(v, bsp);
+    __m128i ctl = _mm_andnot_si128(_mm_cmpeq_epi8(v, vt),
+                                   _mm_cmpeq_epi8(_mm_min_epu8(d, five), d));
+    __m128i w = _mm_or_si128(ctl, _mm_cmpeq_epi8(v, sp));
+    int shift = 16*i;
+    bs |= (uint64_t) (uint16_t)
+          _mm_movemask_epi8(_mm_cmpeq_epi8(v, backslash)) << shift;
+    qu |= (uint64_t) (uint16_t)
+          _mm_movemask_epi8(_mm_cmpeq_epi8(v, quote)) << shift;
+    op |= (uint64_t) (uint16_t) _mm_movemask_epi8(o) << shift;
+    ws |= (uint64_t) (uint16_t) _mm_movemask_epi8(w) << shift;
+  }
+  *bs_out = bs;
+  *quote_out = qu;
+  *op_out = op;
+  *ws_out = ws;
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  const uint8x16_t backslash = vdupq_n_u8('\\');
+  const uint8x16_t quote = vdupq_n_u8('"');
+  const uint8x16_t lower = vdupq_n_u8(0x20);
+  const uint8x16_t lbrace = vdupq_n_u8('{');
+  const uint8x16_t rbrace = vdupq_n_u8('}');
+  const uint8x16_t colon = vdupq_n_u8(':');
+  const uint8x16_t comma = vdupq_n_u8(',');
+  const uint8x16_t sp = vdupq_n_u8(' ');
+  const uint8x16_t bsp = vdupq_n_u8('\b');
+  const uint8x16_t five = vdupq_n_u8('\r' - '\b');
+  const uint8x16_t vt = vdupq_n_u8('\v');
+  uint8x16_t b[4], q[4], o[4], w[4];
+  int i;
+
+  for( i = 0; i < 4; i++ ) {
+    uint8x16_t v = vld1q_u8(p + 16*i);
+    uint8x16_t l = vorrq_u8(v, lower);
+    b[i] = vceqq_u8(v, backslash);
+    q[i] = vceqq_u8(v, quote);
+    o[i] = vorrq_u8(vorrq_u8(vceqq_u8(l, lbrace), vceqq_u8(l, rbrace)),
+                    vorrq_u8(vceqq_u8(v, colon), vceqq_u8(v, comma)));
+    w[i] = vorrq_u8(vbicq_u8(vcleq_u8(vsubq_u8(v, bsp), five),
+                             vceqq_u8(v, vt)),
+                    vceqq_u8(v, sp));
+  }
+  *bs_out = _neon_movemask64(b[0], b[1], b[2], b[3]);
+  *quote_out = _neon_movemask64(q[0], q[1], q[2], q[3]);
+  *op_out = _neon_movemask64(o[0], o[1], o[2], o[3]);
+  *ws_out = _neon_movemask64(w[0], w[1], w[2], w[3]);
+#else
+  uint64_t bs = 0, qu = 0, op = 0, ws = 0;
+  int i;
+
+  for( i = 0; i < 64; i++ ) {
+    uint8_t c = p[i];
+    uint64_t bit = (uint64_t) 1 << i;
+    if( c == '\\' ) bs |= bit;
+    else if( c == '"' ) qu |= bit;
+    else if( c == '{' || c == '}' || c == '[' || c == ']' ||
+             c == ':' || c == ',' ) op |= bit;
+    else if( is_json_whitespace(c) ) ws |= bit;
+  }
+  *bs_out = bs;
+  *quote_out = qu;
+  *op_out = op;
+  *ws_out = ws;
+#endif
+}
+
+// Bit i of the result is the xor of bits 0..i of x.
+static inline
+uint64_t _json_prefix_xor(uint64_t x)
+{
+#if defined(__SSE2__) && defined(__PCLMUL__)
+  __m128i r = _mm_clmulepi64_si128(_mm_set_epi64x(0, (int64_t) x),
+                                   _mm_set1_epi8((char) 0xFF), 0);
+  return (uint64_t) _mm_cvtsi128_si64(r);
+#else
+  x ^= x << 1;
+  x ^= x << 2;
+  x ^= x << 4;
+  x ^= x << 8;
+  x ^= x << 16;
+  x ^= x << 32;
+  return x;
+#endif
+}
+
+// Return a mask of the structural positions in the 64 bytes at p:
+// brackets, braces, colons and commas outside of strings, every
+// unescaped quote, and the first byte of each number or literal.
+static inline
+uint64_t _json_block_structurals(json_block_state_t* s, const uint8_t* p)
+{
+  uint64_t bs, quote, op, ws;
+  uint64_t escaped, in_string, string_tail, scalar, nonquote, follows;
+  uint64_t b;
+
+  _json_block_masks(p, &bs, &quote, &op, &ws);
+
+  // Backslashes are rare enough to visit one at a time. A backslash
+  // escapes the next byte unless it is escaped itself.
+  escaped = s->escaped;
+  s->escaped = 0;
+  for( b = bs; b != 0; b &= b - 1 ) {
+    int i = __builtin_ctzll(b);
+    uint64_t bit = (uint64_t) 1 << i;
+    if( escaped & bit ) continue;
+    if( i == 63 ) s->escaped = 1;
+    else escaped |= bit << 1;
+  }
+  quote &= ~escaped;
+
+  // in_string covers each opening quote and what follows it, up to but
+  // not including the closing quote.
+  in_string = _json_prefix_xor(quote) ^ s->in_string;
+  s->in_string = (uint64_t) ((int64_t) in_string >> 63);
+  string_tail = in_string ^ quote;
+
+  // A scalar starts wherever a byte that isn't whitespace or an
+  // operator doesn't follow another such byte.
+  scalar = ~(op | ws);
+  nonquote = scalar & ~quote;
+  follows = (nonquote << 1) | s->scalar;
+  s->scalar = nonquote >> 63;
+
+  return ((op | (scalar & ~follows)) & ~string_tail) | quote;
+}
+
+static inline
+bool _json_is_delim(uint8_t c)
+{
+  return c == '{' || c == '}' || c == '[' || c == ']' || c == ':' ||
+         c == ',' || c == '"' || is_json_whitespace(c);
+}
+
+static
+bool _json_valid_number(const uint8_t* p, const uint8_t* end)
+{
+  const uint8_t* q;
+
+  if( p < end && *p == '-' ) p++;
+  if( p == end ) return false;
+  if( *p == '0' ) {
+    p++;
+  } else if( '1' <= *p && *p <= '9' ) {
+    p = _skip_decimal_digits(p, end);
+  } else {
+    return false;
+  }
+  if( p < end && *p == '.' ) {
+    q = ++p;
+    p = _skip_decimal_digits(p, end);
+    if( p == q ) return false;
+  }
+  if( p < end && (*p == 'e' || *p == 'E') ) {
+    p++;
+    if( p < end && (*p == '+' || *p == '-') ) p++;
+    q = p;
+    p = _skip_decimal_digits(p, end);
+    if( p == q ) return false;
+  }
+  return p == end;
+}
+
+enum {
+  JSON_WALK_VALUE,      // a whole value
+  JSON_WALK_FIELD,      // "key": value
+  JSON_WALK_OBJECT_END, // the rest of an object after its '{'
+  JSON_WALK_ARRAY_END,  // the rest of an array after its '['
+  JSON_WALK_STRING_END, // the rest of a string after its '"'
+};
+
+enum {
+  JSON_WALK_DONE,
+  JSON_WALK_INCOMPLETE, // ran out of input
+  JSON_WALK_INVALID,
+  JSON_WALK_NOMEM,
+};
+
+// What the state machine is expecting next.
+enum {
+  JS_VALUE,
+  JS_VALUE_OR_END, // just after '['
+  JS_KEY,
+  JS_KEY_OR_END,   // just after '{'
+  JS_COLON,
+  JS_COMMA_OR_END,
+  JS_STRING_END,
+};
+
+static inline
+bool _json_tape_push(qio_json_tape_t* t, int32_t type,
+                     int64_t start, int64_t end)
+{
+  qio_json_tape_entry_t* e;
+
+  if( t->n == t->cap ) {
+    int64_t cap = t->cap ? 2 * t->cap : 64;
+    e = (qio_json_tape_entry_t*) qio_realloc(t->entries, cap * sizeof(*e));
+    if( ! e ) return false;
+    t->entries = e;
+    t->cap = cap;
+  }
+  e = &t->entries[t->n];
+  e->start = start;
+  e->end = end;
+  e->next = ++t->n;
+  e->type = type;
+  return true;
+}
+
+// Check the JSON in buf against the grammar, starting as mode says,
+// and find where it ends. If at_eof is false, buf is only the part of
+// the input that happens to be available, so a number or literal
+// running up to the end of it might continue. For JSON_WALK_VALUE and
+// JSON_WALK_FIELD, *type_out gets the type of the (field's) value.
+static
+int _json_walk(const uint8_t* buf, size_t len, bool at_eof, int mode,
+               qio_json_tape_t* tape, size_t* end_out, int32_t* type_out)
+{
+  json_block_state_t s = {0, 0, 0};
+  uint8_t open[QIO_JSON_MAX_DEPTH];
+  int64_t open_entry[QIO_JSON_MAX_DEPTH];
+  int depth = 0;
+  int state = JS_VALUE;
+  bool key = false;
+  int32_t type = 0;
+  int64_t string_entry = 0;
+  size_t off;
+
+  switch( mode ) {
+    case JSON_WALK_FIELD:
+      state = JS_KEY;
+      break;
+    case JSON_WALK_OBJECT_END:
+      open[depth++] = '{';
+      state = JS_KEY_OR_END;
+      break;
+    case JSON_WALK_ARRAY_END:
+      open[depth++] = '[';
+      state = JS_VALUE_OR_END;
+      break;
+    case JSON_WALK_STRING_END:
+      s.in_string = ~(uint64_t) 0;
+      state = JS_STRING_END;
+      break;
+  }
+
+  for( off = 0; off < len; off += 64 ) {
+    uint64_t st;
+
+    if( len - off >= 64 ) {
+      st = _json_block_structurals(&s, buf + off);
+    } else {
+      uint8_t tmp[64];
+      memset(tmp, ' ', sizeof(tmp));
+      memcpy(tmp, buf + off, len - off);
+      st = _json_block_structurals(&s, tmp);
+      st &= ((uint64_t) 1 << (len - off)) - 1;
+    }
+
+    for( ; st != 0; st &= st - 1 ) {
+      size_t i = off + __builtin_ctzll(st);
+      uint8_t c = buf[i];
+      size_t end = i + 1;
+
+      switch( state ) {
+        case JS_STRING_END:
+          if( c != '"' ) return JSON_WALK_INVALID;
+          if( tape ) tape->entries[string_entry].end = end;
+          if( key ) {
+            key = false;
+            state = JS_COLON;
+            continue;
+          }
+          goto value_done;
+
+        case JS_KEY_OR_END:
+          if( c == '}' ) goto close;
+          // fall through
+        case JS_KEY:
+          if( c != '"' ) return JSON_WALK_INVALID;
+          if( tape ) {
+            string_entry = tape->n;
+            if( ! _json_tape_push(tape, QIO_JSON_STRING, i, 0) ) {
+              return JSON_WALK_NOMEM;
+            }
+          }
+          key = true;
+          state = JS_STRING_END;
+          continue;
+
+        case JS_COLON:
+          if( c != ':' ) return JSON_WALK_INVALID;
+          state = JS_VALUE;
+          continue;
+
+        case JS_COMMA_OR_END:
+          if( c == ',' ) {
+            state = open[depth-1] == '{' ? JS_KEY : JS_VALUE;
+            continue;
+          }
+          if( c == '}' || c == ']' ) goto close;
+          return JSON_WALK_INVALID;
+
+        case JS_VALUE_OR_END:
+          if( c == ']' ) goto close;
+          // fall through
+        case JS_VALUE:
+          break;
+      }
+
+      // Now c starts a value.
+      if( c == '{' || c == '[' ) {
+        if( depth == QIO_JSON_MAX_DEPTH ) return JSON_WALK_INVALID;
+        if( depth == 0 ) {
+          type = c == '{' ? QIO_JSON_OBJECT : QIO_JSON_ARRAY;
+        }
+        if( tape ) {
+          open_entry[depth] = tape->n;
+          if( ! _json_tape_push(tape, c == '{' ? QIO_JSON_OBJECT
+                                               : QIO_JSON_ARRAY, i, 0) ) {
+            return JSON_WALK_NOMEM;
+          }
+        }
+        open[depth++] = c;
+        state = c == '{' ? JS_KEY_OR_END : JS_VALUE_OR_END;
+        continue;
+      } else if( c == '"' ) {
+        if( depth == 0 ) type = QIO_JSON_STRING;
+        if( tape ) {
+          string_entry = tape->n;
+          if( ! _json_tape_push(tape, QIO_JSON_STRING, i, 0) ) {
+            return JSON_WALK_NOMEM;
+          }
+        }
+        state = JS_STRING_END;
+        continue;
+      } else if( c == ',' || c == ':' || c == '}' || c == ']' ) {
+        return JSON_WALK_INVALID;
+      } else {
+        // A number or literal runs to the next delimiter.
+        int32_t t;
+        end = i + 1;
+        while( end < len && ! _json_is_delim(buf[end]) ) end++;
+        if( end == len && ! at_eof ) return JSON_WALK_INCOMPLETE;
+        if( c == 't' && end - i == 4 && memcmp(buf + i, "true", 4) == 0 ) {
+          t = QIO_JSON_TRUE;
+        } else if( c == 'f' && end - i == 5 &&
+                   memcmp(buf + i, "false", 5) == 0 ) {
+          t = QIO_JSON_FALSE;
+        } else if( c == 'n' && end - i == 4 &&
+                   memcmp(buf + i, "null", 4) == 0 ) {
+          t = QIO_JSON_NULL;
+        } else if( _json_valid_number(buf + i, buf + end) ) {
+          t = QIO_JSON_NUMBER;
+        } else {
+          return JSON_WALK_INVALID;
+        }
+        if( depth == 0 ) type = t;
+        if( tape && ! _json_tape_push(tape, t, i, end) ) {
+          return JSON_WALK_NOMEM;
+        }
+        goto value_done;
+      }
+
+    close:
+      if( (c == '}') != (open[depth-1] == '{') ) return JSON_WALK_INVALID;
+      depth--;
+      if( tape && mode == JSON_WALK_VALUE ) {
+        qio_json_tape_entry_t* e = &tape->entries[open_entry[depth]];
+        e->end = end;
+        e->next = tape->n;
+      }
+
+    value_done:
+      if( depth == 0 ) {
+        *end_out = end;
+        if( type_out ) *type_out = type;
+        return JSON_WALK_DONE;
+      }
+      state = JS_COMMA_OR_END;
+    }
+  }
+
+  return JSON_WALK_INCOMPLETE;
+}
+
+// Skip a JSON value, field, or the rest of one, if the channel's
+// buffer holds all of it. Returns false if the caller should do it a
+// byte at a time.
+static inline
+bool _qio_json_skip_cached(qio_channel_t* restrict ch, int mode,
+                           int32_t* ret)
+{
+  const uint8_t* p = (const uint8_t*) ch->cached_cur;
+  const uint8_t* end = (const uint8_t*) ch->cached_end;
+  size_t used;
+  int32_t type = 0;
+
+  if( p == NULL || p >= end ) return false;
+  if( _json_walk(p, end - p, false, mode, NULL, &used, &type)
+      != JSON_WALK_DONE ) {
+    return false;
+  }
+  ch->cached_cur = (void*) (p + used);
+
+  // The byte-at-a-time code reads one character past a number.
+  if( type == QIO_JSON_NUMBER ) *ret = qio_channel_read_byte(false, ch);
+  else *ret = 0;
+  return true;
+}
+
 // Read and skip an arbitrary JSON object, assuming the leading '{'
 // has already been read. Returns 0 on success or a negative error code.
 int32_t qio_skip_json_object_unlocked(qio_channel_t* restrict ch)
 {
   int32_t c;
 
+  if( _qio_json_skip_cached(ch, JSON_WALK_OBJECT_END, &c) ) return c;
+
   while( true ) {
     // Read a field.
     c = qio_skip_json_field_unlocked(ch);
@@ -2192,6 +3010,8 @@ int32_t qio_skip_json_array_unlocked(qio_channel_t* restrict ch)
 {
   int32_t c;
 
+  if( _qio_json_skip_cached(ch, JSON_WALK_ARRAY_END, &c) ) return c;
+
   while( true ) {
     // Read a value.
     c = qio_skip_json_value_unlocked(ch);
@@ -2229,6 +3049,8 @@ int32_t qio_skip_json_value_unlocked(qio_channel_t* restrict ch)
 {
   int32_t c;
 
+  if( _qio_json_skip_cached(ch, JSON_WALK_VALUE, &c) ) return c;
+
   // Read whitespace and then a value.
   while( true ) {
     c = qio_channel_read_byte(false, ch);
@@ -2352,6 +3174,8 @@ int32_t qio_skip_json_string_unlocked(qio_channel_t* restrict ch)
 {
   int32_t c;
 
+  if( _qio_json_skip_cached(ch, JSON_WALK_STRING_END, &c) ) return c;
+
   while( true ) {
     c = qio_channel_read_byte(false, ch);
     if( c < 0 ) return c;
@@ -2380,6 +3204,8 @@ int32_t qio_skip_json_field_unlocked(qio_channel_t* restrict ch)
 {
   int32_t c;
 
+  if( _qio_json_skip_cached(ch, JSON_WALK_FIELD, &c) ) return c;
+
   // Read a whitespace followed by " or '}'
   while( true ) {
     c = qio_channel_read_byte(false, ch);
@@ -2469,6 +3295,157 @@ unlock:
 
 }
 
+void qio_json_tape_init(qio_json_tape_t* t)
+{
+  memset(t, 0, sizeof(*t));
+}
+
+void qio_json_tape_destroy(qio_json_tape_t* t)
+{
+  qio_free(t->entries);
+  qio_free(t->buf);
+  memset(t, 0, sizeof(*t));
+}
+
+qioerr qio_json_tape_parse(qio_json_tape_t* t, const char* text, int64_t len,
+                           int64_t* used_out)
+{
+  size_t used;
+
+  t->n = 0;
+  t->text = text;
+
+  if( len < 0 ) QIO_RETURN_CONSTANT_ERROR(EINVAL, "negative length");
+
+  switch( _json_walk((const uint8_t*) text, len, true, JSON_WALK_VALUE, t,
+                     &used, NULL) ) {
+    case JSON_WALK_DONE:
+      if( used_out ) *used_out = used;
+      return 0;
+    case JSON_WALK_NOMEM:
+      t->n = 0;
+      return QIO_ENOMEM;
+    case JSON_WALK_INCOMPLETE:
+      if( t->n == 0 ) QIO_RETURN_CONSTANT_ERROR(EEOF, "no JSON value");
+      t->n = 0;
+      QIO_RETURN_CONSTANT_ERROR(EFORMAT, "truncated JSON value");
+    default:
+      t->n = 0;
+      QIO_RETURN_CONSTANT_ERROR(EFORMAT, "invalid JSON value");
+  }
+}
+
+static
+qioerr _json_tape_reserve_text(qio_json_tape_t* t, int64_t len)
+{
+  if( len > t->buf_cap ) {
+    char* buf = (char*) qio_realloc(t->buf, len);
+    if( ! buf ) return QIO_ENOMEM;
+    t->buf = buf;
+    t->buf_cap = len;
+  }
+  t->text = t->buf;
+  return 0;
+}
+
+qioerr qio_channel_read_json_tape(const int threadsafe, qio_channel_t* ch,
+                                  qio_json_tape_t* t)
+{
+  qioerr err;
+  const uint8_t* p;
+  const uint8_t* end;
+  size_t used;
+  int32_t got;
+  int64_t start_offset;
+  int64_t offset;
+  int64_t len;
+
+  if( threadsafe ) {
+    err = qio_lock(&ch->lock);
+    if( err ) return err;
+  }
+
+  t->n = 0;
+
+  // Usually the whole value is already in the buffer.
+  p = (const uint8_t*) ch->cached_cur;
+  end = (const uint8_t*) ch->cached_end;
+  if( p != NULL && p < end ) {
+    int rc = _json_walk(p, end - p, false, JSON_WALK_VALUE, t, &used, NULL);
+    if( rc == JSON_WALK_NOMEM ) {
+      t->n = 0;
+      err = QIO_ENOMEM;
+      goto unlock;
+    }
+    if( rc == JSON_WALK_DONE ) {
+      err = _json_tape_reserve_text(t, used);
+      if( err ) {
+        t->n = 0;
+        goto unlock;
+      }
+      memcpy(t->buf, p, used);
+      ch->cached_cur = (void*) (p + used);
+      goto unlock;
+    }
+    t->n = 0;
+  }
+
+  // Otherwise, find where the value ends the slow way, then read it.
+  start_offset = qio_channel_offset_unlocked(ch);
+
+  err = qio_channel_mark(false, ch);
+  if( err ) goto unlock;
+
+  got = qio_skip_json_value_unlocked(ch);
+  if( got < 0 ) {
+    err = qio_int_to_err(-got);
+    qio_channel_revert_unlocked(ch);
+    goto unlock;
+  }
+  offset = qio_channel_offset_unlocked(ch);
+  // don't count the character after a number
+  if( got > 0 && offset > start_offset ) offset--;
+  qio_channel_revert_unlocked(ch);
+  len = offset - start_offset;
+
+  err = _json_tape_reserve_text(t, len);
+  if( err ) goto unlock;
+
+  err = qio_channel_mark(false, ch);
+  if( err ) goto unlock;
+
+  err = qio_channel_read_amt(false, ch, t->buf, len);
+  if( ! err ) err = qio_json_tape_parse(t, t->buf, len, NULL);
+
+  if( err ) qio_channel_revert_unlocked(ch);
+  else qio_channel_commit_unlocked(ch);
+
+unlock:
+  _qio_channel_set_error_unlocked(ch, err);
+  if( threadsafe ) {
+    qio_unlock(&ch->lock);
+  }
+  return err;
+}
+
+int64_t qio_json_tape_find_field(const qio_json_tape_t* t, int64_t i,
+                                 const char* name, int64_t namelen)
+{
+  int64_t k, end;
+
+  if( i < 0 || i >= t->n || t->entries[i].type != QIO_JSON_OBJECT ) return -1;
+
+  end = t->entries[i].next;
+  for( k = i + 1; k < end; k = t->entries[k+1].next ) {
+    const qio_json_tape_entry_t* key = &t->entries[k];
+    if( key->end - key->start - 2 == namelen &&
+        memcmp(t->text + key->start + 1, name, namelen) == 0 ) {
+      return k + 1;
+    }
+  }
+  return -1;
+}
+
 // only support floating point numbers in
 // base 10, or base 16 (with decimal exponent).
 //
@@ -2566,6 +3543,7 @@ qioerr _peek_number_unlocked(qio_channel_t* restrict ch, number_reading_state_t*
   if( err ) return err;
 
   // First, skip any whitespace.
+  _skip_cached_ascii_space(ch);
   do {
     NEXT_CHR;
   } while( iswspace(chr) );
@@ -2694,6 +3672,12 @@ qioerr _peek_number_unlocked(qio_channel_t* restrict ch, number_reading_state_t*
       // Continue to read digits.
     } else if( s->usebase <= 10 && ('0' <= chr && chr < '0' + s->usebase) ) {
       // have digit.
+      if( s->usebase == 10 && ch->cached_cur != NULL ) {
+        // take the rest of the run from the buffer in one go
+        ch->cached_cur = (void*) _skip_decimal_digits(
+                                   (const uint8_t*) ch->cached_cur,
+                                   (const uint8_t*) ch->cached_end);
+      }
       NEXT_CHR_OR_EOF;
     } else if( s->usebase > 10 &&
                ( ('0' <= chr && chr <= '9') ||
@@ -2722,6 +3706,68 @@ error:
 }
 
 
+// Convert a decimal number made of digits, an optional radix point and
+// more digits, and an optional exponent, occupying all of [p, end).
+// Returns 0 when it needs strtod instead: too many significant digits,
+// anything unexpected in the text, or a result that would overflow or
+// underflow.
+static
+int _scan_decimal_fast(const char* p, const char* end, const number_reading_state_t* s, double* out)
+{
+  uint64_t w = 0;
+  int ndigits = 0;
+  int64_t q = 0;
+  int seen_digit = 0;
+
+#define ACCUMULATE_DIGIT \
+  { \
+    if( ndigits > 0 || *p != '0' ) { \
+      if( ndigits == 19 ) return 0; \
+      w = w * 10 + (uint64_t) (*p - '0'); \
+      ndigits++; \
+    } \
+    seen_digit = 1; \
+  }
+
+  while( p < end && (uint8_t) (*p - '0') <= 9 ) {
+    ACCUMULATE_DIGIT;
+    p++;
+  }
+  if( p < end && tolower((unsigned char) *p) == s->point_char ) {
+    p++;
+    while( p < end && (uint8_t) (*p - '0') <= 9 ) {
+      ACCUMULATE_DIGIT;
+      q--;
+      p++;
+    }
+  }
+#undef ACCUMULATE_DIGIT
+
+  if( ! seen_digit ) return 0;
+
+  if( p < end && tolower((unsigned char) *p) == s->exponent_char ) {
+    int64_t e = 0;
+    int eneg = 0;
+    p++;
+    if( p < end && tolower((unsigned char) *p) == s->negative_char ) {
+      eneg = 1;
+      p++;
+    } else if( p < end && tolower((unsigned char) *p) == s->positive_char ) {
+      p++;
+    }
+    if( p == end || (uint8_t) (*p - '0') > 9 ) return 0;
+    while( p < end && (uint8_t) (*p - '0') <= 9 ) {
+      if( e < 100000 ) e = e * 10 + (*p - '0');
+      p++;
+    }
+    q += eneg ? -e : e;
+  }
+
+  if( p != end ) return 0;
+
+  return qio_ff_convert(w, q, s->sign < 0, out);
+}
+
 qioerr qio_channel_scan_int(const int threadsafe, qio_channel_t* restrict ch, void* restrict out, size_t len, int issigned)
 {
   unsigned long long int num = 0;
@@ -2787,8 +3833,19 @@ qioerr qio_channel_scan_int(const int threadsafe, qio_channel_t* restrict ch, vo
 
   //printf("Scanning int %s in base %i\n", buf, st.gotbase);
 
-  // Now read the number.
-  num = strtoull( buf + st.digits_start - start, &end, st.gotbase );
+  // Now read the number.  Plain decimal integers too short to overflow
+  // are common enough to convert here.
+  if( st.gotbase == 10 && st.point == -1 &&
+      st.end - st.digits_start <= 19 && st.end > st.digits_start &&
+      _skip_decimal_digits((const uint8_t*) buf + st.digits_start - start,
+                           (const uint8_t*) buf + st.end - start) ==
+        (const uint8_t*) buf + st.end - start ) {
+    num = _parse_decimal_digits(buf + st.digits_start - start,
+                                st.end - st.digits_start);
+    end = buf + st.end - start;
+  } else {
+    num = strtoull( buf + st.digits_start - start, &end, st.gotbase );
+  }
   if( num == ULLONG_MAX ) {
     // overflow.
     err = qio_mkerror_errno();
@@ -2955,6 +4012,15 @@ qioerr qio_channel_scan_float_or_imag(const int threadsafe, qio_channel_t* restr
   digits_start = 3 + st.digits_start - start;
   point = 3 + st.point - start;
   exponent = 3 + st.exponent - start;;
+
+  // Most decimal input can be converted without strtod.
+  if( st.gotbase == 10 && ! st.is_nan && ! st.is_inf &&
+      _scan_decimal_fast(buf + digits_start,
+                         buf + 3 + ((st.i_after != -1) ? st.i_after - 1
+                                                       : st.end) - start,
+                         &st, &num) ) {
+    goto converted;
+  }
   //end = 3 + st.end - start;
 
   //printf("read '%s', d %i p %i e %i e %i\n", buf, digits_start, point, exponent, end);
@@ -3027,6 +4093,7 @@ qioerr qio_channel_scan_float_or_imag(const int threadsafe, qio_channel_t* restr
     goto error;
   }
 
+converted:
   err = 0;
 
 error:
@@ -3062,6 +4129,39 @@ qioerr qio_channel_scan_imag(const int threadsafe, qio_channel_t* restrict ch, v
   return qio_channel_scan_float_or_imag(false, ch, out, len, true);
 }
 
+static const char _digit_pairs[201] =
+  "00010203040506070809"
+  "10111213141516171819"
+  "20212223242526272829"
+  "30313233343536373839"
+  "40414243444546474849"
+  "50515253545556575859"
+  "60616263646566676869"
+  "70717273747576777879"
+  "80818283848586878889"
+  "90919293949596979899";
+
+// Like _ltoa_convert for base 10, two digits at a time.
+static inline int _ltoa_convert_dec(char *tmp, int tmplen, uint64_t num)
+{
+  int at = tmplen - 1;
+
+  tmp[at] = '\0';
+  while( num >= 100 ) {
+    int pair = 2 * (int) (num % 100);
+    num /= 100;
+    tmp[--at] = _digit_pairs[pair + 1];
+    tmp[--at] = _digit_pairs[pair];
+  }
+  if( num >= 10 ) {
+    tmp[--at] = _digit_pairs[2 * num + 1];
+    tmp[--at] = _digit_pairs[2 * num];
+  } else {
+    tmp[--at] = '0' + num;
+  }
+  return at;
+}
+
 // core of ltoa for arbitrary base.
 // Fills in tmp from right to left
 // Returns the number of positions in tmp to skip to get to number.
@@ -3113,7 +4213,7 @@ int _ltoa(char* restrict dst, size_t size, uint64_t num, int isnegative,
   else if( base == 8 )
     tmp_skip = _ltoa_convert(tmp, sizeof(tmp), num, 8, 0);
   else if( base == 10 )
-    tmp_skip = _ltoa_convert(tmp, sizeof(tmp), num, 10, 0);
+    tmp_skip = _ltoa_convert_dec(tmp, sizeof(tmp), num);
   else if( base == 16 )
     tmp_skip = _ltoa_convert(tmp, sizeof(tmp), num, 16, style->uppercase);
   else
@@ -3248,6 +4348,191 @@ static int _find_prec(char *buf, int len){
   return last_dig;
 }
 
+// Fast paths for _ftoa_core with the default precision, which is most
+// output. They produce exactly what snprintf would, getting the digits
+// from a single multiplication or division by an exact power of ten;
+// when that leaves the rounding in doubt, or the number is out of
+// range, they return -1 and snprintf is used after all.
+
+static const double _exact_pow10[] = {
+  1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Round y >= 0, the result of one correctly rounded operation, to an
+// integer. Returns false if y is too close to halfway for its rounding
+// error not to matter.
+static inline
+bool _round_scaled(double y, uint64_t* out)
+{
+  double f = floor(y);
+  double frac = y - f;
+
+  if( fabs(frac - 0.5) <= y * 0x1p-50 ) return false;
+  *out = (uint64_t) f + (frac > 0.5);
+  return true;
+}
+
+// Round num > 0 to ndigits <= 9 significant digits, setting *digits_out
+// to a number with exactly ndigits digits and *exp_out to the decimal
+// exponent of the first one.
+static
+bool _round_sig_digits(double num, int ndigits,
+                       uint64_t* digits_out, int* exp_out)
+{
+  const double lo = _exact_pow10[ndigits - 1];
+  const double hi = _exact_pow10[ndigits];
+  int b, e10, k, tries;
+  double y;
+  uint64_t m;
+
+  // An estimate of floor(log10(num)) that is at most one too small.
+  frexp(num, &b);
+  e10 = ((b - 1) * 78913) >> 18;
+
+  for( tries = 0; tries < 3; tries++ ) {
+    k = ndigits - 1 - e10;
+    if( k > 22 || k < -22 ) return false;
+    y = (k >= 0) ? num * _exact_pow10[k] : num / _exact_pow10[-k];
+    if( y >= hi ) e10++;
+    else if( y < lo ) e10--;
+    else break;
+  }
+  if( tries == 3 ) return false;
+
+  if( ! _round_scaled(y, &m) ) return false;
+  if( m == (uint64_t) hi ) {
+    m = (uint64_t) lo;
+    e10++;
+  }
+  *digits_out = m;
+  *exp_out = e10;
+  return true;
+}
+
+// Write the n decimal digits of num to dst.
+static inline
+void _put_digits(char* dst, uint64_t num, int n)
+{
+  while( n >= 2 ) {
+    int pair = 2 * (int) (num % 100);
+    num /= 100;
+    n -= 2;
+    dst[n] = _digit_pairs[pair];
+    dst[n + 1] = _digit_pairs[pair + 1];
+  }
+  if( n == 1 ) dst[0] = '0' + num;
+}
+
+static inline
+int _put_exponent(char* dst, int e10, int uppercase)
+{
+  int i = 0;
+
+  dst[i++] = uppercase ? 'E' : 'e';
+  dst[i++] = e10 < 0 ? '-' : '+';
+  if( e10 < 0 ) e10 = -e10;
+  if( e10 >= 100 ) {
+    dst[i++] = '0' + e10 / 100;
+    e10 %= 100;
+  }
+  dst[i++] = _digit_pairs[2 * e10];
+  dst[i++] = _digit_pairs[2 * e10 + 1];
+  return i;
+}
+
+// Finish a fast conversion the way snprintf would.
+static inline
+int _ftoa_fast_copy(char* buf, size_t buf_sz, const char* tmp, int len)
+{
+  if( buf_sz > 0 ) {
+    size_t n = ((size_t) len < buf_sz) ? (size_t) len : buf_sz - 1;
+    memcpy(buf, tmp, n);
+    buf[n] = '\0';
+  }
+  return len;
+}
+
+// %g, except that numbers in [100000, 1000000) are written with an
+// exponent, as _ftoa_core does.
+static
+int _ftoa_fast_g(char* buf, size_t buf_sz, double num, int uppercase)
+{
+  char digits[6];
+  char tmp[32];
+  uint64_t m;
+  int e10, ndig, i = 0;
+
+  if( num == 0 ) return _ftoa_fast_copy(buf, buf_sz, "0", 1);
+  if( ! _round_sig_digits(num, 6, &m, &e10) ) return -1;
+
+  _put_digits(digits, m, 6);
+  for( ndig = 6; ndig > 1 && digits[ndig - 1] == '0'; ndig-- ) ;
+
+  if( e10 < -4 || e10 >= 6 || (num >= 100000.0 && num < 1000000.0) ) {
+    tmp[i++] = digits[0];
+    if( ndig > 1 ) {
+      tmp[i++] = '.';
+      memcpy(tmp + i, digits + 1, ndig - 1);
+      i += ndig - 1;
+    }
+    i += _put_exponent(tmp + i, e10, uppercase);
+  } else if( e10 >= 0 ) {
+    memcpy(tmp, digits, e10 + 1);
+    i = e10 + 1;
+    if( ndig > e10 + 1 ) {
+      tmp[i++] = '.';
+      memcpy(tmp + i, digits + e10 + 1, ndig - e10 - 1);
+      i += ndig - e10 - 1;
+    }
+  } else {
+    tmp[i++] = '0';
+    tmp[i++] = '.';
+    for( ; e10 < -1; e10++ ) tmp[i++] = '0';
+    memcpy(tmp + i, digits, ndig);
+    i += ndig;
+  }
+
+  return _ftoa_fast_copy(buf, buf_sz, tmp, i);
+}
+
+// %e
+static
+int _ftoa_fast_e(char* buf, size_t buf_sz, double num, int uppercase)
+{
+  char tmp[32];
+  uint64_t m = 0;
+  int e10 = 0;
+
+  if( num != 0 && ! _round_sig_digits(num, 7, &m, &e10) ) return -1;
+
+  _put_digits(tmp + 1, m, 7);
+  tmp[0] = tmp[1];
+  tmp[1] = '.';
+  return _ftoa_fast_copy(buf, buf_sz, tmp,
+                         8 + _put_exponent(tmp + 8, e10, uppercase));
+}
+
+// %f
+static
+int _ftoa_fast_f(char* buf, size_t buf_sz, double num)
+{
+  char tmp[32];
+  uint64_t m, ipart;
+  int n;
+
+  // keep the scaled value below 2^53, where doubles are exact integers
+  if( num >= 9.0e9 ) return -1;
+  if( ! _round_scaled(num * 1e6, &m) ) return -1;
+
+  ipart = m / 1000000;
+  for( n = 1; n < 10 && ipart >= (uint64_t) _exact_pow10[n]; n++ ) ;
+  _put_digits(tmp, ipart, n);
+  tmp[n] = '.';
+  _put_digits(tmp + n + 1, m % 1000000, 6);
+  return _ftoa_fast_copy(buf, buf_sz, tmp, n + 7);
+}
+
 // Converts num to a string in buf, returns the number
 // of bytes that would be used if space permits (not including null)
 // or -1 on error
@@ -3295,6 +4580,15 @@ int _ftoa_core(char* buf, size_t buf_sz, double num,
 
   *skip = 0;
 
+  if( base == 10 && precision < 0 && isfinite(num) && num >= 0 ) {
+    if( realfmt == 0 ) got = _ftoa_fast_g(buf, buf_sz, num, uppercase);
+    else if( realfmt == 1 ) got = _ftoa_fast_f(buf, buf_sz, num);
+    else if( realfmt == 2 ) got = _ftoa_fast_e(buf, buf_sz, num, uppercase);
+    else got = -1;
+    if( got >= 0 ) return got;
+    got = 0;
+  }
+
   if( base == 16 ) {
     if( precision < 0 ) {
       if( uppercase ) {
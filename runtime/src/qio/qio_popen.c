@@ -18,6 +18,11 @@
  * limitations under the License.
  */
 
+#ifndef _GNU_SOURCE
+// get pipe2
+#define _GNU_SOURCE
+#endif
+
 #include "sys_basic.h"
 
 #ifndef CHPL_RT_UNIT_TEST
@@ -79,6 +84,68 @@ void qio_spawn_free_str(const char* str)
 }
 
 
+static bool is_pipe_fd(int fd)
+{
+  return fd == QIO_FD_PIPE || fd == QIO_FD_BUFFERED_PIPE ||
+         fd == QIO_FD_NONBLOCKING_PIPE;
+}
+
+/* Create a pipe with close-on-exec set on both ends.
+   Other threads may be spawning processes at the same time, and
+   without close-on-exec those children would inherit our end of the pipe
+   and keep it open (so e.g. the child reading from it would never see EOF).
+   Both ends are also kept off of fds 0-2 so that the child's dup2 onto
+   those always makes a fresh descriptor without close-on-exec.
+   */
+static int make_pipe(int fds[2])
+{
+  int i;
+  int rc;
+
+#if defined(__linux__) && defined(O_CLOEXEC)
+  rc = pipe2(fds, O_CLOEXEC);
+  if( rc != 0 ) return errno;
+#else
+  rc = pipe(fds);
+  if( rc != 0 ) return errno;
+  for( i = 0; i < 2; i++ ) {
+    if( fcntl(fds[i], F_SETFD, FD_CLOEXEC) == -1 ) {
+      rc = errno;
+      close(fds[0]);
+      close(fds[1]);
+      fds[0] = fds[1] = -1;
+      return rc;
+    }
+  }
+#endif
+
+  for( i = 0; i < 2; i++ ) {
+    if( fds[i] <= 2 ) {
+      int moved = fcntl(fds[i], F_DUPFD_CLOEXEC, 3);
+      if( moved == -1 ) {
+        rc = errno;
+        close(fds[0]);
+        close(fds[1]);
+        fds[0] = fds[1] = -1;
+        return rc;
+      }
+      close(fds[i]);
+      fds[i] = moved;
+    }
+  }
+
+  return 0;
+}
+
+static qioerr set_nonblocking(int fd)
+{
+  int flags = fcntl(fd, F_GETFL);
+  if( flags == -1 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1 ) {
+    return qio_int_to_err(errno);
+  }
+  return 0;
+}
+
 /* Set up file actions for posix_spawn.
    *std__fd is FD_FORWARD, FD_CLOSE, FD_PIPE etc or a file descriptor #
    pipe[2] is the pipe created for FD_PIPE
@@ -110,7 +177,7 @@ static qioerr setup_actions(
 
   if( *std__fd == QIO_FD_FORWARD ) {
     // Do nothing. Assume file descriptor childfd does not have close-on-exec.
-  } else if( *std__fd == QIO_FD_PIPE || *std__fd == QIO_FD_BUFFERED_PIPE ) {
+  } else if( is_pipe_fd(*std__fd) ) {
     // child can't write to the parent end of the pipe.
     rc = posix_spawn_file_actions_addclose(actions, pipe_parent_end);
     if( rc ) return qio_int_to_err(errno);
@@ -119,9 +186,8 @@ static qioerr setup_actions(
     rc = posix_spawn_file_actions_adddup2(actions, pipe_child_end, childfd);
     if( rc ) return qio_int_to_err(errno);
 
-    // then close the pipe we dup'd since it is now known by another
-    // name (e.g. fd 0).
-    posix_spawn_file_actions_addclose(actions, pipe_child_end);
+    // The pipe we dup'd is close-on-exec, so it goes away once the child
+    // is running under its new name (e.g. fd 0).
     *hasactions = true;
   } else if( *std__fd == QIO_FD_CLOSE ) {
     // close stdin.
@@ -174,7 +240,9 @@ qioerr qio_do_openproc(const char** argv,
   int out_pipe[2];
   int err_pipe[2];
   posix_spawn_file_actions_t actions;
+  posix_spawnattr_t attr;
   bool inited_actions = false;
+  bool inited_attr = false;
   bool hasactions = false;
   const char* progname;
 
@@ -189,55 +257,76 @@ qioerr qio_do_openproc(const char** argv,
 
   // Create pipes
 
-  if( *stdin_fd == QIO_FD_PIPE || *stdin_fd == QIO_FD_BUFFERED_PIPE ) {
-    rc = pipe(in_pipe);
+  if( is_pipe_fd(*stdin_fd) ) {
+    rc = make_pipe(in_pipe);
     if( rc != 0 ) {
-      err = qio_int_to_err(errno);
+      err = qio_int_to_err(rc);
       goto error;
     }
+    if( *stdin_fd == QIO_FD_NONBLOCKING_PIPE ) {
+      err = set_nonblocking(in_pipe[1]);
+      if( err ) goto error;
+    }
   }
-  if( *stdout_fd == QIO_FD_PIPE || *stdout_fd == QIO_FD_BUFFERED_PIPE ) {
-    rc = pipe(out_pipe);
+  if( is_pipe_fd(*stdout_fd) ) {
+    rc = make_pipe(out_pipe);
     if( rc != 0 ) {
-      err = qio_int_to_err(errno);
+      err = qio_int_to_err(rc);
       goto error;
     }
+    if( *stdout_fd == QIO_FD_NONBLOCKING_PIPE ) {
+      err = set_nonblocking(out_pipe[0]);
+      if( err ) goto error;
+    }
   }
-  if( *stderr_fd == QIO_FD_PIPE || *stderr_fd == QIO_FD_BUFFERED_PIPE ) {
-    rc = pipe(err_pipe);
+  if( is_pipe_fd(*stderr_fd) ) {
+    rc = make_pipe(err_pipe);
     if( rc != 0 ) {
-      err = qio_int_to_err(errno);
+      err = qio_int_to_err(rc);
       goto error;
     }
+    if( *stderr_fd == QIO_FD_NONBLOCKING_PIPE ) {
+      err = set_nonblocking(err_pipe[0]);
+      if( err ) goto error;
+    }
   }
 
   // pipe[0] is the read end of the pipe
   // pipe[1] is the write end
+  // The two ends are separate open files, so making the parent's end
+  // non-blocking doesn't change the child's end.
 
   // fd 0 is stdin, 1 is stdout, 2 is stderr.
 
   // In order for Cygwin support to work, because Windows
   // doesn't have a 'fork' call, we use posix_spawn.
 
-  // Note that posix_spawn *might* be faster on Linux if
-  // we don't specify any file actions, since it can use
-  // vfork and so avoid duplicating page tables.
-
-  // To request vfork for posix_spawn on linux/glibc,
-  // set the spawn attr POSIX_SPAWN_USEVFORK.
-  // It is unclear whether or not the linux implementation
-  // will work correctly when combining POSIX_SPAWN_USEVFORK
-  // with file actions (e.g. to make a pipe for stdin/stdout).
-
-  // If we seek to improve performance on linux, here are some options:
-  //  * POSIX_SPAWN_USEVFORK
-  //  * madvise(MADV_DONTFORK) on the Chapel heap
-  //  * implement fork/dup/exec with clone instead of fork on linux
-  //    (clone can avoid copying page tables).
+  // posix_spawn lets the C library avoid copying the parent's page
+  // tables, which fork would do and which gets slow for a process with a
+  // large heap. glibc 2.24 and newer always use clone(CLONE_VM|CLONE_VFORK)
+  // for it; older glibc only does so when POSIX_SPAWN_USEVFORK is set (or
+  // when there are no file actions or attributes), so we always set it.
+  // All of the pipe setup is done through file actions, which are safe
+  // to run in the vfork'd child.
 
   // Note: posix_spawn can use file descriptors that have
   // close-on-exec set as long as they are dup'd in a file action.
 
+  rc = posix_spawnattr_init(&attr);
+  if( rc ) {
+    err = qio_int_to_err(rc);
+    goto error;
+  }
+  inited_attr = true;
+
+#ifdef POSIX_SPAWN_USEVFORK
+  rc = posix_spawnattr_setflags(&attr, POSIX_SPAWN_USEVFORK);
+  if( rc ) {
+    err = qio_int_to_err(rc);
+    goto error;
+  }
+#endif
+
   rc = posix_spawn_file_actions_init(&actions);
   if( rc ) {
     err = qio_int_to_err(errno);
@@ -254,7 +343,7 @@ qioerr qio_do_openproc(const char** argv,
 
   // handle QIO_FD_TO_STDOUT
   if( *stderr_fd == QIO_FD_TO_STDOUT &&
-      (*stdout_fd == QIO_FD_PIPE || *stdout_fd == QIO_FD_BUFFERED_PIPE) ) {
+      is_pipe_fd(*stdout_fd) ) {
     // forward stderr to stdout.
     err = setup_actions(&actions, stderr_fd, out_pipe, 2, false, &hasactions);
     if( err ) goto error;
@@ -274,7 +363,7 @@ qioerr qio_do_openproc(const char** argv,
   // spawn the subprogram, searching the path, returning the pid in pid
   rc = posix_spawnp(&pid, progname,
                    hasactions?(&actions):(NULL), /* file actions */
-                   NULL, /* attributes */
+                   &attr,
                    (char*const*) argv,
                    // Use the current environment if none was specified.
                    (envp==NULL)?(environ):((char*const*) envp) );
@@ -283,9 +372,11 @@ qioerr qio_do_openproc(const char** argv,
     goto error;
   }
 
-  // destroy file actions, ignoring return code.
+  // destroy file actions and attributes, ignoring return code.
   posix_spawn_file_actions_destroy(&actions);
   inited_actions = false;
+  posix_spawnattr_destroy(&attr);
+  inited_attr = false;
 
   // close the child-side of pipes. Return the parent side.
   if( in_pipe[0] != -1 ) {
@@ -312,13 +403,14 @@ error:
   DONE_SLOW_SYSCALL;
   // intentionally ignoring error returns here...
   if( inited_actions ) posix_spawn_file_actions_destroy(&actions);
+  if( inited_attr ) posix_spawnattr_destroy(&attr);
 
-  if( in_pipe[0] ) close(in_pipe[0]);
-  if( in_pipe[1] ) close(in_pipe[1]);
-  if( out_pipe[0] ) close(out_pipe[0]);
-  if( out_pipe[1] ) close(out_pipe[1]);
-  if( err_pipe[0] ) close(err_pipe[0]);
-  if( err_pipe[1] ) close(err_pipe[1]);
+  if( in_pipe[0] != -1 ) close(in_pipe[0]);
+  if( in_pipe[1] != -1 ) close(in_pipe[1]);
+  if( out_pipe[0] != -1 ) close(out_pipe[0]);
+  if( out_pipe[1] != -1 ) close(out_pipe[1]);
+  if( err_pipe[0] != -1 ) close(err_pipe[0]);
+  if( err_pipe[1] != -1 ) close(err_pipe[1]);
 
   return err;
 }
@@ -508,6 +600,23 @@ qioerr qio_proc_communicate(
     if( nfds <= error_fd ) nfds = error_fd + 1;
   }
 
+  // We wait for the pipes with select below and want reads and writes
+  // that would block to return EAGAIN, not to yield until they can
+  // finish, since e.g. finishing a write to the input could be waiting on
+  // us to read the output.
+  if( input ) {
+    input->file->fdflags = (qio_fdflag_t)
+      (input->file->fdflags & ~QIO_FDFLAG_NONBLOCKING);
+  }
+  if( output ) {
+    output->file->fdflags = (qio_fdflag_t)
+      (output->file->fdflags & ~QIO_FDFLAG_NONBLOCKING);
+  }
+  if( error ) {
+    error->file->fdflags = (qio_fdflag_t)
+      (error->file->fdflags & ~QIO_FDFLAG_NONBLOCKING);
+  }
+
   // Adjust all three pipes to be non-blocking.
   if( input_fd != -1 ) {
     rc = fcntl(input_fd, F_SETFL, O_NONBLOCK);
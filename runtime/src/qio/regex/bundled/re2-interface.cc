@@ -18,8 +18,14 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <limits>
+#include <list>
+#include <mutex>
 #include <pthread.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include <stdlib.h>
 #include <stdio.h>
 
@@ -40,6 +46,7 @@
 #undef printf
 
 #include "re2/re2.h"
+#include "re2/set.h"
 
 using namespace re2;
 
@@ -125,6 +132,84 @@ void re_free(re_t* re)
   delete re;
 }
 
+// The per-thread cache above is small, so a program cycling through more
+// than REGEX_CACHE_SIZE patterns would recompile on every miss. Misses go
+// to this process-wide LRU cache instead, which is shared by all threads.
+// RE2 objects are safe to use from several threads at once.
+#define REGEX_SHARED_CACHE_SIZE 1024
+
+struct shared_re_cache {
+  typedef std::list<std::pair<std::string, re_t*>> lru_list;
+  std::mutex lock;
+  lru_list lru; // most recently used first
+  std::unordered_map<std::string, lru_list::iterator> index;
+};
+
+// The key is the pattern prefixed by one byte holding the options.
+static
+std::string shared_cache_key(const char* str, int64_t str_len, const qio_regex_options_t* options)
+{
+  char flags = (options->utf8       ? 0x01 : 0) |
+               (options->posix      ? 0x02 : 0) |
+               (options->literal    ? 0x04 : 0) |
+               (options->nocapture  ? 0x08 : 0) |
+               (options->ignorecase ? 0x10 : 0) |
+               (options->multiline  ? 0x20 : 0) |
+               (options->dotnl      ? 0x40 : 0) |
+               (options->nongreedy  ? 0x80 : 0);
+  std::string key;
+  key.reserve(str_len + 1);
+  key.push_back(flags);
+  key.append(str, str_len);
+  return key;
+}
+
+// Returns a re_t with a reference held for the caller.
+static
+re_t* shared_cache_get(const char* str, int64_t str_len, const qio_regex_options_t* options)
+{
+  // Never destroyed, since cached regexes can outlive static destructors.
+  static shared_re_cache* c = new shared_re_cache();
+  std::string key = shared_cache_key(str, str_len, options);
+
+  {
+    std::lock_guard<std::mutex> guard(c->lock);
+    auto it = c->index.find(key);
+    if( it != c->index.end() ) {
+      c->lru.splice(c->lru.begin(), c->lru, it->second);
+      re_t* re = it->second->second;
+      DO_RETAIN(re);
+      return re;
+    }
+  }
+
+  // Compile without holding the lock; two threads may race to compile the
+  // same pattern, in which case the loser's copy is dropped.
+  RE2::Options opts;
+  qio_re_options_to_re2_options(options, &opts);
+  StringPiece strp(str, str_len);
+  re_t* re = new re_t(strp, opts, NULL);
+
+  std::lock_guard<std::mutex> guard(c->lock);
+  auto it = c->index.find(key);
+  if( it != c->index.end() ) {
+    DO_RELEASE(re, re_free);
+    c->lru.splice(c->lru.begin(), c->lru, it->second);
+    re = it->second->second;
+  } else {
+    c->lru.emplace_front(key, re);
+    c->index[key] = c->lru.begin();
+    if( c->lru.size() > REGEX_SHARED_CACHE_SIZE ) {
+      // Uses still holding the evicted regex keep it alive.
+      DO_RELEASE(c->lru.back().second, re_free);
+      c->index.erase(c->lru.back().first);
+      c->lru.pop_back();
+    }
+  }
+  DO_RETAIN(re);
+  return re;
+}
+
 static
 re_t* local_cache_get(const char* str, int64_t str_len, const qio_regex_options_t* options) {
   thread_local re_cache cache;
@@ -161,11 +246,9 @@ re_t* local_cache_get(const char* str, int64_t str_len, const qio_regex_options_
   // If we found no match, replace oldest.
   if( c->elems[oldest].re) DO_RELEASE(c->elems[oldest].re, re_free);
 
-  // Put a new RE in that slot.
-  RE2::Options opts;
-  qio_re_options_to_re2_options(options, &opts);
-  StringPiece strp(str, str_len);
-  re_t* re = new re_t(strp, opts, c);
+  // Put a new RE in that slot. The reference shared_cache_get returns
+  // is the one held by this cache.
+  re_t* re = shared_cache_get(str, str_len, options);
   c->elems[oldest].date = c->date;
   c->elems[oldest].re = re;
   // We increment the reference count before returning a copy to the
@@ -574,3 +657,115 @@ markerror:
 
   return err;
 }
+
+struct re_set_t {
+  RE2::Set set;
+  bool compiled;
+  re_set_t(const RE2::Options& options, RE2::Anchor anchor)
+    : set(options, anchor), compiled(false)
+  {
+  }
+};
+
+void qio_regex_set_create(const qio_regex_options_t* options, int anchor, qio_regex_set_t* set)
+{
+  RE2::Options opts;
+  RE2::Anchor ranchor = RE2::UNANCHORED;
+  qio_re_options_to_re2_options(options, &opts);
+
+  if( anchor == QIO_REGEX_ANCHOR_UNANCHORED ) ranchor = RE2::UNANCHORED;
+  else if( anchor == QIO_REGEX_ANCHOR_START ) ranchor = RE2::ANCHOR_START;
+  else if( anchor == QIO_REGEX_ANCHOR_BOTH ) ranchor = RE2::ANCHOR_BOTH;
+
+  set->set = (void*) new re_set_t(opts, ranchor);
+}
+
+void qio_regex_set_release(qio_regex_set_t* set)
+{
+  delete (re_set_t*) set->set;
+  set->set = NULL;
+}
+
+int64_t qio_regex_set_add(qio_regex_set_t* set, const char* str, int64_t str_len, const char** err_str)
+{
+  re_set_t* s = (re_set_t*) set->set;
+  std::string error;
+  int idx = -1;
+
+  if( !s || s->compiled ) {
+    error = s ? "regex set is already compiled" : "invalid regex set";
+  } else {
+    idx = s->set.Add(StringPiece(str, str_len), &error);
+  }
+
+  if( idx < 0 && err_str ) *err_str = qio_strdup(error.c_str());
+  return idx;
+}
+
+qio_bool qio_regex_set_compile(qio_regex_set_t* set)
+{
+  re_set_t* s = (re_set_t*) set->set;
+  if( !s ) return false;
+  if( !s->compiled ) s->compiled = s->set.Compile();
+  return s->compiled;
+}
+
+static
+int64_t re_set_match(const re_set_t* s, const StringPiece& text, int64_t* matches, int64_t nmatches)
+{
+  std::vector<int> found;
+  RE2::Set::ErrorInfo info;
+
+  if( !s || !s->compiled ) return -1;
+
+  if( !s->set.Match(text, &found, &info) ) {
+    return info.kind == RE2::Set::kNoError ? 0 : -1;
+  }
+
+  std::sort(found.begin(), found.end());
+  for( size_t i = 0; i < found.size() && (int64_t) i < nmatches; i++ ) {
+    matches[i] = found[i];
+  }
+  return found.size();
+}
+
+int64_t qio_regex_set_match(const qio_regex_set_t* set, const char* str, int64_t str_len, int64_t startpos, int64_t endpos, int64_t* matches, int64_t nmatches)
+{
+  if( startpos < 0 ) startpos = 0;
+  if( endpos > str_len ) endpos = str_len;
+  if( endpos < startpos ) endpos = startpos;
+
+  StringPiece text(str + startpos, endpos - startpos);
+  return re_set_match((const re_set_t*) set->set, text, matches, nmatches);
+}
+
+qioerr qio_regex_set_channel_match(const qio_regex_set_t* set, const int threadsafe, struct qio_channel_s* ch, int64_t maxlen, int64_t* matches, int64_t nmatches, int64_t* nfound_out, int64_t* nread_out)
+{
+  const re_set_t* s = (const re_set_t*) set->set;
+  qioerr err = 0;
+  ssize_t amt = 0;
+  std::string buf;
+  int64_t nfound;
+
+  *nfound_out = 0;
+  *nread_out = 0;
+
+  if( !s || !s->compiled )
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "invalid regex set");
+
+  if( maxlen <= 0 || (uint64_t) maxlen > (uint64_t) SSIZE_MAX )
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "invalid maximum length");
+
+  buf.resize(maxlen);
+  err = qio_channel_read(threadsafe, ch, &buf[0], maxlen, &amt);
+  if( qio_err_to_int(err) == EEOF && amt > 0 ) err = 0; // short read at EOF
+  if( err ) return err;
+
+  *nread_out = amt;
+  nfound = re_set_match(s, StringPiece(buf.data(), amt), matches, nmatches);
+  if( nfound < 0 )
+    QIO_RETURN_CONSTANT_ERROR(ENOMEM, "regex set match ran out of memory");
+
+  *nfound_out = nfound;
+  return 0;
+}
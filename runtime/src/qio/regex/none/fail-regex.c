@@ -91,3 +91,36 @@ qioerr qio_regex_channel_match(const qio_regex_t* regex, const int threadsafe, s
   return 0;
 }
 
+
+void qio_regex_set_create(const qio_regex_options_t* options, int anchor, qio_regex_set_t* set)
+{
+  chpl_internal_error("No Regex Support");
+}
+
+void qio_regex_set_release(qio_regex_set_t* set)
+{
+}
+
+int64_t qio_regex_set_add(qio_regex_set_t* set, const char* str, int64_t str_len, const char** err_str)
+{
+  chpl_internal_error("No Regex Support");
+  return -1;
+}
+
+qio_bool qio_regex_set_compile(qio_regex_set_t* set)
+{
+  chpl_internal_error("No Regex Support");
+  return false;
+}
+
+int64_t qio_regex_set_match(const qio_regex_set_t* set, const char* str, int64_t str_len, int64_t startpos, int64_t endpos, int64_t* matches, int64_t nmatches)
+{
+  chpl_internal_error("No Regex Support");
+  return -1;
+}
+
+qioerr qio_regex_set_channel_match(const qio_regex_set_t* set, const int threadsafe, struct qio_channel_s* ch, int64_t maxlen, int64_t* matches, int64_t nmatches, int64_t* nfound_out, int64_t* nread_out)
+{
+  chpl_internal_error("No Regex Support");
+  return 0;
+}
@@ -97,6 +97,37 @@
 #include <qthread/qt_syscalls.h>
 #endif
 
+// io_uring is used through raw system calls, so all we need is the
+// kernel's header.
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define SYS_HAS_IO_URING 1
+#endif
+#endif
+#endif
+#ifndef SYS_HAS_IO_URING
+#define SYS_HAS_IO_URING 0
+#endif
+
+// sendmmsg/recvmmsg are also called through syscall(), since their
+// glibc wrappers need _GNU_SOURCE.
+#ifdef __linux__
+#include <sys/syscall.h>
+#if defined(__NR_sendmmsg) && defined(__NR_recvmmsg)
+#define SYS_HAS_MMSG 1
+#endif
+#if defined(MSG_ZEROCOPY) && defined(SO_ZEROCOPY) && defined(__has_include)
+#if __has_include(<linux/errqueue.h>)
+#include <linux/errqueue.h>
+#define SYS_HAS_ZEROCOPY 1
+#endif
+#endif
+#endif
+
 // Should be available in sys_xsi_strerror_r.c
 extern int sys_xsi_strerror_r(int errnum, char* buf, size_t buflen);
 
@@ -1279,6 +1310,338 @@ qio_err_t sys_pwritev(fd_t fd, const struct iovec* iov, int iovcnt, off_t seek_t
 }
 
 
+#endif
+
+#if SYS_HAS_IO_URING
+
+// A single io_uring shared by all tasks.  Tasks fill in submission
+// queue entries and reap completions under ring->lock, but never hold
+// it while waiting; a waiting task yields and then reaps completions
+// on behalf of everyone, marking each finished request done.
+
+#define SYS_URING_ENTRIES 256
+
+// Largest number of requests one call keeps in flight at once.
+#define SYS_URING_BATCH 16
+
+// Yields to allow before blocking the thread in the kernel.
+#define SYS_URING_YIELDS 64
+
+#ifdef CHPL_RT_UNIT_TEST
+#include <sched.h>
+#define sys_uring_yield() sched_yield()
+#else
+extern void chpl_task_yield(void);
+#define sys_uring_yield() chpl_task_yield()
+#endif
+
+typedef struct sys_uring_s {
+  int fd;
+  unsigned entries;
+  unsigned inflight;
+  unsigned* sq_head;
+  unsigned* sq_tail;
+  unsigned* sq_mask;
+  unsigned* sq_array;
+  struct io_uring_sqe* sqes;
+  unsigned* cq_head;
+  unsigned* cq_tail;
+  unsigned* cq_mask;
+  struct io_uring_cqe* cqes;
+  pthread_mutex_t lock;
+} sys_uring_t;
+
+typedef struct sys_uring_req_s {
+  int done;
+  int res;
+} sys_uring_req_t;
+
+static sys_uring_t sys_uring;
+static int sys_uring_ok = 0;
+static pthread_once_t sys_uring_once = PTHREAD_ONCE_INIT;
+
+static void sys_uring_init(void)
+{
+  struct io_uring_params p;
+  sys_uring_t* r = &sys_uring;
+  size_t sq_len, cq_len;
+  void* sq_ring;
+  void* cq_ring;
+  void* sqes;
+  int fd;
+
+  memset(&p, 0, sizeof(p));
+  fd = syscall(__NR_io_uring_setup, SYS_URING_ENTRIES, &p);
+  if( fd < 0 ) return; // no kernel support, or blocked by seccomp
+
+  sq_len = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+  cq_len = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+  if( p.features & IORING_FEAT_SINGLE_MMAP ) {
+    if( cq_len > sq_len ) sq_len = cq_len;
+    cq_len = sq_len;
+  }
+
+  sq_ring = mmap(NULL, sq_len, PROT_READ|PROT_WRITE,
+                 MAP_SHARED|MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+  if( sq_ring == MAP_FAILED ) goto error;
+
+  if( p.features & IORING_FEAT_SINGLE_MMAP ) {
+    cq_ring = sq_ring;
+  } else {
+    cq_ring = mmap(NULL, cq_len, PROT_READ|PROT_WRITE,
+                   MAP_SHARED|MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    if( cq_ring == MAP_FAILED ) goto error_sq;
+  }
+
+  sqes = mmap(NULL, p.sq_entries * sizeof(struct io_uring_sqe),
+              PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE,
+              fd, IORING_OFF_SQES);
+  if( sqes == MAP_FAILED ) goto error_cq;
+
+  r->fd = fd;
+  // Keep completions from overflowing the completion queue.
+  r->entries = (p.cq_entries < p.sq_entries) ? p.cq_entries : p.sq_entries;
+  r->inflight = 0;
+  r->sq_head = (unsigned*) qio_ptr_add(sq_ring, p.sq_off.head);
+  r->sq_tail = (unsigned*) qio_ptr_add(sq_ring, p.sq_off.tail);
+  r->sq_mask = (unsigned*) qio_ptr_add(sq_ring, p.sq_off.ring_mask);
+  r->sq_array = (unsigned*) qio_ptr_add(sq_ring, p.sq_off.array);
+  r->sqes = (struct io_uring_sqe*) sqes;
+  r->cq_head = (unsigned*) qio_ptr_add(cq_ring, p.cq_off.head);
+  r->cq_tail = (unsigned*) qio_ptr_add(cq_ring, p.cq_off.tail);
+  r->cq_mask = (unsigned*) qio_ptr_add(cq_ring, p.cq_off.ring_mask);
+  r->cqes = (struct io_uring_cqe*) qio_ptr_add(cq_ring, p.cq_off.cqes);
+  pthread_mutex_init(&r->lock, NULL);
+
+  sys_uring_ok = 1;
+  return;
+
+error_cq:
+  if( cq_ring != sq_ring ) munmap(cq_ring, cq_len);
+error_sq:
+  munmap(sq_ring, sq_len);
+error:
+  close(fd);
+}
+
+int sys_uring_available(void)
+{
+  pthread_once(&sys_uring_once, sys_uring_init);
+  return sys_uring_ok;
+}
+
+// Call with r->lock held.
+static void sys_uring_reap(sys_uring_t* r)
+{
+  unsigned head = *r->cq_head;
+  unsigned tail = __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE);
+
+  while( head != tail ) {
+    struct io_uring_cqe* cqe = &r->cqes[head & *r->cq_mask];
+    sys_uring_req_t* req = (sys_uring_req_t*) (intptr_t) cqe->user_data;
+    req->res = cqe->res;
+    req->done = 1;
+    r->inflight--;
+    head++;
+  }
+
+  __atomic_store_n(r->cq_head, head, __ATOMIC_RELEASE);
+}
+
+static int sys_uring_all_done(sys_uring_req_t* reqs, int nreqs)
+{
+  int i;
+  for( i = 0; i < nreqs; i++ ) {
+    if( ! reqs[i].done ) return 0;
+  }
+  return 1;
+}
+
+// Submit one request per IOV_MAX-sized group of 'iov', all at once,
+// then wait for every one of them.  Returns 0 or an errno for the
+// submission itself; per-request results are left in 'reqs'.
+static qio_err_t sys_uring_submit_wait(int opcode, fd_t fd,
+                                       const struct iovec* iov, int iovcnt,
+                                       off_t offset,
+                                       sys_uring_req_t* reqs, int nreqs)
+{
+  sys_uring_t* r = &sys_uring;
+  int submitted = 0;
+  int yields = 0;
+  int i;
+
+  for( i = 0; i < nreqs; i++ ) {
+    reqs[i].done = 0;
+    reqs[i].res = 0;
+  }
+
+  while( 1 ) {
+    int got;
+
+    pthread_mutex_lock(&r->lock);
+    sys_uring_reap(r);
+
+    if( submitted < nreqs && r->inflight < r->entries ) {
+      unsigned tail = *r->sq_tail;
+      int n = 0;
+
+      while( submitted < nreqs && r->inflight < r->entries ) {
+        int first = submitted * IOV_MAX;
+        int niovs = iovcnt - first;
+        unsigned idx = tail & *r->sq_mask;
+        struct io_uring_sqe* sqe = &r->sqes[idx];
+
+        if( niovs > IOV_MAX ) niovs = IOV_MAX;
+
+        memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = opcode;
+        sqe->fd = fd;
+        sqe->off = offset;
+        sqe->addr = (uint64_t) (intptr_t) &iov[first];
+        sqe->len = niovs;
+        sqe->user_data = (uint64_t) (intptr_t) &reqs[submitted];
+        r->sq_array[idx] = idx;
+
+        offset += sys_iov_total_bytes(&iov[first], niovs);
+        tail++;
+        n++;
+        submitted++;
+        r->inflight++;
+      }
+
+      __atomic_store_n(r->sq_tail, tail, __ATOMIC_RELEASE);
+
+      do {
+        got = syscall(__NR_io_uring_enter, r->fd, n, 0, 0, NULL, 0);
+      } while( got < 0 && errno == EINTR );
+
+      if( got < 0 ) {
+        // The kernel didn't take these; back them out so the ring
+        // stays consistent, and report the error.
+        qio_err_t err = errno;
+        __atomic_store_n(r->sq_tail, tail - n, __ATOMIC_RELEASE);
+        r->inflight -= n;
+        submitted -= n;
+        pthread_mutex_unlock(&r->lock);
+        if( submitted == 0 ) return err;
+        // Wait for what did go out, then report the short batch.
+        while( ! sys_uring_all_done(reqs, submitted) ) {
+          pthread_mutex_lock(&r->lock);
+          sys_uring_reap(r);
+          pthread_mutex_unlock(&r->lock);
+          sys_uring_yield();
+        }
+        for( i = submitted; i < nreqs; i++ ) reqs[i].res = -err;
+        return 0;
+      }
+    }
+
+    if( submitted == nreqs && sys_uring_all_done(reqs, nreqs) ) {
+      pthread_mutex_unlock(&r->lock);
+      return 0;
+    }
+    pthread_mutex_unlock(&r->lock);
+
+    if( ++yields < SYS_URING_YIELDS ) {
+      sys_uring_yield();
+    } else {
+      // Nothing else seems to want this thread; sleep in the kernel
+      // until some completion arrives.
+      yields = 0;
+      got = syscall(__NR_io_uring_enter, r->fd, 0, 1,
+                    IORING_ENTER_GETEVENTS, NULL, 0);
+      (void) got;
+    }
+  }
+}
+
+static qio_err_t sys_uring_rwv(int opcode, fd_t fd, const struct iovec* iov, int iovcnt, off_t seek_to_offset, ssize_t* num_out)
+{
+  sys_uring_req_t reqs[SYS_URING_BATCH];
+  ssize_t got_total = 0;
+  qio_err_t err_out = 0;
+  int i, j;
+
+  STARTING_SLOW_SYSCALL;
+
+  for( i = 0; i < iovcnt && err_out == 0; ) {
+    int ngroups = (iovcnt - i + IOV_MAX - 1) / IOV_MAX;
+    int short_io = 0;
+
+    if( ngroups > SYS_URING_BATCH ) ngroups = SYS_URING_BATCH;
+
+    err_out = sys_uring_submit_wait(opcode, fd, &iov[i], iovcnt - i,
+                                    seek_to_offset + got_total,
+                                    reqs, ngroups);
+    if( err_out ) break;
+
+    // Only the prefix up to the first short or failed request counts.
+    for( j = 0; j < ngroups; j++ ) {
+      int niovs = iovcnt - i;
+      if( niovs > IOV_MAX ) niovs = IOV_MAX;
+      if( reqs[j].res < 0 ) {
+        err_out = -reqs[j].res;
+        break;
+      }
+      got_total += reqs[j].res;
+      if( reqs[j].res != sys_iov_total_bytes(&iov[i], niovs) ) {
+        short_io = 1;
+        break;
+      }
+      i += niovs;
+    }
+
+    if( short_io ) break;
+  }
+
+  *num_out = got_total;
+
+  DONE_SLOW_SYSCALL;
+
+  return err_out;
+}
+
+qio_err_t sys_uring_preadv(fd_t fd, const struct iovec* iov, int iovcnt, off_t seek_to_offset, ssize_t* num_read_out)
+{
+  qio_err_t err_out;
+
+  if( ! sys_uring_available() ) {
+    return sys_preadv(fd, iov, iovcnt, seek_to_offset, num_read_out);
+  }
+
+  err_out = sys_uring_rwv(IORING_OP_READV, fd, iov, iovcnt, seek_to_offset, num_read_out);
+
+  if( err_out == 0 && *num_read_out == 0 && sys_iov_total_bytes(iov, iovcnt) != 0 ) err_out = EEOF;
+
+  return err_out;
+}
+
+qio_err_t sys_uring_pwritev(fd_t fd, const struct iovec* iov, int iovcnt, off_t seek_to_offset, ssize_t* num_written_out)
+{
+  if( ! sys_uring_available() ) {
+    return sys_pwritev(fd, iov, iovcnt, seek_to_offset, num_written_out);
+  }
+
+  return sys_uring_rwv(IORING_OP_WRITEV, fd, iov, iovcnt, seek_to_offset, num_written_out);
+}
+
+#else
+
+int sys_uring_available(void)
+{
+  return 0;
+}
+
+qio_err_t sys_uring_preadv(fd_t fd, const struct iovec* iov, int iovcnt, off_t seek_to_offset, ssize_t* num_read_out)
+{
+  return sys_preadv(fd, iov, iovcnt, seek_to_offset, num_read_out);
+}
+
+qio_err_t sys_uring_pwritev(fd_t fd, const struct iovec* iov, int iovcnt, off_t seek_to_offset, ssize_t* num_written_out)
+{
+  return sys_pwritev(fd, iov, iovcnt, seek_to_offset, num_written_out);
+}
+
 #endif
 
 qio_err_t sys_fsync(fd_t fd)
@@ -1794,6 +2157,118 @@ qio_err_t sys_sendmsg(fd_t sockfd, const struct msghdr *msg, int flags, ssize_t*
 }
 
 
+qio_err_t sys_sendmmsg(fd_t sockfd, sys_mmsghdr_t* msgvec, unsigned int vlen, int flags, int* num_msgs_out)
+{
+  qio_err_t err_out = 0;
+  int got = 0;
+
+  STARTING_SLOW_SYSCALL;
+#ifdef SYS_HAS_MMSG
+  got = syscall(__NR_sendmmsg, sockfd, msgvec, vlen, flags);
+  if( got == -1 ) {
+    got = 0;
+    err_out = errno;
+  }
+#else
+  while( (unsigned int) got < vlen ) {
+    ssize_t sent = sendmsg(sockfd, &msgvec[got].msg_hdr, flags);
+    if( sent == -1 ) {
+      // report the error only if nothing was sent
+      if( got == 0 ) err_out = errno;
+      break;
+    }
+    msgvec[got].msg_len = sent;
+    got++;
+  }
+#endif
+  DONE_SLOW_SYSCALL;
+
+  *num_msgs_out = got;
+  return err_out;
+}
+
+qio_err_t sys_recvmmsg(fd_t sockfd, sys_mmsghdr_t* msgvec, unsigned int vlen, int flags, int* num_msgs_out)
+{
+  qio_err_t err_out = 0;
+  int got = 0;
+
+  STARTING_SLOW_SYSCALL;
+#ifdef SYS_HAS_MMSG
+  // Wait (if the socket blocks) for the first message, but don't
+  // wait for the batch to fill.
+  got = syscall(__NR_recvmmsg, sockfd, msgvec, vlen, flags | MSG_WAITFORONE, NULL);
+  if( got == -1 ) {
+    got = 0;
+    err_out = errno;
+  }
+#else
+  while( (unsigned int) got < vlen ) {
+    ssize_t recvd = recvmsg(sockfd, &msgvec[got].msg_hdr,
+                            got == 0 ? flags : (flags | MSG_DONTWAIT));
+    if( recvd == -1 ) {
+      if( got == 0 ) err_out = errno;
+      break;
+    }
+    msgvec[got].msg_len = recvd;
+    got++;
+  }
+#endif
+  DONE_SLOW_SYSCALL;
+
+  *num_msgs_out = got;
+  return err_out;
+}
+
+qio_err_t sys_enable_zerocopy(fd_t sockfd)
+{
+#ifdef SYS_HAS_ZEROCOPY
+  int one = 1;
+  if( setsockopt(sockfd, SOL_SOCKET, SO_ZEROCOPY, &one, sizeof(one)) == -1 ) {
+    return errno;
+  }
+  return 0;
+#else
+  return ENOTSUP;
+#endif
+}
+
+qio_err_t sys_zerocopy_completed(fd_t sockfd, uint32_t* lo_out, uint32_t* hi_out)
+{
+#ifdef SYS_HAS_ZEROCOPY
+  struct msghdr msg;
+  char control[CMSG_SPACE(sizeof(struct sock_extended_err))];
+  struct cmsghdr* cm;
+
+  *lo_out = 0;
+  *hi_out = 0;
+
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  // Completions arrive on the error queue, which never blocks.
+  if( recvmsg(sockfd, &msg, MSG_ERRQUEUE) == -1 ) return errno;
+
+  for( cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm) ) {
+    struct sock_extended_err ee;
+    memcpy(&ee, CMSG_DATA(cm), sizeof(ee));
+    if( ee.ee_errno == 0 && ee.ee_origin == SO_EE_ORIGIN_ZEROCOPY ) {
+      *lo_out = ee.ee_info;
+      *hi_out = ee.ee_data;
+      return 0;
+    }
+  }
+
+  // something else was on the error queue
+  return EAGAIN;
+#else
+  *lo_out = 0;
+  *hi_out = 0;
+  return ENOTSUP;
+#endif
+}
+
+
 qio_err_t sys_shutdown(fd_t sockfd, int how)
 {
   int got;
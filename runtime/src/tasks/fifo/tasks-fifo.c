@@ -28,11 +28,16 @@
 #include "chpl-arg-bundle.h"
 #include "chpl-atomics.h"
 #include "chpl-comm.h"
+#include "chpl-env.h"
 #include "chplexit.h"
 #include "chpl-locale-model.h"
 #include "chpl-mem.h"
+#include "chpl-mem-arena.h"
+#include "chpl-sync-spin.h"
+#include "chpl-task-prof.h"
 #include "chpl-tasks.h"
 #include "chpl-tasks-callbacks-internal.h"
+#include "chpl-timer-wheel.h"
 #include "chpl-topo.h"
 #include "chpltypes.h"
 #include "chpl-linefile-support.h"
@@ -69,9 +74,38 @@ typedef struct task_pool_struct {
 } task_pool_t;
 
 
+//
+// Optional per-thread work-stealing deques (Chase-Lev), selected by
+// setting CHPL_RT_TASKS_FIFO_POOL=deque.  A worker pushes the tasks it
+// creates onto the bottom of its own deque and pops from there, while
+// idle workers steal from the tops of randomly chosen victims' deques.
+// Threads without a deque (the main thread, the comm thread, workers
+// past TASK_DEQUES_MAX) and pushes that find a deque full fall back to
+// the global pool, which every worker also checks.  The deques are
+// fixed-size so that we never have to reclaim a buffer a thief might
+// still be reading.
+//
+#define TASK_DEQUE_LEN   4096            // must be a power of 2
+#define TASK_DEQUES_MAX  256
+
+typedef struct {
+  atomic_int_least64_t top;
+  char pad[64 - sizeof(atomic_int_least64_t)]; // keep thieves off bottom's line
+  atomic_int_least64_t bottom;
+  atomic_uintptr_t buf[TASK_DEQUE_LEN];
+} task_deque_t;
+
+static chpl_bool            use_task_deques = false;
+static atomic_uintptr_t     task_deques[TASK_DEQUES_MAX];
+static atomic_int_least32_t num_task_deques;
+static atomic_int_least32_t deque_task_cnt; // number of tasks in deques
+
+
 // This is the data that is private to each thread.
 typedef struct {
   task_pool_p   ptask;
+  task_deque_t* deque;         // my deque, if any
+  uint64_t      steal_seed;    // for choosing steal victims
 } thread_private_data_t;
 
 
@@ -85,7 +119,8 @@ static volatile task_pool_p
                            task_pool_tail;     // tail of task pool
 
 static int                 queued_task_cnt;    // number of tasks in task pool
-static int                 idle_thread_cnt;    // number of threads looking
+static atomic_int_least32_t
+                           idle_thread_cnt;    // number of threads looking
                                                //   for work
 
 static chpl_bool do_taskReport = false;
@@ -93,11 +128,35 @@ static chpl_thread_mutex_t taskTable_lock;     // critical section lock
 
 static chpl_fn_p comm_task_fn;
 
+#ifdef CHAPEL_PROFILE
+// sync variable waits that completed while spinning vs. had to park
+static atomic_uint_least64_t profile_sync_waitSpun;
+static atomic_uint_least64_t profile_sync_waitParked;
+# define PROFILE_INCR(counter,count) \
+  do { (void) atomic_fetch_add_uint_least64_t(&counter,count); } while (0)
+
+static void profile_print(void)
+{
+    fprintf(stderr, "sync waitSpun: %lu\n",
+            (unsigned long) atomic_load_uint_least64_t(&profile_sync_waitSpun));
+    fprintf(stderr, "sync waitParked: %lu\n",
+            (unsigned long) atomic_load_uint_least64_t(&profile_sync_waitParked));
+}
+#else
+# define PROFILE_INCR(counter,count)
+#endif /* CHAPEL_PROFILE */
+
 //
 // Internal functions.
 //
 static void                    enqueue_task(task_pool_p);
 static void                    dequeue_task(task_pool_p);
+static void                    schedule_task(task_pool_p);
+static task_deque_t*           task_deque_new(void);
+static chpl_bool               task_deque_push(task_deque_t*, task_pool_p);
+static task_pool_p             task_deque_pop(task_deque_t*);
+static task_pool_p             task_deque_steal(task_deque_t*);
+static task_pool_p             find_task(thread_private_data_t*);
 static void                    comm_task_wrapper(void*);
 static void                    taskCallBody(chpl_fn_int_t, chpl_fn_p,
                                             void*, size_t,
@@ -114,6 +173,9 @@ static void                    maybe_add_thread(void);
 static task_pool_p             add_to_task_pool(chpl_fn_int_t, chpl_fn_p,
                                                 void*, size_t,
                                                 chpl_bool, int, int32_t);
+static task_pool_p             make_task(chpl_fn_int_t, chpl_fn_p,
+                                         void*, size_t,
+                                         chpl_bool, int, int32_t);
 
 //
 // Condition variable methods
@@ -133,16 +195,29 @@ static void sync_wait_and_lock(chpl_sync_aux_t *s,
                                chpl_bool want_full,
                                int32_t lineno, int32_t filename) {
   chpl_bool suspend_using_cond;
-
-  chpl_thread_mutexLock(&s->lock);
+  uint32_t spins = 0;
+  chpl_bool parked = false;
+  uint64_t prof_start = chpl_task_prof_syncWaitStart();
 
   // If we're oversubscribing the hardware, we wait using conditionals
   // in order to ensure fairness and thus progress.  If we're not, we
-  // can spin-wait.
+  // can spin-wait, briefly with pauses if this sync variable's waits
+  // tend to be short and then by yielding.
   suspend_using_cond = (chpl_thread_getNumThreads() >=
                         chpl_topo_getNumCPUsLogical(true));
 
+  if (!suspend_using_cond) {
+    uint32_t limit = chpl_sync_spinLimit(s->spin_est);
+    while (s->is_full != want_full && spins < limit) {
+      chpl_sync_spinPause();
+      spins++;
+    }
+  }
+
+  chpl_thread_mutexLock(&s->lock);
+
   while (s->is_full != want_full) {
+    parked = true;
     if (!suspend_using_cond) {
       chpl_thread_mutexUnlock(&s->lock);
     }
@@ -155,6 +230,18 @@ static void sync_wait_and_lock(chpl_sync_aux_t *s,
     if (!suspend_using_cond)
       chpl_thread_mutexLock(&s->lock);
   }
+
+  if (spins > 0 || parked) {
+    chpl_task_prof_syncWaitEnd(prof_start);
+    if (!suspend_using_cond) {
+      chpl_sync_spinLearn(&s->spin_est, spins, parked);
+    }
+    if (parked) {
+      PROFILE_INCR(profile_sync_waitParked, 1);
+    } else {
+      PROFILE_INCR(profile_sync_waitSpun, 1);
+    }
+  }
 }
 
 void chpl_sync_lock(chpl_sync_aux_t *s) {
@@ -223,6 +310,7 @@ static void chpl_thread_condvar_init(chpl_thread_condvar_t* cv) {
 
 void chpl_sync_initAux(chpl_sync_aux_t *s) {
   s->is_full = false;
+  s->spin_est = 0;
   chpl_thread_mutexInit(&s->lock);
   chpl_thread_condvar_init(&s->signal_full);
   chpl_thread_condvar_init(&s->signal_empty);
@@ -265,6 +353,7 @@ static void setup_main_thread_private_data(void)
                              .lineno          = 0,
                              .filename        = CHPL_FILE_IDX_MAIN_PROGRAM,
                              .requestedSubloc = c_sublocid_any_val,
+                             .preferredSubloc = c_sublocid_any_val,
                              .requested_fid   = FID_NONE,
                              .requested_fn    = NULL,
                              .id              = get_next_task_id(),
@@ -280,9 +369,26 @@ void chpl_task_init(void) {
   chpl_thread_mutexInit(&threading_lock);
   chpl_thread_mutexInit(&task_id_lock);
   queued_task_cnt = 0;
-  idle_thread_cnt = 0;
+  atomic_init_int_least32_t(&idle_thread_cnt, 0);
   task_pool_head = task_pool_tail = NULL;
 
+  {
+    const char* pool = chpl_env_rt_get("TASKS_FIFO_POOL", "global");
+    if (strcmp(pool, "deque") == 0) {
+      use_task_deques = true;
+    } else if (strcmp(pool, "global") != 0) {
+      char msg[100];
+      snprintf(msg, sizeof(msg),
+               "CHPL_RT_TASKS_FIFO_POOL must be \"global\" or \"deque\"");
+      chpl_warning(msg, 0, 0);
+    }
+  }
+  for (int i = 0; i < TASK_DEQUES_MAX; i++) {
+    atomic_init_uintptr_t(&task_deques[i], (uintptr_t) NULL);
+  }
+  atomic_init_int_least32_t(&num_task_deques, 0);
+  atomic_init_int_least32_t(&deque_task_cnt, 0);
+
   chpl_thread_init(thread_begin, thread_end);
 
   //
@@ -305,6 +411,10 @@ void chpl_task_exit(void) {
   if (!initialized)
     return;
 
+#ifdef CHAPEL_PROFILE
+  profile_print();
+#endif /* CHAPEL_PROFILE */
+
   chpl_thread_exit();
 }
 
@@ -436,6 +546,7 @@ static void comm_task_wrapper(void* arg) {
                              .lineno          = 0,
                              .filename        = CHPL_FILE_IDX_COMM_TASK,
                              .requestedSubloc = c_sublocid_any_val,
+                             .preferredSubloc = c_sublocid_any_val,
                              .requested_fid   = FID_NONE,
                              .requested_fn    = NULL,
                              .id              = get_next_task_id(),
@@ -489,6 +600,187 @@ void dequeue_task(task_pool_p ptask) {
 }
 
 
+//
+// Put a new task where some thread will find it: on the bottom of my
+// deque if I have one and it has room, otherwise in the global pool.
+// Then start another thread if there seem to be more tasks than idle
+// threads to run them.
+//
+static inline
+void schedule_task(task_pool_p ptask) {
+  thread_private_data_t* tp = chpl_thread_getPrivateData();
+
+  if (use_task_deques && tp != NULL && tp->deque != NULL
+      && task_deque_push(tp->deque, ptask)) {
+    int32_t nq = atomic_fetch_add_int_least32_t(&deque_task_cnt, 1) + 1;
+    if (nq > atomic_load_int_least32_t(&idle_thread_cnt)
+        && chpl_thread_canCreate()) {
+      chpl_thread_mutexLock(&threading_lock);
+      maybe_add_thread();
+      chpl_thread_mutexUnlock(&threading_lock);
+    }
+    return;
+  }
+
+  // begin critical section
+  chpl_thread_mutexLock(&threading_lock);
+
+  enqueue_task(ptask);
+
+  // If we now have more tasks than threads to run them on, try to start
+  // another thread
+  if (queued_task_cnt + atomic_load_int_least32_t(&deque_task_cnt)
+      > atomic_load_int_least32_t(&idle_thread_cnt)) {
+    maybe_add_thread();
+  }
+
+  // end critical section
+  chpl_thread_mutexUnlock(&threading_lock);
+}
+
+
+//
+// Chase-Lev deque operations, following the C11 formulation in Le et
+// al., "Correct and Efficient Work-Stealing for Weak Memory Models".
+// Only the owning thread may push and pop; anyone may steal.
+//
+static
+task_deque_t* task_deque_new(void) {
+  task_deque_t* dq;
+
+  dq = (task_deque_t*) chpl_mem_alloc(sizeof(*dq), CHPL_RT_MD_TASK_POOL_DESC,
+                                      0, 0);
+  atomic_init_int_least64_t(&dq->top, 0);
+  atomic_init_int_least64_t(&dq->bottom, 0);
+  for (int i = 0; i < TASK_DEQUE_LEN; i++) {
+    atomic_init_uintptr_t(&dq->buf[i], (uintptr_t) NULL);
+  }
+  return dq;
+}
+
+
+static inline
+chpl_bool task_deque_push(task_deque_t* dq, task_pool_p ptask) {
+  int64_t b = atomic_load_explicit_int_least64_t(&dq->bottom,
+                                                 memory_order_relaxed);
+  int64_t t = atomic_load_explicit_int_least64_t(&dq->top,
+                                                 memory_order_acquire);
+  if (b - t >= TASK_DEQUE_LEN) {
+    return false;
+  }
+  atomic_store_explicit_uintptr_t(&dq->buf[b & (TASK_DEQUE_LEN - 1)],
+                                  (uintptr_t) ptask, memory_order_relaxed);
+  chpl_atomic_thread_fence(memory_order_release);
+  atomic_store_explicit_int_least64_t(&dq->bottom, b + 1,
+                                      memory_order_relaxed);
+  return true;
+}
+
+
+static inline
+task_pool_p task_deque_pop(task_deque_t* dq) {
+  task_pool_p ptask = NULL;
+  int64_t b = atomic_load_explicit_int_least64_t(&dq->bottom,
+                                                 memory_order_relaxed) - 1;
+  atomic_store_explicit_int_least64_t(&dq->bottom, b, memory_order_relaxed);
+  chpl_atomic_thread_fence(memory_order_seq_cst);
+  int64_t t = atomic_load_explicit_int_least64_t(&dq->top,
+                                                 memory_order_relaxed);
+  if (t <= b) {
+    ptask = (task_pool_p)
+            atomic_load_explicit_uintptr_t(&dq->buf[b & (TASK_DEQUE_LEN - 1)],
+                                           memory_order_relaxed);
+    if (t == b) {
+      // last one; race thieves for it
+      if (!atomic_compare_exchange_strong_explicit_int_least64_t(
+             &dq->top, &t, t + 1,
+             memory_order_seq_cst, memory_order_relaxed)) {
+        ptask = NULL;
+      }
+      atomic_store_explicit_int_least64_t(&dq->bottom, b + 1,
+                                          memory_order_relaxed);
+    }
+  } else {
+    atomic_store_explicit_int_least64_t(&dq->bottom, b + 1,
+                                        memory_order_relaxed);
+  }
+  return ptask;
+}
+
+
+static inline
+task_pool_p task_deque_steal(task_deque_t* dq) {
+  int64_t t = atomic_load_explicit_int_least64_t(&dq->top,
+                                                 memory_order_acquire);
+  chpl_atomic_thread_fence(memory_order_seq_cst);
+  int64_t b = atomic_load_explicit_int_least64_t(&dq->bottom,
+                                                 memory_order_acquire);
+  if (t < b) {
+    task_pool_p ptask = (task_pool_p)
+      atomic_load_explicit_uintptr_t(&dq->buf[t & (TASK_DEQUE_LEN - 1)],
+                                     memory_order_relaxed);
+    if (atomic_compare_exchange_strong_explicit_int_least64_t(
+          &dq->top, &t, t + 1,
+          memory_order_seq_cst, memory_order_relaxed)) {
+      return ptask;
+    }
+  }
+  return NULL;
+}
+
+
+//
+// Look for a task to run when using deques: first my own deque, then
+// those of random victims, then the global pool.  Returns NULL if none
+// was found.
+//
+static
+task_pool_p find_task(thread_private_data_t* tp) {
+  task_pool_p ptask = NULL;
+
+  if (tp->deque != NULL) {
+    ptask = task_deque_pop(tp->deque);
+  }
+
+  if (ptask == NULL) {
+    int32_t n = atomic_load_int_least32_t(&num_task_deques);
+    if (n > TASK_DEQUES_MAX) {
+      n = TASK_DEQUES_MAX;
+    }
+    if (n > 0) {
+      // xorshift64
+      tp->steal_seed ^= tp->steal_seed << 13;
+      tp->steal_seed ^= tp->steal_seed >> 7;
+      tp->steal_seed ^= tp->steal_seed << 17;
+      int32_t start = (int32_t) (tp->steal_seed % (uint64_t) n);
+      for (int32_t i = 0; ptask == NULL && i < n; i++) {
+        task_deque_t* victim = (task_deque_t*)
+          atomic_load_explicit_uintptr_t(&task_deques[(start + i) % n],
+                                         memory_order_acquire);
+        if (victim != NULL && victim != tp->deque) {
+          ptask = task_deque_steal(victim);
+        }
+      }
+    }
+  }
+
+  if (ptask != NULL) {
+    (void) atomic_fetch_sub_int_least32_t(&deque_task_cnt, 1);
+    return ptask;
+  }
+
+  if (task_pool_head) {
+    chpl_thread_mutexLock(&threading_lock);
+    if ((ptask = task_pool_head) != NULL) {
+      dequeue_task(ptask);
+    }
+    chpl_thread_mutexUnlock(&threading_lock);
+  }
+
+  return ptask;
+}
+
+
 void chpl_task_addTask(chpl_fn_int_t fid,
                        chpl_task_bundle_t* arg, size_t arg_size,
                        c_sublocid_t subloc,
@@ -497,11 +789,59 @@ void chpl_task_addTask(chpl_fn_int_t fid,
 
   arg->kind = CHPL_ARG_BUNDLE_KIND_TASK;
 
+  (void) add_to_task_pool(fid, chpl_ftable[fid], arg, arg_size,
+                          false, lineno, filename);
+}
+
+
+//
+// Bulk task creation.  Using deques, each task just goes on my deque
+// as usual.  Otherwise we create all the tasks first and then put the
+// whole batch in the global pool in one critical section.
+//
+void chpl_task_addTasks(chpl_fn_int_t fid,
+                        chpl_task_bundle_t* bundles, size_t bundle_size,
+                        int64_t n,
+                        c_sublocid_t subloc,
+                        int lineno, int32_t filename) {
+  task_pool_p head = NULL;
+  task_pool_p tail = NULL;
+
+  assert(subloc == c_sublocid_any);
+
+  for (int64_t i = 0; i < n; i++) {
+    chpl_task_bundle_t* arg =
+      (chpl_task_bundle_t*) ((char*) bundles + i * bundle_size);
+    arg->kind = CHPL_ARG_BUNDLE_KIND_TASK;
+    task_pool_p ptask = make_task(fid, chpl_ftable[fid], arg, bundle_size,
+                                  false, lineno, filename);
+    if (use_task_deques) {
+      schedule_task(ptask);
+    } else {
+      if (tail)
+        tail->next = ptask;
+      else
+        head = ptask;
+      tail = ptask;
+    }
+  }
+
+  if (head == NULL)
+    return;
+
   // begin critical section
   chpl_thread_mutexLock(&threading_lock);
 
-  (void) add_to_task_pool(fid, chpl_ftable[fid], arg, arg_size,
-                          false, lineno, filename);
+  while (head != NULL) {
+    task_pool_p ptask = head;
+    head = head->next;
+    ptask->next = NULL;
+    enqueue_task(ptask);
+
+    if (queued_task_cnt > atomic_load_int_least32_t(&idle_thread_cnt)) {
+      maybe_add_thread();
+    }
+  }
 
   // end critical section
   chpl_thread_mutexUnlock(&threading_lock);
@@ -521,14 +861,8 @@ void taskCallBody(chpl_fn_int_t fid, chpl_fn_p fp,
                   void* arg, size_t arg_size,
                   c_sublocid_t subloc,
                   int lineno, int32_t filename) {
-  // begin critical section
-  chpl_thread_mutexLock(&threading_lock);
-
   (void) add_to_task_pool(fid, fp, arg, arg_size, true,
                           lineno, filename);
-
-  // end critical section
-  chpl_thread_mutexUnlock(&threading_lock);
 }
 
 
@@ -565,6 +899,23 @@ void chpl_task_startMovedTask(chpl_fn_int_t  fid, chpl_fn_p fp,
 //
 
 
+//
+// fifo tasking has no sublocales, so it doesn't act on the preferred
+// sublocale.  It does track it, so that new tasks inherit it.
+//
+c_sublocid_t chpl_task_getPreferredSubloc(void) {
+  task_pool_p ptask = get_current_ptask(false /*must_be_task*/);
+  return ptask ? ptask->taskBundle->preferredSubloc : c_sublocid_any;
+}
+
+
+void chpl_task_setPreferredSubloc(c_sublocid_t subloc) {
+  task_pool_p ptask = get_current_ptask(false /*must_be_task*/);
+  if (ptask)
+    ptask->taskBundle->preferredSubloc = subloc;
+}
+
+
 chpl_taskID_t chpl_task_getId(void) {
   task_pool_p ptask = get_current_ptask(false /*must_be_task*/);
   return ptask ? ptask->taskBundle->id : (chpl_taskID_t) -1;
@@ -588,27 +939,12 @@ void chpl_task_yield(void) {
 
 
 void chpl_task_sleep(double secs) {
-  struct timeval deadline;
-  struct timeval now;
-
   //
-  // Figure out when this task can proceed again, and until then, keep
-  // yielding.
+  // A task here has its thread to itself until it finishes, so yielding
+  // wouldn't let the thread do anything else.  Just block it, which
+  // frees the CPU and wakes us at the deadline.
   //
-  gettimeofday(&deadline, NULL);
-  deadline.tv_usec += (suseconds_t) lround((secs - trunc(secs)) * 1.0e6);
-  if (deadline.tv_usec > 1000000) {
-    deadline.tv_sec++;
-    deadline.tv_usec -= 1000000;
-  }
-  deadline.tv_sec += (time_t) trunc(secs);
-
-  do {
-    chpl_task_yield();
-    gettimeofday(&now, NULL);
-  } while (now.tv_sec < deadline.tv_sec
-           || (now.tv_sec == deadline.tv_sec
-               && now.tv_usec < deadline.tv_usec));
+  chpl_timer_wheel_sleepThread(chpl_timer_wheel_deadline(secs));
 }
 
 uint32_t chpl_task_getMaxPar(void) {
@@ -629,6 +965,14 @@ uint32_t chpl_task_getMaxPar(void) {
   return max;
 }
 
+uint32_t chpl_task_setMaxPar(uint32_t maxPar) {
+  //
+  // Threads here are created on demand and block when idle, so there
+  // are no running workers to park; leave the parallelism as it is.
+  //
+  return chpl_task_getMaxPar();
+}
+
 chpl_task_infoRuntime_t* chpl_task_getInfoRuntime(void) {
   task_pool_p ptask = get_current_ptask(false /*must_be_task*/);
   return ptask ? &ptask->chpl_data.infoRuntime : NULL;
@@ -715,6 +1059,23 @@ static void report_all_tasks(void) {
            pendingTask->taskBundle->lineno);
     pendingTask = pendingTask->next;
   }
+  if (use_task_deques) {
+    int32_t n = atomic_load_int_least32_t(&num_task_deques);
+    for (int32_t i = 0; i < n && i < TASK_DEQUES_MAX; i++) {
+      task_deque_t* dq = (task_deque_t*)
+                         atomic_load_uintptr_t(&task_deques[i]);
+      if (dq == NULL)
+        continue;
+      int64_t b = atomic_load_int_least64_t(&dq->bottom);
+      for (int64_t t = atomic_load_int_least64_t(&dq->top); t < b; t++) {
+        pendingTask = (task_pool_p)
+          atomic_load_uintptr_t(&dq->buf[t & (TASK_DEQUE_LEN - 1)]);
+        printf("- %s:%d\n",
+               chpl_lookupFilename(pendingTask->taskBundle->filename),
+               pendingTask->taskBundle->lineno);
+      }
+    }
+  }
   printf("\n");
 
   // print out running tasks
@@ -751,8 +1112,27 @@ thread_begin(void* ptask_void) {
   chpl_thread_setPrivateData(tp);
 
   tp->ptask = NULL;
+  tp->deque = NULL;
+  tp->steal_seed = (uint64_t) (intptr_t) tp | 1;
+
+  if (use_task_deques) {
+    int32_t i = atomic_fetch_add_int_least32_t(&num_task_deques, 1);
+    if (i < TASK_DEQUES_MAX) {
+      tp->deque = task_deque_new();
+      atomic_store_explicit_uintptr_t(&task_deques[i], (uintptr_t) tp->deque,
+                                      memory_order_release);
+    }
+  }
 
   while (true) {
+    if (use_task_deques) {
+      while ((ptask = find_task(tp)) == NULL) {
+        chpl_thread_yield();
+      }
+      (void) atomic_fetch_sub_int_least32_t(&idle_thread_cnt, 1);
+      goto run_task;
+    }
+
     //
     // wait for a task to be present in the task pool
     //
@@ -793,13 +1173,14 @@ thread_begin(void* ptask_void) {
     // for task-reports on deadlock or Ctrl+C).
     //
     ptask = task_pool_head;
-    idle_thread_cnt--;
+    (void) atomic_fetch_sub_int_least32_t(&idle_thread_cnt, 1);
 
     dequeue_task(ptask);
 
     // end critical section
     chpl_thread_mutexUnlock(&threading_lock);
 
+  run_task:
     tp->ptask = ptask;
 
     if (do_taskReport) {
@@ -831,18 +1212,12 @@ thread_begin(void* ptask_void) {
     }
 
     tp->ptask = NULL;
-    chpl_mem_free(ptask, 0, 0);
-
-    // begin critical section
-    chpl_thread_mutexLock(&threading_lock);
+    chpl_mem_arena_free(ptask, 0, 0);
 
     //
     // finished task; increment idle count
     //
-    idle_thread_cnt++;
-
-    // end critical section
-    chpl_thread_mutexUnlock(&threading_lock);
+    (void) atomic_fetch_add_int_least32_t(&idle_thread_cnt, 1);
   }
 }
 
@@ -870,7 +1245,7 @@ static void maybe_add_thread(void) {
 
   if (!warning_issued && chpl_thread_canCreate()) {
     if (chpl_thread_create(NULL) == 0) {
-      idle_thread_cnt++;
+      (void) atomic_fetch_add_int_least32_t(&idle_thread_cnt, 1);
     }
     else {
       int32_t max_threads = chpl_thread_getMaxThreads();
@@ -894,13 +1269,30 @@ static void maybe_add_thread(void) {
 
 
 // create a task from the given function pointer and arguments
-// and append it to the end of the task pool
-// assumes threading_lock has already been acquired!
+// and append it to the end of the task pool (or my deque)
 static inline
 task_pool_p add_to_task_pool(chpl_fn_int_t fid, chpl_fn_p fp,
                              void* a, size_t a_size,
                              chpl_bool is_executeOn,
                              int lineno, int32_t filename) {
+  task_pool_p ptask = make_task(fid, fp, a, a_size, is_executeOn,
+                                lineno, filename);
+
+  // This comes last so that the created callback and task table entry
+  // precede any thread starting the task.
+  schedule_task(ptask);
+
+  return ptask;
+}
+
+
+// create a task from the given function pointer and arguments, but
+// don't schedule it yet
+static inline
+task_pool_p make_task(chpl_fn_int_t fid, chpl_fn_p fp,
+                      void* a, size_t a_size,
+                      chpl_bool is_executeOn,
+                      int lineno, int32_t filename) {
 
 
   task_pool_p ptask;
@@ -913,9 +1305,10 @@ task_pool_p add_to_task_pool(chpl_fn_int_t fid, chpl_fn_p fp,
   // could be either a comm or a task one.
   //
   assert(a_size >= chpl_argBundleSizeofHdr(a));
-  ptask = (task_pool_p) chpl_mem_alloc(offsetof(task_pool_t, bundle) + a_size,
-                                       CHPL_RT_MD_TASK_ARG_AND_POOL_DESC,
-                                       lineno, filename);
+  ptask = (task_pool_p) chpl_mem_arena_alloc(offsetof(task_pool_t, bundle)
+                                             + a_size,
+                                             CHPL_RT_MD_TASK_ARG_AND_POOL_DESC,
+                                             lineno, filename);
 
   memcpy(&ptask->bundle, a, a_size);
   ptask->taskBundle = chpl_argBundleTaskArgBundle(&ptask->bundle);
@@ -930,14 +1323,14 @@ task_pool_p add_to_task_pool(chpl_fn_int_t fid, chpl_fn_p fp,
       .lineno          = lineno,
       .filename        = filename,
       .requestedSubloc = c_sublocid_any_val,
+      .preferredSubloc = is_executeOn ? c_sublocid_any_val
+                                      : chpl_task_getPreferredSubloc(),
       .requested_fid   = fid,
       .requested_fn    = fp,
       .id              = get_next_task_id(),
       .infoChapel      = ptask->taskBundle->infoChapel,// retain; set by caller
     };
 
-  enqueue_task(ptask);
-
   chpl_task_do_callbacks(chpl_task_cb_event_kind_create,
                          ptask->taskBundle->requested_fid,
                          ptask->taskBundle->filename,
@@ -954,11 +1347,5 @@ task_pool_p add_to_task_pool(chpl_fn_int_t fid, chpl_fn_p fp,
     chpl_thread_mutexUnlock(&taskTable_lock);
   }
 
-  // If we now have more tasks than threads to run them on, try to start
-  // another thread
-  if (queued_task_cnt > idle_thread_cnt) {
-    maybe_add_thread();
-  }
-
   return ptask;
 }
@@ -45,8 +45,11 @@
 #include "chplsys.h"
 #include "chpl-linefile-support.h"
 #include "chpl-tasks.h"
+#include "chpl-sync-spin.h"
+#include "chpl-task-prof.h"
 #include "chpl-tasks-callbacks-internal.h"
 #include "chpl-tasks-impl.h"
+#include "chpl-timer-wheel.h"
 #include "chpl-topo.h"
 #include "chpltypes.h"
 
@@ -110,6 +113,8 @@ static aligned_t profile_sync_markAndSignalEmpty= 0;
 static aligned_t profile_sync_isFull= 0;
 static aligned_t profile_sync_initAux= 0;
 static aligned_t profile_sync_destroyAux= 0;
+static aligned_t profile_sync_waitSpun= 0;
+static aligned_t profile_sync_waitParked= 0;
 
 static void profile_print(void)
 {
@@ -123,6 +128,10 @@ static void profile_print(void)
     fprintf(stderr, "task getSerial: %lu\n", (unsigned long)profile_task_getSerial);
     fprintf(stderr, "task setSerial: %lu\n", (unsigned long)profile_task_setSerial);
     fprintf(stderr, "task getCallStackSize: %lu\n", (unsigned long)profile_task_getCallStackSize);
+    fprintf(stderr, "task steals local: %lu\n", (unsigned long)qthread_readstate(STEALS_LOCAL));
+    fprintf(stderr, "task steals remote: %lu\n", (unsigned long)qthread_readstate(STEALS_REMOTE));
+    fprintf(stderr, "task stack pool hits: %lu\n", (unsigned long)qthread_readstate(STACK_POOL_HITS));
+    fprintf(stderr, "task stack pool misses: %lu\n", (unsigned long)qthread_readstate(STACK_POOL_MISSES));
     /* Sync */
     fprintf(stderr, "sync lock: %lu\n", (unsigned long)profile_sync_lock);
     fprintf(stderr, "sync unlock: %lu\n", (unsigned long)profile_sync_unlock);
@@ -133,6 +142,8 @@ static void profile_print(void)
     fprintf(stderr, "sync isFull: %lu\n", (unsigned long)profile_sync_isFull);
     fprintf(stderr, "sync initAux: %lu\n", (unsigned long)profile_sync_initAux);
     fprintf(stderr, "sync destroyAux: %lu\n", (unsigned long)profile_sync_destroyAux);
+    fprintf(stderr, "sync waitSpun: %lu\n", (unsigned long)profile_sync_waitSpun);
+    fprintf(stderr, "sync waitParked: %lu\n", (unsigned long)profile_sync_waitParked);
 }
 #else
 # define PROFILE_INCR(counter,count)
@@ -162,6 +173,7 @@ chpl_task_bundle_t chpl_qthread_process_bundle = {
                                    .lineno = 0,
                                    .filename = CHPL_FILE_IDX_MAIN_TASK,
                                    .requestedSubloc = c_sublocid_any_val,
+                                   .preferredSubloc = c_sublocid_any_val,
                                    .requested_fid = FID_NONE,
                                    .requested_fn = NULL,
                                    .id = chpl_nullTaskID };
@@ -172,6 +184,7 @@ chpl_task_bundle_t chpl_qthread_comm_task_bundle = {
                                    .lineno = 0,
                                    .filename = CHPL_FILE_IDX_COMM_TASK,
                                    .requestedSubloc = c_sublocid_any_val,
+                                   .preferredSubloc = c_sublocid_any_val,
                                    .requested_fid = FID_NONE,
                                    .requested_fn = NULL,
                                    .id = chpl_nullTaskID };
@@ -190,6 +203,14 @@ static aligned_t exit_ret = 0;
 
 static chpl_bool guardPagesInUse = true;
 
+//
+// Workers started by qthreads, all of which are active at startup.
+// chpl_task_setMaxPar() can park and unpark workers within this limit;
+// comm layers size per-worker resources from it, so it never grows.
+//
+static uint32_t numWorkersStarted = 0;
+static pthread_mutex_t maxPar_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 void chpl_task_yield(void)
 {
     PROFILE_INCR(profile_task_yield,1);
@@ -215,18 +236,48 @@ void chpl_sync_unlock(chpl_sync_aux_t *s)
     qthread_unlock(&s->lock);
 }
 
-void chpl_sync_waitFullAndLock(chpl_sync_aux_t *s,
-                               int32_t          lineno,
-                               int32_t         filename)
+// Spin briefly if this sync variable's waits tend to be short, then
+// park on the signal FEB.  See chpl-sync-spin.h.
+static inline void sync_wait_and_lock(chpl_sync_aux_t *s, int want_full)
 {
-    PROFILE_INCR(profile_sync_waitFullAndLock, 1);
+    uint32_t  limit = chpl_sync_spinLimit(s->spin_est);
+    uint32_t  spins = 0;
+    chpl_bool parked = false;
+    uint64_t  prof_start = chpl_task_prof_syncWaitStart();
+
+    while ((((volatile chpl_sync_aux_t *)s)->is_full != 0) != want_full
+           && spins < limit) {
+        chpl_sync_spinPause();
+        spins++;
+    }
 
     chpl_sync_lock(s);
-    while (s->is_full == 0) {
+    while ((s->is_full != 0) != want_full) {
+        parked = true;
         chpl_sync_unlock(s);
-        qthread_readFE(NULL, &(s->signal_full));
+        qthread_readFE(NULL, want_full ? &(s->signal_full)
+                                       : &(s->signal_empty));
         chpl_sync_lock(s);
     }
+
+    if (spins > 0 || parked) {
+      chpl_task_prof_syncWaitEnd(prof_start);
+        chpl_sync_spinLearn(&s->spin_est, spins, parked);
+        if (parked) {
+            PROFILE_INCR(profile_sync_waitParked, 1);
+        } else {
+            PROFILE_INCR(profile_sync_waitSpun, 1);
+        }
+    }
+}
+
+void chpl_sync_waitFullAndLock(chpl_sync_aux_t *s,
+                               int32_t          lineno,
+                               int32_t         filename)
+{
+    PROFILE_INCR(profile_sync_waitFullAndLock, 1);
+
+    sync_wait_and_lock(s, 1);
 }
 
 void chpl_sync_waitEmptyAndLock(chpl_sync_aux_t *s,
@@ -235,12 +286,7 @@ void chpl_sync_waitEmptyAndLock(chpl_sync_aux_t *s,
 {
     PROFILE_INCR(profile_sync_waitEmptyAndLock, 1);
 
-    chpl_sync_lock(s);
-    while (s->is_full != 0) {
-        chpl_sync_unlock(s);
-        qthread_readFE(NULL, &(s->signal_empty));
-        chpl_sync_lock(s);
-    }
+    sync_wait_and_lock(s, 0);
 }
 
 void chpl_sync_markAndSignalFull(chpl_sync_aux_t *s)         // and unlock
@@ -277,6 +323,7 @@ void chpl_sync_initAux(chpl_sync_aux_t *s)
     s->is_full      = 0;
     s->signal_empty = 0;
     s->signal_full  = 0;
+    s->spin_est     = 0;
 }
 
 void chpl_sync_destroyAux(chpl_sync_aux_t *s)
@@ -644,6 +691,13 @@ static void setupCallStacks(void) {
     }
     snprintf(newenv_alloc, sizeof(newenv_alloc), "%zu", maxPoolAllocSize);
     chpl_qt_setenv("MAX_POOL_ALLOC_SIZE", newenv_alloc, 0);
+
+    // With guard pages, freed stacks are kept in a cache with their guard
+    // pages still protected, so reusing one costs no mprotect() calls. The
+    // body of a cached stack is madvise()d away, so the cache holds address
+    // space rather than memory. Users can bound it with
+    // {QT,QTHREAD}_STACK_CACHE_SIZE (a count of stacks), or keep the pages
+    // committed with {QT,QTHREAD}_STACK_CACHE_RELEASE=false.
 }
 
 static void setupTasklocalStorage(void) {
@@ -664,7 +718,9 @@ static void setupWorkStealing(void) {
     // performance, so disable it. Note that we don't override, so a user could
     // try working stealing out by setting {QT,QTHREAD}_STEAL_RATIO. Also note
     // that not all schedulers support work stealing, but it doesn't hurt to
-    // set this env var for those configs anyways.
+    // set this env var for those configs anyways. Schedulers that do steal
+    // prefer victims in their own NUMA domain (see setupAffinity()) and
+    // only go elsewhere after {QT,QTHREAD}_STEAL_REMOTE_SPINS failed tries.
     chpl_qt_setenv("STEAL_RATIO", "0", 0);
 }
 
@@ -677,6 +733,79 @@ static void setupSpinWaiting(void) {
   }
 }
 
+//
+// Mapping from preferred sublocales (NUMA domains) to the shepherds
+// that run on them, for placing tasks with affinity hints.  With the
+// numa locale model there is one shepherd per domain, so the mapping
+// is the identity.  With binders we know each shepherd's CPU and build
+// a table.  Otherwise we don't know, and ignore hints.
+//
+static int prefSublocsMax = 0;           // table covers [0, this)
+static int *prefShepStart = NULL;        // first entry for each subloc
+static int *prefShepCount = NULL;        // # entries for each subloc
+static qthread_shepherd_id_t *prefSheps = NULL;
+static aligned_t *prefShepNext = NULL;   // round-robin cursor per subloc
+
+static void setupPreferredShepherds(int *cpus, int numCpus) {
+    int *sublocs = chpl_malloc(numCpus * sizeof(*sublocs));
+
+    for (int i = 0; i < numCpus; i++) {
+        sublocs[i] = (int) chpl_topo_getCPULocality(cpus[i]);
+        if (sublocs[i] >= prefSublocsMax) {
+            prefSublocsMax = sublocs[i] + 1;
+        }
+    }
+
+    if (prefSublocsMax > 0) {
+        prefShepStart = chpl_calloc(prefSublocsMax, sizeof(*prefShepStart));
+        prefShepCount = chpl_calloc(prefSublocsMax, sizeof(*prefShepCount));
+        prefShepNext = chpl_calloc(prefSublocsMax, sizeof(*prefShepNext));
+        prefSheps = chpl_malloc(numCpus * sizeof(*prefSheps));
+        for (int i = 0; i < numCpus; i++) {
+            if (sublocs[i] >= 0) {
+                prefShepCount[sublocs[i]]++;
+            }
+        }
+        for (int d = 1; d < prefSublocsMax; d++) {
+            prefShepStart[d] = prefShepStart[d - 1] + prefShepCount[d - 1];
+        }
+        for (int i = 0; i < numCpus; i++) {
+            int d = sublocs[i];
+            if (d >= 0) {
+                prefSheps[prefShepStart[d] + prefShepNext[d]++] =
+                    (qthread_shepherd_id_t) i;
+            }
+        }
+        for (int d = 0; d < prefSublocsMax; d++) {
+            prefShepNext[d] = 0;
+        }
+    }
+
+    chpl_free(sublocs);
+}
+
+static inline c_sublocid_t preferredShepherd(c_sublocid_t subloc) {
+    if (!isActualSublocID(subloc)) {
+        return c_sublocid_any;
+    }
+
+    if (prefSheps == NULL) {
+        if (strcmp(CHPL_LOCALE_MODEL, "numa") == 0
+            && subloc < (c_sublocid_t) qthread_readstate(TOTAL_SHEPHERDS)) {
+            return subloc;
+        }
+        return c_sublocid_any;
+    }
+
+    if (subloc >= prefSublocsMax || prefShepCount[subloc] == 0) {
+        return c_sublocid_any;
+    }
+
+    aligned_t n = qthread_incr(&prefShepNext[subloc], 1);
+    return (c_sublocid_t)
+           prefSheps[prefShepStart[subloc] + n % prefShepCount[subloc]];
+}
+
 static void setupAffinity(void) {
   if (chpl_topo_isOversubscribed()) {
     chpl_qt_setenv("AFFINITY", "no", 0);
@@ -724,6 +853,31 @@ static void setupAffinity(void) {
       _DBG_P("QT_CPUBIND: %s (%d)", buf, numCpus);
       chpl_qt_setenv("CPUBIND", buf, 1);
       chpl_free(buf);
+
+      // tell the scheduler which NUMA domain each shepherd is in, so that
+      // work stealing can stay within a domain when possible. Binders
+      // itself doesn't provide any distance information.
+      bufSize = 0;
+      for (int i = 0; i < numCpus; i++) {
+        int subloc = (int) chpl_topo_getCPULocality(cpus[i]);
+        bufSize += snprintf(NULL, 0, "%d:", (subloc < 0) ? 0 : subloc);
+      }
+      buf = chpl_malloc(bufSize);
+      offset = 0;
+      buf[0] = '\0';
+      for (int i = 0; i < numCpus; i++) {
+        int subloc = (int) chpl_topo_getCPULocality(cpus[i]);
+        offset += snprintf(buf+offset, bufSize - offset, "%d:",
+                           (subloc < 0) ? 0 : subloc);
+      }
+      if (offset > 0) {
+          buf[offset-1] = '\0';
+      }
+      _DBG_P("QT_STEAL_DOMAINS: %s", buf);
+      chpl_qt_setenv("STEAL_DOMAINS", buf, 0);
+      chpl_free(buf);
+
+      setupPreferredShepherds(cpus, numCpus);
     }
     chpl_free(cpus);
   }
@@ -765,6 +919,8 @@ void chpl_task_init(void)
     // QT_NUM_WORKERS_PER_SHEPHERD in which case we don't impose any limits on
     // the number of threads qthreads creates beforehand
     assert(0 == commMaxThreads || qthread_num_workers() < commMaxThreads);
+
+    numWorkersStarted = (uint32_t) qthread_num_workers();
 }
 
 void chpl_task_exit(void)
@@ -858,6 +1014,7 @@ void chpl_task_callMain(void (*chpl_main)(void))
         { .kind            = CHPL_ARG_BUNDLE_KIND_TASK,
           .is_executeOn    = false,
           .requestedSubloc = c_sublocid_any_val,
+          .preferredSubloc = c_sublocid_any_val,
           .requested_fid   = FID_NONE,
           .requested_fn    = (void(*)(void*)) chpl_main,
           .lineno          = 0,
@@ -892,12 +1049,30 @@ int chpl_task_createCommTask(chpl_fn_p fn,
                           NULL, comm_task_wrapper, &wrapper_info);
 }
 
-void chpl_task_addTask(chpl_fn_int_t       fid,
-                       chpl_task_bundle_t *arg,
-                       size_t              arg_size,
-                       c_sublocid_t        full_subloc,
-                       int                 lineno,
-                       int32_t             filename)
+c_sublocid_t chpl_task_getPreferredSubloc(void)
+{
+    chpl_qthread_tls_t * data = chpl_qthread_get_tasklocal();
+    if (data && data->bundle) {
+        return data->bundle->preferredSubloc;
+    }
+    return c_sublocid_any;
+}
+
+void chpl_task_setPreferredSubloc(c_sublocid_t subloc)
+{
+    chpl_qthread_tls_t * data = chpl_qthread_get_tasklocal();
+    if (data && data->bundle) {
+        data->bundle->preferredSubloc = subloc;
+    }
+}
+
+static inline void addTaskBody(chpl_fn_int_t       fid,
+                               chpl_task_bundle_t *arg,
+                               size_t              arg_size,
+                               c_sublocid_t        full_subloc,
+                               c_sublocid_t        preferred_subloc,
+                               int                 lineno,
+                               int32_t             filename)
 {
     chpl_fn_p requested_fn = chpl_ftable[fid];
 
@@ -917,6 +1092,7 @@ void chpl_task_addTask(chpl_fn_int_t       fid,
              .lineno          = lineno,
              .filename        = filename,
              .requestedSubloc = full_subloc,
+             .preferredSubloc = preferred_subloc,
              .requested_fid   = fid,
              .requested_fn    = requested_fn,
              .id              = chpl_nullTaskID,
@@ -925,6 +1101,10 @@ void chpl_task_addTask(chpl_fn_int_t       fid,
 
     wrap_callbacks(chpl_task_cb_event_kind_create, arg);
 
+    if (execution_subloc == c_sublocid_any) {
+        execution_subloc = preferredShepherd(preferred_subloc);
+    }
+
     if (execution_subloc == c_sublocid_any) {
         qthread_fork_copyargs(chapel_wrapper, arg, arg_size, NULL);
     } else {
@@ -933,6 +1113,104 @@ void chpl_task_addTask(chpl_fn_int_t       fid,
     }
 }
 
+void chpl_task_addTask(chpl_fn_int_t       fid,
+                       chpl_task_bundle_t *arg,
+                       size_t              arg_size,
+                       c_sublocid_t        full_subloc,
+                       int                 lineno,
+                       int32_t             filename)
+{
+    addTaskBody(fid, arg, arg_size, full_subloc,
+                chpl_task_getPreferredSubloc(), lineno, filename);
+}
+
+//
+// Bulk task creation.  Spawning n tasks one after another from a single
+// shepherd makes that shepherd the bottleneck, so for large batches we
+// hand the upper half, copied into one contiguous block, to a helper
+// task that splits it again, and so on.  Creation then proceeds in a
+// tree across the workers.  Batches of no more than ADD_TASKS_LEAF
+// tasks are spawned directly.
+//
+#define ADD_TASKS_LEAF 64
+
+typedef struct {
+    chpl_fn_int_t       fid;
+    chpl_task_bundle_t *bundles;      // n bundles of bundle_size bytes
+    size_t              bundle_size;
+    int64_t             n;
+    c_sublocid_t        full_subloc;
+    c_sublocid_t        preferred_subloc;
+    int                 lineno;
+    int32_t             filename;
+} add_tasks_work_t;
+
+static void addTasksBody(add_tasks_work_t *w);
+
+static aligned_t addTasksHelper(void *arg)
+{
+    add_tasks_work_t *w = (add_tasks_work_t *) arg;
+    addTasksBody(w);
+    chpl_free(w->bundles);
+    return 0;
+}
+
+static void addTasksBody(add_tasks_work_t *w)
+{
+    char *bundles = (char *) w->bundles;
+    int64_t n = w->n;
+
+    while (n > ADD_TASKS_LEAF) {
+        int64_t nLo = n / 2;
+        add_tasks_work_t hi = *w;
+        hi.n = n - nLo;
+        hi.bundles = chpl_malloc(hi.n * w->bundle_size);
+        memcpy(hi.bundles, bundles + nLo * w->bundle_size,
+               hi.n * w->bundle_size);
+        qthread_fork_copyargs(addTasksHelper, &hi, sizeof(hi), NULL);
+        n = nLo;
+    }
+
+    for (int64_t i = 0; i < n; i++) {
+        addTaskBody(w->fid,
+                    (chpl_task_bundle_t *) (bundles + i * w->bundle_size),
+                    w->bundle_size, w->full_subloc, w->preferred_subloc,
+                    w->lineno, w->filename);
+    }
+}
+
+void chpl_task_addTasks(chpl_fn_int_t       fid,
+                        chpl_task_bundle_t *bundles,
+                        size_t              bundle_size,
+                        int64_t             n,
+                        c_sublocid_t        full_subloc,
+                        int                 lineno,
+                        int32_t             filename)
+{
+    add_tasks_work_t w = { .fid              = fid,
+                           .bundles          = bundles,
+                           .bundle_size      = bundle_size,
+                           .n                = n,
+                           .full_subloc      = full_subloc,
+                           .preferred_subloc = chpl_task_getPreferredSubloc(),
+                           .lineno           = lineno,
+                           .filename         = filename, };
+
+    if (qthread_shep() == NO_SHEPHERD) {
+        // not in a task (e.g., the comm thread): no helpers
+        for (int64_t i = 0; i < n; i++) {
+            addTaskBody(fid,
+                        (chpl_task_bundle_t *) ((char *) bundles
+                                                + i * bundle_size),
+                        bundle_size, full_subloc, w.preferred_subloc,
+                        lineno, filename);
+        }
+        return;
+    }
+
+    addTasksBody(&w);
+}
+
 static inline void taskCallBody(chpl_fn_int_t fid, chpl_fn_p fp,
                                 void *arg, size_t arg_size,
                                 c_sublocid_t full_subloc,
@@ -948,6 +1226,7 @@ static inline void taskCallBody(chpl_fn_int_t fid, chpl_fn_p fp,
                 .lineno          = lineno,
                 .filename        = filename,
                 .requestedSubloc = full_subloc,
+                .preferredSubloc = c_sublocid_any_val,
                 .requested_fid   = fid,
                 .requested_fn    = fp,
                 .id              = chpl_nullTaskID,
@@ -1038,38 +1317,35 @@ char* chpl_task_idToString(char* buff, size_t size, chpl_taskID_t id) {
     return NULL;
 }
 
+static void wake_sleeper(void *arg)
+{
+    qthread_fill((aligned_t *)arg);
+}
+
 void chpl_task_sleep(double secs)
 {
-    if (qthread_shep() == NO_SHEPHERD) {
-        struct timeval deadline;
-        struct timeval now;
+    uint64_t deadline = chpl_timer_wheel_deadline(secs);
 
-        //
-        // Figure out when this task can proceed again, and until then, keep
-        // yielding.
-        //
-        gettimeofday(&deadline, NULL);
-        deadline.tv_usec += (suseconds_t) lround((secs - trunc(secs)) * 1.0e6);
-        if (deadline.tv_usec > 1000000) {
-            deadline.tv_sec++;
-            deadline.tv_usec -= 1000000;
+    PROFILE_INCR(profile_task_sleep, 1);
+
+    if (qthread_shep() == NO_SHEPHERD) {
+        // Not a task, so there is nothing to yield to.
+        chpl_timer_wheel_sleepThread(deadline);
+    } else if (secs * 1.0e9 < CHPL_TIMER_WHEEL_TICK_NS) {
+        // Too short to be worth parking for.
+        while (chpl_timer_wheel_now() < deadline) {
+            qthread_yield();
         }
-        deadline.tv_sec += (time_t) trunc(secs);
-
-        do {
-            chpl_task_yield();
-            gettimeofday(&now, NULL);
-        } while (now.tv_sec < deadline.tv_sec
-                 || (now.tv_sec == deadline.tv_sec
-                     && now.tv_usec < deadline.tv_usec));
     } else {
-        qtimer_t t = qtimer_create();
-        qtimer_start(t);
-        do {
-            qthread_yield();
-            qtimer_stop(t);
-        } while (qtimer_secs(t) < secs);
-        qtimer_destroy(t);
+        // Park on an FEB that the timer wheel fills at the deadline.  The
+        // wait leaves it full, which is how qthreads expects memory it
+        // isn't tracking (like this stack slot) to be left.
+        chpl_timer_t timer;
+        aligned_t    wake;
+
+        qthread_empty(&wake);
+        chpl_timer_wheel_add(&timer, deadline, wake_sleeper, &wake);
+        qthread_readFF(NULL, &wake);
     }
 }
 
@@ -1080,9 +1356,43 @@ uint32_t chpl_task_getMaxPar(void) {
     // will decide itself how much parallelism to create across and
     // within sublocales, if there are any.
     //
+    // The count only includes active workers, so it reflects any
+    // change made by chpl_task_setMaxPar().
+    //
     return (uint32_t) qthread_num_workers();
 }
 
+uint32_t chpl_task_setMaxPar(uint32_t maxPar) {
+    qthread_worker_id_t w;
+
+    assert(chpl_qthread_initialized);
+
+    if (maxPar < 1) {
+        maxPar = 1;
+    } else if (maxPar > numWorkersStarted) {
+        maxPar = numWorkersStarted;
+    }
+
+    //
+    // Workers are numbered with the shepherd varying fastest, so parking
+    // from the top down empties shepherds' extra workers before parking
+    // any shepherd entirely, and never touches worker 0 (which qthreads
+    // won't disable anyway).  A parked shepherd hands off any tasks that
+    // remain in, or are later aimed at, its queue.
+    //
+    (void) pthread_mutex_lock(&maxPar_mutex);
+    for (w = 1; w < numWorkersStarted; w++) {
+        if (w < maxPar) {
+            qthread_enable_worker(w);
+        } else {
+            (void) qthread_disable_worker(w);
+        }
+    }
+    (void) pthread_mutex_unlock(&maxPar_mutex);
+
+    return chpl_task_getMaxPar();
+}
+
 size_t chpl_task_getCallStackSize(void)
 {
     PROFILE_INCR(profile_task_getCallStackSize,1);
@@ -1099,7 +1409,7 @@ chpl_bool chpl_task_guardPagesInUse(void)
 
 uint32_t chpl_task_impl_getFixedNumThreads(void) {
     assert(chpl_qthread_initialized);
-    return (uint32_t)qthread_num_workers();
+    return numWorkersStarted;
 }
 
 chpl_bool chpl_task_impl_hasFixedNumThreads(void)
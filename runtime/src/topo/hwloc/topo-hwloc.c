@@ -661,6 +661,28 @@ int chpl_topo_getNumNumaDomains(void) {
 }
 
 
+c_sublocid_t chpl_topo_getCPULocality(int cpu) {
+  hwloc_obj_t pu;
+  int node;
+
+  if (!haveTopology) {
+    return c_sublocid_any;
+  }
+
+  if ((pu = hwloc_get_pu_obj_by_os_index(topology, cpu)) == NULL) {
+    return c_sublocid_any;
+  }
+
+  // Like chpl_topo_getThreadLocality(), report the first NUMA node.
+  node = hwloc_bitmap_first(pu->nodeset);
+  if (!isActualSublocID(node)) {
+    node = c_sublocid_any;
+  }
+
+  return node;
+}
+
+
 void chpl_topo_setThreadLocality(c_sublocid_t subloc) {
   hwloc_cpuset_t cpuset;
   int flags;
@@ -789,6 +811,78 @@ void chpl_topo_setMemSubchunkLocality(void* p, size_t size,
 }
 
 
+static void setMemChunkRunLocality(unsigned char* p, size_t size,
+                                   hwloc_obj_t numaObj) {
+  size_t pgSize;
+  unsigned char* pPgLo;
+  size_t nPages;
+
+  if (numaObj == NULL) {
+    return;
+  }
+
+  alignAddrSize(p, size, false /*onlyInside*/, &pgSize, &pPgLo, &nPages);
+  if (nPages > 0) {
+    chpl_topo_setMemLocalityByPages(pPgLo, nPages * pgSize, numaObj);
+  }
+}
+
+
+void chpl_topo_setMemChunkLocality(void* p, size_t nmemb, size_t eltSize,
+                                   int numChunks) {
+  unsigned char* pCh = (unsigned char*) p;
+  int* cpus;
+  int numCPUs;
+
+  _DBG_P("chpl_topo_setMemChunkLocality(%p, %zd, %zd, %d)",
+         p, nmemb, eltSize, numChunks);
+
+  if (!haveTopology || numNumaDomains <= 1 || numChunks < 1 || nmemb == 0) {
+    return;
+  }
+
+  CHK_ERR(cpus = sys_calloc(numCPUsPhysAcc, sizeof(*cpus)));
+  numCPUs = getCPUs(physAccSet, cpus, numCPUsPhysAcc);
+  if (numCPUs == 0) {
+    sys_free(cpus);
+    return;
+  }
+
+  //
+  // Split the elements the way a default forall does, with the first
+  // (nmemb % numChunks) chunks getting one more element than the rest,
+  // and put chunk i on the NUMA domain of the i'th accessible core.
+  // Adjacent chunks on the same domain are localized together.
+  //
+  const size_t perChunk = nmemb / numChunks;
+  const size_t extra = nmemb % numChunks;
+  hwloc_obj_t runObj = NULL;
+  size_t runLo = 0;
+  size_t lo = 0;
+  for (int i = 0; i < numChunks; i++) {
+    hwloc_obj_t pu = hwloc_get_pu_obj_by_os_index(topology,
+                                                  cpus[i % numCPUs]);
+    hwloc_obj_t numaObj = (pu == NULL)
+                          ? NULL
+                          : hwloc_get_numanode_obj_by_os_index(topology,
+                                  hwloc_bitmap_first(pu->nodeset));
+    if (i == 0) {
+      runObj = numaObj;
+    } else if (numaObj != runObj) {
+      setMemChunkRunLocality(pCh + runLo * eltSize, (lo - runLo) * eltSize,
+                             runObj);
+      runObj = numaObj;
+      runLo = lo;
+    }
+    lo += perChunk + ((i < extra) ? 1 : 0);
+  }
+  setMemChunkRunLocality(pCh + runLo * eltSize, (nmemb - runLo) * eltSize,
+                         runObj);
+
+  sys_free(cpus);
+}
+
+
 void chpl_topo_touchMemFromSubloc(void* p, size_t size, chpl_bool onlyInside,
                                   c_sublocid_t subloc) {
   size_t pgSize;
@@ -1093,51 +1187,46 @@ static int compareNics(const void *a, const void *b)
 }
 
 //
-// Given a NIC, determines which NIC of the same type (same vendor and device)
-// is the best to use. The "best" NIC is one in the same socket as this
-// locale. If there isn't a NIC in our socket then use an "extra" NIC if some
-// sockets have more than one, otherwise use an already-assigned NIC. In
-// either case choose a NIC in a round-robin fashion from those locales that
-// do not have a NIC in their socket.
+// Returns the PCI device object at the given address, or NULL if there
+// isn't one.
 //
-
-chpl_topo_pci_addr_t *chpl_topo_selectNicByType(chpl_topo_pci_addr_t *inAddr,
-                                                chpl_topo_pci_addr_t *outAddr)
+static hwloc_obj_t findPciDev(chpl_topo_pci_addr_t *addr)
 {
-  hwloc_obj_t nic = NULL;
-  struct hwloc_pcidev_attr_s *nicAttr;
-  chpl_topo_pci_addr_t *result = NULL;
-  nic_info_t *nics = NULL;
-  int *assignedNics = NULL;
-
-  if (root->type != HWLOC_OBJ_PACKAGE) {
-    // We aren't running in a socket, so we don't care which NIC is used.
-    goto done;
-  }
-
-  // find the PCI object corresponding to the specified NIC
   for (hwloc_obj_t obj = hwloc_get_next_pcidev(topology, NULL);
        obj != NULL;
        obj = hwloc_get_next_pcidev(topology, obj)) {
     if (obj->type == HWLOC_OBJ_PCI_DEVICE) {
       struct hwloc_pcidev_attr_s *attr = &(obj->attr->pcidev);
-      if ((attr->domain == inAddr->domain) && (attr->bus == inAddr->bus) &&
-          (attr->dev == inAddr->device) && (attr->func == inAddr->function)) {
-        nic = obj;
-        break;
+      if ((attr->domain == addr->domain) && (attr->bus == addr->bus) &&
+          (attr->dev == addr->device) && (attr->func == addr->function)) {
+        return obj;
       }
     }
   }
-  if (nic == NULL) {
-    _DBG_P("Could not find NIC %04x:%02x:%02x.%x", inAddr->domain,
-           inAddr->bus, inAddr->device, inAddr->function);
-    goto done;
-  }
+  _DBG_P("Could not find NIC %04x:%02x:%02x.%x", addr->domain,
+         addr->bus, addr->device, addr->function);
+  return NULL;
+}
 
-  // Find all the NICS of the same vendor and device as the specified NIC and
-  // sort them by socket and PCI address.
+static void getPciAddr(hwloc_obj_t obj, chpl_topo_pci_addr_t *addr)
+{
+  struct hwloc_pcidev_attr_s *attr = &(obj->attr->pcidev);
+  addr->domain = attr->domain;
+  addr->bus = attr->bus;
+  addr->device = attr->dev;
+  addr->function = attr->func;
+}
+
+//
+// Finds all the NICS of the same vendor and device as the specified NIC and
+// sorts them by socket and PCI address. Returns NULL if the socket of one of
+// them can't be determined, otherwise an array the caller must free.
+//
+static nic_info_t *getNicsByType(hwloc_obj_t nic, int *numNicsOut)
+{
+  struct hwloc_pcidev_attr_s *nicAttr = &(nic->attr->pcidev);
+  nic_info_t *nics = NULL;
 
-  nicAttr = &(nic->attr->pcidev);
   int maxNics = hwloc_get_nbobjs_by_type(topology, HWLOC_OBJ_PCI_DEVICE);
   CHK_ERR(nics = sys_calloc(maxNics, sizeof(*nics)));
   int numNics = 0;
@@ -1156,7 +1245,8 @@ chpl_topo_pci_addr_t *chpl_topo_selectNicByType(chpl_topo_pci_addr_t *inAddr,
         if (sobj == NULL) {
           _DBG_P("Could not find socket for NIC %04x:%02x:%02x.%x",
                  attr->domain, attr->bus, attr->dev, attr->func);
-          goto done;
+          sys_free(nics);
+          return NULL;
         }
         nics[numNics].socket = sobj->logical_index;
         nics[numNics].obj = obj;
@@ -1166,6 +1256,46 @@ chpl_topo_pci_addr_t *chpl_topo_selectNicByType(chpl_topo_pci_addr_t *inAddr,
     }
   }
   qsort(nics, numNics, sizeof(*nics), compareNics);
+  *numNicsOut = numNics;
+  return nics;
+}
+
+//
+// Given a NIC, determines which NIC of the same type (same vendor and device)
+// is the best to use. The "best" NIC is one in the same socket as this
+// locale. If there isn't a NIC in our socket then use an "extra" NIC if some
+// sockets have more than one, otherwise use an already-assigned NIC. In
+// either case choose a NIC in a round-robin fashion from those locales that
+// do not have a NIC in their socket.
+//
+
+chpl_topo_pci_addr_t *chpl_topo_selectNicByType(chpl_topo_pci_addr_t *inAddr,
+                                                chpl_topo_pci_addr_t *outAddr)
+{
+  hwloc_obj_t nic = NULL;
+  chpl_topo_pci_addr_t *result = NULL;
+  nic_info_t *nics = NULL;
+  int *assignedNics = NULL;
+
+  if (root->type != HWLOC_OBJ_PACKAGE) {
+    // We aren't running in a socket, so we don't care which NIC is used.
+    goto done;
+  }
+
+  // find the PCI object corresponding to the specified NIC
+  nic = findPciDev(inAddr);
+  if (nic == NULL) {
+    goto done;
+  }
+
+  // Find all the NICS of the same vendor and device as the specified NIC and
+  // sort them by socket and PCI address.
+
+  int numNics = 0;
+  nics = getNicsByType(nic, &numNics);
+  if (nics == NULL) {
+    goto done;
+  }
 
   // Use the first NIC in our socket if there is one.
 
@@ -1243,15 +1373,9 @@ chpl_topo_pci_addr_t *chpl_topo_selectNicByType(chpl_topo_pci_addr_t *inAddr,
   }
 
 done:
-  if (nic != NULL) {
-    nicAttr = &(nic->attr->pcidev);
-    if (outAddr != NULL) {
-      outAddr->domain = nicAttr->domain;
-      outAddr->bus = nicAttr->bus;
-      outAddr->device = nicAttr->dev;
-      outAddr->function = nicAttr->func;
-      result = outAddr;
-    }
+  if ((nic != NULL) && (outAddr != NULL)) {
+    getPciAddr(nic, outAddr);
+    result = outAddr;
   }
   if (nics != NULL) {
     sys_free(nics);
@@ -1262,6 +1386,98 @@ done:
   return result;
 }
 
+//
+// Determines which NICs of the same type as the given one this locale
+// should use, with the given NIC first. If we are running in a socket these
+// are the NICs in our socket, or just the given NIC if it isn't in our
+// socket. Otherwise they are all the NICs of that type.
+//
+int chpl_topo_selectNicsByType(chpl_topo_pci_addr_t *inAddr,
+                               chpl_topo_pci_addr_t *outAddrs,
+                               int *outSockets, int count)
+{
+  hwloc_obj_t nic;
+  nic_info_t *nics = NULL;
+  int numNics = 0;
+  int nicSocket = -1;
+  int result = 0;
+
+  if ((count < 1) || ((nic = findPciDev(inAddr)) == NULL)) {
+    goto done;
+  }
+
+  nics = getNicsByType(nic, &numNics);
+  for (int i = 0; i < numNics; i++) {
+    if (nics[i].obj == nic) {
+      nicSocket = nics[i].socket;
+      break;
+    }
+  }
+
+  getPciAddr(nic, &outAddrs[0]);
+  if (outSockets != NULL) {
+    outSockets[0] = nicSocket;
+  }
+  result = 1;
+
+  int ourSocket = (root->type == HWLOC_OBJ_PACKAGE) ? root->logical_index
+                                                    : -1;
+  if ((ourSocket != -1) && (nicSocket != ourSocket)) {
+    // There isn't a NIC in our socket, so don't spread out any further.
+    goto done;
+  }
+
+  for (int i = 0; (i < numNics) && (result < count); i++) {
+    if ((nics[i].obj != nic) &&
+        ((ourSocket == -1) || (nics[i].socket == ourSocket))) {
+      getPciAddr(nics[i].obj, &outAddrs[result]);
+      if (outSockets != NULL) {
+        outSockets[result] = nics[i].socket;
+      }
+      result++;
+    }
+  }
+
+done:
+  if (nics != NULL) {
+    sys_free(nics);
+  }
+  _DBG_P("chpl_topo_selectNicsByType: %d NIC(s)", result);
+  return result;
+}
+
+int chpl_topo_getThreadSocket(void) {
+  hwloc_cpuset_t cpuset;
+  int result = -1;
+
+  if (!haveTopology) {
+    return -1;
+  }
+
+  if (!topoSupport->cpubind->get_thisthread_last_cpu_location) {
+    return -1;
+  }
+
+  CHK_ERR_ERRNO((cpuset = hwloc_bitmap_alloc()) != NULL);
+
+  if (hwloc_get_last_cpu_location(topology, cpuset,
+                                  HWLOC_CPUBIND_THREAD) == 0) {
+    hwloc_obj_t pu = hwloc_get_pu_obj_by_os_index(topology,
+                                                  hwloc_bitmap_first(cpuset));
+    if (pu != NULL) {
+      hwloc_obj_t sobj = hwloc_get_ancestor_obj_by_type(topology,
+                                                        HWLOC_OBJ_PACKAGE,
+                                                        pu);
+      if (sobj != NULL) {
+        result = sobj->logical_index;
+      }
+    }
+  }
+
+  hwloc_bitmap_free(cpuset);
+  return result;
+}
+
 
 static
 void chk_err_fn(const char* file, int lineno, const char* what) {
@@ -75,6 +75,10 @@ int chpl_topo_getNumNumaDomains(void) {
 void chpl_topo_setThreadLocality(c_sublocid_t subloc) { }
 
 
+c_sublocid_t chpl_topo_getCPULocality(int cpu) {
+  return c_sublocid_any;
+}
+
 c_sublocid_t chpl_topo_getThreadLocality(void) {
   return c_sublocid_any;
 }
@@ -90,6 +94,10 @@ void chpl_topo_setMemSubchunkLocality(void* p, size_t size,
                                       size_t* subchunkSizes) { }
 
 
+void chpl_topo_setMemChunkLocality(void* p, size_t nmemb, size_t eltSize,
+                                   int numChunks) { }
+
+
 void chpl_topo_touchMemFromSubloc(void* p, size_t size, chpl_bool onlyInside,
                                   c_sublocid_t subloc) { }
 
@@ -107,3 +115,13 @@ chpl_topo_pci_addr_t *chpl_topo_selectNicByType(chpl_topo_pci_addr_t *inAddr,
   return NULL;
 }
 
+int chpl_topo_selectNicsByType(chpl_topo_pci_addr_t *inAddr,
+                               chpl_topo_pci_addr_t *outAddrs,
+                               int *outSockets, int count) {
+  return 0;
+}
+
+int chpl_topo_getThreadSocket(void) {
+  return -1;
+}
+
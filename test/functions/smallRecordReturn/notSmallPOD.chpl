@@ -0,0 +1,44 @@
+// Returns that must still go through the return argument: records that
+// need copy initialization or deinitialization, and star tuples, which
+// are C arrays.
+
+record tracked {
+  var x: int;
+  proc init(x: int) { this.x = x; }
+  proc init=(other: tracked) {
+    this.x = other.x;
+    writeln("copy ", x);
+  }
+  proc deinit() { writeln("deinit ", x); }
+}
+
+record named {
+  var id: int;
+  var name: string;
+}
+
+proc makeTracked(i: int) {
+  return new tracked(i);
+}
+
+proc keep(const ref t: tracked) {
+  return t;
+}
+
+proc makeNamed(i: int) {
+  return new named(i, "n" + i:string);
+}
+
+proc triple(i: int) {
+  return (i, 2 * i, 3 * i);
+}
+
+{
+  var a = makeTracked(1);
+  var b = keep(a);
+  writeln(a.x, " ", b.x);
+}
+
+for i in 1..2 do writeln(makeNamed(i));
+
+for i in 1..2 do writeln(triple(i));
@@ -0,0 +1,49 @@
+// Small plain-data records are returned by value rather than through a
+// return argument; make sure returns of every shape still work.
+
+record vec2 {
+  var x, y: real;
+}
+
+record tagged {
+  var tag: int(8);
+  var val: int(32);
+}
+
+// too big to come back in registers, still returned by reference
+record vec4 {
+  var a, b, c, d: real;
+}
+
+proc add(u: vec2, v: vec2) {
+  return new vec2(u.x + v.x, u.y + v.y);
+}
+
+proc pick(ref u: vec2, ref v: vec2, first: bool) {
+  if first then return u;
+  return v;
+}
+
+proc mk(i: int) : tagged {
+  var t: tagged;
+  t.tag = (i % 3): int(8);
+  t.val = (i * i): int(32);
+  return t;
+}
+
+proc scale(v: vec4, s: real) {
+  return new vec4(v.a * s, v.b * s, v.c * s, v.d * s);
+}
+
+var acc = new vec2(0.0, 0.0);
+for i in 1..5 do acc = add(acc, new vec2(i, -i));
+writeln(acc);
+
+var p = new vec2(1.0, 2.0), q = new vec2(3.0, 4.0);
+var r = pick(p, q, false);
+r.x = 10.0;
+writeln(r, " ", q);
+
+for i in 1..3 do writeln(mk(i));
+
+writeln(scale(new vec4(1.0, 2.0, 3.0, 4.0), 0.5));
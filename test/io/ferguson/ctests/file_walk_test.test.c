@@ -0,0 +1,127 @@
+#include "chpl-file-walk.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define NDIRS 20
+#define NFILES 15
+
+char root[] = "/tmp/file_walk_test_XXXXXX";
+
+static
+void make_path(char* buf, size_t len, const char* fmt, int i, int j)
+{
+  int n = snprintf(buf, len, "%s/", root);
+  snprintf(buf + n, len - n, fmt, i, j);
+}
+
+// root/dNN/fMM for NDIRS directories of NFILES files, each directory
+// with a subdirectory holding one more file, plus a hidden file.
+static
+void make_tree(void)
+{
+  char path[256];
+  int i, j;
+  FILE* f;
+
+  assert(mkdtemp(root) != NULL);
+  for( i = 0; i < NDIRS; i++ ) {
+    make_path(path, sizeof(path), "d%02d", i, 0);
+    assert(mkdir(path, 0700) == 0);
+    for( j = 0; j < NFILES; j++ ) {
+      make_path(path, sizeof(path), "d%02d/f%02d", i, j);
+      f = fopen(path, "w");
+      assert(f);
+      fclose(f);
+    }
+    make_path(path, sizeof(path), "d%02d/sub", i, 0);
+    assert(mkdir(path, 0700) == 0);
+    make_path(path, sizeof(path), "d%02d/sub/f%02d.dat", i, i);
+    f = fopen(path, "w");
+    assert(f);
+    fclose(f);
+  }
+  make_path(path, sizeof(path), ".hidden", 0, 0);
+  f = fopen(path, "w");
+  assert(f);
+  fclose(f);
+}
+
+static
+void remove_tree(void)
+{
+  char cmd[300];
+  snprintf(cmd, sizeof(cmd), "rm -rf %s", root);
+  assert(system(cmd) == 0);
+}
+
+static
+void check_walk(int nworkers)
+{
+  chpl_fs_walk_t w;
+  char path[256];
+  size_t i, ndirs = 0;
+  qioerr err;
+
+  // Everything, sorted
+  err = chpl_fs_walk(root, NULL, CHPL_FS_WALK_DIRS | CHPL_FS_WALK_FILES |
+                     CHPL_FS_WALK_SORT, nworkers, &w);
+  assert(!err);
+  assert(chpl_fs_walk_num(w) == 1 + NDIRS * (NFILES + 3));
+  assert(0 == strcmp(chpl_fs_walk_index(w, 0), root));
+  for( i = 0; i < chpl_fs_walk_num(w); i++ ) {
+    if( i > 0 ) {
+      assert(strcmp(chpl_fs_walk_index(w, i - 1), chpl_fs_walk_index(w, i)) < 0);
+    }
+    assert(strstr(chpl_fs_walk_index(w, i), ".hidden") == NULL);
+    ndirs += chpl_fs_walk_is_dir(w, i);
+  }
+  assert(ndirs == 1 + 2 * NDIRS);
+  make_path(path, sizeof(path), "d%02d", 0, 0);
+  assert(0 == strcmp(chpl_fs_walk_index(w, 1), path));
+  chpl_fs_walk_free(&w);
+
+  // Hidden files too
+  err = chpl_fs_walk(root, NULL, CHPL_FS_WALK_FILES | CHPL_FS_WALK_HIDDEN,
+                     nworkers, &w);
+  assert(!err);
+  assert(chpl_fs_walk_num(w) == 1 + NDIRS * (NFILES + 1));
+  chpl_fs_walk_free(&w);
+
+  // Like a recursive glob for **/*.dat
+  err = chpl_fs_walk(root, "*.dat", CHPL_FS_WALK_FILES | CHPL_FS_WALK_SORT,
+                     nworkers, &w);
+  assert(!err);
+  assert(chpl_fs_walk_num(w) == NDIRS);
+  for( i = 0; i < NDIRS; i++ ) {
+    make_path(path, sizeof(path), "d%02d/sub/f%02d.dat", i, i);
+    assert(0 == strcmp(chpl_fs_walk_index(w, i), path));
+    assert(!chpl_fs_walk_is_dir(w, i));
+  }
+  chpl_fs_walk_free(&w);
+}
+
+int main(int argc, char** argv)
+{
+  chpl_fs_walk_t w;
+  qioerr err;
+
+  make_tree();
+
+  check_walk(1);
+  check_walk(4);
+  check_walk(0);
+
+  err = chpl_fs_walk("/nonexistent/file_walk_test", NULL,
+                     CHPL_FS_WALK_FILES, 1, &w);
+  assert(qio_err_to_int(err) == ENOENT);
+
+  remove_tree();
+
+  printf("file_walk_test PASS\n");
+
+  return 0;
+}
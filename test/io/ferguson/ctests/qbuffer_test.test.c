@@ -549,6 +549,50 @@ void test_qbuffer_edges(void)
   qbytes_release(b3);
 }
 
+// Long advances in a buffer of many parts, which search rather than
+// walking the parts, have to agree with qbuffer_iter_at.
+void test_qbuffer_many_parts(void)
+{
+  qbuffer_t buf;
+  qbuffer_iter_t cur, want;
+  int64_t start, end, from, to;
+  qioerr err;
+  int i;
+
+  err = qbuffer_init(&buf);
+  assert(!err);
+
+  for( i = 0; i < 5000; i++ ) {
+    qbytes_t* b;
+    int len = 1 + (i * 37) % 50;
+    err = qbytes_create_calloc(&b, len);
+    assert(!err);
+    err = qbuffer_append(&buf, b, 0, len);
+    assert(!err);
+    qbytes_release(b);
+  }
+  qbuffer_trim_front(&buf, 123);
+
+  start = qbuffer_start_offset(&buf);
+  end = qbuffer_end_offset(&buf);
+
+  for( i = 0; i < 100000; i++ ) {
+    from = start + (i * 7919) % (end - start + 1);
+    to = start - 5 + (i * 104729) % (end - start + 11);
+
+    cur = qbuffer_iter_at(&buf, from);
+    qbuffer_iter_advance(&buf, &cur, to - from);
+
+    if( to < start ) want = qbuffer_begin(&buf);
+    else if( to >= end ) want = qbuffer_end(&buf);
+    else want = qbuffer_iter_at(&buf, to);
+
+    assert( qbuffer_iter_same_part(cur, want) );
+    assert( qbuffer_iter_equals(cur, want) );
+  }
+
+  qbuffer_destroy(&buf);
+}
 
 int main(int argc, char** argv)
 {
@@ -560,6 +604,8 @@ int main(int argc, char** argv)
 
   test_qbuffer_edges();
 
+  test_qbuffer_many_parts();
+
   printf("qbuffer_test PASS\n");
 
   return 0;
@@ -0,0 +1,111 @@
+#include "qio_formatted.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int verbose = 0;
+
+// Write an array in bulk and check it against element-at-a-time reads,
+// then bulk-read it back.
+static
+void check_array(size_t elt_size, int64_t nelts, int byteorder)
+{
+  qioerr err;
+  qio_file_t* f;
+  qio_channel_t* writing;
+  qio_channel_t* reading;
+  size_t len = elt_size * nelts;
+  uint8_t* data = malloc(len + 1);
+  uint8_t* got = malloc(len + 1);
+  int64_t i;
+
+  assert(data && got);
+
+  if( verbose ) printf("array of %lli x %i bytes, byte order %i\n",
+                       (long long int) nelts, (int) elt_size, byteorder);
+
+  for( i = 0; i < (int64_t) len; i++ ) data[i] = (uint8_t) (i * 7 + (i >> 8));
+
+  err = qio_file_open_tmp(&f, 0, NULL);
+  assert(!err);
+
+  err = qio_channel_create(&writing, f, 0, 0, 1, 0, INT64_MAX, NULL, 0);
+  assert(!err);
+  // something unaligned first, so the array doesn't start on a boundary
+  err = qio_channel_write_uint8(true, writing, 0x5a);
+  assert(!err);
+  err = qio_channel_write_array(true, byteorder, writing, data, elt_size, nelts);
+  assert(!err);
+  qio_channel_release(writing);
+
+  err = qio_channel_create(&reading, f, 0, 1, 0, 1, INT64_MAX, NULL, 0);
+  assert(!err);
+  for( i = 0; i < nelts; i++ ) {
+    switch( elt_size ) {
+      case 1:
+        err = qio_channel_read_uint8(true, reading, got + i);
+        break;
+      case 2:
+        err = qio_channel_read_uint16(true, byteorder, reading, (uint16_t*) (got + 2*i));
+        break;
+      case 4:
+        err = qio_channel_read_uint32(true, byteorder, reading, (uint32_t*) (got + 4*i));
+        break;
+      case 8:
+        err = qio_channel_read_uint64(true, byteorder, reading, (uint64_t*) (got + 8*i));
+        break;
+    }
+    assert(!err);
+  }
+  assert(0 == memcmp(data, got, len));
+  qio_channel_release(reading);
+
+  memset(got, 0, len);
+  err = qio_channel_create(&reading, f, 0, 1, 0, 1, INT64_MAX, NULL, 0);
+  assert(!err);
+  err = qio_channel_read_array(true, byteorder, reading, got, elt_size, nelts);
+  assert(!err);
+  assert(0 == memcmp(data, got, len));
+  qio_channel_release(reading);
+
+  qio_file_release(f);
+  free(data);
+  free(got);
+}
+
+int main(int argc, char** argv)
+{
+  size_t sizes[] = {1, 2, 4, 8};
+  int64_t counts[] = {0, 1, 3, 1000, 50000, 300001};
+  int orders[] = {QIO_NATIVE, QIO_BIG, QIO_LITTLE};
+  int s, c, o;
+  uint8_t buf[16];
+  qio_file_t* f;
+  qio_channel_t* ch;
+  qioerr err;
+
+  for( s = 0; s < 4; s++ ) {
+    for( c = 0; c < 6; c++ ) {
+      for( o = 0; o < 3; o++ ) {
+        check_array(sizes[s], counts[c], orders[o]);
+      }
+    }
+  }
+
+  // Odd element sizes are fine as long as nothing needs swapping.
+  err = qio_file_open_tmp(&f, 0, NULL);
+  assert(!err);
+  err = qio_channel_create(&ch, f, 0, 0, 1, 0, INT64_MAX, NULL, 0);
+  assert(!err);
+  err = qio_channel_write_array(true, QIO_NATIVE, ch, buf, 3, 5);
+  assert(!err);
+  err = qio_channel_write_array(true, htobe16(1) == 1 ? QIO_LITTLE : QIO_BIG, ch, buf, 3, 5);
+  assert(qio_err_to_int(err) == EINVAL);
+  qio_channel_release(ch);
+  qio_file_release(f);
+
+  printf("qio_array_test PASS\n");
+
+  return 0;
+}
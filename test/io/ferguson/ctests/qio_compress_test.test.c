@@ -0,0 +1,128 @@
+#include "qio_formatted.h"
+#include "qio_compress.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Write len bytes as frames after a prefix of junk, then read them
+// back out of order through the index.
+static
+void check_frames(qio_codec_t codec, int64_t prefix, int64_t len, int64_t frame_size)
+{
+  qioerr err;
+  qio_file_t* f;
+  qio_channel_t* ch;
+  qio_frame_writer_t* w;
+  qio_frame_index_t idx;
+  uint8_t* data = malloc(len + 1);
+  uint8_t* got = malloc(len + 1);
+  int64_t off;
+  int64_t i;
+
+  assert(data && got);
+  for( i = 0; i < len; i++ ) data[i] = (uint8_t) ((i / 3) ^ (i >> 7));
+
+  err = qio_file_open_tmp(&f, 0, NULL);
+  assert(!err);
+  err = qio_channel_create(&ch, f, 0, 0, 1, 0, INT64_MAX, NULL, 0);
+  assert(!err);
+  for( i = 0; i < prefix; i++ ) {
+    err = qio_channel_write_uint8(true, ch, 'x');
+    assert(!err);
+  }
+
+  err = qio_frame_writer_create(&w, ch, codec, 3, frame_size);
+  assert(!err);
+
+  // the first two frames compressed "elsewhere", the rest streamed
+  off = 0;
+  for( i = 0; i < 2 && off + frame_size <= len; i++ ) {
+    size_t cap = qio_codec_bound(codec, frame_size);
+    uint8_t* cbuf = malloc(cap);
+    size_t clen = 0;
+    err = qio_codec_compress(codec, 3, data + off, frame_size, cbuf, cap, &clen);
+    assert(!err);
+    err = qio_frame_writer_add_compressed(w, cbuf, clen, frame_size);
+    assert(!err);
+    free(cbuf);
+    off += frame_size;
+  }
+  while( off < len ) {
+    int64_t amt = 1 + (off * 17) % 3000;
+    if( amt > len - off ) amt = len - off;
+    err = qio_frame_writer_write(w, data + off, amt);
+    assert(!err);
+    off += amt;
+  }
+  err = qio_frame_writer_close(w);
+  assert(!err);
+  qio_channel_release(ch);
+
+  err = qio_frame_index_read(f, -1, &idx);
+  assert(!err);
+  assert(idx.codec == codec);
+  assert(idx.frame_size == frame_size);
+  assert(idx.nframes == (len + frame_size - 1) / frame_size);
+  assert(idx.coffset[0] == prefix);
+  assert(idx.uoffset[idx.nframes] == len);
+
+  memset(got, 0, len);
+  for( i = idx.nframes - 1; i >= 0; i-- ) {
+    err = qio_frame_read(f, &idx, i, got + idx.uoffset[i]);
+    assert(!err);
+  }
+  assert(0 == memcmp(data, got, len));
+
+  for( off = 0; off < len; off += 997 ) {
+    i = qio_frame_index_find(&idx, off);
+    assert(i == off / frame_size);
+  }
+  assert(qio_frame_index_find(&idx, len) == idx.nframes);
+  assert(qio_frame_index_find(&idx, -1) == idx.nframes);
+
+  err = qio_frame_read(f, &idx, idx.nframes, got);
+  assert(qio_err_to_int(err) == EINVAL);
+
+  qio_frame_index_destroy(&idx);
+  qio_file_release(f);
+  free(data);
+  free(got);
+}
+
+int main(int argc, char** argv)
+{
+  qio_codec_t codecs[] = {QIO_CODEC_NONE, QIO_CODEC_ZSTD, QIO_CODEC_LZ4};
+  qio_file_t* f;
+  qio_channel_t* ch;
+  qio_frame_index_t idx;
+  qioerr err;
+  int c;
+
+  for( c = 0; c < 3; c++ ) {
+    if( !qio_codec_available(codecs[c]) ) continue;
+    check_frames(codecs[c], 0, 0, 1000);
+    check_frames(codecs[c], 0, 1, 1000);
+    check_frames(codecs[c], 0, 100000, 1000);
+    check_frames(codecs[c], 123, 100000, 4096);
+    check_frames(codecs[c], 5, 1 << 20, QIO_FRAME_DEFAULT_SIZE);
+  }
+
+  // something that isn't a compressed file
+  err = qio_file_open_tmp(&f, 0, NULL);
+  assert(!err);
+  err = qio_channel_create(&ch, f, 0, 0, 1, 0, INT64_MAX, NULL, 0);
+  assert(!err);
+  for( c = 0; c < 100; c++ ) {
+    err = qio_channel_write_uint8(true, ch, c);
+    assert(!err);
+  }
+  qio_channel_release(ch);
+  err = qio_frame_index_read(f, -1, &idx);
+  assert(qio_err_to_int(err) == EINVAL);
+  qio_file_release(f);
+
+  printf("qio_compress_test PASS\n");
+
+  return 0;
+}
@@ -699,6 +699,159 @@ void test_printscan_float(void)
 #undef NSTYLES
 }
 
+// Reference output for the default precision, as _ftoa_core produced it
+// with snprintf alone.
+static
+void print_float_reference(char* buf, size_t sz, double num, int realfmt)
+{
+  if( realfmt == 1 ) {
+    snprintf(buf, sz, "%f", num);
+  } else if( realfmt == 2 ) {
+    snprintf(buf, sz, "%e", num);
+  } else if( fabs(num) >= 100000.0 && fabs(num) < 1000000.0 ) {
+    // %.5e without trailing zeros
+    char* e;
+    char* z;
+    snprintf(buf, sz, "%.5e", num);
+    e = strchr(buf, 'e');
+    for( z = e; z[-1] == '0'; z-- ) ;
+    if( z[-1] == '.' ) z--;
+    memmove(z, e, strlen(e) + 1);
+  } else {
+    snprintf(buf, sz, "%g", num);
+  }
+}
+
+static
+double tricky_double(unsigned* seed, int i)
+{
+  uint64_t bits;
+  switch( i % 5 ) {
+    case 0:
+      // anything finite
+      bits = ((uint64_t) rand_r(seed) << 33) ^ ((uint64_t) rand_r(seed) << 11) ^
+             rand_r(seed);
+      bits &= ~((uint64_t) 0x7FF << 52);
+      bits |= (uint64_t) (rand_r(seed) % 2047) << 52;
+      {
+        double d;
+        memcpy(&d, &bits, sizeof(d));
+        return d;
+      }
+    case 1:
+      // short decimals, including ones that look like ties
+      return (rand_r(seed) % 20000001 - 10000000) /
+             pow(10, rand_r(seed) % 12);
+    case 2:
+      return (rand_r(seed) % 2000000) + 0.5;
+    case 3:
+      return ldexp(rand_r(seed) % 1000, rand_r(seed) % 80 - 40);
+    default:
+      return (double) (rand_r(seed) % 10000000) * pow(10, rand_r(seed) % 30 - 15);
+  }
+}
+
+// The fast paths for default-precision floats and decimal integers
+// have to match what snprintf produces.
+void test_print_fast(void)
+{
+  const int n = 20000;
+  qioerr err;
+  qio_file_t* f;
+  qio_channel_t* writing;
+  qio_channel_t* reading;
+  qio_style_t style;
+  char got[500];
+  char expect[500];
+  unsigned seed;
+  int realfmt;
+  int i;
+
+  for( realfmt = 0; realfmt < 3; realfmt++ ) {
+    qio_style_init_default(&style);
+    style.showpointzero = 0;
+    style.realfmt = realfmt;
+
+    err = qio_file_open_tmp(&f, 0, NULL);
+    assert(!err);
+    err = qio_channel_create(&writing, f, QIO_CH_BUFFERED, 0, 1, 0, INT64_MAX, &style, 0);
+    assert(!err);
+    seed = realfmt;
+    for( i = 0; i < n; i++ ) {
+      double num = tricky_double(&seed, i);
+      uint8_t nl = '\n';
+      err = qio_channel_print_float(true, writing, &num, 8);
+      assert(!err);
+      err = qio_channel_write_amt(true, writing, &nl, 1);
+      assert(!err);
+    }
+    qio_channel_release(writing);
+
+    err = qio_channel_create(&reading, f, QIO_CH_BUFFERED, 1, 0, 0, INT64_MAX, &style, 0);
+    assert(!err);
+    seed = realfmt;
+    for( i = 0; i < n; i++ ) {
+      double num = tricky_double(&seed, i);
+      size_t len;
+      len = 0;
+      while( true ) {
+        int32_t c = qio_channel_read_byte(true, reading);
+        assert(c >= 0);
+        if( c == '\n' ) break;
+        got[len++] = c;
+      }
+      got[len] = '\0';
+      print_float_reference(expect, sizeof(expect), num, realfmt);
+      if( strcmp(got, expect) != 0 ) {
+        fprintf(stderr, "printing %a with realfmt %i\n", num, realfmt);
+        fprintf(stderr, "Got    '%s'\n", got);
+        fprintf(stderr, "Expect '%s'\n", expect);
+        assert(strcmp(got, expect) == 0);
+      }
+    }
+    qio_channel_release(reading);
+    qio_file_release(f);
+  }
+
+  // Integers
+  qio_style_init_default(&style);
+  err = qio_file_open_tmp(&f, 0, NULL);
+  assert(!err);
+  err = qio_channel_create(&writing, f, QIO_CH_BUFFERED, 0, 1, 0, INT64_MAX, &style, 0);
+  assert(!err);
+  seed = 7;
+  for( i = 0; i < n; i++ ) {
+    int64_t num = (((int64_t) rand_r(&seed) << 40) ^ rand_r(&seed)) >> (i % 63);
+    uint8_t nl = '\n';
+    err = qio_channel_print_int(true, writing, &num, 8, 1);
+    assert(!err);
+    err = qio_channel_write_amt(true, writing, &nl, 1);
+    assert(!err);
+  }
+  qio_channel_release(writing);
+
+  err = qio_channel_create(&reading, f, QIO_CH_BUFFERED, 1, 0, 0, INT64_MAX, &style, 0);
+  assert(!err);
+  seed = 7;
+  for( i = 0; i < n; i++ ) {
+    int64_t num = (((int64_t) rand_r(&seed) << 40) ^ rand_r(&seed)) >> (i % 63);
+    size_t len = 0;
+    while( true ) {
+      int32_t c = qio_channel_read_byte(true, reading);
+      assert(c >= 0);
+      if( c == '\n' ) break;
+      got[len++] = c;
+    }
+    got[len] = '\0';
+    snprintf(expect, sizeof(expect), "%lli", (long long int) num);
+    assert(strcmp(got, expect) == 0);
+  }
+  qio_channel_release(reading);
+  qio_file_release(f);
+
+  if( verbose ) printf("PASS: fast number printing\n");
+}
+
 void test_verybasic()
 {
 	qio_file_t *f = NULL;
@@ -1525,6 +1678,7 @@ int main(int argc, char** argv)
     test_endian();
     test_printscan_int();
     test_printscan_float();
+    test_print_fast();
 
     test_readwritestring();
 
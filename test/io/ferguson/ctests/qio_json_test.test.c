@@ -0,0 +1,239 @@
+#include "qio_formatted.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int verbose = 0;
+
+// Return a reading channel over a temporary file containing data.
+static
+qio_channel_t* open_reading(qio_file_t** f_out, const char* data, int64_t len)
+{
+  qioerr err;
+  qio_file_t* f;
+  qio_channel_t* ch;
+
+  err = qio_file_open_tmp(&f, 0, NULL);
+  assert(!err);
+  err = qio_channel_create(&ch, f, 0, 0, 1, 0, INT64_MAX, NULL, 0);
+  assert(!err);
+  err = qio_channel_write_amt(true, ch, data, len);
+  assert(!err);
+  qio_channel_release(ch);
+
+  err = qio_channel_create(&ch, f, 0, 1, 0, 0, INT64_MAX, NULL, 0);
+  assert(!err);
+  *f_out = f;
+  return ch;
+}
+
+static
+void check_skip(const char* json, int32_t expect_ret, int64_t expect_offset)
+{
+  qio_file_t* f;
+  qio_channel_t* ch = open_reading(&f, json, strlen(json));
+  int32_t got;
+
+  if( verbose ) printf("skipping %s\n", json);
+
+  got = qio_skip_json_value_unlocked(ch);
+  assert(got == expect_ret);
+  if( got >= 0 ) assert(qio_channel_offset_unlocked(ch) == expect_offset);
+
+  qio_channel_release(ch);
+  qio_file_release(f);
+}
+
+// The byte-at-a-time rules, including where they are lax.
+static
+void test_skip(void)
+{
+  check_skip("{\"a\":1,\"b\":[true,false,null],\"c\":\"x\\\"y\"} rest", 0, 40);
+  check_skip("  [ 1 , -2.5e+3 , {} , [] ]x", 0, 27);
+  check_skip("\"ab\\\\\" x", 0, 6);
+  check_skip("123,", ',', 4);
+  check_skip("true]", 0, 4);
+  check_skip("[1,]", 0, 4);
+  check_skip("{\"a\":1,}", 0, 8);
+  check_skip("{\"a\" 1}", -EFORMAT, 0);
+  check_skip("[tru]", -EFORMAT, 0);
+  check_skip("{\"a\":[1,2}", -EFORMAT, 0);
+  check_skip("{\"a\":", -EEOF, 0);
+}
+
+// Append a string made of tricky characters to p, quoted and escaped.
+static
+char* add_string(char* p, int len, unsigned* seed)
+{
+  static const char chars[] = "a \\\"{}[]:,";
+  int i;
+
+  *p++ = '"';
+  for( i = 0; i < len; i++ ) {
+    char c = chars[rand_r(seed) % (sizeof(chars) - 1)];
+    if( c == '\\' || c == '"' ) *p++ = '\\';
+    *p++ = c;
+  }
+  *p++ = '"';
+  return p;
+}
+
+// Strings with escapes and nested values landing on every alignment
+// relative to the 64-byte blocks.
+static
+void test_blocks(void)
+{
+  char* buf = malloc(1 << 16);
+  unsigned seed = 1;
+  int pad, len;
+
+  assert(buf);
+
+  for( pad = 0; pad < 70; pad++ ) {
+    for( len = 0; len < 140; len += 7 ) {
+      char* p = buf;
+      char* value;
+      qio_json_tape_t t;
+      qioerr err;
+      int64_t used;
+      int64_t i;
+
+      memset(p, ' ', pad);
+      p += pad;
+      *p++ = '{';
+      *p++ = '"';
+      *p++ = 'k';
+      *p++ = '"';
+      *p++ = ':';
+      value = p;
+      p = add_string(p, len, &seed);
+      p += sprintf(p, ",\"n\":[[[%d]],", len);
+      p = add_string(p, len / 2, &seed);
+      p += sprintf(p, "]}");
+      check_skip(buf, 0, p - buf);
+      *p = '\0';
+
+      qio_json_tape_init(&t);
+      err = qio_json_tape_parse(&t, buf, p - buf, &used);
+      assert(!err);
+      assert(used == p - buf);
+      assert(t.entries[0].type == QIO_JSON_OBJECT);
+      assert(t.entries[0].next == t.n);
+      i = qio_json_tape_find_field(&t, 0, "k", 1);
+      assert(i >= 0 && t.entries[i].type == QIO_JSON_STRING);
+      assert(buf + t.entries[i].start == value);
+      i = qio_json_tape_find_field(&t, 0, "n", 1);
+      assert(i >= 0 && t.entries[i].type == QIO_JSON_ARRAY);
+      assert(t.entries[i+3].type == QIO_JSON_NUMBER);
+      assert(atoi(buf + t.entries[i+3].start) == len);
+      assert(t.entries[i+1].next == i + 4);
+      assert(qio_json_tape_find_field(&t, 0, "x", 1) == -1);
+      qio_json_tape_destroy(&t);
+    }
+  }
+
+  free(buf);
+}
+
+static
+void test_tape_errors(void)
+{
+  qio_json_tape_t t;
+  const char* deep;
+  char* nested;
+  int i;
+
+  qio_json_tape_init(&t);
+  assert(qio_err_to_int(qio_json_tape_parse(&t, " \n ", 3, NULL)) == EEOF);
+  assert(qio_err_to_int(qio_json_tape_parse(&t, "[1,", 3, NULL)) == EFORMAT);
+  assert(qio_err_to_int(qio_json_tape_parse(&t, "[1,]", 4, NULL)) == EFORMAT);
+  assert(qio_err_to_int(qio_json_tape_parse(&t, "01", 2, NULL)) == EFORMAT);
+  assert(qio_json_tape_parse(&t, "-12.5e3", 7, NULL) == 0);
+  assert(t.n == 1 && t.entries[0].type == QIO_JSON_NUMBER);
+
+  // Too deep for the tape, but the skipping code still manages.
+  nested = malloc(2 * QIO_JSON_MAX_DEPTH + 3);
+  assert(nested);
+  for( i = 0; i <= QIO_JSON_MAX_DEPTH; i++ ) {
+    nested[i] = '[';
+    nested[2 * QIO_JSON_MAX_DEPTH + 1 - i] = ']';
+  }
+  nested[2 * QIO_JSON_MAX_DEPTH + 2] = '\0';
+  deep = nested;
+  assert(qio_err_to_int(qio_json_tape_parse(&t, deep, strlen(deep), NULL))
+         == EFORMAT);
+  check_skip(deep, 0, strlen(deep));
+  free(nested);
+
+  qio_json_tape_destroy(&t);
+}
+
+// Line-delimited records, enough that some straddle buffer boundaries.
+static
+void test_read_lines(void)
+{
+  const int nrecords = 20000;
+  char* data = malloc(nrecords * 128);
+  char* p = data;
+  qio_file_t* f;
+  qio_channel_t* ch;
+  qio_json_tape_t t;
+  qioerr err;
+  int i;
+
+  assert(data);
+  for( i = 0; i < nrecords; i++ ) {
+    p += sprintf(p, "{\"id\":%d,\"name\":\"n%d\",\"tags\":[\"a\",\"b\\\"c\"],"
+                    "\"v\":1.5e3}\n", i, i);
+  }
+
+  ch = open_reading(&f, data, p - data);
+  qio_json_tape_init(&t);
+  for( i = 0; ; i++ ) {
+    int64_t k;
+    err = qio_channel_read_json_tape(true, ch, &t);
+    if( qio_err_to_int(err) == EEOF ) break;
+    assert(!err);
+    k = qio_json_tape_find_field(&t, 0, "id", 2);
+    assert(k >= 0 && t.entries[k].type == QIO_JSON_NUMBER);
+    assert(atoi(t.text + t.entries[k].start) == i);
+    k = qio_json_tape_find_field(&t, 0, "v", 1);
+    assert(k >= 0 && t.entries[k].type == QIO_JSON_NUMBER);
+  }
+  assert(i == nrecords);
+  qio_json_tape_destroy(&t);
+  qio_channel_release(ch);
+  qio_file_release(f);
+
+  // Skipping fields one at a time.
+  ch = open_reading(&f, data, p - data);
+  for( i = 0; i < nrecords; i++ ) {
+    int j;
+    assert(qio_channel_read_byte(true, ch) == '{');
+    for( j = 0; j < 4; j++ ) {
+      err = qio_channel_skip_json_field(true, ch);
+      assert(!err);
+      assert(qio_channel_read_byte(true, ch) == (j < 3 ? ',' : '}'));
+    }
+    assert(qio_channel_read_byte(true, ch) == '\n');
+  }
+  assert(qio_channel_read_byte(true, ch) == -EEOF);
+  qio_channel_release(ch);
+  qio_file_release(f);
+
+  free(data);
+}
+
+int main(int argc, char** argv)
+{
+  if( argc > 1 ) verbose = 1;
+
+  test_skip();
+  test_blocks();
+  test_tape_errors();
+  test_read_lines();
+
+  printf("qio_json_test PASS\n");
+  return 0;
+}
@@ -0,0 +1,143 @@
+#include "qio.h"
+#include <assert.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define NMSGS 40
+
+fd_t fds[2];
+
+// Build a buffer of NMSGS messages of different sizes, some of them
+// spanning more than one part, and iterators for each.
+static
+void make_messages(qbuffer_t* buf, qbuffer_iter_t* starts, qbuffer_iter_t* ends, int fill)
+{
+  qioerr err;
+  int i;
+
+  err = qbuffer_init(buf);
+  assert(!err);
+  for( i = 0; i < 3; i++ ) {
+    qbytes_t* bytes;
+    err = qbytes_create_calloc(&bytes, 4000);
+    assert(!err);
+    if( fill ) {
+      int j;
+      for( j = 0; j < 4000; j++ ) ((uint8_t*) bytes->data)[j] = (uint8_t) (i * 4000 + j) % 251;
+    }
+    err = qbuffer_append(buf, bytes, 0, 4000);
+    assert(!err);
+    qbytes_release(bytes);
+  }
+
+  starts[0] = qbuffer_begin(buf);
+  for( i = 0; i < NMSGS; i++ ) {
+    if( i > 0 ) starts[i] = ends[i-1];
+    ends[i] = starts[i];
+    qbuffer_iter_advance(buf, &ends[i], 1 + (i * 97) % 500);
+  }
+}
+
+static
+void check_batch(int yield)
+{
+  qbuffer_t out, in;
+  qbuffer_iter_t ostarts[NMSGS], oends[NMSGS];
+  qbuffer_iter_t istarts[NMSGS], iends[NMSGS];
+  ssize_t sent[NMSGS], recvd[NMSGS];
+  int nsent = 0, nrecvd = 0, total = 0;
+  qioerr err;
+  int i;
+
+  make_messages(&out, ostarts, oends, 1);
+  make_messages(&in, istarts, iends, 0);
+
+  err = qio_send_batch(fds[0], &out, ostarts, oends, NMSGS, 0, yield, &nsent, sent);
+  assert(!err);
+  assert(nsent == NMSGS);
+  for( i = 0; i < NMSGS; i++ ) assert(sent[i] == qbuffer_iter_num_bytes(ostarts[i], oends[i]));
+
+  while( total < NMSGS ) {
+    err = qio_recv_batch(fds[1], &in, istarts + total, iends + total, NMSGS - total, 0, yield, &nrecvd, recvd + total);
+    assert(!err);
+    assert(nrecvd > 0);
+    total += nrecvd;
+  }
+
+  for( i = 0; i < NMSGS; i++ ) {
+    int64_t len = qbuffer_iter_num_bytes(ostarts[i], oends[i]);
+    uint8_t* a = malloc(len);
+    uint8_t* b = malloc(len);
+    assert(recvd[i] == len);
+    err = qbuffer_copyout(&out, ostarts[i], oends[i], a, len);
+    assert(!err);
+    err = qbuffer_copyout(&in, istarts[i], iends[i], b, len);
+    assert(!err);
+    assert(0 == memcmp(a, b, len));
+    free(a);
+    free(b);
+  }
+
+  qbuffer_destroy(&out);
+  qbuffer_destroy(&in);
+}
+
+static
+void* late_sender(void* arg)
+{
+  qbuffer_t out;
+  qbuffer_iter_t starts[NMSGS], ends[NMSGS];
+  int nsent = 0;
+  qioerr err;
+
+  usleep(20000);
+  make_messages(&out, starts, ends, 1);
+  err = qio_send_batch(fds[0], &out, starts, ends, 1, 0, 0, &nsent, NULL);
+  assert(!err && nsent == 1);
+  qbuffer_destroy(&out);
+  return NULL;
+}
+
+int main(int argc, char** argv)
+{
+  qbuffer_t in;
+  qbuffer_iter_t starts[NMSGS], ends[NMSGS];
+  ssize_t recvd[NMSGS];
+  pthread_t thread;
+  int nrecvd = 0;
+  qioerr err;
+  int rc;
+
+  rc = socketpair(AF_UNIX, SOCK_DGRAM, 0, fds);
+  assert(rc == 0);
+
+  check_batch(0);
+  check_batch(1);
+
+  // Yielding on an empty socket until a message arrives
+  make_messages(&in, starts, ends, 0);
+  rc = pthread_create(&thread, NULL, late_sender, NULL);
+  assert(rc == 0);
+  err = qio_recv_batch(fds[1], &in, starts, ends, NMSGS, 0, 1, &nrecvd, recvd);
+  assert(!err);
+  assert(nrecvd == 1);
+  assert(recvd[0] == 1);
+  pthread_join(thread, NULL);
+
+  // and an empty socket without yielding reports EAGAIN
+  err = qio_recv_batch(fds[1], &in, starts, ends, NMSGS, MSG_DONTWAIT, 0, &nrecvd, recvd);
+  assert(qio_err_to_int(err) == EAGAIN);
+  assert(nrecvd == 0);
+  qbuffer_destroy(&in);
+
+  close(fds[0]);
+  close(fds[1]);
+
+  printf("qio_mmsg_test PASS\n");
+
+  return 0;
+}
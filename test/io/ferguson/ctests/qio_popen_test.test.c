@@ -0,0 +1,166 @@
+#include "qio.h"
+#include "qio_popen.h"
+#include <assert.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+// qio_popen.c waits for children with the tasking layer's yield.
+void chpl_task_yield(void)
+{
+  sched_yield();
+}
+
+static
+void check_pipe_fd(int fd, int nonblocking)
+{
+  int fl = fcntl(fd, F_GETFL);
+  int fdfl = fcntl(fd, F_GETFD);
+
+  // the parent's end of the pipe is off of 0-2 and not inherited by
+  // other children
+  assert(fd > 2);
+  assert(fl != -1 && fdfl != -1);
+  assert(fdfl & FD_CLOEXEC);
+  assert(((fl & O_NONBLOCK) != 0) == nonblocking);
+}
+
+static
+qio_channel_t* open_pipe_channel(qio_file_t** f, int fd, int readable, int nonblocking)
+{
+  qio_channel_t* ch;
+  qioerr err;
+
+  err = qio_file_init(f, NULL, fd, QIO_HINT_OWNED, NULL, 0);
+  assert(!err);
+  assert((((*f)->fdflags & QIO_FDFLAG_NONBLOCKING) != 0) == nonblocking);
+
+  err = qio_channel_create(&ch, *f, 0, readable, !readable, 0, INT64_MAX, NULL, 0);
+  assert(!err);
+  return ch;
+}
+
+static
+void close_pipe_channel(qio_file_t* f, qio_channel_t* ch)
+{
+  qioerr err;
+
+  err = qio_channel_close(false, ch);
+  assert(!err);
+  qio_channel_release(ch);
+  err = qio_file_close(f);
+  assert(!err);
+  qio_file_release(f);
+}
+
+// Read everything from the channel until EOF.
+static
+ssize_t read_all(qio_channel_t* ch, char* buf, ssize_t len)
+{
+  ssize_t total = 0;
+  ssize_t amt;
+  qioerr err;
+
+  while( total < len ) {
+    amt = 0;
+    err = qio_channel_read(false, ch, buf + total, len - total, &amt);
+    total += amt;
+    if( qio_err_to_int(err) == EEOF ) break;
+    assert(!err);
+  }
+  return total;
+}
+
+static
+void wait_for(int64_t pid)
+{
+  int done = 0;
+  int exitcode = -1;
+  qioerr err;
+
+  err = qio_waitpid(pid, 1, &done, &exitcode);
+  assert(!err);
+  assert(done);
+  assert(exitcode == 0);
+}
+
+static
+void check_delayed_output(int fdkind)
+{
+  const char* argv[] = {"sh", "-c", "sleep 0.1; echo hello", NULL};
+  int in_fd = QIO_FD_FORWARD;
+  int out_fd = fdkind;
+  int err_fd = QIO_FD_FORWARD;
+  int nonblocking = fdkind == QIO_FD_NONBLOCKING_PIPE;
+  int64_t pid;
+  qio_file_t* outf;
+  qio_channel_t* out;
+  char buf[100];
+  ssize_t got;
+  qioerr err;
+
+  err = qio_openproc(argv, NULL, NULL, &in_fd, &out_fd, &err_fd, &pid);
+  assert(!err);
+  check_pipe_fd(out_fd, nonblocking);
+
+  // with a non-blocking pipe, the read yields until the output arrives
+  out = open_pipe_channel(&outf, out_fd, 1, nonblocking);
+  got = read_all(out, buf, sizeof(buf));
+  assert(got == 6);
+  assert(0 == memcmp(buf, "hello\n", 6));
+  close_pipe_channel(outf, out);
+
+  wait_for(pid);
+}
+
+static
+void check_cat(int fdkind)
+{
+  const char* argv[] = {"cat", NULL};
+  const char* msg = "some data for cat\n";
+  ssize_t len = strlen(msg);
+  int in_fd = fdkind;
+  int out_fd = fdkind;
+  int err_fd = QIO_FD_FORWARD;
+  int nonblocking = fdkind == QIO_FD_NONBLOCKING_PIPE;
+  int64_t pid;
+  qio_file_t* inf;
+  qio_file_t* outf;
+  qio_channel_t* in;
+  qio_channel_t* out;
+  char buf[100];
+  ssize_t got;
+  qioerr err;
+
+  err = qio_openproc(argv, NULL, NULL, &in_fd, &out_fd, &err_fd, &pid);
+  assert(!err);
+  check_pipe_fd(in_fd, nonblocking);
+  check_pipe_fd(out_fd, nonblocking);
+
+  in = open_pipe_channel(&inf, in_fd, 0, nonblocking);
+  err = qio_channel_write_amt(false, in, msg, len);
+  assert(!err);
+  close_pipe_channel(inf, in);
+
+  out = open_pipe_channel(&outf, out_fd, 1, nonblocking);
+  got = read_all(out, buf, sizeof(buf));
+  assert(got == len);
+  assert(0 == memcmp(buf, msg, len));
+  close_pipe_channel(outf, out);
+
+  wait_for(pid);
+}
+
+int main(int argc, char** argv)
+{
+  check_delayed_output(QIO_FD_PIPE);
+  check_delayed_output(QIO_FD_NONBLOCKING_PIPE);
+  check_cat(QIO_FD_PIPE);
+  check_cat(QIO_FD_NONBLOCKING_PIPE);
+
+  printf("qio_popen_test PASS\n");
+
+  return 0;
+}
@@ -0,0 +1,88 @@
+#include "qio_formatted.h"
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Scanning integers and floats must agree exactly with strtoll/strtod,
+// whichever conversion path qio_channel_scan_* ends up taking.
+int main(int argc, char** argv)
+{
+  qio_file_t* f;
+  qio_channel_t* writing;
+  qio_channel_t* reading;
+  qioerr err;
+  char line[256];
+  int n = 200000;
+  double* ref_d = malloc(n * sizeof(double));
+  long long* ref_i = malloc(n * sizeof(long long));
+  int i, k;
+
+  assert(ref_d && ref_i);
+  srand(3);
+
+  err = qio_file_open_tmp(&f, 0, NULL);
+  assert(!err);
+  err = qio_channel_create(&writing, f, 0, 0, 1, 0, INT64_MAX, NULL, 0);
+  assert(!err);
+
+  for( i = 0; i < n; i++ ) {
+    // up to 40 whitespace characters, then an integer and a float
+    int nspace = rand() % 40;
+    char* p = line;
+    char* dstart;
+    long long v = ((long long) rand() << 31 ^ rand()) * ((rand() & 1) ? -1 : 1);
+    double d = (rand() / (double) RAND_MAX - 0.5) * pow(10, rand() % 640 - 320);
+
+    if( i % 7 == 0 ) v %= 1000;
+    for( k = 0; k < nspace; k++ ) *p++ = " \t\n\r"[rand() % 4];
+    p += sprintf(p, "%lld ", v);
+    dstart = p;
+    switch( i % 4 ) {
+      case 0: p += sprintf(p, "%.17g", d); break;
+      case 1: p += sprintf(p, "%g", d); break;
+      case 2: p += sprintf(p, "%.3f", fmod(d, 1e6)); break;
+      case 3: p += sprintf(p, "%.25e", d); break;
+    }
+    *p++ = '\n';
+    *p = '\0';
+
+    ref_i[i] = v;
+    ref_d[i] = strtod(dstart, NULL);
+
+    err = qio_channel_write_amt(true, writing, line, strlen(line));
+    assert(!err);
+  }
+  qio_channel_release(writing);
+
+  err = qio_channel_create(&reading, f, 0, 1, 0, 0, INT64_MAX, NULL, 0);
+  assert(!err);
+
+  for( i = 0; i < n; i++ ) {
+    int64_t got_i;
+    double got_d;
+
+    err = qio_channel_scan_int(true, reading, &got_i, 8, 1);
+    assert(!err);
+    assert(got_i == ref_i[i]);
+
+    err = qio_channel_scan_float(true, reading, &got_d, 8);
+    // strtod reports overflow and underflow; so does scan_float
+    if( err ) {
+      assert(qio_err_to_int(err) == ERANGE);
+      assert(isinf(ref_d[i]) || ref_d[i] == 0.0);
+      continue;
+    }
+    assert(0 == memcmp(&got_d, &ref_d[i], sizeof(double)));
+  }
+
+  qio_channel_release(reading);
+  qio_file_release(f);
+  free(ref_d);
+  free(ref_i);
+
+  printf("qio_scan_number_test PASS\n");
+
+  return 0;
+}
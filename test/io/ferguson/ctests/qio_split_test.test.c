@@ -0,0 +1,133 @@
+#include "qio_formatted.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+int verbose = 0;
+
+const char* path = "split_test.txt";
+
+// Lines of 0 to 199 bytes, including one much longer than any chunk
+// once we divide the file finely.
+static
+int64_t write_test_file(char** data_out)
+{
+  qioerr err;
+  qio_file_t* f;
+  qio_channel_t* writing;
+  int64_t len = 0;
+  int64_t cap = 1024*1024;
+  char* data = malloc(cap);
+  int i, j;
+
+  assert(data);
+
+  for( i = 0; i < 1000; i++ ) {
+    int linelen = (i * 37) % 200;
+    if( i == 500 ) linelen = 50000;
+    for( j = 0; j < linelen; j++ ) data[len++] = 'a' + (i + j) % 26;
+    data[len++] = '\n';
+  }
+  // no terminator on the last record
+  memcpy(data + len, "tail", 4);
+  len += 4;
+
+  err = qio_file_open_access(&f, path, "w", 0, NULL);
+  assert(!err);
+  err = qio_channel_create(&writing, f, 0, 0, 1, 0, INT64_MAX, NULL, 0);
+  assert(!err);
+  err = qio_channel_write_amt(true, writing, data, len);
+  assert(!err);
+  qio_channel_release(writing);
+  err = qio_file_close(f);
+  assert(!err);
+  qio_file_release(f);
+
+  *data_out = data;
+  return len;
+}
+
+static
+void check_split(const char* data, int64_t len, qio_hint_t hints, int64_t start, int64_t end, int64_t nchunks)
+{
+  qioerr err;
+  qio_file_t* f;
+  int64_t bounds[65];
+  int64_t expect_end = (end == INT64_MAX) ? len : end;
+  int64_t i, off;
+
+  if( verbose ) printf("split hints=%x [%lli,%lli) into %lli\n", (int) hints,
+                       (long long) start, (long long) end, (long long) nchunks);
+
+  err = qio_file_open_access(&f, path, "r", hints, NULL);
+  assert(!err);
+
+  err = qio_file_split_records(f, 0, start, end, '\n', nchunks, bounds);
+  assert(!err);
+
+  assert(bounds[0] == start);
+  assert(bounds[nchunks] == expect_end);
+
+  for( i = 1; i < nchunks; i++ ) {
+    int64_t split = start + (int64_t) ((double) (expect_end - start) * i / nchunks);
+    assert(bounds[i] >= bounds[i-1]);
+    assert(bounds[i] <= expect_end);
+    if( bounds[i] == bounds[i-1] || bounds[i] == start ) continue;
+    // each chunk ends right after a terminator ...
+    if( bounds[i] < expect_end ) assert(data[bounds[i]-1] == '\n');
+    // ... and that's the first one at or after the split point
+    for( off = (split > start) ? split - 1 : start; off < bounds[i] - 1; off++ ) {
+      assert(data[off] != '\n');
+    }
+  }
+
+  // Reading every chunk in turn gives back the whole range.
+  for( i = 0; i < nchunks; i++ ) {
+    qio_channel_t* reading;
+    int64_t amt = bounds[i+1] - bounds[i];
+    char* got = malloc(amt + 1);
+    assert(got);
+
+    err = qio_channel_create(&reading, f, 0, 1, 0, bounds[i], bounds[i+1], NULL, 0);
+    assert(!err);
+    if( amt > 0 ) {
+      err = qio_channel_read_amt(true, reading, got, amt);
+      assert(!err);
+      assert(0 == memcmp(got, data + bounds[i], amt));
+    }
+    qio_channel_release(reading);
+    free(got);
+  }
+
+  err = qio_file_close(f);
+  assert(!err);
+  qio_file_release(f);
+}
+
+int main(int argc, char** argv)
+{
+  qio_hint_t hints[] = {QIO_METHOD_DEFAULT, QIO_METHOD_PREADPWRITE, QIO_METHOD_MMAP};
+  int nhints = sizeof(hints)/sizeof(qio_hint_t);
+  char* data = NULL;
+  int64_t len;
+  int h;
+  int64_t n;
+
+  len = write_test_file(&data);
+
+  for( h = 0; h < nhints; h++ ) {
+    for( n = 1; n <= 64; n++ ) {
+      check_split(data, len, hints[h], 0, INT64_MAX, n);
+      check_split(data, len, hints[h], 1234, len - 77, n);
+    }
+  }
+
+  free(data);
+  unlink(path);
+
+  printf("qio_split_test PASS\n");
+
+  return 0;
+}
@@ -0,0 +1,83 @@
+#include "qio.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+const char* path = "view_test.bin";
+
+int main(int argc, char** argv)
+{
+  qioerr err;
+  qio_file_t* f;
+  qio_channel_t* writing;
+  qio_file_view_t view;
+  int64_t len = 3 * 65536 + 123;
+  uint8_t* data = malloc(len);
+  int64_t starts[] = {0, 1, 4095, 4096, 70000, 3 * 65536 + 122};
+  int i;
+
+  assert(data);
+  for( i = 0; i < len; i++ ) data[i] = (uint8_t) (i * 13 + (i >> 9));
+
+  err = qio_file_open_access(&f, path, "w", 0, NULL);
+  assert(!err);
+  err = qio_channel_create(&writing, f, 0, 0, 1, 0, INT64_MAX, NULL, 0);
+  assert(!err);
+  err = qio_channel_write_amt(true, writing, data, len);
+  assert(!err);
+  qio_channel_release(writing);
+  qio_file_release(f);
+
+  err = qio_file_open_access(&f, path, "r", 0, NULL);
+  assert(!err);
+
+  // unaligned starts, explicit lengths, and views to the end of the file
+  for( i = 0; i < (int) (sizeof(starts)/sizeof(starts[0])); i++ ) {
+    err = qio_file_view(f, starts[i], 100, 0, 0, &view);
+    assert(!err);
+    assert(view.len == (len - starts[i] < 100 ? len - starts[i] : 100));
+    assert(0 == memcmp(view.data, data + starts[i], view.len));
+    qio_file_view_release(&view);
+
+    err = qio_file_view(f, starts[i], -1, 0, QIO_HINT_SEQUENTIAL, &view);
+    assert(!err);
+    assert(view.len == len - starts[i]);
+    assert(0 == memcmp(view.data, data + starts[i], view.len));
+    qio_file_view_release(&view);
+  }
+
+  // past the end of the file is an empty view
+  err = qio_file_view(f, len + 10, 100, 0, 0, &view);
+  assert(!err);
+  assert(view.len == 0 && view.data == NULL && view.map == NULL);
+  qio_file_view_release(&view);
+
+  err = qio_file_view(f, -1, 100, 0, 0, &view);
+  assert(qio_err_to_int(err) == EINVAL);
+
+  // copy-on-write views can be modified without changing the file,
+  // and outlive the file they came from
+  err = qio_file_view(f, 5000, -1, 1, 0, &view);
+  assert(!err);
+  memset(view.data, 0xff, 1000);
+  {
+    qio_file_view_t other;
+    err = qio_file_view(f, 5000, 1000, 0, 0, &other);
+    assert(!err);
+    assert(0 == memcmp(other.data, data + 5000, 1000));
+    qio_file_view_release(&other);
+  }
+  qio_file_release(f);
+  assert(((uint8_t*) view.data)[999] == 0xff);
+  assert(0 == memcmp((uint8_t*) view.data + 1000, data + 6000, len - 6000));
+  qio_file_view_release(&view);
+
+  unlink(path);
+  free(data);
+
+  printf("qio_view_test PASS\n");
+
+  return 0;
+}
@@ -0,0 +1,36 @@
+// A module initializer leaves out calls that an earlier call in it has
+// already made, but not when that earlier initializer can get back to
+// the current one before it initializes the module in question.
+
+module B {
+  writeln("init B");
+}
+
+// Main's call to B is covered by its call to A
+module A {
+  use B;
+  writeln("init A");
+}
+
+// P's initializer runs X's before it gets to Q, so X must still call Q
+module Q {
+  writeln("init Q");
+}
+
+module X {
+  use P, Q;
+  writeln("init X");
+}
+
+module P {
+  use X, Q;
+  writeln("init P");
+}
+
+module Main {
+  use A, B, P;
+
+  proc main() {
+    writeln("main");
+  }
+}
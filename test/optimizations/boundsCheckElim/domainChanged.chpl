@@ -0,0 +1,17 @@
+// The loop body changes the domain the access relies on, so the access
+// must keep its bounds check even though it is over the array's domain.
+
+var D = {1..10};
+var A: [D] int;
+
+// unchanged domain: these accesses are in bounds without a check
+forall i in D do A[i] = i;
+writeln(A);
+
+serial {
+  forall i in D with (ref D) {
+    if i == 5 then D = {1..3};
+    A[i] = 2 * i;
+  }
+}
+writeln(A);
@@ -0,0 +1,17 @@
+// Accesses in foralls over an array's own domain, which have their bounds
+// checks removed, should behave the same as the checked ones.
+
+var D = {1..10};
+var A, B: [D] int;
+
+forall i in A.domain do A[i] = i;
+forall i in D do B[i] = A[i] * 2;
+forall i in B.domain do A[i] += B[i];
+
+writeln(A);
+writeln(B);
+
+// this access isn't over C's domain and keeps its check
+var C: [1..20] int;
+forall i in D do C[i+5] = A[i];
+writeln(C);
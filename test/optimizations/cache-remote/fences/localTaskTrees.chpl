@@ -0,0 +1,39 @@
+// Task wrappers whose whole call tree is local don't need the remote
+// cache fences, however deep or recursive that tree is.  Ones whose call
+// tree writes remote data must keep them, so the writes are visible once
+// the tasks are joined.
+
+class Cell {
+  var x: int;
+}
+
+config const depth = 30;
+
+// local and recursive, deeper than --optimize-on-clause-limit
+proc localSum(n: int): int {
+  if n == 0 then return 0;
+  return n + localSum(n - 1);
+}
+
+var sums: [1..4] int;
+coforall i in 1..4 with (ref sums) do
+  sums[i] = localSum(depth + i);
+writeln(sums);
+
+// recursive too, but the innermost call writes to locale 1
+var cells: [1..4] unmanaged Cell?;
+on Locales[1] do
+  for i in 1..4 do
+    cells[i] = new unmanaged Cell();
+
+proc remoteWrite(c: unmanaged Cell, n: int, v: int) {
+  if n == 0 then c.x = v;
+  else remoteWrite(c, n - 1, v);
+}
+
+coforall i in 1..4 do
+  remoteWrite(cells[i]!, depth, 10 * i);
+writeln([c in cells] c!.x);
+
+for c in cells do
+  delete c;
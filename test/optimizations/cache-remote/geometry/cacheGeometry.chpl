@@ -0,0 +1,67 @@
+// Microbenchmark for the remote cache geometry settings
+// (CHPL_RT_CACHE_SIZE, CHPL_RT_CACHE_PAGE_SIZE, CHPL_RT_CACHE_LINE_SIZE,
+//  CHPL_RT_CACHE_AIN, CHPL_RT_CACHE_AOUT).
+//
+// Locale 0 reads an array stored on the last locale with a sequential
+// scan, a strided scan, and a random-ish scan over a small working set.
+// Use sweepCacheGeometry.sh to run it over a range of settings.
+
+use Time;
+
+config const n = 100_000;
+config const stride = 17;
+config const workingSet = 4096;
+config const trials = 3;
+config const printTiming = false;
+
+class Data {
+  var A: [0..#n] int = 0..#n;
+}
+
+var c: unmanaged Data?;
+on Locales[numLocales-1] do c = new unmanaged Data();
+const data = c!;
+
+proc sequential() {
+  var sum = 0;
+  for i in 0..#n do sum += data.A[i];
+  return sum;
+}
+
+proc strided() {
+  var sum = 0;
+  for j in 0..#stride do
+    for i in j..<n by stride do sum += data.A[i];
+  return sum;
+}
+
+proc reuse() {
+  var sum = 0;
+  var x = 0;
+  for i in 0..#n {
+    x = (x * 1103515245 + 12345) % workingSet;
+    sum += data.A[x];
+  }
+  return sum;
+}
+
+enum pattern { sequential, strided, reuse };
+
+for p in pattern {
+  var t: stopwatch;
+  var sum = 0;
+  t.start();
+  for 1..trials {
+    select p {
+      when pattern.sequential do sum = sequential();
+      when pattern.strided do sum = strided();
+      when pattern.reuse do sum = reuse();
+    }
+  }
+  t.stop();
+  writeln(p, ": ", sum);
+  if printTiming then
+    writeln(p, " time: ", t.elapsed() / trials);
+}
+
+delete c;
@@ -0,0 +1,23 @@
+#!/usr/bin/env bash
+#
+# Sweep the remote cache geometry settings for cacheGeometry.chpl.
+#
+# usage: sweepCacheGeometry.sh [launcher args...]
+# e.g.   sweepCacheGeometry.sh -nl 2
+#
+# Compile first with:
+#   chpl --fast --cache-remote cacheGeometry.chpl
+
+exe=./cacheGeometry
+args=${@:--nl 2}
+
+for size in 256k 1m 4m; do
+  for page in 256 1k 4k; do
+    for ain in 10% 25% 50%; do
+      echo "CHPL_RT_CACHE_SIZE=$size CHPL_RT_CACHE_PAGE_SIZE=$page CHPL_RT_CACHE_AIN=$ain"
+      CHPL_RT_CACHE_SIZE=$size CHPL_RT_CACHE_PAGE_SIZE=$page \
+        CHPL_RT_CACHE_AIN=$ain \
+        $exe $args --printTiming=true | grep time
+    done
+  done
+done
@@ -0,0 +1,53 @@
+// 'in' formals that are only read may borrow the caller's value instead
+// of a copy; the results must be the same as with the copy.
+
+record R {
+  var name: string;
+  var n: int;
+}
+
+proc shout(in s: string): string {
+  return s + "!";
+}
+
+proc describe(in r: R) {
+  writeln(r.name, " ", r.n, " ", r.name.size);
+}
+
+proc count(in s, x) {
+  var k = 0;
+  for c in s do if c == x then k += 1;
+  return k;
+}
+
+proc keep(in s: string) {
+  var t = s;
+  t += "?";
+  return t;
+}
+
+proc depth(in s: string, n: int): int {
+  if n == 0 then return s.size;
+  return depth(s, n - 1);
+}
+
+const greeting = "hello";
+writeln(shout(greeting));
+writeln(greeting);
+
+const r = new R("record", 3);
+describe(r);
+writeln(r);
+
+writeln(count(greeting, "l"));
+writeln(count("mississippi", "s"));
+
+writeln(keep(greeting));
+writeln(greeting);
+
+writeln(depth(greeting, 5));
+
+var changing = "var";
+writeln(shout(changing));
+changing += "iable";
+writeln(shout(changing));
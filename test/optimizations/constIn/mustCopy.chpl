@@ -0,0 +1,45 @@
+// 'in' formals that must still get their own copy: the caller's value
+// changes while the callee runs, or the record's init= and deinit can
+// see the copy being made.
+
+var g = "global";
+
+proc clobbersGlobal(in s: string) {
+  g = "changed";
+  writeln(s, " ", g);
+}
+
+clobbersGlobal(g);
+writeln(g);
+
+record counted {
+  var x: int;
+  proc init(x: int) { this.x = x; }
+  proc init=(other: counted) {
+    this.x = other.x;
+    writeln("copy ", x);
+  }
+  proc deinit() { writeln("deinit ", x); }
+}
+
+proc show(in c: counted) {
+  writeln("show ", c.x);
+}
+
+{
+  const c = new counted(7);
+  show(c);
+  writeln("after");
+}
+
+class Holder {
+  var s: string;
+}
+
+proc viaHolder(in s: string, h: borrowed Holder) {
+  h.s = "overwritten";
+  writeln(s, " ", h.s);
+}
+
+var h = new Holder("held");
+viaHolder(h.s, h.borrow());
@@ -0,0 +1,35 @@
+// Module-level variables that are read somewhere must be kept, even
+// when the only read is in a module deinit, a task, a function that is
+// only called indirectly, or the automatic deinit of a record.
+
+record loud {
+  var x: int;
+  proc deinit() { writeln("deinit loud ", x); }
+}
+
+var readInDeinit = 1;
+var readInTask = 2;
+var readIndirectly = 3;
+var destroyed = new loud(4);
+var readOnlyIfAsked = 5;
+
+config const ask = false;
+
+proc indirect() {
+  writeln("indirectly ", readIndirectly);
+}
+
+sync {
+  begin writeln("in task ", readInTask);
+}
+
+const f = indirect;
+f();
+
+if ask then writeln(readOnlyIfAsked);
+
+readInDeinit = 11;
+
+proc deinit() {
+  writeln("module deinit ", readInDeinit);
+}
@@ -0,0 +1,18 @@
+// Module-level variables that are never read may be removed, but any
+// side effects of their initialization must still happen.
+
+proc noisy(x: int) {
+  writeln("initializing with ", x);
+  return x * 2;
+}
+
+var unusedPlain = 42;
+var unusedChain = unusedPlain;
+const unusedNoisy = noisy(3);
+var unusedReassigned: real;
+unusedReassigned = 1.5;
+
+config const used = 7;
+var usedGlobal = used + 1;
+
+writeln(usedGlobal);
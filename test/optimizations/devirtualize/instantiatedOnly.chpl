@@ -0,0 +1,38 @@
+// Virtual calls whose only instantiated implementation is an override,
+// or the base method, may be made direct; they must still run the
+// right method.
+
+class Shape {
+  proc area(): real { return 0.0; }
+  proc name(): string { return "shape"; }
+}
+
+class Square : Shape {
+  var side: real;
+  override proc area(): real { return side * side; }
+  override proc name(): string { return "square"; }
+}
+
+// never instantiated, so calls through Shape can't reach these
+class Circle : Shape {
+  var r: real;
+  override proc area(): real { return 3.14 * r * r; }
+  override proc name(): string { return "circle"; }
+}
+
+proc describe(s: borrowed Shape) {
+  writeln(s.name(), " ", s.area());
+}
+
+var sq = new Square(2.0);
+describe(sq.borrow());
+
+var total = 0.0;
+for i in 1..4 {
+  var s: owned Shape = new Square(i: real);
+  total += s.area();
+}
+writeln(total);
+
+var c: owned Circle?;
+writeln(c == nil);
@@ -0,0 +1,42 @@
+// Virtual calls that can reach more than one implementation must stay
+// virtual, including when the other implementation is only created in a
+// function that may never run or in a grandchild class.
+
+class Animal {
+  proc speak(): string { return "..."; }
+}
+
+class Dog : Animal {
+  override proc speak(): string { return "woof"; }
+}
+
+class Puppy : Dog {
+  override proc speak(): string { return "yip"; }
+}
+
+class Cat : Animal {
+  override proc speak(): string { return "meow"; }
+}
+
+config const makeCat = false;
+
+proc maybeCat(): owned Animal {
+  if makeCat then
+    return new Cat();
+  return new Dog();
+}
+
+proc talk(a: borrowed Animal) {
+  writeln(a.speak());
+}
+
+var animals: [1..3] owned Animal?;
+animals[1] = new Dog();
+animals[2] = new Puppy();
+animals[3] = maybeCat();
+for a in animals do
+  talk(a!);
+
+// only Dog and Puppy reach Dog.speak's slot, but they differ
+var d: owned Dog = new Puppy();
+writeln(d.speak());
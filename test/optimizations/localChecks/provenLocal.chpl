@@ -0,0 +1,27 @@
+// A local check can be dropped when an earlier one proved the same
+// variable local and it hasn't changed since, but not once it may have.
+
+class C {
+  var x: int;
+}
+
+var l = new unmanaged C(1);
+var r: unmanaged C?;
+on Locales[1] do r = new unmanaged C(10);
+
+// 'l' doesn't change, so only its first check is needed
+var sum = 0;
+local {
+  sum += l.x;
+  for i in 1..3 do
+    sum += l.x;
+}
+writeln(sum);
+
+// 'o' changes every iteration, so the remote one must still be caught
+for o in [l, r!] {
+  local {
+    sum += o.x + o.x;
+  }
+  writeln(sum);
+}
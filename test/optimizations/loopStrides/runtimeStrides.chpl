@@ -0,0 +1,34 @@
+// Inner loops that scale by a runtime stride get a copy for stride 1.
+// Both copies have to compute the same thing, and a scale the loop
+// itself changes must not be treated as a stride.
+
+config const n = 10;
+
+proc fill(stride: int) {
+  var A: [1..n*stride by stride] int;
+  for (a, i) in zip(A, 1..) do
+    a = i * i;
+  return + reduce A;
+}
+
+// stride 1 takes the specialized copy, stride 3 the general one
+writeln(fill(1));
+writeln(fill(3));
+
+proc scaled(blk: int) {
+  var sum = 0;
+  for i in 1..n do
+    sum += i * blk;
+  return sum;
+}
+
+writeln(scaled(1));
+writeln(scaled(2));
+
+// 'blk' starts at 1 but changes in the loop
+var blk = 1, sum = 0;
+for i in 1..n {
+  sum += i * blk;
+  blk += 1;
+}
+writeln(sum);
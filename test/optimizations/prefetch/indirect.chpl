@@ -0,0 +1,22 @@
+// Prefetching the targets of `A[B[i]]` must not change the results, including
+// near the ends of `B` and for indices in `B` that are out of `A`'s bounds.
+config const n = 100;
+
+var A: [1..n] int = [i in 1..n] i * 10;
+var B: [1..n] int = [i in 1..n] (i * 37) % n + 1;
+var C: [1..n] int;
+
+forall i in B.domain do
+  C[i] = A[B[i]];
+
+writeln(+ reduce C);
+
+var D: [0..<n] int = [i in 0..<n] if i % 5 == 0 then 0 else i;
+var E: [0..<n] real;
+
+forall i in D.domain {
+  if A.domain.contains(D[i]) then
+    E[i] = A[D[i]] / 2.0;
+}
+
+writeln(+ reduce E);
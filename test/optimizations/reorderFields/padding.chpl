@@ -0,0 +1,20 @@
+// Fields are sorted by alignment, with @hotField ones first, and the
+// records still behave the same.
+
+record padded {
+  var a: int(8);
+  var b: real;
+  var c: int(8);
+  var d: int(32);
+}
+
+record hot {
+  var x: real;
+  @hotField var flag: bool;
+  var y: real;
+}
+
+var p = new padded(1, 2.0, 3, 4);
+var h = new hot(1.5, true, 2.5);
+writeln(p);
+writeln(h);
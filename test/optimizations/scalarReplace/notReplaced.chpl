@@ -0,0 +1,41 @@
+// Records that can't be scalar replaced: ones that aren't plain data,
+// ones with more fields than --scalar-replace-limit, and ones whose
+// address escapes to a call that isn't inlined.  They have to keep
+// behaving like records in memory.
+
+record counted {
+  var x: int;
+  proc deinit() { writeln("deinit ", x); }
+}
+
+record wide {
+  var a, b, c, d, e: int;
+}
+
+record point {
+  var x, y: real;
+}
+
+pragma "no inline"
+proc bump(ref p: point) {
+  p.x += 1.0;
+  p.y += 2.0;
+}
+
+for i in 1..2 {
+  const c = new counted(i);
+  writeln(c.x);
+}
+
+var w = new wide();
+for i in 1..3 {
+  const t = new wide(i, i, i, i, i);
+  w = new wide(w.a + t.a, w.b + 2 * t.b, w.c + 3 * t.c,
+               w.d + 4 * t.d, w.e + 5 * t.e);
+}
+writeln(w);
+
+var p = new point(0.0, 0.0);
+for i in 1..3 do
+  bump(p);
+writeln(p);
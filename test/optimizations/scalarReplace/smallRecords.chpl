@@ -0,0 +1,29 @@
+// Small plain-data records can be scalar replaced; make sure the ones
+// in these loops still compute the same values.
+
+record point {
+  var x, y, z: real;
+}
+
+proc point.plus(other: point) {
+  return new point(x + other.x, y + other.y, z + other.z);
+}
+
+record pair {
+  var key: int;
+  var value: real;
+}
+
+var sum = new point();
+for i in 1..10 {
+  const p = new point(i, 2 * i, 3 * i);
+  sum = sum.plus(p);
+}
+writeln(sum);
+
+var best = new pair(0, 0.0);
+for i in 1..10 {
+  const kv = new pair(i, (i * 7) % 11 : real);
+  if kv.value > best.value then best = kv;
+}
+writeln(best);
@@ -0,0 +1,18 @@
+// Arrays of records declared with @soa are stored one array per field
+// but should behave the same as the array of records.
+
+record particle {
+  var x: real;
+  var y: real = 1.0;
+  var id: int;
+}
+
+@soa var P: [1..5] particle;
+
+forall i in P.domain {
+  P[i].x = i * 0.5;
+  P[i].id = i;
+}
+forall i in P.domain do P[i].y += P[i].x;
+
+for i in P.domain do writeln(P[i].id, " ", P[i].x, " ", P[i].y);
@@ -0,0 +1,11 @@
+// Arrays used as whole records are kept as arrays of records.
+
+record pair {
+  var a: int;
+  var b: int;
+}
+
+@soa var A: [1..3] pair;
+
+for i in A.domain do A[i].a = i;
+writeln(A);
@@ -0,0 +1,127 @@
+// Class instances that don't escape their creating function may be
+// stack allocated; ones that do must still be valid after it returns.
+
+class C {
+  var x: int;
+}
+
+class Registered {
+  var x: int;
+  proc init(x: int) {
+    this.x = x;
+    init this;
+    registry = this: unmanaged;
+  }
+}
+
+var registry: unmanaged Registered?;
+
+class Holder {
+  var c: unmanaged C?;
+}
+
+var viaGlobal: unmanaged C?;
+var viaRecursion: unmanaged C?;
+
+// Overwrite the stack where earlier frames' instances would have lived.
+proc clobber(n: int): int {
+  var a: 64*int;
+  for i in 0..<64 do a[i] = n;
+  var s = 0;
+  for i in 0..<64 do s += a[i];
+  return s;
+}
+
+// doesn't escape: used and deleted here
+proc sumLocal(n: int): int {
+  var c = new unmanaged C(n);
+  var s = 0;
+  for i in 1..c.x do s += i;
+  delete c;
+  return s;
+}
+
+// doesn't escape: only read by a recursive callee
+proc depthSum(c: unmanaged C, n: int): int {
+  if n == 0 then return c.x;
+  return c.x + depthSum(c, n - 1);
+}
+
+proc recursiveLocal(n: int): int {
+  var c = new unmanaged C(n);
+  const s = depthSum(c, 3);
+  delete c;
+  return s;
+}
+
+// escapes through the initializer's 'this'
+proc makeRegistered(n: int) {
+  var r = new unmanaged Registered(n);
+}
+
+proc makeInField(h: Holder, n: int) {
+  var c = new unmanaged C(n);
+  h.c = c;
+}
+
+proc makeInGlobal(n: int) {
+  var c = new unmanaged C(n);
+  viaGlobal = c;
+}
+
+proc makeReturned(n: int) {
+  var c = new unmanaged C(n);
+  return c;
+}
+
+// 'ping' stores its argument; 'pong' only reaches that through 'ping'
+proc ping(c: unmanaged C, n: int) {
+  if n > 0 then pong(c, n - 1);
+  else viaRecursion = c;
+}
+
+proc pong(c: unmanaged C, n: int) {
+  ping(c, n);
+}
+
+proc makeViaPing(n: int) {
+  var c = new unmanaged C(n);
+  ping(c, 2);
+}
+
+proc makeViaPong(n: int) {
+  var c = new unmanaged C(n);
+  pong(c, 2);
+}
+
+writeln(sumLocal(10));
+writeln(recursiveLocal(5));
+
+makeRegistered(1);
+writeln(clobber(7));
+writeln(registry!.x);
+
+var h = new Holder();
+makeInField(h, 2);
+writeln(clobber(7));
+writeln(h.c!.x);
+
+makeInGlobal(3);
+writeln(clobber(7));
+writeln(viaGlobal!.x);
+
+const ret = makeReturned(4);
+writeln(clobber(7));
+writeln(ret.x);
+
+makeViaPing(5);
+var first = viaRecursion;
+writeln(clobber(7));
+writeln(first!.x);
+
+makeViaPong(6);
+writeln(clobber(7));
+writeln(viaRecursion!.x);
+writeln(first!.x);
+
+delete registry, h.c, viaGlobal, ret, first, viaRecursion;
@@ -0,0 +1,36 @@
+// Channels that only their creating task uses are created without locks;
+// the others keep them. The results must be the same either way.
+use IO;
+
+const path = "taskPrivate.txt";
+
+proc writeNumbers(n: int) throws {
+  var f = open(path, ioMode.cw);
+  var w = f.writer();           // task-private
+  for i in 1..n do w.writeln(i);
+  w.close();
+  f.close();
+}
+
+proc sumNumbers(): int throws {
+  var r = openReader(path);     // task-private
+  var sum, x = 0;
+  while r.read(x) do sum += x;
+  r.close();
+  return sum;
+}
+
+proc sumShared(): int throws {
+  var r = openReader(path);     // read by several tasks
+  var sum: sync int = 0;
+  coforall i in 1..4 with (ref r) {
+    var x: int;
+    while r.read(x) do sum.writeEF(sum.readFE() + x);
+  }
+  r.close();
+  return sum.readFE();
+}
+
+writeNumbers(1000);
+writeln(sumNumbers());
+writeln(sumShared());
@@ -0,0 +1,28 @@
+// Zippered loops whose iterators walk the same indices share one
+// induction variable; ones that don't must keep their own.
+
+var A, B, C: [1..10] int;
+for i in 1..10 {
+  A[i] = i;
+  B[i] = 10 * i;
+}
+
+// the same domain: the counters can be merged
+for (a, b, c) in zip(A, B, C) do
+  c = a + b;
+writeln(C);
+
+// the same length but different starts: they can't
+for (c, i) in zip(C, 3..12) do
+  c = i;
+writeln(C);
+
+// the same start but different strides: they can't either
+for (c, i) in zip(C, 1..20 by 2) do
+  c = i;
+writeln(C);
+
+// a slice of the same array starting elsewhere
+for (a, b) in zip(A[1..5], B[6..10]) do
+  a = b;
+writeln(A);
@@ -0,0 +1,5 @@
+// The followers start and step like the leader, but this one ends
+// sooner, so its length check must not be dropped.
+for (i, j) in zip(1..8, 1..5) {
+  writeln("i is: ", i, " j is: ", j);
+}
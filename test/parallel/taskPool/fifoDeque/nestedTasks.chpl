@@ -0,0 +1,26 @@
+// Exercise the work-stealing deque task pool in tasks=fifo: tasks
+// created by worker threads go onto their own deques and have to be
+// stolen by the others.
+
+config const n = 16, depth = 12;
+
+proc fib(i: int): int {
+  if i < 2 then return i;
+  var a, b: int;
+  sync {
+    begin with (ref a) a = fib(i-1);
+    b = fib(i-2);
+  }
+  return a + b;
+}
+
+var inner: atomic int;
+coforall i in 1..n do
+  coforall j in 1..n do
+    inner.add(1);
+writeln(inner.read() == n * n);
+
+var total: atomic int;
+coforall i in 1..n do
+  total.add(fib(depth));
+writeln(total.read() == n * 144);
@@ -0,0 +1,25 @@
+// Shrink and regrow the number of active qthreads workers at run time,
+// making sure tasks keep running while workers are parked.
+
+extern proc chpl_task_getMaxPar(): uint(32);
+extern proc chpl_task_setMaxPar(maxPar: uint(32)): uint(32);
+
+config const n = 64;
+
+proc work() {
+  var total: atomic int;
+  coforall i in 1..n do
+    total.add(i);
+  return total.read() == n * (n + 1) / 2;
+}
+
+const startPar = chpl_task_getMaxPar();
+
+writeln(chpl_task_setMaxPar(1) == 1);
+writeln(chpl_task_getMaxPar() == 1);
+writeln(work());
+
+writeln(chpl_task_setMaxPar(0) == 1);
+writeln(chpl_task_setMaxPar(startPar + 100) == startPar);
+writeln(chpl_task_getMaxPar() == startPar);
+writeln(work());
@@ -0,0 +1,19 @@
+// Shared helper for the kernels in this directory: prints the comm
+// operation counts summed over all locales, so that a change in how many
+// gets, puts, AMOs or on-statements a kernel needs shows up in the perf
+// data next to its timing.
+use CommDiagnostics;
+
+proc printCommCounts(name: string) {
+  var gets, puts, amos, ons: int;
+  for d in getCommDiagnostics() {
+    gets += (d.get + d.get_nb): int;
+    puts += (d.put + d.put_nb): int;
+    amos += d.amo: int;
+    ons += (d.execute_on + d.execute_on_fast + d.execute_on_nb): int;
+  }
+  writeln(name, " gets (count): ", gets);
+  writeln(name, " puts (count): ", puts);
+  writeln(name, " amos (count): ", amos);
+  writeln(name, " ons (count): ", ons);
+}
@@ -0,0 +1,43 @@
+// Random access (RA) updates to a Block-distributed table.  Every update
+// is a remote read-modify-write on most locales, which makes this kernel
+// sensitive to changes in comm layer latency and, with --cache-remote, to
+// the remote cache's write-back behavior.
+use BlockDist, Random, Time, commCounts;
+
+config param printStats = false;
+config const n = 1 << 16;
+config const numUpdates = 1 << 16;
+config const seed = 314159265;
+
+const TableSpace = blockDist.createDomain({0..#n});
+var T: [TableSpace] int;
+
+const UpdateSpace = blockDist.createDomain({0..#numUpdates});
+var Idx: [UpdateSpace] int;
+fillRandom(Idx, seed);
+forall i in Idx do i = mod(i, n);
+
+resetCommDiagnostics();
+startCommDiagnostics();
+var t: stopwatch;
+t.start();
+forall i in Idx with (ref T) do
+  T[i] ^= i;
+t.stop();
+stopCommDiagnostics();
+
+// applying the same updates again restores the table, except where
+// racing updates to the same entry were lost; RA tolerates that for up
+// to 1% of the updates
+forall i in Idx with (ref T) do
+  T[i] ^= i;
+
+const errors = + reduce (T != 0);
+writeln("Validation: ",
+        if errors <= numUpdates / 100 then "SUCCESS" else "FAILURE");
+
+if printStats {
+  writeln("updates time (sec): ", t.elapsed());
+  writeln("updates rate (GUP/s): ", numUpdates / t.elapsed() / 1e9);
+  printCommCounts("updates");
+}
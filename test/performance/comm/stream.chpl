@@ -0,0 +1,38 @@
+// STREAM triad over Block-distributed arrays.  The triad is purely local,
+// so the comm counts should stay at the few forks the forall needs.
+use BlockDist, Time, commCounts;
+
+config param printStats = false;
+config const m = 1 << 20;
+config const alpha = 3.0;
+config const numTrials = 5;
+
+const D = blockDist.createDomain({1..m});
+var A, B, C: [D] real;
+
+forall (b, c, i) in zip(B, C, D) {
+  b = i: real;
+  c = 2 * i: real;
+}
+
+var best = max(real);
+resetCommDiagnostics();
+startCommDiagnostics();
+for 1..numTrials {
+  var t: stopwatch;
+  t.start();
+  forall (a, b, c) in zip(A, B, C) do
+    a = b + alpha * c;
+  t.stop();
+  best = min(best, t.elapsed());
+}
+stopCommDiagnostics();
+
+const ok = && reduce [(a, i) in zip(A, D)] a == i + alpha * (2 * i);
+writeln("Validation: ", if ok then "SUCCESS" else "FAILURE");
+
+if printStats {
+  writeln("triad time (sec): ", best);
+  writeln("triad bandwidth (GB/s): ", 3 * numBytes(real) * m / best / 1e9);
+  printCommCounts("triad");
+}
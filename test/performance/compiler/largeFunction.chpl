@@ -0,0 +1,8 @@
+// Compile-time benchmark for very long functions, like those from code
+// generators.  largeFunction.precomp writes LargeFunctionGen.chpl, whose
+// bigFunction() declares and uses 'n' variables in one block.  Track the
+// per-pass compile times with 'start_test -compperformance'.
+use LargeFunctionGen;
+
+const n = numVars;
+writeln(bigFunction() == n * (n + 1) / 2);
@@ -0,0 +1,11 @@
+// Compile-time benchmark for programs with many symbols, which fill the
+// compiler's hashed sets and maps.  manySymbols.precomp writes
+// ManySymbolsGen.chpl, with 'n' globals and functions that each have a
+// local named 'x', and many overloads of one name that only a where
+// clause tells apart.  Same-named symbols must stay distinct however
+// full the tables get.
+use ManySymbolsGen;
+
+const n = numSyms;
+writeln(sumAll() == n * (n + 1) / 2);
+writeln(pick(1), " ", pick(77), " ", pick(200));
@@ -0,0 +1,17 @@
+#include <time.h>
+#include "stringLiterals.h"
+
+static struct timespec loadTime;
+
+// Runs when the executable is loaded, before any Chapel initialization.
+__attribute__((constructor))
+static void recordLoadTime(void) {
+  clock_gettime(CLOCK_MONOTONIC, &loadTime);
+}
+
+double secondsSinceLoad(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (double)(now.tv_sec - loadTime.tv_sec) +
+         (double)(now.tv_nsec - loadTime.tv_nsec) * 1.0e-9;
+}
@@ -0,0 +1,23 @@
+// How long it takes to get to main() in a program with a large table of
+// string literals, all of which are initialized at startup.
+
+extern proc secondsSinceLoad(): real;
+
+config param numLiterals = 1024;
+config const printTiming = false;
+
+proc literal(param i: int) param do return "literal number " + i:string;
+
+proc main {
+  const t = secondsSinceLoad();
+
+  var size, expected = 0;
+  for param i in 1..numLiterals do
+    size += literal(i).size;
+  for i in 1..numLiterals do
+    expected += "literal number ".size + (i:string).size;
+  writeln("literals ok: ", size == expected);
+
+  if printTiming then
+    writeln("startup time: ", t);
+}
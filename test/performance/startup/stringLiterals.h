@@ -0,0 +1 @@
+double secondsSinceLoad(void);
@@ -0,0 +1,34 @@
+// Rate of remote atomic operations on an int owned by the last locale.
+use Time;
+
+config param printTimes = false;
+config const iters = 100000;
+
+on Locales[numLocales-1] {
+  var a: atomic int;
+  var t: stopwatch;
+
+  on Locales[0] {
+    t.start();
+    for 1..iters do a.add(1);
+    t.stop();
+    if printTimes then
+      writeln("add rate (ops/sec): ", iters / t.elapsed());
+
+    t.clear();
+    t.start();
+    for 1..iters do a.fetchAdd(1);
+    t.stop();
+    if printTimes then
+      writeln("fetchAdd rate (ops/sec): ", iters / t.elapsed());
+
+    t.clear();
+    t.start();
+    for i in 1..iters do a.compareExchange(2*iters + i - 1, 2*iters + i);
+    t.stop();
+    if printTimes then
+      writeln("compareExchange rate (ops/sec): ", iters / t.elapsed());
+  }
+
+  writeln("final value verified: ", a.read() == 3*iters);
+}
@@ -0,0 +1,60 @@
+// Latency and bandwidth of blocking chpl_comm_get() and chpl_comm_put()
+// by transfer size, from locale 0 to the last locale.
+use CTypes, Time;
+
+extern proc chpl_comm_get(addr: c_ptr(void), node: int(32),
+                          raddr: c_ptr(void), size: c_size_t,
+                          commID: int(32), ln: c_int, fn: int(32));
+extern proc chpl_comm_put(addr: c_ptr(void), node: int(32),
+                          raddr: c_ptr(void), size: c_size_t,
+                          commID: int(32), ln: c_int, fn: int(32));
+
+config param printTimes = false;
+config const maxSize = 2 * 1024 * 1024;
+config const maxIters = 10000;
+config const bytesPerSize = 256 * 1024 * 1024;
+
+const node = Locales[numLocales-1].id: int(32);
+var rbuf: c_ptr(uint(8));
+on Locales[numLocales-1] do rbuf = allocate(uint(8), maxSize: c_size_t);
+var lbuf = allocate(uint(8), maxSize: c_size_t);
+
+for i in 0..#maxSize do lbuf[i] = (i % 251): uint(8);
+chpl_comm_put(lbuf, node, rbuf, maxSize: c_size_t, -1, 0, 0);
+for i in 0..#maxSize do lbuf[i] = 0;
+chpl_comm_get(lbuf, node, rbuf, maxSize: c_size_t, -1, 0, 0);
+var ok = true;
+for i in 0..#maxSize do ok &&= lbuf[i] == (i % 251): uint(8);
+writeln("data verified: ", ok);
+
+proc report(op: string, size: int, iters: int, secs: real) {
+  if printTimes {
+    writeln(op, " ", size, " latency (usec): ", secs / iters * 1e6);
+    writeln(op, " ", size, " bandwidth (MB/s): ",
+            size * iters / secs / 1e6);
+  }
+}
+
+var size = 8;
+while size <= maxSize {
+  const iters = max(10, min(maxIters, bytesPerSize / size));
+  var t: stopwatch;
+
+  t.start();
+  for 1..iters do
+    chpl_comm_get(lbuf, node, rbuf, size: c_size_t, -1, 0, 0);
+  t.stop();
+  report("get", size, iters, t.elapsed());
+
+  t.clear();
+  t.start();
+  for 1..iters do
+    chpl_comm_put(lbuf, node, rbuf, size: c_size_t, -1, 0, 0);
+  t.stop();
+  report("put", size, iters, t.elapsed());
+
+  size *= 8;
+}
+
+on Locales[numLocales-1] do deallocate(rbuf);
+deallocate(lbuf);
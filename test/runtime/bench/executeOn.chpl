@@ -0,0 +1,34 @@
+// Round trip time of remote executeOn: an empty on-body is eligible for
+// the fast (run in the handler) path, one that may block is not.
+use Time;
+
+extern proc chpl_task_yield();
+
+config param printTimes = false;
+config const iters = 10000;
+
+const target = Locales[numLocales-1];
+var count = 0;
+var t: stopwatch;
+
+t.start();
+for 1..iters do on target { }
+t.stop();
+if printTimes then
+  writeln("executeOn fast round trip (usec): ", t.elapsed() / iters * 1e6);
+
+t.clear();
+t.start();
+for 1..iters do on target { chpl_task_yield(); }
+t.stop();
+if printTimes then
+  writeln("executeOn round trip (usec): ", t.elapsed() / iters * 1e6);
+
+t.clear();
+t.start();
+for 1..iters do on target do count += 1;
+t.stop();
+if printTimes then
+  writeln("executeOn with write back (usec): ", t.elapsed() / iters * 1e6);
+
+writeln("count verified: ", count == iters);
@@ -0,0 +1,39 @@
+// Throughput of binary writes and reads through qio channels, to an
+// in-memory file and to a temporary file on disk.
+use IO, Time;
+
+config param printTimes = false;
+config const n = 16 * 1024 * 1024;
+
+proc bench(f: file, kind: string) {
+  var t: stopwatch;
+
+  t.start();
+  {
+    var w = f.writer(locking=false);
+    for i in 0..#n do w.writeBinary(i);
+    w.close();
+  }
+  t.stop();
+  if printTimes then
+    writeln(kind, " write throughput (MB/s): ",
+            n * numBytes(int) / t.elapsed() / 1e6);
+
+  var sum = 0, x: int;
+  t.clear();
+  t.start();
+  {
+    var r = f.reader(locking=false);
+    while r.readBinary(x) do sum += x;
+    r.close();
+  }
+  t.stop();
+  if printTimes then
+    writeln(kind, " read throughput (MB/s): ",
+            n * numBytes(int) / t.elapsed() / 1e6);
+
+  writeln(kind, " data verified: ", sum == n * (n - 1) / 2);
+}
+
+bench(openMemFile(), "memory");
+bench(openTempFile(), "disk");
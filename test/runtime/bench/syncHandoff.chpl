@@ -0,0 +1,24 @@
+// Latency of handing a value back and forth between two tasks through
+// sync variables, which measures task wake-up through the tasking layer.
+use Time;
+
+config param printTimes = false;
+config const iters = 100000;
+
+var ping, pong: sync int;
+var last: int;
+var t: stopwatch;
+
+t.start();
+cobegin {
+  for i in 1..iters {
+    ping.writeEF(i);
+    last = pong.readFE();
+  }
+  for 1..iters do pong.writeEF(ping.readFE());
+}
+t.stop();
+if printTimes then
+  writeln("sync handoff latency (usec): ", t.elapsed() / (2*iters) * 1e6);
+
+writeln("last value verified: ", last == iters);
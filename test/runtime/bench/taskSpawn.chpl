@@ -0,0 +1,30 @@
+// Rate of task creation through begin, coforall and cobegin.
+use Time;
+
+config param printTimes = false;
+config const iters = 100000;
+
+var count: atomic int;
+var t: stopwatch;
+
+t.start();
+sync for 1..iters do begin count.add(1);
+t.stop();
+if printTimes then
+  writeln("begin spawn rate (tasks/sec): ", iters / t.elapsed());
+
+t.clear();
+t.start();
+coforall 1..iters do count.add(1);
+t.stop();
+if printTimes then
+  writeln("coforall spawn rate (tasks/sec): ", iters / t.elapsed());
+
+t.clear();
+t.start();
+for 1..iters/2 do cobegin { count.add(1); count.add(1); }
+t.stop();
+if printTimes then
+  writeln("cobegin spawn rate (tasks/sec): ", 2*(iters/2) / t.elapsed());
+
+writeln("count verified: ", count.read() == 2*iters + 2*(iters/2));
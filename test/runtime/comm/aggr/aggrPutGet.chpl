@@ -0,0 +1,53 @@
+// Exercise the runtime's aggregated PUT/GET interface with both
+// contiguous (mergeable) and scattered access patterns.
+use CTypes;
+
+extern proc chpl_comm_aggr_put(addr: c_ptr(void), node: int(32),
+                               raddr: c_ptr(void), size: c_size_t,
+                               commID: int(32), ln: c_int, fn: int(32));
+extern proc chpl_comm_aggr_get(addr: c_ptr(void), node: int(32),
+                               raddr: c_ptr(void), size: c_size_t,
+                               commID: int(32), ln: c_int, fn: int(32));
+extern proc chpl_comm_aggr_flush();
+
+config const n = 10000;
+
+class Data {
+  var A: [0..#n] int;
+}
+
+var d: unmanaged Data?;
+var base: c_uintptr;
+on Locales[numLocales-1] {
+  d = new unmanaged Data();
+  base = c_ptrTo(d!.A[0]): c_uintptr;
+}
+const node = Locales[numLocales-1].id: int(32);
+
+proc remoteAddr(i: int) {
+  return (base + (i * numBytes(int)): c_uintptr): c_ptr(void);
+}
+
+// contiguous PUTs, then every third element overwritten out of order
+for i in 0..#n {
+  var x = i;
+  chpl_comm_aggr_put(c_ptrTo(x), node, remoteAddr(i), numBytes(int),
+                     -1, 0, 0);
+}
+for i in 0..#n by -3 {
+  var x = -i;
+  chpl_comm_aggr_put(c_ptrTo(x), node, remoteAddr(i), numBytes(int),
+                     -1, 0, 0);
+}
+chpl_comm_aggr_flush();
+writeln("put: ", + reduce d!.A);
+
+// GETs into a local array, in reverse order
+var B: [0..#n] int;
+for i in 0..#n by -1 do
+  chpl_comm_aggr_get(c_ptrTo(B[i]), node, remoteAddr(i), numBytes(int),
+                     -1, 0, 0);
+chpl_comm_aggr_flush();
+writeln("get: ", && reduce (B == d!.A));
+
+delete d;
@@ -0,0 +1,43 @@
+// Exercise strided bulk PUTs and GETs of 2D and 3D halo-like slices
+// between locales, including chunks that are contiguous on one side
+// only and chunks that merge because they are contiguous on both.
+config const n = 24;
+
+var A2: [1..n, 1..n] int;
+var A3: [1..n, 1..n, 1..n] int;
+forall (i, j) in A2.domain do A2[i, j] = i * 1000 + j;
+forall (i, j, k) in A3.domain do A3[i, j, k] = (i * 100 + j) * 100 + k;
+
+on Locales[numLocales-1] {
+  var B2: [1..n, 1..n] int;
+  var B3: [1..n, 1..n, 1..n] int;
+
+  // GETs: a column halo (one element per row), and a 2-deep
+  // face of a 3D block
+  B2[1..n, 2..3] = A2[1..n, 2..3];
+  B3[2..n-1, 2..n-1, 1..2] = A3[2..n-1, 2..n-1, 1..2];
+  // a strided slice, and whole rows that merge into one run
+  B2[1..n by 3, 1..n by 2] = A2[1..n by 3, 1..n by 2];
+  B3[3..5, 1..n, 1..n] = A3[3..5, 1..n, 1..n];
+
+  writeln("get2: ", && reduce [(i, j) in {1..n, 2..3}]
+                               (B2[i, j] == A2[i, j]));
+  writeln("get3: ", && reduce [(i, j, k) in {2..n-1, 2..n-1, 1..2}]
+                               (B3[i, j, k] == A3[i, j, k]));
+  writeln("getStrided: ", && reduce [(i, j) in {1..n by 3, 1..n by 2}]
+                                     (B2[i, j] == A2[i, j]));
+  writeln("getRows: ", && reduce [(i, j, k) in {3..5, 1..n, 1..n}]
+                                  (B3[i, j, k] == A3[i, j, k]));
+
+  // PUTs: negate the locals and send the same regions back
+  B2 = -B2;
+  B3 = -B3;
+  A2[1..n, n-1..n] = B2[1..n, 2..3];
+  A3[2..n-1, 2..n-1, n-1..n] = B3[2..n-1, 2..n-1, 1..2];
+}
+
+writeln("put2: ", && reduce [(i, j) in {1..n, n-1..n}]
+                             (A2[i, j] == -(i * 1000 + j - n + 3)));
+writeln("put3: ", && reduce [(i, j, k) in {2..n-1, 2..n-1, n-1..n}]
+                             (A3[i, j, k] == -((i * 100 + j) * 100
+                                               + k - n + 2)));
@@ -0,0 +1,18 @@
+// Allocate, fill, and check a large array from a jemalloc heap that the
+// runtime maps itself with transparent huge pages, interleaved across
+// NUMA domains.
+
+config const n = 1 << 24;
+
+var A: [0..#n] int;
+forall i in A.domain do
+  A[i] = i;
+writeln(+ reduce A == n * (n - 1) / 2);
+
+{
+  var B: [0..#n] real = 1.0;
+  writeln(+ reduce B == n: real);
+}
+
+var C: [0..#n] int;
+writeln(+ reduce C == 0);
@@ -394,7 +394,11 @@ enum introspective_state {
     CURRENT_WORKER,
     CURRENT_UNIQUE_WORKER,
     CURRENT_TEAM,
-    PARENT_TEAM
+    PARENT_TEAM,
+    STEALS_LOCAL,
+    STEALS_REMOTE,
+    STACK_POOL_HITS,
+    STACK_POOL_MISSES
 };
 size_t qthread_readstate(const enum introspective_state type);
 
@@ -106,6 +106,16 @@ typedef struct qlib_s {
     aligned_t             sched_shepherd;
     QTHREAD_FASTLOCK_TYPE sched_shepherd_lock;
 
+    /* tasks stolen from shepherds in the same/a different steal domain;
+     * maintained by schedulers that steal */
+    aligned_t             steals_local;
+    aligned_t             steals_remote;
+
+    /* guarded stacks reused from (hits) or not found in (misses) the
+     * stack cache */
+    aligned_t             stack_pool_hits;
+    aligned_t             stack_pool_misses;
+
 #if defined(QTHREAD_MUTEX_INCREMENT) ||             \
     (QTHREAD_ASSEMBLY_ARCH == QTHREAD_POWERPC32) || \
     (QTHREAD_ASSEMBLY_ARCH == QTHREAD_SPARCV9_32)
@@ -23,6 +23,7 @@
 # define memmove(d, s, n) bcopy((s), (d), (n))
 #endif
 #include <sys/time.h>
+#include <time.h>                /* for nanosleep() */
 #include <sys/resource.h>
 #include <pthread.h>
 #ifdef HAVE_SCHED_H
@@ -226,10 +227,76 @@ static QINLINE void FREE_STACK(void *t)
 #else /* if defined(UNPOOLED_STACKS) || defined(UNPOOLED) */
 static qt_mpool generic_stack_pool = NULL;
 # ifdef QTHREAD_GUARD_PAGES
+/* Stacks whose guard pages are already protected.  Handing these back out
+ * skips the two mprotect() calls (and the TLB shootdowns they cause) that a
+ * trip through generic_stack_pool would need.  Each cached stack is linked
+ * through the first word of its runtime-data area, which lives above the
+ * upper guard page and is rewritten by alloc_rdata() on reuse anyway. */
+static QTHREAD_FASTLOCK_TYPE guarded_stack_lock;
+static void                 *guarded_stacks     = NULL;
+static size_t                guarded_stack_cnt  = 0;
+static size_t                guarded_stack_max  = 0;
+static int                   guarded_stack_free = 1;
+
+#  define GUARDED_STACK_LINK(base) \
+    (*(void **)((uint8_t *)(base) + qlib->qthread_stack_size + (2 * getpagesize())))
+
+static void guarded_stack_cache_init(void)
+{                      /*{{{ */
+    QTHREAD_FASTLOCK_INIT(guarded_stack_lock);
+    guarded_stacks     = NULL;
+    guarded_stack_cnt  = 0;
+    guarded_stack_max  = qt_internal_get_env_num("STACK_CACHE_SIZE", 1024, 0);
+    guarded_stack_free = qt_internal_get_env_bool("STACK_CACHE_RELEASE", 1);
+}                      /*}}} */
+
+static QINLINE void guarded_stack_unprotect(uint8_t *base)
+{                      /*{{{ */
+    if (mprotect(base, getpagesize(), PROT_READ | PROT_WRITE) != 0) {
+        perror("mprotect in FREE_STACK (1)");
+    }
+    if (mprotect(base + qlib->qthread_stack_size + getpagesize(),
+                getpagesize(),
+                PROT_READ | PROT_WRITE) != 0) {
+        perror("mprotect in FREE_STACK (2)");
+    }
+}                      /*}}} */
+
+static void guarded_stack_cache_drain(void)
+{                      /*{{{ */
+    void *base;
+
+    QTHREAD_FASTLOCK_LOCK(&guarded_stack_lock);
+    while ((base = guarded_stacks) != NULL) {
+        guarded_stacks = GUARDED_STACK_LINK(base);
+        guarded_stack_unprotect(base);
+        qt_mpool_free(generic_stack_pool, base);
+    }
+    guarded_stack_cnt = 0;
+    QTHREAD_FASTLOCK_UNLOCK(&guarded_stack_lock);
+    QTHREAD_FASTLOCK_DESTROY(guarded_stack_lock);
+}                      /*}}} */
+
 static QINLINE void *ALLOC_STACK(void)
 {                      /*{{{ */
     if (GUARD_PAGES) {
-        uint8_t *tmp = qt_mpool_alloc(generic_stack_pool);
+        uint8_t *tmp = NULL;
+
+        if (guarded_stacks != NULL) {
+            QTHREAD_FASTLOCK_LOCK(&guarded_stack_lock);
+            if ((tmp = guarded_stacks) != NULL) {
+                guarded_stacks = GUARDED_STACK_LINK(tmp);
+                guarded_stack_cnt--;
+            }
+            QTHREAD_FASTLOCK_UNLOCK(&guarded_stack_lock);
+        }
+        if (tmp != NULL) {
+            qthread_incr(&qlib->stack_pool_hits, 1);
+            return tmp + getpagesize();
+        }
+        qthread_incr(&qlib->stack_pool_misses, 1);
+
+        tmp = qt_mpool_alloc(generic_stack_pool);
 
         assert(tmp);
         if (tmp == NULL) {
@@ -253,15 +320,30 @@ static QINLINE void FREE_STACK(void *t)
 {                      /*{{{ */
     if (GUARD_PAGES) {
         assert(t);
-        t = (uint8_t*)t - getpagesize();
-        if (mprotect(t, getpagesize(), PROT_READ | PROT_WRITE) != 0) {
-            perror("mprotect in FREE_STACK (1)");
+        if (guarded_stack_free) {
+            /* Let the kernel reclaim the stack's pages lazily; they are
+             * recommitted (zero-filled, if reclaimed) on the next touch. */
+#  if defined(MADV_FREE)
+            madvise(t, qlib->qthread_stack_size, MADV_FREE);
+#  elif defined(MADV_DONTNEED)
+            madvise(t, qlib->qthread_stack_size, MADV_DONTNEED);
+#  endif
         }
-        if (mprotect(((uint8_t*)t) + qlib->qthread_stack_size + getpagesize(),
-                    getpagesize(),
-                    PROT_READ | PROT_WRITE) != 0) {
-            perror("mprotect in FREE_STACK (2)");
+        t = (uint8_t*)t - getpagesize();
+        if (guarded_stack_cnt < guarded_stack_max) {
+            QTHREAD_FASTLOCK_LOCK(&guarded_stack_lock);
+            if (guarded_stack_cnt < guarded_stack_max) {
+                GUARDED_STACK_LINK(t) = guarded_stacks;
+                guarded_stacks        = t;
+                guarded_stack_cnt++;
+                t = NULL;
+            }
+            QTHREAD_FASTLOCK_UNLOCK(&guarded_stack_lock);
+            if (t == NULL) {
+                return;
+            }
         }
+        guarded_stack_unprotect(t);
     }
     qt_mpool_free(generic_stack_pool, t);
 }                      /*}}} */
@@ -375,6 +457,40 @@ static QINLINE void alloc_rdata(qthread_shepherd_t *me,
 } /*}}}*/
 
 
+/* Park a worker that has been disabled (see qthread_disable_worker()) until
+ * it is enabled again.  A parked worker spins briefly, in case it is quickly
+ * re-enabled, and then sleeps with a growing back-off so that its core is
+ * actually handed back to the OS.  A disabled shepherd can still have tasks
+ * in its queue, either left over from before it was disabled or aimed at it
+ * explicitly; while that is the case its worker returns early so the caller
+ * can forward those tasks to an active shepherd instead of stranding them. */
+#define PARK_SPINS         1000
+#define PARK_MAX_SLEEP_NS  1000000
+
+static void qthread_worker_park(qthread_shepherd_t *me,
+                                qthread_worker_t   *me_worker,
+                                qt_threadqueue_t   *threadqueue)
+{   /*{{{*/
+    unsigned long   spins    = 0;
+    struct timespec sleep_ts = { 0, 1000 };
+
+    while (!QTHREAD_CASLOCK_READ_UI(me_worker->active)) {
+        if (!QTHREAD_CASLOCK_READ_UI(me->active) &&
+            (qt_threadqueue_advisory_queuelen(threadqueue) > 0)) {
+            return;
+        }
+        if (spins < PARK_SPINS) {
+            SPINLOCK_BODY();
+            spins++;
+        } else {
+            nanosleep(&sleep_ts, NULL);
+            if (sleep_ts.tv_nsec < PARK_MAX_SLEEP_NS) {
+                sleep_ts.tv_nsec *= 2;
+            }
+        }
+    }
+} /*}}}*/
+
 /* the qthread_master() function is the loop responsible for actually
  * executing the work units
  *
@@ -468,8 +584,8 @@ static void *qthread_master(void *arg)
 #endif
         qthread_debug(SHEPHERD_DETAILS, "id(%i): fetching a thread from my queue...\n", my_id);
 
-        while (!QTHREAD_CASLOCK_READ_UI(me_worker->active)) {
-            SPINLOCK_BODY();
+        if (!QTHREAD_CASLOCK_READ_UI(me_worker->active)) {
+            qthread_worker_park(me, me_worker, threadqueue);
         }
 #ifdef QTHREAD_LOCAL_PRIORITY
         t = qt_scheduler_get_thread(threadqueue, localpriorityqueue, localqueue, QTHREAD_CASLOCK_READ_UI(me->active));
@@ -912,6 +1028,10 @@ int API_FUNC qthread_initialize(void)
     qlib->max_thread_id  = 1;
     qlib->max_unique_id  = 1;
     qlib->sched_shepherd = 0;
+    qlib->steals_local   = 0;
+    qlib->steals_remote  = 0;
+    qlib->stack_pool_hits   = 0;
+    qlib->stack_pool_misses = 0;
     QTHREAD_FASTLOCK_INIT(qlib->max_thread_id_lock);
     QTHREAD_FASTLOCK_INIT(qlib->max_unique_id_lock);
     QTHREAD_FASTLOCK_INIT(qlib->sched_shepherd_lock);
@@ -977,6 +1097,9 @@ int API_FUNC qthread_initialize(void)
         generic_stack_pool = qt_mpool_create_aligned(qlib->qthread_stack_size + sizeof(struct qthread_runtime_data_s), QTHREAD_STACK_ALIGNMENT);     // stacks on most platforms must be 16-byte aligned (or less)
     }
     generic_rdata_pool = qt_mpool_create(sizeof(struct qthread_runtime_data_s));
+# ifdef QTHREAD_GUARD_PAGES
+    guarded_stack_cache_init();
+# endif
 #endif /* ifndef UNPOOLED */
     initialize_hazardptrs();
     qt_internal_teams_init();
@@ -1677,6 +1800,9 @@ void API_FUNC qthread_finalize(void)
     generic_qthread_pool = NULL;
     qt_mpool_destroy(generic_big_qthread_pool);
     generic_big_qthread_pool = NULL;
+# ifdef QTHREAD_GUARD_PAGES
+    guarded_stack_cache_drain();
+# endif
     qt_mpool_destroy(generic_stack_pool);
     generic_stack_pool = NULL;
     qt_mpool_destroy(generic_rdata_pool);
@@ -1876,6 +2002,18 @@ size_t API_FUNC qthread_readstate(const enum introspective_state type)
         case TOTAL_WORKERS:
             return (size_t)(qlib->nworkerspershep * qlib->nshepherds);
 
+        case STEALS_LOCAL:
+            return (size_t)(qlib->steals_local);
+
+        case STEALS_REMOTE:
+            return (size_t)(qlib->steals_remote);
+
+        case STACK_POOL_HITS:
+            return (size_t)(qlib->stack_pool_hits);
+
+        case STACK_POOL_MISSES:
+            return (size_t)(qlib->stack_pool_misses);
+
         case CURRENT_SHEPHERD:
             return qthread_shep();
 
@@ -2469,6 +2607,13 @@ int API_FUNC qthread_spawn(qthread_f             f,
         dest_shep = target_shep % qlib->nshepherds;
     } else {
         dest_shep = qt_threadqueue_choose_dest(myshep);
+        if (qlib->nshepherds_active < qlib->nshepherds) {
+            /* don't schedule onto disabled shepherds; shepherd 0 can never
+             * be disabled, so this terminates */
+            while (!QTHREAD_CASLOCK_READ_UI(qlib->shepherds[dest_shep].active)) {
+                dest_shep = (dest_shep + 1) % qlib->nshepherds;
+            }
+        }
 #ifdef QTHREAD_DEBUG
         // debug moved until after destination shepherd is picked for multithreaded shepherds
         // check to make sure destination shepherd is in range (not target_shep which is
@@ -174,8 +174,9 @@ int API_FUNC qthread_disable_shepherd(const qthread_shepherd_id_t shep)
         return QTHREAD_NOT_ALLOWED;
     }
     qthread_debug(SHEPHERD_CALLS, "began on shep(%i)\n", shep);
-    qthread_internal_incr(&(qlib->nshepherds_active), &(qlib->nshepherds_active_lock), -1);
-    (void)QT_CAS(qlib->shepherds[shep].active, 1, 0);
+    if (QT_CAS(qlib->shepherds[shep].active, 1, 0) == (void *)1) {
+        qthread_internal_incr(&(qlib->nshepherds_active), &(qlib->nshepherds_active_lock), -1);
+    }
     return QTHREAD_SUCCESS;
 }                      /*}}} */
 
@@ -184,8 +185,9 @@ void API_FUNC qthread_enable_shepherd(const qthread_shepherd_id_t shep)
     assert(qthread_library_initialized);
     assert(shep < qlib->nshepherds);
     qthread_debug(SHEPHERD_CALLS, "began on shep(%i)\n", shep);
-    qthread_internal_incr(&(qlib->nshepherds_active), &(qlib->nshepherds_active_lock), 1);
-    (void)QT_CAS(qlib->shepherds[shep].active, 0, 1);
+    if (QT_CAS(qlib->shepherds[shep].active, 0, 1) == (void *)0) {
+        qthread_internal_incr(&(qlib->nshepherds_active), &(qlib->nshepherds_active_lock), 1);
+    }
 }                      /*}}} */
 
 /***************************************************************************
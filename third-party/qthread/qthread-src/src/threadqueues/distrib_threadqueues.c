@@ -5,6 +5,7 @@
 /* System Headers */
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/time.h>
 
 /* Public Headers */
@@ -36,6 +37,12 @@ int max_backoff;
 int spinloop_backoff;
 int condwait_backoff;
 int steal_ratio;
+int steal_remote_spins;
+
+/* Steal domain (NUMA node, L3, ...) of each shepherd. Thieves look for
+ * work in their own domain first and only go to other domains once they
+ * have come up empty steal_remote_spins times in a row. */
+static unsigned int *steal_domain = NULL;
 
 /* Data Structures */
 struct _qt_threadqueue_node {
@@ -161,10 +168,35 @@ void INTERNAL qt_threadqueue_free(qt_threadqueue_t *qe){
 static void qt_threadqueue_subsystem_shutdown(){   
   qt_mpool_destroy(generic_threadqueue_pools.nodes);
   qt_mpool_destroy(generic_threadqueue_pools.queues);
+  qt_free(steal_domain);
+  steal_domain = NULL;
 } 
 
+/* QT_STEAL_DOMAINS is a colon-separated list giving the steal domain of
+ * each shepherd in turn. Shepherds it doesn't cover fall back to the
+ * affinity layer's idea of their node. */
+static void init_steal_domains(void){
+  const char *str = qt_internal_get_env_str("STEAL_DOMAINS", NULL);
+  steal_domain = qt_calloc(qlib->nshepherds, sizeof(unsigned int));
+  for (qthread_shepherd_id_t i = 0; i < qlib->nshepherds; i++) {
+    steal_domain[i] = qlib->shepherds[i].node;
+  }
+  if (str != NULL) {
+    qthread_shepherd_id_t i = 0;
+    while (i < qlib->nshepherds && *str != '\0') {
+      char *end;
+      unsigned long dom = strtoul(str, &end, 10);
+      if (end == str) break;
+      steal_domain[i++] = (unsigned int)dom;
+      str = (*end == ':') ? end + 1 : end;
+    }
+  }
+}
+
 void INTERNAL qt_threadqueue_subsystem_init(){   
   steal_ratio = qt_internal_get_env_num("STEAL_RATIO", 8, 0);
+  steal_remote_spins = qt_internal_get_env_num("STEAL_REMOTE_SPINS", 16, 0);
+  init_steal_domains();
   condwait_backoff = qt_internal_get_env_num("CONDWAIT_BACKOFF", 2048, 0);
   finalizing = 0;
   generic_threadqueue_pools.queues = qt_mpool_create_aligned(sizeof(qt_threadqueue_t),
@@ -351,21 +383,34 @@ qthread_t INTERNAL *qt_scheduler_get_thread(qt_threadqueue_t         *qe,
   qt_threadqueue_node_t *node = NULL;
   qthread_t* t;
   qthread_shepherd_t *my_shepherd = qthread_internal_getshep();
+  unsigned int my_domain = steal_domain[my_shepherd->shepherd_id];
+  int failed_steals = 0;
 
   for(int numwaits = 0; !node; numwaits ++){
     node = qt_threadqueue_dequeue_tail(qe);
 
-    // If we've done QT_STEAL_RATIO waits on local queue, try to steal 
+    // If we've done QT_STEAL_RATIO waits on local queue, try to steal.
+    // Victims in our own steal domain come first; the rest are only
+    // tried once local stealing has failed QT_STEAL_REMOTE_SPINS times.
     if(!node && steal_ratio > 0 && numwaits % steal_ratio == 0) {
-      for(int i=0; i < qlib->nshepherds; i++){
-        qt_threadqueue_t *victim_queue = qlib->shepherds[i].ready;
-        node = qt_threadqueue_dequeue_head(victim_queue);
-        if (node){
-          t = node->value;
-          free_tqnode(node);
-          return t;
+      int remote_ok = (failed_steals >= steal_remote_spins);
+      for(int pass = 0; pass < 1 + remote_ok; pass++){
+        for(int i=0; i < qlib->nshepherds; i++){
+          if ((steal_domain[i] == my_domain) != (pass == 0)) continue;
+          qt_threadqueue_t *victim_queue = qlib->shepherds[i].ready;
+          node = qt_threadqueue_dequeue_head(victim_queue);
+          if (node){
+            if (i != my_shepherd->shepherd_id) {
+              qthread_incr(pass == 0 ? &qlib->steals_local
+                                     : &qlib->steals_remote, 1);
+            }
+            t = node->value;
+            free_tqnode(node);
+            return t;
+          }
         }
       }
+      failed_steals++;
     }
 
     if(!node && qthread_worker(NULL) == 0 && mccoy){
@@ -39,8 +39,11 @@ int API_FUNC qthread_disable_worker(const qthread_worker_id_t w)
     }
     qthread_debug(SHEPHERD_CALLS, "began on worker(%i-%i)\n", shep, worker);
 
-    (void)QT_CAS(qlib->shepherds[shep].workers[worker].active, 1, 0);
-    qlib->nworkers_active--; // decrement active count
+    /* only the caller that actually flips the flag adjusts the count, so
+     * disabling an already-disabled worker is harmless */
+    if (QT_CAS(qlib->shepherds[shep].workers[worker].active, 1, 0) == (void *)1) {
+        qthread_internal_incr(&(qlib->nworkers_active), &(qlib->nworkers_active_lock), -1);
+    }
 
     if (worker == 0) { qthread_disable_shepherd(shep); }
 
@@ -59,8 +62,9 @@ void API_FUNC qthread_enable_worker(const qthread_worker_id_t w)
     if (worker == 0) { qthread_enable_shepherd(shep); }
     qthread_debug(SHEPHERD_CALLS, "began on shep(%i)\n", shep);
     if (worker < qlib->nworkerspershep) {
-        qthread_internal_incr(&(qlib->nworkers_active), &(qlib->nworkers_active_lock), 1);
-        (void)QT_CAS(qlib->shepherds[shep].workers[worker].active, 0, 1);
+        if (QT_CAS(qlib->shepherds[shep].workers[worker].active, 0, 1) == (void *)0) {
+            qthread_internal_incr(&(qlib->nworkers_active), &(qlib->nworkers_active_lock), 1);
+        }
     }
 }                      /*}}} */
 
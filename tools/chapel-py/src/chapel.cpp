@@ -27,6 +27,7 @@
 #include <utility>
 
 static PyMethodDef ChapelMethods[] = {
+  { "parse_in_parallel", (PyCFunction) chapel_parse_in_parallel, METH_VARARGS, "Parse the given files on several threads, each with its own Context" },
   { NULL, NULL, 0, NULL } /* Sentinel */
 };
 
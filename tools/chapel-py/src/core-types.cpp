@@ -22,6 +22,9 @@
 #include "chpl/parsing/parsing-queries.h"
 #include "python-types.h"
 #include "error-tracker.h"
+#include "traversal-support.h"
+#include <algorithm>
+#include <thread>
 
 using namespace chpl;
 using namespace uast;
@@ -74,10 +77,17 @@ PyObject* ContextObject_parse(ContextObject *self, PyObject* args) {
     PyErr_BadArgument();
     return nullptr;
   }
+  const uast::BuilderResult* builderResultPtr = nullptr;
+
+  // Parsing does not touch Python objects (the error handler takes the GIL
+  // back if it needs to), so let other threads run with their own Contexts.
+  Py_BEGIN_ALLOW_THREADS
   auto fileNameUS = UniqueString::get(context, fileName);
   auto parentPathUS = UniqueString();
-  auto& builderResult = parsing::parseFileToBuilderResultAndCheck(context, fileNameUS, parentPathUS);
+  builderResultPtr = &parsing::parseFileToBuilderResultAndCheck(context, fileNameUS, parentPathUS);
+  Py_END_ALLOW_THREADS
 
+  auto& builderResult = *builderResultPtr;
   int listSize = builderResult.numTopLevelExpressions();
   PyObject* topExprs = PyList_New(listSize);
   for (auto i = 0; i < listSize; i++) {
@@ -87,6 +97,103 @@ PyObject* ContextObject_parse(ContextObject *self, PyObject* args) {
   return topExprs;
 }
 
+namespace {
+  struct ParsedFile {
+    ContextObject* contextObject = nullptr;
+    const char* fileName = nullptr;
+    const uast::BuilderResult* builderResult = nullptr;
+    PyObject* errors = nullptr;
+  };
+}
+
+static void parseFilesWithContext(ContextObject* contextObject,
+                                  std::vector<ParsedFile>& files,
+                                  size_t start, size_t end) {
+  auto context = &contextObject->context;
+  auto handler = (PythonErrorHandler*) context->errorHandler();
+
+  for (size_t i = start; i < end; i++) {
+    auto& file = files[i];
+
+    // Error lists are Python objects, so only touch them with the GIL.
+    auto gil = PyGILState_Ensure();
+    file.errors = handler->pushList();
+    Py_INCREF(file.errors);
+    PyGILState_Release(gil);
+
+    auto fileNameUS = UniqueString::get(context, file.fileName);
+    file.builderResult = &parsing::parseFileToBuilderResultAndCheck(context, fileNameUS, UniqueString());
+
+    gil = PyGILState_Ensure();
+    handler->popList();
+    PyGILState_Release(gil);
+  }
+}
+
+PyObject* chapel_parse_in_parallel(PyObject* self, PyObject* args) {
+  PyObject* fileNamesPy;
+  int numThreads = 0;
+  if (!PyArg_ParseTuple(args, "O|i", &fileNamesPy, &numThreads)) {
+    return nullptr;
+  }
+
+  auto seq = PySequence_Fast(fileNamesPy, "expected a sequence of file names");
+  if (!seq) return nullptr;
+
+  std::vector<ParsedFile> files(PySequence_Fast_GET_SIZE(seq));
+  for (size_t i = 0; i < files.size(); i++) {
+    files[i].fileName = PyUnicode_AsUTF8(PySequence_Fast_GET_ITEM(seq, i));
+    if (!files[i].fileName) {
+      Py_DECREF(seq);
+      return nullptr;
+    }
+  }
+
+  if (numThreads <= 0) numThreads = std::max(1u, std::thread::hardware_concurrency());
+  size_t numWorkers = std::min(files.size(), (size_t) numThreads);
+
+  // A Context is not thread-safe, so every worker gets its own. They are
+  // created up front because that needs the GIL.
+  std::vector<ContextObject*> contexts;
+  for (size_t w = 0; w < numWorkers; w++) {
+    auto contextObjectPy = PyObject_CallObject((PyObject*) &ContextType, nullptr);
+    if (!contextObjectPy) {
+      for (auto c : contexts) Py_DECREF(c);
+      Py_DECREF(seq);
+      return nullptr;
+    }
+    contexts.push_back((ContextObject*) contextObjectPy);
+  }
+
+  Py_BEGIN_ALLOW_THREADS
+  std::vector<std::thread> workers;
+  for (size_t w = 0; w < numWorkers; w++) {
+    size_t start = files.size() * w / numWorkers;
+    size_t end = files.size() * (w + 1) / numWorkers;
+    for (size_t i = start; i < end; i++) files[i].contextObject = contexts[w];
+    workers.emplace_back(parseFilesWithContext, contexts[w],
+                         std::ref(files), start, end);
+  }
+  for (auto& t : workers) t.join();
+  Py_END_ALLOW_THREADS
+
+  PyObject* results = PyList_New(files.size());
+  for (size_t i = 0; i < files.size(); i++) {
+    auto& file = files[i];
+    auto& br = *file.builderResult;
+    PyObject* topExprs = PyList_New(br.numTopLevelExpressions());
+    for (int j = 0; j < br.numTopLevelExpressions(); j++) {
+      PyList_SetItem(topExprs, j, wrapAstNode(file.contextObject, br.topLevelExpression(j)));
+    }
+    PyList_SetItem(results, i, Py_BuildValue("(NN)", topExprs, file.errors));
+  }
+
+  // The wrapped nodes and errors keep their Context alive.
+  for (auto c : contexts) Py_DECREF(c);
+  Py_DECREF(seq);
+  return results;
+}
+
 PyObject* ContextObject_is_bundled_path(ContextObject *self, PyObject* args) {
   auto context = &self->context;
   const char* fileName;
@@ -262,6 +369,8 @@ static PyMethodDef AstNodeObject_methods[] = {
   {"parent", (PyCFunction) AstNodeObject_parent, METH_NOARGS, "Get the parent node of this AST node"},
   {"pragmas", (PyCFunction) AstNodeObject_pragmas, METH_NOARGS, "Get the pragmas of this AST node"},
   {"unique_id", (PyCFunction) AstNodeObject_unique_id, METH_NOARGS, "Get a unique identifer for this AST node"},
+  {"find_all", (PyCFunction) AstNodeObject_find_all, METH_VARARGS, "Get a list of this node and its descendants that are instances of the named AST node class"},
+  {"match_pattern", (PyCFunction) AstNodeObject_match_pattern, METH_VARARGS, "Get a list of this node and its descendants that match the given pattern"},
   {NULL, NULL, 0, NULL} /* Sentinel */
 };
 
@@ -342,6 +451,49 @@ PyObject* AstNodeObject_iter(AstNodeObject *self) {
   return wrapIterPair((ContextObject*) self->contextObject, self->astNode->children());
 }
 
+PyObject* AstNodeObject_find_all(AstNodeObject *self, PyObject* args) {
+  const char* className;
+  if (!PyArg_ParseTuple(args, "s", &className)) {
+    PyErr_BadArgument();
+    return nullptr;
+  }
+
+  TagMatcher tag;
+  if (!tagMatcherForName(className, tag)) {
+    PyErr_Format(PyExc_ValueError, "unknown AST node class '%s'", className);
+    return nullptr;
+  }
+
+  std::vector<const AstNode*> nodes;
+  Py_BEGIN_ALLOW_THREADS
+  collectNodes(self->astNode, [&](const AstNode* node) {
+    return tag.matches(node->tag());
+  }, nodes);
+  Py_END_ALLOW_THREADS
+
+  return wrapAstNodeList((ContextObject*) self->contextObject, nodes);
+}
+
+PyObject* AstNodeObject_match_pattern(AstNodeObject *self, PyObject* args) {
+  PyObject* patternPy;
+  if (!PyArg_ParseTuple(args, "O", &patternPy)) {
+    PyErr_BadArgument();
+    return nullptr;
+  }
+
+  AstPattern pattern;
+  if (!unwrapAstPattern(patternPy, pattern)) return nullptr;
+
+  std::vector<const AstNode*> nodes;
+  Py_BEGIN_ALLOW_THREADS
+  collectNodes(self->astNode, [&](const AstNode* node) {
+    return pattern.matches(node);
+  }, nodes);
+  Py_END_ALLOW_THREADS
+
+  return wrapAstNodeList((ContextObject*) self->contextObject, nodes);
+}
+
 PyObject* AstNodeObject_location(AstNodeObject *self) {
   auto locationObjectPy = PyObject_CallObject((PyObject *) &LocationType, nullptr);
   auto& location = ((LocationObject*) locationObjectPy)->location;
@@ -44,6 +44,13 @@ PyObject* ContextObject_advance_to_next_revision(ContextObject *self, PyObject*
 PyObject* ContextObject_get_pyi_file(ContextObject *self, PyObject* args);
 PyObject* ContextObject_track_errors(ContextObject *self, PyObject* args);
 
+/**
+  Parse many files at once, split between several threads that each have
+  their own Context. Returns a list with a (top-level nodes, errors) tuple
+  for each file, in the order the files were given.
+ */
+PyObject* chapel_parse_in_parallel(PyObject* self, PyObject* args);
+
 typedef struct {
   PyObject_HEAD
   chpl::Location location;
@@ -74,6 +81,8 @@ PyObject* AstNodeObject_attribute_group(AstNodeObject *self, PyObject *Py_UNUSED
 PyObject* AstNodeObject_pragmas(AstNodeObject *self, PyObject *Py_UNUSED(ignored));
 PyObject* AstNodeObject_parent(AstNodeObject* self, PyObject *Py_UNUSED(ignored));
 PyObject* AstNodeObject_iter(AstNodeObject *self);
+PyObject* AstNodeObject_find_all(AstNodeObject *self, PyObject* args);
+PyObject* AstNodeObject_match_pattern(AstNodeObject *self, PyObject* args);
 PyObject* AstNodeObject_location(AstNodeObject *self);
 
 /**
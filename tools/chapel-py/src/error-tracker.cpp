@@ -145,6 +145,8 @@ void PythonErrorHandler::report(chpl::Context* context, const chpl::ErrorBase* e
   }
 
   // There's an error list! Create an error object and store it into the list.
+  // The Context may be parsing without holding the GIL, so take it here.
+  auto gil = PyGILState_Ensure();
   auto errorObjectPy = PyObject_CallObject((PyObject *) &ErrorType, nullptr);
   auto errorObject = (ErrorObject*) errorObjectPy;
   errorObject->error = err->clone();
@@ -152,4 +154,6 @@ void PythonErrorHandler::report(chpl::Context* context, const chpl::ErrorBase* e
   errorObject->contextObject = contextObject;
 
   PyList_Append(errorLists.back(), errorObjectPy);
+  Py_DECREF(errorObjectPy);
+  PyGILState_Release(gil);
 }
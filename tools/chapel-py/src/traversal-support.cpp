@@ -0,0 +1,136 @@
+/*
+ * Copyright 2021-2023 Hewlett Packard Enterprise Development LP
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "traversal-support.h"
+#include <cstring>
+
+using namespace chpl;
+using namespace uast;
+
+bool tagMatcherForName(const char* name, TagMatcher& out) {
+  if (!strcmp(name, "AstNode")) {
+    out.first = (asttags::AstTag) 0;
+    out.last = (asttags::AstTag) (asttags::NUM_AST_TAGS - 1);
+    return true;
+  }
+
+#define MATCH_NAME(NAME, FIRST, LAST) \
+  if (!strcmp(name, #NAME)) { \
+    out.first = asttags::FIRST; \
+    out.last = asttags::LAST; \
+    return true; \
+  }
+#define AST_NODE(NAME) MATCH_NAME(NAME, NAME, NAME)
+#define AST_LEAF(NAME) MATCH_NAME(NAME, NAME, NAME)
+#define AST_BEGIN_SUBCLASSES(NAME) MATCH_NAME(NAME, START_##NAME, END_##NAME)
+#define AST_END_SUBCLASSES(NAME)
+#include "chpl/uast/uast-classes-list.h"
+#undef AST_NODE
+#undef AST_LEAF
+#undef AST_BEGIN_SUBCLASSES
+#undef AST_END_SUBCLASSES
+#undef MATCH_NAME
+
+  return false;
+}
+
+bool AstPattern::matches(const AstNode* node) const {
+  if (!isWildcard && !tag.matches(node->tag())) return false;
+  if (!hasChildren) return true;
+
+  auto numChildren = (size_t) node->numChildren();
+  if (numChildren < children.size()) return false;
+  if (numChildren > children.size() && !allowsMoreChildren) return false;
+
+  for (size_t i = 0; i < children.size(); i++) {
+    if (!children[i].matches(node->child(i))) return false;
+  }
+  return true;
+}
+
+static bool unwrapPatternTag(PyObject* obj, AstPattern& out) {
+  if (obj == Py_None) {
+    out.isWildcard = true;
+    return true;
+  }
+
+  if (!PyUnicode_Check(obj)) {
+    PyErr_SetString(PyExc_TypeError,
+                    "pattern elements must be a class name, None, a tuple or a list");
+    return false;
+  }
+
+  auto name = PyUnicode_AsUTF8(obj);
+  if (!name) return false;
+
+  if (!tagMatcherForName(name, out.tag)) {
+    PyErr_Format(PyExc_ValueError, "unknown AST node class '%s'", name);
+    return false;
+  }
+  out.isWildcard = false;
+  return true;
+}
+
+bool unwrapAstPattern(PyObject* obj, AstPattern& out) {
+  if (!PyTuple_Check(obj) && !PyList_Check(obj)) {
+    return unwrapPatternTag(obj, out);
+  }
+
+  auto seq = PySequence_Fast(obj, "expected a tuple or a list");
+  if (!seq) return false;
+
+  auto size = PySequence_Fast_GET_SIZE(seq);
+  auto items = PySequence_Fast_ITEMS(seq);
+  bool ok = true;
+
+  if (size == 0) {
+    PyErr_SetString(PyExc_ValueError, "a pattern tuple needs at least a class name");
+    ok = false;
+  } else {
+    ok = unwrapPatternTag(items[0], out);
+  }
+
+  out.hasChildren = true;
+  for (Py_ssize_t i = 1; ok && i < size; i++) {
+    if (items[i] == Py_Ellipsis) {
+      if (i != size - 1) {
+        PyErr_SetString(PyExc_ValueError, "'...' may only end a pattern tuple");
+        ok = false;
+      }
+      out.allowsMoreChildren = true;
+      continue;
+    }
+
+    out.children.emplace_back();
+    ok = unwrapAstPattern(items[i], out.children.back());
+  }
+
+  Py_DECREF(seq);
+  return ok;
+}
+
+PyObject* wrapAstNodeList(ContextObject* context,
+                          const std::vector<const AstNode*>& nodes) {
+  PyObject* list = PyList_New(nodes.size());
+  if (!list) return nullptr;
+  for (size_t i = 0; i < nodes.size(); i++) {
+    PyList_SET_ITEM(list, i, wrapAstNode(context, nodes[i]));
+  }
+  return list;
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2021-2023 Hewlett Packard Enterprise Development LP
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CHAPEL_PY_TRAVERSAL_SUPPORT_H
+#define CHAPEL_PY_TRAVERSAL_SUPPORT_H
+
+#define PY_SSIZE_T_CLEAN
+#include "Python.h"
+#include "chpl/uast/AstNode.h"
+#include "core-types.h"
+#include <vector>
+
+/**
+  Matches the tags of AST nodes that are instances of a class, which is
+  named the same way as the corresponding Python class. Abstract classes
+  like NamedDecl match all of their subclasses, and AstNode matches every
+  node.
+ */
+struct TagMatcher {
+  chpl::uast::asttags::AstTag first = chpl::uast::asttags::AST_TAG_UNKNOWN;
+  chpl::uast::asttags::AstTag last = chpl::uast::asttags::AST_TAG_UNKNOWN;
+
+  inline bool matches(chpl::uast::asttags::AstTag tag) const {
+    return first <= tag && tag <= last;
+  }
+};
+
+/** Look up the class named 'name'. Returns false if there is none. */
+bool tagMatcherForName(const char* name, TagMatcher& out);
+
+/**
+  A pattern over the shape of an AST, converted from a Python value so that
+  it can be matched without holding the GIL:
+
+    None                  matches any node
+    "Identifier"          matches a node of that class
+    ("FnCall", p1, p2)    matches an FnCall with exactly two children,
+                          where the first matches p1 and the second p2
+    ("FnCall", p1, ...)   the same, but allows any number of further
+                          children
+
+  Lists can be used in place of tuples, and None in place of the class.
+ */
+struct AstPattern {
+  bool isWildcard = true;
+  TagMatcher tag;
+  bool hasChildren = false;
+  bool allowsMoreChildren = false;
+  std::vector<AstPattern> children;
+
+  bool matches(const chpl::uast::AstNode* node) const;
+};
+
+/** Convert a Python value into a pattern. On failure, sets a Python
+    exception and returns false. */
+bool unwrapAstPattern(PyObject* obj, AstPattern& out);
+
+/** Collect 'node' and its descendants that 'pred' accepts, in pre-order.
+    Only touches the uAST, so it may be called without holding the GIL. */
+template <typename F>
+static void collectNodes(const chpl::uast::AstNode* node, const F& pred,
+                         std::vector<const chpl::uast::AstNode*>& out) {
+  if (pred(node)) out.push_back(node);
+  for (auto child : node->children()) collectNodes(child, pred, out);
+}
+
+/** Wrap a vector of AST nodes into a Python list. */
+PyObject* wrapAstNodeList(ContextObject* context,
+                          const std::vector<const chpl::uast::AstNode*>& nodes);
+
+#endif // CHAPEL_PY_TRAVERSAL_SUPPORT_H
@@ -28,7 +28,9 @@
 #include "chpl/util/printf.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/JSON.h"
+#include <algorithm>
 #include <chrono>
+#include <cinttypes>
 #include <thread>
 
 // Wrapper to forward printf arguments to logger.
@@ -57,15 +59,19 @@ void Server::sleep(int msec) {
   std::this_thread::sleep_for(std::chrono::milliseconds(msec));
 }
 
+// The reader thread may log while the main thread does.
 void Server::message(const char* fmt, ...) {
+  std::lock_guard<std::mutex> lock(logLock_);
   VPRINTF_FORWARD_(fmt, logger_.vmessage);
 }
 
 void Server::verbose(const char* fmt, ...) {
+  std::lock_guard<std::mutex> lock(logLock_);
   VPRINTF_FORWARD_(fmt, logger_.vverbose);
 }
 
 void Server::trace(const char* fmt, ...) {
+  std::lock_guard<std::mutex> lock(logLock_);
   VPRINTF_FORWARD_(fmt, logger_.vtrace);
 }
 
@@ -82,6 +88,10 @@ Server::Server(Server::Configuration config)
   errorHandler_ = handler.get();
   chapel_.installErrorHandler(std::move(handler));
 
+  // Configure how long query results survive garbage collection.
+  chapel_.setGarbageCollectionRetention(config_.garbageCollectionKeepRevisions,
+                                        config_.garbageCollectionMaxResults);
+
   // Open the server log.
   Logger logger;
   if (!config_.logFile.empty()) {
@@ -104,6 +114,21 @@ Server::Server(Server::Configuration config)
   doRegisterEssentialEvents();
 }
 
+Server::~Server() {
+  if (!reader_.joinable()) return;
+
+  // The reader stops after reading 'Exit'. Otherwise it may be blocked
+  // on a read that will never complete, so leave it be.
+  std::unique_lock<std::mutex> lock(inboxLock_);
+  const bool isDone = isReaderDone_;
+  lock.unlock();
+  if (isDone) {
+    reader_.join();
+  } else {
+    reader_.detach();
+  }
+}
+
 chpl::Context
 Server::createCompilerContext(const Server::Configuration& config) const {
   chpl::Context::Configuration chplConfig;
@@ -144,10 +169,120 @@ void Server::doRunEvents(Event::When when, const Message* msg) {
 chpl::owned<Message> Server::dequeueOneMessage() {
   if (messages_.empty()) return nullptr;
   auto ret = std::move(messages_.front());
-  messages_.pop();
+  messages_.pop_front();
   return ret;
 }
 
+static bool isExitJson(const JsonValue& j) {
+  if (auto obj = j.getAsObject()) {
+    if (auto method = obj->getString("method")) {
+      auto tag = Message::jsonRpcMethodNameToTag(method->str());
+      return tag == MessageTag::Exit;
+    }
+  }
+  return false;
+}
+
+void Server::doReadIncomingJson() {
+  bool isDone = false;
+
+  while (!isDone) {
+    JsonValue json(nullptr);
+    auto status = transport_->readJson(this, json);
+    if (status != Transport::OK) {
+      this->verbose("Dropping message that could not be read\n");
+      continue;
+    }
+
+    // Nothing should be read after 'Exit', so stop here.
+    isDone = isExitJson(json);
+
+    std::unique_lock<std::mutex> lock(inboxLock_);
+    inbox_.push_back(std::move(json));
+    isReaderDone_ = isDone;
+    lock.unlock();
+    inboxReady_.notify_one();
+  }
+}
+
+size_t Server::readIncomingMessages(bool wait) {
+  if (transport_ == nullptr) return 0;
+
+  if (!reader_.joinable()) {
+    reader_ = std::thread([this]() { doReadIncomingJson(); });
+  }
+
+  std::deque<JsonValue> batch;
+  std::unique_lock<std::mutex> lock(inboxLock_);
+  if (wait) {
+    inboxReady_.wait(lock, [this]() {
+      return !inbox_.empty() || isReaderDone_;
+    });
+  }
+  std::swap(batch, inbox_);
+  lock.unlock();
+
+  for (auto& json : batch) {
+    if (isLogTrace()) {
+      this->trace("Incoming JSON is %s\n", jsonToString(json).c_str());
+    }
+
+    auto work = Message::create(this, std::move(json));
+    CHPL_ASSERT(work.get());
+    enqueue(std::move(work));
+  }
+
+  return batch.size();
+}
+
+bool Server::cancelEnqueuedRequest(const JsonValue& id) {
+  for (auto it = messages_.begin(); it != messages_.end(); it++) {
+    auto& msg = *it;
+    if (msg->behavior() != Message::INCOMING_REQUEST) continue;
+    if (msg->id() != id) continue;
+
+    this->verbose("Cancelling request '%s'\n", msg->idToString().c_str());
+    auto rsp = Response::create(msg->id(), Message::ERR_REQUEST_CANCELLED,
+                                "Request was cancelled");
+    messages_.erase(it);
+    sendMessage(rsp.get());
+    return true;
+  }
+
+  // The request was already handled, or we never received it.
+  return false;
+}
+
+bool Server::coalesceEnqueuedChange(chpl::owned<Message>& msg) {
+  if (messages_.empty()) return false;
+
+  auto next = msg->toDidChange();
+  auto prev = messages_.back()->toDidChange();
+  if (!next || !prev || !next->params() || !prev->params()) return false;
+
+  auto& np = *next->params();
+  auto& pp = *prev->params();
+  if (np.textDocument.uri != pp.textDocument.uri) return false;
+
+  DidChange::Params p;
+  p.textDocument = np.textDocument;
+  p.contentChanges = pp.contentChanges;
+  for (auto& change : np.contentChanges) p.contentChanges.push_back(change);
+
+  // Everything before the last full replacement of the text is moot.
+  auto& v = p.contentChanges;
+  auto it = std::find_if(v.rbegin(), v.rend(), [](auto& change) {
+    return !change.range;
+  });
+  if (it != v.rend()) v.erase(v.begin(), std::prev(it.base()));
+
+  this->verbose("Merged changes to '%s' up to version %" PRId64 "\n",
+                p.textDocument.uri.c_str(), p.textDocument.version);
+
+  messages_.back() = DidChange::create(nullptr, std::move(p));
+  return true;
+}
+
 void Server::sendMessage(const Message* msg) {
   if (transport_ == nullptr) return;
 
@@ -171,7 +306,14 @@ void Server::registerEvent(chpl::owned<Event> event) {
 
 void Server::enqueue(chpl::owned<Message> msg) {
   if (!msg.get()) return;
-  messages_.push(std::move(msg));
+
+  if (auto cancel = msg->toCancelRequest()) {
+    if (auto p = cancel->params()) cancelEnqueuedRequest(p->id);
+  }
+
+  if (coalesceEnqueuedChange(msg)) return;
+
+  messages_.push_back(std::move(msg));
 }
 
 bool Server::handle(chpl::owned<Message> msg) {
@@ -242,10 +384,15 @@ bool Server::handle(chpl::owned<Message> msg) {
 }
 
 int Server::run() {
+  auto ret = run(0);
+  CHPL_ASSERT(ret.hasValue());
+  return *ret;
+}
+
+opt<int> Server::run(size_t n) {
   bool running = true;
-  int ret = 0;
 
-  while (running) {
+  for (size_t i = 0; running && (n == 0 || i < n); i++) {
     doRunEvents(Event::LOOP_START, nullptr);
 
     if (auto msg = dequeueOneMessage()) {
@@ -255,10 +402,12 @@ int Server::run() {
       doRunEvents(Event::AFTER_HANDLE, msg.get());
     }
 
+    std::lock_guard<std::mutex> lock(logLock_);
     logger().flush();
   }
 
-  return ret;
+  if (!running) return 0;
+  return {};
 }
 
 } // end namespace 'chpldef'
@@ -32,9 +32,11 @@
 #include "chpl/uast/AstNode.h"
 #include "llvm/Support/JSON.h"
 #include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <fstream>
 #include <iostream>
-#include <queue>
+#include <mutex>
 #include <thread>
 
 namespace chpldef {
@@ -58,6 +60,8 @@ public:
     Logger::Level logLevel = Logger::OFF;
     std::string chplHome;
     int garbageCollectionFrequency = DEFAULT_GC_FREQUENCY;
+    int garbageCollectionKeepRevisions = 1;
+    size_t garbageCollectionMaxResults = 0;
     bool warnUnstable = false;
     bool enableStandardLibrary = false;
     bool compilerDebugTrace = false;
@@ -131,11 +135,22 @@ private:
   TextRegistry textRegistry_;
   int64_t revision_ = 0;
   ErrorHandler* errorHandler_ = nullptr;
-  std::queue<chpl::owned<Message>> messages_;
+  std::deque<chpl::owned<Message>> messages_;
   std::map<std::string, chpl::owned<Message>> idToOutboundRequest_;
   std::vector<chpl::owned<Event>> events_;
   Transport* transport_ = nullptr;
 
+  /** JSON is read from the transport on a separate thread so that
+      messages pile up in the queue while a slow message is handled.
+      Only the reader touches the transport for reading, and only the
+      main thread creates and handles messages. */
+  std::thread reader_;
+  std::mutex inboxLock_;
+  std::condition_variable inboxReady_;
+  std::deque<JsonValue> inbox_;
+  bool isReaderDone_ = false;
+  std::mutex logLock_;
+
   inline bool
   isLogLevel(Logger::Level level) const { return logger_.level() == level; }
 
@@ -146,26 +161,47 @@ private:
   void doRunEvents(Event::When when, const Message* msg=nullptr);
   chpl::owned<Message> dequeueOneMessage();
   void sendMessage(const Message* msg);
+  void doReadIncomingJson();
+  bool cancelEnqueuedRequest(const JsonValue& id);
+  bool coalesceEnqueuedChange(chpl::owned<Message>& msg);
 
 protected:
   friend chpldef::Initialize;
   friend chpldef::Initialized;
   friend chpldef::Shutdown;
   friend chpldef::DidOpen;
+  friend chpldef::DidChange;
 
   inline void setState(State state) { state_ = state; }
   inline TextRegistry& mutableTextRegistry() { return textRegistry_; }
 
 public:
   Server(Configuration config);
- ~Server() = default;
+ ~Server();
 
   /** Event order matters, and events can be registered more than once. */
   void registerEvent(chpl::owned<Event> event);
 
-  /** Enqueue a message to be worked on by the server. */
+  /** Enqueue a message to be worked on by the server. Work that is made
+      stale by the new message is dropped from the queue first:
+
+        -- A 'CancelRequest' removes the matching request, which is
+           answered with 'ERR_REQUEST_CANCELLED' instead of being handled.
+        -- A 'DidChange' that directly follows another 'DidChange' for the
+           same document is merged into it, and changes that replace the
+           whole text drop the changes that came before them.
+  */
   virtual void enqueue(chpl::owned<Message> msg);
 
+  /** Move every message read from the transport so far into the queue,
+      and return how many there were. If 'wait' is 'true', then block
+      until at least one message has been read. The reader thread is
+      started on the first call. */
+  size_t readIncomingMessages(bool wait);
+
+  /** The number of messages waiting to be handled. */
+  inline size_t numEnqueuedMessages() const { return messages_.size(); }
+
   /** Handling depends on the behavior of the message. There are four modes:
       a message can either be a notification or a request, and it can either
       be incoming (client-to-server) or outbound (server-to-client).
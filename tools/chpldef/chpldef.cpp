@@ -42,6 +42,8 @@ static Server::Configuration prepareServerConfig(int argc, char** argv) {
   ret.logFile = cmd::logFile;
   ret.logLevel = cmd::logLevel;
   ret.garbageCollectionFrequency = cmd::garbageCollectionFrequency;
+  ret.garbageCollectionKeepRevisions = cmd::garbageCollectionKeepRevisions;
+  ret.garbageCollectionMaxResults = cmd::garbageCollectionMaxResults;
   ret.warnUnstable = cmd::warnUnstable;
   ret.enableStandardLibrary = cmd::enableStandardLibrary;
   ret.compilerDebugTrace = cmd::compilerDebugTrace;
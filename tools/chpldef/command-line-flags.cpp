@@ -49,6 +49,16 @@ Flag<int> garbageCollectionFrequency("gc-frequency",
   llvm::cl::desc("Set the garbage collection frequency"),
   llvm::cl::value_desc("An integer specifying a revision interval"));
 
+Flag<int> garbageCollectionKeepRevisions("gc-keep-revisions",
+  llvm::cl::init(1),
+  llvm::cl::desc("Keep query results used in this many recent revisions"),
+  llvm::cl::value_desc("An integer specifying a number of revisions"));
+
+Flag<unsigned> garbageCollectionMaxResults("gc-max-results",
+  llvm::cl::init(0),
+  llvm::cl::desc("Limit the number of query results kept (0 for no limit)"),
+  llvm::cl::value_desc("An integer specifying a number of query results"));
+
 Flag<bool> enableStandardLibrary("enable-std",
   llvm::cl::init(false),
   llvm::cl::desc("Set to enable use of the standard library"));
@@ -60,6 +70,7 @@ Flag<bool> compilerDebugTrace("debug-trace",
 namespace {
 static std::set<const llvm::cl::Option*> flagAddresses = {
   &logFile, &logLevel, &chplHome, &warnUnstable, &garbageCollectionFrequency,
+  &garbageCollectionKeepRevisions, &garbageCollectionMaxResults,
   &enableStandardLibrary,
   &compilerDebugTrace
 };
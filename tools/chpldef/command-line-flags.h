@@ -54,6 +54,12 @@ extern Flag<bool> warnUnstable;
 /** The GC frequency. Defaults to a server-decided value. */
 extern Flag<int> garbageCollectionFrequency;
 
+/** How many revisions query results are kept for. Defaults to 1. */
+extern Flag<int> garbageCollectionKeepRevisions;
+
+/** The most query results kept by GC, or 0 for no limit. Defaults to 0. */
+extern Flag<unsigned> garbageCollectionMaxResults;
+
 /** If the standard library should be enabled. Defaults to 'false'. */
 extern Flag<bool> enableStandardLibrary;
 
@@ -0,0 +1,35 @@
+/*
+ * Copyright 2020-2023 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "./Message.h"
+#include "./Server.h"
+
+namespace chpldef {
+
+/** The server cancels the request when this notification is enqueued,
+    because by the time the notification is handled the request has
+    already been handled (or dropped) in order. */
+template <>
+CancelRequest::ComputeResult
+CancelRequest::compute(Server* ctx, ComputeParams p) {
+  return {};
+}
+
+} // end namespace 'chpldef'
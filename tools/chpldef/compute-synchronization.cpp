@@ -21,6 +21,7 @@
 #include "Message.h"
 #include "Server.h"
 #include "chpl/parsing/parsing-queries.h"
+#include <algorithm>
 
 namespace chpldef {
 
@@ -55,9 +56,70 @@ DidOpen::ComputeResult DidOpen::compute(Server* ctx, ComputeParams p) {
   return {};
 }
 
+/** Convert an LSP position, where 'character' counts UTF-16 code units,
+    into a byte offset within UTF-8 text. Positions past the end of a line
+    or of the text are clamped to it. */
+static size_t positionToOffset(const std::string& text, const Position& pos) {
+  size_t i = 0;
+  for (uint64_t line = 0; line < pos.line && i < text.size(); i++) {
+    if (text[i] == '\n') line++;
+  }
+
+  for (uint64_t units = 0; units < pos.character && i < text.size();) {
+    unsigned char c = text[i];
+    if (c == '\n') break;
+    size_t len = c < 0x80 ? 1 : c < 0xE0 ? 2 : c < 0xF0 ? 3 : 4;
+    i = std::min(i + len, text.size());
+    units += len == 4 ? 2 : 1;
+  }
+
+  return i;
+}
+
 template<>
 DidChange::ComputeResult DidChange::compute(Server* ctx, ComputeParams p) {
-  CHPLDEF_TODO();
+  auto& tdi = p.textDocument;
+  auto& e = ctx->mutableTextRegistry()[tdi.uri];
+
+  // The client has to open a document before it can change it.
+  if (!e.isOpen) {
+    return fail(Message::ERR_INVALID_PARAMS,
+                "document is not open: " + tdi.uri);
+  }
+
+  CHPL_ASSERT(tdi.version > e.version);
+
+  std::string text = ctx->withChapel([&](auto chapel) {
+    return chpl::parsing::fileText(chapel, tdi.uri).text();
+  });
+
+  const std::string oldText = text;
+
+  for (auto& change : p.contentChanges) {
+    if (change.range) {
+      size_t start = positionToOffset(text, change.range->start);
+      size_t end = positionToOffset(text, change.range->end);
+      if (end < start) std::swap(start, end);
+      text.replace(start, end - start, change.text);
+    } else {
+      text = std::move(change.text);
+    }
+  }
+
+  e.version = tdi.version;
+
+  // Edits that leave the text as it was (e.g. an undo back to the last
+  // version we saw) do not need a new revision, so nothing is reparsed.
+  if (text == oldText) return {};
+
+  // Only the text changes here. Unchanged declarations keep their IDs
+  // when the file is reparsed, and 'BuilderResult::update' keeps their
+  // uAST, so queries that depend only on them are not recomputed.
+  ctx->withChapel(Server::CHPL_BUMP_REVISION, [&](auto chapel) {
+    chpl::parsing::setFileText(chapel, tdi.uri, std::move(text));
+    e.lastRevisionContentsUpdated = ctx->revision();
+  });
+
   return {};
 }
 
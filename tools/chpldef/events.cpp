@@ -32,7 +32,7 @@ bool ReadMessage::canRun(Server* ctx) const { return true; }
 void ReadMessage::run(Server* ctx, const Message* msg, When when) {
   CHPL_ASSERT(!msg && when == Event::LOOP_START);
 
-  ctx->message("Attempting to read message...\n");
+  ctx->message("Attempting to read messages...\n");
   auto ts = ctx->transport();
 
   if (ts == nullptr) {
@@ -40,34 +40,12 @@ void ReadMessage::run(Server* ctx, const Message* msg, When when) {
     return;
   }
 
-  JsonValue json(nullptr);
-
-  // TODO: This operation blocks. We'd like non-blocking IO. There are a
-  // few ways to accomplish this. Ideally we find some sort of high-level,
-  // non-blocking "transport" abstraction that we can use.
-  //
-  //    -- LLVM might offer transport layer APIs
-  //    -- LLVM might offer non-blocking IO
-  //    -- C++ futures might be useful here, but we need to be able to
-  //       control which thread runs the future and its lifetime (to
-  //       make sure that the thread reading e.g., stdin is reliably
-  //       closed...).
-  //    -- We can do it ourselves using C++ threads, CVs, and locks, and
-  //       wrap it up in a neat little function that populates a queue
-  //       of messages for the context.
-  auto status = ts->readJson(ctx, json);
-  CHPL_ASSERT(status == Transport::OK);
-
-  if (ctx->isLogTrace()) {
-    ctx->trace("Incoming JSON is %s\n", jsonToString(json).c_str());
-  }
-
-  // Create a message from the incoming JSON...
-  auto work = Message::create(ctx, std::move(json));
-  CHPL_ASSERT(work.get());
-
-  // Add the message to the work queue.
-  ctx->enqueue(std::move(work));
+  // Messages are read on a separate thread. Only block if there is no
+  // other work to do, otherwise take whatever has arrived so far. Taking
+  // a batch lets cancellations and edits drop stale work from the queue.
+  const bool wait = ctx->numEnqueuedMessages() == 0;
+  auto n = ctx->readIncomingMessages(wait);
+  ctx->trace("Read %zu message(s)\n", n);
 }
 
 static bool resolveModulesForMessageTag(MessageTag tag) {
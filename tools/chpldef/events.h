@@ -26,7 +26,7 @@
 namespace chpldef {
 namespace events {
 
-/** This event reads a message from the transport layer. */
+/** This event moves messages read from the transport into the queue. */
 class ReadMessage : public Server::Event {
   static constexpr auto NAME = "ReadMessage";
   static constexpr auto WHEN = LOOP_START;
@@ -55,8 +55,11 @@ CHPLDEF_MESSAGE(LogTrace, $/logTrace)
 // MISC
 //
 
+/** Requests are cancelled when the notification is enqueued, see
+    'Server::enqueue'. Handling the notification itself does nothing. */
+CHPLDEF_MESSAGE(CancelRequest, 0, 1, $/cancelRequest)
+
 /*
-CHPLDEF_MESSAGE(CancelRequest, $/cancelRequest)
 CHPLDEF_MESSAGE(Progress, $/progress)
 */
 
@@ -183,6 +183,20 @@ JsonValue TextDocumentSyncOptions::toJson() const {
   return ret;
 }
 
+bool CancelRequestParams::fromJson(const JsonValue& j, JsonPath p) {
+  if (auto obj = j.getAsObject()) {
+    if (auto v = obj->get("id")) {
+      auto k = v->kind();
+      if (k == JsonValue::Number || k == JsonValue::String) {
+        id = *v;
+        return true;
+      }
+    }
+  }
+  p.report("expected a number or string 'id'");
+  return false;
+}
+
 bool TextDocumentItem::fromJson(const JsonValue& j, JsonPath p) {
   JsonMapper m(j, p);
   return MAP_(m, uri) && MAP_(m, languageId) && MAP_(m, version) &&
@@ -204,9 +218,21 @@ bool DidCloseParams::fromJson(const JsonValue& j, JsonPath p) {
   return m && MAP_(m, textDocument);
 }
 
+bool VersionedTextDocumentIdentifier::fromJson(const JsonValue& j,
+                                               JsonPath p) {
+  JsonMapper m(j, p);
+  return m && MAP_(m, uri) && MAP_(m, version);
+}
+
+bool TextDocumentContentChangeEvent::fromJson(const JsonValue& j,
+                                              JsonPath p) {
+  JsonMapper m(j, p);
+  return m && MAP_(m, range) && MAP_(m, text);
+}
+
 bool DidChangeParams::fromJson(const JsonValue& j, JsonPath p) {
   JsonMapper m(j, p);
-  return m && MAP_(m, textDocument);
+  return m && MAP_(m, textDocument) && MAP_(m, contentChanges);
 }
 
 JsonValue SaveOptions::toJson() const {
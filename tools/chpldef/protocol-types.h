@@ -213,6 +213,12 @@ struct ShutdownParams : EmptyProtocolType {};
 struct ShutdownResult : EmptyProtocolType {};
 struct ExitParams : EmptyProtocolType {};
 
+struct CancelRequestParams : ProtocolTypeRecv {
+  JsonValue id = nullptr;   /** The ID of the request to cancel. */
+
+  virtual bool fromJson(const JsonValue& j, JsonPath p) override;
+};
+
 struct TextDocumentItem : ProtocolTypeRecv {
   std::string uri;
   std::string languageId;
@@ -238,8 +244,9 @@ struct DidOpenParams : ProtocolTypeRecv {
   virtual bool fromJson(const JsonValue& j, JsonPath p) override;
 };
 
-struct DidChangeParams : ProtocolTypeRecv {
-  TextDocumentItem textDocument;
+struct VersionedTextDocumentIdentifier : ProtocolTypeRecv {
+  std::string uri;
+  int64_t version = -1;
 
   virtual bool fromJson(const JsonValue& j, JsonPath p) override;
 };
@@ -316,6 +323,20 @@ struct Range : ProtocolType {
   bool isNegative() const;
 };
 
+struct TextDocumentContentChangeEvent : ProtocolTypeRecv {
+  opt<Range> range;   /** If not present, 'text' is the whole document. */
+  std::string text;
+
+  virtual bool fromJson(const JsonValue& j, JsonPath p) override;
+};
+
+struct DidChangeParams : ProtocolTypeRecv {
+  VersionedTextDocumentIdentifier textDocument;
+  std::vector<TextDocumentContentChangeEvent> contentChanges;
+
+  virtual bool fromJson(const JsonValue& j, JsonPath p) override;
+};
+
 struct TextDocumentPositionParams : ProtocolTypeRecv {
   TextDocumentIdentifier textDocument;
   Position position;
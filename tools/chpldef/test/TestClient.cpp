@@ -19,6 +19,7 @@
  */
 
 #include "./TestClient.h"
+#include "chpl/parsing/parsing-queries.h"
 #include <sstream>
 
 void TestClient::breakpoint() {}
@@ -36,7 +37,7 @@ chpl::Context TestClient::createChapelCompilerInstance() {
 
 int64_t TestClient::bumpVersionForUri(const std::string& uri) {
   auto it = uriToVersion_.find(uri);
-  if (it != uriToVersion_.end()) return it->second++;
+  if (it != uriToVersion_.end()) return ++it->second;
   uriToVersion_[uri] = 0;
   return 0;
 }
@@ -88,6 +89,37 @@ void TestClient::sendDidOpen(const std::string& uri,
   msg->handle(ctx_);
 }
 
+void TestClient::sendDidChange(const std::string& uri,
+                               const std::string& text) {
+  DidChange::Params p;
+  p.textDocument.uri = uri;
+  p.textDocument.version = bumpVersionForUri(uri);
+  TextDocumentContentChangeEvent change;
+  change.text = text;
+  p.contentChanges.push_back(std::move(change));
+  auto msg = DidChange::create(nullptr, std::move(p));
+  msg->handle(ctx_);
+}
+
+void TestClient::sendDidChange(const std::string& uri, const Range& range,
+                               const std::string& text) {
+  DidChange::Params p;
+  p.textDocument.uri = uri;
+  p.textDocument.version = bumpVersionForUri(uri);
+  TextDocumentContentChangeEvent change;
+  change.range = range;
+  change.text = text;
+  p.contentChanges.push_back(std::move(change));
+  auto msg = DidChange::create(nullptr, std::move(p));
+  msg->handle(ctx_);
+}
+
+std::string TestClient::fileText(const std::string& uri) {
+  return ctx_->withChapel([&](auto chapel) {
+    return chpl::parsing::fileText(chapel, uri).text();
+  });
+}
+
 static std::string mentionSymbol(const chpl::uast::AstNode* ast) {
   if (auto x = ast->toIdentifier()) return x->name().c_str();
   if (auto x = ast->toDot()) return x->field().c_str();
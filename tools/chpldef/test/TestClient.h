@@ -56,6 +56,9 @@ public:
   TestClient() : server_(createServerInstance()), ctx_(&server_) {}
  ~TestClient() = default;
 
+  /** Get the server, e.g., to enqueue messages for its main loop. */
+  inline Server* server() { return ctx_; }
+
   /** Get a handle to a stream suitable for printing debug infos. */
   inline std::ostream& dbg() { return dbg_; }
 
@@ -81,6 +84,16 @@ public:
   /** Send a 'DidOpen' notification. */
   void sendDidOpen(const std::string& uri, const std::string& text);
 
+  /** Send a 'DidChange' notification replacing the whole text. */
+  void sendDidChange(const std::string& uri, const std::string& text);
+
+  /** Send a 'DidChange' notification replacing the text in 'range'. */
+  void sendDidChange(const std::string& uri, const Range& range,
+                     const std::string& text);
+
+  /** Get the text the server currently has for 'uri'. */
+  std::string fileText(const std::string& uri);
+
   /** A mention represents a text range the client is interested in.
       Mentions cannot actually store AST because they were computed
       with a separate instance of the Chapel compiler that has a short
@@ -20,14 +20,8 @@
 
 #include "./TestClient.h"
 
-static void testDeclaration(const std::string& uri, const std::string& text) {
-  TestClient client;
-
-  client.advanceServerToReady();
-
-  /** Send 'DidOpen' to communicate text open in the editor. */
-  client.sendDidOpen(uri, text);
-
+static void checkDeclarations(TestClient& client, const std::string& uri,
+                              const std::string& text) {
   /** Collect locations we are interested in. */
   auto lineLengths = TestClient::collectLineLengthsInSource(text);
   auto mentions = TestClient::collectMentions(uri, text);
@@ -71,6 +65,17 @@ static void testDeclaration(const std::string& uri, const std::string& text) {
   }
 }
 
+static void testDeclaration(const std::string& uri, const std::string& text) {
+  TestClient client;
+
+  client.advanceServerToReady();
+
+  /** Send 'DidOpen' to communicate text open in the editor. */
+  client.sendDidOpen(uri, text);
+
+  checkDeclarations(client, uri, text);
+}
+
 static void test0(void) {
   const auto uri = "test0.chpl";
   const auto text = R"""(
@@ -124,8 +129,66 @@ static void test1(void) {
   testDeclaration(uri, text);
 }
 
+/** Edit an open file and check that declarations follow the new text. */
+static void test2(void) {
+  const auto uri = "test2.chpl";
+  const auto before = R"""(
+  var x1 = 0;
+  x1;
+  )""";
+  const auto after = R"""(
+  var x0 = 0.0;
+  var x1 = 0;
+  proc foo() {}
+  x1;
+  foo();
+  x0;
+  )""";
+
+  TestClient client;
+  client.advanceServerToReady();
+  client.sendDidOpen(uri, before);
+  checkDeclarations(client, uri, before);
+  client.sendDidChange(uri, after);
+  checkDeclarations(client, uri, after);
+}
+
+/** Edit ranges of a line with multi-byte text before and after them. The
+    LSP counts characters in UTF-16 code units, so 'é' is one character
+    (two bytes) and '😀' is two characters (four bytes). */
+static void test3(void) {
+  const auto uri = "test3.chpl";
+  const auto before = "var s = \"é😀\"; var x1 = 0;\n"
+                      "x1; // 😀\n";
+
+  TestClient client;
+  client.advanceServerToReady();
+  client.sendDidOpen(uri, before);
+
+  // Rename 'x1' in its declaration, after the multi-byte literal.
+  client.sendDidChange(uri, Range(Position(0, 19), Position(0, 21)), "x2");
+  assert(client.fileText(uri) == "var s = \"é😀\"; var x2 = 0;\n"
+                                 "x1; // 😀\n");
+
+  // Append to the comment, past the two code units of the emoji.
+  client.sendDidChange(uri, Range(Position(1, 9), Position(1, 9)), "!");
+  assert(client.fileText(uri) == "var s = \"é😀\"; var x2 = 0;\n"
+                                 "x1; // 😀!\n");
+
+  // A range spanning a line break and the emoji.
+  client.sendDidChange(uri, Range(Position(0, 26), Position(1, 10)),
+                       "\nx2;");
+  assert(client.fileText(uri) == "var s = \"é😀\"; var x2 = 0;\nx2;\n");
+
+  // Positions past the end of a line clamp to it.
+  client.sendDidChange(uri, Range(Position(1, 3), Position(1, 100)), " ");
+  assert(client.fileText(uri) == "var s = \"é😀\"; var x2 = 0;\nx2; \n");
+}
+
 int main(int argc, char** argv) {
   test0();
   test1();
+  test2();
+  test3();
   return 0;
 }
@@ -0,0 +1,120 @@
+/*
+ * Copyright 2020-2023 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "./TestClient.h"
+
+static chpl::owned<DidChange>
+createDidChange(const std::string& uri, int64_t version,
+                const std::string& text) {
+  DidChange::Params p;
+  p.textDocument.uri = uri;
+  p.textDocument.version = version;
+  TextDocumentContentChangeEvent change;
+  change.text = text;
+  p.contentChanges.push_back(std::move(change));
+  return DidChange::create(nullptr, std::move(p));
+}
+
+static chpl::owned<Declaration>
+createDeclaration(JsonValue id, const std::string& uri) {
+  Declaration::Params p;
+  p.textDocument = TextDocumentIdentifier(uri);
+  p.position = Position(0, 0);
+  return Declaration::create(std::move(id), std::move(p));
+}
+
+/** Changes to the same document that pile up are handled as one. */
+static void test0(void) {
+  const auto uri = "test0.chpl";
+  TestClient client;
+  auto ctx = client.server();
+
+  client.advanceServerToReady();
+  client.sendDidOpen(uri, "var x = 0;\n");
+
+  ctx->enqueue(createDidChange(uri, 1, "var x = 1;\n"));
+  ctx->enqueue(createDidChange(uri, 2, "var x = 2;\n"));
+  ctx->enqueue(createDidChange(uri, 3, "var x = 3;\n"));
+  assert(ctx->numEnqueuedMessages() == 1);
+
+  ctx->run(1);
+  assert(ctx->numEnqueuedMessages() == 0);
+
+  auto text = ctx->withChapel([&](auto chapel) {
+    return chpl::parsing::fileText(chapel, uri).text();
+  });
+  assert(text == "var x = 3;\n");
+  assert(ctx->textRegistry().at(uri).version == 3);
+}
+
+/** A request in between changes needs the text it was sent against, so
+    the changes on either side of it are not merged. */
+static void test1(void) {
+  const auto uri = "test1.chpl";
+  TestClient client;
+  auto ctx = client.server();
+
+  client.advanceServerToReady();
+  client.sendDidOpen(uri, "var x = 0;\n");
+
+  ctx->enqueue(createDidChange(uri, 1, "var x = 1;\n"));
+  ctx->enqueue(createDeclaration(0, uri));
+  ctx->enqueue(createDidChange(uri, 2, "var x = 2;\n"));
+  assert(ctx->numEnqueuedMessages() == 3);
+
+  ctx->run(3);
+  assert(ctx->numEnqueuedMessages() == 0);
+  assert(ctx->textRegistry().at(uri).version == 2);
+}
+
+/** Cancelling a request removes it from the queue, and cancelling one
+    that is not there does nothing. */
+static void test2(void) {
+  const auto uri = "test2.chpl";
+  TestClient client;
+  auto ctx = client.server();
+
+  client.advanceServerToReady();
+  client.sendDidOpen(uri, "var x = 0;\n");
+
+  ctx->enqueue(createDeclaration(7, uri));
+  ctx->enqueue(createDeclaration("eight", uri));
+  assert(ctx->numEnqueuedMessages() == 2);
+
+  CancelRequest::Params p1;
+  p1.id = 7;
+  ctx->enqueue(CancelRequest::create(nullptr, std::move(p1)));
+  assert(ctx->numEnqueuedMessages() == 2);
+
+  CancelRequest::Params p2;
+  p2.id = 7;
+  ctx->enqueue(CancelRequest::create(nullptr, std::move(p2)));
+  assert(ctx->numEnqueuedMessages() == 3);
+
+  ctx->run(3);
+  assert(ctx->numEnqueuedMessages() == 0);
+}
+
+int main(int argc, char** argv) {
+  test0();
+  test1();
+  test2();
+  return 0;
+}
@@ -25,7 +25,9 @@
 #include <iostream>
 #include <fstream>
 #include <limits>
+#include <map>
 #include <regex>
+#include <sstream>
 #include <unordered_map>
 #include <queue>
 
@@ -49,6 +51,7 @@
 #include "chpl/resolution/scope-queries.h"
 
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/xxhash.h"
 #include "chpl/util/version-info.h"
 
 
@@ -1348,9 +1351,14 @@ struct RstResult {
 
   void mark(const Context *c) const {}
 
-  void outputModule(std::string outDir, std::string name, int indentPerDepth) {
+  static std::string outputPath(const std::string& outDir,
+                                const std::string& name) {
     std::string ext = textOnly_ ? ".txt" : ".rst";
-    auto outpath = outDir + "/" + name + ext;
+    return outDir + "/" + name + ext;
+  }
+
+  void outputModule(std::string outDir, std::string name, int indentPerDepth) {
+    auto outpath = outputPath(outDir, name);
 
     std::error_code err = makeDir(outDir, true);
 
@@ -1361,8 +1369,23 @@ struct RstResult {
         return;
       }
     }
+
+    std::ostringstream oss;
+    output(oss, indentPerDepth);
+    std::string contents = oss.str();
+
+    // Leave the file alone if it would not change, so that its timestamp
+    // tells an incremental Sphinx build that the page is up to date.
+    std::ifstream ifs(outpath, std::ios::in | std::ios::binary);
+    if (ifs) {
+      std::ostringstream existing;
+      existing << ifs.rdbuf();
+      if (existing.str() == contents) return;
+    }
+    ifs.close();
+
     std::ofstream ofs = std::ofstream(outpath, std::ios::out);
-    output(ofs, indentPerDepth);
+    ofs << contents;
   }
 
   void output(std::ostream& os, int indentPerDepth) {
@@ -2137,6 +2160,51 @@ module N { }
   //   var nestedX = 22;
   // }
 
+/*
+  Rendered modules are cached between runs in the rst (or text) directory.
+  The cache maps each output file to a key: a hash of the module's source
+  file and of the options that affect what is rendered. A module whose key
+  has not changed is not rendered again. This only helps when the
+  directory is kept between runs, i.e. with --save-sphinx or --text-only.
+*/
+static const char* renderCacheFileName = ".chpldoc-cache";
+
+using RenderCache = std::map<std::string, uint64_t>;
+
+static RenderCache readRenderCache(const std::string& dir) {
+  RenderCache ret;
+  std::ifstream ifs(dir + "/" + renderCacheFileName);
+  std::string path;
+  uint64_t key;
+  while (ifs >> std::hex >> key && std::getline(ifs >> std::ws, path)) {
+    ret[path] = key;
+  }
+  return ret;
+}
+
+static void writeRenderCache(const std::string& dir, const RenderCache& cache) {
+  std::ofstream ofs(dir + "/" + renderCacheFileName, std::ios::out);
+  for (const auto& p : cache) {
+    ofs << std::hex << p.second << " " << p.first << "\n";
+  }
+}
+
+static uint64_t renderKey(Context* context, UniqueString filePath) {
+  std::string key = getVersion();
+  key += '\0';
+  key += commentStyle_;
+  key += textOnly_ ? "t" : "f";
+  key += processUsedModules_ ? "t" : "f";
+  key += fWarnUnknownAttributeToolname ? "t" : "f";
+  for (const auto& name : usingAttributeToolNames) {
+    key += '\0';
+    key += name.str();
+  }
+  key += '\0';
+  key += fileText(context, filePath).text();
+  return llvm::xxHash64(key);
+}
+
 // Command line options and some defaults for dyno-chpldoc
 struct Args {
   std::string saveSphinx = "";
@@ -2426,39 +2494,56 @@ int main(int argc, char** argv) {
     }
   }
 
+  const RenderCache oldCache = readRenderCache(outputDir_);
+  RenderCache newCache;
+
   for (auto id : gather.modules) {
-    if (auto& r = rstDoc(gContext, id)) {
-        // given a module ID we can get the path to the file that we parsed
-        UniqueString filePath;
-        UniqueString parentSymbol;
-        gContext->filePathForId(id, filePath, parentSymbol);
-        std::string moduleName = id.symbolName(gContext).str();
-        std::string parentPath;
-        auto pathVec = id.expandSymbolPath(gContext, id.symbolPath());
-        // remove last entry
-        pathVec.pop_back();
-        for (auto path : pathVec) {
-          for (int i = 0; i <= path.second; i++) {
-            if (path.first != id.symbolName(gContext)) {
-              parentPath += unescapeStringId(path.first.str()) + "/";
-            }
-          }
-        }
-        std::string docsWorkingDir_ = filenameFromModuleName(filePath.c_str(), outputDir_);
-        std::string outdir = docsWorkingDir_;
-        // TODO: This is an ugly hack to handle included module paths
-        if (parentSymbol.isEmpty()) {
-          outdir += "/" + parentPath;
+    // given a module ID we can get the path to the file that we parsed
+    UniqueString filePath;
+    UniqueString parentSymbol;
+    gContext->filePathForId(id, filePath, parentSymbol);
+    std::string moduleName = id.symbolName(gContext).str();
+    std::string parentPath;
+    auto pathVec = id.expandSymbolPath(gContext, id.symbolPath());
+    // remove last entry
+    pathVec.pop_back();
+    for (auto path : pathVec) {
+      for (int i = 0; i <= path.second; i++) {
+        if (path.first != id.symbolName(gContext)) {
+          parentPath += unescapeStringId(path.first.str()) + "/";
         }
+      }
+    }
+    std::string docsWorkingDir_ = filenameFromModuleName(filePath.c_str(), outputDir_);
+    std::string outdir = docsWorkingDir_;
+    // TODO: This is an ugly hack to handle included module paths
+    if (parentSymbol.isEmpty()) {
+      outdir += "/" + parentPath;
+    }
 
-        // need to check for a parent module in the path and add it to the directory structure if it exists
-        r->outputModule(outdir, moduleName, indentPerDepth);
-     }
-   }
+    // Skip modules whose source and options are the same as last time.
+    auto outpath = RstResult::outputPath(outdir, moduleName);
+    auto key = renderKey(gContext, filePath);
+    auto it = oldCache.find(outpath);
+    if (it != oldCache.end() && it->second == key &&
+        llvm::sys::fs::exists(outpath)) {
+      newCache[outpath] = key;
+      continue;
+    }
+
+    if (auto& r = rstDoc(gContext, id)) {
+      // need to check for a parent module in the path and add it to the directory structure if it exists
+      r->outputModule(outdir, moduleName, indentPerDepth);
+      newCache[outpath] = key;
+    }
+  }
 
   // chpldoc-specific warnings could've been issued, make sure they're printed.
   erroHandler->printAndExitIfError(gContext);
 
+  // Only record the cache once everything was rendered without errors.
+  writeRenderCache(outputDir_, newCache);
+
   if (!textOnly_ && !args.noHTML) {
     generateSphinxOutput(docsSphinxDir, docsOutputDir,args.projectVersion,
                          args.author, args.printSystemCommands);
@@ -36,7 +36,10 @@
 #include <sys/stat.h>
 
 // C++ Libraries
+#include <algorithm>
 #include <set>
+#include <string>
+#include <utility>
 
 #ifndef MAXPATHLEN
 #define MAXPATHLEN 2048
@@ -794,6 +797,148 @@ int DataModel::LoadData(const char * filename, bool fromArgv)
 }
 
 
+// Trace files
+//
+// With CHPL_RT_VDEBUG_FORMAT=trace the runtime writes the task, comm
+// and fork records as Chrome/Perfetto trace events, one per line, in
+// <file>.json next to the text file.  They are not in time order, since
+// each thread buffers its own.  Convert each back to the text record
+// it stands for, so the rest of the loader doesn't need to know.
+
+// Copy the value for key in a JSON event, without any quotes.
+static bool jsonValue(const char *ev, const char *key, char *buf, size_t size)
+{
+  char pat[32];
+  snprintf (pat, sizeof(pat), "\"%s\":", key);
+  const char *p = strstr(ev, pat);
+  if (!p)
+    return false;
+  p += strlen(pat);
+  if (*p == '"')
+    p++;
+  size_t n = 0;
+  while (*p && *p != '"' && *p != ',' && *p != '}' && n < size-1)
+    buf[n++] = *p++;
+  buf[n] = 0;
+  return n > 0;
+}
+
+static long jsonLong(const char *ev, const char *key)
+{
+  char buf[64];
+  return jsonValue(ev, key, buf, sizeof(buf)) ? strtol(buf, NULL, 0) : 0;
+}
+
+// Returns the event time in usec, or -1 if ev is not a record for chplvis.
+static long long traceToText(const char *ev, char *out, size_t size)
+{
+  char name[32], cat[16], ph[4], ts[32], tid[32], task[32];
+  char addr[32], raddr[32];
+
+  if (!jsonValue(ev, "name", name, sizeof(name))
+      || !jsonValue(ev, "cat", cat, sizeof(cat))
+      || !jsonValue(ev, "ph", ph, sizeof(ph))
+      || !jsonValue(ev, "ts", ts, sizeof(ts))
+      || !jsonValue(ev, "tid", tid, sizeof(tid)))
+    return -1;
+
+  long long us = strtoll(ts, NULL, 10);
+  long sec = us / 1000000;
+  long usec = us % 1000000;
+  long pid = jsonLong(ev, "pid");
+
+  if (strcmp(cat, "task") == 0) {
+    if (ph[0] == 'i') {
+      if (!jsonValue(ev, "task", task, sizeof(task)))
+        return -1;
+      snprintf (out, size, "task: %ld.%06ld %ld %s %s %s %ld %ld %ld\n",
+                sec, usec, pid, task, tid,
+                jsonLong(ev, "on") ? "O" : "L", jsonLong(ev, "line"),
+                jsonLong(ev, "file"), jsonLong(ev, "fid"));
+    } else {
+      snprintf (out, size, "%s: %ld.%06ld %ld %s\n",
+                ph[0] == 'B' ? "Btask" : "Etask", sec, usec, pid, tid);
+    }
+  } else if (strcmp(cat, "comm") == 0) {
+    if (!jsonValue(ev, "addr", addr, sizeof(addr))
+        || !jsonValue(ev, "raddr", raddr, sizeof(raddr)))
+      return -1;
+    snprintf (out, size, "%s: %ld.%06ld %ld %ld %s %s %s %ld %ld %ld %ld %ld\n",
+              name, sec, usec, pid, jsonLong(ev, "remote"), tid, addr, raddr,
+              jsonLong(ev, "elemSize"), jsonLong(ev, "len"),
+              jsonLong(ev, "commID"), jsonLong(ev, "line"),
+              jsonLong(ev, "file"));
+  } else if (strcmp(cat, "on") == 0) {
+    if (!jsonValue(ev, "arg", addr, sizeof(addr)))
+      return -1;
+    snprintf (out, size, "%s: %ld.%06ld %ld %ld %ld %ld %s %ld %s %ld %ld\n",
+              name, sec, usec, pid, jsonLong(ev, "remote"),
+              jsonLong(ev, "subloc"), jsonLong(ev, "fid"), addr,
+              jsonLong(ev, "argSize"), tid, jsonLong(ev, "line"),
+              jsonLong(ev, "file"));
+  } else {
+    return -1;
+  }
+
+  return us;
+}
+
+typedef std::pair<long long, std::string> timedLine;
+
+static bool timedLineLess (const timedLine &a, const timedLine &b)
+{
+  return a.first < b.first;
+}
+
+// Read the rest of a text data file, merging in the records from its
+// trace file if there is one.  Records without a time keep their place
+// after the record before them.
+
+static bool readDataLines (FILE *data, const char *fileToOpen,
+                           std::vector<std::string> &lines)
+{
+  std::vector<timedLine> text;
+  std::vector<timedLine> trace;
+  char line[4096];
+  long long key = -1;
+
+  while (fgets(line, sizeof(line), data) == line) {
+    const char *linedata = strchr(line, ':');
+    long sec, usec;
+    if (linedata && sscanf(linedata, ": %ld.%ld", &sec, &usec) == 2)
+      key = (long long)sec * 1000000 + usec;
+    text.push_back(timedLine(key, line));
+  }
+  bool ok = feof(data);
+
+  std::string traceName = std::string(fileToOpen) + ".json";
+  FILE *tdata = fopen(traceName.c_str(), "r");
+  if (tdata) {
+    char tline[MAX_LINE_LEN];
+    while (fgets(line, sizeof(line), tdata) == line) {
+      long long us = traceToText(line, tline, sizeof(tline));
+      if (us >= 0)
+        trace.push_back(timedLine(us, tline));
+    }
+    fclose(tdata);
+    std::stable_sort(trace.begin(), trace.end(), timedLineLess);
+  }
+
+  // Text records go first on ties: a Tag at the same usec as an event
+  // started the period the event belongs to.
+  size_t ix = 0, tx = 0;
+  lines.reserve(text.size() + trace.size());
+  while (ix < text.size() || tx < trace.size()) {
+    if (tx == trace.size()
+        || (ix < text.size() && text[ix].first <= trace[tx].first))
+      lines.push_back(text[ix++].second);
+    else
+      lines.push_back(trace[tx++].second);
+  }
+
+  return ok;
+}
+
 // Load the data in the current file
 
 int DataModel::LoadFile (const char *fileToOpen, int index, double seq)
@@ -862,7 +1007,13 @@ int DataModel::LoadFile (const char *fileToOpen, int index, double seq)
     theEvents.insert(itr,newEvent);
   }
 
-  while ( fgets(line, MAX_LINE_LEN, data) == line ) {
+  std::vector<std::string> lines;
+  bool readAll = readDataLines(data, fileToOpen, lines);
+  fclose(data);
+
+  for (size_t lx = 0; lx < lines.size(); lx++) {
+    snprintf (line, MAX_LINE_LEN, "%s", lines[lx].c_str());
+
     // Common Data
     char *linedata;
     long linelen;
@@ -1278,7 +1429,7 @@ int DataModel::LoadFile (const char *fileToOpen, int index, double seq)
   //         fileToOpen, ignoreFork, ignoreTask);
   //  }
 
-  if ( !feof(data) ) return 0;
+  if (!readAll) return 0;
 
   return 1;
 }